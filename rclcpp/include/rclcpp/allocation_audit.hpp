@@ -0,0 +1,154 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__ALLOCATION_AUDIT_HPP_
+#define RCLCPP__ALLOCATION_AUDIT_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// Code path of rclcpp in which allocations are audited.
+enum class AllocationSite
+{
+  Publish,
+  Timer,
+  Subscription,
+  Service,
+  Client,
+  Waitable,
+};
+
+/// Allocations made by one thread for one entity, see AllocationAudit.
+struct AllocationAuditRecord
+{
+  /// Address of the entity, e.g. the publisher or the subscription, used as an identifier.
+  const void * entity;
+  AllocationSite site;
+  std::thread::id thread_id;
+  /// Number of audited executions, e.g. of calls to publish or of callbacks.
+  uint64_t execution_count;
+  /// Number of heap allocations made by these executions.
+  uint64_t allocation_count;
+  /// Number of bytes allocated by these executions.
+  uint64_t allocated_bytes;
+};
+
+/// Opt-in count of the heap allocations of the hot paths of rclcpp, per thread and per entity.
+/**
+ * When enabled, the executors audit the callbacks they execute and the publishers audit
+ * Publisher::publish(), so real-time code can check that these paths don't allocate.
+ * The allocations are attributed to the innermost audited path, e.g. the allocations of a
+ * publish from a callback are counted for the publisher, not for the callback.
+ *
+ * Like AllocationGuard, the allocations are only seen if the program replaces the global
+ * operator new, e.g. by including rclcpp/allocation_guard_operators.hpp in one of its
+ * translation units.
+ *
+ * When disabled, which is the default, auditing a path costs one relaxed atomic load.
+ * When enabled, a mutex is locked once per audited execution to store the counts.
+ *
+ * All public member functions are thread-safe.
+ */
+class AllocationAudit
+{
+public:
+  /// Audit an execution of a code path while in scope.
+  /**
+   * Nothing is audited if the audit is disabled when the scope is created, if the entity is
+   * nullptr, or if the thread is already auditing the same site of the same entity, e.g. in a
+   * publish overload calling another one.
+   */
+  class Scope
+  {
+public:
+    RCLCPP_PUBLIC
+    Scope(const void * entity, AllocationSite site) noexcept;
+
+    RCLCPP_PUBLIC
+    ~Scope();
+
+    /// Called for each allocation of the thread, with the innermost scope.
+    void
+    on_allocation(size_t size) noexcept
+    {
+      ++allocation_count_;
+      allocated_bytes_ += size;
+    }
+
+private:
+    RCLCPP_DISABLE_COPY(Scope)
+
+    const void * entity_;
+    AllocationSite site_;
+    Scope * parent_;
+    bool active_;
+    uint64_t allocation_count_;
+    uint64_t allocated_bytes_;
+  };
+
+  /// Start auditing the allocations.
+  RCLCPP_PUBLIC
+  static void
+  enable();
+
+  /// Stop auditing the allocations, the records are kept.
+  RCLCPP_PUBLIC
+  static void
+  disable();
+
+  /// Return true if the allocations are audited.
+  RCLCPP_PUBLIC
+  static bool
+  is_enabled() noexcept;
+
+  /// Return the records of the audited executions since the last reset().
+  RCLCPP_PUBLIC
+  static std::vector<AllocationAuditRecord>
+  get_records();
+
+  /// Return the total number of allocations of the audited executions since the last reset().
+  RCLCPP_PUBLIC
+  static uint64_t
+  get_allocation_count();
+
+  /// Forget the records.
+  RCLCPP_PUBLIC
+  static void
+  reset();
+
+  /// Check that no audited execution allocated since the last reset().
+  /**
+   * \throws std::runtime_error describing the entities which allocated, if any.
+   */
+  RCLCPP_PUBLIC
+  static void
+  assert_no_allocations();
+
+  /// Called by AllocationGuard::on_allocation() for each allocation.
+  RCLCPP_PUBLIC
+  static void
+  on_allocation(size_t size) noexcept;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__ALLOCATION_AUDIT_HPP_
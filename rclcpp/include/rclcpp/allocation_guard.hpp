@@ -0,0 +1,86 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__ALLOCATION_GUARD_HPP_
+#define RCLCPP__ALLOCATION_GUARD_HPP_
+
+#include <cstddef>
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// What to do with the heap allocations made by a thread within an AllocationGuard.
+enum class AllocationCheck
+{
+  /// Allocations are allowed and not counted.
+  None,
+  /// Allocations are allowed, but counted.
+  Count,
+  /// Allocations abort the process, after printing their size.
+  Abort,
+};
+
+/// Check the heap allocations of the current thread while in scope.
+/**
+ * The allocations are only seen if the program replaces the global operator new, either with
+ * its own operators calling AllocationGuard::on_allocation(), or by including
+ * rclcpp/allocation_guard_operators.hpp in exactly one of its translation units.
+ * Otherwise the guard has no effect, and get_allocation_count() always returns 0.
+ *
+ * The guards can be nested, the innermost one decides, e.g. a guard with
+ * AllocationCheck::None allows allocations within the scope of an aborting one.
+ */
+class AllocationGuard
+{
+public:
+  RCLCPP_PUBLIC
+  explicit AllocationGuard(AllocationCheck check);
+
+  RCLCPP_PUBLIC
+  ~AllocationGuard();
+
+  /// Return the number of allocations counted on this thread since this guard was created.
+  /**
+   * The allocations allowed by nested guards with AllocationCheck::None aren't counted.
+   */
+  RCLCPP_PUBLIC
+  size_t
+  get_allocation_count() const;
+
+  /// Return the check of the innermost guard of the current thread.
+  RCLCPP_PUBLIC
+  static AllocationCheck
+  get_current_check();
+
+  /// Called by the replaced operator new for each allocation, before allocating.
+  /**
+   * \param[in] size number of bytes being allocated.
+   */
+  RCLCPP_PUBLIC
+  static void
+  on_allocation(size_t size) noexcept;
+
+private:
+  RCLCPP_DISABLE_COPY(AllocationGuard)
+
+  const AllocationCheck previous_check_;
+  const size_t initial_count_;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__ALLOCATION_GUARD_HPP_
@@ -0,0 +1,97 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__ALLOCATION_GUARD_OPERATORS_HPP_
+#define RCLCPP__ALLOCATION_GUARD_OPERATORS_HPP_
+
+/// Replace the global operators new and delete to report the allocations to AllocationGuard.
+/**
+ * This header defines functions, it must be included in exactly one translation unit of the
+ * program, typically the one with its main() function.
+ *
+ * The over-aligned operators new aren't replaced, their allocations aren't seen.
+ */
+
+#include <cstdlib>
+#include <new>
+
+#include "rclcpp/allocation_guard.hpp"
+
+void *
+operator new(std::size_t size)
+{
+  rclcpp::AllocationGuard::on_allocation(size);
+  void * ptr = std::malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void *
+operator new[](std::size_t size)
+{
+  return operator new(size);
+}
+
+void *
+operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+  rclcpp::AllocationGuard::on_allocation(size);
+  return std::malloc(size == 0 ? 1 : size);
+}
+
+void *
+operator new[](std::size_t size, const std::nothrow_t & tag) noexcept
+{
+  return operator new(size, tag);
+}
+
+void
+operator delete(void * ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void
+operator delete[](void * ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void
+operator delete(void * ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+void
+operator delete[](void * ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+void
+operator delete(void * ptr, const std::nothrow_t &) noexcept
+{
+  std::free(ptr);
+}
+
+void
+operator delete[](void * ptr, const std::nothrow_t &) noexcept
+{
+  std::free(ptr);
+}
+
+#endif  // RCLCPP__ALLOCATION_GUARD_OPERATORS_HPP_
@@ -17,6 +17,7 @@
 
 #include <cstring>
 #include <memory>
+#include <type_traits>
 
 #include "rcl/allocator.h"
 
@@ -67,6 +68,17 @@ void retyped_deallocate(void * untyped_pointer, void * untyped_allocator)
   std::allocator_traits<Alloc>::deallocate(*typed_allocator, typed_ptr, 1);
 }
 
+/// Whether the allocator has a `reallocate(pointer, n)` member keeping the contents of the memory.
+template<typename Alloc, typename = void>
+struct has_reallocate : std::false_type {};
+
+template<typename Alloc>
+struct has_reallocate<
+  Alloc,
+  std::void_t<decltype(std::declval<Alloc &>().reallocate(
+    std::declval<typename std::allocator_traits<Alloc>::pointer>(), size_t()))>>
+  : std::true_type {};
+
 template<typename T, typename Alloc>
 void * retyped_reallocate(void * untyped_pointer, size_t size, void * untyped_allocator)
 {
@@ -75,8 +87,13 @@ void * retyped_reallocate(void * untyped_pointer, size_t size, void * untyped_al
     throw std::runtime_error("Received incorrect allocator type");
   }
   auto typed_ptr = static_cast<T *>(untyped_pointer);
-  std::allocator_traits<Alloc>::deallocate(*typed_allocator, typed_ptr, 1);
-  return std::allocator_traits<Alloc>::allocate(*typed_allocator, size);
+  if constexpr (has_reallocate<Alloc>::value) {
+    // The allocator knows the size of the memory, it can keep its contents
+    return typed_allocator->reallocate(typed_ptr, size);
+  } else {
+    std::allocator_traits<Alloc>::deallocate(*typed_allocator, typed_ptr, 1);
+    return std::allocator_traits<Alloc>::allocate(*typed_allocator, size);
+  }
 }
 
 
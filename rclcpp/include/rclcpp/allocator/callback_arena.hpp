@@ -0,0 +1,224 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__ALLOCATOR__CALLBACK_ARENA_HPP_
+#define RCLCPP__ALLOCATOR__CALLBACK_ARENA_HPP_
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace allocator
+{
+
+/// Monotonic memory arena, released all at once.
+/**
+ * Allocating is bumping an offset in a chunk of memory, there is no per allocation release.
+ * When the current chunk is full a bigger chunk is added.
+ * reset() makes all the memory available again and merges the chunks into a single one of the
+ * total capacity, so an arena used for similar work each time stops allocating after the
+ * first resets.
+ *
+ * Not thread-safe, an arena is meant to be used by a single thread, see CallbackArenaScope.
+ */
+class CallbackArena
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(CallbackArena)
+
+  /// Create an arena.
+  /**
+   * \param[in] initial_capacity the size in bytes of the first chunk, at least one byte is used.
+   */
+  RCLCPP_PUBLIC
+  explicit CallbackArena(size_t initial_capacity);
+
+  RCLCPP_PUBLIC
+  ~CallbackArena();
+
+  /// Allocate memory from the arena, adding a chunk if the remaining memory isn't enough.
+  /**
+   * \param[in] bytes the size of the memory.
+   * \param[in] alignment the alignment of the memory, a power of two.
+   * \return the memory, valid until the next reset() or the destruction of the arena.
+   * \throws std::bad_alloc if the memory couldn't be allocated.
+   */
+  RCLCPP_PUBLIC
+  void *
+  allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+  /// Make all the memory of the arena available again.
+  RCLCPP_PUBLIC
+  void
+  reset();
+
+  /// Return the total size in bytes of the chunks of the arena.
+  RCLCPP_PUBLIC
+  size_t
+  get_capacity() const;
+
+  /// Return the number of bytes allocated since the last reset, including the alignment padding.
+  RCLCPP_PUBLIC
+  size_t
+  get_used() const;
+
+  /// Return the arena of the callback executed by the calling thread, or nullptr if none.
+  RCLCPP_PUBLIC
+  static CallbackArena *
+  get_current();
+
+private:
+  RCLCPP_DISABLE_COPY(CallbackArena)
+
+  struct Chunk
+  {
+    std::unique_ptr<unsigned char[]> memory;
+    size_t size;
+  };
+
+  void
+  add_chunk(size_t size);
+
+  std::vector<Chunk> chunks_;
+  size_t chunk_offset_{0};
+  size_t capacity_{0};
+  size_t used_{0};
+};
+
+/// Make the arena of the calling thread the current one while this object exists.
+/**
+ * The executors create one around each callback they execute when
+ * rclcpp::ExecutorOptions::callback_arena_capacity isn't zero.
+ * Each thread has its own arena, created the first time a scope is entered and growing to the
+ * largest capacity requested.
+ * Scopes can be nested, the arena is reset when the outermost one ends, as the memory of the
+ * callbacks executed inline by another callback belongs to the latter.
+ */
+class CallbackArenaScope
+{
+public:
+  /// Enter a scope.
+  /**
+   * \param[in] capacity the minimum capacity of the arena of the thread.
+   */
+  RCLCPP_PUBLIC
+  explicit CallbackArenaScope(size_t capacity);
+
+  RCLCPP_PUBLIC
+  ~CallbackArenaScope();
+
+private:
+  RCLCPP_DISABLE_COPY(CallbackArenaScope)
+};
+
+/// Allocator using the arena of the current callback, see CallbackArena::get_current().
+/**
+ * Memory allocated while no callback arena is active comes from the heap, like with
+ * std::allocator, so the containers using it work anywhere.
+ * Deallocating memory of the arena does nothing, it's available again once the callback ends.
+ *
+ * What is allocated from the arena must not outlive the callback, e.g. it must not be stored
+ * in a member, given to another thread or published by unique pointer.
+ * For the same reason it must not be used as the allocator of publishers or subscriptions, whose
+ * intra-process buffers keep messages beyond a callback.
+ *
+ * It's usable with the messages, e.g. `test_msgs::msg::Strings_<CallbackArenaAllocator<void>>`,
+ * and with a rclcpp::message_memory_strategy::MessageMemoryStrategy, see
+ * rclcpp::strategies::callback_arena_memory_strategy::CallbackArenaMessageMemoryStrategy.
+ */
+template<typename T>
+class CallbackArenaAllocator
+{
+public:
+  using value_type = T;
+
+  template<typename U>
+  struct rebind
+  {
+    using other = CallbackArenaAllocator<U>;
+  };
+
+  CallbackArenaAllocator() noexcept = default;
+
+  template<typename U>
+  CallbackArenaAllocator(const CallbackArenaAllocator<U> &) noexcept  // NOLINT
+  {}
+
+  T *
+  allocate(size_t n)
+  {
+    static_assert(
+      alignof(T) <= kHeaderSize, "the alignment of the type is greater than the one of the arena");
+    if (n > (std::numeric_limits<size_t>::max() - kHeaderSize) / sizeof(T)) {
+      throw std::bad_alloc();
+    }
+    const size_t bytes = kHeaderSize + n * sizeof(T);
+    CallbackArena * arena = CallbackArena::get_current();
+    unsigned char * memory;
+    if (arena) {
+      memory = static_cast<unsigned char *>(arena->allocate(bytes, kHeaderSize));
+      *memory = kFromArena;
+    } else {
+      memory = static_cast<unsigned char *>(::operator new(bytes));
+      *memory = kFromHeap;
+    }
+    return reinterpret_cast<T *>(memory + kHeaderSize);
+  }
+
+  void
+  deallocate(T * pointer, size_t n) noexcept
+  {
+    (void)n;
+    if (!pointer) {
+      return;
+    }
+    // The size isn't reliable, e.g. the rcl allocators always give 1, so the header tells
+    // where the memory comes from
+    unsigned char * memory = reinterpret_cast<unsigned char *>(pointer) - kHeaderSize;
+    if (*memory == kFromHeap) {
+      ::operator delete(memory);
+    }
+  }
+
+private:
+  static constexpr size_t kHeaderSize = alignof(std::max_align_t);
+  static constexpr unsigned char kFromHeap = 0;
+  static constexpr unsigned char kFromArena = 1;
+};
+
+template<typename T, typename U>
+constexpr bool
+operator==(const CallbackArenaAllocator<T> &, const CallbackArenaAllocator<U> &) noexcept
+{
+  return true;
+}
+
+template<typename T, typename U>
+constexpr bool
+operator!=(const CallbackArenaAllocator<T> &, const CallbackArenaAllocator<U> &) noexcept
+{
+  return false;
+}
+
+}  // namespace allocator
+}  // namespace rclcpp
+
+#endif  // RCLCPP__ALLOCATOR__CALLBACK_ARENA_HPP_
@@ -0,0 +1,167 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__ALLOCATOR__HUGE_PAGE_MEMORY_RESOURCE_HPP_
+#define RCLCPP__ALLOCATOR__HUGE_PAGE_MEMORY_RESOURCE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace allocator
+{
+
+/// How HugePageMemoryResource gets huge pages from the kernel.
+enum class HugePageMode
+{
+  /// Transparent huge pages, requested with madvise(MADV_HUGEPAGE) on aligned mappings.
+  Transparent,
+  /// Explicit huge pages with MAP_HUGETLB, from the pool reserved in /proc/sys/vm/nr_hugepages.
+  /**
+   * When the pool is exhausted, the memory is mapped as with HugePageMode::Transparent.
+   */
+  Explicit,
+};
+
+/// Options of HugePageMemoryResource.
+struct HugePageMemoryResourceOptions
+{
+  HugePageMode mode = HugePageMode::Transparent;
+  /// Allocations smaller than this are forwarded to the upstream memory resource.
+  size_t min_size = 1024 * 1024;
+  /// Size of the huge pages, the mappings are aligned to it and their sizes multiple of it.
+  size_t huge_page_size = 2 * 1024 * 1024;
+  /// Upper bound of the released memory kept for reuse, the memory beyond it is unmapped.
+  size_t max_cached_bytes = 256 * 1024 * 1024;
+  /// Touch the pages of the new mappings, so that the first use of the memory doesn't fault.
+  bool prefault = false;
+  /// Memory resource of the small allocations, not owned, it must outlive the resource.
+  std::pmr::memory_resource * upstream = std::pmr::get_default_resource();
+};
+
+/// Statistics of a HugePageMemoryResource.
+struct HugePageStatistics
+{
+  /// Mappings created for the large allocations.
+  uint64_t mappings = 0;
+  /// Large allocations served with released memory, without mapping and faulting it again.
+  uint64_t reuses = 0;
+  /// Mappings which got no explicit huge pages and fell back to transparent ones.
+  uint64_t huge_page_fallbacks = 0;
+  /// Allocations forwarded to the upstream memory resource.
+  uint64_t upstream_allocations = 0;
+  /// Memory currently mapped, including the cached memory.
+  size_t mapped_bytes = 0;
+  /// Released memory kept for reuse.
+  size_t cached_bytes = 0;
+};
+
+/// Memory resource backing the large allocations with huge pages and reusing them.
+/**
+ * Meant for the intra-process delivery of large messages, e.g. point clouds and images, whose
+ * fresh allocations otherwise fault on every page and miss the TLB.
+ * The large allocations are rounded up to size classes, multiples of the huge page size at most
+ * 25% larger than requested, and the released memory is kept per size class to serve the next
+ * allocations of the same class.
+ *
+ * It is selected for a publisher or a subscription with rclcpp::PublisherOptionsWithMemoryResource
+ * or rclcpp::SubscriptionOptionsWithMemoryResource, see also create_memory_resource().
+ * The intra-process copies and the message pools of the entity then allocate from it, as well as
+ * the fields of the messages whose container allocator is a MemoryResourceAllocator.
+ *
+ * Huge pages are only supported on Linux, elsewhere the large allocations are aligned
+ * allocations from the upstream memory resource, still reused per size class.
+ * It is thread-safe, and must outlive the memory it allocated.
+ */
+class HugePageMemoryResource : public std::pmr::memory_resource
+{
+public:
+  /// Create the memory resource.
+  /**
+   * \throws std::invalid_argument if the upstream memory resource is nullptr, or if the huge
+   *   page size isn't a power of two.
+   */
+  RCLCPP_PUBLIC
+  explicit HugePageMemoryResource(
+    const HugePageMemoryResourceOptions & options = HugePageMemoryResourceOptions());
+
+  /// Unmap the cached memory.
+  RCLCPP_PUBLIC
+  ~HugePageMemoryResource() override;
+
+  HugePageMemoryResource(const HugePageMemoryResource &) = delete;
+  HugePageMemoryResource & operator=(const HugePageMemoryResource &) = delete;
+
+  /// Unmap the memory kept for reuse.
+  RCLCPP_PUBLIC
+  void
+  release();
+
+  RCLCPP_PUBLIC
+  HugePageStatistics
+  get_statistics() const;
+
+  RCLCPP_PUBLIC
+  const HugePageMemoryResourceOptions &
+  get_options() const noexcept;
+
+protected:
+  /// Allocate the memory.
+  /**
+   * \throws std::bad_alloc if the memory can't be mapped, or if the alignment is greater than
+   *   the huge page size.
+   */
+  RCLCPP_PUBLIC
+  void *
+  do_allocate(size_t bytes, size_t alignment) override;
+
+  RCLCPP_PUBLIC
+  void
+  do_deallocate(void * pointer, size_t bytes, size_t alignment) override;
+
+  RCLCPP_PUBLIC
+  bool
+  do_is_equal(const std::pmr::memory_resource & other) const noexcept override;
+
+private:
+  /// Return the size of the mapping serving an allocation of the given size.
+  size_t
+  get_size_class(size_t bytes) const;
+
+  /// Map memory of the given size class, setting huge_page_fallback if no huge page was got.
+  void *
+  map(size_t size, bool & huge_page_fallback);
+
+  void
+  unmap(void * pointer, size_t size);
+
+  const HugePageMemoryResourceOptions options_;
+
+  mutable std::mutex mutex_;
+  /// Released mappings per size class.
+  std::map<size_t, std::vector<void *>> cached_mappings_;
+  HugePageStatistics statistics_;
+};
+
+}  // namespace allocator
+}  // namespace rclcpp
+
+#endif  // RCLCPP__ALLOCATOR__HUGE_PAGE_MEMORY_RESOURCE_HPP_
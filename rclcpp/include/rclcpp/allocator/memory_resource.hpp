@@ -0,0 +1,219 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__ALLOCATOR__MEMORY_RESOURCE_HPP_
+#define RCLCPP__ALLOCATOR__MEMORY_RESOURCE_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "rclcpp/allocator/huge_page_memory_resource.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace allocator
+{
+
+/// Allocator using a std::pmr::memory_resource chosen at runtime.
+/**
+ * All the entities using it share the same template instantiation, whatever their memory
+ * resource, e.g. rclcpp::PublisherOptionsWithMemoryResource.
+ *
+ * Unlike std::pmr::polymorphic_allocator, it has a `void` specialization, as required by the
+ * publisher and subscription options, and a copy of a container keeps the memory resource.
+ * Each allocation starts with a header holding its size, as the rcl allocators and the
+ * rclcpp deleters don't give the size of the memory they deallocate, which the memory
+ * resources need.
+ *
+ * The memory resource isn't owned, it must outlive the allocators and the memory they
+ * allocated, e.g. the entities using it and their messages.
+ */
+template<typename T = void>
+class MemoryResourceAllocator
+{
+public:
+  using value_type = T;
+
+  template<typename U>
+  struct rebind
+  {
+    using other = MemoryResourceAllocator<U>;
+  };
+
+  /// Create an allocator using std::pmr::get_default_resource().
+  MemoryResourceAllocator() noexcept
+  : resource_(std::pmr::get_default_resource())
+  {}
+
+  /// Create an allocator using the given memory resource.
+  /**
+   * \throws std::invalid_argument if the memory resource is nullptr.
+   */
+  MemoryResourceAllocator(std::pmr::memory_resource * resource)  // NOLINT
+  : resource_(resource)
+  {
+    if (!resource_) {
+      throw std::invalid_argument("memory resource cannot be nullptr");
+    }
+  }
+
+  template<typename U>
+  MemoryResourceAllocator(const MemoryResourceAllocator<U> & other) noexcept  // NOLINT
+  : resource_(other.resource())
+  {}
+
+  T *
+  allocate(size_t n)
+  {
+    static_assert(
+      alignof(T) <= kHeaderSize, "the alignment of the type is greater than the supported one");
+    if (n > (std::numeric_limits<size_t>::max() - kHeaderSize) / sizeof(T)) {
+      throw std::bad_array_new_length();
+    }
+    const size_t bytes = kHeaderSize + n * sizeof(T);
+    auto memory = static_cast<unsigned char *>(resource_->allocate(bytes, kHeaderSize));
+    *reinterpret_cast<size_t *>(memory) = n * sizeof(T);
+    return reinterpret_cast<T *>(memory + kHeaderSize);
+  }
+
+  void
+  deallocate(T * pointer, size_t n) noexcept
+  {
+    (void)n;
+    if (!pointer) {
+      return;
+    }
+    unsigned char * memory = reinterpret_cast<unsigned char *>(pointer) - kHeaderSize;
+    resource_->deallocate(memory, kHeaderSize + get_size(pointer), kHeaderSize);
+  }
+
+  /// Reallocate the memory keeping its contents, like the rcl allocators do.
+  /**
+   * The contents are copied as bytes, the type must be trivially copyable.
+   */
+  T *
+  reallocate(T * pointer, size_t n)
+  {
+    static_assert(std::is_trivially_copyable_v<T>, "the type must be trivially copyable");
+    T * new_pointer = allocate(n);
+    if (pointer) {
+      const size_t old_size = get_size(pointer);
+      std::memcpy(new_pointer, pointer, std::min(old_size, n * sizeof(T)));
+      deallocate(pointer, 0);
+    }
+    return new_pointer;
+  }
+
+  MemoryResourceAllocator
+  select_on_container_copy_construction() const noexcept
+  {
+    return *this;
+  }
+
+  /// Return the memory resource of the allocator.
+  std::pmr::memory_resource *
+  resource() const noexcept
+  {
+    return resource_;
+  }
+
+private:
+  static constexpr size_t kHeaderSize = alignof(std::max_align_t);
+
+  // Size in bytes of the memory allocated for the user, without the header
+  static size_t
+  get_size(const T * pointer) noexcept
+  {
+    const unsigned char * memory = reinterpret_cast<const unsigned char *>(pointer) - kHeaderSize;
+    return *reinterpret_cast<const size_t *>(memory);
+  }
+
+  std::pmr::memory_resource * resource_;
+};
+
+template<typename T, typename U>
+bool
+operator==(const MemoryResourceAllocator<T> & a, const MemoryResourceAllocator<U> & b) noexcept
+{
+  return a.resource() == b.resource() || a.resource()->is_equal(*b.resource());
+}
+
+template<typename T, typename U>
+bool
+operator!=(const MemoryResourceAllocator<T> & a, const MemoryResourceAllocator<U> & b) noexcept
+{
+  return !(a == b);
+}
+
+/// Kind of memory resource created by create_memory_resource().
+enum class MemoryResourceType
+{
+  /// std::pmr::new_delete_resource(), allocating from the heap.
+  NewDelete,
+  /// std::pmr::synchronized_pool_resource, thread-safe pools of blocks.
+  SynchronizedPool,
+  /// std::pmr::unsynchronized_pool_resource, pools of blocks for a single thread.
+  UnsynchronizedPool,
+  /// std::pmr::monotonic_buffer_resource, releasing the memory only when destroyed.
+  Monotonic,
+  /// rclcpp::allocator::HugePageMemoryResource, backing the large messages with huge pages.
+  HugePage,
+};
+
+/// Options of create_memory_resource().
+struct MemoryResourceOptions
+{
+  MemoryResourceType type = MemoryResourceType::NewDelete;
+  /// Options of the pool memory resources.
+  std::pmr::pool_options pool_options = {};
+  /// Size of the first buffer of the monotonic memory resource, zero for the default.
+  size_t initial_size = 0;
+  /// Options of the huge page memory resource.
+  HugePageMemoryResourceOptions huge_page = {};
+};
+
+/// Return the type of memory resource named by a string, e.g. from a parameter.
+/**
+ * \param[in] name one of "new_delete", "synchronized_pool", "unsynchronized_pool",
+ *   "monotonic" or "huge_page".
+ * \throws std::invalid_argument if the name is unknown.
+ */
+RCLCPP_PUBLIC
+MemoryResourceType
+memory_resource_type_from_string(const std::string & name);
+
+/// Create a memory resource, getting its memory from the heap.
+/**
+ * The unsynchronized pool and monotonic resources aren't thread-safe, they must only be used
+ * by entities whose callbacks and publishing are in the same thread.
+ * The monotonic resource never reuses the memory released by the entities, its memory grows
+ * until it's destroyed.
+ */
+RCLCPP_PUBLIC
+std::shared_ptr<std::pmr::memory_resource>
+create_memory_resource(const MemoryResourceOptions & options = MemoryResourceOptions());
+
+}  // namespace allocator
+}  // namespace rclcpp
+
+#endif  // RCLCPP__ALLOCATOR__MEMORY_RESOURCE_HPP_
@@ -54,6 +54,9 @@ struct can_be_nullptr<T, std::void_t<
 template<typename ServiceT>
 class Service;
 
+template<typename ServiceT>
+class DeferredResponse;
+
 template<typename ServiceT>
 class AnyServiceCallback
 {
@@ -97,6 +100,13 @@ public:
       >::value)
     {
       callback_.template emplace<SharedPtrDeferResponseCallbackWithServiceHandle>(callback);
+    } else if constexpr (  // NOLINT
+      rclcpp::function_traits::same_arguments<
+        CallbackT,
+        SharedPtrDeferredResponseHandleCallback
+      >::value)
+    {
+      callback_.template emplace<SharedPtrDeferredResponseHandleCallback>(callback);
     } else {
       // the else clause is not needed, but anyways we should only be doing this instead
       // of all the above workaround ...
@@ -142,6 +152,13 @@ public:
       >::value)
     {
       callback_.template emplace<SharedPtrDeferResponseCallbackWithServiceHandle>(callback);
+    } else if constexpr (  // NOLINT
+      rclcpp::function_traits::same_arguments<
+        CallbackT,
+        SharedPtrDeferredResponseHandleCallback
+      >::value)
+    {
+      callback_.template emplace<SharedPtrDeferredResponseHandleCallback>(callback);
     } else {
       // the else clause is not needed, but anyways we should only be doing this instead
       // of all the above workaround ...
@@ -172,6 +189,11 @@ public:
       cb(service_handle, request_header, std::move(request));
       return nullptr;
     }
+    if (std::holds_alternative<SharedPtrDeferredResponseHandleCallback>(callback_)) {
+      const auto & cb = std::get<SharedPtrDeferredResponseHandleCallback>(callback_);
+      cb(std::move(request), DeferredResponse<ServiceT>(service_handle, request_header));
+      return nullptr;
+    }
     // auto response = allocate_shared<typename ServiceT::Response, Allocator>();
     auto response = std::make_shared<typename ServiceT::Response>();
     if (std::holds_alternative<SharedPtrCallback>(callback_)) {
@@ -186,6 +208,13 @@ public:
     return response;
   }
 
+  /// Return true if the callback answers the requests through a DeferredResponse.
+  bool
+  has_deferred_response_handle_callback() const
+  {
+    return std::holds_alternative<SharedPtrDeferredResponseHandleCallback>(callback_);
+  }
+
   void register_callback_for_tracing()
   {
 #ifndef TRACETOOLS_DISABLED
@@ -222,13 +251,19 @@ private:
       std::shared_ptr<rmw_request_id_t>,
       std::shared_ptr<typename ServiceT::Request>
     )>;
+  using SharedPtrDeferredResponseHandleCallback = std::function<
+    void (
+      std::shared_ptr<typename ServiceT::Request>,
+      DeferredResponse<ServiceT>
+    )>;
 
   std::variant<
     std::monostate,
     SharedPtrCallback,
     SharedPtrWithRequestHeaderCallback,
     SharedPtrDeferResponseCallback,
-    SharedPtrDeferResponseCallbackWithServiceHandle> callback_;
+    SharedPtrDeferResponseCallbackWithServiceHandle,
+    SharedPtrDeferredResponseHandleCallback> callback_;
 };
 
 }  // namespace rclcpp
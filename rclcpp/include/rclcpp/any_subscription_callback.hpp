@@ -21,6 +21,7 @@
 #include <type_traits>
 #include <utility>
 #include <variant>  // NOLINT[build/include_order]
+#include <vector>
 
 #include "rosidl_runtime_cpp/traits.hpp"
 #include "tracetools/tracetools.h"
@@ -29,8 +30,11 @@
 #include "rclcpp/allocator/allocator_common.hpp"
 #include "rclcpp/detail/subscription_callback_type_helper.hpp"
 #include "rclcpp/function_traits.hpp"
+#include "rclcpp/lazy_deserialized_message.hpp"
+#include "rclcpp/local_message_ptr.hpp"
 #include "rclcpp/message_info.hpp"
 #include "rclcpp/serialized_message.hpp"
+#include "rclcpp/subscription_loaned_message.hpp"
 #include "rclcpp/type_adapter.hpp"
 
 
@@ -137,6 +141,32 @@ struct AnySubscriptionCallbackPossibleTypes
         const std::shared_ptr<const rclcpp::SerializedMessage> &,
         const rclcpp::MessageInfo &)>;
 
+  // Batch signature, all the intra-process messages available are given at once:
+  using SharedConstPtrBatchCallback =
+    std::function<void (const std::vector<std::shared_ptr<const SubscribedType>> &)>;
+
+  // Loaned message signatures, the handle can be kept after the callback:
+  using LoanedMessageCallback =
+    std::function<void (rclcpp::SubscriptionLoanedMessage<ROSMessageType>)>;
+  using LoanedMessageWithInfoCallback =
+    std::function<void (
+        rclcpp::SubscriptionLoanedMessage<ROSMessageType>,
+        const rclcpp::MessageInfo &)>;
+
+  // Lazily deserialized signatures, the message is taken serialized and decoded on demand:
+  using LazyMessageCallback =
+    std::function<void (std::shared_ptr<rclcpp::LazyDeserializedMessage<ROSMessageType>>)>;
+  using LazyMessageWithInfoCallback =
+    std::function<void (
+        std::shared_ptr<rclcpp::LazyDeserializedMessage<ROSMessageType>>,
+        const rclcpp::MessageInfo &)>;
+
+  // Thread-confined signatures, the handles count their references without atomics:
+  using LocalMessageCallback =
+    std::function<void (rclcpp::LocalMessagePtr<ROSMessageType>)>;
+  using LocalMessageWithInfoCallback =
+    std::function<void (rclcpp::LocalMessagePtr<ROSMessageType>, const rclcpp::MessageInfo &)>;
+
   // Deprecated signatures:
   using SharedPtrCallback =
     std::function<void (std::shared_ptr<SubscribedType>)>;
@@ -188,7 +218,14 @@ struct AnySubscriptionCallbackHelper<MessageT, AllocatorT, false>
     typename CallbackTypes::SharedPtrCallback,
     typename CallbackTypes::SharedPtrWithInfoCallback,
     typename CallbackTypes::SharedPtrSerializedMessageCallback,
-    typename CallbackTypes::SharedPtrSerializedMessageWithInfoCallback
+    typename CallbackTypes::SharedPtrSerializedMessageWithInfoCallback,
+    typename CallbackTypes::SharedConstPtrBatchCallback,
+    typename CallbackTypes::LoanedMessageCallback,
+    typename CallbackTypes::LoanedMessageWithInfoCallback,
+    typename CallbackTypes::LazyMessageCallback,
+    typename CallbackTypes::LazyMessageWithInfoCallback,
+    typename CallbackTypes::LocalMessageCallback,
+    typename CallbackTypes::LocalMessageWithInfoCallback
   >;
 };
 
@@ -228,7 +265,14 @@ struct AnySubscriptionCallbackHelper<MessageT, AllocatorT, true>
     typename CallbackTypes::SharedPtrWithInfoCallback,
     typename CallbackTypes::SharedPtrWithInfoROSMessageCallback,
     typename CallbackTypes::SharedPtrSerializedMessageCallback,
-    typename CallbackTypes::SharedPtrSerializedMessageWithInfoCallback
+    typename CallbackTypes::SharedPtrSerializedMessageWithInfoCallback,
+    typename CallbackTypes::SharedConstPtrBatchCallback,
+    typename CallbackTypes::LoanedMessageCallback,
+    typename CallbackTypes::LoanedMessageWithInfoCallback,
+    typename CallbackTypes::LazyMessageCallback,
+    typename CallbackTypes::LazyMessageWithInfoCallback,
+    typename CallbackTypes::LocalMessageCallback,
+    typename CallbackTypes::LocalMessageWithInfoCallback
   >;
 };
 
@@ -329,6 +373,20 @@ private:
     typename CallbackTypes::SharedPtrSerializedMessageCallback;
   using SharedPtrSerializedMessageWithInfoCallback =
     typename CallbackTypes::SharedPtrSerializedMessageWithInfoCallback;
+  using SharedConstPtrBatchCallback =
+    typename CallbackTypes::SharedConstPtrBatchCallback;
+  using LoanedMessageCallback =
+    typename CallbackTypes::LoanedMessageCallback;
+  using LoanedMessageWithInfoCallback =
+    typename CallbackTypes::LoanedMessageWithInfoCallback;
+  using LazyMessageCallback =
+    typename CallbackTypes::LazyMessageCallback;
+  using LazyMessageWithInfoCallback =
+    typename CallbackTypes::LazyMessageWithInfoCallback;
+  using LocalMessageCallback =
+    typename CallbackTypes::LocalMessageCallback;
+  using LocalMessageWithInfoCallback =
+    typename CallbackTypes::LocalMessageWithInfoCallback;
 
   template<typename T>
   struct NotNull
@@ -352,6 +410,7 @@ public:
   {
     allocator::set_allocator_for_deleter(&subscribed_type_deleter_, &subscribed_type_allocator_);
     allocator::set_allocator_for_deleter(&ros_message_type_deleter_, &ros_message_type_allocator_);
+    resolve_dispatchers();
   }
 
   AnySubscriptionCallback(const AnySubscriptionCallback &) = default;
@@ -393,6 +452,8 @@ public:
       // Otherwise just assign it.
       callback_variant_ = static_cast<typename scbth::callback_type>(callback);
     }
+    // Resolved once, so that dispatching doesn't visit the variant for each message
+    resolve_dispatchers();
 
     // Return copy of self for easier testing, normally will be compiled out.
     return *this;
@@ -408,6 +469,7 @@ public:
   set_deprecated(std::function<void(std::shared_ptr<SetT>)> callback)
   {
     callback_variant_ = callback;
+    resolve_dispatchers();
   }
 
   /// Function for shared_ptr to non-const MessageT with MessageInfo, which is deprecated.
@@ -422,6 +484,7 @@ public:
   set_deprecated(std::function<void(std::shared_ptr<SetT>, const rclcpp::MessageInfo &)> callback)
   {
     callback_variant_ = callback;
+    resolve_dispatchers();
   }
 
   std::unique_ptr<ROSMessageType, ROSMessageTypeDeleter>
@@ -456,12 +519,14 @@ public:
   }
 
   std::unique_ptr<SubscribedType, SubscribedTypeDeleter>
-  convert_ros_message_to_custom_type_unique_ptr(const ROSMessageType & msg)
+  convert_ros_message_to_custom_type_unique_ptr(
+    const std::shared_ptr<const ROSMessageType> & msg)
   {
     if constexpr (rclcpp::TypeAdapter<MessageT>::is_specialized::value) {
       auto ptr = SubscribedTypeAllocatorTraits::allocate(subscribed_type_allocator_, 1);
       SubscribedTypeAllocatorTraits::construct(subscribed_type_allocator_, ptr);
-      rclcpp::TypeAdapter<MessageT>::convert_to_custom(msg, *ptr);
+      // A view of the message for the adapters allowing it, which avoids copying its data
+      rclcpp::detail::convert_shared_to_custom<rclcpp::TypeAdapter<MessageT>>(msg, *ptr);
       return std::unique_ptr<SubscribedType, SubscribedTypeDeleter>(ptr, subscribed_type_deleter_);
     } else {
       throw std::runtime_error(
@@ -493,96 +558,7 @@ public:
     const rclcpp::MessageInfo & message_info)
   {
     TRACEPOINT(callback_start, static_cast<const void *>(this), false);
-    // Check if the variant is "unset", throw if it is.
-    if (callback_variant_.index() == 0) {
-      if (std::get<0>(callback_variant_) == nullptr) {
-        // This can happen if it is default initialized, or if it is assigned nullptr.
-        throw std::runtime_error("dispatch called on an unset AnySubscriptionCallback");
-      }
-    }
-    // Dispatch.
-    std::visit(
-      [&message, &message_info, this](auto && callback) {
-        using T = std::decay_t<decltype(callback)>;
-        static constexpr bool is_ta = rclcpp::TypeAdapter<MessageT>::is_specialized::value;
-
-        // conditions for output is custom message
-        if constexpr (is_ta && std::is_same_v<T, ConstRefCallback>) {
-          // TODO(wjwwood): consider avoiding heap allocation for small messages
-          //   maybe something like:
-          // if constexpr (rosidl_generator_traits::has_fixed_size<T> && sizeof(T) < N) {
-          //   ... on stack
-          // }
-          auto local_message = convert_ros_message_to_custom_type_unique_ptr(*message);
-          callback(*local_message);
-        } else if constexpr (is_ta && std::is_same_v<T, ConstRefWithInfoCallback>) {  // NOLINT
-          auto local_message = convert_ros_message_to_custom_type_unique_ptr(*message);
-          callback(*local_message, message_info);
-        } else if constexpr (is_ta && std::is_same_v<T, UniquePtrCallback>) {
-          callback(convert_ros_message_to_custom_type_unique_ptr(*message));
-        } else if constexpr (is_ta && std::is_same_v<T, UniquePtrWithInfoCallback>) {
-          callback(convert_ros_message_to_custom_type_unique_ptr(*message), message_info);
-        } else if constexpr (  // NOLINT[readability/braces]
-          is_ta && (
-            std::is_same_v<T, SharedConstPtrCallback>||
-            std::is_same_v<T, ConstRefSharedConstPtrCallback>||
-            std::is_same_v<T, SharedPtrCallback>
-        ))
-        {
-          callback(convert_ros_message_to_custom_type_unique_ptr(*message));
-        } else if constexpr (  // NOLINT[readability/braces]
-          is_ta && (
-            std::is_same_v<T, SharedConstPtrWithInfoCallback>||
-            std::is_same_v<T, ConstRefSharedConstPtrWithInfoCallback>||
-            std::is_same_v<T, SharedPtrWithInfoCallback>
-        ))
-        {
-          callback(convert_ros_message_to_custom_type_unique_ptr(*message), message_info);
-        }
-        // conditions for output is ros message
-        else if constexpr (std::is_same_v<T, ConstRefROSMessageCallback>) {  // NOLINT
-          callback(*message);
-        } else if constexpr (std::is_same_v<T, ConstRefWithInfoROSMessageCallback>) {
-          callback(*message, message_info);
-        } else if constexpr (std::is_same_v<T, UniquePtrROSMessageCallback>) {
-          callback(create_ros_unique_ptr_from_ros_shared_ptr_message(message));
-        } else if constexpr (std::is_same_v<T, UniquePtrWithInfoROSMessageCallback>) {
-          callback(create_ros_unique_ptr_from_ros_shared_ptr_message(message), message_info);
-        } else if constexpr (  // NOLINT[readability/braces]
-          std::is_same_v<T, SharedConstPtrROSMessageCallback>||
-          std::is_same_v<T, ConstRefSharedConstPtrROSMessageCallback>||
-          std::is_same_v<T, SharedPtrROSMessageCallback>)
-        {
-          callback(message);
-        } else if constexpr (  // NOLINT[readability/braces]
-          std::is_same_v<T, SharedConstPtrWithInfoROSMessageCallback>||
-          std::is_same_v<T, ConstRefSharedConstPtrWithInfoROSMessageCallback>||
-          std::is_same_v<T, SharedPtrWithInfoROSMessageCallback>)
-        {
-          callback(message, message_info);
-        }
-        // condition to catch SerializedMessage types
-        else if constexpr (  // NOLINT[readability/braces]
-          std::is_same_v<T, ConstRefSerializedMessageCallback>||
-          std::is_same_v<T, ConstRefSerializedMessageWithInfoCallback>||
-          std::is_same_v<T, UniquePtrSerializedMessageCallback>||
-          std::is_same_v<T, UniquePtrSerializedMessageWithInfoCallback>||
-          std::is_same_v<T, SharedConstPtrSerializedMessageCallback>||
-          std::is_same_v<T, SharedConstPtrSerializedMessageWithInfoCallback>||
-          std::is_same_v<T, ConstRefSharedConstPtrSerializedMessageCallback>||
-          std::is_same_v<T, ConstRefSharedConstPtrSerializedMessageWithInfoCallback>||
-          std::is_same_v<T, SharedPtrSerializedMessageCallback>||
-          std::is_same_v<T, SharedPtrSerializedMessageWithInfoCallback>)
-        {
-          throw std::runtime_error(
-            "Cannot dispatch std::shared_ptr<ROSMessageType> message "
-            "to rclcpp::SerializedMessage");
-        }
-        // condition to catch unhandled callback types
-        else {  // NOLINT[readability/braces]
-          static_assert(always_false_v<T>, "unhandled callback type");
-        }
-      }, callback_variant_);
+    (this->*get_dispatchers().ros_message)(std::move(message), message_info);
     TRACEPOINT(callback_end, static_cast<const void *>(this));
   }
 
@@ -593,76 +569,7 @@ public:
     const rclcpp::MessageInfo & message_info)
   {
     TRACEPOINT(callback_start, static_cast<const void *>(this), false);
-    // Check if the variant is "unset", throw if it is.
-    if (callback_variant_.index() == 0) {
-      if (std::get<0>(callback_variant_) == nullptr) {
-        // This can happen if it is default initialized, or if it is assigned nullptr.
-        throw std::runtime_error("dispatch called on an unset AnySubscriptionCallback");
-      }
-    }
-    // Dispatch.
-    std::visit(
-      [&serialized_message, &message_info, this](auto && callback) {
-        using T = std::decay_t<decltype(callback)>;
-
-        // condition to catch SerializedMessage types
-        if constexpr (std::is_same_v<T, ConstRefSerializedMessageCallback>) {
-          callback(*serialized_message);
-        } else if constexpr (std::is_same_v<T, ConstRefSerializedMessageWithInfoCallback>) {
-          callback(*serialized_message, message_info);
-        } else if constexpr (std::is_same_v<T, UniquePtrSerializedMessageCallback>) {
-          callback(create_serialized_message_unique_ptr_from_shared_ptr(serialized_message));
-        } else if constexpr (std::is_same_v<T, UniquePtrSerializedMessageWithInfoCallback>) {
-          callback(
-            create_serialized_message_unique_ptr_from_shared_ptr(serialized_message),
-            message_info);
-        } else if constexpr (  // NOLINT[readability/braces]
-          std::is_same_v<T, SharedConstPtrSerializedMessageCallback>||
-          std::is_same_v<T, ConstRefSharedConstPtrSerializedMessageCallback>||
-          std::is_same_v<T, SharedPtrSerializedMessageCallback>)
-        {
-          callback(create_serialized_message_unique_ptr_from_shared_ptr(serialized_message));
-        } else if constexpr (  // NOLINT[readability/braces]
-          std::is_same_v<T, SharedConstPtrSerializedMessageWithInfoCallback>||
-          std::is_same_v<T, ConstRefSharedConstPtrSerializedMessageWithInfoCallback>||
-          std::is_same_v<T, SharedPtrSerializedMessageWithInfoCallback>)
-        {
-          callback(
-            create_serialized_message_unique_ptr_from_shared_ptr(serialized_message),
-            message_info);
-        }
-        // conditions for output anything else
-        else if constexpr (  // NOLINT[whitespace/newline]
-          std::is_same_v<T, ConstRefCallback>||
-          std::is_same_v<T, ConstRefROSMessageCallback>||
-          std::is_same_v<T, ConstRefWithInfoCallback>||
-          std::is_same_v<T, ConstRefWithInfoROSMessageCallback>||
-          std::is_same_v<T, UniquePtrCallback>||
-          std::is_same_v<T, UniquePtrROSMessageCallback>||
-          std::is_same_v<T, UniquePtrWithInfoCallback>||
-          std::is_same_v<T, UniquePtrWithInfoROSMessageCallback>||
-          std::is_same_v<T, SharedConstPtrCallback>||
-          std::is_same_v<T, SharedConstPtrROSMessageCallback>||
-          std::is_same_v<T, SharedConstPtrWithInfoCallback>||
-          std::is_same_v<T, SharedConstPtrWithInfoROSMessageCallback>||
-          std::is_same_v<T, ConstRefSharedConstPtrCallback>||
-          std::is_same_v<T, ConstRefSharedConstPtrROSMessageCallback>||
-          std::is_same_v<T, ConstRefSharedConstPtrWithInfoCallback>||
-          std::is_same_v<T, ConstRefSharedConstPtrWithInfoROSMessageCallback>||
-          std::is_same_v<T, SharedPtrCallback>||
-          std::is_same_v<T, SharedPtrROSMessageCallback>||
-          std::is_same_v<T, SharedPtrWithInfoCallback>||
-          std::is_same_v<T, SharedPtrWithInfoROSMessageCallback>)
-        {
-          throw std::runtime_error(
-            "cannot dispatch rclcpp::SerializedMessage to "
-            "non-rclcpp::SerializedMessage callbacks");
-        }
-        // condition to catch unhandled callback types
-        else {  // NOLINT[readability/braces]
-          static_assert(always_false_v<T>, "unhandled callback type");
-        }
-      }, callback_variant_);
+    (this->*get_dispatchers().serialized_message)(std::move(serialized_message), message_info);
     TRACEPOINT(callback_end, static_cast<const void *>(this));
   }
 
@@ -672,127 +579,7 @@ public:
     const rclcpp::MessageInfo & message_info)
   {
     TRACEPOINT(callback_start, static_cast<const void *>(this), true);
-    // Check if the variant is "unset", throw if it is.
-    if (callback_variant_.index() == 0) {
-      if (std::get<0>(callback_variant_) == nullptr) {
-        // This can happen if it is default initialized, or if it is assigned nullptr.
-        throw std::runtime_error("dispatch called on an unset AnySubscriptionCallback");
-      }
-    }
-    // Dispatch.
-    std::visit(
-      [&message, &message_info, this](auto && callback) {
-        using T = std::decay_t<decltype(callback)>;
-        static constexpr bool is_ta = rclcpp::TypeAdapter<MessageT>::is_specialized::value;
-
-        // conditions for custom type
-        if constexpr (is_ta && std::is_same_v<T, ConstRefCallback>) {
-          callback(*message);
-        } else if constexpr (is_ta && std::is_same_v<T, ConstRefWithInfoCallback>) {  // NOLINT
-          callback(*message, message_info);
-        } else if constexpr (  // NOLINT[readability/braces]
-          is_ta && (
-            std::is_same_v<T, UniquePtrCallback>||
-            std::is_same_v<T, SharedPtrCallback>
-        ))
-        {
-          callback(create_custom_unique_ptr_from_custom_shared_ptr_message(message));
-        } else if constexpr (  // NOLINT[readability/braces]
-          is_ta && (
-            std::is_same_v<T, UniquePtrWithInfoCallback>||
-            std::is_same_v<T, SharedPtrWithInfoCallback>
-        ))
-        {
-          callback(create_custom_unique_ptr_from_custom_shared_ptr_message(message), message_info);
-        } else if constexpr (  // NOLINT[readability/braces]
-          is_ta && (
-            std::is_same_v<T, SharedConstPtrCallback>||
-            std::is_same_v<T, ConstRefSharedConstPtrCallback>
-        ))
-        {
-          callback(message);
-        } else if constexpr (  // NOLINT[readability/braces]
-          is_ta && (
-            std::is_same_v<T, SharedConstPtrWithInfoCallback>||
-            std::is_same_v<T, ConstRefSharedConstPtrWithInfoCallback>
-        ))
-        {
-          callback(message, message_info);
-        }
-        // conditions for ros message type
-        else if constexpr (std::is_same_v<T, ConstRefROSMessageCallback>) {  // NOLINT[readability/braces]
-          if constexpr (is_ta) {
-            auto local = convert_custom_type_to_ros_message_unique_ptr(*message);
-            callback(*local);
-          } else {
-            callback(*message);
-          }
-        } else if constexpr (std::is_same_v<T, ConstRefWithInfoROSMessageCallback>) {  // NOLINT[readability/braces]
-          if constexpr (is_ta) {
-            auto local = convert_custom_type_to_ros_message_unique_ptr(*message);
-            callback(*local, message_info);
-          } else {
-            callback(*message, message_info);
-          }
-        } else if constexpr (  // NOLINT[readability/braces]
-          std::is_same_v<T, UniquePtrROSMessageCallback>||
-          std::is_same_v<T, SharedPtrROSMessageCallback>)
-        {
-          if constexpr (is_ta) {
-            callback(convert_custom_type_to_ros_message_unique_ptr(*message));
-          } else {
-            callback(create_ros_unique_ptr_from_ros_shared_ptr_message(message));
-          }
-        } else if constexpr (  // NOLINT[readability/braces]
-          std::is_same_v<T, UniquePtrWithInfoROSMessageCallback>||
-          std::is_same_v<T, SharedPtrWithInfoROSMessageCallback>)
-        {
-          if constexpr (is_ta) {
-            callback(convert_custom_type_to_ros_message_unique_ptr(*message), message_info);
-          } else {
-            callback(create_ros_unique_ptr_from_ros_shared_ptr_message(message), message_info);
-          }
-        } else if constexpr (  // NOLINT[readability/braces]
-          std::is_same_v<T, SharedConstPtrROSMessageCallback>||
-          std::is_same_v<T, ConstRefSharedConstPtrROSMessageCallback>)
-        {
-          if constexpr (is_ta) {
-            callback(convert_custom_type_to_ros_message_unique_ptr(*message));
-          } else {
-            callback(message);
-          }
-        } else if constexpr (  // NOLINT[readability/braces]
-          std::is_same_v<T, SharedConstPtrWithInfoROSMessageCallback>||
-          std::is_same_v<T, ConstRefSharedConstPtrWithInfoROSMessageCallback>)
-        {
-          if constexpr (is_ta) {
-            callback(convert_custom_type_to_ros_message_unique_ptr(*message), message_info);
-          } else {
-            callback(message, message_info);
-          }
-        }
-        // condition to catch SerializedMessage types
-        else if constexpr (  // NOLINT[readability/braces]
-          std::is_same_v<T, ConstRefSerializedMessageCallback>||
-          std::is_same_v<T, ConstRefSerializedMessageWithInfoCallback>||
-          std::is_same_v<T, UniquePtrSerializedMessageCallback>||
-          std::is_same_v<T, UniquePtrSerializedMessageWithInfoCallback>||
-          std::is_same_v<T, SharedConstPtrSerializedMessageCallback>||
-          std::is_same_v<T, SharedConstPtrSerializedMessageWithInfoCallback>||
-          std::is_same_v<T, ConstRefSharedConstPtrSerializedMessageCallback>||
-          std::is_same_v<T, ConstRefSharedConstPtrSerializedMessageWithInfoCallback>||
-          std::is_same_v<T, SharedPtrSerializedMessageCallback>||
-          std::is_same_v<T, SharedPtrSerializedMessageWithInfoCallback>)
-        {
-          throw std::runtime_error(
-            "Cannot dispatch std::shared_ptr<const ROSMessageType> message "
-            "to rclcpp::SerializedMessage");
-        }
-        // condition to catch unhandled callback types
-        else {  // NOLINT[readability/braces]
-          static_assert(always_false_v<T>, "unhandled callback type");
-        }
-      }, callback_variant_);
+    (this->*get_dispatchers().intra_process_shared)(std::move(message), message_info);
     TRACEPOINT(callback_end, static_cast<const void *>(this));
   }
 
@@ -802,131 +589,45 @@ public:
     const rclcpp::MessageInfo & message_info)
   {
     TRACEPOINT(callback_start, static_cast<const void *>(this), true);
-    // Check if the variant is "unset", throw if it is.
-    if (callback_variant_.index() == 0) {
-      if (std::get<0>(callback_variant_) == nullptr) {
-        // This can happen if it is default initialized, or if it is assigned nullptr.
-        throw std::runtime_error("dispatch called on an unset AnySubscriptionCallback");
-      }
+    (this->*get_dispatchers().intra_process_unique)(std::move(message), message_info);
+    TRACEPOINT(callback_end, static_cast<const void *>(this));
+  }
+
+  /// Dispatch messages taken from the intra-process buffer to the batch callback.
+  /**
+   * \throws std::runtime_error if the callback isn't a batch callback.
+   */
+  void
+  dispatch_intra_process_batch(
+    const std::vector<std::shared_ptr<const SubscribedType>> & messages)
+  {
+    TRACEPOINT(callback_start, static_cast<const void *>(this), true);
+    auto callback = std::get_if<SharedConstPtrBatchCallback>(&callback_variant_);
+    if (callback == nullptr) {
+      throw std::runtime_error("dispatch_intra_process_batch called without a batch callback");
+    }
+    (*callback)(messages);
+    TRACEPOINT(callback_end, static_cast<const void *>(this));
+  }
+
+  /// Dispatch a message loaned by the middleware to the loaned message callback.
+  /**
+   * \throws std::runtime_error if the callback isn't a loaned message callback.
+   */
+  void
+  dispatch_loaned_message(
+    rclcpp::SubscriptionLoanedMessage<ROSMessageType> message,
+    const rclcpp::MessageInfo & message_info)
+  {
+    TRACEPOINT(callback_start, static_cast<const void *>(this), false);
+    if (auto callback = std::get_if<LoanedMessageCallback>(&callback_variant_)) {
+      (*callback)(std::move(message));
+    } else if (auto callback = std::get_if<LoanedMessageWithInfoCallback>(&callback_variant_)) {
+      (*callback)(std::move(message), message_info);
+    } else {
+      throw std::runtime_error(
+              "dispatch_loaned_message called without a loaned message callback");
     }
-    // Dispatch.
-    std::visit(
-      [&message, &message_info, this](auto && callback) {
-        // clang complains that 'this' lambda capture is unused, which is true
-        // in *some* specializations of this template, but not others.  Just
-        // quiet it down.
-        (void)this;
-
-        using T = std::decay_t<decltype(callback)>;
-        static constexpr bool is_ta = rclcpp::TypeAdapter<MessageT>::is_specialized::value;
-
-        // conditions for custom type
-        if constexpr (is_ta && std::is_same_v<T, ConstRefCallback>) {
-          callback(*message);
-        } else if constexpr (is_ta && std::is_same_v<T, ConstRefWithInfoCallback>) {  // NOLINT
-          callback(*message, message_info);
-        } else if constexpr (  // NOLINT[readability/braces]
-          is_ta && (
-            std::is_same_v<T, UniquePtrCallback>||
-            std::is_same_v<T, SharedPtrCallback>))
-        {
-          callback(std::move(message));
-        } else if constexpr (  // NOLINT[readability/braces]
-          is_ta && (
-            std::is_same_v<T, UniquePtrWithInfoCallback>||
-            std::is_same_v<T, SharedPtrWithInfoCallback>
-        ))
-        {
-          callback(std::move(message), message_info);
-        } else if constexpr (  // NOLINT[readability/braces]
-          is_ta && (
-            std::is_same_v<T, SharedConstPtrCallback>||
-            std::is_same_v<T, ConstRefSharedConstPtrCallback>
-        ))
-        {
-          callback(std::move(message));
-        } else if constexpr (  // NOLINT[readability/braces]
-          is_ta && (
-            std::is_same_v<T, SharedConstPtrWithInfoCallback>||
-            std::is_same_v<T, ConstRefSharedConstPtrWithInfoCallback>
-        ))
-        {
-          callback(std::move(message), message_info);
-        }
-        // conditions for ros message type
-        else if constexpr (std::is_same_v<T, ConstRefROSMessageCallback>) {  // NOLINT[readability/braces]
-          if constexpr (is_ta) {
-            auto local = convert_custom_type_to_ros_message_unique_ptr(*message);
-            callback(*local);
-          } else {
-            callback(*message);
-          }
-        } else if constexpr (std::is_same_v<T, ConstRefWithInfoROSMessageCallback>) {  // NOLINT[readability/braces]
-          if constexpr (is_ta) {
-            auto local = convert_custom_type_to_ros_message_unique_ptr(*message);
-            callback(*local, message_info);
-          } else {
-            callback(*message, message_info);
-          }
-        } else if constexpr (  // NOLINT[readability/braces]
-          std::is_same_v<T, UniquePtrROSMessageCallback>||
-          std::is_same_v<T, SharedPtrROSMessageCallback>)
-        {
-          if constexpr (is_ta) {
-            callback(convert_custom_type_to_ros_message_unique_ptr(*message));
-          } else {
-            callback(std::move(message));
-          }
-        } else if constexpr (  // NOLINT[readability/braces]
-          std::is_same_v<T, UniquePtrWithInfoROSMessageCallback>||
-          std::is_same_v<T, SharedPtrWithInfoROSMessageCallback>)
-        {
-          if constexpr (is_ta) {
-            callback(convert_custom_type_to_ros_message_unique_ptr(*message), message_info);
-          } else {
-            callback(std::move(message), message_info);
-          }
-        } else if constexpr (  // NOLINT[readability/braces]
-          std::is_same_v<T, SharedConstPtrROSMessageCallback>||
-          std::is_same_v<T, ConstRefSharedConstPtrROSMessageCallback>)
-        {
-          if constexpr (is_ta) {
-            callback(convert_custom_type_to_ros_message_unique_ptr(*message));
-          } else {
-            callback(std::move(message));
-          }
-        } else if constexpr (  // NOLINT[readability/braces]
-          std::is_same_v<T, SharedConstPtrWithInfoROSMessageCallback>||
-          std::is_same_v<T, ConstRefSharedConstPtrWithInfoROSMessageCallback>)
-        {
-          if constexpr (is_ta) {
-            callback(convert_custom_type_to_ros_message_unique_ptr(*message), message_info);
-          } else {
-            callback(std::move(message), message_info);
-          }
-        }
-        // condition to catch SerializedMessage types
-        else if constexpr (  // NOLINT[readability/braces]
-          std::is_same_v<T, ConstRefSerializedMessageCallback>||
-          std::is_same_v<T, ConstRefSerializedMessageWithInfoCallback>||
-          std::is_same_v<T, UniquePtrSerializedMessageCallback>||
-          std::is_same_v<T, UniquePtrSerializedMessageWithInfoCallback>||
-          std::is_same_v<T, SharedConstPtrSerializedMessageCallback>||
-          std::is_same_v<T, SharedConstPtrSerializedMessageWithInfoCallback>||
-          std::is_same_v<T, ConstRefSharedConstPtrSerializedMessageCallback>||
-          std::is_same_v<T, ConstRefSharedConstPtrSerializedMessageWithInfoCallback>||
-          std::is_same_v<T, SharedPtrSerializedMessageCallback>||
-          std::is_same_v<T, SharedPtrSerializedMessageWithInfoCallback>)
-        {
-          throw std::runtime_error(
-            "Cannot dispatch std::unique_ptr<ROSMessageType, ROSMessageTypeDeleter> message "
-            "to rclcpp::SerializedMessage");
-        }
-        // condition to catch unhandled callback types
-        else {  // NOLINT[readability/braces]
-          static_assert(always_false_v<T>, "unhandled callback type");
-        }
-      }, callback_variant_);
     TRACEPOINT(callback_end, static_cast<const void *>(this));
   }
 
@@ -938,7 +639,45 @@ public:
       std::holds_alternative<SharedConstPtrCallback>(callback_variant_) ||
       std::holds_alternative<SharedConstPtrWithInfoCallback>(callback_variant_) ||
       std::holds_alternative<ConstRefSharedConstPtrCallback>(callback_variant_) ||
-      std::holds_alternative<ConstRefSharedConstPtrWithInfoCallback>(callback_variant_);
+      std::holds_alternative<ConstRefSharedConstPtrWithInfoCallback>(callback_variant_) ||
+      std::holds_alternative<SharedConstPtrBatchCallback>(callback_variant_) ||
+      is_loaned_message_callback() ||
+      is_lazy_message_callback() ||
+      is_local_message_callback();
+  }
+
+  constexpr
+  bool
+  is_batch_callback() const
+  {
+    return std::holds_alternative<SharedConstPtrBatchCallback>(callback_variant_);
+  }
+
+  constexpr
+  bool
+  is_loaned_message_callback() const
+  {
+    return
+      std::holds_alternative<LoanedMessageCallback>(callback_variant_) ||
+      std::holds_alternative<LoanedMessageWithInfoCallback>(callback_variant_);
+  }
+
+  constexpr
+  bool
+  is_lazy_message_callback() const
+  {
+    return
+      std::holds_alternative<LazyMessageCallback>(callback_variant_) ||
+      std::holds_alternative<LazyMessageWithInfoCallback>(callback_variant_);
+  }
+
+  constexpr
+  bool
+  is_local_message_callback() const
+  {
+    return
+      std::holds_alternative<LocalMessageCallback>(callback_variant_) ||
+      std::holds_alternative<LocalMessageWithInfoCallback>(callback_variant_);
   }
 
   constexpr
@@ -956,7 +695,21 @@ public:
       std::holds_alternative<SharedConstPtrSerializedMessageWithInfoCallback>(callback_variant_) ||
       std::holds_alternative<ConstRefSharedConstPtrSerializedMessageWithInfoCallback>(
       callback_variant_) ||
-      std::holds_alternative<SharedPtrSerializedMessageWithInfoCallback>(callback_variant_);
+      std::holds_alternative<SharedPtrSerializedMessageWithInfoCallback>(callback_variant_) ||
+      // the lazily deserialized messages are taken serialized
+      is_lazy_message_callback();
+  }
+
+  /// Return true if the callback takes the rclcpp::MessageInfo of the messages.
+  bool
+  uses_message_info() const
+  {
+    return std::visit(
+      [](const auto & callback) {
+        using CallbackT = std::decay_t<decltype(callback)>;
+        // The callbacks with a second argument take the rclcpp::MessageInfo
+        return rclcpp::function_traits::function_traits<CallbackT>::arity == 2;
+      }, callback_variant_);
   }
 
   void
@@ -986,11 +739,693 @@ public:
   }
 
 private:
+  template<typename CallbackT>
+  void
+  dispatch_ros_message_to(
+    CallbackT & callback,
+    std::shared_ptr<ROSMessageType> message,
+    const rclcpp::MessageInfo & message_info)
+  {
+    using T = std::decay_t<decltype(callback)>;
+    static constexpr bool is_ta = rclcpp::TypeAdapter<MessageT>::is_specialized::value;
+
+    // conditions for output is custom message
+    if constexpr (is_ta && std::is_same_v<T, ConstRefCallback>) {
+      // TODO(wjwwood): consider avoiding heap allocation for small messages
+      //   maybe something like:
+      // if constexpr (rosidl_generator_traits::has_fixed_size<T> && sizeof(T) < N) {
+      //   ... on stack
+      // }
+      auto local_message = convert_ros_message_to_custom_type_unique_ptr(message);
+      callback(*local_message);
+    } else if constexpr (is_ta && std::is_same_v<T, ConstRefWithInfoCallback>) {  // NOLINT
+      auto local_message = convert_ros_message_to_custom_type_unique_ptr(message);
+      callback(*local_message, message_info);
+    } else if constexpr (is_ta && std::is_same_v<T, UniquePtrCallback>) {
+      callback(convert_ros_message_to_custom_type_unique_ptr(message));
+    } else if constexpr (is_ta && std::is_same_v<T, UniquePtrWithInfoCallback>) {
+      callback(convert_ros_message_to_custom_type_unique_ptr(message), message_info);
+    } else if constexpr (  // NOLINT[readability/braces]
+      is_ta && (
+        std::is_same_v<T, SharedConstPtrCallback>||
+        std::is_same_v<T, ConstRefSharedConstPtrCallback>||
+        std::is_same_v<T, SharedPtrCallback>
+    ))
+    {
+      callback(convert_ros_message_to_custom_type_unique_ptr(message));
+    } else if constexpr (  // NOLINT[readability/braces]
+      is_ta && (
+        std::is_same_v<T, SharedConstPtrWithInfoCallback>||
+        std::is_same_v<T, ConstRefSharedConstPtrWithInfoCallback>||
+        std::is_same_v<T, SharedPtrWithInfoCallback>
+    ))
+    {
+      callback(convert_ros_message_to_custom_type_unique_ptr(message), message_info);
+    }
+    // conditions for output is ros message
+    else if constexpr (std::is_same_v<T, ConstRefROSMessageCallback>) {  // NOLINT
+      callback(*message);
+    } else if constexpr (std::is_same_v<T, ConstRefWithInfoROSMessageCallback>) {
+      callback(*message, message_info);
+    } else if constexpr (std::is_same_v<T, UniquePtrROSMessageCallback>) {
+      callback(create_ros_unique_ptr_from_ros_shared_ptr_message(message));
+    } else if constexpr (std::is_same_v<T, UniquePtrWithInfoROSMessageCallback>) {
+      callback(create_ros_unique_ptr_from_ros_shared_ptr_message(message), message_info);
+    } else if constexpr (  // NOLINT[readability/braces]
+      std::is_same_v<T, SharedConstPtrROSMessageCallback>||
+      std::is_same_v<T, ConstRefSharedConstPtrROSMessageCallback>||
+      std::is_same_v<T, SharedPtrROSMessageCallback>)
+    {
+      callback(message);
+    } else if constexpr (  // NOLINT[readability/braces]
+      std::is_same_v<T, SharedConstPtrWithInfoROSMessageCallback>||
+      std::is_same_v<T, ConstRefSharedConstPtrWithInfoROSMessageCallback>||
+      std::is_same_v<T, SharedPtrWithInfoROSMessageCallback>)
+    {
+      callback(message, message_info);
+    }
+    // condition for a batch of one message
+    else if constexpr (std::is_same_v<T, SharedConstPtrBatchCallback>) {  // NOLINT
+      if constexpr (is_ta) {
+        callback({convert_ros_message_to_custom_type_unique_ptr(message)});
+      } else {
+        callback({message});
+      }
+    }
+    // conditions for a message taken without a loan
+    else if constexpr (std::is_same_v<T, LoanedMessageCallback>) {  // NOLINT
+      callback(rclcpp::SubscriptionLoanedMessage<ROSMessageType>(std::move(message)));
+    } else if constexpr (std::is_same_v<T, LoanedMessageWithInfoCallback>) {
+      callback(
+        rclcpp::SubscriptionLoanedMessage<ROSMessageType>(std::move(message)), message_info);
+    }
+    // conditions for a message which is already deserialized
+    else if constexpr (std::is_same_v<T, LazyMessageCallback>) {  // NOLINT
+      callback(
+        std::make_shared<rclcpp::LazyDeserializedMessage<ROSMessageType>>(
+          std::shared_ptr<const ROSMessageType>(std::move(message))));
+    } else if constexpr (std::is_same_v<T, LazyMessageWithInfoCallback>) {
+      callback(
+        std::make_shared<rclcpp::LazyDeserializedMessage<ROSMessageType>>(
+          std::shared_ptr<const ROSMessageType>(std::move(message))),
+        message_info);
+    }
+    // conditions for a thread-confined message
+    else if constexpr (std::is_same_v<T, LocalMessageCallback>) {  // NOLINT
+      callback(
+        rclcpp::LocalMessagePtr<ROSMessageType>(
+          std::shared_ptr<const ROSMessageType>(std::move(message))));
+    } else if constexpr (std::is_same_v<T, LocalMessageWithInfoCallback>) {
+      callback(
+        rclcpp::LocalMessagePtr<ROSMessageType>(
+          std::shared_ptr<const ROSMessageType>(std::move(message))),
+        message_info);
+    }
+    // condition to catch SerializedMessage types
+    else if constexpr (  // NOLINT[readability/braces]
+      std::is_same_v<T, ConstRefSerializedMessageCallback>||
+      std::is_same_v<T, ConstRefSerializedMessageWithInfoCallback>||
+      std::is_same_v<T, UniquePtrSerializedMessageCallback>||
+      std::is_same_v<T, UniquePtrSerializedMessageWithInfoCallback>||
+      std::is_same_v<T, SharedConstPtrSerializedMessageCallback>||
+      std::is_same_v<T, SharedConstPtrSerializedMessageWithInfoCallback>||
+      std::is_same_v<T, ConstRefSharedConstPtrSerializedMessageCallback>||
+      std::is_same_v<T, ConstRefSharedConstPtrSerializedMessageWithInfoCallback>||
+      std::is_same_v<T, SharedPtrSerializedMessageCallback>||
+      std::is_same_v<T, SharedPtrSerializedMessageWithInfoCallback>)
+    {
+      throw std::runtime_error(
+        "Cannot dispatch std::shared_ptr<ROSMessageType> message "
+        "to rclcpp::SerializedMessage");
+    }
+    // condition to catch unhandled callback types
+    else {  // NOLINT[readability/braces]
+      static_assert(always_false_v<T>, "unhandled callback type");
+    }
+  }
+
+  template<typename CallbackT>
+  void
+  dispatch_serialized_message_to(
+    CallbackT & callback,
+    std::shared_ptr<rclcpp::SerializedMessage> serialized_message,
+    const rclcpp::MessageInfo & message_info)
+  {
+    using T = std::decay_t<decltype(callback)>;
+
+    // condition to catch SerializedMessage types
+    if constexpr (std::is_same_v<T, ConstRefSerializedMessageCallback>) {
+      callback(*serialized_message);
+    } else if constexpr (std::is_same_v<T, ConstRefSerializedMessageWithInfoCallback>) {
+      callback(*serialized_message, message_info);
+    } else if constexpr (std::is_same_v<T, UniquePtrSerializedMessageCallback>) {
+      callback(create_serialized_message_unique_ptr_from_shared_ptr(serialized_message));
+    } else if constexpr (std::is_same_v<T, UniquePtrSerializedMessageWithInfoCallback>) {
+      callback(
+        create_serialized_message_unique_ptr_from_shared_ptr(serialized_message),
+        message_info);
+    } else if constexpr (  // NOLINT[readability/braces]
+      std::is_same_v<T, SharedConstPtrSerializedMessageCallback>||
+      std::is_same_v<T, ConstRefSharedConstPtrSerializedMessageCallback>||
+      std::is_same_v<T, SharedPtrSerializedMessageCallback>)
+    {
+      callback(create_serialized_message_unique_ptr_from_shared_ptr(serialized_message));
+    } else if constexpr (  // NOLINT[readability/braces]
+      std::is_same_v<T, SharedConstPtrSerializedMessageWithInfoCallback>||
+      std::is_same_v<T, ConstRefSharedConstPtrSerializedMessageWithInfoCallback>||
+      std::is_same_v<T, SharedPtrSerializedMessageWithInfoCallback>)
+    {
+      callback(
+        create_serialized_message_unique_ptr_from_shared_ptr(serialized_message),
+        message_info);
+    }
+    // conditions for a message deserialized on demand
+    else if constexpr (std::is_same_v<T, LazyMessageCallback>) {  // NOLINT
+      callback(
+        std::make_shared<rclcpp::LazyDeserializedMessage<ROSMessageType>>(
+          std::move(serialized_message)));
+    } else if constexpr (std::is_same_v<T, LazyMessageWithInfoCallback>) {
+      callback(
+        std::make_shared<rclcpp::LazyDeserializedMessage<ROSMessageType>>(
+          std::move(serialized_message)),
+        message_info);
+    }
+    // conditions for output anything else
+    else if constexpr (  // NOLINT[whitespace/newline]
+      std::is_same_v<T, ConstRefCallback>||
+      std::is_same_v<T, ConstRefROSMessageCallback>||
+      std::is_same_v<T, ConstRefWithInfoCallback>||
+      std::is_same_v<T, ConstRefWithInfoROSMessageCallback>||
+      std::is_same_v<T, UniquePtrCallback>||
+      std::is_same_v<T, UniquePtrROSMessageCallback>||
+      std::is_same_v<T, UniquePtrWithInfoCallback>||
+      std::is_same_v<T, UniquePtrWithInfoROSMessageCallback>||
+      std::is_same_v<T, SharedConstPtrCallback>||
+      std::is_same_v<T, SharedConstPtrROSMessageCallback>||
+      std::is_same_v<T, SharedConstPtrWithInfoCallback>||
+      std::is_same_v<T, SharedConstPtrWithInfoROSMessageCallback>||
+      std::is_same_v<T, ConstRefSharedConstPtrCallback>||
+      std::is_same_v<T, ConstRefSharedConstPtrROSMessageCallback>||
+      std::is_same_v<T, ConstRefSharedConstPtrWithInfoCallback>||
+      std::is_same_v<T, ConstRefSharedConstPtrWithInfoROSMessageCallback>||
+      std::is_same_v<T, SharedPtrCallback>||
+      std::is_same_v<T, SharedPtrROSMessageCallback>||
+      std::is_same_v<T, SharedPtrWithInfoCallback>||
+      std::is_same_v<T, SharedPtrWithInfoROSMessageCallback>||
+      std::is_same_v<T, SharedConstPtrBatchCallback>||
+      std::is_same_v<T, LoanedMessageCallback>||
+      std::is_same_v<T, LoanedMessageWithInfoCallback>||
+      std::is_same_v<T, LocalMessageCallback>||
+      std::is_same_v<T, LocalMessageWithInfoCallback>)
+    {
+      throw std::runtime_error(
+        "cannot dispatch rclcpp::SerializedMessage to "
+        "non-rclcpp::SerializedMessage callbacks");
+    }
+    // condition to catch unhandled callback types
+    else {  // NOLINT[readability/braces]
+      static_assert(always_false_v<T>, "unhandled callback type");
+    }
+  }
+
+  template<typename CallbackT>
+  void
+  dispatch_intra_process_shared_to(
+    CallbackT & callback,
+    std::shared_ptr<const SubscribedType> message,
+    const rclcpp::MessageInfo & message_info)
+  {
+    using T = std::decay_t<decltype(callback)>;
+    static constexpr bool is_ta = rclcpp::TypeAdapter<MessageT>::is_specialized::value;
+
+    // conditions for custom type
+    if constexpr (is_ta && std::is_same_v<T, ConstRefCallback>) {
+      callback(*message);
+    } else if constexpr (is_ta && std::is_same_v<T, ConstRefWithInfoCallback>) {  // NOLINT
+      callback(*message, message_info);
+    } else if constexpr (  // NOLINT[readability/braces]
+      is_ta && (
+        std::is_same_v<T, UniquePtrCallback>||
+        std::is_same_v<T, SharedPtrCallback>
+    ))
+    {
+      callback(create_custom_unique_ptr_from_custom_shared_ptr_message(message));
+    } else if constexpr (  // NOLINT[readability/braces]
+      is_ta && (
+        std::is_same_v<T, UniquePtrWithInfoCallback>||
+        std::is_same_v<T, SharedPtrWithInfoCallback>
+    ))
+    {
+      callback(create_custom_unique_ptr_from_custom_shared_ptr_message(message), message_info);
+    } else if constexpr (  // NOLINT[readability/braces]
+      is_ta && (
+        std::is_same_v<T, SharedConstPtrCallback>||
+        std::is_same_v<T, ConstRefSharedConstPtrCallback>
+    ))
+    {
+      callback(message);
+    } else if constexpr (  // NOLINT[readability/braces]
+      is_ta && (
+        std::is_same_v<T, SharedConstPtrWithInfoCallback>||
+        std::is_same_v<T, ConstRefSharedConstPtrWithInfoCallback>
+    ))
+    {
+      callback(message, message_info);
+    }
+    // conditions for ros message type
+    else if constexpr (std::is_same_v<T, ConstRefROSMessageCallback>) {  // NOLINT[readability/braces]
+      if constexpr (is_ta) {
+        auto local = convert_custom_type_to_ros_message_unique_ptr(*message);
+        callback(*local);
+      } else {
+        callback(*message);
+      }
+    } else if constexpr (std::is_same_v<T, ConstRefWithInfoROSMessageCallback>) {  // NOLINT[readability/braces]
+      if constexpr (is_ta) {
+        auto local = convert_custom_type_to_ros_message_unique_ptr(*message);
+        callback(*local, message_info);
+      } else {
+        callback(*message, message_info);
+      }
+    } else if constexpr (  // NOLINT[readability/braces]
+      std::is_same_v<T, UniquePtrROSMessageCallback>||
+      std::is_same_v<T, SharedPtrROSMessageCallback>)
+    {
+      if constexpr (is_ta) {
+        callback(convert_custom_type_to_ros_message_unique_ptr(*message));
+      } else {
+        callback(create_ros_unique_ptr_from_ros_shared_ptr_message(message));
+      }
+    } else if constexpr (  // NOLINT[readability/braces]
+      std::is_same_v<T, UniquePtrWithInfoROSMessageCallback>||
+      std::is_same_v<T, SharedPtrWithInfoROSMessageCallback>)
+    {
+      if constexpr (is_ta) {
+        callback(convert_custom_type_to_ros_message_unique_ptr(*message), message_info);
+      } else {
+        callback(create_ros_unique_ptr_from_ros_shared_ptr_message(message), message_info);
+      }
+    } else if constexpr (  // NOLINT[readability/braces]
+      std::is_same_v<T, SharedConstPtrROSMessageCallback>||
+      std::is_same_v<T, ConstRefSharedConstPtrROSMessageCallback>)
+    {
+      if constexpr (is_ta) {
+        callback(convert_custom_type_to_ros_message_unique_ptr(*message));
+      } else {
+        callback(message);
+      }
+    } else if constexpr (  // NOLINT[readability/braces]
+      std::is_same_v<T, SharedConstPtrWithInfoROSMessageCallback>||
+      std::is_same_v<T, ConstRefSharedConstPtrWithInfoROSMessageCallback>)
+    {
+      if constexpr (is_ta) {
+        callback(convert_custom_type_to_ros_message_unique_ptr(*message), message_info);
+      } else {
+        callback(message, message_info);
+      }
+    }
+    // condition for a batch of one message
+    else if constexpr (std::is_same_v<T, SharedConstPtrBatchCallback>) {  // NOLINT
+      callback({message});
+    }
+    // conditions for an intra-process message, shared without a loan
+    else if constexpr (  // NOLINT[readability/braces]
+      std::is_same_v<T, LoanedMessageCallback>||
+      std::is_same_v<T, LoanedMessageWithInfoCallback>)
+    {
+      std::shared_ptr<const ROSMessageType> ros_message;
+      if constexpr (is_ta) {
+        ros_message = convert_custom_type_to_ros_message_unique_ptr(*message);
+      } else {
+        ros_message = message;
+      }
+      rclcpp::SubscriptionLoanedMessage<ROSMessageType> handle(std::move(ros_message));
+      if constexpr (std::is_same_v<T, LoanedMessageCallback>) {
+        callback(std::move(handle));
+      } else {
+        callback(std::move(handle), message_info);
+      }
+    }
+    // conditions for an intra-process message, which is already deserialized
+    else if constexpr (  // NOLINT[readability/braces]
+      std::is_same_v<T, LazyMessageCallback>||
+      std::is_same_v<T, LazyMessageWithInfoCallback>)
+    {
+      std::shared_ptr<const ROSMessageType> ros_message;
+      if constexpr (is_ta) {
+        ros_message = convert_custom_type_to_ros_message_unique_ptr(*message);
+      } else {
+        ros_message = std::move(message);
+      }
+      auto lazy_message =
+        std::make_shared<rclcpp::LazyDeserializedMessage<ROSMessageType>>(std::move(ros_message));
+      if constexpr (std::is_same_v<T, LazyMessageCallback>) {
+        callback(std::move(lazy_message));
+      } else {
+        callback(std::move(lazy_message), message_info);
+      }
+    }
+    // conditions for an intra-process message, shared with a thread-confined handle
+    else if constexpr (  // NOLINT[readability/braces]
+      std::is_same_v<T, LocalMessageCallback>||
+      std::is_same_v<T, LocalMessageWithInfoCallback>)
+    {
+      std::shared_ptr<const ROSMessageType> ros_message;
+      if constexpr (is_ta) {
+        ros_message = convert_custom_type_to_ros_message_unique_ptr(*message);
+      } else {
+        ros_message = std::move(message);
+      }
+      rclcpp::LocalMessagePtr<ROSMessageType> handle(std::move(ros_message));
+      if constexpr (std::is_same_v<T, LocalMessageCallback>) {
+        callback(std::move(handle));
+      } else {
+        callback(std::move(handle), message_info);
+      }
+    }
+    // condition to catch SerializedMessage types
+    else if constexpr (  // NOLINT[readability/braces]
+      std::is_same_v<T, ConstRefSerializedMessageCallback>||
+      std::is_same_v<T, ConstRefSerializedMessageWithInfoCallback>||
+      std::is_same_v<T, UniquePtrSerializedMessageCallback>||
+      std::is_same_v<T, UniquePtrSerializedMessageWithInfoCallback>||
+      std::is_same_v<T, SharedConstPtrSerializedMessageCallback>||
+      std::is_same_v<T, SharedConstPtrSerializedMessageWithInfoCallback>||
+      std::is_same_v<T, ConstRefSharedConstPtrSerializedMessageCallback>||
+      std::is_same_v<T, ConstRefSharedConstPtrSerializedMessageWithInfoCallback>||
+      std::is_same_v<T, SharedPtrSerializedMessageCallback>||
+      std::is_same_v<T, SharedPtrSerializedMessageWithInfoCallback>)
+    {
+      throw std::runtime_error(
+        "Cannot dispatch std::shared_ptr<const ROSMessageType> message "
+        "to rclcpp::SerializedMessage");
+    }
+    // condition to catch unhandled callback types
+    else {  // NOLINT[readability/braces]
+      static_assert(always_false_v<T>, "unhandled callback type");
+    }
+  }
+
+  template<typename CallbackT>
+  void
+  dispatch_intra_process_unique_to(
+    CallbackT & callback,
+    std::unique_ptr<SubscribedType, SubscribedTypeDeleter> message,
+    const rclcpp::MessageInfo & message_info)
+  {
+    // clang complains that 'this' lambda capture is unused, which is true
+    // in *some* specializations of this template, but not others.  Just
+    // quiet it down.
+    (void)this;
+
+    using T = std::decay_t<decltype(callback)>;
+    static constexpr bool is_ta = rclcpp::TypeAdapter<MessageT>::is_specialized::value;
+
+    // conditions for custom type
+    if constexpr (is_ta && std::is_same_v<T, ConstRefCallback>) {
+      callback(*message);
+    } else if constexpr (is_ta && std::is_same_v<T, ConstRefWithInfoCallback>) {  // NOLINT
+      callback(*message, message_info);
+    } else if constexpr (  // NOLINT[readability/braces]
+      is_ta && (
+        std::is_same_v<T, UniquePtrCallback>||
+        std::is_same_v<T, SharedPtrCallback>))
+    {
+      callback(std::move(message));
+    } else if constexpr (  // NOLINT[readability/braces]
+      is_ta && (
+        std::is_same_v<T, UniquePtrWithInfoCallback>||
+        std::is_same_v<T, SharedPtrWithInfoCallback>
+    ))
+    {
+      callback(std::move(message), message_info);
+    } else if constexpr (  // NOLINT[readability/braces]
+      is_ta && (
+        std::is_same_v<T, SharedConstPtrCallback>||
+        std::is_same_v<T, ConstRefSharedConstPtrCallback>
+    ))
+    {
+      callback(std::move(message));
+    } else if constexpr (  // NOLINT[readability/braces]
+      is_ta && (
+        std::is_same_v<T, SharedConstPtrWithInfoCallback>||
+        std::is_same_v<T, ConstRefSharedConstPtrWithInfoCallback>
+    ))
+    {
+      callback(std::move(message), message_info);
+    }
+    // conditions for ros message type
+    else if constexpr (std::is_same_v<T, ConstRefROSMessageCallback>) {  // NOLINT[readability/braces]
+      if constexpr (is_ta) {
+        auto local = convert_custom_type_to_ros_message_unique_ptr(*message);
+        callback(*local);
+      } else {
+        callback(*message);
+      }
+    } else if constexpr (std::is_same_v<T, ConstRefWithInfoROSMessageCallback>) {  // NOLINT[readability/braces]
+      if constexpr (is_ta) {
+        auto local = convert_custom_type_to_ros_message_unique_ptr(*message);
+        callback(*local, message_info);
+      } else {
+        callback(*message, message_info);
+      }
+    } else if constexpr (  // NOLINT[readability/braces]
+      std::is_same_v<T, UniquePtrROSMessageCallback>||
+      std::is_same_v<T, SharedPtrROSMessageCallback>)
+    {
+      if constexpr (is_ta) {
+        callback(convert_custom_type_to_ros_message_unique_ptr(*message));
+      } else {
+        callback(std::move(message));
+      }
+    } else if constexpr (  // NOLINT[readability/braces]
+      std::is_same_v<T, UniquePtrWithInfoROSMessageCallback>||
+      std::is_same_v<T, SharedPtrWithInfoROSMessageCallback>)
+    {
+      if constexpr (is_ta) {
+        callback(convert_custom_type_to_ros_message_unique_ptr(*message), message_info);
+      } else {
+        callback(std::move(message), message_info);
+      }
+    } else if constexpr (  // NOLINT[readability/braces]
+      std::is_same_v<T, SharedConstPtrROSMessageCallback>||
+      std::is_same_v<T, ConstRefSharedConstPtrROSMessageCallback>)
+    {
+      if constexpr (is_ta) {
+        callback(convert_custom_type_to_ros_message_unique_ptr(*message));
+      } else {
+        callback(std::move(message));
+      }
+    } else if constexpr (  // NOLINT[readability/braces]
+      std::is_same_v<T, SharedConstPtrWithInfoROSMessageCallback>||
+      std::is_same_v<T, ConstRefSharedConstPtrWithInfoROSMessageCallback>)
+    {
+      if constexpr (is_ta) {
+        callback(convert_custom_type_to_ros_message_unique_ptr(*message), message_info);
+      } else {
+        callback(std::move(message), message_info);
+      }
+    }
+    // condition for a batch of one message
+    else if constexpr (std::is_same_v<T, SharedConstPtrBatchCallback>) {  // NOLINT
+      callback({std::shared_ptr<const SubscribedType>(std::move(message))});
+    }
+    // conditions for an intra-process message, owned without a loan
+    else if constexpr (  // NOLINT[readability/braces]
+      std::is_same_v<T, LoanedMessageCallback>||
+      std::is_same_v<T, LoanedMessageWithInfoCallback>)
+    {
+      std::shared_ptr<const ROSMessageType> ros_message;
+      if constexpr (is_ta) {
+        ros_message = convert_custom_type_to_ros_message_unique_ptr(*message);
+      } else {
+        ros_message = std::move(message);
+      }
+      rclcpp::SubscriptionLoanedMessage<ROSMessageType> handle(std::move(ros_message));
+      if constexpr (std::is_same_v<T, LoanedMessageCallback>) {
+        callback(std::move(handle));
+      } else {
+        callback(std::move(handle), message_info);
+      }
+    }
+    // conditions for an intra-process message, which is already deserialized
+    else if constexpr (  // NOLINT[readability/braces]
+      std::is_same_v<T, LazyMessageCallback>||
+      std::is_same_v<T, LazyMessageWithInfoCallback>)
+    {
+      std::shared_ptr<const ROSMessageType> ros_message;
+      if constexpr (is_ta) {
+        ros_message = convert_custom_type_to_ros_message_unique_ptr(*message);
+      } else {
+        ros_message = std::move(message);
+      }
+      auto lazy_message =
+        std::make_shared<rclcpp::LazyDeserializedMessage<ROSMessageType>>(std::move(ros_message));
+      if constexpr (std::is_same_v<T, LazyMessageCallback>) {
+        callback(std::move(lazy_message));
+      } else {
+        callback(std::move(lazy_message), message_info);
+      }
+    }
+    // conditions for an intra-process message, owned by a thread-confined handle
+    else if constexpr (  // NOLINT[readability/braces]
+      std::is_same_v<T, LocalMessageCallback>||
+      std::is_same_v<T, LocalMessageWithInfoCallback>)
+    {
+      rclcpp::LocalMessagePtr<ROSMessageType> handle;
+      if constexpr (is_ta) {
+        handle = rclcpp::LocalMessagePtr<ROSMessageType>(
+          convert_custom_type_to_ros_message_unique_ptr(*message));
+      } else {
+        // The handle takes the ownership of the message, without creating a shared pointer
+        handle = rclcpp::LocalMessagePtr<ROSMessageType>(std::move(message));
+      }
+      if constexpr (std::is_same_v<T, LocalMessageCallback>) {
+        callback(std::move(handle));
+      } else {
+        callback(std::move(handle), message_info);
+      }
+    }
+    // condition to catch SerializedMessage types
+    else if constexpr (  // NOLINT[readability/braces]
+      std::is_same_v<T, ConstRefSerializedMessageCallback>||
+      std::is_same_v<T, ConstRefSerializedMessageWithInfoCallback>||
+      std::is_same_v<T, UniquePtrSerializedMessageCallback>||
+      std::is_same_v<T, UniquePtrSerializedMessageWithInfoCallback>||
+      std::is_same_v<T, SharedConstPtrSerializedMessageCallback>||
+      std::is_same_v<T, SharedConstPtrSerializedMessageWithInfoCallback>||
+      std::is_same_v<T, ConstRefSharedConstPtrSerializedMessageCallback>||
+      std::is_same_v<T, ConstRefSharedConstPtrSerializedMessageWithInfoCallback>||
+      std::is_same_v<T, SharedPtrSerializedMessageCallback>||
+      std::is_same_v<T, SharedPtrSerializedMessageWithInfoCallback>)
+    {
+      throw std::runtime_error(
+        "Cannot dispatch std::unique_ptr<ROSMessageType, ROSMessageTypeDeleter> message "
+        "to rclcpp::SerializedMessage");
+    }
+    // condition to catch unhandled callback types
+    else {  // NOLINT[readability/braces]
+      static_assert(always_false_v<T>, "unhandled callback type");
+    }
+  }
+
+  /// Check that the resolved callback alternative is set, for the first alternative only.
+  template<size_t Index>
+  void
+  check_set() const
+  {
+    if constexpr (Index == 0) {
+      if (std::get<0>(callback_variant_) == nullptr) {
+        // This can happen if it is default initialized, or if it is assigned nullptr.
+        throw std::runtime_error("dispatch called on an unset AnySubscriptionCallback");
+      }
+    }
+  }
+
+  template<size_t Index>
+  void
+  dispatch_ros_message_resolved(
+    std::shared_ptr<ROSMessageType> message,
+    const rclcpp::MessageInfo & message_info)
+  {
+    check_set<Index>();
+    dispatch_ros_message_to(
+      *std::get_if<Index>(&callback_variant_), std::move(message), message_info);
+  }
+
+  template<size_t Index>
+  void
+  dispatch_serialized_message_resolved(
+    std::shared_ptr<rclcpp::SerializedMessage> serialized_message,
+    const rclcpp::MessageInfo & message_info)
+  {
+    check_set<Index>();
+    dispatch_serialized_message_to(
+      *std::get_if<Index>(&callback_variant_), std::move(serialized_message), message_info);
+  }
+
+  template<size_t Index>
+  void
+  dispatch_intra_process_shared_resolved(
+    std::shared_ptr<const SubscribedType> message,
+    const rclcpp::MessageInfo & message_info)
+  {
+    check_set<Index>();
+    dispatch_intra_process_shared_to(
+      *std::get_if<Index>(&callback_variant_), std::move(message), message_info);
+  }
+
+  template<size_t Index>
+  void
+  dispatch_intra_process_unique_resolved(
+    std::unique_ptr<SubscribedType, SubscribedTypeDeleter> message,
+    const rclcpp::MessageInfo & message_info)
+  {
+    check_set<Index>();
+    dispatch_intra_process_unique_to(
+      *std::get_if<Index>(&callback_variant_), std::move(message), message_info);
+  }
+
+  /// Dispatch functions of a callback alternative, instantiated for each alternative.
+  struct Dispatchers
+  {
+    void (AnySubscriptionCallback::* ros_message)(
+      std::shared_ptr<ROSMessageType>, const rclcpp::MessageInfo &);
+    void (AnySubscriptionCallback::* serialized_message)(
+      std::shared_ptr<rclcpp::SerializedMessage>, const rclcpp::MessageInfo &);
+    void (AnySubscriptionCallback::* intra_process_shared)(
+      std::shared_ptr<const SubscribedType>, const rclcpp::MessageInfo &);
+    void (AnySubscriptionCallback::* intra_process_unique)(
+      std::unique_ptr<SubscribedType, SubscribedTypeDeleter>, const rclcpp::MessageInfo &);
+  };
+
+  template<size_t ... Indices>
+  static
+  const Dispatchers *
+  get_dispatchers_table(std::index_sequence<Indices...>)
+  {
+    static const Dispatchers table[] = {
+      Dispatchers{
+        &AnySubscriptionCallback::dispatch_ros_message_resolved<Indices>,
+        &AnySubscriptionCallback::dispatch_serialized_message_resolved<Indices>,
+        &AnySubscriptionCallback::dispatch_intra_process_shared_resolved<Indices>,
+        &AnySubscriptionCallback::dispatch_intra_process_unique_resolved<Indices>
+      } ...
+    };
+    return table;
+  }
+
+  /// Resolve the dispatch functions of the current callback alternative.
+  void
+  resolve_dispatchers()
+  {
+    using variant_type = typename HelperT::variant_type;
+    dispatchers_ = &get_dispatchers_table(
+      std::make_index_sequence<std::variant_size_v<variant_type>>())[callback_variant_.index()];
+    dispatchers_index_ = callback_variant_.index();
+  }
+
+  /// Return the dispatch functions of the callback, resolved again if it was changed.
+  /**
+   * The callback is normally set once, but it can also be changed through get_variant().
+   */
+  const Dispatchers &
+  get_dispatchers()
+  {
+    if (dispatchers_index_ != callback_variant_.index()) {
+      resolve_dispatchers();
+    }
+    return *dispatchers_;
+  }
+
   // TODO(wjwwood): switch to inheriting from std::variant (i.e. HelperT::variant_type) once
   // inheriting from std::variant is realistic (maybe C++23?), see:
   //   http://www.open-std.org/jtc1/sc22/wg21/docs/papers/2020/p2162r0.html
   // For now, compose the variant into this class as a private attribute.
   typename HelperT::variant_type callback_variant_;
+  /// Dispatch functions of the alternative of callback_variant_ at index dispatchers_index_.
+  const Dispatchers * dispatchers_ = nullptr;
+  size_t dispatchers_index_ = std::variant_npos;
 
   SubscribedTypeAllocator subscribed_type_allocator_;
   SubscribedTypeDeleter subscribed_type_deleter_;
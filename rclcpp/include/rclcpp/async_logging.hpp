@@ -0,0 +1,80 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__ASYNC_LOGGING_HPP_
+#define RCLCPP__ASYNC_LOGGING_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// Options of the asynchronous logging, see InitOptions::async_logging.
+/**
+ * With a non-zero depth, the rclcpp logging output handler formats each log message into a
+ * buffer of the logging thread, without taking the global logging mutex, and a background
+ * thread writes the buffered messages to the console, the log file and /rosout.
+ * A thread logging faster than they are written drops its new messages, and isn't slowed down
+ * by the other threads logging.
+ *
+ * The fatal messages are still written on the logging thread, so they aren't lost if the process
+ * aborts right after, they may come before the messages which are still buffered.
+ */
+struct AsyncLoggingOptions
+{
+  /// Number of log messages buffered per logging thread, 0 writes them on the logging thread.
+  size_t depth = 0;
+
+  /// Longest time a log message is buffered before the background thread writes it.
+  std::chrono::milliseconds flush_period{10};
+};
+
+/// Metrics of the asynchronous logging.
+/**
+ * The counts are accumulated since the logging was initialized, they are read one at a time
+ * while the messages are logged, so they may not add up exactly.
+ */
+struct AsyncLoggingStatistics
+{
+  /// Number of log messages buffered, including the ones not written yet.
+  uint64_t enqueued_count = 0;
+  /// Number of log messages written by the background thread.
+  uint64_t written_count = 0;
+  /// Number of log messages dropped because the buffer of their thread was full.
+  uint64_t dropped_count = 0;
+  /// Number of log messages whose text or logger name was truncated to fit in the buffer.
+  uint64_t truncated_count = 0;
+};
+
+/// Wait until the log messages buffered by the asynchronous logging are written.
+/**
+ * It returns right away if the asynchronous logging isn't enabled.
+ * It must not be called while holding the global logging mutex, e.g. from a log output handler.
+ */
+RCLCPP_PUBLIC
+void
+flush_async_logging();
+
+/// Return the metrics of the asynchronous logging, all zero if it was never enabled.
+RCLCPP_PUBLIC
+AsyncLoggingStatistics
+get_async_logging_statistics();
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__ASYNC_LOGGING_HPP_
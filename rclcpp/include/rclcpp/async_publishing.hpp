@@ -0,0 +1,72 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__ASYNC_PUBLISHING_HPP_
+#define RCLCPP__ASYNC_PUBLISHING_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace rclcpp
+{
+
+/// What a publish call does when the queue of an asynchronous publisher is full.
+enum class AsyncPublishingOverflowPolicy
+{
+  /// Drop the oldest queued message, the publish call never waits.
+  DropOldest,
+  /// Drop the message being published, the publish call never waits.
+  DropNewest,
+  /// Wait until the sender thread published the oldest queued message.
+  Block,
+};
+
+/// Options of the asynchronous publishing, see PublisherOptionsBase::async_publishing.
+struct AsyncPublishingOptions
+{
+  /// Number of messages queued for the sender thread, 0 publishes on the calling thread.
+  size_t depth = 0;
+
+  /// Behavior of the publish calls when depth messages are already queued.
+  AsyncPublishingOverflowPolicy overflow_policy = AsyncPublishingOverflowPolicy::DropOldest;
+};
+
+/// Metrics of the queue of an asynchronous publisher.
+/**
+ * The counts are accumulated since the publisher was created.
+ * They are read one at a time while the messages are published, so they may not add up exactly.
+ */
+struct AsyncPublishingStatistics
+{
+  /// Maximum number of messages queued, AsyncPublishingOptions::depth.
+  size_t depth = 0;
+  /// Number of messages currently queued.
+  size_t size = 0;
+  /// Largest number of messages queued at once.
+  size_t high_water_mark = 0;
+  /// Number of messages queued, including the ones later dropped.
+  uint64_t enqueued_count = 0;
+  /// Number of messages given to the middleware by the sender thread.
+  uint64_t published_count = 0;
+  /// Number of messages dropped by the overflow policy, without being published.
+  uint64_t dropped_count = 0;
+  /// Number of publish calls which waited for room in the queue.
+  uint64_t blocked_count = 0;
+  /// Number of messages the middleware failed to publish.
+  uint64_t failed_count = 0;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__ASYNC_PUBLISHING_HPP_
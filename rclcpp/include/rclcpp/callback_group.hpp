@@ -16,6 +16,8 @@
 #define RCLCPP__CALLBACK_GROUP_HPP_
 
 #include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <mutex>
@@ -141,10 +143,114 @@ public:
   std::atomic_bool &
   can_be_taken_from();
 
+  /// Reserve this callback group to execute one of its executables.
+  /**
+   * A mutually exclusive callback group is reserved with a single compare and swap of
+   * can_be_taken_from(), so that threads can reserve it without holding any other lock.
+   * It stays reserved until release() is called, which executors do once the executable ran.
+   * A reentrant callback group can always be reserved.
+   *
+   * A failed reservation is counted as a skip, see get_reservation_statistics().
+   *
+   * \return true if the callback group was reserved, false if it is already reserved.
+   */
+  RCLCPP_PUBLIC
+  bool
+  try_reserve();
+
+  /// Release a reservation made with try_reserve().
+  RCLCPP_PUBLIC
+  void
+  release();
+
+  /// Count ready work of this callback group left behind because the group was reserved.
+  /**
+   * Used by memory strategies which check can_be_taken_from() without reserving.
+   */
+  RCLCPP_PUBLIC
+  void
+  record_skip();
+
+  /// Counters of the reservations of this callback group.
+  struct ReservationStatistics
+  {
+    /// Number of successful reservations.
+    uint64_t reservation_count = 0;
+    /// Number of times ready work was skipped because the group was already reserved.
+    uint64_t skip_count = 0;
+  };
+
+  /// Return the reservation counters of this callback group.
+  RCLCPP_PUBLIC
+  ReservationStatistics
+  get_reservation_statistics() const;
+
+  /// Reset the reservation counters of this callback group.
+  RCLCPP_PUBLIC
+  void
+  reset_reservation_statistics();
+
   RCLCPP_PUBLIC
   const CallbackGroupType &
   type() const;
 
+  /// Set the priority used by executors to order the ready work of different callback groups.
+  /**
+   * When at least one of the callback groups associated with an executor has a non default
+   * priority, the executor always dispatches the ready work of the callback groups with the
+   * highest priority first.
+   * Ready work of callback groups with the same priority is dispatched in the usual order:
+   * timers, subscriptions, services, clients and then waitables.
+   *
+   * \param[in] priority The priority of the callback group, higher values are dispatched
+   *   first; the default is 0.
+   */
+  RCLCPP_PUBLIC
+  void
+  set_priority(int priority);
+
+  /// Return the priority of this callback group.
+  RCLCPP_PUBLIC
+  int
+  get_priority() const;
+
+  /// Statistics about how long the ready work of this callback group waited to be dispatched.
+  /**
+   * The waiting time is measured from the moment the executor found the work ready to the
+   * moment it was dispatched, while work of higher priority callback groups was served.
+   * It is only recorded by executors which are dispatching according to priorities.
+   */
+  struct StarvationStatistics
+  {
+    /// Number of executables dispatched according to priorities.
+    uint64_t dispatch_count = 0;
+    /// Number of those executables which waited behind higher priority work.
+    uint64_t starved_count = 0;
+    /// Accumulated waiting time of all the dispatched executables.
+    std::chrono::nanoseconds total_wait_time = std::chrono::nanoseconds::zero();
+    /// Longest waiting time of a dispatched executable.
+    std::chrono::nanoseconds max_wait_time = std::chrono::nanoseconds::zero();
+  };
+
+  /// Return a copy of the starvation statistics of this callback group.
+  RCLCPP_PUBLIC
+  StarvationStatistics
+  get_starvation_statistics() const;
+
+  /// Reset the starvation statistics of this callback group.
+  RCLCPP_PUBLIC
+  void
+  reset_starvation_statistics();
+
+  /// Record the dispatch of an executable of this callback group, used by executors.
+  /**
+   * \param[in] wait_time How long the executable waited, after being found ready.
+   * \param[in] starved Whether higher priority work was dispatched while it waited.
+   */
+  RCLCPP_PUBLIC
+  void
+  record_dispatch(std::chrono::nanoseconds wait_time, bool starved);
+
   RCLCPP_PUBLIC
   void collect_all_ptrs(
     std::function<void(const rclcpp::SubscriptionBase::SharedPtr &)> sub_func,
@@ -229,6 +335,11 @@ protected:
   std::vector<rclcpp::ClientBase::WeakPtr> client_ptrs_;
   std::vector<rclcpp::Waitable::WeakPtr> waitable_ptrs_;
   std::atomic_bool can_be_taken_from_;
+  std::atomic<uint64_t> reservation_count_;
+  std::atomic<uint64_t> skip_count_;
+  std::atomic_int priority_;
+  mutable std::mutex starvation_statistics_mutex_;
+  StarvationStatistics starvation_statistics_;
   const bool automatically_add_to_executor_with_node_;
   // defer the creation of the guard condition
   std::shared_ptr<rclcpp::GuardCondition> notify_guard_condition_ = nullptr;
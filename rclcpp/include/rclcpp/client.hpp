@@ -15,15 +15,20 @@
 #ifndef RCLCPP__CLIENT_HPP_
 #define RCLCPP__CLIENT_HPP_
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <deque>
+#include <exception>
+#include <functional>
 #include <future>
-#include <unordered_map>
 #include <memory>
 #include <mutex>
 #include <optional>  // NOLINT, cpplint doesn't think this is a cpp std header
 #include <sstream>
 #include <string>
 #include <tuple>
+#include <type_traits>
 #include <utility>
 #include <variant>  // NOLINT
 #include <vector>
@@ -34,8 +39,13 @@
 #include "rcl/wait.h"
 
 #include "rclcpp/detail/cpp_callback_trampoline.hpp"
+#include "rclcpp/detail/request_timeout_scheduler.hpp"
+#include "rclcpp/detail/sequence_number_table.hpp"
 #include "rclcpp/exceptions.hpp"
 #include "rclcpp/expand_topic_or_service_name.hpp"
+#include "rclcpp/experimental/client_intra_process.hpp"
+#include "rclcpp/experimental/intra_process_service_manager.hpp"
+#include "rclcpp/experimental/service_intra_process.hpp"
 #include "rclcpp/function_traits.hpp"
 #include "rclcpp/logging.hpp"
 #include "rclcpp/macros.hpp"
@@ -44,6 +54,7 @@
 #include "rclcpp/type_support_decl.hpp"
 #include "rclcpp/utilities.hpp"
 #include "rclcpp/visibility_control.hpp"
+#include "rclcpp/waitable.hpp"
 
 #include "rmw/error_handling.h"
 #include "rmw/impl/cpp/demangle.hpp"
@@ -205,6 +216,17 @@ public:
   virtual void handle_response(
     std::shared_ptr<rmw_request_id_t> request_header, std::shared_ptr<void> response) = 0;
 
+  /// Return the waitable receiving the responses of the services in the same context.
+  /**
+   * \return the waitable, or nullptr if intra-process communication isn't setup.
+   */
+  virtual
+  rclcpp::Waitable::SharedPtr
+  get_intra_process_waitable() const
+  {
+    return nullptr;
+  }
+
   /// Exchange the "in use by wait set" state for this client.
   /**
    * This is used to ensure this client is not used by multiple
@@ -219,6 +241,18 @@ public:
   bool
   exchange_in_use_by_wait_set_state(bool in_use_state);
 
+  /// Time out a pending request, called once the timeout of the request elapsed.
+  /**
+   * Called by rclcpp::detail::RequestTimeoutScheduler, from its thread.
+   *
+   * \param[in] request_id id of the request, as returned when it was sent.
+   * \return true when the request was pending, false if not (e.g. a response was received).
+   */
+  RCLCPP_PUBLIC
+  virtual
+  bool
+  time_out_pending_request(int64_t request_id);
+
   /// Get the actual request publsher QoS settings, after the defaults have been determined.
   /**
    * The actual configuration applied when using RMW_QOS_POLICY_*_SYSTEM_DEFAULT
@@ -369,7 +403,9 @@ protected:
 };
 
 template<typename ServiceT>
-class Client : public ClientBase
+class Client
+  : public ClientBase,
+  public std::enable_shared_from_this<Client<ServiceT>>
 {
 public:
   using Request = typename ServiceT::Request;
@@ -391,6 +427,13 @@ public:
   using CallbackType = std::function<void (SharedFuture)>;
   using CallbackWithRequestType = std::function<void (SharedFutureWithRequest)>;
 
+  using SharedResponses = std::vector<SharedResponse>;
+  using SharedBatchFuture = std::shared_future<SharedResponses>;
+  using BatchCallbackType = std::function<void (SharedBatchFuture)>;
+
+  using ClientIntraProcessT = rclcpp::experimental::ClientIntraProcess<ServiceT>;
+  using ServiceIntraProcessT = rclcpp::experimental::ServiceIntraProcess<ServiceT>;
+
   RCLCPP_SMART_PTR_DEFINITIONS(Client)
 
   /// A convenient Client::Future and request id pair.
@@ -491,6 +534,8 @@ public:
       }
       rclcpp::exceptions::throw_from_rcl_error(ret, "could not create client");
     }
+    timeout_scheduler_ =
+      context_->get_sub_context<rclcpp::detail::RequestTimeoutScheduler>(context_);
   }
 
   virtual ~Client()
@@ -553,28 +598,68 @@ public:
     if (!optional_pending_request) {
       return;
     }
-    auto & value = *optional_pending_request;
-    auto typed_response = std::static_pointer_cast<typename ServiceT::Response>(
-      std::move(response));
-    if (std::holds_alternative<Promise>(value)) {
-      auto & promise = std::get<Promise>(value);
-      promise.set_value(std::move(typed_response));
-    } else if (std::holds_alternative<CallbackTypeValueVariant>(value)) {
-      auto & inner = std::get<CallbackTypeValueVariant>(value);
-      const auto & callback = std::get<CallbackType>(inner);
-      auto & promise = std::get<Promise>(inner);
-      auto & future = std::get<SharedFuture>(inner);
-      promise.set_value(std::move(typed_response));
-      callback(std::move(future));
-    } else if (std::holds_alternative<CallbackWithRequestTypeValueVariant>(value)) {
-      auto & inner = std::get<CallbackWithRequestTypeValueVariant>(value);
-      const auto & callback = std::get<CallbackWithRequestType>(inner);
-      auto & promise = std::get<PromiseWithRequest>(inner);
-      auto & future = std::get<SharedFutureWithRequest>(inner);
-      auto & request = std::get<SharedRequest>(inner);
-      promise.set_value(std::make_pair(std::move(request), std::move(typed_response)));
-      callback(std::move(future));
+    complete_pending_request(
+      *optional_pending_request,
+      std::static_pointer_cast<typename ServiceT::Response>(std::move(response)));
+    send_queued_batch_requests();
+  }
+
+  /// Handle the response of a service in the same context.
+  /**
+   * \param[in] request_id the id of the request, returned when it was sent.
+   * \param[in] response the response, as given by the service.
+   */
+  void
+  handle_intra_process_response(int64_t request_id, SharedResponse response)
+  {
+    std::optional<CallbackInfoVariant>
+    optional_pending_request = this->get_and_erase_pending_request(request_id);
+    if (!optional_pending_request) {
+      return;
+    }
+    complete_pending_request(*optional_pending_request, std::move(response));
+    send_queued_batch_requests();
+  }
+
+  /// Send the requests by pointer to the services in the same context.
+  /**
+   * Called by rclcpp::create_client() when the node uses intra-process communication.
+   * The service is looked up before each request, and the request goes through the
+   * middleware when there is no service with this name and type in the same context.
+   *
+   * The ids of the intra-process requests are negative, so they never collide with the
+   * sequence numbers given by the middleware.
+   * The service gets the request object itself, so a request must not be modified after
+   * being sent.
+   *
+   * \throws std::runtime_error if intra-process communication is already setup.
+   */
+  void
+  setup_intra_process()
+  {
+    if (client_intra_process_) {
+      throw std::runtime_error("intra-process communication is already setup for this client");
     }
+    using rclcpp::experimental::IntraProcessServiceManager;
+    auto ipsm = context_->get_sub_context<IntraProcessServiceManager>();
+    std::weak_ptr<Client<ServiceT>> weak_this = this->shared_from_this();
+    client_intra_process_ = std::make_shared<ClientIntraProcessT>(
+      [weak_this](int64_t request_id, SharedResponse response) {
+        auto client = weak_this.lock();
+        if (client) {
+          client->handle_intra_process_response(request_id, std::move(response));
+        }
+      },
+      context_,
+      get_service_name(),
+      ipsm->reserve_client_id());
+    weak_ipsm_ = ipsm;
+  }
+
+  rclcpp::Waitable::SharedPtr
+  get_intra_process_waitable() const override
+  {
+    return client_intra_process_;
   }
 
   /// Send a request to the service server.
@@ -602,17 +687,37 @@ public:
    * }
    * ```
    *
+   * The request times out after the timeout set with set_request_timeout(), if any.
+   *
    * \param[in] request request to be send.
    * \return a FutureAndRequestId instance.
    */
   FutureAndRequestId
   async_send_request(SharedRequest request)
+  {
+    return async_send_request(std::move(request), get_request_timeout());
+  }
+
+  /// Send a request to the service server, which times out without a response.
+  /**
+   * Similar to the previous overload, but when no response is received within the timeout
+   * the request is removed and its future holds a rclcpp::exceptions::RequestTimeoutError.
+   * The request is removed by a thread shared by the clients of the context, so
+   * remove_pending_request() doesn't need to be called.
+   *
+   * \param[in] request request to be send.
+   * \param[in] timeout time to wait for the response, zero or less to wait forever.
+   * \return a FutureAndRequestId instance.
+   */
+  FutureAndRequestId
+  async_send_request(SharedRequest request, std::chrono::nanoseconds timeout)
   {
     Promise promise;
     auto future = promise.get_future();
     auto req_id = async_send_request_impl(
-      *request,
+      request,
       std::move(promise));
+    schedule_request_timeout(req_id, timeout);
     return FutureAndRequestId(std::move(future), req_id);
   }
 
@@ -627,10 +732,45 @@ public:
    * In this case, it's convenient to setup a timer to cleanup the pending requests.
    * See for example the `examples_rclcpp_async_client` package in https://github.com/ros2/examples.
    *
+   * The request times out after the timeout set with set_request_timeout(), if any.
+   *
    * \param[in] request request to be send.
    * \param[in] cb callback that will be called when we get a response for this request.
    * \return the request id representing the request just sent.
    */
+  template<
+    typename CallbackT,
+    typename std::enable_if<
+      std::conjunction<
+        // A timeout isn't a callback, checked first as function_traits would fail to compile
+        std::negation<std::is_convertible<CallbackT, std::chrono::nanoseconds>>,
+        rclcpp::function_traits::same_arguments<
+          CallbackT,
+          CallbackType
+        >
+      >::value
+    >::type * = nullptr
+  >
+  SharedFutureAndRequestId
+  async_send_request(SharedRequest request, CallbackT && cb)
+  {
+    return async_send_request(
+      std::move(request), std::forward<CallbackT>(cb), get_request_timeout());
+  }
+
+  /// Send a request to the service server and schedule a callback, or time out the request.
+  /**
+   * Similar to the previous overload, but when no response is received within the timeout
+   * the request is removed and the callback is called with a future holding a
+   * rclcpp::exceptions::RequestTimeoutError.
+   * The callback of a request which timed out is called from the thread removing it,
+   * shared by the clients of the context, not from the executor.
+   *
+   * \param[in] request request to be send.
+   * \param[in] cb callback that will be called when we get a response for this request.
+   * \param[in] timeout time to wait for the response, zero or less to wait forever.
+   * \return the request id representing the request just sent.
+   */
   template<
     typename CallbackT,
     typename std::enable_if<
@@ -641,16 +781,17 @@ public:
     >::type * = nullptr
   >
   SharedFutureAndRequestId
-  async_send_request(SharedRequest request, CallbackT && cb)
+  async_send_request(SharedRequest request, CallbackT && cb, std::chrono::nanoseconds timeout)
   {
     Promise promise;
     auto shared_future = promise.get_future().share();
     auto req_id = async_send_request_impl(
-      *request,
+      request,
       std::make_tuple(
         CallbackType{std::forward<CallbackT>(cb)},
         shared_future,
         std::move(promise)));
+    schedule_request_timeout(req_id, timeout);
     return SharedFutureAndRequestId{std::move(shared_future), req_id};
   }
 
@@ -662,6 +803,34 @@ public:
    * \param[in] cb callback that will be called when we get a response for this request.
    * \return the request id representing the request just sent.
    */
+  template<
+    typename CallbackT,
+    typename std::enable_if<
+      std::conjunction<
+        std::negation<std::is_convertible<CallbackT, std::chrono::nanoseconds>>,
+        rclcpp::function_traits::same_arguments<
+          CallbackT,
+          CallbackWithRequestType
+        >
+      >::value
+    >::type * = nullptr
+  >
+  SharedFutureWithRequestAndRequestId
+  async_send_request(SharedRequest request, CallbackT && cb)
+  {
+    return async_send_request(
+      std::move(request), std::forward<CallbackT>(cb), get_request_timeout());
+  }
+
+  /// Send a request to the service server and schedule a callback, or time out the request.
+  /**
+   * Similar to the previous method, but you can get both the request and response in the callback.
+   *
+   * \param[in] request request to be send.
+   * \param[in] cb callback that will be called when we get a response for this request.
+   * \param[in] timeout time to wait for the response, zero or less to wait forever.
+   * \return the request id representing the request just sent.
+   */
   template<
     typename CallbackT,
     typename std::enable_if<
@@ -672,20 +841,125 @@ public:
     >::type * = nullptr
   >
   SharedFutureWithRequestAndRequestId
-  async_send_request(SharedRequest request, CallbackT && cb)
+  async_send_request(SharedRequest request, CallbackT && cb, std::chrono::nanoseconds timeout)
   {
     PromiseWithRequest promise;
     auto shared_future = promise.get_future().share();
     auto req_id = async_send_request_impl(
-      *request,
+      request,
       std::make_tuple(
         CallbackWithRequestType{std::forward<CallbackT>(cb)},
         request,
         shared_future,
         std::move(promise)));
+    schedule_request_timeout(req_id, timeout);
     return SharedFutureWithRequestAndRequestId{std::move(shared_future), req_id};
   }
 
+  /// Send a batch of requests to the service server, completing a single future.
+  /**
+   * The future holds the responses in the order of the requests.
+   * A request removed before its response arrived, e.g. by prune_requests_older_than(),
+   * leaves a nullptr response, so pruning the old requests with a timer completes the batches
+   * whose responses were lost.
+   * Each request times out after the timeout set with set_request_timeout(), if any,
+   * counted from the time it's sent, and leaves a nullptr response as well.
+   *
+   * The requests are sent right away while the client has fewer pending requests than
+   * get_max_outstanding_requests(), the others are queued and sent as the responses arrive.
+   * The batch costs a single promise and allocation, instead of one per request.
+   *
+   * If sending a request fails, the future holds the exception and the requests of the batch
+   * not sent yet are dropped.
+   *
+   * \param[in] requests requests to be sent.
+   * \return a future completed once each request got a response or was removed.
+   */
+  SharedBatchFuture
+  async_send_request_batch(std::vector<SharedRequest> requests)
+  {
+    return async_send_request_batch_impl(std::move(requests), BatchCallbackType{});
+  }
+
+  /// Send a batch of requests to the service server and call a callback with all the responses.
+  /**
+   * Similar to the previous overload, but the callback is called with the future once it is
+   * completed, by the thread handling the last response.
+   *
+   * \param[in] requests requests to be sent.
+   * \param[in] cb callback that will be called once each request got a response or was removed.
+   * \return a future completed once each request got a response or was removed.
+   */
+  template<
+    typename CallbackT,
+    typename std::enable_if<
+      rclcpp::function_traits::same_arguments<
+        CallbackT,
+        BatchCallbackType
+      >::value
+    >::type * = nullptr
+  >
+  SharedBatchFuture
+  async_send_request_batch(std::vector<SharedRequest> requests, CallbackT && cb)
+  {
+    return async_send_request_batch_impl(
+      std::move(requests), BatchCallbackType{std::forward<CallbackT>(cb)});
+  }
+
+  /// Set the timeout of the requests sent afterwards without a timeout of their own.
+  /**
+   * A request without a response within the timeout is removed, and its future holds a
+   * rclcpp::exceptions::RequestTimeoutError.
+   * The deadlines of the clients of a context are kept by a single thread, which removes the
+   * requests, so no timer is needed to prune the requests whose responses were lost.
+   *
+   * \param[in] timeout time to wait for the responses, zero or less to wait forever.
+   */
+  void
+  set_request_timeout(std::chrono::nanoseconds timeout)
+  {
+    request_timeout_.store(timeout);
+  }
+
+  /// Return the timeout of the requests, zero if they wait forever.
+  std::chrono::nanoseconds
+  get_request_timeout() const
+  {
+    return request_timeout_.load();
+  }
+
+  /// Set the number of pending requests up to which the batched requests are sent.
+  /**
+   * The requests sent with async_send_request() count as pending requests,
+   * but they are always sent right away.
+   *
+   * \param[in] max_outstanding_requests maximum number of pending requests, 0 for no limit.
+   */
+  void
+  set_max_outstanding_requests(size_t max_outstanding_requests)
+  {
+    {
+      std::lock_guard guard(pending_requests_mutex_);
+      max_outstanding_requests_ = max_outstanding_requests;
+    }
+    send_queued_batch_requests();
+  }
+
+  /// Return the number of pending requests up to which the batched requests are sent.
+  size_t
+  get_max_outstanding_requests()
+  {
+    std::lock_guard guard(pending_requests_mutex_);
+    return max_outstanding_requests_;
+  }
+
+  /// Return the number of batched requests waiting to be sent.
+  size_t
+  get_queued_request_count() const
+  {
+    return queued_request_count_.load();
+  }
+
   /// Cleanup a pending request.
   /**
    * This notifies the client that we have waited long enough for a response from the server
@@ -700,8 +974,19 @@ public:
   bool
   remove_pending_request(int64_t request_id)
   {
-    std::lock_guard guard(pending_requests_mutex_);
-    return pending_requests_.erase(request_id) != 0u;
+    std::optional<PendingRequest> pending_request;
+    {
+      std::lock_guard guard(pending_requests_mutex_);
+      pending_request = take_pending_request(request_id);
+    }
+    if (!pending_request) {
+      return false;
+    }
+    if (auto * batch_request = std::get_if<BatchRequestInfo>(&pending_request->second)) {
+      complete_batch_request(*batch_request, nullptr);
+    }
+    send_queued_batch_requests();
+    return true;
   }
 
   /// Cleanup a pending request.
@@ -742,19 +1027,50 @@ public:
 
   /// Clean all pending requests.
   /**
+   * The batched requests waiting to be sent are dropped as well, without being counted.
+   *
    * \return number of pending requests that were removed.
    */
   size_t
   prune_pending_requests()
   {
-    std::lock_guard guard(pending_requests_mutex_);
-    auto ret = pending_requests_.size();
-    pending_requests_.clear();
+    std::vector<BatchRequestInfo> batch_requests;
+    std::vector<std::pair<std::shared_ptr<RequestBatch>, size_t>> unsent_batch_requests;
+    size_t ret;
+    {
+      std::lock_guard guard(pending_requests_mutex_);
+      auto collect = [&batch_requests](int64_t, const PendingRequest & value) {
+          if (auto * batch_request = std::get_if<BatchRequestInfo>(&value.second)) {
+            batch_requests.push_back(*batch_request);
+          }
+          return true;
+        };
+      ret = pending_requests_.erase_oldest_while(collect);
+      ret += pending_intra_process_requests_.erase_oldest_while(collect);
+      for (auto & batch : queued_batches_) {
+        const size_t unsent = batch->requests.size() - batch->next_request;
+        batch->next_request = batch->requests.size();
+        unsent_batch_requests.emplace_back(std::move(batch), unsent);
+      }
+      queued_batches_.clear();
+      queued_request_count_.store(0);
+    }
+    for (auto & batch_request : batch_requests) {
+      complete_batch_request(batch_request, nullptr);
+    }
+    for (auto & batch_and_unsent : unsent_batch_requests) {
+      finish_batch_requests(*batch_and_unsent.first, batch_and_unsent.second);
+    }
     return ret;
   }
 
   /// Clean all pending requests older than a time_point.
   /**
+   * The requests are checked in the order they were sent until one was sent after the time
+   * point, so the cost depends on the number of pruned requests, not of pending requests.
+   * If the system clock jumped back, the requests sent after the jump are pruned only once
+   * the requests sent before it are.
+   *
    * \param[in] time_point Requests that were sent before this point are going to be removed.
    * \param[inout] pruned_requests Removed requests id will be pushed to the vector
    *  if a pointer is provided.
@@ -766,19 +1082,36 @@ public:
     std::chrono::time_point<std::chrono::system_clock> time_point,
     std::vector<int64_t, AllocatorT> * pruned_requests = nullptr)
   {
-    std::lock_guard guard(pending_requests_mutex_);
-    auto old_size = pending_requests_.size();
-    for (auto it = pending_requests_.begin(), last = pending_requests_.end(); it != last; ) {
-      if (it->second.first < time_point) {
-        if (pruned_requests) {
-          pruned_requests->push_back(it->first);
-        }
-        it = pending_requests_.erase(it);
-      } else {
-        ++it;
-      }
+    std::vector<BatchRequestInfo> batch_requests;
+    size_t pruned;
+    {
+      std::lock_guard guard(pending_requests_mutex_);
+      auto prune = [&](int64_t request_id, const PendingRequest & value) {
+          if (value.first >= time_point) {
+            return false;
+          }
+          if (pruned_requests) {
+            pruned_requests->push_back(request_id);
+          }
+          if (auto * batch_request = std::get_if<BatchRequestInfo>(&value.second)) {
+            batch_requests.push_back(*batch_request);
+          }
+          return true;
+        };
+      pruned = pending_requests_.erase_oldest_while(prune);
+      // The intra-process requests are indexed by the opposite of their negative id
+      pruned += pending_intra_process_requests_.erase_oldest_while(
+        [&prune](int64_t sequence_number, const PendingRequest & value) {
+          return prune(-sequence_number, value);
+        });
+    }
+    for (auto & batch_request : batch_requests) {
+      complete_batch_request(batch_request, nullptr);
+    }
+    if (pruned > 0) {
+      send_queued_batch_requests();
     }
-    return old_size - pending_requests_.size();
+    return pruned;
   }
 
 protected:
@@ -786,10 +1119,55 @@ protected:
   using CallbackWithRequestTypeValueVariant = std::tuple<
     CallbackWithRequestType, SharedRequest, SharedFutureWithRequest, PromiseWithRequest>;
 
+  /// Requests sent with async_send_request_batch(), completed together.
+  struct RequestBatch
+  {
+    std::vector<SharedRequest> requests;
+    SharedResponses responses;
+    /// Index of the next request to send, protected by pending_requests_mutex_.
+    size_t next_request {0};
+    /// Number of requests without a response, which weren't removed.
+    std::atomic_size_t remaining {0};
+    std::atomic_bool completed {false};
+    std::promise<SharedResponses> promise;
+    SharedBatchFuture future;
+    BatchCallbackType callback;
+  };
+
+  /// Batch of a request and index of the request in the batch.
+  using BatchRequestInfo = std::pair<std::shared_ptr<RequestBatch>, size_t>;
+
   using CallbackInfoVariant = std::variant<
     std::promise<SharedResponse>,
     CallbackTypeValueVariant,
-    CallbackWithRequestTypeValueVariant>;
+    CallbackWithRequestTypeValueVariant,
+    BatchRequestInfo>;
+
+  using PendingRequest = std::pair<
+    std::chrono::time_point<std::chrono::system_clock>,
+    CallbackInfoVariant>;
+
+  int64_t
+  async_send_request_impl(const SharedRequest & request, CallbackInfoVariant value)
+  {
+    if (client_intra_process_) {
+      auto service = get_intra_process_service();
+      if (service) {
+        int64_t request_id;
+        {
+          std::lock_guard<std::mutex> lock(pending_requests_mutex_);
+          request_id = next_intra_process_request_id_--;
+          pending_intra_process_requests_.emplace(
+            -request_id,
+            std::make_pair(std::chrono::system_clock::now(), std::move(value)));
+        }
+        // Registered first, as the response can be given from another thread right away
+        service->send_request(client_intra_process_, request_id, request);
+        return request_id;
+      }
+    }
+    return async_send_request_impl(*request, std::move(value));
+  }
 
   int64_t
   async_send_request_impl(const Request & request, CallbackInfoVariant value)
@@ -800,7 +1178,7 @@ protected:
     if (RCL_RET_OK != ret) {
       rclcpp::exceptions::throw_from_rcl_error(ret, "failed to send request");
     }
-    pending_requests_.try_emplace(
+    pending_requests_.emplace(
       sequence_number,
       std::make_pair(std::chrono::system_clock::now(), std::move(value)));
     return sequence_number;
@@ -810,27 +1188,249 @@ protected:
   get_and_erase_pending_request(int64_t request_number)
   {
     std::unique_lock<std::mutex> lock(pending_requests_mutex_);
-    auto it = this->pending_requests_.find(request_number);
-    if (it == this->pending_requests_.end()) {
+    auto pending_request = take_pending_request(request_number);
+    if (!pending_request) {
       RCUTILS_LOG_DEBUG_NAMED(
         "rclcpp",
         "Received invalid sequence number. Ignoring...");
       return std::nullopt;
     }
-    auto value = std::move(it->second.second);
-    this->pending_requests_.erase(request_number);
-    return value;
+    return std::move(pending_request->second);
+  }
+
+  /// Remove a pending request and return it, pending_requests_mutex_ must be locked.
+  std::optional<PendingRequest>
+  take_pending_request(int64_t request_id)
+  {
+    if (request_id < 0) {
+      return pending_intra_process_requests_.take(-request_id);
+    }
+    return pending_requests_.take(request_id);
+  }
+
+  void
+  complete_pending_request(CallbackInfoVariant & value, SharedResponse typed_response)
+  {
+    if (std::holds_alternative<Promise>(value)) {
+      auto & promise = std::get<Promise>(value);
+      promise.set_value(std::move(typed_response));
+    } else if (std::holds_alternative<CallbackTypeValueVariant>(value)) {
+      auto & inner = std::get<CallbackTypeValueVariant>(value);
+      const auto & callback = std::get<CallbackType>(inner);
+      auto & promise = std::get<Promise>(inner);
+      auto & future = std::get<SharedFuture>(inner);
+      promise.set_value(std::move(typed_response));
+      callback(std::move(future));
+    } else if (std::holds_alternative<CallbackWithRequestTypeValueVariant>(value)) {
+      auto & inner = std::get<CallbackWithRequestTypeValueVariant>(value);
+      const auto & callback = std::get<CallbackWithRequestType>(inner);
+      auto & promise = std::get<PromiseWithRequest>(inner);
+      auto & future = std::get<SharedFutureWithRequest>(inner);
+      auto & request = std::get<SharedRequest>(inner);
+      promise.set_value(std::make_pair(std::move(request), std::move(typed_response)));
+      callback(std::move(future));
+    } else if (std::holds_alternative<BatchRequestInfo>(value)) {
+      complete_batch_request(std::get<BatchRequestInfo>(value), std::move(typed_response));
+    }
+  }
+
+  SharedBatchFuture
+  async_send_request_batch_impl(std::vector<SharedRequest> requests, BatchCallbackType callback)
+  {
+    auto batch = std::make_shared<RequestBatch>();
+    batch->future = batch->promise.get_future().share();
+    batch->callback = std::move(callback);
+    batch->responses.resize(requests.size());
+    batch->remaining.store(requests.size());
+    batch->requests = std::move(requests);
+    auto future = batch->future;
+    if (batch->requests.empty()) {
+      complete_batch(*batch, nullptr);
+      return future;
+    }
+    {
+      std::lock_guard<std::mutex> lock(pending_requests_mutex_);
+      queued_request_count_ += batch->requests.size();
+      queued_batches_.push_back(std::move(batch));
+    }
+    send_queued_batch_requests();
+    return future;
+  }
+
+  /// Send the queued batched requests while the window has room for them.
+  void
+  send_queued_batch_requests()
+  {
+    while (queued_request_count_.load() > 0) {
+      std::shared_ptr<RequestBatch> batch;
+      size_t index;
+      {
+        std::lock_guard<std::mutex> lock(pending_requests_mutex_);
+        // The requests being sent by other threads are counted until they are pending
+        const size_t outstanding_requests = pending_requests_.size() +
+          pending_intra_process_requests_.size() + sending_request_count_.load();
+        if (
+          queued_batches_.empty() ||
+          (max_outstanding_requests_ > 0 && outstanding_requests >= max_outstanding_requests_))
+        {
+          return;
+        }
+        batch = queued_batches_.front();
+        index = batch->next_request++;
+        if (batch->next_request == batch->requests.size()) {
+          queued_batches_.pop_front();
+        }
+        queued_request_count_--;
+        sending_request_count_++;
+      }
+      try {
+        schedule_request_timeout(
+          async_send_request_impl(batch->requests[index], BatchRequestInfo{batch, index}),
+          get_request_timeout());
+      } catch (...) {
+        size_t unsent;
+        {
+          std::lock_guard<std::mutex> lock(pending_requests_mutex_);
+          sending_request_count_--;
+          unsent = 1 + batch->requests.size() - batch->next_request;
+          if (batch->next_request < batch->requests.size()) {
+            queued_batches_.erase(
+              std::find(queued_batches_.begin(), queued_batches_.end(), batch));
+            queued_request_count_ -= unsent - 1;
+            batch->next_request = batch->requests.size();
+          }
+        }
+        complete_batch(*batch, std::current_exception());
+        finish_batch_requests(*batch, unsent);
+        return;
+      }
+      sending_request_count_--;
+    }
+  }
+
+  /// Set the response of a batched request, nullptr if the request was removed.
+  void
+  complete_batch_request(BatchRequestInfo & batch_request, SharedResponse response)
+  {
+    auto & batch = *batch_request.first;
+    batch.responses[batch_request.second] = std::move(response);
+    finish_batch_requests(batch, 1);
+  }
+
+  /// Count requests of a batch as done, completing the batch after the last one.
+  void
+  finish_batch_requests(RequestBatch & batch, size_t count)
+  {
+    if (batch.remaining.fetch_sub(count) == count) {
+      complete_batch(batch, nullptr);
+    }
+  }
+
+  /// Complete the future of a batch and call its callback, once.
+  void
+  complete_batch(RequestBatch & batch, std::exception_ptr exception)
+  {
+    if (batch.completed.exchange(true)) {
+      return;
+    }
+    if (exception) {
+      batch.promise.set_exception(exception);
+    } else {
+      batch.promise.set_value(std::move(batch.responses));
+    }
+    if (batch.callback) {
+      batch.callback(batch.future);
+    }
+  }
+
+  /// Time out a request after the timeout, if positive.
+  void
+  schedule_request_timeout(int64_t request_id, std::chrono::nanoseconds timeout)
+  {
+    if (timeout <= std::chrono::nanoseconds::zero()) {
+      return;
+    }
+    timeout_scheduler_->schedule(
+      std::chrono::steady_clock::now() + timeout, this->weak_from_this(), request_id);
+  }
+
+  bool
+  time_out_pending_request(int64_t request_id) override
+  {
+    std::optional<PendingRequest> pending_request;
+    {
+      std::lock_guard guard(pending_requests_mutex_);
+      pending_request = take_pending_request(request_id);
+    }
+    if (!pending_request) {
+      return false;
+    }
+    auto & value = pending_request->second;
+    if (auto * batch_request = std::get_if<BatchRequestInfo>(&value)) {
+      complete_batch_request(*batch_request, nullptr);
+    } else {
+      auto exception = std::make_exception_ptr(
+        rclcpp::exceptions::RequestTimeoutError(
+          std::string("request to service '") + get_service_name() + "' timed out"));
+      if (auto * promise = std::get_if<Promise>(&value)) {
+        promise->set_exception(exception);
+      } else if (auto * inner = std::get_if<CallbackTypeValueVariant>(&value)) {
+        std::get<Promise>(*inner).set_exception(exception);
+        std::get<CallbackType>(*inner)(std::move(std::get<SharedFuture>(*inner)));
+      } else if (auto * inner = std::get_if<CallbackWithRequestTypeValueVariant>(&value)) {
+        std::get<PromiseWithRequest>(*inner).set_exception(exception);
+        std::get<CallbackWithRequestType>(*inner)(
+          std::move(std::get<SharedFutureWithRequest>(*inner)));
+      }
+    }
+    send_queued_batch_requests();
+    return true;
+  }
+
+  /// Return the intra-process service with the name of this client, if any.
+  /**
+   * The service is looked up again only when services were added to or removed from the
+   * context since the last call.
+   */
+  std::shared_ptr<ServiceIntraProcessT>
+  get_intra_process_service()
+  {
+    auto ipsm = weak_ipsm_.lock();
+    if (!ipsm) {
+      return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(intra_process_service_mutex_);
+    const uint64_t generation = ipsm->get_generation();
+    if (generation != intra_process_service_generation_) {
+      // A service with the same name but another type doesn't get the requests
+      intra_process_service_ = std::dynamic_pointer_cast<ServiceIntraProcessT>(
+        ipsm->get_service(get_service_name()));
+      intra_process_service_generation_ = generation;
+    }
+    return intra_process_service_.lock();
   }
 
   RCLCPP_DISABLE_COPY(Client)
 
-  std::unordered_map<
-    int64_t,
-    std::pair<
-      std::chrono::time_point<std::chrono::system_clock>,
-      CallbackInfoVariant>>
-  pending_requests_;
+  // The requests are indexed by their sequence number, which increases with each request
+  rclcpp::detail::SequenceNumberTable<PendingRequest> pending_requests_;
+  // The intra-process requests are indexed by the opposite of their negative id
+  rclcpp::detail::SequenceNumberTable<PendingRequest> pending_intra_process_requests_;
   std::mutex pending_requests_mutex_;
+  int64_t next_intra_process_request_id_{-1};
+  // The batches and the window are protected by pending_requests_mutex_
+  std::deque<std::shared_ptr<RequestBatch>> queued_batches_;
+  size_t max_outstanding_requests_{0};
+  std::atomic_size_t queued_request_count_{0};
+  std::atomic_size_t sending_request_count_{0};
+  std::atomic<std::chrono::nanoseconds> request_timeout_{std::chrono::nanoseconds::zero()};
+  rclcpp::detail::RequestTimeoutScheduler::SharedPtr timeout_scheduler_;
+
+  typename ClientIntraProcessT::SharedPtr client_intra_process_;
+  std::weak_ptr<rclcpp::experimental::IntraProcessServiceManager> weak_ipsm_;
+  std::mutex intra_process_service_mutex_;
+  std::weak_ptr<ServiceIntraProcessT> intra_process_service_;
+  uint64_t intra_process_service_generation_{0};
 };
 
 }  // namespace rclcpp
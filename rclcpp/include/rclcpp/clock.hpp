@@ -15,7 +15,9 @@
 #ifndef RCLCPP__CLOCK_HPP_
 #define RCLCPP__CLOCK_HPP_
 
+#include <atomic>
 #include <functional>
+#include <map>
 #include <memory>
 #include <mutex>
 
@@ -32,6 +34,8 @@ namespace rclcpp
 {
 
 class TimeSource;
+// Forward declaration is used for friend statement.
+class ClocksState;
 
 class JumpHandler
 {
@@ -51,6 +55,73 @@ public:
   rcl_jump_threshold_t notice_threshold;
 };
 
+class Clock;
+
+/// ROS time received on the clock topic, shared by the clocks attached to a time source.
+/**
+ * The time source stores each received time once, and the clocks reading it directly,
+ * see Clock::set_shared_ros_time(), load it without locking.
+ * The threads sleeping on these clocks wait in a queue sorted by deadline, and each stored
+ * time only wakes the threads whose deadline it reached.
+ */
+class SharedRosTime
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(SharedRosTime)
+
+  RCLCPP_PUBLIC
+  explicit SharedRosTime(rcl_time_point_value_t nanoseconds = 0);
+
+  /// Store the ROS time.
+  RCLCPP_PUBLIC
+  void
+  set(rcl_time_point_value_t nanoseconds) noexcept;
+
+  /// Get the last stored ROS time.
+  RCLCPP_PUBLIC
+  rcl_time_point_value_t
+  get() const noexcept;
+
+private:
+  friend Clock;
+
+  // Thread sleeping until a deadline
+  struct Waiter;
+  using WaiterQueue = std::multimap<rcl_time_point_value_t, Waiter *>;
+
+  // Queue the waiter, which is woken at once if the deadline is already reached
+  RCLCPP_LOCAL
+  void
+  add_waiter(Waiter & waiter);
+
+  // Remove the waiter from the queue if it wasn't woken
+  RCLCPP_LOCAL
+  void
+  remove_waiter(Waiter & waiter);
+
+  // Wake the waiters of a clock which stopped reading the shared time
+  RCLCPP_LOCAL
+  void
+  cancel_waiters(const void * owner, bool time_source_changed);
+
+  // Wake the waiters whose deadline is reached
+  RCLCPP_LOCAL
+  void
+  wake_waiters(rcl_time_point_value_t nanoseconds);
+
+  // Pop a waiter and wake it, waiters_mutex_ must be locked
+  RCLCPP_LOCAL
+  void
+  wake_waiter(WaiterQueue::iterator it, bool cancelled, bool time_source_changed);
+
+  std::atomic<rcl_time_point_value_t> nanoseconds_;
+
+  std::mutex waiters_mutex_;
+  WaiterQueue waiters_;
+  // Earliest deadline of the waiters, checked without locking on each stored time
+  std::atomic<rcl_time_point_value_t> next_deadline_;
+};
+
 class Clock
 {
 public:
@@ -79,6 +150,20 @@ public:
   Time
   now() const;
 
+  /**
+   * Returns current time in nanoseconds, without constructing a Time.
+   *
+   * Steady and system clocks read the time of the operating system directly, which is
+   * clock_gettime() through the vDSO on Linux, instead of calling through the rcl clock.
+   * This is the time now() returns.
+   *
+   * \return current time in nanoseconds.
+   * \throws anything rclcpp::exceptions::throw_from_rcl_error can throw.
+   */
+  RCLCPP_PUBLIC
+  rcl_time_point_value_t
+  now_nanoseconds() const;
+
   /**
    * Sleep until a specified Time, according to clock type.
    *
@@ -87,6 +172,9 @@ public:
    *   - If ROS time enabled state changes during the sleep, this method will immediately return
    *     false. There is not a consistent choice of sleeping time when the time source changes,
    *     so this is up to the caller to call again if needed.
+   *   - While the clock reads the time shared by a time source, see set_shared_ros_time(),
+   *     the thread is only woken once a received time reaches `until`, otherwise on each
+   *     received time.
    *
    * \warning When using gcc < 10 or when using gcc >= 10 and pthreads lacks the function
    *    `pthread_cond_clockwait`, steady clocks may sleep using the system clock.
@@ -194,6 +282,10 @@ public:
   ros_time_is_active();
 
   /// Return the rcl_clock_t clock handle
+  /**
+   * Once the handle is returned, the clock no longer reads the ROS time from a shared time,
+   * since it may be read through rcl, see set_shared_ros_time().
+   */
   RCLCPP_PUBLIC
   rcl_clock_t *
   get_clock_handle() noexcept;
@@ -235,7 +327,36 @@ public:
     JumpHandler::post_callback_t post_callback,
     const rcl_jump_threshold_t & threshold);
 
+  /// Read the ROS time from a shared time, instead of the rcl clock.
+  /**
+   * Used by the time source the clock is attached to while ROS time is active, so that
+   * the time received on the clock topic is stored once for all the clocks reading it, instead
+   * of being set in each rcl clock.
+   * Only a clock of the type `RCL_ROS_TIME` whose rcl clock isn't used elsewhere, through
+   * get_clock_handle() or by jump callbacks, reads the shared time, and only the shared time
+   * of a single time source.
+   * Otherwise the time source keeps setting the rcl clock, see is_using_shared_ros_time().
+   *
+   * \param shared_ros_time the time to read, or nullptr to read the rcl clock again, which is
+   *   set to the last shared time.
+   */
+  RCLCPP_PUBLIC
+  void
+  set_shared_ros_time(SharedRosTime::SharedPtr shared_ros_time);
+
+  /// Return true if the clock reads the ROS time from a shared time.
+  RCLCPP_PUBLIC
+  bool
+  is_using_shared_ros_time() const noexcept;
+
 private:
+  friend ClocksState;
+
+  // Return the rcl clock handle to the time source, which sets it while the shared time is read
+  RCLCPP_LOCAL
+  rcl_clock_t *
+  get_time_source_clock_handle() noexcept;
+
   // Invoke time jump callback
   RCLCPP_PUBLIC
   static void
@@ -0,0 +1,104 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__CONTENT_FILTER_HPP_
+#define RCLCPP__CONTENT_FILTER_HPP_
+
+#include <memory>
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/serialized_message.hpp"
+#include "rclcpp/subscription_content_filter_options.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+#include "rosidl_runtime_c/message_type_support_struct.h"
+
+namespace rclcpp
+{
+
+/// Content filter evaluated by rclcpp, when the middleware doesn't filter the messages.
+/**
+ * The filter expression is compiled once, against the introspection type support of the
+ * message, and then evaluated against each message.
+ * It supports the subset of the SQL-like grammar of content filtered topics common to the
+ * middlewares:
+ *
+ * - comparisons of a field with a literal, a parameter or another field, with `=`, `<>`,
+ *   `!=`, `<`, `<=`, `>` and `>=`,
+ * - `field LIKE 'pattern'`, where `%` matches any characters and `_` a single one,
+ * - `field BETWEEN low AND high` and `field NOT BETWEEN low AND high`,
+ * - conditions combined with `AND`, `OR`, `NOT` and parentheses.
+ *
+ * The fields are named by their path, e.g. `header.frame_id` or `points[0].x`, an element
+ * beyond the size of a sequence doesn't match any comparison.
+ * The literals are integers, reals, strings in single quotes and `TRUE` or `FALSE`, and the
+ * parameters `%0` to `%99` are replaced by the literal of the expression parameter.
+ * The keywords are case insensitive.
+ *
+ * The matches() member functions are thread-safe.
+ */
+class ContentFilter
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(ContentFilter)
+
+  /// Compile a filter expression.
+  /**
+   * \param[in] options the filter expression and its parameters, not empty.
+   * \param[in] type_support the type support of the messages.
+   * \throws std::invalid_argument if the expression can't be compiled, e.g. for a syntax
+   *   error, an unknown field or a comparison of a string with a number, or if the messages
+   *   don't have an introspection type support.
+   */
+  RCLCPP_PUBLIC
+  ContentFilter(
+    const rclcpp::ContentFilterOptions & options,
+    const rosidl_message_type_support_t * type_support);
+
+  RCLCPP_PUBLIC
+  ~ContentFilter();
+
+  /// Return true if a deserialized message matches the filter.
+  /**
+   * \param[in] message the message, of the ROS message type of the type support.
+   */
+  RCLCPP_PUBLIC
+  bool
+  matches(const void * message) const;
+
+  /// Return true if a serialized message matches the filter.
+  /**
+   * Only the top-level members the expression refers to are decoded, unless the message can't
+   * be decoded partially, see rclcpp::LazyDeserializedMessage.
+   *
+   * \throws anything rclcpp::SerializationBase::deserialize_message can throw.
+   */
+  RCLCPP_PUBLIC
+  bool
+  matches(const rclcpp::SerializedMessage & message) const;
+
+  RCLCPP_PUBLIC
+  const rclcpp::ContentFilterOptions &
+  get_options() const;
+
+private:
+  /// Private internal storage
+  class Impl;
+
+  std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__CONTENT_FILTER_HPP_
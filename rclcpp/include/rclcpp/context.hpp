@@ -30,6 +30,7 @@
 #include "rcl/context.h"
 #include "rcl/guard_condition.h"
 #include "rcl/wait.h"
+#include "rclcpp/deserialization_thread_pool.hpp"
 #include "rclcpp/init_options.hpp"
 #include "rclcpp/macros.hpp"
 #include "rclcpp/visibility_control.hpp"
@@ -178,6 +179,8 @@ public:
    * - each on_shutdown callback is called, in the order that they were added
    * - interrupt blocking sleep_for() calls, so they return early due to shutdown
    * - interrupt blocking executors and wait sets
+   * - with rclcpp::InitOptions::fast_teardown, unregister all the intra-process publishers
+   *   and subscriptions at once
    *
    * The underlying rcl context is not finalized by this function.
    *
@@ -326,6 +329,25 @@ public:
   void
   interrupt_all_sleep_for();
 
+  /// Return the worker pool shared by the background jobs of the context.
+  /**
+   * The short jobs of the nodes of the context, e.g. deserializing the messages of
+   * subscriptions or loading components, can be run by this pool instead of threads of their
+   * own, so that the number of threads stays bounded however many nodes the context has.
+   * The pool is created at first use, with the size and thread attributes of
+   * rclcpp::InitOptions::worker_pool, and is released when the context is shutdown, once
+   * it has run the jobs still queued if no one else holds it.
+   *
+   * The jobs should not block, waiting on the pool or for a long time, as they keep a worker
+   * busy meanwhile.
+   *
+   * \return the worker pool, or nullptr if the context is not valid.
+   * \throws anything rclcpp::DeserializationThreadPool can throw, if the pool must be created.
+   */
+  RCLCPP_PUBLIC
+  rclcpp::DeserializationThreadPool::SharedPtr
+  get_worker_pool();
+
   /// Return a singleton instance for the SubContext type, constructing one if necessary.
   template<typename SubContext, typename ... Args>
   std::shared_ptr<SubContext>
@@ -376,6 +398,9 @@ private:
   // attempt to acquire another sub context.
   std::recursive_mutex sub_contexts_mutex_;
 
+  rclcpp::DeserializationThreadPool::SharedPtr worker_pool_;
+  std::mutex worker_pool_mutex_;
+
   std::unordered_set<std::shared_ptr<OnShutdownCallback>> on_shutdown_callbacks_;
   mutable std::mutex on_shutdown_callbacks_mutex_;
 
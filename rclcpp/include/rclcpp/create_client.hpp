@@ -37,6 +37,9 @@ namespace rclcpp
  * \param[in] qos Quality of service profile for client.
  * \param[in] group Callback group to handle the reply to service calls.
  * \return Shared pointer to the created client.
+ *
+ * When the node uses intra-process communication, the requests to a service of the same
+ * context are given by pointer, see Client::setup_intra_process().
  */
 template<typename ServiceT>
 typename rclcpp::Client<ServiceT>::SharedPtr
@@ -75,6 +78,9 @@ create_client(
     node_graph,
     service_name,
     options);
+  if (node_base->get_use_intra_process_default()) {
+    cli->setup_intra_process();
+  }
 
   auto cli_base_ptr = std::dynamic_pointer_cast<rclcpp::ClientBase>(cli);
   node_services->add_client(cli_base_ptr, group);
@@ -19,6 +19,7 @@
 #include <string>
 #include <utility>
 
+#include "rclcpp/detail/create_publisher_topic_statistics.hpp"
 #include "rclcpp/generic_publisher.hpp"
 #include "rclcpp/node_interfaces/node_topics_interface.hpp"
 #include "rclcpp/publisher_options.hpp"
@@ -39,7 +40,8 @@ namespace rclcpp
  * \param qos %QoS settings
  * \param options %Publisher options.
  * Not all publisher options are currently respected, the only relevant options for this
- * publisher are `event_callbacks`, `use_default_callbacks`, and `%callback_group`.
+ * publisher are `event_callbacks`, `use_default_callbacks`, `use_intra_process_comm`,
+ * `payload_compression`, `topic_stats_options`, and `%callback_group`.
  */
 template<typename AllocatorT = std::allocator<void>>
 std::shared_ptr<GenericPublisher> create_generic_publisher(
@@ -60,6 +62,9 @@ std::shared_ptr<GenericPublisher> create_generic_publisher(
     topic_type,
     qos,
     options);
+  pub->post_init_setup(topics_interface->get_node_base_interface(), options);
+  pub->set_topic_statistics(
+    rclcpp::detail::create_publisher_topic_statistics(*topics_interface, options, qos));
   topics_interface->add_publisher(pub, options.callback_group);
   return pub;
 }
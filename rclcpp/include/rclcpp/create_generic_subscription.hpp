@@ -25,6 +25,7 @@
 #include "rclcpp/node_interfaces/node_topics_interface.hpp"
 #include "rclcpp/qos.hpp"
 #include "rclcpp/serialized_message.hpp"
+#include "rclcpp/serialized_message_view.hpp"
 #include "rclcpp/subscription_options.hpp"
 #include "rclcpp/typesupport_helpers.hpp"
 
@@ -74,6 +75,41 @@ std::shared_ptr<GenericSubscription> create_generic_subscription(
   return subscription;
 }
 
+/// Create and return a GenericSubscription borrowing views of the serialized messages.
+/**
+ * \sa the other overload for a description of the parameters.
+ * \param callback Callback for new messages, with a view of their serialized form, which is
+ * only valid during the callback
+ */
+template<typename AllocatorT = std::allocator<void>>
+std::shared_ptr<GenericSubscription> create_generic_subscription(
+  rclcpp::node_interfaces::NodeTopicsInterface::SharedPtr topics_interface,
+  const std::string & topic_name,
+  const std::string & topic_type,
+  const rclcpp::QoS & qos,
+  GenericSubscription::ViewCallback callback,
+  const rclcpp::SubscriptionOptionsWithAllocator<AllocatorT> & options = (
+    rclcpp::SubscriptionOptionsWithAllocator<AllocatorT>()
+  )
+)
+{
+  auto ts_lib = rclcpp::get_typesupport_library(
+    topic_type, "rosidl_typesupport_cpp");
+
+  auto subscription = std::make_shared<GenericSubscription>(
+    topics_interface->get_node_base_interface(),
+    std::move(ts_lib),
+    topic_name,
+    topic_type,
+    qos,
+    std::move(callback),
+    options);
+
+  topics_interface->add_subscription(subscription, options.callback_group);
+
+  return subscription;
+}
+
 }  // namespace rclcpp
 
 #endif  // RCLCPP__CREATE_GENERIC_SUBSCRIPTION_HPP_
@@ -0,0 +1,90 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__CREATE_NODES_HPP_
+#define RCLCPP__CREATE_NODES_HPP_
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "rclcpp/node.hpp"
+#include "rclcpp/node_options.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// Name, namespace and options of a node created by create_nodes().
+struct NodeCreationRequest
+{
+  std::string node_name;
+  std::string namespace_;
+  rclcpp::NodeOptions options;
+};
+
+/// Time spent in the phases of the creation of nodes, see create_nodes().
+/**
+ * Except for wall_time, the durations are summed over the nodes, which are created in
+ * parallel, so they can exceed the wall clock time.
+ */
+struct NodeStartupProfile
+{
+  /// Number of nodes created.
+  size_t number_of_nodes = 0;
+  /// Wall clock time of the creation of all the nodes.
+  std::chrono::nanoseconds wall_time {0};
+  /// Time spent in the constructors of the nodes, including the phases below.
+  std::chrono::nanoseconds construction {0};
+  /// Time spent expanding and remapping the names and initializing the rcl nodes.
+  std::chrono::nanoseconds node_base {0};
+  /// Time spent setting up the graph interfaces.
+  std::chrono::nanoseconds graph {0};
+  /// Time spent resolving the parameter overrides, declaring the parameters and starting the
+  /// parameter services and publisher.
+  std::chrono::nanoseconds parameters {0};
+  /// Time spent setting up the time sources.
+  std::chrono::nanoseconds time_source {0};
+};
+
+/// Create many nodes in parallel.
+/**
+ * The nodes are constructed by worker threads, only the initialization of the rcl nodes is
+ * serialized, and the parameter overrides of the global arguments are copied once for all the
+ * nodes of a context.
+ * If the construction of a node throws, the other nodes are still created and destroyed, and
+ * the first exception is rethrown.
+ *
+ * \param[in] requests name, namespace and options of each node.
+ * \param[in] number_of_threads number of worker threads, if 0 one per hardware thread, at most
+ *   one per node.
+ * \param[out] profile if not nullptr, it is filled with the time spent in each phase of the
+ *   creation.
+ * \return the nodes, in the order of the requests.
+ */
+RCLCPP_PUBLIC
+std::vector<rclcpp::Node::SharedPtr>
+create_nodes(
+  const std::vector<NodeCreationRequest> & requests,
+  size_t number_of_threads = 0,
+  NodeStartupProfile * profile = nullptr);
+
+/// String conversion function for NodeStartupProfile, one phase per line.
+RCLCPP_PUBLIC
+std::string
+to_string(const NodeStartupProfile & profile);
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__CREATE_NODES_HPP_
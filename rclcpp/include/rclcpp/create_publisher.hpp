@@ -19,6 +19,7 @@
 #include <string>
 #include <utility>
 
+#include "rclcpp/detail/create_publisher_topic_statistics.hpp"
 #include "rclcpp/node_interfaces/get_node_topics_interface.hpp"
 #include "rclcpp/node_interfaces/node_topics_interface.hpp"
 #include "rclcpp/node_options.hpp"
@@ -67,6 +68,8 @@ create_publisher(
     rclcpp::create_publisher_factory<MessageT, AllocatorT, PublisherT>(options),
     actual_qos
   );
+  pub->set_topic_statistics(
+    rclcpp::detail::create_publisher_topic_statistics(*node_topics_interface, options, actual_qos));
 
   // Add the publisher to the node topics interface.
   node_topics_interface->add_publisher(pub, options.callback_group);
@@ -84,6 +87,9 @@ create_publisher(
  * In case `options.qos_overriding_options` is enabling qos parameter overrides,
  * NodeT must also have a method called get_node_parameters_interface()
  * which returns a shared_ptr to a NodeParametersInterface.
+ *
+ * \throws std::invalid_argument if topic statistics is enabled and the publish period is
+ * less than or equal to zero.
  */
 template<
   typename MessageT,
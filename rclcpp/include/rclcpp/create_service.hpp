@@ -37,6 +37,9 @@ namespace rclcpp
  * \param[in] qos Quality of service profile for the service.
  * \param[in] group Callback group to handle the reply to service calls.
  * \return Shared pointer to the created service.
+ *
+ * When the node uses intra-process communication, the requests of the clients of the same
+ * context are received by pointer, see Service::setup_intra_process().
  */
 template<typename ServiceT, typename CallbackT>
 typename rclcpp::Service<ServiceT>::SharedPtr
@@ -74,6 +77,9 @@ create_service(
   auto serv = Service<ServiceT>::make_shared(
     node_base->get_shared_rcl_node_handle(),
     service_name, any_service_callback, service_options);
+  if (node_base->get_use_intra_process_default()) {
+    serv->setup_intra_process(node_base->get_context());
+  }
   auto serv_base_ptr = std::dynamic_pointer_cast<ServiceBase>(serv);
   node_services->add_service(serv_base_ptr, group);
   return serv;
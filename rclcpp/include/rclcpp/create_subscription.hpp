@@ -62,9 +62,7 @@ create_subscription(
   const rclcpp::SubscriptionOptionsWithAllocator<AllocatorT> & options = (
     rclcpp::SubscriptionOptionsWithAllocator<AllocatorT>()
   ),
-  typename MessageMemoryStrategyT::SharedPtr msg_mem_strat = (
-    MessageMemoryStrategyT::create_default()
-  )
+  typename MessageMemoryStrategyT::SharedPtr msg_mem_strat = nullptr
 )
 {
   using rclcpp::node_interfaces::get_node_topics_interface;
@@ -93,7 +91,11 @@ create_subscription(
 
     subscription_topic_stats = std::make_shared<
       rclcpp::topic_statistics::SubscriptionTopicStatistics<ROSMessageType>
-      >(node_topics_interface->get_node_base_interface()->get_name(), publisher);
+      >(
+      node_topics_interface->get_node_base_interface()->get_name(), publisher,
+      options.topic_stats_options.percentiles,
+      options.topic_stats_options.sample_every_n_messages,
+      options.topic_stats_options.max_samples_per_period);
 
     std::weak_ptr<
       rclcpp::topic_statistics::SubscriptionTopicStatistics<ROSMessageType>
@@ -119,7 +121,8 @@ create_subscription(
     subscription_topic_stats->set_publisher_timer(timer);
   }
 
-  auto factory = rclcpp::create_subscription_factory<MessageT>(
+  auto factory = rclcpp::create_subscription_factory<
+    MessageT, CallbackT, AllocatorT, SubscriptionT, MessageMemoryStrategyT>(
     std::forward<CallbackT>(callback),
     options,
     msg_mem_strat,
@@ -161,10 +164,11 @@ create_subscription(
  * \param qos
  * \param callback
  * \param options
- * \param msg_mem_strat
+ * \param msg_mem_strat the message memory strategy, nullptr for the default one using the
+ *   allocator of the options
  * \return the created subscription
  * \throws std::invalid_argument if topic statistics is enabled and the publish period is
- * less than or equal to zero.
+ * less than or equal to zero, a percentile is out of range, or the sampling interval is zero.
  */
 template<
   typename MessageT,
@@ -182,9 +186,7 @@ create_subscription(
   const rclcpp::SubscriptionOptionsWithAllocator<AllocatorT> & options = (
     rclcpp::SubscriptionOptionsWithAllocator<AllocatorT>()
   ),
-  typename MessageMemoryStrategyT::SharedPtr msg_mem_strat = (
-    MessageMemoryStrategyT::create_default()
-  )
+  typename MessageMemoryStrategyT::SharedPtr msg_mem_strat = nullptr
 )
 {
   return rclcpp::detail::create_subscription<
@@ -212,9 +214,7 @@ create_subscription(
   const rclcpp::SubscriptionOptionsWithAllocator<AllocatorT> & options = (
     rclcpp::SubscriptionOptionsWithAllocator<AllocatorT>()
   ),
-  typename MessageMemoryStrategyT::SharedPtr msg_mem_strat = (
-    MessageMemoryStrategyT::create_default()
-  )
+  typename MessageMemoryStrategyT::SharedPtr msg_mem_strat = nullptr
 )
 {
   return rclcpp::detail::create_subscription<
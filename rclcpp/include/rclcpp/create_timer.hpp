@@ -17,6 +17,7 @@
 
 #include <chrono>
 #include <exception>
+#include <functional>
 #include <memory>
 #include <string>
 #include <utility>
@@ -28,6 +29,7 @@
 #include "rclcpp/node_interfaces/node_base_interface.hpp"
 #include "rclcpp/node_interfaces/node_clock_interface.hpp"
 #include "rclcpp/node_interfaces/node_timers_interface.hpp"
+#include "rclcpp/timer_coalescer.hpp"
 
 namespace rclcpp
 {
@@ -205,6 +207,80 @@ create_wall_timer(
   node_timers->add_timer(timer, group);
   return timer;
 }
+
+/// Create a timer sharing an rcl timer with the timers of the node with a close period.
+/**
+ * The timers of the node with the same clock and callback group, and with a period within the
+ * tolerance, share a single rcl timer calling their callbacks in turn, see
+ * rclcpp::TimerCoalescer.
+ *
+ * \param clock clock to be used
+ * \param period period to execute callback. This duration must be 0 <= period < nanoseconds::max()
+ * \param tolerance maximum difference between the period and the one of a shared timer
+ * \param callback callback to execute via the timer period
+ * \param group callback group
+ * \param node_base node base interface
+ * \param node_timers node timer interface
+ * \return shared pointer to the handle of the coalesced timer, which cancels it when destroyed
+ * \throws std::invalid_argument if either clock, node_base or node_timers
+ * are nullptr, or period or tolerance is negative or too large
+ */
+template<typename DurationRepT, typename DurationT, typename CallbackT>
+rclcpp::CoalescedTimer::SharedPtr
+create_coalesced_timer(
+  rclcpp::Clock::SharedPtr clock,
+  std::chrono::duration<DurationRepT, DurationT> period,
+  std::chrono::nanoseconds tolerance,
+  CallbackT callback,
+  rclcpp::CallbackGroup::SharedPtr group,
+  node_interfaces::NodeBaseInterface * node_base,
+  node_interfaces::NodeTimersInterface * node_timers)
+{
+  if (node_base == nullptr) {
+    throw std::invalid_argument{"input node_base cannot be null"};
+  }
+  if (node_timers == nullptr) {
+    throw std::invalid_argument{"input node_timers cannot be null"};
+  }
+
+  const std::chrono::nanoseconds period_ns = detail::safe_cast_to_period_in_ns(period);
+
+  return node_timers->get_timer_coalescer()->add_timer(
+    std::move(clock), period_ns, tolerance, std::function<void()>(std::move(callback)),
+    std::move(group));
+}
+
+/// Create a wall timer sharing an rcl timer with the wall timers of the node with a close period.
+/**
+ * \sa rclcpp::create_coalesced_timer()
+ *
+ * \param period period to execute callback. This duration must be 0 <= period < nanoseconds::max()
+ * \param tolerance maximum difference between the period and the one of a shared timer
+ * \param callback callback to execute via the timer period
+ * \param group callback group
+ * \param node_base node base interface
+ * \param node_timers node timer interface
+ * \return shared pointer to the handle of the coalesced timer, which cancels it when destroyed
+ * \throws std::invalid_argument if either node_base or node_timers
+ * are null, or period or tolerance is negative or too large
+ */
+template<typename DurationRepT, typename DurationT, typename CallbackT>
+rclcpp::CoalescedTimer::SharedPtr
+create_coalesced_wall_timer(
+  std::chrono::duration<DurationRepT, DurationT> period,
+  std::chrono::nanoseconds tolerance,
+  CallbackT callback,
+  rclcpp::CallbackGroup::SharedPtr group,
+  node_interfaces::NodeBaseInterface * node_base,
+  node_interfaces::NodeTimersInterface * node_timers)
+{
+  if (node_timers == nullptr) {
+    throw std::invalid_argument{"input node_timers cannot be null"};
+  }
+  return create_coalesced_timer(
+    node_timers->get_timer_coalescer()->get_steady_clock(), period, tolerance,
+    std::move(callback), std::move(group), node_base, node_timers);
+}
 }  // namespace rclcpp
 
 #endif  // RCLCPP__CREATE_TIMER_HPP_
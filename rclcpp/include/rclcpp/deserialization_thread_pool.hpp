@@ -0,0 +1,109 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__DESERIALIZATION_THREAD_POOL_HPP_
+#define RCLCPP__DESERIALIZATION_THREAD_POOL_HPP_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/thread.hpp"
+#include "rclcpp/thread_attributes.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// Worker threads deserializing the messages of subscriptions off the executor threads.
+/**
+ * A pool can be shared by the subscriptions of several nodes and executors, see
+ * rclcpp::SubscriptionOptionsBase::deserialization_thread_pool.
+ * It runs any other short job as well, e.g. the worker pool of a context, see
+ * rclcpp::Context::get_worker_pool().
+ */
+class DeserializationThreadPool
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(DeserializationThreadPool)
+
+  /// Start the worker threads.
+  /**
+   * \param[in] number_of_threads number of worker threads, 0 to use the number of cores.
+   */
+  RCLCPP_PUBLIC
+  explicit DeserializationThreadPool(size_t number_of_threads = 0);
+
+  /// Start the worker threads with the given attributes, e.g. to pin them to some CPUs.
+  /**
+   * \param[in] number_of_threads number of worker threads, 0 to use the number of cores.
+   * \param[in] thread_attributes attributes of each worker thread, the threads without
+   *   attributes are created with the default ones.
+   * \throws anything rclcpp::Thread can throw, if a worker thread cannot be created.
+   */
+  RCLCPP_PUBLIC
+  DeserializationThreadPool(
+    size_t number_of_threads,
+    const std::vector<ThreadAttributes> & thread_attributes);
+
+  /// Run the jobs still queued and join the worker threads.
+  RCLCPP_PUBLIC
+  virtual ~DeserializationThreadPool();
+
+  /// Queue a job to be run by one of the worker threads.
+  /**
+   * \throws std::invalid_argument if the job isn't callable.
+   */
+  RCLCPP_PUBLIC
+  void
+  post(std::function<void()> job);
+
+  /// Return the number of worker threads.
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_threads() const;
+
+private:
+  void
+  stop();
+
+  void
+  run();
+
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  std::deque<std::function<void()>> jobs_;
+  bool stopping_ = false;
+  std::vector<rclcpp::Thread> threads_;
+};
+
+/// Size and attributes of the worker pool of a context, see rclcpp::Context::get_worker_pool().
+struct WorkerPoolOptions
+{
+  /// Number of worker threads, 0 to use the number of cores.
+  size_t number_of_threads = 0;
+  /// Attributes of each worker thread, e.g. to pin them to some CPUs.
+  /**
+   * The threads without attributes are created with the default ones.
+   */
+  std::vector<ThreadAttributes> thread_attributes;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DESERIALIZATION_THREAD_POOL_HPP_
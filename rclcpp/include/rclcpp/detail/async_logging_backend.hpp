@@ -0,0 +1,174 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__DETAIL__ASYNC_LOGGING_BACKEND_HPP_
+#define RCLCPP__DETAIL__ASYNC_LOGGING_BACKEND_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/async_logging.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/visibility_control.hpp"
+#include "rcutils/logging.h"
+#include "rcutils/time.h"
+
+namespace rclcpp
+{
+namespace detail
+{
+
+/// \internal Buffers of the log messages of each thread, written by a background thread.
+/**
+ * Each logging thread has a bounded single producer, single consumer ring of fixed size
+ * records, so enqueuing a message only takes a lock the first time a thread logs.
+ * The arguments of the messages are formatted into the records on the logging thread, as
+ * they may not outlive the logging call, the rest, e.g. the console format, the writes and
+ * the /rosout publication, is done by the background thread.
+ *
+ * The background thread writes the messages with the logging mutex held, it merges the
+ * records of the threads by timestamp within each pass.
+ */
+class AsyncLoggingBackend
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(AsyncLoggingBackend)
+
+  /// Longest log message text buffered, including the terminating null character.
+  static constexpr size_t max_message_size = 1024;
+
+  /// Longest logger name buffered, including the terminating null character.
+  static constexpr size_t max_name_size = 128;
+
+  /// Constructor.
+  /**
+   * \param[in] logging_mutex the mutex held while writing the log messages.
+   * \throws std::invalid_argument if the mutex is null.
+   */
+  RCLCPP_PUBLIC
+  explicit AsyncLoggingBackend(std::shared_ptr<std::recursive_mutex> logging_mutex);
+
+  /// Write the buffered log messages and join the background thread, see stop().
+  RCLCPP_PUBLIC
+  virtual ~AsyncLoggingBackend();
+
+  /// Start buffering the log messages, unless the depth of the options is 0.
+  /**
+   * A backend already started is stopped first.
+   * It must not be called concurrently with stop().
+   * \param[in] options the depth of the buffers and the flush period.
+   * \param[in] output_handler written to by the background thread, with the mutex held.
+   */
+  RCLCPP_PUBLIC
+  void
+  start(
+    const rclcpp::AsyncLoggingOptions & options,
+    rcutils_logging_output_handler_t output_handler);
+
+  /// Stop buffering the log messages, and write the ones still buffered on the calling thread.
+  /**
+   * It may be called with the logging mutex held.
+   */
+  RCLCPP_PUBLIC
+  void
+  stop();
+
+  /// Return true if the log messages are buffered.
+  RCLCPP_PUBLIC
+  bool
+  is_started() const;
+
+  /// Buffer a log message, with the same arguments as a rcutils output handler.
+  /**
+   * \return false if the message must be written by the caller, i.e. the backend isn't
+   *   started or it is a fatal message, true if it was buffered or dropped.
+   */
+  RCLCPP_PUBLIC
+  bool
+  enqueue(
+    const rcutils_log_location_t * location,
+    int severity, const char * name, rcutils_time_point_value_t timestamp,
+    const char * format, va_list * args);
+
+  /// Wait until the log messages buffered before the call are written.
+  /**
+   * It must not be called with the logging mutex held, nor by the output handler.
+   */
+  RCLCPP_PUBLIC
+  void
+  flush();
+
+  RCLCPP_PUBLIC
+  rclcpp::AsyncLoggingStatistics
+  get_statistics() const;
+
+private:
+  class ThreadBuffer;
+
+  /// Return the buffer of the calling thread, registering it the first time.
+  ThreadBuffer &
+  get_thread_buffer();
+
+  void
+  run();
+
+  /// Take the logging mutex and write the buffered messages, false if stopped meanwhile.
+  bool
+  try_write_buffered();
+
+  /// Write the messages buffered before the call, with the logging mutex held.
+  void
+  write_buffered();
+
+  std::shared_ptr<std::recursive_mutex> logging_mutex_;
+  rcutils_logging_output_handler_t output_handler_ = nullptr;
+  rclcpp::AsyncLoggingOptions options_;
+  /// Distinguishes the thread buffers of this backend, and of this start, from the others.
+  uint64_t id_ = 0;
+
+  std::atomic<bool> started_{false};
+  /// Number of enqueue calls in progress, stop() waits for them.
+  std::atomic<size_t> producer_count_{0};
+
+  mutable std::mutex buffers_mutex_;
+  std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+  /// Counts of the buffers removed once their thread exited.
+  rclcpp::AsyncLoggingStatistics retired_statistics_;
+  std::atomic<uint64_t> written_count_{0};
+
+  std::mutex wake_mutex_;
+  std::condition_variable wake_condition_;
+  std::condition_variable flushed_condition_;
+  std::atomic<bool> stopping_{false};
+  uint64_t flush_requested_ = 0;
+  uint64_t flushed_ = 0;
+  std::thread::id thread_id_;
+  std::thread thread_;
+};
+
+/// \internal Return the backend used by the rclcpp logging output handler.
+RCLCPP_PUBLIC
+AsyncLoggingBackend &
+get_global_async_logging_backend();
+
+}  // namespace detail
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DETAIL__ASYNC_LOGGING_BACKEND_HPP_
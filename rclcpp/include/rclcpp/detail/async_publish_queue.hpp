@@ -0,0 +1,268 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__DETAIL__ASYNC_PUBLISH_QUEUE_HPP_
+#define RCLCPP__DETAIL__ASYNC_PUBLISH_QUEUE_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/async_publishing.hpp"
+#include "rclcpp/experimental/buffers/buffer_metrics.hpp"
+#include "rclcpp/experimental/buffers/lock_free_ring_buffer_implementation.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace detail
+{
+
+class AsyncPublishQueueBase;
+
+/// Thread publishing the queued messages of the asynchronous publishers of a context.
+/**
+ * It's a sub-context of rclcpp::Context, shared by all its asynchronous publishers.
+ * A queue is posted when a message is enqueued into it while it wasn't already scheduled, so
+ * the sender thread is woken up once per burst of messages rather than once per message.
+ */
+class AsyncPublishSender
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(AsyncPublishSender)
+
+  /// Start the sender thread.
+  RCLCPP_PUBLIC
+  AsyncPublishSender();
+
+  /// Send the queues still posted and join the sender thread.
+  RCLCPP_PUBLIC
+  virtual ~AsyncPublishSender();
+
+  /// Schedule the queued messages of a queue to be published by the sender thread.
+  RCLCPP_PUBLIC
+  void
+  post(std::shared_ptr<AsyncPublishQueueBase> queue);
+
+private:
+  void
+  run();
+
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  /// Swapped with the queues being sent, so posting doesn't allocate once both have grown.
+  std::vector<std::shared_ptr<AsyncPublishQueueBase>> posted_queues_;
+  bool stopping_ = false;
+  std::thread thread_;
+};
+
+/// Non-templated part of AsyncPublishQueue.
+/**
+ * It implements the overflow policies, the scheduling on the sender thread and the metrics,
+ * while the derived class stores the messages and publishes them.
+ */
+class AsyncPublishQueueBase : public std::enable_shared_from_this<AsyncPublishQueueBase>
+{
+public:
+  RCLCPP_SMART_PTR_ALIASES_ONLY(AsyncPublishQueueBase)
+
+  RCLCPP_PUBLIC
+  AsyncPublishQueueBase(
+    const rclcpp::AsyncPublishingOptions & options,
+    std::shared_ptr<AsyncPublishSender> sender);
+
+  RCLCPP_PUBLIC
+  virtual ~AsyncPublishQueueBase();
+
+  /// Publish the queued messages, called by the sender thread.
+  RCLCPP_PUBLIC
+  void
+  send();
+
+  /// Publish the messages still queued on the calling thread, and stop sending.
+  /**
+   * It waits for the sender thread to be done with the queue, after it returns the publish
+   * function isn't called anymore.
+   * The owner of the queue must call it, as it releases the sender, which must not be
+   * destroyed by the sender thread when the queue is.
+   */
+  RCLCPP_PUBLIC
+  void
+  close();
+
+  /// Wait until all the queued messages were published.
+  /**
+   * \param[in] timeout the maximum time to wait, a negative value waits forever.
+   * \return true if the queue was emptied within the timeout.
+   */
+  RCLCPP_PUBLIC
+  bool
+  wait_until_sent(std::chrono::nanoseconds timeout);
+
+  RCLCPP_PUBLIC
+  rclcpp::AsyncPublishingStatistics
+  get_statistics() const;
+
+protected:
+  /// Apply the overflow policy before enqueuing, return false if the message is dropped.
+  RCLCPP_PUBLIC
+  bool
+  make_room();
+
+  /// Post the queue to the sender thread if it isn't already scheduled, after enqueuing.
+  RCLCPP_PUBLIC
+  void
+  schedule();
+
+  /// Free the room of a message dequeued, before publishing it.
+  RCLCPP_PUBLIC
+  void
+  release_slot();
+
+  /// Publish the oldest queued message, return false if the queue is empty.
+  virtual bool
+  publish_next() = 0;
+
+  virtual bool
+  has_data() const = 0;
+
+  virtual rclcpp::experimental::buffers::BufferMetrics
+  get_queue_metrics() const = 0;
+
+  const rclcpp::AsyncPublishingOptions options_;
+
+private:
+  /// Publish the queued messages, with send_mutex_ held.
+  void
+  publish_queued_messages();
+
+  /// Wake up the publish calls waiting for room, if any.
+  void
+  notify_waiting_threads();
+
+  /// Count a message about to be enqueued, return false if depth messages are already.
+  bool
+  reserve_slot();
+
+  std::shared_ptr<AsyncPublishSender> sender_;
+  std::atomic<bool> scheduled_{false};
+
+  /// Held while publishing, so close() waits for the sender thread.
+  std::mutex send_mutex_;
+  bool closed_ = false;
+
+  /// Only used by the threads waiting for room in the queue or for it to be emptied.
+  std::mutex wait_mutex_;
+  std::condition_variable wait_condition_;
+  std::atomic<size_t> waiting_count_{0};
+
+  /// Number of messages enqueued or being enqueued, unless the oldest ones are dropped.
+  std::atomic<size_t> reserved_count_{0};
+
+  std::atomic<uint64_t> published_count_{0};
+  std::atomic<uint64_t> rejected_count_{0};
+  std::atomic<uint64_t> blocked_count_{0};
+  std::atomic<uint64_t> failed_count_{0};
+};
+
+/// Bounded queue of the messages of an asynchronous publisher.
+/**
+ * The messages are stored in a lock-free ring buffer, which the publishing threads enqueue into
+ * and the sender thread dequeues from, so a publish call only takes a lock when it has to
+ * wake up the sender thread, or to wait with AsyncPublishingOverflowPolicy::Block.
+ */
+template<typename MessageT>
+class AsyncPublishQueue : public AsyncPublishQueueBase
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(AsyncPublishQueue)
+
+  using MessageSharedPtr = std::shared_ptr<const MessageT>;
+  using PublishFunction = std::function<void (const MessageT &)>;
+
+  /// Constructor.
+  /**
+   * \param[in] options the depth, greater than 0, and the overflow policy of the queue.
+   * \param[in] sender the sender thread of the context.
+   * \param[in] publish function publishing a message to the middleware.
+   * \throws std::invalid_argument if the depth is 0.
+   */
+  AsyncPublishQueue(
+    const rclcpp::AsyncPublishingOptions & options,
+    std::shared_ptr<AsyncPublishSender> sender,
+    PublishFunction publish)
+  : AsyncPublishQueueBase(options, std::move(sender)),
+    buffer_(options.depth),
+    publish_(std::move(publish))
+  {}
+
+  ~AsyncPublishQueue() override
+  {
+    close();
+  }
+
+  /// Queue a message for the sender thread, return false if the overflow policy dropped it.
+  bool
+  enqueue(MessageSharedPtr message)
+  {
+    if (!make_room()) {
+      return false;
+    }
+    buffer_.enqueue(std::move(message));
+    schedule();
+    return true;
+  }
+
+protected:
+  bool
+  publish_next() override
+  {
+    MessageSharedPtr message = buffer_.dequeue();
+    if (!message) {
+      return false;
+    }
+    release_slot();
+    publish_(*message);
+    return true;
+  }
+
+  bool
+  has_data() const override
+  {
+    return buffer_.has_data();
+  }
+
+  rclcpp::experimental::buffers::BufferMetrics
+  get_queue_metrics() const override
+  {
+    return buffer_.get_metrics();
+  }
+
+private:
+  rclcpp::experimental::buffers::MultiProducerRingBufferImplementation<MessageSharedPtr> buffer_;
+  PublishFunction publish_;
+};
+
+}  // namespace detail
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DETAIL__ASYNC_PUBLISH_QUEUE_HPP_
@@ -0,0 +1,52 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__DETAIL__CREATE_PUBLISHER_TOPIC_STATISTICS_HPP_
+#define RCLCPP__DETAIL__CREATE_PUBLISHER_TOPIC_STATISTICS_HPP_
+
+#include "rclcpp/node_interfaces/node_topics_interface.hpp"
+#include "rclcpp/publisher_options.hpp"
+#include "rclcpp/qos.hpp"
+#include "rclcpp/topic_statistics/publisher_topic_statistics.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace detail
+{
+
+/// Create the topic statistics of a publisher, if enabled in its options.
+/**
+ * The statistics publisher uses the given QoS, and the statistics are published by a wall timer
+ * of the node, in the callback group of the options.
+ *
+ * \param node_topics the topics interface of the node creating the publisher
+ * \param options the options of the publisher
+ * \param qos the QoS of the publisher
+ * \return the topic statistics, nullptr if they are disabled
+ * \throws std::invalid_argument if topic statistics is enabled and the publish period is
+ * less than or equal to zero.
+ */
+RCLCPP_PUBLIC
+rclcpp::topic_statistics::PublisherTopicStatistics::SharedPtr
+create_publisher_topic_statistics(
+  rclcpp::node_interfaces::NodeTopicsInterface & node_topics,
+  const rclcpp::PublisherOptionsBase & options,
+  const rclcpp::QoS & qos);
+
+}  // namespace detail
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DETAIL__CREATE_PUBLISHER_TOPIC_STATISTICS_HPP_
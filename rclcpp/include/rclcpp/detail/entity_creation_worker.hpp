@@ -0,0 +1,82 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__DETAIL__ENTITY_CREATION_WORKER_HPP_
+#define RCLCPP__DETAIL__ENTITY_CREATION_WORKER_HPP_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace detail
+{
+
+/// Thread creating the entities of the nodes of a context asynchronously.
+/**
+ * It's a sub-context of rclcpp::Context, shared by the nodes creating entities with e.g.
+ * rclcpp::Node::create_subscription_async().
+ * The creations run one at a time in the order they were posted, as the middleware serializes
+ * most of them anyway.
+ */
+class EntityCreationWorker
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(EntityCreationWorker)
+
+  /// Start the worker thread.
+  RCLCPP_PUBLIC
+  EntityCreationWorker();
+
+  /// Run the creations still posted and join the worker thread.
+  /**
+   * If the last reference to the worker is released by one of its creations, e.g. with the
+   * last node of the context, the worker thread is detached instead and exits once done.
+   */
+  RCLCPP_PUBLIC
+  virtual ~EntityCreationWorker();
+
+  /// Schedule a creation on the worker thread, it must not throw.
+  RCLCPP_PUBLIC
+  void
+  post(std::function<void()> creation);
+
+private:
+  struct State
+  {
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<std::function<void()>> creations;
+    bool stopping = false;
+  };
+
+  static void
+  run(std::shared_ptr<State> state);
+
+  /// Shared with the worker thread, which may outlive the worker when detached.
+  std::shared_ptr<State> state_;
+  std::thread thread_;
+};
+
+}  // namespace detail
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DETAIL__ENTITY_CREATION_WORKER_HPP_
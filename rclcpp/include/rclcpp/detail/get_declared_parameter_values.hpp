@@ -0,0 +1,54 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__DETAIL__GET_DECLARED_PARAMETER_VALUES_HPP_
+#define RCLCPP__DETAIL__GET_DECLARED_PARAMETER_VALUES_HPP_
+
+#include <vector>
+
+#include "rclcpp/exceptions.hpp"
+#include "rclcpp/node_interfaces/node_parameters_interface.hpp"
+#include "rclcpp/parameter_value.hpp"
+
+namespace rclcpp
+{
+
+namespace detail
+{
+
+/// Return the values of parameters declared together, converted to their type.
+template<typename ParameterT>
+std::vector<ParameterT>
+get_declared_parameter_values(
+  const std::vector<rclcpp::node_interfaces::ParameterDeclaration> & declarations,
+  const std::vector<rclcpp::ParameterValue> & values)
+{
+  std::vector<ParameterT> result;
+  result.reserve(values.size());
+  for (size_t i = 0; i < values.size(); ++i) {
+    try {
+      result.push_back(values[i].get<ParameterT>());
+    } catch (const ParameterTypeException & ex) {
+      throw exceptions::InvalidParameterTypeException(declarations[i].name, ex.what());
+    }
+  }
+  return result;
+}
+
+}  // namespace detail
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DETAIL__GET_DECLARED_PARAMETER_VALUES_HPP_
@@ -22,6 +22,7 @@
 #include <map>
 #include <string>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "rcl_interfaces/msg/parameter_descriptor.hpp"
@@ -104,6 +105,47 @@ declare_parameter_or_get(
   }
 }
 
+/// \internal Declare the parameters not declared yet at once, and get the values of all of them.
+/**
+ * The parameters are validated and the callbacks called once, and a single parameter event
+ * is published, instead of once per parameter.
+ */
+inline
+std::vector<rclcpp::ParameterValue>
+declare_parameters_or_get(
+  rclcpp::node_interfaces::NodeParametersInterface & parameters_interface,
+  const std::vector<rclcpp::node_interfaces::ParameterDeclaration> & declarations)
+{
+  std::vector<rclcpp::ParameterValue> values(declarations.size());
+  std::vector<rclcpp::node_interfaces::ParameterDeclaration> undeclared;
+  std::vector<size_t> undeclared_indices;
+  for (size_t i = 0; i < declarations.size(); ++i) {
+    if (parameters_interface.has_parameter(declarations[i].name)) {
+      values[i] = parameters_interface.get_parameter(declarations[i].name).get_parameter_value();
+    } else {
+      undeclared.push_back(declarations[i]);
+      undeclared_indices.push_back(i);
+    }
+  }
+  if (undeclared.empty()) {
+    return values;
+  }
+  try {
+    auto declared_values = parameters_interface.declare_parameters(undeclared);
+    for (size_t i = 0; i < declared_values.size(); ++i) {
+      values[undeclared_indices[i]] = std::move(declared_values[i]);
+    }
+  } catch (const rclcpp::exceptions::ParameterAlreadyDeclaredException &) {
+    // Declared by another thread in the meantime
+    for (size_t i = 0; i < undeclared.size(); ++i) {
+      values[undeclared_indices[i]] = declare_parameter_or_get(
+        parameters_interface, undeclared[i].name, undeclared[i].default_value,
+        undeclared[i].descriptor);
+    }
+  }
+  return values;
+}
+
 #ifdef DOXYGEN_ONLY
 /// \internal Declare QoS parameters for the given entity.
 /**
@@ -163,24 +205,28 @@ declare_qos_parameters(
     }
     param_description_suffix = oss.str();
   }
-  rclcpp::QoS qos = default_qos;
+  // The parameters of all the policies are declared at once
+  std::vector<rclcpp::QosPolicyKind> policies;
+  std::vector<rclcpp::node_interfaces::ParameterDeclaration> declarations;
   for (auto policy : EntityQosParametersTraits::allowed_policies()) {
     if (
       std::count(options.get_policy_kinds().begin(), options.get_policy_kinds().end(), policy))
     {
-      std::ostringstream param_name{param_prefix, std::ios::ate};
-      param_name << qos_policy_kind_to_cstr(policy);
-      std::ostringstream param_desciption{"qos policy {", std::ios::ate};
-      param_desciption << qos_policy_kind_to_cstr(policy) << param_description_suffix;
-      rcl_interfaces::msg::ParameterDescriptor descriptor{};
-      descriptor.description = param_desciption.str();
-      descriptor.read_only = true;
-      auto value = declare_parameter_or_get(
-        parameters_interface, param_name.str(),
-        get_default_qos_param_value(policy, qos), descriptor);
-      ::rclcpp::detail::apply_qos_override(policy, value, qos);
+      rclcpp::node_interfaces::ParameterDeclaration declaration;
+      declaration.name = param_prefix + qos_policy_kind_to_cstr(policy);
+      declaration.default_value = get_default_qos_param_value(policy, default_qos);
+      declaration.descriptor.description =
+        std::string("qos policy {") + qos_policy_kind_to_cstr(policy) + param_description_suffix;
+      declaration.descriptor.read_only = true;
+      policies.push_back(policy);
+      declarations.push_back(std::move(declaration));
     }
   }
+  rclcpp::QoS qos = default_qos;
+  auto values = declare_parameters_or_get(parameters_interface, declarations);
+  for (size_t i = 0; i < policies.size(); ++i) {
+    ::rclcpp::detail::apply_qos_override(policies[i], values[i], qos);
+  }
   const auto & validation_callback = options.get_validation_callback();
   if (validation_callback) {
     auto result = validation_callback(qos);
@@ -0,0 +1,124 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__DETAIL__REQUEST_TIMEOUT_SCHEDULER_HPP_
+#define RCLCPP__DETAIL__REQUEST_TIMEOUT_SCHEDULER_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+class ClientBase;
+class Context;
+
+namespace detail
+{
+
+/// \internal Deadlines of the pending requests of the clients of a context.
+/**
+ * A single thread waits for the earliest deadline and times out the request if it's still
+ * pending, see rclcpp::ClientBase::time_out_pending_request().
+ * The thread is started with the first deadline and stopped when the context is shut down.
+ *
+ * A deadline isn't removed when its request completes first, it's dropped once reached,
+ * so at most the requests sent during the longest timeout are queued.
+ */
+class RequestTimeoutScheduler
+  : public std::enable_shared_from_this<RequestTimeoutScheduler>
+{
+public:
+  RCLCPP_SMART_PTR_ALIASES_ONLY(RequestTimeoutScheduler)
+
+  RCLCPP_PUBLIC
+  explicit RequestTimeoutScheduler(const std::shared_ptr<rclcpp::Context> & context);
+
+  RCLCPP_PUBLIC
+  ~RequestTimeoutScheduler();
+
+  /// Time out a request of a client at a deadline, if it's still pending then.
+  /**
+   * Nothing is scheduled once the scheduler is shut down.
+   *
+   * \param[in] deadline time point after which the request times out.
+   * \param[in] client client which sent the request.
+   * \param[in] request_id id of the request, as returned when it was sent.
+   */
+  RCLCPP_PUBLIC
+  void
+  schedule(
+    std::chrono::steady_clock::time_point deadline,
+    std::weak_ptr<rclcpp::ClientBase> client,
+    int64_t request_id);
+
+  /// Return the number of deadlines which weren't reached yet.
+  RCLCPP_PUBLIC
+  size_t
+  get_scheduled_count() const;
+
+  /// Stop the thread, the requests aren't timed out anymore.
+  RCLCPP_PUBLIC
+  void
+  shutdown();
+
+private:
+  RCLCPP_DISABLE_COPY(RequestTimeoutScheduler)
+
+  struct Deadline
+  {
+    std::chrono::steady_clock::time_point time;
+    std::weak_ptr<rclcpp::ClientBase> client;
+    int64_t request_id;
+
+    bool
+    operator>(const Deadline & other) const
+    {
+      return time > other.time;
+    }
+  };
+
+  /// Wait until deadlines are reached and move them to expired, false once shut down.
+  RCLCPP_LOCAL
+  bool
+  wait_for_expired_deadlines(std::vector<Deadline> & expired);
+
+  RCLCPP_LOCAL
+  static void
+  run(std::weak_ptr<RequestTimeoutScheduler> weak_this);
+
+  std::weak_ptr<rclcpp::Context> weak_context_;
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::priority_queue<Deadline, std::vector<Deadline>, std::greater<Deadline>> deadlines_;
+  std::thread thread_;
+  bool is_started_ = false;
+  bool is_shutdown_ = false;
+};
+
+}  // namespace detail
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DETAIL__REQUEST_TIMEOUT_SCHEDULER_HPP_
@@ -0,0 +1,140 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__DETAIL__ROSOUT_BATCHER_HPP_
+#define RCLCPP__DETAIL__ROSOUT_BATCHER_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "rcl_interfaces/msg/log.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/rosout_batching.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace detail
+{
+
+/// \internal Batching and rate limiting of the /rosout messages, see RosoutBatchingOptions.
+/**
+ * The batches and the rate limit summaries are published by a background thread, which holds
+ * no lock while publishing, so that a log message of the publication doesn't deadlock.
+ * Without batching, the messages allowed by the rate limit are published by the caller.
+ */
+class RosoutBatcher
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(RosoutBatcher)
+
+  using PublishFunction = std::function<void (const rcl_interfaces::msg::Log &)>;
+
+  /// Start the background thread.
+  /**
+   * \throws std::invalid_argument if the function is empty, or if the options neither batch
+   *   nor limit the rate.
+   */
+  RCLCPP_PUBLIC
+  RosoutBatcher(const rclcpp::RosoutBatchingOptions & options, PublishFunction publish);
+
+  /// Join the background thread, the pending batches are dropped unless close() was called.
+  RCLCPP_PUBLIC
+  virtual ~RosoutBatcher();
+
+  /// Return true if the options batch or limit the rate, i.e. a batcher is needed.
+  RCLCPP_PUBLIC
+  static bool
+  is_enabled(const rclcpp::RosoutBatchingOptions & options);
+
+  /// Batch a log message, publish it or suppress it.
+  RCLCPP_PUBLIC
+  void
+  add(rcl_interfaces::msg::Log && log);
+
+  /// Join the background thread and publish the pending batches and summaries.
+  /**
+   * They are published on the calling thread, the log messages added after it returns are
+   * published by the caller of add() without batching nor rate limit.
+   */
+  RCLCPP_PUBLIC
+  void
+  close();
+
+  /// Return the number of log messages suppressed by the rate limit.
+  RCLCPP_PUBLIC
+  uint64_t
+  get_suppressed_count() const;
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct LoggerState
+  {
+    /// Batch being accumulated, if batch_size isn't 0.
+    rcl_interfaces::msg::Log batch;
+    size_t batch_size = 0;
+    Clock::time_point batch_deadline;
+    /// Start of the second of the rate limit, and the messages allowed in it.
+    Clock::time_point period_start;
+    size_t period_count = 0;
+    uint64_t suppressed_count = 0;
+  };
+
+  void
+  run();
+
+  /// Stop and join the background thread, return false if it was already.
+  bool
+  stop();
+
+  /// Move the batches due, or all of them, and the summaries into ready_, with mutex_ held.
+  /**
+   * \return the time the next batch or summary is due, at the latest a window or a second later.
+   */
+  Clock::time_point
+  collect(Clock::time_point now, bool all);
+
+  /// Move the batch of a logger into ready_, with mutex_ held.
+  void
+  close_batch(LoggerState & state);
+
+  /// Move the summary of the messages suppressed of a logger into ready_, with mutex_ held.
+  void
+  close_summary(const std::string & name, LoggerState & state);
+
+  const rclcpp::RosoutBatchingOptions options_;
+  const PublishFunction publish_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable condition_;
+  std::unordered_map<std::string, LoggerState> loggers_;
+  /// Messages to publish, in order.
+  std::vector<rcl_interfaces::msg::Log> ready_;
+  uint64_t suppressed_count_ = 0;
+  bool stopping_ = false;
+  std::thread thread_;
+};
+
+}  // namespace detail
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DETAIL__ROSOUT_BATCHER_HPP_
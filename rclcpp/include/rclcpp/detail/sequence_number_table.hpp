@@ -0,0 +1,293 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__DETAIL__SEQUENCE_NUMBER_TABLE_HPP_
+#define RCLCPP__DETAIL__SEQUENCE_NUMBER_TABLE_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace rclcpp
+{
+namespace detail
+{
+
+/// Table of values indexed by mostly increasing sequence numbers, like pending requests.
+/**
+ * The values are kept in a ring indexed by their sequence number, from the oldest value still
+ * in the table, so inserting, finding and erasing them costs constant time while the
+ * sequence numbers in use span less than the capacity of the ring.
+ * The ring grows up to its maximum capacity, then the oldest values move to an ordered
+ * overflow map, as do the values older than the oldest value of the ring.
+ *
+ * This class isn't thread-safe.
+ */
+template<typename T>
+class SequenceNumberTable
+{
+public:
+  /// Construct the table.
+  /**
+   * \param[in] initial_capacity initial size of the ring, rounded up to a power of two.
+   * \param[in] max_capacity maximum size of the ring, rounded up to a power of two.
+   */
+  explicit SequenceNumberTable(size_t initial_capacity = 64, size_t max_capacity = 4096)
+  : max_capacity_(round_up_to_power_of_two(std::max(initial_capacity, max_capacity)))
+  {
+    slots_.resize(round_up_to_power_of_two(initial_capacity));
+  }
+
+  /// Insert a value, return false if the sequence number is already in the table.
+  bool
+  emplace(int64_t sequence_number, T value)
+  {
+    if (ring_size_ == 0 && (overflow_.empty() || overflow_.rbegin()->first < sequence_number)) {
+      // Restarting the ring from the new value keeps it small while the values are short-lived
+      begin_ = end_ = sequence_number;
+    }
+    if (sequence_number < begin_) {
+      return overflow_.emplace(sequence_number, std::move(value)).second;
+    }
+    reserve(sequence_number);
+    auto & slot = slots_[index(sequence_number)];
+    if (slot) {
+      return false;
+    }
+    slot.emplace(std::move(value));
+    ++ring_size_;
+    if (sequence_number >= end_) {
+      end_ = sequence_number + 1;
+    }
+    return true;
+  }
+
+  /// Return the value of a sequence number, or nullptr if it isn't in the table.
+  T *
+  find(int64_t sequence_number)
+  {
+    if (in_ring(sequence_number)) {
+      auto & slot = slots_[index(sequence_number)];
+      return slot ? &*slot : nullptr;
+    }
+    auto it = overflow_.find(sequence_number);
+    return it == overflow_.end() ? nullptr : &it->second;
+  }
+
+  /// Remove the value of a sequence number and return it, if it is in the table.
+  std::optional<T>
+  take(int64_t sequence_number)
+  {
+    std::optional<T> value;
+    if (in_ring(sequence_number)) {
+      auto & slot = slots_[index(sequence_number)];
+      if (slot) {
+        value.emplace(std::move(*slot));
+        slot.reset();
+        --ring_size_;
+        skip_free_slots();
+      }
+      return value;
+    }
+    auto it = overflow_.find(sequence_number);
+    if (it != overflow_.end()) {
+      value.emplace(std::move(it->second));
+      overflow_.erase(it);
+    }
+    return value;
+  }
+
+  /// Remove the value of a sequence number, return false if it isn't in the table.
+  bool
+  erase(int64_t sequence_number)
+  {
+    return take(sequence_number).has_value();
+  }
+
+  /// Remove the oldest values while the predicate returns true for them.
+  /**
+   * The values are visited in the order of their sequence numbers until the predicate
+   * returns false, so pruning values inserted in time order only visits the pruned values
+   * and the free slots before them.
+   *
+   * \param[in] predicate called with the sequence number and the value, returns true to remove.
+   * \return number of removed values.
+   */
+  template<typename PredicateT>
+  size_t
+  erase_oldest_while(PredicateT predicate)
+  {
+    size_t erased = 0;
+    for (auto it = overflow_.begin(); it != overflow_.end(); it = overflow_.erase(it)) {
+      if (!predicate(it->first, it->second)) {
+        return erased;
+      }
+      ++erased;
+    }
+    while (ring_size_ > 0) {
+      auto & slot = slots_[index(begin_)];
+      if (!predicate(begin_, *slot)) {
+        break;
+      }
+      slot.reset();
+      --ring_size_;
+      ++erased;
+      skip_free_slots();
+    }
+    return erased;
+  }
+
+  /// Remove all the values.
+  void
+  clear()
+  {
+    for (int64_t sequence_number = begin_; ring_size_ > 0; ++sequence_number) {
+      auto & slot = slots_[index(sequence_number)];
+      if (slot) {
+        slot.reset();
+        --ring_size_;
+      }
+    }
+    begin_ = end_;
+    overflow_.clear();
+  }
+
+  /// Return the number of values in the table.
+  size_t
+  size() const
+  {
+    return ring_size_ + overflow_.size();
+  }
+
+  /// Return the number of values in the overflow map.
+  size_t
+  overflow_size() const
+  {
+    return overflow_.size();
+  }
+
+  /// Return the current size of the ring.
+  size_t
+  capacity() const
+  {
+    return slots_.size();
+  }
+
+private:
+  static
+  size_t
+  round_up_to_power_of_two(size_t size)
+  {
+    size_t power = 1;
+    while (power < size) {
+      power <<= 1;
+    }
+    return power;
+  }
+
+  size_t
+  index(int64_t sequence_number) const
+  {
+    return static_cast<size_t>(sequence_number) & (slots_.size() - 1);
+  }
+
+  bool
+  in_ring(int64_t sequence_number) const
+  {
+    return ring_size_ > 0 && sequence_number >= begin_ && sequence_number < end_;
+  }
+
+  bool
+  fits(int64_t sequence_number) const
+  {
+    return static_cast<uint64_t>(sequence_number - begin_) < slots_.size();
+  }
+
+  /// Advance the oldest sequence number of the ring to its oldest value.
+  void
+  skip_free_slots()
+  {
+    if (ring_size_ == 0) {
+      begin_ = end_;
+      return;
+    }
+    while (!slots_[index(begin_)]) {
+      ++begin_;
+    }
+  }
+
+  /// Make room in the ring for a sequence number newer than its oldest one.
+  void
+  reserve(int64_t sequence_number)
+  {
+    if (fits(sequence_number)) {
+      return;
+    }
+    size_t capacity = slots_.size();
+    while (capacity < max_capacity_ &&
+      static_cast<uint64_t>(sequence_number - begin_) >= capacity)
+    {
+      capacity <<= 1;
+    }
+    if (capacity != slots_.size()) {
+      std::vector<std::optional<T>> slots(capacity);
+      for (int64_t i = begin_; i < end_; ++i) {
+        auto & slot = slots_[index(i)];
+        if (slot) {
+          slots[static_cast<size_t>(i) & (capacity - 1)] = std::move(slot);
+        }
+      }
+      slots_ = std::move(slots);
+      if (fits(sequence_number)) {
+        return;
+      }
+    }
+    // Move the oldest values to the overflow map, they are likely to be abandoned requests
+    const int64_t begin = std::min(end_, sequence_number - static_cast<int64_t>(slots_.size()) + 1);
+    while (begin_ < begin) {
+      auto & slot = slots_[index(begin_)];
+      if (slot) {
+        overflow_.emplace_hint(overflow_.end(), begin_, std::move(*slot));
+        slot.reset();
+        --ring_size_;
+      }
+      ++begin_;
+    }
+    if (ring_size_ == 0) {
+      begin_ = end_ = sequence_number;
+    } else {
+      skip_free_slots();
+    }
+  }
+
+  std::vector<std::optional<T>> slots_;
+  size_t max_capacity_;
+  /// Number of values in the ring.
+  size_t ring_size_ {0};
+  /// Oldest sequence number of the ring, its value is in the ring unless the ring is empty.
+  int64_t begin_ {0};
+  /// One past the newest sequence number of the ring.
+  int64_t end_ {0};
+  /// Values not in the ring, all older than the values of the ring.
+  std::map<int64_t, T> overflow_;
+};
+
+}  // namespace detail
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DETAIL__SEQUENCE_NUMBER_TABLE_HPP_
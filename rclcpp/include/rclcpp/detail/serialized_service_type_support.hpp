@@ -0,0 +1,102 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__DETAIL__SERIALIZED_SERVICE_TYPE_SUPPORT_HPP_
+#define RCLCPP__DETAIL__SERIALIZED_SERVICE_TYPE_SUPPORT_HPP_
+
+#include <memory>
+#include <string>
+
+#include "rcpputils/shared_library.hpp"
+#include "rosidl_runtime_cpp/message_type_support_decl.hpp"
+#include "rosidl_runtime_cpp/service_type_support_decl.hpp"
+
+#include "rclcpp/serialization.hpp"
+#include "rclcpp/serialized_message.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace detail
+{
+
+/// Type support of a service whose type is only known at runtime.
+/**
+ * The type support libraries of the service are loaded with rclcpp::get_typesupport_library(),
+ * like for the generic publishers and subscriptions.
+ * The requests and responses given to the middleware are allocated with the introspection type
+ * support of the service, and converted from and to their serialized form with its type support.
+ */
+class SerializedServiceTypeSupport
+{
+public:
+  /// Load the type support of a service.
+  /**
+   * \param[in] service_type the service type, e.g. "std_srvs/srv/SetBool"
+   * \throws std::runtime_error if the type support libraries of the service can't be loaded.
+   */
+  RCLCPP_PUBLIC
+  explicit SerializedServiceTypeSupport(const std::string & service_type);
+
+  RCLCPP_PUBLIC
+  const rosidl_service_type_support_t *
+  get_service_type_support() const;
+
+  /// Return a default initialized request of the service type.
+  RCLCPP_PUBLIC
+  std::shared_ptr<void>
+  create_request() const;
+
+  /// Return a default initialized response of the service type.
+  RCLCPP_PUBLIC
+  std::shared_ptr<void>
+  create_response() const;
+
+  /// Return a request of the service type, deserialized from a serialized request.
+  RCLCPP_PUBLIC
+  std::shared_ptr<void>
+  deserialize_request(const rclcpp::SerializedMessage & serialized_request) const;
+
+  /// Return a response of the service type, deserialized from a serialized response.
+  RCLCPP_PUBLIC
+  std::shared_ptr<void>
+  deserialize_response(const rclcpp::SerializedMessage & serialized_response) const;
+
+  /// Serialize a request of the service type.
+  RCLCPP_PUBLIC
+  void
+  serialize_request(const void * request, rclcpp::SerializedMessage & serialized_request) const;
+
+  /// Serialize a response of the service type.
+  RCLCPP_PUBLIC
+  void
+  serialize_response(const void * response, rclcpp::SerializedMessage & serialized_response) const;
+
+private:
+  std::shared_ptr<void>
+  create_message(const void * members) const;
+
+  std::shared_ptr<rcpputils::SharedLibrary> library_;
+  const rosidl_service_type_support_t * service_type_support_;
+  rclcpp::SerializationBase request_serialization_;
+  rclcpp::SerializationBase response_serialization_;
+  /// Introspection members of the request and response, to allocate them
+  const void * request_members_;
+  const void * response_members_;
+};
+
+}  // namespace detail
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DETAIL__SERIALIZED_SERVICE_TYPE_SUPPORT_HPP_
@@ -0,0 +1,104 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__DETAIL__SNAPSHOT_PTR_HPP_
+#define RCLCPP__DETAIL__SNAPSHOT_PTR_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace rclcpp
+{
+namespace detail
+{
+
+/// \internal Shared pointer to an immutable snapshot, loaded without taking any lock.
+/**
+ * std::atomic_load() and std::atomic_store() of a std::shared_ptr lock a mutex of a pool shared
+ * by the whole process, in libstdc++ at least, so the readers would contend with the writers
+ * and with each other.
+ *
+ * Here load() only does four atomic operations, a fixed number, so the readers are wait-free:
+ * it counts itself as a reader of the current epoch, copies the shared pointer and leaves.
+ * The copy increments the reference count of the snapshot, which is an atomic operation too.
+ *
+ * store() is serialized by a mutex of its own.
+ * It swaps the holder of the shared pointer, then switches the epoch twice, each time waiting
+ * for the readers of the previous epoch to leave, before deleting the old holder.
+ * A writer only waits for the loads in progress, which don't run any user code.
+ */
+template<typename T>
+class SnapshotPtr
+{
+public:
+  explicit SnapshotPtr(std::shared_ptr<const T> snapshot = nullptr)
+  : holder_(new std::shared_ptr<const T>(std::move(snapshot)))
+  {}
+
+  ~SnapshotPtr()
+  {
+    delete holder_.load();
+  }
+
+  SnapshotPtr(const SnapshotPtr &) = delete;
+  SnapshotPtr & operator=(const SnapshotPtr &) = delete;
+
+  /// Return the current snapshot, without locking.
+  std::shared_ptr<const T>
+  load() const
+  {
+    ReaderCount & readers = readers_[epoch_.load()];
+    readers.count.fetch_add(1);
+    std::shared_ptr<const T> snapshot = *holder_.load();
+    readers.count.fetch_sub(1, std::memory_order_release);
+    return snapshot;
+  }
+
+  /// Replace the snapshot, once the loads of the previous one are done.
+  void
+  store(std::shared_ptr<const T> snapshot)
+  {
+    auto holder = std::make_unique<std::shared_ptr<const T>>(std::move(snapshot));
+    std::lock_guard<std::mutex> lock(store_mutex_);
+    std::unique_ptr<std::shared_ptr<const T>> previous_holder(holder_.exchange(holder.release()));
+    // A reader may have read the epoch before the previous switch, so both epochs are drained
+    for (size_t i = 0; i < 2; ++i) {
+      const size_t previous_epoch = epoch_.load();
+      epoch_.store(previous_epoch ^ 1);
+      while (readers_[previous_epoch].count.load() != 0) {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+private:
+  struct alignas(64) ReaderCount
+  {
+    std::atomic<size_t> count{0};
+  };
+
+  std::atomic<std::shared_ptr<const T> *> holder_;
+  std::atomic<size_t> epoch_{0};
+  mutable ReaderCount readers_[2];
+  std::mutex store_mutex_;
+};
+
+}  // namespace detail
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DETAIL__SNAPSHOT_PTR_HPP_
@@ -0,0 +1,62 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__DETAIL__STEADY_THROTTLE_HPP_
+#define RCLCPP__DETAIL__STEADY_THROTTLE_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace rclcpp
+{
+namespace detail
+{
+
+/// \internal State of a throttled logging statement, see RCLCPP_INFO_THROTTLE_STEADY.
+/**
+ * It is a static local of the statement, constant initialized, so it doesn't need a guard.
+ */
+class SteadyThrottle
+{
+public:
+  constexpr SteadyThrottle() = default;
+
+  /// Return true if the duration elapsed since the last time it returned true.
+  /**
+   * A throttled call reads the steady time and compares it to the time of the next message.
+   * Only one of the threads calling it at once returns true.
+   * \param[in] duration_ms the throttle interval, in milliseconds.
+   */
+  bool
+  elapsed(int64_t duration_ms)
+  {
+    const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+    int64_t next_time = next_time_ns_.load(std::memory_order_relaxed);
+    if (now < next_time) {
+      return false;
+    }
+    return next_time_ns_.compare_exchange_strong(
+      next_time, now + duration_ms * 1000000, std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<int64_t> next_time_ns_{0};
+};
+
+}  // namespace detail
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DETAIL__STEADY_THROTTLE_HPP_
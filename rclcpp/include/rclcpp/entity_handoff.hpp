@@ -0,0 +1,120 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__ENTITY_HANDOFF_HPP_
+#define RCLCPP__ENTITY_HANDOFF_HPP_
+
+#include <memory>
+#include <string>
+
+#include "rcl/node.h"
+#include "rcl/node_options.h"
+
+#include "rclcpp/context.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/node_interfaces/node_base_interface.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+namespace detail
+{
+struct EntityHandoffState;
+}  // namespace detail
+
+/// Hands the rcl node and the rcl publishers and subscriptions of a node to its next instance.
+/**
+ * Destroying a node and creating it again, e.g. to reload a component, destroys its
+ * publishers and subscriptions, which the other participants then have to discover again.
+ * While a handoff of a node exists, the publishers and subscriptions of the node destroyed are
+ * kept by the handoff instead of being finalized, as well as the rcl node itself.
+ *
+ * A node created with the handoff, see rclcpp::NodeOptions::entity_handoff(), in the same
+ * context and with the same name and namespace, after the remap rules, uses the kept rcl
+ * node: its rcl node options are ignored, the node keeps the arguments of the previous
+ * instance.
+ * Its publishers and subscriptions then use the kept ones of the same topic, message type and
+ * options, so they keep their gids and their matches with the other participants, and the
+ * subscriptions still deliver the messages received in the meantime.
+ *
+ * The kept entities which aren't used by the new instance are finalized by finish() or by the
+ * destructor.
+ */
+class EntityHandoff
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(EntityHandoff)
+
+  /// Start keeping the entities of a node destroyed.
+  /**
+   * \param[in] node_base The node whose entities are handed over, still alive.
+   * \throws std::invalid_argument if the entities of the node are already handed over.
+   */
+  RCLCPP_PUBLIC
+  explicit EntityHandoff(rclcpp::node_interfaces::NodeBaseInterface & node_base);
+
+  /// Finalize the kept entities not used.
+  RCLCPP_PUBLIC
+  ~EntityHandoff();
+
+  /// Stop keeping the entities destroyed, and finalize the kept entities not used.
+  /**
+   * The entities already taken by the new instance of the node stay in use.
+   * Calling it again has no effect.
+   */
+  RCLCPP_PUBLIC
+  void
+  finish();
+
+  /// Return the kept rcl node if it matches a node being created, used by the node.
+  /**
+   * The rcl node is returned once, and only until finish() is called.
+   *
+   * \param[in] context The context of the new node.
+   * \param[in] node_name The name of the new node, before the remap rules.
+   * \param[in] namespace_ The namespace of the new node, before the remap rules.
+   * \param[in] rcl_node_options The options of the new node, holding its remap rules.
+   * \return the rcl node, or nullptr if it doesn't match.
+   */
+  RCLCPP_PUBLIC
+  std::shared_ptr<rcl_node_t>
+  take_node(
+    const rclcpp::Context::SharedPtr & context,
+    const std::string & node_name,
+    const std::string & namespace_,
+    const rcl_node_options_t & rcl_node_options);
+
+  /// Return the number of publishers kept and not used yet.
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_kept_publishers() const;
+
+  /// Return the number of subscriptions kept and not used yet.
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_kept_subscriptions() const;
+
+  /// Return the number of kept publishers and subscriptions used by the new node.
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_reused_entities() const;
+
+private:
+  std::shared_ptr<rclcpp::detail::EntityHandoffState> state_;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__ENTITY_HANDOFF_HPP_
@@ -328,6 +328,14 @@ class QoSCheckCompatibleException : public std::runtime_error
   using std::runtime_error::runtime_error;
 };
 
+/// Set in the future of a client request which got no response before its timeout.
+class RequestTimeoutError : public std::runtime_error
+{
+public:
+  // Inherit constructors from runtime_error.
+  using std::runtime_error::runtime_error;
+};
+
 }  // namespace exceptions
 }  // namespace rclcpp
 
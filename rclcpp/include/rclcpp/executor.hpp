@@ -18,13 +18,19 @@
 #include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <cstdlib>
+#include <functional>
 #include <iostream>
 #include <list>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "rcl/guard_condition.h"
@@ -34,13 +40,18 @@
 #include "rclcpp/context.hpp"
 #include "rclcpp/contexts/default_context.hpp"
 #include "rclcpp/guard_condition.hpp"
+#include "rclcpp/executor_callback_statistics.hpp"
 #include "rclcpp/executor_options.hpp"
+#include "rclcpp/executor_snapshot.hpp"
+#include "rclcpp/executor_time_accounting.hpp"
 #include "rclcpp/future_return_code.hpp"
 #include "rclcpp/memory_strategies.hpp"
 #include "rclcpp/memory_strategy.hpp"
 #include "rclcpp/node_interfaces/node_base_interface.hpp"
+#include "rclcpp/spin_quotas.hpp"
 #include "rclcpp/utilities.hpp"
 #include "rclcpp/visibility_control.hpp"
+#include "rclcpp/waitable.hpp"
 
 namespace rclcpp
 {
@@ -315,6 +326,26 @@ public:
   virtual void
   spin_all(std::chrono::nanoseconds max_duration);
 
+  /// Collect and execute work within a time budget, sharing it fairly between the entities.
+  /**
+   * Work is collected and executed repeatedly, until the budget has elapsed or every ready entity
+   * has reached its quotas of executions or time, see rclcpp::SpinQuotas.
+   * The work which is ready when the budget runs out, or of entities which reached their quotas,
+   * is kept and executed first by the next call, so the starting point rotates between calls and
+   * every entity gets its turn, even when a busy entity could use the entire budget.
+   * The callback groups of the work kept stay reserved until the next call.
+   *
+   * It is meant for cooperative loops calling it repeatedly, and is implemented by the executors
+   * which collect their work with the memory strategy.
+   *
+   * \param[in] quotas The time budget of the call and the quotas of the entities.
+   * \throws std::invalid_argument if a duration of the quotas is less than 0.
+   * \throws std::runtime_error if the executor is already spinning, or doesn't support it.
+   */
+  RCLCPP_PUBLIC
+  virtual void
+  spin_some_with_quotas(const rclcpp::SpinQuotas & quotas);
+
   RCLCPP_PUBLIC
   virtual void
   spin_once(std::chrono::nanoseconds timeout = std::chrono::nanoseconds(-1));
@@ -328,6 +359,10 @@ public:
    *   If the time spent inside the blocking loop exceeds this timeout, return a TIMEOUT return
    *   code.
    * \return The return code, one of `SUCCESS`, `INTERRUPTED`, or `TIMEOUT`.
+   *
+   * If the executor was created with ExecutorOptions::wake_on_future_complete, a future
+   * completed by another thread interrupts the wait for work, so that this function returns
+   * without waiting for other work or for the timeout.
    */
   template<typename FutureT, typename TimeRepT = int64_t, typename TimeT = std::milli>
   FutureReturnCode
@@ -357,6 +392,15 @@ public:
       throw std::runtime_error("spin_until_future_complete() called while already spinning");
     }
     RCPPUTILS_SCOPE_EXIT(this->spinning.store(false); );
+
+    if (wake_on_future_complete_ && timeout_ns != std::chrono::nanoseconds::zero()) {
+      start_future_watcher(
+        [&future](std::chrono::nanoseconds wait_time) {
+          return future.wait_for(wait_time) == std::future_status::ready;
+        }, timeout_ns);
+    }
+    RCPPUTILS_SCOPE_EXIT(this->stop_future_watcher(); );
+
     while (rclcpp::ok(this->context_) && spinning.load()) {
       // Do one item of work.
       spin_once_impl(timeout_left);
@@ -397,7 +441,8 @@ public:
    * Switching the memory strategy while the executor is spinning in another threading could have
    * unintended consequences.
    * \param[in] memory_strategy Shared pointer to the memory strategy to set.
-   * \throws std::runtime_error if memory_strategy is null
+   * \throws std::runtime_error if memory_strategy is null, or if it does not support the
+   *   timer dispatch order of the executor
    */
   RCLCPP_PUBLIC
   void
@@ -412,6 +457,117 @@ public:
   bool
   is_spinning();
 
+  /// Enable or disable the collection of callback statistics.
+  /**
+   * When enabled, the executor measures for every executed callback the time spent in
+   * the callback and the time elapsed between the callback being found ready and its execution.
+   * The measurements are recorded in histograms kept per thread, per callback group and per
+   * entity, so that threads executing callbacks don't contend with each other.
+   * Collection is disabled by default.
+   * Only the callbacks dispatched through execute_any_executable are measured, the
+   * StaticSingleThreadedExecutor executes entities directly and doesn't collect statistics.
+   * This function can be called asynchronously from any thread.
+   * \param[in] enabled true to collect the statistics of the callbacks executed from now on.
+   */
+  RCLCPP_PUBLIC
+  void
+  set_callback_statistics_enabled(bool enabled);
+
+  /// Return true if the collection of callback statistics is enabled.
+  RCLCPP_PUBLIC
+  bool
+  get_callback_statistics_enabled() const;
+
+  /// Get the statistics of the callbacks executed since the last reset.
+  /**
+   * This function can be called asynchronously from any thread, e.g. to export the
+   * statistics periodically.
+   * \return the statistics of each callback, merged across the threads which executed it.
+   */
+  RCLCPP_PUBLIC
+  std::vector<rclcpp::CallbackStatistics>
+  get_callback_statistics() const;
+
+  /// Clear the callback statistics collected so far.
+  RCLCPP_PUBLIC
+  void
+  reset_callback_statistics();
+
+  /// Enable or disable the sampling of hardware performance counters around the callbacks.
+  /**
+   * When enabled, along with the callback statistics, the executor reads the instructions,
+   * cycles, cache misses and context switches of the executing thread before and after each
+   * callback, and sums them in the rclcpp::CallbackStatistics::hardware_counters of the
+   * callback.
+   * The counters are Linux perf_event counters of the thread, opened the first time it
+   * executes a callback; reading them costs two system calls per callback.
+   * The counters which can't be opened, e.g. because of the kernel.perf_event_paranoid
+   * setting, stay 0, and the count of the hardware counters stays 0 on other systems.
+   * Sampling is disabled by default.
+   * This function can be called asynchronously from any thread.
+   * \param[in] enabled true to sample the counters of the callbacks executed from now on.
+   */
+  RCLCPP_PUBLIC
+  void
+  set_hardware_counters_enabled(bool enabled);
+
+  /// Return true if the sampling of hardware performance counters is enabled.
+  RCLCPP_PUBLIC
+  bool
+  get_hardware_counters_enabled() const;
+
+  /// Enable or disable the accounting of the time spent by the threads of the executor.
+  /**
+   * When enabled, each thread spinning the executor accounts the time it spends collecting
+   * entities, waiting in rcl_wait(), selecting the next executable, executing callbacks and,
+   * for the MultiThreadedExecutor, waiting for the other threads.
+   * Accounting reads the steady clock a few times per executed callback.
+   * Accounting is disabled by default.
+   * As for the callback statistics, the StaticSingleThreadedExecutor doesn't account time.
+   * This function can be called asynchronously from any thread.
+   * \param[in] enabled true to account the time spent from now on.
+   */
+  RCLCPP_PUBLIC
+  void
+  set_time_accounting_enabled(bool enabled);
+
+  /// Return true if the accounting of the time spent by the threads is enabled.
+  RCLCPP_PUBLIC
+  bool
+  get_time_accounting_enabled() const;
+
+  /// Get the time spent by each thread in each activity since the last reset.
+  /**
+   * This function can be called asynchronously from any thread, e.g. to export the utilization
+   * of the threads periodically, see rclcpp::ExecutorThreadTimes::utilization().
+   * \return the times of each thread which spun the executor while accounting was enabled.
+   */
+  RCLCPP_PUBLIC
+  std::vector<rclcpp::ExecutorThreadTimes>
+  get_thread_times() const;
+
+  /// Zero the times accounted so far.
+  RCLCPP_PUBLIC
+  void
+  reset_thread_times();
+
+  /// Return the state of the callback groups, subscriptions and timers of the executor.
+  /**
+   * Meant to find out, e.g. during an incident, which subscriptions have messages waiting, how
+   * deep their intra-process buffers are, which callback groups are busy and which timers are
+   * overdue, see also rclcpp::ExecutorStatePublisher.
+   * The ready states come from the memory strategy, they're those of the last wait.
+   *
+   * This function can be called asynchronously from any thread, it doesn't stop the spinning:
+   * the lock of the executor is only held while the callback groups and the ready handles are
+   * copied, which happens outside of the wait.
+   * The StaticSingleThreadedExecutor and the EventsExecutor collect their entities on their own,
+   * their snapshots are empty.
+   */
+  RCLCPP_PUBLIC
+  rclcpp::ExecutorSnapshot
+  get_introspection_snapshot() const;
+
 protected:
   RCLCPP_PUBLIC
   void
@@ -423,6 +579,76 @@ protected:
   void
   spin_some_impl(std::chrono::nanoseconds max_duration, bool exhaustive);
 
+  /// Have the watcher thread trigger the interrupt guard condition once the future is ready.
+  /**
+   * The thread is started by the first call and waits for the next future afterwards.
+   *
+   * \param[in] wait_for_future Function waiting for the future for at most the given
+   *   duration, returning true if the future is ready.
+   * \param[in] timeout Time after which the thread gives up, negative to wait forever.
+   */
+  RCLCPP_PUBLIC
+  void
+  start_future_watcher(
+    std::function<bool(std::chrono::nanoseconds)> wait_for_future,
+    std::chrono::nanoseconds timeout);
+
+  /// Stop watching the future given to start_future_watcher(), if any.
+  /**
+   * Returns once the watcher thread doesn't use the future anymore, the thread keeps running.
+   */
+  RCLCPP_PUBLIC
+  void
+  stop_future_watcher();
+
+  /// Stop and join the watcher thread, if started.
+  RCLCPP_LOCAL
+  void
+  shutdown_future_watcher();
+
+  /// Body of the watcher thread, waiting on the futures given to start_future_watcher().
+  RCLCPP_LOCAL
+  void
+  run_future_watcher();
+
+  /// Wait on the wait set, busy polling it for the current polling budget first.
+  /**
+   * \param[in] timeout Maximum time to wait, negative to wait forever.
+   * \return the return code of the last call to rcl_wait().
+   */
+  RCLCPP_PUBLIC
+  rcl_ret_t
+  busy_poll_wait_set(std::chrono::nanoseconds timeout);
+
+  /// Put all the handles of the memory strategy back in the wait set.
+  RCLCPP_PUBLIC
+  void
+  refill_wait_set() RCPPUTILS_TSA_REQUIRES(mutex_);
+
+  /// Execute the intra-process subscriptions which were delivered messages by a callback.
+  /**
+   * \param[in] deliveries the subscriptions recorded while the callback was executed,
+   *   see rclcpp::experimental::IntraProcessDeliveryScope.
+   * \sa ExecutorOptions::dataflow_chain_depth
+   */
+  RCLCPP_PUBLIC
+  void
+  execute_dataflow_successors(const std::vector<const rclcpp::Waitable *> & deliveries);
+
+  /// Take the data of a delivered intra-process subscription, if this executor can run it now.
+  /**
+   * \return false if the subscription isn't an entity of this executor, if its callback group
+   *   can't be reserved or if its messages were already taken.
+   */
+  RCLCPP_PUBLIC
+  bool
+  take_dataflow_successor(const rclcpp::Waitable * waitable, AnyExecutable & any_executable);
+
+  /// Find the intra-process subscriptions of the callback groups of this executor.
+  RCLCPP_PUBLIC
+  void
+  collect_dataflow_successors() RCPPUTILS_TSA_REQUIRES(mutex_);
+
   /// Find the next available executable and do the work associated with it.
   /**
    * \param[in] any_exec Union structure that can hold any executable type (timer, subscription,
@@ -433,11 +659,47 @@ protected:
   void
   execute_any_executable(AnyExecutable & any_exec);
 
+  /// Record the statistics of an executable which was executed between the given times.
+  RCLCPP_PUBLIC
+  void
+  record_callback_statistics(
+    const AnyExecutable & any_exec,
+    std::chrono::steady_clock::time_point start_time,
+    std::chrono::steady_clock::time_point end_time,
+    const rclcpp::HardwareCounters * hardware_counters = nullptr);
+
+  /// Account the time until the returned scope is destroyed to an activity of this thread.
+  /**
+   * The scope does nothing when time accounting is disabled.
+   * Scopes must not be nested, the time would be accounted twice.
+   */
+  RCLCPP_PUBLIC
+  rclcpp::ExecutorTimeAccounting::Scope
+  account_time(rclcpp::ExecutorActivity activity);
+
+  /// Take and handle a single message of the subscription.
+  /**
+   * The maximum number of messages per take of the subscription doesn't apply, so that one
+   * event of the subscription handles one message.
+   */
   RCLCPP_PUBLIC
   static void
   execute_subscription(
     rclcpp::SubscriptionBase::SharedPtr subscription);
 
+  /// Take and handle messages of the subscription until enough were taken or none is left.
+  /**
+   * \param[in] subscription The subscription to take the messages from.
+   * \param[in] default_max_messages_per_take The maximum number of messages to take, used
+   *   if the subscription doesn't set its own maximum.
+   * \return The number of messages which were taken and handled.
+   */
+  RCLCPP_PUBLIC
+  static size_t
+  execute_subscription(
+    rclcpp::SubscriptionBase::SharedPtr subscription,
+    size_t default_max_messages_per_take);
+
   RCLCPP_PUBLIC
   static void
   execute_timer(rclcpp::TimerBase::SharedPtr timer);
@@ -450,7 +712,11 @@ protected:
   static void
   execute_client(rclcpp::ClientBase::SharedPtr client);
 
+  /// Block until one of the entities of the executor is ready or until the timeout expires.
   /**
+   * The entities collected for the previous wait are reused, unless callback groups were
+   * added to or removed from the executor, the notify guard condition of one of the callback
+   * groups was triggered, or one of the entities was destroyed.
    * \throws std::runtime_error if the wait set can be cleared
    */
   RCLCPP_PUBLIC
@@ -506,12 +772,39 @@ protected:
   bool
   get_next_ready_executable(AnyExecutable & any_executable);
 
+  /// Get the next ready executable of the callback groups in the given map.
+  /**
+   * If any of the callback groups has a non default priority, all the ready executables
+   * are taken from the memory strategy and the one of the callback group with the highest
+   * priority is returned, the others are kept to be returned by the next calls.
+   * Otherwise timers, subscriptions, services, clients and waitables are checked in this order.
+   *
+   * \param[out] any_executable The executable to be filled.
+   * \param[in] weak_groups_to_nodes The callback groups to take the executable from.
+   * \return true if an executable was found, false otherwise.
+   */
   RCLCPP_PUBLIC
   bool
   get_next_ready_executable_from_map(
     AnyExecutable & any_executable,
     const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes);
 
+  /// Take the next ready executable from the memory strategy, in the fixed order of types.
+  RCLCPP_PUBLIC
+  bool
+  take_next_ready_executable(
+    AnyExecutable & any_executable,
+    const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes) RCPPUTILS_TSA_REQUIRES(mutex_);
+
+  /// Return true if ready work of higher priority might be waiting in the middleware.
+  /**
+   * This is the case when all the executables already taken belong to callback groups with a
+   * lower priority than the highest priority callback group associated with the executor.
+   */
+  RCLCPP_PUBLIC
+  bool
+  higher_priority_work_may_be_pending();
+
   RCLCPP_PUBLIC
   bool
   get_next_executable(
@@ -554,6 +847,51 @@ protected:
   /// The context associated with this executor.
   std::shared_ptr<rclcpp::Context> context_;
 
+  /// Maximum number of messages taken from a ready subscription, see ExecutorOptions.
+  const size_t max_messages_per_take_;
+
+  /// Order in which ready timers are dispatched, see ExecutorOptions.
+  const rclcpp::memory_strategy::TimerDispatchOrder timer_dispatch_order_;
+
+  /// True if a completed future wakes up spin_until_future_complete, see ExecutorOptions.
+  const bool wake_on_future_complete_;
+
+  /// Maximum time spent busy polling before blocking in the wait for work, see ExecutorOptions.
+  const std::chrono::nanoseconds busy_poll_budget_;
+
+  /// Polling time of the next wait for work, adapted to how often polling finds work.
+  std::chrono::nanoseconds current_busy_poll_budget_;
+
+  /// Capacity of the arena of the callbacks, zero if disabled, see ExecutorOptions.
+  const size_t callback_arena_capacity_;
+
+  /// Maximum length of the chains of intra-process subscriptions, see ExecutorOptions.
+  const size_t dataflow_chain_depth_;
+
+  /// Thread waiting on the futures of spin_until_future_complete, started on first use.
+  std::thread future_watcher_;
+
+  /// Flag telling the future watcher thread to keep waiting on the current future.
+  std::atomic_bool future_watcher_running_{false};
+
+  /// Mutex held by the watcher thread while it uses the watched future.
+  std::mutex future_watcher_mutex_;
+
+  /// Notified when a future is to be watched or the watcher thread is to exit.
+  std::condition_variable future_watcher_cv_;
+
+  /// Function waiting on the watched future, empty when no future is watched.
+  std::function<bool(std::chrono::nanoseconds)> watched_future_;
+
+  /// Deadline of the watched future, unused if it is waited forever.
+  std::chrono::steady_clock::time_point watched_future_end_time_;
+
+  /// Whether the watched future is waited forever.
+  bool watched_future_forever_{false};
+
+  /// Flag telling the watcher thread to exit, set by the destructor.
+  bool future_watcher_shutdown_{false};
+
   RCLCPP_DISABLE_COPY(Executor)
 
   RCLCPP_PUBLIC
@@ -585,6 +923,75 @@ protected:
   std::list<rclcpp::node_interfaces::NodeBaseInterface::WeakPtr>
   weak_nodes_ RCPPUTILS_TSA_GUARDED_BY(mutex_);
 
+  /// true if the entities have to be collected again before the next wait
+  bool entities_need_rebuild_ RCPPUTILS_TSA_GUARDED_BY(mutex_) = true;
+
+  /// An executable found ready, which waits to be dispatched according to its priority.
+  struct PrioritizedExecutable
+  {
+    std::unique_ptr<AnyExecutable> executable;
+    int priority;
+    std::chrono::steady_clock::time_point ready_time;
+    bool starved;
+  };
+
+  /// ready executables which have not been dispatched yet, in the order they were taken
+  std::list<PrioritizedExecutable> prioritized_executables_ RCPPUTILS_TSA_GUARDED_BY(mutex_);
+
+  /// An executable set aside by spin_some_with_quotas(), its callback group released meanwhile.
+  struct HeldExecutable
+  {
+    std::unique_ptr<AnyExecutable> executable;
+    rclcpp::CallbackGroup::SharedPtr callback_group;
+    /// order in which the executable was taken
+    uint64_t sequence;
+  };
+
+  /// executables whose work was taken, left by the last call of spin_some_with_quotas()
+  std::vector<HeldExecutable> quota_pending_executables_;
+
+  /// entities which had their turn in spin_some_with_quotas() since every ready entity had one
+  std::unordered_set<const void *> quota_served_entities_;
+
+  /// sequence of the next executable set aside by spin_some_with_quotas()
+  uint64_t quota_hold_sequence_ = 0;
+
+  /// An intra-process subscription of this executor, with what's needed to execute it.
+  struct DataflowSuccessor
+  {
+    rclcpp::Waitable::WeakPtr waitable;
+    rclcpp::CallbackGroup::WeakPtr callback_group;
+    rclcpp::node_interfaces::NodeBaseInterface::WeakPtr node_base;
+  };
+
+  /// intra-process subscriptions of the callback groups, by address of their waitable
+  std::unordered_map<const rclcpp::Waitable *, DataflowSuccessor>
+  dataflow_successors_ RCPPUTILS_TSA_GUARDED_BY(mutex_);
+
+  /// true if dataflow_successors_ holds all the subscriptions since the entities were collected
+  bool dataflow_successors_complete_ RCPPUTILS_TSA_GUARDED_BY(mutex_) = false;
+
+  /// time at which the last wait for work returned
+  std::chrono::steady_clock::time_point last_wait_time_ RCPPUTILS_TSA_GUARDED_BY(mutex_);
+
+  /// true if the handles of the memory strategy are those of the ready entities
+  bool handles_are_ready_ RCPPUTILS_TSA_GUARDED_BY(mutex_) = false;
+
+  /// true if the callback statistics are collected
+  std::atomic_bool callback_statistics_enabled_{false};
+
+  /// true if the hardware counters are sampled along with the callback statistics
+  std::atomic_bool hardware_counters_enabled_{false};
+
+  /// execution statistics of the callbacks
+  rclcpp::ExecutorCallbackStatistics callback_statistics_;
+
+  /// true if the time spent by the threads is accounted
+  std::atomic_bool time_accounting_enabled_{false};
+
+  /// time spent by the threads in each activity
+  rclcpp::ExecutorTimeAccounting time_accounting_;
+
   /// shutdown callback handle registered to Context
   rclcpp::OnShutdownCallbackHandle shutdown_callback_handle_;
 };
@@ -0,0 +1,216 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXECUTOR_CALLBACK_STATISTICS_HPP_
+#define RCLCPP__EXECUTOR_CALLBACK_STATISTICS_HPP_
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// Histogram of durations with power of two buckets.
+/**
+ * Bucket 0 counts the durations of 0 ns, bucket i > 0 the durations in [2^(i-1), 2^i) ns.
+ * Recording is a handful of integer operations and never allocates.
+ */
+class LatencyHistogram
+{
+public:
+  /// Number of buckets, enough for any positive std::chrono::nanoseconds.
+  static constexpr size_t NUMBER_OF_BUCKETS = 64;
+
+  /// Add a duration to the histogram, negative durations are ignored.
+  RCLCPP_PUBLIC
+  void
+  record(std::chrono::nanoseconds duration);
+
+  /// Add all the samples of another histogram to this one.
+  RCLCPP_PUBLIC
+  void
+  merge(const LatencyHistogram & other);
+
+  /// Return the number of recorded samples.
+  RCLCPP_PUBLIC
+  uint64_t
+  count() const;
+
+  /// Return the number of samples in the given bucket.
+  RCLCPP_PUBLIC
+  uint64_t
+  bucket_count(size_t bucket) const;
+
+  /// Return the exclusive upper bound of the durations counted in the given bucket.
+  RCLCPP_PUBLIC
+  static std::chrono::nanoseconds
+  bucket_upper_bound(size_t bucket);
+
+  /// Return the smallest recorded duration, 0 if there is no sample.
+  RCLCPP_PUBLIC
+  std::chrono::nanoseconds
+  min() const;
+
+  /// Return the largest recorded duration, 0 if there is no sample.
+  RCLCPP_PUBLIC
+  std::chrono::nanoseconds
+  max() const;
+
+  /// Return the average of the recorded durations, 0 if there is no sample.
+  RCLCPP_PUBLIC
+  std::chrono::nanoseconds
+  mean() const;
+
+  /// Return an upper bound of the given percentile of the recorded durations.
+  /**
+   * \param[in] percentile The percentile, between 0 and 100.
+   * \return The upper bound of the bucket holding the percentile, capped by max().
+   */
+  RCLCPP_PUBLIC
+  std::chrono::nanoseconds
+  percentile(double percentile) const;
+
+private:
+  std::array<uint64_t, NUMBER_OF_BUCKETS> buckets_{};
+  uint64_t count_ = 0;
+  int64_t sum_ = 0;
+  int64_t min_ = 0;
+  int64_t max_ = 0;
+};
+
+/// Hardware performance counters summed over the executions of a callback.
+/**
+ * The counters are those of the thread executing the callback, so they include the work of
+ * the middleware done in the callback, e.g. taking the message.
+ * A counter which isn't available on the system stays 0.
+ */
+struct HardwareCounters
+{
+  /// Number of executions whose counters were summed.
+  uint64_t count = 0;
+  /// Instructions retired, in user space.
+  uint64_t instructions = 0;
+  /// CPU cycles, in user space.
+  uint64_t cycles = 0;
+  /// Misses of the last level cache, in user space.
+  uint64_t cache_misses = 0;
+  /// Context switches of the thread.
+  uint64_t context_switches = 0;
+
+  /// Add the counters of other executions to these.
+  RCLCPP_PUBLIC
+  void
+  merge(const HardwareCounters & other);
+};
+
+/// Kind of entity whose callback was executed.
+enum class CallbackKind
+{
+  Timer,
+  Subscription,
+  Service,
+  Client,
+  Waitable
+};
+
+/// Histograms of a callback, as executed by an executor.
+struct CallbackStatistics
+{
+  /// Address of the callback group of the entity, used as an identifier.
+  const void * callback_group = nullptr;
+  /// Address of the entity (timer, subscription, ...), used as an identifier.
+  const void * entity = nullptr;
+  /// Kind of the entity.
+  CallbackKind kind = CallbackKind::Waitable;
+  /// Topic or service name of the entity, empty for timers and waitables.
+  std::string name;
+  /// Time spent executing the callback.
+  LatencyHistogram execution_time;
+  /// Time between the executor finding the entity ready and the callback starting.
+  LatencyHistogram ready_delay;
+  /// Hardware counters of the executions, see rclcpp::Executor::set_hardware_counters_enabled().
+  HardwareCounters hardware_counters;
+};
+
+/// Collects CallbackStatistics of the callbacks executed by the threads of an executor.
+/**
+ * Each thread records into its own set of histograms, so that recording only takes an
+ * uncontended lock; the sets of all threads are merged when the statistics are queried.
+ */
+class ExecutorCallbackStatistics
+{
+public:
+  RCLCPP_PUBLIC
+  ExecutorCallbackStatistics();
+
+  RCLCPP_PUBLIC
+  ~ExecutorCallbackStatistics();
+
+  /// Record an execution of a callback from the calling thread.
+  /**
+   * \param[in] callback_group Address of the callback group of the entity.
+   * \param[in] entity Address of the entity.
+   * \param[in] kind Kind of the entity.
+   * \param[in] name Topic or service name of the entity, may be nullptr, only copied the
+   *   first time the entity is recorded by this thread.
+   * \param[in] ready_delay Time between the entity being found ready and the execution,
+   *   negative if unknown.
+   * \param[in] execution_time Time spent executing the callback.
+   * \param[in] hardware_counters Hardware counters of the execution, nullptr if not measured.
+   */
+  RCLCPP_PUBLIC
+  void
+  record(
+    const void * callback_group,
+    const void * entity,
+    CallbackKind kind,
+    const char * name,
+    std::chrono::nanoseconds ready_delay,
+    std::chrono::nanoseconds execution_time,
+    const HardwareCounters * hardware_counters = nullptr);
+
+  /// Return the statistics of all the recorded callbacks, merged over all the threads.
+  RCLCPP_PUBLIC
+  std::vector<CallbackStatistics>
+  get_statistics() const;
+
+  /// Discard all the recorded statistics.
+  RCLCPP_PUBLIC
+  void
+  reset();
+
+private:
+  struct ThreadStatistics;
+
+  /// Return the statistics of the calling thread, creating them on first use.
+  ThreadStatistics &
+  get_thread_statistics();
+
+  /// Unique identifier of this object, used to find the statistics of the calling thread.
+  const uint64_t id_;
+
+  mutable std::mutex threads_mutex_;
+  std::vector<std::shared_ptr<ThreadStatistics>> threads_;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXECUTOR_CALLBACK_STATISTICS_HPP_
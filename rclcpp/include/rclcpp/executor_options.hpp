@@ -15,10 +15,14 @@
 #ifndef RCLCPP__EXECUTOR_OPTIONS_HPP_
 #define RCLCPP__EXECUTOR_OPTIONS_HPP_
 
+#include <chrono>
+#include <vector>
+
 #include "rclcpp/context.hpp"
 #include "rclcpp/contexts/default_context.hpp"
 #include "rclcpp/memory_strategies.hpp"
 #include "rclcpp/memory_strategy.hpp"
+#include "rclcpp/thread_attributes.hpp"
 #include "rclcpp/visibility_control.hpp"
 
 namespace rclcpp
@@ -30,12 +34,98 @@ struct ExecutorOptions
   ExecutorOptions()
   : memory_strategy(rclcpp::memory_strategies::create_default_strategy()),
     context(rclcpp::contexts::get_global_default_context()),
-    max_conditions(0)
+    max_conditions(0),
+    max_messages_per_take(1),
+    timer_dispatch_order(rclcpp::memory_strategy::TimerDispatchOrder::CollectionOrder),
+    wake_on_future_complete(false),
+    busy_poll_budget(0),
+    numa_aware(false),
+    callback_arena_capacity(0),
+    dataflow_chain_depth(0)
   {}
 
   rclcpp::memory_strategy::MemoryStrategy::SharedPtr memory_strategy;
   rclcpp::Context::SharedPtr context;
   size_t max_conditions;
+
+  /// Maximum number of messages taken from a ready subscription before waiting again.
+  /**
+   * Used for the subscriptions which don't set their own maximum, see
+   * rclcpp::SubscriptionBase::set_max_messages_per_take().
+   * Use std::numeric_limits<size_t>::max() to take until the subscription queue is empty.
+   * A value of 0 is handled as 1.
+   */
+  size_t max_messages_per_take;
+
+  /// Order in which the executor dispatches the timers which are ready at the same time.
+  /**
+   * With earliest deadline first the lateness of the timers is recorded,
+   * see rclcpp::TimerBase::get_lateness_statistics().
+   * The memory strategy has to support the given order.
+   */
+  rclcpp::memory_strategy::TimerDispatchOrder timer_dispatch_order;
+
+  /// Attributes of the threads created by the executor, indexed by worker thread.
+  /**
+   * Executors which spin in the calling thread don't create threads and ignore them.
+   * Worker threads without a corresponding entry use the default attributes.
+   */
+  std::vector<rclcpp::ThreadAttributes> thread_attributes;
+
+  /// Wake up spin_until_future_complete() as soon as the future is completed by another thread.
+  /**
+   * By default the completion of the future is checked only after some work was executed or
+   * the wait for work timed out.
+   * When true, a helper thread waits on the future for the duration of the spin and triggers
+   * the interrupt guard condition of the executor when the future becomes ready.
+   */
+  bool wake_on_future_complete;
+
+  /// Maximum time spent busy polling for ready entities before blocking in the wait for work.
+  /**
+   * Polling avoids the latency of waking up a blocked thread, at the price of cpu time.
+   * The time actually spent polling adapts: it's reduced while polling doesn't find work and
+   * restored when it does, or when work came in shortly after the polling stopped.
+   * Only executors waiting through Executor::wait_for_work() poll.
+   * Zero, the default, disables polling.
+   */
+  std::chrono::nanoseconds busy_poll_budget;
+
+  /// Place the worker threads and their work according to the NUMA nodes of the host.
+  /**
+   * Supported by the MultiThreadedExecutor: when thread_attributes is empty the workers are
+   * spread over the NUMA nodes and bound to the CPUs of their node, otherwise the node of a
+   * worker is the one of the first CPU it's bound to.
+   * Each executable is preferably executed by a worker of the node holding the memory of its
+   * entity, and the executions on another node are counted.
+   * See rclcpp::NumaTopology.
+   */
+  bool numa_aware;
+
+  /// Initial capacity in bytes of the arena made current while each callback is executed.
+  /**
+   * Each thread executing callbacks has its own arena, reset after each callback without
+   * freeing its memory, see rclcpp::allocator::CallbackArenaScope.
+   * The temporaries of a callback can be allocated from it with
+   * rclcpp::allocator::CallbackArenaAllocator, and the taken messages with
+   * rclcpp::strategies::callback_arena_memory_strategy::CallbackArenaMessageMemoryStrategy.
+   * Zero, the default, disables the arenas.
+   */
+  size_t callback_arena_capacity;
+
+  /// Maximum length of the chains of intra-process subscriptions executed after a callback.
+  /**
+   * When a callback publishes to intra-process subscriptions of this executor, their
+   * callbacks are executed by the same thread right after it, in the order the messages
+   * were published, while the messages are still in the cache, instead of being left to
+   * the next wait for work.
+   * The downstream callbacks publishing in turn continue the chain, up to this length.
+   * A subscription whose mutually exclusive callback group is busy is left to the executor.
+   * Supported by the executors dispatching through Executor::execute_any_executable(),
+   * like the SingleThreadedExecutor and the MultiThreadedExecutor.
+   * Zero, the default, disables the chaining.
+   */
+  size_t dataflow_chain_depth;
 };
 
 }  // namespace rclcpp
@@ -0,0 +1,99 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXECUTOR_SNAPSHOT_HPP_
+#define RCLCPP__EXECUTOR_SNAPSHOT_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "rclcpp/callback_group.hpp"
+
+namespace rclcpp
+{
+
+/// State of the entities of an executor, see Executor::get_introspection_snapshot().
+struct ExecutorSnapshot
+{
+  /// State of a callback group.
+  struct CallbackGroupState
+  {
+    /// Fully qualified name of the node of the group.
+    std::string node_name;
+    /// Index of the group among the groups of its node in the snapshot.
+    size_t index = 0;
+    CallbackGroupType type = CallbackGroupType::MutuallyExclusive;
+    /// True if a callback of this mutually exclusive group is being executed.
+    /**
+     * The executors don't track the execution of the reentrant groups, which are never busy.
+     */
+    bool busy = false;
+    int priority = 0;
+  };
+
+  /// State of a subscription.
+  struct SubscriptionState
+  {
+    std::string node_name;
+    std::string topic_name;
+    /// Index of the callback group of the subscription in callback_groups.
+    size_t callback_group = 0;
+    /// True if the last wait found messages for the subscription, which weren't taken since.
+    bool ready = false;
+    bool paused = false;
+    /// True if the subscription has an intra-process buffer, filling the next two members.
+    bool intra_process = false;
+    /// Number of messages waiting in the intra-process buffer.
+    size_t intra_process_depth = 0;
+    size_t intra_process_capacity = 0;
+    /// Messages dropped by the intra-process buffer since it was created.
+    uint64_t intra_process_dropped = 0;
+  };
+
+  /// State of a timer.
+  struct TimerState
+  {
+    std::string node_name;
+    /// Index of the timer among the timers of its node in the snapshot.
+    size_t index = 0;
+    /// Index of the callback group of the timer in callback_groups.
+    size_t callback_group = 0;
+    std::chrono::nanoseconds period{0};
+    bool canceled = false;
+    /// True if the last wait found the timer ready, and it wasn't executed since.
+    bool ready = false;
+    /// Time since the timer should have been executed, zero if it isn't due yet.
+    std::chrono::nanoseconds overdue{0};
+  };
+
+  /// Steady time at which the snapshot was taken.
+  std::chrono::steady_clock::time_point time;
+  /// True if the executor was spinning.
+  bool spinning = false;
+  /// True if the ready states are those of the last wait, false while the executor waits.
+  /**
+   * While waiting, the ready entities are not known yet, and none is reported as ready.
+   */
+  bool ready_states_valid = false;
+  std::vector<CallbackGroupState> callback_groups;
+  std::vector<SubscriptionState> subscriptions;
+  std::vector<TimerState> timers;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXECUTOR_SNAPSHOT_HPP_
@@ -0,0 +1,118 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXECUTOR_STATE_PUBLISHER_HPP_
+#define RCLCPP__EXECUTOR_STATE_PUBLISHER_HPP_
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "rclcpp/create_publisher.hpp"
+#include "rclcpp/create_timer.hpp"
+#include "rclcpp/executor.hpp"
+#include "rclcpp/executor_snapshot.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/publisher.hpp"
+#include "rclcpp/qos.hpp"
+#include "rclcpp/time.hpp"
+#include "rclcpp/timer.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+#include "statistics_msgs/msg/metrics_message.hpp"
+
+namespace rclcpp
+{
+
+/// Publish the backlog and readiness state of the entities of an executor.
+/**
+ * The state comes from Executor::get_introspection_snapshot(), taken without stopping the
+ * spinning of the executor.
+ * A statistics_msgs::msg::MetricsMessage is published per metric, with the node of the entity
+ * as measurement source, and with a single sample whose average is the value:
+ *  - "callback_group/<index>/busy": 1 if the mutually exclusive group executes a callback,
+ *  - "subscription<topic>/ready": 1 if the last wait found messages for the subscription, with
+ *    the fully qualified topic name, e.g. "subscription/chatter/ready",
+ *  - "subscription<topic>/intra_process_depth": the messages waiting in its intra-process
+ *    buffer, the maximum being the capacity of the buffer,
+ *  - "timer/<index>/overdue": the time since the timer should have been executed.
+ *
+ * With a zero period nothing is published periodically, e.g. to only publish on request with
+ * publish(), when the executor seems stuck.
+ */
+class ExecutorStatePublisher
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(ExecutorStatePublisher)
+
+  static constexpr const char * default_topic_name = "executor_state";
+
+  /// Create the publisher, and the timer publishing the state of the executor.
+  /**
+   * \param[in] node the node which publishes the state.
+   * \param[in] executor the executor whose state is published, it must outlive this object.
+   * \param[in] period the period of the publications, zero to only publish with publish().
+   * \param[in] topic_name the topic the state is published on.
+   * \param[in] qos the quality of service of the publisher.
+   */
+  template<typename NodeT>
+  ExecutorStatePublisher(
+    NodeT & node,
+    const rclcpp::Executor & executor,
+    std::chrono::nanoseconds period,
+    const std::string & topic_name = default_topic_name,
+    const rclcpp::QoS & qos = rclcpp::QoS(100))
+  : executor_(executor), window_start_(now())
+  {
+    publisher_ = rclcpp::create_publisher<statistics_msgs::msg::MetricsMessage>(
+      node, topic_name, qos);
+    if (period > std::chrono::nanoseconds::zero()) {
+      timer_ = rclcpp::create_wall_timer(
+        period, [this]() {publish();}, nullptr,
+        node.get_node_base_interface().get(), node.get_node_timers_interface().get());
+    }
+  }
+
+  RCLCPP_PUBLIC
+  virtual ~ExecutorStatePublisher();
+
+  /// Publish the state of the executor now.
+  RCLCPP_PUBLIC
+  void
+  publish();
+
+  /// Return the messages describing a snapshot of the executor, without publishing them.
+  RCLCPP_PUBLIC
+  std::vector<statistics_msgs::msg::MetricsMessage>
+  generate_messages();
+
+  /// Return the messages describing the given snapshot.
+  RCLCPP_PUBLIC
+  std::vector<statistics_msgs::msg::MetricsMessage>
+  generate_messages(const rclcpp::ExecutorSnapshot & snapshot);
+
+private:
+  RCLCPP_PUBLIC
+  static rclcpp::Time
+  now();
+
+  const rclcpp::Executor & executor_;
+  rclcpp::Time window_start_;
+  rclcpp::Publisher<statistics_msgs::msg::MetricsMessage>::SharedPtr publisher_;
+  rclcpp::TimerBase::SharedPtr timer_;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXECUTOR_STATE_PUBLISHER_HPP_
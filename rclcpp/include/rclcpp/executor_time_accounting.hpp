@@ -0,0 +1,156 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXECUTOR_TIME_ACCOUNTING_HPP_
+#define RCLCPP__EXECUTOR_TIME_ACCOUNTING_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// What a thread of an executor is spending its time on.
+enum class ExecutorActivity
+{
+  /// Collecting the entities and filling the wait set.
+  Collect,
+  /// Blocked in rcl_wait(), or polling the wait set.
+  Wait,
+  /// Selecting the next ready executable.
+  Select,
+  /// Executing callbacks.
+  Execute,
+  /// Waiting for another thread of the executor, e.g. for its turn to wait for work.
+  Idle
+};
+
+/// Accumulated time of an activity of a thread.
+struct ExecutorActivityTime
+{
+  /// Total time spent in the activity.
+  std::chrono::nanoseconds duration{0};
+  /// Number of times the thread entered the activity.
+  uint64_t count = 0;
+};
+
+/// Time spent by a thread of an executor in each of its activities.
+struct ExecutorThreadTimes
+{
+  /// Identifier of the thread.
+  std::thread::id thread_id;
+  ExecutorActivityTime collect;
+  ExecutorActivityTime wait;
+  ExecutorActivityTime select;
+  ExecutorActivityTime execute;
+  ExecutorActivityTime idle;
+
+  /// Return the accumulated time of the given activity.
+  RCLCPP_PUBLIC
+  const ExecutorActivityTime &
+  get(ExecutorActivity activity) const;
+
+  /// Return the time accounted to all the activities.
+  RCLCPP_PUBLIC
+  std::chrono::nanoseconds
+  total() const;
+
+  /// Return the fraction of the accounted time the thread was busy, between 0 and 1.
+  /**
+   * The thread is busy unless it waits for work or for another thread, so a utilization close
+   * to 1 means that it is saturated.
+   * A high collect time compared to the execute time means that it's mostly rebuilding the wait
+   * set rather than executing callbacks.
+   * \return the busy fraction, 0 if no time was accounted.
+   */
+  RCLCPP_PUBLIC
+  double
+  utilization() const;
+};
+
+/// Accounts the time spent by each thread of an executor in each ExecutorActivity.
+/**
+ * The counters of a thread are atomics only written by that thread, so that accounting never
+ * takes a lock once the thread is known, and reading them doesn't stop the threads.
+ */
+class ExecutorTimeAccounting
+{
+public:
+  /// Accounts its lifetime to an activity of the calling thread.
+  class Scope
+  {
+public:
+    /// Start accounting, does nothing if accounting is nullptr.
+    RCLCPP_PUBLIC
+    Scope(ExecutorTimeAccounting * accounting, ExecutorActivity activity);
+
+    RCLCPP_PUBLIC
+    ~Scope();
+
+    Scope(const Scope &) = delete;
+    Scope & operator=(const Scope &) = delete;
+
+private:
+    ExecutorTimeAccounting * accounting_;
+    ExecutorActivity activity_;
+    std::chrono::steady_clock::time_point start_time_;
+  };
+
+  RCLCPP_PUBLIC
+  ExecutorTimeAccounting();
+
+  RCLCPP_PUBLIC
+  ~ExecutorTimeAccounting();
+
+  /// Account a duration to an activity of the calling thread.
+  RCLCPP_PUBLIC
+  void
+  record(ExecutorActivity activity, std::chrono::nanoseconds duration);
+
+  /// Return the times of each thread which accounted time, in the order they first did.
+  RCLCPP_PUBLIC
+  std::vector<ExecutorThreadTimes>
+  get_thread_times() const;
+
+  /// Zero the times of all the threads.
+  /**
+   * Durations recorded concurrently with the reset may be partially kept.
+   */
+  RCLCPP_PUBLIC
+  void
+  reset();
+
+private:
+  struct ThreadTimes;
+
+  /// Return the counters of the calling thread, creating them on first use.
+  ThreadTimes &
+  get_thread_times_of_this_thread();
+
+  /// Unique identifier of this object, used to find the counters of the calling thread.
+  const uint64_t id_;
+
+  mutable std::mutex threads_mutex_;
+  std::vector<std::shared_ptr<ThreadTimes>> threads_;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXECUTOR_TIME_ACCOUNTING_HPP_
@@ -19,7 +19,9 @@
 #include <memory>
 
 #include "rclcpp/executors/multi_threaded_executor.hpp"
+#include "rclcpp/executors/realtime_executor.hpp"
 #include "rclcpp/executors/single_threaded_executor.hpp"
+#include "rclcpp/executors/static_multi_threaded_executor.hpp"
 #include "rclcpp/executors/static_single_threaded_executor.hpp"
 #include "rclcpp/node.hpp"
 #include "rclcpp/utilities.hpp"
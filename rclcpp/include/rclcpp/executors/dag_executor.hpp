@@ -0,0 +1,283 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXECUTORS__DAG_EXECUTOR_HPP_
+#define RCLCPP__EXECUTORS__DAG_EXECUTOR_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "rclcpp/executor.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/subscription_base.hpp"
+#include "rclcpp/thread.hpp"
+#include "rclcpp/timer.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace executors
+{
+
+/// Directed acyclic graph of callbacks, run to completion by a rclcpp::executors::DagExecutor.
+/**
+ * A stage runs once all the stages it depends on have completed.
+ * The dependencies are either given explicitly, by the names of the stages, or derived from the
+ * topics the stages consume and produce: a stage depends on the stages producing its inputs.
+ * The topics only describe the flow of the data between the stages, which pass it through
+ * their own state instead of the middleware.
+ *
+ * The pipeline runs each time its trigger, a timer or a subscription, is executed.
+ */
+class DagPipeline
+{
+public:
+  using StageCallback = std::function<void ()>;
+
+  /// Create an empty pipeline.
+  /**
+   * \param[in] name name of the pipeline, used in the error messages.
+   */
+  RCLCPP_PUBLIC
+  explicit DagPipeline(const std::string & name);
+
+  /// Add a stage which runs once the given stages have completed.
+  /**
+   * The dependencies may be added after the stage, they are resolved by
+   * rclcpp::executors::DagExecutor::add_pipeline().
+   *
+   * \param[in] name name of the stage, unique in the pipeline.
+   * \param[in] callback work of the stage.
+   * \param[in] dependencies names of the stages to complete before this one.
+   * \throws std::invalid_argument if the name is already taken or the callback is empty.
+   */
+  RCLCPP_PUBLIC
+  void
+  add_stage(
+    const std::string & name,
+    StageCallback callback,
+    const std::vector<std::string> & dependencies = {});
+
+  /// Add a stage which runs once the stages producing the topics it consumes have completed.
+  /**
+   * Topics produced by no stage are inputs of the pipeline, e.g. the topic of its trigger.
+   * Explicit dependencies and topics can be mixed in a pipeline.
+   *
+   * \param[in] name name of the stage, unique in the pipeline.
+   * \param[in] callback work of the stage.
+   * \param[in] input_topics topics consumed by the stage.
+   * \param[in] output_topics topics produced by the stage.
+   * \throws std::invalid_argument if the name is already taken or the callback is empty.
+   */
+  RCLCPP_PUBLIC
+  void
+  add_stage_with_topics(
+    const std::string & name,
+    StageCallback callback,
+    const std::vector<std::string> & input_topics,
+    const std::vector<std::string> & output_topics);
+
+  /// Run the pipeline after each execution of the given timer.
+  RCLCPP_PUBLIC
+  void
+  set_trigger(rclcpp::TimerBase::SharedPtr timer);
+
+  /// Run the pipeline after each execution of the given subscription.
+  RCLCPP_PUBLIC
+  void
+  set_trigger(rclcpp::SubscriptionBase::SharedPtr subscription);
+
+  RCLCPP_PUBLIC
+  const std::string &
+  get_name() const;
+
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_stages() const;
+
+  /// Return the names of the stages, in the order in which a single thread runs them.
+  /**
+   * Among the stages whose dependencies are complete, the first added runs first.
+   * \throws std::invalid_argument if a dependency isn't a stage, or the dependencies are cyclic.
+   */
+  RCLCPP_PUBLIC
+  std::vector<std::string>
+  get_topological_order() const;
+
+private:
+  friend class DagExecutor;
+
+  struct Stage
+  {
+    std::string name;
+    StageCallback callback;
+    std::vector<std::string> dependencies;
+    std::vector<std::string> input_topics;
+    std::vector<std::string> output_topics;
+  };
+
+  void
+  add_stage_impl(Stage stage);
+
+  /// Return the indices of the stages in topological order, and the dependencies of each stage.
+  std::vector<size_t>
+  sort_stages(std::vector<std::vector<size_t>> & dependencies) const;
+
+  std::string name_;
+  std::vector<Stage> stages_;
+  rclcpp::TimerBase::WeakPtr trigger_timer_;
+  rclcpp::SubscriptionBase::WeakPtr trigger_subscription_;
+};
+
+/// Executor running pipelines of callbacks to completion, for deterministic latencies.
+/**
+ * The entities of the nodes are executed like by the SingleThreadedExecutor.
+ * When the trigger of a pipeline has been executed, all the stages of the pipeline run before
+ * the executor waits for work again: the stages run in a precomputed topological order, the
+ * independent branches in parallel over the fixed set of threads of the executor, and nothing
+ * is allocated while the pipeline runs.
+ */
+class DagExecutor : public rclcpp::Executor
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(DagExecutor)
+
+  /// Create the executor and its threads.
+  /**
+   * The helper threads use the thread attributes of the options, indexed by thread.
+   *
+   * \param[in] options common options for all executors.
+   * \param[in] number_of_threads number of threads running the stages, including the spinning
+   *   one, the default 1 runs them all in the spinning thread, 0 uses the number of cpu cores.
+   */
+  RCLCPP_PUBLIC
+  explicit DagExecutor(
+    const rclcpp::ExecutorOptions & options = rclcpp::ExecutorOptions(),
+    size_t number_of_threads = 1);
+
+  RCLCPP_PUBLIC
+  virtual ~DagExecutor();
+
+  /// Add a pipeline, ordering its stages and preparing the storage of its runs.
+  /**
+   * \param[in] pipeline the pipeline, copied.
+   * \return the index of the pipeline, for run_pipeline().
+   * \throws std::invalid_argument if a dependency isn't a stage, the dependencies are cyclic, or
+   *   the trigger is already the trigger of another pipeline.
+   * \throws std::runtime_error if the executor is spinning.
+   */
+  RCLCPP_PUBLIC
+  size_t
+  add_pipeline(const DagPipeline & pipeline);
+
+  /// Run all the stages of a pipeline, in the calling thread and the threads of the executor.
+  /**
+   * Once a stage throws, the stages which didn't start are skipped.
+   *
+   * \param[in] pipeline_index index returned by add_pipeline().
+   * \throws std::out_of_range if there is no pipeline with this index.
+   * \throws the first exception thrown by a stage, once the running stages have completed.
+   */
+  RCLCPP_PUBLIC
+  void
+  run_pipeline(size_t pipeline_index);
+
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_threads() const;
+
+  /// Execute work and run the pipelines it triggers until canceled.
+  /**
+   * \throws std::runtime_error when spin() called while already spinning
+   */
+  RCLCPP_PUBLIC
+  void
+  spin() override;
+
+  RCLCPP_PUBLIC
+  void
+  spin_some(std::chrono::nanoseconds max_duration = std::chrono::nanoseconds(0)) override;
+
+  RCLCPP_PUBLIC
+  void
+  spin_all(std::chrono::nanoseconds max_duration) override;
+
+protected:
+  RCLCPP_PUBLIC
+  void
+  spin_once_impl(std::chrono::nanoseconds timeout) override;
+
+private:
+  RCLCPP_DISABLE_COPY(DagExecutor)
+
+  /// A pipeline with its stages in topological order.
+  struct CompiledPipeline
+  {
+    std::vector<DagPipeline::StageCallback> callbacks;
+    /// Successors of the stage i in successors[successor_offsets[i], successor_offsets[i + 1]).
+    std::vector<size_t> successor_offsets;
+    std::vector<size_t> successors;
+    std::vector<size_t> number_of_dependencies;
+    std::vector<size_t> roots;
+  };
+
+  void
+  spin_some_with_pipelines(std::chrono::nanoseconds max_duration, bool exhaustive);
+
+  /// Execute the executable, then the pipeline it triggers if any.
+  void
+  execute_and_run_pipeline(AnyExecutable & any_exec);
+
+  /// Run a ready stage of the current run, the lock is released while the stage runs.
+  void
+  run_ready_stage(std::unique_lock<std::mutex> & lock);
+
+  void
+  run_helper();
+
+  std::vector<std::unique_ptr<CompiledPipeline>> pipelines_;
+  /// Index of the pipeline triggered by an entity, only modified while not spinning.
+  std::unordered_map<const void *, size_t> trigger_pipelines_;
+
+  /// Held by the runs, one pipeline runs at a time.
+  std::mutex run_mutex_;
+
+  /// State of the current run, shared by the threads running its stages.
+  std::mutex stages_mutex_;
+  std::condition_variable ready_cv_;
+  std::condition_variable completed_cv_;
+  const CompiledPipeline * running_pipeline_ = nullptr;
+  /// Number of dependencies of each stage which didn't complete yet.
+  std::vector<size_t> remaining_dependencies_;
+  /// Queue of the stages ready to run, with capacity for all the stages.
+  std::vector<size_t> ready_stages_;
+  size_t next_ready_stage_ = 0;
+  size_t remaining_stages_ = 0;
+  std::exception_ptr stage_exception_;
+  bool stopping_ = false;
+
+  std::vector<rclcpp::Thread> threads_;
+};
+
+}  // namespace executors
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXECUTORS__DAG_EXECUTOR_HPP_
@@ -0,0 +1,200 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXECUTORS__EXECUTOR_GROUP_MANAGER_HPP_
+#define RCLCPP__EXECUTORS__EXECUTOR_GROUP_MANAGER_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "rclcpp/callback_group.hpp"
+#include "rclcpp/executor.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/node_interfaces/node_base_interface.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace executors
+{
+
+/// Options of the balancing done by an ExecutorGroupManager.
+struct ExecutorGroupManagerOptions
+{
+  /// Relative difference between the most and least loaded executors which is tolerated.
+  /**
+   * Callback groups are only migrated when the load of the most loaded executor exceeds the
+   * load of the least loaded one by more than this fraction of the former.
+   */
+  double imbalance_threshold = 0.2;
+
+  /// Maximum number of callback groups migrated by a call to rebalance().
+  size_t max_migrations = 1;
+};
+
+/// Balances the load of callback groups across several executors.
+/**
+ * The callback groups are added to the manager instead of to the executors, the manager adds
+ * each of them to one of its executors and may later migrate it to another one.
+ * The load of each callback group is the time its callbacks took to execute, measured with
+ * the callback statistics of the executors, see rclcpp::Executor::get_callback_statistics(),
+ * which the manager enables.
+ *
+ * rebalance() measures the load since its previous call, and migrates callback groups from
+ * the most loaded executors to the least loaded ones, among the executors each callback group
+ * is allowed to run on.
+ * It is meant to be called periodically, e.g. from a wall timer, while the executors spin in
+ * their own threads.
+ * A callback group is migrated at a safe point: it is reserved, as executors do before
+ * executing one of its callbacks, so that it isn't executing while it changes executor, and
+ * it is skipped until the next call if it is busy.
+ * The executors are woken up to update their wait sets.
+ *
+ * The executors and callback groups must not be used with other executors or managers, and
+ * the executors must not be given the nodes of the callback groups with
+ * rclcpp::Executor::add_node().
+ *
+ * This class is thread-safe.
+ */
+class ExecutorGroupManager
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(ExecutorGroupManager)
+
+  /// Index of an executor in the manager, in the order of add_executor() calls.
+  using ExecutorIndex = size_t;
+
+  /// Load of a callback group measured by the last call to rebalance().
+  struct CallbackGroupLoad
+  {
+    rclcpp::CallbackGroup::WeakPtr callback_group;
+    /// Executor the callback group is on, after the rebalancing.
+    ExecutorIndex executor = 0;
+    /// Time spent executing the callbacks of the group, between the last two rebalancings.
+    std::chrono::nanoseconds execution_time{0};
+  };
+
+  RCLCPP_PUBLIC
+  explicit ExecutorGroupManager(
+    const ExecutorGroupManagerOptions & options = ExecutorGroupManagerOptions());
+
+  /// Remove the managed callback groups from their executors.
+  RCLCPP_PUBLIC
+  virtual ~ExecutorGroupManager();
+
+  /// Add an executor the callback groups can be assigned to.
+  /**
+   * The callback statistics of the executor are enabled and reset.
+   *
+   * \param[in] executor the executor to add.
+   * \param[in] capacity relative capacity of the executor, e.g. its number of threads, the load
+   *   of the executors is compared once divided by their capacity.
+   * \return the index of the executor.
+   * \throws std::invalid_argument if the executor is nullptr or the capacity isn't positive.
+   */
+  RCLCPP_PUBLIC
+  ExecutorIndex
+  add_executor(rclcpp::Executor::SharedPtr executor, double capacity = 1.0);
+
+  /// Return the number of executors.
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_executors() const;
+
+  /// Add a callback group, to the least loaded of the allowed executors.
+  /**
+   * \param[in] group_ptr the callback group to add.
+   * \param[in] node_ptr the node of the callback group.
+   * \param[in] allowed_executors the executors the callback group may run on, any executor
+   *   if empty.
+   * \return the executor the callback group was added to.
+   * \throws std::invalid_argument if the callback group or the node is nullptr, or one of the
+   *   allowed executors doesn't exist.
+   * \throws std::runtime_error if there is no executor, or if the callback group has already
+   *   been added to the manager or to an executor.
+   */
+  RCLCPP_PUBLIC
+  ExecutorIndex
+  add_callback_group(
+    rclcpp::CallbackGroup::SharedPtr group_ptr,
+    rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_ptr,
+    const std::vector<ExecutorIndex> & allowed_executors = {});
+
+  /// Remove a callback group from the manager and from its executor.
+  /**
+   * \throws std::runtime_error if the callback group isn't managed.
+   */
+  RCLCPP_PUBLIC
+  void
+  remove_callback_group(const rclcpp::CallbackGroup::SharedPtr & group_ptr);
+
+  /// Return the executor a callback group is on.
+  /**
+   * \throws std::runtime_error if the callback group isn't managed.
+   */
+  RCLCPP_PUBLIC
+  ExecutorIndex
+  get_executor_index(const rclcpp::CallbackGroup::SharedPtr & group_ptr) const;
+
+  /// Measure the load since the previous call, and migrate callback groups to balance it.
+  /**
+   * \return the number of callback groups migrated.
+   */
+  RCLCPP_PUBLIC
+  size_t
+  rebalance();
+
+  /// Return the loads of the callback groups measured by the last call to rebalance().
+  RCLCPP_PUBLIC
+  std::vector<CallbackGroupLoad>
+  get_callback_group_loads() const;
+
+private:
+  struct ManagedExecutor
+  {
+    rclcpp::Executor::SharedPtr executor;
+    double capacity;
+  };
+
+  struct ManagedCallbackGroup
+  {
+    rclcpp::CallbackGroup::WeakPtr callback_group;
+    rclcpp::node_interfaces::NodeBaseInterface::WeakPtr node;
+    /// Allowed executors, any of them if empty.
+    std::vector<ExecutorIndex> allowed_executors;
+    ExecutorIndex executor = 0;
+    std::chrono::nanoseconds execution_time{0};
+  };
+
+  bool
+  is_allowed(const ManagedCallbackGroup & group, ExecutorIndex executor) const;
+
+  /// Move a callback group at a safe point, return false if it was busy.
+  bool
+  migrate(ManagedCallbackGroup & group, ExecutorIndex executor);
+
+  const ExecutorGroupManagerOptions options_;
+  mutable std::mutex mutex_;
+  std::vector<ManagedExecutor> executors_;
+  /// Managed callback groups, by address, which is how the callback statistics identify them.
+  std::unordered_map<const void *, ManagedCallbackGroup> callback_groups_;
+};
+
+}  // namespace executors
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXECUTORS__EXECUTOR_GROUP_MANAGER_HPP_
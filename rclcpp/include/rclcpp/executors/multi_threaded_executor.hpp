@@ -15,16 +15,23 @@
 #ifndef RCLCPP__EXECUTORS__MULTI_THREADED_EXECUTOR_HPP_
 #define RCLCPP__EXECUTORS__MULTI_THREADED_EXECUTOR_HPP_
 
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <memory>
 #include <mutex>
 #include <set>
 #include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include "rclcpp/executor.hpp"
 #include "rclcpp/macros.hpp"
 #include "rclcpp/memory_strategies.hpp"
+#include "rclcpp/thread.hpp"
+#include "rclcpp/thread_attributes.hpp"
 #include "rclcpp/visibility_control.hpp"
 
 namespace rclcpp
@@ -37,6 +44,16 @@ class MultiThreadedExecutor : public rclcpp::Executor
 public:
   RCLCPP_SMART_PTR_DEFINITIONS(MultiThreadedExecutor)
 
+  /// How the threads of the pool wait for and pick up work.
+  enum class SchedulingMode
+  {
+    /// All the threads share a single mutex around waiting and picking the next executable.
+    SharedWait,
+    /// One thread at a time waits for work and distributes all the ready executables to
+    /// per-thread queues, idle threads steal work from the queues of the other threads.
+    WorkStealing
+  };
+
   /// Constructor for MultiThreadedExecutor.
   /**
    * For the yield_before_execute option, when true std::this_thread::yield()
@@ -45,18 +62,30 @@ public:
    * This is useful for reproducing some bugs related to taking work more than
    * once.
    *
+   * If options.thread_attributes is not empty, all the worker threads are created by the
+   * executor with the attributes of their index, and the thread calling spin() only waits for
+   * them to finish.
+   * Otherwise the thread calling spin() is used as one of the workers.
+   *
+   * The scheduling_mode selects how the threads obtain work.
+   * With SchedulingMode::WorkStealing, executing a callback never waits for another
+   * thread to be done picking work, and mutually exclusive callback groups still
+   * have at most one of their executables queued or running at any time.
+   *
    * \param options common options for all executors
    * \param number_of_threads number of threads to have in the thread pool,
    *   the default 0 will use the number of cpu cores found (minimum of 2)
    * \param yield_before_execute if true std::this_thread::yield() is called
    * \param timeout maximum time to wait
+   * \param scheduling_mode how the threads wait for and pick up work
    */
   RCLCPP_PUBLIC
   explicit MultiThreadedExecutor(
     const rclcpp::ExecutorOptions & options = rclcpp::ExecutorOptions(),
     size_t number_of_threads = 0,
     bool yield_before_execute = false,
-    std::chrono::nanoseconds timeout = std::chrono::nanoseconds(-1));
+    std::chrono::nanoseconds timeout = std::chrono::nanoseconds(-1),
+    SchedulingMode scheduling_mode = SchedulingMode::SharedWait);
 
   RCLCPP_PUBLIC
   virtual ~MultiThreadedExecutor();
@@ -69,22 +98,237 @@ public:
   void
   spin() override;
 
+  /// Return the number of threads of the pool, its maximum size when it's dynamic.
   RCLCPP_PUBLIC
   size_t
   get_number_of_threads();
 
+  /// Size the thread pool dynamically between a minimum and a maximum number of threads.
+  /**
+   * The pool starts spinning with min_threads threads.
+   * A thread is added when an executable waited at least grow_queueing_delay in a queue
+   * before being executed, at most once per grow_queueing_delay.
+   * The thread with the highest index retires after being idle for shrink_idle_time, as long
+   * as the pool has more than min_threads threads.
+   * The number_of_threads given to the constructor is replaced by max_threads.
+   *
+   * Only supported with SchedulingMode::WorkStealing, whose queues tell how long the ready
+   * executables wait.
+   *
+   * \param[in] min_threads number of threads which never retire, at least 1.
+   * \param[in] max_threads maximum number of threads, at least min_threads.
+   * \param[in] grow_queueing_delay queueing delay above which a thread is added.
+   * \param[in] shrink_idle_time time after which an idle thread retires.
+   * \throws std::invalid_argument if the scheduling mode isn't SchedulingMode::WorkStealing,
+   *   or if an argument is out of range.
+   * \throws std::runtime_error if the executor is spinning.
+   */
+  RCLCPP_PUBLIC
+  void
+  set_dynamic_thread_pool(
+    size_t min_threads,
+    size_t max_threads,
+    std::chrono::nanoseconds grow_queueing_delay = std::chrono::milliseconds(1),
+    std::chrono::nanoseconds shrink_idle_time = std::chrono::seconds(1));
+
+  /// Prefer running each callback group on the thread which executed it last.
+  /**
+   * The ready executables of a callback group are queued for the thread which executed an
+   * executable of the group last, so that the state and the messages of the group stay in the
+   * caches of its core.
+   * A thread only steals the executables queued for the other threads once it has been idle
+   * for steal_idle_threshold, so the groups move to another thread when theirs lags behind.
+   *
+   * Only supported with SchedulingMode::WorkStealing, whose per-thread queues it relies on.
+   *
+   * \param[in] steal_idle_threshold idle time after which a thread steals the work of others.
+   * \throws std::invalid_argument if the scheduling mode isn't SchedulingMode::WorkStealing,
+   *   or if the threshold is negative.
+   * \throws std::runtime_error if the executor is spinning.
+   */
+  RCLCPP_PUBLIC
+  void
+  set_callback_group_affinity(
+    std::chrono::nanoseconds steal_idle_threshold = std::chrono::milliseconds(1));
+
+  /// Return the number of threads currently running in the pool.
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_active_threads() const;
+
+  RCLCPP_PUBLIC
+  SchedulingMode
+  get_scheduling_mode() const;
+
+  /// Executions counted when the NUMA aware mode is enabled, see ExecutorOptions::numa_aware.
+  struct NumaStatistics
+  {
+    /// Executions by a worker of the node holding the memory of the entity.
+    uint64_t local_executions = 0;
+    /// Executions by a worker of another node, i.e. with traffic between the nodes.
+    uint64_t remote_executions = 0;
+  };
+
+  /// Return the executions counted since the executor was created.
+  /**
+   * Executions whose worker or entity node is unknown are not counted.
+   */
+  RCLCPP_PUBLIC
+  NumaStatistics
+  get_numa_statistics() const;
+
+  /// Executions counted when the callback group affinity is enabled.
+  struct AffinityStatistics
+  {
+    /// Executions by the thread which executed the callback group last.
+    uint64_t affine_executions = 0;
+    /// Executions by another thread, i.e. the callback group moved to this thread.
+    uint64_t migrated_executions = 0;
+  };
+
+  /// Return the executions counted since the callback group affinity was enabled.
+  /**
+   * The first execution of a callback group is not counted.
+   */
+  RCLCPP_PUBLIC
+  AffinityStatistics
+  get_affinity_statistics() const;
+
 protected:
   RCLCPP_PUBLIC
   void
   run(size_t this_thread_number);
 
+  /// Worker loop used with SchedulingMode::WorkStealing.
+  RCLCPP_PUBLIC
+  void
+  run_work_stealing(size_t this_thread_number);
+
 private:
   RCLCPP_DISABLE_COPY(MultiThreadedExecutor)
 
+  /// Ready executable and the NUMA node holding its entity.
+  struct QueuedExecutable
+  {
+    // AnyExecutable resets its callback group when destroyed, so it is never copied around.
+    std::unique_ptr<rclcpp::AnyExecutable> executable;
+    size_t node;
+    /// Time the executable was queued at, only set with a dynamic thread pool.
+    std::chrono::steady_clock::time_point queued_time;
+  };
+
+  /// Ready executables assigned to one thread of the pool.
+  struct WorkerQueue
+  {
+    std::mutex mutex;
+    std::deque<QueuedExecutable> executables;
+  };
+
+  /// Create all the worker threads with their attributes and wait for them to finish.
+  void
+  spin_with_thread_attributes();
+
+  /// Spin with min_threads threads, and let the pool grow and shrink until spinning stops.
+  void
+  spin_dynamic_thread_pool();
+
+  /// Start the pool thread of the given index, with the pool mutex held.
+  void
+  start_pool_thread(size_t thread_id);
+
+  /// Add a thread to the dynamic pool, unless it's full or grew recently.
+  void
+  grow_thread_pool();
+
+  /// Return true if the given thread should leave the dynamic pool, with the work mutex held.
+  bool
+  should_retire(size_t this_thread_number, std::chrono::steady_clock::time_point idle_since) const;
+
+  /// Set the NUMA node of each worker thread, and their attributes if they're generated.
+  void
+  configure_numa_placement();
+
+  /// Pop from the front of the own queue, or steal from the back of another thread's queue.
+  /**
+   * In NUMA aware mode, the queues of the threads of the same node are tried first.
+   * \param[in] this_thread_number index of the thread.
+   * \param[in] may_steal false to only try the own queue.
+   */
+  QueuedExecutable
+  take_queued_executable(size_t this_thread_number, bool may_steal = true);
+
+  /// Return true if the queue of the given thread has executables.
+  bool
+  has_queued_executables(size_t this_thread_number);
+
+  /// Return the thread which executed the callback group of the executable last.
+  /**
+   * \return the index of the thread, or SIZE_MAX if it's unknown or the affinity is disabled.
+   */
+  size_t
+  get_group_thread(const rclcpp::AnyExecutable & any_exec);
+
+  /// Remember that the given thread executed the callback group of the executable.
+  void
+  record_group_thread(size_t this_thread_number, const rclcpp::AnyExecutable & any_exec);
+
+  /// Return the NUMA node holding the entity of the executable, or NumaTopology::unknown.
+  /**
+   * Called by the thread waiting for work only.
+   */
+  size_t
+  get_entity_node(const rclcpp::AnyExecutable & any_exec);
+
+  /// Count an execution of an entity of the given node by the given thread.
+  void
+  record_numa_execution(size_t this_thread_number, size_t entity_node);
+
+  /// Wait for work and spread every ready executable over the worker queues.
+  void
+  wait_and_distribute_executables(size_t this_thread_number);
+
   std::mutex wait_mutex_;
   size_t number_of_threads_;
   bool yield_before_execute_;
   std::chrono::nanoseconds next_exec_timeout_;
+  SchedulingMode scheduling_mode_;
+  std::vector<rclcpp::ThreadAttributes> thread_attributes_;
+
+  std::vector<std::unique_ptr<WorkerQueue>> worker_queues_;
+  std::atomic<size_t> queued_executables_ {0};
+  std::mutex work_mutex_;
+  std::condition_variable work_cv_;
+  bool waiting_for_work_ {false};
+
+  /// Number of threads running, the indices of the running threads are below this number.
+  std::atomic<size_t> active_threads_ {0};
+
+  bool dynamic_thread_pool_ {false};
+  size_t min_threads_ {0};
+  std::chrono::nanoseconds grow_queueing_delay_ {0};
+  std::chrono::nanoseconds shrink_idle_time_ {0};
+  /// Guards the threads of the dynamic pool and the time of the last growth.
+  std::mutex pool_mutex_;
+  std::vector<rclcpp::Thread> pool_threads_;
+  std::chrono::steady_clock::time_point last_growth_time_;
+
+  bool numa_aware_;
+  /// True if the thread attributes were generated for the NUMA aware mode.
+  bool numa_thread_attributes_ {false};
+  /// NUMA node of each worker thread.
+  std::vector<size_t> worker_nodes_;
+  /// Cache of the NUMA node of the entities, used by the thread waiting for work.
+  std::unordered_map<const void *, size_t> entity_nodes_;
+  std::atomic<uint64_t> numa_local_executions_ {0};
+  std::atomic<uint64_t> numa_remote_executions_ {0};
+
+  bool callback_group_affinity_ {false};
+  std::chrono::nanoseconds steal_idle_threshold_ {0};
+  /// Guards the thread which executed each callback group last.
+  std::mutex group_threads_mutex_;
+  std::unordered_map<const rclcpp::CallbackGroup *, size_t> group_threads_;
+  std::atomic<uint64_t> affine_executions_ {0};
+  std::atomic<uint64_t> migrated_executions_ {0};
 };
 
 }  // namespace executors
@@ -0,0 +1,175 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXECUTORS__REALTIME_EXECUTOR_HPP_
+#define RCLCPP__EXECUTORS__REALTIME_EXECUTOR_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "rmw/types.h"
+
+#include "rclcpp/allocation_guard.hpp"
+#include "rclcpp/executors/static_single_threaded_executor.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/serialized_message.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace executors
+{
+
+/// Static executor which doesn't allocate once spinning, for real-time threads.
+/**
+ * Like the StaticSingleThreadedExecutor, the entities are collected once, and only collected
+ * again when entities are added or removed.
+ * In addition, when starting to spin and after each collection, this executor allocates
+ * one message for each subscription, and one request and request header for each service, and
+ * the responses and request headers of the clients, which are taken into again and again.
+ * A message is only allocated again when the callback of its subscription kept a reference to
+ * it, so the callbacks should take their messages by const reference or const shared pointer.
+ * Taking a message into a reused one only allocates when one of its unbounded fields grows.
+ *
+ * Once the entities are prepared, the spinning thread is within an AllocationGuard with the
+ * given check, so that the allocations it makes can be counted, or abort the process, to find
+ * them while developing the application.
+ * The collection of the entities is always allowed to allocate, adding or removing entities is
+ * expected to happen before spinning, not in a steady state.
+ * What still allocates:
+ *   - the waitables, e.g. the intra-process subscriptions, when taking their data,
+ *   - the typed services when creating their responses, and the clients when completing the
+ *     future of a request,
+ *   - the subscription callbacks taking unique pointers, which copy their message,
+ *   - the user callbacks and the middleware.
+ *
+ * The allocations are only seen when the global operator new is replaced, see
+ * rclcpp/allocation_guard_operators.hpp.
+ */
+class RealtimeExecutor : public StaticSingleThreadedExecutor
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(RealtimeExecutor)
+
+  /// Create the executor.
+  /**
+   * \param[in] options common options for all executors.
+   * \param[in] allocation_check check of the allocations made by the spinning thread.
+   */
+  RCLCPP_PUBLIC
+  explicit RealtimeExecutor(
+    const rclcpp::ExecutorOptions & options = rclcpp::ExecutorOptions(),
+    rclcpp::AllocationCheck allocation_check = rclcpp::AllocationCheck::Count);
+
+  RCLCPP_PUBLIC
+  virtual ~RealtimeExecutor();
+
+  RCLCPP_PUBLIC
+  void
+  spin() override;
+
+  RCLCPP_PUBLIC
+  void
+  spin_some(std::chrono::nanoseconds max_duration = std::chrono::nanoseconds(0)) override;
+
+  RCLCPP_PUBLIC
+  void
+  spin_all(std::chrono::nanoseconds max_duration) override;
+
+  /// Return the number of allocations counted while spinning, outside of the collections.
+  /**
+   * The count is updated after each execution of the ready entities, and only increases with
+   * AllocationCheck::Count.
+   */
+  RCLCPP_PUBLIC
+  size_t
+  get_allocation_count() const;
+
+protected:
+  RCLCPP_PUBLIC
+  bool
+  execute_ready_executables(bool spin_once = false) override;
+
+  RCLCPP_PUBLIC
+  void
+  spin_once_impl(std::chrono::nanoseconds timeout) override;
+
+private:
+  RCLCPP_DISABLE_COPY(RealtimeExecutor)
+
+  /// Storage taken into by a subscription, a service or a client.
+  template<typename EntityT>
+  struct Slot
+  {
+    std::shared_ptr<EntityT> entity;
+    /// Message, request or response.
+    std::shared_ptr<void> data;
+    /// Use count of the data, or serialized message, when only this slot refers to it.
+    long use_count = 0;  // NOLINT(runtime/int)
+    std::shared_ptr<rmw_request_id_t> request_header;
+    std::shared_ptr<rclcpp::SerializedMessage> serialized_message;
+  };
+
+  /// Initialize the collector if needed, and prepare the storage of its entities.
+  void
+  prepare_entities();
+
+  /// Create the storage of the entities collected since the last call.
+  void
+  prepare_slots();
+
+  void
+  prepare_subscription_slot(
+    Slot<rclcpp::SubscriptionBase> & slot,
+    const rclcpp::SubscriptionBase::SharedPtr & subscription);
+
+  void
+  prepare_service_slot(
+    Slot<rclcpp::ServiceBase> & slot, const rclcpp::ServiceBase::SharedPtr & service);
+
+  void
+  prepare_client_slot(
+    Slot<rclcpp::ClientBase> & slot, const rclcpp::ClientBase::SharedPtr & client);
+
+  /// Return the messages of the slot to its subscription.
+  static void
+  release_subscription_slot(Slot<rclcpp::SubscriptionBase> & slot);
+
+  void
+  execute_subscription_slot(Slot<rclcpp::SubscriptionBase> & slot);
+
+  void
+  execute_service_slot(Slot<rclcpp::ServiceBase> & slot);
+
+  void
+  execute_client_slot(Slot<rclcpp::ClientBase> & slot);
+
+  /// Spin like StaticSingleThreadedExecutor::spin_some_impl(), within the allocation guard.
+  void
+  spin_some_guarded(std::chrono::nanoseconds max_duration, bool exhaustive);
+
+  const rclcpp::AllocationCheck allocation_check_;
+  std::atomic<size_t> allocation_count_{0};
+
+  std::vector<Slot<rclcpp::SubscriptionBase>> subscription_slots_;
+  std::vector<Slot<rclcpp::ServiceBase>> service_slots_;
+  std::vector<Slot<rclcpp::ClientBase>> client_slots_;
+};
+
+}  // namespace executors
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXECUTORS__REALTIME_EXECUTOR_HPP_
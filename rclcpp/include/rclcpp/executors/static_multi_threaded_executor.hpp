@@ -0,0 +1,157 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXECUTORS__STATIC_MULTI_THREADED_EXECUTOR_HPP_
+#define RCLCPP__EXECUTORS__STATIC_MULTI_THREADED_EXECUTOR_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "rclcpp/executors/static_single_threaded_executor.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/thread_attributes.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace executors
+{
+
+/// Static executor implementation executing callbacks in a pool of threads
+/**
+ * This executor is a multi-threaded version of the StaticSingleThreadedExecutor.
+ * Like it, it doesn't reconstruct the executable list for every iteration: the entities are
+ * collected once, and again only when the guard condition of the entities collector fires,
+ * i.e. when an entity is added/removed to/from a node.
+ *
+ * Every time the executable list is rebuilt, each entity is assigned to a worker thread:
+ * all the entities of a mutually exclusive callback group are assigned to the same worker,
+ * so they are never executed at the same time, while the entities of reentrant callback groups
+ * are spread over all the workers.
+ *
+ * The thread calling spin() waits for work and hands the ready entities to the queue of their
+ * worker; an entity is not handed out again before its previous execution is over.
+ * spin_some(), spin_all() and spin_once() execute the work in the calling thread,
+ * as the StaticSingleThreadedExecutor does.
+ */
+class StaticMultiThreadedExecutor : public StaticSingleThreadedExecutor
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(StaticMultiThreadedExecutor)
+
+  /// Constructor for StaticMultiThreadedExecutor.
+  /**
+   * The worker threads use the thread attributes of the options, indexed by worker.
+   *
+   * \param options common options for all executors
+   * \param number_of_threads number of worker threads to have in the thread pool,
+   *   the default 0 will use the number of cpu cores found (minimum of 2)
+   */
+  RCLCPP_PUBLIC
+  explicit StaticMultiThreadedExecutor(
+    const rclcpp::ExecutorOptions & options = rclcpp::ExecutorOptions(),
+    size_t number_of_threads = 0);
+
+  RCLCPP_PUBLIC
+  virtual ~StaticMultiThreadedExecutor();
+
+  /// Static multi-threaded executor implementation of spin.
+  /**
+   * This function will block until work comes in, hand it to the worker threads, and keep
+   * blocking.
+   * It will only be interrupted by a CTRL-C (managed by the global signal handler).
+   * \throws std::runtime_error when spin() called while already spinning
+   */
+  RCLCPP_PUBLIC
+  void
+  spin() override;
+
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_threads();
+
+protected:
+  /// Assign the entities of the executable list to the workers.
+  RCLCPP_PUBLIC
+  void
+  build_entities_layout();
+
+  /// Hand the ready entities of the wait set to their workers.
+  /**
+   * \return true if any entity was handed to a worker.
+   */
+  RCLCPP_PUBLIC
+  bool
+  dispatch_ready_executables();
+
+  /// Execute the work handed to the given worker until the executor stops spinning.
+  RCLCPP_PUBLIC
+  void
+  run_worker(size_t worker_id);
+
+private:
+  RCLCPP_DISABLE_COPY(StaticMultiThreadedExecutor)
+
+  /// Worker and callback group of an entity of the executable list.
+  struct EntityPlacement
+  {
+    size_t worker_id;
+    rclcpp::CallbackGroup::WeakPtr callback_group;
+  };
+
+  struct WorkerQueue
+  {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<std::unique_ptr<rclcpp::AnyExecutable>> executables;
+  };
+
+  /// Hand an executable to the worker of the given entity, unless it is still executing.
+  /**
+   * \return false if the entity could not be handed out.
+   */
+  bool
+  dispatch(const void * entity, std::unique_ptr<rclcpp::AnyExecutable> executable);
+
+  /// Return true if the given entity was handed to a worker and did not finish executing.
+  bool
+  is_in_flight(const void * entity);
+
+  size_t number_of_threads_;
+  std::vector<rclcpp::ThreadAttributes> thread_attributes_;
+
+  /// Placement of the entities, keyed by their address, rebuilt with the executable list.
+  std::unordered_map<const void *, EntityPlacement> entities_layout_;
+
+  std::vector<std::unique_ptr<WorkerQueue>> worker_queues_;
+  std::atomic_bool workers_running_{false};
+
+  /// Entities handed to a worker which did not finish executing, and a completion counter.
+  std::mutex in_flight_mutex_;
+  std::condition_variable in_flight_cv_;
+  std::unordered_set<const void *> in_flight_entities_;
+  uint64_t completed_executions_ = 0;
+};
+
+}  // namespace executors
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXECUTORS__STATIC_MULTI_THREADED_EXECUTOR_HPP_
@@ -30,6 +30,7 @@
 #include "rclcpp/macros.hpp"
 #include "rclcpp/memory_strategies.hpp"
 #include "rclcpp/node.hpp"
+#include "rclcpp/ready_entities.hpp"
 #include "rclcpp/rate.hpp"
 #include "rclcpp/utilities.hpp"
 #include "rclcpp/visibility_control.hpp"
@@ -116,6 +117,14 @@ public:
   void
   spin_all(std::chrono::nanoseconds max_duration) override;
 
+  /// Not supported, the work isn't collected with the memory strategy.
+  /**
+   * \throws std::runtime_error always.
+   */
+  RCLCPP_PUBLIC
+  void
+  spin_some_with_quotas(const rclcpp::SpinQuotas & quotas) override;
+
   /// Add a callback group to an executor.
   /**
    * \sa rclcpp::Executor::add_callback_group
@@ -200,7 +209,7 @@ protected:
    * @return true if any executable was ready.
    */
   RCLCPP_PUBLIC
-  bool
+  virtual bool
   execute_ready_executables(bool spin_once = false);
 
   RCLCPP_PUBLIC
@@ -211,10 +220,13 @@ protected:
   void
   spin_once_impl(std::chrono::nanoseconds timeout) override;
 
+  StaticExecutorEntitiesCollector::SharedPtr entities_collector_;
+
 private:
   RCLCPP_DISABLE_COPY(StaticSingleThreadedExecutor)
 
-  StaticExecutorEntitiesCollector::SharedPtr entities_collector_;
+  /// Indices of the ready slots of the wait set, collected once after each wait.
+  rclcpp::ReadyIndices ready_indices_;
 };
 
 }  // namespace executors
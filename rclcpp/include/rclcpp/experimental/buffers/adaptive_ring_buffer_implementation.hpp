@@ -0,0 +1,384 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXPERIMENTAL__BUFFERS__ADAPTIVE_RING_BUFFER_IMPLEMENTATION_HPP_
+#define RCLCPP__EXPERIMENTAL__BUFFERS__ADAPTIVE_RING_BUFFER_IMPLEMENTATION_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "rclcpp/experimental/buffers/buffer_implementation_base.hpp"
+#include "rclcpp/flight_recorder.hpp"
+#include "rclcpp/experimental/buffers/buffer_implementation_factory.hpp"
+#include "rclcpp/qos.hpp"
+
+#include "tracetools/tracetools.h"
+
+namespace rclcpp
+{
+namespace experimental
+{
+namespace buffers
+{
+
+/// Change of the capacity of an adaptive buffer.
+struct BufferResize
+{
+  /// Capacity before the change.
+  size_t previous_capacity = 0;
+  /// Capacity after the change.
+  size_t capacity = 0;
+  /// Number of elements stored when the capacity changed.
+  size_t depth = 0;
+  /// Estimated memory, in bytes, of the elements stored when the capacity changed.
+  size_t memory_usage = 0;
+};
+
+/// Limits of the capacity of an AdaptiveRingBufferImplementation.
+struct AdaptiveBufferOptions
+{
+  /// Capacity of the buffer when the consumer keeps up, must be positive.
+  size_t min_depth = 1;
+  /// Largest capacity the buffer grows to, 0 for the depth of the QoS of the subscription.
+  size_t max_depth = 0;
+  /// Largest estimated memory, in bytes, of the elements stored, 0 for no limit.
+  /**
+   * The buffer doesn't grow beyond it, and drops its oldest elements to stay within it.
+   * The newest element is always stored, even if it doesn't fit alone.
+   */
+  size_t memory_budget = 0;
+  /// Number of enqueues after which the capacity is halved if the buffer stayed half empty.
+  size_t shrink_window = 100;
+  /// Called after each change of the capacity, by the thread enqueuing, without lock held.
+  std::function<void (const BufferResize &)> on_resize;
+};
+
+namespace detail
+{
+
+/// Size of the pointed to object for the smart pointers, of the element otherwise.
+template<typename BufferT, typename = void>
+struct DefaultElementSize
+{
+  static constexpr size_t value = sizeof(BufferT);
+};
+
+template<typename BufferT>
+struct DefaultElementSize<BufferT, std::void_t<typename BufferT::element_type>>
+{
+  static constexpr size_t value = sizeof(typename BufferT::element_type);
+};
+
+template<typename T>
+struct DefaultElementSize<T *>
+{
+  static constexpr size_t value = sizeof(T);
+};
+
+}  // namespace detail
+
+/// Store elements in a FIFO buffer whose capacity follows the lag of the consumer
+/**
+ * The buffer starts with a capacity of min_depth elements. When an element is enqueued into
+ * the full buffer, the capacity is doubled, up to max_depth and as long as the elements fit
+ * the memory budget; otherwise the oldest element is dropped, as for the ring buffers.
+ * Once the consumer catches up, the capacity is halved, down to min_depth, after each window
+ * of shrink_window enqueues during which the buffer never was more than half full.
+ *
+ * The memory of the elements is estimated with the given function, by default the size of
+ * the pointed to object for the pointers, e.g. the messages, and the size of the element
+ * otherwise.
+ * All public member functions are thread-safe.
+ */
+template<typename BufferT>
+class AdaptiveRingBufferImplementation : public BufferImplementationBase<BufferT>
+{
+public:
+  /// Function returning the estimated memory of an element, in bytes.
+  using ElementSizeFunction = std::function<size_t (const BufferT &)>;
+
+  /// Create an adaptive buffer.
+  /**
+   * \param[in] options the limits of the capacity, max_depth must be set.
+   * \param[in] element_size the estimation of the memory of the elements, nullptr for the
+   *   default one.
+   * \throws std::invalid_argument if min_depth is 0 or greater than max_depth.
+   */
+  explicit AdaptiveRingBufferImplementation(
+    AdaptiveBufferOptions options,
+    ElementSizeFunction element_size = nullptr)
+  : options_(std::move(options)),
+    element_size_(std::move(element_size)),
+    capacity_(options_.min_depth)
+  {
+    if (options_.min_depth == 0 || options_.max_depth < options_.min_depth) {
+      throw std::invalid_argument(
+              "the minimum depth must be positive and not greater than the maximum depth");
+    }
+    TRACEPOINT(rclcpp_construct_ring_buffer, static_cast<const void *>(this), capacity_);
+  }
+
+  virtual ~AdaptiveRingBufferImplementation() {}
+
+  /// Add a new element, growing the buffer or dropping the oldest one if it is full
+  void enqueue(BufferT request)
+  {
+    std::optional<BufferResize> resize;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      const size_t request_size = get_element_size_(request);
+      if (elements_.size() == capacity_ && capacity_ < options_.max_depth &&
+        fits_memory_budget_(request_size))
+      {
+        resize = resize_(std::min(options_.max_depth, capacity_ * 2));
+      }
+      if (elements_.size() == capacity_) {
+        drop_oldest_();
+      }
+      while (!elements_.empty() && !fits_memory_budget_(request_size)) {
+        drop_oldest_();
+      }
+      elements_.push_back({std::move(request), request_size});
+      memory_usage_ += request_size;
+      high_water_mark_ = std::max(high_water_mark_, elements_.size());
+      enqueued_count_++;
+
+      window_peak_ = std::max(window_peak_, elements_.size());
+      if (++window_enqueues_ >= options_.shrink_window && !resize) {
+        if (capacity_ > options_.min_depth && window_peak_ <= capacity_ / 2) {
+          resize = resize_(std::max(options_.min_depth, capacity_ / 2));
+        } else {
+          restart_window_();
+        }
+      }
+    }
+    if (resize && options_.on_resize) {
+      options_.on_resize(*resize);
+    }
+  }
+
+  /// Remove the oldest element, or return a default constructed one if there is none
+  BufferT dequeue()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (elements_.empty()) {
+      return BufferT();
+    }
+    BufferT request = std::move(elements_.front().element);
+    memory_usage_ -= elements_.front().size;
+    elements_.pop_front();
+    dequeued_count_++;
+    return request;
+  }
+
+  bool has_data() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return !elements_.empty();
+  }
+
+  void clear()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    elements_.clear();
+    memory_usage_ = 0;
+  }
+
+  /// Return the current capacity, between the minimum and maximum depth
+  size_t get_capacity() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return capacity_;
+  }
+
+  /// Return the estimated memory of the elements stored, in bytes
+  size_t get_memory_usage() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return memory_usage_;
+  }
+
+  BufferMetrics get_metrics() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    BufferMetrics metrics;
+    metrics.capacity = capacity_;
+    metrics.depth = elements_.size();
+    metrics.high_water_mark = high_water_mark_;
+    metrics.enqueued_count = enqueued_count_;
+    metrics.dequeued_count = dequeued_count_;
+    metrics.dropped_count = dropped_count_;
+    metrics.resize_count = resize_count_;
+    return metrics;
+  }
+
+private:
+  struct Entry
+  {
+    BufferT element;
+    size_t size;
+  };
+
+  size_t get_element_size_(const BufferT & element) const
+  {
+    if (element_size_) {
+      return element_size_(element);
+    }
+    return detail::DefaultElementSize<BufferT>::value;
+  }
+
+  bool fits_memory_budget_(size_t request_size) const
+  {
+    return options_.memory_budget == 0 ||
+           memory_usage_ + request_size <= options_.memory_budget;
+  }
+
+  void drop_oldest_()
+  {
+    memory_usage_ -= elements_.front().size;
+    elements_.pop_front();
+    dropped_count_++;
+    rclcpp::FlightRecorder::record(
+      rclcpp::FlightRecorderEventType::IntraProcessDrop, this,
+      static_cast<int64_t>(dropped_count_));
+  }
+
+  BufferResize resize_(size_t capacity)
+  {
+    BufferResize resize;
+    resize.previous_capacity = capacity_;
+    resize.capacity = capacity;
+    resize.depth = elements_.size();
+    resize.memory_usage = memory_usage_;
+    if (capacity < capacity_) {
+      elements_.shrink_to_fit();
+    }
+    capacity_ = capacity;
+    resize_count_++;
+    restart_window_();
+    return resize;
+  }
+
+  void restart_window_()
+  {
+    window_enqueues_ = 0;
+    window_peak_ = elements_.size();
+  }
+
+  const AdaptiveBufferOptions options_;
+  const ElementSizeFunction element_size_;
+
+  std::deque<Entry> elements_;
+  size_t capacity_;
+  size_t memory_usage_ = 0;
+
+  size_t window_enqueues_ = 0;
+  size_t window_peak_ = 0;
+
+  size_t high_water_mark_ = 0;
+  uint64_t enqueued_count_ = 0;
+  uint64_t dequeued_count_ = 0;
+  uint64_t dropped_count_ = 0;
+  uint64_t resize_count_ = 0;
+
+  mutable std::mutex mutex_;
+};
+
+namespace detail
+{
+
+template<typename MessageT, typename BufferT>
+class AdaptiveBufferImplementationFactory : public BufferImplementationFactory<BufferT>
+{
+public:
+  AdaptiveBufferImplementationFactory(
+    const AdaptiveBufferOptions & options,
+    const std::function<size_t(const MessageT &)> & message_size)
+  : options_(options), message_size_(message_size)
+  {}
+
+  std::unique_ptr<BufferImplementationBase<BufferT>>
+  create_buffer_implementation(const rclcpp::QoS & qos) override
+  {
+    AdaptiveBufferOptions options = options_;
+    if (options.max_depth == 0) {
+      options.max_depth = qos.depth();
+    }
+    typename AdaptiveRingBufferImplementation<BufferT>::ElementSizeFunction element_size;
+    if (message_size_) {
+      element_size = [message_size = message_size_](const BufferT & message) {
+          return message ? message_size(*message) : size_t(0);
+        };
+    }
+    return std::make_unique<AdaptiveRingBufferImplementation<BufferT>>(
+      std::move(options), std::move(element_size));
+  }
+
+private:
+  const AdaptiveBufferOptions options_;
+  const std::function<size_t(const MessageT &)> message_size_;
+};
+
+}  // namespace detail
+
+/// Factory of adaptive intra-process buffers, for the subscriptions to MessageT
+/**
+ * E.g. for large images, whose memory the default estimation doesn't see:
+ *
+ * ```cpp
+ * rclcpp::experimental::buffers::AdaptiveBufferOptions adaptive;
+ * adaptive.min_depth = 2;
+ * adaptive.max_depth = 32;
+ * adaptive.memory_budget = 200 * 1024 * 1024;
+ * options.intra_process_buffer_factory = std::make_shared<
+ *   AdaptiveBufferImplementationFactory<sensor_msgs::msg::Image>>(
+ *   adaptive, [](const sensor_msgs::msg::Image & image) {return image.data.size();});
+ * ```
+ */
+template<typename MessageT, typename Deleter = std::default_delete<MessageT>>
+class AdaptiveBufferImplementationFactory
+  : public detail::AdaptiveBufferImplementationFactory<MessageT, std::shared_ptr<const MessageT>>,
+  public detail::AdaptiveBufferImplementationFactory<MessageT, std::unique_ptr<MessageT, Deleter>>
+{
+public:
+  /// Create a factory of adaptive buffers.
+  /**
+   * \param[in] options the limits of the capacity of the buffers.
+   * \param[in] message_size the estimation of the memory of the messages, in bytes, nullptr
+   *   for sizeof(MessageT).
+   */
+  explicit AdaptiveBufferImplementationFactory(
+    AdaptiveBufferOptions options = AdaptiveBufferOptions(),
+    std::function<size_t(const MessageT &)> message_size = nullptr)
+  : detail::AdaptiveBufferImplementationFactory<MessageT, std::shared_ptr<const MessageT>>(
+      options, message_size),
+    detail::AdaptiveBufferImplementationFactory<MessageT, std::unique_ptr<MessageT, Deleter>>(
+      options, message_size)
+  {}
+};
+
+}  // namespace buffers
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__BUFFERS__ADAPTIVE_RING_BUFFER_IMPLEMENTATION_HPP_
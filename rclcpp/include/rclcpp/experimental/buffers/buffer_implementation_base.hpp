@@ -15,6 +15,8 @@
 #ifndef RCLCPP__EXPERIMENTAL__BUFFERS__BUFFER_IMPLEMENTATION_BASE_HPP_
 #define RCLCPP__EXPERIMENTAL__BUFFERS__BUFFER_IMPLEMENTATION_BASE_HPP_
 
+#include "rclcpp/experimental/buffers/buffer_metrics.hpp"
+
 namespace rclcpp
 {
 namespace experimental
@@ -33,6 +35,9 @@ public:
 
   virtual void clear() = 0;
   virtual bool has_data() const = 0;
+
+  /// Get the occupancy and traffic counters, all zero if the implementation doesn't keep them.
+  virtual BufferMetrics get_metrics() const {return BufferMetrics();}
 };
 
 }  // namespace buffers
@@ -0,0 +1,108 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXPERIMENTAL__BUFFERS__BUFFER_IMPLEMENTATION_FACTORY_HPP_
+#define RCLCPP__EXPERIMENTAL__BUFFERS__BUFFER_IMPLEMENTATION_FACTORY_HPP_
+
+#include <memory>
+
+#include "rclcpp/experimental/buffers/buffer_implementation_base.hpp"
+#include "rclcpp/qos.hpp"
+
+namespace rclcpp
+{
+namespace experimental
+{
+namespace buffers
+{
+
+/// Non-template base of the factories of intra-process buffer implementations.
+/**
+ * The factories are given through rclcpp::SubscriptionOptionsBase::intra_process_buffer_factory,
+ * which doesn't know the message type, so a factory derives from BufferImplementationFactory
+ * for each type of element it creates buffers for.
+ */
+class BufferImplementationFactoryBase
+{
+public:
+  virtual ~BufferImplementationFactoryBase() = default;
+};
+
+/// Factory of the intra-process buffer implementations storing elements of type BufferT.
+/**
+ * The elements of the buffer of a subscription are std::shared_ptr<const MessageT> or
+ * std::unique_ptr<MessageT, Deleter>, depending on rclcpp::IntraProcessBufferType, with
+ * MessageT the subscribed type and Deleter std::default_delete<MessageT> for the default
+ * allocator.
+ */
+template<typename BufferT>
+class BufferImplementationFactory : public virtual BufferImplementationFactoryBase
+{
+public:
+  /// Create the buffer implementation of a subscription.
+  /**
+   * It is called once per subscription, with the thread creating the subscription.
+   * The implementation is used like the builtin ones, enqueue() may be called by any publishing
+   * thread while the executor calls dequeue().
+   *
+   * \param[in] qos the QoS of the subscription, whose depth the builtin implementations use as
+   *   their capacity.
+   * \return the buffer implementation, must not be nullptr.
+   */
+  virtual std::unique_ptr<BufferImplementationBase<BufferT>>
+  create_buffer_implementation(const rclcpp::QoS & qos) = 0;
+};
+
+namespace detail
+{
+
+template<template<typename> class ImplementationT, typename BufferT>
+class DepthBufferImplementationFactory : public BufferImplementationFactory<BufferT>
+{
+public:
+  std::unique_ptr<BufferImplementationBase<BufferT>>
+  create_buffer_implementation(const rclcpp::QoS & qos) override
+  {
+    return std::make_unique<ImplementationT<BufferT>>(qos.depth());
+  }
+};
+
+}  // namespace detail
+
+/// Factory of ImplementationT constructed with the depth of the QoS, for both buffer types.
+/**
+ * E.g. for a buffer implementation template taking its capacity:
+ *
+ * ```cpp
+ * options.intra_process_buffer_factory = std::make_shared<
+ *   DepthBufferImplementationFactory<MyRingBuffer, MessageT>>();
+ * ```
+ */
+template<
+  template<typename> class ImplementationT,
+  typename MessageT,
+  typename Deleter = std::default_delete<MessageT>>
+class DepthBufferImplementationFactory
+  : public detail::DepthBufferImplementationFactory<
+    ImplementationT, std::shared_ptr<const MessageT>>,
+  public detail::DepthBufferImplementationFactory<
+    ImplementationT, std::unique_ptr<MessageT, Deleter>>
+{
+};
+
+}  // namespace buffers
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__BUFFERS__BUFFER_IMPLEMENTATION_FACTORY_HPP_
@@ -0,0 +1,55 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXPERIMENTAL__BUFFERS__BUFFER_METRICS_HPP_
+#define RCLCPP__EXPERIMENTAL__BUFFERS__BUFFER_METRICS_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace rclcpp
+{
+namespace experimental
+{
+namespace buffers
+{
+
+/// Occupancy and traffic of an intra-process buffer.
+/**
+ * The counts are accumulated since the buffer was created.
+ * A buffer which doesn't keep metrics reports all of them as zero.
+ */
+struct BufferMetrics
+{
+  /// Maximum number of elements the buffer stores.
+  size_t capacity = 0;
+  /// Number of elements currently stored.
+  size_t depth = 0;
+  /// Largest number of elements stored at once.
+  size_t high_water_mark = 0;
+  /// Number of elements enqueued, including the ones later dropped.
+  uint64_t enqueued_count = 0;
+  /// Number of elements dequeued.
+  uint64_t dequeued_count = 0;
+  /// Number of elements overwritten by an enqueue into a full buffer, without being dequeued.
+  uint64_t dropped_count = 0;
+  /// Number of changes of the capacity, by the buffers which adapt it.
+  uint64_t resize_count = 0;
+};
+
+}  // namespace buffers
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__BUFFERS__BUFFER_METRICS_HPP_
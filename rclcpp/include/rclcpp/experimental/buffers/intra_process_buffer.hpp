@@ -23,8 +23,12 @@
 #include "rclcpp/allocator/allocator_common.hpp"
 #include "rclcpp/allocator/allocator_deleter.hpp"
 #include "rclcpp/experimental/buffers/buffer_implementation_base.hpp"
+#include "rclcpp/experimental/buffers/buffer_metrics.hpp"
+#include "rclcpp/flight_recorder.hpp"
 #include "rclcpp/macros.hpp"
 
+#include "tracetools/tracetools.h"
+
 namespace rclcpp
 {
 namespace experimental
@@ -43,6 +47,8 @@ public:
 
   virtual bool has_data() const = 0;
   virtual bool use_take_shared_method() const = 0;
+
+  virtual BufferMetrics get_metrics() const = 0;
 };
 
 template<
@@ -94,6 +100,11 @@ public:
 
     buffer_ = std::move(buffer_impl);
 
+    TRACEPOINT(
+      rclcpp_buffer_to_ipb,
+      static_cast<const void *>(buffer_.get()),
+      static_cast<const void *>(this));
+
     if (!allocator) {
       message_allocator_ = std::make_shared<MessageAlloc>();
     } else {
@@ -105,11 +116,15 @@ public:
 
   void add_shared(MessageSharedPtr msg) override
   {
+    rclcpp::FlightRecorder::record(
+      rclcpp::FlightRecorderEventType::IntraProcessEnqueue, buffer_.get());
     add_shared_impl<BufferT>(std::move(msg));
   }
 
   void add_unique(MessageUniquePtr msg) override
   {
+    rclcpp::FlightRecorder::record(
+      rclcpp::FlightRecorderEventType::IntraProcessEnqueue, buffer_.get());
     buffer_->enqueue(std::move(msg));
   }
 
@@ -138,6 +153,11 @@ public:
     return std::is_same<BufferT, MessageSharedPtr>::value;
   }
 
+  BufferMetrics get_metrics() const override
+  {
+    return buffer_->get_metrics();
+  }
+
 private:
   std::unique_ptr<BufferImplementationBase<BufferT>> buffer_;
 
@@ -0,0 +1,184 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXPERIMENTAL__BUFFERS__LATEST_VALUE_BUFFER_IMPLEMENTATION_HPP_
+#define RCLCPP__EXPERIMENTAL__BUFFERS__LATEST_VALUE_BUFFER_IMPLEMENTATION_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "rclcpp/experimental/buffers/buffer_implementation_base.hpp"
+#include "rclcpp/flight_recorder.hpp"
+#include "rclcpp/macros.hpp"
+
+#include "tracetools/tracetools.h"
+
+namespace rclcpp
+{
+namespace experimental
+{
+namespace buffers
+{
+
+/// Store only the newest element, in a slot swapped atomically
+/**
+ * Enqueuing replaces the element not dequeued yet, which is counted as dropped, so consumers
+ * only ever see the latest value instead of a backlog of stale ones.
+ *
+ * The element is stored in a node the producer fills before swapping it into the slot, the
+ * node swapped out is kept as a spare for the next enqueue, so no allocation is done in the
+ * steady state.
+ * Each node is only accessed by the thread that swapped it out of the slot or of the spare, so
+ * all the public member functions are lock-free and thread-safe, for any number of producers
+ * and consumers.
+ */
+template<typename BufferT>
+class LatestValueBufferImplementation : public BufferImplementationBase<BufferT>
+{
+public:
+  LatestValueBufferImplementation()
+  {
+    TRACEPOINT(rclcpp_construct_ring_buffer, static_cast<const void *>(this), size_t(1));
+  }
+
+  virtual ~LatestValueBufferImplementation()
+  {
+    delete slot_.exchange(nullptr);
+    delete spare_.exchange(nullptr);
+  }
+
+  /// Replace the stored element
+  /**
+   * This member function is lock-free and thread-safe.
+   *
+   * \param request the element to be stored
+   */
+  void enqueue(BufferT request)
+  {
+    Node * node = spare_.exchange(nullptr, std::memory_order_acquire);
+    if (!node) {
+      node = new Node();
+    }
+    node->data = std::move(request);
+    enqueued_count_.fetch_add(1, std::memory_order_relaxed);
+    high_water_mark_.store(1, std::memory_order_relaxed);
+
+    Node * replaced = slot_.exchange(node, std::memory_order_acq_rel);
+    if (replaced) {
+      replaced->data = BufferT();
+      const uint64_t dropped_count = dropped_count_.fetch_add(1, std::memory_order_relaxed) + 1;
+      rclcpp::FlightRecorder::record(
+        rclcpp::FlightRecorderEventType::IntraProcessDrop, this,
+        static_cast<int64_t>(dropped_count));
+      recycle(replaced);
+    }
+    TRACEPOINT(
+      rclcpp_ring_buffer_enqueue,
+      static_cast<const void *>(this),
+      size_t(0),
+      size_t(1),
+      replaced != nullptr);
+  }
+
+  /// Remove the stored element
+  /**
+   * This member function is lock-free and thread-safe.
+   *
+   * \return the element that is being removed, or a default constructed one if there is none
+   */
+  BufferT dequeue()
+  {
+    Node * node = slot_.exchange(nullptr, std::memory_order_acq_rel);
+    if (!node) {
+      return BufferT();
+    }
+    BufferT request = std::move(node->data);
+    node->data = BufferT();
+    recycle(node);
+    dequeued_count_.fetch_add(1, std::memory_order_relaxed);
+    TRACEPOINT(rclcpp_ring_buffer_dequeue, static_cast<const void *>(this), size_t(0), size_t(0));
+    return request;
+  }
+
+  /// Get if an element is stored
+  /**
+   * This member function is lock-free and thread-safe.
+   *
+   * \return `true` if there is data and `false` otherwise
+   */
+  inline bool has_data() const
+  {
+    return slot_.load(std::memory_order_acquire) != nullptr;
+  }
+
+  /// Remove the stored element, if any.
+  void clear()
+  {
+    Node * node = slot_.exchange(nullptr, std::memory_order_acq_rel);
+    if (node) {
+      node->data = BufferT();
+      recycle(node);
+    }
+    TRACEPOINT(rclcpp_ring_buffer_clear, static_cast<const void *>(this));
+  }
+
+  /// Get the occupancy and traffic counters of the buffer
+  /**
+   * This member function is lock-free and thread-safe.
+   * The dropped count is the number of elements replaced before being dequeued.
+   *
+   * \return the metrics accumulated since the buffer was created
+   */
+  BufferMetrics get_metrics() const
+  {
+    BufferMetrics metrics;
+    metrics.capacity = 1;
+    metrics.depth = has_data() ? 1 : 0;
+    metrics.high_water_mark = high_water_mark_.load(std::memory_order_relaxed);
+    metrics.enqueued_count = enqueued_count_.load(std::memory_order_relaxed);
+    metrics.dequeued_count = dequeued_count_.load(std::memory_order_relaxed);
+    metrics.dropped_count = dropped_count_.load(std::memory_order_relaxed);
+    return metrics;
+  }
+
+private:
+  RCLCPP_DISABLE_COPY(LatestValueBufferImplementation)
+
+  struct Node
+  {
+    BufferT data{};
+  };
+
+  /// Keep an emptied node as the spare, deleting the previous spare if another thread left one.
+  void recycle(Node * node)
+  {
+    delete spare_.exchange(node, std::memory_order_acq_rel);
+  }
+
+  std::atomic<Node *> slot_{nullptr};
+  std::atomic<Node *> spare_{nullptr};
+
+  std::atomic<uint64_t> enqueued_count_{0};
+  std::atomic<uint64_t> dequeued_count_{0};
+  std::atomic<uint64_t> dropped_count_{0};
+  std::atomic<size_t> high_water_mark_{0};
+};
+
+}  // namespace buffers
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__BUFFERS__LATEST_VALUE_BUFFER_IMPLEMENTATION_HPP_
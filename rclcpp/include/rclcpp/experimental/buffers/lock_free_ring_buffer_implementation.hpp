@@ -0,0 +1,367 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXPERIMENTAL__BUFFERS__LOCK_FREE_RING_BUFFER_IMPLEMENTATION_HPP_
+#define RCLCPP__EXPERIMENTAL__BUFFERS__LOCK_FREE_RING_BUFFER_IMPLEMENTATION_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include "rclcpp/experimental/buffers/buffer_implementation_base.hpp"
+#include "rclcpp/flight_recorder.hpp"
+#include "rclcpp/macros.hpp"
+
+#include "tracetools/tracetools.h"
+
+namespace rclcpp
+{
+namespace experimental
+{
+namespace buffers
+{
+
+/// Size of the cache lines the indices of the lock-free buffers are padded to.
+constexpr size_t kCacheLineSize = 64;
+
+/// Store elements in a fixed-size, FIFO buffer, without locks
+/**
+ * Like the RingBufferImplementation, the oldest element is dropped when enqueuing into a full
+ * buffer, which keeps the last elements as the intra-process communication requires.
+ *
+ * Each cell has a sequence number telling if it can be written or read at a given position.
+ * The producers and the consumers only contend on their own index, padded to a cache line, and
+ * on the cells they write or read.
+ * A producer enqueuing into a full buffer drops the oldest element the way a consumer would.
+ *
+ * It's safe to dequeue from any number of threads.
+ * With multiple_producers set to false, only one thread at a time may enqueue, which saves a
+ * compare and swap per element.
+ *
+ * An element being enqueued isn't visible until it's fully stored, so has_data() can return
+ * false right after another thread started enqueuing.
+ */
+template<typename BufferT, bool multiple_producers>
+class LockFreeRingBufferImplementation : public BufferImplementationBase<BufferT>
+{
+public:
+  explicit LockFreeRingBufferImplementation(size_t capacity)
+  : capacity_(capacity),
+    // A single cell would be free for the next lap at the very sequence number telling it's
+    // readable, so at least two are used
+    cell_count_(std::max<size_t>(capacity, 2))
+  {
+    if (capacity == 0) {
+      throw std::invalid_argument("capacity must be a positive, non-zero value");
+    }
+    cells_ = std::make_unique<Cell[]>(cell_count_);
+    for (size_t i = 0; i < cell_count_; ++i) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    TRACEPOINT(rclcpp_construct_ring_buffer, static_cast<const void *>(this), capacity_);
+  }
+
+  virtual ~LockFreeRingBufferImplementation() {}
+
+  /// Add a new element to store in the ring buffer
+  /**
+   * This member function is lock-free, and thread-safe if multiple_producers is true.
+   *
+   * \param request the element to be stored in the ring buffer
+   */
+  void enqueue(BufferT request)
+  {
+    size_t position = enqueue_position_.value.load(std::memory_order_relaxed);
+    Cell * cell = nullptr;
+    bool overwritten = false;
+    while (true) {
+      cell = &cells_[position % cell_count_];
+      const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      const auto difference =
+        static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+      if (difference == 0 && cell_count_ > capacity_ && is_full_at(position)) {
+        // The cell is free but the buffer is full, with the spare cell of a capacity of one
+        BufferT dropped{};
+        if (try_dequeue(dropped)) {
+          increment(producer_counters_.dropped_count);
+          overwritten = true;
+          record_drop();
+        }
+        position = enqueue_position_.value.load(std::memory_order_relaxed);
+      } else if (difference == 0) {
+        // The cell is free at this position, claim it
+        if (!multiple_producers) {
+          enqueue_position_.value.store(position + 1, std::memory_order_relaxed);
+          break;
+        }
+        if (
+          enqueue_position_.value.compare_exchange_weak(
+            position, position + 1, std::memory_order_relaxed))
+        {
+          break;
+        }
+      } else if (difference < 0) {
+        // The cell still holds the element enqueued one lap earlier
+        if (is_full_at(position)) {
+          BufferT dropped{};
+          if (try_dequeue(dropped)) {
+            increment(producer_counters_.dropped_count);
+            overwritten = true;
+            record_drop();
+          }
+        } else {
+          // That element is being dequeued
+          std::this_thread::yield();
+        }
+        position = enqueue_position_.value.load(std::memory_order_relaxed);
+      } else {
+        // Another producer claimed this position
+        position = enqueue_position_.value.load(std::memory_order_relaxed);
+      }
+    }
+    cell->data = std::move(request);
+    cell->sequence.store(position + 1, std::memory_order_release);
+
+    increment(producer_counters_.enqueued_count);
+    const size_t depth = static_cast<size_t>(std::max<std::ptrdiff_t>(depth_at(position + 1), 0));
+    size_t high_water_mark = producer_counters_.high_water_mark.load(std::memory_order_relaxed);
+    while (
+      depth > high_water_mark &&
+      !producer_counters_.high_water_mark.compare_exchange_weak(
+        high_water_mark, depth, std::memory_order_relaxed))
+    {
+    }
+    TRACEPOINT(
+      rclcpp_ring_buffer_enqueue,
+      static_cast<const void *>(this),
+      position % cell_count_,
+      std::min(depth, capacity_),
+      overwritten);
+    // Only read by the tracepoint
+    (void)overwritten;
+  }
+
+  /// Remove the oldest element from ring buffer
+  /**
+   * This member function is lock-free and thread-safe.
+   *
+   * \return the element that is being removed from the ring buffer, or a default constructed
+   *   one if it's empty
+   */
+  BufferT dequeue()
+  {
+    BufferT request{};
+    size_t position = 0;
+    if (try_dequeue(request, &position)) {
+      dequeued_count_.value.fetch_add(1, std::memory_order_relaxed);
+      TRACEPOINT(
+        rclcpp_ring_buffer_dequeue,
+        static_cast<const void *>(this),
+        position % cell_count_,
+        std::min(
+          enqueue_position_.value.load(std::memory_order_relaxed) - position - 1, capacity_));
+    }
+    return request;
+  }
+
+  /// Get if the ring buffer has at least one element stored
+  /**
+   * This member function is lock-free and thread-safe.
+   *
+   * \return `true` if there is data and `false` otherwise
+   */
+  inline bool has_data() const
+  {
+    const size_t position = dequeue_position_.value.load(std::memory_order_relaxed);
+    const Cell & cell = cells_[position % cell_count_];
+    return cell.sequence.load(std::memory_order_acquire) == position + 1;
+  }
+
+  /// Get if the size of the buffer is equal to its capacity
+  /**
+   * This member function is lock-free and thread-safe.
+   *
+   * \return `true` if the size of the buffer is equal is capacity
+   * and `false` otherwise
+   */
+  inline bool is_full() const
+  {
+    const size_t dequeue_position = dequeue_position_.value.load(std::memory_order_acquire);
+    const size_t enqueue_position = enqueue_position_.value.load(std::memory_order_acquire);
+    return enqueue_position - dequeue_position >= capacity_;
+  }
+
+  /// Get the occupancy and traffic counters of the ring buffer
+  /**
+   * This member function is lock-free and thread-safe.
+   * The counters are read one at a time, while other threads enqueue or dequeue they may not
+   * add up exactly.
+   *
+   * \return the metrics accumulated since the buffer was created
+   */
+  BufferMetrics get_metrics() const
+  {
+    const size_t dequeue_position = dequeue_position_.value.load(std::memory_order_acquire);
+    const size_t enqueue_position = enqueue_position_.value.load(std::memory_order_acquire);
+    BufferMetrics metrics;
+    metrics.capacity = capacity_;
+    metrics.depth = std::min(enqueue_position - dequeue_position, capacity_);
+    metrics.high_water_mark = producer_counters_.high_water_mark.load(std::memory_order_relaxed);
+    metrics.enqueued_count = producer_counters_.enqueued_count.load(std::memory_order_relaxed);
+    metrics.dequeued_count = dequeued_count_.value.load(std::memory_order_relaxed);
+    metrics.dropped_count = producer_counters_.dropped_count.load(std::memory_order_relaxed);
+    return metrics;
+  }
+
+  /// Remove all the stored elements.
+  void clear()
+  {
+    BufferT request{};
+    while (try_dequeue(request)) {
+      request = BufferT();
+    }
+    TRACEPOINT(rclcpp_ring_buffer_clear, static_cast<const void *>(this));
+  }
+
+private:
+  RCLCPP_DISABLE_COPY(LockFreeRingBufferImplementation)
+
+  struct Cell
+  {
+    std::atomic<size_t> sequence{0};
+    BufferT data{};
+  };
+
+  struct alignas(kCacheLineSize) PaddedIndex
+  {
+    std::atomic<size_t> value{0};
+  };
+
+  struct alignas(kCacheLineSize) PaddedCounter
+  {
+    std::atomic<uint64_t> value{0};
+  };
+
+  /// Counters only written by the producers, kept apart from the consumers' ones.
+  struct alignas(kCacheLineSize) ProducerCounters
+  {
+    std::atomic<uint64_t> enqueued_count{0};
+    std::atomic<uint64_t> dropped_count{0};
+    std::atomic<size_t> high_water_mark{0};
+  };
+
+  /// Increment a producer counter, without a read-modify-write for a single producer.
+  static void increment(std::atomic<uint64_t> & counter)
+  {
+    if (multiple_producers) {
+      counter.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+  }
+
+  /// Return the number of elements before the position, as seen from the dequeue position.
+  /**
+   * The dequeue position is read again, and may have moved past a position read earlier by a
+   * producer, once the other producers and the consumers advanced, which is a negative depth
+   * rather than an unsigned wrap around.
+   */
+  std::ptrdiff_t depth_at(size_t position) const
+  {
+    const size_t dequeue_position = dequeue_position_.value.load(std::memory_order_acquire);
+    return static_cast<std::ptrdiff_t>(position) - static_cast<std::ptrdiff_t>(dequeue_position);
+  }
+
+  /// Return true if a producer enqueuing at the position has to drop the oldest element.
+  bool is_full_at(size_t position) const
+  {
+    return depth_at(position) >= static_cast<std::ptrdiff_t>(capacity_);
+  }
+
+  /// Record the drop of an element in the FlightRecorder.
+  void record_drop() const
+  {
+    rclcpp::FlightRecorder::record(
+      rclcpp::FlightRecorderEventType::IntraProcessDrop, this,
+      static_cast<int64_t>(producer_counters_.dropped_count.load(std::memory_order_relaxed)));
+  }
+
+  /// Move the oldest element out, return false if there is none.
+  /**
+   * \param[out] request the element removed
+   * \param[out] dequeued_position if not null, the position the element was removed from
+   */
+  bool try_dequeue(BufferT & request, size_t * dequeued_position = nullptr)
+  {
+    size_t position = dequeue_position_.value.load(std::memory_order_relaxed);
+    Cell * cell = nullptr;
+    while (true) {
+      cell = &cells_[position % cell_count_];
+      const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      const auto difference =
+        static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+      if (difference == 0) {
+        if (
+          dequeue_position_.value.compare_exchange_weak(
+            position, position + 1, std::memory_order_relaxed))
+        {
+          break;
+        }
+      } else if (difference < 0) {
+        // Empty, or the element at this position isn't fully enqueued yet
+        return false;
+      } else {
+        // Another consumer took this position
+        position = dequeue_position_.value.load(std::memory_order_relaxed);
+      }
+    }
+    request = std::move(cell->data);
+    cell->data = BufferT();
+    // Free the cell for the producer of the next lap
+    cell->sequence.store(position + cell_count_, std::memory_order_release);
+    if (dequeued_position) {
+      *dequeued_position = position;
+    }
+    return true;
+  }
+
+  const size_t capacity_;
+  const size_t cell_count_;
+  std::unique_ptr<Cell[]> cells_;
+
+  PaddedIndex enqueue_position_;
+  PaddedIndex dequeue_position_;
+
+  ProducerCounters producer_counters_;
+  PaddedCounter dequeued_count_;
+};
+
+/// Lock-free ring buffer for a single publishing thread, see LockFreeRingBufferImplementation.
+template<typename BufferT>
+using SingleProducerRingBufferImplementation = LockFreeRingBufferImplementation<BufferT, false>;
+
+/// Lock-free ring buffer for any number of publishing threads.
+template<typename BufferT>
+using MultiProducerRingBufferImplementation = LockFreeRingBufferImplementation<BufferT, true>;
+
+}  // namespace buffers
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__BUFFERS__LOCK_FREE_RING_BUFFER_IMPLEMENTATION_HPP_
@@ -15,17 +15,22 @@
 #ifndef RCLCPP__EXPERIMENTAL__BUFFERS__RING_BUFFER_IMPLEMENTATION_HPP_
 #define RCLCPP__EXPERIMENTAL__BUFFERS__RING_BUFFER_IMPLEMENTATION_HPP_
 
+#include <algorithm>
+#include <cstdint>
 #include <mutex>
 #include <stdexcept>
 #include <utility>
 #include <vector>
 
 #include "rclcpp/experimental/buffers/buffer_implementation_base.hpp"
+#include "rclcpp/flight_recorder.hpp"
 #include "rclcpp/logger.hpp"
 #include "rclcpp/logging.hpp"
 #include "rclcpp/macros.hpp"
 #include "rclcpp/visibility_control.hpp"
 
+#include "tracetools/tracetools.h"
+
 namespace rclcpp
 {
 namespace experimental
@@ -51,6 +56,7 @@ public:
     if (capacity == 0) {
       throw std::invalid_argument("capacity must be a positive, non-zero value");
     }
+    TRACEPOINT(rclcpp_construct_ring_buffer, static_cast<const void *>(this), capacity_);
   }
 
   virtual ~RingBufferImplementation() {}
@@ -68,11 +74,24 @@ public:
     write_index_ = next_(write_index_);
     ring_buffer_[write_index_] = std::move(request);
 
-    if (is_full_()) {
+    const bool overwritten = is_full_();
+    if (overwritten) {
       read_index_ = next_(read_index_);
+      dropped_count_++;
+      rclcpp::FlightRecorder::record(
+        rclcpp::FlightRecorderEventType::IntraProcessDrop, this,
+        static_cast<int64_t>(dropped_count_));
     } else {
       size_++;
+      high_water_mark_ = std::max(high_water_mark_, size_);
     }
+    enqueued_count_++;
+    TRACEPOINT(
+      rclcpp_ring_buffer_enqueue,
+      static_cast<const void *>(this),
+      write_index_,
+      size_,
+      overwritten);
   }
 
   /// Remove the oldest element from ring buffer
@@ -90,9 +109,15 @@ public:
     }
 
     auto request = std::move(ring_buffer_[read_index_]);
+    TRACEPOINT(
+      rclcpp_ring_buffer_dequeue,
+      static_cast<const void *>(this),
+      read_index_,
+      size_ - 1);
     read_index_ = next_(read_index_);
 
     size_--;
+    dequeued_count_++;
 
     return request;
   }
@@ -135,7 +160,29 @@ public:
     return is_full_();
   }
 
-  void clear() {}
+  void clear()
+  {
+    TRACEPOINT(rclcpp_ring_buffer_clear, static_cast<const void *>(this));
+  }
+
+  /// Get the occupancy and traffic counters of the ring buffer
+  /**
+   * This member function is thread-safe.
+   *
+   * \return the metrics accumulated since the buffer was created
+   */
+  BufferMetrics get_metrics() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    BufferMetrics metrics;
+    metrics.capacity = capacity_;
+    metrics.depth = size_;
+    metrics.high_water_mark = high_water_mark_;
+    metrics.enqueued_count = enqueued_count_;
+    metrics.dequeued_count = dequeued_count_;
+    metrics.dropped_count = dropped_count_;
+    return metrics;
+  }
 
 private:
   /// Get the next index value for the ring buffer
@@ -181,6 +228,11 @@ private:
   size_t read_index_;
   size_t size_;
 
+  size_t high_water_mark_ = 0;
+  uint64_t enqueued_count_ = 0;
+  uint64_t dequeued_count_ = 0;
+  uint64_t dropped_count_ = 0;
+
   mutable std::mutex mutex_;
 };
 
@@ -0,0 +1,145 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXPERIMENTAL__CLIENT_INTRA_PROCESS_HPP_
+#define RCLCPP__EXPERIMENTAL__CLIENT_INTRA_PROCESS_HPP_
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "rcl/wait.h"
+
+#include "rclcpp/context.hpp"
+#include "rclcpp/experimental/intra_process_service_waitable.hpp"
+#include "rclcpp/macros.hpp"
+
+namespace rclcpp
+{
+namespace experimental
+{
+
+/// Intra-process part of a client, receiving the responses of a service in the same context.
+/**
+ * The responses are given by pointer by the ServiceIntraProcess of the service, then handed
+ * to the client when the executor executes this waitable.
+ */
+template<typename ServiceT>
+class ClientIntraProcess : public IntraProcessServiceWaitable
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(ClientIntraProcess)
+
+  using SharedResponse = typename ServiceT::Response::SharedPtr;
+
+  /// Function called with the sequence number of a request and its response.
+  using ResponseCallback = std::function<void (int64_t, SharedResponse)>;
+
+  /// Create the intra-process part of a client.
+  /**
+   * \param[in] callback function handing a response to the client.
+   * \param[in] context the context of the client.
+   * \param[in] service_name the fully qualified name of the service.
+   * \param[in] client_id the id identifying the client in the request headers, see
+   *   IntraProcessServiceManager::reserve_client_id().
+   * \throws std::invalid_argument if the callback is empty.
+   */
+  ClientIntraProcess(
+    ResponseCallback callback,
+    rclcpp::Context::SharedPtr context,
+    const std::string & service_name,
+    uint64_t client_id)
+  : IntraProcessServiceWaitable(context, service_name, EntityType::Client),
+    callback_(std::move(callback)),
+    client_id_(client_id)
+  {
+    if (!callback_) {
+      throw std::invalid_argument("intra-process client response callback cannot be empty");
+    }
+  }
+
+  virtual ~ClientIntraProcess() = default;
+
+  /// Return the id identifying this client in the request headers.
+  uint64_t
+  get_client_id() const
+  {
+    return client_id_;
+  }
+
+  bool
+  is_ready(rcl_wait_set_t * wait_set) override
+  {
+    (void) wait_set;
+    std::lock_guard<std::mutex> lock(responses_mutex_);
+    return !responses_.empty();
+  }
+
+  std::shared_ptr<void>
+  take_data() override
+  {
+    std::lock_guard<std::mutex> lock(responses_mutex_);
+    if (responses_.empty()) {
+      return nullptr;
+    }
+    auto response = std::make_shared<QueuedResponse>(std::move(responses_.front()));
+    responses_.pop_front();
+    return response;
+  }
+
+  void
+  execute(std::shared_ptr<void> & data) override
+  {
+    if (!data) {
+      return;
+    }
+    auto response = std::static_pointer_cast<QueuedResponse>(data);
+    callback_(response->first, std::move(response->second));
+  }
+
+  /// Queue the response to a request, can be called from any thread.
+  /**
+   * \param[in] sequence_number the sequence number of the request.
+   * \param[in] response the response, given as is to the client.
+   */
+  void
+  provide_response(int64_t sequence_number, SharedResponse response)
+  {
+    {
+      std::lock_guard<std::mutex> lock(responses_mutex_);
+      responses_.emplace_back(sequence_number, std::move(response));
+    }
+    notify_ready();
+  }
+
+private:
+  RCLCPP_DISABLE_COPY(ClientIntraProcess)
+
+  using QueuedResponse = std::pair<int64_t, SharedResponse>;
+
+  ResponseCallback callback_;
+  const uint64_t client_id_;
+
+  std::mutex responses_mutex_;
+  std::deque<QueuedResponse> responses_;
+};
+
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__CLIENT_INTRA_PROCESS_HPP_
@@ -0,0 +1,281 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXPERIMENTAL__COROUTINES_HPP_
+#define RCLCPP__EXPERIMENTAL__COROUTINES_HPP_
+
+#if !defined(__cpp_impl_coroutine) || !__has_include(<coroutine>)
+#error "rclcpp/experimental/coroutines.hpp requires a compiler with C++20 coroutine support"
+#endif
+
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "rclcpp/callback_group.hpp"
+#include "rclcpp/client.hpp"
+#include "rclcpp/create_timer.hpp"
+#include "rclcpp/node_interfaces/get_node_base_interface.hpp"
+#include "rclcpp/node_interfaces/get_node_timers_interface.hpp"
+#include "rclcpp/node_interfaces/node_base_interface.hpp"
+#include "rclcpp/node_interfaces/node_timers_interface.hpp"
+#include "rclcpp/timer.hpp"
+
+namespace rclcpp
+{
+namespace experimental
+{
+
+/// Fire-and-forget coroutine type, for callbacks written as coroutines.
+/**
+ * A function returning a Task starts running as soon as it is called, and returns to the
+ * caller at its first suspension point, e.g.:
+ *
+ * ```cpp
+ * rclcpp::experimental::Task
+ * do_work(rclcpp::Node::SharedPtr node, rclcpp::Client<SrvT>::SharedPtr client)
+ * {
+ *   co_await rclcpp::experimental::async_sleep_for(node, 1s);
+ *   auto response = co_await rclcpp::experimental::async_send_request(client, request);
+ * }
+ * ```
+ *
+ * The coroutine is then resumed from the callbacks of its executor, so no thread is blocked
+ * while it waits.
+ * The coroutine frame is destroyed once the coroutine returns.
+ * An exception escaping from the coroutine terminates the program, as for std::thread.
+ */
+class Task
+{
+public:
+  struct promise_type
+  {
+    Task
+    get_return_object() noexcept
+    {
+      return Task{};
+    }
+
+    std::suspend_never
+    initial_suspend() noexcept
+    {
+      return {};
+    }
+
+    std::suspend_never
+    final_suspend() noexcept
+    {
+      return {};
+    }
+
+    void
+    return_void() noexcept
+    {
+    }
+
+    void
+    unhandled_exception() noexcept
+    {
+      std::terminate();
+    }
+  };
+};
+
+namespace detail
+{
+
+/// Resume a coroutine from a one-shot timer callback, executed by the executor of the node.
+/**
+ * The timer is kept alive by its own callback, and is released after it triggered once.
+ *
+ * \param[in] handle handle of the suspended coroutine.
+ * \param[in] delay time to wait before resuming the coroutine.
+ * \param[in] node_base node base interface used to create the timer.
+ * \param[in] node_timers node timers interface used to create the timer.
+ * \param[in] group callback group of the timer, or nullptr for the default one.
+ */
+inline void
+resume_from_timer(
+  std::coroutine_handle<> handle,
+  std::chrono::nanoseconds delay,
+  node_interfaces::NodeBaseInterface * node_base,
+  node_interfaces::NodeTimersInterface * node_timers,
+  rclcpp::CallbackGroup::SharedPtr group)
+{
+  struct OneShotTimer
+  {
+    std::mutex mutex;
+    rclcpp::TimerBase::SharedPtr timer;
+  };
+  auto one_shot = std::make_shared<OneShotTimer>();
+
+  // The timer may trigger in another thread before it is stored: the lock is held until then.
+  std::lock_guard<std::mutex> lock(one_shot->mutex);
+  one_shot->timer = rclcpp::create_wall_timer(
+    delay,
+    [one_shot, handle]() {
+      rclcpp::TimerBase::SharedPtr timer;
+      {
+        std::lock_guard<std::mutex> lock(one_shot->mutex);
+        timer = std::move(one_shot->timer);
+      }
+      // The timer may have been executed again before being canceled
+      if (!timer) {
+        return;
+      }
+      timer->cancel();
+      handle.resume();
+    },
+    group, node_base, node_timers);
+}
+
+}  // namespace detail
+
+/// Awaitable suspending a coroutine for the given duration, see async_sleep_for().
+class SleepAwaitable
+{
+public:
+  SleepAwaitable(
+    std::chrono::nanoseconds delay,
+    node_interfaces::NodeBaseInterface::SharedPtr node_base,
+    node_interfaces::NodeTimersInterface::SharedPtr node_timers,
+    rclcpp::CallbackGroup::SharedPtr group)
+  : delay_(delay),
+    node_base_(std::move(node_base)),
+    node_timers_(std::move(node_timers)),
+    group_(std::move(group))
+  {}
+
+  bool
+  await_ready() const noexcept
+  {
+    return false;
+  }
+
+  void
+  await_suspend(std::coroutine_handle<> handle)
+  {
+    detail::resume_from_timer(handle, delay_, node_base_.get(), node_timers_.get(), group_);
+  }
+
+  void
+  await_resume() const noexcept
+  {
+  }
+
+private:
+  std::chrono::nanoseconds delay_;
+  node_interfaces::NodeBaseInterface::SharedPtr node_base_;
+  node_interfaces::NodeTimersInterface::SharedPtr node_timers_;
+  rclcpp::CallbackGroup::SharedPtr group_;
+};
+
+/// Suspend the calling coroutine for the given duration, without blocking its thread.
+/**
+ * The coroutine is resumed by a one-shot wall timer of the node, i.e. by the executor the
+ * node (or the given callback group) is added to.
+ * A zero duration can be used to yield to the other callbacks of the executor.
+ *
+ * \param[in] node node used to create the timer.
+ * \param[in] delay time to wait before resuming the coroutine.
+ * \param[in] group callback group of the timer, or nullptr for the default one.
+ * \return the awaitable to `co_await`.
+ */
+template<typename NodeT, typename DurationRepT, typename DurationT>
+SleepAwaitable
+async_sleep_for(
+  NodeT && node,
+  std::chrono::duration<DurationRepT, DurationT> delay,
+  rclcpp::CallbackGroup::SharedPtr group = nullptr)
+{
+  return SleepAwaitable(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(delay),
+    rclcpp::node_interfaces::get_node_base_interface(node),
+    rclcpp::node_interfaces::get_node_timers_interface(node),
+    std::move(group));
+}
+
+/// Awaitable sending a request and producing its response, see async_send_request().
+template<typename ServiceT>
+class ClientRequestAwaitable
+{
+public:
+  using ClientT = rclcpp::Client<ServiceT>;
+
+  ClientRequestAwaitable(
+    typename ClientT::SharedPtr client,
+    typename ClientT::SharedRequest request)
+  : client_(std::move(client)), request_(std::move(request))
+  {}
+
+  bool
+  await_ready() const noexcept
+  {
+    return false;
+  }
+
+  void
+  await_suspend(std::coroutine_handle<> handle)
+  {
+    // The response may be handled by another thread before async_send_request() returns,
+    // and resuming the coroutine destroys this object: it isn't used after sending.
+    auto client = client_;
+    client->async_send_request(
+      request_,
+      [this, handle](typename ClientT::SharedFuture future) {
+        response_ = future.get();
+        handle.resume();
+      });
+  }
+
+  typename ClientT::SharedResponse
+  await_resume() noexcept
+  {
+    return std::move(response_);
+  }
+
+private:
+  typename ClientT::SharedPtr client_;
+  typename ClientT::SharedRequest request_;
+  typename ClientT::SharedResponse response_;
+};
+
+/// Send a request from a coroutine, and resume it when the response is received.
+/**
+ * The coroutine is resumed from the response callback of the client, i.e. by the executor
+ * the client is added to, so no executor thread is held while waiting for the response.
+ * If the response never comes, e.g. because the service server died, the coroutine is
+ * never resumed; use Client::prune_requests_older_than() to drop such requests.
+ *
+ * \param[in] client client used to send the request.
+ * \param[in] request request to be sent.
+ * \return the awaitable to `co_await`, producing the response.
+ * \throws rclcpp::exceptions::RCLError from the `co_await` expression if sending failed.
+ */
+template<typename ServiceT>
+ClientRequestAwaitable<ServiceT>
+async_send_request(
+  const std::shared_ptr<rclcpp::Client<ServiceT>> & client,
+  std::shared_ptr<typename ServiceT::Request> request)
+{
+  return ClientRequestAwaitable<ServiceT>(client, std::move(request));
+}
+
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__COROUTINES_HPP_
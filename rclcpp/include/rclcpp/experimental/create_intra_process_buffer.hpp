@@ -17,9 +17,15 @@
 
 #include <memory>
 #include <stdexcept>
+#include <string>
+#include <typeinfo>
 #include <utility>
 
+#include "rclcpp/experimental/buffers/buffer_implementation_base.hpp"
+#include "rclcpp/experimental/buffers/buffer_implementation_factory.hpp"
 #include "rclcpp/experimental/buffers/intra_process_buffer.hpp"
+#include "rclcpp/experimental/buffers/latest_value_buffer_implementation.hpp"
+#include "rclcpp/experimental/buffers/lock_free_ring_buffer_implementation.hpp"
 #include "rclcpp/experimental/buffers/ring_buffer_implementation.hpp"
 #include "rclcpp/intra_process_buffer_type.hpp"
 #include "rclcpp/qos.hpp"
@@ -29,6 +35,54 @@ namespace rclcpp
 namespace experimental
 {
 
+/// Create the implementation of an intra-process buffer storing elements of type BufferT.
+template<typename BufferT>
+std::unique_ptr<rclcpp::experimental::buffers::BufferImplementationBase<BufferT>>
+create_intra_process_buffer_implementation(
+  IntraProcessBufferImplementation buffer_implementation,
+  size_t buffer_size)
+{
+  using namespace rclcpp::experimental::buffers;  // NOLINT(build/namespaces)
+  switch (buffer_implementation) {
+    case IntraProcessBufferImplementation::MutexRingBuffer:
+      return std::make_unique<RingBufferImplementation<BufferT>>(buffer_size);
+    case IntraProcessBufferImplementation::SingleProducerRingBuffer:
+      return std::make_unique<SingleProducerRingBufferImplementation<BufferT>>(buffer_size);
+    case IntraProcessBufferImplementation::Default:
+    case IntraProcessBufferImplementation::MultiProducerRingBuffer:
+      return std::make_unique<MultiProducerRingBufferImplementation<BufferT>>(buffer_size);
+    case IntraProcessBufferImplementation::LatestValue:
+      return std::make_unique<LatestValueBufferImplementation<BufferT>>();
+    default:
+      throw std::runtime_error("Unrecognized IntraProcessBufferImplementation value");
+  }
+}
+
+/// Create the implementation of an intra-process buffer storing elements of type BufferT.
+/**
+ * \throws std::invalid_argument if the factory doesn't create buffers of elements of type
+ *   BufferT, or creates none.
+ */
+template<typename BufferT>
+std::unique_ptr<rclcpp::experimental::buffers::BufferImplementationBase<BufferT>>
+create_intra_process_buffer_implementation(
+  rclcpp::experimental::buffers::BufferImplementationFactoryBase & buffer_factory,
+  const rclcpp::QoS & qos)
+{
+  using rclcpp::experimental::buffers::BufferImplementationFactory;
+  auto typed_factory = dynamic_cast<BufferImplementationFactory<BufferT> *>(&buffer_factory);
+  if (!typed_factory) {
+    throw std::invalid_argument(
+            std::string("the intra-process buffer factory doesn't create buffers of ") +
+            typeid(BufferT).name());
+  }
+  auto buffer_implementation = typed_factory->create_buffer_implementation(qos);
+  if (!buffer_implementation) {
+    throw std::invalid_argument("the intra-process buffer factory created no buffer");
+  }
+  return buffer_implementation;
+}
+
 template<
   typename MessageT,
   typename Alloc = std::allocator<void>,
@@ -37,7 +91,11 @@ typename rclcpp::experimental::buffers::IntraProcessBuffer<MessageT, Alloc, Dele
 create_intra_process_buffer(
   IntraProcessBufferType buffer_type,
   const rclcpp::QoS & qos,
-  std::shared_ptr<Alloc> allocator)
+  std::shared_ptr<Alloc> allocator,
+  IntraProcessBufferImplementation buffer_implementation =
+  IntraProcessBufferImplementation::Default,
+  std::shared_ptr<rclcpp::experimental::buffers::BufferImplementationFactoryBase> buffer_factory =
+  nullptr)
 {
   using MessageSharedPtr = std::shared_ptr<const MessageT>;
   using MessageUniquePtr = std::unique_ptr<MessageT, Deleter>;
@@ -52,15 +110,13 @@ create_intra_process_buffer(
       {
         using BufferT = MessageSharedPtr;
 
-        auto buffer_implementation =
-          std::make_unique<rclcpp::experimental::buffers::RingBufferImplementation<BufferT>>(
-          buffer_size);
-
         // Construct the intra_process_buffer
         buffer =
           std::make_unique<rclcpp::experimental::buffers::TypedIntraProcessBuffer<MessageT, Alloc,
             Deleter, BufferT>>(
-          std::move(buffer_implementation),
+          buffer_factory ?
+          create_intra_process_buffer_implementation<BufferT>(*buffer_factory, qos) :
+          create_intra_process_buffer_implementation<BufferT>(buffer_implementation, buffer_size),
           allocator);
 
         break;
@@ -69,15 +125,13 @@ create_intra_process_buffer(
       {
         using BufferT = MessageUniquePtr;
 
-        auto buffer_implementation =
-          std::make_unique<rclcpp::experimental::buffers::RingBufferImplementation<BufferT>>(
-          buffer_size);
-
         // Construct the intra_process_buffer
         buffer =
           std::make_unique<rclcpp::experimental::buffers::TypedIntraProcessBuffer<MessageT, Alloc,
             Deleter, BufferT>>(
-          std::move(buffer_implementation),
+          buffer_factory ?
+          create_intra_process_buffer_implementation<BufferT>(*buffer_factory, qos) :
+          create_intra_process_buffer_implementation<BufferT>(buffer_implementation, buffer_size),
           allocator);
 
         break;
@@ -0,0 +1,299 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXPERIMENTAL__EXECUTORS__EVENTS_EXECUTOR__EVENTS_EXECUTOR_HPP_
+#define RCLCPP__EXPERIMENTAL__EXECUTORS__EVENTS_EXECUTOR__EVENTS_EXECUTOR_HPP_
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "rclcpp/executor.hpp"
+#include "rclcpp/experimental/executors/events_executor/events_executor_event_types.hpp"
+#include "rclcpp/experimental/executors/events_executor/events_queue.hpp"
+#include "rclcpp/experimental/executors/events_executor/simple_events_queue.hpp"
+#include "rclcpp/experimental/timers_manager.hpp"
+#include "rclcpp/node.hpp"
+
+namespace rclcpp
+{
+namespace experimental
+{
+namespace executors
+{
+
+/// Events executor implementation
+/**
+ * This executor uses an events queue and a timers manager to execute entities from its
+ * associated nodes and callback groups.
+ * ROS 2 entities allow to set callback functions that are invoked when the entity is triggered
+ * or has work to do.
+ * The events-executor sets these callbacks such that they push an event into its queue.
+ *
+ * This executor tries to reduce as much as possible the amount of maintenance operations.
+ * There is no wait set that has to be cleared, resized and filled on every iteration:
+ * the set of entities is refreshed only when the notify guard condition of one of its nodes
+ * or callback groups is triggered, i.e. when entities are added or removed.
+ * Timers are monitored by a TimersManager, which is the only place where the executor still
+ * has to look for the next entity to become ready.
+ *
+ * The events-executor is a single threaded executor, so mutually exclusive callback groups
+ * need no special handling.
+ * Custom waitables are only supported if they implement `Waitable::set_on_ready_callback`
+ * and `Waitable::take_data_by_entity_id`, waitables that don't are not executed.
+ *
+ * To run this executor:
+ * rclcpp::experimental::executors::EventsExecutor executor;
+ * executor.add_node(node);
+ * executor.spin();
+ * executor.remove_node(node);
+ */
+class EventsExecutor : public rclcpp::Executor
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(EventsExecutor)
+
+  /// Default constructor. See the default constructor for Executor.
+  /**
+   * \param[in] events_queue The queue used to store events.
+   * \param[in] execute_timers_separate_thread If true, timers are executed in a separate
+   * thread. If false, timers are executed in the same thread as all other entities.
+   * \param[in] options Options used to configure the executor.
+   */
+  RCLCPP_PUBLIC
+  explicit EventsExecutor(
+    rclcpp::experimental::executors::EventsQueue::UniquePtr events_queue = std::make_unique<
+      rclcpp::experimental::executors::SimpleEventsQueue>(),
+    bool execute_timers_separate_thread = false,
+    const rclcpp::ExecutorOptions & options = rclcpp::ExecutorOptions());
+
+  /// Default destructor.
+  RCLCPP_PUBLIC
+  virtual ~EventsExecutor();
+
+  /// Events executor implementation of spin.
+  /**
+   * This function will block until work comes in, execute it, and keep blocking.
+   * It will only be interrupted by a CTRL-C (managed by the global signal handler).
+   * \throws std::runtime_error when spin() called while already spinning
+   */
+  RCLCPP_PUBLIC
+  void
+  spin() override;
+
+  /// Events executor implementation of spin some
+  /**
+   * This non-blocking function will execute the timers and events
+   * that were ready when this API was called, until timeout or no
+   * more work available. New ready-timers/events arrived while
+   * executing work, won't be taken into account here.
+   *
+   * Example:
+   *   while(condition) {
+   *     spin_some();
+   *     sleep(); // User should have some sync work or
+   *              // sleep to avoid a 100% CPU usage
+   *   }
+   */
+  RCLCPP_PUBLIC
+  void
+  spin_some(std::chrono::nanoseconds max_duration = std::chrono::nanoseconds(0)) override;
+
+  /// Events executor implementation of spin all
+  /**
+   * This non-blocking function will execute timers and events
+   * until timeout or no more work available. If new ready-timers/events
+   * arrive while executing work available, they will be executed
+   * as long as the timeout hasn't expired.
+   *
+   * Example:
+   *   while(condition) {
+   *     spin_all();
+   *     sleep(); // User should have some sync work or
+   *              // sleep to avoid a 100% CPU usage
+   *   }
+   */
+  RCLCPP_PUBLIC
+  void
+  spin_all(std::chrono::nanoseconds max_duration) override;
+
+  /// Not supported, the work isn't collected with the memory strategy.
+  /**
+   * \throws std::runtime_error always.
+   */
+  RCLCPP_PUBLIC
+  void
+  spin_some_with_quotas(const rclcpp::SpinQuotas & quotas) override;
+
+  /// Add a node to the executor.
+  /**
+   * \sa rclcpp::Executor::add_node
+   */
+  RCLCPP_PUBLIC
+  void
+  add_node(
+    rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_ptr,
+    bool notify = true) override;
+
+  /// Convenience function which takes Node and forwards NodeBaseInterface.
+  /**
+   * \sa rclcpp::EventsExecutor::add_node
+   */
+  RCLCPP_PUBLIC
+  void
+  add_node(std::shared_ptr<rclcpp::Node> node_ptr, bool notify = true) override;
+
+  /// Remove a node from the executor.
+  /**
+   * \sa rclcpp::Executor::remove_node
+   */
+  RCLCPP_PUBLIC
+  void
+  remove_node(
+    rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_ptr,
+    bool notify = true) override;
+
+  /// Convenience function which takes Node and forwards NodeBaseInterface.
+  /**
+   * \sa rclcpp::Executor::remove_node
+   */
+  RCLCPP_PUBLIC
+  void
+  remove_node(std::shared_ptr<rclcpp::Node> node_ptr, bool notify = true) override;
+
+  /// Add a callback group to an executor.
+  /**
+   * \sa rclcpp::Executor::add_callback_group
+   */
+  RCLCPP_PUBLIC
+  void
+  add_callback_group(
+    rclcpp::CallbackGroup::SharedPtr group_ptr,
+    rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_ptr,
+    bool notify = true) override;
+
+  /// Remove callback group from the executor
+  /**
+   * \sa rclcpp::Executor::remove_callback_group
+   */
+  RCLCPP_PUBLIC
+  void
+  remove_callback_group(
+    rclcpp::CallbackGroup::SharedPtr group_ptr,
+    bool notify = true) override;
+
+protected:
+  /// Internal implementation of spin_once
+  RCLCPP_PUBLIC
+  void
+  spin_once_impl(std::chrono::nanoseconds timeout) override;
+
+  /// Internal implementation of spin_some
+  RCLCPP_PUBLIC
+  void
+  spin_some_impl(std::chrono::nanoseconds max_duration, bool exhaustive);
+
+private:
+  RCLCPP_DISABLE_COPY(EventsExecutor)
+
+  template<typename EntityT>
+  using EntitiesMap = std::unordered_map<const void *, typename EntityT::WeakPtr>;
+
+  /// Execute a provided executor event if its associated entities are available
+  void
+  execute_event(const ExecutorEvent & event);
+
+  /// Collect the entities of all the callback groups associated with the executor and
+  /// register or unregister the events callbacks of the entities that changed.
+  void
+  refresh_current_collection_from_callback_groups();
+
+  /// Register or unregister the callbacks of the notify guard conditions of nodes and
+  /// callback groups, must be called while holding the base Executor mutex_.
+  void
+  refresh_notify_guard_conditions() RCPPUTILS_TSA_REQUIRES(mutex_);
+
+  /// Unregister all the callbacks set by this executor.
+  void
+  clear_all_callbacks();
+
+  /// Create a listener callback function for a rmw entity, pushing events of the given type.
+  std::function<void(size_t)>
+  create_entity_callback(const void * entity_key, ExecutorEventType type);
+
+  /// Create a listener callback function for a waitable.
+  std::function<void(size_t, int)>
+  create_waitable_callback(const rclcpp::Waitable * waitable_id);
+
+  /// Create a listener callback function for the guard conditions the executor waits on.
+  std::function<void(size_t)>
+  create_notify_callback();
+
+  /// Search for an entity in the current collection, returns nullptr if not found.
+  template<typename EntityT>
+  typename EntityT::SharedPtr
+  retrieve_entity(const void * entity_key, const EntitiesMap<EntityT> & entities)
+  {
+    std::lock_guard<std::recursive_mutex> lock(collection_mutex_);
+    auto it = entities.find(entity_key);
+    if (it == entities.end()) {
+      return nullptr;
+    }
+    return it->second.lock();
+  }
+
+  /// Queue where entities can push events
+  rclcpp::experimental::executors::EventsQueue::UniquePtr events_queue_;
+
+  /// Timers manager used to track and/or execute associated timers
+  std::shared_ptr<rclcpp::experimental::TimersManager> timers_manager_;
+
+  // Mutex to protect the current collection of entities.
+  std::recursive_mutex collection_mutex_;
+
+  /// Entities currently registered with the executor, keyed by the value used in their events.
+  EntitiesMap<rclcpp::SubscriptionBase> subscriptions_;
+  EntitiesMap<rclcpp::ServiceBase> services_;
+  EntitiesMap<rclcpp::ClientBase> clients_;
+  EntitiesMap<rclcpp::TimerBase> timers_;
+  EntitiesMap<rclcpp::Waitable> waitables_;
+
+  typedef std::map<rclcpp::node_interfaces::NodeBaseInterface::WeakPtr,
+      rclcpp::GuardCondition *,
+      std::owner_less<rclcpp::node_interfaces::NodeBaseInterface::WeakPtr>>
+    WeakNodesToGuardConditionsMap;
+
+  typedef std::map<rclcpp::CallbackGroup::WeakPtr,
+      rclcpp::GuardCondition::WeakPtr,
+      std::owner_less<rclcpp::CallbackGroup::WeakPtr>>
+    WeakCallbackGroupsToWeakGuardConditionsMap;
+
+  /// Notify guard conditions of the nodes associated with the executor
+  WeakNodesToGuardConditionsMap
+  notify_guard_conditions_of_nodes_ RCPPUTILS_TSA_GUARDED_BY(mutex_);
+
+  /// Notify guard conditions of the callback groups associated with the executor
+  WeakCallbackGroupsToWeakGuardConditionsMap
+  notify_guard_conditions_of_groups_ RCPPUTILS_TSA_GUARDED_BY(mutex_);
+};
+
+}  // namespace executors
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__EXECUTORS__EVENTS_EXECUTOR__EVENTS_EXECUTOR_HPP_
@@ -19,23 +19,35 @@
 
 #include <shared_mutex>
 
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <functional>
 #include <iterator>
 #include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 #include <typeinfo>
 
 #include "rclcpp/allocator/allocator_deleter.hpp"
+#include "rclcpp/content_filter.hpp"
+#include "rclcpp/detail/snapshot_ptr.hpp"
+#include "rclcpp/experimental/lazy_serialized_message.hpp"
+#include "rclcpp/experimental/message_pool.hpp"
 #include "rclcpp/experimental/ros_message_intra_process_buffer.hpp"
 #include "rclcpp/experimental/subscription_intra_process.hpp"
 #include "rclcpp/experimental/subscription_intra_process_base.hpp"
 #include "rclcpp/experimental/subscription_intra_process_buffer.hpp"
+#include "rclcpp/experimental/subscription_intra_process_serialized.hpp"
 #include "rclcpp/logger.hpp"
 #include "rclcpp/logging.hpp"
 #include "rclcpp/macros.hpp"
 #include "rclcpp/publisher_base.hpp"
+#include "rclcpp/serialized_message.hpp"
 #include "rclcpp/type_adapter.hpp"
 #include "rclcpp/visibility_control.hpp"
 
@@ -86,6 +98,18 @@ namespace experimental
  * This information allows this class to operate efficiently by performing the
  * fewest number of copies of the message required.
  *
+ * The subscriptions of each publisher are kept in an immutable snapshot, which is
+ * replaced atomically each time a publisher or a subscription is added or removed,
+ * so that publishing takes no lock.
+ * A message published while a subscription is being removed may still be stored in
+ * its buffer.
+ * The buffers of the subscriptions are cast to the message types of each publisher
+ * registered with these types when the snapshot is built, not for each message.
+ *
+ * For each transient local publisher, this class keeps the last messages published,
+ * up to the depth of its history, shared with the subscriptions which don't take ownership.
+ * They are given to the transient local subscriptions when they are registered.
+ *
  * This class is neither CopyConstructable nor CopyAssignable.
  */
 class IntraProcessManager
@@ -108,6 +132,8 @@ public:
    * the information of its wrapped subscription (i.e. topic name and QoS).
    *
    * In addition this generates a unique intra process id for the subscription.
+   * A transient local subscription receives the messages kept for the transient local
+   * publishers it communicates with.
    *
    * \param subscription the SubscriptionIntraProcess to register.
    * \return an unsigned 64-bit integer which is the subscription's unique id.
@@ -140,6 +166,43 @@ public:
   uint64_t
   add_publisher(rclcpp::PublisherBase::SharedPtr publisher);
 
+  /// Register a publisher with the manager, with the types of the messages it publishes.
+  /**
+   * Like add_publisher(), in addition the subscriptions of this publisher are cast to the
+   * buffers of these message types once, instead of for each published message.
+   *
+   * \param publisher publisher to be registered with the manager.
+   * \return an unsigned 64-bit integer which is the publisher's unique id.
+   */
+  template<
+    typename PublishedType,
+    typename ROSMessageType,
+    typename Alloc>
+  uint64_t
+  add_publisher(rclcpp::PublisherBase::SharedPtr publisher)
+  {
+    auto resolver = [](rclcpp::experimental::SubscriptionIntraProcessBase & subscription) {
+        // The publisher publishes both its published type and its ROS message type
+        return TypedSubscriptions{
+          resolve_typed_subscription<PublishedType, Alloc, ROSMessageType>(subscription),
+          resolve_typed_subscription<ROSMessageType, Alloc, ROSMessageType>(subscription)};
+      };
+    return add_publisher_with_resolver(std::move(publisher), resolver);
+  }
+
+  /// Register a publisher of serialized messages, see GenericPublisher.
+  /**
+   * The publisher only communicates with the subscriptions of serialized messages, see
+   * SubscriptionIntraProcessSerialized, its messages are published with
+   * do_serialized_intra_process_publish().
+   *
+   * \param publisher publisher to be registered with the manager.
+   * \return an unsigned 64-bit integer which is the publisher's unique id.
+   */
+  RCLCPP_PUBLIC
+  uint64_t
+  add_serialized_publisher(rclcpp::PublisherBase::SharedPtr publisher);
+
   /// Unregister a publisher using the publisher's unique id.
   /**
    * This method does not allocate memory.
@@ -150,6 +213,18 @@ public:
   void
   remove_publisher(uint64_t intra_process_publisher_id);
 
+  /// Unregister all the publishers and subscriptions at once.
+  /**
+   * This is used to tear down a context quickly, see rclcpp::InitOptions::fast_teardown:
+   * the routes are dropped once, instead of being rebuilt each time one of the many
+   * publishers and subscriptions is removed.
+   * Removing the publishers and subscriptions afterwards is a cheap no-op, and publishing
+   * intra-process to the removed subscriptions isn't possible anymore.
+   */
+  RCLCPP_PUBLIC
+  void
+  clear();
+
   /// Publishes an intra-process message, passed as a unique pointer.
   /**
    * This is one of the two methods for publishing intra-process.
@@ -173,6 +248,9 @@ public:
    * \param intra_process_publisher_id the id of the publisher of this message.
    * \param message the message that is being stored.
    * \param allocator for allocations when buffering messages.
+   * \param message_pool if not nullptr, pool recycling the shared copy of the message.
+   * \param ros_message if not nullptr, the message already converted to the ROS message type,
+   *   given to the subscriptions of that type instead of converting the message again.
    */
   template<
     typename MessageT,
@@ -184,143 +262,730 @@ public:
   do_intra_process_publish(
     uint64_t intra_process_publisher_id,
     std::unique_ptr<MessageT, Deleter> message,
+    typename allocator::AllocRebind<MessageT, Alloc>::allocator_type & allocator,
+    MessagePool<MessageT, Alloc> * message_pool = nullptr,
+    std::shared_ptr<const ROSMessageType> ros_message = nullptr)
+  {
+    const auto snapshot = routing_snapshot_.load();
+    const PublisherRoute * route = find_route(*snapshot, intra_process_publisher_id);
+    if (route == nullptr) {
+      // Publisher is either invalid or no longer exists.
+      RCLCPP_WARN(
+        rclcpp::get_logger("rclcpp"),
+        "Calling do_intra_process_publish for invalid or no longer existing publisher id");
+      return;
+    }
+    this->template publish_to_route<MessageT, ROSMessageType, Alloc, Deleter>(
+      *route, std::move(message), allocator, message_pool, std::move(ros_message));
+  }
+
+  template<
+    typename MessageT,
+    typename ROSMessageType,
+    typename Alloc,
+    typename Deleter = std::default_delete<MessageT>
+  >
+  std::shared_ptr<const MessageT>
+  do_intra_process_publish_and_return_shared(
+    uint64_t intra_process_publisher_id,
+    std::unique_ptr<MessageT, Deleter> message,
+    typename allocator::AllocRebind<MessageT, Alloc>::allocator_type & allocator,
+    MessagePool<MessageT, Alloc> * message_pool = nullptr,
+    std::shared_ptr<const ROSMessageType> ros_message = nullptr)
+  {
+    const auto snapshot = routing_snapshot_.load();
+    const PublisherRoute * route = find_route(*snapshot, intra_process_publisher_id);
+    if (route == nullptr) {
+      // Publisher is either invalid or no longer exists.
+      RCLCPP_WARN(
+        rclcpp::get_logger("rclcpp"),
+        "Calling do_intra_process_publish for invalid or no longer existing publisher id");
+      return nullptr;
+    }
+    return this->template publish_to_route_and_return_shared<MessageT, ROSMessageType, Alloc,
+             Deleter>(
+      *route, std::move(message), allocator, message_pool, std::move(ros_message));
+  }
+
+  /// Publishes a batch of intra-process messages, looking the subscriptions up once.
+  /**
+   * The messages are delivered in order, each like with do_intra_process_publish(), or like
+   * with do_intra_process_publish_and_return_shared() if shared_messages is not nullptr.
+   *
+   * \param intra_process_publisher_id the id of the publisher of the messages.
+   * \param messages the messages being stored, the vector is left with null pointers.
+   * \param allocator for allocations when buffering messages.
+   * \param message_pool if not nullptr, pool recycling the shared copies of the messages.
+   * \param shared_messages if not nullptr, the shared messages are appended to it, e.g. to
+   *   publish them to other processes afterwards.
+   */
+  template<
+    typename MessageT,
+    typename ROSMessageType,
+    typename Alloc,
+    typename Deleter = std::default_delete<MessageT>
+  >
+  void
+  do_intra_process_publish_batch(
+    uint64_t intra_process_publisher_id,
+    std::vector<std::unique_ptr<MessageT, Deleter>> & messages,
+    typename allocator::AllocRebind<MessageT, Alloc>::allocator_type & allocator,
+    MessagePool<MessageT, Alloc> * message_pool = nullptr,
+    std::vector<std::shared_ptr<const MessageT>> * shared_messages = nullptr)
+  {
+    const auto snapshot = routing_snapshot_.load();
+    const PublisherRoute * route = find_route(*snapshot, intra_process_publisher_id);
+    if (route == nullptr) {
+      // Publisher is either invalid or no longer exists.
+      RCLCPP_WARN(
+        rclcpp::get_logger("rclcpp"),
+        "Calling do_intra_process_publish for invalid or no longer existing publisher id");
+      return;
+    }
+    for (auto & message : messages) {
+      if (shared_messages != nullptr) {
+        shared_messages->push_back(
+          this->template publish_to_route_and_return_shared<MessageT, ROSMessageType, Alloc,
+          Deleter>(*route, std::move(message), allocator, message_pool, nullptr));
+      } else {
+        this->template publish_to_route<MessageT, ROSMessageType, Alloc, Deleter>(
+          *route, std::move(message), allocator, message_pool, nullptr);
+      }
+    }
+  }
+
+  /// Publishes a read-only intra-process message, e.g. a message loaned by the middleware.
+  /**
+   * The subscriptions taking shared messages get a reference to the message itself, so it is
+   * released only once all of them released it.
+   * The subscriptions taking ownership and the history of a transient local publisher get a
+   * copy instead, which doesn't keep the message.
+   *
+   * This method can throw an exception if the publisher id is not found or
+   * if the publisher shared_ptr given to add_publisher has gone out of scope.
+   *
+   * \param intra_process_publisher_id the id of the publisher of this message.
+   * \param message the message, which must not be modified anymore.
+   * \param allocator for the copies of the message.
+   */
+  template<
+    typename MessageT,
+    typename ROSMessageType,
+    typename Alloc,
+    typename Deleter = std::default_delete<MessageT>
+  >
+  void
+  do_intra_process_publish_shared(
+    uint64_t intra_process_publisher_id,
+    std::shared_ptr<const MessageT> message,
     typename allocator::AllocRebind<MessageT, Alloc>::allocator_type & allocator)
   {
     using MessageAllocTraits = allocator::AllocRebind<MessageT, Alloc>;
-    using MessageAllocatorT = typename MessageAllocTraits::allocator_type;
 
-    std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+    const auto snapshot = routing_snapshot_.load();
+    const PublisherRoute * route = find_route(*snapshot, intra_process_publisher_id);
+    if (route == nullptr) {
+      // Publisher is either invalid or no longer exists.
+      RCLCPP_WARN(
+        rclcpp::get_logger("rclcpp"),
+        "Calling do_intra_process_publish_shared for invalid or no longer existing publisher id");
+      return;
+    }
+    const auto & sub_ids = *route;
+    ConvertedMessage<MessageT, Alloc, ROSMessageType> converted_message;
+
+    if (!sub_ids.take_ownership_subscriptions.empty()) {
+      // Copied once, the copy is shared as usual by the buffers taking ownership
+      Deleter deleter;
+      allocator::set_allocator_for_deleter(&deleter, &allocator);
+      auto ptr = MessageAllocTraits::allocate(allocator, 1);
+      MessageAllocTraits::construct(allocator, ptr, *message);
+      this->template add_owned_msg_to_buffers<MessageT, Alloc, Deleter, ROSMessageType>(
+        std::unique_ptr<MessageT, Deleter>(ptr, deleter),
+        sub_ids.take_ownership_subscriptions,
+        allocator,
+        converted_message);
+    }
+    if (sub_ids.history != nullptr) {
+      this->template add_msg_to_history<MessageT, Alloc, Deleter, ROSMessageType>(
+        std::allocate_shared<MessageT>(allocator, *message), *sub_ids.history, allocator);
+    }
+    if (!sub_ids.take_shared_subscriptions.empty()) {
+      this->template add_shared_msg_to_buffers<MessageT, Alloc, Deleter, ROSMessageType>(
+        std::move(message), sub_ids.take_shared_subscriptions, converted_message);
+    }
+  }
+
+  /// Publishes an intra-process message kept by the caller, copying it only when needed.
+  /**
+   * Nothing is copied when the publisher has neither intra-process subscriptions nor a
+   * transient local history.
+   * When none of the subscriptions take ownership, the message is copied once into a shared
+   * message, given to all of them and to the history.
+   * Otherwise the message is copied and delivered like with do_intra_process_publish(), or like
+   * with do_intra_process_publish_and_return_shared() if return_shared is true.
+   *
+   * This method can throw an exception if the publisher shared_ptr given to add_publisher
+   * has gone out of scope.
+   *
+   * \param intra_process_publisher_id the id of the publisher of this message.
+   * \param message the message, which the caller keeps.
+   * \param allocator for the copies of the message.
+   * \param message_pool if not nullptr, pool recycling the shared copy of the message.
+   * \param ros_message if not nullptr, the message already converted to the ROS message type.
+   * \param return_shared true to get a shared copy of the message even when some
+   *   subscriptions take ownership, e.g. to publish it to other processes afterwards.
+   * \return the shared copy of the message, or nullptr if none was made.
+   */
+  template<
+    typename MessageT,
+    typename ROSMessageType,
+    typename Alloc,
+    typename Deleter = std::default_delete<MessageT>
+  >
+  std::shared_ptr<const MessageT>
+  do_intra_process_publish_copy(
+    uint64_t intra_process_publisher_id,
+    const MessageT & message,
+    typename allocator::AllocRebind<MessageT, Alloc>::allocator_type & allocator,
+    MessagePool<MessageT, Alloc> * message_pool = nullptr,
+    std::shared_ptr<const ROSMessageType> ros_message = nullptr,
+    bool return_shared = false)
+  {
+    using MessageAllocTraits = allocator::AllocRebind<MessageT, Alloc>;
+    using MessageAllocatorT = typename MessageAllocTraits::allocator_type;
 
-    auto publisher_it = pub_to_subs_.find(intra_process_publisher_id);
-    if (publisher_it == pub_to_subs_.end()) {
+    const auto snapshot = routing_snapshot_.load();
+    const PublisherRoute * route = find_route(*snapshot, intra_process_publisher_id);
+    if (route == nullptr) {
       // Publisher is either invalid or no longer exists.
       RCLCPP_WARN(
         rclcpp::get_logger("rclcpp"),
-        "Calling do_intra_process_publish for invalid or no longer existing publisher id");
+        "Calling do_intra_process_publish_copy for invalid or no longer existing publisher id");
+      return nullptr;
+    }
+    const auto & sub_ids = *route;
+    if (sub_ids.all_subscriptions.empty() && sub_ids.history == nullptr) {
+      return nullptr;
+    }
+
+    if (sub_ids.take_ownership_subscriptions.empty()) {
+      // A single shared copy serves all the subscriptions
+      std::shared_ptr<const MessageT> shared_msg = message_pool != nullptr ?
+        message_pool->copy(message) :
+        std::allocate_shared<MessageT, MessageAllocatorT>(allocator, message);
+      ConvertedMessage<MessageT, Alloc, ROSMessageType> converted_message(std::move(ros_message));
+      if (!sub_ids.take_shared_subscriptions.empty()) {
+        this->template add_shared_msg_to_buffers<MessageT, Alloc, Deleter, ROSMessageType>(
+          shared_msg, sub_ids.take_shared_subscriptions, converted_message);
+      }
+      if (sub_ids.history != nullptr) {
+        this->template add_msg_to_history<MessageT, Alloc, Deleter, ROSMessageType>(
+          shared_msg, *sub_ids.history, allocator);
+      }
+      return shared_msg;
+    }
+
+    // The subscriptions taking ownership need a copy they can own
+    Deleter deleter;
+    allocator::set_allocator_for_deleter(&deleter, &allocator);
+    auto ptr = MessageAllocTraits::allocate(allocator, 1);
+    MessageAllocTraits::construct(allocator, ptr, message);
+    std::unique_ptr<MessageT, Deleter> unique_msg(ptr, deleter);
+    if (return_shared) {
+      return this->template publish_to_route_and_return_shared<MessageT, ROSMessageType, Alloc,
+             Deleter>(
+        sub_ids, std::move(unique_msg), allocator, message_pool, std::move(ros_message));
+    }
+    this->template publish_to_route<MessageT, ROSMessageType, Alloc, Deleter>(
+      sub_ids, std::move(unique_msg), allocator, message_pool, std::move(ros_message));
+    return nullptr;
+  }
+
+  /// Publishes a serialized intra-process message, shared by all the subscriptions.
+  /**
+   * This method can throw an exception if the publisher id is not found or
+   * if the publisher wasn't registered with add_serialized_publisher().
+   *
+   * \param intra_process_publisher_id the id of the publisher of this message.
+   * \param message the serialized message, which must not be modified anymore.
+   */
+  RCLCPP_PUBLIC
+  void
+  do_serialized_intra_process_publish(
+    uint64_t intra_process_publisher_id,
+    std::shared_ptr<const rclcpp::SerializedMessage> message);
+
+  /// Return true if the given rmw_gid_t matches any stored Publishers.
+  /**
+   * \param id the gid of the publisher of a message received from the middleware.
+   * \param include_serialized_publishers whether to match the publishers of serialized messages,
+   *   which only deliver intra-process messages to the subscriptions of serialized messages.
+   */
+  RCLCPP_PUBLIC
+  bool
+  matches_any_publishers(
+    const rmw_gid_t * id,
+    bool include_serialized_publishers = false) const;
+
+  /// Return the number of intraprocess subscriptions that are matched with a given publisher id.
+  RCLCPP_PUBLIC
+  size_t
+  get_subscription_count(uint64_t intra_process_publisher_id) const;
+
+  RCLCPP_PUBLIC
+  rclcpp::experimental::SubscriptionIntraProcessBase::SharedPtr
+  get_subscription_intra_process(uint64_t intra_process_subscription_id);
+
+private:
+  struct SplittedSubscriptions
+  {
+    std::vector<uint64_t> take_shared_subscriptions;
+    std::vector<uint64_t> take_ownership_subscriptions;
+  };
+
+  using SubscriptionMap =
+    std::unordered_map<uint64_t, rclcpp::experimental::SubscriptionIntraProcessBase::WeakPtr>;
+
+  using PublisherMap =
+    std::unordered_map<uint64_t, rclcpp::PublisherBase::WeakPtr>;
+
+  using PublisherToSubscriptionIdsMap =
+    std::unordered_map<uint64_t, SplittedSubscriptions>;
+
+  /// Buffers of a subscription cast for the messages of a given type.
+  struct TypedSubscription
+  {
+    /// Tag of the message types, see get_types_tag(), nullptr if unresolved.
+    const void * types_tag = nullptr;
+    /// The SubscriptionIntraProcessBuffer of the published type, if it's one.
+    void * buffer_subscription = nullptr;
+    /// The SubscriptionROSMsgIntraProcessBuffer of the ROS message type, if it's one.
+    void * ros_message_subscription = nullptr;
+    /// The SubscriptionIntraProcessSerialized, if it's one.
+    void * serialized_subscription = nullptr;
+  };
+
+  using TypedSubscriptions = std::array<TypedSubscription, 2>;
+
+  using SubscriptionResolver =
+    std::function<TypedSubscriptions(rclcpp::experimental::SubscriptionIntraProcessBase &)>;
+
+  /// Subscription of a route, cast for the types of its publisher.
+  struct RoutedSubscription
+  {
+    rclcpp::experimental::SubscriptionIntraProcessBase::WeakPtr subscription;
+    TypedSubscriptions typed_subscriptions;
+  };
+
+  using RoutedSubscriptions = std::vector<RoutedSubscription>;
+
+  /// ROS message converted from a type adapted message, at most once per publish.
+  /**
+   * The subscriptions of the ROS message type taking shared messages share the converted
+   * message, the ones taking ownership get a copy, or the converted message itself when they
+   * are the last to need it.
+   */
+  template<
+    typename MessageT,
+    typename Alloc,
+    typename ROSMessageType>
+  class ConvertedMessage
+  {
+public:
+    using ROSMessageTypeAllocatorTraits = allocator::AllocRebind<ROSMessageType, Alloc>;
+    using ROSMessageTypeAllocator = typename ROSMessageTypeAllocatorTraits::allocator_type;
+    using ROSMessageTypeDeleter = allocator::Deleter<ROSMessageTypeAllocator, ROSMessageType>;
+    using ROSMessageUniquePtr = std::unique_ptr<ROSMessageType, ROSMessageTypeDeleter>;
+
+    /// True if MessageT has to be converted to be given as a ROSMessageType.
+    static constexpr bool is_converted = rclcpp::TypeAdapter<MessageT>::is_specialized::value ||
+      (!std::is_same<MessageT, ROSMessageType>::value &&
+      std::is_same<typename rclcpp::TypeAdapter<MessageT,
+      ROSMessageType>::ros_message_type, ROSMessageType>::value);
+
+    /// Start from a message the publisher already converted, if not nullptr.
+    explicit ConvertedMessage(std::shared_ptr<const ROSMessageType> converted_message = nullptr)
+    : shared_(std::move(converted_message))
+    {}
+
+    /// Return the converted message, converting it if it wasn't yet.
+    std::shared_ptr<const ROSMessageType>
+    get_shared(const MessageT & message)
+    {
+      if (!shared_) {
+        if (owned_) {
+          shared_ = std::move(owned_);
+        } else if (auto viewed_message = get_viewed(message)) {
+          shared_ = std::move(viewed_message);
+        } else {
+          auto ros_message = std::make_shared<ROSMessageType>();
+          convert(message, *ros_message);
+          shared_ = std::move(ros_message);
+        }
+      }
+      return shared_;
+    }
+
+    /// Return a converted message owned by the caller, converting it if it wasn't yet.
+    /**
+     * \param[in] message the message to convert.
+     * \param[in] ros_message_allocator allocator of the messages given to the caller.
+     * \param[in] last true if the converted message isn't needed after this call.
+     */
+    ROSMessageUniquePtr
+    take_unique(
+      const MessageT & message,
+      ROSMessageTypeAllocator & ros_message_allocator,
+      bool last)
+    {
+      if (owned_ && last) {
+        return std::move(owned_);
+      }
+      if (!shared_ && !owned_) {
+        // The ROS message a view refers to is copied like a message converted for all
+        shared_ = get_viewed(message);
+      }
+      ROSMessageTypeDeleter deleter;
+      allocator::set_allocator_for_deleter(&deleter, &ros_message_allocator);
+      auto ptr = ROSMessageTypeAllocatorTraits::allocate(ros_message_allocator, 1);
+      if (!shared_ && !owned_) {
+        ROSMessageTypeAllocatorTraits::construct(ros_message_allocator, ptr);
+        ROSMessageUniquePtr ros_message(ptr, deleter);
+        convert(message, *ros_message);
+        if (last) {
+          return ros_message;
+        }
+        owned_ = std::move(ros_message);
+        ptr = ROSMessageTypeAllocatorTraits::allocate(ros_message_allocator, 1);
+      }
+      // Copy the converted message since it's also needed by other subscriptions
+      ROSMessageTypeAllocatorTraits::construct(
+        ros_message_allocator, ptr, shared_ ? *shared_ : *owned_);
+      return ROSMessageUniquePtr(ptr, deleter);
+    }
+
+private:
+    /// Return the ROS message the message is a view of, see rclcpp::TypeAdapter.
+    static std::shared_ptr<const ROSMessageType>
+    get_viewed(const MessageT & message)
+    {
+      if constexpr (rclcpp::TypeAdapter<MessageT>::is_specialized::value) {
+        return rclcpp::detail::get_viewed_ros_message<rclcpp::TypeAdapter<MessageT>>(message);
+      } else if constexpr (is_converted) {
+        return rclcpp::detail::get_viewed_ros_message<
+          rclcpp::TypeAdapter<MessageT, ROSMessageType>>(message);
+      } else {
+        (void) message;
+        return nullptr;
+      }
+    }
+
+    static void
+    convert(const MessageT & message, ROSMessageType & ros_message)
+    {
+      if constexpr (rclcpp::TypeAdapter<MessageT>::is_specialized::value) {
+        rclcpp::TypeAdapter<MessageT>::convert_to_ros_message(message, ros_message);
+      } else if constexpr (is_converted) {
+        rclcpp::TypeAdapter<MessageT, ROSMessageType>::convert_to_ros_message(
+          message, ros_message);
+      } else {
+        (void) message;
+        (void) ros_message;
+      }
+    }
+
+    std::shared_ptr<const ROSMessageType> shared_;
+    ROSMessageUniquePtr owned_;
+  };
+
+  /// Return true if the content filter of the subscription drops the message.
+  template<
+    typename MessageT,
+    typename Alloc,
+    typename ROSMessageType>
+  static
+  bool
+  drop_by_content_filter(
+    const rclcpp::experimental::SubscriptionIntraProcessBase & subscription,
+    const MessageT & message,
+    ConvertedMessage<MessageT, Alloc, ROSMessageType> & converted_message)
+  {
+    const auto content_filter = subscription.get_content_filter();
+    if (!content_filter) {
+      return false;
+    }
+    if constexpr (ConvertedMessage<MessageT, Alloc, ROSMessageType>::is_converted) {
+      // The filter is evaluated on the ROS message, converted once for all the subscriptions
+      return !content_filter->matches(converted_message.get_shared(message).get());
+    } else if constexpr (std::is_same<MessageT, ROSMessageType>::value) {
+      (void) converted_message;
+      return !content_filter->matches(&message);
+    } else {
+      (void) message;
+      (void) converted_message;
+      return false;
+    }
+  }
+
+  struct HistoryEntry;
+
+  /// Give a message of the history to a subscription, see replay_message().
+  using ReplayFunction = void (IntraProcessManager::*)(
+    const HistoryEntry & entry,
+    const rclcpp::experimental::SubscriptionIntraProcessBase::SharedPtr & subscription);
+
+  /// Message kept for the subscriptions registered after it was published.
+  struct HistoryEntry
+  {
+    std::shared_ptr<const void> message;
+    ReplayFunction replay;
+    /// Allocator of the publisher, for the copies given to the subscriptions taking ownership.
+    void * allocator;
+  };
+
+  /// Last messages of a transient local publisher.
+  struct PublisherHistory
+  {
+    explicit PublisherHistory(size_t history_depth)
+    : depth(history_depth)
+    {}
+
+    const size_t depth;
+    std::mutex mutex;
+    std::deque<HistoryEntry> entries;
+  };
+
+  /// Subscriptions a publisher delivers its messages to.
+  struct PublisherRoute
+  {
+    uint64_t publisher_id;
+    RoutedSubscriptions take_shared_subscriptions;
+    RoutedSubscriptions take_ownership_subscriptions;
+    /// The subscriptions of both kinds, the ones taking shared messages first.
+    RoutedSubscriptions all_subscriptions;
+    /// The history of the publisher if it's transient local, or nullptr.
+    std::shared_ptr<PublisherHistory> history;
+  };
+
+  /// Routes of all the publishers, sorted by publisher id, never modified once published.
+  using RoutingSnapshot = std::vector<PublisherRoute>;
+
+  /// Return the route of a publisher in the snapshot, or nullptr if it isn't there.
+  static
+  const PublisherRoute *
+  find_route(const RoutingSnapshot & snapshot, uint64_t intra_process_publisher_id)
+  {
+    auto route_it = std::lower_bound(
+      snapshot.begin(), snapshot.end(), intra_process_publisher_id,
+      [](const PublisherRoute & route, uint64_t id) {return route.publisher_id < id;});
+    if (route_it == snapshot.end() || route_it->publisher_id != intra_process_publisher_id) {
+      return nullptr;
+    }
+    return &*route_it;
+  }
+
+  /// Deliver a message to the subscriptions of a route, see do_intra_process_publish().
+  template<
+    typename MessageT,
+    typename ROSMessageType,
+    typename Alloc,
+    typename Deleter>
+  void
+  publish_to_route(
+    const PublisherRoute & sub_ids,
+    std::unique_ptr<MessageT, Deleter> message,
+    typename allocator::AllocRebind<MessageT, Alloc>::allocator_type & allocator,
+    MessagePool<MessageT, Alloc> * message_pool,
+    std::shared_ptr<const ROSMessageType> ros_message)
+  {
+    using MessageAllocTraits = allocator::AllocRebind<MessageT, Alloc>;
+    using MessageAllocatorT = typename MessageAllocTraits::allocator_type;
+
+    if (sub_ids.history != nullptr) {
+      // The message is shared with the history of the publisher
+      this->template publish_to_route_and_return_shared<MessageT, ROSMessageType, Alloc, Deleter>(
+        sub_ids, std::move(message), allocator, message_pool, std::move(ros_message));
       return;
     }
-    const auto & sub_ids = publisher_it->second;
+
+    // Converted at most once to the ROS message type, for all the subscriptions
+    ConvertedMessage<MessageT, Alloc, ROSMessageType> converted_message(std::move(ros_message));
 
     if (sub_ids.take_ownership_subscriptions.empty()) {
       // None of the buffers require ownership, so we promote the pointer
       std::shared_ptr<MessageT> msg = std::move(message);
 
       this->template add_shared_msg_to_buffers<MessageT, Alloc, Deleter, ROSMessageType>(
-        msg, sub_ids.take_shared_subscriptions);
+        msg, sub_ids.take_shared_subscriptions, converted_message);
     } else if (!sub_ids.take_ownership_subscriptions.empty() && // NOLINT
       sub_ids.take_shared_subscriptions.size() <= 1)
     {
       // There is at maximum 1 buffer that does not require ownership.
       // So this case is equivalent to all the buffers requiring ownership
-
-      // Merge the two vector of ids into a unique one
-      std::vector<uint64_t> concatenated_vector(sub_ids.take_shared_subscriptions);
-      concatenated_vector.insert(
-        concatenated_vector.end(),
-        sub_ids.take_ownership_subscriptions.begin(),
-        sub_ids.take_ownership_subscriptions.end());
       this->template add_owned_msg_to_buffers<MessageT, Alloc, Deleter, ROSMessageType>(
         std::move(message),
-        concatenated_vector,
-        allocator);
+        sub_ids.all_subscriptions,
+        allocator,
+        converted_message);
     } else if (!sub_ids.take_ownership_subscriptions.empty() && // NOLINT
       sub_ids.take_shared_subscriptions.size() > 1)
     {
       // Construct a new shared pointer from the message
       // for the buffers that do not require ownership
-      auto shared_msg = std::allocate_shared<MessageT, MessageAllocatorT>(allocator, *message);
+      auto shared_msg = message_pool != nullptr ?
+        message_pool->copy(*message) :
+        std::allocate_shared<MessageT, MessageAllocatorT>(allocator, *message);
 
       this->template add_shared_msg_to_buffers<MessageT, Alloc, Deleter, ROSMessageType>(
-        shared_msg, sub_ids.take_shared_subscriptions);
+        shared_msg, sub_ids.take_shared_subscriptions, converted_message);
       this->template add_owned_msg_to_buffers<MessageT, Alloc, Deleter, ROSMessageType>(
-        std::move(message), sub_ids.take_ownership_subscriptions, allocator);
+        std::move(message), sub_ids.take_ownership_subscriptions, allocator, converted_message);
     }
   }
 
+  /// Deliver a message to a route and return it, see do_intra_process_publish_and_return_shared().
   template<
     typename MessageT,
     typename ROSMessageType,
     typename Alloc,
-    typename Deleter = std::default_delete<MessageT>
-  >
+    typename Deleter>
   std::shared_ptr<const MessageT>
-  do_intra_process_publish_and_return_shared(
-    uint64_t intra_process_publisher_id,
+  publish_to_route_and_return_shared(
+    const PublisherRoute & sub_ids,
     std::unique_ptr<MessageT, Deleter> message,
-    typename allocator::AllocRebind<MessageT, Alloc>::allocator_type & allocator)
+    typename allocator::AllocRebind<MessageT, Alloc>::allocator_type & allocator,
+    MessagePool<MessageT, Alloc> * message_pool,
+    std::shared_ptr<const ROSMessageType> ros_message)
   {
     using MessageAllocTraits = allocator::AllocRebind<MessageT, Alloc>;
     using MessageAllocatorT = typename MessageAllocTraits::allocator_type;
 
-    std::shared_lock<std::shared_timed_mutex> lock(mutex_);
-
-    auto publisher_it = pub_to_subs_.find(intra_process_publisher_id);
-    if (publisher_it == pub_to_subs_.end()) {
-      // Publisher is either invalid or no longer exists.
-      RCLCPP_WARN(
-        rclcpp::get_logger("rclcpp"),
-        "Calling do_intra_process_publish for invalid or no longer existing publisher id");
-      return nullptr;
-    }
-    const auto & sub_ids = publisher_it->second;
+    ConvertedMessage<MessageT, Alloc, ROSMessageType> converted_message(std::move(ros_message));
 
     if (sub_ids.take_ownership_subscriptions.empty()) {
       // If there are no owning, just convert to shared.
       std::shared_ptr<MessageT> shared_msg = std::move(message);
       if (!sub_ids.take_shared_subscriptions.empty()) {
         this->template add_shared_msg_to_buffers<MessageT, Alloc, Deleter, ROSMessageType>(
-          shared_msg, sub_ids.take_shared_subscriptions);
+          shared_msg, sub_ids.take_shared_subscriptions, converted_message);
+      }
+      if (sub_ids.history != nullptr) {
+        this->template add_msg_to_history<MessageT, Alloc, Deleter, ROSMessageType>(
+          shared_msg, *sub_ids.history, allocator);
       }
       return shared_msg;
     } else {
       // Construct a new shared pointer from the message for the buffers that
       // do not require ownership and to return.
-      auto shared_msg = std::allocate_shared<MessageT, MessageAllocatorT>(allocator, *message);
+      auto shared_msg = message_pool != nullptr ?
+        message_pool->copy(*message) :
+        std::allocate_shared<MessageT, MessageAllocatorT>(allocator, *message);
 
       if (!sub_ids.take_shared_subscriptions.empty()) {
         this->template add_shared_msg_to_buffers<MessageT, Alloc, Deleter, ROSMessageType>(
           shared_msg,
-          sub_ids.take_shared_subscriptions);
+          sub_ids.take_shared_subscriptions,
+          converted_message);
       }
       if (!sub_ids.take_ownership_subscriptions.empty()) {
         this->template add_owned_msg_to_buffers<MessageT, Alloc, Deleter, ROSMessageType>(
           std::move(message),
           sub_ids.take_ownership_subscriptions,
-          allocator);
+          allocator,
+          converted_message);
+      }
+      if (sub_ids.history != nullptr) {
+        this->template add_msg_to_history<MessageT, Alloc, Deleter, ROSMessageType>(
+          shared_msg, *sub_ids.history, allocator);
       }
       return shared_msg;
     }
   }
 
-  /// Return true if the given rmw_gid_t matches any stored Publishers.
-  RCLCPP_PUBLIC
-  bool
-  matches_any_publishers(const rmw_gid_t * id) const;
+  /// Return an address unique to the given types, within a shared library.
+  template<
+    typename MessageT,
+    typename Alloc,
+    typename ROSMessageType>
+  static
+  const void *
+  get_types_tag()
+  {
+    static const char tag = 0;
+    return &tag;
+  }
 
-  /// Return the number of intraprocess subscriptions that are matched with a given publisher id.
-  RCLCPP_PUBLIC
-  size_t
-  get_subscription_count(uint64_t intra_process_publisher_id) const;
+  /// Cast the subscription to the buffers receiving messages of the given types.
+  template<
+    typename MessageT,
+    typename Alloc,
+    typename ROSMessageType>
+  static
+  TypedSubscription
+  resolve_typed_subscription(rclcpp::experimental::SubscriptionIntraProcessBase & subscription)
+  {
+    using ROSMessageTypeAllocatorTraits = allocator::AllocRebind<ROSMessageType, Alloc>;
+    using ROSMessageTypeAllocator = typename ROSMessageTypeAllocatorTraits::allocator_type;
+    using ROSMessageTypeDeleter = allocator::Deleter<ROSMessageTypeAllocator, ROSMessageType>;
 
-  RCLCPP_PUBLIC
-  rclcpp::experimental::SubscriptionIntraProcessBase::SharedPtr
-  get_subscription_intra_process(uint64_t intra_process_subscription_id);
+    using PublishedType = typename rclcpp::TypeAdapter<MessageT>::custom_type;
+    using PublishedTypeAllocatorTraits = allocator::AllocRebind<PublishedType, Alloc>;
+    using PublishedTypeAllocator = typename PublishedTypeAllocatorTraits::allocator_type;
+    using PublishedTypeDeleter = allocator::Deleter<PublishedTypeAllocator, PublishedType>;
 
-private:
-  struct SplittedSubscriptions
+    TypedSubscription typed_subscription;
+    typed_subscription.types_tag = get_types_tag<MessageT, Alloc, ROSMessageType>();
+    typed_subscription.buffer_subscription = dynamic_cast<
+      rclcpp::experimental::SubscriptionIntraProcessBuffer<PublishedType,
+      PublishedTypeAllocator, PublishedTypeDeleter, ROSMessageType> *>(&subscription);
+    typed_subscription.ros_message_subscription = dynamic_cast<
+      rclcpp::experimental::SubscriptionROSMsgIntraProcessBuffer<ROSMessageType,
+      ROSMessageTypeAllocator, ROSMessageTypeDeleter> *>(&subscription);
+    typed_subscription.serialized_subscription = dynamic_cast<
+      rclcpp::experimental::SubscriptionIntraProcessSerialized *>(&subscription);
+    return typed_subscription;
+  }
+
+  /// Return the subscription cast for the given types, casting it now if it wasn't.
+  template<
+    typename MessageT,
+    typename Alloc,
+    typename ROSMessageType>
+  static
+  TypedSubscription
+  get_typed_subscription(
+    const RoutedSubscription & routed_subscription,
+    rclcpp::experimental::SubscriptionIntraProcessBase & subscription)
   {
-    std::vector<uint64_t> take_shared_subscriptions;
-    std::vector<uint64_t> take_ownership_subscriptions;
-  };
+    const void * types_tag = get_types_tag<MessageT, Alloc, ROSMessageType>();
+    for (const auto & typed_subscription : routed_subscription.typed_subscriptions) {
+      if (typed_subscription.types_tag == types_tag) {
+        return typed_subscription;
+      }
+    }
+    // The publisher was registered without its types
+    return resolve_typed_subscription<MessageT, Alloc, ROSMessageType>(subscription);
+  }
 
-  using SubscriptionMap =
-    std::unordered_map<uint64_t, rclcpp::experimental::SubscriptionIntraProcessBase::WeakPtr>;
+  RCLCPP_PUBLIC
+  uint64_t
+  add_publisher_with_resolver(
+    rclcpp::PublisherBase::SharedPtr publisher,
+    SubscriptionResolver resolver,
+    bool serialized = false);
 
-  using PublisherMap =
-    std::unordered_map<uint64_t, rclcpp::PublisherBase::WeakPtr>;
+  /// Give the history of a publisher to a subscription, mutex_ must be locked exclusively.
+  RCLCPP_PUBLIC
+  void
+  replay_history(
+    uint64_t pub_id,
+    const rclcpp::experimental::SubscriptionIntraProcessBase::SharedPtr & subscription);
 
-  using PublisherToSubscriptionIdsMap =
-    std::unordered_map<uint64_t, SplittedSubscriptions>;
+  /// Replace the routing snapshot after a change, mutex_ must be locked exclusively.
+  RCLCPP_PUBLIC
+  void
+  update_routing_snapshot();
 
   RCLCPP_PUBLIC
   static
@@ -334,9 +999,65 @@ private:
   RCLCPP_PUBLIC
   bool
   can_communicate(
+    uint64_t pub_id,
     rclcpp::PublisherBase::SharedPtr pub,
     rclcpp::experimental::SubscriptionIntraProcessBase::SharedPtr sub) const;
 
+  /// Keep a published message in the history of a transient local publisher.
+  template<
+    typename MessageT,
+    typename Alloc,
+    typename Deleter,
+    typename ROSMessageType>
+  void
+  add_msg_to_history(
+    std::shared_ptr<const MessageT> message,
+    PublisherHistory & history,
+    typename allocator::AllocRebind<MessageT, Alloc>::allocator_type & allocator)
+  {
+    std::lock_guard<std::mutex> lock(history.mutex);
+    if (history.entries.size() >= history.depth) {
+      history.entries.pop_front();
+    }
+    history.entries.push_back(
+      HistoryEntry{
+        std::move(message),
+        &IntraProcessManager::replay_message<MessageT, Alloc, Deleter, ROSMessageType>,
+        &allocator});
+  }
+
+  /// Give a message of the history to a subscription, copying it if it takes ownership.
+  template<
+    typename MessageT,
+    typename Alloc,
+    typename Deleter,
+    typename ROSMessageType>
+  void
+  replay_message(
+    const HistoryEntry & entry,
+    const rclcpp::experimental::SubscriptionIntraProcessBase::SharedPtr & subscription)
+  {
+    using MessageAllocTraits = allocator::AllocRebind<MessageT, Alloc>;
+    using MessageAllocatorT = typename MessageAllocTraits::allocator_type;
+
+    auto message = std::static_pointer_cast<const MessageT>(entry.message);
+    RoutedSubscriptions subscriptions{RoutedSubscription{subscription, {}}};
+    ConvertedMessage<MessageT, Alloc, ROSMessageType> converted_message;
+    if (subscription->use_take_shared_method()) {
+      this->template add_shared_msg_to_buffers<MessageT, Alloc, Deleter, ROSMessageType>(
+        std::move(message), subscriptions, converted_message);
+      return;
+    }
+    auto & allocator = *static_cast<MessageAllocatorT *>(entry.allocator);
+    Deleter deleter;
+    allocator::set_allocator_for_deleter(&deleter, &allocator);
+    auto ptr = MessageAllocTraits::allocate(allocator, 1);
+    MessageAllocTraits::construct(allocator, ptr, *message);
+    this->template add_owned_msg_to_buffers<MessageT, Alloc, Deleter, ROSMessageType>(
+      std::unique_ptr<MessageT, Deleter>(ptr, deleter), subscriptions, allocator,
+      converted_message);
+  }
+
   template<
     typename MessageT,
     typename Alloc,
@@ -345,7 +1066,8 @@ private:
   void
   add_shared_msg_to_buffers(
     std::shared_ptr<const MessageT> message,
-    std::vector<uint64_t> subscription_ids)
+    const RoutedSubscriptions & subscriptions,
+    ConvertedMessage<MessageT, Alloc, ROSMessageType> & converted_message)
   {
     using ROSMessageTypeAllocatorTraits = allocator::AllocRebind<ROSMessageType, Alloc>;
     using ROSMessageTypeAllocator = typename ROSMessageTypeAllocatorTraits::allocator_type;
@@ -356,30 +1078,50 @@ private:
     using PublishedTypeAllocator = typename PublishedTypeAllocatorTraits::allocator_type;
     using PublishedTypeDeleter = allocator::Deleter<PublishedTypeAllocator, PublishedType>;
 
-    for (auto id : subscription_ids) {
-      auto subscription_it = subscriptions_.find(id);
-      if (subscription_it == subscriptions_.end()) {
-        throw std::runtime_error("subscription has unexpectedly gone out of scope");
-      }
-      auto subscription_base = subscription_it->second.lock();
+    // Serialized once for all the subscriptions of serialized messages
+    LazySerializedMessage::SharedPtr serialized_message;
+
+    for (const auto & routed_subscription : subscriptions) {
+      auto subscription_base = routed_subscription.subscription.lock();
       if (subscription_base == nullptr) {
-        subscriptions_.erase(id);
+        continue;
+      }
+      if (
+        subscription_base->drop_by_pause() ||
+        drop_by_content_filter(*subscription_base, *message, converted_message) ||
+        subscription_base->drop_by_rate_limit())
+      {
+        continue;
+      }
+      const TypedSubscription typed_subscription =
+        get_typed_subscription<MessageT, Alloc, ROSMessageType>(
+        routed_subscription, *subscription_base);
+
+      auto serialized_subscription = static_cast<
+        rclcpp::experimental::SubscriptionIntraProcessSerialized *>(
+        typed_subscription.serialized_subscription);
+      if (serialized_subscription != nullptr) {
+        if (!serialized_message) {
+          serialized_message =
+            LazySerializedMessage::make_from_message<MessageT, ROSMessageType>(message);
+        }
+        serialized_subscription->provide_serialized_message(serialized_message);
         continue;
       }
 
-      auto subscription = std::dynamic_pointer_cast<
+      auto subscription = static_cast<
         rclcpp::experimental::SubscriptionIntraProcessBuffer<PublishedType,
-        PublishedTypeAllocator, PublishedTypeDeleter, ROSMessageType>
-        >(subscription_base);
+        PublishedTypeAllocator, PublishedTypeDeleter, ROSMessageType> *>(
+        typed_subscription.buffer_subscription);
       if (subscription != nullptr) {
         subscription->provide_intra_process_data(message);
         continue;
       }
 
-      auto ros_message_subscription = std::dynamic_pointer_cast<
+      auto ros_message_subscription = static_cast<
         rclcpp::experimental::SubscriptionROSMsgIntraProcessBuffer<ROSMessageType,
-        ROSMessageTypeAllocator, ROSMessageTypeDeleter>
-        >(subscription_base);
+        ROSMessageTypeAllocator, ROSMessageTypeDeleter> *>(
+        typed_subscription.ros_message_subscription);
       if (nullptr == ros_message_subscription) {
         throw std::runtime_error(
                 "failed to dynamic cast SubscriptionIntraProcessBase to "
@@ -389,25 +1131,12 @@ private:
                 "subscription use different allocator types, which is not supported");
       }
 
-      if constexpr (rclcpp::TypeAdapter<MessageT>::is_specialized::value) {
-        ROSMessageType ros_msg;
-        rclcpp::TypeAdapter<MessageT>::convert_to_ros_message(*message, ros_msg);
+      if constexpr (ConvertedMessage<MessageT, Alloc, ROSMessageType>::is_converted) {
+        // Converted once for all the subscriptions of the ROS message type
         ros_message_subscription->provide_intra_process_message(
-          std::make_shared<ROSMessageType>(ros_msg));
-      } else {
-        if constexpr (std::is_same<MessageT, ROSMessageType>::value) {
-          ros_message_subscription->provide_intra_process_message(message);
-        } else {
-          if constexpr (std::is_same<typename rclcpp::TypeAdapter<MessageT,
-            ROSMessageType>::ros_message_type, ROSMessageType>::value)
-          {
-            ROSMessageType ros_msg;
-            rclcpp::TypeAdapter<MessageT, ROSMessageType>::convert_to_ros_message(
-              *message, ros_msg);
-            ros_message_subscription->provide_intra_process_message(
-              std::make_shared<ROSMessageType>(ros_msg));
-          }
-        }
+          converted_message.get_shared(*message));
+      } else if constexpr (std::is_same<MessageT, ROSMessageType>::value) {
+        ros_message_subscription->provide_intra_process_message(message);
       }
     }
   }
@@ -420,8 +1149,9 @@ private:
   void
   add_owned_msg_to_buffers(
     std::unique_ptr<MessageT, Deleter> message,
-    std::vector<uint64_t> subscription_ids,
-    typename allocator::AllocRebind<MessageT, Alloc>::allocator_type & allocator)
+    const RoutedSubscriptions & subscriptions,
+    typename allocator::AllocRebind<MessageT, Alloc>::allocator_type & allocator,
+    ConvertedMessage<MessageT, Alloc, ROSMessageType> & converted_message)
   {
     using MessageAllocTraits = allocator::AllocRebind<MessageT, Alloc>;
     using MessageUniquePtr = std::unique_ptr<MessageT, Deleter>;
@@ -435,23 +1165,50 @@ private:
     using PublishedTypeAllocator = typename PublishedTypeAllocatorTraits::allocator_type;
     using PublishedTypeDeleter = allocator::Deleter<PublishedTypeAllocator, PublishedType>;
 
-    for (auto it = subscription_ids.begin(); it != subscription_ids.end(); it++) {
-      auto subscription_it = subscriptions_.find(*it);
-      if (subscription_it == subscriptions_.end()) {
-        throw std::runtime_error("subscription has unexpectedly gone out of scope");
-      }
-      auto subscription_base = subscription_it->second.lock();
+    // Serialized once for all the subscriptions of serialized messages
+    LazySerializedMessage::SharedPtr serialized_message;
+
+    for (auto it = subscriptions.begin(); it != subscriptions.end(); it++) {
+      auto subscription_base = it->subscription.lock();
       if (subscription_base == nullptr) {
-        subscriptions_.erase(subscription_it);
+        continue;
+      }
+      if (
+        subscription_base->drop_by_pause() ||
+        drop_by_content_filter(*subscription_base, *message, converted_message) ||
+        subscription_base->drop_by_rate_limit())
+      {
+        continue;
+      }
+      const TypedSubscription typed_subscription =
+        get_typed_subscription<MessageT, Alloc, ROSMessageType>(*it, *subscription_base);
+
+      auto serialized_subscription = static_cast<
+        rclcpp::experimental::SubscriptionIntraProcessSerialized *>(
+        typed_subscription.serialized_subscription);
+      if (serialized_subscription != nullptr) {
+        if (!serialized_message) {
+          std::shared_ptr<const MessageT> shared_message;
+          if (std::next(it) == subscriptions.end()) {
+            // If this is the last subscription, give up ownership
+            shared_message = std::move(message);
+          } else {
+            shared_message = std::allocate_shared<MessageT>(allocator, *message);
+          }
+          serialized_message =
+            LazySerializedMessage::make_from_message<MessageT, ROSMessageType>(
+            std::move(shared_message));
+        }
+        serialized_subscription->provide_serialized_message(serialized_message);
         continue;
       }
 
-      auto subscription = std::dynamic_pointer_cast<
+      auto subscription = static_cast<
         rclcpp::experimental::SubscriptionIntraProcessBuffer<PublishedType,
-        PublishedTypeAllocator, PublishedTypeDeleter, ROSMessageType>
-        >(subscription_base);
+        PublishedTypeAllocator, PublishedTypeDeleter, ROSMessageType> *>(
+        typed_subscription.buffer_subscription);
       if (subscription != nullptr) {
-        if (std::next(it) == subscription_ids.end()) {
+        if (std::next(it) == subscriptions.end()) {
           // If this is the last subscription, give up ownership
           subscription->provide_intra_process_data(std::move(message));
         } else {
@@ -466,10 +1223,10 @@ private:
         continue;
       }
 
-      auto ros_message_subscription = std::dynamic_pointer_cast<
+      auto ros_message_subscription = static_cast<
         rclcpp::experimental::SubscriptionROSMsgIntraProcessBuffer<ROSMessageType,
-        ROSMessageTypeAllocator, ROSMessageTypeDeleter>
-        >(subscription_base);
+        ROSMessageTypeAllocator, ROSMessageTypeDeleter> *>(
+        typed_subscription.ros_message_subscription);
       if (nullptr == ros_message_subscription) {
         throw std::runtime_error(
                 "failed to dynamic cast SubscriptionIntraProcessBase to "
@@ -479,18 +1236,15 @@ private:
                 "subscription use different allocator types, which is not supported");
       }
 
-      if constexpr (rclcpp::TypeAdapter<MessageT>::is_specialized::value) {
+      if constexpr (ConvertedMessage<MessageT, Alloc, ROSMessageType>::is_converted) {
+        // Converted once for all the subscriptions of the ROS message type
         ROSMessageTypeAllocator ros_message_alloc(allocator);
-        auto ptr = ros_message_alloc.allocate(1);
-        ros_message_alloc.construct(ptr);
-        ROSMessageTypeDeleter deleter;
-        allocator::set_allocator_for_deleter(&deleter, &allocator);
-        rclcpp::TypeAdapter<MessageT>::convert_to_ros_message(*message, *ptr);
-        auto ros_msg = std::unique_ptr<ROSMessageType, ROSMessageTypeDeleter>(ptr, deleter);
-        ros_message_subscription->provide_intra_process_message(std::move(ros_msg));
+        ros_message_subscription->provide_intra_process_message(
+          converted_message.take_unique(
+            *message, ros_message_alloc, std::next(it) == subscriptions.end()));
       } else {
         if constexpr (std::is_same<MessageT, ROSMessageType>::value) {
-          if (std::next(it) == subscription_ids.end()) {
+          if (std::next(it) == subscriptions.end()) {
             // If this is the last subscription, give up ownership
             ros_message_subscription->provide_intra_process_message(std::move(message));
           } else {
@@ -511,8 +1265,17 @@ private:
   PublisherToSubscriptionIdsMap pub_to_subs_;
   SubscriptionMap subscriptions_;
   PublisherMap publishers_;
+  /// Casts of the subscriptions for the publishers registered with their types.
+  std::unordered_map<uint64_t, SubscriptionResolver> publisher_resolvers_;
+  /// Ids of the publishers registered with add_serialized_publisher().
+  std::unordered_set<uint64_t> serialized_publishers_;
+  /// Histories of the transient local publishers.
+  std::unordered_map<uint64_t, std::shared_ptr<PublisherHistory>> publisher_histories_;
 
   mutable std::shared_timed_mutex mutex_;
+
+  /// Loaded by the publishers without locking mutex_, see rclcpp::detail::SnapshotPtr.
+  rclcpp::detail::SnapshotPtr<RoutingSnapshot> routing_snapshot_;
 };
 
 }  // namespace experimental
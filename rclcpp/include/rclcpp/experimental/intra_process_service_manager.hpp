@@ -0,0 +1,122 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXPERIMENTAL__INTRA_PROCESS_SERVICE_MANAGER_HPP_
+#define RCLCPP__EXPERIMENTAL__INTRA_PROCESS_SERVICE_MANAGER_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "rclcpp/experimental/intra_process_service_waitable.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace experimental
+{
+
+/// Keep track of the intra-process services of a context, for the clients to find them.
+/**
+ * This is the counterpart of the IntraProcessManager for services, there is one per context,
+ * see rclcpp::Context::get_sub_context().
+ *
+ * A client of a node using intra-process communication looks up the service by name before
+ * each request.
+ * When a service of the same type is registered in the same context, the request and the
+ * response are given by pointer, without going through the middleware.
+ * Otherwise, e.g. when the service is in another process, the request goes through the
+ * middleware as usual.
+ *
+ * When several services with the same name are registered, the oldest one gets the requests.
+ * The middleware doesn't define which one answers either.
+ *
+ * All public member functions are thread-safe.
+ */
+class IntraProcessServiceManager
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(IntraProcessServiceManager)
+
+  RCLCPP_PUBLIC
+  IntraProcessServiceManager() = default;
+
+  RCLCPP_PUBLIC
+  virtual ~IntraProcessServiceManager() = default;
+
+  /// Register the intra-process part of a service.
+  /**
+   * \param[in] service the intra-process part of the service.
+   * \return an id identifying the service, to remove it.
+   */
+  RCLCPP_PUBLIC
+  uint64_t
+  add_service(IntraProcessServiceWaitable::SharedPtr service);
+
+  /// Unregister the intra-process part of a service.
+  /**
+   * \param[in] intra_process_service_id the id returned by add_service().
+   */
+  RCLCPP_PUBLIC
+  void
+  remove_service(uint64_t intra_process_service_id);
+
+  /// Return the intra-process part of the service with this name, if any.
+  /**
+   * \param[in] service_name the fully qualified name of the service.
+   * \return the oldest service registered with this name, or nullptr.
+   */
+  RCLCPP_PUBLIC
+  IntraProcessServiceWaitable::SharedPtr
+  get_service(const std::string & service_name) const;
+
+  /// Return a number changing each time a service is added or removed.
+  /**
+   * The clients can keep the service they looked up until this number changes.
+   */
+  RCLCPP_PUBLIC
+  uint64_t
+  get_generation() const;
+
+  /// Return a new id, identifying a client in the headers of its intra-process requests.
+  RCLCPP_PUBLIC
+  uint64_t
+  reserve_client_id();
+
+private:
+  RCLCPP_DISABLE_COPY(IntraProcessServiceManager)
+
+  struct ServiceInfo
+  {
+    uint64_t id;
+    IntraProcessServiceWaitable::WeakPtr service;
+  };
+
+  mutable std::shared_timed_mutex mutex_;
+  std::unordered_map<std::string, std::vector<ServiceInfo>> services_;
+
+  uint64_t next_service_id_{1};
+  std::atomic<uint64_t> next_client_id_{1};
+  std::atomic<uint64_t> generation_{0};
+};
+
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__INTRA_PROCESS_SERVICE_MANAGER_HPP_
@@ -0,0 +1,128 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXPERIMENTAL__INTRA_PROCESS_SERVICE_WAITABLE_HPP_
+#define RCLCPP__EXPERIMENTAL__INTRA_PROCESS_SERVICE_WAITABLE_HPP_
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "rcl/wait.h"
+
+#include "rclcpp/context.hpp"
+#include "rclcpp/guard_condition.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/visibility_control.hpp"
+#include "rclcpp/waitable.hpp"
+
+namespace rclcpp
+{
+namespace experimental
+{
+
+/// Waitable of the intra-process part of a service or of a client.
+/**
+ * The requests, or the responses, are queued by the other end and the guard condition is
+ * triggered for each of them, so the executor takes and executes them one at a time.
+ */
+class IntraProcessServiceWaitable : public rclcpp::Waitable
+{
+public:
+  RCLCPP_SMART_PTR_ALIASES_ONLY(IntraProcessServiceWaitable)
+
+  enum class EntityType : std::size_t
+  {
+    Service,
+    Client,
+  };
+
+  RCLCPP_PUBLIC
+  IntraProcessServiceWaitable(
+    rclcpp::Context::SharedPtr context,
+    const std::string & service_name,
+    EntityType entity_type);
+
+  RCLCPP_PUBLIC
+  virtual ~IntraProcessServiceWaitable() = default;
+
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_ready_guard_conditions() override {return 1;}
+
+  RCLCPP_PUBLIC
+  void
+  add_to_wait_set(rcl_wait_set_t * wait_set) override;
+
+  bool
+  is_ready(rcl_wait_set_t * wait_set) override = 0;
+
+  std::shared_ptr<void>
+  take_data() override = 0;
+
+  std::shared_ptr<void>
+  take_data_by_entity_id(size_t id) override
+  {
+    (void)id;
+    return take_data();
+  }
+
+  void
+  execute(std::shared_ptr<void> & data) override = 0;
+
+  /// Return the fully qualified name of the service.
+  RCLCPP_PUBLIC
+  const char *
+  get_service_name() const;
+
+  /// Set a callback to be called each time a request, or a response, is queued.
+  /**
+   * \sa rclcpp::SubscriptionIntraProcessBase::set_on_ready_callback
+   *
+   * \param[in] callback functor to be called when a new request or response is queued.
+   * \throws std::invalid_argument if the callback is not callable.
+   */
+  RCLCPP_PUBLIC
+  void
+  set_on_ready_callback(std::function<void(size_t, int)> callback) override;
+
+  /// Unset the callback registered for new requests or responses, if any.
+  RCLCPP_PUBLIC
+  void
+  clear_on_ready_callback() override;
+
+protected:
+  /// Wake up the executor after queuing a request or a response.
+  RCLCPP_PUBLIC
+  void
+  notify_ready();
+
+  rclcpp::GuardCondition gc_;
+
+private:
+  RCLCPP_DISABLE_COPY(IntraProcessServiceWaitable)
+
+  std::string service_name_;
+  EntityType entity_type_;
+
+  std::mutex callback_mutex_;
+  std::function<void(size_t)> on_ready_callback_{nullptr};
+  size_t unread_count_{0};
+};
+
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__INTRA_PROCESS_SERVICE_WAITABLE_HPP_
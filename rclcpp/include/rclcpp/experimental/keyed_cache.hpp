@@ -0,0 +1,426 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__EXPERIMENTAL__KEYED_CACHE_HPP_
+#define RCLCPP__EXPERIMENTAL__KEYED_CACHE_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "rcl/wait.h"
+
+#include "rclcpp/create_subscription.hpp"
+#include "rclcpp/detail/add_guard_condition_to_rcl_wait_set.hpp"
+#include "rclcpp/guard_condition.hpp"
+#include "rclcpp/logging.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/qos.hpp"
+#include "rclcpp/subscription_base.hpp"
+#include "rclcpp/subscription_options.hpp"
+#include "rclcpp/waitable.hpp"
+
+#include "rmw/impl/cpp/demangle.hpp"
+
+namespace rclcpp
+{
+namespace experimental
+{
+
+/// Options of a KeyedCache.
+struct KeyedCacheOptions
+{
+  /// Maximum number of keys cached, unbounded if zero.
+  /**
+   * The least recently updated key is evicted to cache a new one beyond this size.
+   */
+  size_t max_keys = 0;
+  /// Age after which a key not updated is evicted, never if zero.
+  std::chrono::nanoseconds max_age = std::chrono::nanoseconds(0);
+};
+
+/// Cache of the latest message per key, for the topics multiplexing several entities.
+/**
+ * The key of a message is given by a user extractor, e.g. the id of the robot it is about.
+ * Each message replaces the previous one of its key, and marks the key as changed.
+ *
+ * Instead of a callback per message, the changed keys are handled in batches: once added to
+ * an executor by subscribe(), the cache is a waitable calling the batch callback at most once
+ * per executor pass, with the latest message of each key changed since the previous call.
+ * Without a batch callback, the changed keys are polled with take_changed().
+ *
+ * The messages are kept as shared pointers to const, so the intra-process messages aren't
+ * copied, and the keys are evicted by size and age, see KeyedCacheOptions.
+ * All public member functions are thread-safe, the batch callback isn't called with the lock
+ * held.
+ */
+template<typename MessageT, typename KeyT, typename HashT = std::hash<KeyT>>
+class KeyedCache
+  : public rclcpp::Waitable,
+  public std::enable_shared_from_this<KeyedCache<MessageT, KeyT, HashT>>
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(KeyedCache)
+
+  enum class EntityType : std::size_t
+  {
+    ChangedKeys,
+  };
+
+  using KeyExtractor = std::function<KeyT(const MessageT &)>;
+  using Entry = std::pair<KeyT, std::shared_ptr<const MessageT>>;
+  using BatchCallback = std::function<void (const std::vector<Entry> &)>;
+
+  /// Create a cache, calling the batch callback with the changed keys if it isn't empty.
+  /**
+   * \throws std::invalid_argument if the key extractor is empty.
+   */
+  KeyedCache(
+    const KeyedCacheOptions & options,
+    KeyExtractor key_extractor,
+    BatchCallback batch_callback = nullptr)
+  : options_(options),
+    key_extractor_(std::move(key_extractor)),
+    batch_callback_(std::move(batch_callback))
+  {
+    if (!key_extractor_) {
+      throw std::invalid_argument("key extractor must not be empty");
+    }
+  }
+
+  virtual ~KeyedCache() = default;
+
+  /// Subscribe to a topic, adding its messages to the cache.
+  /**
+   * The subscription is kept by the cache.
+   * With a batch callback, the cache is also added to the node as a waitable, in the callback
+   * group of the subscription options, so the executor spinning the subscription calls it.
+   *
+   * \return the subscription created.
+   */
+  template<typename NodeT>
+  rclcpp::SubscriptionBase::SharedPtr
+  subscribe(
+    NodeT & node,
+    const std::string & topic_name,
+    const rclcpp::QoS & qos,
+    const rclcpp::SubscriptionOptions & options = rclcpp::SubscriptionOptions())
+  {
+    std::weak_ptr<KeyedCache> weak_this = this->shared_from_this();
+    auto subscription = rclcpp::create_subscription<MessageT>(
+      node, topic_name, qos,
+      [weak_this](std::shared_ptr<const MessageT> message) {
+        auto cache = weak_this.lock();
+        if (cache) {
+          cache->add_message(std::move(message));
+        }
+      },
+      options);
+    bool add_waitable = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      subscriptions_.push_back(subscription);
+      if (batch_callback_ && !gc_) {
+        gc_ = std::make_shared<rclcpp::GuardCondition>(
+          node.get_node_base_interface()->get_context());
+        // One wake up per executor pass is enough, the changes are batched anyway
+        gc_->set_trigger_coalescing(true);
+        add_waitable = true;
+        if (!changed_keys_.empty()) {
+          gc_->trigger();
+        }
+      }
+    }
+    if (add_waitable) {
+      node.get_node_waitables_interface()->add_waitable(
+        this->shared_from_this(), options.callback_group);
+    }
+    return subscription;
+  }
+
+  /// Add a message, replacing the latest one of its key.
+  /**
+   * \throws std::invalid_argument if the message is nullptr.
+   */
+  void
+  add_message(std::shared_ptr<const MessageT> message)
+  {
+    if (!message) {
+      throw std::invalid_argument("message cannot be nullptr");
+    }
+    KeyT key = key_extractor_(*message);
+    const auto now = std::chrono::steady_clock::now();
+    bool notify = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = entries_.find(key);
+      if (it == entries_.end()) {
+        order_.push_back(key);
+        it = entries_.emplace(std::move(key), CachedEntry()).first;
+        it->second.position = std::prev(order_.end());
+      } else {
+        // The most recently updated key is at the back
+        order_.splice(order_.end(), order_, it->second.position);
+      }
+      it->second.message = std::move(message);
+      it->second.updated = now;
+      if (!it->second.changed) {
+        it->second.changed = true;
+        // The executor is woken up by the first change of a batch only
+        notify = changed_keys_.empty();
+        changed_keys_.push_back(it->first);
+      }
+      evict(now);
+      notify = notify && gc_;
+      if (notify) {
+        gc_->trigger();
+      }
+    }
+    if (notify) {
+      std::lock_guard<std::mutex> lock(callback_mutex_);
+      if (on_ready_callback_) {
+        on_ready_callback_(1);
+      } else {
+        unread_count_++;
+      }
+    }
+  }
+
+  /// Return the latest message of a key, nullptr if it isn't cached.
+  std::shared_ptr<const MessageT>
+  get(const KeyT & key) const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    return it == entries_.end() ? nullptr : it->second.message;
+  }
+
+  /// Return the latest message of each key changed since the previous call, in update order.
+  std::vector<Entry>
+  take_changed()
+  {
+    std::vector<Entry> changed;
+    std::lock_guard<std::mutex> lock(mutex_);
+    evict(std::chrono::steady_clock::now());
+    changed.reserve(changed_keys_.size());
+    for (const auto & key : changed_keys_) {
+      // The keys evicted, or changed again after an eviction, are skipped
+      auto it = entries_.find(key);
+      if (it != entries_.end() && it->second.changed) {
+        it->second.changed = false;
+        changed.emplace_back(it->first, it->second.message);
+      }
+    }
+    changed_keys_.clear();
+    return changed;
+  }
+
+  /// Remove a key from the cache, return false if it wasn't cached.
+  bool
+  erase(const KeyT & key)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+      return false;
+    }
+    order_.erase(it->second.position);
+    entries_.erase(it);
+    return true;
+  }
+
+  /// Remove all the keys from the cache.
+  void
+  clear()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    order_.clear();
+    changed_keys_.clear();
+  }
+
+  /// Return the number of keys cached.
+  size_t
+  size() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+  }
+
+  /// Return the number of keys evicted by size or age.
+  uint64_t
+  get_evicted_count() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return evicted_count_;
+  }
+
+  size_t
+  get_number_of_ready_guard_conditions() override {return 1;}
+
+  void
+  add_to_wait_set(rcl_wait_set_t * wait_set) override
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    rclcpp::detail::add_guard_condition_to_rcl_wait_set(*wait_set, *gc_);
+  }
+
+  /// Return true if keys changed since the previous batch.
+  bool
+  is_ready(rcl_wait_set_t * wait_set) override
+  {
+    (void)wait_set;
+    std::lock_guard<std::mutex> lock(mutex_);
+    return !changed_keys_.empty();
+  }
+
+  std::shared_ptr<void>
+  take_data() override
+  {
+    auto changed = take_changed();
+    if (changed.empty()) {
+      return nullptr;
+    }
+    return std::make_shared<std::vector<Entry>>(std::move(changed));
+  }
+
+  std::shared_ptr<void>
+  take_data_by_entity_id(size_t id) override
+  {
+    (void)id;
+    return take_data();
+  }
+
+  /// Call the batch callback with the changed keys taken.
+  void
+  execute(std::shared_ptr<void> & data) override
+  {
+    if (!data || !batch_callback_) {
+      return;
+    }
+    batch_callback_(*std::static_pointer_cast<std::vector<Entry>>(data));
+  }
+
+  /// Set a callback to be called each time keys change after a batch was taken.
+  /**
+   * \sa rclcpp::SubscriptionIntraProcessBase::set_on_ready_callback
+   *
+   * \param[in] callback functor to be called when keys change.
+   * \throws std::invalid_argument if the callback is not callable.
+   */
+  void
+  set_on_ready_callback(std::function<void(size_t, int)> callback) override
+  {
+    if (!callback) {
+      throw std::invalid_argument(
+              "The callback passed to set_on_ready_callback "
+              "is not callable.");
+    }
+
+    // Note: we bind the int identifier argument to this waitable's entity type
+    auto new_callback =
+      [callback, this](size_t number_of_events) {
+        try {
+          callback(number_of_events, static_cast<int>(EntityType::ChangedKeys));
+        } catch (const std::exception & exception) {
+          RCLCPP_ERROR_STREAM(
+            rclcpp::get_logger("rclcpp"),
+            "rclcpp::experimental::KeyedCache@" << this <<
+              " caught " << rmw::impl::cpp::demangle(exception) <<
+              " exception in user-provided callback for the 'on ready' callback: " <<
+              exception.what());
+        } catch (...) {
+          RCLCPP_ERROR_STREAM(
+            rclcpp::get_logger("rclcpp"),
+            "rclcpp::experimental::KeyedCache@" << this <<
+              " caught unhandled exception in user-provided callback " <<
+              "for the 'on ready' callback");
+        }
+      };
+
+    std::lock_guard<std::mutex> lock(callback_mutex_);
+    on_ready_callback_ = new_callback;
+    if (unread_count_ > 0) {
+      on_ready_callback_(unread_count_);
+      unread_count_ = 0;
+    }
+  }
+
+  /// Unset the callback registered for the changed keys, if any.
+  void
+  clear_on_ready_callback() override
+  {
+    std::lock_guard<std::mutex> lock(callback_mutex_);
+    on_ready_callback_ = nullptr;
+  }
+
+private:
+  struct CachedEntry
+  {
+    std::shared_ptr<const MessageT> message;
+    typename std::list<KeyT>::iterator position;
+    std::chrono::steady_clock::time_point updated;
+    bool changed = false;
+  };
+
+  /// Evict the keys beyond the maximum number of keys or age, the lock must be held.
+  void
+  evict(std::chrono::steady_clock::time_point now)
+  {
+    while (!order_.empty()) {
+      auto it = entries_.find(order_.front());
+      const bool too_many = options_.max_keys > 0 && entries_.size() > options_.max_keys;
+      const bool too_old =
+        options_.max_age.count() > 0 && now - it->second.updated > options_.max_age;
+      if (!too_many && !too_old) {
+        break;
+      }
+      entries_.erase(it);
+      order_.pop_front();
+      evicted_count_++;
+    }
+  }
+
+  const KeyedCacheOptions options_;
+  const KeyExtractor key_extractor_;
+  const BatchCallback batch_callback_;
+
+  mutable std::mutex mutex_;
+  std::unordered_map<KeyT, CachedEntry, HashT> entries_;
+  // The keys from the least to the most recently updated
+  std::list<KeyT> order_;
+  std::vector<KeyT> changed_keys_;
+  uint64_t evicted_count_{0};
+  std::shared_ptr<rclcpp::GuardCondition> gc_;
+  std::vector<rclcpp::SubscriptionBase::SharedPtr> subscriptions_;
+
+  std::mutex callback_mutex_;
+  std::function<void(size_t)> on_ready_callback_{nullptr};
+  size_t unread_count_{0};
+};
+
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__KEYED_CACHE_HPP_
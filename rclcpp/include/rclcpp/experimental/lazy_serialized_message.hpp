@@ -0,0 +1,127 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXPERIMENTAL__LAZY_SERIALIZED_MESSAGE_HPP_
+#define RCLCPP__EXPERIMENTAL__LAZY_SERIALIZED_MESSAGE_HPP_
+
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/serialization.hpp"
+#include "rclcpp/serialized_message.hpp"
+#include "rclcpp/type_adapter.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace experimental
+{
+
+/// Message given to the intra-process subscriptions of serialized messages.
+/**
+ * A message published by a typed publisher is serialized the first time a subscription
+ * gets it, and the serialized message is then shared by all the subscriptions.
+ * A message published by a generic publisher is already serialized.
+ *
+ * All public member functions are thread-safe.
+ */
+class LazySerializedMessage
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(LazySerializedMessage)
+
+  /// Wrap a message which is already serialized.
+  explicit LazySerializedMessage(std::shared_ptr<const rclcpp::SerializedMessage> message)
+  : serialized_message_(std::move(message)), serialize_(nullptr)
+  {}
+
+  /// Wrap a message of a typed publisher, serialized on first use.
+  /**
+   * \param message the message, of the published type or of the ROS message type.
+   */
+  template<typename MessageT, typename ROSMessageType>
+  static
+  SharedPtr
+  make_from_message(std::shared_ptr<const MessageT> message)
+  {
+    return SharedPtr(
+      new LazySerializedMessage(
+        std::move(message), &LazySerializedMessage::serialize<MessageT, ROSMessageType>));
+  }
+
+  /// Return the serialized message, serializing it if it wasn't yet.
+  /**
+   * \throws anything rclcpp::SerializationBase::serialize_message can throw.
+   */
+  std::shared_ptr<const rclcpp::SerializedMessage>
+  get_serialized_message()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!serialized_message_) {
+      auto serialized_message = std::make_shared<rclcpp::SerializedMessage>();
+      serialize_(message_.get(), *serialized_message);
+      serialized_message_ = std::move(serialized_message);
+      // The serialized message is all that's needed from now on
+      message_.reset();
+    }
+    return serialized_message_;
+  }
+
+private:
+  using SerializeFunction = void (*)(const void *, rclcpp::SerializedMessage &);
+
+  LazySerializedMessage(std::shared_ptr<const void> message, SerializeFunction serialize)
+  : message_(std::move(message)), serialize_(serialize)
+  {}
+
+  template<typename MessageT, typename ROSMessageType>
+  static
+  void
+  serialize(const void * message, rclcpp::SerializedMessage & serialized_message)
+  {
+    static const rclcpp::Serialization<ROSMessageType> serialization;
+    const auto & typed_message = *static_cast<const MessageT *>(message);
+    if constexpr (std::is_same<MessageT, ROSMessageType>::value) {
+      serialization.serialize_message(&typed_message, &serialized_message);
+    } else if constexpr (rclcpp::TypeAdapter<MessageT>::is_specialized::value) {
+      ROSMessageType ros_message;
+      rclcpp::TypeAdapter<MessageT>::convert_to_ros_message(typed_message, ros_message);
+      serialization.serialize_message(&ros_message, &serialized_message);
+    } else if constexpr (std::is_same<typename rclcpp::TypeAdapter<MessageT,
+      ROSMessageType>::ros_message_type, ROSMessageType>::value)
+    {
+      ROSMessageType ros_message;
+      rclcpp::TypeAdapter<MessageT, ROSMessageType>::convert_to_ros_message(
+        typed_message, ros_message);
+      serialization.serialize_message(&ros_message, &serialized_message);
+    } else {
+      (void) typed_message;
+      throw std::runtime_error("message type can't be converted to the ROS message type");
+    }
+  }
+
+  std::mutex mutex_;
+  std::shared_ptr<const void> message_;
+  std::shared_ptr<const rclcpp::SerializedMessage> serialized_message_;
+  const SerializeFunction serialize_;
+};
+
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__LAZY_SERIALIZED_MESSAGE_HPP_
@@ -0,0 +1,235 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXPERIMENTAL__MESSAGE_POOL_HPP_
+#define RCLCPP__EXPERIMENTAL__MESSAGE_POOL_HPP_
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/allocator/allocator_common.hpp"
+#include "rclcpp/macros.hpp"
+
+namespace rclcpp
+{
+namespace experimental
+{
+
+/// Statistics of a MessagePool.
+struct MessagePoolStatistics
+{
+  /// Maximum number of free messages kept by the pool.
+  size_t depth = 0;
+  /// Number of messages of the pool not released yet.
+  size_t in_use = 0;
+  /// Number of free messages kept by the pool.
+  size_t free = 0;
+  /// Highest number of messages in use at the same time.
+  size_t high_water_mark = 0;
+  /// Number of messages allocated because no free message was available.
+  size_t allocations = 0;
+  /// Number of recycled messages handed out, as copies or borrowed messages.
+  size_t reuses = 0;
+};
+
+/// Recycle the messages copied by the intra-process manager for its subscriptions.
+/**
+ * When a message is released by the last subscription holding it, it's kept by the pool,
+ * up to `depth` messages, instead of being deallocated.
+ * The next copy is assigned to a free message, so that the memory owned by the message,
+ * e.g. the data of a large point cloud, is reused when its size doesn't grow.
+ *
+ * The pool also lends messages to be filled by the user, see borrow().
+ *
+ * Messages which aren't copy assignable are always allocated.
+ * The messages released after the pool is destroyed are deallocated.
+ *
+ * All public member functions are thread-safe.
+ */
+template<typename MessageT, typename Alloc = std::allocator<void>>
+class MessagePool
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(MessagePool)
+
+  using MessageAllocTraits = allocator::AllocRebind<MessageT, Alloc>;
+  using MessageAllocatorT = typename MessageAllocTraits::allocator_type;
+
+  /// Create a pool keeping up to `depth` free messages.
+  /**
+   * \param depth the maximum number of free messages kept.
+   * \param allocator allocator of the messages.
+   * \throws std::invalid_argument if depth is 0.
+   */
+  explicit MessagePool(size_t depth, const MessageAllocatorT & allocator = MessageAllocatorT())
+  : state_(std::make_shared<State>(depth, allocator))
+  {
+    if (depth == 0) {
+      throw std::invalid_argument("message pool depth must be a positive, non-zero value");
+    }
+  }
+
+  /// Return a copy of the message, in a recycled message when one is free.
+  std::shared_ptr<MessageT>
+  copy(const MessageT & message)
+  {
+    MessageT * ptr = state_->acquire();
+    try {
+      if (ptr != nullptr) {
+        if constexpr (std::is_copy_assignable<MessageT>::value) {
+          *ptr = message;
+        }
+      } else {
+        ptr = MessageAllocTraits::allocate(state_->allocator, 1);
+        try {
+          MessageAllocTraits::construct(state_->allocator, ptr, message);
+        } catch (...) {
+          MessageAllocTraits::deallocate(state_->allocator, ptr, 1);
+          ptr = nullptr;
+          throw;
+        }
+      }
+    } catch (...) {
+      state_->release(ptr);
+      throw;
+    }
+    return std::shared_ptr<MessageT>(ptr, get_deleter());
+  }
+
+  /// Return a message to be filled by the caller, a recycled one when one is free.
+  /**
+   * A recycled message keeps the value it had when it was released, so that the memory it
+   * owns is reused, a new message is default constructed.
+   * The message goes back to the pool when the returned pointer is destroyed.
+   */
+  std::unique_ptr<MessageT, std::function<void(MessageT *)>>
+  borrow()
+  {
+    MessageT * ptr = state_->acquire();
+    if (ptr == nullptr) {
+      try {
+        ptr = MessageAllocTraits::allocate(state_->allocator, 1);
+        try {
+          MessageAllocTraits::construct(state_->allocator, ptr);
+        } catch (...) {
+          MessageAllocTraits::deallocate(state_->allocator, ptr, 1);
+          throw;
+        }
+      } catch (...) {
+        state_->release(nullptr);
+        throw;
+      }
+    }
+    return std::unique_ptr<MessageT, std::function<void(MessageT *)>>(ptr, get_deleter());
+  }
+
+  /// Return the statistics of the pool.
+  MessagePoolStatistics
+  get_statistics() const
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    MessagePoolStatistics statistics = state_->statistics;
+    statistics.free = state_->free_messages.size();
+    return statistics;
+  }
+
+private:
+  /// Return a deleter giving the messages back to the pool, or deallocating them once it's gone.
+  std::function<void(MessageT *)>
+  get_deleter() const
+  {
+    std::weak_ptr<State> weak_state = state_;
+    MessageAllocatorT allocator = state_->allocator;
+    return [weak_state, allocator](MessageT * released) mutable {
+        if (auto state = weak_state.lock()) {
+          state->release(released);
+        } else {
+          MessageAllocTraits::destroy(allocator, released);
+          MessageAllocTraits::deallocate(allocator, released, 1);
+        }
+      };
+  }
+
+  struct State
+  {
+    State(size_t depth, const MessageAllocatorT & message_allocator)
+    : allocator(message_allocator)
+    {
+      statistics.depth = depth;
+      free_messages.reserve(depth);
+    }
+
+    ~State()
+    {
+      for (MessageT * ptr : free_messages) {
+        MessageAllocTraits::destroy(allocator, ptr);
+        MessageAllocTraits::deallocate(allocator, ptr, 1);
+      }
+    }
+
+    /// Take a free message, or return nullptr if a new one must be allocated.
+    MessageT *
+    acquire()
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      statistics.in_use++;
+      statistics.high_water_mark = std::max(statistics.high_water_mark, statistics.in_use);
+      if (!std::is_copy_assignable<MessageT>::value || free_messages.empty()) {
+        statistics.allocations++;
+        return nullptr;
+      }
+      statistics.reuses++;
+      MessageT * ptr = free_messages.back();
+      free_messages.pop_back();
+      return ptr;
+    }
+
+    /// Keep a released message, or deallocate it if the pool is full.
+    void
+    release(MessageT * ptr)
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        statistics.in_use--;
+        if (ptr == nullptr) {
+          return;
+        }
+        if (std::is_copy_assignable<MessageT>::value && free_messages.size() < statistics.depth) {
+          free_messages.push_back(ptr);
+          return;
+        }
+      }
+      MessageAllocTraits::destroy(allocator, ptr);
+      MessageAllocTraits::deallocate(allocator, ptr, 1);
+    }
+
+    MessageAllocatorT allocator;
+    std::mutex mutex;
+    MessagePoolStatistics statistics;
+    std::vector<MessageT *> free_messages;
+  };
+
+  std::shared_ptr<State> state_;
+};
+
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__MESSAGE_POOL_HPP_
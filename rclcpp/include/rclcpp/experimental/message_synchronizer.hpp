@@ -0,0 +1,321 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXPERIMENTAL__MESSAGE_SYNCHRONIZER_HPP_
+#define RCLCPP__EXPERIMENTAL__MESSAGE_SYNCHRONIZER_HPP_
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/create_subscription.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/qos.hpp"
+#include "rclcpp/subscription_base.hpp"
+#include "rclcpp/subscription_options.hpp"
+
+namespace rclcpp
+{
+namespace experimental
+{
+
+/// How the messages of the topics are matched by a MessageSynchronizer.
+enum class SyncPolicy
+{
+  /// Match the messages with the same stamp.
+  ExactTime,
+  /// Match the messages whose stamps are within SynchronizerOptions::max_interval.
+  ApproximateTime
+};
+
+/// Options of a MessageSynchronizer.
+struct SynchronizerOptions
+{
+  SyncPolicy policy = SyncPolicy::ExactTime;
+  /// Maximum number of messages waiting for a match, per topic.
+  /**
+   * The oldest message of the topic is dropped to queue a new one beyond this size.
+   */
+  size_t queue_size = 10;
+  /// Maximum difference between the stamps of the messages matched, with ApproximateTime.
+  std::chrono::nanoseconds max_interval = std::chrono::milliseconds(10);
+};
+
+/// Stamp the messages are matched on, in nanoseconds.
+/**
+ * It's the stamp of the header by default, specialize it for the messages without a header.
+ */
+template<typename MessageT>
+struct MessageStamp
+{
+  static int64_t
+  get(const MessageT & message)
+  {
+    return static_cast<int64_t>(message.header.stamp.sec) * 1000000000LL +
+           static_cast<int64_t>(message.header.stamp.nanosec);
+  }
+};
+
+/// Call a callback with sets of messages of several topics, matched on their stamps.
+/**
+ * The messages are kept as shared pointers to const from their arrival to the callback, so the
+ * intra-process messages aren't copied, and the memory used is bounded by
+ * SynchronizerOptions::queue_size per topic.
+ * The messages are matched as soon as the last one of a set is added, by the callback of its
+ * subscription, there is no other queue nor executor entity.
+ *
+ * With ApproximateTime the newest of the oldest messages of the topics is the pivot, and each
+ * topic contributes its latest message not newer than the pivot.
+ * The set is matched if all of them are within the maximum interval of the pivot, otherwise
+ * the oldest of them is dropped and the next pivot is tried.
+ *
+ * The messages which can't be matched anymore are dropped, see get_dropped_count().
+ * All public member functions are thread-safe, the callback isn't called with the lock held,
+ * and it may be called concurrently if the subscriptions are in a reentrant callback group.
+ */
+template<typename ... MessageTs>
+class MessageSynchronizer
+{
+  static_assert(sizeof...(MessageTs) >= 2, "at least two topics are synchronized");
+
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(MessageSynchronizer)
+
+  using MessageSet = std::tuple<std::shared_ptr<const MessageTs>...>;
+  using Callback = std::function<void (const std::shared_ptr<const MessageTs> &...)>;
+
+  template<size_t I>
+  using MessageType = std::tuple_element_t<I, std::tuple<MessageTs...>>;
+
+  /// Create a synchronizer calling the callback with each set of messages matched.
+  /**
+   * \throws std::invalid_argument if the queue size is zero, the maximum interval is negative
+   *   or the callback is empty.
+   */
+  MessageSynchronizer(const SynchronizerOptions & options, Callback callback)
+  : options_(options), callback_(std::move(callback))
+  {
+    if (options_.queue_size == 0) {
+      throw std::invalid_argument("queue_size must be greater than zero");
+    }
+    if (options_.max_interval.count() < 0) {
+      throw std::invalid_argument("max_interval must not be negative");
+    }
+    if (!callback_) {
+      throw std::invalid_argument("callback must not be empty");
+    }
+  }
+
+  /// Subscribe to the topic of the messages at index I, adding them to the synchronizer.
+  /**
+   * The subscription is kept by the synchronizer, which must outlive the executor spinning it.
+   * The subscriptions of a synchronizer should share a mutually exclusive callback group,
+   * so that a set of messages is matched by a single thread.
+   *
+   * \return the subscription created.
+   */
+  template<size_t I, typename NodeT>
+  rclcpp::SubscriptionBase::SharedPtr
+  subscribe(
+    NodeT & node,
+    const std::string & topic_name,
+    const rclcpp::QoS & qos,
+    const rclcpp::SubscriptionOptions & options = rclcpp::SubscriptionOptions())
+  {
+    auto subscription = rclcpp::create_subscription<MessageType<I>>(
+      node, topic_name, qos,
+      [this](std::shared_ptr<const MessageType<I>> message) {
+        add_message<I>(std::move(message));
+      },
+      options);
+    std::lock_guard<std::mutex> lock(mutex_);
+    subscriptions_.push_back(subscription);
+    return subscription;
+  }
+
+  /// Add a message of the topic at index I, calling the callback if it completes a set.
+  /**
+   * \throws std::invalid_argument if the message is nullptr.
+   */
+  template<size_t I>
+  void
+  add_message(std::shared_ptr<const MessageType<I>> message)
+  {
+    if (!message) {
+      throw std::invalid_argument("message cannot be nullptr");
+    }
+    std::vector<MessageSet> matched;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      const int64_t stamp = MessageStamp<MessageType<I>>::get(*message);
+      auto & queue = std::get<I>(queues_);
+      // Kept sorted by stamp, the messages usually arrive in order
+      auto position = std::upper_bound(
+        queue.begin(), queue.end(), stamp,
+        [](int64_t value, const auto & entry) {return value < entry.first;});
+      queue.emplace(position, stamp, std::move(message));
+      if (queue.size() > options_.queue_size) {
+        queue.pop_front();
+        dropped_count_++;
+      }
+      if (options_.policy == SyncPolicy::ExactTime) {
+        match_exact(stamp, Indices(), matched);
+      } else {
+        match_approximate(Indices(), matched);
+      }
+    }
+    for (const auto & set : matched) {
+      std::apply(callback_, set);
+    }
+  }
+
+  /// Return the number of messages dropped without being matched.
+  uint64_t
+  get_dropped_count() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dropped_count_;
+  }
+
+  /// Return the number of sets of messages matched.
+  uint64_t
+  get_matched_count() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return matched_count_;
+  }
+
+private:
+  using Indices = std::index_sequence_for<MessageTs...>;
+  static constexpr size_t kTopicCount = sizeof...(MessageTs);
+
+  template<typename MessageT>
+  using Queue = std::deque<std::pair<int64_t, std::shared_ptr<const MessageT>>>;
+
+  /// Match the messages with the given stamp, if all the topics have one.
+  template<size_t ... Is>
+  void
+  match_exact(int64_t stamp, std::index_sequence<Is...>, std::vector<MessageSet> & matched)
+  {
+    MessageSet set;
+    if (!(find_stamp<Is>(stamp, std::get<Is>(set)) && ...)) {
+      return;
+    }
+    // The older messages can't be matched anymore
+    (erase_until<Is>(stamp), ...);
+    matched_count_++;
+    matched.push_back(std::move(set));
+  }
+
+  template<size_t I>
+  bool
+  find_stamp(int64_t stamp, std::shared_ptr<const MessageType<I>> & message) const
+  {
+    for (const auto & entry : std::get<I>(queues_)) {
+      if (entry.first == stamp) {
+        message = entry.second;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// Erase the messages up to the given stamp, counting the ones not matched as dropped.
+  template<size_t I>
+  void
+  erase_until(int64_t stamp)
+  {
+    auto & queue = std::get<I>(queues_);
+    bool matched = false;
+    while (!queue.empty() && queue.front().first <= stamp) {
+      if (queue.front().first == stamp && !matched) {
+        matched = true;
+      } else {
+        dropped_count_++;
+      }
+      queue.pop_front();
+    }
+  }
+
+  /// Match the sets of messages within the maximum interval, while all the topics have one.
+  template<size_t ... Is>
+  void
+  match_approximate(std::index_sequence<Is...>, std::vector<MessageSet> & matched)
+  {
+    while ((!std::get<Is>(queues_).empty() && ...)) {
+      const int64_t pivot = std::max({std::get<Is>(queues_).front().first...});
+      // The latest message of each topic not newer than the pivot, there is at least the oldest
+      const std::array<size_t, kTopicCount> candidates = {latest_until<Is>(pivot)...};
+      const std::array<int64_t, kTopicCount> stamps = {
+        std::get<Is>(queues_)[candidates[Is]].first...};
+      const auto oldest = std::min_element(stamps.begin(), stamps.end());
+      if (pivot - *oldest <= options_.max_interval.count()) {
+        MessageSet set(std::get<Is>(queues_)[candidates[Is]].second...);
+        (erase_through<Is>(candidates[Is], true), ...);
+        matched_count_++;
+        matched.push_back(std::move(set));
+        continue;
+      }
+      // The oldest candidate is too far from the pivot to be matched
+      const size_t topic = static_cast<size_t>(oldest - stamps.begin());
+      ((Is == topic ? erase_through<Is>(candidates[Is], false) : void()), ...);
+    }
+  }
+
+  template<size_t I>
+  size_t
+  latest_until(int64_t stamp) const
+  {
+    const auto & queue = std::get<I>(queues_);
+    auto position = std::upper_bound(
+      queue.begin(), queue.end(), stamp,
+      [](int64_t value, const auto & entry) {return value < entry.first;});
+    return static_cast<size_t>(position - queue.begin()) - 1;
+  }
+
+  /// Erase the messages up to the given index, the last one is matched or dropped.
+  template<size_t I>
+  void
+  erase_through(size_t index, bool matched)
+  {
+    auto & queue = std::get<I>(queues_);
+    dropped_count_ += matched ? index : index + 1;
+    queue.erase(queue.begin(), queue.begin() + static_cast<std::ptrdiff_t>(index + 1));
+  }
+
+  const SynchronizerOptions options_;
+  const Callback callback_;
+
+  mutable std::mutex mutex_;
+  std::tuple<Queue<MessageTs>...> queues_;
+  uint64_t dropped_count_ = 0;
+  uint64_t matched_count_ = 0;
+  std::vector<rclcpp::SubscriptionBase::SharedPtr> subscriptions_;
+};
+
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__MESSAGE_SYNCHRONIZER_HPP_
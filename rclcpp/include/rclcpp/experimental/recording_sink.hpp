@@ -0,0 +1,289 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__EXPERIMENTAL__RECORDING_SINK_HPP_
+#define RCLCPP__EXPERIMENTAL__RECORDING_SINK_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "rclcpp/generic_subscription.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/message_info.hpp"
+#include "rclcpp/qos.hpp"
+#include "rclcpp/serialized_message_view.hpp"
+#include "rclcpp/subscription_options.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace experimental
+{
+
+/// Options of a RecordingSink.
+struct RecordingSinkOptions
+{
+  /// Directory of the segment files, created if it doesn't exist.
+  std::string directory;
+  /// Size in bytes of each segment file, allocated and mapped when the segment is opened.
+  size_t segment_size = 64 * 1024 * 1024;
+  /// Maximum number of records of a segment, the capacity of its index.
+  size_t max_records_per_segment = 64 * 1024;
+  /// Number of the most recent segments kept on disk, all of them if zero.
+  size_t max_segments = 0;
+};
+
+/// A topic recorded by a RecordingSink.
+struct RecordingTopic
+{
+  /// Id of the topic in the records.
+  uint32_t id;
+  /// Fully qualified name of the topic.
+  std::string name;
+  /// Type of the messages, e.g. "std_msgs/msg/String".
+  std::string type;
+};
+
+/// Counters of a RecordingSink.
+struct RecordingSinkStatistics
+{
+  /// Number of messages recorded.
+  uint64_t record_count = 0;
+  /// Number of bytes of serialized data recorded.
+  uint64_t byte_count = 0;
+  /// Number of segments opened.
+  uint64_t segment_count = 0;
+  /// Number of messages which couldn't be recorded, being larger than a segment.
+  uint64_t dropped_count = 0;
+};
+
+/// Append-only recorder of serialized messages into memory mapped segment files.
+/**
+ * It's the fast path of the recorders running in the process of the publishers: the
+ * subscriptions made by subscribe() borrow the serialized messages, see
+ * rclcpp::GenericSubscription::ViewCallback, and each message is copied once, straight
+ * into the mapped segment.
+ * No memory is allocated and no system call is made per message, the segments are
+ * allocated on disk when they're opened and written back by the kernel.
+ *
+ * A segment file "segment_<n>.rec" holds the records one after the other, each with its
+ * topic id and its timestamps, aligned on 8 bytes.
+ * When it's full, or when its index is, it's truncated to the size used and its index is
+ * written with a single write to "segment_<n>.idx", with the topics and the offset of each
+ * record.
+ * RecordingSegmentReader reads them back.
+ *
+ * All public member functions are thread-safe.
+ * Only supported on POSIX systems.
+ */
+class RecordingSink : public std::enable_shared_from_this<RecordingSink>
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(RecordingSink)
+
+  /// Create the directory of the sink if needed, the first segment is opened on first write.
+  /**
+   * \throws std::invalid_argument if the directory is empty, if the segment size can't hold
+   *   the segment header or if the maximum number of records is zero.
+   */
+  RCLCPP_PUBLIC
+  explicit RecordingSink(const RecordingSinkOptions & options);
+
+  /// Close the current segment, writing its index.
+  RCLCPP_PUBLIC
+  virtual ~RecordingSink();
+
+  /// Register a topic, returning the id of its records.
+  /**
+   * The topics are written in the index of each segment.
+   */
+  RCLCPP_PUBLIC
+  uint32_t
+  add_topic(const std::string & name, const std::string & type);
+
+  /// Append a serialized message to the current segment, opening a new one if it's full.
+  /**
+   * \param[in] topic_id id given by add_topic().
+   * \param[in] message serialized data of the message.
+   * \param[in] source_timestamp time at which the message was published, in nanoseconds.
+   * \param[in] received_timestamp time at which the message was received, in nanoseconds.
+   * \return false if the message is larger than a segment and was dropped.
+   * \throws std::invalid_argument if the topic id is unknown.
+   * \throws std::system_error if a segment can't be opened or closed.
+   */
+  RCLCPP_PUBLIC
+  bool
+  write(
+    uint32_t topic_id,
+    const rclcpp::SerializedMessageView & message,
+    int64_t source_timestamp,
+    int64_t received_timestamp);
+
+  /// Subscribe to a topic, recording its messages into this sink.
+  /**
+   * The sink must be owned by a shared pointer, the subscription stops recording once it's
+   * destroyed.
+   * Setting rclcpp::SubscriptionOptionsBase::max_messages_per_take lets the executor take
+   * all the pending messages of the topic each time it's ready.
+   *
+   * \param[in] node node creating the subscription.
+   * \param[in] topic_name name of the topic.
+   * \param[in] topic_type type of the messages, e.g. "std_msgs/msg/String".
+   * \param[in] qos quality of service of the subscription.
+   * \param[in] options options of the subscription.
+   * \return the subscription, recording as long as it's alive.
+   */
+  template<typename NodeT, typename AllocatorT = std::allocator<void>>
+  std::shared_ptr<rclcpp::GenericSubscription>
+  subscribe(
+    NodeT & node,
+    const std::string & topic_name,
+    const std::string & topic_type,
+    const rclcpp::QoS & qos,
+    const rclcpp::SubscriptionOptionsWithAllocator<AllocatorT> & options = (
+      rclcpp::SubscriptionOptionsWithAllocator<AllocatorT>()
+    ))
+  {
+    const uint32_t topic_id = add_topic(
+      node.get_node_topics_interface()->resolve_topic_name(topic_name), topic_type);
+    std::weak_ptr<RecordingSink> weak_sink = shared_from_this();
+    return node.create_generic_subscription(
+      topic_name, topic_type, qos,
+      rclcpp::GenericSubscription::ViewCallback(
+        [weak_sink, topic_id](
+          const rclcpp::SerializedMessageView & message,
+          const rclcpp::MessageInfo & message_info)
+        {
+          auto sink = weak_sink.lock();
+          if (!sink) {
+            return;
+          }
+          const auto & rmw_message_info = message_info.get_rmw_message_info();
+          sink->write(
+            topic_id, message, rmw_message_info.source_timestamp,
+            rmw_message_info.received_timestamp);
+        }),
+      options);
+  }
+
+  /// Ask the kernel to write back the records of the current segment, without waiting.
+  RCLCPP_PUBLIC
+  void
+  flush();
+
+  /// Close the current segment, writing its index, the next write opens a new one.
+  RCLCPP_PUBLIC
+  void
+  close();
+
+  /// Return the paths of the segment files kept on disk, from the oldest one.
+  RCLCPP_PUBLIC
+  std::vector<std::string>
+  get_segment_paths() const;
+
+  /// Return the topics registered with add_topic().
+  RCLCPP_PUBLIC
+  std::vector<RecordingTopic>
+  get_topics() const;
+
+  /// Return the counters of the sink.
+  RCLCPP_PUBLIC
+  RecordingSinkStatistics
+  get_statistics() const;
+
+private:
+  class Segment;
+
+  void
+  open_segment();
+
+  void
+  close_segment();
+
+  const RecordingSinkOptions options_;
+
+  mutable std::mutex mutex_;
+  std::vector<RecordingTopic> topics_;
+  std::unique_ptr<Segment> segment_;
+  uint64_t next_segment_number_ = 0;
+  std::deque<std::string> segment_paths_;
+  RecordingSinkStatistics statistics_;
+};
+
+/// A record read by a RecordingSegmentReader.
+struct RecordingEntry
+{
+  /// Id of the topic of the message, see RecordingSegmentReader::get_topics().
+  uint32_t topic_id;
+  /// Time at which the message was published, in nanoseconds.
+  int64_t source_timestamp;
+  /// Time at which the message was received, in nanoseconds.
+  int64_t received_timestamp;
+  /// Serialized data of the message, valid as long as the reader is.
+  rclcpp::SerializedMessageView message;
+};
+
+/// Reader of a segment closed by a RecordingSink, using its index.
+class RecordingSegmentReader
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(RecordingSegmentReader)
+
+  /// Map the segment file and read its index.
+  /**
+   * \param[in] segment_path path of the segment file, see RecordingSink::get_segment_paths().
+   * \throws std::system_error if the files can't be read.
+   * \throws std::runtime_error if the files aren't a segment and its index.
+   */
+  RCLCPP_PUBLIC
+  explicit RecordingSegmentReader(const std::string & segment_path);
+
+  RCLCPP_PUBLIC
+  virtual ~RecordingSegmentReader();
+
+  /// Return the topics of the sink when the segment was closed.
+  RCLCPP_PUBLIC
+  const std::vector<RecordingTopic> &
+  get_topics() const;
+
+  /// Return the number of records of the segment.
+  RCLCPP_PUBLIC
+  size_t
+  size() const;
+
+  /// Return a record, in the order they were written.
+  /**
+   * \throws std::out_of_range if the index is beyond the number of records.
+   */
+  RCLCPP_PUBLIC
+  RecordingEntry
+  at(size_t index) const;
+
+private:
+  std::vector<RecordingTopic> topics_;
+  std::vector<RecordingEntry> entries_;
+  const uint8_t * data_ = nullptr;
+  size_t data_size_ = 0;
+};
+
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__RECORDING_SINK_HPP_
@@ -0,0 +1,192 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXPERIMENTAL__SERVICE_INTRA_PROCESS_HPP_
+#define RCLCPP__EXPERIMENTAL__SERVICE_INTRA_PROCESS_HPP_
+
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "rcl/wait.h"
+#include "rmw/types.h"
+
+#include "rclcpp/context.hpp"
+#include "rclcpp/experimental/client_intra_process.hpp"
+#include "rclcpp/experimental/intra_process_service_waitable.hpp"
+#include "rclcpp/macros.hpp"
+
+namespace rclcpp
+{
+namespace experimental
+{
+
+/// Intra-process part of a service, receiving the requests of the clients in the same context.
+/**
+ * The requests are given by pointer by the clients, then handed to the service when the
+ * executor executes this waitable.
+ * The request header of an intra-process request has the sequence number chosen by the client,
+ * and a writer guid made of the client id, so requests from different clients are told apart
+ * the same way as with the middleware.
+ */
+template<typename ServiceT>
+class ServiceIntraProcess : public IntraProcessServiceWaitable
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(ServiceIntraProcess)
+
+  using SharedRequest = typename ServiceT::Request::SharedPtr;
+  using SharedResponse = typename ServiceT::Response::SharedPtr;
+  using ClientIntraProcessT = ClientIntraProcess<ServiceT>;
+
+  /// Function called with the header of a request and the request.
+  using RequestCallback = std::function<void (std::shared_ptr<rmw_request_id_t>, SharedRequest)>;
+
+  /// Create the intra-process part of a service.
+  /**
+   * \param[in] callback function handing a request to the service.
+   * \param[in] context the context of the service.
+   * \param[in] service_name the fully qualified name of the service.
+   * \throws std::invalid_argument if the callback is empty.
+   */
+  ServiceIntraProcess(
+    RequestCallback callback,
+    rclcpp::Context::SharedPtr context,
+    const std::string & service_name)
+  : IntraProcessServiceWaitable(context, service_name, EntityType::Service),
+    callback_(std::move(callback))
+  {
+    if (!callback_) {
+      throw std::invalid_argument("intra-process service request callback cannot be empty");
+    }
+  }
+
+  virtual ~ServiceIntraProcess() = default;
+
+  bool
+  is_ready(rcl_wait_set_t * wait_set) override
+  {
+    (void) wait_set;
+    std::lock_guard<std::mutex> lock(mutex_);
+    return !requests_.empty();
+  }
+
+  std::shared_ptr<void>
+  take_data() override
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (requests_.empty()) {
+      return nullptr;
+    }
+    auto request = std::make_shared<QueuedRequest>(std::move(requests_.front()));
+    requests_.pop_front();
+    return request;
+  }
+
+  void
+  execute(std::shared_ptr<void> & data) override
+  {
+    if (!data) {
+      return;
+    }
+    auto request = std::static_pointer_cast<QueuedRequest>(data);
+    callback_(std::move(request->first), std::move(request->second));
+  }
+
+  /// Queue the request of a client in the same context, can be called from any thread.
+  /**
+   * \param[in] client the intra-process part of the client, which gets the response.
+   * \param[in] sequence_number the sequence number of the request, unique for the client.
+   * \param[in] request the request, given as is to the service.
+   */
+  void
+  send_request(
+    const typename ClientIntraProcessT::SharedPtr & client,
+    int64_t sequence_number,
+    SharedRequest request)
+  {
+    auto request_header = std::make_shared<rmw_request_id_t>();
+    std::memset(request_header->writer_guid, 0, sizeof(request_header->writer_guid));
+    const uint64_t client_id = client->get_client_id();
+    std::memcpy(request_header->writer_guid, &client_id, sizeof(client_id));
+    std::memcpy(
+      request_header->writer_guid + sizeof(client_id), kRequestMarker, sizeof(kRequestMarker));
+    request_header->sequence_number = sequence_number;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      pending_clients_.emplace(RequestKey(client_id, sequence_number), client);
+      requests_.emplace_back(std::move(request_header), std::move(request));
+    }
+    notify_ready();
+  }
+
+  /// Take the client waiting for the response to a request, if it's an intra-process one.
+  /**
+   * \param[in] request_header the header of the request.
+   * \return the client waiting for the response, which may not exist anymore, or std::nullopt
+   *   if the request was received from the middleware or was already answered.
+   */
+  std::optional<typename ClientIntraProcessT::WeakPtr>
+  take_pending_client(const rmw_request_id_t & request_header)
+  {
+    // Only the intra-process requests have the marker, the others don't need the lock
+    if (
+      std::memcmp(
+        request_header.writer_guid + sizeof(uint64_t), kRequestMarker,
+        sizeof(kRequestMarker)) != 0)
+    {
+      return std::nullopt;
+    }
+    uint64_t client_id;
+    std::memcpy(&client_id, request_header.writer_guid, sizeof(client_id));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = pending_clients_.find(RequestKey(client_id, request_header.sequence_number));
+    if (it == pending_clients_.end()) {
+      return std::nullopt;
+    }
+    auto client = std::move(it->second);
+    pending_clients_.erase(it);
+    return client;
+  }
+
+private:
+  RCLCPP_DISABLE_COPY(ServiceIntraProcess)
+
+  static constexpr char kRequestMarker[] = {'r', 'c', 'l', 'c', 'p', 'p', 'i', 'p'};
+  static_assert(
+    sizeof(rmw_request_id_t::writer_guid) >= sizeof(uint64_t) + sizeof(kRequestMarker),
+    "the writer guid can't hold the client id and the marker");
+
+  using QueuedRequest = std::pair<std::shared_ptr<rmw_request_id_t>, SharedRequest>;
+  using RequestKey = std::pair<uint64_t, int64_t>;
+
+  RequestCallback callback_;
+
+  std::mutex mutex_;
+  std::deque<QueuedRequest> requests_;
+  std::map<RequestKey, typename ClientIntraProcessT::WeakPtr> pending_clients_;
+};
+
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__SERVICE_INTRA_PROCESS_HPP_
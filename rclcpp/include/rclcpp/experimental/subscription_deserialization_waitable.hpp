@@ -0,0 +1,206 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__EXPERIMENTAL__SUBSCRIPTION_DESERIALIZATION_WAITABLE_HPP_
+#define RCLCPP__EXPERIMENTAL__SUBSCRIPTION_DESERIALIZATION_WAITABLE_HPP_
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include "rcl/wait.h"
+
+#include "rclcpp/context.hpp"
+#include "rclcpp/deserialization_thread_pool.hpp"
+#include "rclcpp/guard_condition.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/message_info.hpp"
+#include "rclcpp/serialized_message.hpp"
+#include "rclcpp/visibility_control.hpp"
+#include "rclcpp/waitable.hpp"
+
+namespace rclcpp
+{
+
+class SubscriptionBase;
+
+namespace experimental
+{
+
+/// Waitable of a subscription deserializing its messages on a thread pool.
+/**
+ * The executor takes the messages serialized and gives them to deserialize_async(), which
+ * deserializes them on the thread pool.
+ * Once deserialized, the messages are handled by the subscription from the executor, in the
+ * order in which they were taken, so the callback group of the subscription is respected.
+ *
+ * With take_and_prefetch(), the thread pool also takes the next messages ahead of the
+ * executor, see rclcpp::SubscriptionOptionsBase::prefetch_depth.
+ */
+class SubscriptionDeserializationWaitable
+  : public rclcpp::Waitable,
+  public std::enable_shared_from_this<SubscriptionDeserializationWaitable>
+{
+public:
+  RCLCPP_SMART_PTR_ALIASES_ONLY(SubscriptionDeserializationWaitable)
+
+  enum class EntityType : std::size_t
+  {
+    Subscription,
+  };
+
+  /// Function deserializing a message, returning the deserialized message.
+  using DeserializeFunction =
+    std::function<std::shared_ptr<void>(const rclcpp::SerializedMessage &)>;
+
+  /// Constructor.
+  /**
+   * \param[in] context the context of the guard condition waking the executor.
+   * \param[in] thread_pool the thread pool deserializing the messages.
+   * \param[in] deserialize the function deserializing a message, called by the thread pool.
+   * \throws std::invalid_argument if the thread pool is nullptr or the function not callable.
+   */
+  RCLCPP_PUBLIC
+  SubscriptionDeserializationWaitable(
+    rclcpp::Context::SharedPtr context,
+    rclcpp::DeserializationThreadPool::SharedPtr thread_pool,
+    DeserializeFunction deserialize);
+
+  RCLCPP_PUBLIC
+  virtual ~SubscriptionDeserializationWaitable() = default;
+
+  /// Deserialize a message on the thread pool, then have the subscription handle it.
+  /**
+   * \param[in] subscription the subscription which took the message.
+   * \param[in] serialized_message the message, which must not be modified until deserialized.
+   * \param[in] message_info the information of the message given to the subscription.
+   */
+  RCLCPP_PUBLIC
+  void
+  deserialize_async(
+    std::weak_ptr<rclcpp::SubscriptionBase> subscription,
+    std::shared_ptr<const rclcpp::SerializedMessage> serialized_message,
+    const rclcpp::MessageInfo & message_info);
+
+  /// Take the next message of the subscription, and have the thread pool take the next ones.
+  /**
+   * The message is taken serialized and handed to the subscription, which gives it to
+   * deserialize_async().
+   * Then, unless it's doing so already, the thread pool takes the next ready messages the same
+   * way, as long as fewer than `prefetch_depth` messages are pending.
+   * The messages are taken one at a time, by the caller or the thread pool, so they're handled
+   * in the order in which they were taken.
+   *
+   * \param[in] subscription the subscription, whose messages are taken serialized.
+   * \param[in] prefetch_depth the maximum number of pending messages taken ahead.
+   * \return true if a message was taken by the caller.
+   * \throws anything SubscriptionBase::take_serialized() can throw.
+   */
+  RCLCPP_PUBLIC
+  bool
+  take_and_prefetch(
+    const std::shared_ptr<rclcpp::SubscriptionBase> & subscription,
+    size_t prefetch_depth);
+
+  /// Return the number of messages given to deserialize_async() and not yet handled.
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_pending_messages() const;
+
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_ready_guard_conditions() override {return 1;}
+
+  RCLCPP_PUBLIC
+  void
+  add_to_wait_set(rcl_wait_set_t * wait_set) override;
+
+  /// Return true if the oldest pending message is deserialized.
+  RCLCPP_PUBLIC
+  bool
+  is_ready(rcl_wait_set_t * wait_set) override;
+
+  RCLCPP_PUBLIC
+  std::shared_ptr<void>
+  take_data() override;
+
+  RCLCPP_PUBLIC
+  std::shared_ptr<void>
+  take_data_by_entity_id(size_t id) override;
+
+  /// Have the subscription handle the deserialized message.
+  /**
+   * \throws anything the deserialization threw for this message.
+   */
+  RCLCPP_PUBLIC
+  void
+  execute(std::shared_ptr<void> & data) override;
+
+  /// Set a callback to be called each time a message is ready to be handled.
+  /**
+   * \sa rclcpp::SubscriptionIntraProcessBase::set_on_ready_callback
+   *
+   * \param[in] callback functor to be called when a message is ready.
+   * \throws std::invalid_argument if the callback is not callable.
+   */
+  RCLCPP_PUBLIC
+  void
+  set_on_ready_callback(std::function<void(size_t, int)> callback) override;
+
+  /// Unset the callback registered for the ready messages, if any.
+  RCLCPP_PUBLIC
+  void
+  clear_on_ready_callback() override;
+
+private:
+  RCLCPP_DISABLE_COPY(SubscriptionDeserializationWaitable)
+
+  struct PendingMessage;
+
+  void
+  on_deserialized();
+
+  /// Take a message and hand it to the subscription, return false if none was ready.
+  bool
+  take_next_message(rclcpp::SubscriptionBase & subscription);
+
+  /// Take the ready messages ahead, run by the thread pool.
+  void
+  prefetch(std::weak_ptr<rclcpp::SubscriptionBase> subscription, size_t prefetch_depth);
+
+  rclcpp::GuardCondition gc_;
+  rclcpp::DeserializationThreadPool::SharedPtr thread_pool_;
+  DeserializeFunction deserialize_;
+
+  mutable std::mutex mutex_;
+  std::deque<std::shared_ptr<PendingMessage>> pending_messages_;
+  // Number of deserialized messages at the front of the pending ones already notified
+  size_t notified_count_{0};
+  // Set while the thread pool takes messages ahead
+  bool prefetching_{false};
+
+  // Held while a message is taken and queued, so the messages are queued in order
+  std::mutex take_mutex_;
+
+  std::mutex callback_mutex_;
+  std::function<void(size_t)> on_ready_callback_{nullptr};
+  size_t unread_count_{0};
+};
+
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__SUBSCRIPTION_DESERIALIZATION_WAITABLE_HPP_
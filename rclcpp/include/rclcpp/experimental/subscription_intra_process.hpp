@@ -17,11 +17,13 @@
 
 #include <rmw/types.h>
 
+#include <atomic>
 #include <memory>
 #include <stdexcept>
 #include <string>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "rcl/types.h"
 
@@ -29,6 +31,9 @@
 #include "rclcpp/context.hpp"
 #include "rclcpp/experimental/buffers/intra_process_buffer.hpp"
 #include "rclcpp/experimental/subscription_intra_process_buffer.hpp"
+#include "rclcpp/latest_message.hpp"
+#include "rclcpp/message_info.hpp"
+#include "rclcpp/message_lineage.hpp"
 #include "rclcpp/qos.hpp"
 #include "rclcpp/type_support_decl.hpp"
 #include "tracetools/tracetools.h"
@@ -77,15 +82,24 @@ public:
     rclcpp::Context::SharedPtr context,
     const std::string & topic_name,
     const rclcpp::QoS & qos_profile,
-    rclcpp::IntraProcessBufferType buffer_type)
+    rclcpp::IntraProcessBufferType buffer_type,
+    rclcpp::IntraProcessBufferImplementation buffer_implementation =
+    rclcpp::IntraProcessBufferImplementation::Default,
+    std::shared_ptr<rclcpp::experimental::buffers::BufferImplementationFactoryBase>
+    buffer_factory = nullptr)
   : SubscriptionIntraProcessBuffer<SubscribedType, SubscribedTypeAlloc,
       SubscribedTypeDeleter, ROSMessageType>(
       std::make_shared<SubscribedTypeAlloc>(*allocator),
       context,
       topic_name,
       qos_profile,
-      buffer_type),
-    any_callback_(callback)
+      buffer_type,
+      buffer_implementation,
+      buffer_factory),
+    any_callback_(callback),
+    coalesce_wake_ups_(
+      !buffer_factory &&
+      buffer_implementation == rclcpp::IntraProcessBufferImplementation::LatestValue)
   {
     TRACEPOINT(
       rclcpp_subscription_callback_added,
@@ -101,28 +115,44 @@ public:
 
   virtual ~SubscriptionIntraProcess() = default;
 
+  /// Set the slot the messages are stored in before calling the callback.
+  /**
+   * It must be set before the subscription is added to the intra-process manager.
+   */
+  void
+  set_latest_message(typename rclcpp::LatestMessage<ROSMessageType>::SharedPtr latest_message)
+  {
+    latest_message_ = std::move(latest_message);
+  }
+
   std::shared_ptr<void>
   take_data() override
   {
-    ConstMessageSharedPtr shared_msg;
-    MessageUniquePtr unique_msg;
+    if (any_callback_.is_batch_callback()) {
+      return take_batch();
+    }
+    if (coalesce_wake_ups_) {
+      // Messages added from now on trigger the guard condition again
+      wake_up_pending_.store(false);
+    }
 
-    if (any_callback_.use_take_shared_method()) {
-      shared_msg = this->buffer_->consume_shared();
-      if (!shared_msg) {
-        return nullptr;
+    auto taken_message = std::make_shared<TakenMessage>();
+    const void * message = nullptr;
+    // The messages queued for too long are dropped, up to the first one still fresh
+    do {
+      if (any_callback_.use_take_shared_method()) {
+        taken_message->shared_msg = this->buffer_->consume_shared();
+        message = taken_message->shared_msg.get();
+      } else {
+        taken_message->unique_msg = this->buffer_->consume_unique();
+        message = taken_message->unique_msg.get();
       }
-    } else {
-      unique_msg = this->buffer_->consume_unique();
-      if (!unique_msg) {
+      if (!message) {
         return nullptr;
       }
-    }
-    return std::static_pointer_cast<void>(
-      std::make_shared<std::pair<ConstMessageSharedPtr, MessageUniquePtr>>(
-        std::pair<ConstMessageSharedPtr, MessageUniquePtr>(
-          shared_msg, std::move(unique_msg)))
-    );
+      taken_message->lineage = this->take_lineage(message);
+    } while (this->drop_by_age(message));
+    return std::static_pointer_cast<void>(taken_message);
   }
 
   void execute(std::shared_ptr<void> & data) override
@@ -130,7 +160,70 @@ public:
     execute_impl<SubscribedType>(data);
   }
 
+  void
+  add_to_wait_set(rcl_wait_set_t * wait_set) override
+  {
+    // With a batch callback or a latest value buffer the guard condition isn't triggered for
+    // each message, so make sure the messages left, e.g. while the callback group was busy,
+    // aren't missed
+    if ((any_callback_.is_batch_callback() || coalesce_wake_ups_) && this->buffer_->has_data()) {
+      this->gc_.trigger();
+    }
+    SubscriptionIntraProcessBufferT::add_to_wait_set(wait_set);
+  }
+
 protected:
+  using MessageBatch = std::vector<ConstMessageSharedPtr>;
+
+  /// Message taken by take_data(), with its flow.
+  struct TakenMessage
+  {
+    ConstMessageSharedPtr shared_msg;
+    MessageUniquePtr unique_msg;
+    rclcpp::MessageLineage lineage;
+  };
+
+  /// Messages taken by take_batch(), with the flow of the newest one which has one.
+  struct TakenBatch
+  {
+    MessageBatch messages;
+    rclcpp::MessageLineage lineage;
+  };
+
+  /// Trigger the guard condition, only once per take with a batch callback or a latest value.
+  void
+  trigger_guard_condition() override
+  {
+    // The pending wake-up is cleared before the buffer is drained, see take_batch()
+    const bool coalesce = any_callback_.is_batch_callback() || coalesce_wake_ups_;
+    if (!coalesce || !wake_up_pending_.exchange(true)) {
+      this->gc_.trigger();
+    }
+  }
+
+  /// Take all the messages of the buffer, or return nullptr if it's empty.
+  std::shared_ptr<void>
+  take_batch()
+  {
+    // Messages added from now on trigger the guard condition again
+    wake_up_pending_.store(false);
+    auto batch = std::make_shared<TakenBatch>();
+    while (auto shared_msg = this->buffer_->consume_shared()) {
+      const rclcpp::MessageLineage lineage = this->take_lineage(shared_msg.get());
+      if (this->drop_by_age(shared_msg.get())) {
+        continue;
+      }
+      if (lineage.is_valid()) {
+        batch->lineage = lineage;
+      }
+      batch->messages.push_back(std::move(shared_msg));
+    }
+    if (batch->messages.empty()) {
+      return nullptr;
+    }
+    return std::static_pointer_cast<void>(batch);
+  }
+
   template<typename T>
   typename std::enable_if<std::is_same<T, rcl_serialized_message_t>::value, void>::type
   execute_impl(std::shared_ptr<void> & data)
@@ -146,25 +239,92 @@ protected:
     if (!data) {
       return;
     }
+    if (this->is_paused()) {
+      // Queued before the subscription was paused
+      this->add_paused_dropped_count(
+        any_callback_.is_batch_callback() ?
+        std::static_pointer_cast<TakenBatch>(data)->messages.size() : 1u);
+      return;
+    }
+
+    if (any_callback_.is_batch_callback()) {
+      auto batch = std::static_pointer_cast<TakenBatch>(data);
+#ifndef TRACETOOLS_DISABLED
+      for (const auto & message : batch->messages) {
+        TRACEPOINT(
+          rclcpp_intra_take,
+          static_cast<const void *>(this),
+          static_cast<const void *>(message.get()));
+      }
+#endif
+      if (latest_message_) {
+        store_latest_message(batch->messages.back());
+      }
+      rclcpp::MessageLineageScope lineage_scope(batch->lineage);
+      any_callback_.dispatch_intra_process_batch(batch->messages);
+      return;
+    }
 
     rmw_message_info_t msg_info;
     msg_info.publisher_gid = {0, {0}};
     msg_info.from_intra_process = true;
 
-    auto shared_ptr = std::static_pointer_cast<std::pair<ConstMessageSharedPtr, MessageUniquePtr>>(
-      data);
+    auto taken_message = std::static_pointer_cast<TakenMessage>(data);
+    rclcpp::MessageInfo message_info(msg_info);
+    message_info.set_lineage(taken_message->lineage);
+    rclcpp::MessageLineageScope lineage_scope(taken_message->lineage);
 
     if (any_callback_.use_take_shared_method()) {
-      ConstMessageSharedPtr shared_msg = shared_ptr->first;
-      any_callback_.dispatch_intra_process(shared_msg, msg_info);
+      ConstMessageSharedPtr shared_msg = taken_message->shared_msg;
+      TRACEPOINT(
+        rclcpp_intra_take,
+        static_cast<const void *>(this),
+        static_cast<const void *>(shared_msg.get()));
+      if (latest_message_) {
+        store_latest_message(shared_msg);
+      }
+      any_callback_.dispatch_intra_process(shared_msg, message_info);
+    } else {
+      MessageUniquePtr unique_msg = std::move(taken_message->unique_msg);
+      TRACEPOINT(
+        rclcpp_intra_take,
+        static_cast<const void *>(this),
+        static_cast<const void *>(unique_msg.get()));
+      if (latest_message_) {
+        // The callback owns the message, so the slot gets a copy
+        store_latest_message(std::make_shared<const SubscribedType>(*unique_msg));
+      }
+      any_callback_.dispatch_intra_process(std::move(unique_msg), message_info);
+    }
+    taken_message.reset();
+  }
+
+  /// Store the message in the slot, converted to the ROS message type with a TypeAdapter.
+  void
+  store_latest_message(const ConstMessageSharedPtr & message)
+  {
+    if constexpr (std::is_same<SubscribedType, ROSMessageType>::value) {
+      latest_message_->store(message);
     } else {
-      MessageUniquePtr unique_msg = std::move(shared_ptr->second);
-      any_callback_.dispatch_intra_process(std::move(unique_msg), msg_info);
+      using TypeAdapterT = rclcpp::TypeAdapter<SubscribedType, ROSMessageType>;
+      if (auto viewed_message = rclcpp::detail::get_viewed_ros_message<TypeAdapterT>(*message)) {
+        latest_message_->store(std::move(viewed_message));
+        return;
+      }
+      auto ros_message = std::make_shared<ROSMessageType>();
+      TypeAdapterT::convert_to_ros_message(*message, *ros_message);
+      latest_message_->store(std::move(ros_message));
     }
-    shared_ptr.reset();
   }
 
   AnySubscriptionCallback<MessageT, Alloc> any_callback_;
+  /// Whether the buffer only keeps the latest value, so a single wake-up is needed to take it.
+  const bool coalesce_wake_ups_;
+  /// Whether the guard condition was triggered for messages not taken yet, with a batch callback
+  /// or a latest value buffer.
+  std::atomic<bool> wake_up_pending_{false};
+  /// Slot of rclcpp::Subscription::get_latest_message(), nullptr if it isn't kept.
+  typename rclcpp::LatestMessage<ROSMessageType>::SharedPtr latest_message_;
 };
 
 }  // namespace experimental
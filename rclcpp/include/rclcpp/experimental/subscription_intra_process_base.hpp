@@ -16,23 +16,61 @@
 #define RCLCPP__EXPERIMENTAL__SUBSCRIPTION_INTRA_PROCESS_BASE_HPP_
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include "rcl/wait.h"
 #include "rmw/impl/cpp/demangle.hpp"
 
+#include "rclcpp/content_filter.hpp"
+#include "rclcpp/experimental/buffers/buffer_metrics.hpp"
 #include "rclcpp/guard_condition.hpp"
 #include "rclcpp/logging.hpp"
 #include "rclcpp/qos.hpp"
+#include "rclcpp/rate_limit.hpp"
 #include "rclcpp/waitable.hpp"
 
 namespace rclcpp
 {
+
+class CallbackGroup;
+
 namespace experimental
 {
 
+/// Record the intra-process subscriptions notified of a message by the calling thread.
+/**
+ * While the scope is alive, each intra-process subscription notified of a new message by
+ * this thread, e.g. by a publish() from a callback, is appended once to the given vector,
+ * as a pointer to its Waitable.
+ * Messages dispatched directly, see SubscriptionIntraProcessBase::set_direct_dispatch(),
+ * aren't recorded.
+ * Scopes nest, only the innermost one records.
+ *
+ * Used by the executors to run the subscriptions fed by a callback right after it,
+ * see rclcpp::ExecutorOptions::dataflow_chain_depth.
+ */
+class IntraProcessDeliveryScope
+{
+public:
+  RCLCPP_PUBLIC
+  explicit IntraProcessDeliveryScope(std::vector<const rclcpp::Waitable *> & deliveries);
+
+  RCLCPP_PUBLIC
+  ~IntraProcessDeliveryScope();
+
+  IntraProcessDeliveryScope(const IntraProcessDeliveryScope &) = delete;
+  IntraProcessDeliveryScope & operator=(const IntraProcessDeliveryScope &) = delete;
+
+private:
+  std::vector<const rclcpp::Waitable *> * previous_deliveries_;
+};
+
 class SubscriptionIntraProcessBase : public rclcpp::Waitable
 {
 public:
@@ -49,7 +87,10 @@ public:
     const std::string & topic_name,
     const rclcpp::QoS & qos_profile)
   : gc_(context), topic_name_(topic_name), qos_profile_(qos_profile)
-  {}
+  {
+    // Each message triggers the guard condition, one wake up per wait is enough.
+    gc_.set_trigger_coalescing(true);
+  }
 
   RCLCPP_PUBLIC
   virtual ~SubscriptionIntraProcessBase() = default;
@@ -82,6 +123,17 @@ public:
   bool
   use_take_shared_method() const = 0;
 
+  /// Get the occupancy and traffic counters of the buffer of this subscription.
+  /**
+   * \return the metrics of the buffer, all zero if it doesn't keep them
+   */
+  virtual
+  rclcpp::experimental::buffers::BufferMetrics
+  get_buffer_metrics() const
+  {
+    return rclcpp::experimental::buffers::BufferMetrics();
+  }
+
   RCLCPP_PUBLIC
   const char *
   get_topic_name() const;
@@ -90,6 +142,112 @@ public:
   QoS
   get_actual_qos() const;
 
+  /// Execute the callback on the thread providing a message, instead of waking the executor.
+  /**
+   * A message is only dispatched directly when the callback group of the subscription can be
+   * reserved, which a reentrant one always can, and when fewer than max_depth direct
+   * dispatches are nested on the calling thread, e.g. in a chain of components publishing
+   * from their callbacks.
+   * Otherwise the message is queued and the executor woken as usual.
+   *
+   * Must be called at most once, before messages are provided.
+   *
+   * \param[in] callback_group the callback group of the subscription.
+   * \param[in] max_depth maximum number of nested direct dispatches on a thread, 0 to disable
+   *   direct dispatch.
+   */
+  RCLCPP_PUBLIC
+  void
+  set_direct_dispatch(std::weak_ptr<rclcpp::CallbackGroup> callback_group, size_t max_depth);
+
+  /// Return true if the messages are dispatched directly when possible.
+  RCLCPP_PUBLIC
+  bool
+  is_direct_dispatch_enabled() const;
+
+  /// Set the rate limiter of the subscription, shared with its inter-process messages.
+  /**
+   * Must be called at most once, before messages are provided.
+   *
+   * \param[in] rate_limiter the rate limiter, nullptr to keep every message.
+   */
+  RCLCPP_PUBLIC
+  void
+  set_rate_limiter(std::shared_ptr<rclcpp::RateLimiter> rate_limiter);
+
+  /// Return true if the rate limit drops the message provided, called before it is queued.
+  RCLCPP_PUBLIC
+  bool
+  drop_by_rate_limit();
+
+  /// Pause or resume the delivery of the messages, see rclcpp::SubscriptionBase::pause().
+  RCLCPP_PUBLIC
+  void
+  set_paused(bool paused);
+
+  RCLCPP_PUBLIC
+  bool
+  is_paused() const;
+
+  /// Return true if the subscription is paused, counting the message provided as dropped.
+  RCLCPP_PUBLIC
+  bool
+  drop_by_pause();
+
+  /// Count the messages queued before the subscription was paused, dropped by execute().
+  RCLCPP_PUBLIC
+  void
+  add_paused_dropped_count(uint64_t count);
+
+  /// Return the number of messages dropped while the subscription was paused.
+  RCLCPP_PUBLIC
+  uint64_t
+  get_paused_dropped_count() const;
+
+  /// Drop the messages queued for longer than the maximum age when they're taken.
+  /**
+   * The queue time of the last 2 * depth messages is kept, keyed by their address.
+   * Must be called at most once, before messages are provided.
+   *
+   * \param[in] max_message_age the maximum age, 0 to deliver the messages whatever their age.
+   */
+  RCLCPP_PUBLIC
+  void
+  set_max_message_age(std::chrono::nanoseconds max_message_age);
+
+  /// Record the time a message is queued at, called before it's added to the buffer.
+  RCLCPP_PUBLIC
+  void
+  record_queue_time(const void * message);
+
+  /// Return true if a message taken from the buffer was queued for too long, and count it.
+  RCLCPP_PUBLIC
+  bool
+  drop_by_age(const void * message);
+
+  /// Return the number of messages dropped for being older than the maximum age.
+  RCLCPP_PUBLIC
+  uint64_t
+  get_expired_message_count() const;
+
+  /// Set the content filter of the subscription, evaluated before the messages are queued.
+  /**
+   * This function is thread-safe.
+   *
+   * \param[in] content_filter the content filter, nullptr to keep every message.
+   */
+  RCLCPP_PUBLIC
+  void
+  set_content_filter(std::shared_ptr<const rclcpp::ContentFilter> content_filter);
+
+  /// Return the content filter of the subscription, nullptr if it keeps every message.
+  /**
+   * This function is thread-safe.
+   */
+  RCLCPP_PUBLIC
+  std::shared_ptr<const rclcpp::ContentFilter>
+  get_content_filter() const;
+
   /// Set a callback to be called when each new message arrives.
   /**
    * The callback receives a size_t which is the number of messages received
@@ -180,6 +338,19 @@ protected:
   virtual void
   trigger_guard_condition() = 0;
 
+  /// Notify a new message, executed right away with direct dispatch or left to the executor.
+  RCLCPP_PUBLIC
+  void
+  notify_new_message();
+
+  /// Take and execute the next message on this thread, if direct dispatch allows it.
+  /**
+   * \return true if the message was executed, false if the executor has to be woken.
+   */
+  RCLCPP_PUBLIC
+  bool
+  try_dispatch_direct();
+
   void
   invoke_on_new_message()
   {
@@ -194,6 +365,29 @@ protected:
 private:
   std::string topic_name_;
   QoS qos_profile_;
+
+  std::weak_ptr<rclcpp::CallbackGroup> direct_dispatch_callback_group_;
+  /// Set last by set_direct_dispatch(), 0 while direct dispatch is disabled.
+  std::atomic<size_t> direct_dispatch_max_depth_{0};
+
+  std::shared_ptr<rclcpp::RateLimiter> rate_limiter_;
+  std::shared_ptr<const rclcpp::ContentFilter> content_filter_;
+
+  std::atomic<bool> paused_{false};
+  std::atomic<uint64_t> paused_dropped_count_{0};
+
+  struct QueuedMessage
+  {
+    const void * message = nullptr;
+    std::chrono::steady_clock::time_point queue_time;
+  };
+
+  std::chrono::nanoseconds max_message_age_{0};
+  std::mutex queued_messages_mutex_;
+  std::vector<QueuedMessage> queued_messages_;
+  /// Index of the entry recorded next, overwriting the oldest one.
+  size_t next_queued_message_ = 0;
+  std::atomic<uint64_t> expired_message_count_{0};
 };
 
 }  // namespace experimental
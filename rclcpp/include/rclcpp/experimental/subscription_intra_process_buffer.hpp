@@ -28,9 +28,12 @@
 #include "rclcpp/experimental/create_intra_process_buffer.hpp"
 #include "rclcpp/experimental/subscription_intra_process_base.hpp"
 #include "rclcpp/experimental/ros_message_intra_process_buffer.hpp"
+#include "rclcpp/message_lineage.hpp"
 #include "rclcpp/qos.hpp"
 #include "rclcpp/type_support_decl.hpp"
 
+#include "tracetools/tracetools.h"
+
 namespace rclcpp
 {
 namespace experimental
@@ -77,7 +80,11 @@ public:
     rclcpp::Context::SharedPtr context,
     const std::string & topic_name,
     const rclcpp::QoS & qos_profile,
-    rclcpp::IntraProcessBufferType buffer_type)
+    rclcpp::IntraProcessBufferType buffer_type,
+    rclcpp::IntraProcessBufferImplementation buffer_implementation =
+    rclcpp::IntraProcessBufferImplementation::Default,
+    std::shared_ptr<rclcpp::experimental::buffers::BufferImplementationFactoryBase>
+    buffer_factory = nullptr)
   : SubscriptionROSMsgIntraProcessBuffer<ROSMessageType, ROSMessageTypeAllocator,
       ROSMessageTypeDeleter>(
       context, topic_name, qos_profile),
@@ -90,7 +97,13 @@ public:
         SubscribedTypeDeleter>(
       buffer_type,
       qos_profile,
-      std::make_shared<Alloc>(subscribed_type_allocator_));
+      std::make_shared<Alloc>(subscribed_type_allocator_),
+      buffer_implementation,
+      std::move(buffer_factory));
+    TRACEPOINT(
+      rclcpp_ipb_to_subscription,
+      static_cast<const void *>(buffer_.get()),
+      static_cast<const void *>(this));
   }
 
   bool
@@ -100,6 +113,27 @@ public:
     return buffer_->has_data();
   }
 
+  /// True if the subscribed type can be a view of the ROS message, see rclcpp::TypeAdapter.
+  static constexpr bool is_view_type_adapter = rclcpp::detail::is_view_type_adapter<
+    rclcpp::TypeAdapter<SubscribedType, ROSMessageType>>::value;
+
+  SubscribedTypeUniquePtr
+  convert_ros_message_to_subscribed_type_unique_ptr(const ConstMessageSharedPtr & msg)
+  {
+    if constexpr (!std::is_same<SubscribedType, ROSMessageType>::value) {
+      auto ptr = SubscribedTypeAllocatorTraits::allocate(subscribed_type_allocator_, 1);
+      SubscribedTypeAllocatorTraits::construct(subscribed_type_allocator_, ptr);
+      // A view of the message for the adapters allowing it, which avoids copying its data
+      rclcpp::detail::convert_shared_to_custom<
+        rclcpp::TypeAdapter<SubscribedType, ROSMessageType>>(msg, *ptr);
+      return SubscribedTypeUniquePtr(ptr, subscribed_type_deleter_);
+    } else {
+      throw std::runtime_error(
+              "convert_ros_message_to_subscribed_type_unique_ptr "
+              "unexpectedly called without TypeAdapter");
+    }
+  }
+
   SubscribedTypeUniquePtr
   convert_ros_message_to_subscribed_type_unique_ptr(const ROSMessageType & msg)
   {
@@ -119,42 +153,61 @@ public:
   provide_intra_process_message(ConstMessageSharedPtr message) override
   {
     if constexpr (std::is_same<SubscribedType, ROSMessageType>::value) {
+      record_queued_message(message.get());
       buffer_->add_shared(std::move(message));
-      trigger_guard_condition();
     } else {
-      buffer_->add_shared(convert_ros_message_to_subscribed_type_unique_ptr(*message));
-      trigger_guard_condition();
+      auto converted_message = convert_ros_message_to_subscribed_type_unique_ptr(message);
+      record_queued_message(converted_message.get());
+      buffer_->add_shared(std::move(converted_message));
     }
-    this->invoke_on_new_message();
+    this->notify_new_message();
   }
 
   void
   provide_intra_process_message(MessageUniquePtr message) override
   {
     if constexpr (std::is_same<SubscribedType, ROSMessageType>::value) {
+      record_queued_message(message.get());
       buffer_->add_unique(std::move(message));
-      trigger_guard_condition();
     } else {
-      buffer_->add_unique(convert_ros_message_to_subscribed_type_unique_ptr(*message));
-      trigger_guard_condition();
+      SubscribedTypeUniquePtr converted_message;
+      if constexpr (is_view_type_adapter) {
+        // The view shares the ownership of the message instead of copying its data
+        converted_message = convert_ros_message_to_subscribed_type_unique_ptr(
+          ConstMessageSharedPtr(std::move(message)));
+      } else {
+        converted_message = convert_ros_message_to_subscribed_type_unique_ptr(*message);
+      }
+      record_queued_message(converted_message.get());
+      buffer_->add_unique(std::move(converted_message));
     }
-    this->invoke_on_new_message();
+    this->notify_new_message();
   }
 
   void
   provide_intra_process_data(ConstDataSharedPtr message)
   {
+    record_queued_message(message.get());
     buffer_->add_shared(std::move(message));
-    trigger_guard_condition();
-    this->invoke_on_new_message();
+    this->notify_new_message();
   }
 
   void
   provide_intra_process_data(SubscribedTypeUniquePtr message)
   {
+    record_queued_message(message.get());
     buffer_->add_unique(std::move(message));
-    trigger_guard_condition();
-    this->invoke_on_new_message();
+    this->notify_new_message();
+  }
+
+  /// Set the tracker of the flows of the messages provided, nullptr to not track them.
+  /**
+   * Must be called at most once, before messages are provided.
+   */
+  void
+  set_lineage_tracker(std::shared_ptr<rclcpp::MessageLineageTracker> lineage_tracker)
+  {
+    lineage_tracker_ = std::move(lineage_tracker);
   }
 
   bool
@@ -163,6 +216,12 @@ public:
     return buffer_->use_take_shared_method();
   }
 
+  rclcpp::experimental::buffers::BufferMetrics
+  get_buffer_metrics() const override
+  {
+    return buffer_->get_metrics();
+  }
+
 protected:
   void
   trigger_guard_condition() override
@@ -170,9 +229,30 @@ protected:
     this->gc_.trigger();
   }
 
+  /// Record the flow and the queue time of a message before it's queued, keyed by its address.
+  void
+  record_queued_message(const void * message)
+  {
+    if (lineage_tracker_) {
+      lineage_tracker_->record(message);
+    }
+    this->record_queue_time(message);
+  }
+
+  /// Return the flow of a message taken from the buffer, invalid if it isn't tracked.
+  rclcpp::MessageLineage
+  take_lineage(const void * message)
+  {
+    if (!lineage_tracker_) {
+      return rclcpp::MessageLineage();
+    }
+    return lineage_tracker_->take(message);
+  }
+
   BufferUniquePtr buffer_;
   SubscribedTypeAllocator subscribed_type_allocator_;
   SubscribedTypeDeleter subscribed_type_deleter_;
+  std::shared_ptr<rclcpp::MessageLineageTracker> lineage_tracker_;
 };
 
 }  // namespace experimental
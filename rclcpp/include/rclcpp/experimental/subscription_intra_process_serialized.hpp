@@ -0,0 +1,103 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXPERIMENTAL__SUBSCRIPTION_INTRA_PROCESS_SERIALIZED_HPP_
+#define RCLCPP__EXPERIMENTAL__SUBSCRIPTION_INTRA_PROCESS_SERIALIZED_HPP_
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "rcl/wait.h"
+
+#include "rclcpp/context.hpp"
+#include "rclcpp/experimental/buffers/ring_buffer_implementation.hpp"
+#include "rclcpp/experimental/lazy_serialized_message.hpp"
+#include "rclcpp/experimental/subscription_intra_process_base.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/qos.hpp"
+#include "rclcpp/serialized_message.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace experimental
+{
+
+/// Intra-process part of a subscription to serialized messages, see GenericSubscription.
+/**
+ * The messages of the typed publishers are serialized when this subscription executes
+ * its callback, once for all the subscriptions of serialized messages.
+ * The serialized messages are shared between these subscriptions, a callback must not
+ * modify the message it's given.
+ */
+class SubscriptionIntraProcessSerialized : public SubscriptionIntraProcessBase
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(SubscriptionIntraProcessSerialized)
+
+  using Callback = std::function<void (std::shared_ptr<rclcpp::SerializedMessage>)>;
+
+  /// Create a subscription storing up to qos_profile.depth() messages.
+  RCLCPP_PUBLIC
+  SubscriptionIntraProcessSerialized(
+    Callback callback,
+    rclcpp::Context::SharedPtr context,
+    const std::string & topic_name,
+    const rclcpp::QoS & qos_profile);
+
+  RCLCPP_PUBLIC
+  virtual ~SubscriptionIntraProcessSerialized() = default;
+
+  RCLCPP_PUBLIC
+  bool
+  is_ready(rcl_wait_set_t * wait_set) override;
+
+  RCLCPP_PUBLIC
+  std::shared_ptr<void>
+  take_data() override;
+
+  RCLCPP_PUBLIC
+  void
+  execute(std::shared_ptr<void> & data) override;
+
+  RCLCPP_PUBLIC
+  bool
+  use_take_shared_method() const override;
+
+  RCLCPP_PUBLIC
+  rclcpp::experimental::buffers::BufferMetrics
+  get_buffer_metrics() const override;
+
+  /// Store a message, dropping the oldest one if the buffer is full.
+  RCLCPP_PUBLIC
+  void
+  provide_serialized_message(LazySerializedMessage::SharedPtr message);
+
+protected:
+  RCLCPP_PUBLIC
+  void
+  trigger_guard_condition() override;
+
+private:
+  RCLCPP_DISABLE_COPY(SubscriptionIntraProcessSerialized)
+
+  Callback callback_;
+  rclcpp::experimental::buffers::RingBufferImplementation<LazySerializedMessage::SharedPtr> buffer_;
+};
+
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__SUBSCRIPTION_INTRA_PROCESS_SERIALIZED_HPP_
@@ -0,0 +1,249 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXPERIMENTAL__TIMERS_MANAGER_HPP_
+#define RCLCPP__EXPERIMENTAL__TIMERS_MANAGER_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/context.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/timer.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace experimental
+{
+
+/**
+ * \brief This class provides a way for storing and executing timer objects.
+ * It provides APIs to suit the needs of different applications and execution models.
+ * All public APIs provided by this class are thread-safe.
+ *
+ * Timers management
+ * This class provides APIs to add/remove timers to/from an internal storage.
+ * It keeps a list of weak pointers from added timers, and locks them only when
+ * they need to be executed or modified.
+ * Timers pointers are stored in a contiguous container to keep the cost of
+ * scanning for the next expiring timer low.
+ *
+ * Timers execution
+ * The most efficient use of this class consists in letting a TimersManager object
+ * to spawn a thread where timers are monitored and optionally executed.
+ * This can be controlled via the `start` and `stop` methods.
+ * Ready timers can either be executed or an on_ready_callback can be used to notify
+ * other entities that they are ready and need to be executed.
+ * Other APIs allow to directly execute a given timer.
+ */
+class TimersManager
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(TimersManager)
+
+  /// Maximum time to wait when no timer is going to expire.
+  static constexpr std::chrono::nanoseconds MAX_TIME = std::chrono::hours(90);
+
+  /**
+   * \brief Construct a new TimersManager object
+   *
+   * \param context custom context to be used.
+   * Shared ownership of the context is held until destruction.
+   * \param on_ready_callback The timers on ready callback. The presence of this function
+   * indicates what to do when the TimersManager is running and a timer becomes ready.
+   * The TimersManager is considered "running" when the `start` method has been called.
+   * If it's callable, it will be invoked instead of the timer callback.
+   * If it's not callable, then the TimersManager will
+   * directly execute timers when they are ready.
+   * All the methods that execute a given timer (e.g. `execute_head_timer`
+   * or `execute_ready_timer`) without the TimersManager being `running`, i.e.
+   * without actually explicitly waiting for the timer to become ready, will ignore this
+   * callback.
+   */
+  RCLCPP_PUBLIC
+  TimersManager(
+    std::shared_ptr<rclcpp::Context> context,
+    std::function<void(const rclcpp::TimerBase *)> on_ready_callback = nullptr);
+
+  /**
+   * \brief Destruct the TimersManager object making sure to stop thread and release memory.
+   */
+  RCLCPP_PUBLIC
+  ~TimersManager();
+
+  /**
+   * \brief Adds a new timer to the storage, maintaining weak ownership of it.
+   * Function is thread safe and it can be called regardless of the state of the timers thread.
+   *
+   * \param timer the timer to add.
+   * \throws std::invalid_argument if timer is a nullptr.
+   */
+  RCLCPP_PUBLIC
+  void
+  add_timer(rclcpp::TimerBase::SharedPtr timer);
+
+  /**
+   * \brief Remove a single timer from the object storage.
+   * Will do nothing if the timer was not being stored here.
+   * Function is thread safe and it can be called regardless of the state of the timers thread.
+   *
+   * \param timer the timer to remove.
+   */
+  RCLCPP_PUBLIC
+  void
+  remove_timer(rclcpp::TimerBase::SharedPtr timer);
+
+  /**
+   * \brief Remove all the timers stored in the object.
+   * Function is thread safe and it can be called regardless of the state of the timers thread.
+   */
+  RCLCPP_PUBLIC
+  void
+  clear();
+
+  /**
+   * \brief Starts a thread that takes care of executing the timers stored in this object.
+   * Function will throw an error if the timers thread was already running.
+   *
+   * \throws std::runtime_error if the timers thread was already running.
+   */
+  RCLCPP_PUBLIC
+  void
+  start();
+
+  /**
+   * \brief Stops the timers thread.
+   * Will do nothing if the timer thread was not running.
+   */
+  RCLCPP_PUBLIC
+  void
+  stop();
+
+  /**
+   * \brief Get the number of timers that are currently ready.
+   * This function is thread safe.
+   *
+   * \return size_t number of ready timers.
+   * \throws std::runtime_error if the timers thread was already running.
+   */
+  RCLCPP_PUBLIC
+  size_t
+  get_number_ready_timers();
+
+  /**
+   * \brief Get the amount of time before the next timer triggers.
+   * This function is thread safe.
+   *
+   * \return std::chrono::nanoseconds to wait,
+   * the returned value could be negative if the timer is already expired
+   * or MAX_TIME if there are no timers stored in the object.
+   * \throws std::runtime_error if the timers thread was already running.
+   */
+  RCLCPP_PUBLIC
+  std::chrono::nanoseconds
+  get_head_timeout();
+
+  /**
+   * \brief Executes all the timers currently ready when the function was invoked.
+   * This function is thread safe.
+   *
+   * \return size_t number of timers that were executed.
+   * \throws std::runtime_error if the timers thread was already running.
+   */
+  RCLCPP_PUBLIC
+  size_t
+  execute_ready_timers();
+
+  /**
+   * \brief Executes head timer if ready.
+   * This function is thread safe.
+   *
+   * \return true if head timer was ready.
+   * \throws std::runtime_error if the timers thread was already running.
+   */
+  RCLCPP_PUBLIC
+  bool
+  execute_head_timer();
+
+  /**
+   * \brief Executes timer identified by its ID.
+   * This function is thread safe.
+   * The timer is expected to have been marked as called by the timers thread, i.e. this
+   * is meant to be used together with the `on_ready_callback`.
+   *
+   * \param timer_id the timer ID of the timer to execute
+   */
+  RCLCPP_PUBLIC
+  void
+  execute_ready_timer(const rclcpp::TimerBase * timer_id);
+
+private:
+  RCLCPP_DISABLE_COPY(TimersManager)
+
+  /**
+   * \brief Implements a loop that keeps executing ready timers.
+   * This function is executed in the timers thread.
+   */
+  void
+  run_timers();
+
+  /**
+   * \brief Get the timer that expires first, pruning timers that are not valid anymore.
+   * This function is not thread safe, acquire the timers_mutex_ before calling it.
+   *
+   * \param[out] timeout time until the returned timer triggers, or MAX_TIME if none.
+   * \return the first timer to expire or nullptr if there are no valid timers.
+   */
+  rclcpp::TimerBase::SharedPtr
+  get_head_timer_unsafe(std::chrono::nanoseconds & timeout);
+
+  /**
+   * \brief Marks all the currently ready timers as called and collects them.
+   * This function is not thread safe, acquire the timers_mutex_ before calling it.
+   *
+   * \return the timers that have to be executed or notified.
+   */
+  std::vector<rclcpp::TimerBase::SharedPtr>
+  collect_ready_timers_unsafe();
+
+  // Callback to be called when timer is ready
+  std::function<void(const rclcpp::TimerBase *)> on_ready_callback_ = nullptr;
+
+  // Thread used to run the timers execution task
+  std::thread timers_thread_;
+  // Protects access to timers
+  std::mutex timers_mutex_;
+  // Notifies the timers thread whenever timers are added/removed
+  std::condition_variable timers_cv_;
+  // Flag used as predicate by timers_cv_ that denotes one or more timers being added/removed
+  bool timers_updated_ {false};
+  // Indicates whether the timers thread is currently running or not
+  std::atomic<bool> running_ {false};
+  // Parent context used to understand if ROS is still active
+  std::shared_ptr<rclcpp::Context> context_;
+  // Timers storage
+  std::vector<rclcpp::TimerBase::WeakPtr> weak_timers_;
+};
+
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__TIMERS_MANAGER_HPP_
@@ -0,0 +1,103 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__EXTERN_TEMPLATES_HPP_
+#define RCLCPP__EXTERN_TEMPLATES_HPP_
+
+#include <memory>
+#include <string>
+
+#include "rcl_interfaces/msg/parameter_event.hpp"
+#include "rosgraph_msgs/msg/clock.hpp"
+#include "statistics_msgs/msg/metrics_message.hpp"
+
+#include "rclcpp/any_subscription_callback.hpp"
+#include "rclcpp/message_memory_strategy.hpp"
+#include "rclcpp/node.hpp"
+#include "rclcpp/publisher.hpp"
+#include "rclcpp/publisher_options.hpp"
+#include "rclcpp/qos.hpp"
+#include "rclcpp/subscription.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+/// Declare the templates of rclcpp explicitly instantiated for a message type elsewhere.
+/**
+ * With these extern template declarations, the translation units including them don't
+ * instantiate again the publisher, the subscription and the subscription callback for
+ * the message type, with the default allocator, and they use the instantiations of a
+ * single library instead, made with RCLCPP_INSTANTIATE_MESSAGE_TEMPLATES().
+ * Only the callback independent parts can be shared this way, the callbacks given to
+ * rclcpp::Node::create_subscription() are still compiled where they are written.
+ *
+ * For example, a library of instantiations for the common messages of a project has a
+ * header with:
+ *
+ * ```cpp
+ * RCLCPP_DECLARE_MESSAGE_TEMPLATES(std_msgs::msg::String, MY_MSGS_TEMPLATES_PUBLIC);
+ * ```
+ *
+ * which is included by the users of the message instead of (or after) rclcpp.hpp, and a
+ * source file with:
+ *
+ * ```cpp
+ * RCLCPP_INSTANTIATE_MESSAGE_TEMPLATES(std_msgs::msg::String);
+ * ```
+ *
+ * where the visibility macro exports the symbols of the library, like RCLCPP_PUBLIC.
+ * It may be left empty on platforms exporting all the symbols.
+ *
+ * Note: this macro needs to be used in the root namespace.
+ *
+ * \param MessageT ROS message type, type adapters aren't supported.
+ * \param VISIBILITY visibility attribute of the library holding the instantiations.
+ */
+#define RCLCPP_DECLARE_MESSAGE_TEMPLATES(MessageT, VISIBILITY) \
+  extern template class VISIBILITY rclcpp::Publisher<MessageT>; \
+  extern template class VISIBILITY rclcpp::Subscription<MessageT>; \
+  extern template class VISIBILITY rclcpp::AnySubscriptionCallback<MessageT>; \
+  extern template class VISIBILITY \
+  rclcpp::message_memory_strategy::MessageMemoryStrategy<MessageT>; \
+  extern template VISIBILITY std::shared_ptr<rclcpp::Publisher<MessageT>> \
+  rclcpp::Node::create_publisher<MessageT>( \
+    const std::string &, \
+    const rclcpp::QoS &, \
+    const rclcpp::PublisherOptionsWithAllocator<std::allocator<void>> &)
+
+/// Explicitly instantiate the templates declared by RCLCPP_DECLARE_MESSAGE_TEMPLATES().
+/**
+ * It is used once, in a source file of the library declaring the templates, after
+ * including the header with the declarations.
+ *
+ * Note: this macro needs to be used in the root namespace.
+ *
+ * \param MessageT ROS message type, type adapters aren't supported.
+ */
+#define RCLCPP_INSTANTIATE_MESSAGE_TEMPLATES(MessageT) \
+  template class rclcpp::Publisher<MessageT>; \
+  template class rclcpp::Subscription<MessageT>; \
+  template class rclcpp::AnySubscriptionCallback<MessageT>; \
+  template class rclcpp::message_memory_strategy::MessageMemoryStrategy<MessageT>; \
+  template std::shared_ptr<rclcpp::Publisher<MessageT>> \
+  rclcpp::Node::create_publisher<MessageT>( \
+    const std::string &, \
+    const rclcpp::QoS &, \
+    const rclcpp::PublisherOptionsWithAllocator<std::allocator<void>> &)
+
+// The messages of the interfaces of rclcpp itself are instantiated in the library.
+RCLCPP_DECLARE_MESSAGE_TEMPLATES(rcl_interfaces::msg::ParameterEvent, RCLCPP_PUBLIC);
+RCLCPP_DECLARE_MESSAGE_TEMPLATES(rosgraph_msgs::msg::Clock, RCLCPP_PUBLIC);
+RCLCPP_DECLARE_MESSAGE_TEMPLATES(statistics_msgs::msg::MetricsMessage, RCLCPP_PUBLIC);
+
+#endif  // RCLCPP__EXTERN_TEMPLATES_HPP_
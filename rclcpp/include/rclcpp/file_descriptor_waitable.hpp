@@ -0,0 +1,213 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__FILE_DESCRIPTOR_WAITABLE_HPP_
+#define RCLCPP__FILE_DESCRIPTOR_WAITABLE_HPP_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include "rcl/wait.h"
+
+#include "rclcpp/callback_group.hpp"
+#include "rclcpp/context.hpp"
+#include "rclcpp/guard_condition.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/visibility_control.hpp"
+#include "rclcpp/waitable.hpp"
+
+namespace rclcpp
+{
+
+namespace detail
+{
+class FileDescriptorMonitor;
+}  // namespace detail
+
+/// Events of a file descriptor watched by a FileDescriptorWaitable.
+struct FileDescriptorEvents
+{
+  /// Data can be read without blocking.
+  bool readable = false;
+  /// Data can be written without blocking.
+  bool writable = false;
+  /// An error or a hang up happened, only reported to the callback.
+  bool error = false;
+};
+
+/// Waitable ready when a file descriptor, e.g. a socket or a device, is readable or writable.
+/**
+ * The callback is executed by the executor, like the ones of the subscriptions, so that the
+ * drivers of sockets, CAN or serial devices do their I/O themselves instead of each having a
+ * thread handing the data over.
+ *
+ * The middleware wait sets can't wait on file descriptors, so a single thread of the process
+ * polls all the file descriptors of the waitables and triggers the guard condition of those
+ * which became ready, or their on ready callback with the events executor.
+ * Like with EPOLLONESHOT, a file descriptor isn't polled again until the callback reporting
+ * its events returned, so the callback should read, or write, until it would block.
+ *
+ * The file descriptor isn't owned by the waitable and must stay open while it's alive.
+ * Only supported on POSIX systems.
+ */
+class FileDescriptorWaitable : public rclcpp::Waitable
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(FileDescriptorWaitable)
+
+  /// Callback executed with the events of the file descriptor.
+  using Callback = std::function<void (int, const FileDescriptorEvents &)>;
+
+  enum class EntityType : std::size_t
+  {
+    FileDescriptor,
+  };
+
+  /// Start watching the file descriptor.
+  /**
+   * \param[in] fd the file descriptor to watch.
+   * \param[in] events the events waited for, readable and/or writable.
+   * \param[in] callback the callback executed with the events which happened.
+   * \param[in] context the context of the guard condition waking the executor.
+   * \throws std::invalid_argument if the file descriptor is negative, if no event is waited
+   *   for or if the callback is not callable.
+   * \throws std::runtime_error on Windows.
+   */
+  RCLCPP_PUBLIC
+  FileDescriptorWaitable(
+    int fd,
+    const FileDescriptorEvents & events,
+    Callback callback,
+    rclcpp::Context::SharedPtr context = rclcpp::contexts::get_global_default_context());
+
+  /// Stop watching the file descriptor, waiting for the monitor thread to release it.
+  RCLCPP_PUBLIC
+  virtual ~FileDescriptorWaitable();
+
+  /// Return the file descriptor watched.
+  RCLCPP_PUBLIC
+  int
+  get_fd() const;
+
+  /// Change the events waited for, e.g. to wait for writable only while there's data to send.
+  /**
+   * \throws std::invalid_argument if no event is waited for.
+   */
+  RCLCPP_PUBLIC
+  void
+  set_events(const FileDescriptorEvents & events);
+
+  /// Return the events waited for.
+  RCLCPP_PUBLIC
+  FileDescriptorEvents
+  get_events() const;
+
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_ready_guard_conditions() override {return 1;}
+
+  RCLCPP_PUBLIC
+  void
+  add_to_wait_set(rcl_wait_set_t * wait_set) override;
+
+  /// Return true if events of the file descriptor weren't handled yet.
+  RCLCPP_PUBLIC
+  bool
+  is_ready(rcl_wait_set_t * wait_set) override;
+
+  RCLCPP_PUBLIC
+  std::shared_ptr<void>
+  take_data() override;
+
+  RCLCPP_PUBLIC
+  std::shared_ptr<void>
+  take_data_by_entity_id(size_t id) override;
+
+  /// Execute the callback with the events taken, then poll the file descriptor again.
+  RCLCPP_PUBLIC
+  void
+  execute(std::shared_ptr<void> & data) override;
+
+  /// Set a callback to be called each time the file descriptor becomes ready.
+  /**
+   * The callback receives a size_t which is the number of times the file descriptor became
+   * ready since the last time this callback was called, and the identifier of the entity,
+   * FileDescriptorWaitable::EntityType::FileDescriptor.
+   *
+   * \sa rclcpp::SubscriptionIntraProcessBase::set_on_ready_callback
+   *
+   * \param[in] callback functor to be called when the file descriptor is ready.
+   * \throws std::invalid_argument if the callback is not callable.
+   */
+  RCLCPP_PUBLIC
+  void
+  set_on_ready_callback(std::function<void(size_t, int)> callback) override;
+
+  /// Unset the callback registered for the ready file descriptor, if any.
+  RCLCPP_PUBLIC
+  void
+  clear_on_ready_callback() override;
+
+private:
+  friend class detail::FileDescriptorMonitor;
+
+  /// Called by the monitor thread with the events of the file descriptor.
+  void
+  notify_events(const FileDescriptorEvents & events);
+
+  const int fd_;
+  const Callback callback_;
+  rclcpp::GuardCondition gc_;
+  std::shared_ptr<detail::FileDescriptorMonitor> monitor_;
+  uint64_t id_ = 0;
+
+  mutable std::mutex events_mutex_;
+  FileDescriptorEvents events_;
+  FileDescriptorEvents ready_events_;
+  bool has_ready_events_ = false;
+
+  std::mutex callback_mutex_;
+  std::function<void(size_t)> on_ready_callback_{nullptr};
+  size_t unread_count_{0};
+};
+
+/// Create a FileDescriptorWaitable and add it to a callback group of a node.
+/**
+ * \param[in] node the node whose executor runs the callback.
+ * \param[in] fd the file descriptor to watch.
+ * \param[in] events the events waited for, readable and/or writable.
+ * \param[in] callback the callback executed with the events which happened.
+ * \param[in] group the callback group of the waitable, the default one of the node if null.
+ * \return the waitable, which must be kept alive for as long as the file descriptor is watched.
+ */
+template<typename NodeT>
+FileDescriptorWaitable::SharedPtr
+create_file_descriptor_waitable(
+  NodeT & node,
+  int fd,
+  const FileDescriptorEvents & events,
+  FileDescriptorWaitable::Callback callback,
+  rclcpp::CallbackGroup::SharedPtr group = nullptr)
+{
+  auto waitable = FileDescriptorWaitable::make_shared(
+    fd, events, std::move(callback), node.get_node_base_interface()->get_context());
+  node.get_node_waitables_interface()->add_waitable(waitable, group);
+  return waitable;
+}
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__FILE_DESCRIPTOR_WAITABLE_HPP_
@@ -0,0 +1,191 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__FLIGHT_RECORDER_HPP_
+#define RCLCPP__FLIGHT_RECORDER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// Kind of an event recorded by the FlightRecorder.
+enum class FlightRecorderEventType : uint8_t
+{
+  /// An executor thread started waiting for work.
+  WaitStart,
+  /// An executor thread stopped waiting for work, the value is the rcl_wait() return code.
+  WaitEnd,
+  /// An executor started to execute the callbacks of the entity.
+  CallbackStart,
+  /// An executor finished executing the callbacks of the entity.
+  CallbackEnd,
+  /// A message was enqueued into the intra-process buffer, which is the entity.
+  IntraProcessEnqueue,
+  /// A message was dropped by the intra-process buffer, the value is its total dropped count.
+  IntraProcessDrop,
+  /// A timer was called, the value is how late it was in nanoseconds.
+  TimerLateness,
+  /// A QoS deadline was missed, the value is the total count of missed deadlines.
+  DeadlineMissed,
+};
+
+/// Compact event of the FlightRecorder.
+struct FlightRecorderEvent
+{
+  /// Time of the event, in nanoseconds since the epoch of std::chrono::steady_clock.
+  int64_t timestamp;
+  /// Address of the entity, e.g. the timer or the subscription, used as an identifier.
+  const void * entity;
+  /// Value of the event, see FlightRecorderEventType.
+  int64_t value;
+  FlightRecorderEventType type;
+};
+
+/// Events recorded by one thread, see FlightRecorder::get_snapshot().
+struct FlightRecorderThreadEvents
+{
+  std::thread::id thread_id;
+  /// Number of events of the thread overwritten by newer ones, or cleared.
+  uint64_t lost_count;
+  /// The events still in the ring of the thread, oldest first.
+  std::vector<FlightRecorderEvent> events;
+};
+
+/// Always-on record of the last events of each thread, for post-mortem analysis.
+/**
+ * The executors record their waits and the start and end of their callbacks, the timers their
+ * lateness, the intra-process buffers their enqueues and drops, and the QoS event handlers the
+ * missed deadlines.
+ *
+ * Each thread records into its own fixed-size ring of thread_capacity events, allocated the
+ * first time it records.
+ * Recording is lock-free: it reads the steady clock and writes the event with relaxed atomic
+ * stores, the oldest event of the ring being overwritten once it's full.
+ * Reading the rings never stops the threads, the events overwritten while they're read are
+ * discarded.
+ * The ring of a thread is released when the thread exits.
+ *
+ * The events can be dumped on demand with dump(), or into files by a background thread, when
+ * a signal installed with install_dump_signal_handler() is received, or when a deadline is
+ * missed if set_dump_on_deadline_missed() was called.
+ *
+ * Recording is enabled by default, disable() makes it cost one relaxed atomic load.
+ *
+ * All public member functions are thread-safe.
+ */
+class FlightRecorder
+{
+public:
+  /// Number of events kept for each thread.
+  static constexpr size_t thread_capacity = 4096;
+
+  /// Start recording the events, which is the default.
+  RCLCPP_PUBLIC
+  static void
+  enable();
+
+  /// Stop recording the events, the recorded ones are kept.
+  RCLCPP_PUBLIC
+  static void
+  disable();
+
+  /// Return true if the events are recorded.
+  RCLCPP_PUBLIC
+  static bool
+  is_enabled() noexcept;
+
+  /// Record an event of the calling thread, does nothing if recording is disabled.
+  RCLCPP_PUBLIC
+  static void
+  record(
+    FlightRecorderEventType type, const void * entity = nullptr, int64_t value = 0) noexcept;
+
+  /// Record a missed deadline, and request a dump if set_dump_on_deadline_missed() was called.
+  RCLCPP_PUBLIC
+  static void
+  on_deadline_missed(const void * entity, int64_t total_count) noexcept;
+
+  /// Return the events of each thread alive, in the order they first recorded.
+  RCLCPP_PUBLIC
+  static std::vector<FlightRecorderThreadEvents>
+  get_snapshot();
+
+  /// Write the events of all the threads to the stream, one per line in timestamp order.
+  /**
+   * Each line holds the timestamp, an index of the thread, the event type, the entity and
+   * the value, e.g. `1234567 thread=0 callback_start entity=0x5581 value=0`.
+   */
+  RCLCPP_PUBLIC
+  static void
+  dump(std::ostream & stream);
+
+  /// Forget the events recorded so far, counting them as lost.
+  RCLCPP_PUBLIC
+  static void
+  clear();
+
+  /// Start the background thread writing the requested dumps to files.
+  /**
+   * The n-th dump is written into `<path_prefix>.<n>`, n counting from 0.
+   * The thread is stopped if path_prefix is empty, and at the exit of the process.
+   * \throws std::runtime_error if the thread couldn't be started.
+   */
+  RCLCPP_PUBLIC
+  static void
+  set_dump_path_prefix(const std::string & path_prefix);
+
+  /// Ask the background thread for a dump, ignored if it isn't started.
+  /**
+   * Only notifies the thread, so that it can be called from a signal handler.
+   * The requests made before the thread starts writing a dump are served by that dump.
+   */
+  RCLCPP_PUBLIC
+  static void
+  request_dump() noexcept;
+
+  /// Return the number of dumps written by the background thread.
+  RCLCPP_PUBLIC
+  static uint64_t
+  get_dump_count() noexcept;
+
+  /// Request a dump when the signal is received, e.g. SIGUSR1.
+  /**
+   * The handler replaces any handler of the signal, and only calls request_dump().
+   * \throws std::runtime_error if the handler couldn't be installed.
+   */
+  RCLCPP_PUBLIC
+  static void
+  install_dump_signal_handler(int signal_number);
+
+  /// Set whether a dump is requested each time a QoS deadline is missed, false by default.
+  /**
+   * The deadlines are only seen for the publishers and subscriptions having a deadline event
+   * callback, see PublisherEventCallbacks and SubscriptionEventCallbacks.
+   */
+  RCLCPP_PUBLIC
+  static void
+  set_dump_on_deadline_missed(bool dump_on_deadline_missed);
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__FLIGHT_RECORDER_HPP_
@@ -0,0 +1,218 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__GENERIC_CLIENT_HPP_
+#define RCLCPP__GENERIC_CLIENT_HPP_
+
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+#include "rcl/client.h"
+
+#include "rclcpp/client.hpp"
+#include "rclcpp/detail/serialized_service_type_support.hpp"
+#include "rclcpp/function_traits.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/node_interfaces/node_base_interface.hpp"
+#include "rclcpp/node_interfaces/node_graph_interface.hpp"
+#include "rclcpp/serialized_message.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// %Client of a service whose type is only known at runtime, sending serialized requests.
+/**
+ * Like rclcpp::GenericPublisher for topics, the requests are given in their serialized form
+ * and the responses are received serialized, so that a gateway or a proxy can forward them
+ * without knowing the type of the service or parsing its payload.
+ *
+ * The requests are always sent through the middleware, also to the services of the same
+ * context using intra-process communication.
+ */
+class GenericClient : public ClientBase
+{
+public:
+  using Request = rclcpp::SerializedMessage;
+  using Response = rclcpp::SerializedMessage;
+  using SharedRequest = std::shared_ptr<rclcpp::SerializedMessage>;
+  using SharedResponse = std::shared_ptr<rclcpp::SerializedMessage>;
+
+  using Promise = std::promise<SharedResponse>;
+  using Future = std::future<SharedResponse>;
+  using SharedFuture = std::shared_future<SharedResponse>;
+
+  using CallbackType = std::function<void (SharedFuture)>;
+
+  RCLCPP_SMART_PTR_DEFINITIONS(GenericClient)
+
+  /// A convenient GenericClient::Future and request id pair.
+  /**
+   * \sa rclcpp::Client::FutureAndRequestId
+   */
+  struct FutureAndRequestId
+    : detail::FutureAndRequestId<Future>
+  {
+    using detail::FutureAndRequestId<Future>::FutureAndRequestId;
+
+    /// See std::future::share().
+    SharedFuture share() noexcept {return this->future.share();}
+  };
+
+  /// A convenient GenericClient::SharedFuture and request id pair.
+  /**
+   * \sa rclcpp::Client::SharedFutureAndRequestId
+   */
+  struct SharedFutureAndRequestId
+    : detail::FutureAndRequestId<SharedFuture>
+  {
+    using detail::FutureAndRequestId<SharedFuture>::FutureAndRequestId;
+  };
+
+  /// Constructor.
+  /**
+   * The constructor for a GenericClient is almost never called directly.
+   * Instead, generic clients should be instantiated through the function
+   * rclcpp::create_generic_client().
+   *
+   * \param[in] node_base NodeBaseInterface pointer that is used in part of the setup.
+   * \param[in] node_graph The node graph interface of the corresponding node.
+   * \param[in] service_name Name of the service.
+   * \param[in] service_type Type of the service, e.g. "std_srvs/srv/SetBool".
+   * \param[in] client_options options of the client.
+   * \throws std::runtime_error if the type support of the service can't be loaded.
+   */
+  RCLCPP_PUBLIC
+  GenericClient(
+    rclcpp::node_interfaces::NodeBaseInterface * node_base,
+    rclcpp::node_interfaces::NodeGraphInterface::SharedPtr node_graph,
+    const std::string & service_name,
+    const std::string & service_type,
+    rcl_client_options_t & client_options);
+
+  RCLCPP_PUBLIC
+  virtual ~GenericClient() = default;
+
+  RCLCPP_PUBLIC
+  std::shared_ptr<void>
+  create_response() override;
+
+  RCLCPP_PUBLIC
+  std::shared_ptr<rmw_request_id_t>
+  create_request_header() override;
+
+  RCLCPP_PUBLIC
+  void
+  handle_response(
+    std::shared_ptr<rmw_request_id_t> request_header,
+    std::shared_ptr<void> response) override;
+
+  /// Send a serialized request to the service server.
+  /**
+   * \sa rclcpp::Client::async_send_request(), a request which never gets a response must be
+   * removed with remove_pending_request().
+   *
+   * \param[in] request the serialized request.
+   * \return a FutureAndRequestId instance, completed with the serialized response.
+   * \throws rclcpp::exceptions::RCLError based exceptions if the request can't be sent.
+   */
+  RCLCPP_PUBLIC
+  FutureAndRequestId
+  async_send_request(const Request & request);
+
+  /// Send a serialized request to the service server, calling the callback with the response.
+  /**
+   * \param[in] request the serialized request.
+   * \param[in] cb callback called with the future of the serialized response.
+   * \return a SharedFutureAndRequestId instance.
+   * \throws rclcpp::exceptions::RCLError based exceptions if the request can't be sent.
+   */
+  template<
+    typename CallbackT,
+    typename std::enable_if<
+      rclcpp::function_traits::same_arguments<CallbackT, CallbackType>::value
+    >::type * = nullptr
+  >
+  SharedFutureAndRequestId
+  async_send_request(const Request & request, CallbackT && cb)
+  {
+    Promise promise;
+    SharedFuture future(promise.get_future());
+    const int64_t request_id = async_send_request_impl(
+      request, PendingRequest{std::move(promise), std::forward<CallbackT>(cb), future});
+    return SharedFutureAndRequestId(std::move(future), request_id);
+  }
+
+  /// Clean up a pending request, its response will be ignored.
+  /**
+   * \param[in] request_id the id of the request, as returned by async_send_request().
+   * \return true when a pending request was removed.
+   */
+  RCLCPP_PUBLIC
+  bool
+  remove_pending_request(int64_t request_id);
+
+  /// Clean up a pending request, \sa remove_pending_request(int64_t).
+  RCLCPP_PUBLIC
+  bool
+  remove_pending_request(const FutureAndRequestId & future);
+
+  /// Clean up a pending request, \sa remove_pending_request(int64_t).
+  RCLCPP_PUBLIC
+  bool
+  remove_pending_request(const SharedFutureAndRequestId & future);
+
+  /// Clean up all the pending requests.
+  /**
+   * \return the number of pending requests that were removed.
+   */
+  RCLCPP_PUBLIC
+  size_t
+  prune_pending_requests();
+
+  /// Return the type of the service.
+  RCLCPP_PUBLIC
+  const std::string &
+  get_service_type() const;
+
+private:
+  RCLCPP_DISABLE_COPY(GenericClient)
+
+  struct PendingRequest
+  {
+    Promise promise;
+    /// Called with the future once the promise is set, if not null
+    CallbackType callback;
+    SharedFuture future;
+  };
+
+  RCLCPP_PUBLIC
+  int64_t
+  async_send_request_impl(const Request & request, PendingRequest pending_request);
+
+  const std::string service_type_;
+  rclcpp::detail::SerializedServiceTypeSupport type_support_;
+  std::unordered_map<int64_t, PendingRequest> pending_requests_;
+  std::mutex pending_requests_mutex_;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__GENERIC_CLIENT_HPP_
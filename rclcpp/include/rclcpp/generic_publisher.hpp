@@ -16,18 +16,27 @@
 #ifndef RCLCPP__GENERIC_PUBLISHER_HPP_
 #define RCLCPP__GENERIC_PUBLISHER_HPP_
 
+#include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "rcpputils/shared_library.hpp"
 
 #include "rclcpp/callback_group.hpp"
+#include "rclcpp/detail/resolve_use_intra_process.hpp"
+#include "rclcpp/experimental/message_pool.hpp"
 #include "rclcpp/macros.hpp"
 #include "rclcpp/node_interfaces/node_base_interface.hpp"
 #include "rclcpp/node_interfaces/node_topics_interface.hpp"
+#include "rclcpp/payload_compression.hpp"
 #include "rclcpp/publisher_base.hpp"
+#include "rclcpp/publisher_options.hpp"
 #include "rclcpp/qos.hpp"
 #include "rclcpp/serialized_message.hpp"
+#include "rclcpp/serialized_message_view.hpp"
+#include "rclcpp/serialized_message.hpp"
+#include "rclcpp/serialized_message_view.hpp"
 #include "rclcpp/typesupport_helpers.hpp"
 #include "rclcpp/visibility_control.hpp"
 
@@ -41,7 +50,10 @@ namespace rclcpp
  * Since the type is not known at compile time, this is not a template, and the dynamic library
  * containing type support information has to be identified and loaded based on the type name.
  *
- * It does not support intra-process handling.
+ * With intra-process communication, the messages are shared with the generic subscriptions of
+ * this process, the typed subscriptions receive them from the middleware.
+ * Intra-process communication is only used with the keep last history, a non-zero depth and
+ * the volatile durability, otherwise the messages are only published to the middleware.
  */
 class GenericPublisher : public rclcpp::PublisherBase
 {
@@ -49,6 +61,10 @@ public:
   // cppcheck-suppress unknownMacro
   RCLCPP_SMART_PTR_DEFINITIONS(GenericPublisher)
 
+  /// A serialized message lent by borrow_serialized_message(), returned when destroyed.
+  using LoanedSerializedMessage = std::unique_ptr<
+    rclcpp::SerializedMessage, std::function<void(rclcpp::SerializedMessage *)>>;
+
   /// Constructor.
   /**
    * In order to properly publish to a topic, this publisher needs to be added to
@@ -64,7 +80,8 @@ public:
    * \param qos %QoS settings
    * \param options %Publisher options.
    * Not all publisher options are currently respected, the only relevant options for this
-   * publisher are `event_callbacks`, `use_default_callbacks`, and `%callback_group`.
+   * publisher are `event_callbacks`, `use_default_callbacks`, `use_intra_process_comm`,
+   * `payload_compression`, `loaned_message_pool_depth`, and `%callback_group`.
    */
   template<typename AllocatorT = std::allocator<void>>
   GenericPublisher(
@@ -83,7 +100,30 @@ public:
       options.event_callbacks,
       options.use_default_callbacks),
     ts_lib_(ts_lib)
-  {}
+  {
+    if (!options.payload_compression.encoding.empty()) {
+      payload_compressor_ = std::make_shared<rclcpp::PayloadCompressor>(
+        options.payload_compression);
+    }
+    if (options.loaned_message_pool_depth > 0) {
+      serialized_message_pool_ = std::make_shared<SerializedMessagePool>(
+        options.loaned_message_pool_depth);
+    }
+    set_skip_publish_without_subscriptions(options.skip_publish_without_subscriptions);
+    // Setup continues in the post construction method, post_init_setup().
+  }
+
+  /// Called post construction, so that construction may continue after shared_from_this() works.
+  template<typename AllocatorT = std::allocator<void>>
+  void
+  post_init_setup(
+    rclcpp::node_interfaces::NodeBaseInterface * node_base,
+    const rclcpp::PublisherOptionsWithAllocator<AllocatorT> & options)
+  {
+    if (rclcpp::detail::resolve_use_intra_process(options, *node_base)) {
+      setup_serialized_intra_process(node_base);
+    }
+  }
 
   RCLCPP_PUBLIC
   virtual ~GenericPublisher() = default;
@@ -92,6 +132,57 @@ public:
   RCLCPP_PUBLIC
   void publish(const rclcpp::SerializedMessage & message);
 
+  /// Publish the serialized data of a rclcpp::SerializedMessageView, without copying it.
+  /**
+   * This allows to forward the messages of a rclcpp::GenericSubscription borrowing views of
+   * them, only the intra-process subscriptions, if any, get a copy of the data.
+   *
+   * \param message a view of a serialized message
+   * \throws anything rclcpp::exceptions::throw_from_rcl_error can show
+   */
+  RCLCPP_PUBLIC
+  void publish(const rclcpp::SerializedMessageView & message);
+
+  /// Publish the concatenation of the given fragments of serialized data.
+  /**
+   * This allows to forward data held in several buffers, e.g. the packets of a network
+   * capture, as a single message.
+   * A single fragment is published without copying it, see the overload above, while several
+   * fragments are gathered in a buffer from borrow_serialized_message(), as the middleware
+   * only publishes contiguous data.
+   *
+   * \param fragments views of the consecutive parts of a serialized message
+   * \throws anything rclcpp::exceptions::throw_from_rcl_error can show
+   */
+  RCLCPP_PUBLIC
+  void publish(const std::vector<rclcpp::SerializedMessageView> & fragments);
+
+  /// Borrow a serialized message with at least the given capacity, to fill and publish it.
+  /**
+   * The data can be written in place, e.g. read from a socket or from a file, into
+   * `get_rcl_serialized_message().buffer`, setting its `buffer_length`, and then published with
+   * publish() without further copy.
+   *
+   * The middleware doesn't loan serialized messages, so with a positive
+   * `loaned_message_pool_depth` in the options the messages are taken from a pool of the
+   * publisher, which keeps their buffers, otherwise they're allocated.
+   * A recycled message keeps the data it had, its length must always be set.
+   * The message goes back to the pool when the returned pointer is destroyed.
+   *
+   * \param capacity the number of bytes the message must be able to hold
+   */
+  RCLCPP_PUBLIC
+  LoanedSerializedMessage
+  borrow_serialized_message(size_t capacity);
+
+  /// Return the statistics of the pool of the serialized messages borrowed.
+  /**
+   * \return the statistics, all zero if the publisher has no pool
+   */
+  RCLCPP_PUBLIC
+  rclcpp::experimental::MessagePoolStatistics
+  get_serialized_message_pool_statistics() const;
+
   /**
    * Publish a rclcpp::SerializedMessage via loaned message after de-serialization.
    *
@@ -104,6 +195,22 @@ public:
 private:
   // The type support library should stay loaded, so it is stored in the GenericPublisher
   std::shared_ptr<rcpputils::SharedLibrary> ts_lib_;
+  // Set when the messages published to the middleware are compressed
+  std::shared_ptr<rclcpp::PayloadCompressor> payload_compressor_;
+
+  using SerializedMessagePool = rclcpp::experimental::MessagePool<rclcpp::SerializedMessage>;
+  // Set when the options give a loaned message pool depth
+  std::shared_ptr<SerializedMessagePool> serialized_message_pool_;
+
+  /// Register with the intra-process manager, if the QoS allows it.
+  RCLCPP_PUBLIC
+  void
+  setup_serialized_intra_process(rclcpp::node_interfaces::NodeBaseInterface * node_base);
+
+  /// Give the message to the intra-process subscriptions, return if it must be published too.
+  bool publish_intra_process(const rcl_serialized_message_t & message);
+
+  void publish_serialized_message(const rcl_serialized_message_t & message);
 
   void * borrow_loaned_message();
   void deserialize_message(
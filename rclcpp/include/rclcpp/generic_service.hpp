@@ -0,0 +1,171 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__GENERIC_SERVICE_HPP_
+#define RCLCPP__GENERIC_SERVICE_HPP_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>  // NOLINT
+
+#include "rcl/service.h"
+
+#include "rclcpp/detail/serialized_service_type_support.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/serialized_message.hpp"
+#include "rclcpp/service.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// %Service whose type is only known at runtime, handling serialized requests and responses.
+/**
+ * Like rclcpp::GenericSubscription for topics, the requests are given to the callback in their
+ * serialized form and the responses are returned serialized, so that a gateway or a proxy can
+ * forward them without knowing the type of the service or parsing its payload.
+ * The callback can also defer the response, and send it later with send_response(), e.g. once
+ * the response of the forwarded request arrived.
+ *
+ * The requests are always received through the middleware, also from the clients of the same
+ * context using intra-process communication.
+ */
+class GenericService
+  : public ServiceBase,
+  public std::enable_shared_from_this<GenericService>
+{
+public:
+  using Request = rclcpp::SerializedMessage;
+  using Response = rclcpp::SerializedMessage;
+  using SharedRequest = std::shared_ptr<rclcpp::SerializedMessage>;
+  using SharedResponse = std::shared_ptr<rclcpp::SerializedMessage>;
+
+  /// Callback filling the response of a request.
+  using CallbackType = std::function<void (const SharedRequest, SharedResponse)>;
+
+  /// Callback filling the response of a request, given its header.
+  using CallbackWithHeaderType = std::function<
+    void (const std::shared_ptr<rmw_request_id_t>, const SharedRequest, SharedResponse)>;
+
+  /// Callback deferring the response of a request, sent later with send_response().
+  using DeferredCallbackType = std::function<
+    void (std::shared_ptr<GenericService>, const std::shared_ptr<rmw_request_id_t>,
+    const SharedRequest)>;
+
+  RCLCPP_SMART_PTR_DEFINITIONS(GenericService)
+
+  /// Constructor.
+  /**
+   * The constructor for a GenericService is almost never called directly.
+   * Instead, generic services should be instantiated through the function
+   * rclcpp::create_generic_service().
+   *
+   * \param[in] node_handle the rcl node of the service.
+   * \param[in] service_name name of the service.
+   * \param[in] service_type type of the service, e.g. "std_srvs/srv/SetBool".
+   * \param[in] callback the callback handling the requests, with any of the signatures of
+   *   CallbackType, CallbackWithHeaderType or DeferredCallbackType.
+   * \param[in] service_options options of the service.
+   * \throws std::runtime_error if the type support of the service can't be loaded.
+   */
+  template<typename CallbackT>
+  GenericService(
+    std::shared_ptr<rcl_node_t> node_handle,
+    const std::string & service_name,
+    const std::string & service_type,
+    CallbackT && callback,
+    rcl_service_options_t & service_options)
+  : GenericService(
+      std::move(node_handle), service_name, service_type, make_callback(
+        std::forward<CallbackT>(callback)), service_options)
+  {}
+
+  RCLCPP_PUBLIC
+  virtual ~GenericService() = default;
+
+  RCLCPP_PUBLIC
+  std::shared_ptr<void>
+  create_request() override;
+
+  RCLCPP_PUBLIC
+  std::shared_ptr<rmw_request_id_t>
+  create_request_header() override;
+
+  RCLCPP_PUBLIC
+  void
+  handle_request(
+    std::shared_ptr<rmw_request_id_t> request_header,
+    std::shared_ptr<void> request) override;
+
+  /// Send the serialized response of a request.
+  /**
+   * \param[in] request_id the header of the request.
+   * \param[in] response the serialized response.
+   * \throws rclcpp::exceptions::RCLError based exceptions if the response can't be sent.
+   */
+  RCLCPP_PUBLIC
+  void
+  send_response(rmw_request_id_t & request_id, const rclcpp::SerializedMessage & response);
+
+  /// Return the type of the service.
+  RCLCPP_PUBLIC
+  const std::string &
+  get_service_type() const;
+
+private:
+  RCLCPP_DISABLE_COPY(GenericService)
+
+  using AnyCallback = std::variant<CallbackType, CallbackWithHeaderType, DeferredCallbackType>;
+
+  template<typename CallbackT>
+  static AnyCallback
+  make_callback(CallbackT && callback)
+  {
+    if constexpr (std::is_invocable_v<CallbackT, std::shared_ptr<GenericService>,
+      const std::shared_ptr<rmw_request_id_t>, const SharedRequest>)
+    {
+      return DeferredCallbackType(std::forward<CallbackT>(callback));
+    } else if constexpr (std::is_invocable_v<CallbackT, const std::shared_ptr<rmw_request_id_t>,
+      const SharedRequest, SharedResponse>)
+    {
+      return CallbackWithHeaderType(std::forward<CallbackT>(callback));
+    } else {
+      static_assert(
+        std::is_invocable_v<CallbackT, const SharedRequest, SharedResponse>,
+        "the callback of a generic service must be invocable with a serialized request and "
+        "response, optionally preceded by the request header, or with the service, the request "
+        "header and the serialized request to defer the response");
+      return CallbackType(std::forward<CallbackT>(callback));
+    }
+  }
+
+  RCLCPP_PUBLIC
+  GenericService(
+    std::shared_ptr<rcl_node_t> node_handle,
+    const std::string & service_name,
+    const std::string & service_type,
+    AnyCallback callback,
+    rcl_service_options_t & service_options);
+
+  const std::string service_type_;
+  rclcpp::detail::SerializedServiceTypeSupport type_support_;
+  AnyCallback callback_;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__GENERIC_SERVICE_HPP_
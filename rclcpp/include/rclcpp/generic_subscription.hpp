@@ -19,15 +19,21 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <utility>
 
 #include "rcpputils/shared_library.hpp"
 
 #include "rclcpp/callback_group.hpp"
+#include "rclcpp/detail/resolve_use_intra_process.hpp"
 #include "rclcpp/macros.hpp"
 #include "rclcpp/node_interfaces/node_base_interface.hpp"
 #include "rclcpp/node_interfaces/node_topics_interface.hpp"
+#include "rclcpp/payload_compression.hpp"
 #include "rclcpp/qos.hpp"
+#include "rclcpp/message_info.hpp"
 #include "rclcpp/serialized_message.hpp"
+#include "rclcpp/serialized_message_pool.hpp"
+#include "rclcpp/serialized_message_view.hpp"
 #include "rclcpp/subscription_base.hpp"
 #include "rclcpp/typesupport_helpers.hpp"
 #include "rclcpp/visibility_control.hpp"
@@ -40,7 +46,19 @@ namespace rclcpp
  * Since the type is not known at compile time, this is not a template, and the dynamic library
  * containing type support information has to be identified and loaded based on the type name.
  *
- * It does not support intra-process handling.
+ * With intra-process communication, the messages of the typed publishers are serialized once
+ * for all the generic subscriptions, and the messages of the generic publishers are shared.
+ * The callback must not modify these messages.
+ * Intra-process communication is only used with the keep last history, a non-zero depth and
+ * the volatile durability, otherwise the messages are received from the middleware.
+ *
+ * A callback receiving a rclcpp::SerializedMessageView only borrows the buffer of the message,
+ * the buffer the middleware took the message into or the one shared with intra-process
+ * communication, so forwarding the data, e.g. with rclcpp::GenericPublisher::publish(), doesn't
+ * copy nor allocate it.
+ *
+ * The messages compressed by their publisher are decompressed before being given to the
+ * callback, see rclcpp::PublisherOptionsBase::payload_compression.
  */
 class GenericSubscription : public rclcpp::SubscriptionBase
 {
@@ -48,6 +66,10 @@ public:
   // cppcheck-suppress unknownMacro
   RCLCPP_SMART_PTR_DEFINITIONS(GenericSubscription)
 
+  using SharedCallback = std::function<void (std::shared_ptr<rclcpp::SerializedMessage>)>;
+  using ViewCallback = std::function<
+    void (const rclcpp::SerializedMessageView &, const rclcpp::MessageInfo &)>;
+
   /// Constructor.
   /**
    * In order to properly subscribe to a topic, this subscription needs to be added to
@@ -64,8 +86,8 @@ public:
    * \param callback Callback for new messages of serialized form
    * \param options %Subscription options.
    * Not all subscription options are currently respected, the only relevant options for this
-   * subscription are `event_callbacks`, `use_default_callbacks`, `ignore_local_publications`, and
-   * `%callback_group`.
+   * subscription are `event_callbacks`, `use_default_callbacks`, `ignore_local_publications`,
+   * `use_intra_process_comm`, and `%callback_group`.
    */
   template<typename AllocatorT = std::allocator<void>>
   GenericSubscription(
@@ -77,16 +99,29 @@ public:
     // TODO(nnmm): Add variant for callback with message info. See issue #1604.
     std::function<void(std::shared_ptr<rclcpp::SerializedMessage>)> callback,
     const rclcpp::SubscriptionOptionsWithAllocator<AllocatorT> & options)
-  : SubscriptionBase(
-      node_base,
-      *rclcpp::get_typesupport_handle(topic_type, "rosidl_typesupport_cpp", *ts_lib),
-      topic_name,
-      options.to_rcl_subscription_options(qos),
-      options.event_callbacks,
-      options.use_default_callbacks,
-      true),
-    callback_(callback),
-    ts_lib_(ts_lib)
+  : GenericSubscription(
+      node_base, ts_lib, topic_name, topic_type, qos, std::move(callback), ViewCallback(), options)
+  {}
+
+  /// Constructor for a callback borrowing a view of the serialized messages.
+  /**
+   * The view is only valid during the callback, see rclcpp::SerializedMessageView.
+   *
+   * \sa the other constructor for a description of the other parameters.
+   * \param callback Callback for new messages, with a view of their serialized form
+   */
+  template<typename AllocatorT = std::allocator<void>>
+  GenericSubscription(
+    rclcpp::node_interfaces::NodeBaseInterface * node_base,
+    const std::shared_ptr<rcpputils::SharedLibrary> ts_lib,
+    const std::string & topic_name,
+    const std::string & topic_type,
+    const rclcpp::QoS & qos,
+    ViewCallback callback,
+    const rclcpp::SubscriptionOptionsWithAllocator<AllocatorT> & options)
+  : GenericSubscription(
+      node_base, ts_lib, topic_name, topic_type, qos, SharedCallback(), std::move(callback),
+      options)
   {}
 
   RCLCPP_PUBLIC
@@ -96,9 +131,15 @@ public:
   RCLCPP_PUBLIC
   std::shared_ptr<void> create_message() override;
 
+  /// Return an empty serialized message, reusing the buffers of the previously taken ones.
   RCLCPP_PUBLIC
   std::shared_ptr<rclcpp::SerializedMessage> create_serialized_message() override;
 
+  /// Return if the callback borrows a view of the messages.
+  RCLCPP_PUBLIC
+  bool
+  is_view_callback() const;
+
   /// Cast the message to a rclcpp::SerializedMessage and call the callback.
   RCLCPP_PUBLIC
   void handle_message(
@@ -120,15 +161,57 @@ public:
   RCLCPP_PUBLIC
   void return_message(std::shared_ptr<void> & message) override;
 
+  /// Give back the message to the pool of the subscription, unless the callback kept it.
   RCLCPP_PUBLIC
   void return_serialized_message(std::shared_ptr<rclcpp::SerializedMessage> & message) override;
 
 private:
   RCLCPP_DISABLE_COPY(GenericSubscription)
 
-  std::function<void(std::shared_ptr<rclcpp::SerializedMessage>)> callback_;
+  template<typename AllocatorT>
+  GenericSubscription(
+    rclcpp::node_interfaces::NodeBaseInterface * node_base,
+    const std::shared_ptr<rcpputils::SharedLibrary> ts_lib,
+    const std::string & topic_name,
+    const std::string & topic_type,
+    const rclcpp::QoS & qos,
+    SharedCallback callback,
+    ViewCallback view_callback,
+    const rclcpp::SubscriptionOptionsWithAllocator<AllocatorT> & options)
+  : SubscriptionBase(
+      node_base,
+      *rclcpp::get_typesupport_handle(topic_type, "rosidl_typesupport_cpp", *ts_lib),
+      topic_name,
+      options.to_rcl_subscription_options(qos),
+      options.event_callbacks,
+      options.use_default_callbacks,
+      true),
+    callback_(std::move(callback)),
+    view_callback_(std::move(view_callback)),
+    ts_lib_(ts_lib)
+  {
+    this->set_max_messages_per_take(options.max_messages_per_take);
+    this->set_rate_limit(options.rate_limit);
+    this->set_max_message_age(options.max_message_age);
+    this->setup_content_filter(options.content_filter_options);
+    if (rclcpp::detail::resolve_use_intra_process(options, *node_base)) {
+      setup_serialized_intra_process(node_base);
+    }
+  }
+
+  /// Register with the intra-process manager, if the QoS allows it.
+  RCLCPP_PUBLIC
+  void
+  setup_serialized_intra_process(rclcpp::node_interfaces::NodeBaseInterface * node_base);
+
+  SharedCallback callback_;
+  ViewCallback view_callback_;
   // The type support library should stay loaded, so it is stored in the GenericSubscription
   std::shared_ptr<rcpputils::SharedLibrary> ts_lib_;
+  // The buffers of the taken messages, kept so they don't grow again for each message
+  rclcpp::SerializedMessagePool serialized_message_pool_;
+  // The buffers of the messages decompressed, see rclcpp::PublisherOptionsBase::payload_compression
+  rclcpp::PayloadDecompressor payload_decompressor_;
 };
 
 }  // namespace rclcpp
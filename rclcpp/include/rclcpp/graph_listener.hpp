@@ -16,9 +16,17 @@
 #define RCLCPP__GRAPH_LISTENER_HPP_
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <string>
 #include <thread>
+#include <utility>
 #include <vector>
 
 #include "rcl/guard_condition.h"
@@ -117,6 +125,55 @@ public:
   void
   remove_node(rclcpp::node_interfaces::NodeGraphInterface * node_graph);
 
+  /// Add a filter of the graph changes, checked by the listening thread.
+  /**
+   * On each graph change, the topics and services of all the filters are queried once,
+   * through the node of the first filter, and the callback of each filter is called if one
+   * of its topics or services changed.
+   * The filter is removed when its callback returns false, or when its node is removed.
+   *
+   * The node must query the graph without calling the graph listener.
+   *
+   * \param[in] node_graph node in the graph listener's list, used to query the graph.
+   * \param[in] filter fully qualified names of the topics and services.
+   * \param[in] callback called by the listening thread, returning false to remove the filter.
+   * \throws GraphListenerShutdownError if the GraphListener is shutdown
+   * \throws NodeNotFoundError if the given node is not in the list
+   * \throws std::invalid_argument if node is nullptr
+   * \throws anything the queries of the node throw
+   */
+  RCLCPP_PUBLIC
+  void
+  add_graph_change_filter(
+    rclcpp::node_interfaces::NodeGraphInterface * node_graph,
+    const rclcpp::GraphEventFilter & filter,
+    std::function<bool()> callback);
+
+  /// Wait for a service to become ready, checked on entry and after each graph change.
+  /**
+   * The waiters of the same service name share the checks: after a graph change the
+   * listening thread calls is_ready of the waiters of a name in turn until one returns false,
+   * so a graph change costs one check per name while the service isn't available,
+   * not one per waiter.
+   * The waiter which wasn't ready is checked first on the next graph change.
+   *
+   * is_ready is called with a lock held, by this thread and by the listening thread,
+   * and must not call the graph listener.
+   * If it throws in the listening thread, the waiter is woken and this returns false.
+   *
+   * \param[in] service_name fully qualified name grouping the waiters.
+   * \param[in] is_ready returns true if the service is ready.
+   * \param[in] timeout maximum time to wait, std::chrono::nanoseconds::max() waits forever.
+   * \return true if is_ready returned true, false on timeout or shutdown.
+   * \throws anything is_ready throws when called by this thread
+   */
+  RCLCPP_PUBLIC
+  bool
+  wait_for_service_ready(
+    const std::string & service_name,
+    const std::function<bool()> & is_ready,
+    std::chrono::nanoseconds timeout);
+
   /// Stop the listening thread.
   /**
    * The thread cannot be restarted, and the class is defunct after calling.
@@ -154,6 +211,15 @@ public:
   bool
   is_shutdown();
 
+  /// Return the number of times the listening thread was woken by a graph change.
+  /**
+   * It's incremented before the nodes are notified of the change.
+   * This function is thread-safe.
+   */
+  RCLCPP_PUBLIC
+  uint64_t
+  get_graph_change_count() const;
+
 protected:
   /// Main function for the listening thread.
   RCLCPP_PUBLIC
@@ -181,6 +247,45 @@ private:
   void
   __shutdown();
 
+  /// Filter of the graph changes added with add_graph_change_filter().
+  struct GraphChangeFilter
+  {
+    rclcpp::node_interfaces::NodeGraphInterface * node_graph;
+    rclcpp::GraphEventFilter filter;
+    std::function<bool()> callback;
+  };
+
+  /// Numbers of publishers and subscriptions of topics.
+  using TopicStates = std::map<std::string, std::pair<size_t, size_t>>;
+  /// Whether or not services are in the graph.
+  using ServiceStates = std::map<std::string, bool>;
+
+  /** \internal Query the topics and services of the filters missing from the states. */
+  static
+  void
+  query_graph_change_filter_states(
+    rclcpp::node_interfaces::NodeGraphInterface * node_graph,
+    const rclcpp::GraphEventFilter & filter,
+    TopicStates & topic_states,
+    ServiceStates & service_states);
+
+  /** \internal Call the callbacks of the filters whose topics or services changed. */
+  void
+  check_graph_change_filters();
+
+  /// Thread waiting in wait_for_service_ready().
+  struct ServiceWaiter
+  {
+    const std::function<bool()> * is_ready;
+    std::condition_variable cv;
+    bool woken;
+    bool ready;
+  };
+
+  /** \internal Wake the waiters whose service became ready. */
+  void
+  check_service_waiters();
+
   std::weak_ptr<rclcpp::Context> weak_parent_context_;
   std::shared_ptr<rcl_context_t> rcl_parent_context_;
 
@@ -188,10 +293,18 @@ private:
   bool is_started_;
   std::atomic_bool is_shutdown_;
   mutable std::mutex shutdown_mutex_;
+  std::atomic<uint64_t> graph_change_count_;
 
   mutable std::mutex node_graph_interfaces_barrier_mutex_;
   mutable std::mutex node_graph_interfaces_mutex_;
   std::vector<rclcpp::node_interfaces::NodeGraphInterface *> node_graph_interfaces_;
+  // The graph change filters and their last states are protected by node_graph_interfaces_mutex_
+  std::vector<GraphChangeFilter> graph_change_filters_;
+  TopicStates filtered_topic_states_;
+  ServiceStates filtered_service_states_;
+
+  std::mutex service_waiters_mutex_;
+  std::map<std::string, std::list<ServiceWaiter *>> service_waiters_;
 
   rclcpp::GuardCondition interrupt_guard_condition_;
   rcl_wait_set_t wait_set_ = rcl_get_zero_initialized_wait_set();
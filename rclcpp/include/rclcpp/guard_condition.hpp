@@ -16,6 +16,7 @@
 #define RCLCPP__GUARD_CONDITION_HPP_
 
 #include <atomic>
+#include <cstdint>
 
 #include "rcl/guard_condition.h"
 
@@ -84,6 +85,45 @@ public:
   void
   trigger();
 
+  /// Enable or disable the coalescing of the triggers which happen before the next wait.
+  /**
+   * When enabled, only the first trigger after the guard condition was added to a wait set
+   * triggers the underlying rcl guard condition, the following ones are cheap no-ops until
+   * the guard condition is added to a wait set again.
+   * A trigger which was skipped is replayed when the guard condition is added to the next
+   * wait set, so no wake up is lost.
+   * The callback set with set_on_trigger_callback() is still called on every trigger.
+   *
+   * This must only be enabled for guard conditions which are added to their wait sets with
+   * add_to_wait_set(), rclcpp::detail::add_guard_condition_to_rcl_wait_set() or
+   * rclcpp::WaitSet, as these are the places which call reset_coalesced_triggers().
+   * It is disabled by default.
+   *
+   * \param[in] enabled true to coalesce the triggers, false to forward all of them.
+   */
+  RCLCPP_PUBLIC
+  void
+  set_trigger_coalescing(bool enabled);
+
+  /// Return true if the triggers of this guard condition are coalesced.
+  RCLCPP_PUBLIC
+  bool
+  get_trigger_coalescing() const;
+
+  /// Let the next trigger reach the rcl guard condition, replaying a skipped trigger if any.
+  /**
+   * This is called whenever the guard condition is added to a wait set, just before waiting.
+   * It does nothing when the triggers are not coalesced.
+   *
+   * This function is thread-safe.
+   *
+   * \throws rclcpp::exceptions::RCLError based exceptions when underlying
+   *   rcl functions fail.
+   */
+  RCLCPP_PUBLIC
+  void
+  reset_coalesced_triggers() const;
+
   /// Exchange the "in use by wait set" state for this guard condition.
   /**
    * This is used to ensure this guard condition is not used by multiple
@@ -135,6 +175,25 @@ protected:
   std::function<void(size_t)> on_trigger_callback_{nullptr};
   size_t unread_count_{0};
   rcl_wait_set_t * wait_set_{nullptr};
+
+private:
+  /// The state of the coalesced triggers, since the last time the guard condition was waited on.
+  enum class TriggerState : uint8_t
+  {
+    /// No trigger happened.
+    Idle,
+    /// The rcl guard condition was triggered.
+    Triggered,
+    /// The rcl guard condition was triggered, and then later triggers were skipped.
+    Skipped,
+  };
+
+  /// Return true if the trigger can be skipped, as an earlier one is still pending.
+  bool
+  coalesce_trigger();
+
+  std::atomic<bool> coalesce_triggers_{false};
+  mutable std::atomic<TriggerState> trigger_state_{TriggerState::Idle};
 };
 
 }  // namespace rclcpp
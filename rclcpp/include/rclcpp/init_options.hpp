@@ -19,6 +19,9 @@
 #include <mutex>
 
 #include "rcl/init_options.h"
+#include "rclcpp/async_logging.hpp"
+#include "rclcpp/deserialization_thread_pool.hpp"
+#include "rclcpp/rosout_batching.hpp"
 #include "rclcpp/visibility_control.hpp"
 
 namespace rclcpp
@@ -31,6 +34,40 @@ public:
   /// If true, the context will be shutdown on SIGINT by the signal handler (if it was installed).
   bool shutdown_on_signal = true;
 
+  /// Buffering of the log messages, written by a background thread.
+  /**
+   * It is used if logging is initialized by rclcpp::Context::init, by the first context doing
+   * so, see auto_initialize_logging().
+   * It is disabled by default, see rclcpp::AsyncLoggingOptions.
+   */
+  AsyncLoggingOptions async_logging;
+
+  /// Batching and rate limiting of the /rosout publisher shared by the nodes of the context.
+  /**
+   * It is only used by the nodes using the shared publishers, see
+   * rclcpp::NodeOptions::use_shared_publishers(), it is disabled by default.
+   */
+  RosoutBatchingOptions rosout_batching;
+
+  /// If true, the entities of the context are released in bulk when it is shutdown.
+  /**
+   * Shutting down the context already stops the executors, the graph listener and the clock
+   * threads of its nodes, as they are woken up and stop waiting.
+   * With this option, the context also unregisters all the intra-process publishers and
+   * subscriptions at once, so that destroying hundreds of nodes afterwards doesn't rebuild
+   * the intra-process routes for each of their entities.
+   * Intra-process communication stops working after the shutdown, even for entities which
+   * keep being used.
+   * It is disabled by default.
+   */
+  bool fast_teardown = false;
+
+  /// Size and CPU affinity of the worker pool of the context, see Context::get_worker_pool().
+  /**
+   * By default the pool has one worker thread per core, created without any attribute.
+   */
+  WorkerPoolOptions worker_pool;
+
   /// Constructor
   /**
    * It allows you to specify the allocator used within the init options.
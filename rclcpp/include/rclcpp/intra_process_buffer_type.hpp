@@ -30,6 +30,21 @@ enum class IntraProcessBufferType
   CallbackDefault
 };
 
+/// Used in the subscription options to select the implementation of the intra-process buffer
+enum class IntraProcessBufferImplementation
+{
+  /// Same as MultiProducerRingBuffer, as publishers can be created at any time
+  Default,
+  /// Ring buffer taking a mutex for each operation
+  MutexRingBuffer,
+  /// Lock-free ring buffer, only one thread at a time may publish to the subscription
+  SingleProducerRingBuffer,
+  /// Lock-free ring buffer, any number of threads may publish to the subscription
+  MultiProducerRingBuffer,
+  /// Lock-free single slot keeping only the newest message, whatever the depth of the QoS
+  LatestValue
+};
+
 }  // namespace rclcpp
 
 #endif  // RCLCPP__INTRA_PROCESS_BUFFER_TYPE_HPP_
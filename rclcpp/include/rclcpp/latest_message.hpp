@@ -0,0 +1,58 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__LATEST_MESSAGE_HPP_
+#define RCLCPP__LATEST_MESSAGE_HPP_
+
+#include <memory>
+#include <utility>
+
+#include "rclcpp/macros.hpp"
+
+namespace rclcpp
+{
+
+/// Slot holding the last message delivered by a subscription, swapped atomically.
+/**
+ * It's shared by the subscription and its intra-process subscription, which store the messages
+ * before calling the callback, see rclcpp::SubscriptionOptionsBase::latest_value_only.
+ * The messages stored are never modified afterwards, so they can be read from any thread.
+ */
+template<typename MessageT>
+class LatestMessage
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(LatestMessage)
+
+  /// Replace the message held.
+  void
+  store(std::shared_ptr<const MessageT> message)
+  {
+    std::atomic_store(&message_, std::move(message));
+  }
+
+  /// Return the message held, or nullptr if none was delivered yet.
+  std::shared_ptr<const MessageT>
+  load() const
+  {
+    return std::atomic_load(&message_);
+  }
+
+private:
+  std::shared_ptr<const MessageT> message_;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__LATEST_MESSAGE_HPP_
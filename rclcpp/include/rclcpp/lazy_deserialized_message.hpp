@@ -0,0 +1,206 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__LAZY_DESERIALIZED_MESSAGE_HPP_
+#define RCLCPP__LAZY_DESERIALIZED_MESSAGE_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/serialized_message.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+#include "rosidl_runtime_c/message_type_support_struct.h"
+#include "rosidl_typesupport_cpp/message_type_support.hpp"
+
+namespace rclcpp
+{
+
+/// Type independent part of rclcpp::LazyDeserializedMessage.
+class LazyDeserializedMessageBase
+{
+public:
+  RCLCPP_PUBLIC
+  virtual ~LazyDeserializedMessageBase();
+
+  /// Return the serialized message, or nullptr if the message was received deserialized.
+  RCLCPP_PUBLIC
+  std::shared_ptr<const rclcpp::SerializedMessage>
+  get_serialized_message() const;
+
+protected:
+  RCLCPP_PUBLIC
+  LazyDeserializedMessageBase(
+    std::shared_ptr<const rclcpp::SerializedMessage> serialized_message,
+    const rosidl_message_type_support_t * type_support);
+
+  /// Decode a single top-level member of the serialized message.
+  /**
+   * Members already decoded are skipped. Must be called with mutex_ locked.
+   *
+   * \param[in] member_offset the offset of the member within the message.
+   * \param[out] message the message in which the member is decoded.
+   * \return false if the member can't be decoded alone, e.g. when the serialization format
+   *   or the member type isn't supported, in which case the whole message must be deserialized.
+   */
+  RCLCPP_PUBLIC
+  bool
+  decode_member(size_t member_offset, void * message);
+
+  /// Deserialize the whole serialized message.
+  RCLCPP_PUBLIC
+  void
+  deserialize(void * message) const;
+
+  std::mutex mutex_;
+
+private:
+  bool
+  resolve_members();
+
+  std::shared_ptr<const rclcpp::SerializedMessage> serialized_message_;
+  const rosidl_message_type_support_t * type_support_;
+  const void * members_ = nullptr;
+  bool members_resolved_ = false;
+  // Position in the serialized message of the members walked so far, and the decoded ones
+  std::vector<size_t> member_positions_;
+  std::vector<size_t> decoded_members_;
+};
+
+/// Message given to the lazily deserialized subscription callbacks.
+/**
+ * The message is taken serialized, and decoded only when needed: either entirely with
+ * get_message(), or one top-level field at a time with get_field(), e.g. to look at the header
+ * of a large message before deciding whether it's worth deserializing.
+ * Decoding a field skips the members before it without decoding them, using the introspection
+ * type support of the message, and falls back to deserializing the whole message when the
+ * serialization format isn't little endian CDR or when a member can't be decoded alone.
+ *
+ * Messages which are received deserialized, e.g. intra-process, are given through the same
+ * type, which then shares the ownership of the message.
+ *
+ * The lazy message can be kept after the callback: the default message memory strategy reuses
+ * a serialized message only once nothing else references it.
+ *
+ * All public member functions are thread-safe.
+ */
+template<typename MessageT>
+class LazyDeserializedMessage : public LazyDeserializedMessageBase
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(LazyDeserializedMessage)
+
+  /// Wrap a serialized message, deserialized on demand.
+  /**
+   * \throws std::invalid_argument if the serialized message is nullptr.
+   */
+  explicit LazyDeserializedMessage(
+    std::shared_ptr<const rclcpp::SerializedMessage> serialized_message)
+  : LazyDeserializedMessageBase(
+      std::move(serialized_message),
+      rosidl_typesupport_cpp::get_message_type_support_handle<MessageT>())
+  {
+    if (!get_serialized_message()) {
+      throw std::invalid_argument("serialized message cannot be nullptr");
+    }
+  }
+
+  /// Wrap a message which is already deserialized.
+  /**
+   * \throws std::invalid_argument if the message is nullptr.
+   */
+  explicit LazyDeserializedMessage(std::shared_ptr<const MessageT> message)
+  : LazyDeserializedMessageBase(
+      nullptr, rosidl_typesupport_cpp::get_message_type_support_handle<MessageT>()),
+    message_(std::move(message))
+  {
+    if (!message_) {
+      throw std::invalid_argument("message cannot be nullptr");
+    }
+  }
+
+  /// Return the message, deserializing it the first time.
+  /**
+   * \throws anything rclcpp::SerializationBase::deserialize_message can throw.
+   */
+  std::shared_ptr<const MessageT>
+  get_message()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return get_message_locked();
+  }
+
+  /// Return a top-level field of the message, decoding only this field the first time.
+  /**
+   * The reference stays valid as long as the lazy message, e.g.
+   * `lazy_message->get_field(&sensor_msgs::msg::PointCloud2::header)`.
+   *
+   * \param[in] member pointer to the member of the field.
+   * \throws anything rclcpp::SerializationBase::deserialize_message can throw.
+   */
+  template<typename FieldT>
+  const FieldT &
+  get_field(FieldT MessageT::* member)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (message_) {
+      return (*message_).*member;
+    }
+    if (!partial_message_) {
+      partial_message_ = std::make_unique<MessageT>();
+    }
+    const FieldT & field = (*partial_message_).*member;
+    const size_t member_offset = static_cast<size_t>(
+      reinterpret_cast<const char *>(&field) -
+      reinterpret_cast<const char *>(partial_message_.get()));
+    if (decode_member(member_offset, partial_message_.get())) {
+      return field;
+    }
+    return (*get_message_locked()).*member;
+  }
+
+  /// Return true if the whole message is deserialized.
+  bool
+  is_deserialized()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return message_ != nullptr;
+  }
+
+private:
+  std::shared_ptr<const MessageT>
+  get_message_locked()
+  {
+    if (!message_) {
+      auto message = std::make_shared<MessageT>();
+      deserialize(message.get());
+      message_ = std::move(message);
+    }
+    return message_;
+  }
+
+  std::shared_ptr<const MessageT> message_;
+  // Fields decoded one at a time, kept so that the references given stay valid
+  std::unique_ptr<MessageT> partial_message_;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__LAZY_DESERIALIZED_MESSAGE_HPP_
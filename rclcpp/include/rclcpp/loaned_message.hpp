@@ -15,6 +15,7 @@
 #ifndef RCLCPP__LOANED_MESSAGE_HPP_
 #define RCLCPP__LOANED_MESSAGE_HPP_
 
+#include <functional>
 #include <memory>
 #include <utility>
 
@@ -103,6 +104,29 @@ public:
    * \param[in] allocator Allocator instance in case middleware can not allocate messages
    * \throws anything rclcpp::exceptions::throw_from_rcl_error can throw.
    */
+  /// Constructor of the LoanedMessage class, taking a message the middleware didn't loan.
+  /**
+   * It's used by the publishers keeping a pool of messages for the middlewares which can not
+   * loan messages, see rclcpp::PublisherOptionsBase::loaned_message_pool_depth.
+   * The message is given back with its deleter when this instance is destroyed, or by the
+   * pointer returned by release().
+   *
+   * \param[in] pub rclcpp::Publisher instance to which the memory belongs
+   * \param[in] allocator Allocator instance of the publisher
+   * \param[in] message message, and the deleter giving it back to the pool
+   */
+  LoanedMessage(
+    const rclcpp::PublisherBase & pub,
+    std::allocator<MessageT> allocator,
+    std::unique_ptr<MessageT, std::function<void(MessageT *)>> message)
+  : pub_(pub),
+    message_(message.get()),
+    message_allocator_(std::move(allocator)),
+    message_deleter_(std::move(message.get_deleter()))
+  {
+    message.release();
+  }
+
   [[
     deprecated("used the LoanedMessage constructor that does not use a shared_ptr to the allocator")
   ]]
@@ -116,7 +140,8 @@ public:
   LoanedMessage(LoanedMessage<MessageT> && other)
   : pub_(std::move(other.pub_)),
     message_(std::move(other.message_)),
-    message_allocator_(std::move(other.message_allocator_))
+    message_allocator_(std::move(other.message_allocator_)),
+    message_deleter_(std::move(other.message_deleter_))
   {
     other.message_ = nullptr;
   }
@@ -150,6 +175,9 @@ public:
           error_logger, "rcl_deallocate_loaned_message failed: %s", rcl_get_error_string().str);
         rcl_reset_error();
       }
+    } else if (message_deleter_) {
+      // give the message back to the pool it was taken from
+      message_deleter_(message_);
     } else {
       // call destructor before deallocating
       message_->~MessageT();
@@ -205,6 +233,11 @@ public:
       return std::unique_ptr<MessageT, std::function<void(MessageT *)>>(msg, [](MessageT *) {});
     }
 
+    if (message_deleter_) {
+      return std::unique_ptr<MessageT, std::function<void(MessageT *)>>(
+        msg, std::move(message_deleter_));
+    }
+
     return std::unique_ptr<MessageT, std::function<void(MessageT *)>>(
       msg,
       [allocator = message_allocator_](MessageT * msg_ptr) mutable {
@@ -221,6 +254,9 @@ protected:
 
   MessageAllocator message_allocator_;
 
+  /// Deleter of a message taken from the pool of the publisher, empty otherwise.
+  std::function<void(MessageT *)> message_deleter_;
+
   /// Deleted copy constructor to preserve memory integrity.
   LoanedMessage(const LoanedMessage<MessageT> & other) = delete;
 };
@@ -0,0 +1,323 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__LOCAL_MESSAGE_PTR_HPP_
+#define RCLCPP__LOCAL_MESSAGE_PTR_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace rclcpp
+{
+
+/// Shared handle to a message which never leaves the thread it was received on.
+/**
+ * It shares the ownership of the message like a std::shared_ptr<const MessageT>, but the
+ * copies of the handle count their references without atomic operations.
+ * Copying the handle, e.g. into the containers or the functions called by a subscription
+ * callback, is then as cheap as copying a raw pointer.
+ *
+ * The handle and all its copies must be used and destroyed by a single thread at a time,
+ * which is the case of the callbacks run by a single-threaded executor or in a mutually
+ * exclusive callback group, as long as the copies aren't given to another thread.
+ * Use get_shared() or copy the message to hand it over to another thread.
+ *
+ * The blocks counting the references are recycled by each thread, so that wrapping a message
+ * doesn't allocate once a thread released a few handles.
+ */
+template<typename MessageT>
+class LocalMessagePtr
+{
+public:
+  /// Create a handle which doesn't refer to any message.
+  LocalMessagePtr() noexcept = default;
+
+  /// Create a handle taking the ownership of a message.
+  template<typename DeleterT>
+  explicit LocalMessagePtr(std::unique_ptr<MessageT, DeleterT> message)
+  {
+    if (message) {
+      block_ = new UniqueBlock<DeleterT>(std::move(message));
+    }
+  }
+
+  /// Create a handle sharing the ownership of a message, without copying it.
+  explicit LocalMessagePtr(std::shared_ptr<const MessageT> message)
+  {
+    if (message) {
+      block_ = new SharedBlock(std::move(message));
+    }
+  }
+
+  LocalMessagePtr(const LocalMessagePtr & other) noexcept
+  : block_(other.block_)
+  {
+    if (block_) {
+      ++block_->count;
+    }
+  }
+
+  LocalMessagePtr(LocalMessagePtr && other) noexcept
+  : block_(std::exchange(other.block_, nullptr))
+  {}
+
+  LocalMessagePtr &
+  operator=(const LocalMessagePtr & other) noexcept
+  {
+    LocalMessagePtr(other).swap(*this);
+    return *this;
+  }
+
+  LocalMessagePtr &
+  operator=(LocalMessagePtr && other) noexcept
+  {
+    LocalMessagePtr(std::move(other)).swap(*this);
+    return *this;
+  }
+
+  ~LocalMessagePtr()
+  {
+    release();
+  }
+
+  /// Return the message, or nullptr if the handle doesn't refer to one.
+  const MessageT *
+  get() const noexcept
+  {
+    return block_ ? block_->message : nullptr;
+  }
+
+  const MessageT &
+  operator*() const noexcept
+  {
+    return *get();
+  }
+
+  const MessageT *
+  operator->() const noexcept
+  {
+    return get();
+  }
+
+  /// Return true if the handle refers to a message.
+  explicit operator bool() const noexcept
+  {
+    return block_ != nullptr;
+  }
+
+  /// Return the number of handles referring to the message, including this one.
+  size_t
+  use_count() const noexcept
+  {
+    return block_ ? block_->count : 0u;
+  }
+
+  /// Return a std::shared_ptr to the message, which can be given to other threads.
+  /**
+   * It keeps the message alive through its own, atomic, reference count, independently of
+   * the handles.
+   */
+  std::shared_ptr<const MessageT>
+  get_shared() const
+  {
+    if (!block_) {
+      return nullptr;
+    }
+    return block_->share();
+  }
+
+  /// Release this handle, destroying the message if it was the last one referring to it.
+  void
+  reset() noexcept
+  {
+    release();
+    block_ = nullptr;
+  }
+
+  void
+  swap(LocalMessagePtr & other) noexcept
+  {
+    std::swap(block_, other.block_);
+  }
+
+private:
+  /// Blocks released on a thread, reused by the next handles created on it.
+  /**
+   * A handle released on another thread than the one which created it gives its block to the
+   * pool of the releasing thread.
+   */
+  template<typename BlockT>
+  class BlockPool
+  {
+public:
+    static void *
+    allocate(size_t size)
+    {
+      BlockPool * pool = get();
+      if (size == sizeof(BlockT) && pool && pool->free_blocks_) {
+        FreeBlock * block = pool->free_blocks_;
+        pool->free_blocks_ = block->next;
+        --pool->size_;
+        return block;
+      }
+      return ::operator new(size);
+    }
+
+    static void
+    deallocate(void * block, size_t size) noexcept
+    {
+      BlockPool * pool = get();
+      if (size == sizeof(BlockT) && pool && pool->size_ < max_size) {
+        pool->free_blocks_ = new (block) FreeBlock{pool->free_blocks_};
+        ++pool->size_;
+        return;
+      }
+      ::operator delete(block);
+    }
+
+private:
+    struct FreeBlock
+    {
+      FreeBlock * next;
+    };
+
+    /// Blocks kept per thread, more than the handles a callback usually holds at once.
+    static constexpr size_t max_size = 64;
+
+    BlockPool() = default;
+
+    ~BlockPool()
+    {
+      is_destroyed() = true;
+      while (free_blocks_) {
+        FreeBlock * next = free_blocks_->next;
+        ::operator delete(free_blocks_);
+        free_blocks_ = next;
+      }
+    }
+
+    /// Flag set when the pool of this thread is destroyed, the handles released later free.
+    static bool &
+    is_destroyed() noexcept
+    {
+      thread_local bool destroyed = false;
+      return destroyed;
+    }
+
+    /// Return the pool of this thread, or nullptr if the thread is exiting and destroyed it.
+    static BlockPool *
+    get() noexcept
+    {
+      if (is_destroyed()) {
+        return nullptr;
+      }
+      thread_local BlockPool pool;
+      return &pool;
+    }
+
+    FreeBlock * free_blocks_ = nullptr;
+    size_t size_ = 0;
+  };
+
+  struct Block
+  {
+    explicit Block(const MessageT * message_in)
+    : message(message_in)
+    {}
+
+    virtual ~Block() = default;
+
+    virtual std::shared_ptr<const MessageT>
+    share() = 0;
+
+    const MessageT * message;
+    size_t count = 1;
+  };
+
+  struct SharedBlock : public Block
+  {
+    explicit SharedBlock(std::shared_ptr<const MessageT> owner_in)
+    : Block(owner_in.get()), owner(std::move(owner_in))
+    {}
+
+    std::shared_ptr<const MessageT>
+    share() override
+    {
+      return owner;
+    }
+
+    static void *
+    operator new(size_t size)
+    {
+      return BlockPool<SharedBlock>::allocate(size);
+    }
+
+    static void
+    operator delete(void * block, size_t size) noexcept
+    {
+      BlockPool<SharedBlock>::deallocate(block, size);
+    }
+
+    std::shared_ptr<const MessageT> owner;
+  };
+
+  template<typename DeleterT>
+  struct UniqueBlock : public Block
+  {
+    explicit UniqueBlock(std::unique_ptr<MessageT, DeleterT> owner_in)
+    : Block(owner_in.get()), owner(std::move(owner_in))
+    {}
+
+    std::shared_ptr<const MessageT>
+    share() override
+    {
+      // The message is moved, not copied, into a shared pointer the first time it is shared
+      if (!shared) {
+        shared = std::shared_ptr<const MessageT>(std::move(owner));
+      }
+      return shared;
+    }
+
+    static void *
+    operator new(size_t size)
+    {
+      return BlockPool<UniqueBlock>::allocate(size);
+    }
+
+    static void
+    operator delete(void * block, size_t size) noexcept
+    {
+      BlockPool<UniqueBlock>::deallocate(block, size);
+    }
+
+    std::unique_ptr<MessageT, DeleterT> owner;
+    std::shared_ptr<const MessageT> shared;
+  };
+
+  void
+  release() noexcept
+  {
+    if (block_ && --block_->count == 0) {
+      delete block_;
+    }
+  }
+
+  Block * block_ = nullptr;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__LOCAL_MESSAGE_PTR_HPP_
@@ -24,19 +24,41 @@
 #include "rcutils/logging.h"
 #include "rcpputils/filesystem_helper.hpp"
 
+// These are used for compiling out logging macros lower than a minimum severity.
+#define RCLCPP_LOG_MIN_SEVERITY_DEBUG 0
+#define RCLCPP_LOG_MIN_SEVERITY_INFO 1
+#define RCLCPP_LOG_MIN_SEVERITY_WARN 2
+#define RCLCPP_LOG_MIN_SEVERITY_ERROR 3
+#define RCLCPP_LOG_MIN_SEVERITY_FATAL 4
+#define RCLCPP_LOG_MIN_SEVERITY_NONE 5
+
+/**
+ * \def RCLCPP_LOG_MIN_SEVERITY
+ * Define RCLCPP_LOG_MIN_SEVERITY=RCLCPP_LOG_MIN_SEVERITY_[DEBUG|INFO|WARN|ERROR|FATAL]
+ * in your build options to compile out anything below that severity.
+ * The logging macros compiled out expand to nothing, their arguments aren't evaluated and the
+ * severity of the logger isn't checked at runtime.
+ * Use RCLCPP_LOG_MIN_SEVERITY_NONE to compile out all macros.
+ */
+#ifndef RCLCPP_LOG_MIN_SEVERITY
+#define RCLCPP_LOG_MIN_SEVERITY RCLCPP_LOG_MIN_SEVERITY_DEBUG
+#endif
+
 /**
  * \def RCLCPP_LOGGING_ENABLED
  * When this define evaluates to true (default), logger factory functions will
  * behave normally.
  * When false, logger factory functions will create dummy loggers to avoid
  * computational expense in manipulating objects.
- * This should be used in combination with `RCLCPP_LOG_MIN_SEVERITY` to compile
- * out logging macros.
+ * It defaults to false when `RCLCPP_LOG_MIN_SEVERITY` compiles out all the logging macros.
  */
-// TODO(dhood): determine this automatically from `RCLCPP_LOG_MIN_SEVERITY`
 #ifndef RCLCPP_LOGGING_ENABLED
+#if RCLCPP_LOG_MIN_SEVERITY >= RCLCPP_LOG_MIN_SEVERITY_NONE
+#define RCLCPP_LOGGING_ENABLED 0
+#else
 #define RCLCPP_LOGGING_ENABLED 1
 #endif
+#endif
 
 namespace rclcpp
 {
@@ -0,0 +1,265 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__MEMORY_ACCOUNTING_HPP_
+#define RCLCPP__MEMORY_ACCOUNTING_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// Kind of entity whose memory is accounted, see MemoryAccounting.
+enum class MemoryEntityKind
+{
+  Publisher,
+  Subscription,
+  IntraProcessBuffer,
+  MessagePool,
+  Parameters,
+  Other,
+};
+
+/// Return the name of a kind of entity, e.g. "intra_process_buffer".
+RCLCPP_PUBLIC
+const char *
+to_string(MemoryEntityKind kind);
+
+/// Memory measured by a probe of a MemoryAccount.
+struct MemorySample
+{
+  uint64_t bytes_in_use = 0;
+  uint64_t high_water_mark = 0;
+};
+
+/// Memory used by an entity, see MemoryAccounting::get_usage().
+struct MemoryUsage
+{
+  /// Fully qualified name of the node of the entity.
+  std::string node_name;
+  /// Name of the entity, e.g. its topic.
+  std::string entity_name;
+  MemoryEntityKind kind;
+  uint64_t bytes_in_use;
+  /// Largest number of bytes in use seen since the account was created or reset.
+  uint64_t high_water_mark;
+};
+
+/// Account of the memory used by one entity, registered with MemoryAccounting while it exists.
+/**
+ * The memory is either reported as it is allocated and deallocated, e.g. by an
+ * AccountingMemoryResource, or measured when the usage is queried by a probe, e.g. from the
+ * occupancy of a buffer, or both, in which case they are summed.
+ *
+ * The probe is called with the lock of the registry held, from the thread querying the usage,
+ * so it must not query the usage itself nor create accounts.
+ * As an account waits for the queries in progress when destroyed, the probe may use the
+ * entity owning the account as long as the entity destroys the account first.
+ *
+ * Reporting allocations is lock-free, all public member functions are thread-safe.
+ */
+class MemoryAccount
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(MemoryAccount)
+
+  /// Function measuring the memory of the entity.
+  using Probe = std::function<MemorySample()>;
+
+  /// Create an account and register it.
+  RCLCPP_PUBLIC
+  MemoryAccount(
+    const std::string & node_name,
+    const std::string & entity_name,
+    MemoryEntityKind kind,
+    Probe probe = nullptr);
+
+  /// Unregister the account, waiting for the queries of the usage in progress.
+  RCLCPP_PUBLIC
+  ~MemoryAccount();
+
+  /// Report memory allocated by the entity.
+  void
+  on_allocate(size_t bytes) noexcept
+  {
+    const uint64_t in_use = bytes_in_use_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    update_high_water_mark(in_use);
+  }
+
+  /// Report memory deallocated by the entity.
+  void
+  on_deallocate(size_t bytes) noexcept
+  {
+    bytes_in_use_.fetch_sub(bytes, std::memory_order_relaxed);
+  }
+
+  /// Return the memory used by the entity, calling the probe if any.
+  RCLCPP_PUBLIC
+  MemoryUsage
+  get_usage() const;
+
+  /// Set the high-water mark to the bytes in use reported.
+  RCLCPP_PUBLIC
+  void
+  reset_high_water_mark() noexcept;
+
+private:
+  friend class MemoryAccounting;
+
+  void
+  update_high_water_mark(uint64_t bytes) const noexcept
+  {
+    uint64_t current = high_water_mark_.load(std::memory_order_relaxed);
+    while (current < bytes &&
+      !high_water_mark_.compare_exchange_weak(current, bytes, std::memory_order_relaxed))
+    {
+    }
+  }
+
+  const std::string node_name_;
+  const std::string entity_name_;
+  const MemoryEntityKind kind_;
+  const Probe probe_;
+  std::atomic<uint64_t> bytes_in_use_{0};
+  mutable std::atomic<uint64_t> high_water_mark_{0};
+};
+
+/// Opt-in accounting of the memory used by the nodes and their entities.
+/**
+ * When enabled, the entities created afterwards account the memory rclcpp holds for them:
+ * - the intra-process buffers of the subscriptions, measured from their occupancy,
+ * - the free serialized messages kept by the subscriptions for their next takes,
+ * - the pools of the intra-process message copies of the publishers,
+ * - the parameters of the nodes.
+ *
+ * The messages are measured by their size, without the memory they reference, e.g. the data
+ * of their sequences.
+ * To account every allocation of an entity, give it an AccountingMemoryResource with the
+ * memory resource options, e.g. rclcpp::PublisherOptionsWithMemoryResource.
+ *
+ * The usage is queried per node with rclcpp::Node::get_memory_usage(), or published
+ * periodically by a rclcpp::MemoryUsagePublisher.
+ *
+ * When disabled, which is the default, no account is created by rclcpp.
+ * All public member functions are thread-safe.
+ */
+class MemoryAccounting
+{
+public:
+  /// Start accounting the memory of the entities created from now on.
+  RCLCPP_PUBLIC
+  static void
+  enable();
+
+  /// Stop creating accounts, the existing ones are kept.
+  RCLCPP_PUBLIC
+  static void
+  disable();
+
+  /// Return true if the memory of the new entities is accounted.
+  RCLCPP_PUBLIC
+  static bool
+  is_enabled() noexcept;
+
+  /// Create an account if the accounting is enabled, otherwise return nullptr.
+  RCLCPP_PUBLIC
+  static MemoryAccount::SharedPtr
+  create_account(
+    const std::string & node_name,
+    const std::string & entity_name,
+    MemoryEntityKind kind,
+    MemoryAccount::Probe probe = nullptr);
+
+  /// Return the memory used by the entities of all the nodes.
+  RCLCPP_PUBLIC
+  static std::vector<MemoryUsage>
+  get_usage();
+
+  /// Return the memory used by the entities of a node.
+  /**
+   * \param[in] node_name the fully qualified name of the node.
+   */
+  RCLCPP_PUBLIC
+  static std::vector<MemoryUsage>
+  get_usage(const std::string & node_name);
+
+  /// Return the total memory used by the entities of a node.
+  RCLCPP_PUBLIC
+  static uint64_t
+  get_total_bytes_in_use(const std::string & node_name);
+
+private:
+  friend class MemoryAccount;
+
+  static void
+  register_account(const MemoryAccount * account);
+
+  static void
+  unregister_account(const MemoryAccount * account);
+};
+
+/// Memory resource reporting the memory allocated from an upstream resource to an account.
+/**
+ * Each allocation costs two relaxed atomic operations on top of the upstream ones.
+ * The upstream memory resource isn't owned, it must outlive this one.
+ */
+class AccountingMemoryResource : public std::pmr::memory_resource
+{
+public:
+  /// Create a memory resource reporting to the account, which may be nullptr.
+  /**
+   * \throws std::invalid_argument if the upstream memory resource is nullptr.
+   */
+  RCLCPP_PUBLIC
+  explicit AccountingMemoryResource(
+    MemoryAccount::SharedPtr account,
+    std::pmr::memory_resource * upstream = std::pmr::get_default_resource());
+
+  /// Return the account, nullptr if none.
+  RCLCPP_PUBLIC
+  const MemoryAccount::SharedPtr &
+  get_account() const noexcept;
+
+protected:
+  RCLCPP_PUBLIC
+  void *
+  do_allocate(size_t bytes, size_t alignment) override;
+
+  RCLCPP_PUBLIC
+  void
+  do_deallocate(void * pointer, size_t bytes, size_t alignment) override;
+
+  RCLCPP_PUBLIC
+  bool
+  do_is_equal(const std::pmr::memory_resource & other) const noexcept override;
+
+private:
+  MemoryAccount::SharedPtr account_;
+  std::pmr::memory_resource * upstream_;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__MEMORY_ACCOUNTING_HPP_
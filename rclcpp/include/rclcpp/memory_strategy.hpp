@@ -18,6 +18,7 @@
 #include <list>
 #include <map>
 #include <memory>
+#include <vector>
 
 #include "rcl/allocator.h"
 #include "rcl/wait.h"
@@ -33,6 +34,17 @@ namespace rclcpp
 namespace memory_strategy
 {
 
+/// Order in which the ready timers are returned by MemoryStrategy::get_next_timer().
+enum class TimerDispatchOrder
+{
+  /// In the order the timers were collected, the default memory strategy serving the callback
+  /// groups in turn.
+  CollectionOrder,
+  /// Earliest deadline first, the deadline of a ready timer being its scheduled call time
+  /// plus its period, i.e. the moment its next call is due.
+  EarliestDeadlineFirst
+};
+
 /// Delegate for handling memory allocations while the Executor is executing.
 /**
  * By default, the memory strategy dynamically allocates memory for structures that come in from
@@ -51,6 +63,24 @@ public:
 
   virtual bool collect_entities(const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes) = 0;
 
+  /// Replace the current handles with the entities found by the last call to collect_entities().
+  /**
+   * This allows the executor to skip collecting the entities when its callback groups did not
+   * change since the last collection.
+   * \return false if the entities need to be collected again, e.g. because one of them was
+   *   destroyed or because the memory strategy does not support it.
+   */
+  virtual bool restore_collected_entities() {return false;}
+
+  /// Set the order in which the ready timers are returned by get_next_timer().
+  /**
+   * \return false if the memory strategy does not support the given order.
+   */
+  virtual bool set_timer_dispatch_order(TimerDispatchOrder order)
+  {
+    return TimerDispatchOrder::CollectionOrder == order;
+  }
+
   virtual size_t number_of_ready_subscriptions() const = 0;
   virtual size_t number_of_ready_services() const = 0;
   virtual size_t number_of_ready_clients() const = 0;
@@ -59,6 +89,18 @@ public:
   virtual size_t number_of_guard_conditions() const = 0;
   virtual size_t number_of_waitables() const = 0;
 
+  /// Append the addresses of the ready subscription, timer and waitable handles.
+  /**
+   * After remove_null_handles(), the handles are those of the entities found ready by the wait
+   * which weren't taken since, e.g. for rclcpp::Executor::get_introspection_snapshot().
+   * The subscriptions and timers are given by the address of their rcl handle.
+   * The default implementation appends nothing.
+   */
+  virtual void get_ready_handles(std::vector<const void *> & handles) const
+  {
+    (void)handles;
+  }
+
   virtual void add_waitable_handle(const rclcpp::Waitable::SharedPtr & waitable) = 0;
   virtual bool add_handles_to_wait_set(rcl_wait_set_t * wait_set) = 0;
   virtual void clear_handles() = 0;
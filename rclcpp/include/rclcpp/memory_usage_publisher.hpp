@@ -0,0 +1,100 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__MEMORY_USAGE_PUBLISHER_HPP_
+#define RCLCPP__MEMORY_USAGE_PUBLISHER_HPP_
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "rclcpp/create_publisher.hpp"
+#include "rclcpp/create_timer.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/memory_accounting.hpp"
+#include "rclcpp/publisher.hpp"
+#include "rclcpp/qos.hpp"
+#include "rclcpp/time.hpp"
+#include "rclcpp/timer.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+#include "statistics_msgs/msg/metrics_message.hpp"
+
+namespace rclcpp
+{
+
+/// Publish periodically the memory used by the entities of a node, see MemoryAccounting.
+/**
+ * A statistics_msgs::msg::MetricsMessage is published per account of the node, with the node
+ * as measurement source and "<kind>/<entity>" as metrics source, in bytes.
+ * Its statistics hold a single sample: the average is the number of bytes in use and the
+ * maximum the high-water mark.
+ */
+class MemoryUsagePublisher
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(MemoryUsagePublisher)
+
+  static constexpr const char * default_topic_name = "memory_usage";
+
+  /// Create the publisher and the timer publishing the memory usage of the node.
+  /**
+   * \param[in] node the node whose memory usage is published, and which publishes it.
+   * \param[in] period the period of the publications.
+   * \param[in] topic_name the topic the memory usage is published on.
+   * \param[in] qos the quality of service of the publisher.
+   */
+  template<typename NodeT>
+  MemoryUsagePublisher(
+    NodeT & node,
+    std::chrono::nanoseconds period,
+    const std::string & topic_name = default_topic_name,
+    const rclcpp::QoS & qos = rclcpp::QoS(10))
+  : node_name_(node.get_fully_qualified_name()), window_start_(now())
+  {
+    publisher_ = rclcpp::create_publisher<statistics_msgs::msg::MetricsMessage>(
+      node, topic_name, qos);
+    timer_ = rclcpp::create_wall_timer(
+      period, [this]() {publish();}, nullptr,
+      node.get_node_base_interface().get(), node.get_node_timers_interface().get());
+  }
+
+  RCLCPP_PUBLIC
+  virtual ~MemoryUsagePublisher();
+
+  /// Publish the memory usage of the node now.
+  RCLCPP_PUBLIC
+  void
+  publish();
+
+  /// Return the messages describing the memory usage of the node, without publishing them.
+  RCLCPP_PUBLIC
+  std::vector<statistics_msgs::msg::MetricsMessage>
+  generate_messages();
+
+private:
+  RCLCPP_PUBLIC
+  static rclcpp::Time
+  now();
+
+  const std::string node_name_;
+  rclcpp::Time window_start_;
+  rclcpp::Publisher<statistics_msgs::msg::MetricsMessage>::SharedPtr publisher_;
+  rclcpp::TimerBase::SharedPtr timer_;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__MEMORY_USAGE_PUBLISHER_HPP_
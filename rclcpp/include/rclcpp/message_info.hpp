@@ -17,6 +17,7 @@
 
 #include "rmw/types.h"
 
+#include "rclcpp/message_lineage.hpp"
 #include "rclcpp/visibility_control.hpp"
 
 namespace rclcpp
@@ -46,8 +47,22 @@ public:
   rmw_message_info_t &
   get_rmw_message_info();
 
+  /// Return the flow of the message, invalid if it isn't part of one.
+  /**
+   * Only the intra-process messages published with
+   * rclcpp::PublisherOptionsBase::propagate_lineage to subscriptions with
+   * rclcpp::SubscriptionOptionsBase::track_lineage have one.
+   */
+  const rclcpp::MessageLineage &
+  get_lineage() const;
+
+  /// Set the flow of the message.
+  void
+  set_lineage(const rclcpp::MessageLineage & lineage);
+
 private:
   rmw_message_info_t rmw_message_info_;
+  rclcpp::MessageLineage lineage_;
 };
 
 }  // namespace rclcpp
@@ -0,0 +1,182 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__MESSAGE_LINEAGE_HPP_
+#define RCLCPP__MESSAGE_LINEAGE_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/topic_statistics/atomic_histogram.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// Flow a message belongs to, propagated from the messages received to the ones published.
+/**
+ * A flow starts with a message published by a publisher with
+ * rclcpp::PublisherOptionsBase::propagate_lineage while no flow is current on the publishing
+ * thread.
+ * The flow of a message is current while its callback runs, so the messages published from
+ * the callback by such publishers continue it, and each hop of a chain of components can
+ * measure its latency from the origin of the flow, see rclcpp::MessageLineageTracker.
+ *
+ * Only the intra-process messages carry their flow, the middleware has no metadata to
+ * carry it to other processes.
+ */
+struct MessageLineage
+{
+  /// Identifier of the flow, 0 when the message isn't part of one.
+  uint64_t flow_id = 0;
+
+  /// System time, in nanoseconds since the epoch, at which the first message was published.
+  int64_t origin_timestamp = 0;
+
+  /// Return true if the message is part of a flow.
+  bool
+  is_valid() const
+  {
+    return flow_id != 0;
+  }
+};
+
+/// Return a new flow starting now, with an identifier unlikely to be used by other processes.
+RCLCPP_PUBLIC
+MessageLineage
+start_message_flow();
+
+/// Return the flow current on this thread, invalid outside the callbacks of its messages.
+RCLCPP_PUBLIC
+const MessageLineage &
+get_current_message_lineage();
+
+/// Make a flow current on this thread while the scope exists.
+/**
+ * The intra-process subscriptions set the flow of the message around its callback, this is
+ * for the processing done elsewhere, e.g. by a timer callback for data received earlier.
+ */
+class MessageLineageScope
+{
+public:
+  RCLCPP_PUBLIC
+  explicit MessageLineageScope(const MessageLineage & lineage);
+
+  RCLCPP_PUBLIC
+  ~MessageLineageScope();
+
+private:
+  RCLCPP_DISABLE_COPY(MessageLineageScope)
+
+  MessageLineage previous_lineage_;
+  MessageLineage previous_published_lineage_;
+};
+
+/// Record the flows of the intra-process messages of a subscription and their latency.
+/**
+ * The flow of a message is recorded when it's queued, keyed by its address, and the
+ * latency from the origin of the flow is measured when it's taken.
+ * Only the flows of the last `capacity` messages queued are kept, the messages of a flow
+ * dropped by the buffer are then forgotten.
+ *
+ * All public member functions are thread-safe.
+ */
+class MessageLineageTracker
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(MessageLineageTracker)
+
+  /// Create a tracker keeping the flows of up to `capacity` messages queued.
+  /**
+   * \throws std::invalid_argument if the capacity is 0.
+   */
+  RCLCPP_PUBLIC
+  explicit MessageLineageTracker(size_t capacity);
+
+  /// Record the flow published on this thread for a message queued.
+  RCLCPP_PUBLIC
+  void
+  record(const void * message);
+
+  /// Return the flow recorded for a message taken, forget it and measure its latency.
+  /**
+   * \return the flow of the message, invalid if none was recorded.
+   */
+  RCLCPP_PUBLIC
+  MessageLineage
+  take(const void * message);
+
+  /// Return the latencies, in nanoseconds, measured since the previous snapshot.
+  RCLCPP_PUBLIC
+  rclcpp::topic_statistics::AtomicHistogram::Snapshot
+  take_latency_snapshot();
+
+  /// Return the number of messages taken without a flow.
+  RCLCPP_PUBLIC
+  uint64_t
+  get_untracked_count() const;
+
+private:
+  struct Entry
+  {
+    const void * message = nullptr;
+    MessageLineage lineage;
+  };
+
+  std::mutex mutex_;
+  std::vector<Entry> entries_;
+  /// Index of the entry recorded next, overwriting the oldest one.
+  size_t next_entry_ = 0;
+
+  rclcpp::topic_statistics::AtomicHistogram latency_histogram_;
+  std::atomic<uint64_t> untracked_count_{0};
+};
+
+namespace detail
+{
+
+/// Return the flow given to the intra-process messages being published on this thread.
+RCLCPP_PUBLIC
+const MessageLineage &
+get_published_message_lineage();
+
+/// Set the flow of the messages published on this thread while the scope exists.
+/**
+ * The flow current on the thread is continued, otherwise a new one is started.
+ */
+class PublishedLineageScope
+{
+public:
+  /// \param[in] enabled false for a scope doing nothing.
+  RCLCPP_PUBLIC
+  explicit PublishedLineageScope(bool enabled);
+
+  RCLCPP_PUBLIC
+  ~PublishedLineageScope();
+
+private:
+  RCLCPP_DISABLE_COPY(PublishedLineageScope)
+
+  const bool enabled_;
+  MessageLineage previous_published_lineage_;
+};
+
+}  // namespace detail
+}  // namespace rclcpp
+
+#endif  // RCLCPP__MESSAGE_LINEAGE_HPP_
@@ -24,6 +24,7 @@
 #include "rclcpp/exceptions.hpp"
 #include "rclcpp/macros.hpp"
 #include "rclcpp/serialized_message.hpp"
+#include "rclcpp/serialized_message_pool.hpp"
 #include "rclcpp/visibility_control.hpp"
 
 #include "rcutils/logging_macros.h"
@@ -87,9 +88,14 @@ public:
     return std::allocate_shared<MessageT, MessageAlloc>(*message_allocator_.get());
   }
 
+  /// By default, reuse a returned serialized message, keeping the capacity of its buffer.
+  /**
+   * \param[in] capacity the minimum capacity of the buffer of the message.
+   * \return Shared pointer to the empty message.
+   */
   virtual std::shared_ptr<rclcpp::SerializedMessage> borrow_serialized_message(size_t capacity)
   {
-    return std::make_shared<rclcpp::SerializedMessage>(capacity);
+    return serialized_message_pool_.acquire(capacity);
   }
 
   virtual std::shared_ptr<rclcpp::SerializedMessage> borrow_serialized_message()
@@ -109,10 +115,12 @@ public:
     msg.reset();
   }
 
+  /// Keep the serialized message for the next borrow, unless it has other owners.
+  /** \param[in] serialized_msg Shared pointer to the message we are returning. */
   virtual void return_serialized_message(
     std::shared_ptr<rclcpp::SerializedMessage> & serialized_msg)
   {
-    serialized_msg.reset();
+    serialized_message_pool_.release(serialized_msg);
   }
 
   std::shared_ptr<MessageAlloc> message_allocator_;
@@ -124,6 +132,7 @@ public:
   std::shared_ptr<BufferAlloc> buffer_allocator_;
   BufferDeleter buffer_deleter_;
   size_t default_buffer_capacity_ = 0;
+  rclcpp::SerializedMessagePool serialized_message_pool_;
 
   rcutils_allocator_t rcutils_allocator_;
 };
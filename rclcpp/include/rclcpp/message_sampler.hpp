@@ -0,0 +1,262 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__MESSAGE_SAMPLER_HPP_
+#define RCLCPP__MESSAGE_SAMPLER_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "rosidl_runtime_cpp/traits.hpp"
+
+#include "rclcpp/callback_group.hpp"
+#include "rclcpp/context.hpp"
+#include "rclcpp/create_subscription.hpp"
+#include "rclcpp/guard_condition.hpp"
+#include "rclcpp/intra_process_setting.hpp"
+#include "rclcpp/latest_message.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/message_info.hpp"
+#include "rclcpp/qos.hpp"
+#include "rclcpp/subscription.hpp"
+#include "rclcpp/subscription_options.hpp"
+#include "rclcpp/wait_set.hpp"
+
+namespace rclcpp
+{
+
+/// Sample the messages of a topic on demand, with a subscription and a wait set kept alive.
+/**
+ * Unlike rclcpp::wait_for_message(), which creates a subscription and a wait set per call,
+ * the subscription is created once, so the discovery is done once, and a sample costs a wait
+ * and a take.
+ * The messages are taken into recycled messages, which are only allocated while the caller
+ * still holds the previous samples.
+ *
+ * The subscription is in a callback group of its own, not added to the executors with the
+ * node, so the sampler works whether the node is spun or not.
+ * It doesn't use intra-process communication, its messages are taken from the middleware.
+ *
+ * All public member functions are thread-safe, the calls waiting for a message are serialized.
+ */
+template<typename MessageT>
+class MessageSampler
+{
+  static_assert(
+    rosidl_generator_traits::is_message<MessageT>::value,
+    "the messages sampled must be ROS messages");
+
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(MessageSampler)
+
+  /// Create the subscription of the sampler.
+  /**
+   * \param[in] node the node creating the subscription.
+   * \param[in] topic_name the topic to sample.
+   * \param[in] qos the quality of service of the subscription, only the latest message
+   *   matters by default.
+   */
+  template<typename NodeT>
+  MessageSampler(
+    NodeT & node,
+    const std::string & topic_name,
+    const rclcpp::QoS & qos = rclcpp::QoS(1))
+  : context_(node.get_node_base_interface()->get_context()),
+    shutdown_guard_condition_(std::make_shared<rclcpp::GuardCondition>(context_))
+  {
+    callback_group_ = node.create_callback_group(
+      rclcpp::CallbackGroupType::MutuallyExclusive, false);
+    rclcpp::SubscriptionOptions options;
+    options.callback_group = callback_group_;
+    options.use_intra_process_comm = rclcpp::IntraProcessSetting::Disable;
+    // The messages are only taken by the sampler, the callback is never called
+    subscription_ = rclcpp::create_subscription<MessageT>(
+      node, topic_name, qos, [](std::shared_ptr<const MessageT>) {}, options);
+    std::weak_ptr<rclcpp::GuardCondition> weak_guard_condition = shutdown_guard_condition_;
+    shutdown_callback_handle_ = context_->add_on_shutdown_callback(
+      [weak_guard_condition]() {
+        auto guard_condition = weak_guard_condition.lock();
+        if (guard_condition) {
+          guard_condition->trigger();
+        }
+      });
+    wait_set_.add_subscription(subscription_);
+    wait_set_.add_guard_condition(shutdown_guard_condition_);
+  }
+
+  virtual ~MessageSampler()
+  {
+    context_->remove_on_shutdown_callback(shutdown_callback_handle_);
+  }
+
+  /// Wait for a message not returned yet by this sampler.
+  /**
+   * The newest pending message is returned at once, otherwise the next one received.
+   *
+   * \param[in] timeout the maximum time to wait, forever if negative.
+   * \return the message, or nullptr on timeout or once the context is shut down.
+   */
+  std::shared_ptr<const MessageT>
+  wait_next(std::chrono::nanoseconds timeout = std::chrono::nanoseconds(-1))
+  {
+    const auto deadline = get_deadline(timeout);
+    std::unique_lock<std::timed_mutex> lock(mutex_, std::defer_lock);
+    if (!lock_until(lock, deadline) || !wait_for_new_message(deadline)) {
+      return nullptr;
+    }
+    has_new_message_ = false;
+    return latest_message_.load();
+  }
+
+  /// Return the latest message received, waiting for the first one if none was received yet.
+  /**
+   * \param[in] timeout the maximum time to wait for the first message, forever if negative.
+   * \return the message, or nullptr if none was received before the timeout or the shutdown.
+   */
+  std::shared_ptr<const MessageT>
+  get_latest(std::chrono::nanoseconds timeout = std::chrono::nanoseconds(0))
+  {
+    const auto deadline = get_deadline(timeout);
+    std::unique_lock<std::timed_mutex> lock(mutex_, std::defer_lock);
+    if (!lock_until(lock, deadline)) {
+      // Another call is waiting, it takes the messages meanwhile
+      return latest_message_.load();
+    }
+    take_pending_messages();
+    if (!latest_message_.load() && !wait_for_new_message(deadline)) {
+      return nullptr;
+    }
+    has_new_message_ = false;
+    return latest_message_.load();
+  }
+
+  /// Return the number of messages taken by the sampler, including the ones never returned.
+  uint64_t
+  get_received_count() const
+  {
+    return received_count_.load(std::memory_order_relaxed);
+  }
+
+  /// Return the subscription of the sampler.
+  typename rclcpp::Subscription<MessageT>::SharedPtr
+  get_subscription() const
+  {
+    return subscription_;
+  }
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  static Clock::time_point
+  get_deadline(std::chrono::nanoseconds timeout)
+  {
+    if (timeout.count() < 0) {
+      return Clock::time_point::max();
+    }
+    return Clock::now() + timeout;
+  }
+
+  static bool
+  lock_until(std::unique_lock<std::timed_mutex> & lock, Clock::time_point deadline)
+  {
+    if (deadline == Clock::time_point::max()) {
+      lock.lock();
+      return true;
+    }
+    return lock.try_lock_until(deadline);
+  }
+
+  /// Take the pending messages, the newest becoming the latest one, mutex_ must be locked.
+  void
+  take_pending_messages()
+  {
+    rclcpp::MessageInfo message_info;
+    while (true) {
+      // Only recycled once unreachable from the slot and not held by a caller anymore
+      if (!spare_message_ || spare_message_.use_count() > 1) {
+        spare_message_ = std::make_shared<MessageT>();
+      }
+      if (!subscription_->take(*spare_message_, message_info)) {
+        return;
+      }
+      latest_message_.store(spare_message_);
+      std::swap(current_message_, spare_message_);
+      received_count_.fetch_add(1, std::memory_order_relaxed);
+      has_new_message_ = true;
+    }
+  }
+
+  /// Wait until a new message is taken, mutex_ must be locked.
+  bool
+  wait_for_new_message(Clock::time_point deadline)
+  {
+    while (true) {
+      take_pending_messages();
+      if (has_new_message_) {
+        return true;
+      }
+      std::chrono::nanoseconds remaining(-1);
+      if (deadline != Clock::time_point::max()) {
+        remaining = std::max(
+          std::chrono::nanoseconds(0),
+          std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - Clock::now()));
+      }
+      auto result = wait_set_.wait(remaining);
+      if (result.kind() != rclcpp::WaitResultKind::Ready || is_shut_down()) {
+        return false;
+      }
+    }
+  }
+
+  /// Return true if the shutdown guard condition woke up the wait set.
+  bool
+  is_shut_down()
+  {
+    const auto & rcl_wait_set = wait_set_.get_rcl_wait_set();
+    const rcl_guard_condition_t * shutdown_guard_condition =
+      &shutdown_guard_condition_->get_rcl_guard_condition();
+    for (size_t i = 0; i < rcl_wait_set.size_of_guard_conditions; ++i) {
+      if (rcl_wait_set.guard_conditions[i] == shutdown_guard_condition) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  rclcpp::Context::SharedPtr context_;
+  rclcpp::GuardCondition::SharedPtr shutdown_guard_condition_;
+  rclcpp::OnShutdownCallbackHandle shutdown_callback_handle_;
+  rclcpp::CallbackGroup::SharedPtr callback_group_;
+  typename rclcpp::Subscription<MessageT>::SharedPtr subscription_;
+
+  std::timed_mutex mutex_;
+  rclcpp::WaitSet wait_set_;
+  // The latest message, also held by latest_message_, and the one recycled for the next take
+  std::shared_ptr<MessageT> current_message_;
+  std::shared_ptr<MessageT> spare_message_;
+  bool has_new_message_ = false;
+  rclcpp::LatestMessage<MessageT> latest_message_;
+  std::atomic<uint64_t> received_count_{0};
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__MESSAGE_SAMPLER_HPP_
@@ -0,0 +1,236 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__MULTI_NODE_PARAMETERS_CLIENT_HPP_
+#define RCLCPP__MULTI_NODE_PARAMETERS_CLIENT_HPP_
+
+#include <chrono>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rcl_interfaces/msg/list_parameters_result.hpp"
+#include "rcl_interfaces/msg/parameter_descriptor.hpp"
+#include "rcl_interfaces/msg/set_parameters_result.hpp"
+
+#include "rclcpp/callback_group.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/node_interfaces/node_base_interface.hpp"
+#include "rclcpp/node_interfaces/node_graph_interface.hpp"
+#include "rclcpp/node_interfaces/node_services_interface.hpp"
+#include "rclcpp/node_interfaces/node_timers_interface.hpp"
+#include "rclcpp/node_interfaces/node_topics_interface.hpp"
+#include "rclcpp/parameter.hpp"
+#include "rclcpp/qos.hpp"
+#include "rclcpp/timer.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// Status of a request sent by a MultiNodeParametersClient to one of its remote nodes.
+enum class RemoteParametersStatus
+{
+  /// The remote node replied.
+  Success,
+  /// The remote node didn't reply within the timeout.
+  Timeout,
+  /// The request couldn't be sent or its reply couldn't be read.
+  Failure,
+};
+
+/// Result of a request sent by a MultiNodeParametersClient to one of its remote nodes.
+template<typename ResultT>
+struct RemoteParametersResult
+{
+  RemoteParametersStatus status = RemoteParametersStatus::Timeout;
+
+  /// Reply of the remote node, only valid when the status is RemoteParametersStatus::Success.
+  ResultT result;
+};
+
+/// Options of a MultiNodeParametersClient.
+struct MultiNodeParametersClientOptions
+{
+  /// Maximum number of requests waiting for the reply of each remote node.
+  /**
+   * The other requests to the node are queued and sent as the replies come in.
+   */
+  size_t max_requests_in_flight = 4;
+
+  /// Time given to a remote node to reply to a request, from when the request is sent.
+  std::chrono::nanoseconds timeout = std::chrono::seconds(5);
+
+  /// QoS profile of the parameter service clients.
+  rclcpp::QoS qos_profile = rclcpp::ParametersQoS();
+
+  /// Callback group of the parameter service clients and of the timeout timer.
+  rclcpp::CallbackGroup::SharedPtr group = nullptr;
+};
+
+/// Parameter client of several remote nodes.
+/**
+ * Each request is sent to all the remote nodes at once, or to a part of them, and its
+ * future is completed with the results of all the nodes once they all replied or timed out.
+ * Several requests can be waiting for the reply of the same node, up to
+ * MultiNodeParametersClientOptions::max_requests_in_flight, so the requests sent one after
+ * another are pipelined instead of waiting for each other.
+ *
+ * The replies are received, and the timeouts checked, by the executor spinning the node
+ * of the client.
+ */
+class MultiNodeParametersClient
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(MultiNodeParametersClient)
+
+  /// Results of a request, by name of remote node.
+  template<typename ResultT>
+  using Results = std::map<std::string, RemoteParametersResult<ResultT>>;
+
+  template<typename ResultT>
+  using SharedFuture = std::shared_future<Results<ResultT>>;
+
+  template<typename ResultT>
+  using CallbackType = std::function<void (SharedFuture<ResultT>)>;
+
+  /// Create a parameter client of several remote nodes.
+  /**
+   * \param[in] node_base_interface The node base interface of the corresponding node.
+   * \param[in] node_topics_interface Node topic base interface.
+   * \param[in] node_graph_interface The node graph interface of the corresponding node.
+   * \param[in] node_services_interface Node service interface.
+   * \param[in] node_timers_interface Node timers interface, used to check the timeouts.
+   * \param[in] remote_node_names Fully qualified names of the remote nodes.
+   * \param[in] options Options of the client.
+   * \throws std::invalid_argument if max_requests_in_flight or timeout isn't positive.
+   */
+  RCLCPP_PUBLIC
+  MultiNodeParametersClient(
+    const rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_base_interface,
+    const rclcpp::node_interfaces::NodeTopicsInterface::SharedPtr node_topics_interface,
+    const rclcpp::node_interfaces::NodeGraphInterface::SharedPtr node_graph_interface,
+    const rclcpp::node_interfaces::NodeServicesInterface::SharedPtr node_services_interface,
+    const rclcpp::node_interfaces::NodeTimersInterface::SharedPtr node_timers_interface,
+    const std::vector<std::string> & remote_node_names,
+    const MultiNodeParametersClientOptions & options = MultiNodeParametersClientOptions());
+
+  /// Create a parameter client of several remote nodes.
+  /**
+   * \param[in] node The parameter service clients will be added to this node.
+   * \param[in] remote_node_names Fully qualified names of the remote nodes.
+   * \param[in] options Options of the client.
+   */
+  template<typename NodeT>
+  MultiNodeParametersClient(
+    const std::shared_ptr<NodeT> node,
+    const std::vector<std::string> & remote_node_names,
+    const MultiNodeParametersClientOptions & options = MultiNodeParametersClientOptions())
+  : MultiNodeParametersClient(
+      node->get_node_base_interface(),
+      node->get_node_topics_interface(),
+      node->get_node_graph_interface(),
+      node->get_node_services_interface(),
+      node->get_node_timers_interface(),
+      remote_node_names,
+      options)
+  {}
+
+  RCLCPP_PUBLIC
+  virtual
+  ~MultiNodeParametersClient();
+
+  /// Get the names of the remote nodes.
+  RCLCPP_PUBLIC
+  std::vector<std::string>
+  get_remote_node_names() const;
+
+  /// Get the number of requests sent and waiting for a reply, for all the remote nodes.
+  RCLCPP_PUBLIC
+  size_t
+  get_requests_in_flight() const;
+
+  RCLCPP_PUBLIC
+  SharedFuture<std::vector<rclcpp::Parameter>>
+  get_parameters(
+    const std::vector<std::string> & names,
+    CallbackType<std::vector<rclcpp::Parameter>> callback = nullptr);
+
+  RCLCPP_PUBLIC
+  SharedFuture<std::vector<rcl_interfaces::msg::ParameterDescriptor>>
+  describe_parameters(
+    const std::vector<std::string> & names,
+    CallbackType<std::vector<rcl_interfaces::msg::ParameterDescriptor>> callback = nullptr);
+
+  /// Set the same parameters on all the remote nodes.
+  RCLCPP_PUBLIC
+  SharedFuture<std::vector<rcl_interfaces::msg::SetParametersResult>>
+  set_parameters(
+    const std::vector<rclcpp::Parameter> & parameters,
+    CallbackType<std::vector<rcl_interfaces::msg::SetParametersResult>> callback = nullptr);
+
+  /// Set different parameters on each remote node.
+  /**
+   * \param[in] parameters The parameters to set, by name of remote node.
+   *   The request is only sent to the nodes of the map.
+   * \param[in] callback (optional) Called with the future once it's completed.
+   * \throws std::invalid_argument if a node isn't a remote node of this client.
+   */
+  RCLCPP_PUBLIC
+  SharedFuture<std::vector<rcl_interfaces::msg::SetParametersResult>>
+  set_parameters(
+    const std::map<std::string, std::vector<rclcpp::Parameter>> & parameters,
+    CallbackType<std::vector<rcl_interfaces::msg::SetParametersResult>> callback = nullptr);
+
+  RCLCPP_PUBLIC
+  SharedFuture<rcl_interfaces::msg::ListParametersResult>
+  list_parameters(
+    const std::vector<std::string> & prefixes,
+    uint64_t depth,
+    CallbackType<rcl_interfaces::msg::ListParametersResult> callback = nullptr);
+
+  /// Wait for the services of all the remote nodes to be ready.
+  /**
+   * \param timeout maximum time to wait
+   * \return `true` if the services are ready and the timeout is not over, `false` otherwise
+   */
+  template<typename RepT = int64_t, typename RatioT = std::milli>
+  bool
+  wait_for_services(
+    std::chrono::duration<RepT, RatioT> timeout = std::chrono::duration<RepT, RatioT>(-1))
+  {
+    return wait_for_services_nanoseconds(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(timeout)
+    );
+  }
+
+protected:
+  RCLCPP_PUBLIC
+  bool
+  wait_for_services_nanoseconds(std::chrono::nanoseconds timeout);
+
+private:
+  class State;
+
+  std::shared_ptr<State> state_;
+  rclcpp::TimerBase::SharedPtr timeout_timer_;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__MULTI_NODE_PARAMETERS_CLIENT_HPP_
@@ -18,6 +18,7 @@
 #include <atomic>
 #include <condition_variable>
 #include <functional>
+#include <future>
 #include <list>
 #include <map>
 #include <memory>
@@ -42,10 +43,13 @@
 #include "rclcpp/clock.hpp"
 #include "rclcpp/context.hpp"
 #include "rclcpp/event.hpp"
+#include "rclcpp/generic_client.hpp"
 #include "rclcpp/generic_publisher.hpp"
+#include "rclcpp/generic_service.hpp"
 #include "rclcpp/generic_subscription.hpp"
 #include "rclcpp/logger.hpp"
 #include "rclcpp/macros.hpp"
+#include "rclcpp/memory_accounting.hpp"
 #include "rclcpp/message_memory_strategy.hpp"
 #include "rclcpp/node_interfaces/node_base_interface.hpp"
 #include "rclcpp/node_interfaces/node_clock_interface.hpp"
@@ -59,6 +63,7 @@
 #include "rclcpp/node_interfaces/node_waitables_interface.hpp"
 #include "rclcpp/node_options.hpp"
 #include "rclcpp/parameter.hpp"
+#include "rclcpp/parameter_handle.hpp"
 #include "rclcpp/publisher.hpp"
 #include "rclcpp/publisher_options.hpp"
 #include "rclcpp/qos.hpp"
@@ -135,6 +140,14 @@ public:
   const char *
   get_fully_qualified_name() const;
 
+  /// Return the memory used by the entities of the node which is accounted.
+  /**
+   * It's empty unless rclcpp::MemoryAccounting was enabled before the entities were created.
+   */
+  RCLCPP_PUBLIC
+  std::vector<rclcpp::MemoryUsage>
+  get_memory_usage() const;
+
   /// Get the logger of the node.
   /** \return The logger of the node. */
   RCLCPP_PUBLIC
@@ -205,7 +218,8 @@ public:
    * \param[in] qos QoS profile for Subcription.
    * \param[in] callback The user-defined callback function to receive a message
    * \param[in] options Additional options for the creation of the Subscription.
-   * \param[in] msg_mem_strat The message memory strategy to use for allocating messages.
+   * \param[in] msg_mem_strat The message memory strategy to use for allocating messages,
+   *   nullptr for the default one using the allocator of the options.
    * \return Shared pointer to the created subscription.
    */
   template<
@@ -222,9 +236,7 @@ public:
     CallbackT && callback,
     const SubscriptionOptionsWithAllocator<AllocatorT> & options =
     SubscriptionOptionsWithAllocator<AllocatorT>(),
-    typename MessageMemoryStrategyT::SharedPtr msg_mem_strat = (
-      MessageMemoryStrategyT::create_default()
-    )
+    typename MessageMemoryStrategyT::SharedPtr msg_mem_strat = nullptr
   );
 
   /// Create a wall timer that uses the wall clock to drive the callback.
@@ -317,6 +329,86 @@ public:
     const rclcpp::QoS & qos = rclcpp::ServicesQoS(),
     rclcpp::CallbackGroup::SharedPtr group = nullptr);
 
+  /// Callback called once an entity created asynchronously is ready, or failed to be created.
+  /**
+   * It is called on the thread creating the entities, it must not block nor throw.
+   * Getting the value of the future rethrows the exception thrown by the creation, if any.
+   */
+  template<typename EntityT>
+  using EntityCreatedCallback =
+    std::function<void (std::shared_future<std::shared_ptr<EntityT>>)>;
+
+  /// Create a Publisher on a thread of the context, without blocking the caller.
+  /**
+   * The creation by the middleware may take milliseconds, this allows nodes to create entities
+   * from their callbacks without stalling their executor.
+   * The entities are created one at a time, in the order they were requested, by a thread
+   * shared by the nodes of the context.
+   * The node must be owned by a std::shared_ptr, the creation fails if it is destroyed before.
+   *
+   * \sa create_publisher
+   * \param[in] on_created called once the publisher is created, or failed to be, if set.
+   * \return future set to the publisher, or to the exception thrown by its creation.
+   * \throws std::bad_weak_ptr if the node isn't owned by a std::shared_ptr.
+   */
+  template<
+    typename MessageT,
+    typename AllocatorT = std::allocator<void>,
+    typename PublisherT = rclcpp::Publisher<MessageT, AllocatorT>>
+  std::shared_future<std::shared_ptr<PublisherT>>
+  create_publisher_async(
+    const std::string & topic_name,
+    const rclcpp::QoS & qos,
+    const PublisherOptionsWithAllocator<AllocatorT> & options =
+    PublisherOptionsWithAllocator<AllocatorT>(),
+    EntityCreatedCallback<PublisherT> on_created = nullptr);
+
+  /// Create a Subscription on a thread of the context, without blocking the caller.
+  /**
+   * The subscription is added to its callback group once created, the executors then wait
+   * for its messages.
+   *
+   * \sa create_subscription, create_publisher_async
+   */
+  template<
+    typename MessageT,
+    typename CallbackT,
+    typename AllocatorT = std::allocator<void>,
+    typename SubscriptionT = rclcpp::Subscription<MessageT, AllocatorT>>
+  std::shared_future<std::shared_ptr<SubscriptionT>>
+  create_subscription_async(
+    const std::string & topic_name,
+    const rclcpp::QoS & qos,
+    CallbackT && callback,
+    const SubscriptionOptionsWithAllocator<AllocatorT> & options =
+    SubscriptionOptionsWithAllocator<AllocatorT>(),
+    EntityCreatedCallback<SubscriptionT> on_created = nullptr);
+
+  /// Create a Client on a thread of the context, without blocking the caller.
+  /**
+   * \sa create_client, create_publisher_async
+   */
+  template<typename ServiceT>
+  std::shared_future<std::shared_ptr<rclcpp::Client<ServiceT>>>
+  create_client_async(
+    const std::string & service_name,
+    const rclcpp::QoS & qos = rclcpp::ServicesQoS(),
+    rclcpp::CallbackGroup::SharedPtr group = nullptr,
+    EntityCreatedCallback<rclcpp::Client<ServiceT>> on_created = nullptr);
+
+  /// Create a Service on a thread of the context, without blocking the caller.
+  /**
+   * \sa create_service, create_publisher_async
+   */
+  template<typename ServiceT, typename CallbackT>
+  std::shared_future<std::shared_ptr<rclcpp::Service<ServiceT>>>
+  create_service_async(
+    const std::string & service_name,
+    CallbackT && callback,
+    const rclcpp::QoS & qos = rclcpp::ServicesQoS(),
+    rclcpp::CallbackGroup::SharedPtr group = nullptr,
+    EntityCreatedCallback<rclcpp::Service<ServiceT>> on_created = nullptr);
+
   /// Create and return a GenericPublisher.
   /**
    * The returned pointer will never be empty, but this function can throw various exceptions, for
@@ -366,6 +458,64 @@ public:
     )
   );
 
+  /// Create and return a GenericSubscription borrowing views of the serialized messages.
+  /**
+   * \sa the other overload for a description of the parameters.
+   * \param[in] callback Callback for new messages, with a view of their serialized form, which
+   * is only valid during the callback
+   * \return Shared pointer to the created generic subscription.
+   */
+  template<typename AllocatorT = std::allocator<void>>
+  std::shared_ptr<rclcpp::GenericSubscription> create_generic_subscription(
+    const std::string & topic_name,
+    const std::string & topic_type,
+    const rclcpp::QoS & qos,
+    rclcpp::GenericSubscription::ViewCallback callback,
+    const rclcpp::SubscriptionOptionsWithAllocator<AllocatorT> & options = (
+      rclcpp::SubscriptionOptionsWithAllocator<AllocatorT>()
+    )
+  );
+
+  /// Create and return a GenericClient, sending serialized requests.
+  /**
+   * The returned pointer will never be empty, but this function can throw various exceptions, for
+   * instance when the service's package can not be found on the AMENT_PREFIX_PATH.
+   *
+   * \param[in] service_name The name on which the service is accessible.
+   * \param[in] service_type The type of the service, e.g. "std_srvs/srv/SetBool".
+   * \param[in] qos Quality of service profile for client.
+   * \param[in] group Callback group to handle the reply to service calls.
+   * \return Shared pointer to the created generic client.
+   */
+  RCLCPP_PUBLIC
+  rclcpp::GenericClient::SharedPtr
+  create_generic_client(
+    const std::string & service_name,
+    const std::string & service_type,
+    const rclcpp::QoS & qos = rclcpp::ServicesQoS(),
+    rclcpp::CallbackGroup::SharedPtr group = nullptr);
+
+  /// Create and return a GenericService, handling serialized requests.
+  /**
+   * The returned pointer will never be empty, but this function can throw various exceptions, for
+   * instance when the service's package can not be found on the AMENT_PREFIX_PATH.
+   *
+   * \param[in] service_name The name on which the service is accessible.
+   * \param[in] service_type The type of the service, e.g. "std_srvs/srv/SetBool".
+   * \param[in] callback User-defined callback function, see rclcpp::GenericService.
+   * \param[in] qos Quality of service profile for the service.
+   * \param[in] group Callback group to call the service.
+   * \return Shared pointer to the created generic service.
+   */
+  template<typename CallbackT>
+  rclcpp::GenericService::SharedPtr
+  create_generic_service(
+    const std::string & service_name,
+    const std::string & service_type,
+    CallbackT && callback,
+    const rclcpp::QoS & qos = rclcpp::ServicesQoS(),
+    rclcpp::CallbackGroup::SharedPtr group = nullptr);
+
   /// Declare and initialize a parameter, return the effective value.
   /**
    * This method is used to declare that a parameter exists on this node.
@@ -494,6 +644,22 @@ public:
     rcl_interfaces::msg::ParameterDescriptor(),
     bool ignore_override = false);
 
+  /// Declare and initialize a parameter with a type, return a handle to read its value.
+  /**
+   * See the templated declare_parameter() on this class for details.
+   *
+   * The handle reads the current value of the parameter without looking it up,
+   * see rclcpp::ParameterHandle.
+   */
+  template<typename ParameterT>
+  ParameterHandle<ParameterT>
+  declare_parameter_handle(
+    const std::string & name,
+    const ParameterT & default_value,
+    const rcl_interfaces::msg::ParameterDescriptor & parameter_descriptor =
+    rcl_interfaces::msg::ParameterDescriptor(),
+    bool ignore_override = false);
+
   /// Declare and initialize several parameters with the same namespace and type.
   /**
    * For each key in the map, a parameter with a name of "namespace.key"
@@ -514,22 +680,25 @@ public:
    * If `ignore_overrides` is `true`, all the overrides of the parameters declared
    * by the function call will be ignored.
    *
-   * This method will result in any callback registered with
-   * `add_on_set_parameters_callback` and `add_post_set_parameters_callback`
-   * to be called once for each parameter.
+   * The parameters are declared together, see
+   * rclcpp::node_interfaces::NodeParametersInterface::declare_parameters().
+   * The initial values are all checked against their descriptors before any
+   * callback is called, and either all the parameters are declared or none is.
    *
-   * This method, if successful, will result in any callback registered with
-   * `add_on_set_parameters_callback` to be called, once for each parameter.
-   * If that callback prevents the initial value for any parameter from being
-   * set then rclcpp::exceptions::InvalidParameterValueException is thrown.
+   * This method will result in any callback registered with
+   * `add_on_set_parameters_callback` to be called once, with the initial values
+   * of all the parameters.
+   * If that callback prevents the initial values from being set then
+   * rclcpp::exceptions::InvalidParameterValueException is thrown.
    *
    * If a callback was registered previously with `add_post_set_parameters_callback`,
-   * it will be called after setting the parameters successfully for the node,
-   * once for each parameter.
+   * it will be called once after setting the parameters successfully for the node.
    *
    * This method will _not_ result in any callbacks registered with
    * `add_pre_set_parameters_callback` to be called.
    *
+   * The declarations are published in a single parameter event.
+   *
    * \param[in] namespace_ The namespace in which to declare the parameters.
    * \param[in] parameters The parameters to set in the given namespace.
    * \param[in] ignore_overrides When `true`, the parameters overrides are ignored.
@@ -836,6 +1005,19 @@ public:
     const std::string & name,
     const ParameterT & alternative_value) const;
 
+  /// Return a handle reading the value of a declared parameter without looking it up.
+  /**
+   * \param[in] name The name of the parameter.
+   * \return The handle of the parameter, see rclcpp::ParameterHandle.
+   * \throws rclcpp::exceptions::ParameterNotDeclaredException if the parameter
+   *   has not been declared.
+   * \throws rclcpp::exceptions::InvalidParameterTypeException if the value of the
+   *   parameter isn't of the requested type.
+   */
+  template<typename ParameterT>
+  ParameterHandle<ParameterT>
+  get_parameter_handle(const std::string & name);
+
   /// Return the parameters by the given parameter names.
   /**
    * Like get_parameter(const std::string &), this method may throw the
@@ -1577,6 +1759,16 @@ protected:
 private:
   RCLCPP_DISABLE_COPY(Node)
 
+  /// Create an entity with the given function, called with the node on the creation thread.
+  template<typename EntityT, typename CreateT>
+  std::shared_future<std::shared_ptr<EntityT>>
+  create_entity_async(CreateT && create, EntityCreatedCallback<EntityT> on_created);
+
+  /// Post a creation to the thread creating the entities of the context.
+  RCLCPP_PUBLIC
+  void
+  post_entity_creation(std::function<void()> creation);
+
   rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_base_;
   rclcpp::node_interfaces::NodeGraphInterface::SharedPtr node_graph_;
   rclcpp::node_interfaces::NodeLoggingInterface::SharedPtr node_logging_;
@@ -21,6 +21,9 @@
 #include <algorithm>
 #include <chrono>
 #include <cstdlib>
+#include <exception>
+#include <functional>
+#include <future>
 #include <iostream>
 #include <limits>
 #include <map>
@@ -28,6 +31,7 @@
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -37,11 +41,13 @@
 #include "rclcpp/contexts/default_context.hpp"
 #include "rclcpp/create_client.hpp"
 #include "rclcpp/create_generic_publisher.hpp"
+#include "rclcpp/create_generic_service.hpp"
 #include "rclcpp/create_generic_subscription.hpp"
 #include "rclcpp/create_publisher.hpp"
 #include "rclcpp/create_service.hpp"
 #include "rclcpp/create_subscription.hpp"
 #include "rclcpp/create_timer.hpp"
+#include "rclcpp/detail/get_declared_parameter_values.hpp"
 #include "rclcpp/detail/resolve_enable_topic_statistics.hpp"
 #include "rclcpp/parameter.hpp"
 #include "rclcpp/qos.hpp"
@@ -185,6 +191,97 @@ Node::create_service(
     group);
 }
 
+template<typename EntityT, typename CreateT>
+std::shared_future<std::shared_ptr<EntityT>>
+Node::create_entity_async(CreateT && create, EntityCreatedCallback<EntityT> on_created)
+{
+  std::weak_ptr<Node> weak_node = this->shared_from_this();
+  auto promise = std::make_shared<std::promise<std::shared_ptr<EntityT>>>();
+  std::shared_future<std::shared_ptr<EntityT>> future = promise->get_future().share();
+  this->post_entity_creation(
+    [weak_node, promise, future, create = std::forward<CreateT>(create),
+    on_created = std::move(on_created)]() {
+      try {
+        auto node = weak_node.lock();
+        if (!node) {
+          throw std::runtime_error("the node was destroyed before the entity was created");
+        }
+        promise->set_value(create(*node));
+      } catch (...) {
+        promise->set_exception(std::current_exception());
+      }
+      if (on_created) {
+        on_created(future);
+      }
+    });
+  return future;
+}
+
+template<typename MessageT, typename AllocatorT, typename PublisherT>
+std::shared_future<std::shared_ptr<PublisherT>>
+Node::create_publisher_async(
+  const std::string & topic_name,
+  const rclcpp::QoS & qos,
+  const PublisherOptionsWithAllocator<AllocatorT> & options,
+  EntityCreatedCallback<PublisherT> on_created)
+{
+  return this->create_entity_async<PublisherT>(
+    [topic_name, qos, options](Node & node) {
+      return node.create_publisher<MessageT, AllocatorT, PublisherT>(topic_name, qos, options);
+    },
+    std::move(on_created));
+}
+
+template<typename MessageT, typename CallbackT, typename AllocatorT, typename SubscriptionT>
+std::shared_future<std::shared_ptr<SubscriptionT>>
+Node::create_subscription_async(
+  const std::string & topic_name,
+  const rclcpp::QoS & qos,
+  CallbackT && callback,
+  const SubscriptionOptionsWithAllocator<AllocatorT> & options,
+  EntityCreatedCallback<SubscriptionT> on_created)
+{
+  return this->create_entity_async<SubscriptionT>(
+    [topic_name, qos, callback = std::decay_t<CallbackT>(std::forward<CallbackT>(callback)),
+    options](Node & node) {
+      return node.create_subscription<MessageT, const std::decay_t<CallbackT> &, AllocatorT,
+      SubscriptionT>(topic_name, qos, callback, options);
+    },
+    std::move(on_created));
+}
+
+template<typename ServiceT>
+std::shared_future<std::shared_ptr<rclcpp::Client<ServiceT>>>
+Node::create_client_async(
+  const std::string & service_name,
+  const rclcpp::QoS & qos,
+  rclcpp::CallbackGroup::SharedPtr group,
+  EntityCreatedCallback<rclcpp::Client<ServiceT>> on_created)
+{
+  return this->create_entity_async<rclcpp::Client<ServiceT>>(
+    [service_name, qos, group](Node & node) {
+      return node.create_client<ServiceT>(service_name, qos, group);
+    },
+    std::move(on_created));
+}
+
+template<typename ServiceT, typename CallbackT>
+std::shared_future<std::shared_ptr<rclcpp::Service<ServiceT>>>
+Node::create_service_async(
+  const std::string & service_name,
+  CallbackT && callback,
+  const rclcpp::QoS & qos,
+  rclcpp::CallbackGroup::SharedPtr group,
+  EntityCreatedCallback<rclcpp::Service<ServiceT>> on_created)
+{
+  return this->create_entity_async<rclcpp::Service<ServiceT>>(
+    [service_name, callback = std::decay_t<CallbackT>(std::forward<CallbackT>(callback)), qos,
+    group](Node & node) {
+      return node.create_service<ServiceT>(service_name, callback, qos, group);
+    },
+    std::move(on_created));
+}
+
 template<typename ServiceT, typename CallbackT>
 typename rclcpp::Service<ServiceT>::SharedPtr
 Node::create_service(
@@ -238,6 +335,44 @@ Node::create_generic_subscription(
   );
 }
 
+template<typename AllocatorT>
+std::shared_ptr<rclcpp::GenericSubscription>
+Node::create_generic_subscription(
+  const std::string & topic_name,
+  const std::string & topic_type,
+  const rclcpp::QoS & qos,
+  rclcpp::GenericSubscription::ViewCallback callback,
+  const rclcpp::SubscriptionOptionsWithAllocator<AllocatorT> & options)
+{
+  return rclcpp::create_generic_subscription(
+    node_topics_,
+    extend_name_with_sub_namespace(topic_name, this->get_sub_namespace()),
+    topic_type,
+    qos,
+    std::move(callback),
+    options
+  );
+}
+
+template<typename CallbackT>
+rclcpp::GenericService::SharedPtr
+Node::create_generic_service(
+  const std::string & service_name,
+  const std::string & service_type,
+  CallbackT && callback,
+  const rclcpp::QoS & qos,
+  rclcpp::CallbackGroup::SharedPtr group)
+{
+  return rclcpp::create_generic_service(
+    node_base_,
+    node_services_,
+    extend_name_with_sub_namespace(service_name, this->get_sub_namespace()),
+    service_type,
+    std::forward<CallbackT>(callback),
+    qos,
+    group);
+}
+
 
 template<typename ParameterT>
 auto
@@ -281,6 +416,18 @@ Node::declare_parameter(
   }
 }
 
+template<typename ParameterT>
+ParameterHandle<ParameterT>
+Node::declare_parameter_handle(
+  const std::string & name,
+  const ParameterT & default_value,
+  const rcl_interfaces::msg::ParameterDescriptor & parameter_descriptor,
+  bool ignore_override)
+{
+  this->declare_parameter(name, default_value, parameter_descriptor, ignore_override);
+  return ParameterHandle<ParameterT>(node_parameters_->get_parameter_value_cell(name));
+}
+
 template<typename ParameterT>
 std::vector<ParameterT>
 Node::declare_parameters(
@@ -288,19 +435,16 @@ Node::declare_parameters(
   const std::map<std::string, ParameterT> & parameters,
   bool ignore_overrides)
 {
-  std::vector<ParameterT> result;
   std::string normalized_namespace = namespace_.empty() ? "" : (namespace_ + ".");
-  std::transform(
-    parameters.begin(), parameters.end(), std::back_inserter(result),
-    [this, &normalized_namespace, ignore_overrides](auto element) {
-      return this->declare_parameter(
-        normalized_namespace + element.first,
-        element.second,
-        rcl_interfaces::msg::ParameterDescriptor(),
-        ignore_overrides);
-    }
-  );
-  return result;
+  std::vector<rclcpp::node_interfaces::ParameterDeclaration> declarations(parameters.size());
+  auto declaration = declarations.begin();
+  for (const auto & element : parameters) {
+    declaration->name = normalized_namespace + element.first;
+    declaration->default_value = rclcpp::ParameterValue(element.second);
+    ++declaration;
+  }
+  return rclcpp::detail::get_declared_parameter_values<ParameterT>(
+    declarations, node_parameters_->declare_parameters(declarations, ignore_overrides));
 }
 
 template<typename ParameterT>
@@ -313,21 +457,17 @@ Node::declare_parameters(
   > & parameters,
   bool ignore_overrides)
 {
-  std::vector<ParameterT> result;
   std::string normalized_namespace = namespace_.empty() ? "" : (namespace_ + ".");
-  std::transform(
-    parameters.begin(), parameters.end(), std::back_inserter(result),
-    [this, &normalized_namespace, ignore_overrides](auto element) {
-      return static_cast<ParameterT>(
-        this->declare_parameter(
-          normalized_namespace + element.first,
-          element.second.first,
-          element.second.second,
-          ignore_overrides)
-      );
-    }
-  );
-  return result;
+  std::vector<rclcpp::node_interfaces::ParameterDeclaration> declarations(parameters.size());
+  auto declaration = declarations.begin();
+  for (const auto & element : parameters) {
+    declaration->name = normalized_namespace + element.first;
+    declaration->default_value = rclcpp::ParameterValue(element.second.first);
+    declaration->descriptor = element.second.second;
+    ++declaration;
+  }
+  return rclcpp::detail::get_declared_parameter_values<ParameterT>(
+    declarations, node_parameters_->declare_parameters(declarations, ignore_overrides));
 }
 
 template<typename ParameterT>
@@ -373,6 +513,19 @@ Node::get_parameter_or(
   return parameter;
 }
 
+template<typename ParameterT>
+ParameterHandle<ParameterT>
+Node::get_parameter_handle(const std::string & name)
+{
+  auto cell = node_parameters_->get_parameter_value_cell(name);
+  ParameterHandle<ParameterT> handle(cell);
+  if (cell->get_value()->get_type() != rclcpp::ParameterType::PARAMETER_NOT_SET) {
+    // Throws if the value isn't of the requested type
+    handle.get();
+  }
+  return handle;
+}
+
 // this is a partially-specialized version of get_parameter above,
 // where our concrete type for ParameterT is std::map, but the to-be-determined
 // type is the value in the map.
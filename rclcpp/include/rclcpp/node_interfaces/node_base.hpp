@@ -30,6 +30,13 @@
 
 namespace rclcpp
 {
+class EntityHandoff;
+
+namespace detail
+{
+class ResolvedNameCache;
+}  // namespace detail
+
 namespace node_interfaces
 {
 
@@ -45,6 +52,9 @@ public:
    * be created by the constructor using the create_callback_group() method,
    * but virtual dispatch will not occur so overrides of that method will not
    * be used.
+   *
+   * If an entity_handoff is given, the node uses the rcl node it hands over if it matches,
+   * instead of initializing one, see rclcpp::EntityHandoff.
    */
   RCLCPP_PUBLIC
   NodeBase(
@@ -54,7 +64,8 @@ public:
     const rcl_node_options_t & rcl_node_options,
     bool use_intra_process_default,
     bool enable_topic_statistics_default,
-    rclcpp::CallbackGroup::SharedPtr default_callback_group = nullptr);
+    rclcpp::CallbackGroup::SharedPtr default_callback_group = nullptr,
+    std::shared_ptr<rclcpp::EntityHandoff> entity_handoff = nullptr);
 
   RCLCPP_PUBLIC
   virtual
@@ -155,6 +166,9 @@ private:
   mutable std::recursive_mutex notify_guard_condition_mutex_;
   rclcpp::GuardCondition notify_guard_condition_;
   bool notify_guard_condition_is_valid_;
+
+  /// Names resolved by resolve_topic_or_service_name().
+  std::shared_ptr<rclcpp::detail::ResolvedNameCache> resolved_names_;
 };
 
 }  // namespace node_interfaces
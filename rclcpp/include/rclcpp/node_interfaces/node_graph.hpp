@@ -18,6 +18,8 @@
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
+#include <cstdint>
+#include <functional>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -38,6 +40,12 @@
 namespace rclcpp
 {
 
+namespace detail
+{
+class GraphCache;
+class ResolvedNameCache;
+}  // namespace detail
+
 namespace graph_listener
 {
 class GraphListener;
@@ -47,13 +55,20 @@ namespace node_interfaces
 {
 
 /// Implementation the NodeGraph part of the Node API.
+/**
+ * With use_graph_cache, the results of the queries are cached for the nodes of the context
+ * until the graph listener of the context is woken by a graph change.
+ * They may then miss a change for the time it takes the graph listener to wake up.
+ */
 class NodeGraph : public NodeGraphInterface
 {
 public:
   RCLCPP_SMART_PTR_ALIASES_ONLY(NodeGraph)
 
   RCLCPP_PUBLIC
-  explicit NodeGraph(rclcpp::node_interfaces::NodeBaseInterface * node_base);
+  explicit NodeGraph(
+    rclcpp::node_interfaces::NodeBaseInterface * node_base,
+    bool use_graph_cache = false);
 
   RCLCPP_PUBLIC
   virtual
@@ -129,12 +144,23 @@ public:
   rclcpp::Event::SharedPtr
   get_graph_event() override;
 
+  RCLCPP_PUBLIC
+  rclcpp::Event::SharedPtr
+  get_filtered_graph_event(const rclcpp::GraphEventFilter & filter) override;
+
   RCLCPP_PUBLIC
   void
   wait_for_graph_change(
     rclcpp::Event::SharedPtr event,
     std::chrono::nanoseconds timeout) override;
 
+  RCLCPP_PUBLIC
+  bool
+  wait_for_service_ready(
+    const std::string & service_name,
+    const std::function<bool()> & is_ready,
+    std::chrono::nanoseconds timeout) override;
+
   RCLCPP_PUBLIC
   size_t
   count_graph_users() const override;
@@ -154,13 +180,37 @@ public:
 private:
   RCLCPP_DISABLE_COPY(NodeGraph)
 
+  /// Get the number of graph changes seen by the graph listener, watching them if needed.
+  /**
+   * \return false if the graph cache isn't used or the changes can't be watched.
+   */
+  bool
+  get_graph_generation(uint64_t & generation) const;
+
+  /// Return the result of the query from the graph cache, if used, or else from the graph.
+  template<typename T, typename QueryT>
+  T
+  query_graph(const std::string & key, QueryT && query) const;
+
+  /// Return the topic or service name expanded for this node, from the cache if possible.
+  std::string
+  expand_name(const std::string & name, bool is_service) const;
+
   /// Handle to the NodeBaseInterface given in the constructor.
   rclcpp::node_interfaces::NodeBaseInterface * node_base_;
 
   /// Graph Listener which waits on graph changes for the node and is shared across nodes.
   std::shared_ptr<rclcpp::graph_listener::GraphListener> graph_listener_;
   /// Whether or not this node needs to be added to the graph listener.
-  std::atomic_bool should_add_to_graph_listener_;
+  mutable std::atomic_bool should_add_to_graph_listener_;
+
+  /// Results of the graph queries shared across the nodes of the context, if used.
+  std::shared_ptr<rclcpp::detail::GraphCache> graph_cache_;
+  /// Whether or not the graph listener watches the graph changes for the graph cache.
+  mutable std::atomic_bool graph_cache_watched_;
+
+  /// Names expanded, and remapped, for the graph queries of this node.
+  std::shared_ptr<rclcpp::detail::ResolvedNameCache> expanded_names_;
 
   /// Mutex to guard the graph event related data structures.
   mutable std::mutex graph_mutex_;
@@ -171,6 +221,10 @@ private:
   /// Number of graph events out on loan, used to determine if the graph should be monitored.
   /** graph_users_count_ is atomic so that it can be accessed without acquiring the graph_mutex_ */
   std::atomic_size_t graph_users_count_;
+  /// Weak references to filtered graph events out on loan, set by the graph listener.
+  std::vector<rclcpp::Event::WeakPtr> filtered_graph_events_;
+  /// Number of filtered graph events out on loan, which the graph listener checks.
+  std::atomic_size_t filtered_graph_users_count_;
 };
 
 }  // namespace node_interfaces
@@ -18,6 +18,7 @@
 #include <algorithm>
 #include <array>
 #include <chrono>
+#include <functional>
 #include <map>
 #include <string>
 #include <tuple>
@@ -131,6 +132,15 @@ private:
   rclcpp::QoS qos_profile_;
 };
 
+/// Topics and services whose changes set a filtered graph event.
+struct GraphEventFilter
+{
+  /// Names of topics, changed when their number of publishers or subscriptions changes.
+  std::vector<std::string> topic_names;
+  /// Names of services, changed when they appear in or disappear from the graph.
+  std::vector<std::string> service_names;
+};
+
 namespace node_interfaces
 {
 
@@ -331,9 +341,27 @@ public:
   rclcpp::Event::SharedPtr
   get_graph_event() = 0;
 
+  /// Return a graph event, which will be set when the given topics or services change.
+  /**
+   * Like the events of get_graph_event(), the event is a loan which is waited on with
+   * wait_for_graph_change(), but the other graph changes don't set it.
+   * The names are expanded like the names of publishers and services of the node.
+   *
+   * The default implementation returns an event of get_graph_event(), set by any change.
+   */
+  RCLCPP_PUBLIC
+  virtual
+  rclcpp::Event::SharedPtr
+  get_filtered_graph_event(const rclcpp::GraphEventFilter & filter)
+  {
+    (void)filter;
+    return get_graph_event();
+  }
+
   /// Wait for a graph event to occur by waiting on an Event to become set.
   /**
-   * The given Event must be acquire through the get_graph_event() method.
+   * The given Event must be acquire through the get_graph_event() or
+   * get_filtered_graph_event() method.
    *
    * \throws InvalidEventError if the given event is nullptr
    * \throws EventNotRegisteredError if the given event was not acquired with
@@ -346,6 +374,36 @@ public:
     rclcpp::Event::SharedPtr event,
     std::chrono::nanoseconds timeout) = 0;
 
+  /// Wait for a service to become ready, checked on entry and after graph changes.
+  /**
+   * Unlike waiting on a graph event, the waiters of the same service don't all check it
+   * on every graph change, see rclcpp::graph_listener::GraphListener::wait_for_service_ready().
+   * It returns at the latest after the timeout, callers needing more time call it again.
+   *
+   * The default implementation checks is_ready, waits for one graph change and checks again.
+   *
+   * \param[in] service_name fully qualified name of the service.
+   * \param[in] is_ready returns true if the service is ready, may be called by another thread.
+   * \param[in] timeout maximum time to wait.
+   * \return true if is_ready returned true, false otherwise.
+   */
+  RCLCPP_PUBLIC
+  virtual
+  bool
+  wait_for_service_ready(
+    const std::string & service_name,
+    const std::function<bool()> & is_ready,
+    std::chrono::nanoseconds timeout)
+  {
+    (void)service_name;
+    auto event = get_graph_event();
+    if (is_ready()) {
+      return true;
+    }
+    wait_for_graph_change(event, timeout);
+    return event->check_and_clear() && is_ready();
+  }
+
   /// Return the number of on loan graph events, see get_graph_event().
   /**
    * This is typically only used by the rclcpp::graph_listener::GraphListener.
@@ -25,6 +25,11 @@
 
 namespace rclcpp
 {
+namespace detail
+{
+class SharedNodePublishers;
+}  // namespace detail
+
 namespace node_interfaces
 {
 
@@ -34,8 +39,17 @@ class NodeLogging : public NodeLoggingInterface
 public:
   RCLCPP_SMART_PTR_ALIASES_ONLY(NodeLoggingInterface)
 
+  /// Constructor.
+  /**
+   * \param[in] node_base the node base interface of the node.
+   * \param[in] use_shared_rosout if true, the log messages of the node are published on /rosout
+   *   by the publisher shared by the nodes of the context, see
+   *   rclcpp::NodeOptions::use_shared_publishers().
+   */
   RCLCPP_PUBLIC
-  explicit NodeLogging(rclcpp::node_interfaces::NodeBaseInterface * node_base);
+  explicit NodeLogging(
+    rclcpp::node_interfaces::NodeBaseInterface * node_base,
+    bool use_shared_rosout = false);
 
   RCLCPP_PUBLIC
   virtual
@@ -56,6 +70,9 @@ private:
   rclcpp::node_interfaces::NodeBaseInterface * node_base_;
 
   rclcpp::Logger logger_;
+
+  /// Shared publishers of the context, if the node publishes its log messages with them.
+  std::shared_ptr<rclcpp::detail::SharedNodePublishers> shared_publishers_;
 };
 
 }  // namespace node_interfaces
@@ -15,11 +15,15 @@
 #ifndef RCLCPP__NODE_INTERFACES__NODE_PARAMETERS_HPP_
 #define RCLCPP__NODE_INTERFACES__NODE_PARAMETERS_HPP_
 
+#include <atomic>
+#include <cstdint>
 #include <list>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include "rcutils/macros.h"
@@ -29,7 +33,9 @@
 #include "rcl_interfaces/msg/parameter_event.hpp"
 #include "rcl_interfaces/msg/set_parameters_result.hpp"
 
+#include "rclcpp/detail/snapshot_ptr.hpp"
 #include "rclcpp/macros.hpp"
+#include "rclcpp/memory_accounting.hpp"
 #include "rclcpp/node_interfaces/node_base_interface.hpp"
 #include "rclcpp/node_interfaces/node_logging_interface.hpp"
 #include "rclcpp/node_interfaces/node_parameters_interface.hpp"
@@ -42,6 +48,12 @@
 
 namespace rclcpp
 {
+namespace detail
+{
+class ParameterNameIndex;
+class SharedNodePublishers;
+}  // namespace detail
+
 namespace node_interfaces
 {
 
@@ -80,6 +92,20 @@ private:
 };
 
 /// Implementation of the NodeParameters part of the Node API.
+/**
+ * The parameters are read from an immutable snapshot, which is replaced atomically once per
+ * declaration, setting or undeclaration that changed them, so that reading them takes no lock
+ * and doesn't wait for the parameters being set.
+ * The snapshots share the parameters that didn't change, only the changed ones are copied,
+ * but each snapshot still copies the map of the pointers to all the parameters: replacing it
+ * costs one node allocation and one reference count increment per parameter, so declaring N
+ * parameters one at a time is still O(N^2), with a smaller constant than copying the
+ * parameters. declare_parameters() and set_parameters() replace it once for all theirs.
+ * The parameters are stored in a hash map, and their names are indexed by namespace, so that
+ * listing the parameters under a prefix only visits the names under it.
+ * The parameters read from the callbacks called while they are set, on the thread setting
+ * them, are the ones being set, like before the snapshot is replaced.
+ */
 class NodeParameters : public NodeParametersInterface
 {
 public:
@@ -94,6 +120,16 @@ public:
    * automatically_declare_parameters_from_overrides and invoke
    * perform_automatically_declare_parameters_from_overrides() manually after
    * construction.
+   *
+   * If use_shared_parameter_event_publisher is true, the parameter events are published by the
+   * publisher shared by the nodes of the context, see
+   * rclcpp::NodeOptions::use_shared_publishers(), and parameter_event_qos and
+   * parameter_event_publisher_options are ignored.
+   *
+   * The parameter_state is a state saved by save_parameter_state(), empty for none, see
+   * rclcpp::NodeOptions::parameter_state().
+   *
+   * \throws std::invalid_argument if the parameter state is malformed.
    */
   RCLCPP_PUBLIC
   NodeParameters(
@@ -108,7 +144,9 @@ public:
     const rclcpp::QoS & parameter_event_qos,
     const rclcpp::PublisherOptionsBase & parameter_event_publisher_options,
     bool allow_undeclared_parameters,
-    bool automatically_declare_parameters_from_overrides);
+    bool automatically_declare_parameters_from_overrides,
+    bool use_shared_parameter_event_publisher = false,
+    const std::vector<uint8_t> & parameter_state = {});
 
   RCLCPP_PUBLIC
   virtual
@@ -132,6 +170,12 @@ public:
     rcl_interfaces::msg::ParameterDescriptor(),
     bool ignore_override = false) override;
 
+  RCLCPP_PUBLIC
+  std::vector<rclcpp::ParameterValue>
+  declare_parameters(
+    const std::vector<ParameterDeclaration> & declarations,
+    bool ignore_overrides = false) override;
+
   RCLCPP_PUBLIC
   void
   undeclare_parameter(const std::string & name) override;
@@ -214,6 +258,49 @@ public:
   const std::map<std::string, rclcpp::ParameterValue> &
   get_parameter_overrides() const override;
 
+  RCLCPP_PUBLIC
+  ParameterValueCell::SharedPtr
+  get_parameter_value_cell(const std::string & name) override;
+
+  RCLCPP_PUBLIC
+  void
+  begin_parameter_event_batch() override;
+
+  RCLCPP_PUBLIC
+  void
+  end_parameter_event_batch() override;
+
+  /// Save the values and descriptors of the declared parameters, to restore them on a restart.
+  /**
+   * The state is a compact binary serialization, to restore on the same platform with
+   * rclcpp::NodeOptions::parameter_state().
+   * The parameters declared without a value aren't saved.
+   *
+   * \return the parameter state.
+   */
+  RCLCPP_PUBLIC
+  std::vector<uint8_t>
+  save_parameter_state() const;
+
+  /// Enable or disable the new parameters in the parameter events of all the nodes.
+  /**
+   * While disabled, the declarations of parameters aren't published, which avoids
+   * flooding the parameter events when many parameters are declared at startup.
+   * They are enabled by default.
+   *
+   * \param[in] enabled true to publish the declarations.
+   */
+  RCLCPP_PUBLIC
+  static
+  void
+  set_declaration_events_enabled(bool enabled);
+
+  /// Return true if the new parameters are published in the parameter events.
+  RCLCPP_PUBLIC
+  static
+  bool
+  get_declaration_events_enabled();
+
   using PreSetCallbacksHandleContainer = std::list<PreSetParametersCallbackHandle::WeakPtr>;
   using OnSetCallbacksHandleContainer = std::list<OnSetParametersCallbackHandle::WeakPtr>;
   using PostSetCallbacksHandleContainer = std::list<PostSetParametersCallbackHandle::WeakPtr>;
@@ -228,6 +315,48 @@ protected:
 private:
   RCLCPP_DISABLE_COPY(NodeParameters)
 
+  using ParameterInfos = std::unordered_map<std::string, ParameterInfo>;
+
+  /// Immutable copies of the parameters, shared by the snapshots in which they didn't change.
+  using SharedParameterInfos =
+    std::unordered_map<std::string, std::shared_ptr<const ParameterInfo>>;
+
+  // Parameters and index of their names, shared by the readers
+  struct ParametersSnapshot;
+
+  // RAII-style scope of a modification of the parameters, which replaces the snapshot
+  class ParameterModificationScope;
+
+  /// Copy the modified parameters into shared_parameters_, mutex_ must be locked.
+  void
+  update_shared_parameters() const;
+
+  /// Replace the snapshot and store the changed values in the cells, mutex_ must be locked.
+  /**
+   * The snapshot isn't replaced when no parameter changed.
+   */
+  void
+  update_parameters_snapshot();
+
+  /// Parse a state saved by save_parameter_state() into restored_parameters_.
+  void
+  load_parameter_state(const std::vector<uint8_t> & parameter_state);
+
+  /// Publish the parameter event, or merge it into the pending one when batching.
+  /**
+   * The parameter event is modified, mutex_ must be locked.
+   */
+  void
+  publish_parameter_event(rcl_interfaces::msg::ParameterEvent & parameter_event);
+
+  /// Return the parameters to read, the snapshot or the ones being modified on their thread.
+  std::shared_ptr<const SharedParameterInfos>
+  get_parameters_snapshot() const;
+
+  /// Return the index of the names of the parameters, and the parameters read with it.
+  std::shared_ptr<const detail::ParameterNameIndex>
+  get_parameter_name_index(std::shared_ptr<const SharedParameterInfos> & parameters) const;
+
   mutable std::recursive_mutex mutex_;
 
   // There are times when we don't want to allow modifications to parameters
@@ -241,20 +370,61 @@ private:
 
   PostSetCallbacksHandleContainer post_set_parameters_callback_container_;
 
-  std::map<std::string, ParameterInfo> parameters_;
+  ParameterInfos parameters_;
+
+  /// Copies of parameters_ shared with the snapshots, updated by update_shared_parameters().
+  /// The readers on the thread modifying the parameters update them too, hence mutable.
+  mutable SharedParameterInfos shared_parameters_;
+
+  /// Names of the parameters the current modification may have changed, duplicates included.
+  std::vector<std::string> modified_parameter_names_;
+
+  /// Whether shared_parameters_ changed since the last snapshot.
+  mutable bool shared_parameters_changed_ = false;
+
+  /// Index of the names of shared_parameters_, updated with them.
+  /// Its copies in the snapshots share the namespaces in which no name was added or removed.
+  std::shared_ptr<detail::ParameterNameIndex> parameter_name_index_;
+
+  /// Snapshot of shared_parameters_ replaced after each change, loaded without locking mutex_.
+  detail::SnapshotPtr<ParametersSnapshot> parameters_snapshot_;
+
+  /// Thread modifying parameters_, if any.
+  std::atomic<std::thread::id> modifying_thread_;
+
+  /// Depth of the nested modification scopes, only the outermost one replaces the snapshot.
+  size_t modification_depth_ = 0;
+
+  /// Cells of the parameters referenced by handles.
+  std::map<std::string, ParameterValueCell::WeakPtr> parameter_value_cells_;
+
+  /// Depth of the nested parameter event batches.
+  size_t parameter_event_batch_depth_ = 0;
+
+  /// Changes of the parameters merged while batching.
+  rcl_interfaces::msg::ParameterEvent pending_parameter_event_;
 
   std::map<std::string, rclcpp::ParameterValue> parameter_overrides_;
 
+  /// Parameters of the restored state not declared yet.
+  ParameterInfos restored_parameters_;
+
   bool allow_undeclared_ = false;
 
   Publisher<rcl_interfaces::msg::ParameterEvent>::SharedPtr events_publisher_;
 
+  /// Shared publishers of the context, used instead of events_publisher_ if set.
+  std::shared_ptr<rclcpp::detail::SharedNodePublishers> shared_publishers_;
+
   std::shared_ptr<ParameterService> parameter_service_;
 
   std::string combined_name_;
 
   node_interfaces::NodeLoggingInterface::SharedPtr node_logging_;
   node_interfaces::NodeClockInterface::SharedPtr node_clock_;
+
+  /// Account of the memory of the parameters, destroyed first as its probe reads them.
+  rclcpp::MemoryAccount::SharedPtr memory_account_;
 };
 
 }  // namespace node_interfaces
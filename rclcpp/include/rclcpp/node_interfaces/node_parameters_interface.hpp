@@ -27,6 +27,7 @@
 #include "rclcpp/macros.hpp"
 #include "rclcpp/node_interfaces/detail/node_interfaces_helpers.hpp"
 #include "rclcpp/parameter.hpp"
+#include "rclcpp/parameter_handle.hpp"
 #include "rclcpp/visibility_control.hpp"
 
 namespace rclcpp
@@ -68,6 +69,22 @@ struct PostSetParametersCallbackHandle
   PostSetParametersCallbackType callback;
 };
 
+/// Declaration of a parameter, see NodeParametersInterface::declare_parameters().
+struct ParameterDeclaration
+{
+  /// Name of the parameter.
+  std::string name;
+
+  /// Value of the parameter when there's no override, may be unset.
+  rclcpp::ParameterValue default_value;
+
+  /// Type of a statically typed parameter, the type of the default value if not set.
+  rclcpp::ParameterType type = rclcpp::PARAMETER_NOT_SET;
+
+  /// A description of the parameter.
+  rcl_interfaces::msg::ParameterDescriptor descriptor;
+};
+
 /// Pure virtual interface class for the NodeParameters part of the Node API.
 class NodeParametersInterface
 {
@@ -106,6 +123,22 @@ public:
     rcl_interfaces::msg::ParameterDescriptor(),
     bool ignore_override = false) = 0;
 
+  /// Declare and initialize several parameters at once.
+  /**
+   * The parameters are validated together, the callbacks are called once with all of them
+   * and a single parameter event is published.
+   * Either all the parameters are declared or none is.
+   *
+   * \sa rclcpp::Node::declare_parameters
+   * \return the values of the parameters, in the order of the declarations.
+   */
+  RCLCPP_PUBLIC
+  virtual
+  std::vector<rclcpp::ParameterValue>
+  declare_parameters(
+    const std::vector<ParameterDeclaration> & declarations,
+    bool ignore_overrides = false) = 0;
+
   /// Undeclare a parameter.
   /**
    * \sa rclcpp::Node::undeclare_parameter
@@ -272,6 +305,61 @@ public:
   virtual
   const std::map<std::string, rclcpp::ParameterValue> &
   get_parameter_overrides() const = 0;
+
+  /// Get the cell holding the current value of a declared parameter, for its handles.
+  /*
+   * The same cell is returned for a parameter while it's referenced, and it keeps
+   * holding the value of the parameter if it's undeclared and declared again.
+   *
+   * \param[in] name the name of the parameter.
+   * \return the cell of the parameter.
+   * \throws rclcpp::exceptions::ParameterNotDeclaredException if the parameter
+   *   has not been declared.
+   */
+  RCLCPP_PUBLIC
+  virtual
+  ParameterValueCell::SharedPtr
+  get_parameter_value_cell(const std::string & name) = 0;
+
+  /// Start a batch of parameter events, published as a single event when it ends.
+  /*
+   * The changes of the parameters declared, set or undeclared until the matching
+   * call to end_parameter_event_batch() are merged into one parameter event.
+   * The batches can be nested, the event is published when the outermost one ends.
+   *
+   * See also rclcpp::node_interfaces::ParameterEventBatch.
+   */
+  RCLCPP_PUBLIC
+  virtual
+  void
+  begin_parameter_event_batch() = 0;
+
+  /// End a batch of parameter events started with begin_parameter_event_batch().
+  RCLCPP_PUBLIC
+  virtual
+  void
+  end_parameter_event_batch() = 0;
+};
+
+/// RAII-style batch of the parameter events of a node.
+class ParameterEventBatch
+{
+public:
+  explicit ParameterEventBatch(NodeParametersInterface & node_parameters)
+  : node_parameters_(node_parameters)
+  {
+    node_parameters_.begin_parameter_event_batch();
+  }
+
+  ~ParameterEventBatch()
+  {
+    node_parameters_.end_parameter_event_batch();
+  }
+
+private:
+  RCLCPP_DISABLE_COPY(ParameterEventBatch)
+
+  NodeParametersInterface & node_parameters_;
 };
 
 }  // namespace node_interfaces
@@ -15,6 +15,8 @@
 #ifndef RCLCPP__NODE_INTERFACES__NODE_TIMERS_HPP_
 #define RCLCPP__NODE_INTERFACES__NODE_TIMERS_HPP_
 
+#include <mutex>
+
 #include "rclcpp/callback_group.hpp"
 #include "rclcpp/macros.hpp"
 #include "rclcpp/node_interfaces/node_base_interface.hpp"
@@ -47,10 +49,18 @@ public:
     rclcpp::TimerBase::SharedPtr timer,
     rclcpp::CallbackGroup::SharedPtr callback_group) override;
 
+  /// Get the coalescer of the node, created on first use.
+  RCLCPP_PUBLIC
+  rclcpp::TimerCoalescer::SharedPtr
+  get_timer_coalescer() override;
+
 private:
   RCLCPP_DISABLE_COPY(NodeTimers)
 
   rclcpp::node_interfaces::NodeBaseInterface * node_base_;
+
+  std::mutex timer_coalescer_mutex_;
+  rclcpp::TimerCoalescer::SharedPtr timer_coalescer_;
 };
 
 }  // namespace node_interfaces
@@ -19,6 +19,7 @@
 #include "rclcpp/macros.hpp"
 #include "rclcpp/node_interfaces/detail/node_interfaces_helpers.hpp"
 #include "rclcpp/timer.hpp"
+#include "rclcpp/timer_coalescer.hpp"
 #include "rclcpp/visibility_control.hpp"
 
 namespace rclcpp
@@ -43,6 +44,12 @@ public:
   add_timer(
     rclcpp::TimerBase::SharedPtr timer,
     rclcpp::CallbackGroup::SharedPtr callback_group) = 0;
+
+  /// Get the coalescer sharing rcl timers between the coalesced timers of the node.
+  RCLCPP_PUBLIC
+  virtual
+  rclcpp::TimerCoalescer::SharedPtr
+  get_timer_coalescer() = 0;
 };
 
 }  // namespace node_interfaces
@@ -15,6 +15,7 @@
 #ifndef RCLCPP__NODE_OPTIONS_HPP_
 #define RCLCPP__NODE_OPTIONS_HPP_
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -26,11 +27,14 @@
 #include "rclcpp/parameter.hpp"
 #include "rclcpp/publisher_options.hpp"
 #include "rclcpp/qos.hpp"
+#include "rclcpp/thread_attributes.hpp"
 #include "rclcpp/visibility_control.hpp"
 
 namespace rclcpp
 {
 
+class EntityHandoff;
+
 /// Encapsulation of options for node initialization.
 class NodeOptions
 {
@@ -42,14 +46,21 @@ public:
    *   - context = rclcpp::contexts::get_global_default_context()
    *   - arguments = {}
    *   - parameter_overrides = {}
+   *   - parameter_state = {}
+   *   - entity_handoff = nullptr
    *   - use_global_arguments = true
    *   - use_intra_process_comms = false
    *   - enable_topic_statistics = false
+   *   - use_graph_cache = false
    *   - start_parameter_services = true
    *   - start_parameter_event_publisher = true
+   *   - start_lifecycle_services = true
+   *   - lightweight = false
+   *   - use_shared_publishers = false
    *   - clock_type = RCL_ROS_TIME
    *   - clock_qos = rclcpp::ClockQoS()
    *   - use_clock_thread = true
+   *   - clock_thread_attributes = rclcpp::ThreadAttributes()
    *   - rosout_qos = rclcpp::RosoutQoS()
    *   - parameter_event_qos = rclcpp::ParameterEventQoS
    *     - with history setting and depth from rmw_qos_profile_parameter_events
@@ -144,6 +155,45 @@ public:
     return *this;
   }
 
+  /// Return a reference to the parameter state restored by the node.
+  RCLCPP_PUBLIC
+  const std::vector<uint8_t> &
+  parameter_state() const;
+
+  /// Set the parameter state restored by the node, return this for parameter idiom.
+  /**
+   * The state is the value returned by
+   * rclcpp::node_interfaces::NodeParameters::save_parameter_state() of a previous instance of
+   * the node, on the same platform, to restart it with the same parameters.
+   * When the node declares a restored parameter, its restored value is used instead of the
+   * default value and of the overrides, even if the override is ignored.
+   * If the declaration has the descriptor of the restored parameter, the value is used
+   * without validating it, calling the set parameters callbacks or publishing it in a
+   * parameter event, as this was done by the previous instance.
+   * Otherwise the value is validated like an override.
+   *
+   * An empty state, the default, restores nothing.
+   * A malformed state makes the construction of the node throw std::invalid_argument.
+   */
+  RCLCPP_PUBLIC
+  NodeOptions &
+  parameter_state(const std::vector<uint8_t> & parameter_state);
+
+  /// Return the entity handoff used by the node.
+  RCLCPP_PUBLIC
+  const std::shared_ptr<rclcpp::EntityHandoff> &
+  entity_handoff() const;
+
+  /// Set the entity handoff used by the node, return this for parameter idiom.
+  /**
+   * The node then uses the rcl node, publishers and subscriptions of the previous instance of
+   * the node handed over by the handoff, when they match, instead of creating them, so that
+   * they aren't discovered again, see rclcpp::EntityHandoff.
+   */
+  RCLCPP_PUBLIC
+  NodeOptions &
+  entity_handoff(std::shared_ptr<rclcpp::EntityHandoff> entity_handoff);
+
   /// Return the use_global_arguments flag.
   RCLCPP_PUBLIC
   bool
@@ -213,6 +263,24 @@ public:
   NodeOptions &
   enable_topic_statistics(bool enable_topic_statistics);
 
+  /// Return the use_graph_cache flag.
+  RCLCPP_PUBLIC
+  bool
+  use_graph_cache() const;
+
+  /// Set the use_graph_cache flag, return this for parameter idiom.
+  /**
+   * If true, the results of the graph queries of the node, such as get_topic_names_and_types()
+   * or count_publishers(), are cached with the ones of the other nodes of the context using
+   * it, until the graph listener of the context sees a graph change.
+   * The results may then miss a change for the time it takes the graph listener to wake up.
+   *
+   * Defaults to false.
+   */
+  RCLCPP_PUBLIC
+  NodeOptions &
+  use_graph_cache(bool use_graph_cache);
+
   /// Return the start_parameter_services flag.
   RCLCPP_PUBLIC
   bool
@@ -232,6 +300,25 @@ public:
   NodeOptions &
   start_parameter_services(bool start_parameter_services);
 
+  /// Return the start_lifecycle_services flag.
+  RCLCPP_PUBLIC
+  bool
+  start_lifecycle_services() const;
+
+  /// Set the start_lifecycle_services flag, return this for parameter idiom.
+  /**
+   * Only used by the lifecycle nodes of rclcpp_lifecycle.
+   * If true, the lifecycle services of the node, such as change_state and get_state, and its
+   * transition_event publisher are created.
+   *
+   * If false, the node saves these entities and their discovery, its transitions are
+   * triggered in the process, for example by a rclcpp_lifecycle::LifecycleCoordinator offering
+   * a single service for all the lifecycle nodes of a container.
+   */
+  RCLCPP_PUBLIC
+  NodeOptions &
+  start_lifecycle_services(bool start_lifecycle_services);
+
   /// Return the start_parameter_event_publisher flag.
   RCLCPP_PUBLIC
   bool
@@ -248,6 +335,49 @@ public:
   NodeOptions &
   start_parameter_event_publisher(bool start_parameter_event_publisher);
 
+  /// Return the lightweight flag.
+  RCLCPP_PUBLIC
+  bool
+  lightweight() const;
+
+  /// Set the lightweight flag, return this for parameter idiom.
+  /**
+   * A lightweight node creates none of the entities most nodes don't use:
+   * setting it to true is equivalent to setting start_parameter_services(),
+   * start_parameter_event_publisher() and enable_rosout() to false, and the time source of the
+   * node follows the node's use_sim_time parameter without subscribing to /parameter_events.
+   * The parameters, logging and clock of the node still work locally, and any of the options
+   * above can be enabled again after this call.
+   *
+   * This is meant for processes with hundreds of small nodes, e.g. component containers.
+   *
+   * This will cause the internal rcl_node_options_t struct to be invalidated.
+   */
+  RCLCPP_PUBLIC
+  NodeOptions &
+  lightweight(bool lightweight);
+
+  /// Return the use_shared_publishers flag.
+  RCLCPP_PUBLIC
+  bool
+  use_shared_publishers() const;
+
+  /// Set the use_shared_publishers flag, return this for parameter idiom.
+  /**
+   * If true, the rosout and parameter event messages of the node are published by a single
+   * /rosout and a single /parameter_events publisher shared by all the nodes of the context
+   * which use them, instead of the publishers of each node.
+   * The messages keep the name of the node, in the name field and in the node field.
+   * The publishers are still used only if enable_rosout() and
+   * start_parameter_event_publisher() are true, and rosout_qos(), parameter_event_qos() and
+   * parameter_event_publisher_options() are ignored.
+   *
+   * This will cause the internal rcl_node_options_t struct to be invalidated.
+   */
+  RCLCPP_PUBLIC
+  NodeOptions &
+  use_shared_publishers(bool use_shared_publishers);
+
   /// Return a reference to the clock type.
   RCLCPP_PUBLIC
   const rcl_clock_type_t &
@@ -288,6 +418,19 @@ public:
   NodeOptions &
   use_clock_thread(bool use_clock_thread);
 
+  /// Return a reference to the attributes of the clock thread.
+  RCLCPP_PUBLIC
+  const rclcpp::ThreadAttributes &
+  clock_thread_attributes() const;
+
+  /// Set the attributes of the clock thread, return this for parameter idiom.
+  /**
+   * These are only used if use_clock_thread is true.
+   */
+  RCLCPP_PUBLIC
+  NodeOptions &
+  clock_thread_attributes(const rclcpp::ThreadAttributes & clock_thread_attributes);
+
   /// Return a reference to the parameter_event_qos QoS.
   RCLCPP_PUBLIC
   const rclcpp::QoS &
@@ -403,6 +546,10 @@ private:
 
   std::vector<rclcpp::Parameter> parameter_overrides_ {};
 
+  std::vector<uint8_t> parameter_state_ {};
+
+  std::shared_ptr<rclcpp::EntityHandoff> entity_handoff_ {nullptr};
+
   bool use_global_arguments_ {true};
 
   bool enable_rosout_ {true};
@@ -411,16 +558,26 @@ private:
 
   bool enable_topic_statistics_ {false};
 
+  bool use_graph_cache_ {false};
+
   bool start_parameter_services_ {true};
 
   bool start_parameter_event_publisher_ {true};
 
+  bool start_lifecycle_services_ {true};
+
+  bool lightweight_ {false};
+
+  bool use_shared_publishers_ {false};
+
   rcl_clock_type_t clock_type_ {RCL_ROS_TIME};
 
   rclcpp::QoS clock_qos_ = rclcpp::ClockQoS();
 
   bool use_clock_thread_ {true};
 
+  rclcpp::ThreadAttributes clock_thread_attributes_ {};
+
   rclcpp::QoS parameter_event_qos_ = rclcpp::ParameterEventsQoS(
     rclcpp::QoSInitialization::from_rmw(rmw_qos_profile_parameter_events)
   );
@@ -0,0 +1,127 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__NUMA_TOPOLOGY_HPP_
+#define RCLCPP__NUMA_TOPOLOGY_HPP_
+
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "rclcpp/thread_attributes.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// NUMA nodes of a host and the CPUs they are made of.
+/**
+ * The topology of the host is read from sysfs on Linux.
+ * On other platforms, or if it can't be read, the host is described as a single node made of
+ * all the CPUs reported by std::thread::hardware_concurrency().
+ */
+class NumaTopology
+{
+public:
+  /// Value returned when a node or a CPU is unknown.
+  static constexpr size_t unknown = std::numeric_limits<size_t>::max();
+
+  /// Create a topology from the CPUs of each node, indexed by node id.
+  /**
+   * Nodes without CPUs, e.g. made of memory only, are never used to place workers.
+   *
+   * \throws std::invalid_argument if no node has CPUs.
+   */
+  RCLCPP_PUBLIC
+  explicit NumaTopology(std::vector<std::vector<size_t>> node_cpus);
+
+  /// Return the topology of this host, discovered once.
+  RCLCPP_PUBLIC
+  static
+  const NumaTopology &
+  get_host_topology();
+
+  /// Parse a list of CPUs in the sysfs format, e.g. "0-3,8-11".
+  /**
+   * \throws std::invalid_argument if the list is malformed.
+   */
+  RCLCPP_PUBLIC
+  static
+  std::vector<size_t>
+  parse_cpu_list(const std::string & cpu_list);
+
+  /// Return the number of nodes, including the nodes without CPUs.
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_nodes() const;
+
+  /// Return the CPUs of the given node.
+  /**
+   * \throws std::out_of_range if the node doesn't exist.
+   */
+  RCLCPP_PUBLIC
+  const std::vector<size_t> &
+  get_node_cpus(size_t node) const;
+
+  /// Return the node of the given CPU, or NumaTopology::unknown.
+  RCLCPP_PUBLIC
+  size_t
+  get_node_of_cpu(size_t cpu) const;
+
+  /// Return the node of the CPU the calling thread runs on, or NumaTopology::unknown.
+  RCLCPP_PUBLIC
+  size_t
+  get_current_node() const;
+
+  /// Return the node holding the memory page of the given address, or NumaTopology::unknown.
+  /**
+   * This is a system call, so the result should be cached by the caller.
+   * It's only supported on Linux.
+   */
+  RCLCPP_PUBLIC
+  static
+  size_t
+  get_node_of_address(const void * address);
+
+  /// Return the node of each of the given number of workers, spread evenly over the nodes.
+  /**
+   * Consecutive workers share the same node, e.g. 4 workers on 2 nodes are placed on the
+   * nodes 0, 0, 1 and 1.
+   * Only the nodes with CPUs are used.
+   */
+  RCLCPP_PUBLIC
+  std::vector<size_t>
+  get_worker_nodes(size_t number_of_workers) const;
+
+  /// Return the attributes binding each of the given number of workers to its node.
+  /**
+   * The workers are placed according to get_worker_nodes() and may run on any CPU of their
+   * node.
+   */
+  RCLCPP_PUBLIC
+  std::vector<rclcpp::ThreadAttributes>
+  make_worker_thread_attributes(size_t number_of_workers) const;
+
+private:
+  std::vector<std::vector<size_t>> node_cpus_;
+  /// Ids of the nodes with CPUs.
+  std::vector<size_t> cpu_node_ids_;
+  /// Node of each CPU, indexed by CPU.
+  std::vector<size_t> cpu_nodes_;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__NUMA_TOPOLOGY_HPP_
@@ -19,6 +19,7 @@
 #include <ostream>
 #include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "rcl_interfaces/msg/parameter.hpp"
@@ -67,7 +68,7 @@ public:
   /// Construct with given name and given parameter value.
   template<typename ValueTypeT>
   Parameter(const std::string & name, ValueTypeT value)
-  : Parameter(name, ParameterValue(value))
+  : Parameter(name, ParameterValue(std::move(value)))
   {}
 
   RCLCPP_PUBLIC
@@ -359,6 +359,18 @@ public:
     );
   }
 
+  /// Remove the requests sent before a time point which are still waiting for a response.
+  /**
+   * The futures of the removed requests are never completed, and their callbacks aren't
+   * called.
+   *
+   * \param time_point requests that were sent before this point are removed
+   * \return number of pending requests that were removed
+   */
+  RCLCPP_PUBLIC
+  size_t
+  prune_requests_older_than(std::chrono::system_clock::time_point time_point);
+
 protected:
   RCLCPP_PUBLIC
   bool
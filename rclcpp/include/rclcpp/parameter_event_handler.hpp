@@ -30,6 +30,8 @@
 #include "rclcpp/parameter.hpp"
 #include "rclcpp/qos.hpp"
 #include "rclcpp/subscription.hpp"
+#include "rclcpp/subscription_content_filter_options.hpp"
+#include "rclcpp/subscription_options.hpp"
 #include "rclcpp/visibility_control.hpp"
 #include "rcl_interfaces/msg/parameter_event.hpp"
 
@@ -158,6 +160,12 @@ struct ParameterEventCallbackHandle
  * Note: the callback handle returned from add_parameter_event_callback must be captured or
  * the callback will immediately be unregistered.
  *
+ * Only the parameter callbacks of the node and the parameters of an event are looked up and
+ * called, so the cost of an event doesn't depend on the number of callbacks of other nodes.
+ * When the middleware supports content filtered topics, the handler can also be constructed
+ * with use_content_filter set to true, so that while there is no parameter event callback,
+ * the events of the nodes without parameter callbacks aren't received at all.
+ *
  * To remove a parameter event callback, reset the callback smart pointer or use:
  *
  *   param_handler->remove_event_parameter_callback(handle3);
@@ -169,23 +177,32 @@ public:
   /**
    * \param[in] node The node to use to create any required subscribers.
    * \param[in] qos The QoS settings to use for any subscriptions.
+   * \param[in] use_content_filter Filter the events by node name in the middleware,
+   *   when it supports content filtered topics, otherwise before they are deserialized.
    */
   template<typename NodeT>
   explicit ParameterEventHandler(
     NodeT node,
     const rclcpp::QoS & qos =
-    rclcpp::QoS(rclcpp::QoSInitialization::from_rmw(rmw_qos_profile_parameter_events)))
+    rclcpp::QoS(rclcpp::QoSInitialization::from_rmw(rmw_qos_profile_parameter_events)),
+    bool use_content_filter = false)
   : node_base_(rclcpp::node_interfaces::get_node_base_interface(node))
   {
     auto node_topics = rclcpp::node_interfaces::get_node_topics_interface(node);
 
     callbacks_ = std::make_shared<Callbacks>();
 
+    rclcpp::SubscriptionOptions options;
+    if (use_content_filter) {
+      // All the events are received until the callbacks are added
+      options.content_filter_options = get_content_filter({});
+    }
     event_subscription_ = rclcpp::create_subscription<rcl_interfaces::msg::ParameterEvent>(
       node_topics, "/parameter_events", qos,
       [callbacks = callbacks_](const rcl_interfaces::msg::ParameterEvent & event) {
         callbacks->event_callback(event);
-      });
+      },
+      options);
   }
 
   using ParameterEventCallbackType =
@@ -341,6 +358,9 @@ protected:
 
     std::list<ParameterEventCallbackHandle::WeakPtr> event_callbacks_;
 
+    // Number of parameters with callbacks of each node
+    std::unordered_map<std::string, size_t> parameter_callback_nodes_;
+
     /// Callback for parameter events subscriptions.
     RCLCPP_PUBLIC
     void
@@ -352,6 +372,16 @@ protected:
   // Utility function for resolving node path.
   std::string resolve_path(const std::string & path);
 
+  /// Return the content filter receiving the events of the nodes, or all if empty.
+  RCLCPP_PUBLIC
+  static
+  rclcpp::ContentFilterOptions
+  get_content_filter(const std::vector<std::string> & node_names);
+
+  /// Filter the events received after a change of the callbacks, callbacks_ must be locked.
+  void
+  update_content_filter();
+
   // Node interface used for base functionality
   std::shared_ptr<rclcpp::node_interfaces::NodeBaseInterface> node_base_;
 
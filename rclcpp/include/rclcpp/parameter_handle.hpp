@@ -0,0 +1,214 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__PARAMETER_HANDLE_HPP_
+#define RCLCPP__PARAMETER_HANDLE_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+#include "rclcpp/exceptions.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/parameter_value.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// Current value of a parameter, shared by the node parameters with its handles.
+/**
+ * The node parameters store the value each time the parameter changes, and the
+ * handles load it without locking.
+ * The boolean, integer and double values are also kept in a single word protected by a
+ * sequence lock, so they are loaded without copying the rclcpp::ParameterValue.
+ */
+class ParameterValueCell
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(ParameterValueCell)
+
+  /// Construct the cell of a parameter.
+  /**
+   * \param[in] name the name of the parameter.
+   * \param[in] value the current value of the parameter.
+   */
+  RCLCPP_PUBLIC
+  ParameterValueCell(const std::string & name, const rclcpp::ParameterValue & value);
+
+  /// Return the name of the parameter.
+  RCLCPP_PUBLIC
+  const std::string &
+  get_name() const;
+
+  /// Return the number of times the value was stored, including at construction.
+  uint64_t
+  get_version() const noexcept
+  {
+    return sequence_.load(std::memory_order_acquire) / 2;
+  }
+
+  /// Return the current value, which is rclcpp::PARAMETER_NOT_SET when not declared.
+  RCLCPP_PUBLIC
+  std::shared_ptr<const rclcpp::ParameterValue>
+  get_value() const;
+
+  /// Load the type and the word of a boolean, integer or double value together.
+  /**
+   * \param[out] type the type of the value.
+   * \return the bits of the value, meaningful for these types only.
+   */
+  uint64_t
+  load_scalar(ParameterType & type) const noexcept
+  {
+    for (;;) {
+      const uint64_t sequence = sequence_.load(std::memory_order_acquire);
+      if ((sequence & 1u) != 0) {
+        // The value is being stored
+        continue;
+      }
+      // Acquiring the stored words, the sequence loaded after them is at least the one
+      // incremented before storing them
+      const auto loaded_type = scalar_type_.load(std::memory_order_acquire);
+      const uint64_t bits = scalar_bits_.load(std::memory_order_acquire);
+      if (sequence_.load(std::memory_order_relaxed) == sequence) {
+        type = static_cast<ParameterType>(loaded_type);
+        return bits;
+      }
+    }
+  }
+
+  /// Store a new value, the calls must be serialized.
+  /**
+   * \param[in] value the value of the parameter, rclcpp::PARAMETER_NOT_SET once undeclared.
+   */
+  RCLCPP_PUBLIC
+  void
+  store(const rclcpp::ParameterValue & value);
+
+private:
+  const std::string name_;
+
+  /// Odd while a value is being stored.
+  std::atomic<uint64_t> sequence_{0};
+  std::atomic<uint8_t> scalar_type_{0};
+  std::atomic<uint64_t> scalar_bits_{0};
+
+  /// Accessed with std::atomic_load() and std::atomic_store() only.
+  std::shared_ptr<const rclcpp::ParameterValue> value_;
+};
+
+/// Typed handle to a declared parameter, reading its value without looking it up.
+/**
+ * The handle is obtained from rclcpp::Node::declare_parameter_handle() or
+ * rclcpp::Node::get_parameter_handle(), and keeps reading the value of the
+ * parameter as it's set, without locking.
+ * The boolean, integer and floating point values cost about an atomic load to read,
+ * the other values are copied.
+ * The version changes each time the parameter is set, so it can be compared with a
+ * previous version to detect the changes.
+ *
+ * A handle can be copied and used by several threads.
+ */
+template<typename ParameterT>
+class ParameterHandle
+{
+public:
+  /// Construct a handle bound to no parameter.
+  ParameterHandle() = default;
+
+  /// Construct a handle reading the value of the cell.
+  /**
+   * \param[in] cell the cell of the parameter.
+   * \throws std::invalid_argument if the cell is nullptr.
+   */
+  explicit ParameterHandle(ParameterValueCell::SharedPtr cell)
+  : cell_(std::move(cell))
+  {
+    if (!cell_) {
+      throw std::invalid_argument("cell argument must not be nullptr");
+    }
+  }
+
+  /// Return the name of the parameter.
+  const std::string &
+  get_name() const
+  {
+    return cell_->get_name();
+  }
+
+  /// Return a number changing each time the parameter is set.
+  uint64_t
+  get_version() const noexcept
+  {
+    return cell_->get_version();
+  }
+
+  /// Return the current value of the parameter.
+  /**
+   * \throws rclcpp::exceptions::ParameterNotDeclaredException if the parameter
+   *   was undeclared.
+   * \throws rclcpp::exceptions::InvalidParameterTypeException if the value of a
+   *   dynamically typed parameter isn't of this type anymore.
+   */
+  ParameterT
+  get() const
+  {
+    if constexpr (std::is_arithmetic<ParameterT>::value) {
+      ParameterType type;
+      const uint64_t bits = cell_->load_scalar(type);
+      if (std::is_same<ParameterT, bool>::value && type == ParameterType::PARAMETER_BOOL) {
+        return static_cast<ParameterT>(bits != 0);
+      }
+      if (
+        !std::is_same<ParameterT, bool>::value && std::is_integral<ParameterT>::value &&
+        type == ParameterType::PARAMETER_INTEGER)
+      {
+        return static_cast<ParameterT>(static_cast<int64_t>(bits));
+      }
+      if (std::is_floating_point<ParameterT>::value && type == ParameterType::PARAMETER_DOUBLE) {
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return static_cast<ParameterT>(value);
+      }
+      // Throws the same exceptions as the values of the other types
+    }
+    const auto value = cell_->get_value();
+    if (value->get_type() == ParameterType::PARAMETER_NOT_SET) {
+      throw rclcpp::exceptions::ParameterNotDeclaredException(cell_->get_name());
+    }
+    try {
+      return static_cast<ParameterT>(value->get<ParameterT>());
+    } catch (const ParameterTypeException & ex) {
+      throw rclcpp::exceptions::InvalidParameterTypeException(cell_->get_name(), ex.what());
+    }
+  }
+
+  /// Return true if the handle is bound to a parameter.
+  explicit operator bool() const noexcept
+  {
+    return cell_ != nullptr;
+  }
+
+private:
+  ParameterValueCell::SharedPtr cell_;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__PARAMETER_HANDLE_HPP_
@@ -18,11 +18,14 @@
 #include <rcl_yaml_param_parser/parser.h>
 #include <rcl_yaml_param_parser/types.h>
 
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "rclcpp/exceptions.hpp"
+#include "rclcpp/macros.hpp"
 #include "rclcpp/parameter.hpp"
 #include "rclcpp/parameter_value.hpp"
 #include "rclcpp/visibility_control.hpp"
@@ -52,10 +55,15 @@ ParameterValue
 parameter_value_from(const rcl_variant_t * const c_value);
 
 /// Get the ParameterMap from a yaml file.
-/// \param[in] yaml_filename full name of the yaml file.
-/// \param[in] node_fqn a Fully Qualified Name of node, default value is nullptr.
-/// \returns an instance of a parameter map
-/// \throws from rcl error of rcl_parse_yaml_file()
+/**
+ * The file is parsed through the ParameterFileCache global instance, so loading the same file
+ * again only converts the parameters of the requested node.
+ *
+ * \param[in] yaml_filename full name of the yaml file.
+ * \param[in] node_fqn a Fully Qualified Name of node, default value is nullptr.
+ * \returns an instance of a parameter map
+ * \throws from rcl error of rcl_parse_yaml_file()
+ */
 RCLCPP_PUBLIC
 ParameterMap
 parameter_map_from_yaml_file(const std::string & yaml_filename, const char * node_fqn = nullptr);
@@ -68,6 +76,78 @@ RCLCPP_PUBLIC
 std::vector<Parameter>
 parameters_from_map(const ParameterMap & parameter_map, const char * node_fqn = nullptr);
 
+/// Process-wide cache of parsed parameter files.
+/**
+ * A yaml file is parsed once and kept as long as its size and modification time don't change,
+ * and the parameters of a node are only converted the first time they are requested.
+ * Many nodes loading their parameters from the same large file, e.g. the components of a
+ * container, then share a single parse of the file.
+ *
+ * The parsed files are kept until clear() is called.
+ * All the methods are thread-safe.
+ */
+class ParameterFileCache
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(ParameterFileCache)
+
+  RCLCPP_PUBLIC
+  ParameterFileCache();
+
+  RCLCPP_PUBLIC
+  virtual ~ParameterFileCache();
+
+  /// Get the cache shared by the process.
+  RCLCPP_PUBLIC
+  static
+  ParameterFileCache &
+  get_global_instance();
+
+  /// Get the parameters of a node from a yaml file.
+  /**
+   * The parameters of all the entries matching the node are returned in file order, as
+   * `parameter_map_from(c_params, node_fqn)[node_fqn]` does.
+   *
+   * \param[in] yaml_filename full name of the yaml file.
+   * \param[in] node_fqn a Fully Qualified Name of node.
+   * \returns the parameters of the node, empty when no entry of the file matches it.
+   * \throws from rcl error of rcl_parse_yaml_file()
+   */
+  RCLCPP_PUBLIC
+  std::vector<Parameter>
+  get_parameters(const std::string & yaml_filename, const std::string & node_fqn);
+
+  /// Get the ParameterMap of a yaml file.
+  /**
+   * \param[in] yaml_filename full name of the yaml file.
+   * \param[in] node_fqn a Fully Qualified Name of node, default value is nullptr.
+   * \returns the same map as parameter_map_from() would for the parsed file.
+   * \throws from rcl error of rcl_parse_yaml_file()
+   */
+  RCLCPP_PUBLIC
+  ParameterMap
+  get_parameter_map(const std::string & yaml_filename, const char * node_fqn = nullptr);
+
+  /// Release all the parsed files.
+  RCLCPP_PUBLIC
+  void
+  clear();
+
+  /// Get the number of parsed files in the cache.
+  RCLCPP_PUBLIC
+  size_t
+  get_file_count() const;
+
+private:
+  class ParsedFile;
+
+  std::shared_ptr<ParsedFile>
+  get_parsed_file(const std::string & yaml_filename);
+
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, std::shared_ptr<ParsedFile>> files_;
+};
+
 }  // namespace rclcpp
 
 #endif  // RCLCPP__PARAMETER_MAP_HPP_
@@ -15,8 +15,10 @@
 #ifndef RCLCPP__PARAMETER_VALUE_HPP_
 #define RCLCPP__PARAMETER_VALUE_HPP_
 
+#include <cstdint>
 #include <exception>
 #include <iostream>
+#include <memory>
 #include <ostream>
 #include <sstream>
 #include <string>
@@ -68,6 +70,14 @@ public:
 };
 
 /// Store the type and value of a parameter.
+/**
+ * The value is immutable. The scalars and strings are stored inline, the storage of the arrays
+ * is shared by the copies of the ParameterValue, so that copying one doesn't copy its arrays,
+ * e.g. when getting a parameter or copying a rclcpp::Parameter.
+ * The references to the arrays returned by get() stay valid as long as a copy of the
+ * ParameterValue exists.
+ * A moved from ParameterValue is not set.
+ */
 class ParameterValue
 {
 public:
@@ -77,6 +87,9 @@ public:
   /// Construct a parameter value from a message.
   RCLCPP_PUBLIC
   explicit ParameterValue(const rcl_interfaces::msg::ParameterValue & value);
+  /// Construct a parameter value from a message, moving its arrays and strings.
+  RCLCPP_PUBLIC
+  explicit ParameterValue(rcl_interfaces::msg::ParameterValue && value);
   /// Construct a parameter value with type PARAMETER_BOOL.
   RCLCPP_PUBLIC
   explicit ParameterValue(const bool bool_value);
@@ -95,30 +108,64 @@ public:
   /// Construct a parameter value with type PARAMETER_STRING.
   RCLCPP_PUBLIC
   explicit ParameterValue(const std::string & string_value);
+  /// Construct a parameter value with type PARAMETER_STRING, without copying the value.
+  RCLCPP_PUBLIC
+  explicit ParameterValue(std::string && string_value);
   /// Construct a parameter value with type PARAMETER_STRING.
   RCLCPP_PUBLIC
   explicit ParameterValue(const char * string_value);
   /// Construct a parameter value with type PARAMETER_BYTE_ARRAY.
   RCLCPP_PUBLIC
   explicit ParameterValue(const std::vector<uint8_t> & byte_array_value);
+  /// Construct a parameter value with type PARAMETER_BYTE_ARRAY, without copying the value.
+  RCLCPP_PUBLIC
+  explicit ParameterValue(std::vector<uint8_t> && byte_array_value);
   /// Construct a parameter value with type PARAMETER_BOOL_ARRAY.
   RCLCPP_PUBLIC
   explicit ParameterValue(const std::vector<bool> & bool_array_value);
+  /// Construct a parameter value with type PARAMETER_BOOL_ARRAY, without copying the value.
+  RCLCPP_PUBLIC
+  explicit ParameterValue(std::vector<bool> && bool_array_value);
   /// Construct a parameter value with type PARAMETER_INTEGER_ARRAY.
   RCLCPP_PUBLIC
   explicit ParameterValue(const std::vector<int> & int_array_value);
   /// Construct a parameter value with type PARAMETER_INTEGER_ARRAY.
   RCLCPP_PUBLIC
   explicit ParameterValue(const std::vector<int64_t> & int_array_value);
+  /// Construct a parameter value with type PARAMETER_INTEGER_ARRAY, without copying the value.
+  RCLCPP_PUBLIC
+  explicit ParameterValue(std::vector<int64_t> && int_array_value);
   /// Construct a parameter value with type PARAMETER_DOUBLE_ARRAY.
   RCLCPP_PUBLIC
   explicit ParameterValue(const std::vector<float> & double_array_value);
   /// Construct a parameter value with type PARAMETER_DOUBLE_ARRAY.
   RCLCPP_PUBLIC
   explicit ParameterValue(const std::vector<double> & double_array_value);
+  /// Construct a parameter value with type PARAMETER_DOUBLE_ARRAY, without copying the value.
+  RCLCPP_PUBLIC
+  explicit ParameterValue(std::vector<double> && double_array_value);
   /// Construct a parameter value with type PARAMETER_STRING_ARRAY.
   RCLCPP_PUBLIC
   explicit ParameterValue(const std::vector<std::string> & string_array_value);
+  /// Construct a parameter value with type PARAMETER_STRING_ARRAY, without copying the value.
+  RCLCPP_PUBLIC
+  explicit ParameterValue(std::vector<std::string> && string_array_value);
+
+  RCLCPP_PUBLIC
+  ParameterValue(const ParameterValue & other) = default;
+
+  /// Move constructor, leaving the other value not set.
+  RCLCPP_PUBLIC
+  ParameterValue(ParameterValue && other) noexcept;
+
+  RCLCPP_PUBLIC
+  ParameterValue &
+  operator=(const ParameterValue & other) = default;
+
+  /// Move assignment operator, leaving the other value not set.
+  RCLCPP_PUBLIC
+  ParameterValue &
+  operator=(ParameterValue && other) noexcept;
 
   /// Return an enum indicating the type of the set value.
   RCLCPP_PUBLIC
@@ -147,10 +194,10 @@ public:
   typename std::enable_if<type == ParameterType::PARAMETER_BOOL, const bool &>::type
   get() const
   {
-    if (value_.type != rcl_interfaces::msg::ParameterType::PARAMETER_BOOL) {
+    if (type_ != rcl_interfaces::msg::ParameterType::PARAMETER_BOOL) {
       throw ParameterTypeException(ParameterType::PARAMETER_BOOL, get_type());
     }
-    return value_.bool_value;
+    return bool_value_;
   }
 
   template<ParameterType type>
@@ -158,10 +205,10 @@ public:
   typename std::enable_if<type == ParameterType::PARAMETER_INTEGER, const int64_t &>::type
   get() const
   {
-    if (value_.type != rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER) {
+    if (type_ != rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER) {
       throw ParameterTypeException(ParameterType::PARAMETER_INTEGER, get_type());
     }
-    return value_.integer_value;
+    return integer_value_;
   }
 
   template<ParameterType type>
@@ -169,10 +216,10 @@ public:
   typename std::enable_if<type == ParameterType::PARAMETER_DOUBLE, const double &>::type
   get() const
   {
-    if (value_.type != rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE) {
+    if (type_ != rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE) {
       throw ParameterTypeException(ParameterType::PARAMETER_DOUBLE, get_type());
     }
-    return value_.double_value;
+    return double_value_;
   }
 
   template<ParameterType type>
@@ -180,10 +227,10 @@ public:
   typename std::enable_if<type == ParameterType::PARAMETER_STRING, const std::string &>::type
   get() const
   {
-    if (value_.type != rcl_interfaces::msg::ParameterType::PARAMETER_STRING) {
+    if (type_ != rcl_interfaces::msg::ParameterType::PARAMETER_STRING) {
       throw ParameterTypeException(ParameterType::PARAMETER_STRING, get_type());
     }
-    return value_.string_value;
+    return string_value_;
   }
 
   template<ParameterType type>
@@ -192,10 +239,10 @@ public:
     type == ParameterType::PARAMETER_BYTE_ARRAY, const std::vector<uint8_t> &>::type
   get() const
   {
-    if (value_.type != rcl_interfaces::msg::ParameterType::PARAMETER_BYTE_ARRAY) {
+    if (type_ != rcl_interfaces::msg::ParameterType::PARAMETER_BYTE_ARRAY) {
       throw ParameterTypeException(ParameterType::PARAMETER_BYTE_ARRAY, get_type());
     }
-    return value_.byte_array_value;
+    return array_value_->byte_array_value;
   }
 
   template<ParameterType type>
@@ -204,10 +251,10 @@ public:
     type == ParameterType::PARAMETER_BOOL_ARRAY, const std::vector<bool> &>::type
   get() const
   {
-    if (value_.type != rcl_interfaces::msg::ParameterType::PARAMETER_BOOL_ARRAY) {
+    if (type_ != rcl_interfaces::msg::ParameterType::PARAMETER_BOOL_ARRAY) {
       throw ParameterTypeException(ParameterType::PARAMETER_BOOL_ARRAY, get_type());
     }
-    return value_.bool_array_value;
+    return array_value_->bool_array_value;
   }
 
   template<ParameterType type>
@@ -216,10 +263,10 @@ public:
     type == ParameterType::PARAMETER_INTEGER_ARRAY, const std::vector<int64_t> &>::type
   get() const
   {
-    if (value_.type != rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER_ARRAY) {
+    if (type_ != rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER_ARRAY) {
       throw ParameterTypeException(ParameterType::PARAMETER_INTEGER_ARRAY, get_type());
     }
-    return value_.integer_array_value;
+    return array_value_->integer_array_value;
   }
 
   template<ParameterType type>
@@ -228,10 +275,10 @@ public:
     type == ParameterType::PARAMETER_DOUBLE_ARRAY, const std::vector<double> &>::type
   get() const
   {
-    if (value_.type != rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE_ARRAY) {
+    if (type_ != rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE_ARRAY) {
       throw ParameterTypeException(ParameterType::PARAMETER_DOUBLE_ARRAY, get_type());
     }
-    return value_.double_array_value;
+    return array_value_->double_array_value;
   }
 
   template<ParameterType type>
@@ -240,10 +287,10 @@ public:
     type == ParameterType::PARAMETER_STRING_ARRAY, const std::vector<std::string> &>::type
   get() const
   {
-    if (value_.type != rcl_interfaces::msg::ParameterType::PARAMETER_STRING_ARRAY) {
+    if (type_ != rcl_interfaces::msg::ParameterType::PARAMETER_STRING_ARRAY) {
       throw ParameterTypeException(ParameterType::PARAMETER_STRING_ARRAY, get_type());
     }
-    return value_.string_array_value;
+    return array_value_->string_array_value;
   }
 
   // The following get() variants allow the use of primitive types
@@ -352,7 +399,24 @@ public:
   }
 
 private:
-  rcl_interfaces::msg::ParameterValue value_;
+  /// Reset to a value not set.
+  void
+  reset() noexcept;
+
+  /// Type of the value, one of the rcl_interfaces::msg::ParameterType constants.
+  uint8_t type_{rcl_interfaces::msg::ParameterType::PARAMETER_NOT_SET};
+
+  bool bool_value_{false};
+
+  int64_t integer_value_{0};
+
+  double double_value_{0.0};
+
+  std::string string_value_;
+
+  /// Storage of the array of an array type, shared by the copies.
+  /// Never null, the values of the other types share the storage of the values not set.
+  std::shared_ptr<const rcl_interfaces::msg::ParameterValue> array_value_;
 };
 
 /// Return the value of a parameter as a string
@@ -0,0 +1,234 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__PAYLOAD_COMPRESSION_HPP_
+#define RCLCPP__PAYLOAD_COMPRESSION_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "rcl/types.h"
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/serialized_message.hpp"
+#include "rclcpp/serialized_message_pool.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// Compression algorithm for the payloads of serialized messages.
+/**
+ * A codec is identified by its encoding name, which is written in each compressed payload, so
+ * the subscriptions find the codec to decompress it with, see rclcpp::get_payload_codec().
+ * rclcpp provides the "lz4" codec, other ones, e.g. wrapping zstd, can be registered with
+ * rclcpp::register_payload_codec() before the publishers and subscriptions using them are
+ * created.
+ *
+ * The member functions are called concurrently by several publishers and subscriptions, so
+ * they must be thread-safe.
+ */
+class PayloadCodec
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(PayloadCodec)
+
+  PayloadCodec() = default;
+
+  RCLCPP_PUBLIC
+  virtual ~PayloadCodec();
+
+  /// Return the name of the encoding, at most 255 characters.
+  virtual std::string
+  get_encoding() const = 0;
+
+  /// Return the level used when the publisher doesn't select one.
+  virtual int
+  get_default_level() const = 0;
+
+  /// Return the maximum size of the compressed form of `size` bytes.
+  virtual size_t
+  get_max_compressed_size(size_t size) const = 0;
+
+  /// Compress `size` bytes into `output`, return the size of the compressed data.
+  /**
+   * \param[in] input the data to compress.
+   * \param[in] size the size of the data.
+   * \param[out] output the buffer for the compressed data.
+   * \param[in] capacity the size of the buffer, at least get_max_compressed_size() of `size`.
+   * \param[in] level the compression level, as selected in rclcpp::PayloadCompressionOptions.
+   */
+  virtual size_t
+  compress(
+    const uint8_t * input, size_t size, uint8_t * output, size_t capacity, int level) const = 0;
+
+  /// Decompress `size` bytes into exactly `output_size` bytes.
+  /**
+   * \throws std::runtime_error if the data is corrupted.
+   */
+  virtual void
+  decompress(
+    const uint8_t * input, size_t size, uint8_t * output, size_t output_size) const = 0;
+};
+
+/// Codec for the LZ4 block format, fast enough to compress on the publishing thread.
+/**
+ * The levels go from 1, the fastest, to 9, which searches more matches and compresses better.
+ */
+class LZ4PayloadCodec : public PayloadCodec
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(LZ4PayloadCodec)
+
+  LZ4PayloadCodec() = default;
+
+  RCLCPP_PUBLIC
+  std::string
+  get_encoding() const override;
+
+  RCLCPP_PUBLIC
+  int
+  get_default_level() const override;
+
+  RCLCPP_PUBLIC
+  size_t
+  get_max_compressed_size(size_t size) const override;
+
+  RCLCPP_PUBLIC
+  size_t
+  compress(
+    const uint8_t * input, size_t size, uint8_t * output, size_t capacity,
+    int level) const override;
+
+  RCLCPP_PUBLIC
+  void
+  decompress(
+    const uint8_t * input, size_t size, uint8_t * output, size_t output_size) const override;
+};
+
+/// Register a codec, replacing the one registered for the same encoding.
+/**
+ * \throws std::invalid_argument if the codec is null or its encoding is empty or too long.
+ */
+RCLCPP_PUBLIC
+void
+register_payload_codec(PayloadCodec::SharedPtr codec);
+
+/// Return the codec registered for an encoding, null if there is none.
+RCLCPP_PUBLIC
+PayloadCodec::SharedPtr
+get_payload_codec(const std::string & encoding);
+
+/// Options of the compression of the serialized messages published, disabled by default.
+struct PayloadCompressionOptions
+{
+  /// Encoding of the registered codec compressing the messages, empty to disable compression.
+  std::string encoding;
+
+  /// Compression level given to the codec, 0 for its default level.
+  int level = 0;
+
+  /// Serialized size below which the messages are published uncompressed.
+  size_t min_size = 0;
+};
+
+/// Compress serialized messages into pooled buffers.
+/**
+ * Each compressed payload starts with a header holding the encoding and the uncompressed size,
+ * which rclcpp::PayloadDecompressor recognizes, as it can't be mistaken for the encapsulation
+ * header the serialized messages start with.
+ *
+ * All public member functions are thread-safe.
+ */
+class PayloadCompressor
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(PayloadCompressor)
+
+  /// Create a compressor with the codec of the options.
+  /**
+   * \throws std::invalid_argument if no codec is registered for the encoding of the options.
+   */
+  RCLCPP_PUBLIC
+  explicit PayloadCompressor(const PayloadCompressionOptions & options);
+
+  /// Return the compressed form of a serialized message.
+  /**
+   * Null is returned when the message should be published as is, because it is smaller than
+   * the minimum size of the options or it doesn't compress.
+   * The returned message should be given back with release() once published.
+   */
+  RCLCPP_PUBLIC
+  std::shared_ptr<rclcpp::SerializedMessage>
+  compress(const rcl_serialized_message_t & serialized_message);
+
+  /// Give back a message returned by compress().
+  RCLCPP_PUBLIC
+  void
+  release(std::shared_ptr<rclcpp::SerializedMessage> & message);
+
+  /// Return the codec compressing the messages.
+  RCLCPP_PUBLIC
+  PayloadCodec::SharedPtr
+  get_codec() const;
+
+private:
+  const PayloadCompressionOptions options_;
+  const PayloadCodec::SharedPtr codec_;
+  rclcpp::SerializedMessagePool pool_;
+};
+
+/// Decompress the serialized messages compressed by a rclcpp::PayloadCompressor.
+/**
+ * All public member functions are thread-safe.
+ */
+class PayloadDecompressor
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(PayloadDecompressor)
+
+  RCLCPP_PUBLIC
+  PayloadDecompressor();
+
+  /// Return if a serialized message has been compressed by a rclcpp::PayloadCompressor.
+  RCLCPP_PUBLIC
+  static bool
+  is_compressed(const rcl_serialized_message_t & serialized_message);
+
+  /// Return the decompressed form of a compressed serialized message, in a pooled buffer.
+  /**
+   * The buffer is reused once the returned message is given back with release() and no longer
+   * referenced elsewhere.
+   *
+   * \throws std::runtime_error if the message is corrupted or its codec isn't registered.
+   */
+  RCLCPP_PUBLIC
+  std::shared_ptr<rclcpp::SerializedMessage>
+  decompress(const rcl_serialized_message_t & serialized_message);
+
+  /// Give back a message returned by decompress().
+  RCLCPP_PUBLIC
+  void
+  release(std::shared_ptr<rclcpp::SerializedMessage> & message);
+
+private:
+  rclcpp::SerializedMessagePool pool_;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__PAYLOAD_COMPRESSION_HPP_
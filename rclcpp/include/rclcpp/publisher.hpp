@@ -15,13 +15,17 @@
 #ifndef RCLCPP__PUBLISHER_HPP_
 #define RCLCPP__PUBLISHER_HPP_
 
+#include <algorithm>
+#include <chrono>
 #include <functional>
 #include <iostream>
+#include <iterator>
 #include <memory>
 #include <sstream>
 #include <string>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "rcl/error_handling.h"
 #include "rcl/publisher.h"
@@ -29,17 +33,25 @@
 #include "rmw/rmw.h"
 #include "rosidl_runtime_cpp/traits.hpp"
 
+#include "rclcpp/allocation_audit.hpp"
 #include "rclcpp/allocator/allocator_common.hpp"
 #include "rclcpp/allocator/allocator_deleter.hpp"
+#include "rclcpp/async_publishing.hpp"
+#include "rclcpp/detail/async_publish_queue.hpp"
 #include "rclcpp/detail/resolve_use_intra_process.hpp"
 #include "rclcpp/experimental/intra_process_manager.hpp"
+#include "rclcpp/experimental/message_pool.hpp"
 #include "rclcpp/get_message_type_support_handle.hpp"
 #include "rclcpp/is_ros_compatible_type.hpp"
 #include "rclcpp/loaned_message.hpp"
 #include "rclcpp/macros.hpp"
+#include "rclcpp/memory_accounting.hpp"
+#include "rclcpp/message_lineage.hpp"
 #include "rclcpp/node_interfaces/node_base_interface.hpp"
+#include "rclcpp/payload_compression.hpp"
 #include "rclcpp/publisher_base.hpp"
 #include "rclcpp/publisher_options.hpp"
+#include "rclcpp/rate_limit.hpp"
 #include "rclcpp/type_adapter.hpp"
 #include "rclcpp/type_support_decl.hpp"
 #include "rclcpp/visibility_control.hpp"
@@ -141,6 +153,26 @@ public:
   {
     allocator::set_allocator_for_deleter(&published_type_deleter_, &published_type_allocator_);
     allocator::set_allocator_for_deleter(&ros_message_type_deleter_, &ros_message_type_allocator_);
+    if (!options_.payload_compression.encoding.empty()) {
+      payload_compressor_ = std::make_shared<rclcpp::PayloadCompressor>(
+        options_.payload_compression);
+    }
+    if (options_.rate_limit.policy != rclcpp::RateLimitPolicy::Disabled) {
+      if (options_.rate_limit.policy == rclcpp::RateLimitPolicy::LatestPerInterval) {
+        throw std::invalid_argument(
+                "the publishers don't support the LatestPerInterval rate limit");
+      }
+      rate_limiter_ = std::make_shared<rclcpp::RateLimiter>(options_.rate_limit);
+    }
+    this->set_skip_publish_without_subscriptions(options_.skip_publish_without_subscriptions);
+    if (options_.async_publishing.depth > 0) {
+      async_publish_queue_ = std::make_shared<AsyncPublishQueue>(
+        options_.async_publishing,
+        node_base->get_context()->get_sub_context<rclcpp::detail::AsyncPublishSender>(),
+        [this](const ROSMessageType & msg) {
+          this->publish_to_middleware(msg);
+        });
+    }
     // Setup continues in the post construction method, post_init_setup().
   }
 
@@ -171,25 +203,70 @@ public:
         throw std::invalid_argument(
                 "intraprocess communication is not allowed with a zero qos history depth value");
       }
-      if (qos.durability() != rclcpp::DurabilityPolicy::Volatile) {
+      if (
+        qos.durability() != rclcpp::DurabilityPolicy::Volatile &&
+        qos.durability() != rclcpp::DurabilityPolicy::TransientLocal)
+      {
         throw std::invalid_argument(
-                "intraprocess communication allowed only with volatile durability");
+                "intraprocess communication allowed only with volatile or transient local "
+                "durability");
       }
-      uint64_t intra_process_publisher_id = ipm->add_publisher(this->shared_from_this());
+      uint64_t intra_process_publisher_id =
+        ipm->template add_publisher<PublishedType, ROSMessageType, AllocatorT>(
+        this->shared_from_this());
       this->setup_intra_process(
         intra_process_publisher_id,
         ipm);
+      if (options.intra_process_message_pool_depth > 0) {
+        published_type_message_pool_ = std::make_shared<PublishedTypeMessagePool>(
+          options.intra_process_message_pool_depth, published_type_allocator_);
+        if constexpr (std::is_same<PublishedType, ROSMessageType>::value) {
+          ros_message_type_message_pool_ = published_type_message_pool_;
+        } else {
+          ros_message_type_message_pool_ = std::make_shared<ROSMessageTypeMessagePool>(
+            options.intra_process_message_pool_depth, ros_message_type_allocator_);
+        }
+        std::weak_ptr<PublishedTypeMessagePool> weak_published_pool =
+          published_type_message_pool_;
+        std::weak_ptr<ROSMessageTypeMessagePool> weak_ros_pool = ros_message_type_message_pool_;
+        message_pool_memory_account_ = rclcpp::MemoryAccounting::create_account(
+          node_base->get_fully_qualified_name(), this->get_topic_name(),
+          rclcpp::MemoryEntityKind::MessagePool,
+          [weak_published_pool, weak_ros_pool]() {
+            rclcpp::MemorySample sample = get_pool_memory_sample(weak_published_pool.lock());
+            if constexpr (!std::is_same<PublishedType, ROSMessageType>::value) {
+              const rclcpp::MemorySample ros_sample =
+                get_pool_memory_sample(weak_ros_pool.lock());
+              sample.bytes_in_use += ros_sample.bytes_in_use;
+              sample.high_water_mark += ros_sample.high_water_mark;
+            } else {
+              (void)weak_ros_pool;
+            }
+            return sample;
+          });
+      }
+    }
+    if (options.loaned_message_pool_depth > 0 && !this->can_loan_messages()) {
+      loaned_message_pool_ = std::make_shared<ROSMessageTypeMessagePool>(
+        options.loaned_message_pool_depth, ros_message_type_allocator_);
     }
   }
 
   virtual ~Publisher()
-  {}
+  {
+    if (async_publish_queue_) {
+      // The messages still queued are published before the publisher is gone
+      async_publish_queue_->close();
+    }
+  }
 
   /// Borrow a loaned ROS message from the middleware.
   /**
    * If the middleware is capable of loaning memory for a ROS message instance,
    * the loaned message will be directly allocated in the middleware.
-   * If not, the message allocator of this rclcpp::Publisher instance is being used.
+   * If not, the message allocator of this rclcpp::Publisher instance is being used, or the
+   * message is taken from the pool of the publisher with
+   * rclcpp::PublisherOptionsBase::loaned_message_pool_depth.
    *
    * With a call to \sa `publish` the LoanedMessage instance is being returned to the middleware
    * or free'd accordingly to the allocator.
@@ -203,6 +280,12 @@ public:
   rclcpp::LoanedMessage<ROSMessageType, AllocatorT>
   borrow_loaned_message()
   {
+    if (loaned_message_pool_) {
+      return rclcpp::LoanedMessage<ROSMessageType, AllocatorT>(
+        *this,
+        this->get_ros_message_type_allocator(),
+        loaned_message_pool_->borrow());
+    }
     return rclcpp::LoanedMessage<ROSMessageType, AllocatorT>(
       *this,
       this->get_ros_message_type_allocator());
@@ -226,26 +309,13 @@ public:
   >
   publish(std::unique_ptr<T, ROSMessageTypeDeleter> msg)
   {
-    if (!intra_process_is_enabled_) {
-      this->do_inter_process_publish(*msg);
+    if (this->drop_by_rate_limit()) {
       return;
     }
-    // If an interprocess subscription exist, then the unique_ptr is promoted
-    // to a shared_ptr and published.
-    // This allows doing the intraprocess publish first and then doing the
-    // interprocess publish, resulting in lower publish-to-subscribe latency.
-    // It's not possible to do that with an unique_ptr,
-    // as do_intra_process_publish takes the ownership of the message.
-    bool inter_process_publish_needed =
-      get_subscription_count() > get_intra_process_subscription_count();
-
-    if (inter_process_publish_needed) {
-      auto shared_msg =
-        this->do_intra_process_ros_message_publish_and_return_shared(std::move(msg));
-      this->do_inter_process_publish(*shared_msg);
-    } else {
-      this->do_intra_process_ros_message_publish(std::move(msg));
-    }
+    rclcpp::AllocationAudit::Scope audit_scope(this, rclcpp::AllocationSite::Publish);
+    rclcpp::topic_statistics::PublisherTopicStatistics::Scope topic_stats_scope(
+      topic_stats_.get());
+    this->do_unique_ros_message_publish(std::move(msg));
   }
 
   /// Publish a message on the topic.
@@ -257,6 +327,8 @@ public:
    * This signature allows the user to give a reference to a message, which is
    * copied onto the heap without modification so that a copy can be owned by
    * rclcpp and ownership of the copy can be moved later if needed.
+   * The message is only copied for the intra process subscriptions: once, shared by all of
+   * them, if none takes ownership, and not at all if there are none.
    *
    * \param[in] msg A const reference to the message to send.
    */
@@ -267,16 +339,35 @@ public:
   >
   publish(const T & msg)
   {
+    if (this->drop_by_rate_limit()) {
+      return;
+    }
+    rclcpp::AllocationAudit::Scope audit_scope(this, rclcpp::AllocationSite::Publish);
+    rclcpp::topic_statistics::PublisherTopicStatistics::Scope topic_stats_scope(
+      topic_stats_.get());
     // Avoid allocating when not using intra process.
     if (!intra_process_is_enabled_) {
       // In this case we're not using intra process.
+      if (this->skip_inter_process_publish()) {
+        return;
+      }
       return this->do_inter_process_publish(msg);
     }
-    // Otherwise we have to allocate memory in a unique_ptr and pass it along.
-    // As the message is not const, a copy should be made.
-    // A shared_ptr<const MessageT> could also be constructed here.
-    auto unique_msg = this->duplicate_ros_message_as_unique_ptr(msg);
-    this->publish(std::move(unique_msg));
+    // Otherwise the intra process manager copies the message as its subscriptions require.
+    // The middleware publishes the message of the caller, unless it's published
+    // asynchronously, which reuses the copy shared with the intra process subscriptions.
+    const bool inter_process_publish_needed =
+      get_subscription_count() > get_intra_process_subscription_count();
+    auto shared_msg = this->do_intra_process_ros_message_publish_copy(
+      msg, inter_process_publish_needed && async_publish_queue_);
+    if (!inter_process_publish_needed) {
+      return;
+    }
+    if (shared_msg && async_publish_queue_) {
+      this->do_inter_process_publish(std::move(shared_msg));
+    } else {
+      this->do_inter_process_publish(msg);
+    }
   }
 
   /// Publish a message on the topic.
@@ -297,28 +388,13 @@ public:
   >
   publish(std::unique_ptr<T, PublishedTypeDeleter> msg)
   {
-    // Avoid allocating when not using intra process.
-    if (!intra_process_is_enabled_) {
-      // In this case we're not using intra process.
-      ROSMessageType ros_msg;
-      rclcpp::TypeAdapter<MessageT>::convert_to_ros_message(*msg, ros_msg);
-      return this->do_inter_process_publish(ros_msg);
-    }
-
-    bool inter_process_publish_needed =
-      get_subscription_count() > get_intra_process_subscription_count();
-
-    if (inter_process_publish_needed) {
-      ROSMessageType ros_msg;
-      // TODO(clalancette): This is unnecessarily doing an additional conversion
-      // that may have already been done in do_intra_process_publish_and_return_shared().
-      // We should just reuse that effort.
-      rclcpp::TypeAdapter<MessageT>::convert_to_ros_message(*msg, ros_msg);
-      this->do_intra_process_publish(std::move(msg));
-      this->do_inter_process_publish(ros_msg);
-    } else {
-      this->do_intra_process_publish(std::move(msg));
+    if (this->drop_by_rate_limit()) {
+      return;
     }
+    rclcpp::AllocationAudit::Scope audit_scope(this, rclcpp::AllocationSite::Publish);
+    rclcpp::topic_statistics::PublisherTopicStatistics::Scope topic_stats_scope(
+      topic_stats_.get());
+    this->do_unique_published_type_publish(std::move(msg));
   }
 
   /// Publish a message on the topic.
@@ -339,8 +415,24 @@ public:
   >
   publish(const T & msg)
   {
-    // Avoid double allocating when not using intra process.
-    if (!intra_process_is_enabled_) {
+    if (this->drop_by_rate_limit()) {
+      return;
+    }
+    rclcpp::AllocationAudit::Scope audit_scope(this, rclcpp::AllocationSite::Publish);
+    rclcpp::topic_statistics::PublisherTopicStatistics::Scope topic_stats_scope(
+      topic_stats_.get());
+    // Avoid double allocating when not using intra process, or without intra process
+    // subscriptions.
+    if (!intra_process_is_enabled_ || get_intra_process_subscription_count() == 0) {
+      if (this->skip_inter_process_publish()) {
+        return;
+      }
+      // A view of a ROS message is published without being converted.
+      if (auto viewed_msg = rclcpp::detail::get_viewed_ros_message<
+          rclcpp::TypeAdapter<MessageT>>(msg))
+      {
+        return this->do_inter_process_publish(std::move(viewed_msg));
+      }
       // Convert to the ROS message equivalent and publish it.
       ROSMessageType ros_msg;
       rclcpp::TypeAdapter<MessageT>::convert_to_ros_message(msg, ros_msg);
@@ -352,18 +444,30 @@ public:
     // As the message is not const, a copy should be made.
     // A shared_ptr<const MessageT> could also be constructed here.
     auto unique_msg = this->duplicate_type_adapt_message_as_unique_ptr(msg);
-    this->publish(std::move(unique_msg));
+    this->do_unique_published_type_publish(std::move(unique_msg));
   }
 
   void
   publish(const rcl_serialized_message_t & serialized_msg)
   {
+    if (this->drop_by_rate_limit()) {
+      return;
+    }
+    rclcpp::AllocationAudit::Scope audit_scope(this, rclcpp::AllocationSite::Publish);
+    rclcpp::topic_statistics::PublisherTopicStatistics::Scope topic_stats_scope(
+      topic_stats_.get());
     return this->do_serialized_publish(&serialized_msg);
   }
 
   void
   publish(const SerializedMessage & serialized_msg)
   {
+    if (this->drop_by_rate_limit()) {
+      return;
+    }
+    rclcpp::AllocationAudit::Scope audit_scope(this, rclcpp::AllocationSite::Publish);
+    rclcpp::topic_statistics::PublisherTopicStatistics::Scope topic_stats_scope(
+      topic_stats_.get());
     return this->do_serialized_publish(&serialized_msg.get_rcl_serialized_message());
   }
 
@@ -373,17 +477,65 @@ public:
    * after being published.
    * The instance of the loaned message is no longer valid after this call.
    *
+   * When intra process is enabled, the intra process subscriptions receive a copy of the
+   * message, and the loaned message is published only if subscriptions of other processes
+   * exist.
+   * The middleware is then in charge of delivering it without copy to the processes of the
+   * same host, if it can loan messages, and of falling back to its network transport otherwise.
+   * With rclcpp::PublisherOptionsBase::share_loaned_messages_intra_process, the intra process
+   * subscriptions share the loaned message instead, and the middleware gets it once all of them
+   * released it.
+   * If the middleware can't loan messages, the intra process subscriptions always share the
+   * message, after the middleware copied it.
+   *
    * \param loaned_msg The LoanedMessage instance to be published.
    */
   void
   publish(rclcpp::LoanedMessage<ROSMessageType, AllocatorT> && loaned_msg)
   {
+    rclcpp::AllocationAudit::Scope audit_scope(this, rclcpp::AllocationSite::Publish);
+    rclcpp::topic_statistics::PublisherTopicStatistics::Scope topic_stats_scope(
+      topic_stats_.get());
     if (!loaned_msg.is_valid()) {
       throw std::runtime_error("loaned message is not valid");
     }
+    if (this->drop_by_rate_limit()) {
+      // The loan is returned to the middleware on destruction
+      return;
+    }
     if (intra_process_is_enabled_) {
-      // TODO(Karsten1987): support loaned message passed by intraprocess
-      throw std::runtime_error("storing loaned messages in intra process is not supported yet");
+      const size_t intra_process_subscription_count = get_intra_process_subscription_count();
+      if (intra_process_subscription_count > 0) {
+        const bool inter_process = get_subscription_count() > intra_process_subscription_count;
+        if (!this->can_loan_messages()) {
+          // The message was allocated by the publisher, it can be shared once published
+          std::shared_ptr<const ROSMessageType> msg = loaned_msg.release();
+          if (inter_process) {
+            this->do_inter_process_publish(msg);
+          }
+          this->do_intra_process_ros_message_publish_shared(std::move(msg));
+          return;
+        }
+        if (options_.share_loaned_messages_intra_process) {
+          if (inter_process && topic_stats_) {
+            // Given to the middleware once the intra process subscriptions released it
+            topic_stats_->on_inter_process_publish();
+          }
+          this->do_intra_process_ros_message_publish_shared(
+            this->share_loaned_message(loaned_msg.release().release(), inter_process));
+          return;
+        }
+        // The loan belongs to the middleware, the intra process buffers need their own copy
+        this->do_intra_process_ros_message_publish(
+          this->duplicate_ros_message_as_unique_ptr(loaned_msg.get()));
+      }
+      if (get_subscription_count() <= intra_process_subscription_count) {
+        // The loaned message is returned to the middleware on destruction
+        return;
+      }
+    } else if (this->skip_inter_process_publish()) {
+      // The loaned message is returned to the middleware on destruction
+      return;
     }
 
     // verify that publisher supports loaned messages
@@ -402,6 +554,131 @@ public:
     }
   }
 
+  /// Publish a batch of messages on the topic, in order.
+  /**
+   * This is equivalent to publishing each message with publish(), but the intra process
+   * subscriptions of the publisher are looked up once for the batch, and the subscription
+   * counts are queried once to decide whether the messages go to other processes.
+   * The messages are given to the intra process subscriptions first, and then published to
+   * the other processes one at a time, as the middleware has no batched publish.
+   * The whole batch is measured as one publish call by the topic statistics and the
+   * rclcpp::AllocationAudit.
+   *
+   * \param[in] msgs unique pointers to the messages to send, the vector is cleared.
+   * \throws std::runtime_error if one of the messages is a null pointer, in which case none
+   *   of them is published.
+   */
+  template<typename T>
+  typename std::enable_if_t<
+    rosidl_generator_traits::is_message<T>::value &&
+    std::is_same<T, ROSMessageType>::value
+  >
+  publish_batch(std::vector<std::unique_ptr<T, ROSMessageTypeDeleter>> && msgs)
+  {
+    rclcpp::AllocationAudit::Scope audit_scope(this, rclcpp::AllocationSite::Publish);
+    rclcpp::topic_statistics::PublisherTopicStatistics::Scope topic_stats_scope(
+      topic_stats_.get());
+    for (const auto & msg : msgs) {
+      if (!msg) {
+        throw std::runtime_error("cannot publish msg which is a null pointer");
+      }
+    }
+    if (rate_limiter_) {
+      msgs.erase(
+        std::remove_if(
+          msgs.begin(), msgs.end(),
+          [this](const auto &) {
+            return this->drop_by_rate_limit();
+          }),
+        msgs.end());
+    }
+    if (!intra_process_is_enabled_) {
+      if (msgs.empty() || !this->skip_inter_process_publish()) {
+        for (auto & msg : msgs) {
+          this->do_inter_process_publish(std::move(msg));
+        }
+      }
+      msgs.clear();
+      return;
+    }
+    auto ipm = weak_ipm_.lock();
+    if (!ipm) {
+      throw std::runtime_error(
+              "intra process publish called after destruction of intra process manager");
+    }
+    for (size_t i = 0; i < msgs.size(); ++i) {
+      this->count_intra_process_publish();
+      TRACEPOINT(
+        rclcpp_intra_publish,
+        static_cast<const void *>(publisher_handle_.get()),
+        static_cast<const void *>(msgs[i].get()));
+    }
+    rclcpp::detail::PublishedLineageScope lineage_scope(options_.propagate_lineage);
+    const bool inter_process_publish_needed =
+      get_subscription_count() > get_intra_process_subscription_count();
+    if (!inter_process_publish_needed) {
+      ipm->template do_intra_process_publish_batch<ROSMessageType, ROSMessageType, AllocatorT>(
+        intra_process_publisher_id_,
+        msgs,
+        ros_message_type_allocator_,
+        ros_message_type_message_pool_.get());
+      msgs.clear();
+      return;
+    }
+    std::vector<std::shared_ptr<const ROSMessageType>> shared_msgs;
+    shared_msgs.reserve(msgs.size());
+    ipm->template do_intra_process_publish_batch<ROSMessageType, ROSMessageType, AllocatorT>(
+      intra_process_publisher_id_,
+      msgs,
+      ros_message_type_allocator_,
+      ros_message_type_message_pool_.get(),
+      &shared_msgs);
+    msgs.clear();
+    for (auto & shared_msg : shared_msgs) {
+      if (shared_msg) {
+        this->do_inter_process_publish(std::move(shared_msg));
+      }
+    }
+  }
+
+  /// Publish a batch of messages on the topic, in order.
+  /**
+   * This is equivalent to publishing each message with publish(const T &), see
+   * publish_batch(std::vector<std::unique_ptr<T, ROSMessageTypeDeleter>> &&).
+   * Without intra process communication nor asynchronous publishing the messages aren't
+   * copied.
+   *
+   * \param[in] first iterator to the first message to send.
+   * \param[in] last iterator past the last message to send.
+   */
+  template<typename InputIt>
+  typename std::enable_if_t<
+    std::is_same<
+      typename std::iterator_traits<InputIt>::value_type, ROSMessageType>::value
+  >
+  publish_batch(InputIt first, InputIt last)
+  {
+    if (!intra_process_is_enabled_) {
+      rclcpp::AllocationAudit::Scope audit_scope(this, rclcpp::AllocationSite::Publish);
+      rclcpp::topic_statistics::PublisherTopicStatistics::Scope topic_stats_scope(
+        topic_stats_.get());
+      if (first == last || this->skip_inter_process_publish()) {
+        return;
+      }
+      for (; first != last; ++first) {
+        if (!this->drop_by_rate_limit()) {
+          this->do_inter_process_publish(*first);
+        }
+      }
+      return;
+    }
+    std::vector<std::unique_ptr<ROSMessageType, ROSMessageTypeDeleter>> unique_msgs;
+    for (; first != last; ++first) {
+      unique_msgs.push_back(this->duplicate_ros_message_as_unique_ptr(*first));
+    }
+    this->publish_batch(std::move(unique_msgs));
+  }
+
   [[deprecated("use get_published_type_allocator() or get_ros_message_type_allocator() instead")]]
   std::shared_ptr<PublishedTypeAllocator>
   get_allocator() const
@@ -421,9 +698,206 @@ public:
     return ros_message_type_allocator_;
   }
 
+  /// Return the statistics of the pool of intra-process message copies.
+  /**
+   * When the published type differs from the ROS message type, the statistics of the pools
+   * of both types are added.
+   * The statistics are empty if PublisherOptions::intra_process_message_pool_depth is 0.
+   */
+  rclcpp::experimental::MessagePoolStatistics
+  get_intra_process_message_pool_statistics() const
+  {
+    rclcpp::experimental::MessagePoolStatistics statistics;
+    if (!published_type_message_pool_) {
+      return statistics;
+    }
+    statistics = published_type_message_pool_->get_statistics();
+    if constexpr (!std::is_same<PublishedType, ROSMessageType>::value) {
+      const auto ros_message_statistics = ros_message_type_message_pool_->get_statistics();
+      statistics.depth += ros_message_statistics.depth;
+      statistics.in_use += ros_message_statistics.in_use;
+      statistics.high_water_mark += ros_message_statistics.high_water_mark;
+      statistics.allocations += ros_message_statistics.allocations;
+      statistics.reuses += ros_message_statistics.reuses;
+    }
+    return statistics;
+  }
+
+  /// Return the statistics of the pool of the messages returned by borrow_loaned_message().
+  /**
+   * The statistics are empty if PublisherOptions::loaned_message_pool_depth is 0, or if the
+   * middleware loans the messages.
+   */
+  rclcpp::experimental::MessagePoolStatistics
+  get_loaned_message_pool_statistics() const
+  {
+    if (!loaned_message_pool_) {
+      return rclcpp::experimental::MessagePoolStatistics();
+    }
+    return loaned_message_pool_->get_statistics();
+  }
+
+  /// Return the metrics of the queue of the asynchronous publishing.
+  /**
+   * The statistics are empty if PublisherOptions::async_publishing is disabled.
+   */
+  rclcpp::AsyncPublishingStatistics
+  get_async_publishing_statistics() const
+  {
+    if (!async_publish_queue_) {
+      return rclcpp::AsyncPublishingStatistics();
+    }
+    return async_publish_queue_->get_statistics();
+  }
+
+  /// Wait until the messages queued by the asynchronous publishing are given to the middleware.
+  /**
+   * It returns true right away if PublisherOptions::async_publishing is disabled.
+   *
+   * \param[in] timeout the maximum time to wait, a negative value waits forever.
+   * \return true if all the queued messages were published within the timeout.
+   */
+  template<typename DurationRepT = int64_t, typename DurationT = std::milli>
+  bool
+  wait_for_async_publishing(
+    std::chrono::duration<DurationRepT, DurationT> timeout =
+    std::chrono::duration<DurationRepT, DurationT>(-1))
+  {
+    if (!async_publish_queue_) {
+      return true;
+    }
+    return async_publish_queue_->wait_until_sent(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(timeout));
+  }
+
+  /// Return the rate limiter of the messages published.
+  /**
+   * \return the rate limiter counting the messages kept and dropped, or nullptr if
+   *   PublisherOptions::rate_limit is disabled.
+   */
+  std::shared_ptr<const rclcpp::RateLimiter>
+  get_rate_limiter() const
+  {
+    return rate_limiter_;
+  }
+
 protected:
+  /// Publish a ROS message given by unique pointer, once the rate limit kept it.
+  void
+  do_unique_ros_message_publish(std::unique_ptr<ROSMessageType, ROSMessageTypeDeleter> msg)
+  {
+    if (!intra_process_is_enabled_) {
+      if (!this->skip_inter_process_publish()) {
+        this->do_inter_process_publish(std::move(msg));
+      }
+      return;
+    }
+    // If an interprocess subscription exist, then the unique_ptr is promoted
+    // to a shared_ptr and published.
+    // This allows doing the intraprocess publish first and then doing the
+    // interprocess publish, resulting in lower publish-to-subscribe latency.
+    // It's not possible to do that with an unique_ptr,
+    // as do_intra_process_publish takes the ownership of the message.
+    bool inter_process_publish_needed =
+      get_subscription_count() > get_intra_process_subscription_count();
+
+    if (inter_process_publish_needed) {
+      auto shared_msg =
+        this->do_intra_process_ros_message_publish_and_return_shared(std::move(msg));
+      this->do_inter_process_publish(std::move(shared_msg));
+    } else {
+      this->do_intra_process_ros_message_publish(std::move(msg));
+    }
+  }
+
+  /// Publish a type adapted message given by unique pointer, once the rate limit kept it.
+  void
+  do_unique_published_type_publish(std::unique_ptr<PublishedType, PublishedTypeDeleter> msg)
+  {
+    if constexpr (!rclcpp::TypeAdapter<MessageT>::is_specialized::value) {
+      // Both types are the same, this keeps the explicit instantiations compiling
+      this->do_unique_ros_message_publish(std::move(msg));
+    } else {
+      // Avoid allocating when not using intra process.
+      // A view of a ROS message is published without being converted.
+      auto viewed_msg =
+        rclcpp::detail::get_viewed_ros_message<rclcpp::TypeAdapter<MessageT>>(*msg);
+      if (!intra_process_is_enabled_) {
+        // In this case we're not using intra process.
+        if (this->skip_inter_process_publish()) {
+          return;
+        }
+        if (viewed_msg) {
+          return this->do_inter_process_publish(std::move(viewed_msg));
+        }
+        ROSMessageType ros_msg;
+        rclcpp::TypeAdapter<MessageT>::convert_to_ros_message(*msg, ros_msg);
+        return this->do_inter_process_publish(ros_msg);
+      }
+
+      bool inter_process_publish_needed =
+        get_subscription_count() > get_intra_process_subscription_count();
+
+      if (inter_process_publish_needed) {
+        // Converted once, for the middleware and the intra-process subscriptions of the ROS
+        // type
+        std::shared_ptr<const ROSMessageType> ros_msg = std::move(viewed_msg);
+        if (!ros_msg) {
+          auto converted_msg =
+            std::allocate_shared<ROSMessageType>(ros_message_type_allocator_);
+          rclcpp::TypeAdapter<MessageT>::convert_to_ros_message(*msg, *converted_msg);
+          ros_msg = std::move(converted_msg);
+        }
+        this->do_intra_process_publish(std::move(msg), ros_msg);
+        this->do_inter_process_publish(std::move(ros_msg));
+      } else {
+        this->do_intra_process_publish(std::move(msg), std::move(viewed_msg));
+      }
+    }
+  }
+
+  /// Return true if the rate limit drops the message being published.
+  bool
+  drop_by_rate_limit()
+  {
+    return rate_limiter_ && !rate_limiter_->try_keep();
+  }
+
   void
   do_inter_process_publish(const ROSMessageType & msg)
+  {
+    if (async_publish_queue_) {
+      // The caller keeps the message, the queue needs a copy
+      async_publish_queue_->enqueue(
+        std::allocate_shared<ROSMessageType>(ros_message_type_allocator_, msg));
+      return;
+    }
+    this->publish_to_middleware(msg);
+  }
+
+  void
+  do_inter_process_publish(std::unique_ptr<ROSMessageType, ROSMessageTypeDeleter> msg)
+  {
+    if (async_publish_queue_) {
+      async_publish_queue_->enqueue(std::shared_ptr<const ROSMessageType>(std::move(msg)));
+      return;
+    }
+    this->publish_to_middleware(*msg);
+  }
+
+  void
+  do_inter_process_publish(std::shared_ptr<const ROSMessageType> msg)
+  {
+    if (async_publish_queue_) {
+      async_publish_queue_->enqueue(std::move(msg));
+      return;
+    }
+    this->publish_to_middleware(*msg);
+  }
+
+  /// Publish a message with the middleware, on the calling thread.
+  void
+  publish_to_middleware(const ROSMessageType & msg)
   {
     TRACEPOINT(rclcpp_publish, nullptr, static_cast<const void *>(&msg));
     auto status = rcl_publish(publisher_handle_.get(), &msg, nullptr);
@@ -441,6 +915,9 @@ protected:
     if (RCL_RET_OK != status) {
       rclcpp::exceptions::throw_from_rcl_error(status, "failed to publish message");
     }
+    if (topic_stats_) {
+      topic_stats_->on_inter_process_publish();
+    }
   }
 
   void
@@ -450,10 +927,29 @@ protected:
       // TODO(Karsten1987): support serialized message passed by intraprocess
       throw std::runtime_error("storing serialized messages in intra process is not supported yet");
     }
+    if (topic_stats_) {
+      topic_stats_->on_serialized_publish(serialized_msg->buffer_length);
+    }
+    if (this->skip_inter_process_publish()) {
+      return;
+    }
+    std::shared_ptr<rclcpp::SerializedMessage> compressed_msg;
+    if (payload_compressor_) {
+      compressed_msg = payload_compressor_->compress(*serialized_msg);
+      if (compressed_msg) {
+        serialized_msg = &compressed_msg->get_rcl_serialized_message();
+      }
+    }
     auto status = rcl_publish_serialized_message(publisher_handle_.get(), serialized_msg, nullptr);
+    if (compressed_msg) {
+      payload_compressor_->release(compressed_msg);
+    }
     if (RCL_RET_OK != status) {
       rclcpp::exceptions::throw_from_rcl_error(status, "failed to publish serialized message");
     }
+    if (topic_stats_) {
+      topic_stats_->on_inter_process_publish();
+    }
   }
 
   void
@@ -475,10 +971,15 @@ protected:
     if (RCL_RET_OK != status) {
       rclcpp::exceptions::throw_from_rcl_error(status, "failed to publish message");
     }
+    if (topic_stats_) {
+      topic_stats_->on_inter_process_publish();
+    }
   }
 
   void
-  do_intra_process_publish(std::unique_ptr<PublishedType, PublishedTypeDeleter> msg)
+  do_intra_process_publish(
+    std::unique_ptr<PublishedType, PublishedTypeDeleter> msg,
+    std::shared_ptr<const ROSMessageType> ros_msg = nullptr)
   {
     auto ipm = weak_ipm_.lock();
     if (!ipm) {
@@ -488,11 +989,19 @@ protected:
     if (!msg) {
       throw std::runtime_error("cannot publish msg which is a null pointer");
     }
+    this->count_intra_process_publish();
+    TRACEPOINT(
+      rclcpp_intra_publish,
+      static_cast<const void *>(publisher_handle_.get()),
+      static_cast<const void *>(msg.get()));
+    rclcpp::detail::PublishedLineageScope lineage_scope(options_.propagate_lineage);
 
     ipm->template do_intra_process_publish<PublishedType, ROSMessageType, AllocatorT>(
       intra_process_publisher_id_,
       std::move(msg),
-      published_type_allocator_);
+      published_type_allocator_,
+      published_type_message_pool_.get(),
+      std::move(ros_msg));
   }
 
   void
@@ -506,13 +1015,113 @@ protected:
     if (!msg) {
       throw std::runtime_error("cannot publish msg which is a null pointer");
     }
+    this->count_intra_process_publish();
+    TRACEPOINT(
+      rclcpp_intra_publish,
+      static_cast<const void *>(publisher_handle_.get()),
+      static_cast<const void *>(msg.get()));
+    rclcpp::detail::PublishedLineageScope lineage_scope(options_.propagate_lineage);
 
     ipm->template do_intra_process_publish<ROSMessageType, ROSMessageType, AllocatorT>(
+      intra_process_publisher_id_,
+      std::move(msg),
+      ros_message_type_allocator_,
+      ros_message_type_message_pool_.get());
+  }
+
+  void
+  do_intra_process_ros_message_publish_shared(std::shared_ptr<const ROSMessageType> msg)
+  {
+    auto ipm = weak_ipm_.lock();
+    if (!ipm) {
+      throw std::runtime_error(
+              "intra process publish called after destruction of intra process manager");
+    }
+    if (!msg) {
+      throw std::runtime_error("cannot publish msg which is a null pointer");
+    }
+    this->count_intra_process_publish();
+    TRACEPOINT(
+      rclcpp_intra_publish,
+      static_cast<const void *>(publisher_handle_.get()),
+      static_cast<const void *>(msg.get()));
+    rclcpp::detail::PublishedLineageScope lineage_scope(options_.propagate_lineage);
+
+    ipm->template do_intra_process_publish_shared<ROSMessageType, ROSMessageType, AllocatorT,
+      ROSMessageTypeDeleter>(
       intra_process_publisher_id_,
       std::move(msg),
       ros_message_type_allocator_);
   }
 
+  /// Count a message given to the intra-process subscriptions, if topic statistics are enabled.
+  void
+  count_intra_process_publish()
+  {
+    if (topic_stats_ && get_intra_process_subscription_count() > 0) {
+      topic_stats_->on_intra_process_publish();
+    }
+  }
+
+  /// Share a message loaned by the middleware, given back to it once all the owners released it.
+  /**
+   * \param[in] msg the loaned message.
+   * \param[in] inter_process true to publish the message to the subscriptions of other
+   *   processes once released, false to return it to the middleware unpublished.
+   */
+  std::shared_ptr<const ROSMessageType>
+  share_loaned_message(ROSMessageType * msg, bool inter_process)
+  {
+    return std::shared_ptr<const ROSMessageType>(
+      msg,
+      [publisher_handle = publisher_handle_, inter_process](const ROSMessageType * message)
+      {
+        auto loaned_message = const_cast<ROSMessageType *>(message);
+        rcl_ret_t ret = inter_process ?
+        rcl_publish_loaned_message(publisher_handle.get(), loaned_message, nullptr) :
+        rcl_return_loaned_message_from_publisher(publisher_handle.get(), loaned_message);
+        if (RCL_RET_OK != ret) {
+          RCLCPP_ERROR(
+            rclcpp::get_logger("rclcpp"),
+            "failed to give a shared loaned message back to the middleware: %s",
+            rcl_get_error_string().str);
+          rcl_reset_error();
+        }
+      });
+  }
+
+  /// Give a copy of a message kept by the caller to the intra process subscriptions.
+  /**
+   * \param[in] msg the message, copied only as the intra process subscriptions require.
+   * \param[in] return_shared true to get a shared copy of the message in any case.
+   * \return the copy of the message shared with the intra process subscriptions, or nullptr
+   *   if none was made.
+   */
+  std::shared_ptr<const ROSMessageType>
+  do_intra_process_ros_message_publish_copy(const ROSMessageType & msg, bool return_shared)
+  {
+    auto ipm = weak_ipm_.lock();
+    if (!ipm) {
+      throw std::runtime_error(
+              "intra process publish called after destruction of intra process manager");
+    }
+    this->count_intra_process_publish();
+    TRACEPOINT(
+      rclcpp_intra_publish,
+      static_cast<const void *>(publisher_handle_.get()),
+      static_cast<const void *>(&msg));
+    rclcpp::detail::PublishedLineageScope lineage_scope(options_.propagate_lineage);
+
+    return ipm->template do_intra_process_publish_copy<ROSMessageType, ROSMessageType,
+             AllocatorT, ROSMessageTypeDeleter>(
+      intra_process_publisher_id_,
+      msg,
+      ros_message_type_allocator_,
+      ros_message_type_message_pool_.get(),
+      nullptr,
+      return_shared);
+  }
+
   std::shared_ptr<const ROSMessageType>
   do_intra_process_ros_message_publish_and_return_shared(
     std::unique_ptr<ROSMessageType, ROSMessageTypeDeleter> msg)
@@ -525,12 +1134,19 @@ protected:
     if (!msg) {
       throw std::runtime_error("cannot publish msg which is a null pointer");
     }
+    this->count_intra_process_publish();
+    TRACEPOINT(
+      rclcpp_intra_publish,
+      static_cast<const void *>(publisher_handle_.get()),
+      static_cast<const void *>(msg.get()));
+    rclcpp::detail::PublishedLineageScope lineage_scope(options_.propagate_lineage);
 
     return ipm->template do_intra_process_publish_and_return_shared<ROSMessageType, ROSMessageType,
              AllocatorT>(
       intra_process_publisher_id_,
       std::move(msg),
-      ros_message_type_allocator_);
+      ros_message_type_allocator_,
+      ros_message_type_message_pool_.get());
   }
 
 
@@ -561,6 +1177,22 @@ protected:
     return std::unique_ptr<PublishedType, PublishedTypeDeleter>(ptr, published_type_deleter_);
   }
 
+  /// Return the memory of the copies of a pool, in use or free, nullptr giving an empty sample.
+  template<typename PoolT>
+  static rclcpp::MemorySample
+  get_pool_memory_sample(const std::shared_ptr<PoolT> & pool)
+  {
+    rclcpp::MemorySample sample;
+    if (pool) {
+      using PoolMessageT = typename PoolT::MessageAllocTraits::value_type;
+      const auto statistics = pool->get_statistics();
+      sample.bytes_in_use = (statistics.in_use + statistics.free) * sizeof(PoolMessageT);
+      // The pool never holds more copies than the most in use at once
+      sample.high_water_mark = statistics.high_water_mark * sizeof(PoolMessageT);
+    }
+    return sample;
+  }
+
   /// Copy of original options passed during construction.
   /**
    * It is important to save a copy of this so that the rmw payload which it
@@ -572,6 +1204,30 @@ protected:
   PublishedTypeDeleter published_type_deleter_;
   ROSMessageTypeAllocator ros_message_type_allocator_;
   ROSMessageTypeDeleter ros_message_type_deleter_;
+
+  using PublishedTypeMessagePool = rclcpp::experimental::MessagePool<PublishedType, AllocatorT>;
+  using ROSMessageTypeMessagePool = rclcpp::experimental::MessagePool<ROSMessageType, AllocatorT>;
+
+  /// Pools of the intra-process message copies, nullptr when disabled.
+  std::shared_ptr<PublishedTypeMessagePool> published_type_message_pool_;
+  std::shared_ptr<ROSMessageTypeMessagePool> ros_message_type_message_pool_;
+
+  /// Pool of the messages of borrow_loaned_message(), nullptr when the middleware loans them.
+  std::shared_ptr<ROSMessageTypeMessagePool> loaned_message_pool_;
+
+  /// Account of the memory of the pools, nullptr when the memory isn't accounted.
+  rclcpp::MemoryAccount::SharedPtr message_pool_memory_account_;
+
+  /// Set when the serialized messages published are compressed.
+  std::shared_ptr<rclcpp::PayloadCompressor> payload_compressor_;
+
+  using AsyncPublishQueue = rclcpp::detail::AsyncPublishQueue<ROSMessageType>;
+
+  /// Queue of the messages published by the sender thread, nullptr when disabled.
+  std::shared_ptr<AsyncPublishQueue> async_publish_queue_;
+
+  /// Set when the messages published are downsampled.
+  std::shared_ptr<rclcpp::RateLimiter> rate_limiter_;
 };
 
 }  // namespace rclcpp
@@ -18,6 +18,7 @@
 #include <rmw/error_handling.h>
 #include <rmw/rmw.h>
 
+#include <atomic>
 #include <chrono>
 #include <functional>
 #include <iostream>
@@ -34,6 +35,7 @@
 #include "rclcpp/network_flow_endpoint.hpp"
 #include "rclcpp/qos.hpp"
 #include "rclcpp/qos_event.hpp"
+#include "rclcpp/topic_statistics/publisher_topic_statistics.hpp"
 #include "rclcpp/type_support_decl.hpp"
 #include "rclcpp/visibility_control.hpp"
 #include "rcpputils/time.hpp"
@@ -127,6 +129,16 @@ public:
   std::unordered_map<rcl_publisher_event_type_t, std::shared_ptr<rclcpp::QOSEventHandlerBase>> &
   get_event_handlers() const;
 
+  /// Get the waitable dispatching all the QoS events of this publisher.
+  /**
+   * The executors wait for the events of the publisher through this single waitable, rather than
+   * through each handler of get_event_handlers().
+   * \return The waitable, nullptr if there is no event handler.
+   */
+  RCLCPP_PUBLIC
+  std::shared_ptr<rclcpp::CompositeQOSEventHandler>
+  get_composite_event_handler() const;
+
   /// Get subscription count
   /** \return The number of subscriptions. */
   RCLCPP_PUBLIC
@@ -139,6 +151,40 @@ public:
   size_t
   get_intra_process_subscription_count() const;
 
+  /// Return true if subscriptions of other processes are matched with this publisher.
+  /**
+   * The subscriptions of the other processes are the ones counted by get_subscription_count()
+   * but not by get_intra_process_subscription_count().
+   * The middleware keeps the matched subscriptions up to date as they are discovered, so that
+   * this is cheap enough to be checked before building each message: with a volatile
+   * durability, the message is lost unless this or has_intra_process_subscriptions() is true.
+   * \return true if the messages published would be sent to other processes.
+   */
+  RCLCPP_PUBLIC
+  bool
+  has_inter_process_subscriptions() const;
+
+  /// Return true if intra process subscriptions are matched with this publisher.
+  RCLCPP_PUBLIC
+  bool
+  has_intra_process_subscriptions() const;
+
+  /// Return true if the messages published without matched subscriptions are skipped.
+  /**
+   * \sa rclcpp::PublisherOptionsBase::skip_publish_without_subscriptions
+   */
+  RCLCPP_PUBLIC
+  bool
+  skips_publish_without_subscriptions() const;
+
+  /// Return the number of publish calls skipped as no subscription was matched.
+  /**
+   * A batch of messages skipped together counts once.
+   */
+  RCLCPP_PUBLIC
+  uint64_t
+  get_skipped_publish_count() const;
+
   /// Manually assert that this Publisher is alive (for RMW_QOS_POLICY_LIVELINESS_MANUAL_BY_TOPIC).
   /**
    * If the rmw Liveliness policy is set to RMW_QOS_POLICY_LIVELINESS_MANUAL_BY_TOPIC, the creator
@@ -206,6 +252,19 @@ public:
     uint64_t intra_process_publisher_id,
     IntraProcessManagerSharedPtr ipm);
 
+  /// Implementation utility function used to setup the topic statistics after creation.
+  /**
+   * \param[in] topic_stats the statistics measuring the publish calls, nullptr to disable them
+   */
+  RCLCPP_PUBLIC
+  void
+  set_topic_statistics(rclcpp::topic_statistics::PublisherTopicStatistics::SharedPtr topic_stats);
+
+  /// Return the topic statistics of the publisher, nullptr if they are disabled.
+  RCLCPP_PUBLIC
+  rclcpp::topic_statistics::PublisherTopicStatistics::SharedPtr
+  get_topic_statistics() const;
+
   /// Get network flow endpoints
   /**
    * Describes network flow endpoints that this publisher is sending messages out on
@@ -334,17 +393,40 @@ protected:
       publisher_handle_,
       event_type);
     event_handlers_.insert(std::make_pair(event_type, handler));
+    if (!composite_event_handler_) {
+      composite_event_handler_ = std::make_shared<rclcpp::CompositeQOSEventHandler>();
+    }
+    composite_event_handler_->add_handler(handler);
   }
 
   RCLCPP_PUBLIC
   void default_incompatible_qos_callback(QOSOfferedIncompatibleQoSInfo & info) const;
 
+  /// Enable skipping the messages published without matched subscriptions, if requested.
+  /**
+   * It stays disabled unless the actual durability of the publisher is volatile, as the
+   * transient local history must be kept for the late joining subscriptions.
+   */
+  RCLCPP_PUBLIC
+  void
+  set_skip_publish_without_subscriptions(bool skip);
+
+  /// Return true if a message about to be published to other processes should be skipped.
+  /**
+   * This is the case when the skipping is enabled and no subscription of another process is
+   * matched, the skipped message is counted.
+   */
+  RCLCPP_PUBLIC
+  bool
+  skip_inter_process_publish();
+
   std::shared_ptr<rcl_node_t> rcl_node_handle_;
 
   std::shared_ptr<rcl_publisher_t> publisher_handle_;
 
   std::unordered_map<rcl_publisher_event_type_t,
     std::shared_ptr<rclcpp::QOSEventHandlerBase>> event_handlers_;
+  std::shared_ptr<rclcpp::CompositeQOSEventHandler> composite_event_handler_;
 
   using IntraProcessManagerWeakPtr =
     std::weak_ptr<rclcpp::experimental::IntraProcessManager>;
@@ -352,6 +434,13 @@ protected:
   IntraProcessManagerWeakPtr weak_ipm_;
   uint64_t intra_process_publisher_id_;
 
+  /// Set by set_skip_publish_without_subscriptions().
+  bool skip_publish_without_subscriptions_ = false;
+  std::atomic<uint64_t> skipped_publish_count_{0};
+
+  /// Set when the publish calls are measured by topic statistics.
+  rclcpp::topic_statistics::PublisherTopicStatistics::SharedPtr topic_stats_;
+
   rmw_gid_t rmw_gid_;
 
   const rosidl_message_type_support_t type_support_;
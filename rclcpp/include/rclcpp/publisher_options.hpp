@@ -15,6 +15,7 @@
 #ifndef RCLCPP__PUBLISHER_OPTIONS_HPP_
 #define RCLCPP__PUBLISHER_OPTIONS_HPP_
 
+#include <chrono>
 #include <memory>
 #include <string>
 #include <type_traits>
@@ -23,11 +24,16 @@
 #include "rcl/publisher.h"
 
 #include "rclcpp/allocator/allocator_common.hpp"
+#include "rclcpp/allocator/memory_resource.hpp"
+#include "rclcpp/async_publishing.hpp"
 #include "rclcpp/detail/rmw_implementation_specific_publisher_payload.hpp"
 #include "rclcpp/intra_process_setting.hpp"
+#include "rclcpp/payload_compression.hpp"
 #include "rclcpp/qos.hpp"
 #include "rclcpp/qos_event.hpp"
 #include "rclcpp/qos_overriding_options.hpp"
+#include "rclcpp/rate_limit.hpp"
+#include "rclcpp/topic_statistics_state.hpp"
 
 namespace rclcpp
 {
@@ -40,6 +46,90 @@ struct PublisherOptionsBase
   /// Setting to explicitly set intraprocess communications.
   IntraProcessSetting use_intra_process_comm = IntraProcessSetting::NodeDefault;
 
+  /// Number of intra-process message copies kept for reuse by the publisher, 0 to disable.
+  /**
+   * The copies shared by several intra-process subscriptions are recycled once all of
+   * them released the message, see rclcpp::experimental::MessagePool.
+   */
+  size_t intra_process_message_pool_depth = 0;
+
+  /// Whether the intra-process subscriptions share the messages loaned by the middleware.
+  /**
+   * When enabled, a loaned message published while intra-process subscriptions exist is
+   * shared with them without copy, and it's given to the middleware for the subscriptions of
+   * other processes once all of them released it.
+   * Their delivery is then delayed until the intra-process subscriptions are executed.
+   * Otherwise the intra-process subscriptions get a copy of the loaned message.
+   * The messages which aren't loaned by the middleware are always shared.
+   */
+  bool share_loaned_messages_intra_process = false;
+
+  /// Number of messages kept for reuse by borrow_loaned_message(), 0 to disable.
+  /**
+   * When the middleware can not loan messages, the messages "loaned" by the publisher are
+   * taken from a pool instead of being allocated each time, and they go back to the pool once
+   * published or destroyed, see rclcpp::experimental::MessagePool::borrow().
+   * A recycled message keeps the value it had when it was published, so that the memory it
+   * owns is reused, the user must set all of its fields.
+   * The option is ignored when the middleware loans the messages.
+   */
+  size_t loaned_message_pool_depth = 0;
+
+  /// Compression of the serialized messages published, disabled by default.
+  /**
+   * It applies to rclcpp::GenericPublisher and to the serialized messages published by typed
+   * publishers, the intra-process subscriptions always get the uncompressed messages.
+   * The generic subscriptions and the subscriptions configured with
+   * rclcpp::SubscriptionOptionsBase::decompress_payloads decompress them.
+   */
+  PayloadCompressionOptions payload_compression;
+
+  /// Asynchronous publishing to the middleware, disabled by default.
+  /**
+   * When enabled, the messages published to the subscriptions of other processes are queued
+   * and given to the middleware by a sender thread shared by the publishers of the context,
+   * so the publish calls don't wait for the serialization and the transport.
+   * The messages published by reference are copied into the queue, while the ones published
+   * by unique pointer and the ones shared with intra-process subscriptions are queued
+   * without copy.
+   * The intra-process subscriptions, the loaned messages given to the middleware and the
+   * serialized messages are still published on the calling thread.
+   * See rclcpp::Publisher::get_async_publishing_statistics() for the metrics of the queue.
+   */
+  AsyncPublishingOptions async_publishing;
+
+  /// Downsampling of the messages published, disabled by default.
+  /**
+   * The messages dropped aren't sent to any subscription, and the publish calls return
+   * without copying nor serializing them.
+   * RateLimitPolicy::LatestPerInterval isn't supported, as it would delay the messages.
+   * See rclcpp::Publisher::get_rate_limiter() for the number of messages dropped.
+   */
+  RateLimitOptions rate_limit;
+
+  /// Whether the intra-process messages published carry a flow, disabled by default.
+  /**
+   * The messages continue the flow current on the publishing thread, e.g. the one of the
+   * message whose callback publishes them, otherwise each starts a new flow, see
+   * rclcpp::MessageLineage.
+   * The subscriptions with rclcpp::SubscriptionOptionsBase::track_lineage get it in the
+   * rclcpp::MessageInfo and measure the latency from its origin.
+   * The messages of a rclcpp::Publisher::publish_batch() call share a flow.
+   */
+  bool propagate_lineage = false;
+
+  /// Skip publishing to the middleware while no subscription of another process is matched.
+  /**
+   * The message isn't serialized nor converted from a type adapted one for the middleware
+   * then, it is still given to the intra process subscriptions.
+   * The subscriptions of other processes are matched by the middleware as they are discovered,
+   * see rclcpp::PublisherBase::has_inter_process_subscriptions().
+   * The option is ignored unless the durability is volatile, as the transient local history
+   * must be kept for the late joining subscriptions.
+   * A skipped message doesn't assert the liveliness of the publisher.
+   */
+  bool skip_publish_without_subscriptions = false;
+
   /// Callbacks for various events related to publishers.
   PublisherEventCallbacks event_callbacks;
 
@@ -58,6 +148,24 @@ struct PublisherOptionsBase
   std::shared_ptr<rclcpp::detail::RMWImplementationSpecificPublisherPayload>
   rmw_implementation_payload = nullptr;
 
+  // Options to configure topic statistics collection in the publisher.
+  struct TopicStatisticsOptions
+  {
+    // Enable and disable topic statistics calculation and publication. Defaults to disabled,
+    // NodeDefault follows rclcpp::NodeOptions::enable_topic_statistics().
+    TopicStatisticsState state = TopicStatisticsState::Disable;
+
+    // Topic to which topic statistics get published when enabled. Defaults to /statistics.
+    std::string publish_topic = "/statistics";
+
+    // Topic statistics publication period in ms. Defaults to one second.
+    // Only values greater than zero are allowed.
+    std::chrono::milliseconds publish_period{std::chrono::seconds(1)};
+  };
+
+  /// Statistics of the publish calls, see rclcpp::topic_statistics::PublisherTopicStatistics.
+  TopicStatisticsOptions topic_stats_options;
+
   QosOverridingOptions qos_overriding_options;
 };
 
@@ -137,6 +245,17 @@ private:
 
 using PublisherOptions = PublisherOptionsWithAllocator<std::allocator<void>>;
 
+/// Publisher options allocating from a std::pmr::memory_resource chosen at runtime.
+/**
+ * Every publisher using it shares the same template instantiation whatever its memory
+ * resource, which is given with
+ * `options.allocator = std::make_shared<rclcpp::allocator::MemoryResourceAllocator<>>(resource)`.
+ * See rclcpp::allocator::create_memory_resource() to create the resource from a configuration,
+ * and rclcpp::allocator::HugePageMemoryResource for the large intra-process messages.
+ */
+using PublisherOptionsWithMemoryResource =
+  PublisherOptionsWithAllocator<rclcpp::allocator::MemoryResourceAllocator<>>;
+
 }  // namespace rclcpp
 
 #endif  // RCLCPP__PUBLISHER_OPTIONS_HPP_
@@ -20,6 +20,9 @@
 #include <mutex>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "rcl/error_handling.h"
 #include "rcl/event_callback.h"
@@ -30,8 +33,10 @@
 
 #include "rclcpp/detail/cpp_callback_trampoline.hpp"
 #include "rclcpp/exceptions.hpp"
+#include "rclcpp/flight_recorder.hpp"
 #include "rclcpp/function_traits.hpp"
 #include "rclcpp/logging.hpp"
+#include "rclcpp/macros.hpp"
 #include "rclcpp/waitable.hpp"
 
 namespace rclcpp
@@ -275,6 +280,12 @@ public:
       throw std::runtime_error("'data' is empty");
     }
     auto callback_ptr = std::static_pointer_cast<EventCallbackInfoT>(data);
+    if constexpr (
+      std::is_same_v<EventCallbackInfoT, QOSDeadlineRequestedInfo> ||
+      std::is_same_v<EventCallbackInfoT, QOSDeadlineOfferedInfo>)
+    {
+      rclcpp::FlightRecorder::on_deadline_missed(this, callback_ptr->total_count);
+    }
     event_callback_(*callback_ptr);
     callback_ptr.reset();
   }
@@ -287,6 +298,85 @@ private:
   EventCallbackT event_callback_;
 };
 
+/// Waitable dispatching all the QOS events of an entity, instead of one waitable per event.
+/**
+ * The handlers keep their own rcl event, which takes a slot of the wait set, but the executor
+ * only tracks and checks this waitable, which executes the callbacks of all the events which
+ * fired with a single readiness check.
+ *
+ * With the listener APIs, e.g. with the EventsExecutor, the identifier given to the on ready
+ * callback is the index of the handler of the event, see get_handlers().
+ */
+class CompositeQOSEventHandler : public Waitable
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(CompositeQOSEventHandler)
+
+  RCLCPP_PUBLIC
+  virtual ~CompositeQOSEventHandler();
+
+  /// Add the handler of an event, not thread-safe, only done while creating the entity.
+  RCLCPP_PUBLIC
+  void
+  add_handler(std::shared_ptr<QOSEventHandlerBase> handler);
+
+  /// Return the handlers of the events, in the order they were added.
+  RCLCPP_PUBLIC
+  const std::vector<std::shared_ptr<QOSEventHandlerBase>> &
+  get_handlers() const;
+
+  /// Get the number of events of all the handlers.
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_ready_events() override;
+
+  /// Add the events of all the handlers to a wait set.
+  RCLCPP_PUBLIC
+  void
+  add_to_wait_set(rcl_wait_set_t * wait_set) override;
+
+  /// Check if any of the events is ready, remembering which ones are.
+  RCLCPP_PUBLIC
+  bool
+  is_ready(rcl_wait_set_t * wait_set) override;
+
+  /// Take the info of each ready event.
+  RCLCPP_PUBLIC
+  std::shared_ptr<void>
+  take_data() override;
+
+  /// Take the info of the event of the handler at the given index.
+  RCLCPP_PUBLIC
+  std::shared_ptr<void>
+  take_data_by_entity_id(size_t id) override;
+
+  /// Call the callbacks of the events whose info was taken.
+  RCLCPP_PUBLIC
+  void
+  execute(std::shared_ptr<void> & data) override;
+
+  /// Set the on ready callback of all the handlers, with the index of each as identifier.
+  /**
+   * \sa rclcpp::QOSEventHandlerBase::set_on_ready_callback
+   */
+  RCLCPP_PUBLIC
+  void
+  set_on_ready_callback(std::function<void(size_t, int)> callback) override;
+
+  /// Unset the on ready callback of all the handlers.
+  RCLCPP_PUBLIC
+  void
+  clear_on_ready_callback() override;
+
+private:
+  /// Info taken from the event of each handler, by index of the handler.
+  using TakenEvents = std::vector<std::pair<size_t, std::shared_ptr<void>>>;
+
+  std::vector<std::shared_ptr<QOSEventHandlerBase>> handlers_;
+  /// Indexes of the handlers found ready by the last call to is_ready().
+  std::vector<size_t> ready_handlers_;
+};
+
 }  // namespace rclcpp
 
 #endif  // RCLCPP__QOS_EVENT_HPP_
@@ -15,7 +15,9 @@
 #ifndef RCLCPP__RATE_HPP_
 #define RCLCPP__RATE_HPP_
 
+#include <algorithm>
 #include <chrono>
+#include <cstdint>
 #include <memory>
 #include <thread>
 
@@ -41,6 +43,21 @@ using std::chrono::duration;
 using std::chrono::duration_cast;
 using std::chrono::nanoseconds;
 
+/// Statistics of the cycles of a rate which missed their deadline.
+struct RateOverrunStatistics
+{
+  /// Number of calls to sleep().
+  uint64_t cycles = 0;
+  /// Number of calls to sleep() after the deadline of the cycle.
+  uint64_t overruns = 0;
+  /// Number of whole periods skipped after the overruns.
+  uint64_t missed_periods = 0;
+  /// Longest delay of a call to sleep() past the deadline of the cycle.
+  std::chrono::nanoseconds max_overrun{0};
+  /// Longest delay of the end of a sleep past the deadline of the cycle.
+  std::chrono::nanoseconds max_wakeup_latency{0};
+};
+
 template<class Clock = std::chrono::high_resolution_clock>
 class GenericRate : public RateBase
 {
@@ -71,19 +88,44 @@ public:
     auto time_to_sleep = next_interval - now;
     // Update the interval
     last_interval_ += period_;
+    ++overrun_statistics_.cycles;
     // If the time_to_sleep is negative or zero, don't sleep
     if (time_to_sleep <= std::chrono::seconds(0)) {
+      ++overrun_statistics_.overruns;
+      overrun_statistics_.max_overrun = std::max(
+        overrun_statistics_.max_overrun, duration_cast<nanoseconds>(now - next_interval));
       // If an entire cycle was missed then reset next interval.
       // This might happen if the loop took more than a cycle.
       // Or if time jumps forward.
       if (now > next_interval + period_) {
-        last_interval_ = now + period_;
+        const auto missed_periods = (now - next_interval) / period_;
+        overrun_statistics_.missed_periods += static_cast<uint64_t>(missed_periods);
+        if (busy_wait_threshold_ > nanoseconds::zero()) {
+          // Skip the missed periods without shifting the next deadlines
+          last_interval_ += missed_periods * period_;
+        } else {
+          last_interval_ = now + period_;
+        }
       }
       // Either way do not sleep and return false
       return false;
     }
-    // Sleep (will get interrupted by ctrl-c, may not sleep full time)
-    rclcpp::sleep_for(time_to_sleep);
+    if (busy_wait_threshold_ > nanoseconds::zero()) {
+      // Sleep until shortly before the deadline, and busy-wait the rest to not be woken late
+      if (time_to_sleep > busy_wait_threshold_) {
+        rclcpp::sleep_for(time_to_sleep - busy_wait_threshold_);
+      }
+      const auto spin_start = Clock::now();
+      for (auto spin_now = spin_start; spin_now < next_interval && spin_now >= spin_start; ) {
+        spin_now = Clock::now();
+      }
+    } else {
+      // Sleep (will get interrupted by ctrl-c, may not sleep full time)
+      rclcpp::sleep_for(time_to_sleep);
+    }
+    overrun_statistics_.max_wakeup_latency = std::max(
+      overrun_statistics_.max_wakeup_latency,
+      duration_cast<nanoseconds>(Clock::now() - next_interval));
     return true;
   }
 
@@ -104,10 +146,45 @@ public:
     return period_;
   }
 
+  /// Busy-wait the end of each sleep, to follow the deadlines more closely.
+  /**
+   * sleep() sleeps until the threshold before the deadline, and busy-waits from there, so the
+   * delay of the operating system to wake the thread up isn't added to the cycle.
+   * The periods missed by a cycle are skipped without shifting the next deadlines.
+   *
+   * \param[in] threshold time busy-waited before each deadline, zero to only sleep.
+   */
+  void
+  set_busy_wait_threshold(std::chrono::nanoseconds threshold)
+  {
+    busy_wait_threshold_ = std::max(threshold, nanoseconds::zero());
+  }
+
+  std::chrono::nanoseconds
+  get_busy_wait_threshold() const
+  {
+    return busy_wait_threshold_;
+  }
+
+  /// Return the statistics of the cycles since construction or reset_overrun_statistics().
+  const RateOverrunStatistics &
+  get_overrun_statistics() const
+  {
+    return overrun_statistics_;
+  }
+
+  void
+  reset_overrun_statistics()
+  {
+    overrun_statistics_ = RateOverrunStatistics();
+  }
+
 private:
   RCLCPP_DISABLE_COPY(GenericRate)
 
   std::chrono::nanoseconds period_;
+  std::chrono::nanoseconds busy_wait_threshold_{0};
+  RateOverrunStatistics overrun_statistics_;
   using ClockDurationNano = std::chrono::duration<typename Clock::rep, std::nano>;
   std::chrono::time_point<Clock, ClockDurationNano> last_interval_;
 };
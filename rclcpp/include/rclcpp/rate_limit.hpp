@@ -0,0 +1,139 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__RATE_LIMIT_HPP_
+#define RCLCPP__RATE_LIMIT_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// How the messages of a topic are thinned out, see RateLimitOptions.
+enum class RateLimitPolicy
+{
+  /// Keep all the messages.
+  Disabled,
+  /// Keep a message if at least 1 / max_frequency elapsed since the last one kept.
+  MaxFrequency,
+  /// Keep one message out of keep_every_nth.
+  KeepEveryNth,
+  /// Keep the newest message once per interval of 1 / max_frequency.
+  /**
+   * Only subscriptions support it: when an interval elapsed, the messages queued by the
+   * middleware meanwhile are skipped, without being deserialized, and the newest one is kept.
+   * The intra-process messages are limited like with MaxFrequency.
+   */
+  LatestPerInterval,
+};
+
+/// Options of the rate limit of a publisher or a subscription.
+/**
+ * See rclcpp::PublisherOptionsBase::rate_limit and rclcpp::SubscriptionOptionsBase::rate_limit.
+ */
+struct RateLimitOptions
+{
+  RateLimitPolicy policy = RateLimitPolicy::Disabled;
+
+  /// Maximum number of messages kept per second, for MaxFrequency and LatestPerInterval.
+  double max_frequency = 0.0;
+
+  /// Keep one message out of this many, for KeepEveryNth.
+  size_t keep_every_nth = 1;
+};
+
+/// Decide which messages a rate limit keeps, and count them.
+/**
+ * It's thread-safe, the decisions of concurrent calls are made one at a time.
+ */
+class RateLimiter
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(RateLimiter)
+
+  using Clock = std::chrono::steady_clock;
+
+  /// Constructor.
+  /**
+   * \param[in] options the rate limit, not disabled.
+   * \throws std::invalid_argument if the policy is disabled, if max_frequency isn't positive
+   *   for MaxFrequency and LatestPerInterval, or if keep_every_nth is 0 for KeepEveryNth.
+   */
+  RCLCPP_PUBLIC
+  explicit RateLimiter(const RateLimitOptions & options);
+
+  /// Decide if a message is kept and count it.
+  /**
+   * \param[in] now the time the message is published or received.
+   * \return true if the message is kept.
+   */
+  RCLCPP_PUBLIC
+  bool
+  try_keep(Clock::time_point now = Clock::now());
+
+  /// Return true if the next message would be kept, without counting it.
+  /**
+   * The message is counted afterwards with on_kept() or on_dropped().
+   */
+  RCLCPP_PUBLIC
+  bool
+  is_due(Clock::time_point now = Clock::now()) const;
+
+  /// Count a message kept after is_due() returned true.
+  RCLCPP_PUBLIC
+  void
+  on_kept(Clock::time_point now = Clock::now());
+
+  /// Count a message dropped after is_due() returned false.
+  RCLCPP_PUBLIC
+  void
+  on_dropped();
+
+  RCLCPP_PUBLIC
+  const RateLimitOptions &
+  get_options() const;
+
+  /// Return the number of messages kept.
+  RCLCPP_PUBLIC
+  uint64_t
+  get_kept_count() const;
+
+  /// Return the number of messages dropped.
+  RCLCPP_PUBLIC
+  uint64_t
+  get_dropped_count() const;
+
+private:
+  const RateLimitOptions options_;
+  const int64_t period_ns_;
+
+  /// Time since the clock epoch from which the next message is kept, for the time policies.
+  std::atomic<int64_t> next_due_ns_{std::numeric_limits<int64_t>::min()};
+  /// Number of messages counted, for KeepEveryNth.
+  std::atomic<uint64_t> message_count_{0};
+
+  std::atomic<uint64_t> kept_count_{0};
+  std::atomic<uint64_t> dropped_count_{0};
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__RATE_LIMIT_HPP_
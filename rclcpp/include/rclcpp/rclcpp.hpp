@@ -54,9 +54,11 @@
  *   - rclcpp::ParameterValue
  *   - rclcpp::AsyncParametersClient
  *   - rclcpp::SyncParametersClient
+ *   - rclcpp::MultiNodeParametersClient
  *   - rclcpp/parameter.hpp
  *   - rclcpp/parameter_value.hpp
  *   - rclcpp/parameter_client.hpp
+ *   - rclcpp/multi_node_parameters_client.hpp
  *   - rclcpp/parameter_service.hpp
  * - Rate:
  *   - rclcpp::Rate
@@ -153,11 +155,14 @@
 #include <memory>
 
 #include "rclcpp/executors.hpp"
+#include "rclcpp/extern_templates.hpp"
 #include "rclcpp/guard_condition.hpp"
 #include "rclcpp/logging.hpp"
+#include "rclcpp/multi_node_parameters_client.hpp"
 #include "rclcpp/node.hpp"
 #include "rclcpp/parameter_client.hpp"
 #include "rclcpp/parameter_event_handler.hpp"
+#include "rclcpp/parameter_handle.hpp"
 #include "rclcpp/parameter.hpp"
 #include "rclcpp/parameter_service.hpp"
 #include "rclcpp/rate.hpp"
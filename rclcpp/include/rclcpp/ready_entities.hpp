@@ -0,0 +1,117 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__READY_ENTITIES_HPP_
+#define RCLCPP__READY_ENTITIES_HPP_
+
+#include <memory>
+#include <vector>
+
+#include "rcl/wait.h"
+
+#include "rclcpp/client.hpp"
+#include "rclcpp/guard_condition.hpp"
+#include "rclcpp/service.hpp"
+#include "rclcpp/subscription_base.hpp"
+#include "rclcpp/timer.hpp"
+#include "rclcpp/waitable.hpp"
+
+namespace rclcpp
+{
+
+/// Indices of the slots of a rcl wait set which are ready after waiting.
+/**
+ * The indices are collected once after rcl_wait(), so that the ready entities can be
+ * dispatched without testing every slot of the rcl wait set again.
+ * The vectors keep their capacity between collections, so collecting doesn't allocate once
+ * the number of ready entities has been reached before.
+ */
+struct ReadyIndices
+{
+  std::vector<size_t> subscriptions;
+  std::vector<size_t> guard_conditions;
+  std::vector<size_t> timers;
+  std::vector<size_t> clients;
+  std::vector<size_t> services;
+
+  /// Collect the indices of the non null slots of the given rcl wait set.
+  void
+  collect(const rcl_wait_set_t & wait_set)
+  {
+    auto collect_slots = [](const auto * slots, size_t size_of_slots, std::vector<size_t> & out) {
+        out.clear();
+        for (size_t i = 0; i < size_of_slots; ++i) {
+          if (slots[i]) {
+            out.push_back(i);
+          }
+        }
+      };
+    collect_slots(wait_set.subscriptions, wait_set.size_of_subscriptions, subscriptions);
+    collect_slots(wait_set.guard_conditions, wait_set.size_of_guard_conditions, guard_conditions);
+    collect_slots(wait_set.timers, wait_set.size_of_timers, timers);
+    collect_slots(wait_set.clients, wait_set.size_of_clients, clients);
+    collect_slots(wait_set.services, wait_set.size_of_services, services);
+  }
+
+  /// Return true if no slot was ready.
+  bool
+  empty() const
+  {
+    return
+      subscriptions.empty() && guard_conditions.empty() && timers.empty() && clients.empty() &&
+      services.empty();
+  }
+};
+
+/// Entities of a wait set which are ready after waiting.
+/**
+ * The entities are in the order they were added to the wait set.
+ * The guard conditions used internally by the wait set, e.g. to interrupt the wait, are not
+ * part of the ready guard conditions.
+ * The waitables are the ones for which rclcpp::Waitable::is_ready() returned true.
+ */
+struct ReadyEntities
+{
+  std::vector<std::shared_ptr<rclcpp::SubscriptionBase>> subscriptions;
+  std::vector<std::shared_ptr<rclcpp::GuardCondition>> guard_conditions;
+  std::vector<std::shared_ptr<rclcpp::TimerBase>> timers;
+  std::vector<std::shared_ptr<rclcpp::ClientBase>> clients;
+  std::vector<std::shared_ptr<rclcpp::ServiceBase>> services;
+  std::vector<std::shared_ptr<rclcpp::Waitable>> waitables;
+
+  /// Remove the entities, keeping the capacity of the vectors.
+  void
+  clear()
+  {
+    subscriptions.clear();
+    guard_conditions.clear();
+    timers.clear();
+    clients.clear();
+    services.clear();
+    waitables.clear();
+  }
+
+  /// Return true if no entity is ready.
+  bool
+  empty() const
+  {
+    return
+      subscriptions.empty() && guard_conditions.empty() && timers.empty() && clients.empty() &&
+      services.empty() && waitables.empty();
+  }
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__READY_ENTITIES_HPP_
@@ -0,0 +1,53 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__ROSOUT_BATCHING_HPP_
+#define RCLCPP__ROSOUT_BATCHING_HPP_
+
+#include <chrono>
+#include <cstddef>
+
+namespace rclcpp
+{
+
+/// Options of the /rosout publisher shared by the nodes of a context, see InitOptions.
+/**
+ * They apply to the nodes using the shared publishers, see NodeOptions::use_shared_publishers().
+ *
+ * When batching, the consecutive log messages of a logger with the same severity are joined
+ * into a single rcl_interfaces::msg::Log, one line each, with the time stamp and the location
+ * of the first one.
+ * A batch is published by a background thread once the window elapsed since its first message,
+ * or once it holds max_batch_size messages.
+ * The batches still pending when the context is shut down are dropped.
+ *
+ * When rate limiting, the log messages of a logger beyond max_messages_per_second in a second
+ * aren't published, a warning with the number of messages suppressed is published instead once
+ * the second elapsed.
+ */
+struct RosoutBatchingOptions
+{
+  /// Longest time a log message waits for the next ones of its batch, 0 disables the batching.
+  std::chrono::milliseconds window{0};
+
+  /// Number of log messages after which a batch is published before its window elapsed.
+  size_t max_batch_size = 32;
+
+  /// Number of log messages of a logger published per second, 0 doesn't limit them.
+  size_t max_messages_per_second = 0;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__ROSOUT_BATCHING_HPP_
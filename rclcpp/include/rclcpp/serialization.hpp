@@ -15,9 +15,11 @@
 #ifndef RCLCPP__SERIALIZATION_HPP_
 #define RCLCPP__SERIALIZATION_HPP_
 
+#include <cstddef>
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 #include "rclcpp/visibility_control.hpp"
 
@@ -74,6 +76,61 @@ public:
   void deserialize_message(
     const SerializedMessage * serialized_message, void * ros_message) const;
 
+  /// Serialize a sequence of ROS2 messages, each one to its own serialized message
+  /**
+   * The serialized messages keep their capacity from previous calls, so reusing them for every
+   * batch avoids growing the buffers once they reached the size of the largest message.
+   * Empty serialized messages are reserved with get_serialized_size_hint() first.
+   *
+   * \param[in] ros_messages The ROS2 messages which are read and serialized by rmw.
+   * \param[in] count The number of messages.
+   * \param[out] serialized_messages At least `count` serialized messages.
+   */
+  void serialize_messages(
+    const void * const * ros_messages, size_t count,
+    SerializedMessage * serialized_messages) const;
+
+  /// Serialize a sequence of ROS2 messages into one contiguous framed buffer
+  /**
+   * Each message is written as a frame made of an 8 byte header, holding the little endian
+   * 32 bit size of the serialized message, followed by the serialized message padded to a
+   * multiple of 8 bytes, so that every frame stays aligned within the buffer.
+   * The buffer is overwritten, its capacity is kept and grows geometrically when needed.
+   *
+   * \param[in] ros_messages The ROS2 messages which are read and serialized by rmw.
+   * \param[in] count The number of messages.
+   * \param[out] serialized_buffer The framed buffer.
+   */
+  void serialize_messages_framed(
+    const void * const * ros_messages, size_t count,
+    SerializedMessage * serialized_buffer) const;
+
+  /// Deserialize the messages of a framed buffer created by serialize_messages_framed()
+  /**
+   * The frames are deserialized in place, without copying them out of the buffer.
+   *
+   * \param[in] serialized_buffer The framed buffer.
+   * \param[out] ros_messages The deserialized ROS2 messages.
+   * \param[in] count The number of messages, which must match get_framed_message_count().
+   * \throws std::invalid_argument if the buffer is malformed or holds another number of frames.
+   */
+  void deserialize_messages_framed(
+    const SerializedMessage * serialized_buffer, void * const * ros_messages,
+    size_t count) const;
+
+  /// Return the number of messages in a framed buffer created by serialize_messages_framed()
+  /**
+   * \throws std::invalid_argument if the buffer is malformed.
+   */
+  static size_t get_framed_message_count(const SerializedMessage * serialized_buffer);
+
+  /// Return the capacity to reserve for serializing one message of this type
+  /**
+   * The hint is the serialized size bound reported by rmw for the type support, or zero when
+   * the type is unbounded or the rmw implementation doesn't support computing it.
+   */
+  size_t get_serialized_size_hint() const;
+
 private:
   const rosidl_message_type_support_t * type_support_;
 };
@@ -91,6 +148,59 @@ public:
       !serialization_traits::is_serialized_message_class<MessageT>::value,
       "Serialization of serialized message to serialized message is not possible.");
   }
+
+  using SerializationBase::serialize_messages;
+  using SerializationBase::serialize_messages_framed;
+  using SerializationBase::deserialize_messages_framed;
+
+  /// Serialize messages to reusable serialized messages, resizing them to the number of messages
+  template<typename AllocatorT, typename SerializedAllocatorT>
+  void serialize_messages(
+    const std::vector<MessageT, AllocatorT> & ros_messages,
+    std::vector<SerializedMessage, SerializedAllocatorT> & serialized_messages) const
+  {
+    serialized_messages.resize(ros_messages.size());
+    const auto pointers = get_pointers(ros_messages);
+    serialize_messages(pointers.data(), pointers.size(), serialized_messages.data());
+  }
+
+  /// Serialize messages into one framed buffer
+  template<typename AllocatorT>
+  void serialize_messages_framed(
+    const std::vector<MessageT, AllocatorT> & ros_messages,
+    SerializedMessage & serialized_buffer) const
+  {
+    const auto pointers = get_pointers(ros_messages);
+    serialize_messages_framed(pointers.data(), pointers.size(), &serialized_buffer);
+  }
+
+  /// Deserialize the messages of a framed buffer, resizing the vector to the number of frames
+  template<typename AllocatorT>
+  void deserialize_messages_framed(
+    const SerializedMessage & serialized_buffer,
+    std::vector<MessageT, AllocatorT> & ros_messages) const
+  {
+    ros_messages.resize(get_framed_message_count(&serialized_buffer));
+    std::vector<void *> pointers;
+    pointers.reserve(ros_messages.size());
+    for (auto & ros_message : ros_messages) {
+      pointers.push_back(&ros_message);
+    }
+    deserialize_messages_framed(&serialized_buffer, pointers.data(), pointers.size());
+  }
+
+private:
+  template<typename AllocatorT>
+  static std::vector<const void *>
+  get_pointers(const std::vector<MessageT, AllocatorT> & ros_messages)
+  {
+    std::vector<const void *> pointers;
+    pointers.reserve(ros_messages.size());
+    for (const auto & ros_message : ros_messages) {
+      pointers.push_back(&ros_message);
+    }
+    return pointers;
+  }
 };
 
 }  // namespace rclcpp
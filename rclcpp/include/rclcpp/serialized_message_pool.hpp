@@ -0,0 +1,93 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__SERIALIZED_MESSAGE_POOL_HPP_
+#define RCLCPP__SERIALIZED_MESSAGE_POOL_HPP_
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/serialized_message.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// Reuse the serialized messages taken by a subscription, keeping the capacity of their buffer.
+/**
+ * A message given back is kept, up to `depth` messages, unless it's still referenced elsewhere,
+ * e.g. by a callback queuing it.
+ * The kept messages are emptied, but their buffer isn't shrunk, so once a buffer grew to the
+ * size of the messages of the topic the next takes don't allocate.
+ *
+ * All public member functions are thread-safe.
+ */
+class SerializedMessagePool
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(SerializedMessagePool)
+
+  /// Default number of free messages kept by a pool.
+  static constexpr size_t default_depth = 4;
+
+  /// Create a pool keeping up to `depth` free messages.
+  /**
+   * \param[in] depth the maximum number of free messages kept, zero disables the pool.
+   */
+  RCLCPP_PUBLIC
+  explicit SerializedMessagePool(size_t depth = default_depth);
+
+  /// Return an empty serialized message, a free one when available.
+  /**
+   * \param[in] capacity the minimum capacity of the buffer of the message.
+   */
+  RCLCPP_PUBLIC
+  std::shared_ptr<rclcpp::SerializedMessage>
+  acquire(size_t capacity = 0);
+
+  /// Give back a message returned by acquire().
+  /**
+   * \param[inout] message the message, reset by this call.
+   */
+  RCLCPP_PUBLIC
+  void
+  release(std::shared_ptr<rclcpp::SerializedMessage> & message);
+
+  /// Return the number of free messages kept by the pool.
+  RCLCPP_PUBLIC
+  size_t
+  get_free_count() const;
+
+  /// Return the sum of the capacities of the buffers of the free messages, in bytes.
+  RCLCPP_PUBLIC
+  size_t
+  get_free_capacity() const;
+
+  /// Return the number of messages which had to be allocated by acquire().
+  RCLCPP_PUBLIC
+  size_t
+  get_allocation_count() const;
+
+private:
+  const size_t depth_;
+  mutable std::mutex mutex_;
+  std::vector<std::shared_ptr<rclcpp::SerializedMessage>> free_messages_;
+  size_t allocation_count_{0};
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__SERIALIZED_MESSAGE_POOL_HPP_
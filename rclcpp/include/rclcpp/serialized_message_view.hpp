@@ -0,0 +1,120 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__SERIALIZED_MESSAGE_VIEW_HPP_
+#define RCLCPP__SERIALIZED_MESSAGE_VIEW_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "rcl/types.h"
+#include "rcutils/allocator.h"
+#include "rmw/serialized_message.h"
+
+#include "rclcpp/serialized_message.hpp"
+
+namespace rclcpp
+{
+
+/// Read-only view of a serialized message, which doesn't own its buffer.
+/**
+ * The view is only valid as long as the buffer it was created from, e.g. for the duration of
+ * the callback it is given to.
+ * The data must be copied, e.g. in a rclcpp::SerializedMessage, to be kept after that.
+ */
+class SerializedMessageView
+{
+public:
+  /// Default constructor for an empty view.
+  SerializedMessageView() = default;
+
+  /// Constructor for a view of the given bytes.
+  SerializedMessageView(const uint8_t * data, size_t size)
+  : data_(data), size_(size)
+  {}
+
+  /// Constructor for a view of the serialized data of a rcl serialized message.
+  explicit SerializedMessageView(const rcl_serialized_message_t & serialized_message)
+  : SerializedMessageView(serialized_message.buffer, serialized_message.buffer_length)
+  {}
+
+  /// Constructor for a view of the serialized data of a rclcpp::SerializedMessage.
+  explicit SerializedMessageView(const rclcpp::SerializedMessage & serialized_message)
+  : SerializedMessageView(serialized_message.get_rcl_serialized_message())
+  {}
+
+  /// Return the first byte of the serialized data.
+  const uint8_t *
+  data() const
+  {
+    return data_;
+  }
+
+  /// Return the size of the serialized data in bytes.
+  size_t
+  size() const
+  {
+    return size_;
+  }
+
+  /// Return if the view is empty.
+  bool
+  empty() const
+  {
+    return 0u == size_;
+  }
+
+  const uint8_t *
+  begin() const
+  {
+    return data_;
+  }
+
+  const uint8_t *
+  end() const
+  {
+    return data_ + size_;
+  }
+
+  uint8_t
+  operator[](size_t index) const
+  {
+    return data_[index];
+  }
+
+  /// Return a rcl serialized message referring to the viewed data.
+  /**
+   * The returned message must not be resized nor finalized, it can only be read, e.g. to
+   * publish it or to copy it in a rclcpp::SerializedMessage.
+   */
+  rcl_serialized_message_t
+  get_rcl_serialized_message() const
+  {
+    rcl_serialized_message_t serialized_message = rmw_get_zero_initialized_serialized_message();
+    serialized_message.buffer = const_cast<uint8_t *>(data_);
+    serialized_message.buffer_length = size_;
+    serialized_message.buffer_capacity = size_;
+    serialized_message.allocator = rcutils_get_default_allocator();
+    return serialized_message;
+  }
+
+private:
+  const uint8_t * data_ = nullptr;
+  size_t size_ = 0u;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__SERIALIZED_MESSAGE_VIEW_HPP_
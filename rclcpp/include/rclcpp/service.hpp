@@ -21,7 +21,9 @@
 #include <memory>
 #include <mutex>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <utility>
 
 #include "rcl/error_handling.h"
 #include "rcl/event_callback.h"
@@ -34,14 +36,19 @@
 #include "tracetools/tracetools.h"
 
 #include "rclcpp/any_service_callback.hpp"
+#include "rclcpp/context.hpp"
 #include "rclcpp/detail/cpp_callback_trampoline.hpp"
 #include "rclcpp/exceptions.hpp"
 #include "rclcpp/expand_topic_or_service_name.hpp"
+#include "rclcpp/experimental/intra_process_service_manager.hpp"
+#include "rclcpp/experimental/service_intra_process.hpp"
 #include "rclcpp/logging.hpp"
 #include "rclcpp/macros.hpp"
 #include "rclcpp/qos.hpp"
+#include "rclcpp/service_concurrency.hpp"
 #include "rclcpp/type_support_decl.hpp"
 #include "rclcpp/visibility_control.hpp"
+#include "rclcpp/waitable.hpp"
 
 namespace rclcpp
 {
@@ -114,6 +121,17 @@ public:
     std::shared_ptr<rmw_request_id_t> request_header,
     std::shared_ptr<void> request) = 0;
 
+  /// Return the waitable receiving the requests of the clients in the same context.
+  /**
+   * \return the waitable, or nullptr if intra-process communication isn't setup.
+   */
+  virtual
+  rclcpp::Waitable::SharedPtr
+  get_intra_process_waitable() const
+  {
+    return nullptr;
+  }
+
   /// Exchange the "in use by wait set" state for this service.
   /**
    * This is used to ensure this service is not used by multiple
@@ -290,6 +308,9 @@ public:
       const std::shared_ptr<rmw_request_id_t>,
       const std::shared_ptr<typename ServiceT::Request>,
       std::shared_ptr<typename ServiceT::Response>)>;
+
+  using ServiceIntraProcessT = rclcpp::experimental::ServiceIntraProcess<ServiceT>;
+
   RCLCPP_SMART_PTR_DEFINITIONS(Service)
 
   /// Default constructor.
@@ -433,6 +454,51 @@ public:
 
   virtual ~Service()
   {
+    auto ipsm = weak_ipsm_.lock();
+    if (ipsm && service_intra_process_) {
+      ipsm->remove_service(intra_process_service_id_);
+    }
+  }
+
+  /// Receive by pointer the requests of the clients in the same context.
+  /**
+   * Called by rclcpp::create_service() when the node uses intra-process communication.
+   * The clients of the same context using intra-process communication then give their
+   * requests by pointer, and get the response object without going through the middleware.
+   * The requests of the other clients are received from the middleware as usual.
+   *
+   * \param[in] context the context of the node of the service.
+   * \throws std::runtime_error if intra-process communication is already setup.
+   */
+  void
+  setup_intra_process(rclcpp::Context::SharedPtr context)
+  {
+    if (service_intra_process_) {
+      throw std::runtime_error("intra-process communication is already setup for this service");
+    }
+    using rclcpp::experimental::IntraProcessServiceManager;
+    auto ipsm = context->get_sub_context<IntraProcessServiceManager>();
+    std::weak_ptr<Service<ServiceT>> weak_this = this->shared_from_this();
+    service_intra_process_ = std::make_shared<ServiceIntraProcessT>(
+      [weak_this](
+        std::shared_ptr<rmw_request_id_t> request_header,
+        std::shared_ptr<typename ServiceT::Request> request)
+      {
+        auto service = weak_this.lock();
+        if (service) {
+          service->handle_request(std::move(request_header), std::move(request));
+        }
+      },
+      context,
+      get_service_name());
+    intra_process_service_id_ = ipsm->add_service(service_intra_process_);
+    weak_ipsm_ = ipsm;
+  }
+
+  rclcpp::Waitable::SharedPtr
+  get_intra_process_waitable() const override
+  {
+    return service_intra_process_;
   }
 
   /// Take the next request from the service.
@@ -471,15 +537,44 @@ public:
     std::shared_ptr<void> request) override
   {
     auto typed_request = std::static_pointer_cast<typename ServiceT::Request>(request);
+    if (any_callback_.has_deferred_response_handle_callback() &&
+      !try_reserve_deferred_response())
+    {
+      handle_deferred_response_overflow(request_header, typed_request);
+      return;
+    }
+    auto request_scheduler = std::atomic_load(&request_scheduler_);
+    if (request_scheduler) {
+      auto self = this->shared_from_this();
+      request_scheduler->submit(
+        [self, request_header, typed_request]() {
+          auto response = self->any_callback_.dispatch(self, request_header, typed_request);
+          return make_send_response(self, request_header, std::move(response));
+        },
+        [self, request_header, typed_request]() {
+          return make_send_response(self, request_header, self->reject_request(typed_request));
+        });
+      return;
+    }
     auto response = any_callback_.dispatch(this->shared_from_this(), request_header, typed_request);
     if (response) {
-      send_response(*request_header, *response);
+      if (!try_send_intra_process_response(*request_header, [&response]() {return response;})) {
+        send_response(*request_header, *response);
+      }
     }
   }
 
   void
   send_response(rmw_request_id_t & req_id, typename ServiceT::Response & response)
   {
+    if (
+      try_send_intra_process_response(
+        req_id, [&response]() {
+          return std::make_shared<typename ServiceT::Response>(response);
+        }))
+    {
+      return;
+    }
     rcl_ret_t ret = rcl_send_response(get_service_handle().get(), &req_id, &response);
 
     if (ret != RCL_RET_OK) {
@@ -487,10 +582,337 @@ public:
     }
   }
 
+  /// Set the maximum number of requests waiting for a DeferredResponse to be sent.
+  /**
+   * Only the requests handled by a callback taking a DeferredResponse are accounted, from the
+   * call of the callback until the response is sent or the DeferredResponse is destroyed.
+   * Once the limit is reached, new requests are answered right away by the overflow callback,
+   * or dropped with a warning if there is none, so a slow backend can't accumulate an unbounded
+   * number of outstanding requests.
+   *
+   * \param[in] max_deferred_responses maximum number of outstanding deferred responses,
+   *   0 (the default) meaning no limit.
+   * \param[in] overflow_callback callback producing the response of the requests exceeding the
+   *   limit, called from the executor thread.
+   */
+  void
+  set_max_deferred_responses(
+    size_t max_deferred_responses,
+    CallbackType overflow_callback = nullptr)
+  {
+    std::lock_guard<std::mutex> lock(overflow_callback_mutex_);
+    overflow_callback_ = std::move(overflow_callback);
+    max_deferred_responses_.store(max_deferred_responses);
+  }
+
+  /// Get the maximum number of requests waiting for a DeferredResponse to be sent.
+  /** \return the maximum number of outstanding deferred responses, 0 meaning no limit. */
+  size_t
+  get_max_deferred_responses() const
+  {
+    return max_deferred_responses_.load();
+  }
+
+  /// Get the number of requests waiting for a DeferredResponse to be sent.
+  size_t
+  get_number_of_deferred_responses() const
+  {
+    return deferred_responses_.load();
+  }
+
+  /// Handle up to a number of requests at once, in the executor threads or a thread pool.
+  /**
+   * The requests beyond the maximum number wait in a queue, and are handled by the threads
+   * finishing the previous requests.
+   * The statistics of the requests, see get_request_statistics(), are collected from then on.
+   *
+   * \param[in] options the concurrency options, see rclcpp::ServiceConcurrencyOptions.
+   * \throws std::invalid_argument if options.max_concurrent_requests is 0
+   */
+  void
+  set_concurrency(const ServiceConcurrencyOptions & options)
+  {
+    std::atomic_store(&request_scheduler_, std::make_shared<ServiceRequestScheduler>(options));
+  }
+
+  /// Set the callback producing the response of the requests rejected on overload.
+  /**
+   * The requests are rejected by the limits of the queue of set_concurrency(), see
+   * ServiceConcurrencyOptions::max_queue_depth and ServiceConcurrencyOptions::max_queue_time,
+   * and counted in the statistics of the requests.
+   * The response is e.g. an error code telling the client to retry later, the requests are
+   * dropped without a callback.
+   *
+   * \param[in] overload_callback callback filling the response of a rejected request,
+   *   nullptr to drop the rejected requests.
+   */
+  void
+  set_overload_callback(CallbackType overload_callback)
+  {
+    std::lock_guard<std::mutex> lock(overflow_callback_mutex_);
+    overload_callback_ = std::move(overload_callback);
+  }
+
+  /// Get the statistics of the requests handled since set_concurrency() was called.
+  /**
+   * \return the statistics, all zero if set_concurrency() wasn't called.
+   */
+  ServiceRequestStatistics
+  get_request_statistics() const
+  {
+    auto request_scheduler = std::atomic_load(&request_scheduler_);
+    return request_scheduler ? request_scheduler->get_statistics() : ServiceRequestStatistics();
+  }
+
+  /// Reset the statistics of the requests, except the numbers of running and queued requests.
+  void
+  reset_request_statistics()
+  {
+    auto request_scheduler = std::atomic_load(&request_scheduler_);
+    if (request_scheduler) {
+      request_scheduler->reset_statistics();
+    }
+  }
+
 private:
   RCLCPP_DISABLE_COPY(Service)
 
+  friend class DeferredResponse<ServiceT>;
+
+  bool
+  try_reserve_deferred_response()
+  {
+    const size_t max_deferred_responses = max_deferred_responses_.load();
+    size_t current = deferred_responses_.load();
+    do {
+      if (max_deferred_responses != 0 && current >= max_deferred_responses) {
+        return false;
+      }
+    } while (!deferred_responses_.compare_exchange_weak(current, current + 1));
+    return true;
+  }
+
+  void
+  release_deferred_response()
+  {
+    // AnyServiceCallback::dispatch() can be called directly, without reserving a response
+    size_t current = deferred_responses_.load();
+    while (current > 0 && !deferred_responses_.compare_exchange_weak(current, current - 1)) {
+    }
+  }
+
+  /// Return the function sending a response, nullptr without a response.
+  static ServiceRequestScheduler::SendResponse
+  make_send_response(
+    const std::shared_ptr<Service> & self,
+    const std::shared_ptr<rmw_request_id_t> & request_header,
+    std::shared_ptr<typename ServiceT::Response> response)
+  {
+    if (!response) {
+      return nullptr;
+    }
+    return [self, request_header, response = std::move(response)]() {
+        if (
+          !self->try_send_intra_process_response(
+            *request_header, [&response]() {return response;}))
+        {
+          self->send_response(*request_header, *response);
+        }
+      };
+  }
+
+  /// Return the response of a request rejected on overload, nullptr to drop it.
+  std::shared_ptr<typename ServiceT::Response>
+  reject_request(const std::shared_ptr<typename ServiceT::Request> & request)
+  {
+    if (any_callback_.has_deferred_response_handle_callback()) {
+      // Reserved when the request was received, but the callback won't be called
+      release_deferred_response();
+    }
+    CallbackType overload_callback;
+    {
+      std::lock_guard<std::mutex> lock(overflow_callback_mutex_);
+      overload_callback = overload_callback_;
+    }
+    if (!overload_callback) {
+      return nullptr;
+    }
+    auto response = std::make_shared<typename ServiceT::Response>();
+    overload_callback(request, response);
+    return response;
+  }
+
+  void
+  handle_deferred_response_overflow(
+    const std::shared_ptr<rmw_request_id_t> & request_header,
+    const std::shared_ptr<typename ServiceT::Request> & request)
+  {
+    CallbackType overflow_callback;
+    {
+      std::lock_guard<std::mutex> lock(overflow_callback_mutex_);
+      overflow_callback = overflow_callback_;
+    }
+    if (!overflow_callback) {
+      RCLCPP_WARN(
+        node_logger_,
+        "Dropping request to service '%s': %zu deferred responses are already pending",
+        get_service_name(), deferred_responses_.load());
+      return;
+    }
+    auto response = std::make_shared<typename ServiceT::Response>();
+    overflow_callback(request, response);
+    if (!try_send_intra_process_response(*request_header, [&response]() {return response;})) {
+      send_response(*request_header, *response);
+    }
+  }
+
+  /// Give the response to the client, if the request was received from a client in the context.
+  /**
+   * \param[in] request_header the header of the request.
+   * \param[in] make_response function returning the shared response, only called for an
+   *   intra-process request.
+   * \return true if the request was an intra-process one, false if the response has to be sent
+   *   through the middleware.
+   */
+  template<typename MakeResponseT>
+  bool
+  try_send_intra_process_response(
+    const rmw_request_id_t & request_header,
+    MakeResponseT && make_response)
+  {
+    if (!service_intra_process_) {
+      return false;
+    }
+    auto pending_client = service_intra_process_->take_pending_client(request_header);
+    if (!pending_client) {
+      return false;
+    }
+    // The response is dropped if the client was destroyed, as with the middleware
+    auto client = pending_client->lock();
+    if (client) {
+      client->provide_response(request_header.sequence_number, make_response());
+    }
+    return true;
+  }
+
   AnyServiceCallback<ServiceT> any_callback_;
+
+  std::atomic<size_t> max_deferred_responses_{0};
+  std::atomic<size_t> deferred_responses_{0};
+  // Protects the overflow and overload callbacks
+  std::mutex overflow_callback_mutex_;
+  CallbackType overflow_callback_;
+  CallbackType overload_callback_;
+  std::shared_ptr<ServiceRequestScheduler> request_scheduler_;
+
+  typename ServiceIntraProcessT::SharedPtr service_intra_process_;
+  std::weak_ptr<rclcpp::experimental::IntraProcessServiceManager> weak_ipsm_;
+  uint64_t intra_process_service_id_{0};
+};
+
+/// Response to a service request, which can be sent later from any thread.
+/**
+ * A service callback taking a DeferredResponse, instead of a response to fill, returns without
+ * blocking the executor thread, e.g. while waiting for another service.
+ * The response is then sent with send(), or abandoned when the object is destroyed.
+ * The number of outstanding deferred responses can be bounded, see
+ * Service::set_max_deferred_responses().
+ *
+ * A DeferredResponse doesn't keep its service alive, and is not thread-safe: it is meant to be
+ * moved to the thread sending the response.
+ */
+template<typename ServiceT>
+class DeferredResponse
+{
+public:
+  DeferredResponse() = default;
+
+  DeferredResponse(DeferredResponse && other) noexcept
+  : service_(std::move(other.service_)),
+    request_header_(std::move(other.request_header_))
+  {
+    other.service_.reset();
+  }
+
+  DeferredResponse &
+  operator=(DeferredResponse && other) noexcept
+  {
+    if (this != &other) {
+      release();
+      service_ = std::move(other.service_);
+      request_header_ = std::move(other.request_header_);
+      other.service_.reset();
+    }
+    return *this;
+  }
+
+  ~DeferredResponse()
+  {
+    release();
+  }
+
+  /// Return true if the response wasn't sent or abandoned yet.
+  bool
+  is_pending() const
+  {
+    return request_header_ != nullptr;
+  }
+
+  /// Return the header of the request, e.g. to identify the client.
+  std::shared_ptr<const rmw_request_id_t>
+  get_request_header() const
+  {
+    return request_header_;
+  }
+
+  /// Send the response to the request.
+  /**
+   * \param[in] response the response sent to the client.
+   * \return true if the response was sent, false if the service doesn't exist anymore.
+   * \throws std::runtime_error if the response isn't pending.
+   * \throws rclcpp::exceptions::RCLError based exceptions if sending the response failed.
+   */
+  bool
+  send(typename ServiceT::Response & response)
+  {
+    if (!request_header_) {
+      throw std::runtime_error("DeferredResponse::send(): the response isn't pending");
+    }
+    auto service = service_.lock();
+    auto request_header = std::move(request_header_);
+    service_.reset();
+    if (!service) {
+      return false;
+    }
+    service->release_deferred_response();
+    service->send_response(*request_header, response);
+    return true;
+  }
+
+private:
+  RCLCPP_DISABLE_COPY(DeferredResponse)
+
+  friend class AnyServiceCallback<ServiceT>;
+
+  DeferredResponse(
+    const std::shared_ptr<Service<ServiceT>> & service,
+    std::shared_ptr<rmw_request_id_t> request_header)
+  : service_(service), request_header_(std::move(request_header))
+  {}
+
+  void
+  release()
+  {
+    auto service = service_.lock();
+    service_.reset();
+    if (service && request_header_) {
+      service->release_deferred_response();
+    }
+    request_header_.reset();
+  }
+
+  std::weak_ptr<Service<ServiceT>> service_;
+  std::shared_ptr<rmw_request_id_t> request_header_;
 };
 
 }  // namespace rclcpp
@@ -0,0 +1,171 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__SERVICE_CONCURRENCY_HPP_
+#define RCLCPP__SERVICE_CONCURRENCY_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "rclcpp/deserialization_thread_pool.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// Options handling several requests of a service at once, see Service::set_concurrency().
+struct ServiceConcurrencyOptions
+{
+  /// Maximum number of requests handled at once, the others wait in a queue.
+  size_t max_concurrent_requests = 1;
+
+  /// Maximum number of requests waiting in the queue, 0 for no limit.
+  /**
+   * The requests received while the queue is full are rejected right away, see
+   * Service::set_overload_callback(), even if the responses are ordered.
+   */
+  size_t max_queue_depth = 0;
+
+  /// Maximum time a request waits in the queue, zero for no limit.
+  /**
+   * The requests which waited longer are rejected instead of being handled, as their clients
+   * likely gave up on them.
+   */
+  std::chrono::nanoseconds max_queue_time {0};
+
+  /// Send the responses in the order the requests were received.
+  /**
+   * The responses sent later through a DeferredResponse aren't ordered.
+   */
+  bool ordered_responses = false;
+
+  /// Threads running the callbacks, nullptr to run them in the executor threads.
+  /**
+   * Without a thread pool, the requests are only handled at once by the threads of a
+   * multi-threaded executor if the service is in a reentrant callback group.
+   * The pool can be shared, e.g. with the deserialization of subscriptions.
+   */
+  rclcpp::DeserializationThreadPool::SharedPtr thread_pool = nullptr;
+};
+
+/// Statistics of the requests handled by a service, see Service::get_request_statistics().
+struct ServiceRequestStatistics
+{
+  /// Number of requests whose callback returned.
+  uint64_t handled_requests = 0;
+  /// Number of requests whose callback is running.
+  size_t running_requests = 0;
+  /// Number of requests waiting for a running request to finish.
+  size_t queue_depth = 0;
+  size_t max_queue_depth = 0;
+  /// Number of requests rejected as the queue was full.
+  uint64_t rejected_requests = 0;
+  /// Number of requests rejected after waiting longer than the maximum time in the queue.
+  uint64_t expired_requests = 0;
+  /// Time the handled requests waited in the queue.
+  std::chrono::nanoseconds total_queue_time {0};
+  std::chrono::nanoseconds max_queue_time {0};
+  /// Time the callbacks of the handled requests ran.
+  std::chrono::nanoseconds total_service_time {0};
+  std::chrono::nanoseconds max_service_time {0};
+};
+
+/// Runs the callbacks of the requests of a service, up to a number at once.
+/**
+ * Each request is a job returning the function sending its response, if any, which is called
+ * right away or once the responses of the previous requests were sent.
+ * A request rejected by the limits of the queue runs its rejection job instead.
+ * Without a thread pool, submit() runs the job in the calling thread, followed by the
+ * requests queued meanwhile.
+ *
+ * This class is used by rclcpp::Service and is thread-safe.
+ */
+class ServiceRequestScheduler : public std::enable_shared_from_this<ServiceRequestScheduler>
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(ServiceRequestScheduler)
+
+  using SendResponse = std::function<void ()>;
+  using Job = std::function<SendResponse()>;
+
+  /// Construct a scheduler.
+  /**
+   * \throws std::invalid_argument if max_concurrent_requests is 0
+   */
+  RCLCPP_PUBLIC
+  explicit ServiceRequestScheduler(const ServiceConcurrencyOptions & options);
+
+  /// Run a request, or queue it if the maximum number of requests are running.
+  /**
+   * \param[in] job job handling the request.
+   * \param[in] reject_job job run instead if the request is rejected, returning the function
+   *   sending the rejection, nullptr to drop the request.
+   * \throws anything the jobs run by this thread or the sending of their responses throw,
+   *   once the queue is empty
+   */
+  RCLCPP_PUBLIC
+  void
+  submit(Job job, Job reject_job = nullptr);
+
+  RCLCPP_PUBLIC
+  const ServiceConcurrencyOptions &
+  get_options() const;
+
+  RCLCPP_PUBLIC
+  ServiceRequestStatistics
+  get_statistics() const;
+
+  /// Reset the statistics, except the numbers of running and queued requests.
+  RCLCPP_PUBLIC
+  void
+  reset_statistics();
+
+private:
+  struct Request
+  {
+    Job job;
+    Job reject_job;
+    uint64_t ticket;
+    std::chrono::steady_clock::time_point submit_time;
+  };
+
+  /// Run a request and the queued ones, with a reserved slot.
+  void
+  run(Request request);
+
+  /// Send a response, after the responses of the previous requests if they are ordered.
+  void
+  send_response(uint64_t ticket, SendResponse send_response);
+
+  const ServiceConcurrencyOptions options_;
+
+  mutable std::mutex mutex_;
+  std::deque<Request> queue_;
+  uint64_t next_ticket_ {0};
+  ServiceRequestStatistics statistics_;
+
+  std::mutex responses_mutex_;
+  uint64_t next_response_ticket_ {0};
+  std::map<uint64_t, SendResponse> pending_responses_;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__SERVICE_CONCURRENCY_HPP_
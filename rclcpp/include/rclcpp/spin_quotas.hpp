@@ -0,0 +1,55 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__SPIN_QUOTAS_HPP_
+#define RCLCPP__SPIN_QUOTAS_HPP_
+
+#include <chrono>
+#include <cstddef>
+
+namespace rclcpp
+{
+
+/// Time budget and quotas of a call of rclcpp::Executor::spin_some_with_quotas().
+/**
+ * A quota of zero means no limit.
+ * The quotas are checked before each execution, so an entity or a callback group may exceed its
+ * time quota by the duration of one execution, and the call may exceed its budget likewise.
+ */
+struct SpinQuotas
+{
+  /// Total time of the call, or 0 to spin until every ready entity has reached its quotas.
+  std::chrono::nanoseconds max_duration{0};
+
+  /// Maximum number of executions of an entity per call.
+  /**
+   * An entity is executed at most once per wait for work, so with the default of one every ready
+   * entity is executed once, like spin_some() but rotating its starting point.
+   * With no limit the work is executed until none is ready anymore, like spin_all().
+   */
+  size_t max_executions_per_entity = 1;
+
+  /// Maximum time spent executing an entity per call.
+  std::chrono::nanoseconds max_time_per_entity{0};
+
+  /// Maximum number of executions of the entities of a callback group per call.
+  size_t max_executions_per_group = 0;
+
+  /// Maximum time spent executing the entities of a callback group per call.
+  std::chrono::nanoseconds max_time_per_group{0};
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__SPIN_QUOTAS_HPP_
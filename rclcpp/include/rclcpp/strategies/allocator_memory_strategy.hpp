@@ -15,7 +15,11 @@
 #ifndef RCLCPP__STRATEGIES__ALLOCATOR_MEMORY_STRATEGY_HPP_
 #define RCLCPP__STRATEGIES__ALLOCATOR_MEMORY_STRATEGY_HPP_
 
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "rcl/allocator.h"
@@ -154,6 +158,11 @@ public:
   bool collect_entities(const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes) override
   {
     bool has_invalid_weak_groups_or_nodes = false;
+    collected_subscription_handles_.clear();
+    collected_service_handles_.clear();
+    collected_client_handles_.clear();
+    collected_timer_handles_.clear();
+    collected_waitable_handles_.clear();
     for (const auto & pair : weak_groups_to_nodes) {
       auto group = pair.first.lock();
       auto node = pair.second.lock();
@@ -168,24 +177,52 @@ public:
       group->collect_all_ptrs(
         [this](const rclcpp::SubscriptionBase::SharedPtr & subscription) {
           subscription_handles_.push_back(subscription->get_subscription_handle());
+          collected_subscription_handles_.push_back(subscription_handles_.back());
         },
         [this](const rclcpp::ServiceBase::SharedPtr & service) {
           service_handles_.push_back(service->get_service_handle());
+          collected_service_handles_.push_back(service_handles_.back());
         },
         [this](const rclcpp::ClientBase::SharedPtr & client) {
           client_handles_.push_back(client->get_client_handle());
+          collected_client_handles_.push_back(client_handles_.back());
         },
         [this](const rclcpp::TimerBase::SharedPtr & timer) {
           timer_handles_.push_back(timer->get_timer_handle());
+          collected_timer_handles_.push_back(timer_handles_.back());
         },
         [this](const rclcpp::Waitable::SharedPtr & waitable) {
           waitable_handles_.push_back(waitable);
+          collected_waitable_handles_.push_back(waitable);
         });
     }
+    collected_entities_valid_ = true;
 
     return has_invalid_weak_groups_or_nodes;
   }
 
+  bool restore_collected_entities() override
+  {
+    if (!collected_entities_valid_) {
+      return false;
+    }
+    // Only weak references are kept between waits, so that the executor does not extend the
+    // lifetime of the rcl handles. An expired one means that the collection is outdated.
+    clear_handles();
+    if (
+      !restore_handles(collected_subscription_handles_, subscription_handles_) ||
+      !restore_handles(collected_service_handles_, service_handles_) ||
+      !restore_handles(collected_client_handles_, client_handles_) ||
+      !restore_handles(collected_timer_handles_, timer_handles_) ||
+      !restore_handles(collected_waitable_handles_, waitable_handles_))
+    {
+      collected_entities_valid_ = false;
+      clear_handles();
+      return false;
+    }
+    return true;
+  }
+
   void add_waitable_handle(const rclcpp::Waitable::SharedPtr & waitable) override
   {
     if (nullptr == waitable) {
@@ -247,34 +284,38 @@ public:
     rclcpp::AnyExecutable & any_exec,
     const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes) override
   {
-    auto it = subscription_handles_.begin();
-    while (it != subscription_handles_.end()) {
-      auto subscription = get_subscription_by_handle(*it, weak_groups_to_nodes);
-      if (subscription) {
+    take_round_robin(
+      subscription_handles_, next_subscription_index_,
+      [this, &any_exec, &weak_groups_to_nodes](
+        const std::shared_ptr<const rcl_subscription_t> & handle,
+        const rclcpp::CallbackGroup * deferred_group)
+      {
+        auto subscription = get_subscription_by_handle(handle, weak_groups_to_nodes);
+        if (!subscription) {
+          // The subscription is no longer valid, remove it and continue
+          return Visit::Remove;
+        }
         // Find the group for this handle and see if it can be serviced
         auto group = get_group_by_subscription(subscription, weak_groups_to_nodes);
         if (!group) {
           // Group was not found, meaning the subscription is not valid...
-          // Remove it from the ready list and continue looking
-          it = subscription_handles_.erase(it);
-          continue;
+          return Visit::Remove;
         }
-        if (!group->can_be_taken_from().load()) {
+        if (group.get() == deferred_group) {
+          return Visit::Defer;
+        }
+        if (!group->try_reserve()) {
           // Group is mutually exclusive and is being used, so skip it for now
           // Leave it to be checked next time, but continue searching
-          ++it;
-          continue;
+          return Visit::Skip;
         }
         // Otherwise it is safe to set and return the any_exec
         any_exec.subscription = subscription;
         any_exec.callback_group = group;
         any_exec.node_base = get_node_by_group(group, weak_groups_to_nodes);
-        subscription_handles_.erase(it);
-        return;
-      }
-      // Else, the subscription is no longer valid, remove it and continue
-      it = subscription_handles_.erase(it);
-    }
+        last_taken_group_ = group.get();
+        return Visit::Take;
+      });
   }
 
   void
@@ -282,34 +323,37 @@ public:
     rclcpp::AnyExecutable & any_exec,
     const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes) override
   {
-    auto it = service_handles_.begin();
-    while (it != service_handles_.end()) {
-      auto service = get_service_by_handle(*it, weak_groups_to_nodes);
-      if (service) {
+    take_round_robin(
+      service_handles_, next_service_index_,
+      [this, &any_exec, &weak_groups_to_nodes](
+        const std::shared_ptr<const rcl_service_t> & handle,
+        const rclcpp::CallbackGroup * deferred_group)
+      {
+        auto service = get_service_by_handle(handle, weak_groups_to_nodes);
+        if (!service) {
+          // The service is no longer valid, remove it and continue
+          return Visit::Remove;
+        }
         // Find the group for this handle and see if it can be serviced
         auto group = get_group_by_service(service, weak_groups_to_nodes);
         if (!group) {
           // Group was not found, meaning the service is not valid...
-          // Remove it from the ready list and continue looking
-          it = service_handles_.erase(it);
-          continue;
+          return Visit::Remove;
         }
-        if (!group->can_be_taken_from().load()) {
+        if (group.get() == deferred_group) {
+          return Visit::Defer;
+        }
+        if (!group->try_reserve()) {
           // Group is mutually exclusive and is being used, so skip it for now
-          // Leave it to be checked next time, but continue searching
-          ++it;
-          continue;
+          return Visit::Skip;
         }
         // Otherwise it is safe to set and return the any_exec
         any_exec.service = service;
         any_exec.callback_group = group;
         any_exec.node_base = get_node_by_group(group, weak_groups_to_nodes);
-        service_handles_.erase(it);
-        return;
-      }
-      // Else, the service is no longer valid, remove it and continue
-      it = service_handles_.erase(it);
-    }
+        last_taken_group_ = group.get();
+        return Visit::Take;
+      });
   }
 
   void
@@ -317,34 +361,37 @@ public:
     rclcpp::AnyExecutable & any_exec,
     const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes) override
   {
-    auto it = client_handles_.begin();
-    while (it != client_handles_.end()) {
-      auto client = get_client_by_handle(*it, weak_groups_to_nodes);
-      if (client) {
+    take_round_robin(
+      client_handles_, next_client_index_,
+      [this, &any_exec, &weak_groups_to_nodes](
+        const std::shared_ptr<const rcl_client_t> & handle,
+        const rclcpp::CallbackGroup * deferred_group)
+      {
+        auto client = get_client_by_handle(handle, weak_groups_to_nodes);
+        if (!client) {
+          // The client is no longer valid, remove it and continue
+          return Visit::Remove;
+        }
         // Find the group for this handle and see if it can be serviced
         auto group = get_group_by_client(client, weak_groups_to_nodes);
         if (!group) {
-          // Group was not found, meaning the service is not valid...
-          // Remove it from the ready list and continue looking
-          it = client_handles_.erase(it);
-          continue;
+          // Group was not found, meaning the client is not valid...
+          return Visit::Remove;
         }
-        if (!group->can_be_taken_from().load()) {
+        if (group.get() == deferred_group) {
+          return Visit::Defer;
+        }
+        if (!group->try_reserve()) {
           // Group is mutually exclusive and is being used, so skip it for now
-          // Leave it to be checked next time, but continue searching
-          ++it;
-          continue;
+          return Visit::Skip;
         }
         // Otherwise it is safe to set and return the any_exec
         any_exec.client = client;
         any_exec.callback_group = group;
         any_exec.node_base = get_node_by_group(group, weak_groups_to_nodes);
-        client_handles_.erase(it);
-        return;
-      }
-      // Else, the service is no longer valid, remove it and continue
-      it = client_handles_.erase(it);
-    }
+        last_taken_group_ = group.get();
+        return Visit::Take;
+      });
   }
 
   void
@@ -352,39 +399,53 @@ public:
     rclcpp::AnyExecutable & any_exec,
     const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes) override
   {
-    auto it = timer_handles_.begin();
-    while (it != timer_handles_.end()) {
-      auto timer = get_timer_by_handle(*it, weak_groups_to_nodes);
-      if (timer) {
+    if (memory_strategy::TimerDispatchOrder::EarliestDeadlineFirst == timer_dispatch_order_) {
+      get_next_timer_by_deadline(any_exec, weak_groups_to_nodes);
+      return;
+    }
+    take_round_robin(
+      timer_handles_, next_timer_index_,
+      [this, &any_exec, &weak_groups_to_nodes](
+        const std::shared_ptr<const rcl_timer_t> & handle,
+        const rclcpp::CallbackGroup * deferred_group)
+      {
+        auto timer = get_timer_by_handle(handle, weak_groups_to_nodes);
+        if (!timer) {
+          // The timer is no longer valid, remove it and continue
+          return Visit::Remove;
+        }
         // Find the group for this handle and see if it can be serviced
         auto group = get_group_by_timer(timer, weak_groups_to_nodes);
         if (!group) {
           // Group was not found, meaning the timer is not valid...
-          // Remove it from the ready list and continue looking
-          it = timer_handles_.erase(it);
-          continue;
+          return Visit::Remove;
         }
-        if (!group->can_be_taken_from().load()) {
+        if (group.get() == deferred_group) {
+          return Visit::Defer;
+        }
+        if (!group->try_reserve()) {
           // Group is mutually exclusive and is being used, so skip it for now
-          // Leave it to be checked next time, but continue searching
-          ++it;
-          continue;
+          return Visit::Skip;
         }
         if (!timer->call()) {
           // timer was cancelled, skip it.
-          ++it;
-          continue;
+          group->release();
+          return Visit::Skip;
         }
         // Otherwise it is safe to set and return the any_exec
         any_exec.timer = timer;
         any_exec.callback_group = group;
         any_exec.node_base = get_node_by_group(group, weak_groups_to_nodes);
-        timer_handles_.erase(it);
-        return;
-      }
-      // Else, the timer is no longer valid, remove it and continue
-      it = timer_handles_.erase(it);
-    }
+        last_taken_group_ = group.get();
+        return Visit::Take;
+      });
+  }
+
+  bool
+  set_timer_dispatch_order(memory_strategy::TimerDispatchOrder order) override
+  {
+    timer_dispatch_order_ = order;
+    return true;
   }
 
   void
@@ -392,34 +453,36 @@ public:
     rclcpp::AnyExecutable & any_exec,
     const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes) override
   {
-    auto it = waitable_handles_.begin();
-    while (it != waitable_handles_.end()) {
-      std::shared_ptr<Waitable> & waitable = *it;
-      if (waitable) {
+    take_round_robin(
+      waitable_handles_, next_waitable_index_,
+      [this, &any_exec, &weak_groups_to_nodes](
+        const std::shared_ptr<Waitable> & waitable,
+        const rclcpp::CallbackGroup * deferred_group)
+      {
+        if (!waitable) {
+          // The waitable is no longer valid, remove it and continue
+          return Visit::Remove;
+        }
         // Find the group for this handle and see if it can be serviced
         auto group = get_group_by_waitable(waitable, weak_groups_to_nodes);
         if (!group) {
           // Group was not found, meaning the waitable is not valid...
-          // Remove it from the ready list and continue looking
-          it = waitable_handles_.erase(it);
-          continue;
+          return Visit::Remove;
         }
-        if (!group->can_be_taken_from().load()) {
+        if (group.get() == deferred_group) {
+          return Visit::Defer;
+        }
+        if (!group->try_reserve()) {
           // Group is mutually exclusive and is being used, so skip it for now
-          // Leave it to be checked next time, but continue searching
-          ++it;
-          continue;
+          return Visit::Skip;
         }
         // Otherwise it is safe to set and return the any_exec
         any_exec.waitable = waitable;
         any_exec.callback_group = group;
         any_exec.node_base = get_node_by_group(group, weak_groups_to_nodes);
-        waitable_handles_.erase(it);
-        return;
-      }
-      // Else, the waitable is no longer valid, remove it and continue
-      it = waitable_handles_.erase(it);
-    }
+        last_taken_group_ = group.get();
+        return Visit::Take;
+      });
   }
 
   rcl_allocator_t get_allocator() override
@@ -427,6 +490,19 @@ public:
     return rclcpp::allocator::get_rcl_allocator<void *, VoidAlloc>(*allocator_.get());
   }
 
+  void get_ready_handles(std::vector<const void *> & handles) const override
+  {
+    for (const auto & handle : subscription_handles_) {
+      handles.push_back(handle.get());
+    }
+    for (const auto & handle : timer_handles_) {
+      handles.push_back(handle.get());
+    }
+    for (const auto & waitable : waitable_handles_) {
+      handles.push_back(waitable.get());
+    }
+  }
+
   size_t number_of_ready_subscriptions() const override
   {
     size_t number_of_subscriptions = subscription_handles_.size();
@@ -491,6 +567,151 @@ private:
   using VectorRebind =
     std::vector<T, typename std::allocator_traits<Alloc>::template rebind_alloc<T>>;
 
+  /// Outcome of the visit of a ready handle, see take_round_robin().
+  enum class Visit
+  {
+    /// Leave the handle to be checked next time.
+    Skip,
+    /// Leave the handle, it belongs to the callback group served last.
+    Defer,
+    /// Remove the handle, which is no longer valid.
+    Remove,
+    /// Remove the handle, whose entity was taken.
+    Take
+  };
+
+  /// Visit the ready handles circularly from the cursor, until the entity of one is taken.
+  /**
+   * The work of the callback group served last is only taken when no other callback group has
+   * ready work of this type, and the cursor is left at the position of the taken handle.
+   * This way the callback groups are served in turn, instead of always starting from the first
+   * callback group collected, whose ready work could otherwise starve the other groups.
+   */
+  template<typename T, typename VisitorT>
+  void
+  take_round_robin(VectorRebind<T> & handles, size_t & cursor, VisitorT visitor)
+  {
+    const rclcpp::CallbackGroup * deferred_group = last_taken_group_;
+    for (int pass = 0; pass < 2; ++pass) {
+      bool deferred = false;
+      size_t index = cursor < handles.size() ? cursor : 0;
+      for (size_t remaining = handles.size(); remaining > 0; --remaining) {
+        switch (visitor(handles[index], deferred_group)) {
+          case Visit::Take:
+            handles.erase(handles.begin() + static_cast<std::ptrdiff_t>(index));
+            cursor = index;
+            return;
+          case Visit::Remove:
+            handles.erase(handles.begin() + static_cast<std::ptrdiff_t>(index));
+            collected_entities_valid_ = false;
+            break;
+          case Visit::Defer:
+            deferred = true;
+            ++index;
+            break;
+          case Visit::Skip:
+            ++index;
+            break;
+        }
+        if (index >= handles.size()) {
+          index = 0;
+        }
+      }
+      if (!deferred) {
+        return;
+      }
+      deferred_group = nullptr;
+    }
+  }
+
+  template<typename T>
+  static bool
+  restore_handles(
+    const VectorRebind<std::weak_ptr<T>> & collected_handles,
+    VectorRebind<std::shared_ptr<T>> & handles)
+  {
+    for (const auto & weak_handle : collected_handles) {
+      auto handle = weak_handle.lock();
+      if (!handle) {
+        return false;
+      }
+      handles.push_back(std::move(handle));
+    }
+    return true;
+  }
+
+  /// Return the ready timer whose deadline is the earliest, recording how late it is.
+  void
+  get_next_timer_by_deadline(
+    rclcpp::AnyExecutable & any_exec,
+    const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes)
+  {
+    while (true) {
+      auto best_it = timer_handles_.end();
+      rclcpp::TimerBase::SharedPtr best_timer;
+      rclcpp::CallbackGroup::SharedPtr best_group;
+      std::chrono::nanoseconds best_deadline = std::chrono::nanoseconds::max();
+      std::chrono::nanoseconds best_time_until_trigger = std::chrono::nanoseconds::zero();
+
+      // Only handles after best_it are erased while scanning, so it stays valid.
+      auto it = timer_handles_.begin();
+      while (it != timer_handles_.end()) {
+        auto timer = get_timer_by_handle(*it, weak_groups_to_nodes);
+        if (!timer) {
+          // The timer is no longer valid, remove it and continue
+          it = timer_handles_.erase(it);
+          collected_entities_valid_ = false;
+          continue;
+        }
+        auto group = get_group_by_timer(timer, weak_groups_to_nodes);
+        if (!group) {
+          // Group was not found, meaning the timer is not valid...
+          it = timer_handles_.erase(it);
+          collected_entities_valid_ = false;
+          continue;
+        }
+        if (!group->can_be_taken_from().load()) {
+          // Group is mutually exclusive and is being used, leave it to be checked next time
+          group->record_skip();
+          ++it;
+          continue;
+        }
+        std::chrono::nanoseconds time_until_trigger = timer->time_until_trigger();
+        if (std::chrono::nanoseconds::max() == time_until_trigger) {
+          // timer was cancelled, skip it.
+          ++it;
+          continue;
+        }
+        std::chrono::nanoseconds deadline = time_until_trigger + timer->get_period();
+        if (!best_timer || deadline < best_deadline) {
+          best_it = it;
+          best_timer = timer;
+          best_group = group;
+          best_deadline = deadline;
+          best_time_until_trigger = time_until_trigger;
+        }
+        ++it;
+      }
+
+      if (!best_timer || !best_group->try_reserve()) {
+        return;
+      }
+      if (!best_timer->call()) {
+        // timer was cancelled in the meantime, don't consider it again in this wakeup.
+        best_group->release();
+        timer_handles_.erase(best_it);
+        continue;
+      }
+      best_timer->record_lateness(
+        std::max(std::chrono::nanoseconds::zero(), -best_time_until_trigger));
+      any_exec.timer = best_timer;
+      any_exec.callback_group = best_group;
+      any_exec.node_base = get_node_by_group(best_group, weak_groups_to_nodes);
+      timer_handles_.erase(best_it);
+      return;
+    }
+  }
+
   VectorRebind<const rclcpp::GuardCondition *> guard_conditions_;
 
   VectorRebind<std::shared_ptr<const rcl_subscription_t>> subscription_handles_;
@@ -499,6 +720,26 @@ private:
   VectorRebind<std::shared_ptr<const rcl_timer_t>> timer_handles_;
   VectorRebind<std::shared_ptr<Waitable>> waitable_handles_;
 
+  // Entities found by the last collect_entities(), see restore_collected_entities()
+  VectorRebind<std::weak_ptr<const rcl_subscription_t>> collected_subscription_handles_;
+  VectorRebind<std::weak_ptr<const rcl_service_t>> collected_service_handles_;
+  VectorRebind<std::weak_ptr<const rcl_client_t>> collected_client_handles_;
+  VectorRebind<std::weak_ptr<const rcl_timer_t>> collected_timer_handles_;
+  VectorRebind<std::weak_ptr<Waitable>> collected_waitable_handles_;
+  bool collected_entities_valid_ = false;
+
+  // Position of the next ready handle of each type to visit, see take_round_robin()
+  size_t next_subscription_index_ = 0;
+  size_t next_service_index_ = 0;
+  size_t next_client_index_ = 0;
+  size_t next_timer_index_ = 0;
+  size_t next_waitable_index_ = 0;
+  // Only compared with the groups of the ready handles, it's never dereferenced
+  const rclcpp::CallbackGroup * last_taken_group_ = nullptr;
+
+  memory_strategy::TimerDispatchOrder timer_dispatch_order_ =
+    memory_strategy::TimerDispatchOrder::CollectionOrder;
+
   std::shared_ptr<VoidAlloc> allocator_;
 };
 
@@ -0,0 +1,68 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__STRATEGIES__CALLBACK_ARENA_MEMORY_STRATEGY_HPP_
+#define RCLCPP__STRATEGIES__CALLBACK_ARENA_MEMORY_STRATEGY_HPP_
+
+#include <memory>
+
+#include "rclcpp/allocator/callback_arena.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/message_memory_strategy.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace strategies
+{
+namespace callback_arena_memory_strategy
+{
+
+/// Message memory strategy allocating the taken messages from the arena of the callback.
+/**
+ * The executor borrows the message, takes it and returns it within the callback, so when the
+ * executor enables the callback arenas, see rclcpp::ExecutorOptions::callback_arena_capacity,
+ * the message is allocated from the arena and nothing is freed after the callback.
+ * Without an active arena the messages are allocated like with the default strategy.
+ *
+ * The subscription callback must not keep the message after returning.
+ */
+template<typename MessageT, typename Alloc = std::allocator<void>>
+class CallbackArenaMessageMemoryStrategy
+  : public message_memory_strategy::MessageMemoryStrategy<MessageT, Alloc>
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(CallbackArenaMessageMemoryStrategy)
+
+  CallbackArenaMessageMemoryStrategy() = default;
+
+  explicit CallbackArenaMessageMemoryStrategy(std::shared_ptr<Alloc> allocator)
+  : message_memory_strategy::MessageMemoryStrategy<MessageT, Alloc>(allocator)
+  {}
+
+  std::shared_ptr<MessageT> borrow_message() override
+  {
+    if (!rclcpp::allocator::CallbackArena::get_current()) {
+      return message_memory_strategy::MessageMemoryStrategy<MessageT, Alloc>::borrow_message();
+    }
+    return std::allocate_shared<MessageT>(
+      rclcpp::allocator::CallbackArenaAllocator<MessageT>());
+  }
+};
+
+}  // namespace callback_arena_memory_strategy
+}  // namespace strategies
+}  // namespace rclcpp
+
+#endif  // RCLCPP__STRATEGIES__CALLBACK_ARENA_MEMORY_STRATEGY_HPP_
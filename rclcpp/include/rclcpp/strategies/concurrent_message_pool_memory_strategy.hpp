@@ -0,0 +1,419 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__STRATEGIES__CONCURRENT_MESSAGE_POOL_MEMORY_STRATEGY_HPP_
+#define RCLCPP__STRATEGIES__CONCURRENT_MESSAGE_POOL_MEMORY_STRATEGY_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/message_memory_strategy.hpp"
+
+namespace rclcpp
+{
+namespace strategies
+{
+namespace message_pool_memory_strategy
+{
+
+/// Options of a ConcurrentMessagePool.
+struct MessagePoolOptions
+{
+  /// Number of messages allocated when the pool is created.
+  size_t initial_size = 0;
+  /// Maximum number of messages owned by the pool, zero for no limit.
+  /**
+   * When all of them are borrowed, the messages are allocated without being pooled.
+   */
+  size_t max_size = 0;
+  /// Maximum number of free messages kept by each thread, without locking.
+  /**
+   * Zero disables the thread caches, all the messages are then kept by the shared depot.
+   */
+  size_t thread_cache_size = 8;
+};
+
+/// Statistics of a ConcurrentMessagePool.
+struct ConcurrentMessagePoolStatistics
+{
+  /// Number of borrowed messages which were taken from the pool.
+  uint64_t hit_count = 0;
+  /// Number of borrowed messages which had to be allocated.
+  uint64_t miss_count = 0;
+  /// Number of the misses which couldn't be pooled because the pool reached its maximum size.
+  uint64_t overflow_count = 0;
+  /// Number of messages owned by the pool, borrowed or free.
+  size_t size = 0;
+  /// Number of free messages in the shared depot, the thread caches aren't counted.
+  size_t depot_size = 0;
+};
+
+/// Pool of messages of one type, shared by any number of subscriptions and threads.
+/**
+ * The free messages are kept in a cache per thread, refilled from and spilled to a shared
+ * depot protected by a mutex, so most borrows and returns don't lock.
+ * The pool grows when no message is free, up to MessagePoolOptions::max_size.
+ *
+ * A message returned while still referenced elsewhere, e.g. kept by a subscription callback,
+ * leaves the pool and is deallocated with its last reference.
+ * The messages are not reset when they're reused, the taken messages are overwritten by the
+ * middleware.
+ * The free messages cached by a thread when the pool is destroyed are deallocated the next
+ * time the thread uses a pool of the same message type, or when it exits.
+ *
+ * All public member functions are thread-safe.
+ */
+template<typename MessageT>
+class ConcurrentMessagePool
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(ConcurrentMessagePool)
+
+  /// Create a pool, allocating MessagePoolOptions::initial_size messages.
+  explicit ConcurrentMessagePool(const MessagePoolOptions & options = MessagePoolOptions())
+  : state_(std::make_shared<State>(options))
+  {
+    reserve(options.initial_size);
+  }
+
+  /// Allocate messages until the pool owns at least `size` of them, within the maximum size.
+  void
+  reserve(size_t size)
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    if (state_->options.max_size != 0) {
+      size = std::min(size, state_->options.max_size);
+    }
+    state_->depot.reserve(size);
+    while (state_->size < size) {
+      state_->depot.push_back(make_pooled_message());
+      state_->size++;
+    }
+  }
+
+  /// Borrow a message, from the pool when one is free.
+  std::shared_ptr<MessageT>
+  acquire()
+  {
+    ThreadCache * cache = get_thread_cache();
+    if (cache && !cache->messages.empty()) {
+      state_->hit_count++;
+      std::shared_ptr<MessageT> message = std::move(cache->messages.back());
+      cache->messages.pop_back();
+      return message;
+    }
+    {
+      std::lock_guard<std::mutex> lock(state_->mutex);
+      if (!state_->depot.empty()) {
+        state_->hit_count++;
+        std::shared_ptr<MessageT> message = std::move(state_->depot.back());
+        state_->depot.pop_back();
+        if (cache) {
+          // Refill half of the cache, so the next borrows don't lock
+          while (!state_->depot.empty() &&
+            cache->messages.size() < state_->options.thread_cache_size / 2)
+          {
+            cache->messages.push_back(std::move(state_->depot.back()));
+            state_->depot.pop_back();
+          }
+        }
+        return message;
+      }
+      state_->miss_count++;
+      if (state_->options.max_size != 0 && state_->size >= state_->options.max_size) {
+        state_->overflow_count++;
+        return std::make_shared<MessageT>();
+      }
+      state_->size++;
+    }
+    return make_pooled_message();
+  }
+
+  /// Give a borrowed message back to the pool.
+  /**
+   * Messages not allocated by this pool are just released.
+   * \param[inout] message the message, reset by this call.
+   */
+  void
+  release(std::shared_ptr<MessageT> & message)
+  {
+    auto deleter = std::get_deleter<PooledDeleter>(message);
+    if (!deleter || deleter->state != state_.get()) {
+      message.reset();
+      return;
+    }
+    if (message.use_count() != 1) {
+      // Someone else keeps the message, it's deallocated with its last reference
+      message.reset();
+      std::lock_guard<std::mutex> lock(state_->mutex);
+      state_->size--;
+      return;
+    }
+    ThreadCache * cache = get_thread_cache();
+    if (cache && cache->messages.size() < state_->options.thread_cache_size) {
+      cache->messages.push_back(std::move(message));
+      return;
+    }
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    if (cache) {
+      // Spill half of the cache, so the next returns don't lock
+      while (cache->messages.size() > state_->options.thread_cache_size / 2) {
+        state_->depot.push_back(std::move(cache->messages.back()));
+        cache->messages.pop_back();
+      }
+    }
+    state_->depot.push_back(std::move(message));
+  }
+
+  /// Return the statistics of the pool.
+  ConcurrentMessagePoolStatistics
+  get_statistics() const
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    ConcurrentMessagePoolStatistics statistics;
+    statistics.hit_count = state_->hit_count.load();
+    statistics.miss_count = state_->miss_count;
+    statistics.overflow_count = state_->overflow_count;
+    statistics.size = state_->size;
+    statistics.depot_size = state_->depot.size();
+    return statistics;
+  }
+
+private:
+  struct State
+  {
+    explicit State(const MessagePoolOptions & pool_options)
+    : options(pool_options)
+    {}
+
+    const MessagePoolOptions options;
+    std::atomic<uint64_t> hit_count{0};
+
+    mutable std::mutex mutex;
+    std::vector<std::shared_ptr<MessageT>> depot;
+    uint64_t miss_count = 0;
+    uint64_t overflow_count = 0;
+    size_t size = 0;
+  };
+
+  /// Deleter of the pooled messages, telling which pool they belong to.
+  struct PooledDeleter
+  {
+    void
+    operator()(MessageT * message) const
+    {
+      delete message;
+    }
+
+    const State * state;
+  };
+
+  struct ThreadCache
+  {
+    std::weak_ptr<State> state;
+    const State * owner;
+    std::vector<std::shared_ptr<MessageT>> messages;
+  };
+
+  std::shared_ptr<MessageT>
+  make_pooled_message() const
+  {
+    return std::shared_ptr<MessageT>(new MessageT(), PooledDeleter{state_.get()});
+  }
+
+  /// Return the cache of the calling thread for this pool, or nullptr if disabled.
+  ThreadCache *
+  get_thread_cache() const
+  {
+    if (state_->options.thread_cache_size == 0) {
+      return nullptr;
+    }
+    // One list per message type and thread, the caches of the destroyed pools are dropped here
+    thread_local std::vector<ThreadCache> caches;
+    ThreadCache * found = nullptr;
+    for (auto it = caches.begin(); it != caches.end(); ) {
+      if (it->state.expired()) {
+        it = caches.erase(it);
+        continue;
+      }
+      if (it->owner == state_.get()) {
+        found = &*it;
+      }
+      ++it;
+    }
+    if (found) {
+      return found;
+    }
+    caches.push_back({state_, state_.get(), {}});
+    caches.back().messages.reserve(state_->options.thread_cache_size);
+    return &caches.back();
+  }
+
+  std::shared_ptr<State> state_;
+};
+
+/// Set of pools of several message types, e.g. for the subscriptions of a node.
+/**
+ * All public member functions are thread-safe.
+ */
+class MessagePoolSet
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(MessagePoolSet)
+
+  /// Create a set whose pools use the given options, unless added with other options.
+  explicit MessagePoolSet(const MessagePoolOptions & default_options = MessagePoolOptions())
+  : default_options_(default_options)
+  {}
+
+  /// Add the pool of a message type with specific options, e.g. to pre-warm it at startup.
+  /**
+   * \return the pool, or the existing one if the message type already had a pool.
+   */
+  template<typename MessageT>
+  typename ConcurrentMessagePool<MessageT>::SharedPtr
+  add_pool(const MessagePoolOptions & options)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto & pool = pools_[std::type_index(typeid(MessageT))];
+    if (!pool.pool) {
+      auto typed_pool = std::make_shared<ConcurrentMessagePool<MessageT>>(options);
+      pool.pool = typed_pool;
+      pool.get_statistics = [weak_pool = std::weak_ptr<ConcurrentMessagePool<MessageT>>(typed_pool)]
+        () {
+          auto typed_pool = weak_pool.lock();
+          return typed_pool ? typed_pool->get_statistics() : ConcurrentMessagePoolStatistics();
+        };
+    }
+    return std::static_pointer_cast<ConcurrentMessagePool<MessageT>>(pool.pool);
+  }
+
+  /// Return the pool of a message type, created with the default options if needed.
+  template<typename MessageT>
+  typename ConcurrentMessagePool<MessageT>::SharedPtr
+  get_pool()
+  {
+    return add_pool<MessageT>(default_options_);
+  }
+
+  /// Create a message memory strategy borrowing from the pool of the message type.
+  template<typename MessageT, typename Alloc = std::allocator<void>>
+  std::shared_ptr<message_memory_strategy::MessageMemoryStrategy<MessageT, Alloc>>
+  create_memory_strategy();
+
+  /// Return the sum of the statistics of the pools.
+  ConcurrentMessagePoolStatistics
+  get_statistics() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ConcurrentMessagePoolStatistics total;
+    for (const auto & pool : pools_) {
+      const auto statistics = pool.second.get_statistics();
+      total.hit_count += statistics.hit_count;
+      total.miss_count += statistics.miss_count;
+      total.overflow_count += statistics.overflow_count;
+      total.size += statistics.size;
+      total.depot_size += statistics.depot_size;
+    }
+    return total;
+  }
+
+private:
+  struct TypeErasedPool
+  {
+    std::shared_ptr<void> pool;
+    std::function<ConcurrentMessagePoolStatistics()> get_statistics;
+  };
+
+  const MessagePoolOptions default_options_;
+  mutable std::mutex mutex_;
+  std::unordered_map<std::type_index, TypeErasedPool> pools_;
+};
+
+/// Message memory strategy borrowing the messages from a ConcurrentMessagePool.
+/**
+ * Unlike MessagePoolMemoryStrategy, it's usable by multi-threaded executors, the pool grows
+ * instead of throwing when it's exhausted, and the pool can be shared by subscriptions.
+ */
+template<typename MessageT, typename Alloc = std::allocator<void>>
+class ConcurrentMessagePoolMemoryStrategy
+  : public message_memory_strategy::MessageMemoryStrategy<MessageT, Alloc>
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(ConcurrentMessagePoolMemoryStrategy)
+
+  /// Create a strategy with its own pool.
+  explicit ConcurrentMessagePoolMemoryStrategy(
+    const MessagePoolOptions & options = MessagePoolOptions())
+  : pool_(std::make_shared<ConcurrentMessagePool<MessageT>>(options))
+  {}
+
+  /// Create a strategy borrowing from an existing pool.
+  /**
+   * \throws std::invalid_argument if the pool is nullptr.
+   */
+  explicit ConcurrentMessagePoolMemoryStrategy(
+    typename ConcurrentMessagePool<MessageT>::SharedPtr pool)
+  : pool_(std::move(pool))
+  {
+    if (!pool_) {
+      throw std::invalid_argument("message pool cannot be nullptr");
+    }
+  }
+
+  std::shared_ptr<MessageT> borrow_message() override
+  {
+    return pool_->acquire();
+  }
+
+  void return_message(std::shared_ptr<MessageT> & msg) override
+  {
+    pool_->release(msg);
+  }
+
+  /// Return the pool of the strategy.
+  typename ConcurrentMessagePool<MessageT>::SharedPtr
+  get_pool() const
+  {
+    return pool_;
+  }
+
+private:
+  typename ConcurrentMessagePool<MessageT>::SharedPtr pool_;
+};
+
+template<typename MessageT, typename Alloc>
+std::shared_ptr<message_memory_strategy::MessageMemoryStrategy<MessageT, Alloc>>
+MessagePoolSet::create_memory_strategy()
+{
+  return std::make_shared<ConcurrentMessagePoolMemoryStrategy<MessageT, Alloc>>(
+    get_pool<MessageT>());
+}
+
+}  // namespace message_pool_memory_strategy
+}  // namespace strategies
+}  // namespace rclcpp
+
+#endif  // RCLCPP__STRATEGIES__CONCURRENT_MESSAGE_POOL_MEMORY_STRATEGY_HPP_
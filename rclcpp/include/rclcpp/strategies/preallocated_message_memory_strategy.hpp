@@ -0,0 +1,136 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__STRATEGIES__PREALLOCATED_MESSAGE_MEMORY_STRATEGY_HPP_
+#define RCLCPP__STRATEGIES__PREALLOCATED_MESSAGE_MEMORY_STRATEGY_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/message_memory_strategy.hpp"
+
+namespace rclcpp
+{
+namespace strategies
+{
+namespace message_pool_memory_strategy
+{
+
+/// Message memory strategy taking the messages into instances owned by the user.
+/**
+ * The executor takes each message into one of the instances given to the constructor, in turn,
+ * so a single instance is enough for a single-threaded executor, and a small ring of them for a
+ * multi-threaded one.
+ * The instances aren't reset between takes, so the sequences they contain keep their capacity,
+ * e.g. reserved by the user for the largest message expected, and large variable-length
+ * messages don't reallocate on every take.
+ *
+ * The instance is reused as soon as the callback returns, so the callback must not keep the
+ * message, it should copy what it needs instead.
+ * When all the instances are borrowed, the messages are allocated, see get_fallback_count().
+ *
+ * All public member functions are thread-safe and lock-free.
+ */
+template<typename MessageT, typename Alloc = std::allocator<void>>
+class PreallocatedMessageMemoryStrategy
+  : public message_memory_strategy::MessageMemoryStrategy<MessageT, Alloc>
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(PreallocatedMessageMemoryStrategy)
+
+  /// Create a strategy taking the messages into the given instances.
+  /**
+   * \param messages the instances, kept alive by the strategy.
+   * \throws std::invalid_argument if there is no instance or one of them is nullptr.
+   */
+  explicit PreallocatedMessageMemoryStrategy(std::vector<std::shared_ptr<MessageT>> messages)
+  : size_(messages.size()),
+    slots_(std::make_unique<Slot[]>(messages.size()))
+  {
+    if (messages.empty()) {
+      throw std::invalid_argument("at least one preallocated message is required");
+    }
+    for (size_t i = 0; i < size_; ++i) {
+      if (!messages[i]) {
+        throw std::invalid_argument("preallocated message cannot be nullptr");
+      }
+      slots_[i].message = std::move(messages[i]);
+    }
+  }
+
+  /// Create a strategy taking the messages into a single instance.
+  /**
+   * \throws std::invalid_argument if the message is nullptr.
+   */
+  explicit PreallocatedMessageMemoryStrategy(std::shared_ptr<MessageT> message)
+  : PreallocatedMessageMemoryStrategy(std::vector<std::shared_ptr<MessageT>>{std::move(message)})
+  {}
+
+  /// Borrow the next free instance, or allocate a message if they're all borrowed.
+  std::shared_ptr<MessageT> borrow_message() override
+  {
+    const size_t start = next_index_.fetch_add(1, std::memory_order_relaxed);
+    for (size_t i = 0; i < size_; ++i) {
+      Slot & slot = slots_[(start + i) % size_];
+      if (!slot.borrowed.exchange(true, std::memory_order_acquire)) {
+        return slot.message;
+      }
+    }
+    fallback_count_.fetch_add(1, std::memory_order_relaxed);
+    return message_memory_strategy::MessageMemoryStrategy<MessageT, Alloc>::borrow_message();
+  }
+
+  /// Give back an instance for the next take, or release an allocated message.
+  void return_message(std::shared_ptr<MessageT> & msg) override
+  {
+    for (size_t i = 0; i < size_; ++i) {
+      if (slots_[i].message == msg) {
+        msg.reset();
+        slots_[i].borrowed.store(false, std::memory_order_release);
+        return;
+      }
+    }
+    msg.reset();
+  }
+
+  /// Return the number of messages allocated because all the instances were borrowed.
+  uint64_t
+  get_fallback_count() const
+  {
+    return fallback_count_.load(std::memory_order_relaxed);
+  }
+
+private:
+  struct Slot
+  {
+    std::shared_ptr<MessageT> message;
+    std::atomic<bool> borrowed{false};
+  };
+
+  const size_t size_;
+  std::unique_ptr<Slot[]> slots_;
+  std::atomic<size_t> next_index_{0};
+  std::atomic<uint64_t> fallback_count_{0};
+};
+
+}  // namespace message_pool_memory_strategy
+}  // namespace strategies
+}  // namespace rclcpp
+
+#endif  // RCLCPP__STRATEGIES__PREALLOCATED_MESSAGE_MEMORY_STRATEGY_HPP_
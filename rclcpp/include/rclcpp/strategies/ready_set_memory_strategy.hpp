@@ -0,0 +1,651 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__STRATEGIES__READY_SET_MEMORY_STRATEGY_HPP_
+#define RCLCPP__STRATEGIES__READY_SET_MEMORY_STRATEGY_HPP_
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "rcl/allocator.h"
+
+#include "rclcpp/allocator/allocator_common.hpp"
+#include "rclcpp/detail/add_guard_condition_to_rcl_wait_set.hpp"
+#include "rclcpp/memory_strategy.hpp"
+#include "rclcpp/node.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+#include "rcutils/logging_macros.h"
+
+#include "rmw/types.h"
+
+namespace rclcpp
+{
+namespace memory_strategies
+{
+namespace ready_set_memory_strategy
+{
+
+/// Memory strategy visiting only the ready entities after a wait.
+/**
+ * It behaves like the AllocatorMemoryStrategy, but instead of resetting and erasing the
+ * handles of the entities which are not ready, remove_null_handles() records the indices of
+ * the ready entities in a list.
+ * The get_next_*() functions then only visit the ready entities, and find the entity and the
+ * callback group of a handle through the index recorded at collection time instead of searching
+ * all the callback groups.
+ *
+ * The storage is sized when the entities are collected, so that waiting and dispatching do not
+ * allocate memory as long as the set of entities does not change.
+ */
+template<typename Alloc = std::allocator<void>>
+class ReadySetMemoryStrategy : public memory_strategy::MemoryStrategy
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(ReadySetMemoryStrategy<Alloc>)
+
+  using VoidAllocTraits = typename allocator::AllocRebind<void *, Alloc>;
+  using VoidAlloc = typename VoidAllocTraits::allocator_type;
+
+  explicit ReadySetMemoryStrategy(std::shared_ptr<Alloc> allocator)
+  {
+    allocator_ = std::make_shared<VoidAlloc>(*allocator.get());
+  }
+
+  ReadySetMemoryStrategy()
+  {
+    allocator_ = std::make_shared<VoidAlloc>();
+  }
+
+  void add_guard_condition(const rclcpp::GuardCondition & guard_condition) override
+  {
+    for (const auto & existing_guard_condition : guard_conditions_) {
+      if (existing_guard_condition == &guard_condition) {
+        return;
+      }
+    }
+    guard_conditions_.push_back(&guard_condition);
+  }
+
+  void remove_guard_condition(const rclcpp::GuardCondition * guard_condition) override
+  {
+    for (auto it = guard_conditions_.begin(); it != guard_conditions_.end(); ++it) {
+      if (*it == guard_condition) {
+        guard_conditions_.erase(it);
+        break;
+      }
+    }
+  }
+
+  void clear_handles() override
+  {
+    subscriptions_.clear_handles();
+    services_.clear_handles();
+    clients_.clear_handles();
+    timers_.clear_handles();
+    waitables_.clear_handles();
+  }
+
+  void remove_null_handles(rcl_wait_set_t * wait_set) override
+  {
+    // Only the handles of the entities added by this strategy are checked, there may be more
+    // entities in the wait set due to waitables added to the end.
+    subscriptions_.keep_ready(
+      [wait_set](size_t i) {return nullptr != wait_set->subscriptions[i];});
+    services_.keep_ready(
+      [wait_set](size_t i) {return nullptr != wait_set->services[i];});
+    clients_.keep_ready(
+      [wait_set](size_t i) {return nullptr != wait_set->clients[i];});
+    timers_.keep_ready(
+      [wait_set](size_t i) {return nullptr != wait_set->timers[i];});
+    waitables_.keep_ready(
+      [this, wait_set](size_t i) {return waitables_.handles[i]->is_ready(wait_set);});
+  }
+
+  bool collect_entities(const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes) override
+  {
+    bool has_invalid_weak_groups_or_nodes = false;
+    subscriptions_.clear();
+    services_.clear();
+    clients_.clear();
+    timers_.clear();
+    waitables_.clear();
+    for (const auto & pair : weak_groups_to_nodes) {
+      auto group = pair.first.lock();
+      auto node = pair.second.lock();
+      if (group == nullptr || node == nullptr) {
+        has_invalid_weak_groups_or_nodes = true;
+        continue;
+      }
+      if (!group->can_be_taken_from().load()) {
+        continue;
+      }
+
+      group->collect_all_ptrs(
+        [this, &group](const rclcpp::SubscriptionBase::SharedPtr & subscription) {
+          subscriptions_.add(subscription, subscription->get_subscription_handle(), group);
+        },
+        [this, &group](const rclcpp::ServiceBase::SharedPtr & service) {
+          services_.add(service, service->get_service_handle(), group);
+        },
+        [this, &group](const rclcpp::ClientBase::SharedPtr & client) {
+          clients_.add(client, client->get_client_handle(), group);
+        },
+        [this, &group](const rclcpp::TimerBase::SharedPtr & timer) {
+          timers_.add(timer, timer->get_timer_handle(), group);
+        },
+        [this, &group](const rclcpp::Waitable::SharedPtr & waitable) {
+          waitables_.add(waitable, waitable, group);
+        });
+    }
+    // Reserve once, so that recording the ready entities never allocates
+    subscriptions_.reserve();
+    services_.reserve();
+    clients_.reserve();
+    timers_.reserve();
+    waitables_.reserve();
+    collected_entities_valid_ = true;
+
+    return has_invalid_weak_groups_or_nodes;
+  }
+
+  bool restore_collected_entities() override
+  {
+    if (!collected_entities_valid_) {
+      return false;
+    }
+    // Only weak references are kept between waits, so that the executor does not extend the
+    // lifetime of the rcl handles. An expired one means that the collection is outdated.
+    if (
+      !subscriptions_.restore() || !services_.restore() || !clients_.restore() ||
+      !timers_.restore() || !waitables_.restore())
+    {
+      collected_entities_valid_ = false;
+      clear_handles();
+      return false;
+    }
+    return true;
+  }
+
+  void add_waitable_handle(const rclcpp::Waitable::SharedPtr & waitable) override
+  {
+    if (nullptr == waitable) {
+      throw std::runtime_error("waitable object unexpectedly nullptr");
+    }
+    // The callback group of the waitable is searched when it's ready
+    waitables_.add(waitable, waitable, nullptr);
+    waitables_.reserve();
+  }
+
+  bool add_handles_to_wait_set(rcl_wait_set_t * wait_set) override
+  {
+    // The wait set indices must match the indices of the handles, so all of them are added
+    for (const std::shared_ptr<const rcl_subscription_t> & subscription :
+      subscriptions_.handles)
+    {
+      if (rcl_wait_set_add_subscription(wait_set, subscription.get(), NULL) != RCL_RET_OK) {
+        RCUTILS_LOG_ERROR_NAMED(
+          "rclcpp",
+          "Couldn't add subscription to wait set: %s", rcl_get_error_string().str);
+        return false;
+      }
+    }
+
+    for (const std::shared_ptr<const rcl_client_t> & client : clients_.handles) {
+      if (rcl_wait_set_add_client(wait_set, client.get(), NULL) != RCL_RET_OK) {
+        RCUTILS_LOG_ERROR_NAMED(
+          "rclcpp",
+          "Couldn't add client to wait set: %s", rcl_get_error_string().str);
+        return false;
+      }
+    }
+
+    for (const std::shared_ptr<const rcl_service_t> & service : services_.handles) {
+      if (rcl_wait_set_add_service(wait_set, service.get(), NULL) != RCL_RET_OK) {
+        RCUTILS_LOG_ERROR_NAMED(
+          "rclcpp",
+          "Couldn't add service to wait set: %s", rcl_get_error_string().str);
+        return false;
+      }
+    }
+
+    for (const std::shared_ptr<const rcl_timer_t> & timer : timers_.handles) {
+      if (rcl_wait_set_add_timer(wait_set, timer.get(), NULL) != RCL_RET_OK) {
+        RCUTILS_LOG_ERROR_NAMED(
+          "rclcpp",
+          "Couldn't add timer to wait set: %s", rcl_get_error_string().str);
+        return false;
+      }
+    }
+
+    for (auto guard_condition : guard_conditions_) {
+      detail::add_guard_condition_to_rcl_wait_set(*wait_set, *guard_condition);
+    }
+
+    for (const std::shared_ptr<Waitable> & waitable : waitables_.handles) {
+      if (!waitable) {
+        throw std::runtime_error("waitable object unexpectedly nullptr");
+      }
+      waitable->add_to_wait_set(wait_set);
+    }
+    return true;
+  }
+
+  void
+  get_next_subscription(
+    rclcpp::AnyExecutable & any_exec,
+    const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes) override
+  {
+    any_exec.subscription = take_next_ready(subscriptions_, any_exec, weak_groups_to_nodes);
+  }
+
+  void
+  get_next_service(
+    rclcpp::AnyExecutable & any_exec,
+    const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes) override
+  {
+    any_exec.service = take_next_ready(services_, any_exec, weak_groups_to_nodes);
+  }
+
+  void
+  get_next_client(
+    rclcpp::AnyExecutable & any_exec,
+    const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes) override
+  {
+    any_exec.client = take_next_ready(clients_, any_exec, weak_groups_to_nodes);
+  }
+
+  void
+  get_next_timer(
+    rclcpp::AnyExecutable & any_exec,
+    const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes) override
+  {
+    if (memory_strategy::TimerDispatchOrder::EarliestDeadlineFirst == timer_dispatch_order_) {
+      get_next_timer_by_deadline(any_exec, weak_groups_to_nodes);
+      return;
+    }
+    any_exec.timer = take_next_ready(
+      timers_, any_exec, weak_groups_to_nodes,
+      [](const rclcpp::TimerBase::SharedPtr & timer) {
+        // A cancelled timer is skipped
+        return timer->call();
+      });
+  }
+
+  bool
+  set_timer_dispatch_order(memory_strategy::TimerDispatchOrder order) override
+  {
+    timer_dispatch_order_ = order;
+    return true;
+  }
+
+  void
+  get_next_waitable(
+    rclcpp::AnyExecutable & any_exec,
+    const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes) override
+  {
+    any_exec.waitable = take_next_ready(waitables_, any_exec, weak_groups_to_nodes);
+  }
+
+  rcl_allocator_t get_allocator() override
+  {
+    return rclcpp::allocator::get_rcl_allocator<void *, VoidAlloc>(*allocator_.get());
+  }
+
+  size_t number_of_ready_subscriptions() const override
+  {
+    size_t number_of_subscriptions = subscriptions_.handles.size();
+    for (const std::shared_ptr<Waitable> & waitable : waitables_.handles) {
+      number_of_subscriptions += waitable->get_number_of_ready_subscriptions();
+    }
+    return number_of_subscriptions;
+  }
+
+  size_t number_of_ready_services() const override
+  {
+    size_t number_of_services = services_.handles.size();
+    for (const std::shared_ptr<Waitable> & waitable : waitables_.handles) {
+      number_of_services += waitable->get_number_of_ready_services();
+    }
+    return number_of_services;
+  }
+
+  size_t number_of_ready_events() const override
+  {
+    size_t number_of_events = 0;
+    for (const std::shared_ptr<Waitable> & waitable : waitables_.handles) {
+      number_of_events += waitable->get_number_of_ready_events();
+    }
+    return number_of_events;
+  }
+
+  size_t number_of_ready_clients() const override
+  {
+    size_t number_of_clients = clients_.handles.size();
+    for (const std::shared_ptr<Waitable> & waitable : waitables_.handles) {
+      number_of_clients += waitable->get_number_of_ready_clients();
+    }
+    return number_of_clients;
+  }
+
+  size_t number_of_guard_conditions() const override
+  {
+    size_t number_of_guard_conditions = guard_conditions_.size();
+    for (const std::shared_ptr<Waitable> & waitable : waitables_.handles) {
+      number_of_guard_conditions += waitable->get_number_of_ready_guard_conditions();
+    }
+    return number_of_guard_conditions;
+  }
+
+  size_t number_of_ready_timers() const override
+  {
+    size_t number_of_timers = timers_.handles.size();
+    for (const std::shared_ptr<Waitable> & waitable : waitables_.handles) {
+      number_of_timers += waitable->get_number_of_ready_timers();
+    }
+    return number_of_timers;
+  }
+
+  size_t number_of_waitables() const override
+  {
+    return waitables_.handles.size();
+  }
+
+  /// Return the number of entities found ready by the last wait and not taken yet.
+  size_t number_of_pending_ready_entities() const
+  {
+    return subscriptions_.ready.size() + services_.ready.size() + clients_.ready.size() +
+           timers_.ready.size() + waitables_.ready.size();
+  }
+
+private:
+  template<typename T>
+  using VectorRebind =
+    std::vector<T, typename std::allocator_traits<Alloc>::template rebind_alloc<T>>;
+
+  /// The collected entities of one type, with the handles added to the wait set.
+  template<typename EntityT, typename HandleT>
+  struct EntitySet
+  {
+    /// Entity and callback group of a handle, at the same index as the handle.
+    struct Entry
+    {
+      std::weak_ptr<EntityT> entity;
+      std::weak_ptr<HandleT> handle;
+      rclcpp::CallbackGroup::WeakPtr callback_group;
+      // False for the waitables added without callback group
+      bool has_callback_group;
+    };
+
+    void
+    add(
+      const std::shared_ptr<EntityT> & entity,
+      const std::shared_ptr<HandleT> & handle,
+      const rclcpp::CallbackGroup::SharedPtr & callback_group)
+    {
+      entries.push_back({entity, handle, callback_group, nullptr != callback_group});
+      handles.push_back(handle);
+      ready.push_back(handles.size() - 1);
+    }
+
+    void
+    reserve()
+    {
+      ready.reserve(entries.size());
+    }
+
+    void
+    clear()
+    {
+      entries.clear();
+      handles.clear();
+      ready.clear();
+    }
+
+    void
+    clear_handles()
+    {
+      handles.clear();
+      ready.clear();
+    }
+
+    /// Lock the handles of the collected entities again, all of them being candidates.
+    bool
+    restore()
+    {
+      handles.clear();
+      ready.clear();
+      for (size_t i = 0; i < entries.size(); ++i) {
+        auto handle = entries[i].handle.lock();
+        if (!handle) {
+          return false;
+        }
+        handles.push_back(std::move(handle));
+        ready.push_back(i);
+      }
+      return true;
+    }
+
+    /// Record the indices of the handles for which is_ready returns true, release the others.
+    template<typename IsReadyT>
+    void
+    keep_ready(IsReadyT is_ready)
+    {
+      ready.clear();
+      for (size_t i = 0; i < handles.size(); ++i) {
+        if (!handles[i]) {
+          continue;
+        }
+        if (is_ready(i)) {
+          ready.push_back(i);
+        } else {
+          handles[i].reset();
+        }
+      }
+    }
+
+    VectorRebind<Entry> entries;
+    VectorRebind<std::shared_ptr<HandleT>> handles;
+    // Indices of the entities which are candidates for execution, in collection order
+    VectorRebind<size_t> ready;
+  };
+
+  using SubscriptionSet = EntitySet<rclcpp::SubscriptionBase, const rcl_subscription_t>;
+  using ServiceSet = EntitySet<rclcpp::ServiceBase, const rcl_service_t>;
+  using ClientSet = EntitySet<rclcpp::ClientBase, const rcl_client_t>;
+  using TimerSet = EntitySet<rclcpp::TimerBase, const rcl_timer_t>;
+  using WaitableSet = EntitySet<rclcpp::Waitable, rclcpp::Waitable>;
+
+  /// Find the callback group of a ready entity, nullptr if it's not valid anymore.
+  template<typename EntryT, typename EntityT>
+  static rclcpp::CallbackGroup::SharedPtr
+  get_group_of_entry(
+    const EntryT & entry,
+    const std::shared_ptr<EntityT> & entity,
+    const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes)
+  {
+    if (!entry.has_callback_group) {
+      return find_group(entity, weak_groups_to_nodes);
+    }
+    if (weak_groups_to_nodes.find(entry.callback_group) == weak_groups_to_nodes.end()) {
+      return nullptr;
+    }
+    return entry.callback_group.lock();
+  }
+
+  static rclcpp::CallbackGroup::SharedPtr
+  find_group(
+    const rclcpp::Waitable::SharedPtr & waitable,
+    const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes)
+  {
+    return get_group_by_waitable(waitable, weak_groups_to_nodes);
+  }
+
+  template<typename EntityT>
+  static rclcpp::CallbackGroup::SharedPtr
+  find_group(const std::shared_ptr<EntityT> &, const WeakCallbackGroupsToNodesMap &)
+  {
+    return nullptr;
+  }
+
+  /// Take the first ready entity of the set whose callback group can be taken from.
+  template<typename EntityT, typename HandleT, typename AcceptT>
+  std::shared_ptr<EntityT>
+  take_next_ready(
+    EntitySet<EntityT, HandleT> & set,
+    rclcpp::AnyExecutable & any_exec,
+    const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes,
+    AcceptT accept)
+  {
+    auto it = set.ready.begin();
+    while (it != set.ready.end()) {
+      auto entity = set.entries[*it].entity.lock();
+      rclcpp::CallbackGroup::SharedPtr group;
+      if (entity) {
+        group = get_group_of_entry(set.entries[*it], entity, weak_groups_to_nodes);
+      }
+      if (!group) {
+        // The entity or its group is no longer valid, remove it and continue looking
+        set.handles[*it].reset();
+        it = set.ready.erase(it);
+        collected_entities_valid_ = false;
+        continue;
+      }
+      if (!group->try_reserve()) {
+        // Group is mutually exclusive and is being used, so skip it for now
+        // Leave it to be checked next time, but continue searching
+        ++it;
+        continue;
+      }
+      if (!accept(entity)) {
+        group->release();
+        ++it;
+        continue;
+      }
+      // Otherwise it is safe to set and return the entity
+      any_exec.callback_group = group;
+      any_exec.node_base = get_node_by_group(group, weak_groups_to_nodes);
+      set.handles[*it].reset();
+      set.ready.erase(it);
+      return entity;
+    }
+    return nullptr;
+  }
+
+  template<typename EntityT, typename HandleT>
+  std::shared_ptr<EntityT>
+  take_next_ready(
+    EntitySet<EntityT, HandleT> & set,
+    rclcpp::AnyExecutable & any_exec,
+    const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes)
+  {
+    return take_next_ready(
+      set, any_exec, weak_groups_to_nodes,
+      [](const std::shared_ptr<EntityT> &) {return true;});
+  }
+
+  /// Return the ready timer whose deadline is the earliest, recording how late it is.
+  void
+  get_next_timer_by_deadline(
+    rclcpp::AnyExecutable & any_exec,
+    const WeakCallbackGroupsToNodesMap & weak_groups_to_nodes)
+  {
+    while (true) {
+      auto best_it = timers_.ready.end();
+      rclcpp::TimerBase::SharedPtr best_timer;
+      rclcpp::CallbackGroup::SharedPtr best_group;
+      std::chrono::nanoseconds best_deadline = std::chrono::nanoseconds::max();
+      std::chrono::nanoseconds best_time_until_trigger = std::chrono::nanoseconds::zero();
+
+      // Only indices after best_it are erased while scanning, so it stays valid.
+      auto it = timers_.ready.begin();
+      while (it != timers_.ready.end()) {
+        auto timer = timers_.entries[*it].entity.lock();
+        rclcpp::CallbackGroup::SharedPtr group;
+        if (timer) {
+          group = get_group_of_entry(timers_.entries[*it], timer, weak_groups_to_nodes);
+        }
+        if (!group) {
+          // The timer or its group is no longer valid, remove it and continue
+          timers_.handles[*it].reset();
+          it = timers_.ready.erase(it);
+          collected_entities_valid_ = false;
+          continue;
+        }
+        if (!group->can_be_taken_from().load()) {
+          // Group is mutually exclusive and is being used, leave it to be checked next time
+          group->record_skip();
+          ++it;
+          continue;
+        }
+        std::chrono::nanoseconds time_until_trigger = timer->time_until_trigger();
+        if (std::chrono::nanoseconds::max() == time_until_trigger) {
+          // timer was cancelled, skip it.
+          ++it;
+          continue;
+        }
+        std::chrono::nanoseconds deadline = time_until_trigger + timer->get_period();
+        if (!best_timer || deadline < best_deadline) {
+          best_it = it;
+          best_timer = timer;
+          best_group = group;
+          best_deadline = deadline;
+          best_time_until_trigger = time_until_trigger;
+        }
+        ++it;
+      }
+
+      if (!best_timer || !best_group->try_reserve()) {
+        return;
+      }
+      timers_.handles[*best_it].reset();
+      timers_.ready.erase(best_it);
+      if (!best_timer->call()) {
+        // timer was cancelled in the meantime, don't consider it again in this wakeup.
+        best_group->release();
+        continue;
+      }
+      best_timer->record_lateness(
+        std::max(std::chrono::nanoseconds::zero(), -best_time_until_trigger));
+      any_exec.timer = best_timer;
+      any_exec.callback_group = best_group;
+      any_exec.node_base = get_node_by_group(best_group, weak_groups_to_nodes);
+      return;
+    }
+  }
+
+  VectorRebind<const rclcpp::GuardCondition *> guard_conditions_;
+
+  SubscriptionSet subscriptions_;
+  ServiceSet services_;
+  ClientSet clients_;
+  TimerSet timers_;
+  WaitableSet waitables_;
+  bool collected_entities_valid_ = false;
+
+  memory_strategy::TimerDispatchOrder timer_dispatch_order_ =
+    memory_strategy::TimerDispatchOrder::CollectionOrder;
+
+  std::shared_ptr<VoidAlloc> allocator_;
+};
+
+}  // namespace ready_set_memory_strategy
+}  // namespace memory_strategies
+}  // namespace rclcpp
+
+#endif  // RCLCPP__STRATEGIES__READY_SET_MEMORY_STRATEGY_HPP_
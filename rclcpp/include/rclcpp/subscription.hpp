@@ -22,6 +22,7 @@
 #include <functional>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <sstream>
 #include <string>
 #include <utility>
@@ -35,12 +36,18 @@
 #include "rclcpp/exceptions.hpp"
 #include "rclcpp/expand_topic_or_service_name.hpp"
 #include "rclcpp/experimental/intra_process_manager.hpp"
+#include "rclcpp/experimental/subscription_deserialization_waitable.hpp"
 #include "rclcpp/experimental/subscription_intra_process.hpp"
+#include "rclcpp/latest_message.hpp"
 #include "rclcpp/logging.hpp"
 #include "rclcpp/macros.hpp"
+#include "rclcpp/memory_accounting.hpp"
 #include "rclcpp/message_info.hpp"
+#include "rclcpp/message_lineage.hpp"
 #include "rclcpp/message_memory_strategy.hpp"
 #include "rclcpp/node_interfaces/node_base_interface.hpp"
+#include "rclcpp/payload_compression.hpp"
+#include "rclcpp/serialization.hpp"
 #include "rclcpp/subscription_base.hpp"
 #include "rclcpp/subscription_options.hpp"
 #include "rclcpp/subscription_traits.hpp"
@@ -125,7 +132,8 @@ public:
    * \param[in] subscription_topic_statistics Optional pointer to a topic statistics subcription.
    * \throws std::invalid_argument if the QoS is uncompatible with intra-process (if one
    *   of the following conditions are true: qos_profile.history == RMW_QOS_POLICY_HISTORY_KEEP_ALL,
-   *   qos_profile.depth == 0 or qos_profile.durability != RMW_QOS_POLICY_DURABILITY_VOLATILE).
+   *   qos_profile.depth == 0 or qos_profile.durability is neither
+   *   RMW_QOS_POLICY_DURABILITY_VOLATILE nor RMW_QOS_POLICY_DURABILITY_TRANSIENT_LOCAL).
    */
   Subscription(
     rclcpp::node_interfaces::NodeBaseInterface * node_base,
@@ -144,13 +152,44 @@ public:
       // NOTE(methylDragon): Passing these args separately is necessary for event binding
       options.event_callbacks,
       options.use_default_callbacks,
-      callback.is_serialized_message_callback()),
+      // the messages deserialized off the executor threads or decompressed are taken serialized
+      callback.is_serialized_message_callback() || options.deserialization_thread_pool ||
+      options.prefetch_depth > 0 || options.decompress_payloads),
     any_callback_(callback),
-    options_(options),
+    allocator_(options.get_allocator()),
+    rcl_allocator_storage_(options.get_rcl_allocator_storage()),
+    rmw_implementation_payload_(options.rmw_implementation_payload),
+    deserialization_thread_pool_min_size_(options.deserialization_thread_pool_min_size),
+    prefetch_depth_(options.prefetch_depth),
     message_memory_strategy_(message_memory_strategy)
   {
+    this->set_max_messages_per_take(options.max_messages_per_take);
+    this->set_rate_limit(options.rate_limit);
+    this->set_max_message_age(options.max_message_age);
+    this->setup_content_filter(options.content_filter_options);
+    this->set_message_info_needed(any_callback_.uses_message_info());
+    if (this->is_serialized()) {
+      // Only the messages taken serialized can be compressed, see handle_serialized_message()
+      payload_decompressor_ = std::make_unique<rclcpp::PayloadDecompressor>();
+    }
+    if (options.latest_value_only) {
+      latest_message_ = std::make_shared<rclcpp::LatestMessage<ROSMessageType>>();
+    }
+
+    if (!any_callback_.is_serialized_message_callback()) {
+      auto thread_pool = options.deserialization_thread_pool;
+      if (!thread_pool && prefetch_depth_ > 0) {
+        thread_pool = node_base->get_context()->get_worker_pool();
+      }
+      if (thread_pool) {
+        deserialization_waitable_ =
+          std::make_shared<rclcpp::experimental::SubscriptionDeserializationWaitable>(
+          node_base->get_context(), thread_pool, &Subscription::deserialize_message);
+      }
+    }
+
     // Setup intra process publishing if requested.
-    if (rclcpp::detail::resolve_use_intra_process(options_, *node_base)) {
+    if (rclcpp::detail::resolve_use_intra_process(options, *node_base)) {
       using rclcpp::detail::resolve_intra_process_buffer_type;
 
       // Check if the QoS is compatible with intra-process.
@@ -163,9 +202,13 @@ public:
         throw std::invalid_argument(
                 "intraprocess communication is not allowed with 0 depth qos policy");
       }
-      if (qos_profile.durability() != rclcpp::DurabilityPolicy::Volatile) {
+      if (
+        qos_profile.durability() != rclcpp::DurabilityPolicy::Volatile &&
+        qos_profile.durability() != rclcpp::DurabilityPolicy::TransientLocal)
+      {
         throw std::invalid_argument(
-                "intraprocess communication allowed only with volatile durability");
+                "intraprocess communication allowed only with volatile or transient local "
+                "durability");
       }
 
       using SubscriptionIntraProcessT = rclcpp::experimental::SubscriptionIntraProcess<
@@ -176,15 +219,29 @@ public:
         ROSMessageT,
         AllocatorT>;
 
+      const auto buffer_implementation = options.latest_value_only ?
+        rclcpp::IntraProcessBufferImplementation::LatestValue :
+        options.intra_process_buffer_implementation;
+
       // First create a SubscriptionIntraProcess which will be given to the intra-process manager.
       auto context = node_base->get_context();
-      subscription_intra_process_ = std::make_shared<SubscriptionIntraProcessT>(
+      auto subscription_intra_process = std::make_shared<SubscriptionIntraProcessT>(
         callback,
-        options_.get_allocator(),
+        options.get_allocator(),
         context,
         this->get_topic_name(),  // important to get like this, as it has the fully-qualified name
         qos_profile,
-        resolve_intra_process_buffer_type(options_.intra_process_buffer_type, callback));
+        resolve_intra_process_buffer_type(options.intra_process_buffer_type, callback),
+        buffer_implementation,
+        options.latest_value_only ? nullptr : options.intra_process_buffer_factory);
+      subscription_intra_process->set_latest_message(latest_message_);
+      if (options.track_lineage) {
+        // Room for the messages queued and the ones dropped meanwhile
+        lineage_tracker_ = std::make_shared<rclcpp::MessageLineageTracker>(
+          2 * qos_profile.depth());
+        subscription_intra_process->set_lineage_tracker(lineage_tracker_);
+      }
+      subscription_intra_process_ = subscription_intra_process;
       TRACEPOINT(
         rclcpp_subscription_init,
         static_cast<const void *>(get_subscription_handle().get()),
@@ -195,10 +252,35 @@ public:
       auto ipm = context->get_sub_context<IntraProcessManager>();
       uint64_t intra_process_subscription_id = ipm->add_subscription(subscription_intra_process_);
       this->setup_intra_process(intra_process_subscription_id, ipm);
+
+      // Enabled once registered, so that the history replayed on registration is queued
+      if (options.intra_process_direct_dispatch && !options.latest_value_only) {
+        auto callback_group = options.callback_group ?
+          options.callback_group : node_base->get_default_callback_group();
+        subscription_intra_process_->set_direct_dispatch(
+          callback_group, options.intra_process_direct_dispatch_max_depth);
+      }
     }
 
     if (subscription_topic_statistics != nullptr) {
       this->subscription_topic_statistics_ = std::move(subscription_topic_statistics);
+      if (subscription_intra_process_) {
+        std::weak_ptr<rclcpp::experimental::SubscriptionIntraProcessBase>
+        weak_subscription_intra_process(subscription_intra_process_);
+        this->subscription_topic_statistics_->set_intra_process_buffer_metrics_source(
+          [weak_subscription_intra_process]()
+          -> std::optional<rclcpp::experimental::buffers::BufferMetrics> {
+            auto subscription_intra_process = weak_subscription_intra_process.lock();
+            if (!subscription_intra_process) {
+              return std::nullopt;
+            }
+            return subscription_intra_process->get_buffer_metrics();
+          });
+      }
+    }
+
+    if (rclcpp::MemoryAccounting::is_enabled()) {
+      setup_memory_accounting(node_base->get_fully_qualified_name());
     }
 
     TRACEPOINT(
@@ -268,17 +350,66 @@ public:
   >
   take(TakeT & message_out, rclcpp::MessageInfo & message_info_out)
   {
-    ROSMessageType local_message;
-    bool taken = this->take_type_erased(static_cast<void *>(&local_message), message_info_out);
-    if (taken) {
-      rclcpp::TypeAdapter<MessageT>::convert_to_custom(local_message, message_out);
+    if constexpr (rclcpp::detail::is_view_type_adapter<rclcpp::TypeAdapter<MessageT>>::value) {
+      // The taken message is shared with the view instead of being copied
+      auto local_message = std::make_shared<ROSMessageType>();
+      bool taken = this->take_type_erased(local_message.get(), message_info_out);
+      if (taken) {
+        rclcpp::TypeAdapter<MessageT>::convert_to_custom(
+          std::shared_ptr<const ROSMessageType>(std::move(local_message)), message_out);
+      }
+      return taken;
+    } else {
+      ROSMessageType local_message;
+      bool taken = this->take_type_erased(static_cast<void *>(&local_message), message_info_out);
+      if (taken) {
+        rclcpp::TypeAdapter<MessageT>::convert_to_custom(local_message, message_out);
+      }
+      return taken;
+    }
+  }
+
+  /// Return the last message delivered, or nullptr if none was delivered yet.
+  /**
+   * It's only kept with rclcpp::SubscriptionOptionsBase::latest_value_only, otherwise it
+   * returns nullptr.
+   * The message is stored before the callback is called, from another process or not, so a
+   * control loop can read the newest value at its own rate, without a queue of its own.
+   * It's not updated for the callbacks taking serialized messages.
+   * The callbacks must not modify the messages they share with the slot, i.e. the ones taking a
+   * std::shared_ptr to a non-const message.
+   *
+   * This member function is thread-safe.
+   */
+  std::shared_ptr<const ROSMessageType>
+  get_latest_message() const
+  {
+    if (!latest_message_) {
+      return nullptr;
     }
-    return taken;
+    return latest_message_->load();
+  }
+
+  /// Return the tracker of the flows of the intra-process messages received.
+  /**
+   * \return the tracker measuring the latency of the messages from the origin of their flow,
+   *   or nullptr if rclcpp::SubscriptionOptionsBase::track_lineage is disabled or the
+   *   subscription doesn't use intra-process communication.
+   */
+  std::shared_ptr<rclcpp::MessageLineageTracker>
+  get_lineage_tracker() const
+  {
+    return lineage_tracker_;
   }
 
   std::shared_ptr<void>
   create_message() override
   {
+    if (latest_message_) {
+      // The message may be kept by the slot of get_latest_message(), so it can't be reused
+      return std::allocate_shared<ROSMessageType>(
+        ROSMessageTypeAllocator(*allocator_));
+    }
     /* The default message memory strategy provides a dynamically allocated message on each call to
      * create_message, though alternative memory strategies that re-use a preallocated message may be
      * used (see rclcpp/strategies/message_pool_memory_strategy.hpp).
@@ -303,9 +434,14 @@ public:
       return;
     }
     auto typed_message = std::static_pointer_cast<ROSMessageType>(message);
+    if (latest_message_) {
+      latest_message_->store(typed_message);
+    }
 
+    const bool measure_message = subscription_topic_statistics_ &&
+      subscription_topic_statistics_->should_measure_message();
     std::chrono::time_point<std::chrono::system_clock> now;
-    if (subscription_topic_statistics_) {
+    if (measure_message) {
       // get current time before executing callback to
       // exclude callback duration from topic statistics result.
       now = std::chrono::system_clock::now();
@@ -313,7 +449,7 @@ public:
 
     any_callback_.dispatch(typed_message, message_info);
 
-    if (subscription_topic_statistics_) {
+    if (measure_message) {
       const auto nanos = std::chrono::time_point_cast<std::chrono::nanoseconds>(now);
       const auto time = rclcpp::Time(nanos.time_since_epoch().count());
       subscription_topic_statistics_->handle_message(*typed_message, time);
@@ -325,8 +461,16 @@ public:
     const std::shared_ptr<rclcpp::SerializedMessage> & serialized_message,
     const rclcpp::MessageInfo & message_info) override
   {
-    // TODO(wjwwood): enable topic statistics for serialized messages
-    any_callback_.dispatch(serialized_message, message_info);
+    std::shared_ptr<rclcpp::SerializedMessage> message = serialized_message;
+    const bool is_compressed =
+      rclcpp::PayloadDecompressor::is_compressed(message->get_rcl_serialized_message());
+    if (is_compressed) {
+      message = payload_decompressor_->decompress(message->get_rcl_serialized_message());
+    }
+    dispatch_serialized_message(message, message_info);
+    if (is_compressed) {
+      payload_decompressor_->release(message);
+    }
   }
 
   void
@@ -334,6 +478,35 @@ public:
     void * loaned_message,
     const rclcpp::MessageInfo & message_info) override
   {
+    if (any_callback_.is_loaned_message_callback()) {
+      // From now on the handle owns the loan, see keeps_loaned_messages()
+      rclcpp::SubscriptionLoanedMessage<ROSMessageType> handle(
+        get_subscription_handle(), static_cast<ROSMessageType *>(loaned_message));
+      if (matches_any_intra_process_publishers(
+          &message_info.get_rmw_message_info().publisher_gid))
+      {
+        return;
+      }
+      if (latest_message_) {
+        // The loan is returned to the middleware, so the slot gets a copy
+        latest_message_->store(std::make_shared<const ROSMessageType>(*handle));
+      }
+      const bool measure_message = subscription_topic_statistics_ &&
+        subscription_topic_statistics_->should_measure_message();
+      std::chrono::time_point<std::chrono::system_clock> now;
+      if (measure_message) {
+        now = std::chrono::system_clock::now();
+      }
+      // The copy given to the callback may be released before the statistics are updated
+      any_callback_.dispatch_loaned_message(handle, message_info);
+      if (measure_message) {
+        const auto nanos = std::chrono::time_point_cast<std::chrono::nanoseconds>(now);
+        const auto time = rclcpp::Time(nanos.time_since_epoch().count());
+        subscription_topic_statistics_->handle_message(*handle, time);
+      }
+      return;
+    }
+
     if (matches_any_intra_process_publishers(&message_info.get_rmw_message_info().publisher_gid)) {
       // In this case, the message will be delivered via intra process and
       // we should ignore this copy of the message.
@@ -341,12 +514,17 @@ public:
     }
 
     auto typed_message = static_cast<ROSMessageType *>(loaned_message);
+    if (latest_message_) {
+      latest_message_->store(std::make_shared<const ROSMessageType>(*typed_message));
+    }
     // message is loaned, so we have to make sure that the deleter does not deallocate the message
     auto sptr = std::shared_ptr<ROSMessageType>(
       typed_message, [](ROSMessageType * msg) {(void) msg;});
 
+    const bool measure_message = subscription_topic_statistics_ &&
+      subscription_topic_statistics_->should_measure_message();
     std::chrono::time_point<std::chrono::system_clock> now;
-    if (subscription_topic_statistics_) {
+    if (measure_message) {
       // get current time before executing callback to
       // exclude callback duration from topic statistics result.
       now = std::chrono::system_clock::now();
@@ -354,13 +532,19 @@ public:
 
     any_callback_.dispatch(sptr, message_info);
 
-    if (subscription_topic_statistics_) {
+    if (measure_message) {
       const auto nanos = std::chrono::time_point_cast<std::chrono::nanoseconds>(now);
       const auto time = rclcpp::Time(nanos.time_since_epoch().count());
       subscription_topic_statistics_->handle_message(*typed_message, time);
     }
   }
 
+  bool
+  keeps_loaned_messages() const override
+  {
+    return any_callback_.is_loaned_message_callback();
+  }
+
   /// Return the borrowed message.
   /**
    * \param[inout] message message to be returned
@@ -388,21 +572,139 @@ public:
     return any_callback_.use_take_shared_method();
   }
 
+  rclcpp::Waitable::SharedPtr
+  get_deserialization_waitable() const override
+  {
+    return deserialization_waitable_;
+  }
+
+  size_t
+  get_prefetch_depth() const override
+  {
+    return deserialization_waitable_ ? prefetch_depth_ : 0;
+  }
+
+  bool
+  take_and_prefetch() override
+  {
+    if (!deserialization_waitable_ || 0 == prefetch_depth_) {
+      return false;
+    }
+    return deserialization_waitable_->take_and_prefetch(
+      this->shared_from_this(), prefetch_depth_);
+  }
+
 private:
   RCLCPP_DISABLE_COPY(Subscription)
 
+  static
+  std::shared_ptr<void>
+  deserialize_message(const rclcpp::SerializedMessage & serialized_message)
+  {
+    static const rclcpp::Serialization<ROSMessageType> serialization;
+    auto message = std::make_shared<ROSMessageType>();
+    serialization.deserialize_message(&serialized_message, message.get());
+    return message;
+  }
+
+  void
+  dispatch_serialized_message(
+    const std::shared_ptr<rclcpp::SerializedMessage> & serialized_message,
+    const rclcpp::MessageInfo & message_info)
+  {
+    if (deserialization_waitable_) {
+      // The prefetched messages are dispatched by the thread pool, they are always handed over
+      if (0 == prefetch_depth_ &&
+        serialized_message->size() < deserialization_thread_pool_min_size_ &&
+        deserialization_waitable_->get_number_of_pending_messages() == 0)
+      {
+        auto message = deserialize_message(*serialized_message);
+        handle_message(message, message_info);
+      } else {
+        deserialization_waitable_->deserialize_async(
+          this->weak_from_this(), serialized_message, message_info);
+      }
+      return;
+    }
+    if (!any_callback_.is_serialized_message_callback()) {
+      // Only taken serialized to be decompressed, see SubscriptionOptionsBase::decompress_payloads
+      auto message = deserialize_message(*serialized_message);
+      handle_message(message, message_info);
+      return;
+    }
+    // TODO(wjwwood): enable topic statistics for serialized messages
+    any_callback_.dispatch(serialized_message, message_info);
+  }
+
+  /// Account the free serialized messages kept and the intra-process buffer, if any.
+  void
+  setup_memory_accounting(const std::string & node_name)
+  {
+    std::weak_ptr<message_memory_strategy::MessageMemoryStrategy<ROSMessageType, AllocatorT>>
+    weak_message_memory_strategy(message_memory_strategy_);
+    memory_account_ = rclcpp::MemoryAccounting::create_account(
+      node_name, this->get_topic_name(), rclcpp::MemoryEntityKind::Subscription,
+      [weak_message_memory_strategy]() {
+        rclcpp::MemorySample sample;
+        auto message_memory_strategy = weak_message_memory_strategy.lock();
+        if (message_memory_strategy) {
+          sample.bytes_in_use =
+            message_memory_strategy->serialized_message_pool_.get_free_capacity();
+        }
+        return sample;
+      });
+    if (!subscription_intra_process_) {
+      return;
+    }
+    std::weak_ptr<rclcpp::experimental::SubscriptionIntraProcessBase>
+    weak_subscription_intra_process(subscription_intra_process_);
+    intra_process_memory_account_ = rclcpp::MemoryAccounting::create_account(
+      node_name, this->get_topic_name(), rclcpp::MemoryEntityKind::IntraProcessBuffer,
+      [weak_subscription_intra_process]() {
+        rclcpp::MemorySample sample;
+        auto subscription_intra_process = weak_subscription_intra_process.lock();
+        if (subscription_intra_process) {
+          // The messages queued, the memory they reference isn't measured
+          const auto metrics = subscription_intra_process->get_buffer_metrics();
+          sample.bytes_in_use = metrics.depth * sizeof(SubscribedType);
+          sample.high_water_mark = metrics.high_water_mark * sizeof(SubscribedType);
+        }
+        return sample;
+      });
+  }
+
   AnySubscriptionCallback<MessageT, AllocatorT> any_callback_;
-  /// Copy of original options passed during construction.
+  /// What the subscription keeps of the options passed during construction.
   /**
-   * It is important to save a copy of this so that the rmw payload which it
-   * may contain is kept alive for the duration of the subscription.
+   * Only these are kept instead of a copy of the options, to keep the footprint of processes with
+   * many subscriptions small.
+   * The storage of the rcl allocator and the rmw payload are kept alive for the duration of the
+   * subscription, as the rcl subscription refers to them.
    */
-  const rclcpp::SubscriptionOptionsWithAllocator<AllocatorT> options_;
+  const std::shared_ptr<AllocatorT> allocator_;
+  const std::shared_ptr<void> rcl_allocator_storage_;
+  const std::shared_ptr<rclcpp::detail::RMWImplementationSpecificSubscriptionPayload>
+  rmw_implementation_payload_;
+  const size_t deserialization_thread_pool_min_size_;
+  const size_t prefetch_depth_;
   typename message_memory_strategy::MessageMemoryStrategy<ROSMessageType, AllocatorT>::SharedPtr
     message_memory_strategy_;
+  /// Set when the messages are deserialized on the thread pool of the options
+  std::shared_ptr<rclcpp::experimental::SubscriptionDeserializationWaitable>
+  deserialization_waitable_;
+  /// Buffers of the messages decompressed, only created when the messages are taken serialized
+  std::unique_ptr<rclcpp::PayloadDecompressor> payload_decompressor_;
+  /// Slot of get_latest_message(), set with SubscriptionOptionsBase::latest_value_only
+  typename rclcpp::LatestMessage<ROSMessageType>::SharedPtr latest_message_;
+  /// Tracker of get_lineage_tracker(), set with SubscriptionOptionsBase::track_lineage
+  std::shared_ptr<rclcpp::MessageLineageTracker> lineage_tracker_;
 
   /// Component which computes and publishes topic statistics for this subscriber
   SubscriptionTopicStatisticsSharedPtr subscription_topic_statistics_{nullptr};
+
+  /// Accounts of the memory of the subscription, nullptr when the memory isn't accounted.
+  rclcpp::MemoryAccount::SharedPtr memory_account_;
+  rclcpp::MemoryAccount::SharedPtr intra_process_memory_account_;
 };
 
 }  // namespace rclcpp
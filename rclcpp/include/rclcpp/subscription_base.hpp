@@ -16,8 +16,11 @@
 #define RCLCPP__SUBSCRIPTION_BASE_HPP_
 
 #include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -30,6 +33,7 @@
 #include "rmw/rmw.h"
 
 #include "rclcpp/any_subscription_callback.hpp"
+#include "rclcpp/content_filter.hpp"
 #include "rclcpp/detail/cpp_callback_trampoline.hpp"
 #include "rclcpp/experimental/intra_process_manager.hpp"
 #include "rclcpp/experimental/subscription_intra_process_base.hpp"
@@ -38,6 +42,7 @@
 #include "rclcpp/network_flow_endpoint.hpp"
 #include "rclcpp/qos.hpp"
 #include "rclcpp/qos_event.hpp"
+#include "rclcpp/rate_limit.hpp"
 #include "rclcpp/serialized_message.hpp"
 #include "rclcpp/subscription_content_filter_options.hpp"
 #include "rclcpp/type_support_decl.hpp"
@@ -118,6 +123,16 @@ public:
   std::unordered_map<rcl_subscription_event_type_t, std::shared_ptr<rclcpp::QOSEventHandlerBase>> &
   get_event_handlers() const;
 
+  /// Get the waitable dispatching all the QoS events of this subscription.
+  /**
+   * The executors wait for the events of the subscription through this single waitable, rather than
+   * through each handler of get_event_handlers().
+   * \return The waitable, nullptr if there is no event handler.
+   */
+  RCLCPP_PUBLIC
+  std::shared_ptr<rclcpp::CompositeQOSEventHandler>
+  get_composite_event_handler() const;
+
   /// Get the actual QoS settings, after the defaults have been determined.
   /**
    * The actual configuration applied when using RMW_QOS_POLICY_*_SYSTEM_DEFAULT
@@ -155,6 +170,31 @@ public:
   bool
   take_type_erased(void * message_out, rclcpp::MessageInfo & message_info_out);
 
+  /// Take the next inter-process message, without its rclcpp::MessageInfo.
+  /**
+   * The middleware then doesn't fill the message info, which is cheaper for high-rate topics.
+   * It's only valid if needs_message_info() returns false, the executor then handles the
+   * message with an empty message info.
+   *
+   * \sa take_type_erased()
+   * \param[out] message_out The type erased message pointer into which take
+   *   will copy the data.
+   * \returns true if data was taken and is valid, otherwise false
+   * \throws any rmw errors from rmw_take, \sa rclcpp::exceptions::throw_from_rcl_error()
+   */
+  RCLCPP_PUBLIC
+  bool
+  take_type_erased_without_info(void * message_out);
+
+  /// Return true if the messages handled need their rclcpp::MessageInfo.
+  /**
+   * It's the case if the callback takes it, or if the intra-process communication is used,
+   * as the message info tells which messages are duplicates of the intra-process ones.
+   */
+  RCLCPP_PUBLIC
+  bool
+  needs_message_info() const;
+
   /// Take the next inter-process message, in its serialized form, from the subscription.
   /**
    * For now, if data is taken (written) into the message_out and
@@ -209,6 +249,50 @@ public:
   void
   handle_loaned_message(void * loaned_message, const rclcpp::MessageInfo & message_info) = 0;
 
+  /// Return true if handle_loaned_message() takes the ownership of the loaned messages.
+  /**
+   * In that case the subscription returns the loaned messages to the middleware itself,
+   * e.g. when the user releases the rclcpp::SubscriptionLoanedMessage given to its callback,
+   * otherwise the caller returns them after handle_loaned_message().
+   */
+  RCLCPP_PUBLIC
+  virtual
+  bool
+  keeps_loaned_messages() const;
+
+  /// Return the waitable of the messages deserialized off the executor threads.
+  /**
+   * \return the waitable, or nullptr if the subscription doesn't use a deserialization thread
+   *   pool, see rclcpp::SubscriptionOptionsBase::deserialization_thread_pool.
+   */
+  RCLCPP_PUBLIC
+  virtual
+  rclcpp::Waitable::SharedPtr
+  get_deserialization_waitable() const;
+
+  /// Return the number of messages the thread pool takes ahead of the executor.
+  /**
+   * \return 0 if the messages aren't prefetched, see
+   *   rclcpp::SubscriptionOptionsBase::prefetch_depth.
+   */
+  RCLCPP_PUBLIC
+  virtual
+  size_t
+  get_prefetch_depth() const;
+
+  /// Take the next message, and have the thread pool prefetch the next ones.
+  /**
+   * The executors call it instead of taking the messages themselves when get_prefetch_depth()
+   * isn't 0, the message is then handled from the deserialization waitable.
+   *
+   * \return true if a message was taken, false if none was ready or nothing is prefetched.
+   * \throws any rcl errors from rcl_take, \sa rclcpp::exceptions::throw_from_rcl_error()
+   */
+  RCLCPP_PUBLIC
+  virtual
+  bool
+  take_and_prefetch();
+
   /// Return the message borrowed in create_message.
   /** \param[in] message Shared pointer to the returned message. */
   RCLCPP_PUBLIC
@@ -235,6 +319,121 @@ public:
   bool
   is_serialized() const;
 
+  /// Set the maximum number of messages taken by the executor each time this is ready.
+  /**
+   * The executor keeps taking and handling messages until this many have been taken or
+   * the subscription queue is empty, without waiting again in between.
+   * Use std::numeric_limits<size_t>::max() to always take until the queue is empty.
+   *
+   * \param[in] max_messages_per_take The maximum number of messages, 0 to use the
+   *   setting of the executor.
+   */
+  RCLCPP_PUBLIC
+  void
+  set_max_messages_per_take(size_t max_messages_per_take);
+
+  /// Return the maximum number of messages taken by the executor each time this is ready.
+  /**
+   * \return The maximum number of messages, 0 if the setting of the executor is used.
+   */
+  RCLCPP_PUBLIC
+  size_t
+  get_max_messages_per_take() const;
+
+  /// Return the rate limiter of the messages received.
+  /**
+   * \return the rate limiter counting the messages kept and dropped, or nullptr if
+   *   rclcpp::SubscriptionOptionsBase::rate_limit is disabled.
+   */
+  RCLCPP_PUBLIC
+  std::shared_ptr<const rclcpp::RateLimiter>
+  get_rate_limiter() const;
+
+  /// Return the maximum age of the messages delivered, 0 if they are delivered whatever their age.
+  RCLCPP_PUBLIC
+  std::chrono::nanoseconds
+  get_max_message_age() const;
+
+  /// Return the number of messages dropped for being older than the maximum age.
+  /**
+   * See rclcpp::SubscriptionOptionsBase::max_message_age.
+   */
+  RCLCPP_PUBLIC
+  uint64_t
+  get_expired_message_count() const;
+
+  /// Return true if a message already taken is older than the maximum age, and count it.
+  /**
+   * take_type_erased() and take_serialized() drop the expired messages themselves, before they
+   * are deserialized, this is for the messages taken otherwise, e.g. loaned ones.
+   *
+   * \param[in] message_info the info of the message taken.
+   */
+  RCLCPP_PUBLIC
+  bool
+  drop_by_age(const rclcpp::MessageInfo & message_info);
+
+  /// Stop delivering the messages, without destroying the subscription.
+  /**
+   * The subscription stays matched with the publishers, so that resume() is immediate, but the
+   * messages received meanwhile are dropped: the executors take them serialized, without
+   * deserializing them nor calling the callback, and the intra-process messages aren't queued.
+   * The messages taken explicitly, e.g. with a wait set and take(), are still delivered.
+   *
+   * This function is thread-safe.
+   */
+  RCLCPP_PUBLIC
+  void
+  pause();
+
+  /// Deliver the messages received from now on again.
+  /**
+   * This function is thread-safe.
+   */
+  RCLCPP_PUBLIC
+  void
+  resume();
+
+  RCLCPP_PUBLIC
+  bool
+  is_paused() const;
+
+  /// Return the number of messages dropped while the subscription was paused.
+  RCLCPP_PUBLIC
+  uint64_t
+  get_paused_dropped_count() const;
+
+  /// Drop the messages waiting in the middleware without deserializing them, while paused.
+  /**
+   * Called by the executors instead of taking the messages, when the subscription is paused.
+   *
+   * \param[in] max_messages the maximum number of messages to drop.
+   * \return the number of messages dropped.
+   */
+  RCLCPP_PUBLIC
+  size_t
+  drop_paused_messages(size_t max_messages);
+
+  /// Return true if the rate limit drops a message already taken, and count it.
+  /**
+   * take_type_erased() and take_serialized() apply the rate limit themselves, before the
+   * messages are deserialized, this is for the messages taken otherwise, e.g. loaned ones.
+   */
+  RCLCPP_PUBLIC
+  bool
+  drop_by_rate_limit();
+
+  /// Return true if the content filter evaluated by rclcpp drops a message already taken.
+  /**
+   * take_type_erased() and take_serialized() apply the content filter themselves, before the
+   * messages are deserialized, this is for the messages taken otherwise, e.g. loaned ones.
+   *
+   * \param[in] message the message taken, of the ROS message type of the subscription.
+   */
+  RCLCPP_PUBLIC
+  bool
+  drop_by_content_filter(const void * message) const;
+
   /// Get matching publisher count.
   /** \return The number of publishers on this topic. */
   RCLCPP_PUBLIC
@@ -271,6 +470,18 @@ public:
   rclcpp::Waitable::SharedPtr
   get_intra_process_waitable() const;
 
+  /// Return the occupancy and traffic counters of the intra-process buffer.
+  /**
+   * The buffer stores the intra-process messages until the subscription executes, it has room
+   * for the QoS depth messages and drops the oldest one when full.
+   * The high-water mark and the dropped count help choosing the depth.
+   *
+   * \return the metrics of the buffer, or std::nullopt if intra-process is not setup.
+   */
+  RCLCPP_PUBLIC
+  std::optional<rclcpp::experimental::buffers::BufferMetrics>
+  get_intra_process_buffer_metrics() const;
+
   /// Exchange state of whether or not a part of the subscription is used by a wait set.
   /**
    * Used to ensure parts of the subscription are not used with multiple wait
@@ -503,14 +714,31 @@ public:
 
   /// Check if content filtered topic feature of the subscription instance is enabled.
   /**
+   * This is only true if the middleware filters the messages, see is_content_filter_enabled().
+   *
    * \return boolean flag indicating if the content filtered topic of this subscription is enabled.
    */
   RCLCPP_PUBLIC
   bool
   is_cft_enabled() const;
 
+  /// Check if the messages of the subscription are filtered on their content.
+  /**
+   * The middleware filters the messages if it supports content filtered topics, otherwise
+   * rclcpp evaluates the filter expression, see rclcpp::ContentFilter, before the messages are
+   * deserialized and given to the callback.
+   *
+   * \return true if the middleware or rclcpp filters the messages.
+   */
+  RCLCPP_PUBLIC
+  bool
+  is_content_filter_enabled() const;
+
   /// Set the filter expression and expression parameters for the subscription.
   /**
+   * If the middleware doesn't support content filtered topics, rclcpp filters the messages.
+   * The intra-process messages are always filtered by rclcpp.
+   *
    * \param[in] filter_expression A filter expression to set.
    *   \sa ContentFilterOptions::filter_expression
    *   An empty string ("") will clear the content filter setting of the subscription.
@@ -518,6 +746,8 @@ public:
    *   \sa ContentFilterOptions::expression_parameters
    * \throws RCLBadAlloc if memory cannot be allocated
    * \throws RCLError if an unexpect error occurs
+   * \throws std::invalid_argument if rclcpp filters the messages and the expression can't be
+   *   compiled, see rclcpp::ContentFilter.
    */
   RCLCPP_PUBLIC
   void
@@ -527,7 +757,8 @@ public:
 
   /// Get the filter expression and expression parameters for the subscription.
   /**
-   * \return rclcpp::ContentFilterOptions The content filter options to get.
+   * \return rclcpp::ContentFilterOptions The content filter options to get, empty if the
+   *   messages aren't filtered.
    * \throws RCLBadAlloc if memory cannot be allocated
    * \throws RCLError if an unexpect error occurs
    */
@@ -550,6 +781,10 @@ protected:
       event_type);
     qos_events_in_use_by_wait_set_.insert(std::make_pair(handler.get(), false));
     event_handlers_.insert(std::make_pair(event_type, handler));
+    if (!composite_event_handler_) {
+      composite_event_handler_ = std::make_shared<rclcpp::CompositeQOSEventHandler>();
+    }
+    composite_event_handler_->add_handler(handler);
   }
 
   RCLCPP_PUBLIC
@@ -559,6 +794,47 @@ protected:
   bool
   matches_any_intra_process_publishers(const rmw_gid_t * sender_gid) const;
 
+  /// Set the rate limit of the messages received, called by the constructors of subscriptions.
+  /**
+   * It must be called before setup_intra_process(), which applies it to the intra-process
+   * subscription.
+   *
+   * \throws std::invalid_argument if the options are invalid, see rclcpp::RateLimiter.
+   */
+  RCLCPP_PUBLIC
+  void
+  set_rate_limit(const rclcpp::RateLimitOptions & options);
+
+  /// Set the maximum age of the messages delivered, called by the constructors of subscriptions.
+  /**
+   * It must be called before setup_intra_process(), which applies it to the intra-process
+   * subscription.
+   *
+   * \param[in] max_message_age the maximum age, 0 to deliver the messages whatever their age.
+   * \throws std::invalid_argument if the maximum age is negative.
+   */
+  RCLCPP_PUBLIC
+  void
+  set_max_message_age(std::chrono::nanoseconds max_message_age);
+
+  /// Set up the filter given in the options, called by the constructors of subscriptions.
+  /**
+   * rclcpp filters the messages the middleware doesn't, see set_content_filter().
+   * It must be called before setup_intra_process(), which applies it to the intra-process
+   * subscription.
+   *
+   * \throws std::invalid_argument if rclcpp filters the messages and the expression can't be
+   *   compiled, see rclcpp::ContentFilter.
+   */
+  RCLCPP_PUBLIC
+  void
+  setup_content_filter(const rclcpp::ContentFilterOptions & options);
+
+  /// Set if the callback takes the rclcpp::MessageInfo, see needs_message_info().
+  RCLCPP_PUBLIC
+  void
+  set_message_info_needed(bool needed);
+
   RCLCPP_PUBLIC
   void
   set_on_new_message_callback(rcl_event_callback_t callback, const void * user_data);
@@ -572,6 +848,7 @@ protected:
 
   std::unordered_map<rcl_subscription_event_type_t,
     std::shared_ptr<rclcpp::QOSEventHandlerBase>> event_handlers_;
+  std::shared_ptr<rclcpp::CompositeQOSEventHandler> composite_event_handler_;
 
   bool use_intra_process_;
   IntraProcessManagerWeakPtr weak_ipm_;
@@ -583,8 +860,69 @@ protected:
 private:
   RCLCPP_DISABLE_COPY(SubscriptionBase)
 
+  /// What take_rate_limited() left to take.
+  enum class RateLimitTake
+  {
+    /// No message is left, all the queued ones were dropped.
+    Nothing,
+    /// The next message is kept and can be taken.
+    Next,
+    /// The newest message is kept, it was taken into the latest_message buffer.
+    Latest,
+  };
+
+  /// Take and drop serialized the messages the rate limit doesn't keep.
+  RateLimitTake
+  take_rate_limited(rclcpp::MessageInfo & message_info_out);
+
+  /// Take a serialized message matching the content filter, without applying the rate limit.
+  bool
+  take_serialized_message(
+    rclcpp::SerializedMessage & message_out, rclcpp::MessageInfo & message_info_out);
+
+  /// Compile the filter evaluated by rclcpp, for the messages the middleware doesn't filter.
+  void
+  set_client_content_filter(
+    const rclcpp::ContentFilterOptions & options, bool middleware_filters);
+
   rosidl_message_type_support_t type_support_;
   bool is_serialized_;
+  std::atomic<size_t> max_messages_per_take_{0};
+  bool message_info_needed_ = true;
+
+  /// Buffers reused to take serialized messages, only needed by the rate limit and the filter.
+  /**
+   * They only hold a message during a take, which fills and reads them on its thread.
+   */
+  struct TakeBuffers
+  {
+    /// The messages dropped by the rate limit and the newest one queued.
+    rclcpp::SerializedMessage dropped_message;
+    rclcpp::SerializedMessage latest_message;
+    /// The messages to filter before deserializing them.
+    rclcpp::SerializedMessage filtered_message;
+  };
+
+  /// Return the buffers of the calling thread to take serialized messages.
+  /**
+   * The subscriptions of a reentrant callback group are taken from by several threads at
+   * once, so each thread has its own buffers, shared by all the subscriptions it takes from.
+   * They are created on the first call of each thread, as most threads never need them.
+   */
+  static TakeBuffers &
+  get_take_buffers();
+
+  std::shared_ptr<rclcpp::RateLimiter> rate_limiter_;
+
+  /// Filter evaluated by rclcpp, for all the messages and for the intra-process ones.
+  std::shared_ptr<const rclcpp::ContentFilter> content_filter_;
+  std::shared_ptr<const rclcpp::ContentFilter> inter_process_content_filter_;
+
+  std::atomic<bool> paused_{false};
+  std::atomic<uint64_t> paused_dropped_count_{0};
+
+  std::chrono::nanoseconds max_message_age_{0};
+  std::atomic<uint64_t> expired_message_count_{0};
 
   std::atomic<bool> subscription_in_use_by_wait_set_{false};
   std::atomic<bool> intra_process_subscription_waitable_in_use_by_wait_set_{false};
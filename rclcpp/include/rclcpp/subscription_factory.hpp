@@ -17,7 +17,9 @@
 
 #include <functional>
 #include <memory>
+#include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <utility>
 
 #include "rcl/subscription.h"
@@ -67,7 +69,8 @@ struct SubscriptionFactory
 /**
  * \param[in] callback The user-defined callback function to receive a message
  * \param[in] options Additional options for the creation of the Subscription.
- * \param[in] msg_mem_strat The message memory strategy to use for allocating messages.
+ * \param[in] msg_mem_strat The message memory strategy to use for allocating messages,
+ *   nullptr for the default one using the allocator of the options.
  * \param[in] subscription_topic_stats Optional stats callback for topic_statistics
  */
 template<
@@ -89,6 +92,15 @@ create_subscription_factory(
 {
   auto allocator = options.get_allocator();
 
+  if (!msg_mem_strat) {
+    if constexpr (std::is_constructible_v<MessageMemoryStrategyT, std::shared_ptr<AllocatorT>>) {
+      // Allocate the messages like the rest of the subscription, e.g. from its memory resource
+      msg_mem_strat = std::make_shared<MessageMemoryStrategyT>(allocator);
+    } else {
+      throw std::invalid_argument("message memory strategy cannot be nullptr");
+    }
+  }
+
   using rclcpp::AnySubscriptionCallback;
   AnySubscriptionCallback<MessageT, AllocatorT> any_subscription_callback(*allocator);
   any_subscription_callback.set(std::forward<CallbackT>(callback));
@@ -101,10 +113,10 @@ create_subscription_factory(
       const rclcpp::QoS & qos
     ) -> rclcpp::SubscriptionBase::SharedPtr
     {
-      using rclcpp::Subscription;
       using rclcpp::SubscriptionBase;
 
-      auto sub = Subscription<MessageT, AllocatorT>::make_shared(
+      // SubscriptionT may derive from rclcpp::Subscription, e.g. to be managed by a node
+      auto sub = std::make_shared<SubscriptionT>(
         node_base,
         rclcpp::get_message_type_support_handle<MessageT>(),
         topic_name,
@@ -0,0 +1,147 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__SUBSCRIPTION_LOANED_MESSAGE_HPP_
+#define RCLCPP__SUBSCRIPTION_LOANED_MESSAGE_HPP_
+
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "rcl/error_handling.h"
+#include "rcl/subscription.h"
+
+#include "rclcpp/logging.hpp"
+
+namespace rclcpp
+{
+
+/// Handle to a message received by a subscription, possibly loaned by the middleware.
+/**
+ * When the middleware can loan messages, the handle refers to the loaned sample, e.g. in
+ * shared memory, without any copy.
+ * Unlike the messages given to the other callback signatures, it can be kept after the
+ * callback returns: the loan is returned to the middleware when the last copy of the handle
+ * is destroyed or reset, possibly from another thread.
+ * Keeping many loans may prevent the middleware from receiving new samples.
+ *
+ * Messages which aren't loaned, e.g. delivered intra-process or by a middleware which can't
+ * loan, are given through the same handle, which then shares the ownership of the message.
+ */
+template<typename MessageT>
+class SubscriptionLoanedMessage
+{
+public:
+  /// Create a handle owning a message loaned by the middleware to a subscription.
+  /**
+   * \param[in] subscription_handle the subscription which took the loaned message, kept alive
+   *   until the loan is returned.
+   * \param[in] loaned_message the message loaned by the middleware.
+   * \throws std::invalid_argument if any of the arguments is nullptr.
+   */
+  SubscriptionLoanedMessage(
+    std::shared_ptr<rcl_subscription_t> subscription_handle,
+    MessageT * loaned_message)
+  : loaned_(true)
+  {
+    if (!subscription_handle || !loaned_message) {
+      throw std::invalid_argument("subscription handle and loaned message cannot be nullptr");
+    }
+    message_ = std::shared_ptr<const MessageT>(
+      loaned_message,
+      [subscription_handle = std::move(subscription_handle)](const MessageT * message)
+      {
+        rcl_ret_t ret = rcl_return_loaned_message_from_subscription(
+          subscription_handle.get(), const_cast<MessageT *>(message));
+        if (RCL_RET_OK != ret) {
+          RCLCPP_ERROR(
+            rclcpp::get_logger("rclcpp"),
+            "rcl_return_loaned_message_from_subscription() failed: %s",
+            rcl_get_error_string().str);
+          rcl_reset_error();
+        }
+      });
+  }
+
+  /// Create a handle sharing the ownership of a message which isn't loaned.
+  explicit SubscriptionLoanedMessage(std::shared_ptr<const MessageT> message)
+  : message_(std::move(message)),
+    loaned_(false)
+  {}
+
+  SubscriptionLoanedMessage(const SubscriptionLoanedMessage &) = default;
+  SubscriptionLoanedMessage(SubscriptionLoanedMessage &&) noexcept = default;
+  SubscriptionLoanedMessage & operator=(const SubscriptionLoanedMessage &) = default;
+  SubscriptionLoanedMessage & operator=(SubscriptionLoanedMessage &&) noexcept = default;
+
+  /// Return the message.
+  /**
+   * \throws std::runtime_error if the handle was reset.
+   */
+  const MessageT &
+  get() const
+  {
+    if (!message_) {
+      throw std::runtime_error("the subscription loaned message was reset");
+    }
+    return *message_;
+  }
+
+  const MessageT &
+  operator*() const
+  {
+    return get();
+  }
+
+  const MessageT *
+  operator->() const
+  {
+    return &get();
+  }
+
+  /// Return true if the handle still refers to a message.
+  explicit operator bool() const
+  {
+    return static_cast<bool>(message_);
+  }
+
+  /// Return true if the message is loaned by the middleware rather than copied.
+  bool
+  is_loaned() const
+  {
+    return loaned_ && message_;
+  }
+
+  /// Return a shared pointer to the message, which keeps the loan as long as the handle.
+  std::shared_ptr<const MessageT>
+  get_shared() const
+  {
+    return message_;
+  }
+
+  /// Release this handle, returning the loan if it was the last one referring to it.
+  void
+  reset()
+  {
+    message_.reset();
+  }
+
+private:
+  std::shared_ptr<const MessageT> message_;
+  bool loaned_;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__SUBSCRIPTION_LOANED_MESSAGE_HPP_
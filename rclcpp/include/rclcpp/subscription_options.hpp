@@ -16,18 +16,23 @@
 #define RCLCPP__SUBSCRIPTION_OPTIONS_HPP_
 
 #include <chrono>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <type_traits>
 #include <vector>
 
+#include "rclcpp/allocator/memory_resource.hpp"
 #include "rclcpp/callback_group.hpp"
+#include "rclcpp/deserialization_thread_pool.hpp"
 #include "rclcpp/detail/rmw_implementation_specific_subscription_payload.hpp"
+#include "rclcpp/experimental/buffers/buffer_implementation_factory.hpp"
 #include "rclcpp/intra_process_buffer_type.hpp"
 #include "rclcpp/intra_process_setting.hpp"
 #include "rclcpp/qos.hpp"
 #include "rclcpp/qos_event.hpp"
 #include "rclcpp/qos_overriding_options.hpp"
+#include "rclcpp/rate_limit.hpp"
 #include "rclcpp/subscription_content_filter_options.hpp"
 #include "rclcpp/topic_statistics_state.hpp"
 #include "rclcpp/visibility_control.hpp"
@@ -52,6 +57,13 @@ struct SubscriptionOptionsBase
   rmw_unique_network_flow_endpoints_requirement_t require_unique_network_flow_endpoints =
     RMW_UNIQUE_NETWORK_FLOW_ENDPOINTS_NOT_REQUIRED;
 
+  /// Maximum number of messages taken by the executor each time the subscription is ready.
+  /**
+   * 0 to use the setting of the executor, std::numeric_limits<size_t>::max() to take until
+   * the subscription queue is empty.
+   */
+  size_t max_messages_per_take = 0;
+
   /// The callback group for this subscription. NULL to use the default callback group.
   rclcpp::CallbackGroup::SharedPtr callback_group = nullptr;
 
@@ -61,6 +73,126 @@ struct SubscriptionOptionsBase
   /// Setting the data-type stored in the intraprocess buffer
   IntraProcessBufferType intra_process_buffer_type = IntraProcessBufferType::CallbackDefault;
 
+  /// Setting the implementation of the intraprocess buffer
+  IntraProcessBufferImplementation intra_process_buffer_implementation =
+    IntraProcessBufferImplementation::Default;
+
+  /// Factory of a custom implementation of the intraprocess buffer, nullptr for the builtin ones.
+  /**
+   * It replaces intra_process_buffer_implementation, to e.g. prioritize the messages or cap the
+   * memory they use.
+   * It has to derive from rclcpp::experimental::buffers::BufferImplementationFactory for the
+   * type of element the buffer stores, which depends on intra_process_buffer_type, see
+   * rclcpp::experimental::buffers::DepthBufferImplementationFactory to support both.
+   * rclcpp::experimental::buffers::AdaptiveBufferImplementationFactory creates buffers whose
+   * capacity follows the lag of the subscription, within a memory budget.
+   * Creating the subscription throws std::invalid_argument if it doesn't.
+   */
+  std::shared_ptr<rclcpp::experimental::buffers::BufferImplementationFactoryBase>
+  intra_process_buffer_factory = nullptr;
+
+  /// Execute the callback on the publishing thread for the intra-process messages.
+  /**
+   * This avoids waking the executor, at the cost of blocking the publisher while the callback
+   * runs.
+   * A message is only dispatched directly when the callback group can be reserved, always
+   * for a reentrant one, otherwise it's queued for the executor as usual.
+   */
+  bool intra_process_direct_dispatch = false;
+
+  /// Maximum number of direct dispatches nested on a thread, e.g. in a chain of components.
+  /**
+   * The messages published deeper in the chain are queued for the executor, which bounds the
+   * stack growth.
+   */
+  size_t intra_process_direct_dispatch_max_depth = 4;
+
+  /// Thread pool deserializing the messages off the executor threads, nullptr to disable.
+  /**
+   * The executor takes the messages serialized and the thread pool deserializes them, then the
+   * executor runs the callback once the message is ready, so a large message doesn't block the
+   * other callbacks of the executor while it's deserialized.
+   * The callbacks still run in the order in which the messages were taken.
+   * It doesn't apply to the callbacks which take serialized messages, nor to the messages
+   * taken by the user from a wait set.
+   */
+  rclcpp::DeserializationThreadPool::SharedPtr deserialization_thread_pool = nullptr;
+
+  /// Serialized size below which the messages are deserialized by the executor itself.
+  /**
+   * Small messages are cheaper to deserialize than to hand over to the thread pool.
+   * They are still handed over while older messages are being deserialized, to keep the order.
+   */
+  size_t deserialization_thread_pool_min_size = 0;
+
+  /// Number of messages taken ahead by the thread pool while the callbacks run, 0 to disable.
+  /**
+   * Each time the executor takes a message, the thread pool takes and deserializes the next
+   * ready messages, up to this number of them in flight, so that the time spent in the
+   * middleware is off the executor threads too.
+   * The callbacks still run from the executor, in the order in which the messages were taken.
+   * The thread pool is deserialization_thread_pool, or the worker pool of the context if it
+   * is nullptr, see rclcpp::Context::get_worker_pool().
+   * Like deserialization_thread_pool, it doesn't apply to the callbacks which take serialized
+   * messages, and the messages are always handed over, whatever their size.
+   */
+  size_t prefetch_depth = 0;
+
+  /// Whether the subscription decompresses the messages compressed by the publishers.
+  /**
+   * The messages are then taken serialized, and deserialized once decompressed, see
+   * rclcpp::PublisherOptionsBase::payload_compression.
+   * The callbacks taking serialized messages always get them decompressed, like the generic
+   * subscriptions, so this only needs to be enabled for the other callbacks.
+   */
+  bool decompress_payloads = false;
+
+  /// Downsampling of the messages received, disabled by default.
+  /**
+   * The messages dropped from other processes are taken serialized, so they aren't
+   * deserialized, and the intra-process ones are dropped before being queued.
+   * The middleware has no time or sequence based filtering to delegate it to, see
+   * content_filter_options to filter on the content of the messages instead.
+   * See rclcpp::SubscriptionBase::get_rate_limiter() for the number of messages dropped.
+   */
+  RateLimitOptions rate_limit;
+
+  /// Maximum age of the messages delivered, 0 to deliver them whatever their age.
+  /**
+   * Under overload the messages older than this are dropped when they are taken, before being
+   * deserialized, so that the callbacks catch up with the newest data.
+   * The age of the messages of other processes is measured from their source timestamp, on the
+   * system clock, the messages without one are always delivered.
+   * The age of the intra-process messages is measured from the time they were queued.
+   * See rclcpp::SubscriptionBase::get_expired_message_count() for the number of messages
+   * dropped.
+   */
+  std::chrono::nanoseconds max_message_age{0};
+
+  /// Keep only the newest message, for topics such as states where older values are stale.
+  /**
+   * The middleware keeps the last message only, whatever the history and depth of the QoS, and
+   * the intra-process messages are stored in a single slot swapped atomically, see
+   * rclcpp::IntraProcessBufferImplementation::LatestValue.
+   * The executor is woken once for the messages received since the previous take, so the
+   * callback is called at most once per executor pass, with the newest message.
+   * rclcpp::Subscription::get_latest_message() returns the last message delivered, from any
+   * thread.
+   * intra_process_buffer_implementation, intra_process_buffer_factory and
+   * intra_process_direct_dispatch are then ignored.
+   */
+  bool latest_value_only = false;
+
+  /// Whether the flows of the intra-process messages received are tracked, disabled by default.
+  /**
+   * The flow of a message published with rclcpp::PublisherOptionsBase::propagate_lineage is
+   * given in the rclcpp::MessageInfo and is current while the callback runs, so the messages
+   * published from the callback continue it, and the latency from the origin of the flow is
+   * measured when the message is taken, see rclcpp::Subscription::get_lineage_tracker().
+   * The messages of other processes have no flow, as the middleware can't carry it.
+   */
+  bool track_lineage = false;
+
   /// Optional RMW implementation specific payload to be used during creation of the subscription.
   std::shared_ptr<rclcpp::detail::RMWImplementationSpecificSubscriptionPayload>
   rmw_implementation_payload = nullptr;
@@ -77,12 +209,33 @@ struct SubscriptionOptionsBase
     // Topic statistics publication period in ms. Defaults to one second.
     // Only values greater than zero are allowed.
     std::chrono::milliseconds publish_period{std::chrono::seconds(1)};
+
+    // Percentiles of the message age and period to publish, e.g. {50.0, 99.0, 99.9}.
+    // Each is published as a metric of its own, none by default.
+    // Only values in ]0, 100] are allowed.
+    std::vector<double> percentiles;
+
+    // Measure one received message out of sample_every_n_messages, 1 measures all of them.
+    // The period of the measured messages is scaled to the period between the messages.
+    // Only values greater than zero are allowed.
+    uint64_t sample_every_n_messages = 1;
+
+    // Maximum number of messages measured per publish period, 0 for no limit.
+    // The sampling interval is adapted to the rate of the topic at the end of each period,
+    // so the cost of the measurements doesn't grow with the rate.
+    uint64_t max_samples_per_period = 0;
   };
 
   TopicStatisticsOptions topic_stats_options;
 
   QosOverridingOptions qos_overriding_options;
 
+  /// Options to filter the messages on their content.
+  /**
+   * The middleware filters the messages if it supports content filtered topics, otherwise
+   * rclcpp does, see rclcpp::ContentFilter for the expressions it supports.
+   * The intra-process messages are always filtered by rclcpp.
+   */
   ContentFilterOptions content_filter_options;
 };
 
@@ -116,6 +269,10 @@ struct SubscriptionOptionsWithAllocator : public SubscriptionOptionsBase
     rcl_subscription_options_t result = rcl_subscription_get_default_options();
     result.allocator = this->get_rcl_allocator();
     result.qos = qos.get_rmw_qos_profile();
+    if (latest_value_only) {
+      result.qos.history = RMW_QOS_POLICY_HISTORY_KEEP_LAST;
+      result.qos.depth = 1;
+    }
     result.rmw_subscription_options.ignore_local_publications = this->ignore_local_publications;
     result.rmw_subscription_options.require_unique_network_flow_endpoints =
       this->require_unique_network_flow_endpoints;
@@ -155,6 +312,17 @@ struct SubscriptionOptionsWithAllocator : public SubscriptionOptionsBase
     return this->allocator;
   }
 
+  /// Return the storage of the allocator used by the result of to_rcl_subscription_options().
+  /**
+   * The rcl allocator refers to it, it must be kept alive as long as the rcl subscription.
+   * \return the storage, nullptr if to_rcl_subscription_options() was never called.
+   */
+  std::shared_ptr<void>
+  get_rcl_allocator_storage() const
+  {
+    return plain_allocator_storage_;
+  }
+
 private:
   using PlainAllocator =
     typename std::allocator_traits<Allocator>::template rebind_alloc<char>;
@@ -179,6 +347,17 @@ private:
 };
 
 using SubscriptionOptions = SubscriptionOptionsWithAllocator<std::allocator<void>>;
+
+/// Subscription options allocating from a std::pmr::memory_resource chosen at runtime.
+/**
+ * Every subscription using it shares the same template instantiation whatever its memory
+ * resource, which is given with
+ * `options.allocator = std::make_shared<rclcpp::allocator::MemoryResourceAllocator<>>(resource)`.
+ * See rclcpp::allocator::create_memory_resource() to create the resource from a configuration,
+ * and rclcpp::allocator::HugePageMemoryResource for the large intra-process messages.
+ */
+using SubscriptionOptionsWithMemoryResource =
+  SubscriptionOptionsWithAllocator<rclcpp::allocator::MemoryResourceAllocator<>>;
 }  // namespace rclcpp
 
 #endif  // RCLCPP__SUBSCRIPTION_OPTIONS_HPP_
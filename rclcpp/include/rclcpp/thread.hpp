@@ -0,0 +1,87 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__THREAD_HPP_
+#define RCLCPP__THREAD_HPP_
+
+#include <functional>
+#include <memory>
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/thread_attributes.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// Thread of execution created with a set of ThreadAttributes.
+/**
+ * This behaves like std::thread, which cannot set attributes like the stack size or the
+ * scheduling policy before the thread starts running.
+ * As with std::thread, a joinable Thread must be joined before being destroyed.
+ */
+class Thread
+{
+public:
+  /// Create an object which does not represent a thread.
+  RCLCPP_PUBLIC
+  Thread() noexcept;
+
+  /// Start a new thread running the given function.
+  /**
+   * \param[in] attributes attributes the thread is created with.
+   * \param[in] function function the thread runs.
+   * \throws std::invalid_argument if an attribute is not valid, e.g. an out of range CPU index.
+   * \throws std::runtime_error if an attribute is not supported on this platform.
+   * \throws std::system_error if the thread cannot be created with these attributes, e.g.
+   *   because the process isn't allowed to use a real-time scheduling policy.
+   */
+  RCLCPP_PUBLIC
+  Thread(const ThreadAttributes & attributes, std::function<void()> function);
+
+  RCLCPP_PUBLIC
+  Thread(Thread && other) noexcept;
+
+  /// Move the given thread into this object, calls std::terminate() if this one is joinable.
+  RCLCPP_PUBLIC
+  Thread &
+  operator=(Thread && other) noexcept;
+
+  /// Destructor, calls std::terminate() if the thread is still joinable.
+  RCLCPP_PUBLIC
+  ~Thread();
+
+  /// Return true if the object represents a thread which was not joined yet.
+  RCLCPP_PUBLIC
+  bool
+  joinable() const noexcept;
+
+  /// Block until the thread finishes running its function.
+  /**
+   * \throws std::system_error if the thread is not joinable or cannot be joined.
+   */
+  RCLCPP_PUBLIC
+  void
+  join();
+
+private:
+  RCLCPP_DISABLE_COPY(Thread)
+
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__THREAD_HPP_
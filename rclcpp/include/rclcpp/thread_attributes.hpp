@@ -0,0 +1,64 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__THREAD_ATTRIBUTES_HPP_
+#define RCLCPP__THREAD_ATTRIBUTES_HPP_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace rclcpp
+{
+
+/// Scheduling policy of a thread created by rclcpp.
+enum class ThreadSchedulingPolicy
+{
+  /// Keep the policy and priority of the thread creating the thread.
+  Inherit,
+  /// Default time-sharing policy, SCHED_OTHER.
+  Other,
+  /// First-in first-out real-time policy, SCHED_FIFO.
+  Fifo,
+  /// Round-robin real-time policy, SCHED_RR.
+  RoundRobin
+};
+
+/// Attributes applied to a thread when rclcpp creates it.
+/**
+ * The default value of each attribute leaves the corresponding property of the thread as the
+ * operating system sets it by default.
+ * Apart from the name, the attributes are only supported on POSIX platforms, and CPU affinity
+ * is only supported on Linux.
+ */
+struct ThreadAttributes
+{
+  /// Indices of the CPUs the thread is allowed to run on, empty to not pin the thread.
+  std::vector<size_t> cpu_set;
+  /// Scheduling policy of the thread.
+  ThreadSchedulingPolicy scheduling_policy = ThreadSchedulingPolicy::Inherit;
+  /// Scheduling priority of the thread, ignored when the policy is Inherit.
+  int priority = 0;
+  /// Size of the stack of the thread in bytes, 0 to use the default size.
+  size_t stack_size = 0;
+  /// Name of the thread, shown by debuggers and tools like top, empty to not set it.
+  /**
+   * Linux truncates the name to 15 characters.
+   */
+  std::string name;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__THREAD_ATTRIBUTES_HPP_
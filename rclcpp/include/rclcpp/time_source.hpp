@@ -27,6 +27,7 @@
 #include "rclcpp/node.hpp"
 #include "rclcpp/executors.hpp"
 #include "rclcpp/node_interfaces/node_parameters_interface.hpp"
+#include "rclcpp/thread_attributes.hpp"
 
 
 namespace rclcpp
@@ -142,6 +143,32 @@ public:
   RCLCPP_PUBLIC
   bool clock_thread_is_joinable();
 
+  /// Get the attributes the clock thread is created with
+  RCLCPP_PUBLIC
+  rclcpp::ThreadAttributes get_clock_thread_attributes();
+
+  /// Set the attributes the clock thread is created with
+  /**
+   * This has no effect on a clock thread which is already running.
+   * \param[in] attributes attributes of the clock thread
+   */
+  RCLCPP_PUBLIC
+  void set_clock_thread_attributes(const rclcpp::ThreadAttributes & attributes);
+
+  /// Get whether use_sim_time is followed through a /parameter_events subscription
+  RCLCPP_PUBLIC
+  bool get_use_parameter_events();
+
+  /// Set whether use_sim_time is followed through a /parameter_events subscription
+  /**
+   * If false, the time source follows the use_sim_time parameter of the node through a post set
+   * parameters callback instead, saving the subscription.
+   * This has no effect on a node which is already attached.
+   * \param[in] use_parameter_events whether to subscribe to the parameter events
+   */
+  RCLCPP_PUBLIC
+  void set_use_parameter_events(bool use_parameter_events);
+
   /// TimeSource Destructor
   RCLCPP_PUBLIC
   ~TimeSource();
@@ -17,8 +17,10 @@
 
 #include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <thread>
 #include <type_traits>
@@ -29,6 +31,7 @@
 #include "rclcpp/function_traits.hpp"
 #include "rclcpp/macros.hpp"
 #include "rclcpp/rate.hpp"
+#include "rclcpp/timer_statistics.hpp"
 #include "rclcpp/utilities.hpp"
 #include "rclcpp/visibility_control.hpp"
 #include "tracetools/tracetools.h"
@@ -121,6 +124,69 @@ public:
   std::chrono::nanoseconds
   time_until_trigger();
 
+  /// Get the period of the timer.
+  /**
+   * \return The period of the timer.
+   * \throws std::runtime_error if the rcl_timer_get_period returns a failure
+   */
+  RCLCPP_PUBLIC
+  std::chrono::nanoseconds
+  get_period() const;
+
+  /// Statistics about how late the callbacks of this timer were dispatched.
+  /**
+   * The lateness is the time between the scheduled call time of the timer and the moment
+   * the executor dispatched it.
+   * It is only recorded by executors dispatching timers by earliest deadline first,
+   * see rclcpp::memory_strategy::TimerDispatchOrder.
+   */
+  struct LatenessStatistics
+  {
+    /// Number of recorded calls.
+    uint64_t call_count = 0;
+    /// Lateness of the last recorded call.
+    std::chrono::nanoseconds last_lateness = std::chrono::nanoseconds::zero();
+    /// Largest lateness of the recorded calls.
+    std::chrono::nanoseconds max_lateness = std::chrono::nanoseconds::zero();
+    /// Accumulated lateness of all the recorded calls.
+    std::chrono::nanoseconds total_lateness = std::chrono::nanoseconds::zero();
+  };
+
+  /// Return a copy of the lateness statistics of this timer.
+  RCLCPP_PUBLIC
+  LatenessStatistics
+  get_lateness_statistics() const;
+
+  /// Reset the lateness statistics of this timer.
+  RCLCPP_PUBLIC
+  void
+  reset_lateness_statistics();
+
+  /// Record how late a call of this timer was dispatched, used by executors.
+  RCLCPP_PUBLIC
+  void
+  record_lateness(std::chrono::nanoseconds lateness);
+
+  /// Enable the statistics of the lateness, execution time and missed periods of the callbacks.
+  /**
+   * Unlike the lateness statistics, they are recorded whatever the executor calling the timer.
+   * Once enabled, the statistics are recorded until the timer is destroyed.
+   * Calling this function again returns the same statistics.
+   *
+   * \return the statistics of the timer.
+   */
+  RCLCPP_PUBLIC
+  TimerStatistics::SharedPtr
+  enable_statistics();
+
+  /// Return the statistics of the callbacks of this timer.
+  /**
+   * \return the statistics, nullptr if they aren't enabled.
+   */
+  RCLCPP_PUBLIC
+  TimerStatistics::SharedPtr
+  get_statistics() const;
+
   /// Is the clock steady (i.e. is the time between ticks constant?)
   /** \return True if the clock used by this timer is steady. */
   virtual bool is_steady() = 0;
@@ -150,10 +216,26 @@ public:
   exchange_in_use_by_wait_set_state(bool in_use_state);
 
 protected:
+  /// Record the scheduled time of the call about to happen, if the statistics are enabled.
+  /**
+   * Its lateness is also recorded by the FlightRecorder, if enabled.
+   */
+  RCLCPP_PUBLIC
+  void
+  record_call_statistics();
+
   Clock::SharedPtr clock_;
   std::shared_ptr<rcl_timer_t> timer_handle_;
 
   std::atomic<bool> in_use_by_wait_set_{false};
+
+  mutable std::mutex lateness_statistics_mutex_;
+  LatenessStatistics lateness_statistics_;
+
+  mutable std::mutex statistics_mutex_;
+  TimerStatistics::SharedPtr statistics_;
+  /// Raw pointer to statistics_, read without locking when calling the timer.
+  std::atomic<TimerStatistics *> statistics_ptr_{nullptr};
 };
 
 
@@ -210,6 +292,7 @@ public:
   bool
   call() override
   {
+    record_call_statistics();
     rcl_ret_t ret = rcl_timer_call(timer_handle_.get());
     if (ret == RCL_RET_TIMER_CANCELED) {
       return false;
@@ -227,7 +310,11 @@ public:
   execute_callback() override
   {
     TRACEPOINT(callback_start, reinterpret_cast<const void *>(&callback_), false);
-    execute_callback_delegate<>();
+    {
+      TimerStatistics::CallbackScope statistics_scope(
+        statistics_ptr_.load(std::memory_order_acquire), *clock_);
+      execute_callback_delegate<>();
+    }
     TRACEPOINT(callback_end, reinterpret_cast<const void *>(&callback_));
   }
 
@@ -0,0 +1,187 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__TIMER_COALESCER_HPP_
+#define RCLCPP__TIMER_COALESCER_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "rclcpp/callback_group.hpp"
+#include "rclcpp/clock.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/timer.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+namespace node_interfaces
+{
+class NodeBaseInterface;
+class NodeTimersInterface;
+}  // namespace node_interfaces
+
+class TimerCoalescer;
+
+/// Handle of a timer sharing an rcl timer with other timers, see TimerCoalescer.
+/**
+ * The timer is canceled when the handle is destroyed.
+ */
+class CoalescedTimer
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(CoalescedTimer)
+
+  RCLCPP_PUBLIC
+  ~CoalescedTimer();
+
+  /// Cancel the timer, its callback isn't called anymore.
+  RCLCPP_PUBLIC
+  void
+  cancel();
+
+  RCLCPP_PUBLIC
+  bool
+  is_canceled() const;
+
+  /// Return the period of the shared timer, which may differ from the requested one.
+  RCLCPP_PUBLIC
+  std::chrono::nanoseconds
+  get_period() const;
+
+private:
+  friend TimerCoalescer;
+
+  struct Member
+  {
+    std::function<void ()> callback;
+    std::atomic<bool> canceled{false};
+  };
+
+  CoalescedTimer(
+    std::weak_ptr<TimerCoalescer> coalescer,
+    std::shared_ptr<Member> member,
+    std::chrono::nanoseconds period);
+
+  std::weak_ptr<TimerCoalescer> coalescer_;
+  std::shared_ptr<Member> member_;
+  const std::chrono::nanoseconds period_;
+};
+
+/// Share one rcl timer between the timers with the same clock, period and callback group.
+/**
+ * Components of a process often create timers with the same period, e.g. 100ms, which
+ * expire at almost the same time and wake up the executor once each.
+ * Instead, the coalesced timers whose periods are within a tolerance of each other share a
+ * single rcl timer, calling their callbacks in turn, in the order the timers were added.
+ *
+ * A timer added to an existing shared timer takes its phase and period, so its first call
+ * can happen less than one period after it's added.
+ * The shared timer is destroyed with its last coalesced timer.
+ *
+ * The clocks are compared by identity, so that the timers of the same node clock, or the ones
+ * using the steady clock of the coalescer, can share a timer.
+ *
+ * The coalescer of a node is returned by NodeTimersInterface::get_timer_coalescer(), see also
+ * rclcpp::create_coalesced_timer() and rclcpp::create_coalesced_wall_timer().
+ */
+class TimerCoalescer : public std::enable_shared_from_this<TimerCoalescer>
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(TimerCoalescer)
+
+  /// Create a coalescer adding its shared timers to the given node.
+  RCLCPP_PUBLIC
+  TimerCoalescer(
+    rclcpp::node_interfaces::NodeBaseInterface * node_base,
+    rclcpp::node_interfaces::NodeTimersInterface * node_timers);
+
+  RCLCPP_PUBLIC
+  virtual ~TimerCoalescer();
+
+  /// Add a timer sharing the rcl timer of the timers with a period within the tolerance.
+  /**
+   * \param[in] clock clock of the timer.
+   * \param[in] period period of the timer.
+   * \param[in] tolerance maximum difference with the period of a shared timer.
+   * \param[in] callback callback called each time the timer expires.
+   * \param[in] group callback group of the timer, or nullptr for the default one.
+   * \return the handle of the timer.
+   * \throws std::invalid_argument if the clock or the callback is empty, or if the period
+   *   or the tolerance is negative.
+   */
+  RCLCPP_PUBLIC
+  CoalescedTimer::SharedPtr
+  add_timer(
+    rclcpp::Clock::SharedPtr clock,
+    std::chrono::nanoseconds period,
+    std::chrono::nanoseconds tolerance,
+    std::function<void ()> callback,
+    rclcpp::CallbackGroup::SharedPtr group = nullptr);
+
+  /// Return the steady clock shared by the coalesced wall timers.
+  RCLCPP_PUBLIC
+  rclcpp::Clock::SharedPtr
+  get_steady_clock() const;
+
+  /// Return the number of rcl timers shared by the coalesced timers.
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_shared_timers() const;
+
+  /// Return the number of coalesced timers which aren't canceled.
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_coalesced_timers() const;
+
+private:
+  friend CoalescedTimer;
+
+  struct SharedTimer
+  {
+    rclcpp::Clock::SharedPtr clock;
+    rclcpp::CallbackGroup::WeakPtr group;
+    std::chrono::nanoseconds period;
+    rclcpp::TimerBase::SharedPtr timer;
+    std::mutex members_mutex;
+    std::vector<std::shared_ptr<CoalescedTimer::Member>> members;
+  };
+
+  /// Remove a canceled timer, and its shared timer if it was the last one.
+  void
+  remove_member(
+    const std::shared_ptr<CoalescedTimer::Member> & member,
+    std::chrono::nanoseconds period);
+
+  static void
+  call_members(const std::weak_ptr<SharedTimer> & weak_shared_timer);
+
+  rclcpp::node_interfaces::NodeBaseInterface * node_base_;
+  rclcpp::node_interfaces::NodeTimersInterface * node_timers_;
+  const rclcpp::Clock::SharedPtr steady_clock_;
+
+  mutable std::mutex mutex_;
+  /// Shared timers sorted by period.
+  std::multimap<std::chrono::nanoseconds, std::shared_ptr<SharedTimer>> shared_timers_;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__TIMER_COALESCER_HPP_
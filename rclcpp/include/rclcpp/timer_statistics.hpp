@@ -0,0 +1,135 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__TIMER_STATISTICS_HPP_
+#define RCLCPP__TIMER_STATISTICS_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/topic_statistics/atomic_histogram.hpp"
+#include "rclcpp/topic_statistics/atomic_statistics_accumulator.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+class Clock;
+
+/// Statistics of the callbacks of a timer: how late they started, how long they ran and how
+/// many periods were missed.
+/**
+ * The lateness of a callback is the time between its scheduled call time and its start,
+ * measured with the clock of the timer.
+ * When a callback starts more than a period late, the periods in between are skipped by the
+ * timer and counted as missed.
+ * The execution time is measured with the steady clock.
+ *
+ * The samples are accumulated without locking, like the topic statistics, in a window which
+ * take_snapshot() ends.
+ * A timer records its statistics once they are enabled, see rclcpp::TimerBase::enable_statistics(),
+ * and rclcpp::topic_statistics::TimerStatisticsPublisher publishes them.
+ */
+class TimerStatistics
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(TimerStatistics)
+
+  using StatisticData = rclcpp::topic_statistics::AtomicStatisticsAccumulator::StatisticData;
+
+  /// Statistics of the callbacks executed in a window.
+  struct Snapshot
+  {
+    /// Number of callbacks executed.
+    uint64_t call_count;
+    /// Number of periods skipped because a callback started more than a period late.
+    uint64_t missed_periods;
+    /// Lateness of the starts of the callbacks, in milliseconds.
+    StatisticData lateness;
+    /// Execution time of the callbacks, in milliseconds.
+    StatisticData execution_time;
+    /// Lateness of the starts of the callbacks, in nanoseconds.
+    rclcpp::topic_statistics::AtomicHistogram::Snapshot lateness_histogram;
+  };
+
+  /// Measure a callback, from the construction of the scope to its destruction.
+  /**
+   * Nothing is measured if the statistics are nullptr.
+   */
+  class CallbackScope
+  {
+public:
+    RCLCPP_PUBLIC
+    CallbackScope(TimerStatistics * statistics, rclcpp::Clock & clock);
+
+    RCLCPP_PUBLIC
+    ~CallbackScope();
+
+private:
+    RCLCPP_DISABLE_COPY(CallbackScope)
+
+    TimerStatistics * statistics_;
+    std::chrono::steady_clock::time_point start_;
+  };
+
+  RCLCPP_PUBLIC
+  TimerStatistics();
+
+  /// Record the time a call of the timer was scheduled at, when the timer is called.
+  /**
+   * \param[in] scheduled_time the scheduled call time, in nanoseconds of the timer clock.
+   * \param[in] period the period of the timer.
+   */
+  void on_call(int64_t scheduled_time, std::chrono::nanoseconds period) noexcept
+  {
+    period_.store(period.count(), std::memory_order_relaxed);
+    scheduled_time_.store(scheduled_time, std::memory_order_relaxed);
+  }
+
+  /// Return the statistics of the current window.
+  RCLCPP_PUBLIC
+  Snapshot
+  get_snapshot() const;
+
+  /// Return the statistics of the current window and start a new one.
+  RCLCPP_PUBLIC
+  Snapshot
+  take_snapshot();
+
+private:
+  /// Record the start of a callback, given the time of the timer clock.
+  void record_start(int64_t start_time) noexcept;
+
+  /// Value of scheduled_time_ when no call of the timer is pending.
+  static constexpr int64_t kNoScheduledTime = INT64_MIN;
+
+  /// Lateness of the starts of the callbacks, in nanoseconds
+  rclcpp::topic_statistics::AtomicHistogram lateness_histogram_;
+  /// Lateness of the starts of the callbacks, in milliseconds
+  rclcpp::topic_statistics::AtomicStatisticsAccumulator lateness_;
+  /// Execution time of the callbacks, in milliseconds
+  rclcpp::topic_statistics::AtomicStatisticsAccumulator execution_time_;
+  /// Number of periods skipped in the window
+  std::atomic<uint64_t> missed_periods_{0};
+  /// Scheduled time of the last call of the timer, in nanoseconds of the timer clock
+  std::atomic<int64_t> scheduled_time_{kNoScheduledTime};
+  /// Period of the timer at its last call, in nanoseconds
+  std::atomic<int64_t> period_{0};
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__TIMER_STATISTICS_HPP_
@@ -0,0 +1,220 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__TIMER_WHEEL_HPP_
+#define RCLCPP__TIMER_WHEEL_HPP_
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/callback_group.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/node_interfaces/get_node_base_interface.hpp"
+#include "rclcpp/node_interfaces/get_node_timers_interface.hpp"
+#include "rclcpp/node_interfaces/node_base_interface.hpp"
+#include "rclcpp/node_interfaces/node_timers_interface.hpp"
+#include "rclcpp/timer.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// Hierarchical timer wheel multiplexing many periodic logical timers on a single timer.
+/**
+ * The logical timers have a resolution of one wheel tick, and adding, resetting or
+ * canceling one of them is O(1), whatever the number of timers.
+ * This suits nodes with thousands of timers, e.g. per-peer watchdogs, for which a
+ * rclcpp::TimerBase each would mean as many wait set entries scanned by the executor.
+ *
+ * The wheel is advanced by a single wall timer ticking at the resolution of the wheel, see
+ * create_timer_wheel(), and the tick timer is canceled while the wheel has no timers.
+ * The callbacks of the expired timers are called in turn from the tick timer callback,
+ * so they run in its callback group and delay each other.
+ *
+ * The methods are thread-safe and can be called from the callbacks of the wheel.
+ */
+class TimerWheel
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(TimerWheel)
+
+  using Callback = std::function<void ()>;
+  /// Identifier of a logical timer, never reused by the same wheel.
+  using TimerId = uint64_t;
+
+  /// Create a wheel which is advanced manually, see advance().
+  /**
+   * \param[in] resolution duration of a tick, the granularity of the timer periods.
+   * \param[in] start_time time of the tick 0.
+   * \throws std::invalid_argument if the resolution isn't positive.
+   */
+  RCLCPP_PUBLIC
+  explicit TimerWheel(
+    std::chrono::nanoseconds resolution,
+    std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now());
+
+  RCLCPP_PUBLIC
+  virtual ~TimerWheel();
+
+  /// Add a periodic timer, which first expires one period from now.
+  /**
+   * The period is rounded up to a whole number of ticks.
+   *
+   * \param[in] period period of the timer.
+   * \param[in] callback callback called each time the timer expires.
+   * \return the identifier of the new timer.
+   * \throws std::invalid_argument if the period is negative or the callback is empty.
+   */
+  RCLCPP_PUBLIC
+  TimerId
+  add_timer(std::chrono::nanoseconds period, Callback callback);
+
+  /// Cancel a timer, its callback isn't called anymore.
+  /**
+   * \return false if the timer doesn't exist, e.g. because it was already canceled.
+   */
+  RCLCPP_PUBLIC
+  bool
+  cancel(TimerId timer_id);
+
+  /// Restart a timer, so that it expires one period from now, e.g. to feed a watchdog.
+  /**
+   * \return false if the timer doesn't exist.
+   */
+  RCLCPP_PUBLIC
+  bool
+  reset(TimerId timer_id);
+
+  /// Return the number of timers of the wheel.
+  RCLCPP_PUBLIC
+  size_t
+  size() const;
+
+  RCLCPP_PUBLIC
+  std::chrono::nanoseconds
+  get_resolution() const;
+
+  /// Advance the wheel up to the given time, calling the callbacks of the expired timers.
+  /**
+   * The callbacks are called without holding the lock of the wheel, in expiration order.
+   * A timer expiring several times since the last call is called once, and keeps its phase.
+   *
+   * \param[in] now time to advance the wheel to.
+   * \return the number of callbacks called.
+   */
+  RCLCPP_PUBLIC
+  size_t
+  advance(std::chrono::steady_clock::time_point now);
+
+  /// Set the timer advancing the wheel, which is canceled while the wheel has no timers.
+  RCLCPP_PUBLIC
+  void
+  set_tick_timer(rclcpp::TimerBase::SharedPtr tick_timer);
+
+private:
+  // 4 levels of 256 slots cover 2^32 ticks, e.g. 49 days with a resolution of 1ms
+  static constexpr size_t kSlotBits = 8;
+  static constexpr size_t kSlotsPerLevel = 1u << kSlotBits;
+  static constexpr size_t kLevels = 4;
+  static constexpr uint32_t kNone = UINT32_MAX;
+
+  struct Entry
+  {
+    std::shared_ptr<const Callback> callback;
+    uint64_t period_ticks = 0;
+    uint64_t expiry_tick = 0;
+    // Doubly linked list of the slot holding the entry, or of the free entries
+    uint32_t previous = kNone;
+    uint32_t next = kNone;
+    uint32_t generation = 0;
+    uint32_t slot = kNone;
+    uint64_t last_advance = 0;
+    bool active = false;
+  };
+
+  /// Return the index of the entry of an active timer, or kNone.
+  uint32_t
+  find_entry(TimerId timer_id) const;
+
+  void
+  link(uint32_t index);
+
+  void
+  unlink(uint32_t index);
+
+  /// Move the entries of a slot of an upper level to the lower levels.
+  void
+  cascade(size_t level);
+
+  void
+  update_tick_timer();
+
+  const std::chrono::nanoseconds resolution_;
+  const std::chrono::steady_clock::time_point start_time_;
+
+  mutable std::mutex mutex_;
+  uint64_t current_tick_ = 0;
+  /// Number of calls to advance(), to call an entry at most once per call.
+  uint64_t advance_count_ = 0;
+  size_t size_ = 0;
+  std::vector<Entry> entries_;
+  uint32_t free_entries_ = kNone;
+  std::array<std::array<uint32_t, kSlotsPerLevel>, kLevels> slots_;
+  /// Entries which expire beyond the range of the upper level.
+  uint32_t overflow_ = kNone;
+
+  rclcpp::TimerBase::SharedPtr tick_timer_;
+  bool tick_timer_running_ = true;
+};
+
+/// Create a timer wheel advanced by a wall timer of the node.
+/**
+ * \param[in] node_base node base interface used to create the tick timer.
+ * \param[in] node_timers node timers interface used to create the tick timer.
+ * \param[in] resolution duration of a tick of the wheel, the period of the tick timer.
+ * \param[in] group callback group of the tick timer, or nullptr for the default one.
+ * \return the timer wheel, its tick timer stops when it's destroyed.
+ */
+RCLCPP_PUBLIC
+TimerWheel::SharedPtr
+create_timer_wheel(
+  rclcpp::node_interfaces::NodeBaseInterface * node_base,
+  rclcpp::node_interfaces::NodeTimersInterface * node_timers,
+  std::chrono::nanoseconds resolution,
+  rclcpp::CallbackGroup::SharedPtr group = nullptr);
+
+/// Create a timer wheel advanced by a wall timer of the node.
+template<typename NodeT>
+TimerWheel::SharedPtr
+create_timer_wheel(
+  NodeT && node,
+  std::chrono::nanoseconds resolution,
+  rclcpp::CallbackGroup::SharedPtr group = nullptr)
+{
+  return create_timer_wheel(
+    rclcpp::node_interfaces::get_node_base_interface(node).get(),
+    rclcpp::node_interfaces::get_node_timers_interface(node).get(),
+    resolution,
+    std::move(group));
+}
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__TIMER_WHEEL_HPP_
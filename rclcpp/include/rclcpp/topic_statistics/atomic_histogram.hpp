@@ -0,0 +1,211 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__TOPIC_STATISTICS__ATOMIC_HISTOGRAM_HPP_
+#define RCLCPP__TOPIC_STATISTICS__ATOMIC_HISTOGRAM_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace rclcpp
+{
+namespace topic_statistics
+{
+
+/// Log-linear histogram of non-negative integer samples, filled without locking.
+/**
+ * Like an HDR histogram, each power of two range of values is split in 2^sub_bucket_bits
+ * buckets of equal width, so a value is recorded with a relative error lower than
+ * 2^-sub_bucket_bits, e.g. about 3% with the default 5 bits.
+ * The buckets are allocated at construction, recording a sample only increments one of them.
+ * The values greater than or equal to 2^max_value_bits are recorded in the last bucket.
+ */
+class AtomicHistogram
+{
+public:
+  static constexpr uint8_t kDefaultSubBucketBits = 5;
+  /// About 275 seconds for values in nanoseconds.
+  static constexpr uint8_t kDefaultMaxValueBits = 38;
+
+  /// Counts of the buckets of a histogram, at the end of a window.
+  class Snapshot
+  {
+public:
+    /// Return the number of samples.
+    uint64_t get_count() const
+    {
+      return count_;
+    }
+
+    /// Return the value below or at which the given percentage of the samples are.
+    /**
+     * The value is the highest one recorded in the bucket of the sample of that rank.
+     *
+     * \param percentile the percentage of samples, in ]0, 100]
+     * \return the value at the percentile, 0 when there is no sample
+     * \throws std::invalid_argument if the percentile is out of range
+     */
+    uint64_t get_value_at_percentile(double percentile) const
+    {
+      if (!(percentile > 0.0 && percentile <= 100.0)) {
+        throw std::invalid_argument("percentile must be in ]0, 100]");
+      }
+      if (0 == count_) {
+        return 0;
+      }
+      const auto rank = std::max<uint64_t>(
+        1, static_cast<uint64_t>(std::ceil(percentile / 100.0 * static_cast<double>(count_))));
+      uint64_t cumulative_count = 0;
+      for (size_t index = 0; index < counts_.size(); ++index) {
+        cumulative_count += counts_[index];
+        if (cumulative_count >= rank) {
+          return get_highest_equivalent_value(index, sub_bucket_bits_);
+        }
+      }
+      // Only reached if the rank is rounded above the count
+      return get_highest_equivalent_value(counts_.size() - 1, sub_bucket_bits_);
+    }
+
+private:
+    friend class AtomicHistogram;
+
+    Snapshot(std::vector<uint64_t> counts, uint64_t count, uint8_t sub_bucket_bits)
+    : counts_(std::move(counts)), count_(count), sub_bucket_bits_(sub_bucket_bits)
+    {}
+
+    std::vector<uint64_t> counts_;
+    uint64_t count_;
+    uint8_t sub_bucket_bits_;
+  };
+
+  /// Construct an empty histogram.
+  /**
+   * \param sub_bucket_bits the number of bits of a value recorded exactly, from 1 to 16
+   * \param max_value_bits the number of bits of the greatest value recorded exactly, greater
+   *   than sub_bucket_bits and up to 64
+   * \throws std::invalid_argument if the number of bits are out of range
+   */
+  explicit AtomicHistogram(
+    uint8_t sub_bucket_bits = kDefaultSubBucketBits,
+    uint8_t max_value_bits = kDefaultMaxValueBits)
+  : sub_bucket_bits_(sub_bucket_bits),
+    max_value_(max_value_bits >= 64 ? UINT64_MAX : (uint64_t(1) << max_value_bits) - 1)
+  {
+    if (sub_bucket_bits < 1 || sub_bucket_bits > 16) {
+      throw std::invalid_argument("sub_bucket_bits must be between 1 and 16");
+    }
+    if (max_value_bits <= sub_bucket_bits || max_value_bits > 64) {
+      throw std::invalid_argument(
+              "max_value_bits must be greater than sub_bucket_bits and at most 64");
+    }
+    bucket_count_ = get_bucket_index(max_value_) + 1;
+    buckets_.reset(new std::atomic<uint64_t>[bucket_count_]);
+    for (size_t index = 0; index < bucket_count_; ++index) {
+      buckets_[index].store(0, std::memory_order_relaxed);
+    }
+  }
+
+  /// Add a sample to the current window.
+  void add_sample(uint64_t value) noexcept
+  {
+    buckets_[get_bucket_index(std::min(value, max_value_))].fetch_add(
+      1, std::memory_order_relaxed);
+  }
+
+  /// Return the number of buckets, which is fixed at construction.
+  size_t get_bucket_count() const
+  {
+    return bucket_count_;
+  }
+
+  /// Return the counts of the buckets of the current window.
+  Snapshot get_snapshot() const
+  {
+    std::vector<uint64_t> counts(bucket_count_);
+    uint64_t count = 0;
+    for (size_t index = 0; index < bucket_count_; ++index) {
+      counts[index] = buckets_[index].load(std::memory_order_relaxed);
+      count += counts[index];
+    }
+    return Snapshot(std::move(counts), count, sub_bucket_bits_);
+  }
+
+  /// Return the counts of the buckets of the current window and start a new one.
+  Snapshot take_snapshot()
+  {
+    std::vector<uint64_t> counts(bucket_count_);
+    uint64_t count = 0;
+    for (size_t index = 0; index < bucket_count_; ++index) {
+      counts[index] = buckets_[index].exchange(0, std::memory_order_relaxed);
+      count += counts[index];
+    }
+    return Snapshot(std::move(counts), count, sub_bucket_bits_);
+  }
+
+private:
+  /// Return the index of the most significant bit set in a non-zero value.
+  static unsigned floor_log2(uint64_t value) noexcept
+  {
+    unsigned result = 0;
+    for (unsigned shift = 32; shift > 0; shift >>= 1) {
+      if (value >> shift) {
+        value >>= shift;
+        result += shift;
+      }
+    }
+    return result;
+  }
+
+  /// Return the index of the bucket of a value.
+  size_t get_bucket_index(uint64_t value) const noexcept
+  {
+    const uint64_t sub_bucket_count = uint64_t(1) << sub_bucket_bits_;
+    if (value < sub_bucket_count) {
+      return static_cast<size_t>(value);
+    }
+    // The most significant bits select the sub-bucket in the power of two range of the value
+    const unsigned shift = floor_log2(value) - sub_bucket_bits_;
+    return static_cast<size_t>(shift * sub_bucket_count + (value >> shift));
+  }
+
+  /// Return the highest value recorded in a bucket.
+  static uint64_t get_highest_equivalent_value(size_t index, uint8_t sub_bucket_bits) noexcept
+  {
+    const uint64_t sub_bucket_count = uint64_t(1) << sub_bucket_bits;
+    if (index < sub_bucket_count) {
+      return index;
+    }
+    const uint64_t shift = index / sub_bucket_count - 1;
+    const uint64_t lowest_value = (index - shift * sub_bucket_count) << shift;
+    return lowest_value + ((uint64_t(1) << shift) - 1);
+  }
+
+  const uint8_t sub_bucket_bits_;
+  const uint64_t max_value_;
+  size_t bucket_count_;
+  std::unique_ptr<std::atomic<uint64_t>[]> buckets_;
+};
+
+}  // namespace topic_statistics
+}  // namespace rclcpp
+
+#endif  // RCLCPP__TOPIC_STATISTICS__ATOMIC_HISTOGRAM_HPP_
@@ -0,0 +1,135 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__TOPIC_STATISTICS__ATOMIC_STATISTICS_ACCUMULATOR_HPP_
+#define RCLCPP__TOPIC_STATISTICS__ATOMIC_STATISTICS_ACCUMULATOR_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include "libstatistics_collector/moving_average_statistics/types.hpp"
+
+namespace rclcpp
+{
+namespace topic_statistics
+{
+
+/// Unit of the statistics measuring durations.
+constexpr const char kMillisecondUnitName[]{"ms"};
+
+/// Accumulate the samples of a statistic without locking, from any number of threads.
+/**
+ * The samples are accumulated in atomic sums and extremes, which take_statistics() reads and
+ * resets at the end of each window.
+ * A sample added while the window is being reset may be split between the two windows, e.g.
+ * counted in one and summed in the other, which is negligible for the statistics computed.
+ */
+class AtomicStatisticsAccumulator
+{
+public:
+  using StatisticData = libstatistics_collector::moving_average_statistics::StatisticData;
+
+  /// Add a sample to the current window.
+  void add_sample(double sample)
+  {
+    add(sum_, sample);
+    add(sum_of_squares_, sample * sample);
+    update(min_, sample, [](double current, double value) {return value < current;});
+    update(max_, sample, [](double current, double value) {return value > current;});
+    count_.fetch_add(1, std::memory_order_release);
+  }
+
+  /// Return the statistics of the current window.
+  /**
+   * The average, extremes and standard deviation are NaN when there is no sample.
+   */
+  StatisticData get_statistics() const
+  {
+    return compute(
+      count_.load(std::memory_order_acquire),
+      sum_.load(std::memory_order_relaxed),
+      sum_of_squares_.load(std::memory_order_relaxed),
+      min_.load(std::memory_order_relaxed),
+      max_.load(std::memory_order_relaxed));
+  }
+
+  /// Return the statistics of the current window and start a new one.
+  StatisticData take_statistics()
+  {
+    const uint64_t count = count_.exchange(0, std::memory_order_acq_rel);
+    return compute(
+      count,
+      sum_.exchange(0.0, std::memory_order_relaxed),
+      sum_of_squares_.exchange(0.0, std::memory_order_relaxed),
+      min_.exchange(std::numeric_limits<double>::infinity(), std::memory_order_relaxed),
+      max_.exchange(-std::numeric_limits<double>::infinity(), std::memory_order_relaxed));
+  }
+
+private:
+  static void add(std::atomic<double> & accumulator, double value)
+  {
+    double current = accumulator.load(std::memory_order_relaxed);
+    while (!accumulator.compare_exchange_weak(
+        current, current + value, std::memory_order_relaxed))
+    {
+    }
+  }
+
+  template<typename CompareT>
+  static void update(std::atomic<double> & extreme, double value, CompareT replaces)
+  {
+    double current = extreme.load(std::memory_order_relaxed);
+    while (replaces(current, value) &&
+      !extreme.compare_exchange_weak(current, value, std::memory_order_relaxed))
+    {
+    }
+  }
+
+  static StatisticData compute(
+    uint64_t count, double sum, double sum_of_squares, double min, double max)
+  {
+    StatisticData data;
+    data.sample_count = count;
+    if (0 == count) {
+      data.average = std::nan("");
+      data.min = std::nan("");
+      data.max = std::nan("");
+      data.standard_deviation = std::nan("");
+      return data;
+    }
+    const double samples = static_cast<double>(count);
+    data.average = sum / samples;
+    data.min = min;
+    data.max = max;
+    // Population standard deviation, like the libstatistics_collector moving averages
+    const double variance = sum_of_squares / samples - data.average * data.average;
+    data.standard_deviation = std::sqrt(std::max(variance, 0.0));
+    return data;
+  }
+
+  std::atomic<uint64_t> count_{0};
+  std::atomic<double> sum_{0.0};
+  std::atomic<double> sum_of_squares_{0.0};
+  std::atomic<double> min_{std::numeric_limits<double>::infinity()};
+  std::atomic<double> max_{-std::numeric_limits<double>::infinity()};
+};
+
+}  // namespace topic_statistics
+}  // namespace rclcpp
+
+#endif  // RCLCPP__TOPIC_STATISTICS__ATOMIC_STATISTICS_ACCUMULATOR_HPP_
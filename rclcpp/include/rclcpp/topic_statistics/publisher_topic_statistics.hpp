@@ -0,0 +1,189 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__TOPIC_STATISTICS__PUBLISHER_TOPIC_STATISTICS_HPP_
+#define RCLCPP__TOPIC_STATISTICS__PUBLISHER_TOPIC_STATISTICS_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/time.hpp"
+#include "rclcpp/topic_statistics/atomic_statistics_accumulator.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+#include "statistics_msgs/msg/metrics_message.hpp"
+
+namespace rclcpp
+{
+
+template<typename MessageT, typename AllocatorT>
+class Publisher;
+
+class TimerBase;
+
+namespace topic_statistics
+{
+
+constexpr const char kPublishPeriodName[]{"publish_period"};
+constexpr const char kPublishDurationName[]{"publish_duration"};
+constexpr const char kSerializedMessageSizeName[]{"serialized_message_size"};
+constexpr const char kByteUnitName[]{"bytes"};
+
+constexpr const char kIntraProcessPublishedMessagesName[]{"intra_process_published_messages"};
+constexpr const char kInterProcessPublishedMessagesName[]{"inter_process_published_messages"};
+constexpr const char kPublishedMessagesUnitName[]{"messages"};
+
+/**
+ * Class used to collect, measure, and publish the topic statistics of a publisher.
+ * The statistics supported are the period between the publish calls, their duration, the size
+ * of the serialized messages published and the number of messages given to the intra-process
+ * subscriptions and to the middleware.
+ * The samples are accumulated without locking, see AtomicStatisticsAccumulator, so the
+ * messages published on several threads don't contend on the statistics.
+ *
+ * The publishers are given an instance when topic statistics are enabled in their options,
+ * see rclcpp::PublisherOptionsBase::topic_stats_options.
+ */
+class PublisherTopicStatistics
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(PublisherTopicStatistics)
+
+  using MetricsPublisher =
+    rclcpp::Publisher<statistics_msgs::msg::MetricsMessage, std::allocator<void>>;
+  using StatisticData = AtomicStatisticsAccumulator::StatisticData;
+
+  /// Measure a publish call, from the construction of the scope to its destruction.
+  /**
+   * Nothing is measured if the statistics are nullptr, or if the thread is already measuring
+   * a publish call with the same statistics, e.g. in a publish overload calling another one.
+   */
+  class Scope
+  {
+public:
+    RCLCPP_PUBLIC
+    explicit Scope(PublisherTopicStatistics * statistics) noexcept;
+
+    RCLCPP_PUBLIC
+    ~Scope();
+
+private:
+    RCLCPP_DISABLE_COPY(Scope)
+
+    PublisherTopicStatistics * statistics_;
+    PublisherTopicStatistics * parent_;
+    int64_t start_;
+  };
+
+  /// Construct a PublisherTopicStatistics object.
+  /**
+   * \param node_name the name of the node, which created this instance, in order to denote
+   * topic source
+   * \param publisher instance constructed by the node in order to publish statistics data.
+   * This class owns the publisher.
+   * \throws std::invalid_argument if publisher pointer is nullptr
+   */
+  RCLCPP_PUBLIC
+  PublisherTopicStatistics(
+    const std::string & node_name,
+    std::shared_ptr<MetricsPublisher> publisher);
+
+  RCLCPP_PUBLIC
+  virtual ~PublisherTopicStatistics();
+
+  /// Count a message given to the intra-process subscriptions.
+  void on_intra_process_publish() noexcept
+  {
+    intra_process_count_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /// Count a message given to the middleware.
+  void on_inter_process_publish() noexcept
+  {
+    inter_process_count_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /// Measure the size of a serialized message published.
+  void on_serialized_publish(size_t size) noexcept
+  {
+    serialized_message_size_.add_sample(static_cast<double>(size));
+  }
+
+  /// Set the timer used to publish statistics messages.
+  /**
+   * \param publisher_timer the timer to fire the publisher, created by the node
+   */
+  RCLCPP_PUBLIC
+  void set_publisher_timer(std::shared_ptr<rclcpp::TimerBase> publisher_timer);
+
+  /// Publish the statistics of the current window and start a new one.
+  RCLCPP_PUBLIC
+  virtual void publish_message_and_reset_measurements();
+
+protected:
+  /// Return the statistics of the current window.
+  /**
+   * \return the publish period, publish duration and serialized message size statistics
+   */
+  RCLCPP_PUBLIC
+  std::vector<StatisticData> get_current_collector_data() const;
+
+  /// Return the number of messages published in the current window.
+  /**
+   * \return the number of messages given to the intra-process subscriptions and to the
+   * middleware
+   */
+  RCLCPP_PUBLIC
+  std::pair<uint64_t, uint64_t> get_current_published_message_counts() const;
+
+private:
+  /// Add the samples of a publish call, given the steady times of its start and end.
+  void record_publish(int64_t start, int64_t end) noexcept;
+
+  /// Value of last_publish_time_ before the first publish call.
+  static constexpr int64_t kNoPublishTime = -1;
+
+  /// Period between the publish calls
+  AtomicStatisticsAccumulator publish_period_;
+  /// Duration of the publish calls
+  AtomicStatisticsAccumulator publish_duration_;
+  /// Size of the serialized messages published
+  AtomicStatisticsAccumulator serialized_message_size_;
+  /// Number of messages given to the intra-process subscriptions in the window
+  std::atomic<uint64_t> intra_process_count_{0};
+  /// Number of messages given to the middleware in the window
+  std::atomic<uint64_t> inter_process_count_{0};
+  /// Steady time the last publish call started, in nanoseconds
+  std::atomic<int64_t> last_publish_time_{kNoPublishTime};
+  /// Node name used to generate topic statistics messages to be published
+  const std::string node_name_;
+  /// Publisher, created by the node, used to publish topic statistics messages
+  std::shared_ptr<MetricsPublisher> publisher_;
+  /// Timer which fires the publisher
+  std::shared_ptr<rclcpp::TimerBase> publisher_timer_;
+  /// The start of the collection window, used in the published topic statistics message
+  rclcpp::Time window_start_;
+};
+
+}  // namespace topic_statistics
+}  // namespace rclcpp
+
+#endif  // RCLCPP__TOPIC_STATISTICS__PUBLISHER_TOPIC_STATISTICS_HPP_
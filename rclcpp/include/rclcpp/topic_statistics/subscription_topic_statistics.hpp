@@ -15,21 +15,31 @@
 #ifndef RCLCPP__TOPIC_STATISTICS__SUBSCRIPTION_TOPIC_STATISTICS_HPP_
 #define RCLCPP__TOPIC_STATISTICS__SUBSCRIPTION_TOPIC_STATISTICS_HPP_
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 #include "libstatistics_collector/collector/generate_statistics_message.hpp"
 #include "libstatistics_collector/moving_average_statistics/types.hpp"
-#include "libstatistics_collector/topic_statistics_collector/constants.hpp"
-#include "libstatistics_collector/topic_statistics_collector/received_message_age.hpp"
-#include "libstatistics_collector/topic_statistics_collector/received_message_period.hpp"
 
 #include "rcl/time.h"
+#include "rclcpp/experimental/buffers/buffer_metrics.hpp"
 #include "rclcpp/time.hpp"
 #include "rclcpp/publisher.hpp"
 #include "rclcpp/timer.hpp"
+#include "rclcpp/topic_statistics/atomic_histogram.hpp"
+#include "rclcpp/topic_statistics/atomic_statistics_accumulator.hpp"
 
 #include "statistics_msgs/msg/metrics_message.hpp"
 
@@ -41,53 +51,120 @@ namespace topic_statistics
 constexpr const char kDefaultPublishTopicName[]{"/statistics"};
 constexpr const std::chrono::milliseconds kDefaultPublishingPeriod{std::chrono::seconds(1)};
 
+constexpr const char kMessageAgeName[]{"message_age"};
+constexpr const char kMessagePeriodName[]{"message_period"};
+constexpr const char kReceivedMessagesName[]{"received_messages"};
+constexpr const char kReceivedMessagesUnitName[]{"messages"};
+
+constexpr const char kIntraProcessBufferDepthName[]{"intra_process_buffer_depth"};
+constexpr const char kIntraProcessBufferHighWaterMarkName[]{"intra_process_buffer_high_water_mark"};
+constexpr const char kIntraProcessEnqueuedMessagesName[]{"intra_process_enqueued_messages"};
+constexpr const char kIntraProcessDequeuedMessagesName[]{"intra_process_dequeued_messages"};
+constexpr const char kIntraProcessDroppedMessagesName[]{"intra_process_dropped_messages"};
+constexpr const char kIntraProcessBufferMetricUnit[]{"messages"};
+
 using libstatistics_collector::collector::GenerateStatisticMessage;
 using statistics_msgs::msg::MetricsMessage;
 using libstatistics_collector::moving_average_statistics::StatisticData;
+using rclcpp::experimental::buffers::BufferMetrics;
+
+namespace detail
+{
+
+/// Trait telling if a message has a header with a stamp, whose age can be measured.
+template<typename MessageT, typename = void>
+struct has_header_stamp : std::false_type
+{};
+
+template<typename MessageT>
+struct has_header_stamp<MessageT, std::void_t<decltype(std::declval<MessageT>().header.stamp)>>
+  : std::true_type
+{};
+
+/// Return the name of the metric reporting a percentile of another one, e.g. message_age_p99.
+inline std::string
+get_percentile_metric_name(const std::string & metric_name, double percentile)
+{
+  std::ostringstream name;
+  name << metric_name << "_p" << percentile;
+  return name.str();
+}
+
+}  // namespace detail
 
 /**
  * Class used to collect, measure, and publish topic statistics data. Current statistics
  * supported for subscribers are received message age and received message period.
+ * The samples are accumulated without locking, see AtomicStatisticsAccumulator, so the
+ * messages received on several threads don't contend on the statistics.
+ * Subscriptions using intra-process communication also publish the occupancy of their
+ * intra-process buffer, along with the number of messages enqueued, dequeued and dropped
+ * in the window.
+ * When percentiles are requested, the message age and period are also recorded in histograms,
+ * see AtomicHistogram, and each percentile is published as a metric of its own, whose name is
+ * suffixed with the percentile, e.g. message_age_p99.9.
+ * On high-rate topics, the subscription can measure only a sample of the messages received,
+ * see should_measure_message(), the number of messages received in the window is then
+ * published too.
  *
  * \tparam CallbackMessageT the subscribed message type
  */
 template<typename CallbackMessageT>
 class SubscriptionTopicStatistics
 {
-  using TopicStatsCollector =
-    libstatistics_collector::topic_statistics_collector::TopicStatisticsCollector<
-    CallbackMessageT>;
-  using ReceivedMessageAge =
-    libstatistics_collector::topic_statistics_collector::ReceivedMessageAgeCollector<
-    CallbackMessageT>;
-  using ReceivedMessagePeriod =
-    libstatistics_collector::topic_statistics_collector::ReceivedMessagePeriodCollector<
-    CallbackMessageT>;
-
 public:
   /// Construct a SubscriptionTopicStatistics object.
   /**
-   * This object wraps utilities, defined in libstatistics_collector, to collect,
-   * measure, and publish topic statistics data. This throws an invalid_argument
-   * if the input publisher is null.
+   * This object collects, measures, and publishes topic statistics data, using the message
+   * format of libstatistics_collector. This throws an invalid_argument if the input publisher
+   * is null.
    *
    * \param node_name the name of the node, which created this instance, in order to denote
    * topic source
    * \param publisher instance constructed by the node in order to publish statistics data.
    * This class owns the publisher.
-   * \throws std::invalid_argument if publisher pointer is nullptr
+   * \param percentiles the percentiles of the message age and period to publish, in ]0, 100]
+   * \param sample_every_n_messages the interval between the messages measured, 1 to measure
+   * all of them
+   * \param max_samples_per_period the maximum number of messages measured per window, 0 for
+   * no limit
+   * \throws std::invalid_argument if publisher pointer is nullptr, a percentile is out of
+   * range or the sampling interval is zero
    */
   SubscriptionTopicStatistics(
     const std::string & node_name,
-    rclcpp::Publisher<statistics_msgs::msg::MetricsMessage>::SharedPtr publisher)
+    rclcpp::Publisher<statistics_msgs::msg::MetricsMessage>::SharedPtr publisher,
+    const std::vector<double> & percentiles = {},
+    uint64_t sample_every_n_messages = 1,
+    uint64_t max_samples_per_period = 0)
   : node_name_(node_name),
-    publisher_(std::move(publisher))
+    publisher_(std::move(publisher)),
+    percentiles_(percentiles),
+    min_sampling_interval_(sample_every_n_messages),
+    max_samples_per_period_(max_samples_per_period)
   {
     // TODO(dbbonnie): ros-tooling/aws-roadmap/issues/226, received message age
 
     if (nullptr == publisher_) {
       throw std::invalid_argument("publisher pointer is nullptr");
     }
+    if (0 == sample_every_n_messages) {
+      throw std::invalid_argument("topic statistics sample_every_n_messages must be positive");
+    }
+    sampling_interval_.store(sample_every_n_messages, std::memory_order_relaxed);
+    for (double percentile : percentiles_) {
+      if (!(percentile > 0.0 && percentile <= 100.0)) {
+        throw std::invalid_argument("topic statistics percentiles must be in ]0, 100]");
+      }
+      message_age_percentile_names_.push_back(
+        detail::get_percentile_metric_name(kMessageAgeName, percentile));
+      message_period_percentile_names_.push_back(
+        detail::get_percentile_metric_name(kMessagePeriodName, percentile));
+    }
+    if (!percentiles_.empty()) {
+      message_age_histogram_ = std::make_unique<AtomicHistogram>();
+      message_period_histogram_ = std::make_unique<AtomicHistogram>();
+    }
 
     bring_up();
   }
@@ -97,9 +174,25 @@ public:
     tear_down();
   }
 
+  /// Count a message received by the subscription, return true if it must be measured.
+  /**
+   * The subscription calls handle_message() only for the messages to measure, one out of the
+   * sampling interval, and doesn't read the time for the others.
+   * This method doesn't lock, it can be called concurrently from several threads.
+   *
+   * \return true if the message must be given to handle_message()
+   */
+  bool should_measure_message() const noexcept
+  {
+    const uint64_t index = received_count_.fetch_add(1, std::memory_order_relaxed);
+    return index % sampling_interval_.load(std::memory_order_relaxed) == 0;
+  }
+
   /// Handle a message received by the subscription to collect statistics.
   /**
-   * This method acquires a lock to prevent race conditions to collectors list.
+   * With sampling, the period between the measured messages is divided by the sampling
+   * interval, so the statistics are the ones of the period between the received messages.
+   * This method doesn't lock, it can be called concurrently from several threads.
    *
    * \param received_message the message received by the subscription
    * \param now_nanoseconds current time in nanoseconds
@@ -108,9 +201,33 @@ public:
     const CallbackMessageT & received_message,
     const rclcpp::Time now_nanoseconds) const
   {
-    std::lock_guard<std::mutex> lock(mutex_);
-    for (const auto & collector : subscriber_statistics_collectors_) {
-      collector->OnMessageReceived(received_message, now_nanoseconds.nanoseconds());
+    const int64_t now = now_nanoseconds.nanoseconds();
+    if constexpr (detail::has_header_stamp<CallbackMessageT>::value) {
+      const auto & stamp = received_message.header.stamp;
+      const int64_t stamp_nanoseconds = RCL_S_TO_NS(static_cast<int64_t>(stamp.sec)) +
+        static_cast<int64_t>(stamp.nanosec);
+      // Only measured when both times are set
+      if (stamp_nanoseconds != 0 && now != 0) {
+        message_age_.add_sample(to_milliseconds(now - stamp_nanoseconds));
+        if (message_age_histogram_) {
+          // The clocks of the publisher and the subscription may be skewed
+          message_age_histogram_->add_sample(
+            static_cast<uint64_t>(std::max<int64_t>(now - stamp_nanoseconds, 0)));
+        }
+      }
+    } else {
+      (void)received_message;
+    }
+
+    const int64_t last_message_time = last_message_time_.exchange(now, std::memory_order_relaxed);
+    // The first message only starts the measurement, the concurrent ones may be out of order
+    if (last_message_time != kNoMessageTime && now >= last_message_time) {
+      const int64_t period = (now - last_message_time) /
+        static_cast<int64_t>(sampling_interval_.load(std::memory_order_relaxed));
+      message_period_.add_sample(to_milliseconds(period));
+      if (message_period_histogram_) {
+        message_period_histogram_->add_sample(static_cast<uint64_t>(period));
+      }
     }
   }
 
@@ -123,9 +240,29 @@ public:
     publisher_timer_ = publisher_timer;
   }
 
-  /// Publish a populated MetricsStatisticsMessage.
+  /// Set the function giving the metrics of the intra-process buffer of the subscription.
   /**
+   * The metrics are then published with the other statistics, the source can return
+   * std::nullopt to skip them.
    * This method acquires a lock to prevent race conditions to collectors list.
+   *
+   * \param source function returning the current metrics of the buffer, or nullptr to stop
+   * publishing them
+   */
+  void set_intra_process_buffer_metrics_source(
+    std::function<std::optional<BufferMetrics>()> source)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    intra_process_buffer_metrics_source_ = std::move(source);
+  }
+
+  /// Publish a populated MetricsStatisticsMessage.
+  /**
+   * The samples accumulated since the previous call are merged into the statistics messages,
+   * and a new window starts.
+   * With a maximum number of samples per window, the sampling interval of the new window is
+   * adapted to the number of messages received in the previous one.
+   * This method acquires a lock to prevent race conditions to the intra-process buffer metrics.
    */
   virtual void publish_message_and_reset_measurements()
   {
@@ -134,18 +271,38 @@ public:
 
     {
       std::lock_guard<std::mutex> lock(mutex_);
-      for (auto & collector : subscriber_statistics_collectors_) {
-        const auto collected_stats = collector->GetStatisticsResults();
-        collector->ClearCurrentMeasurements();
-
-        auto message = libstatistics_collector::collector::GenerateStatisticMessage(
+      msgs.push_back(
+        libstatistics_collector::collector::GenerateStatisticMessage(
           node_name_,
-          collector->GetMetricName(),
-          collector->GetMetricUnit(),
+          kMessageAgeName,
+          kMillisecondUnitName,
           window_start_,
           window_end,
-          collected_stats);
-        msgs.push_back(message);
+          message_age_.take_statistics()));
+      msgs.push_back(
+        libstatistics_collector::collector::GenerateStatisticMessage(
+          node_name_,
+          kMessagePeriodName,
+          kMillisecondUnitName,
+          window_start_,
+          window_end,
+          message_period_.take_statistics()));
+
+      if (!percentiles_.empty()) {
+        add_percentile_messages(
+          window_end, message_age_histogram_->take_snapshot(),
+          message_age_percentile_names_, msgs);
+        add_percentile_messages(
+          window_end, message_period_histogram_->take_snapshot(),
+          message_period_percentile_names_, msgs);
+      }
+
+      if (min_sampling_interval_ > 1 || max_samples_per_period_ > 0) {
+        add_received_messages_message(window_end, msgs);
+      }
+
+      if (intra_process_buffer_metrics_source_) {
+        add_intra_process_buffer_messages(window_end, msgs);
       }
     }
 
@@ -158,62 +315,167 @@ public:
 protected:
   /// Return a vector of all the currently collected data.
   /**
-   * This method acquires a lock to prevent race conditions to collectors list.
-   *
-   * \return a vector of all the collected data
+   * \return the message age and message period statistics of the current window
    */
   std::vector<StatisticData> get_current_collector_data() const
   {
-    std::vector<StatisticData> data;
-    std::lock_guard<std::mutex> lock(mutex_);
-    for (const auto & collector : subscriber_statistics_collectors_) {
-      data.push_back(collector->GetStatisticsResults());
-    }
-    return data;
+    return {message_age_.get_statistics(), message_period_.get_statistics()};
   }
 
 private:
-  /// Construct and start all collectors and set window_start_.
-  /**
-   * This method acquires a lock to prevent race conditions to collectors list.
-   */
+  /// Value of last_message_time_ before the first message.
+  static constexpr int64_t kNoMessageTime = -1;
+
+  /// Return a duration in nanoseconds in milliseconds.
+  static double to_milliseconds(int64_t nanoseconds)
+  {
+    return std::chrono::duration<double, std::milli>(std::chrono::nanoseconds(nanoseconds)).count();
+  }
+
+  /// Set window_start_.
   void bring_up()
   {
-    auto received_message_age = std::make_unique<ReceivedMessageAge>();
-    received_message_age->Start();
-    subscriber_statistics_collectors_.emplace_back(std::move(received_message_age));
+    window_start_ = rclcpp::Time(get_current_nanoseconds_since_epoch());
+  }
 
-    auto received_message_period = std::make_unique<ReceivedMessagePeriod>();
-    received_message_period->Start();
-    {
-      std::lock_guard<std::mutex> lock(mutex_);
-      subscriber_statistics_collectors_.emplace_back(std::move(received_message_period));
+  /// Stop publishing timer, and reset publisher.
+  void tear_down()
+  {
+    if (publisher_timer_) {
+      publisher_timer_->cancel();
+      publisher_timer_.reset();
     }
 
-    window_start_ = rclcpp::Time(get_current_nanoseconds_since_epoch());
+    publisher_.reset();
   }
 
-  /// Stop all collectors, clear measurements, stop publishing timer, and reset publisher.
+  /// Append a message per percentile of a histogram, in milliseconds.
   /**
-   * This method acquires a lock to prevent race conditions to collectors list.
+   * Each message has a single sample, the value at the percentile, and the sample count is the
+   * number of samples of the histogram in the window.
+   *
+   * \param window_end the end of the collection window
+   * \param snapshot the histogram of the window
+   * \param names the names of the metrics, in the order of percentiles_
+   * \param msgs the messages to publish
    */
-  void tear_down()
+  void add_percentile_messages(
+    const rclcpp::Time & window_end,
+    const AtomicHistogram::Snapshot & snapshot,
+    const std::vector<std::string> & names,
+    std::vector<MetricsMessage> & msgs) const
   {
-    {
-      std::lock_guard<std::mutex> lock(mutex_);
-      for (auto & collector : subscriber_statistics_collectors_) {
-        collector->Stop();
+    for (size_t index = 0; index < percentiles_.size(); ++index) {
+      StatisticData data;
+      data.sample_count = snapshot.get_count();
+      if (0 == data.sample_count) {
+        data.average = std::nan("");
+        data.standard_deviation = std::nan("");
+      } else {
+        data.average = to_milliseconds(
+          static_cast<int64_t>(snapshot.get_value_at_percentile(percentiles_[index])));
+        data.standard_deviation = 0.0;
       }
+      data.min = data.average;
+      data.max = data.average;
+      msgs.push_back(
+        libstatistics_collector::collector::GenerateStatisticMessage(
+          node_name_,
+          names[index],
+          kMillisecondUnitName,
+          window_start_,
+          window_end,
+          data));
+    }
+  }
+
+  /// Append the message of the number of messages received, and adapt the sampling interval.
+  /**
+   * This method is not thread-safe, the caller must hold mutex_.
+   *
+   * \param window_end the end of the collection window
+   * \param msgs the messages to publish
+   */
+  void add_received_messages_message(
+    const rclcpp::Time & window_end,
+    std::vector<MetricsMessage> & msgs)
+  {
+    const uint64_t received_count = received_count_.load(std::memory_order_relaxed);
+    const uint64_t window_received_count = received_count - window_start_received_count_;
+    window_start_received_count_ = received_count;
 
-      subscriber_statistics_collectors_.clear();
+    // A single sample, taken at the end of the window
+    StatisticData data;
+    data.average = static_cast<double>(window_received_count);
+    data.min = data.average;
+    data.max = data.average;
+    data.standard_deviation = 0.0;
+    data.sample_count = 1;
+    msgs.push_back(
+      libstatistics_collector::collector::GenerateStatisticMessage(
+        node_name_,
+        kReceivedMessagesName,
+        kReceivedMessagesUnitName,
+        window_start_,
+        window_end,
+        data));
+
+    if (0 == max_samples_per_period_) {
+      return;
+    }
+    const uint64_t sampling_interval = std::max(
+      min_sampling_interval_,
+      (window_received_count + max_samples_per_period_ - 1) / max_samples_per_period_);
+    if (sampling_interval != sampling_interval_.exchange(sampling_interval)) {
+      // The next period must not span messages counted with different intervals
+      last_message_time_.store(kNoMessageTime, std::memory_order_relaxed);
     }
+  }
 
-    if (publisher_timer_) {
-      publisher_timer_->cancel();
-      publisher_timer_.reset();
+  /// Append a message per intra-process buffer metric, the counts are the window's ones.
+  /**
+   * This method is not thread-safe, the caller must hold mutex_.
+   *
+   * \param window_end the end of the collection window
+   * \param msgs the messages to publish
+   */
+  void add_intra_process_buffer_messages(
+    const rclcpp::Time & window_end,
+    std::vector<MetricsMessage> & msgs)
+  {
+    const auto metrics = intra_process_buffer_metrics_source_();
+    if (!metrics) {
+      return;
     }
+    const std::pair<const char *, double> values[] = {
+      {kIntraProcessBufferDepthName, static_cast<double>(metrics->depth)},
+      {kIntraProcessBufferHighWaterMarkName, static_cast<double>(metrics->high_water_mark)},
+      {kIntraProcessEnqueuedMessagesName,
+        static_cast<double>(metrics->enqueued_count - last_buffer_metrics_.enqueued_count)},
+      {kIntraProcessDequeuedMessagesName,
+        static_cast<double>(metrics->dequeued_count - last_buffer_metrics_.dequeued_count)},
+      {kIntraProcessDroppedMessagesName,
+        static_cast<double>(metrics->dropped_count - last_buffer_metrics_.dropped_count)},
+    };
+    last_buffer_metrics_ = *metrics;
 
-    publisher_.reset();
+    for (const auto & value : values) {
+      // A single sample, taken at the end of the window
+      StatisticData data;
+      data.average = value.second;
+      data.min = value.second;
+      data.max = value.second;
+      data.standard_deviation = 0.0;
+      data.sample_count = 1;
+      msgs.push_back(
+        libstatistics_collector::collector::GenerateStatisticMessage(
+          node_name_,
+          value.first,
+          kIntraProcessBufferMetricUnit,
+          window_start_,
+          window_end,
+          data));
+    }
   }
 
   /// Return the current nanoseconds (count) since epoch.
@@ -226,14 +488,40 @@ private:
     return std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
   }
 
-  /// Mutex to protect the subsequence vectors
+  /// Mutex to protect the intra-process buffer metrics
   mutable std::mutex mutex_;
-  /// Collection of statistics collectors
-  std::vector<std::unique_ptr<TopicStatsCollector>> subscriber_statistics_collectors_{};
+  /// Age of the received messages, measured if they have a header
+  mutable AtomicStatisticsAccumulator message_age_;
+  /// Period between the received messages
+  mutable AtomicStatisticsAccumulator message_period_;
+  /// Time the last message was received, in nanoseconds
+  mutable std::atomic<int64_t> last_message_time_{kNoMessageTime};
+  /// Number of messages received, counted by should_measure_message()
+  mutable std::atomic<uint64_t> received_count_{0};
+  /// Interval between the messages measured
+  std::atomic<uint64_t> sampling_interval_{1};
+  /// Value of received_count_ at the start of the collection window
+  uint64_t window_start_received_count_{0};
   /// Node name used to generate topic statistics messages to be published
   const std::string node_name_;
   /// Publisher, created by the node, used to publish topic statistics messages
   rclcpp::Publisher<statistics_msgs::msg::MetricsMessage>::SharedPtr publisher_;
+  /// Percentiles of the message age and period to publish
+  const std::vector<double> percentiles_;
+  /// Minimum interval between the messages measured, given at construction
+  const uint64_t min_sampling_interval_;
+  /// Maximum number of messages measured per window, 0 for no limit
+  const uint64_t max_samples_per_period_;
+  /// Names of the metrics of the percentiles
+  std::vector<std::string> message_age_percentile_names_;
+  std::vector<std::string> message_period_percentile_names_;
+  /// Histograms of the message age and period in nanoseconds, set if percentiles are published
+  std::unique_ptr<AtomicHistogram> message_age_histogram_;
+  std::unique_ptr<AtomicHistogram> message_period_histogram_;
+  /// Function giving the metrics of the intra-process buffer, if any
+  std::function<std::optional<BufferMetrics>()> intra_process_buffer_metrics_source_{nullptr};
+  /// The intra-process buffer metrics at the start of the collection window
+  BufferMetrics last_buffer_metrics_{};
   /// Timer which fires the publisher
   rclcpp::TimerBase::SharedPtr publisher_timer_;
   /// The start of the collection window, used in the published topic statistics message
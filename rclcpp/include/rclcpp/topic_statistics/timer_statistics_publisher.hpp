@@ -0,0 +1,193 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__TOPIC_STATISTICS__TIMER_STATISTICS_PUBLISHER_HPP_
+#define RCLCPP__TOPIC_STATISTICS__TIMER_STATISTICS_PUBLISHER_HPP_
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/publisher.hpp"
+#include "rclcpp/qos.hpp"
+#include "rclcpp/time.hpp"
+#include "rclcpp/timer.hpp"
+#include "rclcpp/timer_statistics.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+#include "statistics_msgs/msg/metrics_message.hpp"
+
+namespace rclcpp
+{
+namespace topic_statistics
+{
+
+constexpr const char kTimerLatenessName[]{"timer_lateness"};
+constexpr const char kTimerLatenessP50Name[]{"timer_lateness_p50"};
+constexpr const char kTimerLatenessP90Name[]{"timer_lateness_p90"};
+constexpr const char kTimerLatenessP99Name[]{"timer_lateness_p99"};
+constexpr const char kTimerExecutionTimeName[]{"timer_execution_time"};
+constexpr const char kTimerMissedPeriodsName[]{"timer_missed_periods"};
+constexpr const char kTimerMissedPeriodsUnitName[]{"periods"};
+
+/// Options of the publication of the statistics of a timer.
+struct TimerStatisticsPublisherOptions
+{
+  /// Topic to which the statistics get published. Defaults to /statistics.
+  std::string publish_topic = "/statistics";
+
+  /// Publication period of the statistics. Only values greater than zero are allowed.
+  std::chrono::milliseconds publish_period{std::chrono::seconds(1)};
+
+  /// QoS of the statistics publisher.
+  rclcpp::QoS qos = rclcpp::QoS(10);
+
+  /// Callback group of the timer publishing the statistics, the default one if null.
+  rclcpp::CallbackGroup::SharedPtr callback_group = nullptr;
+};
+
+/**
+ * Class used to publish the statistics of a timer, see rclcpp::TimerStatistics, as
+ * statistics_msgs::msg::MetricsMessage like the topic statistics.
+ * Each publication ends the window of the statistics, the lateness and execution time are
+ * published in milliseconds with the 50th, 90th and 99th percentiles of the lateness, and the
+ * number of missed periods as a single sample.
+ */
+class TimerStatisticsPublisher
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(TimerStatisticsPublisher)
+
+  using MetricsPublisher =
+    rclcpp::Publisher<statistics_msgs::msg::MetricsMessage, std::allocator<void>>;
+
+  /// Construct a TimerStatisticsPublisher object.
+  /**
+   * \param source_name the name of the measurement source of the messages, e.g. the name of
+   * the node and of the timer
+   * \param statistics the statistics of the timer
+   * \param publisher instance constructed by the node in order to publish statistics data.
+   * This class owns the publisher.
+   * \throws std::invalid_argument if the statistics or publisher pointer is nullptr
+   */
+  RCLCPP_PUBLIC
+  TimerStatisticsPublisher(
+    const std::string & source_name,
+    rclcpp::TimerStatistics::SharedPtr statistics,
+    std::shared_ptr<MetricsPublisher> publisher);
+
+  RCLCPP_PUBLIC
+  virtual ~TimerStatisticsPublisher();
+
+  /// Set the timer used to publish statistics messages.
+  /**
+   * \param publisher_timer the timer to fire the publisher, created by the node
+   */
+  RCLCPP_PUBLIC
+  void set_publisher_timer(std::shared_ptr<rclcpp::TimerBase> publisher_timer);
+
+  /// Publish the statistics of the current window and start a new one.
+  RCLCPP_PUBLIC
+  virtual void publish_message_and_reset_measurements();
+
+  /// Return the messages of the statistics of a window.
+  /**
+   * \param source_name the name of the measurement source of the messages
+   * \param snapshot the statistics of the window
+   * \param window_start the start of the window
+   * \param window_end the end of the window
+   * \return the lateness, lateness percentiles, execution time and missed periods messages
+   */
+  RCLCPP_PUBLIC
+  static std::vector<statistics_msgs::msg::MetricsMessage>
+  generate_messages(
+    const std::string & source_name,
+    const rclcpp::TimerStatistics::Snapshot & snapshot,
+    const rclcpp::Time & window_start,
+    const rclcpp::Time & window_end);
+
+private:
+  /// Name of the measurement source of the messages
+  const std::string source_name_;
+  /// Statistics of the measured timer
+  rclcpp::TimerStatistics::SharedPtr statistics_;
+  /// Publisher, created by the node, used to publish the statistics messages
+  std::shared_ptr<MetricsPublisher> publisher_;
+  /// Timer which fires the publisher
+  std::shared_ptr<rclcpp::TimerBase> publisher_timer_;
+  /// The start of the collection window, used in the published statistics messages
+  rclcpp::Time window_start_;
+};
+
+/// Enable the statistics of a timer and publish them periodically.
+/**
+ * The statistics are published on the topic of the options by a wall timer of the node, with
+ * the fully qualified name of the node and the name of the timer as measurement source, e.g.
+ * "/my_node/control_loop".
+ *
+ * \param node the node creating the statistics publisher and its timer
+ * \param timer the timer whose statistics are published
+ * \param timer_name the name of the timer in the messages
+ * \param options the options of the publication
+ * \return the statistics publisher, which must be kept alive to publish
+ * \throws std::invalid_argument if the timer is nullptr or the publish period is less than or
+ * equal to zero.
+ */
+template<typename NodeT>
+TimerStatisticsPublisher::SharedPtr
+create_timer_statistics_publisher(
+  NodeT & node,
+  rclcpp::TimerBase::SharedPtr timer,
+  const std::string & timer_name,
+  const TimerStatisticsPublisherOptions & options = TimerStatisticsPublisherOptions())
+{
+  if (!timer) {
+    throw std::invalid_argument("timer pointer is nullptr");
+  }
+  if (options.publish_period <= std::chrono::milliseconds(0)) {
+    throw std::invalid_argument(
+            "publish_period must be greater than 0, specified value of " +
+            std::to_string(options.publish_period.count()) +
+            " ms");
+  }
+
+  auto publisher = node.template create_publisher<statistics_msgs::msg::MetricsMessage>(
+    options.publish_topic, options.qos);
+  auto statistics_publisher = std::make_shared<TimerStatisticsPublisher>(
+    std::string(node.get_fully_qualified_name()) + "/" + timer_name,
+    timer->enable_statistics(),
+    std::move(publisher));
+
+  std::weak_ptr<TimerStatisticsPublisher> weak_statistics_publisher(statistics_publisher);
+  auto publisher_timer = node.create_wall_timer(
+    options.publish_period,
+    [weak_statistics_publisher]() {
+      auto statistics_publisher = weak_statistics_publisher.lock();
+      if (statistics_publisher) {
+        statistics_publisher->publish_message_and_reset_measurements();
+      }
+    },
+    options.callback_group);
+  statistics_publisher->set_publisher_timer(publisher_timer);
+  return statistics_publisher;
+}
+
+}  // namespace topic_statistics
+}  // namespace rclcpp
+
+#endif  // RCLCPP__TOPIC_STATISTICS__TIMER_STATISTICS_PUBLISHER_HPP_
@@ -15,7 +15,9 @@
 #ifndef RCLCPP__TYPE_ADAPTER_HPP_
 #define RCLCPP__TYPE_ADAPTER_HPP_
 
+#include <memory>
 #include <type_traits>
+#include <utility>
 
 namespace rclcpp
 {
@@ -93,6 +95,23 @@ namespace rclcpp
  *     // Then you can create things with just the custom type, and the ROS
  *     // message type is implied based on the previous statement.
  *     auto pub = node->create_publisher<std::string>(...);
+ *
+ * A custom type can also be a view of the ROS message, e.g. an image type referencing the
+ * `data` sequence of a `sensor_msgs::msg::Image` instead of copying the pixels.
+ * The specialization then provides, in addition to the convert functions above:
+ *
+ *   - static void convert_to_custom(
+ *       const std::shared_ptr<const ros_message_type> &, custom_type &)
+ *     which makes the custom type refer to the data of the shared ROS message, keeping a
+ *     shared ownership of it for as long as the data is referenced,
+ *   - optionally static std::shared_ptr<const ros_message_type> get_viewed_ros_message(
+ *       const custom_type &)
+ *     which returns the ROS message the custom type refers to, or nullptr if it doesn't.
+ *
+ * rclcpp uses them whenever it holds the ROS message in a shared pointer, so that neither
+ * the subscriptions receiving the custom type nor the publishers of the custom type copy
+ * the data, within the process or not.
+ * The ROS messages viewed this way must not be modified.
  */
 template<typename CustomType, typename ROSMessageType = void, class Enable = void>
 struct TypeAdapter
@@ -196,6 +215,61 @@ struct TypeAdapter<T, void, std::enable_if_t<ImplicitTypeAdapter<T>::is_speciali
       "Cannot use custom type as ros type when there is no TypeAdapter for that pair"); \
   }
 
+namespace detail
+{
+
+/// True if the TypeAdapter can make a custom type which is a view of a shared ROS message.
+template<typename TypeAdapterT, typename = void>
+struct is_view_type_adapter : std::false_type {};
+
+template<typename TypeAdapterT>
+struct is_view_type_adapter<
+  TypeAdapterT,
+  std::void_t<decltype(TypeAdapterT::convert_to_custom(
+    std::declval<const std::shared_ptr<const typename TypeAdapterT::ros_message_type> &>(),
+    std::declval<typename TypeAdapterT::custom_type &>()))>
+>: std::true_type {};
+
+/// True if the TypeAdapter can return the ROS message a custom type is a view of.
+template<typename TypeAdapterT, typename = void>
+struct has_viewed_ros_message : std::false_type {};
+
+template<typename TypeAdapterT>
+struct has_viewed_ros_message<
+  TypeAdapterT,
+  std::void_t<decltype(TypeAdapterT::get_viewed_ros_message(
+    std::declval<const typename TypeAdapterT::custom_type &>()))>
+>: std::true_type {};
+
+/// Convert a shared ROS message to the custom type, as a view of it if the adapter allows it.
+template<typename TypeAdapterT>
+void
+convert_shared_to_custom(
+  const std::shared_ptr<const typename TypeAdapterT::ros_message_type> & source,
+  typename TypeAdapterT::custom_type & destination)
+{
+  if constexpr (is_view_type_adapter<TypeAdapterT>::value) {
+    TypeAdapterT::convert_to_custom(source, destination);
+  } else {
+    TypeAdapterT::convert_to_custom(*source, destination);
+  }
+}
+
+/// Return the ROS message the custom type is a view of, or nullptr if it must be converted.
+template<typename TypeAdapterT>
+std::shared_ptr<const typename TypeAdapterT::ros_message_type>
+get_viewed_ros_message(const typename TypeAdapterT::custom_type & source)
+{
+  if constexpr (has_viewed_ros_message<TypeAdapterT>::value) {
+    return TypeAdapterT::get_viewed_ros_message(source);
+  } else {
+    (void)source;
+    return nullptr;
+  }
+}
+
+}  // namespace detail
+
 }  // namespace rclcpp
 
 #endif  // RCLCPP__TYPE_ADAPTER_HPP_
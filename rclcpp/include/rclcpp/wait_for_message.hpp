@@ -78,6 +78,8 @@ bool wait_for_message(
 /// Wait for the next incoming message.
 /**
  * Wait for the next incoming message to arrive on a specified topic before the specified timeout.
+ * The subscription is created for this call, to sample a topic repeatedly use a
+ * rclcpp::MessageSampler instead.
  *
  * \param[out] out is the message to be filled when a new message is arriving.
  * \param[in] node the node pointer to initialize the subscription on.
@@ -18,10 +18,12 @@
 #include <cassert>
 #include <functional>
 #include <stdexcept>
+#include <utility>
 
 #include "rcl/wait.h"
 
 #include "rclcpp/macros.hpp"
+#include "rclcpp/ready_entities.hpp"
 #include "rclcpp/wait_result_kind.hpp"
 
 namespace rclcpp
@@ -35,7 +37,8 @@ namespace rclcpp
  *
  *   - provides the result of waiting, i.e. ready, timeout, or empty, and
  *   - holds the ownership of the entities of the wait set, if needed, and
- *   - provides the necessary information for iterating over the wait set.
+ *   - provides the necessary information for iterating over the wait set, or
+ *     over only its ready entities.
  *
  * This class is only valid as long as the wait set which created it is valid,
  * and it must be deleted before the wait set is deleted, as it contains a
@@ -122,9 +125,28 @@ public:
     return *wait_set_pointer_;
   }
 
+  /// Return the entities which are ready.
+  /**
+   * The entities are collected the first time this is called, once for this result, so that
+   * only the ready entities have to be visited instead of every entity of the wait set.
+   *
+   * \return the ready entities, empty if the result was not ready.
+   */
+  const ReadyEntities &
+  get_ready_entities()
+  {
+    if (!ready_entities_collected_ && wait_set_pointer_) {
+      wait_set_pointer_->wait_result_collect_ready_entities(ready_entities_);
+    }
+    ready_entities_collected_ = true;
+    return ready_entities_;
+  }
+
   WaitResult(WaitResult && other) noexcept
   : wait_result_kind_(other.wait_result_kind_),
-    wait_set_pointer_(std::exchange(other.wait_set_pointer_, nullptr))
+    wait_set_pointer_(std::exchange(other.wait_set_pointer_, nullptr)),
+    ready_entities_(std::move(other.ready_entities_)),
+    ready_entities_collected_(other.ready_entities_collected_)
   {}
 
   ~WaitResult()
@@ -157,6 +179,9 @@ private:
   const WaitResultKind wait_result_kind_;
 
   WaitSetT * wait_set_pointer_ = nullptr;
+
+  ReadyEntities ready_entities_;
+  bool ready_entities_collected_ = false;
 };
 
 }  // namespace rclcpp
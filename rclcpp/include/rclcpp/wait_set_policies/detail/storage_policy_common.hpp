@@ -15,15 +15,19 @@
 #ifndef RCLCPP__WAIT_SET_POLICIES__DETAIL__STORAGE_POLICY_COMMON_HPP_
 #define RCLCPP__WAIT_SET_POLICIES__DETAIL__STORAGE_POLICY_COMMON_HPP_
 
+#include <algorithm>
+#include <iterator>
 #include <memory>
 #include <stdexcept>
 #include <utility>
+#include <vector>
 
 #include "rcl/wait.h"
 
 #include "rclcpp/exceptions.hpp"
 #include "rclcpp/logging.hpp"
 #include "rclcpp/macros.hpp"
+#include "rclcpp/ready_entities.hpp"
 #include "rclcpp/visibility_control.hpp"
 #include "rclcpp/waitable.hpp"
 
@@ -147,6 +151,71 @@ protected:
     return {shared_pointer, shared_pointer.get()};
   }
 
+  template<class EntityT>
+  static std::shared_ptr<EntityT>
+  to_shared_pointer(const std::shared_ptr<EntityT> & shared_pointer)
+  {
+    return shared_pointer;
+  }
+
+  template<class EntityT>
+  static std::shared_ptr<EntityT>
+  to_shared_pointer(const std::weak_ptr<EntityT> & weak_pointer)
+  {
+    return weak_pointer.lock();
+  }
+
+  template<class EntityT>
+  static constexpr bool
+  is_expired(const std::shared_ptr<EntityT> &)
+  {
+    return false;
+  }
+
+  template<class EntityT>
+  static bool
+  is_expired(const std::weak_ptr<EntityT> & weak_pointer)
+  {
+    return weak_pointer.expired();
+  }
+
+  /// Return true if one of the entities, other than the waitables, was deleted.
+  template<
+    class SubscriptionsIterable,
+    class GuardConditionsIterable,
+    class TimersIterable,
+    class ClientsIterable,
+    class ServicesIterable
+  >
+  static bool
+  has_expired_entity(
+    const SubscriptionsIterable & subscriptions,
+    const GuardConditionsIterable & guard_conditions,
+    const TimersIterable & timers,
+    const ClientsIterable & clients,
+    const ServicesIterable & services)
+  {
+    if (HasStrongOwnership) {
+      return false;
+    }
+    for (const auto & subscription_entry : subscriptions) {
+      if (is_expired(subscription_entry.subscription)) {
+        return true;
+      }
+    }
+    auto any_expired = [](const auto & entities) {
+        for (const auto & entity : entities) {
+          if (is_expired(entity)) {
+            return true;
+          }
+        }
+        return false;
+      };
+    return
+      any_expired(guard_conditions) || any_expired(timers) || any_expired(clients) ||
+      any_expired(services);
+  }
+
   /// Rebuild the wait set, preparing it for the next wait call.
   /**
    * The wait set is rebuilt by:
@@ -154,6 +223,11 @@ protected:
    *   - resizing the wait set if needed,
    *   - clearing the wait set if not already done by resizing, and
    *   - re-adding the entities.
+   *
+   * rcl_wait() removes the entities which aren't ready from the rcl wait set, so the entities
+   * are added again before each wait.
+   * The rcl handles of the entities other than the waitables are kept from the last rebuild,
+   * and added again directly, as long as no entity was added, removed or deleted since.
    */
   template<
     class SubscriptionsIterable,
@@ -242,8 +316,25 @@ protected:
       }
     }
 
+    // Reuse the handles of the last rebuild if the entities didn't change.
+    if (
+      has_cached_handles_ && !was_resized &&
+      !has_expired_entity(subscriptions, guard_conditions, timers, clients, services))
+    {
+      this->storage_add_cached_handles(guard_conditions, extra_guard_conditions, waitables);
+      return;
+    }
+    has_cached_handles_ = false;
+    cached_subscriptions_.clear();
+    cached_guard_conditions_.clear();
+    cached_timers_.clear();
+    cached_clients_.clear();
+    cached_services_.clear();
+
     // Add subscriptions.
+    size_t subscription_index = 0;
     for (const auto & subscription_entry : subscriptions) {
+      const size_t entity_index = subscription_index++;
       auto subscription_ptr_pair =
         get_raw_pointer_from_smart_pointer(subscription_entry.subscription);
       if (nullptr == subscription_ptr_pair.second) {
@@ -257,20 +348,22 @@ protected:
         needs_pruning_ = true;
         continue;
       }
-      rcl_ret_t ret = rcl_wait_set_add_subscription(
-        &rcl_wait_set_,
-        subscription_ptr_pair.second->get_subscription_handle().get(),
-        nullptr);
+      const rcl_subscription_t * subscription_handle =
+        subscription_ptr_pair.second->get_subscription_handle().get();
+      rcl_ret_t ret = rcl_wait_set_add_subscription(&rcl_wait_set_, subscription_handle, nullptr);
       if (RCL_RET_OK != ret) {
         rclcpp::exceptions::throw_from_rcl_error(ret);
       }
+      cached_subscriptions_.push_back(subscription_handle, entity_index);
     }
 
     // Setup common code to add guard_conditions.
     auto add_guard_conditions =
-      [this](const auto & inner_guard_conditions)
+      [this](const auto & inner_guard_conditions, bool cache_handles)
       {
+        size_t guard_condition_index = 0;
         for (const auto & guard_condition : inner_guard_conditions) {
+          const size_t entity_index = guard_condition_index++;
           auto guard_condition_ptr_pair = get_raw_pointer_from_smart_pointer(guard_condition);
           if (nullptr == guard_condition_ptr_pair.second) {
             // In this case it was probably stored as a weak_ptr, but is now locking to nullptr.
@@ -283,24 +376,30 @@ protected:
             needs_pruning_ = true;
             continue;
           }
+          guard_condition_ptr_pair.second->reset_coalesced_triggers();
+          const rcl_guard_condition_t * guard_condition_handle =
+            &guard_condition_ptr_pair.second->get_rcl_guard_condition();
           rcl_ret_t ret = rcl_wait_set_add_guard_condition(
-            &rcl_wait_set_,
-            &guard_condition_ptr_pair.second->get_rcl_guard_condition(),
-            nullptr);
+            &rcl_wait_set_, guard_condition_handle, nullptr);
           if (RCL_RET_OK != ret) {
             rclcpp::exceptions::throw_from_rcl_error(ret);
           }
+          if (cache_handles) {
+            cached_guard_conditions_.push_back(guard_condition_handle, entity_index);
+          }
         }
       };
 
     // Add guard conditions.
-    add_guard_conditions(guard_conditions);
+    add_guard_conditions(guard_conditions, true);
 
-    // Add extra guard conditions.
-    add_guard_conditions(extra_guard_conditions);
+    // Add extra guard conditions, they are added again from the arguments on each rebuild.
+    add_guard_conditions(extra_guard_conditions, false);
 
     // Add timers.
+    size_t timer_index = 0;
     for (const auto & timer : timers) {
+      const size_t entity_index = timer_index++;
       auto timer_ptr_pair = get_raw_pointer_from_smart_pointer(timer);
       if (nullptr == timer_ptr_pair.second) {
         // In this case it was probably stored as a weak_ptr, but is now locking to nullptr.
@@ -313,17 +412,18 @@ protected:
         needs_pruning_ = true;
         continue;
       }
-      rcl_ret_t ret = rcl_wait_set_add_timer(
-        &rcl_wait_set_,
-        timer_ptr_pair.second->get_timer_handle().get(),
-        nullptr);
+      const rcl_timer_t * timer_handle = timer_ptr_pair.second->get_timer_handle().get();
+      rcl_ret_t ret = rcl_wait_set_add_timer(&rcl_wait_set_, timer_handle, nullptr);
       if (RCL_RET_OK != ret) {
         rclcpp::exceptions::throw_from_rcl_error(ret);
       }
+      cached_timers_.push_back(timer_handle, entity_index);
     }
 
     // Add clients.
+    size_t client_index = 0;
     for (const auto & client : clients) {
+      const size_t entity_index = client_index++;
       auto client_ptr_pair = get_raw_pointer_from_smart_pointer(client);
       if (nullptr == client_ptr_pair.second) {
         // In this case it was probably stored as a weak_ptr, but is now locking to nullptr.
@@ -336,17 +436,18 @@ protected:
         needs_pruning_ = true;
         continue;
       }
-      rcl_ret_t ret = rcl_wait_set_add_client(
-        &rcl_wait_set_,
-        client_ptr_pair.second->get_client_handle().get(),
-        nullptr);
+      const rcl_client_t * client_handle = client_ptr_pair.second->get_client_handle().get();
+      rcl_ret_t ret = rcl_wait_set_add_client(&rcl_wait_set_, client_handle, nullptr);
       if (RCL_RET_OK != ret) {
         rclcpp::exceptions::throw_from_rcl_error(ret);
       }
+      cached_clients_.push_back(client_handle, entity_index);
     }
 
     // Add services.
+    size_t service_index = 0;
     for (const auto & service : services) {
+      const size_t entity_index = service_index++;
       auto service_ptr_pair = get_raw_pointer_from_smart_pointer(service);
       if (nullptr == service_ptr_pair.second) {
         // In this case it was probably stored as a weak_ptr, but is now locking to nullptr.
@@ -359,13 +460,12 @@ protected:
         needs_pruning_ = true;
         continue;
       }
-      rcl_ret_t ret = rcl_wait_set_add_service(
-        &rcl_wait_set_,
-        service_ptr_pair.second->get_service_handle().get(),
-        nullptr);
+      const rcl_service_t * service_handle = service_ptr_pair.second->get_service_handle().get();
+      rcl_ret_t ret = rcl_wait_set_add_service(&rcl_wait_set_, service_handle, nullptr);
       if (RCL_RET_OK != ret) {
         rclcpp::exceptions::throw_from_rcl_error(ret);
       }
+      cached_services_.push_back(service_handle, entity_index);
     }
 
     // Add waitables.
@@ -385,6 +485,172 @@ protected:
       rclcpp::Waitable & waitable = *waitable_ptr_pair.second;
       waitable.add_to_wait_set(&rcl_wait_set_);
     }
+    has_cached_handles_ = true;
+  }
+
+  /// Add the cached handles, the extra guard conditions and the waitables to the wait set.
+  template<
+    class GuardConditionsIterable,
+    class ExtraGuardConditionsIterable,
+    class WaitablesIterable
+  >
+  void
+  storage_add_cached_handles(
+    const GuardConditionsIterable & guard_conditions,
+    const ExtraGuardConditionsIterable & extra_guard_conditions,
+    const WaitablesIterable & waitables)
+  {
+    auto check = [](rcl_ret_t ret) {
+        if (RCL_RET_OK != ret) {
+          rclcpp::exceptions::throw_from_rcl_error(ret);
+        }
+      };
+    for (const rcl_subscription_t * subscription_handle : cached_subscriptions_.handles) {
+      check(rcl_wait_set_add_subscription(&rcl_wait_set_, subscription_handle, nullptr));
+    }
+    for (size_t i = 0; i < cached_guard_conditions_.handles.size(); ++i) {
+      // The entities didn't expire since the rebuild, so the guard condition is still there.
+      auto guard_condition_ptr_pair = get_raw_pointer_from_smart_pointer(
+        guard_conditions[cached_guard_conditions_.entity_indices[i]]);
+      if (nullptr != guard_condition_ptr_pair.second) {
+        guard_condition_ptr_pair.second->reset_coalesced_triggers();
+      }
+      check(
+        rcl_wait_set_add_guard_condition(
+          &rcl_wait_set_, cached_guard_conditions_.handles[i], nullptr));
+    }
+    for (const auto & guard_condition : extra_guard_conditions) {
+      auto guard_condition_ptr_pair = get_raw_pointer_from_smart_pointer(guard_condition);
+      if (nullptr != guard_condition_ptr_pair.second) {
+        guard_condition_ptr_pair.second->reset_coalesced_triggers();
+        check(
+          rcl_wait_set_add_guard_condition(
+            &rcl_wait_set_, &guard_condition_ptr_pair.second->get_rcl_guard_condition(),
+            nullptr));
+      }
+    }
+    for (const rcl_timer_t * timer_handle : cached_timers_.handles) {
+      check(rcl_wait_set_add_timer(&rcl_wait_set_, timer_handle, nullptr));
+    }
+    for (const rcl_client_t * client_handle : cached_clients_.handles) {
+      check(rcl_wait_set_add_client(&rcl_wait_set_, client_handle, nullptr));
+    }
+    for (const rcl_service_t * service_handle : cached_services_.handles) {
+      check(rcl_wait_set_add_service(&rcl_wait_set_, service_handle, nullptr));
+    }
+    for (auto & waitable_entry : waitables) {
+      auto waitable_ptr_pair = get_raw_pointer_from_smart_pointer(waitable_entry.waitable);
+      if (nullptr == waitable_ptr_pair.second) {
+        // This waitable has gone out of scope, it needs pruning.
+        needs_pruning_ = true;
+        continue;
+      }
+      waitable_ptr_pair.second->add_to_wait_set(&rcl_wait_set_);
+    }
+  }
+
+  /// Collect the ready entities of one kind, see storage_collect_ready_entities_with_sets().
+  template<class HandleT, class EntitiesIterable, class GetEntity, class GetHandle, class ReadyT>
+  static void
+  collect_ready_entities(
+    const HandleT * const * slots,
+    size_t size_of_slots,
+    const CachedHandles<HandleT> & cached_handles,
+    const EntitiesIterable & entities,
+    GetEntity get_entity,
+    GetHandle get_handle,
+    ReadyT & ready)
+  {
+    // The extra guard conditions follow the cached ones and are left out.
+    const size_t size = std::min(size_of_slots, cached_handles.handles.size());
+    for (size_t slot = 0; slot < size; ++slot) {
+      if (nullptr == slots[slot]) {
+        continue;
+      }
+      const size_t entity_index = cached_handles.entity_indices[slot];
+      decltype(get_entity(*std::begin(entities))) entity;
+      if (entity_index < entities.size()) {
+        entity = get_entity(entities[entity_index]);
+      }
+      if (!entity || get_handle(*entity) != slots[slot]) {
+        // The entities were modified while waiting, look the entity up by its handle.
+        entity = nullptr;
+        for (const auto & other : entities) {
+          auto other_entity = get_entity(other);
+          if (other_entity && get_handle(*other_entity) == slots[slot]) {
+            entity = std::move(other_entity);
+            break;
+          }
+        }
+      }
+      if (entity) {
+        ready.push_back(std::move(entity));
+      }
+    }
+  }
+
+  /// Collect the entities which are ready in the rcl wait set after waiting.
+  /**
+   * The ready slots of the rcl wait set are mapped back to the entities with the handles
+   * recorded by the last rebuild.
+   * Entities removed since the rebuild are left out.
+   */
+  template<
+    class SubscriptionsIterable,
+    class GuardConditionsIterable,
+    class TimersIterable,
+    class ClientsIterable,
+    class ServicesIterable,
+    class WaitablesIterable
+  >
+  void
+  storage_collect_ready_entities_with_sets(
+    const SubscriptionsIterable & subscriptions,
+    const GuardConditionsIterable & guard_conditions,
+    const TimersIterable & timers,
+    const ClientsIterable & clients,
+    const ServicesIterable & services,
+    const WaitablesIterable & waitables,
+    rclcpp::ReadyEntities & ready_entities)
+  {
+    ready_entities.clear();
+    auto get_shared_pointer = [](const auto & entity) {return to_shared_pointer(entity);};
+    collect_ready_entities(
+      rcl_wait_set_.subscriptions, rcl_wait_set_.size_of_subscriptions, cached_subscriptions_,
+      subscriptions,
+      [](const auto & entry) {return to_shared_pointer(entry.subscription);},
+      [](rclcpp::SubscriptionBase & subscription) {
+        return subscription.get_subscription_handle().get();
+      },
+      ready_entities.subscriptions);
+    collect_ready_entities(
+      rcl_wait_set_.guard_conditions, rcl_wait_set_.size_of_guard_conditions,
+      cached_guard_conditions_, guard_conditions, get_shared_pointer,
+      [](rclcpp::GuardCondition & guard_condition) {
+        return &guard_condition.get_rcl_guard_condition();
+      },
+      ready_entities.guard_conditions);
+    collect_ready_entities(
+      rcl_wait_set_.timers, rcl_wait_set_.size_of_timers, cached_timers_, timers,
+      get_shared_pointer,
+      [](rclcpp::TimerBase & timer) {return timer.get_timer_handle().get();},
+      ready_entities.timers);
+    collect_ready_entities(
+      rcl_wait_set_.clients, rcl_wait_set_.size_of_clients, cached_clients_, clients,
+      get_shared_pointer,
+      [](rclcpp::ClientBase & client) {return client.get_client_handle().get();},
+      ready_entities.clients);
+    collect_ready_entities(
+      rcl_wait_set_.services, rcl_wait_set_.size_of_services, cached_services_, services,
+      get_shared_pointer,
+      [](rclcpp::ServiceBase & service) {return service.get_service_handle().get();},
+      ready_entities.services);
+    for (const auto & waitable_entry : waitables) {
+      auto waitable = to_shared_pointer(waitable_entry.waitable);
+      if (waitable && waitable->is_ready(&rcl_wait_set_)) {
+        ready_entities.waitables.push_back(std::move(waitable));
+      }
+    }
   }
 
   const rcl_wait_set_t &
@@ -405,11 +671,41 @@ protected:
     needs_resize_ = true;
   }
 
+  /// rcl handles added by the last rebuild, in the order of their slots in the rcl wait set.
+  template<class HandleT>
+  struct CachedHandles
+  {
+    std::vector<const HandleT *> handles;
+    /// Index of the entity of each handle, in the sequence of entities of the storage.
+    std::vector<size_t> entity_indices;
+
+    void
+    push_back(const HandleT * handle, size_t entity_index)
+    {
+      handles.push_back(handle);
+      entity_indices.push_back(entity_index);
+    }
+
+    void
+    clear()
+    {
+      handles.clear();
+      entity_indices.clear();
+    }
+  };
+
   rcl_wait_set_t rcl_wait_set_;
   rclcpp::Context::SharedPtr context_;
 
   bool needs_pruning_ = false;
   bool needs_resize_ = false;
+
+  CachedHandles<rcl_subscription_t> cached_subscriptions_;
+  CachedHandles<rcl_guard_condition_t> cached_guard_conditions_;
+  CachedHandles<rcl_timer_t> cached_timers_;
+  CachedHandles<rcl_client_t> cached_clients_;
+  CachedHandles<rcl_service_t> cached_services_;
+  bool has_cached_handles_ = false;
 };
 
 }  // namespace detail
@@ -47,6 +47,21 @@ protected:
     }
   }
 
+  /// Return true if waiting should go on, like the predicate of create_loop_predicate().
+  /**
+   * Unlike create_loop_predicate(), this doesn't create a std::function, so that waiting
+   * doesn't allocate.
+   */
+  bool
+  should_keep_waiting(
+    std::chrono::nanoseconds time_to_wait_ns,
+    std::chrono::steady_clock::time_point start)
+  {
+    return
+      time_to_wait_ns < std::chrono::nanoseconds(0) ||
+      std::chrono::steady_clock::now() < start + time_to_wait_ns;
+  }
+
   std::chrono::nanoseconds
   calculate_time_left_to_wait(
     std::chrono::nanoseconds original_time_to_wait_ns,
@@ -215,6 +215,20 @@ public:
     );
   }
 
+  void
+  storage_collect_ready_entities(rclcpp::ReadyEntities & ready_entities)
+  {
+    this->storage_collect_ready_entities_with_sets(
+      subscriptions_,
+      guard_conditions_,
+      timers_,
+      clients_,
+      services_,
+      waitables_,
+      ready_entities
+    );
+  }
+
   template<class EntityT, class SequenceOfEntitiesT>
   static
   bool
@@ -407,6 +421,7 @@ public:
         }
       };
     // Lock all the weak pointers and hold them until released.
+    lock_all(subscriptions_, shared_subscriptions_);
     lock_all(guard_conditions_, shared_guard_conditions_);
     lock_all(timers_, shared_timers_);
     lock_all(clients_, shared_clients_);
@@ -438,6 +453,7 @@ public:
           shared_ptr.reset();
         }
       };
+    reset_all(shared_subscriptions_);
     reset_all(shared_guard_conditions_);
     reset_all(shared_timers_);
     reset_all(shared_clients_);
@@ -235,13 +235,26 @@ protected:
   }
 
   /// Implements wait without any thread-safety.
-  template<class WaitResultT>
+  /**
+   * The functions are taken as template parameters rather than std::function,
+   * so that waiting doesn't allocate.
+   *
+   * \param[in] rebuild_rcl_wait_set function to rebuild the rcl wait set.
+   * \param[in] get_rcl_wait_set function returning the rcl wait set.
+   * \param[in] create_wait_result function creating the WaitResultT from a WaitResultKind.
+   */
+  template<
+    class WaitResultT,
+    class RebuildRclWaitSetT,
+    class GetRclWaitSetT,
+    class CreateWaitResultT
+  >
   WaitResultT
   sync_wait(
     std::chrono::nanoseconds time_to_wait_ns,
-    std::function<void()> rebuild_rcl_wait_set,
-    std::function<rcl_wait_set_t & ()> get_rcl_wait_set,
-    std::function<WaitResultT(WaitResultKind wait_result_kind)> create_wait_result)
+    RebuildRclWaitSetT && rebuild_rcl_wait_set,
+    GetRclWaitSetT && get_rcl_wait_set,
+    CreateWaitResultT && create_wait_result)
   {
     // Assumption: this function assumes that some measure has been taken to
     // ensure none of the entities being waited on by the wait set are allowed
@@ -252,9 +265,7 @@ protected:
     // which calls this function, by acquiring shared ownership of the entites
     // for the duration of this function.
 
-    // Setup looping predicate.
     auto start = std::chrono::steady_clock::now();
-    std::function<bool()> should_loop = this->create_loop_predicate(time_to_wait_ns, start);
 
     // Wait until exit condition is met.
     do {
@@ -292,7 +303,7 @@ protected:
         // Some other error case, throw.
         rclcpp::exceptions::throw_from_rcl_error(ret);
       }
-    } while (should_loop());
+    } while (this->should_keep_waiting(time_to_wait_ns, start));
 
     // Wait did not result in ready items, return timeout.
     return create_wait_result(WaitResultKind::Timeout);
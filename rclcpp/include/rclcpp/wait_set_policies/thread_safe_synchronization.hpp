@@ -15,6 +15,7 @@
 #ifndef RCLCPP__WAIT_SET_POLICIES__THREAD_SAFE_SYNCHRONIZATION_HPP_
 #define RCLCPP__WAIT_SET_POLICIES__THREAD_SAFE_SYNCHRONIZATION_HPP_
 
+#include <atomic>
 #include <chrono>
 #include <functional>
 #include <memory>
@@ -45,9 +46,9 @@ namespace wait_set_policies
  * This class uses a "write-preferring RW lock" so that adding items to, and
  * removing items from, the wait set will take priority over reading, i.e.
  * waiting.
- * This is done since add and remove calls will interrupt the wait set anyways
- * so it is wasteful to do "fair" locking when there are many add/remove
- * operations queued up.
+ * This is done since add calls will interrupt the wait set anyways so it is
+ * wasteful to do "fair" locking when there are many add/remove operations
+ * queued up.
  *
  * There are some things to consider about the thread-safety provided by this
  * policy.
@@ -60,16 +61,22 @@ namespace wait_set_policies
  * will block the other.
  * Therefore, if you are holding a WaitResult in scope, and try to add or
  * remove an entity at the same time, they will block each other.
- * The write activities will try to interrupt the wait() method by triggering
- * a guard condition, but they have no way of causing the WaitResult to release
- * its lock.
+ * Adding an entity interrupts the wait() method by triggering a guard
+ * condition, but it has no way of causing the WaitResult to release its lock.
+ *
+ * The modifications are applied to the storage right away, and the rcl wait set
+ * is rebuilt once per wait cycle with all of them.
+ * Only the first addition after a rebuild interrupts the waiting thread, and
+ * only while it is waiting, so that many additions cause a single rebuild.
+ * Removing an entity doesn't interrupt the waiting thread, as the storage keeps
+ * the entities alive while waiting, and the WaitResult leaves out the removed
+ * entities which became ready.
  */
 class ThreadSafeSynchronization : public detail::SynchronizationPolicyCommon
 {
 protected:
   explicit ThreadSafeSynchronization(rclcpp::Context::SharedPtr context)
-  : extra_guard_conditions_{{std::make_shared<rclcpp::GuardCondition>(context)}},
-    wprw_lock_([this]() {this->interrupt_waiting_wait_set();})
+  : extra_guard_conditions_{{std::make_shared<rclcpp::GuardCondition>(context)}}
   {}
   ~ThreadSafeSynchronization() = default;
 
@@ -86,12 +93,16 @@ protected:
 
   /// Interrupt any waiting wait set.
   /**
-   * Used to interrupt the wait set when adding or removing items.
+   * Used to interrupt the wait set when adding items.
+   * Nothing is done if no thread waits on the entities of the last rebuild, or
+   * if the waiting thread was already interrupted since that rebuild.
    */
   void
   interrupt_waiting_wait_set()
   {
-    extra_guard_conditions_[0]->trigger();
+    if (waiting_on_last_rebuild_.exchange(false)) {
+      extra_guard_conditions_[0]->trigger();
+    }
   }
 
   /// Add subscription.
@@ -106,6 +117,7 @@ protected:
     using rclcpp::wait_set_policies::detail::WritePreferringReadWriteLock;
     std::lock_guard<WritePreferringReadWriteLock::WriteMutex> lock(wprw_lock_.get_write_mutex());
     add_subscription_function(std::move(subscription), mask);
+    this->interrupt_waiting_wait_set();
   }
 
   /// Remove guard condition.
@@ -131,6 +143,7 @@ protected:
     using rclcpp::wait_set_policies::detail::WritePreferringReadWriteLock;
     std::lock_guard<WritePreferringReadWriteLock::WriteMutex> lock(wprw_lock_.get_write_mutex());
     add_guard_condition_function(std::move(guard_condition));
+    this->interrupt_waiting_wait_set();
   }
 
   /// Remove guard condition.
@@ -153,6 +166,7 @@ protected:
     using rclcpp::wait_set_policies::detail::WritePreferringReadWriteLock;
     std::lock_guard<WritePreferringReadWriteLock::WriteMutex> lock(wprw_lock_.get_write_mutex());
     add_timer_function(std::move(timer));
+    this->interrupt_waiting_wait_set();
   }
 
   /// Remove timer.
@@ -175,6 +189,7 @@ protected:
     using rclcpp::wait_set_policies::detail::WritePreferringReadWriteLock;
     std::lock_guard<WritePreferringReadWriteLock::WriteMutex> lock(wprw_lock_.get_write_mutex());
     add_client_function(std::move(client));
+    this->interrupt_waiting_wait_set();
   }
 
   /// Remove client.
@@ -197,6 +212,7 @@ protected:
     using rclcpp::wait_set_policies::detail::WritePreferringReadWriteLock;
     std::lock_guard<WritePreferringReadWriteLock::WriteMutex> lock(wprw_lock_.get_write_mutex());
     add_service_function(std::move(service));
+    this->interrupt_waiting_wait_set();
   }
 
   /// Remove service.
@@ -222,6 +238,7 @@ protected:
     using rclcpp::wait_set_policies::detail::WritePreferringReadWriteLock;
     std::lock_guard<WritePreferringReadWriteLock::WriteMutex> lock(wprw_lock_.get_write_mutex());
     add_waitable_function(std::move(waitable), std::move(associated_entity));
+    this->interrupt_waiting_wait_set();
   }
 
   /// Remove waitable.
@@ -245,13 +262,26 @@ protected:
   }
 
   /// Implements wait.
-  template<class WaitResultT>
+  /**
+   * The functions are taken as template parameters rather than std::function,
+   * so that waiting doesn't allocate.
+   *
+   * \param[in] rebuild_rcl_wait_set function to rebuild the rcl wait set.
+   * \param[in] get_rcl_wait_set function returning the rcl wait set.
+   * \param[in] create_wait_result function creating the WaitResultT from a WaitResultKind.
+   */
+  template<
+    class WaitResultT,
+    class RebuildRclWaitSetT,
+    class GetRclWaitSetT,
+    class CreateWaitResultT
+  >
   WaitResultT
   sync_wait(
     std::chrono::nanoseconds time_to_wait_ns,
-    std::function<void()> rebuild_rcl_wait_set,
-    std::function<rcl_wait_set_t & ()> get_rcl_wait_set,
-    std::function<WaitResultT(WaitResultKind wait_result_kind)> create_wait_result)
+    RebuildRclWaitSetT && rebuild_rcl_wait_set,
+    GetRclWaitSetT && get_rcl_wait_set,
+    CreateWaitResultT && create_wait_result)
   {
     // Assumption: this function assumes that some measure has been taken to
     // ensure none of the entities being waited on by the wait set are allowed
@@ -262,9 +292,7 @@ protected:
     // which calls this function, by acquiring shared ownership of the entites
     // for the duration of this function.
 
-    // Setup looping predicate.
     auto start = std::chrono::steady_clock::now();
-    std::function<bool()> should_loop = this->create_loop_predicate(time_to_wait_ns, start);
 
     // Wait until exit condition is met.
     do {
@@ -280,6 +308,8 @@ protected:
         // This will also clear the wait set and re-add all the entities, which
         // prepares it to be waited on again.
         rebuild_rcl_wait_set();
+        // Additions from now on interrupt the wait, see interrupt_waiting_wait_set().
+        waiting_on_last_rebuild_.store(true);
       }
 
       rcl_wait_set_t & rcl_wait_set = get_rcl_wait_set();
@@ -298,6 +328,7 @@ protected:
       // in the rcl wait set will not be updated until this method calls
       // rebuild_rcl_wait_set().
       rcl_ret_t ret = rcl_wait(&rcl_wait_set, time_left_to_wait_ns.count());
+      waiting_on_last_rebuild_.store(false);
       if (RCL_RET_OK == ret) {
         // Something has become ready in the wait set, first check if it was
         // the guard condition added by this class and/or a user defined guard condition.
@@ -350,7 +381,7 @@ protected:
         // Some other error case, throw.
         rclcpp::exceptions::throw_from_rcl_error(ret);
       }
-    } while (should_loop());
+    } while (this->should_keep_waiting(time_to_wait_ns, start));
 
     // Wait did not result in ready items, return timeout.
     return create_wait_result(WaitResultKind::Timeout);
@@ -371,6 +402,8 @@ protected:
 protected:
   std::array<std::shared_ptr<rclcpp::GuardCondition>, 1> extra_guard_conditions_;
   rclcpp::wait_set_policies::detail::WritePreferringReadWriteLock wprw_lock_;
+  /// True between a rebuild and the end of the following wait, unless interrupted since.
+  std::atomic<bool> waiting_on_last_rebuild_{false};
 };
 
 }  // namespace wait_set_policies
@@ -27,6 +27,7 @@
 #include "rclcpp/contexts/default_context.hpp"
 #include "rclcpp/guard_condition.hpp"
 #include "rclcpp/macros.hpp"
+#include "rclcpp/ready_entities.hpp"
 #include "rclcpp/service.hpp"
 #include "rclcpp/subscription_base.hpp"
 #include "rclcpp/subscription_wait_set_mask.hpp"
@@ -740,6 +741,18 @@ private:
     this->sync_wait_result_release();
   }
 
+  /// Called by the WaitResult to collect the entities which are ready.
+  /**
+   * Should only be called while the WaitResult is holding, i.e. between
+   * wait_result_acquire() and wait_result_release().
+   */
+  void
+  wait_result_collect_ready_entities(ReadyEntities & ready_entities)
+  {
+    // this method comes from the StoragePolicy
+    this->storage_collect_ready_entities(ready_entities);
+  }
+
   bool wait_result_holding_ = false;
 };
 
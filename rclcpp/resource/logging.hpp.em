@@ -20,31 +20,14 @@
 #include <sstream>
 #include <type_traits>
 
+#include "rclcpp/detail/steady_throttle.hpp"
 #include "rclcpp/logger.hpp"
 #include "rcutils/logging_macros.h"
 #include "rclcpp/utilities.hpp"
 
-// These are used for compiling out logging macros lower than a minimum severity.
-#define RCLCPP_LOG_MIN_SEVERITY_DEBUG 0
-#define RCLCPP_LOG_MIN_SEVERITY_INFO 1
-#define RCLCPP_LOG_MIN_SEVERITY_WARN 2
-#define RCLCPP_LOG_MIN_SEVERITY_ERROR 3
-#define RCLCPP_LOG_MIN_SEVERITY_FATAL 4
-#define RCLCPP_LOG_MIN_SEVERITY_NONE 5
-
 #define RCLCPP_FIRST_ARG(N, ...) N
 #define RCLCPP_ALL_BUT_FIRST_ARGS(N, ...) __VA_ARGS__
 
-/**
- * \def RCLCPP_LOG_MIN_SEVERITY
- * Define RCLCPP_LOG_MIN_SEVERITY=RCLCPP_LOG_MIN_SEVERITY_[DEBUG|INFO|WARN|ERROR|FATAL]
- * in your build options to compile out anything below that severity.
- * Use RCLCPP_LOG_MIN_SEVERITY_NONE to compile out all macros.
- */
-#ifndef RCLCPP_LOG_MIN_SEVERITY
-#define RCLCPP_LOG_MIN_SEVERITY RCLCPP_LOG_MIN_SEVERITY_DEBUG
-#endif
-
 @{
 from collections import OrderedDict
 from copy import deepcopy
@@ -90,6 +73,10 @@ def get_rclcpp_suffix_from_features(features):
 /// Empty logging macro due to the preprocessor definition of RCLCPP_LOG_MIN_SEVERITY.
 #define RCLCPP_@(severity)@(suffix)(...)
 @[ end for]@
+/// Empty logging macro due to the preprocessor definition of RCLCPP_LOG_MIN_SEVERITY.
+#define RCLCPP_@(severity)_THROTTLE_STEADY(...)
+/// Empty logging macro due to the preprocessor definition of RCLCPP_LOG_MIN_SEVERITY.
+#define RCLCPP_@(severity)_STREAM_THROTTLE_STEADY(...)
 
 #else
 @[ for feature_combination in rclcpp_feature_combinations.keys()]@
@@ -140,6 +127,13 @@ def get_rclcpp_suffix_from_features(features):
     }; \
 @[ end if] \
 @[ if 'stream' in feature_combination]@
+    RCUTILS_LOGGING_AUTOINIT; \
+    /* the stream isn't formatted for a logger disabled at runtime */ \
+    if (!rcutils_logging_logger_is_enabled_for( \
+        (logger).get_name(), RCUTILS_LOG_SEVERITY_@(severity))) \
+    { \
+      break; \
+    } \
     std::stringstream rclcpp_stream_ss_; \
     rclcpp_stream_ss_ << @(stream_arg); \
 @[ end if]@
@@ -157,6 +151,48 @@ def get_rclcpp_suffix_from_features(features):
   } while (0)
 
 @[ end for]@
+/**
+ * \def RCLCPP_@(severity)_THROTTLE_STEADY
+ * Log a message with severity @(severity) at most once per duration of the steady time.
+ * Unlike RCLCPP_@(severity)_THROTTLE, the time of the next message is a static local of the
+ * statement, so a throttled call only reads the steady time and compares it, before the
+ * severity of the logger is checked and the message formatted.
+ * \param logger The `rclcpp::Logger` to use
+ * \param duration The duration of the throttle interval as an integral value in milliseconds.
+ * \param ... The format string, followed by the variable arguments for the format string.
+ */
+#define RCLCPP_@(severity)_THROTTLE_STEADY(logger, duration, ...) \
+  do { \
+    static_assert( \
+      ::std::is_same<typename std::remove_cv_t<typename std::remove_reference_t<decltype(logger)>>, \
+      typename ::rclcpp::Logger>::value, \
+      "First argument to logging macros must be an rclcpp::Logger"); \
+    static ::rclcpp::detail::SteadyThrottle rclcpp_steady_throttle_; \
+    if (rclcpp_steady_throttle_.elapsed(duration)) { \
+      RCUTILS_LOG_@(severity)_NAMED((logger).get_name(), __VA_ARGS__); \
+    } \
+  } while (0)
+
+/**
+ * \def RCLCPP_@(severity)_STREAM_THROTTLE_STEADY
+ * Log a message with severity @(severity) at most once per duration of the steady time.
+ * See RCLCPP_@(severity)_THROTTLE_STEADY, the stream is only formatted for the logged messages.
+ * \param logger The `rclcpp::Logger` to use
+ * \param duration The duration of the throttle interval as an integral value in milliseconds.
+ * \param stream_arg The argument << into a stringstream
+ */
+#define RCLCPP_@(severity)_STREAM_THROTTLE_STEADY(logger, duration, stream_arg) \
+  do { \
+    static_assert( \
+      ::std::is_same<typename std::remove_cv_t<typename std::remove_reference_t<decltype(logger)>>, \
+      typename ::rclcpp::Logger>::value, \
+      "First argument to logging macros must be an rclcpp::Logger"); \
+    static ::rclcpp::detail::SteadyThrottle rclcpp_steady_throttle_; \
+    if (rclcpp_steady_throttle_.elapsed(duration)) { \
+      RCLCPP_@(severity)_STREAM(logger, stream_arg); \
+    } \
+  } while (0)
+
 #endif
 ///@@}
 
@@ -0,0 +1,193 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/allocation_audit.hpp"
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "rclcpp/allocation_guard.hpp"
+
+using rclcpp::AllocationAudit;
+using rclcpp::AllocationAuditRecord;
+using rclcpp::AllocationSite;
+
+namespace
+{
+
+std::atomic_bool g_enabled{false};
+
+// Plain thread local variable, so that reading it never allocates
+thread_local AllocationAudit::Scope * g_current_scope = nullptr;
+
+using RecordKey = std::tuple<const void *, AllocationSite, std::thread::id>;
+
+struct Records
+{
+  std::mutex mutex;
+  std::map<RecordKey, AllocationAuditRecord> records;
+};
+
+Records &
+get_records_storage()
+{
+  static Records records;
+  return records;
+}
+
+const char *
+to_string(AllocationSite site)
+{
+  switch (site) {
+    case AllocationSite::Publish:
+      return "publish";
+    case AllocationSite::Timer:
+      return "timer";
+    case AllocationSite::Subscription:
+      return "subscription";
+    case AllocationSite::Service:
+      return "service";
+    case AllocationSite::Client:
+      return "client";
+    case AllocationSite::Waitable:
+      return "waitable";
+  }
+  return "unknown";
+}
+
+}  // namespace
+
+AllocationAudit::Scope::Scope(const void * entity, AllocationSite site) noexcept
+: entity_(entity), site_(site), parent_(g_current_scope), active_(false),
+  allocation_count_(0), allocated_bytes_(0)
+{
+  if (!entity_ || !g_enabled.load(std::memory_order_relaxed)) {
+    return;
+  }
+  if (parent_ && parent_->entity_ == entity_ && parent_->site_ == site_) {
+    return;
+  }
+  active_ = true;
+  g_current_scope = this;
+}
+
+AllocationAudit::Scope::~Scope()
+{
+  if (!active_) {
+    return;
+  }
+  g_current_scope = nullptr;
+  {
+    // Storing the first record of an entity allocates, which is neither audited nor checked
+    AllocationGuard allow(AllocationCheck::None);
+    Records & storage = get_records_storage();
+    const std::thread::id thread_id = std::this_thread::get_id();
+    std::lock_guard<std::mutex> lock(storage.mutex);
+    auto it = storage.records.find(RecordKey(entity_, site_, thread_id));
+    if (it == storage.records.end()) {
+      it = storage.records.emplace(
+        RecordKey(entity_, site_, thread_id),
+        AllocationAuditRecord{entity_, site_, thread_id, 0, 0, 0}).first;
+    }
+    it->second.execution_count++;
+    it->second.allocation_count += allocation_count_;
+    it->second.allocated_bytes += allocated_bytes_;
+  }
+  g_current_scope = parent_;
+}
+
+void
+AllocationAudit::enable()
+{
+  g_enabled.store(true);
+}
+
+void
+AllocationAudit::disable()
+{
+  g_enabled.store(false);
+}
+
+bool
+AllocationAudit::is_enabled() noexcept
+{
+  return g_enabled.load(std::memory_order_relaxed);
+}
+
+std::vector<AllocationAuditRecord>
+AllocationAudit::get_records()
+{
+  Records & storage = get_records_storage();
+  std::lock_guard<std::mutex> lock(storage.mutex);
+  std::vector<AllocationAuditRecord> records;
+  records.reserve(storage.records.size());
+  for (const auto & record : storage.records) {
+    records.push_back(record.second);
+  }
+  return records;
+}
+
+uint64_t
+AllocationAudit::get_allocation_count()
+{
+  Records & storage = get_records_storage();
+  std::lock_guard<std::mutex> lock(storage.mutex);
+  uint64_t count = 0;
+  for (const auto & record : storage.records) {
+    count += record.second.allocation_count;
+  }
+  return count;
+}
+
+void
+AllocationAudit::reset()
+{
+  Records & storage = get_records_storage();
+  std::lock_guard<std::mutex> lock(storage.mutex);
+  storage.records.clear();
+}
+
+void
+AllocationAudit::assert_no_allocations()
+{
+  std::ostringstream allocations;
+  for (const auto & record : get_records()) {
+    if (record.allocation_count == 0) {
+      continue;
+    }
+    allocations << "\n  " << to_string(record.site) << " of entity " << record.entity <<
+      " on thread " << record.thread_id << ": " << record.allocation_count <<
+      " allocations of " << record.allocated_bytes << " bytes in " <<
+      record.execution_count << " executions";
+  }
+  const std::string description = allocations.str();
+  if (!description.empty()) {
+    throw std::runtime_error("allocations in audited code paths:" + description);
+  }
+}
+
+void
+AllocationAudit::on_allocation(size_t size) noexcept
+{
+  if (g_current_scope) {
+    g_current_scope->on_allocation(size);
+  }
+}
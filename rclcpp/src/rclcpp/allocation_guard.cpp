@@ -0,0 +1,75 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/allocation_guard.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "rclcpp/allocation_audit.hpp"
+
+using rclcpp::AllocationAudit;
+using rclcpp::AllocationCheck;
+using rclcpp::AllocationGuard;
+
+namespace
+{
+
+// Plain thread local variables, so that reading them never allocates
+thread_local AllocationCheck current_check = AllocationCheck::None;
+thread_local size_t allocation_count = 0;
+
+}  // namespace
+
+AllocationGuard::AllocationGuard(AllocationCheck check)
+: previous_check_(current_check), initial_count_(allocation_count)
+{
+  current_check = check;
+}
+
+AllocationGuard::~AllocationGuard()
+{
+  current_check = previous_check_;
+}
+
+size_t
+AllocationGuard::get_allocation_count() const
+{
+  return allocation_count - initial_count_;
+}
+
+AllocationCheck
+AllocationGuard::get_current_check()
+{
+  return current_check;
+}
+
+void
+AllocationGuard::on_allocation(size_t size) noexcept
+{
+  AllocationAudit::on_allocation(size);
+  switch (current_check) {
+    case AllocationCheck::None:
+      return;
+    case AllocationCheck::Count:
+      ++allocation_count;
+      return;
+    case AllocationCheck::Abort:
+      // Printing may allocate as well
+      current_check = AllocationCheck::None;
+      std::fprintf(
+        stderr, "rclcpp: allocation of %zu bytes from a thread forbidding allocations\n", size);
+      std::abort();
+  }
+}
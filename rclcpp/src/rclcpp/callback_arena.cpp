@@ -0,0 +1,132 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/allocator/callback_arena.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+
+using rclcpp::allocator::CallbackArena;
+using rclcpp::allocator::CallbackArenaScope;
+
+namespace
+{
+
+thread_local std::unique_ptr<CallbackArena> g_thread_arena;
+thread_local CallbackArena * g_current_arena = nullptr;
+thread_local size_t g_scope_depth = 0;
+
+}  // namespace
+
+CallbackArena::CallbackArena(size_t initial_capacity)
+{
+  add_chunk(std::max<size_t>(initial_capacity, 1));
+}
+
+CallbackArena::~CallbackArena()
+{
+  if (g_current_arena == this) {
+    g_current_arena = nullptr;
+  }
+}
+
+void
+CallbackArena::add_chunk(size_t size)
+{
+  chunks_.push_back({std::unique_ptr<unsigned char[]>(new unsigned char[size]), size});
+  capacity_ += size;
+  chunk_offset_ = 0;
+}
+
+void *
+CallbackArena::allocate(size_t bytes, size_t alignment)
+{
+  if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+    throw std::bad_alloc();
+  }
+  for (;;) {
+    Chunk & chunk = chunks_.back();
+    const auto base = reinterpret_cast<std::uintptr_t>(chunk.memory.get());
+    const std::uintptr_t aligned =
+      (base + chunk_offset_ + alignment - 1) & ~static_cast<std::uintptr_t>(alignment - 1);
+    const size_t offset = static_cast<size_t>(aligned - base);
+    if (offset <= chunk.size && bytes <= chunk.size - offset) {
+      used_ += offset + bytes - chunk_offset_;
+      chunk_offset_ = offset + bytes;
+      return chunk.memory.get() + offset;
+    }
+    if (bytes > std::numeric_limits<size_t>::max() / 2 - alignment) {
+      throw std::bad_alloc();
+    }
+    // Growing geometrically keeps the number of chunks low until the next reset merges them
+    add_chunk(std::max(chunk.size * 2, bytes + alignment));
+  }
+}
+
+void
+CallbackArena::reset()
+{
+  if (chunks_.size() > 1) {
+    const size_t capacity = capacity_;
+    chunks_.clear();
+    capacity_ = 0;
+    add_chunk(capacity);
+  }
+  chunk_offset_ = 0;
+  used_ = 0;
+}
+
+size_t
+CallbackArena::get_capacity() const
+{
+  return capacity_;
+}
+
+size_t
+CallbackArena::get_used() const
+{
+  return used_;
+}
+
+CallbackArena *
+CallbackArena::get_current()
+{
+  return g_current_arena;
+}
+
+CallbackArenaScope::CallbackArenaScope(size_t capacity)
+{
+  if (g_scope_depth > 0) {
+    g_scope_depth++;
+    return;
+  }
+  if (!g_thread_arena || g_thread_arena->get_capacity() < capacity) {
+    // Nothing is allocated from the arena outside of a scope, it can be replaced
+    g_thread_arena = std::make_unique<CallbackArena>(capacity);
+  }
+  g_current_arena = g_thread_arena.get();
+  g_scope_depth = 1;
+}
+
+CallbackArenaScope::~CallbackArenaScope()
+{
+  if (--g_scope_depth > 0) {
+    return;
+  }
+  g_current_arena = nullptr;
+  g_thread_arena->reset();
+}
@@ -14,6 +14,7 @@
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <mutex>
@@ -34,6 +35,9 @@ CallbackGroup::CallbackGroup(
   bool automatically_add_to_executor_with_node)
 : type_(group_type), associated_with_executor_(false),
   can_be_taken_from_(true),
+  reservation_count_(0),
+  skip_count_(0),
+  priority_(0),
   automatically_add_to_executor_with_node_(automatically_add_to_executor_with_node)
 {}
 
@@ -48,12 +52,92 @@ CallbackGroup::can_be_taken_from()
   return can_be_taken_from_;
 }
 
+bool
+CallbackGroup::try_reserve()
+{
+  if (type_ == CallbackGroupType::MutuallyExclusive) {
+    bool expected = true;
+    if (!can_be_taken_from_.compare_exchange_strong(expected, false)) {
+      skip_count_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+  }
+  reservation_count_.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+void
+CallbackGroup::release()
+{
+  can_be_taken_from_.store(true);
+}
+
+void
+CallbackGroup::record_skip()
+{
+  skip_count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+CallbackGroup::ReservationStatistics
+CallbackGroup::get_reservation_statistics() const
+{
+  ReservationStatistics statistics;
+  statistics.reservation_count = reservation_count_.load(std::memory_order_relaxed);
+  statistics.skip_count = skip_count_.load(std::memory_order_relaxed);
+  return statistics;
+}
+
+void
+CallbackGroup::reset_reservation_statistics()
+{
+  reservation_count_.store(0, std::memory_order_relaxed);
+  skip_count_.store(0, std::memory_order_relaxed);
+}
+
 const CallbackGroupType &
 CallbackGroup::type() const
 {
   return type_;
 }
 
+void
+CallbackGroup::set_priority(int priority)
+{
+  priority_.store(priority);
+}
+
+int
+CallbackGroup::get_priority() const
+{
+  return priority_.load();
+}
+
+CallbackGroup::StarvationStatistics
+CallbackGroup::get_starvation_statistics() const
+{
+  std::lock_guard<std::mutex> lock(starvation_statistics_mutex_);
+  return starvation_statistics_;
+}
+
+void
+CallbackGroup::reset_starvation_statistics()
+{
+  std::lock_guard<std::mutex> lock(starvation_statistics_mutex_);
+  starvation_statistics_ = StarvationStatistics();
+}
+
+void
+CallbackGroup::record_dispatch(std::chrono::nanoseconds wait_time, bool starved)
+{
+  std::lock_guard<std::mutex> lock(starvation_statistics_mutex_);
+  starvation_statistics_.dispatch_count++;
+  if (starved) {
+    starvation_statistics_.starved_count++;
+  }
+  starvation_statistics_.total_wait_time += wait_time;
+  starvation_statistics_.max_wait_time = std::max(starvation_statistics_.max_wait_time, wait_time);
+}
+
 void CallbackGroup::collect_all_ptrs(
   std::function<void(const rclcpp::SubscriptionBase::SharedPtr &)> sub_func,
   std::function<void(const rclcpp::ServiceBase::SharedPtr &)> service_func,
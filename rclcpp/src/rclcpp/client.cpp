@@ -17,6 +17,7 @@
 #include <algorithm>
 #include <chrono>
 #include <cstdio>
+#include <functional>
 #include <memory>
 #include <string>
 
@@ -86,6 +87,13 @@ ClientBase::get_service_name() const
   return rcl_client_get_service_name(this->get_client_handle().get());
 }
 
+bool
+ClientBase::time_out_pending_request(int64_t request_id)
+{
+  (void) request_id;
+  return false;
+}
+
 std::shared_ptr<rcl_client_t>
 ClientBase::get_client_handle()
 {
@@ -136,7 +144,6 @@ ClientBase::wait_for_service_nanoseconds(std::chrono::nanoseconds timeout)
     // check was non-blocking, return immediately
     return false;
   }
-  auto event = node_ptr->get_graph_event();
   // update the time even on the first loop to account for time spent in the first call
   // to this->server_is_ready()
   std::chrono::nanoseconds time_to_wait =
@@ -148,6 +155,10 @@ ClientBase::wait_for_service_nanoseconds(std::chrono::nanoseconds timeout)
     // Setting time_to_wait to 0 will allow one non-blocking wait because of the do-while.
     time_to_wait = std::chrono::nanoseconds(0);
   }
+  // The waiters of the same service share the readiness checks done after the graph changes
+  const std::function<bool()> is_ready = [this]() {
+      return this->service_is_ready();
+    };
   do {
     if (!rclcpp::ok(this->context_)) {
       return false;
@@ -159,12 +170,13 @@ ClientBase::wait_for_service_nanoseconds(std::chrono::nanoseconds timeout)
     // If no other graph events occur, the wait set will not be triggered again until the timeout
     // has been reached, despite the service being available, so we artificially limit the wait
     // time to limit the delay.
-    node_ptr->wait_for_graph_change(
-      event, std::min(time_to_wait, std::chrono::nanoseconds(RCL_MS_TO_NS(100))));
-    // Because of the aforementioned race condition, we check if the service is ready even if the
-    // graph event wasn't triggered.
-    event->check_and_clear();
-    if (this->service_is_ready()) {
+    // Because of the aforementioned race condition, the service is checked again on each call
+    // even if no graph change occurred.
+    if (
+      node_ptr->wait_for_service_ready(
+        this->get_service_name(), is_ready,
+        std::min(time_to_wait, std::chrono::nanoseconds(RCL_MS_TO_NS(100)))))
+    {
       return true;
     }
     // server is not ready, loop if there is time left
@@ -14,9 +14,16 @@
 
 #include "rclcpp/clock.hpp"
 
+#include <atomic>
 #include <condition_variable>
+#include <iterator>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <thread>
+#include <utility>
+
+#include "rcl/error_handling.h"
 
 #include "rclcpp/exceptions.hpp"
 #include "rclcpp/utilities.hpp"
@@ -47,11 +54,171 @@ public:
     }
   }
 
+  // Read the rcl clock again, after setting it to the last shared time,
+  // the sleeping threads are woken as if the time source changed unless it keeps setting the clock
+  void stop_using_shared_ros_time(bool time_source_changed)
+  {
+    SharedRosTime * shared_ros_time = shared_ros_time_.load();
+    if (!shared_ros_time) {
+      return;
+    }
+    shared_ros_time_.store(nullptr);
+    shared_ros_time->cancel_waiters(this, time_source_changed);
+    // The time source sets the time it shares next in the rcl clock as well,
+    // so the rcl clock is set again until it didn't miss a concurrently shared time
+    // The time source sets the rcl clock with clock_mutex_ locked, which is taken after
+    // shared_ros_time_mutex_, never before
+    std::lock_guard<std::mutex> clock_guard(clock_mutex_);
+    rcl_time_point_value_t nanoseconds = shared_ros_time->get();
+    for (;;) {
+      rcl_ret_t ret = rcl_set_ros_time_override(&rcl_clock_, nanoseconds);
+      if (ret != RCL_RET_OK) {
+        RCUTILS_LOG_ERROR("Failed to set ros_time_override_status");
+        rcl_reset_error();
+      }
+      const rcl_time_point_value_t last_nanoseconds = shared_ros_time->get();
+      if (last_nanoseconds == nanoseconds) {
+        break;
+      }
+      nanoseconds = last_nanoseconds;
+    }
+  }
+
+  // Stop reading the shared time for good, since the rcl clock is used elsewhere
+  void use_rcl_clock()
+  {
+    std::lock_guard<std::mutex> guard(shared_ros_time_mutex_);
+    stop_using_shared_ros_time(false);
+    rcl_clock_used_.store(true, std::memory_order_release);
+  }
+
   rcl_clock_t rcl_clock_;
   rcl_allocator_t allocator_;
   std::mutex clock_mutex_;
+
+  // Protects changing the shared time read by now(), not the rcl clock
+  std::mutex shared_ros_time_mutex_;
+  // Shared time read instead of the rcl clock, if any
+  std::atomic<SharedRosTime *> shared_ros_time_{nullptr};
+  // Owner of the only shared time ever read, which concurrent now() calls may still read
+  SharedRosTime::SharedPtr shared_ros_time_owner_;
+  // Whether the rcl clock was used elsewhere, and so is always set
+  std::atomic<bool> rcl_clock_used_{false};
 };
 
+struct SharedRosTime::Waiter
+{
+  Waiter(
+    rcl_time_point_value_t deadline,
+    const void * owner,
+    std::mutex & mutex,
+    std::condition_variable & cv)
+  : deadline(deadline), owner(owner), mutex(mutex), cv(cv)
+  {}
+
+  const rcl_time_point_value_t deadline;
+  // Clock::Impl of the sleeping clock
+  const void * const owner;
+  std::mutex & mutex;
+  std::condition_variable & cv;
+  // Protected by mutex
+  bool woken = false;
+  bool cancelled = false;
+  bool time_source_changed = false;
+  // Protected by SharedRosTime::waiters_mutex_
+  bool queued = false;
+  WaiterQueue::iterator position;
+};
+
+SharedRosTime::SharedRosTime(rcl_time_point_value_t nanoseconds)
+: nanoseconds_(nanoseconds),
+  next_deadline_(std::numeric_limits<rcl_time_point_value_t>::max())
+{}
+
+void
+SharedRosTime::set(rcl_time_point_value_t nanoseconds) noexcept
+{
+  nanoseconds_.store(nanoseconds);
+  // Nothing is locked unless a deadline is reached
+  if (nanoseconds >= next_deadline_.load()) {
+    wake_waiters(nanoseconds);
+  }
+}
+
+void
+SharedRosTime::add_waiter(Waiter & waiter)
+{
+  std::lock_guard<std::mutex> guard(waiters_mutex_);
+  waiter.position = waiters_.emplace(waiter.deadline, &waiter);
+  waiter.queued = true;
+  next_deadline_.store(waiters_.begin()->first);
+  // A time stored concurrently either sees the new deadline, or is seen here
+  if (nanoseconds_.load() >= waiter.deadline) {
+    wake_waiter(waiter.position, false, false);
+  }
+}
+
+void
+SharedRosTime::remove_waiter(Waiter & waiter)
+{
+  std::lock_guard<std::mutex> guard(waiters_mutex_);
+  if (waiter.queued) {
+    waiters_.erase(waiter.position);
+    waiter.queued = false;
+    next_deadline_.store(
+      waiters_.empty() ?
+      std::numeric_limits<rcl_time_point_value_t>::max() : waiters_.begin()->first);
+  }
+}
+
+void
+SharedRosTime::cancel_waiters(const void * owner, bool time_source_changed)
+{
+  std::lock_guard<std::mutex> guard(waiters_mutex_);
+  for (auto it = waiters_.begin(); it != waiters_.end(); ) {
+    auto next_it = std::next(it);
+    if (it->second->owner == owner) {
+      wake_waiter(it, true, time_source_changed);
+    }
+    it = next_it;
+  }
+}
+
+void
+SharedRosTime::wake_waiters(rcl_time_point_value_t nanoseconds)
+{
+  std::lock_guard<std::mutex> guard(waiters_mutex_);
+  while (!waiters_.empty() && waiters_.begin()->first <= nanoseconds) {
+    wake_waiter(waiters_.begin(), false, false);
+  }
+}
+
+void
+SharedRosTime::wake_waiter(
+  WaiterQueue::iterator it, bool cancelled, bool time_source_changed)
+{
+  Waiter * waiter = it->second;
+  waiters_.erase(it);
+  waiter->queued = false;
+  next_deadline_.store(
+    waiters_.empty() ?
+    std::numeric_limits<rcl_time_point_value_t>::max() : waiters_.begin()->first);
+  {
+    std::lock_guard<std::mutex> guard(waiter->mutex);
+    waiter->woken = true;
+    waiter->cancelled = cancelled;
+    waiter->time_source_changed = time_source_changed;
+  }
+  // The waiter is removed with waiters_mutex_ locked, it's still valid
+  waiter->cv.notify_all();
+}
+
+rcl_time_point_value_t
+SharedRosTime::get() const noexcept
+{
+  return nanoseconds_.load();
+}
+
 JumpHandler::JumpHandler(
   pre_callback_t pre_callback,
   post_callback_t post_callback,
@@ -69,14 +236,35 @@ Clock::~Clock() {}
 Time
 Clock::now() const
 {
-  Time now(0, 0, impl_->rcl_clock_.type);
+  return Time(now_nanoseconds(), impl_->rcl_clock_.type);
+}
 
-  auto ret = rcl_clock_get_now(&impl_->rcl_clock_, &now.rcl_time_.nanoseconds);
+rcl_time_point_value_t
+Clock::now_nanoseconds() const
+{
+  rcl_time_point_value_t nanoseconds = 0;
+  // The rcl steady and system clocks read the same rcutils times
+  if (impl_->rcl_clock_.type == RCL_STEADY_TIME) {
+    if (rcutils_steady_time_now(&nanoseconds) == RCUTILS_RET_OK) {
+      return nanoseconds;
+    }
+  } else if (impl_->rcl_clock_.type == RCL_SYSTEM_TIME) {
+    if (rcutils_system_time_now(&nanoseconds) == RCUTILS_RET_OK) {
+      return nanoseconds;
+    }
+  } else {
+    const SharedRosTime * shared_ros_time = impl_->shared_ros_time_.load();
+    if (shared_ros_time) {
+      return shared_ros_time->get();
+    }
+  }
+
+  auto ret = rcl_clock_get_now(&impl_->rcl_clock_, &nanoseconds);
   if (ret != RCL_RET_OK) {
     exceptions::throw_from_rcl_error(ret, "could not get current time stamp");
   }
 
-  return now;
+  return nanoseconds;
 }
 
 bool
@@ -92,10 +280,12 @@ Clock::sleep_until(Time until, Context::SharedPtr context)
   bool time_source_changed = false;
 
   std::condition_variable cv;
+  std::mutex wait_mutex;
 
   // Wake this thread if the context is shutdown
   rclcpp::OnShutdownCallbackHandle shutdown_cb_handle = context->add_on_shutdown_callback(
-    [&cv]() {
+    [&cv, &wait_mutex]() {
+      std::lock_guard<std::mutex> lock(wait_mutex);
       cv.notify_one();
     });
   // No longer need the shutdown callback when this function exits
@@ -129,42 +319,64 @@ Clock::sleep_until(Time until, Context::SharedPtr context)
       cv.wait_until(lock, system_time);
     }
   } else if (this_clock_type == RCL_ROS_TIME) {
-    // Install jump handler for any amount of time change, for two purposes:
-    // - if ROS time is active, check if time reached on each new clock sample
-    // - Trigger via on_clock_change to detect if time source changes, to invalidate sleep
-    rcl_jump_threshold_t threshold;
-    threshold.on_clock_change = true;
-    // 0 is disable, so -1 and 1 are smallest possible time changes
-    threshold.min_backward.nanoseconds = -1;
-    threshold.min_forward.nanoseconds = 1;
-    auto clock_handler = create_jump_callback(
-      nullptr,
-      [&cv, &time_source_changed](const rcl_time_jump_t & jump) {
-        if (jump.clock_change != RCL_ROS_TIME_NO_CHANGE) {
-          time_source_changed = true;
+    bool waited_shared_ros_time = false;
+    SharedRosTime * shared_ros_time = impl_->shared_ros_time_.load();
+    if (shared_ros_time && ros_time_is_active()) {
+      // Wait in the queue of the shared time, woken only once the time source shares a time
+      // reaching until, or when the clock stops reading the shared time
+      SharedRosTime::Waiter waiter(until.nanoseconds(), impl_.get(), wait_mutex, cv);
+      shared_ros_time->add_waiter(waiter);
+      bool cancelled = false;
+      {
+        std::unique_lock lock(wait_mutex);
+        while (!waiter.woken && context->is_valid()) {
+          cv.wait(lock);
         }
-        cv.notify_one();
-      },
-      threshold);
-
-    if (!ros_time_is_active()) {
-      auto system_time = std::chrono::system_clock::time_point(
-        // Cast because system clock resolution is too big for nanoseconds on some systems
-        std::chrono::duration_cast<std::chrono::system_clock::duration>(
-          std::chrono::nanoseconds(until.nanoseconds())));
-
-      // loop over spurious wakeups but notice shutdown or time source change
-      std::unique_lock lock(impl_->clock_mutex_);
-      while (now() < until && context->is_valid() && !time_source_changed) {
-        cv.wait_until(lock, system_time);
+        cancelled = waiter.cancelled;
+        time_source_changed = waiter.time_source_changed;
       }
-    } else {
-      // RCL_ROS_TIME with ros_time_is_active.
-      // Just wait without "until" because installed
-      // jump callbacks wake the cv on every new sample.
-      std::unique_lock lock(impl_->clock_mutex_);
-      while (now() < until && context->is_valid() && !time_source_changed) {
-        cv.wait(lock);
+      shared_ros_time->remove_waiter(waiter);
+      // Otherwise the rcl clock is used, still set by the time source, and followed from now on
+      waited_shared_ros_time = !cancelled || time_source_changed;
+    }
+    if (!waited_shared_ros_time && context->is_valid()) {
+      // Install jump handler for any amount of time change, for two purposes:
+      // - if ROS time is active, check if time reached on each new clock sample
+      // - Trigger via on_clock_change to detect if time source changes, to invalidate sleep
+      rcl_jump_threshold_t threshold;
+      threshold.on_clock_change = true;
+      // 0 is disable, so -1 and 1 are smallest possible time changes
+      threshold.min_backward.nanoseconds = -1;
+      threshold.min_forward.nanoseconds = 1;
+      auto clock_handler = create_jump_callback(
+        nullptr,
+        [&cv, &time_source_changed](const rcl_time_jump_t & jump) {
+          if (jump.clock_change != RCL_ROS_TIME_NO_CHANGE) {
+            time_source_changed = true;
+          }
+          cv.notify_one();
+        },
+        threshold);
+
+      if (!ros_time_is_active()) {
+        auto system_time = std::chrono::system_clock::time_point(
+          // Cast because system clock resolution is too big for nanoseconds on some systems
+          std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            std::chrono::nanoseconds(until.nanoseconds())));
+
+        // loop over spurious wakeups but notice shutdown or time source change
+        std::unique_lock lock(impl_->clock_mutex_);
+        while (now() < until && context->is_valid() && !time_source_changed) {
+          cv.wait_until(lock, system_time);
+        }
+      } else {
+        // RCL_ROS_TIME with ros_time_is_active.
+        // Just wait without "until" because installed
+        // jump callbacks wake the cv on every new sample.
+        std::unique_lock lock(impl_->clock_mutex_);
+        while (now() < until && context->is_valid() && !time_source_changed) {
+          cv.wait(lock);
+        }
       }
     }
   }
@@ -185,10 +397,14 @@ Clock::sleep_for(Duration rel_time, Context::SharedPtr context)
 bool
 Clock::started()
 {
-  if (!rcl_clock_valid(get_clock_handle())) {
+  if (!rcl_clock_valid(&impl_->rcl_clock_)) {
     throw std::runtime_error("clock is not rcl_clock_valid");
   }
-  return rcl_clock_time_started(get_clock_handle());
+  const SharedRosTime * shared_ros_time = impl_->shared_ros_time_.load();
+  if (shared_ros_time) {
+    return shared_ros_time->get() > 0;
+  }
+  return rcl_clock_time_started(&impl_->rcl_clock_);
 }
 
 bool
@@ -197,7 +413,7 @@ Clock::wait_until_started(Context::SharedPtr context)
   if (!context || !context->is_valid()) {
     throw std::runtime_error("context cannot be slept with because it's invalid");
   }
-  if (!rcl_clock_valid(get_clock_handle())) {
+  if (!rcl_clock_valid(&impl_->rcl_clock_)) {
     throw std::runtime_error("clock cannot be waited on as it is not rcl_clock_valid");
   }
 
@@ -218,7 +434,7 @@ Clock::wait_until_started(
   if (!context || !context->is_valid()) {
     throw std::runtime_error("context cannot be slept with because it's invalid");
   }
-  if (!rcl_clock_valid(get_clock_handle())) {
+  if (!rcl_clock_valid(&impl_->rcl_clock_)) {
     throw std::runtime_error("clock cannot be waited on as it is not rcl_clock_valid");
   }
 
@@ -267,9 +483,43 @@ Clock::ros_time_is_active()
 rcl_clock_t *
 Clock::get_clock_handle() noexcept
 {
+  if (!impl_->rcl_clock_used_.load(std::memory_order_acquire)) {
+    impl_->use_rcl_clock();
+  }
   return &impl_->rcl_clock_;
 }
 
+rcl_clock_t *
+Clock::get_time_source_clock_handle() noexcept
+{
+  return &impl_->rcl_clock_;
+}
+
+void
+Clock::set_shared_ros_time(SharedRosTime::SharedPtr shared_ros_time)
+{
+  std::lock_guard<std::mutex> guard(impl_->shared_ros_time_mutex_);
+  if (!shared_ros_time) {
+    impl_->stop_using_shared_ros_time(true);
+    return;
+  }
+  if (
+    impl_->rcl_clock_.type != RCL_ROS_TIME ||
+    impl_->rcl_clock_used_.load(std::memory_order_relaxed) ||
+    (impl_->shared_ros_time_owner_ && impl_->shared_ros_time_owner_ != shared_ros_time))
+  {
+    return;
+  }
+  impl_->shared_ros_time_owner_ = std::move(shared_ros_time);
+  impl_->shared_ros_time_.store(impl_->shared_ros_time_owner_.get());
+}
+
+bool
+Clock::is_using_shared_ros_time() const noexcept
+{
+  return impl_->shared_ros_time_.load() != nullptr;
+}
+
 rcl_clock_type_t
 Clock::get_clock_type() const noexcept
 {
@@ -311,6 +561,11 @@ Clock::create_jump_callback(
     throw std::bad_alloc{};
   }
 
+  // The jump callbacks are called by the rcl clock, which has to be set from now on
+  if (!impl_->rcl_clock_used_.load(std::memory_order_acquire)) {
+    impl_->use_rcl_clock();
+  }
+
   {
     std::lock_guard<std::mutex> clock_guard(impl_->clock_mutex_);
     // Try to add the jump callback to the clock
@@ -0,0 +1,1005 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/content_filter.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/lazy_deserialized_message.hpp"
+
+#include "rcutils/error_handling.h"
+
+#include "rosidl_runtime_cpp/message_initialization.hpp"
+#include "rosidl_typesupport_introspection_cpp/field_types.hpp"
+#include "rosidl_typesupport_introspection_cpp/identifier.hpp"
+#include "rosidl_typesupport_introspection_cpp/message_introspection.hpp"
+
+using rclcpp::ContentFilter;
+using rosidl_typesupport_introspection_cpp::MessageMember;
+using rosidl_typesupport_introspection_cpp::MessageMembers;
+
+namespace
+{
+
+namespace ts = rosidl_typesupport_introspection_cpp;
+
+enum class TokenType
+{
+  Field,
+  Integer,
+  Real,
+  String,
+  Boolean,
+  Parameter,
+  Comparison,
+  And,
+  Or,
+  Not,
+  Like,
+  Between,
+  OpenParenthesis,
+  CloseParenthesis,
+  End,
+};
+
+enum class Comparison
+{
+  Equal,
+  NotEqual,
+  Less,
+  LessEqual,
+  Greater,
+  GreaterEqual,
+};
+
+struct Token
+{
+  TokenType type = TokenType::End;
+  std::string text;
+  Comparison comparison = Comparison::Equal;
+};
+
+bool
+is_identifier_start(char c)
+{
+  return std::isalpha(static_cast<unsigned char>(c)) || c == '_';
+}
+
+bool
+is_identifier_character(char c)
+{
+  return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+bool
+is_digit(char c)
+{
+  return std::isdigit(static_cast<unsigned char>(c)) != 0;
+}
+
+std::string
+to_upper(std::string text)
+{
+  std::transform(
+    text.begin(), text.end(), text.begin(),
+    [](char c) {return static_cast<char>(std::toupper(static_cast<unsigned char>(c)));});
+  return text;
+}
+
+[[noreturn]] void
+throw_syntax_error(size_t position, const std::string & reason)
+{
+  throw std::invalid_argument(reason + " at position " + std::to_string(position));
+}
+
+/// Split a filter expression, or the literal of an expression parameter, into tokens.
+std::vector<Token>
+tokenize(const std::string & text)
+{
+  std::vector<Token> tokens;
+  size_t i = 0;
+  while (i < text.size()) {
+    const char c = text[i];
+    if (std::isspace(static_cast<unsigned char>(c))) {
+      ++i;
+      continue;
+    }
+    const size_t start = i;
+    Token token;
+    if (is_identifier_start(c)) {
+      // Either a keyword or the path of a field, e.g. points[0].x
+      bool is_path = false;
+      while (i < text.size()) {
+        if (is_identifier_character(text[i])) {
+          ++i;
+        } else if (text[i] == '.' && i + 1 < text.size() && is_identifier_start(text[i + 1])) {
+          is_path = true;
+          ++i;
+        } else if (text[i] == '[') {
+          const size_t end = text.find(']', i);
+          if (end == std::string::npos || end == i + 1 ||
+            text.find_first_not_of("0123456789", i + 1) != end)
+          {
+            throw_syntax_error(i, "invalid array index");
+          }
+          is_path = true;
+          i = end + 1;
+        } else {
+          break;
+        }
+      }
+      token.text = text.substr(start, i - start);
+      const std::string keyword = is_path ? std::string() : to_upper(token.text);
+      if (keyword == "AND") {
+        token.type = TokenType::And;
+      } else if (keyword == "OR") {
+        token.type = TokenType::Or;
+      } else if (keyword == "NOT") {
+        token.type = TokenType::Not;
+      } else if (keyword == "LIKE") {
+        token.type = TokenType::Like;
+      } else if (keyword == "BETWEEN") {
+        token.type = TokenType::Between;
+      } else if (keyword == "TRUE" || keyword == "FALSE") {
+        token.type = TokenType::Boolean;
+        token.text = keyword;
+      } else {
+        token.type = TokenType::Field;
+      }
+    } else if (is_digit(c) || ((c == '-' || c == '+' || c == '.') && i + 1 < text.size() &&
+      (is_digit(text[i + 1]) || text[i + 1] == '.')))
+    {
+      const char * begin = text.c_str() + i;
+      char * end = nullptr;
+      static_cast<void>(std::strtod(begin, &end));
+      const size_t length = static_cast<size_t>(end - begin);
+      if (length == 0u || (i + length < text.size() && is_identifier_character(text[i + length]))) {
+        throw_syntax_error(i, "invalid number");
+      }
+      token.text = text.substr(i, length);
+      token.type = token.text.find_first_of(".eE") == std::string::npos ?
+        TokenType::Integer : TokenType::Real;
+      i += length;
+    } else if (c == '\'') {
+      const size_t end = text.find('\'', i + 1);
+      if (end == std::string::npos) {
+        throw_syntax_error(i, "unterminated string");
+      }
+      token.type = TokenType::String;
+      token.text = text.substr(i + 1, end - i - 1);
+      i = end + 1;
+    } else if (c == '%') {
+      ++i;
+      while (i < text.size() && is_digit(text[i])) {
+        ++i;
+      }
+      if (i == start + 1) {
+        throw_syntax_error(start, "invalid parameter");
+      }
+      token.type = TokenType::Parameter;
+      token.text = text.substr(start, i - start);
+    } else if (c == '(' || c == ')') {
+      token.type = c == '(' ? TokenType::OpenParenthesis : TokenType::CloseParenthesis;
+      token.text = std::string(1, c);
+      ++i;
+    } else {
+      static const std::pair<const char *, Comparison> comparisons[] = {
+        {"<=", Comparison::LessEqual},
+        {">=", Comparison::GreaterEqual},
+        {"<>", Comparison::NotEqual},
+        {"!=", Comparison::NotEqual},
+        {"<", Comparison::Less},
+        {">", Comparison::Greater},
+        {"=", Comparison::Equal},
+      };
+      for (const auto & comparison : comparisons) {
+        const size_t length = std::strlen(comparison.first);
+        if (text.compare(i, length, comparison.first) == 0) {
+          token.type = TokenType::Comparison;
+          token.text = comparison.first;
+          token.comparison = comparison.second;
+          i += length;
+          break;
+        }
+      }
+      if (token.type != TokenType::Comparison) {
+        throw_syntax_error(i, std::string("unexpected character '") + c + "'");
+      }
+    }
+    tokens.push_back(std::move(token));
+  }
+  tokens.emplace_back();
+  return tokens;
+}
+
+/// Kind of the values compared, values of different kinds can't be compared.
+enum class ValueKind
+{
+  Number,
+  String,
+};
+
+/// Value of a field or of a literal.
+struct Value
+{
+  ValueKind kind = ValueKind::Number;
+  // Integers are compared exactly, the other numbers as reals
+  bool is_integer = true;
+  int64_t integer = 0;
+  double real = 0.0;
+  const std::string * string = nullptr;
+};
+
+void
+set_integer(Value & value, int64_t integer)
+{
+  value.kind = ValueKind::Number;
+  value.is_integer = true;
+  value.integer = integer;
+}
+
+void
+set_real(Value & value, double real)
+{
+  value.kind = ValueKind::Number;
+  value.is_integer = false;
+  value.real = real;
+}
+
+/// Return true if values of the given member type can be compared, and the kind of the values.
+bool
+get_value_kind(uint8_t type_id, ValueKind & kind)
+{
+  switch (type_id) {
+    case ts::ROS_TYPE_STRING:
+      kind = ValueKind::String;
+      return true;
+    case ts::ROS_TYPE_BOOLEAN:
+    case ts::ROS_TYPE_CHAR:
+    case ts::ROS_TYPE_OCTET:
+    case ts::ROS_TYPE_UINT8:
+    case ts::ROS_TYPE_INT8:
+    case ts::ROS_TYPE_UINT16:
+    case ts::ROS_TYPE_INT16:
+    case ts::ROS_TYPE_UINT32:
+    case ts::ROS_TYPE_INT32:
+    case ts::ROS_TYPE_UINT64:
+    case ts::ROS_TYPE_INT64:
+    case ts::ROS_TYPE_FLOAT:
+    case ts::ROS_TYPE_DOUBLE:
+    case ts::ROS_TYPE_LONG_DOUBLE:
+      kind = ValueKind::Number;
+      return true;
+    default:
+      // Wide strings and characters, and messages
+      return false;
+  }
+}
+
+/// Read a value of the given member type.
+void
+read_value(uint8_t type_id, const void * data, Value & value)
+{
+  switch (type_id) {
+    case ts::ROS_TYPE_STRING:
+      value.kind = ValueKind::String;
+      value.string = static_cast<const std::string *>(data);
+      break;
+    case ts::ROS_TYPE_BOOLEAN:
+      set_integer(value, *static_cast<const bool *>(data) ? 1 : 0);
+      break;
+    case ts::ROS_TYPE_CHAR:
+    case ts::ROS_TYPE_OCTET:
+    case ts::ROS_TYPE_UINT8:
+      set_integer(value, *static_cast<const uint8_t *>(data));
+      break;
+    case ts::ROS_TYPE_INT8:
+      set_integer(value, *static_cast<const int8_t *>(data));
+      break;
+    case ts::ROS_TYPE_UINT16:
+      set_integer(value, *static_cast<const uint16_t *>(data));
+      break;
+    case ts::ROS_TYPE_INT16:
+      set_integer(value, *static_cast<const int16_t *>(data));
+      break;
+    case ts::ROS_TYPE_UINT32:
+      set_integer(value, *static_cast<const uint32_t *>(data));
+      break;
+    case ts::ROS_TYPE_INT32:
+      set_integer(value, *static_cast<const int32_t *>(data));
+      break;
+    case ts::ROS_TYPE_UINT64:
+      {
+        const uint64_t integer = *static_cast<const uint64_t *>(data);
+        if (integer <= static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+          set_integer(value, static_cast<int64_t>(integer));
+        } else {
+          set_real(value, static_cast<double>(integer));
+        }
+        break;
+      }
+    case ts::ROS_TYPE_INT64:
+      set_integer(value, *static_cast<const int64_t *>(data));
+      break;
+    case ts::ROS_TYPE_FLOAT:
+      set_real(value, *static_cast<const float *>(data));
+      break;
+    case ts::ROS_TYPE_DOUBLE:
+      set_real(value, *static_cast<const double *>(data));
+      break;
+    case ts::ROS_TYPE_LONG_DOUBLE:
+      set_real(value, static_cast<double>(*static_cast<const long double *>(data)));
+      break;
+    default:
+      break;
+  }
+}
+
+struct FieldStep
+{
+  const MessageMember * member = nullptr;
+  bool has_index = false;
+  size_t index = 0u;
+};
+
+/// Members to walk from the message to a field.
+struct FieldPath
+{
+  std::vector<FieldStep> steps;
+  ValueKind kind = ValueKind::Number;
+};
+
+/// Read a field of a message, return false if an index is beyond the size of a sequence.
+bool
+read_field(const FieldPath & path, const void * message, Value & value)
+{
+  const uint8_t * data = static_cast<const uint8_t *>(message);
+  for (size_t i = 0u; i < path.steps.size(); ++i) {
+    const FieldStep & step = path.steps[i];
+    const MessageMember & member = *step.member;
+    const void * element = data + member.offset_;
+    if (step.has_index) {
+      if (step.index >= member.size_function(element)) {
+        return false;
+      }
+      if (member.type_id_ == ts::ROS_TYPE_BOOLEAN) {
+        // std::vector<bool> doesn't give access to its elements
+        bool boolean = false;
+        member.fetch_function(element, step.index, &boolean);
+        set_integer(value, boolean ? 1 : 0);
+        return true;
+      }
+      element = member.get_const_function(element, step.index);
+    }
+    if (i + 1u < path.steps.size()) {
+      data = static_cast<const uint8_t *>(element);
+    } else {
+      read_value(member.type_id_, element, value);
+    }
+  }
+  return true;
+}
+
+int
+compare_numbers(const Value & lhs, const Value & rhs)
+{
+  if (lhs.is_integer && rhs.is_integer) {
+    return lhs.integer < rhs.integer ? -1 : (lhs.integer > rhs.integer ? 1 : 0);
+  }
+  const double left = lhs.is_integer ? static_cast<double>(lhs.integer) : lhs.real;
+  const double right = rhs.is_integer ? static_cast<double>(rhs.integer) : rhs.real;
+  return left < right ? -1 : (left > right ? 1 : 0);
+}
+
+bool
+compare(const Value & lhs, Comparison comparison, const Value & rhs)
+{
+  if (lhs.kind == ValueKind::Number &&
+    ((!lhs.is_integer && std::isnan(lhs.real)) || (!rhs.is_integer && std::isnan(rhs.real))))
+  {
+    return comparison == Comparison::NotEqual;
+  }
+  const int order = lhs.kind == ValueKind::String ?
+    lhs.string->compare(*rhs.string) : compare_numbers(lhs, rhs);
+  switch (comparison) {
+    case Comparison::Equal:
+      return order == 0;
+    case Comparison::NotEqual:
+      return order != 0;
+    case Comparison::Less:
+      return order < 0;
+    case Comparison::LessEqual:
+      return order <= 0;
+    case Comparison::Greater:
+      return order > 0;
+    case Comparison::GreaterEqual:
+      return order >= 0;
+  }
+  return false;
+}
+
+/// Return true if the text matches a LIKE pattern, '%' matching any characters, '_' one.
+bool
+matches_pattern(const std::string & text, const std::string & pattern)
+{
+  size_t t = 0u;
+  size_t p = 0u;
+  // Position after the last '%' of the pattern, and of the text it was matched to
+  size_t wildcard_p = std::string::npos;
+  size_t wildcard_t = 0u;
+  while (t < text.size()) {
+    if (p < pattern.size() && (pattern[p] == '_' || pattern[p] == text[t])) {
+      ++t;
+      ++p;
+    } else if (p < pattern.size() && pattern[p] == '%') {
+      wildcard_p = ++p;
+      wildcard_t = t;
+    } else if (wildcard_p != std::string::npos) {
+      // The last '%' matches one more character
+      p = wildcard_p;
+      t = ++wildcard_t;
+    } else {
+      return false;
+    }
+  }
+  while (p < pattern.size() && pattern[p] == '%') {
+    ++p;
+  }
+  return p == pattern.size();
+}
+
+/// Field or literal of a condition.
+struct Operand
+{
+  bool is_field = false;
+  FieldPath field;
+  Value literal;
+  std::string literal_string;
+};
+
+bool
+get_value(const Operand & operand, const void * message, Value & value)
+{
+  if (operand.is_field) {
+    return read_field(operand.field, message, value);
+  }
+  value = operand.literal;
+  value.string = &operand.literal_string;
+  return true;
+}
+
+enum class NodeType
+{
+  And,
+  Or,
+  Not,
+  Comparison,
+  Like,
+  Between,
+};
+
+/// Node of the compiled expression.
+struct Node
+{
+  NodeType type = NodeType::Comparison;
+  Comparison comparison = Comparison::Equal;
+  // For NOT LIKE and NOT BETWEEN
+  bool negated = false;
+  std::unique_ptr<Node> left;
+  std::unique_ptr<Node> right;
+  // The compared operands, the field and the pattern, or the field and the range
+  std::vector<Operand> operands;
+};
+
+bool
+evaluate(const Node & node, const void * message)
+{
+  switch (node.type) {
+    case NodeType::And:
+      return evaluate(*node.left, message) && evaluate(*node.right, message);
+    case NodeType::Or:
+      return evaluate(*node.left, message) || evaluate(*node.right, message);
+    case NodeType::Not:
+      return !evaluate(*node.left, message);
+    case NodeType::Comparison:
+      {
+        Value lhs;
+        Value rhs;
+        return get_value(node.operands[0], message, lhs) &&
+               get_value(node.operands[1], message, rhs) &&
+               compare(lhs, node.comparison, rhs);
+      }
+    case NodeType::Like:
+      {
+        Value value;
+        if (!get_value(node.operands[0], message, value)) {
+          return false;
+        }
+        return matches_pattern(*value.string, node.operands[1].literal_string) != node.negated;
+      }
+    case NodeType::Between:
+      {
+        Value value;
+        Value low;
+        Value high;
+        if (!get_value(node.operands[0], message, value) ||
+          !get_value(node.operands[1], message, low) ||
+          !get_value(node.operands[2], message, high))
+        {
+          return false;
+        }
+        const bool inside =
+          compare(value, Comparison::GreaterEqual, low) &&
+          compare(value, Comparison::LessEqual, high);
+        return inside != node.negated;
+      }
+  }
+  return false;
+}
+
+/// Compiler of a filter expression, against the members of the messages.
+class Parser
+{
+public:
+  Parser(const rclcpp::ContentFilterOptions & options, const MessageMembers & members)
+  : options_(options), members_(members)
+  {
+    try {
+      tokens_ = tokenize(options_.filter_expression);
+    } catch (const std::invalid_argument & exception) {
+      fail(exception.what());
+    }
+  }
+
+  std::unique_ptr<Node>
+  parse()
+  {
+    auto node = parse_or();
+    if (peek().type != TokenType::End) {
+      fail("unexpected '" + peek().text + "'");
+    }
+    return node;
+  }
+
+  /// Return the offsets of the top-level members the expression refers to.
+  const std::vector<size_t> &
+  get_top_level_offsets() const
+  {
+    return top_level_offsets_;
+  }
+
+private:
+  [[noreturn]] void
+  fail(const std::string & reason) const
+  {
+    throw std::invalid_argument(
+            "invalid content filter expression '" + options_.filter_expression + "': " + reason);
+  }
+
+  const Token &
+  peek() const
+  {
+    return tokens_[position_];
+  }
+
+  const Token &
+  next()
+  {
+    const Token & token = tokens_[position_];
+    if (token.type != TokenType::End) {
+      ++position_;
+    }
+    return token;
+  }
+
+  bool
+  accept(TokenType type)
+  {
+    if (peek().type != type) {
+      return false;
+    }
+    next();
+    return true;
+  }
+
+  static std::unique_ptr<Node>
+  make_node(NodeType type, std::unique_ptr<Node> left, std::unique_ptr<Node> right = nullptr)
+  {
+    auto node = std::make_unique<Node>();
+    node->type = type;
+    node->left = std::move(left);
+    node->right = std::move(right);
+    return node;
+  }
+
+  std::unique_ptr<Node>
+  parse_or()
+  {
+    auto node = parse_and();
+    while (accept(TokenType::Or)) {
+      node = make_node(NodeType::Or, std::move(node), parse_and());
+    }
+    return node;
+  }
+
+  std::unique_ptr<Node>
+  parse_and()
+  {
+    auto node = parse_not();
+    while (accept(TokenType::And)) {
+      node = make_node(NodeType::And, std::move(node), parse_not());
+    }
+    return node;
+  }
+
+  std::unique_ptr<Node>
+  parse_not()
+  {
+    if (accept(TokenType::Not)) {
+      return make_node(NodeType::Not, parse_not());
+    }
+    if (accept(TokenType::OpenParenthesis)) {
+      auto node = parse_or();
+      if (!accept(TokenType::CloseParenthesis)) {
+        fail("missing ')'");
+      }
+      return node;
+    }
+    return parse_predicate();
+  }
+
+  std::unique_ptr<Node>
+  parse_predicate()
+  {
+    auto node = std::make_unique<Node>();
+    node->operands.reserve(3u);
+    node->operands.push_back(parse_operand());
+    const Operand & lhs = node->operands[0];
+    if (peek().type == TokenType::Comparison) {
+      node->type = NodeType::Comparison;
+      node->comparison = next().comparison;
+      node->operands.push_back(parse_operand());
+      check_comparable(lhs, node->operands[1]);
+      if (!lhs.is_field && !node->operands[1].is_field) {
+        fail("a comparison needs a field");
+      }
+      return node;
+    }
+    node->negated = accept(TokenType::Not);
+    if (accept(TokenType::Like)) {
+      node->type = NodeType::Like;
+      node->operands.push_back(parse_operand());
+      const Operand & pattern = node->operands[1];
+      if (!lhs.is_field || lhs.field.kind != ValueKind::String || pattern.is_field ||
+        pattern.literal.kind != ValueKind::String)
+      {
+        fail("LIKE compares a string field with a string pattern");
+      }
+      return node;
+    }
+    if (accept(TokenType::Between)) {
+      node->type = NodeType::Between;
+      node->operands.push_back(parse_operand());
+      if (!accept(TokenType::And)) {
+        fail("missing AND after the lower bound of BETWEEN");
+      }
+      node->operands.push_back(parse_operand());
+      if (!lhs.is_field) {
+        fail("BETWEEN needs a field");
+      }
+      check_comparable(lhs, node->operands[1]);
+      check_comparable(lhs, node->operands[2]);
+      return node;
+    }
+    fail("expected a comparison instead of '" + peek().text + "'");
+  }
+
+  Operand
+  parse_operand()
+  {
+    const Token & token = next();
+    switch (token.type) {
+      case TokenType::Field:
+        {
+          Operand operand;
+          operand.is_field = true;
+          operand.field = resolve_field(token.text);
+          return operand;
+        }
+      case TokenType::Integer:
+      case TokenType::Real:
+      case TokenType::String:
+      case TokenType::Boolean:
+        return make_literal(token);
+      case TokenType::Parameter:
+        return parse_parameter(token.text);
+      default:
+        fail(
+          "expected a field, a literal or a parameter instead of '" +
+          (token.type == TokenType::End ? std::string("end") : token.text) + "'");
+    }
+  }
+
+  Operand
+  parse_parameter(const std::string & name)
+  {
+    const size_t index = std::strtoul(name.c_str() + 1, nullptr, 10);
+    if (index >= options_.expression_parameters.size()) {
+      fail("missing expression parameter " + name);
+    }
+    const std::string & parameter = options_.expression_parameters[index];
+    std::vector<Token> tokens;
+    try {
+      tokens = tokenize(parameter);
+    } catch (const std::invalid_argument & exception) {
+      fail("invalid expression parameter " + name + ": " + exception.what());
+    }
+    if (tokens.size() != 2u ||
+      (tokens[0].type != TokenType::Integer && tokens[0].type != TokenType::Real &&
+      tokens[0].type != TokenType::String && tokens[0].type != TokenType::Boolean))
+    {
+      fail(
+        "expression parameter " + name + " isn't a literal, strings are quoted: '" +
+        parameter + "'");
+    }
+    return make_literal(tokens[0]);
+  }
+
+  Operand
+  make_literal(const Token & token) const
+  {
+    Operand operand;
+    switch (token.type) {
+      case TokenType::String:
+        operand.literal.kind = ValueKind::String;
+        operand.literal_string = token.text;
+        break;
+      case TokenType::Boolean:
+        set_integer(operand.literal, token.text == "TRUE" ? 1 : 0);
+        break;
+      case TokenType::Integer:
+        {
+          errno = 0;
+          char * end = nullptr;
+          const long long integer = std::strtoll(token.text.c_str(), &end, 10);  // NOLINT
+          if (*end != '\0') {
+            fail("invalid integer '" + token.text + "'");
+          }
+          if (errno != ERANGE) {
+            set_integer(operand.literal, integer);
+            break;
+          }
+          // Beyond the range of the integers, e.g. a large uint64 value
+          set_real(operand.literal, std::strtod(token.text.c_str(), nullptr));
+          break;
+        }
+      default:
+        set_real(operand.literal, std::strtod(token.text.c_str(), nullptr));
+        break;
+    }
+    return operand;
+  }
+
+  FieldPath
+  resolve_field(const std::string & name)
+  {
+    FieldPath path;
+    const MessageMembers * members = &members_;
+    size_t position = 0u;
+    for (;;) {
+      const size_t end = name.find_first_of(".[", position);
+      const std::string member_name = name.substr(position, end - position);
+      const MessageMember * member = nullptr;
+      for (uint32_t i = 0u; i < members->member_count_; ++i) {
+        if (member_name == members->members_[i].name_) {
+          member = &members->members_[i];
+          break;
+        }
+      }
+      if (member == nullptr) {
+        fail("unknown field '" + name + "'");
+      }
+      FieldStep step;
+      step.member = member;
+      size_t next = end;
+      if (next != std::string::npos && name[next] == '[') {
+        if (!member->is_array_) {
+          fail("field '" + name + "' indexes a member which isn't an array");
+        }
+        const size_t close = name.find(']', next);
+        step.has_index = true;
+        step.index = std::strtoull(name.c_str() + next + 1, nullptr, 10);
+        if (member->array_size_ > 0u && !member->is_upper_bound_ &&
+          step.index >= member->array_size_)
+        {
+          fail("field '" + name + "' indexes beyond the size of the array");
+        }
+        next = close + 1u;
+      } else if (member->is_array_) {
+        fail("field '" + name + "' is an array, an element must be indexed");
+      }
+      path.steps.push_back(step);
+
+      if (next >= name.size()) {
+        if (!get_value_kind(member->type_id_, path.kind)) {
+          fail("field '" + name + "' isn't a number nor a string");
+        }
+        const size_t offset = path.steps.front().member->offset_;
+        if (std::find(top_level_offsets_.begin(), top_level_offsets_.end(), offset) ==
+          top_level_offsets_.end())
+        {
+          top_level_offsets_.push_back(offset);
+        }
+        return path;
+      }
+      if (name[next] != '.' || member->type_id_ != ts::ROS_TYPE_MESSAGE ||
+        member->members_ == nullptr || member->members_->data == nullptr)
+      {
+        fail("field '" + name + "' refers to a member of a field which isn't a message");
+      }
+      members = static_cast<const MessageMembers *>(member->members_->data);
+      position = next + 1u;
+    }
+  }
+
+  void
+  check_comparable(const Operand & lhs, const Operand & rhs) const
+  {
+    const ValueKind lhs_kind = lhs.is_field ? lhs.field.kind : lhs.literal.kind;
+    const ValueKind rhs_kind = rhs.is_field ? rhs.field.kind : rhs.literal.kind;
+    if (lhs_kind != rhs_kind) {
+      fail("a string can only be compared with a string");
+    }
+  }
+
+  const rclcpp::ContentFilterOptions & options_;
+  const MessageMembers & members_;
+  std::vector<Token> tokens_;
+  size_t position_ = 0u;
+  std::vector<size_t> top_level_offsets_;
+};
+
+/// Decoder of the top-level members of a serialized message, which it doesn't own.
+class SerializedMemberDecoder : public rclcpp::LazyDeserializedMessageBase
+{
+public:
+  SerializedMemberDecoder(
+    const rclcpp::SerializedMessage & serialized_message,
+    const rosidl_message_type_support_t * type_support)
+  : LazyDeserializedMessageBase(
+      std::shared_ptr<const rclcpp::SerializedMessage>(
+        std::shared_ptr<void>(), &serialized_message),
+      type_support)
+  {}
+
+  /// Decode the given members, or the whole message if one can't be decoded alone.
+  void
+  decode(const std::vector<size_t> & member_offsets, void * message)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const size_t member_offset : member_offsets) {
+      if (!decode_member(member_offset, message)) {
+        deserialize(message);
+        return;
+      }
+    }
+  }
+};
+
+}  // namespace
+
+class ContentFilter::Impl
+{
+public:
+  Impl(
+    const rclcpp::ContentFilterOptions & options,
+    const rosidl_message_type_support_t * type_support)
+  : options_(options)
+  {
+    if (!type_support) {
+      throw std::invalid_argument("type support cannot be nullptr");
+    }
+    if (options_.filter_expression.empty()) {
+      throw std::invalid_argument("the filter expression cannot be empty");
+    }
+    type_support_ = *type_support;
+    const rosidl_message_type_support_t * introspection_type_support =
+      get_message_typesupport_handle(type_support, ts::typesupport_identifier);
+    if (!introspection_type_support || !introspection_type_support->data) {
+      rcutils_reset_error();
+      throw std::invalid_argument(
+              "the content filter needs the introspection type support of the messages");
+    }
+    members_ = static_cast<const MessageMembers *>(introspection_type_support->data);
+
+    Parser parser(options_, *members_);
+    root_ = parser.parse();
+    top_level_offsets_ = parser.get_top_level_offsets();
+  }
+
+  ~Impl()
+  {
+    if (decoded_message_) {
+      members_->fini_function(decoded_message_);
+      ::operator delete(decoded_message_);
+    }
+  }
+
+  /// Return the message in which the serialized messages are decoded, with mutex_ locked.
+  void *
+  get_decoded_message()
+  {
+    if (!decoded_message_) {
+      void * message = ::operator new(members_->size_of_);
+      members_->init_function(message, rosidl_runtime_cpp::MessageInitialization::ALL);
+      decoded_message_ = message;
+    }
+    return decoded_message_;
+  }
+
+  const rclcpp::ContentFilterOptions options_;
+  rosidl_message_type_support_t type_support_;
+  const MessageMembers * members_ = nullptr;
+  std::unique_ptr<Node> root_;
+  std::vector<size_t> top_level_offsets_;
+
+  std::mutex mutex_;
+  // Reused for the members of the serialized messages
+  void * decoded_message_ = nullptr;
+};
+
+ContentFilter::ContentFilter(
+  const rclcpp::ContentFilterOptions & options,
+  const rosidl_message_type_support_t * type_support)
+: impl_(std::make_unique<Impl>(options, type_support))
+{}
+
+ContentFilter::~ContentFilter()
+{}
+
+bool
+ContentFilter::matches(const void * message) const
+{
+  return evaluate(*impl_->root_, message);
+}
+
+bool
+ContentFilter::matches(const rclcpp::SerializedMessage & message) const
+{
+  std::lock_guard<std::mutex> lock(impl_->mutex_);
+  void * decoded_message = impl_->get_decoded_message();
+  SerializedMemberDecoder decoder(message, &impl_->type_support_);
+  decoder.decode(impl_->top_level_offsets_, decoded_message);
+  return evaluate(*impl_->root_, decoded_message);
+}
+
+const rclcpp::ContentFilterOptions &
+ContentFilter::get_options() const
+{
+  return impl_->options_;
+}
@@ -25,13 +25,16 @@
 #include "rcl/init.h"
 #include "rcl/logging.h"
 
+#include "rclcpp/detail/async_logging_backend.hpp"
 #include "rclcpp/detail/utilities.hpp"
 #include "rclcpp/exceptions.hpp"
+#include "rclcpp/experimental/intra_process_manager.hpp"
 #include "rclcpp/logging.hpp"
 
 #include "rcutils/error_handling.h"
 #include "rcutils/macros.h"
 
+#include "./detail/shared_node_publishers.hpp"
 #include "./logging_mutex.hpp"
 
 using rclcpp::Context;
@@ -120,6 +123,24 @@ get_logging_reference_count()
 
 extern "C"
 {
+/// Write a log message to the rcl output handlers and to /rosout, with the logging mutex held.
+static
+void
+rclcpp_write_log(
+  const rcutils_log_location_t * location,
+  int severity, const char * name, rcutils_time_point_value_t timestamp,
+  const char * format, va_list * args)
+{
+  va_list args_copy;
+  va_copy(args_copy, *args);
+  rcl_logging_multiple_output_handler(
+    location, severity, name, timestamp, format, args);
+  // The loggers of the nodes using the shared publishers of their context
+  rclcpp::detail::SharedNodePublishers::publish_log(
+    location, severity, name, timestamp, format, &args_copy);
+  va_end(args_copy);
+}
+
 static
 void
 rclcpp_logging_output_handler(
@@ -128,11 +149,16 @@ rclcpp_logging_output_handler(
   const char * format, va_list * args)
 {
   try {
+    // Buffered without the logging mutex, if the asynchronous logging is enabled
+    if (rclcpp::detail::get_global_async_logging_backend().enqueue(
+        location, severity, name, timestamp, format, args))
+    {
+      return;
+    }
     std::shared_ptr<std::recursive_mutex> logging_mutex;
     logging_mutex = get_global_logging_mutex();
     std::lock_guard<std::recursive_mutex> guard(*logging_mutex);
-    return rcl_logging_multiple_output_handler(
-      location, severity, name, timestamp, format, args);
+    rclcpp_write_log(location, severity, name, timestamp, format, args);
   } catch (std::exception & ex) {
     RCUTILS_SAFE_FWRITE_TO_STDERR(ex.what());
     RCUTILS_SAFE_FWRITE_TO_STDERR("\n");
@@ -225,6 +251,8 @@ Context::init(
         rcl_context_.reset();
         rclcpp::exceptions::throw_from_rcl_error(ret, "failed to configure logging");
       }
+      rclcpp::detail::get_global_async_logging_backend().start(
+        init_options.async_logging, rclcpp_write_log);
     } else {
       RCLCPP_WARN(
         rclcpp::get_logger("rclcpp"),
@@ -334,6 +362,28 @@ Context::shutdown(const std::string & reason)
 
   // interrupt all blocking sleep_for() and all blocking executors or wait sets
   this->interrupt_all_sleep_for();
+  if (init_options_.fast_teardown) {
+    // release the intra-process entities in bulk, they are destroyed one by one afterwards
+    std::shared_ptr<void> intra_process_manager;
+    {
+      std::lock_guard<std::recursive_mutex> lock(sub_contexts_mutex_);
+      auto it = sub_contexts_.find(typeid(rclcpp::experimental::IntraProcessManager));
+      if (it != sub_contexts_.end()) {
+        intra_process_manager = it->second;
+      }
+    }
+    if (intra_process_manager) {
+      std::static_pointer_cast<rclcpp::experimental::IntraProcessManager>(
+        intra_process_manager)->clear();
+    }
+  }
+  // the queued jobs are run by the worker pool before it is destroyed
+  rclcpp::DeserializationThreadPool::SharedPtr worker_pool;
+  {
+    std::lock_guard<std::mutex> lock(worker_pool_mutex_);
+    worker_pool = std::move(worker_pool_);
+  }
+  worker_pool.reset();
   // remove self from the global contexts
   weak_contexts_->remove_context(this);
   // shutdown logger
@@ -342,6 +392,8 @@ Context::shutdown(const std::string & reason)
     std::lock_guard<std::recursive_mutex> guard(*logging_mutex_);
     size_t & count = get_logging_reference_count();
     if (0u == --count) {
+      // The buffered log messages are written before the output handlers are finalized
+      rclcpp::detail::get_global_async_logging_backend().stop();
       rcl_ret_t rcl_ret = rcl_logging_fini();
       if (RCL_RET_OK != rcl_ret) {
         RCUTILS_SAFE_FWRITE_TO_STDERR(
@@ -500,6 +552,18 @@ Context::interrupt_all_sleep_for()
   interrupt_condition_variable_.notify_all();
 }
 
+rclcpp::DeserializationThreadPool::SharedPtr
+Context::get_worker_pool()
+{
+  std::lock_guard<std::mutex> lock(worker_pool_mutex_);
+  if (!worker_pool_ && this->is_valid()) {
+    const rclcpp::WorkerPoolOptions & options = init_options_.worker_pool;
+    worker_pool_ = std::make_shared<rclcpp::DeserializationThreadPool>(
+      options.number_of_threads, options.thread_attributes);
+  }
+  return worker_pool_;
+}
+
 void
 Context::clean_up()
 {
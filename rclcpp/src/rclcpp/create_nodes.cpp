@@ -0,0 +1,131 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/create_nodes.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/deserialization_thread_pool.hpp"
+
+#include "./detail/node_startup_profile.hpp"
+
+using rclcpp::NodeStartupProfile;
+
+namespace
+{
+
+thread_local NodeStartupProfile * g_thread_profile = nullptr;
+
+void
+add_profile(NodeStartupProfile & total, const NodeStartupProfile & profile)
+{
+  total.number_of_nodes += profile.number_of_nodes;
+  total.construction += profile.construction;
+  total.node_base += profile.node_base;
+  total.graph += profile.graph;
+  total.parameters += profile.parameters;
+  total.time_source += profile.time_source;
+}
+
+}  // namespace
+
+NodeStartupProfile *&
+rclcpp::detail::get_thread_node_startup_profile()
+{
+  return g_thread_profile;
+}
+
+std::vector<rclcpp::Node::SharedPtr>
+rclcpp::create_nodes(
+  const std::vector<NodeCreationRequest> & requests,
+  size_t number_of_threads,
+  NodeStartupProfile * profile)
+{
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<rclcpp::Node::SharedPtr> nodes(requests.size());
+  std::mutex mutex;
+  std::exception_ptr error;
+  NodeStartupProfile total;
+
+  if (0 == number_of_threads) {
+    number_of_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  number_of_threads = std::min(number_of_threads, requests.size());
+  if (number_of_threads > 0) {
+    // The pool runs all the queued jobs before it is destroyed
+    rclcpp::DeserializationThreadPool thread_pool(number_of_threads);
+    for (size_t i = 0; i < requests.size(); ++i) {
+      thread_pool.post(
+        [&, i]() {
+          NodeStartupProfile node_profile;
+          node_profile.number_of_nodes = 1;
+          g_thread_profile = profile ? &node_profile : nullptr;
+          rclcpp::Node::SharedPtr node;
+          std::exception_ptr node_error;
+          {
+            rclcpp::detail::NodeStartupPhaseTimer timer(&NodeStartupProfile::construction);
+            try {
+              node = std::make_shared<rclcpp::Node>(
+                requests[i].node_name, requests[i].namespace_, requests[i].options);
+            } catch (...) {
+              node_error = std::current_exception();
+            }
+          }
+          g_thread_profile = nullptr;
+          std::lock_guard<std::mutex> lock(mutex);
+          if (node_error) {
+            if (!error) {
+              error = node_error;
+            }
+            return;
+          }
+          nodes[i] = std::move(node);
+          add_profile(total, node_profile);
+        });
+    }
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+  if (profile) {
+    total.wall_time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - start);
+    *profile = total;
+  }
+  return nodes;
+}
+
+std::string
+rclcpp::to_string(const NodeStartupProfile & profile)
+{
+  auto to_ms = [](std::chrono::nanoseconds duration) {
+      return std::chrono::duration<double, std::milli>(duration).count();
+    };
+  std::ostringstream stream;
+  stream << "nodes: " << profile.number_of_nodes << "\n" <<
+    "wall time: " << to_ms(profile.wall_time) << " ms\n" <<
+    "construction: " << to_ms(profile.construction) << " ms\n" <<
+    "  node base: " << to_ms(profile.node_base) << " ms\n" <<
+    "  graph: " << to_ms(profile.graph) << " ms\n" <<
+    "  parameters: " << to_ms(profile.parameters) << " ms\n" <<
+    "  time source: " << to_ms(profile.time_source) << " ms\n";
+  return stream.str();
+}
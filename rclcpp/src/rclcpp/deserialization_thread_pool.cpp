@@ -0,0 +1,118 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "rclcpp/deserialization_thread_pool.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include "rclcpp/logging.hpp"
+
+#include "rmw/impl/cpp/demangle.hpp"
+
+using rclcpp::DeserializationThreadPool;
+
+DeserializationThreadPool::DeserializationThreadPool(size_t number_of_threads)
+: DeserializationThreadPool(number_of_threads, {})
+{}
+
+DeserializationThreadPool::DeserializationThreadPool(
+  size_t number_of_threads,
+  const std::vector<ThreadAttributes> & thread_attributes)
+{
+  if (number_of_threads == 0) {
+    number_of_threads = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+  threads_.reserve(number_of_threads);
+  try {
+    for (size_t i = 0; i < number_of_threads; ++i) {
+      threads_.emplace_back(
+        i < thread_attributes.size() ? thread_attributes[i] : ThreadAttributes(),
+        [this]() {run();});
+    }
+  } catch (...) {
+    // The threads started already must be joined before they are destroyed
+    stop();
+    throw;
+  }
+}
+
+DeserializationThreadPool::~DeserializationThreadPool()
+{
+  stop();
+}
+
+void
+DeserializationThreadPool::post(std::function<void()> job)
+{
+  if (!job) {
+    throw std::invalid_argument("job must be callable");
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    jobs_.push_back(std::move(job));
+  }
+  condition_.notify_one();
+}
+
+size_t
+DeserializationThreadPool::get_number_of_threads() const
+{
+  return threads_.size();
+}
+
+void
+DeserializationThreadPool::stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  condition_.notify_all();
+  for (auto & thread : threads_) {
+    thread.join();
+  }
+}
+
+void
+DeserializationThreadPool::run()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;) {
+    condition_.wait(lock, [this]() {return stopping_ || !jobs_.empty();});
+    if (jobs_.empty()) {
+      // Stopping once all the queued jobs are done
+      return;
+    }
+    auto job = std::move(jobs_.front());
+    jobs_.pop_front();
+    lock.unlock();
+    try {
+      job();
+    } catch (const std::exception & exception) {
+      RCLCPP_ERROR(
+        rclcpp::get_logger("rclcpp"),
+        "caught %s exception in a deserialization job: %s",
+        rmw::impl::cpp::demangle(exception).c_str(), exception.what());
+    } catch (...) {
+      RCLCPP_ERROR(
+        rclcpp::get_logger("rclcpp"), "caught unknown exception in a deserialization job");
+    }
+    lock.lock();
+  }
+}
@@ -0,0 +1,482 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/detail/async_logging_backend.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "rcutils/error_handling.h"
+
+#include "../logging_mutex.hpp"
+
+using rclcpp::detail::AsyncLoggingBackend;
+
+namespace
+{
+
+struct LogRecord
+{
+  rcutils_log_location_t location;
+  bool has_location;
+  int severity;
+  rcutils_time_point_value_t timestamp;
+  char name[AsyncLoggingBackend::max_name_size];
+  char message[AsyncLoggingBackend::max_message_size];
+};
+
+/// Copy a null terminated string, return false if it was truncated to fit.
+bool
+copy_string(char * destination, size_t size, const char * source)
+{
+  size_t length = source ? std::strlen(source) : 0u;
+  const bool fits = length < size;
+  if (!fits) {
+    length = size - 1u;
+  }
+  if (length > 0u) {
+    std::memcpy(destination, source, length);
+  }
+  destination[length] = '\0';
+  return fits;
+}
+
+void
+write_record(
+  rcutils_logging_output_handler_t output_handler, const LogRecord & record,
+  const char * format, ...)
+{
+  va_list args;
+  va_start(args, format);
+  try {
+    output_handler(
+      record.has_location ? &record.location : nullptr, record.severity, record.name,
+      record.timestamp, format, &args);
+  } catch (const std::exception & ex) {
+    RCUTILS_SAFE_FWRITE_TO_STDERR(ex.what());
+    RCUTILS_SAFE_FWRITE_TO_STDERR("\n");
+  } catch (...) {
+    RCUTILS_SAFE_FWRITE_TO_STDERR("failed to write a buffered log message\n");
+  }
+  va_end(args);
+}
+
+/// Increment a counter only written by one thread, without a read-modify-write.
+void
+increment(std::atomic<uint64_t> & counter)
+{
+  counter.store(counter.load(std::memory_order_relaxed) + 1u, std::memory_order_relaxed);
+}
+
+std::atomic<uint64_t> g_next_backend_id{1u};
+
+}  // namespace
+
+/// Ring of the log records of a thread, which it enqueues into and the backend thread writes.
+class AsyncLoggingBackend::ThreadBuffer
+{
+public:
+  explicit ThreadBuffer(size_t depth)
+  : depth_(depth),
+    records_(new LogRecord[depth])
+  {}
+
+  /// Return the record to fill before push(), nullptr if the ring is full, producer only.
+  LogRecord *
+  tail_record()
+  {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) == depth_) {
+      return nullptr;
+    }
+    return &records_[tail % depth_];
+  }
+
+  /// Publish the record returned by tail_record(), return the number of records buffered.
+  size_t
+  push()
+  {
+    const size_t tail = tail_.load(std::memory_order_relaxed) + 1u;
+    tail_.store(tail, std::memory_order_release);
+    return tail - head_.load(std::memory_order_relaxed);
+  }
+
+  /// Index of the oldest record, consumer only.
+  size_t
+  head() const
+  {
+    return head_.load(std::memory_order_relaxed);
+  }
+
+  /// Index after the newest record published.
+  size_t
+  tail() const
+  {
+    return tail_.load(std::memory_order_acquire);
+  }
+
+  const LogRecord &
+  record(size_t index) const
+  {
+    return records_[index % depth_];
+  }
+
+  /// Release the oldest record, consumer only.
+  void
+  pop()
+  {
+    head_.store(head_.load(std::memory_order_relaxed) + 1u, std::memory_order_release);
+  }
+
+  // Written by the producer only
+  std::atomic<uint64_t> enqueued_count{0u};
+  std::atomic<uint64_t> dropped_count{0u};
+  std::atomic<uint64_t> truncated_count{0u};
+
+  // Dropped records already reported, written by the consumer with the buffers mutex held
+  uint64_t reported_dropped_count = 0u;
+
+private:
+  const size_t depth_;
+  std::unique_ptr<LogRecord[]> records_;
+  // On their own cache lines, so the producer and the consumer don't invalidate each other's
+  alignas(64) std::atomic<size_t> head_{0u};
+  alignas(64) std::atomic<size_t> tail_{0u};
+};
+
+AsyncLoggingBackend::AsyncLoggingBackend(std::shared_ptr<std::recursive_mutex> logging_mutex)
+: logging_mutex_(std::move(logging_mutex))
+{
+  if (!logging_mutex_) {
+    throw std::invalid_argument("the logging mutex of the asynchronous logging must not be null");
+  }
+}
+
+AsyncLoggingBackend::~AsyncLoggingBackend()
+{
+  stop();
+}
+
+void
+AsyncLoggingBackend::start(
+  const rclcpp::AsyncLoggingOptions & options,
+  rcutils_logging_output_handler_t output_handler)
+{
+  stop();
+  if (0u == options.depth) {
+    return;
+  }
+  if (!output_handler) {
+    throw std::invalid_argument(
+            "the output handler of the asynchronous logging must not be null");
+  }
+  options_ = options;
+  output_handler_ = output_handler;
+  id_ = g_next_backend_id++;
+  {
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+    stopping_.store(false);
+    thread_ = std::thread(&AsyncLoggingBackend::run, this);
+    thread_id_ = thread_.get_id();
+  }
+  started_.store(true);
+}
+
+void
+AsyncLoggingBackend::stop()
+{
+  if (!started_.exchange(false)) {
+    return;
+  }
+  // The enqueue calls which saw the backend started are about to push their record
+  while (0u != producer_count_.load()) {
+    std::this_thread::yield();
+  }
+  {
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+    stopping_.store(true);
+  }
+  wake_condition_.notify_all();
+  flushed_condition_.notify_all();
+  thread_.join();
+
+  // The backend thread is joined, so the calling thread is the consumer of the buffers now
+  {
+    std::lock_guard<std::recursive_mutex> guard(*logging_mutex_);
+    write_buffered();
+  }
+  {
+    std::lock_guard<std::mutex> lock(buffers_mutex_);
+    for (const auto & buffer : buffers_) {
+      retired_statistics_.enqueued_count += buffer->enqueued_count.load();
+      retired_statistics_.dropped_count += buffer->dropped_count.load();
+      retired_statistics_.truncated_count += buffer->truncated_count.load();
+    }
+    buffers_.clear();
+  }
+  std::lock_guard<std::mutex> lock(wake_mutex_);
+  flushed_ = flush_requested_;
+  thread_id_ = std::thread::id();
+}
+
+bool
+AsyncLoggingBackend::is_started() const
+{
+  return started_.load();
+}
+
+bool
+AsyncLoggingBackend::enqueue(
+  const rcutils_log_location_t * location,
+  int severity, const char * name, rcutils_time_point_value_t timestamp,
+  const char * format, va_list * args)
+{
+  if (severity >= RCUTILS_LOG_SEVERITY_FATAL) {
+    return false;
+  }
+  struct ProducerGuard
+  {
+    explicit ProducerGuard(std::atomic<size_t> & count)
+    : count_(count)
+    {
+      count_.fetch_add(1u);
+    }
+
+    ~ProducerGuard()
+    {
+      count_.fetch_sub(1u);
+    }
+
+    std::atomic<size_t> & count_;
+  } producer_guard(producer_count_);
+  // Checked once counted, so either stop() waits for this call or the call sees it stopped
+  if (!started_.load()) {
+    return false;
+  }
+
+  ThreadBuffer & buffer = get_thread_buffer();
+  LogRecord * record = buffer.tail_record();
+  if (!record) {
+    increment(buffer.dropped_count);
+    return true;
+  }
+  record->has_location = nullptr != location;
+  if (location) {
+    record->location = *location;
+  }
+  record->severity = severity;
+  record->timestamp = timestamp;
+  bool fits = copy_string(record->name, max_name_size, name);
+  va_list args_copy;
+  va_copy(args_copy, *args);
+  const int length = std::vsnprintf(record->message, max_message_size, format, args_copy);
+  va_end(args_copy);
+  if (length < 0) {
+    // Invalid format, the format itself is written
+    fits = copy_string(record->message, max_message_size, format) && fits;
+  } else if (static_cast<size_t>(length) >= max_message_size) {
+    fits = false;
+  }
+  if (!fits) {
+    increment(buffer.truncated_count);
+  }
+  increment(buffer.enqueued_count);
+  // Woken up early once half full, without the wake mutex, else after the flush period
+  if (buffer.push() == (options_.depth + 1u) / 2u) {
+    wake_condition_.notify_one();
+  }
+  return true;
+}
+
+void
+AsyncLoggingBackend::flush()
+{
+  std::unique_lock<std::mutex> lock(wake_mutex_);
+  if (stopping_.load() || std::thread::id() == thread_id_ ||
+    std::this_thread::get_id() == thread_id_)
+  {
+    return;
+  }
+  const uint64_t requested = ++flush_requested_;
+  wake_condition_.notify_one();
+  flushed_condition_.wait(
+    lock, [this, requested]() {
+      return stopping_.load() || flushed_ >= requested;
+    });
+}
+
+rclcpp::AsyncLoggingStatistics
+AsyncLoggingBackend::get_statistics() const
+{
+  rclcpp::AsyncLoggingStatistics statistics;
+  {
+    std::lock_guard<std::mutex> lock(buffers_mutex_);
+    statistics = retired_statistics_;
+    for (const auto & buffer : buffers_) {
+      statistics.enqueued_count += buffer->enqueued_count.load(std::memory_order_relaxed);
+      statistics.dropped_count += buffer->dropped_count.load(std::memory_order_relaxed);
+      statistics.truncated_count += buffer->truncated_count.load(std::memory_order_relaxed);
+    }
+  }
+  statistics.written_count = written_count_.load();
+  return statistics;
+}
+
+AsyncLoggingBackend::ThreadBuffer &
+AsyncLoggingBackend::get_thread_buffer()
+{
+  // A thread logging with several backends in turn gets a new buffer at each switch
+  thread_local uint64_t backend_id = 0u;
+  thread_local std::shared_ptr<ThreadBuffer> buffer;
+  if (backend_id != id_) {
+    auto new_buffer = std::make_shared<ThreadBuffer>(options_.depth);
+    {
+      std::lock_guard<std::mutex> lock(buffers_mutex_);
+      buffers_.push_back(new_buffer);
+    }
+    buffer = std::move(new_buffer);
+    backend_id = id_;
+  }
+  return *buffer;
+}
+
+void
+AsyncLoggingBackend::run()
+{
+  std::unique_lock<std::mutex> lock(wake_mutex_);
+  while (!stopping_.load()) {
+    if (flush_requested_ == flushed_) {
+      wake_condition_.wait_for(lock, options_.flush_period);
+      if (stopping_.load()) {
+        break;
+      }
+    }
+    const uint64_t requested = flush_requested_;
+    lock.unlock();
+    const bool written = try_write_buffered();
+    lock.lock();
+    if (written && flushed_ != requested) {
+      flushed_ = requested;
+      flushed_condition_.notify_all();
+    }
+  }
+}
+
+bool
+AsyncLoggingBackend::try_write_buffered()
+{
+  std::unique_lock<std::recursive_mutex> guard(*logging_mutex_, std::try_to_lock);
+  while (!guard.owns_lock()) {
+    // stop() may be waiting for this thread with the logging mutex held
+    if (stopping_.load()) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+    guard.try_lock();
+  }
+  write_buffered();
+  return true;
+}
+
+void
+AsyncLoggingBackend::write_buffered()
+{
+  // Kept alive while written, even if their thread exits meanwhile
+  using PendingBuffer = std::pair<std::shared_ptr<ThreadBuffer>, size_t>;
+  std::vector<PendingBuffer> pending;
+  uint64_t dropped_count = 0u;
+  {
+    std::lock_guard<std::mutex> lock(buffers_mutex_);
+    for (auto it = buffers_.begin(); it != buffers_.end(); ) {
+      ThreadBuffer & buffer = **it;
+      const uint64_t dropped = buffer.dropped_count.load(std::memory_order_relaxed);
+      dropped_count += dropped - buffer.reported_dropped_count;
+      buffer.reported_dropped_count = dropped;
+      const size_t tail = buffer.tail();
+      if (buffer.head() != tail) {
+        pending.emplace_back(*it, tail);
+      } else if (1 == it->use_count()) {
+        // Its thread exited and it was written
+        retired_statistics_.enqueued_count += buffer.enqueued_count.load();
+        retired_statistics_.dropped_count += dropped;
+        retired_statistics_.truncated_count += buffer.truncated_count.load();
+        it = buffers_.erase(it);
+        continue;
+      }
+      ++it;
+    }
+  }
+
+  // Merge the records of the threads, the records of each thread are already ordered
+  while (!pending.empty()) {
+    auto oldest = std::min_element(
+      pending.begin(), pending.end(),
+      [](const PendingBuffer & a, const PendingBuffer & b) {
+        return a.first->record(a.first->head()).timestamp <
+        b.first->record(b.first->head()).timestamp;
+      });
+    ThreadBuffer * buffer = oldest->first.get();
+    const LogRecord & record = buffer->record(buffer->head());
+    write_record(output_handler_, record, "%s", record.message);
+    buffer->pop();
+    written_count_.fetch_add(1u, std::memory_order_relaxed);
+    if (buffer->head() == oldest->second) {
+      pending.erase(oldest);
+    }
+  }
+
+  if (dropped_count > 0u) {
+    LogRecord record;
+    record.has_location = false;
+    record.severity = RCUTILS_LOG_SEVERITY_WARN;
+    copy_string(record.name, max_name_size, "rclcpp");
+    if (RCUTILS_RET_OK != rcutils_system_time_now(&record.timestamp)) {
+      record.timestamp = 0;
+      rcutils_reset_error();
+    }
+    write_record(
+      output_handler_, record,
+      "%" PRIu64 " log messages were dropped, the asynchronous logging buffer of their thread "
+      "was full", dropped_count);
+  }
+}
+
+AsyncLoggingBackend &
+rclcpp::detail::get_global_async_logging_backend()
+{
+  static AsyncLoggingBackend backend(get_global_logging_mutex());
+  return backend;
+}
+
+void
+rclcpp::flush_async_logging()
+{
+  rclcpp::detail::get_global_async_logging_backend().flush();
+}
+
+rclcpp::AsyncLoggingStatistics
+rclcpp::get_async_logging_statistics()
+{
+  return rclcpp::detail::get_global_async_logging_backend().get_statistics();
+}
@@ -0,0 +1,253 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/detail/async_publish_queue.hpp"
+
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/logging.hpp"
+
+#include "rmw/impl/cpp/demangle.hpp"
+
+using rclcpp::detail::AsyncPublishQueueBase;
+using rclcpp::detail::AsyncPublishSender;
+
+AsyncPublishSender::AsyncPublishSender()
+: thread_(&AsyncPublishSender::run, this)
+{}
+
+AsyncPublishSender::~AsyncPublishSender()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  condition_.notify_one();
+  thread_.join();
+}
+
+void
+AsyncPublishSender::post(std::shared_ptr<AsyncPublishQueueBase> queue)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    posted_queues_.push_back(std::move(queue));
+  }
+  condition_.notify_one();
+}
+
+void
+AsyncPublishSender::run()
+{
+  std::vector<std::shared_ptr<AsyncPublishQueueBase>> sending_queues;
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;) {
+    condition_.wait(lock, [this]() {return stopping_ || !posted_queues_.empty();});
+    if (posted_queues_.empty()) {
+      // Stopping once all the posted queues are sent
+      return;
+    }
+    sending_queues.swap(posted_queues_);
+    lock.unlock();
+    for (const auto & queue : sending_queues) {
+      queue->send();
+    }
+    sending_queues.clear();
+    lock.lock();
+  }
+}
+
+AsyncPublishQueueBase::AsyncPublishQueueBase(
+  const rclcpp::AsyncPublishingOptions & options,
+  std::shared_ptr<AsyncPublishSender> sender)
+: options_(options),
+  sender_(std::move(sender))
+{
+  if (!sender_) {
+    throw std::invalid_argument("the sender of an asynchronous publisher must not be null");
+  }
+}
+
+AsyncPublishQueueBase::~AsyncPublishQueueBase()
+{}
+
+void
+AsyncPublishQueueBase::send()
+{
+  {
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    if (closed_) {
+      return;
+    }
+    for (;;) {
+      publish_queued_messages();
+      scheduled_.store(false);
+      // A message enqueued after the last dequeue may have found the queue still scheduled
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (!has_data() || scheduled_.exchange(true)) {
+        break;
+      }
+    }
+  }
+  notify_waiting_threads();
+}
+
+void
+AsyncPublishQueueBase::close()
+{
+  {
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    if (closed_) {
+      return;
+    }
+    publish_queued_messages();
+    closed_ = true;
+    scheduled_.store(false);
+    // The sender isn't needed anymore, and it must not be destroyed by its own thread
+    sender_.reset();
+  }
+  notify_waiting_threads();
+}
+
+bool
+AsyncPublishQueueBase::wait_until_sent(std::chrono::nanoseconds timeout)
+{
+  auto is_sent = [this]() {return !scheduled_.load() && !has_data();};
+  std::unique_lock<std::mutex> lock(wait_mutex_);
+  waiting_count_.fetch_add(1);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  bool sent = true;
+  if (timeout < std::chrono::nanoseconds::zero()) {
+    wait_condition_.wait(lock, is_sent);
+  } else {
+    sent = wait_condition_.wait_for(lock, timeout, is_sent);
+  }
+  waiting_count_.fetch_sub(1);
+  return sent;
+}
+
+rclcpp::AsyncPublishingStatistics
+AsyncPublishQueueBase::get_statistics() const
+{
+  const auto metrics = get_queue_metrics();
+  rclcpp::AsyncPublishingStatistics statistics;
+  statistics.depth = metrics.capacity;
+  statistics.size = metrics.depth;
+  statistics.high_water_mark = metrics.high_water_mark;
+  statistics.enqueued_count = metrics.enqueued_count;
+  statistics.published_count = published_count_.load(std::memory_order_relaxed);
+  statistics.dropped_count =
+    metrics.dropped_count + rejected_count_.load(std::memory_order_relaxed);
+  statistics.blocked_count = blocked_count_.load(std::memory_order_relaxed);
+  statistics.failed_count = failed_count_.load(std::memory_order_relaxed);
+  return statistics;
+}
+
+bool
+AsyncPublishQueueBase::make_room()
+{
+  switch (options_.overflow_policy) {
+    case rclcpp::AsyncPublishingOverflowPolicy::DropOldest:
+      // The ring buffer drops the oldest message when enqueuing into a full buffer
+      return true;
+    case rclcpp::AsyncPublishingOverflowPolicy::DropNewest:
+      if (reserve_slot()) {
+        return true;
+      }
+      rejected_count_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    case rclcpp::AsyncPublishingOverflowPolicy::Block:
+      break;
+  }
+  if (reserve_slot()) {
+    return true;
+  }
+  blocked_count_.fetch_add(1, std::memory_order_relaxed);
+  std::unique_lock<std::mutex> lock(wait_mutex_);
+  waiting_count_.fetch_add(1);
+  // Pairs with the fence of the sender thread, so either sees the other's update
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  wait_condition_.wait(lock, [this]() {return reserve_slot();});
+  waiting_count_.fetch_sub(1);
+  return true;
+}
+
+void
+AsyncPublishQueueBase::release_slot()
+{
+  if (options_.overflow_policy != rclcpp::AsyncPublishingOverflowPolicy::DropOldest) {
+    reserved_count_.fetch_sub(1);
+  }
+}
+
+bool
+AsyncPublishQueueBase::reserve_slot()
+{
+  // Concurrent publish calls can't enqueue into a full buffer, which would drop a message
+  size_t count = reserved_count_.load();
+  while (count < options_.depth) {
+    if (reserved_count_.compare_exchange_weak(count, count + 1)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void
+AsyncPublishQueueBase::schedule()
+{
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (!scheduled_.exchange(true)) {
+    sender_->post(shared_from_this());
+  }
+}
+
+void
+AsyncPublishQueueBase::publish_queued_messages()
+{
+  for (;;) {
+    try {
+      if (!publish_next()) {
+        return;
+      }
+      published_count_.fetch_add(1, std::memory_order_relaxed);
+    } catch (const std::exception & exception) {
+      failed_count_.fetch_add(1, std::memory_order_relaxed);
+      RCLCPP_ERROR(
+        rclcpp::get_logger("rclcpp"),
+        "caught %s exception in an asynchronous publish: %s",
+        rmw::impl::cpp::demangle(exception).c_str(), exception.what());
+    } catch (...) {
+      failed_count_.fetch_add(1, std::memory_order_relaxed);
+      RCLCPP_ERROR(
+        rclcpp::get_logger("rclcpp"), "caught unknown exception in an asynchronous publish");
+    }
+    notify_waiting_threads();
+  }
+}
+
+void
+AsyncPublishQueueBase::notify_waiting_threads()
+{
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (waiting_count_.load(std::memory_order_relaxed) > 0) {
+    std::lock_guard<std::mutex> lock(wait_mutex_);
+    wait_condition_.notify_all();
+  }
+}
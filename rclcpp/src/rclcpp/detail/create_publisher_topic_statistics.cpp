@@ -0,0 +1,87 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "rclcpp/detail/create_publisher_topic_statistics.hpp"
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "rclcpp/create_timer.hpp"
+#include "rclcpp/detail/resolve_enable_topic_statistics.hpp"
+#include "rclcpp/publisher.hpp"
+#include "rclcpp/publisher_factory.hpp"
+
+#include "statistics_msgs/msg/metrics_message.hpp"
+
+namespace rclcpp
+{
+namespace detail
+{
+
+rclcpp::topic_statistics::PublisherTopicStatistics::SharedPtr
+create_publisher_topic_statistics(
+  rclcpp::node_interfaces::NodeTopicsInterface & node_topics,
+  const rclcpp::PublisherOptionsBase & options,
+  const rclcpp::QoS & qos)
+{
+  using rclcpp::topic_statistics::PublisherTopicStatistics;
+
+  auto node_base = node_topics.get_node_base_interface();
+  if (!rclcpp::detail::resolve_enable_topic_statistics(options, *node_base)) {
+    return nullptr;
+  }
+  if (options.topic_stats_options.publish_period <= std::chrono::milliseconds(0)) {
+    throw std::invalid_argument(
+            "topic_stats_options.publish_period must be greater than 0, specified value of " +
+            std::to_string(options.topic_stats_options.publish_period.count()) +
+            " ms");
+  }
+
+  // The statistics publisher uses the default options, so it has no statistics itself
+  auto publisher = node_topics.create_publisher(
+    options.topic_stats_options.publish_topic,
+    rclcpp::create_publisher_factory<statistics_msgs::msg::MetricsMessage>(
+      rclcpp::PublisherOptions()),
+    qos);
+  node_topics.add_publisher(publisher, nullptr);
+
+  auto publisher_topic_stats = std::make_shared<PublisherTopicStatistics>(
+    node_base->get_name(),
+    std::dynamic_pointer_cast<PublisherTopicStatistics::MetricsPublisher>(publisher));
+
+  std::weak_ptr<PublisherTopicStatistics> weak_publisher_topic_stats(publisher_topic_stats);
+  auto pub_call_back = [weak_publisher_topic_stats]() {
+      auto publisher_topic_stats = weak_publisher_topic_stats.lock();
+      if (publisher_topic_stats) {
+        publisher_topic_stats->publish_message_and_reset_measurements();
+      }
+    };
+
+  auto timer = create_wall_timer(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+      options.topic_stats_options.publish_period),
+    pub_call_back,
+    options.callback_group,
+    node_base,
+    node_topics.get_node_timers_interface());
+
+  publisher_topic_stats->set_publisher_timer(timer);
+  return publisher_topic_stats;
+}
+
+}  // namespace detail
+}  // namespace rclcpp
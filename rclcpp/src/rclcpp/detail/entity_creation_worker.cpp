@@ -0,0 +1,75 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/detail/entity_creation_worker.hpp"
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+using rclcpp::detail::EntityCreationWorker;
+
+EntityCreationWorker::EntityCreationWorker()
+: state_(std::make_shared<State>()),
+  thread_(&EntityCreationWorker::run, state_)
+{}
+
+EntityCreationWorker::~EntityCreationWorker()
+{
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->stopping = true;
+  }
+  state_->condition.notify_one();
+  if (thread_.get_id() == std::this_thread::get_id()) {
+    // Destroyed by one of its creations, the thread exits after it
+    thread_.detach();
+  } else {
+    thread_.join();
+  }
+}
+
+void
+EntityCreationWorker::post(std::function<void()> creation)
+{
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->creations.push_back(std::move(creation));
+  }
+  state_->condition.notify_one();
+}
+
+void
+EntityCreationWorker::run(std::shared_ptr<State> state)
+{
+  std::unique_lock<std::mutex> lock(state->mutex);
+  for (;;) {
+    state->condition.wait(
+      lock, [&state]() {
+        return state->stopping || !state->creations.empty();
+      });
+    if (state->creations.empty()) {
+      // Stopping once all the creations posted ran
+      return;
+    }
+    std::function<void()> creation = std::move(state->creations.front());
+    state->creations.pop_front();
+    lock.unlock();
+    creation();
+    // Released unlocked, it may hold the last reference to a node
+    creation = nullptr;
+    lock.lock();
+  }
+}
@@ -0,0 +1,85 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__DETAIL__ENTITY_HANDOFF_HPP_
+#define RCLCPP__DETAIL__ENTITY_HANDOFF_HPP_
+
+#include <memory>
+#include <string>
+
+#include "rcl/node.h"
+#include "rcl/publisher.h"
+#include "rcl/subscription.h"
+#include "rosidl_runtime_c/message_type_support_struct.h"
+
+#include "rclcpp/node_interfaces/node_base_interface.hpp"
+
+namespace rclcpp
+{
+namespace detail
+{
+
+/// \internal Return true if the entities of the rcl node are handed over, see EntityHandoff.
+bool
+is_handing_over_node(const rcl_node_t * node);
+
+/// \internal Keep a publisher being destroyed if its node is handed over.
+/**
+ * \return false if the node isn't handed over, the publisher is then finalized.
+ */
+bool
+keep_handed_over_publisher(
+  const std::shared_ptr<rcl_publisher_t> & publisher,
+  const rcl_node_t * node,
+  const rosidl_message_type_support_t & type_support);
+
+/// \internal Take a kept publisher of the node with the same topic, type and options.
+/**
+ * \return the publisher, or nullptr if there is none.
+ */
+std::shared_ptr<rcl_publisher_t>
+take_handed_over_publisher(
+  rclcpp::node_interfaces::NodeBaseInterface * node_base,
+  const std::string & topic_name,
+  const rosidl_message_type_support_t & type_support,
+  const rcl_publisher_options_t & publisher_options);
+
+/// \internal Keep a subscription being destroyed if its node is handed over.
+/**
+ * The callback for new messages of the subscription must already be cleared.
+ * Subscriptions using a content filter aren't kept.
+ *
+ * \return false if the subscription isn't kept, it is then finalized.
+ */
+bool
+keep_handed_over_subscription(
+  const std::shared_ptr<rcl_subscription_t> & subscription,
+  const rcl_node_t * node,
+  const rosidl_message_type_support_t & type_support);
+
+/// \internal Take a kept subscription of the node with the same topic, type and options.
+/**
+ * \return the subscription, or nullptr if there is none.
+ */
+std::shared_ptr<rcl_subscription_t>
+take_handed_over_subscription(
+  rclcpp::node_interfaces::NodeBaseInterface * node_base,
+  const std::string & topic_name,
+  const rosidl_message_type_support_t & type_support,
+  const rcl_subscription_options_t & subscription_options);
+
+}  // namespace detail
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DETAIL__ENTITY_HANDOFF_HPP_
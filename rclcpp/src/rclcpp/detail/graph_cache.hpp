@@ -0,0 +1,78 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__DETAIL__GRAPH_CACHE_HPP_
+#define RCLCPP__DETAIL__GRAPH_CACHE_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace rclcpp
+{
+namespace detail
+{
+
+/// \internal Results of the graph queries of the nodes of a context, until the graph changes.
+/**
+ * The graph is identified by the number of graph changes the graph listener of the context saw,
+ * the results of a query in an older graph are dropped on the first query in a newer one.
+ */
+class GraphCache
+{
+public:
+  /// Return the result of a query in the graph, querying it only if it isn't cached.
+  /**
+   * \param[in] key identifier of the query and its arguments.
+   * \param[in] generation number of graph changes seen before the query.
+   * \param[in] query function querying the graph.
+   */
+  template<typename T, typename QueryT>
+  T
+  get(const std::string & key, uint64_t generation, QueryT && query)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (generation == generation_) {
+        auto it = results_.find(key);
+        if (it != results_.end()) {
+          return *std::static_pointer_cast<const T>(it->second);
+        }
+      }
+    }
+    auto result = std::make_shared<const T>(query());
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (generation > generation_) {
+      results_.clear();
+      generation_ = generation;
+    }
+    if (generation == generation_) {
+      results_[key] = result;
+    }
+    return *result;
+  }
+
+private:
+  std::mutex mutex_;
+  uint64_t generation_ = 0;
+  std::unordered_map<std::string, std::shared_ptr<const void>> results_;
+};
+
+}  // namespace detail
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DETAIL__GRAPH_CACHE_HPP_
@@ -0,0 +1,165 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./hardware_counter_reader.hpp"
+
+#include <array>
+#include <cstdint>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using rclcpp::detail::HardwareCounterReader;
+
+HardwareCounterReader &
+HardwareCounterReader::get_thread_reader()
+{
+  // perf_event counters opened for the calling thread only count that thread
+  thread_local HardwareCounterReader reader;
+  return reader;
+}
+
+HardwareCounterReader::HardwareCounterReader()
+{
+  fds_.fill(-1);
+  read_order_.fill(NumberOfCounters);
+#if defined(__linux__)
+  struct CounterConfig
+  {
+    Counter counter;
+    uint32_t type;
+    uint64_t config;
+    bool exclude_kernel;
+  };
+  const CounterConfig configs[] = {
+    {Instructions, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, true},
+    {Cycles, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, true},
+    {CacheMisses, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, true},
+    // The context switches happen in the kernel
+    {ContextSwitches, PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, false},
+  };
+  for (const CounterConfig & config : configs) {
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = config.type;
+    attr.config = config.config;
+    attr.read_format = PERF_FORMAT_GROUP;
+    attr.exclude_kernel = config.exclude_kernel ? 1 : 0;
+    attr.exclude_hv = 1;
+    // The group is enabled at once, once all its counters are opened
+    attr.disabled = leader_fd_ == -1 ? 1 : 0;
+    const int fd = static_cast<int>(
+      syscall(SYS_perf_event_open, &attr, 0, -1, leader_fd_, PERF_FLAG_FD_CLOEXEC));
+    if (fd == -1) {
+      continue;
+    }
+    if (leader_fd_ == -1) {
+      leader_fd_ = fd;
+    }
+    fds_[config.counter] = fd;
+    read_order_[number_of_open_counters_++] = config.counter;
+  }
+  if (leader_fd_ != -1 &&
+    ioctl(leader_fd_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP) == -1)
+  {
+    for (int & fd : fds_) {
+      if (fd != -1) {
+        close(fd);
+        fd = -1;
+      }
+    }
+    leader_fd_ = -1;
+    number_of_open_counters_ = 0;
+  }
+#endif
+}
+
+HardwareCounterReader::~HardwareCounterReader()
+{
+#if defined(__linux__)
+  for (int fd : fds_) {
+    if (fd != -1) {
+      close(fd);
+    }
+  }
+#endif
+}
+
+bool
+HardwareCounterReader::is_available() const
+{
+  return leader_fd_ != -1;
+}
+
+bool
+HardwareCounterReader::read(rclcpp::HardwareCounters & values) const
+{
+#if defined(__linux__)
+  if (leader_fd_ == -1) {
+    return false;
+  }
+  // With PERF_FORMAT_GROUP, the number of counters followed by their values
+  std::array<uint64_t, NumberOfCounters + 1> buffer;
+  const ssize_t size = static_cast<ssize_t>(sizeof(uint64_t) * (number_of_open_counters_ + 1));
+  if (::read(leader_fd_, buffer.data(), static_cast<size_t>(size)) != size) {
+    return false;
+  }
+  for (size_t i = 0; i < number_of_open_counters_; ++i) {
+    const uint64_t value = buffer[i + 1];
+    switch (read_order_[i]) {
+      case Instructions:
+        values.instructions = value;
+        break;
+      case Cycles:
+        values.cycles = value;
+        break;
+      case CacheMisses:
+        values.cache_misses = value;
+        break;
+      case ContextSwitches:
+        values.context_switches = value;
+        break;
+      default:
+        break;
+    }
+  }
+  return true;
+#else
+  (void)values;
+  return false;
+#endif
+}
+
+HardwareCounterReader::Measurement::Measurement(const HardwareCounterReader & reader)
+: reader_(reader), started_(reader.read(start_))
+{}
+
+rclcpp::HardwareCounters
+HardwareCounterReader::Measurement::stop() const
+{
+  rclcpp::HardwareCounters counters;
+  if (!started_ || !reader_.read(counters)) {
+    return rclcpp::HardwareCounters();
+  }
+  counters.count = 1;
+  counters.instructions -= start_.instructions;
+  counters.cycles -= start_.cycles;
+  counters.cache_misses -= start_.cache_misses;
+  counters.context_switches -= start_.context_switches;
+  return counters;
+}
@@ -0,0 +1,107 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__DETAIL__HARDWARE_COUNTER_READER_HPP_
+#define RCLCPP__DETAIL__HARDWARE_COUNTER_READER_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "rclcpp/executor_callback_statistics.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace detail
+{
+
+/// \internal Reader of the hardware performance counters of the calling thread.
+/**
+ * On Linux, the counters are perf_event counters of the thread, opened as a single group so
+ * that one read() gives all of them.
+ * The counters which can't be opened, e.g. because of the perf_event_paranoid setting or in
+ * a virtual machine without a PMU, are left out.
+ */
+class HardwareCounterReader
+{
+public:
+  /// Return the reader of the calling thread, opening its counters on first use.
+  RCLCPP_LOCAL
+  static HardwareCounterReader &
+  get_thread_reader();
+
+  RCLCPP_LOCAL
+  ~HardwareCounterReader();
+
+  HardwareCounterReader(const HardwareCounterReader &) = delete;
+  HardwareCounterReader & operator=(const HardwareCounterReader &) = delete;
+
+  /// Return true if at least one counter could be opened.
+  RCLCPP_LOCAL
+  bool
+  is_available() const;
+
+  /// Read the current values of the counters, the count of the values is left untouched.
+  /**
+   * \return false if the counters aren't available or couldn't be read.
+   */
+  RCLCPP_LOCAL
+  bool
+  read(rclcpp::HardwareCounters & values) const;
+
+  /// \internal Measures the hardware counters of the calling thread during a scope.
+  class Measurement
+  {
+  public:
+    /// Start measuring, if the reader is available.
+    RCLCPP_LOCAL
+    explicit Measurement(const HardwareCounterReader & reader);
+
+    /// Return the counters since the start, their count is 1 unless the measurement failed.
+    RCLCPP_LOCAL
+    rclcpp::HardwareCounters
+    stop() const;
+
+  private:
+    const HardwareCounterReader & reader_;
+    rclcpp::HardwareCounters start_;
+    bool started_;
+  };
+
+private:
+  HardwareCounterReader();
+
+  enum Counter : size_t
+  {
+    Instructions,
+    Cycles,
+    CacheMisses,
+    ContextSwitches,
+    NumberOfCounters
+  };
+
+  /// File descriptor of the group leader, -1 if no counter could be opened.
+  int leader_fd_ = -1;
+  /// File descriptors of the counters, -1 for those not available.
+  std::array<int, NumberOfCounters> fds_;
+  /// Counters in the order of their values in a read of the group.
+  std::array<Counter, NumberOfCounters> read_order_;
+  size_t number_of_open_counters_ = 0;
+};
+
+}  // namespace detail
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DETAIL__HARDWARE_COUNTER_READER_HPP_
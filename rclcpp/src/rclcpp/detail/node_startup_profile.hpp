@@ -0,0 +1,62 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__DETAIL__NODE_STARTUP_PROFILE_HPP_
+#define RCLCPP__DETAIL__NODE_STARTUP_PROFILE_HPP_
+
+#include <chrono>
+
+#include "rclcpp/create_nodes.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace detail
+{
+
+/// \internal Return the profile of the nodes created by the current thread, nullptr if none.
+RCLCPP_LOCAL
+NodeStartupProfile *&
+get_thread_node_startup_profile();
+
+/// \internal Add the time spent in a scope to a phase of the startup profile of the thread.
+class NodeStartupPhaseTimer
+{
+public:
+  explicit NodeStartupPhaseTimer(std::chrono::nanoseconds NodeStartupProfile::* phase)
+  : profile_(get_thread_node_startup_profile()), phase_(phase)
+  {
+    if (profile_) {
+      start_ = std::chrono::steady_clock::now();
+    }
+  }
+
+  ~NodeStartupPhaseTimer()
+  {
+    if (profile_) {
+      profile_->*phase_ += std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start_);
+    }
+  }
+
+private:
+  NodeStartupProfile * profile_;
+  std::chrono::nanoseconds NodeStartupProfile::* phase_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace detail
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DETAIL__NODE_STARTUP_PROFILE_HPP_
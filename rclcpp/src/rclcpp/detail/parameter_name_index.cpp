@@ -0,0 +1,171 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "parameter_name_index.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+using rclcpp::detail::ParameterNameIndex;
+
+// The namespaces of a name are separated by '.'
+static constexpr char separator = '.';
+
+// Return the child namespace with the name, or where to insert it.
+template<typename ChildrenT>
+auto
+__find_child(ChildrenT & children, const std::string & name)
+{
+  return std::lower_bound(
+    children.begin(), children.end(), name,
+    [](const auto & child, const std::string & name) {return child.first < name;});
+}
+
+ParameterNameIndex::ParameterNameIndex()
+: root_(std::make_shared<Namespace>())
+{}
+
+ParameterNameIndex::~ParameterNameIndex() = default;
+
+ParameterNameIndex::ParameterNameIndex(const ParameterNameIndex & other) = default;
+
+ParameterNameIndex &
+ParameterNameIndex::operator=(const ParameterNameIndex & other) = default;
+
+ParameterNameIndex::Namespace &
+ParameterNameIndex::unshare(std::shared_ptr<Namespace> & ns)
+{
+  // Only the thread modifying this index adds references to its namespaces, the other threads
+  // only release the copies, so at worst a namespace no longer shared is copied
+  if (ns.use_count() > 1) {
+    ns = std::make_shared<Namespace>(*ns);
+  }
+  return *ns;
+}
+
+void
+ParameterNameIndex::add(const std::string & name)
+{
+  Namespace * ns = &unshare(root_);
+  size_t begin = 0;
+  for (;;) {
+    const size_t end = name.find(separator, begin);
+    std::string segment = name.substr(begin, end - begin);
+    auto child_it = __find_child(ns->children, segment);
+    if (child_it == ns->children.end() || child_it->first != segment) {
+      child_it = ns->children.emplace(
+        child_it, std::move(segment), std::make_shared<Namespace>());
+    }
+    ns = &unshare(child_it->second);
+    if (std::string::npos == end) {
+      break;
+    }
+    begin = end + 1;
+  }
+  if (!ns->parameter_name) {
+    ns->parameter_name = std::make_shared<const std::string>(name);
+  }
+}
+
+void
+ParameterNameIndex::remove(const std::string & name)
+{
+  // Nothing is copied for a name which wasn't added
+  if (contains(name)) {
+    remove(unshare(root_), name, 0);
+  }
+}
+
+void
+ParameterNameIndex::remove(Namespace & ns, const std::string & name, size_t begin)
+{
+  const size_t end = name.find(separator, begin);
+  auto child_it = __find_child(ns.children, name.substr(begin, end - begin));
+  Namespace & child = unshare(child_it->second);
+  if (std::string::npos == end) {
+    child.parameter_name.reset();
+  } else {
+    remove(child, name, end + 1);
+  }
+  if (!child.parameter_name && child.children.empty()) {
+    ns.children.erase(child_it);
+  }
+}
+
+const ParameterNameIndex::Namespace *
+ParameterNameIndex::find(const std::string & prefix) const
+{
+  const Namespace * ns = root_.get();
+  size_t begin = 0;
+  for (;;) {
+    const size_t end = prefix.find(separator, begin);
+    const std::string segment = prefix.substr(begin, end - begin);
+    auto child_it = __find_child(ns->children, segment);
+    if (child_it == ns->children.end() || child_it->first != segment) {
+      return nullptr;
+    }
+    ns = child_it->second.get();
+    if (std::string::npos == end) {
+      return ns;
+    }
+    begin = end + 1;
+  }
+}
+
+bool
+ParameterNameIndex::contains(const std::string & prefix) const
+{
+  const Namespace * ns = find(prefix);
+  return ns && ns->parameter_name;
+}
+
+void
+ParameterNameIndex::get_names(size_t max_distance, std::vector<const std::string *> & names) const
+{
+  if (max_distance > 0) {
+    append_names(*root_, max_distance, names);
+  }
+}
+
+void
+ParameterNameIndex::get_names(
+  const std::string & prefix,
+  size_t max_distance,
+  std::vector<const std::string *> & names) const
+{
+  const Namespace * ns = find(prefix);
+  if (ns && max_distance > 0) {
+    append_names(*ns, max_distance, names);
+  }
+}
+
+void
+ParameterNameIndex::append_names(
+  const Namespace & ns,
+  size_t max_distance,
+  std::vector<const std::string *> & names)
+{
+  for (const auto & child : ns.children) {
+    if (child.second->parameter_name) {
+      names.push_back(child.second->parameter_name.get());
+    }
+    if (max_distance > 1) {
+      append_names(
+        *child.second, any_distance == max_distance ? max_distance : max_distance - 1, names);
+    }
+  }
+}
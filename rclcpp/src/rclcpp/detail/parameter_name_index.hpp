@@ -0,0 +1,135 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__DETAIL__PARAMETER_NAME_INDEX_HPP_
+#define RCLCPP__DETAIL__PARAMETER_NAME_INDEX_HPP_
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace detail
+{
+
+/// \internal Hierarchical index of the parameter names, split into namespaces at each '.'.
+/**
+ * The names in a namespace are found without visiting the names outside of it, nor the names
+ * deeper than the requested depth.
+ *
+ * The copies of an index share its namespaces, so copying it is cheap.
+ * Adding or removing a name only copies the namespaces of the name that are still shared, so the
+ * other copies are left as is, and can be read while the index is modified.
+ * Each index must be modified by a single thread.
+ */
+class ParameterNameIndex
+{
+public:
+  /// Distance to pass to get the names of all the descendants of a namespace.
+  static constexpr size_t any_distance = std::numeric_limits<size_t>::max();
+
+  RCLCPP_LOCAL
+  ParameterNameIndex();
+
+  RCLCPP_LOCAL
+  ~ParameterNameIndex();
+
+  RCLCPP_LOCAL
+  ParameterNameIndex(const ParameterNameIndex & other);
+
+  RCLCPP_LOCAL
+  ParameterNameIndex &
+  operator=(const ParameterNameIndex & other);
+
+  /// Add the name of a parameter.
+  RCLCPP_LOCAL
+  void
+  add(const std::string & name);
+
+  /// Remove the name of a parameter, and the namespaces left empty, if the name was added.
+  RCLCPP_LOCAL
+  void
+  remove(const std::string & name);
+
+  /// Return true if the namespace is the name of a parameter.
+  RCLCPP_LOCAL
+  bool
+  contains(const std::string & prefix) const;
+
+  /// Get the names of the parameters with at most max_distance namespaces.
+  RCLCPP_LOCAL
+  void
+  get_names(size_t max_distance, std::vector<const std::string *> & names) const;
+
+  /// Get the names of the parameters in the namespace of the prefix.
+  /**
+   * The names at most max_distance namespaces below the prefix are appended, not including
+   * the prefix itself.
+   * Like the names, the prefix is split at each '.', so an empty prefix is the namespace of the
+   * names starting with '.', not the root namespace.
+   */
+  RCLCPP_LOCAL
+  void
+  get_names(
+    const std::string & prefix,
+    size_t max_distance,
+    std::vector<const std::string *> & names) const;
+
+private:
+  struct Namespace
+  {
+    /// Child namespaces sorted by name, so that copying a namespace is a single allocation.
+    std::vector<std::pair<std::string, std::shared_ptr<Namespace>>> children;
+    /// Name of the parameter named after this namespace, if any.
+    std::shared_ptr<const std::string> parameter_name;
+  };
+
+  /// Return the namespace to modify, copied first if it is shared with other indexes.
+  RCLCPP_LOCAL
+  static
+  Namespace &
+  unshare(std::shared_ptr<Namespace> & ns);
+
+  /// Remove the name from the namespace, from the segment starting at begin.
+  RCLCPP_LOCAL
+  static
+  void
+  remove(Namespace & ns, const std::string & name, size_t begin);
+
+  RCLCPP_LOCAL
+  const Namespace *
+  find(const std::string & prefix) const;
+
+  RCLCPP_LOCAL
+  static
+  void
+  append_names(
+    const Namespace & ns,
+    size_t max_distance,
+    std::vector<const std::string *> & names);
+
+  std::shared_ptr<Namespace> root_;
+};
+
+}  // namespace detail
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DETAIL__PARAMETER_NAME_INDEX_HPP_
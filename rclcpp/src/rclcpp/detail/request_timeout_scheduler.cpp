@@ -0,0 +1,162 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "rclcpp/detail/request_timeout_scheduler.hpp"
+
+#include <cinttypes>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/client.hpp"
+#include "rclcpp/context.hpp"
+#include "rclcpp/logging.hpp"
+#include "rmw/impl/cpp/demangle.hpp"
+
+using rclcpp::detail::RequestTimeoutScheduler;
+
+RequestTimeoutScheduler::RequestTimeoutScheduler(const std::shared_ptr<rclcpp::Context> & context)
+: weak_context_(context)
+{
+}
+
+RequestTimeoutScheduler::~RequestTimeoutScheduler()
+{
+  shutdown();
+  if (thread_.joinable()) {
+    // Only left running when a request timing out dropped the last reference, it exits then
+    thread_.detach();
+  }
+}
+
+void
+RequestTimeoutScheduler::schedule(
+  std::chrono::steady_clock::time_point deadline,
+  std::weak_ptr<rclcpp::ClientBase> client,
+  int64_t request_id)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (is_shutdown_) {
+    return;
+  }
+  if (!is_started_) {
+    auto context = weak_context_.lock();
+    if (!context || !context->is_valid()) {
+      return;
+    }
+    // Stopped with the context, before the destruction of static objects
+    std::weak_ptr<RequestTimeoutScheduler> weak_this = shared_from_this();
+    context->on_shutdown(
+      [weak_this]() {
+        auto shared_this = weak_this.lock();
+        if (shared_this) {
+          shared_this->shutdown();
+        }
+      });
+    thread_ = std::thread(&RequestTimeoutScheduler::run, weak_this);
+    is_started_ = true;
+  }
+  const bool is_earliest = deadlines_.empty() || deadline < deadlines_.top().time;
+  deadlines_.push({deadline, std::move(client), request_id});
+  if (is_earliest) {
+    cv_.notify_one();
+  }
+}
+
+size_t
+RequestTimeoutScheduler::get_scheduled_count() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return deadlines_.size();
+}
+
+void
+RequestTimeoutScheduler::shutdown()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (is_shutdown_) {
+      return;
+    }
+    is_shutdown_ = true;
+    deadlines_ = {};
+  }
+  cv_.notify_one();
+  // The thread can't join itself, it exits once the request timing out is done
+  if (thread_.joinable() && thread_.get_id() != std::this_thread::get_id()) {
+    thread_.join();
+  }
+}
+
+bool
+RequestTimeoutScheduler::wait_for_expired_deadlines(std::vector<Deadline> & expired)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!is_shutdown_) {
+    if (deadlines_.empty()) {
+      cv_.wait(lock);
+      continue;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    // Copied, the queue can be reallocated by a schedule() call while waiting
+    const auto earliest = deadlines_.top().time;
+    if (earliest > now) {
+      cv_.wait_until(lock, earliest);
+      continue;
+    }
+    while (!deadlines_.empty() && deadlines_.top().time <= now) {
+      expired.push_back(deadlines_.top());
+      deadlines_.pop();
+    }
+    return true;
+  }
+  return false;
+}
+
+void
+RequestTimeoutScheduler::run(std::weak_ptr<RequestTimeoutScheduler> weak_this)
+{
+  std::vector<Deadline> expired;
+  // A request timing out can drop the last reference to the scheduler, so the scheduler is
+  // only used while locked
+  while (auto shared_this = weak_this.lock()) {
+    if (!shared_this->wait_for_expired_deadlines(expired)) {
+      return;
+    }
+    for (auto & deadline : expired) {
+      auto client = deadline.client.lock();
+      if (!client) {
+        continue;
+      }
+      try {
+        client->time_out_pending_request(deadline.request_id);
+      } catch (const std::exception & exc) {
+        RCLCPP_ERROR(
+          rclcpp::get_logger("rclcpp"),
+          "caught %s exception when timing out request %" PRId64 " of service '%s': %s",
+          rmw::impl::cpp::demangle(exc).c_str(), deadline.request_id,
+          client->get_service_name(), exc.what());
+      } catch (...) {
+        RCLCPP_ERROR(
+          rclcpp::get_logger("rclcpp"),
+          "caught unknown exception when timing out request %" PRId64 " of service '%s'",
+          deadline.request_id, client->get_service_name());
+      }
+    }
+    expired.clear();
+  }
+}
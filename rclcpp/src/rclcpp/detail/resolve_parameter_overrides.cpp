@@ -21,28 +21,71 @@
 #include "rcl_yaml_param_parser/parser.h"
 #include "rcpputils/scope_exit.hpp"
 
+#include "rclcpp/exceptions.hpp"
 #include "rclcpp/parameter_map.hpp"
 
+using rclcpp::detail::GlobalParameterOverrides;
+
+GlobalParameterOverrides::GlobalParameterOverrides(std::shared_ptr<rcl_context_t> rcl_context)
+{
+  rcl_ret_t ret = rcl_arguments_get_param_overrides(&rcl_context->global_arguments, &params_);
+  if (RCL_RET_OK != ret) {
+    rclcpp::exceptions::throw_from_rcl_error(ret);
+  }
+}
+
+GlobalParameterOverrides::~GlobalParameterOverrides()
+{
+  if (params_) {
+    rcl_yaml_node_struct_fini(params_);
+  }
+}
+
+const rcl_params_t *
+GlobalParameterOverrides::get_params() const
+{
+  return params_;
+}
+
+namespace
+{
+
+void
+apply_parameter_overrides(
+  const rcl_params_t * params,
+  const std::string & node_fqn,
+  std::map<std::string, rclcpp::ParameterValue> & result)
+{
+  rclcpp::ParameterMap initial_map = rclcpp::parameter_map_from(params, node_fqn.c_str());
+
+  if (initial_map.count(node_fqn) > 0) {
+    // Combine parameter yaml files, overwriting values in older ones
+    for (const rclcpp::Parameter & param : initial_map.at(node_fqn)) {
+      result[param.get_name()] =
+        rclcpp::ParameterValue(param.get_value_message());
+    }
+  }
+}
+
+}  // namespace
+
 std::map<std::string, rclcpp::ParameterValue>
 rclcpp::detail::resolve_parameter_overrides(
   const std::string & node_fqn,
   const std::vector<rclcpp::Parameter> & parameter_overrides,
   const rcl_arguments_t * local_args,
-  const rcl_arguments_t * global_args)
+  const rcl_params_t * global_params)
 {
   std::map<std::string, rclcpp::ParameterValue> result;
 
   // global before local so that local overwrites global
-  std::array<const rcl_arguments_t *, 2> argument_sources = {global_args, local_args};
-
-  // Get fully qualified node name post-remapping to use to find node's params in yaml files
+  if (global_params) {
+    apply_parameter_overrides(global_params, node_fqn, result);
+  }
 
-  for (const rcl_arguments_t * source : argument_sources) {
-    if (!source) {
-      continue;
-    }
+  if (local_args) {
     rcl_params_t * params = NULL;
-    rcl_ret_t ret = rcl_arguments_get_param_overrides(source, &params);
+    rcl_ret_t ret = rcl_arguments_get_param_overrides(local_args, &params);
     if (RCL_RET_OK != ret) {
       rclcpp::exceptions::throw_from_rcl_error(ret);
     }
@@ -51,15 +94,7 @@ rclcpp::detail::resolve_parameter_overrides(
         [params]() {
           rcl_yaml_node_struct_fini(params);
         });
-      rclcpp::ParameterMap initial_map = rclcpp::parameter_map_from(params, node_fqn.c_str());
-
-      if (initial_map.count(node_fqn) > 0) {
-        // Combine parameter yaml files, overwriting values in older ones
-        for (const rclcpp::Parameter & param : initial_map.at(node_fqn)) {
-          result[param.get_name()] =
-            rclcpp::ParameterValue(param.get_value_message());
-        }
-      }
+      apply_parameter_overrides(params, node_fqn, result);
     }
   }
 
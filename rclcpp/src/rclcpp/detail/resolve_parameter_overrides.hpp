@@ -15,11 +15,14 @@
 #ifndef RCLCPP__DETAIL__RESOLVE_PARAMETER_OVERRIDES_HPP_
 #define RCLCPP__DETAIL__RESOLVE_PARAMETER_OVERRIDES_HPP_
 
+#include <memory>
 #include <string>
 #include <map>
 #include <vector>
 
 #include "rcl/arguments.h"
+#include "rcl/context.h"
+#include "rcl_yaml_param_parser/types.h"
 
 #include "rclcpp/parameter.hpp"
 #include "rclcpp/parameter_value.hpp"
@@ -29,14 +32,42 @@ namespace rclcpp
 {
 namespace detail
 {
+/// \internal Parameter overrides of the global arguments of a context.
+/**
+ * They are copied out of the arguments once for all the nodes of the context, which are
+ * created after the arguments are parsed, and kept as a sub context of the context, see
+ * rclcpp::Context::get_sub_context().
+ */
+class GlobalParameterOverrides
+{
+public:
+  explicit GlobalParameterOverrides(std::shared_ptr<rcl_context_t> rcl_context);
+
+  ~GlobalParameterOverrides();
+
+  /// Return the parameter overrides, nullptr if there are none.
+  const rcl_params_t *
+  get_params() const;
+
+private:
+  rcl_params_t * params_ = nullptr;
+};
+
 /// \internal Get the parameter overrides from the arguments.
+/**
+ * \param[in] node_name fully qualified name of the node.
+ * \param[in] parameter_overrides overrides of the node options, applied last.
+ * \param[in] local_args arguments of the node.
+ * \param[in] global_params parameter overrides of the global arguments, applied first, or
+ *   nullptr if the node doesn't use the global arguments.
+ */
 RCLCPP_LOCAL
 std::map<std::string, rclcpp::ParameterValue>
 resolve_parameter_overrides(
   const std::string & node_name,
   const std::vector<rclcpp::Parameter> & parameter_overrides,
   const rcl_arguments_t * local_args,
-  const rcl_arguments_t * global_args);
+  const rcl_params_t * global_params);
 
 }  // namespace detail
 }  // namespace rclcpp
@@ -0,0 +1,89 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__DETAIL__RESOLVED_NAME_CACHE_HPP_
+#define RCLCPP__DETAIL__RESOLVED_NAME_CACHE_HPP_
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace rclcpp
+{
+namespace detail
+{
+
+/// \internal Topic and service names expanded or remapped for a node.
+/**
+ * The remap rules of a node are fixed when its rcl node is initialized, so the names are
+ * cached as long as the node.
+ * Only the names resolved successfully are cached, an invalid name is resolved, and throws,
+ * on each call.
+ * The cache is cleared when it holds max_size names, to bound its memory.
+ */
+class ResolvedNameCache
+{
+public:
+  static constexpr size_t max_size = 4096;
+
+  /// Return the resolved name, calling resolve only if it isn't cached.
+  /**
+   * \param[in] name name to resolve.
+   * \param[in] is_service true for a service name, false for a topic name.
+   * \param[in] only_expand true if the name is only expanded, false if it's also remapped.
+   * \param[in] resolve function resolving the name.
+   */
+  template<typename ResolveT>
+  std::string
+  get(const std::string & name, bool is_service, bool only_expand, ResolveT && resolve)
+  {
+    std::string key;
+    key.reserve(name.size() + 2);
+    key.push_back(is_service ? 's' : 't');
+    key.push_back(only_expand ? 'e' : 'r');
+    key += name;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = names_.find(key);
+      if (it != names_.end()) {
+        return it->second;
+      }
+    }
+    std::string resolved_name = resolve();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (names_.size() >= max_size) {
+      names_.clear();
+    }
+    names_.emplace(std::move(key), resolved_name);
+    return resolved_name;
+  }
+
+  /// Return the number of cached names.
+  size_t
+  size() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return names_.size();
+  }
+
+private:
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, std::string> names_;
+};
+
+}  // namespace detail
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DETAIL__RESOLVED_NAME_CACHE_HPP_
@@ -0,0 +1,240 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/detail/rosout_batcher.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rcutils/macros.h"
+
+using rclcpp::detail::RosoutBatcher;
+
+RosoutBatcher::RosoutBatcher(
+  const rclcpp::RosoutBatchingOptions & options, PublishFunction publish)
+: options_(options),
+  publish_(std::move(publish))
+{
+  if (!publish_) {
+    throw std::invalid_argument("the publish function of the rosout batcher must not be empty");
+  }
+  if (!is_enabled(options_)) {
+    throw std::invalid_argument(
+            "the rosout batching options must set a window or a maximum number of messages");
+  }
+  thread_ = std::thread(&RosoutBatcher::run, this);
+}
+
+RosoutBatcher::~RosoutBatcher()
+{
+  stop();
+}
+
+bool
+RosoutBatcher::is_enabled(const rclcpp::RosoutBatchingOptions & options)
+{
+  return options.window.count() > 0 || options.max_messages_per_second > 0u;
+}
+
+void
+RosoutBatcher::add(rcl_interfaces::msg::Log && log)
+{
+  bool publish_now = false;
+  bool notify = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_) {
+      publish_now = true;
+    } else {
+      const auto now = Clock::now();
+      auto inserted = loggers_.emplace(log.name, LoggerState());
+      LoggerState & state = inserted.first->second;
+      // The background thread waits for the loggers with pending messages only
+      notify = inserted.second;
+      if (options_.max_messages_per_second > 0u) {
+        if (now - state.period_start >= std::chrono::seconds(1)) {
+          close_summary(log.name, state);
+          state.period_start = now;
+          state.period_count = 0u;
+        }
+        if (state.period_count >= options_.max_messages_per_second) {
+          ++state.suppressed_count;
+          ++suppressed_count_;
+          return;
+        }
+        ++state.period_count;
+      }
+      if (0 == options_.window.count()) {
+        publish_now = true;
+      } else {
+        if (0u != state.batch_size && state.batch.level != log.level) {
+          close_batch(state);
+        }
+        if (0u == state.batch_size) {
+          state.batch = std::move(log);
+          state.batch_deadline = now + options_.window;
+        } else {
+          state.batch.msg += '\n';
+          state.batch.msg += log.msg;
+        }
+        if (++state.batch_size >= options_.max_batch_size) {
+          close_batch(state);
+        }
+      }
+      notify = notify || !ready_.empty();
+    }
+  }
+  if (notify) {
+    condition_.notify_one();
+  }
+  if (publish_now) {
+    publish_(log);
+  }
+}
+
+void
+RosoutBatcher::close()
+{
+  stop();
+  std::vector<rcl_interfaces::msg::Log> publishing;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    collect(Clock::now(), true);
+    publishing.swap(ready_);
+  }
+  for (const auto & log : publishing) {
+    publish_(log);
+  }
+}
+
+uint64_t
+RosoutBatcher::get_suppressed_count() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return suppressed_count_;
+}
+
+void
+RosoutBatcher::run()
+{
+  std::vector<rcl_interfaces::msg::Log> publishing;
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stopping_) {
+    const Clock::time_point next_time = collect(Clock::now(), false);
+    if (ready_.empty()) {
+      if (loggers_.empty()) {
+        condition_.wait(lock);
+      } else {
+        condition_.wait_until(lock, next_time);
+      }
+      continue;
+    }
+    publishing.swap(ready_);
+    lock.unlock();
+    for (const auto & log : publishing) {
+      try {
+        publish_(log);
+      } catch (const std::exception & ex) {
+        RCUTILS_SAFE_FWRITE_TO_STDERR(ex.what());
+        RCUTILS_SAFE_FWRITE_TO_STDERR("\n");
+      }
+    }
+    publishing.clear();
+    lock.lock();
+  }
+}
+
+bool
+RosoutBatcher::stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_) {
+      return false;
+    }
+    stopping_ = true;
+  }
+  condition_.notify_one();
+  thread_.join();
+  return true;
+}
+
+RosoutBatcher::Clock::time_point
+RosoutBatcher::collect(Clock::time_point now, bool all)
+{
+  const Clock::duration period = options_.window.count() > 0 ?
+    Clock::duration(options_.window) : Clock::duration(std::chrono::seconds(1));
+  Clock::time_point next_time = now + period;
+  for (auto it = loggers_.begin(); it != loggers_.end(); ) {
+    LoggerState & state = it->second;
+    if (0u != state.batch_size && (all || now >= state.batch_deadline)) {
+      close_batch(state);
+    }
+    const bool period_elapsed = now - state.period_start >= std::chrono::seconds(1);
+    if (all || period_elapsed) {
+      close_summary(it->first, state);
+    }
+    if (0u != state.batch_size) {
+      next_time = std::min(next_time, state.batch_deadline);
+    }
+    if (0u != state.suppressed_count) {
+      next_time = std::min(next_time, state.period_start + std::chrono::seconds(1));
+    }
+    if (0u == state.batch_size && 0u == state.suppressed_count && period_elapsed) {
+      // An idle logger is forgotten, its next message starts a new rate limit period
+      it = loggers_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  return next_time;
+}
+
+void
+RosoutBatcher::close_batch(LoggerState & state)
+{
+  ready_.push_back(std::move(state.batch));
+  state.batch = rcl_interfaces::msg::Log();
+  state.batch_size = 0u;
+}
+
+void
+RosoutBatcher::close_summary(const std::string & name, LoggerState & state)
+{
+  if (0u == state.suppressed_count) {
+    return;
+  }
+  // The messages allowed before the suppressed ones are published first
+  if (0u != state.batch_size) {
+    close_batch(state);
+  }
+  rcl_interfaces::msg::Log summary;
+  const auto stamp = std::chrono::system_clock::now().time_since_epoch();
+  const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(stamp);
+  summary.stamp.sec = static_cast<int32_t>(seconds.count());
+  summary.stamp.nanosec = static_cast<uint32_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(stamp - seconds).count());
+  summary.level = rcl_interfaces::msg::Log::WARN;
+  summary.name = name;
+  summary.msg = std::to_string(state.suppressed_count) +
+    " log messages were suppressed by the /rosout rate limit";
+  ready_.push_back(std::move(summary));
+  state.suppressed_count = 0u;
+}
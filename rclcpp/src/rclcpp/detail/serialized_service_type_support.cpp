@@ -0,0 +1,142 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/detail/serialized_service_type_support.hpp"
+
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+#include "rcutils/error_handling.h"
+#include "rosidl_typesupport_introspection_cpp/identifier.hpp"
+#include "rosidl_typesupport_introspection_cpp/message_introspection.hpp"
+
+#include "rclcpp/typesupport_helpers.hpp"
+
+using rclcpp::detail::SerializedServiceTypeSupport;
+using rosidl_typesupport_introspection_cpp::MessageMembers;
+
+namespace
+{
+
+const rosidl_message_type_support_t *
+get_message_type_support(
+  const std::string & service_type, const char * suffix, rcpputils::SharedLibrary & library)
+{
+  // The requests and responses are messages of the service package, e.g. pkg/srv/Type_Request
+  return rclcpp::get_typesupport_handle(
+    service_type + suffix, "rosidl_typesupport_cpp", library);
+}
+
+const void *
+get_message_members(
+  const std::string & service_type, const rosidl_message_type_support_t * type_support)
+{
+  const rosidl_message_type_support_t * introspection_type_support =
+    get_message_typesupport_handle(
+    type_support, rosidl_typesupport_introspection_cpp::typesupport_identifier);
+  if (!introspection_type_support || !introspection_type_support->data) {
+    rcutils_reset_error();
+    throw std::runtime_error(
+            "The introspection type support of the service type '" + service_type +
+            "' is not available.");
+  }
+  return introspection_type_support->data;
+}
+
+}  // namespace
+
+SerializedServiceTypeSupport::SerializedServiceTypeSupport(const std::string & service_type)
+: library_(rclcpp::get_typesupport_library(service_type, "rosidl_typesupport_cpp")),
+  service_type_support_(
+    rclcpp::get_service_typesupport_handle(service_type, "rosidl_typesupport_cpp", *library_)),
+  request_serialization_(get_message_type_support(service_type, "_Request", *library_)),
+  response_serialization_(get_message_type_support(service_type, "_Response", *library_)),
+  request_members_(
+    get_message_members(
+      service_type, get_message_type_support(service_type, "_Request", *library_))),
+  response_members_(
+    get_message_members(
+      service_type, get_message_type_support(service_type, "_Response", *library_)))
+{}
+
+const rosidl_service_type_support_t *
+SerializedServiceTypeSupport::get_service_type_support() const
+{
+  return service_type_support_;
+}
+
+std::shared_ptr<void>
+SerializedServiceTypeSupport::create_request() const
+{
+  return create_message(request_members_);
+}
+
+std::shared_ptr<void>
+SerializedServiceTypeSupport::create_response() const
+{
+  return create_message(response_members_);
+}
+
+std::shared_ptr<void>
+SerializedServiceTypeSupport::deserialize_request(
+  const rclcpp::SerializedMessage & serialized_request) const
+{
+  auto request = create_request();
+  request_serialization_.deserialize_message(&serialized_request, request.get());
+  return request;
+}
+
+std::shared_ptr<void>
+SerializedServiceTypeSupport::deserialize_response(
+  const rclcpp::SerializedMessage & serialized_response) const
+{
+  auto response = create_response();
+  response_serialization_.deserialize_message(&serialized_response, response.get());
+  return response;
+}
+
+void
+SerializedServiceTypeSupport::serialize_request(
+  const void * request, rclcpp::SerializedMessage & serialized_request) const
+{
+  request_serialization_.serialize_message(request, &serialized_request);
+}
+
+void
+SerializedServiceTypeSupport::serialize_response(
+  const void * response, rclcpp::SerializedMessage & serialized_response) const
+{
+  response_serialization_.serialize_message(response, &serialized_response);
+}
+
+std::shared_ptr<void>
+SerializedServiceTypeSupport::create_message(const void * members) const
+{
+  const auto * message_members = static_cast<const MessageMembers *>(members);
+  void * message = ::operator new(message_members->size_of_);
+  try {
+    message_members->init_function(message, rosidl_runtime_cpp::MessageInitialization::ALL);
+  } catch (...) {
+    ::operator delete(message);
+    throw;
+  }
+  // The library holds the functions of the message, so it must outlive it
+  return std::shared_ptr<void>(
+    message, [message_members, library = library_](void * ptr) {
+      message_members->fini_function(ptr);
+      ::operator delete(ptr);
+    });
+}
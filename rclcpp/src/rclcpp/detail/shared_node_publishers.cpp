@@ -0,0 +1,268 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "./shared_node_publishers.hpp"
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "rcl/context.h"
+#include "rcl/error_handling.h"
+#include "rcl/time.h"
+#include "rcl_interfaces/msg/log.hpp"
+#include "rclcpp/exceptions.hpp"
+#include "rclcpp/get_message_type_support_handle.hpp"
+#include "rclcpp/qos.hpp"
+#include "rcutils/macros.h"
+
+using rclcpp::detail::SharedNodePublishers;
+
+namespace
+{
+
+struct RosoutLoggers
+{
+  std::mutex mutex;
+  /// Shared publishers and number of additions of each logger.
+  std::unordered_map<
+    std::string, std::pair<std::weak_ptr<SharedNodePublishers>, size_t>> loggers;
+  /// Number of loggers, checked before taking the mutex on each log message.
+  std::atomic<size_t> size {0};
+};
+
+RosoutLoggers &
+get_rosout_loggers()
+{
+  static RosoutLoggers rosout_loggers;
+  return rosout_loggers;
+}
+
+std::shared_ptr<SharedNodePublishers>
+find_rosout_publishers(RosoutLoggers & rosout_loggers, std::string logger_name)
+{
+  std::lock_guard<std::mutex> lock(rosout_loggers.mutex);
+  for (;;) {
+    auto it = rosout_loggers.loggers.find(logger_name);
+    if (it != rosout_loggers.loggers.end()) {
+      return it->second.first.lock();
+    }
+    auto separator = logger_name.rfind('.');
+    if (separator == std::string::npos) {
+      return nullptr;
+    }
+    logger_name.resize(separator);
+  }
+}
+
+// Log messages of the publication itself aren't published again
+thread_local bool g_publishing_log = false;
+
+std::atomic<size_t> g_number_of_shared_nodes {0};
+
+}  // namespace
+
+SharedNodePublishers::SharedNodePublishers(
+  std::shared_ptr<rcl_context_t> rcl_context,
+  const rclcpp::RosoutBatchingOptions & rosout_batching)
+: rcl_context_(std::move(rcl_context)),
+  node_(rcl_get_zero_initialized_node()),
+  parameter_events_publisher_(rcl_get_zero_initialized_publisher()),
+  rosout_publisher_(rcl_get_zero_initialized_publisher())
+{
+  if (RosoutBatcher::is_enabled(rosout_batching)) {
+    rosout_batcher_ = std::make_unique<RosoutBatcher>(
+      rosout_batching, [this](const rcl_interfaces::msg::Log & log) {
+        const bool publishing_log = g_publishing_log;
+        g_publishing_log = true;
+        publish_rosout(log);
+        g_publishing_log = publishing_log;
+      });
+  }
+}
+
+SharedNodePublishers::~SharedNodePublishers()
+{
+  if (rosout_batcher_) {
+    // The pending batches can't be published once the context is shut down
+    if (rcl_context_is_valid(rcl_context_.get())) {
+      rosout_batcher_->close();
+    }
+    rosout_batcher_.reset();
+  }
+  if (!initialized_) {
+    return;
+  }
+  if (RCL_RET_OK != rcl_publisher_fini(&rosout_publisher_, &node_)) {
+    RCUTILS_SAFE_FWRITE_TO_STDERR("failed to finalize the shared rosout publisher\n");
+    rcl_reset_error();
+  }
+  if (RCL_RET_OK != rcl_publisher_fini(&parameter_events_publisher_, &node_)) {
+    RCUTILS_SAFE_FWRITE_TO_STDERR("failed to finalize the shared parameter events publisher\n");
+    rcl_reset_error();
+  }
+  if (RCL_RET_OK != rcl_node_fini(&node_)) {
+    RCUTILS_SAFE_FWRITE_TO_STDERR("failed to finalize the node of the shared publishers\n");
+    rcl_reset_error();
+  }
+}
+
+void
+SharedNodePublishers::init_publishers()
+{
+  std::call_once(
+    init_flag_, [this]() {
+      rcl_node_options_t node_options = rcl_node_get_default_options();
+      node_options.use_global_arguments = false;
+      node_options.enable_rosout = false;
+      const std::string node_name =
+        "_shared_node_publishers_" + std::to_string(g_number_of_shared_nodes++);
+      rcl_ret_t ret = rcl_node_init(
+        &node_, node_name.c_str(), "", rcl_context_.get(), &node_options);
+      if (RCL_RET_OK != ret) {
+        rclcpp::exceptions::throw_from_rcl_error(
+          ret, "failed to create the node of the shared publishers");
+      }
+
+      rcl_publisher_options_t publisher_options = rcl_publisher_get_default_options();
+      publisher_options.qos = rclcpp::ParameterEventsQoS().get_rmw_qos_profile();
+      ret = rcl_publisher_init(
+        &parameter_events_publisher_, &node_,
+        &rclcpp::get_message_type_support_handle<rcl_interfaces::msg::ParameterEvent>(),
+        "/parameter_events", &publisher_options);
+      if (RCL_RET_OK == ret) {
+        publisher_options.qos = rclcpp::RosoutQoS().get_rmw_qos_profile();
+        ret = rcl_publisher_init(
+          &rosout_publisher_, &node_,
+          &rclcpp::get_message_type_support_handle<rcl_interfaces::msg::Log>(),
+          "/rosout", &publisher_options);
+        if (RCL_RET_OK != ret) {
+          (void)rcl_publisher_fini(&parameter_events_publisher_, &node_);
+        }
+      }
+      if (RCL_RET_OK != ret) {
+        rcl_error_string_t error = rcl_get_error_string();
+        rcl_reset_error();
+        (void)rcl_node_fini(&node_);
+        rcl_reset_error();
+        rclcpp::exceptions::throw_from_rcl_error(
+          ret, std::string("failed to create the shared publishers: ") + error.str);
+      }
+      initialized_ = true;
+    });
+}
+
+void
+SharedNodePublishers::publish_parameter_event(
+  const rcl_interfaces::msg::ParameterEvent & parameter_event)
+{
+  init_publishers();
+  rcl_ret_t ret = rcl_publish(&parameter_events_publisher_, &parameter_event, nullptr);
+  if (RCL_RET_OK != ret) {
+    rclcpp::exceptions::throw_from_rcl_error(ret, "failed to publish the parameter event");
+  }
+}
+
+void
+SharedNodePublishers::add_rosout_logger(const std::string & logger_name)
+{
+  auto & rosout_loggers = get_rosout_loggers();
+  std::lock_guard<std::mutex> lock(rosout_loggers.mutex);
+  auto & entry = rosout_loggers.loggers[logger_name];
+  entry.first = shared_from_this();
+  ++entry.second;
+  rosout_loggers.size = rosout_loggers.loggers.size();
+}
+
+void
+SharedNodePublishers::remove_rosout_logger(const std::string & logger_name)
+{
+  auto & rosout_loggers = get_rosout_loggers();
+  std::lock_guard<std::mutex> lock(rosout_loggers.mutex);
+  auto it = rosout_loggers.loggers.find(logger_name);
+  if (it != rosout_loggers.loggers.end() && --it->second.second == 0) {
+    rosout_loggers.loggers.erase(it);
+  }
+  rosout_loggers.size = rosout_loggers.loggers.size();
+}
+
+void
+SharedNodePublishers::publish_log(
+  const rcutils_log_location_t * location,
+  int severity, const char * name, rcutils_time_point_value_t timestamp,
+  const char * format, va_list * args)
+{
+  auto & rosout_loggers = get_rosout_loggers();
+  if (0 == rosout_loggers.size || g_publishing_log || nullptr == name) {
+    return;
+  }
+  g_publishing_log = true;
+  try {
+    auto shared_publishers = find_rosout_publishers(rosout_loggers, name);
+    if (shared_publishers) {
+      rcl_interfaces::msg::Log log;
+      log.stamp.sec = static_cast<int32_t>(RCL_NS_TO_S(timestamp));
+      log.stamp.nanosec = static_cast<uint32_t>(timestamp % (1000LL * 1000LL * 1000LL));
+      log.level = static_cast<uint8_t>(severity);
+      log.name = name;
+      va_list args_copy;
+      va_copy(args_copy, *args);
+      const int length = vsnprintf(nullptr, 0, format, args_copy);
+      va_end(args_copy);
+      if (length > 0) {
+        std::vector<char> buffer(static_cast<size_t>(length) + 1);
+        va_copy(args_copy, *args);
+        vsnprintf(buffer.data(), buffer.size(), format, args_copy);
+        va_end(args_copy);
+        log.msg.assign(buffer.data(), static_cast<size_t>(length));
+      }
+      if (location) {
+        log.file = location->file_name ? location->file_name : "";
+        log.function = location->function_name ? location->function_name : "";
+        log.line = static_cast<uint32_t>(location->line_number);
+      }
+      if (shared_publishers->rosout_batcher_) {
+        shared_publishers->rosout_batcher_->add(std::move(log));
+      } else {
+        shared_publishers->publish_rosout(log);
+      }
+    }
+  } catch (const std::exception & ex) {
+    RCUTILS_SAFE_FWRITE_TO_STDERR(ex.what());
+    RCUTILS_SAFE_FWRITE_TO_STDERR("\n");
+  }
+  g_publishing_log = false;
+}
+
+void
+SharedNodePublishers::publish_rosout(const rcl_interfaces::msg::Log & log)
+{
+  try {
+    init_publishers();
+  } catch (const std::exception & ex) {
+    RCUTILS_SAFE_FWRITE_TO_STDERR(ex.what());
+    RCUTILS_SAFE_FWRITE_TO_STDERR("\n");
+    return;
+  }
+  if (RCL_RET_OK != rcl_publish(&rosout_publisher_, &log, nullptr)) {
+    RCUTILS_SAFE_FWRITE_TO_STDERR("failed to publish the log message on /rosout: ");
+    RCUTILS_SAFE_FWRITE_TO_STDERR(rcl_get_error_string().str);
+    RCUTILS_SAFE_FWRITE_TO_STDERR("\n");
+    rcl_reset_error();
+  }
+}
@@ -0,0 +1,108 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__DETAIL__SHARED_NODE_PUBLISHERS_HPP_
+#define RCLCPP__DETAIL__SHARED_NODE_PUBLISHERS_HPP_
+
+#include <cstdarg>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "rcl/context.h"
+#include "rcl/node.h"
+#include "rcl/publisher.h"
+#include "rcl_interfaces/msg/log.hpp"
+#include "rcl_interfaces/msg/parameter_event.hpp"
+#include "rclcpp/detail/rosout_batcher.hpp"
+#include "rclcpp/rosout_batching.hpp"
+#include "rcutils/logging.h"
+#include "rcutils/time.h"
+
+namespace rclcpp
+{
+namespace detail
+{
+
+/// \internal Publishers of /rosout and /parameter_events shared by the nodes of a context.
+/**
+ * The publishers belong to a hidden node, created on the first publication, the messages keep
+ * the name of the node publishing them.
+ * It is a sub context of the context, see rclcpp::Context::get_sub_context(), and holds the rcl
+ * context only, so that it doesn't keep the context alive.
+ * The log messages are batched or rate limited according to the
+ * rclcpp::InitOptions::rosout_batching of the context.
+ */
+class SharedNodePublishers : public std::enable_shared_from_this<SharedNodePublishers>
+{
+public:
+  explicit SharedNodePublishers(
+    std::shared_ptr<rcl_context_t> rcl_context,
+    const rclcpp::RosoutBatchingOptions & rosout_batching = rclcpp::RosoutBatchingOptions());
+
+  ~SharedNodePublishers();
+
+  /// Publish the parameter event of a node on /parameter_events.
+  /**
+   * \throws rclcpp::exceptions::RCLError if the publishers can't be created or on a failed
+   *   publication.
+   */
+  void
+  publish_parameter_event(const rcl_interfaces::msg::ParameterEvent & parameter_event);
+
+  /// Publish the log messages of a logger, and of its child loggers, on /rosout.
+  /**
+   * A logger may be added many times, it is removed once remove_rosout_logger() is called as
+   * many times.
+   */
+  void
+  add_rosout_logger(const std::string & logger_name);
+
+  /// Stop publishing the log messages of a logger added with add_rosout_logger().
+  void
+  remove_rosout_logger(const std::string & logger_name);
+
+  /// Publish a log message, if its logger was added to the shared publishers of a context.
+  /**
+   * It is called by the rclcpp logging output handler, errors are written to stderr.
+   */
+  static void
+  publish_log(
+    const rcutils_log_location_t * location,
+    int severity, const char * name, rcutils_time_point_value_t timestamp,
+    const char * format, va_list * args);
+
+private:
+  /// Create the node and the publishers, the first time only.
+  void
+  init_publishers();
+
+  /// Publish a log message on /rosout, errors are written to stderr.
+  void
+  publish_rosout(const rcl_interfaces::msg::Log & log);
+
+  std::shared_ptr<rcl_context_t> rcl_context_;
+  std::once_flag init_flag_;
+  bool initialized_ = false;
+  rcl_node_t node_;
+  rcl_publisher_t parameter_events_publisher_;
+  rcl_publisher_t rosout_publisher_;
+  /// Null unless the log messages are batched or rate limited.
+  std::unique_ptr<RosoutBatcher> rosout_batcher_;
+};
+
+}  // namespace detail
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DETAIL__SHARED_NODE_PUBLISHERS_HPP_
@@ -0,0 +1,388 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/entity_handoff.hpp"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "rcl/error_handling.h"
+#include "rcl/remap.h"
+
+#include "rclcpp/qos.hpp"
+
+#include "./detail/entity_handoff.hpp"
+
+namespace rclcpp
+{
+namespace detail
+{
+
+/// \internal Entities of a node kept by an EntityHandoff.
+struct EntityHandoffState
+{
+  template<typename HandleT>
+  struct KeptEntity
+  {
+    std::shared_ptr<HandleT> handle;
+    rosidl_message_type_support_t type_support;
+  };
+
+  std::shared_ptr<rcl_node_t> node_handle;
+  rclcpp::Context::SharedPtr context;
+  bool node_taken = false;
+  std::vector<KeptEntity<rcl_publisher_t>> publishers;
+  std::vector<KeptEntity<rcl_subscription_t>> subscriptions;
+  size_t reused_entities = 0;
+};
+
+namespace
+{
+
+/// The nodes handed over, by rcl node handle, protected by handoffs_mutex.
+std::unordered_map<const rcl_node_t *, std::shared_ptr<EntityHandoffState>> &
+get_handoffs()
+{
+  static std::unordered_map<const rcl_node_t *, std::shared_ptr<EntityHandoffState>> handoffs;
+  return handoffs;
+}
+
+std::mutex handoffs_mutex;
+/// Number of handoffs, so the nodes not handed over don't lock handoffs_mutex.
+std::atomic<size_t> handoffs_count {0};
+
+/// Return the state of the handoff of the node, handoffs_mutex must be locked.
+EntityHandoffState *
+find_handoff(const rcl_node_t * node)
+{
+  auto & handoffs = get_handoffs();
+  auto it = handoffs.find(node);
+  return it == handoffs.end() ? nullptr : it->second.get();
+}
+
+bool
+same_type_support(
+  const rosidl_message_type_support_t & left, const rosidl_message_type_support_t & right)
+{
+  return left.typesupport_identifier == right.typesupport_identifier &&
+         left.data == right.data &&
+         left.func == right.func;
+}
+
+bool
+same_qos(const rmw_qos_profile_t & left, const rmw_qos_profile_t & right)
+{
+  return rclcpp::QoS(rclcpp::QoSInitialization::from_rmw(left), left) ==
+         rclcpp::QoS(rclcpp::QoSInitialization::from_rmw(right), right);
+}
+
+/// Resolve the topic name a publisher or subscription of the node would get.
+bool
+resolve_topic_name(
+  rclcpp::node_interfaces::NodeBaseInterface * node_base,
+  const std::string & topic_name,
+  std::string & resolved_name)
+{
+  try {
+    resolved_name = node_base->resolve_topic_or_service_name(topic_name, false);
+  } catch (const std::exception &) {
+    // The creation of the publisher or the subscription reports the invalid name
+    return false;
+  }
+  return true;
+}
+
+/// Return the remapped node name or namespace, the given one if no rule applies.
+template<typename RemapFunctionT>
+bool
+remap_node_name(
+  RemapFunctionT remap_function,
+  const rcl_node_options_t & rcl_node_options,
+  const rcl_arguments_t * global_arguments,
+  const std::string & node_name,
+  std::string & remapped)
+{
+  rcl_allocator_t allocator = rcl_node_options.allocator;
+  char * output = nullptr;
+  if (
+    RCL_RET_OK != remap_function(
+      &rcl_node_options.arguments, global_arguments, node_name.c_str(), allocator, &output))
+  {
+    rcl_reset_error();
+    return false;
+  }
+  if (nullptr != output) {
+    remapped = output;
+    allocator.deallocate(output, allocator.state);
+  }
+  return true;
+}
+
+}  // namespace
+
+bool
+is_handing_over_node(const rcl_node_t * node)
+{
+  if (0 == handoffs_count.load(std::memory_order_acquire)) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(handoffs_mutex);
+  return nullptr != find_handoff(node);
+}
+
+bool
+keep_handed_over_publisher(
+  const std::shared_ptr<rcl_publisher_t> & publisher,
+  const rcl_node_t * node,
+  const rosidl_message_type_support_t & type_support)
+{
+  if (0 == handoffs_count.load(std::memory_order_acquire)) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(handoffs_mutex);
+  EntityHandoffState * handoff = find_handoff(node);
+  if (nullptr == handoff || !rcl_publisher_is_valid(publisher.get())) {
+    rcl_reset_error();
+    return false;
+  }
+  handoff->publishers.push_back({publisher, type_support});
+  return true;
+}
+
+std::shared_ptr<rcl_publisher_t>
+take_handed_over_publisher(
+  rclcpp::node_interfaces::NodeBaseInterface * node_base,
+  const std::string & topic_name,
+  const rosidl_message_type_support_t & type_support,
+  const rcl_publisher_options_t & publisher_options)
+{
+  if (
+    0 == handoffs_count.load(std::memory_order_acquire) ||
+    !is_handing_over_node(node_base->get_rcl_node_handle()))
+  {
+    return nullptr;
+  }
+  std::string resolved_name;
+  if (!resolve_topic_name(node_base, topic_name, resolved_name)) {
+    return nullptr;
+  }
+
+  std::lock_guard<std::mutex> lock(handoffs_mutex);
+  EntityHandoffState * handoff = find_handoff(node_base->get_rcl_node_handle());
+  if (nullptr == handoff) {
+    return nullptr;
+  }
+  for (auto it = handoff->publishers.begin(); it != handoff->publishers.end(); ++it) {
+    const rcl_publisher_options_t * options = rcl_publisher_get_options(it->handle.get());
+    if (
+      resolved_name == rcl_publisher_get_topic_name(it->handle.get()) &&
+      same_type_support(type_support, it->type_support) &&
+      same_qos(publisher_options.qos, options->qos) &&
+      publisher_options.rmw_publisher_options.require_unique_network_flow_endpoints ==
+      options->rmw_publisher_options.require_unique_network_flow_endpoints)
+    {
+      auto publisher = std::move(it->handle);
+      handoff->publishers.erase(it);
+      ++handoff->reused_entities;
+      return publisher;
+    }
+  }
+  return nullptr;
+}
+
+bool
+keep_handed_over_subscription(
+  const std::shared_ptr<rcl_subscription_t> & subscription,
+  const rcl_node_t * node,
+  const rosidl_message_type_support_t & type_support)
+{
+  if (0 == handoffs_count.load(std::memory_order_acquire)) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(handoffs_mutex);
+  EntityHandoffState * handoff = find_handoff(node);
+  if (
+    nullptr == handoff || !rcl_subscription_is_valid(subscription.get()) ||
+    rcl_subscription_is_cft_enabled(subscription.get()))
+  {
+    rcl_reset_error();
+    return false;
+  }
+  handoff->subscriptions.push_back({subscription, type_support});
+  return true;
+}
+
+std::shared_ptr<rcl_subscription_t>
+take_handed_over_subscription(
+  rclcpp::node_interfaces::NodeBaseInterface * node_base,
+  const std::string & topic_name,
+  const rosidl_message_type_support_t & type_support,
+  const rcl_subscription_options_t & subscription_options)
+{
+  // The content filter of a kept subscription can't be changed
+  if (
+    0 == handoffs_count.load(std::memory_order_acquire) ||
+    nullptr != subscription_options.rmw_subscription_options.content_filter_options ||
+    !is_handing_over_node(node_base->get_rcl_node_handle()))
+  {
+    return nullptr;
+  }
+  std::string resolved_name;
+  if (!resolve_topic_name(node_base, topic_name, resolved_name)) {
+    return nullptr;
+  }
+
+  const auto & rmw_options = subscription_options.rmw_subscription_options;
+  std::lock_guard<std::mutex> lock(handoffs_mutex);
+  EntityHandoffState * handoff = find_handoff(node_base->get_rcl_node_handle());
+  if (nullptr == handoff) {
+    return nullptr;
+  }
+  for (auto it = handoff->subscriptions.begin(); it != handoff->subscriptions.end(); ++it) {
+    const rcl_subscription_options_t * options = rcl_subscription_get_options(it->handle.get());
+    if (
+      resolved_name == rcl_subscription_get_topic_name(it->handle.get()) &&
+      same_type_support(type_support, it->type_support) &&
+      same_qos(subscription_options.qos, options->qos) &&
+      rmw_options.ignore_local_publications ==
+      options->rmw_subscription_options.ignore_local_publications &&
+      rmw_options.require_unique_network_flow_endpoints ==
+      options->rmw_subscription_options.require_unique_network_flow_endpoints)
+    {
+      auto subscription = std::move(it->handle);
+      handoff->subscriptions.erase(it);
+      ++handoff->reused_entities;
+      return subscription;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace detail
+
+EntityHandoff::EntityHandoff(rclcpp::node_interfaces::NodeBaseInterface & node_base)
+: state_(std::make_shared<rclcpp::detail::EntityHandoffState>())
+{
+  state_->node_handle = node_base.get_shared_rcl_node_handle();
+  state_->context = node_base.get_context();
+
+  using rclcpp::detail::handoffs_mutex;
+  std::lock_guard<std::mutex> lock(handoffs_mutex);
+  auto inserted = rclcpp::detail::get_handoffs().emplace(state_->node_handle.get(), state_);
+  if (!inserted.second) {
+    throw std::invalid_argument(
+            std::string("the entities of the node '") + node_base.get_fully_qualified_name() +
+            "' are already handed over");
+  }
+  rclcpp::detail::handoffs_count.fetch_add(1, std::memory_order_release);
+}
+
+EntityHandoff::~EntityHandoff()
+{
+  finish();
+}
+
+void
+EntityHandoff::finish()
+{
+  // The entities are finalized once the lock is released
+  rclcpp::detail::EntityHandoffState state;
+  {
+    using rclcpp::detail::handoffs_mutex;
+    std::lock_guard<std::mutex> lock(handoffs_mutex);
+    if (!state_->node_handle) {
+      return;
+    }
+    rclcpp::detail::get_handoffs().erase(state_->node_handle.get());
+    rclcpp::detail::handoffs_count.fetch_sub(1, std::memory_order_release);
+    std::swap(state.publishers, state_->publishers);
+    std::swap(state.subscriptions, state_->subscriptions);
+    std::swap(state.node_handle, state_->node_handle);
+    std::swap(state.context, state_->context);
+  }
+}
+
+std::shared_ptr<rcl_node_t>
+EntityHandoff::take_node(
+  const rclcpp::Context::SharedPtr & context,
+  const std::string & node_name,
+  const std::string & namespace_,
+  const rcl_node_options_t & rcl_node_options)
+{
+  {
+    std::lock_guard<std::mutex> lock(rclcpp::detail::handoffs_mutex);
+    if (!state_->node_handle || state_->node_taken || context != state_->context) {
+      return nullptr;
+    }
+  }
+
+  // The name and namespace the new node gets, as rcl_node_init() computes them
+  const rcl_arguments_t * global_arguments = nullptr;
+  if (rcl_node_options.use_global_arguments) {
+    global_arguments = &context->get_rcl_context()->global_arguments;
+  }
+  std::string name = node_name;
+  std::string namespace_name = namespace_;
+  if (
+    !rclcpp::detail::remap_node_name(
+      rcl_remap_node_name, rcl_node_options, global_arguments, node_name, name) ||
+    !rclcpp::detail::remap_node_name(
+      rcl_remap_node_namespace, rcl_node_options, global_arguments, node_name, namespace_name))
+  {
+    return nullptr;
+  }
+  if (namespace_name.empty() || namespace_name.front() != '/') {
+    namespace_name = "/" + namespace_name;
+  }
+
+  std::lock_guard<std::mutex> lock(rclcpp::detail::handoffs_mutex);
+  if (
+    !state_->node_handle || state_->node_taken ||
+    name != rcl_node_get_name(state_->node_handle.get()) ||
+    namespace_name != rcl_node_get_namespace(state_->node_handle.get()))
+  {
+    return nullptr;
+  }
+  state_->node_taken = true;
+  return state_->node_handle;
+}
+
+size_t
+EntityHandoff::get_number_of_kept_publishers() const
+{
+  std::lock_guard<std::mutex> lock(rclcpp::detail::handoffs_mutex);
+  return state_->publishers.size();
+}
+
+size_t
+EntityHandoff::get_number_of_kept_subscriptions() const
+{
+  std::lock_guard<std::mutex> lock(rclcpp::detail::handoffs_mutex);
+  return state_->subscriptions.size();
+}
+
+size_t
+EntityHandoff::get_number_of_reused_entities() const
+{
+  std::lock_guard<std::mutex> lock(rclcpp::detail::handoffs_mutex);
+  return state_->reused_entities;
+}
+
+}  // namespace rclcpp
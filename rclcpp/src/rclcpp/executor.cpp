@@ -15,8 +15,11 @@
 #include <algorithm>
 #include <memory>
 #include <map>
+#include <optional>
 #include <string>
+#include <thread>
 #include <type_traits>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -24,8 +27,12 @@
 #include "rcl/error_handling.h"
 #include "rcpputils/scope_exit.hpp"
 
+#include "rclcpp/allocation_audit.hpp"
+#include "rclcpp/allocator/callback_arena.hpp"
 #include "rclcpp/exceptions.hpp"
 #include "rclcpp/executor.hpp"
+#include "rclcpp/experimental/subscription_intra_process_base.hpp"
+#include "rclcpp/flight_recorder.hpp"
 #include "rclcpp/guard_condition.hpp"
 #include "rclcpp/memory_strategy.hpp"
 #include "rclcpp/node.hpp"
@@ -35,6 +42,8 @@
 
 #include "tracetools/tracetools.h"
 
+#include "./detail/hardware_counter_reader.hpp"
+
 using namespace std::chrono_literals;
 
 using rclcpp::exceptions::throw_from_rcl_error;
@@ -43,15 +52,68 @@ using rclcpp::Executor;
 using rclcpp::ExecutorOptions;
 using rclcpp::FutureReturnCode;
 
+namespace
+{
+
+/// Number of dataflow successors being executed on this thread, nested in each other.
+thread_local size_t g_dataflow_chain_depth = 0;
+
+/// Executions of an entity or of a callback group during a call of spin_some_with_quotas().
+struct QuotaUsage
+{
+  size_t executions = 0;
+  std::chrono::nanoseconds time{0};
+
+  bool
+  reached(size_t max_executions, std::chrono::nanoseconds max_time) const
+  {
+    return (max_executions > 0 && executions >= max_executions) ||
+           (max_time > 0ns && time >= max_time);
+  }
+};
+
+/// Return the entity executed by an executable.
+const void *
+get_entity(const AnyExecutable & any_exec)
+{
+  if (any_exec.timer) {
+    return any_exec.timer.get();
+  } else if (any_exec.subscription) {
+    return any_exec.subscription.get();
+  } else if (any_exec.service) {
+    return any_exec.service.get();
+  } else if (any_exec.client) {
+    return any_exec.client.get();
+  }
+  return any_exec.waitable.get();
+}
+
+}  // namespace
+
 Executor::Executor(const rclcpp::ExecutorOptions & options)
 : spinning(false),
   interrupt_guard_condition_(options.context),
   shutdown_guard_condition_(std::make_shared<rclcpp::GuardCondition>(options.context)),
-  memory_strategy_(options.memory_strategy)
+  memory_strategy_(options.memory_strategy),
+  max_messages_per_take_(options.max_messages_per_take),
+  timer_dispatch_order_(options.timer_dispatch_order),
+  wake_on_future_complete_(options.wake_on_future_complete),
+  busy_poll_budget_(std::max(options.busy_poll_budget, std::chrono::nanoseconds::zero())),
+  current_busy_poll_budget_(busy_poll_budget_),
+  callback_arena_capacity_(options.callback_arena_capacity),
+  dataflow_chain_depth_(options.dataflow_chain_depth)
 {
+  if (!memory_strategy_->set_timer_dispatch_order(timer_dispatch_order_)) {
+    throw std::runtime_error("The memory strategy does not support the timer dispatch order.");
+  }
+
   // Store the context for later use.
   context_ = options.context;
 
+  // The interrupt guard condition is triggered after each executed callback, while a single
+  // wake up is needed per wait.
+  interrupt_guard_condition_.set_trigger_coalescing(true);
+
   shutdown_callback_handle_ = context_->add_on_shutdown_callback(
     [weak_gc = std::weak_ptr<rclcpp::GuardCondition>{shutdown_guard_condition_}]() {
       auto strong_gc = weak_gc.lock();
@@ -84,6 +146,7 @@ Executor::Executor(const rclcpp::ExecutorOptions & options)
 
 Executor::~Executor()
 {
+  shutdown_future_watcher();
   // Disassociate all callback groups.
   for (auto & pair : weak_groups_to_nodes_) {
     auto group = pair.first.lock();
@@ -214,6 +277,7 @@ Executor::add_callback_group_to_map(
   }
   // Also add to the map that contains all callback groups
   weak_groups_to_nodes_.insert(std::make_pair(weak_group_ptr, node_ptr));
+  entities_need_rebuild_ = true;
 
   if (node_ptr->get_context()->is_valid()) {
     auto callback_group_guard_condition =
@@ -293,6 +357,12 @@ Executor::remove_callback_group_from_map(
     }
     weak_groups_to_nodes.erase(iter);
     weak_groups_to_nodes_.erase(group_ptr);
+    entities_need_rebuild_ = true;
+    // Drop the executables of this group which were taken but not dispatched yet
+    prioritized_executables_.remove_if(
+      [&group_ptr](const PrioritizedExecutable & prioritized) {
+        return prioritized.executable->callback_group == group_ptr;
+      });
     std::atomic_bool & has_executor = group_ptr->get_associated_with_executor_atomic();
     has_executor.store(false);
   } else {
@@ -464,6 +534,132 @@ Executor::spin_some_impl(std::chrono::nanoseconds max_duration, bool exhaustive)
   }
 }
 
+void
+Executor::spin_some_with_quotas(const rclcpp::SpinQuotas & quotas)
+{
+  if (quotas.max_duration < 0ns || quotas.max_time_per_entity < 0ns ||
+    quotas.max_time_per_group < 0ns)
+  {
+    throw std::invalid_argument("the durations of the quotas must be greater than or equal to 0");
+  }
+  if (spinning.exchange(true)) {
+    throw std::runtime_error("spin_some_with_quotas() called while already spinning");
+  }
+  RCPPUTILS_SCOPE_EXIT(this->spinning.store(false); );
+
+  const auto start = std::chrono::steady_clock::now();
+  auto can_execute = [this, &quotas, start]() {
+      if (!spinning.load()) {
+        return false;
+      }
+      return 0ns == quotas.max_duration ||
+             std::chrono::steady_clock::now() - start < quotas.max_duration;
+    };
+  std::unordered_map<const void *, QuotaUsage> entity_usage;
+  std::unordered_map<const rclcpp::CallbackGroup *, QuotaUsage> group_usage;
+  // The callback group of an executable set aside is released, so that the other entities of
+  // the group can be executed meanwhile.
+  auto hold = [this](std::unique_ptr<AnyExecutable> any_exec) {
+      HeldExecutable held;
+      held.sequence = quota_hold_sequence_++;
+      held.callback_group = std::move(any_exec->callback_group);
+      held.callback_group->release();
+      held.executable = std::move(any_exec);
+      return held;
+    };
+  // What is left for the next call
+  std::vector<HeldExecutable> kept;
+  // The executables of entities which had their turn already, executed after the others
+  std::vector<HeldExecutable> deferred;
+  bool executed = false;
+  auto dispatch = [&](HeldExecutable held, bool defer_served) {
+      const void * entity = get_entity(*held.executable);
+      QuotaUsage & entity_quota_usage = entity_usage[entity];
+      QuotaUsage & group_quota_usage = group_usage[held.callback_group.get()];
+      if (
+        !can_execute() ||
+        entity_quota_usage.reached(quotas.max_executions_per_entity, quotas.max_time_per_entity) ||
+        group_quota_usage.reached(quotas.max_executions_per_group, quotas.max_time_per_group))
+      {
+        kept.push_back(std::move(held));
+        return;
+      }
+      if (defer_served && quota_served_entities_.count(entity) != 0) {
+        deferred.push_back(std::move(held));
+        return;
+      }
+      if (!held.callback_group->try_reserve()) {
+        kept.push_back(std::move(held));
+        return;
+      }
+      held.executable->callback_group = held.callback_group;
+      const auto execution_start = std::chrono::steady_clock::now();
+      execute_any_executable(*held.executable);
+      const auto elapsed = std::chrono::steady_clock::now() - execution_start;
+      ++entity_quota_usage.executions;
+      entity_quota_usage.time += elapsed;
+      ++group_quota_usage.executions;
+      group_quota_usage.time += elapsed;
+      quota_served_entities_.insert(entity);
+      executed = true;
+    };
+
+  // The work taken by the last call is dispatched first
+  std::vector<HeldExecutable> pending = std::move(quota_pending_executables_);
+  quota_pending_executables_.clear();
+  while (rclcpp::ok(context_) && can_execute()) {
+    executed = false;
+    for (HeldExecutable & held : pending) {
+      {
+        std::lock_guard<std::mutex> guard{mutex_};
+        rclcpp::CallbackGroup::WeakPtr weak_group_ptr = held.callback_group;
+        if (weak_groups_to_nodes_.find(weak_group_ptr) == weak_groups_to_nodes_.end()) {
+          // The callback group was removed from the executor meanwhile
+          continue;
+        }
+      }
+      dispatch(std::move(held), true);
+    }
+    pending.clear();
+    wait_for_work(std::chrono::milliseconds::zero());
+    while (can_execute()) {
+      auto any_exec = std::make_unique<AnyExecutable>();
+      if (!get_next_ready_executable(*any_exec)) {
+        break;
+      }
+      dispatch(hold(std::move(any_exec)), true);
+    }
+    if (!executed && !deferred.empty()) {
+      // Every ready entity had its turn, start the next turn
+      quota_served_entities_.clear();
+    }
+    std::vector<HeldExecutable> round_deferred = std::move(deferred);
+    deferred.clear();
+    for (HeldExecutable & held : round_deferred) {
+      dispatch(std::move(held), false);
+    }
+    if (!executed) {
+      break;
+    }
+  }
+  for (HeldExecutable & held : pending) {
+    kept.push_back(std::move(held));
+  }
+
+  // The work of the timers and of the waitables was taken with them, it is kept for the next
+  // call in the order it was taken, the other entities are ready again in the next wait.
+  for (HeldExecutable & held : kept) {
+    if (held.executable->timer || held.executable->waitable) {
+      quota_pending_executables_.push_back(std::move(held));
+    }
+  }
+  std::sort(
+    quota_pending_executables_.begin(), quota_pending_executables_.end(),
+    [](const HeldExecutable & a, const HeldExecutable & b) {
+      return a.sequence < b.sequence;
+    });
+}
+
 void
 Executor::spin_once_impl(std::chrono::nanoseconds timeout)
 {
@@ -501,8 +697,94 @@ Executor::set_memory_strategy(rclcpp::memory_strategy::MemoryStrategy::SharedPtr
   if (memory_strategy == nullptr) {
     throw std::runtime_error("Received NULL memory strategy in executor.");
   }
+  if (!memory_strategy->set_timer_dispatch_order(timer_dispatch_order_)) {
+    throw std::runtime_error("The memory strategy does not support the timer dispatch order.");
+  }
   std::lock_guard<std::mutex> guard{mutex_};
   memory_strategy_ = memory_strategy;
+  entities_need_rebuild_ = true;
+}
+
+void
+Executor::start_future_watcher(
+  std::function<bool(std::chrono::nanoseconds)> wait_for_future,
+  std::chrono::nanoseconds timeout)
+{
+  const auto now = std::chrono::steady_clock::now();
+  // A timeout reaching past the latest time point is waited forever instead of overflowing.
+  const bool forever = timeout < std::chrono::nanoseconds::zero() ||
+    timeout >= std::chrono::steady_clock::time_point::max() - now;
+  std::lock_guard<std::mutex> lock(future_watcher_mutex_);
+  watched_future_ = std::move(wait_for_future);
+  watched_future_forever_ = forever;
+  watched_future_end_time_ = forever ? now : now + timeout;
+  future_watcher_running_.store(true);
+  if (!future_watcher_.joinable()) {
+    future_watcher_ = std::thread([this]() {run_future_watcher();});
+  }
+  future_watcher_cv_.notify_one();
+}
+
+void
+Executor::stop_future_watcher()
+{
+  future_watcher_running_.store(false);
+  // The watcher holds the mutex while it waits on the future, which the caller is about to
+  // destroy: once locked, the future is not used anymore.
+  std::lock_guard<std::mutex> lock(future_watcher_mutex_);
+  watched_future_ = nullptr;
+}
+
+void
+Executor::shutdown_future_watcher()
+{
+  {
+    std::lock_guard<std::mutex> lock(future_watcher_mutex_);
+    future_watcher_shutdown_ = true;
+    future_watcher_running_.store(false);
+  }
+  future_watcher_cv_.notify_one();
+  if (future_watcher_.joinable()) {
+    future_watcher_.join();
+  }
+}
+
+void
+Executor::run_future_watcher()
+{
+  std::unique_lock<std::mutex> lock(future_watcher_mutex_);
+  while (true) {
+    future_watcher_cv_.wait(
+      lock, [this]() {return future_watcher_shutdown_ || watched_future_;});
+    if (future_watcher_shutdown_) {
+      return;
+    }
+    // The future can't notify when it's completed: wait on it in slices, so that the
+    // thread notices when spinning ends before the future is ready.
+    bool ready = false;
+    while (!ready && future_watcher_running_.load()) {
+      std::chrono::nanoseconds wait_slice = std::chrono::milliseconds(10);
+      if (!watched_future_forever_) {
+        auto time_left = std::chrono::duration_cast<std::chrono::nanoseconds>(
+          watched_future_end_time_ - std::chrono::steady_clock::now());
+        if (time_left <= std::chrono::nanoseconds::zero()) {
+          break;
+        }
+        wait_slice = std::min(wait_slice, time_left);
+      }
+      ready = watched_future_(wait_slice);
+    }
+    watched_future_ = nullptr;
+    if (ready) {
+      try {
+        interrupt_guard_condition_.trigger();
+      } catch (const rclcpp::exceptions::RCLError & ex) {
+        RCLCPP_ERROR(
+          rclcpp::get_logger("rclcpp"),
+          "Failed to trigger guard condition on future completion: %s", ex.what());
+      }
+    }
+  }
 }
 
 void
@@ -511,6 +793,46 @@ Executor::execute_any_executable(AnyExecutable & any_exec)
   if (!spinning.load()) {
     return;
   }
+  // Ended before the dataflow successors, which account their own execution time
+  std::optional<rclcpp::ExecutorTimeAccounting::Scope> execute_scope;
+  execute_scope.emplace(
+    time_accounting_enabled_.load() ? &time_accounting_ : nullptr,
+    rclcpp::ExecutorActivity::Execute);
+  std::optional<rclcpp::allocator::CallbackArenaScope> arena_scope;
+  if (callback_arena_capacity_ > 0) {
+    arena_scope.emplace(callback_arena_capacity_);
+  }
+  std::optional<rclcpp::AllocationAudit::Scope> audit_scope;
+  if (rclcpp::AllocationAudit::is_enabled()) {
+    if (any_exec.timer) {
+      audit_scope.emplace(any_exec.timer.get(), rclcpp::AllocationSite::Timer);
+    } else if (any_exec.subscription) {
+      audit_scope.emplace(any_exec.subscription.get(), rclcpp::AllocationSite::Subscription);
+    } else if (any_exec.service) {
+      audit_scope.emplace(any_exec.service.get(), rclcpp::AllocationSite::Service);
+    } else if (any_exec.client) {
+      audit_scope.emplace(any_exec.client.get(), rclcpp::AllocationSite::Client);
+    } else {
+      audit_scope.emplace(any_exec.waitable.get(), rclcpp::AllocationSite::Waitable);
+    }
+  }
+  // The intra-process subscriptions fed by the callback are recorded to be executed after it
+  std::vector<const rclcpp::Waitable *> deliveries;
+  std::optional<rclcpp::experimental::IntraProcessDeliveryScope> delivery_scope;
+  if (g_dataflow_chain_depth < dataflow_chain_depth_) {
+    delivery_scope.emplace(deliveries);
+  }
+  const bool collect_statistics = callback_statistics_enabled_.load();
+  std::optional<rclcpp::detail::HardwareCounterReader::Measurement> counters_measurement;
+  if (collect_statistics && hardware_counters_enabled_.load()) {
+    counters_measurement.emplace(rclcpp::detail::HardwareCounterReader::get_thread_reader());
+  }
+  std::chrono::steady_clock::time_point start_time;
+  if (collect_statistics) {
+    start_time = std::chrono::steady_clock::now();
+  }
+  const void * entity = get_entity(any_exec);
+  rclcpp::FlightRecorder::record(rclcpp::FlightRecorderEventType::CallbackStart, entity);
   if (any_exec.timer) {
     TRACEPOINT(
       rclcpp_executor_execute,
@@ -521,7 +843,7 @@ Executor::execute_any_executable(AnyExecutable & any_exec)
     TRACEPOINT(
       rclcpp_executor_execute,
       static_cast<const void *>(any_exec.subscription->get_subscription_handle().get()));
-    execute_subscription(any_exec.subscription);
+    execute_subscription(any_exec.subscription, max_messages_per_take_);
   }
   if (any_exec.service) {
     execute_service(any_exec.service);
@@ -532,8 +854,26 @@ Executor::execute_any_executable(AnyExecutable & any_exec)
   if (any_exec.waitable) {
     any_exec.waitable->execute(any_exec.data);
   }
+  rclcpp::FlightRecorder::record(rclcpp::FlightRecorderEventType::CallbackEnd, entity);
+  if (collect_statistics) {
+    const auto end_time = std::chrono::steady_clock::now();
+    if (counters_measurement) {
+      const rclcpp::HardwareCounters counters = counters_measurement->stop();
+      record_callback_statistics(any_exec, start_time, end_time, &counters);
+    } else {
+      record_callback_statistics(any_exec, start_time, end_time);
+    }
+  }
+  audit_scope.reset();
+  // The memory of the callback isn't used anymore
+  arena_scope.reset();
+  delivery_scope.reset();
   // Reset the callback_group, regardless of type
-  any_exec.callback_group->can_be_taken_from().store(true);
+  any_exec.callback_group->release();
+  execute_scope.reset();
+  if (!deliveries.empty()) {
+    execute_dataflow_successors(deliveries);
+  }
   // Wake the wait, because it may need to be recalculated or work that
   // was previously blocked is now available.
   try {
@@ -545,8 +885,281 @@ Executor::execute_any_executable(AnyExecutable & any_exec)
   }
 }
 
-static
 void
+Executor::execute_dataflow_successors(const std::vector<const rclcpp::Waitable *> & deliveries)
+{
+  g_dataflow_chain_depth++;
+  RCPPUTILS_SCOPE_EXIT(g_dataflow_chain_depth--; );
+  for (const rclcpp::Waitable * delivery : deliveries) {
+    AnyExecutable any_exec;
+    if (!spinning.load() || !take_dataflow_successor(delivery, any_exec)) {
+      continue;
+    }
+    execute_any_executable(any_exec);
+    // Clear the callback_group to prevent the AnyExecutable destructor from
+    // resetting the callback group `can_be_taken_from`
+    any_exec.callback_group.reset();
+  }
+}
+
+bool
+Executor::take_dataflow_successor(
+  const rclcpp::Waitable * waitable,
+  AnyExecutable & any_executable)
+{
+  std::lock_guard<std::mutex> guard{mutex_};
+  auto it = dataflow_successors_.find(waitable);
+  if (it == dataflow_successors_.end() && !dataflow_successors_complete_) {
+    collect_dataflow_successors();
+    it = dataflow_successors_.find(waitable);
+  }
+  if (it == dataflow_successors_.end()) {
+    // An entity of another executor
+    return false;
+  }
+  auto shared_waitable = it->second.waitable.lock();
+  auto callback_group = it->second.callback_group.lock();
+  auto node_base = it->second.node_base.lock();
+  if (!shared_waitable || shared_waitable.get() != waitable || !callback_group || !node_base) {
+    dataflow_successors_.erase(it);
+    return false;
+  }
+  if (weak_groups_to_nodes_.find(it->second.callback_group) == weak_groups_to_nodes_.end()) {
+    // The callback group was removed from the executor
+    return false;
+  }
+  if (!callback_group->try_reserve()) {
+    // Executed by the executor once the group is released
+    return false;
+  }
+  auto data = shared_waitable->take_data();
+  if (!data) {
+    // Another thread took the messages meanwhile
+    callback_group->release();
+    return false;
+  }
+  any_executable.waitable = std::move(shared_waitable);
+  any_executable.callback_group = std::move(callback_group);
+  any_executable.node_base = std::move(node_base);
+  any_executable.data = std::move(data);
+  any_executable.ready_time = std::chrono::steady_clock::now();
+  return true;
+}
+
+void
+Executor::collect_dataflow_successors()
+{
+  dataflow_successors_.clear();
+  for (const auto & pair : weak_groups_to_nodes_) {
+    auto group = pair.first.lock();
+    if (!group || pair.second.expired()) {
+      continue;
+    }
+    group->find_waitable_ptrs_if(
+      [this, &pair](const rclcpp::Waitable::SharedPtr & waitable) {
+        if (dynamic_cast<rclcpp::experimental::SubscriptionIntraProcessBase *>(waitable.get())) {
+          dataflow_successors_[waitable.get()] = {waitable, pair.first, pair.second};
+        }
+        return false;
+      });
+  }
+  dataflow_successors_complete_ = true;
+}
+
+void
+Executor::record_callback_statistics(
+  const AnyExecutable & any_exec,
+  std::chrono::steady_clock::time_point start_time,
+  std::chrono::steady_clock::time_point end_time,
+  const rclcpp::HardwareCounters * hardware_counters)
+{
+  const void * entity = nullptr;
+  rclcpp::CallbackKind kind = rclcpp::CallbackKind::Waitable;
+  const char * name = nullptr;
+  if (any_exec.timer) {
+    entity = any_exec.timer.get();
+    kind = rclcpp::CallbackKind::Timer;
+  } else if (any_exec.subscription) {
+    entity = any_exec.subscription.get();
+    kind = rclcpp::CallbackKind::Subscription;
+    name = any_exec.subscription->get_topic_name();
+  } else if (any_exec.service) {
+    entity = any_exec.service.get();
+    kind = rclcpp::CallbackKind::Service;
+    name = any_exec.service->get_service_name();
+  } else if (any_exec.client) {
+    entity = any_exec.client.get();
+    kind = rclcpp::CallbackKind::Client;
+    name = any_exec.client->get_service_name();
+  } else if (any_exec.waitable) {
+    entity = any_exec.waitable.get();
+  } else {
+    return;
+  }
+  // A negative delay is ignored by the histograms, in case the ready time is unknown
+  std::chrono::nanoseconds ready_delay(-1);
+  if (any_exec.ready_time != std::chrono::steady_clock::time_point()) {
+    ready_delay = start_time - any_exec.ready_time;
+  }
+  callback_statistics_.record(
+    any_exec.callback_group.get(), entity, kind, name, ready_delay, end_time - start_time,
+    hardware_counters);
+}
+
+void
+Executor::set_callback_statistics_enabled(bool enabled)
+{
+  callback_statistics_enabled_.store(enabled);
+}
+
+bool
+Executor::get_callback_statistics_enabled() const
+{
+  return callback_statistics_enabled_.load();
+}
+
+std::vector<rclcpp::CallbackStatistics>
+Executor::get_callback_statistics() const
+{
+  return callback_statistics_.get_statistics();
+}
+
+void
+Executor::reset_callback_statistics()
+{
+  callback_statistics_.reset();
+}
+
+void
+Executor::set_hardware_counters_enabled(bool enabled)
+{
+  hardware_counters_enabled_.store(enabled);
+}
+
+bool
+Executor::get_hardware_counters_enabled() const
+{
+  return hardware_counters_enabled_.load();
+}
+
+rclcpp::ExecutorTimeAccounting::Scope
+Executor::account_time(rclcpp::ExecutorActivity activity)
+{
+  return rclcpp::ExecutorTimeAccounting::Scope(
+    time_accounting_enabled_.load() ? &time_accounting_ : nullptr, activity);
+}
+
+void
+Executor::set_time_accounting_enabled(bool enabled)
+{
+  time_accounting_enabled_.store(enabled);
+}
+
+bool
+Executor::get_time_accounting_enabled() const
+{
+  return time_accounting_enabled_.load();
+}
+
+std::vector<rclcpp::ExecutorThreadTimes>
+Executor::get_thread_times() const
+{
+  return time_accounting_.get_thread_times();
+}
+
+void
+Executor::reset_thread_times()
+{
+  time_accounting_.reset();
+}
+
+rclcpp::ExecutorSnapshot
+Executor::get_introspection_snapshot() const
+{
+  rclcpp::ExecutorSnapshot snapshot;
+  std::vector<const void *> ready_handles;
+  std::vector<std::pair<rclcpp::CallbackGroup::SharedPtr,
+    rclcpp::node_interfaces::NodeBaseInterface::SharedPtr>> groups;
+  {
+    std::lock_guard<std::mutex> guard{mutex_};
+    snapshot.ready_states_valid = handles_are_ready_;
+    if (handles_are_ready_) {
+      memory_strategy_->get_ready_handles(ready_handles);
+    }
+    for (const auto & pair : weak_groups_to_nodes_) {
+      auto group = pair.first.lock();
+      auto node = pair.second.lock();
+      if (group && node) {
+        groups.emplace_back(std::move(group), std::move(node));
+      }
+    }
+  }
+  snapshot.time = std::chrono::steady_clock::now();
+  snapshot.spinning = spinning.load();
+
+  // The entities are inspected without holding the lock of the executor
+  std::sort(ready_handles.begin(), ready_handles.end());
+  auto is_ready = [&ready_handles](const void * handle) {
+      return handle && std::binary_search(ready_handles.begin(), ready_handles.end(), handle);
+    };
+  std::map<std::string, size_t> groups_per_node;
+  std::map<std::string, size_t> timers_per_node;
+  for (const auto & [group, node] : groups) {
+    const std::string node_name = node->get_fully_qualified_name();
+    const size_t group_index = snapshot.callback_groups.size();
+    rclcpp::ExecutorSnapshot::CallbackGroupState group_state;
+    group_state.node_name = node_name;
+    group_state.index = groups_per_node[node_name]++;
+    group_state.type = group->type();
+    group_state.busy = group->type() == rclcpp::CallbackGroupType::MutuallyExclusive &&
+      !group->can_be_taken_from().load();
+    group_state.priority = group->get_priority();
+    snapshot.callback_groups.push_back(std::move(group_state));
+
+    group->collect_all_ptrs(
+      [&](const rclcpp::SubscriptionBase::SharedPtr & subscription) {
+        rclcpp::ExecutorSnapshot::SubscriptionState state;
+        state.node_name = node_name;
+        state.topic_name = subscription->get_topic_name();
+        state.callback_group = group_index;
+        state.paused = subscription->is_paused();
+        state.ready = is_ready(subscription->get_subscription_handle().get()) ||
+        is_ready(subscription->get_intra_process_waitable().get()) ||
+        is_ready(subscription->get_deserialization_waitable().get());
+        auto metrics = subscription->get_intra_process_buffer_metrics();
+        if (metrics) {
+          state.intra_process = true;
+          state.intra_process_depth = metrics->depth;
+          state.intra_process_capacity = metrics->capacity;
+          state.intra_process_dropped = metrics->dropped_count;
+        }
+        snapshot.subscriptions.push_back(std::move(state));
+      },
+      [](const rclcpp::ServiceBase::SharedPtr &) {},
+      [](const rclcpp::ClientBase::SharedPtr &) {},
+      [&](const rclcpp::TimerBase::SharedPtr & timer) {
+        rclcpp::ExecutorSnapshot::TimerState state;
+        state.node_name = node_name;
+        state.index = timers_per_node[node_name]++;
+        state.callback_group = group_index;
+        state.period = timer->get_period();
+        state.canceled = timer->is_canceled();
+        state.ready = is_ready(timer->get_timer_handle().get());
+        if (!state.canceled) {
+          const auto time_until_trigger = timer->time_until_trigger();
+          if (time_until_trigger < std::chrono::nanoseconds::zero()) {
+            state.overdue = -time_until_trigger;
+          }
+        }
+        snapshot.timers.push_back(std::move(state));
+      },
+      [](const rclcpp::Waitable::SharedPtr &) {});
+  }
+  return snapshot;
+}
+
+static
+bool
 take_and_do_error_handling(
   const char * action_description,
   const char * topic_or_service_name,
@@ -579,75 +1192,143 @@ take_and_do_error_handling(
       action_description,
       topic_or_service_name);
   }
+  return taken;
 }
 
-void
-Executor::execute_subscription(rclcpp::SubscriptionBase::SharedPtr subscription)
+// Take and handle at most max_messages messages of the subscription, whatever its own maximum.
+static
+size_t
+take_and_execute_messages(
+  const rclcpp::SubscriptionBase::SharedPtr & subscription,
+  size_t max_messages)
 {
-  rclcpp::MessageInfo message_info;
-  message_info.get_rmw_message_info().from_intra_process = false;
-
-  if (subscription->is_serialized()) {
-    // This is the case where a copy of the serialized message is taken from
-    // the middleware via inter-process communication.
-    std::shared_ptr<SerializedMessage> serialized_msg = subscription->create_serialized_message();
-    take_and_do_error_handling(
-      "taking a serialized message from topic",
-      subscription->get_topic_name(),
-      [&]() {return subscription->take_serialized(*serialized_msg.get(), message_info);},
-      [&]()
-      {
-        subscription->handle_serialized_message(serialized_msg, message_info);
-      });
-    subscription->return_serialized_message(serialized_msg);
-  } else if (subscription->can_loan_messages()) {
-    // This is the case where a loaned message is taken from the middleware via
-    // inter-process communication, given to the user for their callback,
-    // and then returned.
-    void * loaned_msg = nullptr;
-    // TODO(wjwwood): refactor this into methods on subscription when LoanedMessage
-    //   is extened to support subscriptions as well.
-    take_and_do_error_handling(
-      "taking a loaned message from topic",
+  if (subscription->is_paused()) {
+    subscription->drop_paused_messages(max_messages);
+    return 0;
+  }
+  if (subscription->get_prefetch_depth() > 0) {
+    // The next messages are taken by the thread pool while the callbacks run
+    bool taken = take_and_do_error_handling(
+      "taking and prefetching messages from topic",
       subscription->get_topic_name(),
-      [&]()
-      {
-        rcl_ret_t ret = rcl_take_loaned_message(
+      [&]() {return subscription->take_and_prefetch();},
+      []() {});
+    return taken ? 1 : 0;
+  }
+
+  // Keep taking until the maximum is reached or nothing could be taken, i.e. the queue of the
+  // subscription is empty, without going through a wait set in between.
+  size_t taken_count = 0;
+  bool taken = true;
+  while (taken && taken_count < max_messages) {
+    rclcpp::MessageInfo message_info;
+    message_info.get_rmw_message_info().from_intra_process = false;
+
+    if (subscription->is_serialized()) {
+      // This is the case where a copy of the serialized message is taken from
+      // the middleware via inter-process communication.
+      std::shared_ptr<SerializedMessage> serialized_msg =
+        subscription->create_serialized_message();
+      taken = take_and_do_error_handling(
+        "taking a serialized message from topic",
+        subscription->get_topic_name(),
+        [&]() {return subscription->take_serialized(*serialized_msg.get(), message_info);},
+        [&]()
+        {
+          subscription->handle_serialized_message(serialized_msg, message_info);
+        });
+      subscription->return_serialized_message(serialized_msg);
+    } else if (subscription->can_loan_messages()) {
+      // This is the case where a loaned message is taken from the middleware via
+      // inter-process communication, given to the user for their callback,
+      // and then returned, unless the subscription keeps it for the user.
+      void * loaned_msg = nullptr;
+      bool dropped = false;
+      taken = take_and_do_error_handling(
+        "taking a loaned message from topic",
+        subscription->get_topic_name(),
+        [&]()
+        {
+          rcl_ret_t ret = rcl_take_loaned_message(
+            subscription->get_subscription_handle().get(),
+            &loaned_msg,
+            &message_info.get_rmw_message_info(),
+            nullptr);
+          if (RCL_RET_SUBSCRIPTION_TAKE_FAILED == ret) {
+            return false;
+          } else if (RCL_RET_OK != ret) {
+            rclcpp::exceptions::throw_from_rcl_error(ret);
+          }
+          return true;
+        },
+        [&]()
+        {
+          // The loaned messages are dropped after the take, returning the loan
+          dropped =
+            subscription->drop_by_age(message_info) ||
+            subscription->drop_by_content_filter(loaned_msg) ||
+            subscription->drop_by_rate_limit();
+          if (!dropped) {
+            subscription->handle_loaned_message(loaned_msg, message_info);
+          }
+        });
+      if (nullptr != loaned_msg && (dropped || !subscription->keeps_loaned_messages())) {
+        rcl_ret_t ret = rcl_return_loaned_message_from_subscription(
           subscription->get_subscription_handle().get(),
-          &loaned_msg,
-          &message_info.get_rmw_message_info(),
-          nullptr);
-        if (RCL_RET_SUBSCRIPTION_TAKE_FAILED == ret) {
-          return false;
-        } else if (RCL_RET_OK != ret) {
-          rclcpp::exceptions::throw_from_rcl_error(ret);
+          loaned_msg);
+        if (RCL_RET_OK != ret) {
+          RCLCPP_ERROR(
+            rclcpp::get_logger("rclcpp"),
+            "rcl_return_loaned_message_from_subscription() failed for subscription on topic "
+            "'%s': %s",
+            subscription->get_topic_name(), rcl_get_error_string().str);
         }
-        return true;
-      },
-      [&]() {subscription->handle_loaned_message(loaned_msg, message_info);});
-    if (nullptr != loaned_msg) {
-      rcl_ret_t ret = rcl_return_loaned_message_from_subscription(
-        subscription->get_subscription_handle().get(),
-        loaned_msg);
-      if (RCL_RET_OK != ret) {
-        RCLCPP_ERROR(
-          rclcpp::get_logger("rclcpp"),
-          "rcl_return_loaned_message_from_subscription() failed for subscription on topic '%s': %s",
-          subscription->get_topic_name(), rcl_get_error_string().str);
+        loaned_msg = nullptr;
       }
-      loaned_msg = nullptr;
+    } else {
+      // This case is taking a copy of the message data from the middleware via
+      // inter-process communication.
+      std::shared_ptr<void> message = subscription->create_message();
+      // The middleware doesn't fill the message info if nothing uses it
+      const bool needs_message_info = subscription->needs_message_info();
+      taken = take_and_do_error_handling(
+        "taking a message from topic",
+        subscription->get_topic_name(),
+        [&]()
+        {
+          if (needs_message_info) {
+            return subscription->take_type_erased(message.get(), message_info);
+          }
+          return subscription->take_type_erased_without_info(message.get());
+        },
+        [&]() {subscription->handle_message(message, message_info);});
+      subscription->return_message(message);
     }
-  } else {
-    // This case is taking a copy of the message data from the middleware via
-    // inter-process communication.
-    std::shared_ptr<void> message = subscription->create_message();
-    take_and_do_error_handling(
-      "taking a message from topic",
-      subscription->get_topic_name(),
-      [&]() {return subscription->take_type_erased(message.get(), message_info);},
-      [&]() {subscription->handle_message(message, message_info);});
-    subscription->return_message(message);
+
+    if (taken) {
+      taken_count++;
+    }
+  }
+  return taken_count;
+}
+
+void
+Executor::execute_subscription(rclcpp::SubscriptionBase::SharedPtr subscription)
+{
+  // A single message, even if the subscription takes more at once, e.g. for one event of it
+  take_and_execute_messages(subscription, 1);
+}
+
+size_t
+Executor::execute_subscription(
+  rclcpp::SubscriptionBase::SharedPtr subscription,
+  size_t default_max_messages_per_take)
+{
+  size_t max_messages = subscription->get_max_messages_per_take();
+  if (0 == max_messages) {
+    max_messages = std::max<size_t>(default_max_messages_per_take, 1);
   }
+  return take_and_execute_messages(subscription, max_messages);
 }
 
 void
@@ -686,7 +1367,9 @@ Executor::wait_for_work(std::chrono::nanoseconds timeout)
 {
   TRACEPOINT(rclcpp_executor_wait_for_work, timeout.count());
   {
+    auto collect_scope = account_time(rclcpp::ExecutorActivity::Collect);
     std::lock_guard<std::mutex> guard(mutex_);
+    handles_are_ready_ = false;
 
     // Check weak_nodes_ to find any callback group that is not owned
     // by an executor and add it to the list of callbackgroups for
@@ -694,41 +1377,58 @@ Executor::wait_for_work(std::chrono::nanoseconds timeout)
     // allowed to add to another executor
     add_callback_groups_from_nodes_associated_to_executor();
 
-    // Collect the subscriptions and timers to be waited on
-    memory_strategy_->clear_handles();
-    bool has_invalid_weak_groups_or_nodes =
-      memory_strategy_->collect_entities(weak_groups_to_nodes_);
-
-    if (has_invalid_weak_groups_or_nodes) {
-      std::vector<rclcpp::CallbackGroup::WeakPtr> invalid_group_ptrs;
-      for (auto pair : weak_groups_to_nodes_) {
-        auto weak_group_ptr = pair.first;
-        auto weak_node_ptr = pair.second;
-        if (weak_group_ptr.expired() || weak_node_ptr.expired()) {
-          invalid_group_ptrs.push_back(weak_group_ptr);
+    // A mutually exclusive group which is being executed is skipped when collecting entities,
+    // so entities can only be reused while all the groups can be taken from.
+    bool all_groups_can_be_taken_from = std::all_of(
+      weak_groups_to_nodes_.begin(), weak_groups_to_nodes_.end(),
+      [](const WeakCallbackGroupsToNodesMap::value_type & pair) {
+        auto group = pair.first.lock();
+        return !group || group->can_be_taken_from().load();
+      });
+
+    // Reuse the subscriptions and timers collected for the previous wait if nothing changed
+    bool need_collection = entities_need_rebuild_ || !all_groups_can_be_taken_from ||
+      !memory_strategy_->restore_collected_entities();
+    if (need_collection) {
+      memory_strategy_->clear_handles();
+      bool has_invalid_weak_groups_or_nodes =
+        memory_strategy_->collect_entities(weak_groups_to_nodes_);
+
+      if (has_invalid_weak_groups_or_nodes) {
+        std::vector<rclcpp::CallbackGroup::WeakPtr> invalid_group_ptrs;
+        for (auto pair : weak_groups_to_nodes_) {
+          auto weak_group_ptr = pair.first;
+          auto weak_node_ptr = pair.second;
+          if (weak_group_ptr.expired() || weak_node_ptr.expired()) {
+            invalid_group_ptrs.push_back(weak_group_ptr);
+          }
         }
+        std::for_each(
+          invalid_group_ptrs.begin(), invalid_group_ptrs.end(),
+          [this](rclcpp::CallbackGroup::WeakPtr group_ptr) {
+            if (weak_groups_to_nodes_associated_with_executor_.find(group_ptr) !=
+            weak_groups_to_nodes_associated_with_executor_.end())
+            {
+              weak_groups_to_nodes_associated_with_executor_.erase(group_ptr);
+            }
+            if (weak_groups_associated_with_executor_to_nodes_.find(group_ptr) !=
+            weak_groups_associated_with_executor_to_nodes_.end())
+            {
+              weak_groups_associated_with_executor_to_nodes_.erase(group_ptr);
+            }
+            auto callback_guard_pair = weak_groups_to_guard_conditions_.find(group_ptr);
+            if (callback_guard_pair != weak_groups_to_guard_conditions_.end()) {
+              auto guard_condition = callback_guard_pair->second;
+              weak_groups_to_guard_conditions_.erase(group_ptr);
+              memory_strategy_->remove_guard_condition(guard_condition);
+            }
+            weak_groups_to_nodes_.erase(group_ptr);
+          });
       }
-      std::for_each(
-        invalid_group_ptrs.begin(), invalid_group_ptrs.end(),
-        [this](rclcpp::CallbackGroup::WeakPtr group_ptr) {
-          if (weak_groups_to_nodes_associated_with_executor_.find(group_ptr) !=
-          weak_groups_to_nodes_associated_with_executor_.end())
-          {
-            weak_groups_to_nodes_associated_with_executor_.erase(group_ptr);
-          }
-          if (weak_groups_associated_with_executor_to_nodes_.find(group_ptr) !=
-          weak_groups_associated_with_executor_to_nodes_.end())
-          {
-            weak_groups_associated_with_executor_to_nodes_.erase(group_ptr);
-          }
-          auto callback_guard_pair = weak_groups_to_guard_conditions_.find(group_ptr);
-          if (callback_guard_pair != weak_groups_to_guard_conditions_.end()) {
-            auto guard_condition = callback_guard_pair->second;
-            weak_groups_to_guard_conditions_.erase(group_ptr);
-            memory_strategy_->remove_guard_condition(guard_condition);
-          }
-          weak_groups_to_nodes_.erase(group_ptr);
-        });
+      // The collection missed the entities of the groups which could not be taken from
+      entities_need_rebuild_ = !all_groups_can_be_taken_from;
+      // Subscriptions may have been added since the dataflow successors were found
+      dataflow_successors_complete_ = false;
     }
 
     // clear wait set
@@ -738,13 +1438,27 @@ Executor::wait_for_work(std::chrono::nanoseconds timeout)
     }
 
     // The size of waitables are accounted for in size of the other entities
-    ret = rcl_wait_set_resize(
-      &wait_set_, memory_strategy_->number_of_ready_subscriptions(),
-      memory_strategy_->number_of_guard_conditions(), memory_strategy_->number_of_ready_timers(),
-      memory_strategy_->number_of_ready_clients(), memory_strategy_->number_of_ready_services(),
-      memory_strategy_->number_of_ready_events());
-    if (RCL_RET_OK != ret) {
-      throw_from_rcl_error(ret, "Couldn't resize the wait set");
+    size_t number_of_subscriptions = memory_strategy_->number_of_ready_subscriptions();
+    size_t number_of_guard_conditions = memory_strategy_->number_of_guard_conditions();
+    size_t number_of_timers = memory_strategy_->number_of_ready_timers();
+    size_t number_of_clients = memory_strategy_->number_of_ready_clients();
+    size_t number_of_services = memory_strategy_->number_of_ready_services();
+    size_t number_of_events = memory_strategy_->number_of_ready_events();
+    // Resizing reallocates the storage of the wait set, only do it if the sizes changed
+    if (
+      wait_set_.size_of_subscriptions != number_of_subscriptions ||
+      wait_set_.size_of_guard_conditions != number_of_guard_conditions ||
+      wait_set_.size_of_timers != number_of_timers ||
+      wait_set_.size_of_clients != number_of_clients ||
+      wait_set_.size_of_services != number_of_services ||
+      wait_set_.size_of_events != number_of_events)
+    {
+      ret = rcl_wait_set_resize(
+        &wait_set_, number_of_subscriptions, number_of_guard_conditions, number_of_timers,
+        number_of_clients, number_of_services, number_of_events);
+      if (RCL_RET_OK != ret) {
+        throw_from_rcl_error(ret, "Couldn't resize the wait set");
+      }
     }
 
     if (!memory_strategy_->add_handles_to_wait_set(&wait_set_)) {
@@ -752,8 +1466,20 @@ Executor::wait_for_work(std::chrono::nanoseconds timeout)
     }
   }
 
-  rcl_ret_t status =
-    rcl_wait(&wait_set_, std::chrono::duration_cast<std::chrono::nanoseconds>(timeout).count());
+  rcl_ret_t status = RCL_RET_TIMEOUT;
+  {
+    auto wait_scope = account_time(rclcpp::ExecutorActivity::Wait);
+    rclcpp::FlightRecorder::record(rclcpp::FlightRecorderEventType::WaitStart);
+    if (busy_poll_budget_ > std::chrono::nanoseconds::zero() &&
+      timeout != std::chrono::nanoseconds::zero())
+    {
+      status = busy_poll_wait_set(timeout);
+    } else {
+      status = rcl_wait(
+        &wait_set_, std::chrono::duration_cast<std::chrono::nanoseconds>(timeout).count());
+    }
+    rclcpp::FlightRecorder::record(rclcpp::FlightRecorderEventType::WaitEnd, nullptr, status);
+  }
   if (status == RCL_RET_WAIT_SET_EMPTY) {
     RCUTILS_LOG_WARN_NAMED(
       "rclcpp",
@@ -765,8 +1491,105 @@ Executor::wait_for_work(std::chrono::nanoseconds timeout)
 
   // check the null handles in the wait set and remove them from the handles in memory strategy
   // for callback-based entities
+  auto collect_scope = account_time(rclcpp::ExecutorActivity::Collect);
   std::lock_guard<std::mutex> guard(mutex_);
+  last_wait_time_ = std::chrono::steady_clock::now();
   memory_strategy_->remove_null_handles(&wait_set_);
+  handles_are_ready_ = true;
+
+  // A triggered notify guard condition of a callback group means that entities were added to it
+  if (!entities_need_rebuild_) {
+    for (size_t i = 0; i < wait_set_.size_of_guard_conditions; ++i) {
+      const rcl_guard_condition_t * triggered = wait_set_.guard_conditions[i];
+      if (!triggered) {
+        continue;
+      }
+      for (const auto & pair : weak_groups_to_guard_conditions_) {
+        if (&pair.second->get_rcl_guard_condition() == triggered) {
+          entities_need_rebuild_ = true;
+          break;
+        }
+      }
+      if (entities_need_rebuild_) {
+        break;
+      }
+    }
+  }
+}
+
+rcl_ret_t
+Executor::busy_poll_wait_set(std::chrono::nanoseconds timeout)
+{
+  // Number of polls after which the polling thread yields between polls
+  constexpr size_t polls_before_yield = 64;
+
+  const auto start_time = std::chrono::steady_clock::now();
+  std::chrono::nanoseconds poll_budget = current_busy_poll_budget_;
+  if (timeout > std::chrono::nanoseconds::zero()) {
+    poll_budget = std::min(poll_budget, timeout);
+  }
+
+  rcl_ret_t status = RCL_RET_TIMEOUT;
+  for (size_t polls = 0; ; ++polls) {
+    status = rcl_wait(&wait_set_, 0);
+    if (status != RCL_RET_TIMEOUT) {
+      break;
+    }
+    if (std::chrono::steady_clock::now() - start_time >= poll_budget) {
+      break;
+    }
+    // The wait set only keeps the ready entities, put all the entities back for the next poll
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      refill_wait_set();
+    }
+    if (polls >= polls_before_yield) {
+      std::this_thread::yield();
+    }
+  }
+
+  if (status != RCL_RET_TIMEOUT) {
+    // Polling paid off, poll with the whole budget next time
+    current_busy_poll_budget_ = busy_poll_budget_;
+    return status;
+  }
+
+  // Nothing became ready while polling, back off so that an idle executor doesn't keep
+  // burning cpu time, but not below a fraction of the budget to be able to recover.
+  current_busy_poll_budget_ = std::max(current_busy_poll_budget_ / 2, busy_poll_budget_ / 16);
+
+  std::chrono::nanoseconds blocking_timeout = timeout;
+  if (timeout > std::chrono::nanoseconds::zero()) {
+    blocking_timeout = timeout - (std::chrono::steady_clock::now() - start_time);
+    if (blocking_timeout <= std::chrono::nanoseconds::zero()) {
+      return status;
+    }
+  }
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    refill_wait_set();
+  }
+  const auto blocking_start_time = std::chrono::steady_clock::now();
+  status = rcl_wait(&wait_set_, blocking_timeout.count());
+  if (status == RCL_RET_OK &&
+    std::chrono::steady_clock::now() - blocking_start_time < busy_poll_budget_)
+  {
+    // Work came in shortly after polling stopped, a longer polling would have caught it
+    current_busy_poll_budget_ = std::min(current_busy_poll_budget_ * 2, busy_poll_budget_);
+  }
+  return status;
+}
+
+void
+Executor::refill_wait_set()
+{
+  rcl_ret_t ret = rcl_wait_set_clear(&wait_set_);
+  if (ret != RCL_RET_OK) {
+    throw_from_rcl_error(ret, "Couldn't clear wait set");
+  }
+  if (!memory_strategy_->add_handles_to_wait_set(&wait_set_)) {
+    throw std::runtime_error("Couldn't fill wait set");
+  }
 }
 
 rclcpp::node_interfaces::NodeBaseInterface::SharedPtr
@@ -824,6 +1647,7 @@ Executor::get_group_by_timer(rclcpp::TimerBase::SharedPtr timer)
 bool
 Executor::get_next_ready_executable(AnyExecutable & any_executable)
 {
+  auto select_scope = account_time(rclcpp::ExecutorActivity::Select);
   bool success = get_next_ready_executable_from_map(any_executable, weak_groups_to_nodes_);
   return success;
 }
@@ -835,8 +1659,66 @@ Executor::get_next_ready_executable_from_map(
   weak_groups_to_nodes)
 {
   TRACEPOINT(rclcpp_executor_get_next_ready);
-  bool success = false;
   std::lock_guard<std::mutex> guard{mutex_};
+  bool use_priorities = !prioritized_executables_.empty() || std::any_of(
+    weak_groups_to_nodes.begin(), weak_groups_to_nodes.end(),
+    [](const WeakCallbackGroupsToNodesMap::value_type & pair) {
+      auto group = pair.first.lock();
+      return group && group->get_priority() != 0;
+    });
+  if (!use_priorities) {
+    return take_next_ready_executable(any_executable, weak_groups_to_nodes);
+  }
+
+  // Take everything that is ready, so that the work of the callback groups with the highest
+  // priority can be dispatched first, whatever the type of the entities.
+  auto now = std::chrono::steady_clock::now();
+  while (true) {
+    auto executable = std::make_unique<AnyExecutable>();
+    if (!take_next_ready_executable(*executable, weak_groups_to_nodes)) {
+      break;
+    }
+    int priority = executable->callback_group ? executable->callback_group->get_priority() : 0;
+    prioritized_executables_.push_back({std::move(executable), priority, now, false});
+  }
+
+  while (!prioritized_executables_.empty()) {
+    // The first executable with the highest priority, to keep the order of types among equals
+    auto best = std::max_element(
+      prioritized_executables_.begin(), prioritized_executables_.end(),
+      [](const PrioritizedExecutable & a, const PrioritizedExecutable & b) {
+        return a.priority < b.priority;
+      });
+    PrioritizedExecutable prioritized = std::move(*best);
+    prioritized_executables_.erase(best);
+    // The callback group might have been removed since the executable was taken,
+    // in that case the executable is dropped and its callback group released.
+    rclcpp::CallbackGroup::WeakPtr weak_group_ptr = prioritized.executable->callback_group;
+    if (weak_groups_to_nodes.find(weak_group_ptr) == weak_groups_to_nodes.end()) {
+      continue;
+    }
+    for (auto & other : prioritized_executables_) {
+      if (other.priority < prioritized.priority) {
+        other.starved = true;
+      }
+    }
+    prioritized.executable->callback_group->record_dispatch(
+      std::chrono::steady_clock::now() - prioritized.ready_time, prioritized.starved);
+    any_executable = *prioritized.executable;
+    // The callback group now belongs to any_executable, don't let the destructor release it.
+    prioritized.executable->callback_group.reset();
+    return true;
+  }
+  return false;
+}
+
+bool
+Executor::take_next_ready_executable(
+  AnyExecutable & any_executable,
+  const rclcpp::memory_strategy::MemoryStrategy::WeakCallbackGroupsToNodesMap &
+  weak_groups_to_nodes)
+{
+  bool success = false;
   // Check the timers to see if there are any that are ready
   memory_strategy_->get_next_timer(any_executable, weak_groups_to_nodes);
   if (any_executable.timer) {
@@ -882,18 +1764,17 @@ Executor::get_next_ready_executable_from_map(
   }
 
   if (success) {
-    // If it is valid, check to see if the group is mutually exclusive or
-    // not, then mark it accordingly ..Check if the callback_group belongs to this executor
+    // The memory strategies reserve mutually exclusive callback groups with a compare and swap
+    // when taking their entities, reserve the group here for the ones which only check it.
+    // The reservation is released either when the any_executable is executed or when the
+    // any_executable is destructed
     if (any_executable.callback_group && any_executable.callback_group->type() == \
-      CallbackGroupType::MutuallyExclusive)
+      CallbackGroupType::MutuallyExclusive &&
+      any_executable.callback_group->can_be_taken_from().load())
     {
-      // It should not have been taken otherwise
-      assert(any_executable.callback_group->can_be_taken_from().load());
-      // Set to false to indicate something is being run from this group
-      // This is reset to true either when the any_executable is executed or when the
-      // any_executable is destructued
-      any_executable.callback_group->can_be_taken_from().store(false);
+      any_executable.callback_group->try_reserve();
     }
+    any_executable.ready_time = last_wait_time_;
   }
   // If there is no ready executable, return false
   return success;
@@ -903,6 +1784,12 @@ bool
 Executor::get_next_executable(AnyExecutable & any_executable, std::chrono::nanoseconds timeout)
 {
   bool success = false;
+  // Before dispatching work of low priority callback groups, poll the middleware without
+  // blocking, so that work of higher priority callback groups which became ready meanwhile
+  // is dispatched first.
+  if (higher_priority_work_may_be_pending()) {
+    wait_for_work(std::chrono::nanoseconds(0));
+  }
   // Check to see if there are any subscriptions or timers needing service
   // TODO(wjwwood): improve run to run efficiency of this function
   success = get_next_ready_executable(any_executable);
@@ -919,6 +1806,25 @@ Executor::get_next_executable(AnyExecutable & any_executable, std::chrono::nanos
   return success;
 }
 
+bool
+Executor::higher_priority_work_may_be_pending()
+{
+  std::lock_guard<std::mutex> guard{mutex_};
+  if (prioritized_executables_.empty()) {
+    return false;
+  }
+  int highest_taken_priority = prioritized_executables_.front().priority;
+  for (const auto & prioritized : prioritized_executables_) {
+    highest_taken_priority = std::max(highest_taken_priority, prioritized.priority);
+  }
+  return std::any_of(
+    weak_groups_to_nodes_.begin(), weak_groups_to_nodes_.end(),
+    [highest_taken_priority](const WeakCallbackGroupsToNodesMap::value_type & pair) {
+      auto group = pair.first.lock();
+      return group && group->get_priority() > highest_taken_priority;
+    });
+}
+
 // Returns true iff the weak_groups_to_nodes map has node_ptr as the value in any of its entry.
 bool
 Executor::has_node(
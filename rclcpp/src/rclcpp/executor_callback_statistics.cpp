@@ -0,0 +1,275 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/executor_callback_statistics.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using rclcpp::CallbackStatistics;
+using rclcpp::ExecutorCallbackStatistics;
+using rclcpp::HardwareCounters;
+using rclcpp::LatencyHistogram;
+
+namespace
+{
+
+/// Number of significant bits of the value, i.e. the index of its bucket.
+size_t
+bit_width(uint64_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return value == 0 ? 0 : 64 - static_cast<size_t>(__builtin_clzll(value));
+#else
+  size_t width = 0;
+  while (value != 0) {
+    value >>= 1;
+    ++width;
+  }
+  return width;
+#endif
+}
+
+}  // namespace
+
+constexpr size_t LatencyHistogram::NUMBER_OF_BUCKETS;
+
+void
+LatencyHistogram::record(std::chrono::nanoseconds duration)
+{
+  const int64_t value = duration.count();
+  if (value < 0) {
+    return;
+  }
+  buckets_[bit_width(static_cast<uint64_t>(value))]++;
+  if (count_ == 0 || value < min_) {
+    min_ = value;
+  }
+  if (count_ == 0 || value > max_) {
+    max_ = value;
+  }
+  count_++;
+  sum_ += value;
+}
+
+void
+LatencyHistogram::merge(const LatencyHistogram & other)
+{
+  if (other.count_ == 0) {
+    return;
+  }
+  for (size_t i = 0; i < NUMBER_OF_BUCKETS; ++i) {
+    buckets_[i] += other.buckets_[i];
+  }
+  min_ = count_ == 0 ? other.min_ : std::min(min_, other.min_);
+  max_ = count_ == 0 ? other.max_ : std::max(max_, other.max_);
+  count_ += other.count_;
+  sum_ += other.sum_;
+}
+
+uint64_t
+LatencyHistogram::count() const
+{
+  return count_;
+}
+
+uint64_t
+LatencyHistogram::bucket_count(size_t bucket) const
+{
+  return bucket < NUMBER_OF_BUCKETS ? buckets_[bucket] : 0;
+}
+
+std::chrono::nanoseconds
+LatencyHistogram::bucket_upper_bound(size_t bucket)
+{
+  if (bucket >= NUMBER_OF_BUCKETS - 1) {
+    return std::chrono::nanoseconds::max();
+  }
+  return std::chrono::nanoseconds(int64_t(1) << bucket);
+}
+
+std::chrono::nanoseconds
+LatencyHistogram::min() const
+{
+  return std::chrono::nanoseconds(min_);
+}
+
+std::chrono::nanoseconds
+LatencyHistogram::max() const
+{
+  return std::chrono::nanoseconds(max_);
+}
+
+std::chrono::nanoseconds
+LatencyHistogram::mean() const
+{
+  return std::chrono::nanoseconds(count_ == 0 ? 0 : sum_ / static_cast<int64_t>(count_));
+}
+
+std::chrono::nanoseconds
+LatencyHistogram::percentile(double percentile) const
+{
+  if (count_ == 0) {
+    return std::chrono::nanoseconds::zero();
+  }
+  percentile = std::min(std::max(percentile, 0.0), 100.0);
+  const uint64_t rank = std::max<uint64_t>(
+    1, static_cast<uint64_t>(std::ceil(percentile / 100.0 * static_cast<double>(count_))));
+  uint64_t accumulated = 0;
+  for (size_t i = 0; i < NUMBER_OF_BUCKETS; ++i) {
+    accumulated += buckets_[i];
+    if (accumulated >= rank) {
+      return std::min(bucket_upper_bound(i), max());
+    }
+  }
+  return max();
+}
+
+void
+HardwareCounters::merge(const HardwareCounters & other)
+{
+  count += other.count;
+  instructions += other.instructions;
+  cycles += other.cycles;
+  cache_misses += other.cache_misses;
+  context_switches += other.context_switches;
+}
+
+struct ExecutorCallbackStatistics::ThreadStatistics
+{
+  using Key = std::pair<const void *, const void *>;
+
+  struct KeyHash
+  {
+    size_t operator()(const Key & key) const
+    {
+      return std::hash<const void *>()(key.first) ^ (std::hash<const void *>()(key.second) << 1);
+    }
+  };
+
+  std::mutex mutex;
+  std::unordered_map<Key, CallbackStatistics, KeyHash> callbacks;
+};
+
+ExecutorCallbackStatistics::ExecutorCallbackStatistics()
+: id_([]() {
+      static std::atomic<uint64_t> next_id{0};
+      return next_id++;
+    } ())
+{}
+
+ExecutorCallbackStatistics::~ExecutorCallbackStatistics() {}
+
+ExecutorCallbackStatistics::ThreadStatistics &
+ExecutorCallbackStatistics::get_thread_statistics()
+{
+  // Statistics of the calling thread for each ExecutorCallbackStatistics object
+  thread_local std::unordered_map<uint64_t, std::weak_ptr<ThreadStatistics>> per_owner;
+  auto it = per_owner.find(id_);
+  if (it != per_owner.end()) {
+    auto thread_statistics = it->second.lock();
+    if (thread_statistics) {
+      // Still owned by this object, which is alive as it's calling.
+      return *thread_statistics;
+    }
+  }
+
+  // Drop the statistics of the objects which were destroyed
+  for (auto owner_it = per_owner.begin(); owner_it != per_owner.end(); ) {
+    if (owner_it->second.expired()) {
+      owner_it = per_owner.erase(owner_it);
+    } else {
+      ++owner_it;
+    }
+  }
+  auto thread_statistics = std::make_shared<ThreadStatistics>();
+  per_owner[id_] = thread_statistics;
+  std::lock_guard<std::mutex> lock(threads_mutex_);
+  threads_.push_back(thread_statistics);
+  return *thread_statistics;
+}
+
+void
+ExecutorCallbackStatistics::record(
+  const void * callback_group,
+  const void * entity,
+  CallbackKind kind,
+  const char * name,
+  std::chrono::nanoseconds ready_delay,
+  std::chrono::nanoseconds execution_time,
+  const HardwareCounters * hardware_counters)
+{
+  ThreadStatistics & thread_statistics = get_thread_statistics();
+  std::lock_guard<std::mutex> lock(thread_statistics.mutex);
+  auto insert_info = thread_statistics.callbacks.emplace(
+    std::make_pair(callback_group, entity), CallbackStatistics());
+  CallbackStatistics & statistics = insert_info.first->second;
+  if (insert_info.second) {
+    statistics.callback_group = callback_group;
+    statistics.entity = entity;
+    statistics.kind = kind;
+    if (name) {
+      statistics.name = name;
+    }
+  }
+  statistics.ready_delay.record(ready_delay);
+  statistics.execution_time.record(execution_time);
+  if (hardware_counters) {
+    statistics.hardware_counters.merge(*hardware_counters);
+  }
+}
+
+std::vector<CallbackStatistics>
+ExecutorCallbackStatistics::get_statistics() const
+{
+  // Merge the statistics of all the threads, keeping a stable order
+  std::map<ThreadStatistics::Key, CallbackStatistics> merged;
+  std::lock_guard<std::mutex> lock(threads_mutex_);
+  for (const auto & thread_statistics : threads_) {
+    std::lock_guard<std::mutex> thread_lock(thread_statistics->mutex);
+    for (const auto & pair : thread_statistics->callbacks) {
+      auto insert_info = merged.emplace(pair.first, pair.second);
+      if (!insert_info.second) {
+        insert_info.first->second.execution_time.merge(pair.second.execution_time);
+        insert_info.first->second.ready_delay.merge(pair.second.ready_delay);
+        insert_info.first->second.hardware_counters.merge(pair.second.hardware_counters);
+      }
+    }
+  }
+  std::vector<CallbackStatistics> result;
+  result.reserve(merged.size());
+  for (auto & pair : merged) {
+    result.push_back(std::move(pair.second));
+  }
+  return result;
+}
+
+void
+ExecutorCallbackStatistics::reset()
+{
+  std::lock_guard<std::mutex> lock(threads_mutex_);
+  for (const auto & thread_statistics : threads_) {
+    std::lock_guard<std::mutex> thread_lock(thread_statistics->mutex);
+    thread_statistics->callbacks.clear();
+  }
+}
@@ -0,0 +1,117 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/executor_state_publisher.hpp"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "libstatistics_collector/collector/generate_statistics_message.hpp"
+#include "libstatistics_collector/moving_average_statistics/types.hpp"
+
+using libstatistics_collector::collector::GenerateStatisticMessage;
+using libstatistics_collector::moving_average_statistics::StatisticData;
+using rclcpp::ExecutorStatePublisher;
+using statistics_msgs::msg::MetricsMessage;
+
+namespace
+{
+constexpr const char kBooleanUnitName[] = "boolean";
+constexpr const char kMessagesUnitName[] = "messages";
+constexpr const char kNanosecondsUnitName[] = "ns";
+
+StatisticData
+single_sample(double value, double max)
+{
+  StatisticData data;
+  data.average = value;
+  data.min = value;
+  data.max = max;
+  data.standard_deviation = 0.0;
+  data.sample_count = 1;
+  return data;
+}
+}  // namespace
+
+ExecutorStatePublisher::~ExecutorStatePublisher()
+{
+  if (timer_) {
+    timer_->cancel();
+  }
+}
+
+void
+ExecutorStatePublisher::publish()
+{
+  for (const auto & message : generate_messages()) {
+    publisher_->publish(message);
+  }
+}
+
+std::vector<MetricsMessage>
+ExecutorStatePublisher::generate_messages()
+{
+  return generate_messages(executor_.get_introspection_snapshot());
+}
+
+std::vector<MetricsMessage>
+ExecutorStatePublisher::generate_messages(const rclcpp::ExecutorSnapshot & snapshot)
+{
+  const rclcpp::Time window_end = now();
+  std::vector<MetricsMessage> messages;
+  auto add_message = [&](
+    const std::string & node_name, const std::string & metric, const char * unit,
+    const StatisticData & data)
+    {
+      messages.push_back(
+        GenerateStatisticMessage(node_name, metric, unit, window_start_, window_end, data));
+    };
+  for (const auto & group : snapshot.callback_groups) {
+    const double busy = group.busy ? 1.0 : 0.0;
+    add_message(
+      group.node_name, "callback_group/" + std::to_string(group.index) + "/busy",
+      kBooleanUnitName, single_sample(busy, busy));
+  }
+  for (const auto & subscription : snapshot.subscriptions) {
+    const double ready = subscription.ready ? 1.0 : 0.0;
+    add_message(
+      subscription.node_name, "subscription" + subscription.topic_name + "/ready",
+      kBooleanUnitName, single_sample(ready, ready));
+    if (subscription.intra_process) {
+      add_message(
+        subscription.node_name,
+        "subscription" + subscription.topic_name + "/intra_process_depth", kMessagesUnitName,
+        single_sample(
+          static_cast<double>(subscription.intra_process_depth),
+          static_cast<double>(subscription.intra_process_capacity)));
+    }
+  }
+  for (const auto & timer : snapshot.timers) {
+    const double overdue = static_cast<double>(timer.overdue.count());
+    add_message(
+      timer.node_name, "timer/" + std::to_string(timer.index) + "/overdue",
+      kNanosecondsUnitName, single_sample(overdue, overdue));
+  }
+  window_start_ = window_end;
+  return messages;
+}
+
+rclcpp::Time
+ExecutorStatePublisher::now()
+{
+  return rclcpp::Time(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count());
+}
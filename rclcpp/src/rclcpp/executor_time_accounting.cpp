@@ -0,0 +1,176 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/executor_time_accounting.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using rclcpp::ExecutorActivity;
+using rclcpp::ExecutorActivityTime;
+using rclcpp::ExecutorThreadTimes;
+using rclcpp::ExecutorTimeAccounting;
+
+namespace
+{
+constexpr size_t number_of_activities = static_cast<size_t>(ExecutorActivity::Idle) + 1;
+}  // namespace
+
+const ExecutorActivityTime &
+ExecutorThreadTimes::get(ExecutorActivity activity) const
+{
+  switch (activity) {
+    case ExecutorActivity::Collect:
+      return collect;
+    case ExecutorActivity::Wait:
+      return wait;
+    case ExecutorActivity::Select:
+      return select;
+    case ExecutorActivity::Execute:
+      return execute;
+    case ExecutorActivity::Idle:
+    default:
+      return idle;
+  }
+}
+
+std::chrono::nanoseconds
+ExecutorThreadTimes::total() const
+{
+  return collect.duration + wait.duration + select.duration + execute.duration + idle.duration;
+}
+
+double
+ExecutorThreadTimes::utilization() const
+{
+  const std::chrono::nanoseconds total_time = total();
+  if (total_time <= std::chrono::nanoseconds::zero()) {
+    return 0.0;
+  }
+  const std::chrono::nanoseconds busy_time = total_time - wait.duration - idle.duration;
+  return static_cast<double>(busy_time.count()) / static_cast<double>(total_time.count());
+}
+
+ExecutorTimeAccounting::Scope::Scope(
+  ExecutorTimeAccounting * accounting, ExecutorActivity activity)
+: accounting_(accounting), activity_(activity)
+{
+  if (accounting_) {
+    start_time_ = std::chrono::steady_clock::now();
+  }
+}
+
+ExecutorTimeAccounting::Scope::~Scope()
+{
+  if (accounting_) {
+    accounting_->record(activity_, std::chrono::steady_clock::now() - start_time_);
+  }
+}
+
+struct ExecutorTimeAccounting::ThreadTimes
+{
+  std::thread::id thread_id = std::this_thread::get_id();
+  std::array<std::atomic<int64_t>, number_of_activities> durations{};
+  std::array<std::atomic<uint64_t>, number_of_activities> counts{};
+};
+
+ExecutorTimeAccounting::ExecutorTimeAccounting()
+: id_([]() {
+      static std::atomic<uint64_t> next_id{0};
+      return next_id++;
+    } ())
+{}
+
+ExecutorTimeAccounting::~ExecutorTimeAccounting() {}
+
+ExecutorTimeAccounting::ThreadTimes &
+ExecutorTimeAccounting::get_thread_times_of_this_thread()
+{
+  // Counters of the calling thread for each ExecutorTimeAccounting object
+  thread_local std::unordered_map<uint64_t, std::weak_ptr<ThreadTimes>> per_owner;
+  auto it = per_owner.find(id_);
+  if (it != per_owner.end()) {
+    auto thread_times = it->second.lock();
+    if (thread_times) {
+      // Still owned by this object, which is alive as it's calling.
+      return *thread_times;
+    }
+  }
+
+  // Drop the counters of the objects which were destroyed
+  for (auto owner_it = per_owner.begin(); owner_it != per_owner.end(); ) {
+    if (owner_it->second.expired()) {
+      owner_it = per_owner.erase(owner_it);
+    } else {
+      ++owner_it;
+    }
+  }
+  auto thread_times = std::make_shared<ThreadTimes>();
+  per_owner[id_] = thread_times;
+  std::lock_guard<std::mutex> lock(threads_mutex_);
+  threads_.push_back(thread_times);
+  return *thread_times;
+}
+
+void
+ExecutorTimeAccounting::record(ExecutorActivity activity, std::chrono::nanoseconds duration)
+{
+  const size_t index = static_cast<size_t>(activity);
+  if (index >= number_of_activities || duration < std::chrono::nanoseconds::zero()) {
+    return;
+  }
+  ThreadTimes & thread_times = get_thread_times_of_this_thread();
+  thread_times.durations[index].fetch_add(duration.count(), std::memory_order_relaxed);
+  thread_times.counts[index].fetch_add(1, std::memory_order_relaxed);
+}
+
+std::vector<ExecutorThreadTimes>
+ExecutorTimeAccounting::get_thread_times() const
+{
+  std::lock_guard<std::mutex> lock(threads_mutex_);
+  std::vector<ExecutorThreadTimes> result;
+  result.reserve(threads_.size());
+  for (const auto & thread_times : threads_) {
+    ExecutorThreadTimes times;
+    times.thread_id = thread_times->thread_id;
+    ExecutorActivityTime * activity_times[number_of_activities] = {
+      &times.collect, &times.wait, &times.select, &times.execute, &times.idle};
+    for (size_t i = 0; i < number_of_activities; ++i) {
+      activity_times[i]->duration =
+        std::chrono::nanoseconds(thread_times->durations[i].load(std::memory_order_relaxed));
+      activity_times[i]->count = thread_times->counts[i].load(std::memory_order_relaxed);
+    }
+    result.push_back(times);
+  }
+  return result;
+}
+
+void
+ExecutorTimeAccounting::reset()
+{
+  std::lock_guard<std::mutex> lock(threads_mutex_);
+  for (const auto & thread_times : threads_) {
+    for (size_t i = 0; i < number_of_activities; ++i) {
+      thread_times->durations[i].store(0, std::memory_order_relaxed);
+      thread_times->counts[i].store(0, std::memory_order_relaxed);
+    }
+  }
+}
@@ -0,0 +1,478 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/executors/dag_executor.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "rcpputils/scope_exit.hpp"
+
+#include "rclcpp/any_executable.hpp"
+#include "rclcpp/utilities.hpp"
+
+using rclcpp::executors::DagExecutor;
+using rclcpp::executors::DagPipeline;
+
+DagPipeline::DagPipeline(const std::string & name)
+: name_(name)
+{}
+
+void
+DagPipeline::add_stage(
+  const std::string & name,
+  StageCallback callback,
+  const std::vector<std::string> & dependencies)
+{
+  add_stage_impl({name, std::move(callback), dependencies, {}, {}});
+}
+
+void
+DagPipeline::add_stage_with_topics(
+  const std::string & name,
+  StageCallback callback,
+  const std::vector<std::string> & input_topics,
+  const std::vector<std::string> & output_topics)
+{
+  add_stage_impl({name, std::move(callback), {}, input_topics, output_topics});
+}
+
+void
+DagPipeline::add_stage_impl(Stage stage)
+{
+  if (!stage.callback) {
+    throw std::invalid_argument(
+            "stage '" + stage.name + "' of pipeline '" + name_ + "' has no callback");
+  }
+  for (const auto & existing : stages_) {
+    if (existing.name == stage.name) {
+      throw std::invalid_argument(
+              "pipeline '" + name_ + "' already has a stage named '" + stage.name + "'");
+    }
+  }
+  stages_.push_back(std::move(stage));
+}
+
+void
+DagPipeline::set_trigger(rclcpp::TimerBase::SharedPtr timer)
+{
+  trigger_timer_ = timer;
+  trigger_subscription_.reset();
+}
+
+void
+DagPipeline::set_trigger(rclcpp::SubscriptionBase::SharedPtr subscription)
+{
+  trigger_subscription_ = subscription;
+  trigger_timer_.reset();
+}
+
+const std::string &
+DagPipeline::get_name() const
+{
+  return name_;
+}
+
+size_t
+DagPipeline::get_number_of_stages() const
+{
+  return stages_.size();
+}
+
+std::vector<std::string>
+DagPipeline::get_topological_order() const
+{
+  std::vector<std::vector<size_t>> dependencies;
+  std::vector<std::string> names;
+  for (size_t index : sort_stages(dependencies)) {
+    names.push_back(stages_[index].name);
+  }
+  return names;
+}
+
+std::vector<size_t>
+DagPipeline::sort_stages(std::vector<std::vector<size_t>> & dependencies) const
+{
+  std::unordered_map<std::string, size_t> stage_indices;
+  std::unordered_map<std::string, std::vector<size_t>> producers;
+  for (size_t i = 0; i < stages_.size(); ++i) {
+    stage_indices[stages_[i].name] = i;
+    for (const auto & topic : stages_[i].output_topics) {
+      producers[topic].push_back(i);
+    }
+  }
+
+  dependencies.assign(stages_.size(), {});
+  std::vector<std::vector<size_t>> successors(stages_.size());
+  for (size_t i = 0; i < stages_.size(); ++i) {
+    auto add_dependency = [&dependencies, &successors, i](size_t dependency) {
+        auto & stage_dependencies = dependencies[i];
+        if (std::find(stage_dependencies.begin(), stage_dependencies.end(), dependency) !=
+          stage_dependencies.end())
+        {
+          return;
+        }
+        dependencies[i].push_back(dependency);
+        successors[dependency].push_back(i);
+      };
+    for (const auto & name : stages_[i].dependencies) {
+      auto it = stage_indices.find(name);
+      if (it == stage_indices.end()) {
+        throw std::invalid_argument(
+                "stage '" + stages_[i].name + "' of pipeline '" + name_ +
+                "' depends on the unknown stage '" + name + "'");
+      }
+      if (it->second == i) {
+        throw std::invalid_argument(
+                "stage '" + name + "' of pipeline '" + name_ + "' has a cyclic dependency");
+      }
+      add_dependency(it->second);
+    }
+    for (const auto & topic : stages_[i].input_topics) {
+      auto it = producers.find(topic);
+      if (it == producers.end()) {
+        // An input of the pipeline
+        continue;
+      }
+      for (size_t producer : it->second) {
+        if (producer == i) {
+          throw std::invalid_argument(
+                  "stage '" + stages_[i].name + "' of pipeline '" + name_ +
+                  "' has a cyclic dependency on topic '" + topic + "'");
+        }
+        add_dependency(producer);
+      }
+    }
+  }
+
+  // Kahn's algorithm, taking the ready stage added first at each step
+  std::vector<size_t> remaining(stages_.size());
+  for (size_t i = 0; i < stages_.size(); ++i) {
+    remaining[i] = dependencies[i].size();
+  }
+  std::vector<bool> sorted(stages_.size(), false);
+  std::vector<size_t> order;
+  order.reserve(stages_.size());
+  while (order.size() < stages_.size()) {
+    size_t next = stages_.size();
+    for (size_t i = 0; i < stages_.size(); ++i) {
+      if (!sorted[i] && remaining[i] == 0) {
+        next = i;
+        break;
+      }
+    }
+    if (next == stages_.size()) {
+      throw std::invalid_argument("pipeline '" + name_ + "' has a cyclic dependency");
+    }
+    sorted[next] = true;
+    order.push_back(next);
+    for (size_t successor : successors[next]) {
+      --remaining[successor];
+    }
+  }
+  return order;
+}
+
+DagExecutor::DagExecutor(const rclcpp::ExecutorOptions & options, size_t number_of_threads)
+: rclcpp::Executor(options)
+{
+  if (number_of_threads == 0) {
+    number_of_threads = std::max(std::thread::hardware_concurrency(), 1U);
+  }
+  // The spinning thread runs stages too
+  threads_.reserve(number_of_threads - 1);
+  for (size_t worker_id = 0; worker_id + 1 < number_of_threads; ++worker_id) {
+    const rclcpp::ThreadAttributes attributes = worker_id < options.thread_attributes.size() ?
+      options.thread_attributes[worker_id] : rclcpp::ThreadAttributes();
+    threads_.emplace_back(attributes, std::bind(&DagExecutor::run_helper, this));
+  }
+}
+
+DagExecutor::~DagExecutor()
+{
+  {
+    std::lock_guard<std::mutex> lock(stages_mutex_);
+    stopping_ = true;
+  }
+  ready_cv_.notify_all();
+  for (auto & thread : threads_) {
+    thread.join();
+  }
+}
+
+size_t
+DagExecutor::add_pipeline(const DagPipeline & pipeline)
+{
+  if (spinning.load()) {
+    throw std::runtime_error("add_pipeline() called while spinning");
+  }
+  std::vector<std::vector<size_t>> dependencies;
+  const std::vector<size_t> order = pipeline.sort_stages(dependencies);
+
+  // Renumber the stages in topological order
+  std::vector<size_t> position(order.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    position[order[i]] = i;
+  }
+  auto compiled = std::make_unique<CompiledPipeline>();
+  std::vector<std::vector<size_t>> successors(order.size());
+  compiled->number_of_dependencies.assign(order.size(), 0);
+  for (size_t i = 0; i < order.size(); ++i) {
+    compiled->callbacks.push_back(pipeline.stages_[order[i]].callback);
+    compiled->number_of_dependencies[i] = dependencies[order[i]].size();
+    if (dependencies[order[i]].empty()) {
+      compiled->roots.push_back(i);
+    }
+    for (size_t dependency : dependencies[order[i]]) {
+      successors[position[dependency]].push_back(i);
+    }
+  }
+  compiled->successor_offsets.push_back(0);
+  for (const auto & stage_successors : successors) {
+    compiled->successors.insert(
+      compiled->successors.end(), stage_successors.begin(), stage_successors.end());
+    compiled->successor_offsets.push_back(compiled->successors.size());
+  }
+
+  std::vector<const void *> trigger_entities;
+  if (auto timer = pipeline.trigger_timer_.lock()) {
+    trigger_entities.push_back(timer.get());
+  }
+  if (auto subscription = pipeline.trigger_subscription_.lock()) {
+    trigger_entities.push_back(subscription.get());
+    if (auto waitable = subscription->get_intra_process_waitable()) {
+      trigger_entities.push_back(waitable.get());
+    }
+  }
+  for (const void * entity : trigger_entities) {
+    if (trigger_pipelines_.count(entity) != 0) {
+      throw std::invalid_argument(
+              "the trigger of pipeline '" + pipeline.get_name() +
+              "' already triggers another pipeline");
+    }
+  }
+
+  // Preallocate the storage of the runs
+  std::lock_guard<std::mutex> run_lock(run_mutex_);
+  {
+    std::lock_guard<std::mutex> lock(stages_mutex_);
+    if (remaining_dependencies_.size() < order.size()) {
+      remaining_dependencies_.resize(order.size());
+      ready_stages_.reserve(order.size());
+    }
+  }
+  const size_t pipeline_index = pipelines_.size();
+  pipelines_.push_back(std::move(compiled));
+  for (const void * entity : trigger_entities) {
+    trigger_pipelines_[entity] = pipeline_index;
+  }
+  return pipeline_index;
+}
+
+void
+DagExecutor::run_pipeline(size_t pipeline_index)
+{
+  std::lock_guard<std::mutex> run_lock(run_mutex_);
+  const CompiledPipeline & pipeline = *pipelines_.at(pipeline_index);
+  if (threads_.empty()) {
+    // A single thread runs the stages in topological order
+    for (const auto & callback : pipeline.callbacks) {
+      callback();
+    }
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(stages_mutex_);
+  std::copy(
+    pipeline.number_of_dependencies.begin(), pipeline.number_of_dependencies.end(),
+    remaining_dependencies_.begin());
+  ready_stages_.assign(pipeline.roots.begin(), pipeline.roots.end());
+  next_ready_stage_ = 0;
+  remaining_stages_ = pipeline.callbacks.size();
+  stage_exception_ = nullptr;
+  running_pipeline_ = &pipeline;
+  ready_cv_.notify_all();
+
+  while (remaining_stages_ > 0) {
+    if (next_ready_stage_ < ready_stages_.size()) {
+      run_ready_stage(lock);
+    } else {
+      completed_cv_.wait(lock);
+    }
+  }
+  running_pipeline_ = nullptr;
+  if (stage_exception_) {
+    std::exception_ptr exception = stage_exception_;
+    stage_exception_ = nullptr;
+    std::rethrow_exception(exception);
+  }
+}
+
+void
+DagExecutor::run_ready_stage(std::unique_lock<std::mutex> & lock)
+{
+  const CompiledPipeline & pipeline = *running_pipeline_;
+  const size_t stage = ready_stages_[next_ready_stage_++];
+  if (!stage_exception_) {
+    lock.unlock();
+    std::exception_ptr exception;
+    try {
+      pipeline.callbacks[stage]();
+    } catch (...) {
+      exception = std::current_exception();
+    }
+    lock.lock();
+    if (exception && !stage_exception_) {
+      stage_exception_ = exception;
+    }
+  }
+  // Skipped stages complete too, for their successors to be counted down
+  bool new_ready_stages = false;
+  for (size_t i = pipeline.successor_offsets[stage];
+    i < pipeline.successor_offsets[stage + 1]; ++i)
+  {
+    const size_t successor = pipeline.successors[i];
+    if (--remaining_dependencies_[successor] == 0) {
+      ready_stages_.push_back(successor);
+      new_ready_stages = true;
+    }
+  }
+  if (new_ready_stages) {
+    ready_cv_.notify_all();
+  }
+  if (--remaining_stages_ == 0) {
+    completed_cv_.notify_all();
+  } else if (new_ready_stages) {
+    completed_cv_.notify_one();
+  }
+}
+
+void
+DagExecutor::run_helper()
+{
+  std::unique_lock<std::mutex> lock(stages_mutex_);
+  while (!stopping_) {
+    if (running_pipeline_ && next_ready_stage_ < ready_stages_.size()) {
+      run_ready_stage(lock);
+    } else {
+      ready_cv_.wait(lock);
+    }
+  }
+}
+
+size_t
+DagExecutor::get_number_of_threads() const
+{
+  return threads_.size() + 1;
+}
+
+void
+DagExecutor::execute_and_run_pipeline(AnyExecutable & any_exec)
+{
+  const void * entity = nullptr;
+  if (any_exec.timer) {
+    entity = any_exec.timer.get();
+  } else if (any_exec.subscription) {
+    entity = any_exec.subscription.get();
+  } else if (any_exec.waitable) {
+    entity = any_exec.waitable.get();
+  }
+  execute_any_executable(any_exec);
+  if (trigger_pipelines_.empty() || !entity) {
+    return;
+  }
+  auto it = trigger_pipelines_.find(entity);
+  if (it != trigger_pipelines_.end()) {
+    run_pipeline(it->second);
+  }
+}
+
+void
+DagExecutor::spin()
+{
+  if (spinning.exchange(true)) {
+    throw std::runtime_error("spin() called while already spinning");
+  }
+  RCPPUTILS_SCOPE_EXIT(this->spinning.store(false); );
+  while (rclcpp::ok(this->context_) && spinning.load()) {
+    rclcpp::AnyExecutable any_executable;
+    if (get_next_executable(any_executable)) {
+      execute_and_run_pipeline(any_executable);
+    }
+  }
+}
+
+void
+DagExecutor::spin_some(std::chrono::nanoseconds max_duration)
+{
+  spin_some_with_pipelines(max_duration, false);
+}
+
+void
+DagExecutor::spin_all(std::chrono::nanoseconds max_duration)
+{
+  if (max_duration < std::chrono::nanoseconds(0)) {
+    throw std::invalid_argument("max_duration must be greater than or equal to 0");
+  }
+  spin_some_with_pipelines(max_duration, true);
+}
+
+void
+DagExecutor::spin_some_with_pipelines(std::chrono::nanoseconds max_duration, bool exhaustive)
+{
+  auto start = std::chrono::steady_clock::now();
+  auto max_duration_not_elapsed = [max_duration, start]() {
+      return std::chrono::nanoseconds(0) == max_duration ||
+             std::chrono::steady_clock::now() - start < max_duration;
+    };
+
+  if (spinning.exchange(true)) {
+    throw std::runtime_error("spin_some() called while already spinning");
+  }
+  RCPPUTILS_SCOPE_EXIT(this->spinning.store(false); );
+  bool work_available = false;
+  while (rclcpp::ok(context_) && spinning.load() && max_duration_not_elapsed()) {
+    AnyExecutable any_exec;
+    if (!work_available) {
+      wait_for_work(std::chrono::milliseconds::zero());
+    }
+    if (get_next_ready_executable(any_exec)) {
+      execute_and_run_pipeline(any_exec);
+      work_available = true;
+    } else {
+      if (!work_available || !exhaustive) {
+        break;
+      }
+      work_available = false;
+    }
+  }
+}
+
+void
+DagExecutor::spin_once_impl(std::chrono::nanoseconds timeout)
+{
+  AnyExecutable any_exec;
+  if (get_next_executable(any_exec, timeout)) {
+    execute_and_run_pipeline(any_exec);
+  }
+}
@@ -0,0 +1,292 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/executors/executor_group_manager.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+using rclcpp::executors::ExecutorGroupManager;
+
+ExecutorGroupManager::ExecutorGroupManager(const ExecutorGroupManagerOptions & options)
+: options_(options)
+{}
+
+ExecutorGroupManager::~ExecutorGroupManager()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto & pair : callback_groups_) {
+    auto group_ptr = pair.second.callback_group.lock();
+    if (group_ptr) {
+      executors_[pair.second.executor].executor->remove_callback_group(group_ptr);
+    }
+  }
+}
+
+ExecutorGroupManager::ExecutorIndex
+ExecutorGroupManager::add_executor(rclcpp::Executor::SharedPtr executor, double capacity)
+{
+  if (!executor) {
+    throw std::invalid_argument("executor argument is nullptr");
+  }
+  if (!(capacity > 0.0)) {
+    throw std::invalid_argument("the capacity of an executor must be positive");
+  }
+  executor->set_callback_statistics_enabled(true);
+  executor->reset_callback_statistics();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  executors_.push_back({std::move(executor), capacity});
+  return executors_.size() - 1;
+}
+
+size_t
+ExecutorGroupManager::get_number_of_executors() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return executors_.size();
+}
+
+ExecutorGroupManager::ExecutorIndex
+ExecutorGroupManager::add_callback_group(
+  rclcpp::CallbackGroup::SharedPtr group_ptr,
+  rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_ptr,
+  const std::vector<ExecutorIndex> & allowed_executors)
+{
+  if (!group_ptr || !node_ptr) {
+    throw std::invalid_argument("callback group and node arguments must not be nullptr");
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (executors_.empty()) {
+    throw std::runtime_error("no executor to add the callback group to");
+  }
+  for (ExecutorIndex executor : allowed_executors) {
+    if (executor >= executors_.size()) {
+      throw std::invalid_argument("allowed executor doesn't exist");
+    }
+  }
+  if (callback_groups_.count(group_ptr.get()) != 0) {
+    throw std::runtime_error("callback group has already been added to the manager");
+  }
+
+  ManagedCallbackGroup group;
+  group.callback_group = group_ptr;
+  group.node = node_ptr;
+  group.allowed_executors = allowed_executors;
+
+  // The least loaded executor, or with the fewest callback groups when the loads are equal
+  std::vector<std::chrono::nanoseconds> loads(executors_.size(), std::chrono::nanoseconds(0));
+  std::vector<size_t> counts(executors_.size(), 0);
+  for (const auto & pair : callback_groups_) {
+    loads[pair.second.executor] += pair.second.execution_time;
+    ++counts[pair.second.executor];
+  }
+  bool found = false;
+  for (ExecutorIndex executor = 0; executor < executors_.size(); ++executor) {
+    if (!is_allowed(group, executor)) {
+      continue;
+    }
+    const double load = loads[executor].count() / executors_[executor].capacity;
+    const double best_load = loads[group.executor].count() / executors_[group.executor].capacity;
+    if (
+      !found || load < best_load ||
+      (load == best_load && counts[executor] < counts[group.executor]))
+    {
+      group.executor = executor;
+      found = true;
+    }
+  }
+
+  executors_[group.executor].executor->add_callback_group(group_ptr, node_ptr);
+  const ExecutorIndex executor = group.executor;
+  callback_groups_.emplace(group_ptr.get(), std::move(group));
+  return executor;
+}
+
+void
+ExecutorGroupManager::remove_callback_group(const rclcpp::CallbackGroup::SharedPtr & group_ptr)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = callback_groups_.find(group_ptr.get());
+  if (it == callback_groups_.end()) {
+    throw std::runtime_error("callback group isn't managed");
+  }
+  executors_[it->second.executor].executor->remove_callback_group(group_ptr);
+  callback_groups_.erase(it);
+}
+
+ExecutorGroupManager::ExecutorIndex
+ExecutorGroupManager::get_executor_index(
+  const rclcpp::CallbackGroup::SharedPtr & group_ptr) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = callback_groups_.find(group_ptr.get());
+  if (it == callback_groups_.end()) {
+    throw std::runtime_error("callback group isn't managed");
+  }
+  return it->second.executor;
+}
+
+size_t
+ExecutorGroupManager::rebalance()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  // Drop the callback groups which were destroyed, and measure the load of the others
+  for (auto it = callback_groups_.begin(); it != callback_groups_.end(); ) {
+    if (it->second.callback_group.expired()) {
+      it = callback_groups_.erase(it);
+    } else {
+      it->second.execution_time = std::chrono::nanoseconds(0);
+      ++it;
+    }
+  }
+  for (auto & managed_executor : executors_) {
+    auto statistics = managed_executor.executor->get_callback_statistics();
+    managed_executor.executor->reset_callback_statistics();
+    for (const auto & callback_statistics : statistics) {
+      auto it = callback_groups_.find(callback_statistics.callback_group);
+      if (it != callback_groups_.end()) {
+        it->second.execution_time +=
+          callback_statistics.execution_time.mean() *
+          static_cast<int64_t>(callback_statistics.execution_time.count());
+      }
+    }
+  }
+
+  std::vector<double> loads(executors_.size(), 0.0);
+  for (const auto & pair : callback_groups_) {
+    loads[pair.second.executor] +=
+      pair.second.execution_time.count() / executors_[pair.second.executor].capacity;
+  }
+
+  size_t migrations = 0;
+  // Callback groups which were busy, left in place until the next call
+  std::vector<const void *> busy;
+  while (migrations < options_.max_migrations) {
+    const auto source = static_cast<ExecutorIndex>(
+      std::max_element(loads.begin(), loads.end()) - loads.begin());
+    if (!(loads[source] > 0.0)) {
+      break;
+    }
+    // The move reducing the most the difference between the source and its target
+    const void * best_key = nullptr;
+    ManagedCallbackGroup * best_group = nullptr;
+    ExecutorIndex best_target = source;
+    double best_difference = std::numeric_limits<double>::infinity();
+    for (auto & pair : callback_groups_) {
+      ManagedCallbackGroup & group = pair.second;
+      if (
+        group.executor != source || group.execution_time.count() == 0 ||
+        std::find(busy.begin(), busy.end(), pair.first) != busy.end())
+      {
+        continue;
+      }
+      for (ExecutorIndex target = 0; target < executors_.size(); ++target) {
+        if (
+          target == source || !is_allowed(group, target) ||
+          loads[source] - loads[target] <= options_.imbalance_threshold * loads[source])
+        {
+          continue;
+        }
+        const double time = static_cast<double>(group.execution_time.count());
+        const double difference = std::abs(
+          (loads[source] - time / executors_[source].capacity) -
+          (loads[target] + time / executors_[target].capacity));
+        if (difference < loads[source] - loads[target] && difference < best_difference) {
+          best_key = pair.first;
+          best_group = &group;
+          best_target = target;
+          best_difference = difference;
+        }
+      }
+    }
+    if (!best_group) {
+      break;
+    }
+    if (!migrate(*best_group, best_target)) {
+      busy.push_back(best_key);
+      continue;
+    }
+    const double time = static_cast<double>(best_group->execution_time.count());
+    loads[source] -= time / executors_[source].capacity;
+    loads[best_target] += time / executors_[best_target].capacity;
+    ++migrations;
+  }
+  return migrations;
+}
+
+std::vector<ExecutorGroupManager::CallbackGroupLoad>
+ExecutorGroupManager::get_callback_group_loads() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<CallbackGroupLoad> group_loads;
+  group_loads.reserve(callback_groups_.size());
+  for (const auto & pair : callback_groups_) {
+    group_loads.push_back(
+      {pair.second.callback_group, pair.second.executor, pair.second.execution_time});
+  }
+  return group_loads;
+}
+
+bool
+ExecutorGroupManager::is_allowed(
+  const ManagedCallbackGroup & group,
+  ExecutorIndex executor) const
+{
+  if (group.allowed_executors.empty()) {
+    return true;
+  }
+  const auto & allowed = group.allowed_executors;
+  return std::find(allowed.begin(), allowed.end(), executor) != allowed.end();
+}
+
+bool
+ExecutorGroupManager::migrate(ManagedCallbackGroup & group, ExecutorIndex executor)
+{
+  auto group_ptr = group.callback_group.lock();
+  auto node_ptr = group.node.lock();
+  if (!group_ptr || !node_ptr) {
+    return false;
+  }
+  // Reserved like for an execution, none of its callbacks is executing while it is removed
+  if (!group_ptr->try_reserve()) {
+    return false;
+  }
+  try {
+    executors_[group.executor].executor->remove_callback_group(group_ptr);
+  } catch (...) {
+    group_ptr->release();
+    throw;
+  }
+  // Released before being added, so that the new executor can execute it once woken up
+  group_ptr->release();
+  try {
+    executors_[executor].executor->add_callback_group(group_ptr, node_ptr);
+  } catch (...) {
+    // Back to its executor, rather than left without one
+    executors_[group.executor].executor->add_callback_group(group_ptr, node_ptr);
+    throw;
+  }
+  group.executor = executor;
+  return true;
+}
@@ -14,14 +14,21 @@
 
 #include "rclcpp/executors/multi_threaded_executor.hpp"
 
+#include <algorithm>
 #include <chrono>
 #include <functional>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 
 #include "rcpputils/scope_exit.hpp"
 
 #include "rclcpp/logging.hpp"
+#include "rclcpp/numa_topology.hpp"
+#include "rclcpp/thread.hpp"
 #include "rclcpp/utilities.hpp"
 
 using rclcpp::executors::MultiThreadedExecutor;
@@ -30,15 +37,21 @@ MultiThreadedExecutor::MultiThreadedExecutor(
   const rclcpp::ExecutorOptions & options,
   size_t number_of_threads,
   bool yield_before_execute,
-  std::chrono::nanoseconds next_exec_timeout)
+  std::chrono::nanoseconds next_exec_timeout,
+  SchedulingMode scheduling_mode)
 : rclcpp::Executor(options),
   yield_before_execute_(yield_before_execute),
-  next_exec_timeout_(next_exec_timeout)
+  next_exec_timeout_(next_exec_timeout),
+  scheduling_mode_(scheduling_mode),
+  thread_attributes_(options.thread_attributes),
+  numa_aware_(options.numa_aware)
 {
   number_of_threads_ = number_of_threads > 0 ?
     number_of_threads :
     std::max(std::thread::hardware_concurrency(), 2U);
 
+  configure_numa_placement();
+
   if (number_of_threads_ == 1) {
     RCLCPP_WARN(
       rclcpp::get_logger("rclcpp"),
@@ -49,6 +62,25 @@ MultiThreadedExecutor::MultiThreadedExecutor(
 
 MultiThreadedExecutor::~MultiThreadedExecutor() {}
 
+void
+MultiThreadedExecutor::configure_numa_placement()
+{
+  worker_nodes_.assign(number_of_threads_, rclcpp::NumaTopology::unknown);
+  if (!numa_aware_) {
+    return;
+  }
+  const rclcpp::NumaTopology & topology = rclcpp::NumaTopology::get_host_topology();
+  if (thread_attributes_.empty() || numa_thread_attributes_) {
+    thread_attributes_ = topology.make_worker_thread_attributes(number_of_threads_);
+    numa_thread_attributes_ = true;
+  }
+  for (size_t i = 0; i < number_of_threads_ && i < thread_attributes_.size(); ++i) {
+    if (!thread_attributes_[i].cpu_set.empty()) {
+      worker_nodes_[i] = topology.get_node_of_cpu(thread_attributes_[i].cpu_set.front());
+    }
+  }
+}
+
 void
 MultiThreadedExecutor::spin()
 {
@@ -56,6 +88,30 @@ MultiThreadedExecutor::spin()
     throw std::runtime_error("spin() called while already spinning");
   }
   RCPPUTILS_SCOPE_EXIT(this->spinning.store(false); );
+
+  if (scheduling_mode_ == SchedulingMode::WorkStealing) {
+    worker_queues_.clear();
+    for (size_t i = 0; i < number_of_threads_; ++i) {
+      worker_queues_.emplace_back(std::make_unique<WorkerQueue>());
+    }
+    queued_executables_.store(0);
+    waiting_for_work_ = false;
+  }
+  active_threads_.store(dynamic_thread_pool_ ? min_threads_ : number_of_threads_);
+  // Executables still queued when spinning stops are discarded, which releases their
+  // callback groups.
+  RCPPUTILS_SCOPE_EXIT(this->worker_queues_.clear(); );
+
+  if (dynamic_thread_pool_) {
+    spin_dynamic_thread_pool();
+    return;
+  }
+
+  if (!thread_attributes_.empty()) {
+    spin_with_thread_attributes();
+    return;
+  }
+
   std::vector<std::thread> threads;
   size_t thread_id = 0;
   {
@@ -72,31 +128,247 @@ MultiThreadedExecutor::spin()
   }
 }
 
+void
+MultiThreadedExecutor::spin_with_thread_attributes()
+{
+  std::vector<rclcpp::Thread> threads;
+  try {
+    std::lock_guard wait_lock{wait_mutex_};
+    for (size_t thread_id = 0; thread_id < number_of_threads_; ++thread_id) {
+      const rclcpp::ThreadAttributes attributes = thread_id < thread_attributes_.size() ?
+        thread_attributes_[thread_id] : rclcpp::ThreadAttributes();
+      threads.emplace_back(attributes, std::bind(&MultiThreadedExecutor::run, this, thread_id));
+    }
+  } catch (...) {
+    // Stop the threads which were already started before reporting the error
+    spinning.store(false);
+    interrupt_guard_condition_.trigger();
+    for (auto & thread : threads) {
+      thread.join();
+    }
+    throw;
+  }
+
+  for (auto & thread : threads) {
+    thread.join();
+  }
+}
+
+void
+MultiThreadedExecutor::spin_dynamic_thread_pool()
+{
+  // Without thread attributes, the thread calling spin() is the first worker, which never retires
+  const bool caller_is_worker = thread_attributes_.empty();
+  RCPPUTILS_SCOPE_EXIT(
+  {
+    std::lock_guard<std::mutex> pool_lock(pool_mutex_);
+    for (auto & thread : pool_threads_) {
+      if (thread.joinable()) {
+        thread.join();
+      }
+    }
+    pool_threads_.clear();
+  });
+  try {
+    std::lock_guard<std::mutex> pool_lock(pool_mutex_);
+    pool_threads_.clear();
+    pool_threads_.resize(number_of_threads_);
+    last_growth_time_ = std::chrono::steady_clock::now();
+    for (size_t thread_id = caller_is_worker ? 1 : 0; thread_id < min_threads_; ++thread_id) {
+      start_pool_thread(thread_id);
+    }
+  } catch (...) {
+    // Stop the threads which were already started before reporting the error
+    spinning.store(false);
+    interrupt_guard_condition_.trigger();
+    work_cv_.notify_all();
+    throw;
+  }
+
+  if (caller_is_worker) {
+    run(0);
+  } else {
+    // The other elements are only replaced with the pool mutex held, and never this one
+    pool_threads_[0].join();
+  }
+}
+
+void
+MultiThreadedExecutor::start_pool_thread(size_t thread_id)
+{
+  const rclcpp::ThreadAttributes attributes = thread_id < thread_attributes_.size() ?
+    thread_attributes_[thread_id] : rclcpp::ThreadAttributes();
+  pool_threads_[thread_id] =
+    rclcpp::Thread(attributes, std::bind(&MultiThreadedExecutor::run, this, thread_id));
+}
+
+void
+MultiThreadedExecutor::grow_thread_pool()
+{
+  // The thread holding the pool mutex is already growing the pool, or joining the pool threads
+  // because spinning stopped
+  std::unique_lock<std::mutex> pool_lock(pool_mutex_, std::try_to_lock);
+  if (!pool_lock.owns_lock()) {
+    return;
+  }
+  const auto now = std::chrono::steady_clock::now();
+  // Give the last added thread time to take some of the load
+  if (now - last_growth_time_ < grow_queueing_delay_) {
+    return;
+  }
+  size_t thread_id;
+  {
+    std::lock_guard<std::mutex> lock(work_mutex_);
+    if (!spinning.load() || active_threads_.load() >= number_of_threads_) {
+      return;
+    }
+    thread_id = active_threads_.fetch_add(1);
+  }
+  last_growth_time_ = now;
+  // A retired thread with this index has returned from run(), or is about to
+  if (pool_threads_[thread_id].joinable()) {
+    pool_threads_[thread_id].join();
+  }
+  try {
+    start_pool_thread(thread_id);
+  } catch (const std::exception & exception) {
+    {
+      // Only this function adds threads, and the missing thread can't retire
+      std::lock_guard<std::mutex> lock(work_mutex_);
+      active_threads_.store(thread_id);
+    }
+    RCLCPP_WARN(
+      rclcpp::get_logger("rclcpp"),
+      "MultiThreadedExecutor failed to add a thread to its pool: %s", exception.what());
+  }
+}
+
+bool
+MultiThreadedExecutor::should_retire(
+  size_t this_thread_number,
+  std::chrono::steady_clock::time_point idle_since) const
+{
+  // Only the thread with the highest index retires, so the running threads keep the lowest ones
+  return
+    this_thread_number >= min_threads_ &&
+    this_thread_number + 1 == active_threads_.load() &&
+    queued_executables_.load() == 0 &&
+    std::chrono::steady_clock::now() - idle_since >= shrink_idle_time_;
+}
+
 size_t
 MultiThreadedExecutor::get_number_of_threads()
 {
   return number_of_threads_;
 }
 
+void
+MultiThreadedExecutor::set_dynamic_thread_pool(
+  size_t min_threads,
+  size_t max_threads,
+  std::chrono::nanoseconds grow_queueing_delay,
+  std::chrono::nanoseconds shrink_idle_time)
+{
+  if (spinning.load()) {
+    throw std::runtime_error("set_dynamic_thread_pool() called while spinning");
+  }
+  if (scheduling_mode_ != SchedulingMode::WorkStealing) {
+    throw std::invalid_argument("dynamic thread pool requires the work stealing scheduling mode");
+  }
+  if (min_threads == 0 || max_threads < min_threads) {
+    throw std::invalid_argument("dynamic thread pool requires 0 < min_threads <= max_threads");
+  }
+  if (
+    grow_queueing_delay <= std::chrono::nanoseconds::zero() ||
+    shrink_idle_time <= std::chrono::nanoseconds::zero())
+  {
+    throw std::invalid_argument("dynamic thread pool delays must be positive");
+  }
+  dynamic_thread_pool_ = true;
+  min_threads_ = min_threads;
+  number_of_threads_ = max_threads;
+  grow_queueing_delay_ = grow_queueing_delay;
+  shrink_idle_time_ = shrink_idle_time;
+  configure_numa_placement();
+}
+
+void
+MultiThreadedExecutor::set_callback_group_affinity(std::chrono::nanoseconds steal_idle_threshold)
+{
+  if (spinning.load()) {
+    throw std::runtime_error("set_callback_group_affinity() called while spinning");
+  }
+  if (scheduling_mode_ != SchedulingMode::WorkStealing) {
+    throw std::invalid_argument(
+            "callback group affinity requires the work stealing scheduling mode");
+  }
+  if (steal_idle_threshold < std::chrono::nanoseconds::zero()) {
+    throw std::invalid_argument("callback group affinity steal threshold must not be negative");
+  }
+  callback_group_affinity_ = true;
+  steal_idle_threshold_ = steal_idle_threshold;
+}
+
+size_t
+MultiThreadedExecutor::get_number_of_active_threads() const
+{
+  return active_threads_.load();
+}
+
+MultiThreadedExecutor::SchedulingMode
+MultiThreadedExecutor::get_scheduling_mode() const
+{
+  return scheduling_mode_;
+}
+
+MultiThreadedExecutor::NumaStatistics
+MultiThreadedExecutor::get_numa_statistics() const
+{
+  NumaStatistics statistics;
+  statistics.local_executions = numa_local_executions_.load();
+  statistics.remote_executions = numa_remote_executions_.load();
+  return statistics;
+}
+
+MultiThreadedExecutor::AffinityStatistics
+MultiThreadedExecutor::get_affinity_statistics() const
+{
+  AffinityStatistics statistics;
+  statistics.affine_executions = affine_executions_.load();
+  statistics.migrated_executions = migrated_executions_.load();
+  return statistics;
+}
+
 void
 MultiThreadedExecutor::run(size_t this_thread_number)
 {
-  (void)this_thread_number;
+  if (scheduling_mode_ == SchedulingMode::WorkStealing) {
+    run_work_stealing(this_thread_number);
+    return;
+  }
   while (rclcpp::ok(this->context_) && spinning.load()) {
     rclcpp::AnyExecutable any_exec;
+    size_t entity_node = rclcpp::NumaTopology::unknown;
     {
-      std::lock_guard wait_lock{wait_mutex_};
+      std::unique_lock<std::mutex> wait_lock(wait_mutex_, std::defer_lock);
+      {
+        // Only one thread waits for work at a time, the others are idle meanwhile
+        auto idle_scope = account_time(rclcpp::ExecutorActivity::Idle);
+        wait_lock.lock();
+      }
       if (!rclcpp::ok(this->context_) || !spinning.load()) {
         return;
       }
       if (!get_next_executable(any_exec, next_exec_timeout_)) {
         continue;
       }
+      entity_node = get_entity_node(any_exec);
     }
     if (yield_before_execute_) {
       std::this_thread::yield();
     }
 
+    record_numa_execution(this_thread_number, entity_node);
     execute_any_executable(any_exec);
 
     // Clear the callback_group to prevent the AnyExecutable destructor from
@@ -104,3 +376,290 @@ MultiThreadedExecutor::run(size_t this_thread_number)
     any_exec.callback_group.reset();
   }
 }
+
+void
+MultiThreadedExecutor::run_work_stealing(size_t this_thread_number)
+{
+  auto idle_since = std::chrono::steady_clock::now();
+  // Since when this thread looks for work, i.e. since it was woken up or executed something
+  auto looking_since = idle_since;
+  while (rclcpp::ok(this->context_) && spinning.load()) {
+    QueuedExecutable queued;
+    // With the callback group affinity, the work of the other threads is left to them for a while
+    const bool may_steal = !callback_group_affinity_ ||
+      std::chrono::steady_clock::now() - looking_since >= steal_idle_threshold_;
+    {
+      auto select_scope = account_time(rclcpp::ExecutorActivity::Select);
+      queued = take_queued_executable(this_thread_number, may_steal);
+    }
+    std::unique_ptr<rclcpp::AnyExecutable> any_exec = std::move(queued.executable);
+    if (!any_exec && !may_steal && queued_executables_.load() > 0) {
+      // Sleep until work is queued for this thread, or until it may steal the queued work
+      std::unique_lock<std::mutex> lock(work_mutex_);
+      auto idle_scope = account_time(rclcpp::ExecutorActivity::Idle);
+      work_cv_.wait_until(
+        lock, looking_since + steal_idle_threshold_, [this, this_thread_number]() {
+          return has_queued_executables(this_thread_number) || !spinning.load();
+        });
+      continue;
+    }
+    if (!any_exec) {
+      std::unique_lock<std::mutex> lock(work_mutex_);
+      // Sleep while another thread is waiting for work and there is nothing to steal
+      auto has_work_or_stopped = [this]() {
+          return queued_executables_.load() > 0 || !waiting_for_work_ || !spinning.load();
+        };
+      if (dynamic_thread_pool_) {
+        // Wake up from time to time to check whether this thread should retire
+        {
+          auto idle_scope = account_time(rclcpp::ExecutorActivity::Idle);
+          work_cv_.wait_for(lock, shrink_idle_time_, has_work_or_stopped);
+        }
+        if (should_retire(this_thread_number, idle_since)) {
+          active_threads_.fetch_sub(1);
+          lock.unlock();
+          // Executables queued for this thread meanwhile are stolen by the others
+          work_cv_.notify_all();
+          return;
+        }
+        if (!has_work_or_stopped()) {
+          continue;
+        }
+      } else {
+        auto idle_scope = account_time(rclcpp::ExecutorActivity::Idle);
+        work_cv_.wait(lock, has_work_or_stopped);
+      }
+      looking_since = std::chrono::steady_clock::now();
+      if (queued_executables_.load() > 0 || !rclcpp::ok(this->context_) || !spinning.load()) {
+        continue;
+      }
+      // Waiting while executables are still queued would report their entities as ready a
+      // second time, so this thread only waits once all the queues have been drained.
+      waiting_for_work_ = true;
+      lock.unlock();
+
+      wait_and_distribute_executables(this_thread_number);
+
+      lock.lock();
+      waiting_for_work_ = false;
+      lock.unlock();
+      work_cv_.notify_all();
+      looking_since = std::chrono::steady_clock::now();
+      continue;
+    }
+    if (
+      dynamic_thread_pool_ &&
+      std::chrono::steady_clock::now() - queued.queued_time >= grow_queueing_delay_)
+    {
+      grow_thread_pool();
+    }
+    if (yield_before_execute_) {
+      std::this_thread::yield();
+    }
+
+    record_numa_execution(this_thread_number, queued.node);
+    record_group_thread(this_thread_number, *any_exec);
+    execute_any_executable(*any_exec);
+
+    // Clear the callback_group to prevent the AnyExecutable destructor from
+    // resetting the callback group `can_be_taken_from`
+    any_exec->callback_group.reset();
+    idle_since = std::chrono::steady_clock::now();
+    looking_since = idle_since;
+  }
+  // Wake up the other threads, so that they notice that spinning stopped
+  work_cv_.notify_all();
+}
+
+MultiThreadedExecutor::QueuedExecutable
+MultiThreadedExecutor::take_queued_executable(size_t this_thread_number, bool may_steal)
+{
+  if (queued_executables_.load() == 0) {
+    return {};
+  }
+  const size_t number_of_queues = worker_queues_.size();
+  const size_t this_node = worker_nodes_[this_thread_number];
+  // Without NUMA awareness, or when the node of this thread is unknown, a single pass is made
+  const bool prefer_own_node = numa_aware_ && this_node != rclcpp::NumaTopology::unknown;
+  for (int pass = prefer_own_node ? 0 : 1; pass < 2; ++pass) {
+    for (size_t i = 0; i < number_of_queues; ++i) {
+      const size_t queue_index = (this_thread_number + i) % number_of_queues;
+      if (prefer_own_node && (worker_nodes_[queue_index] == this_node) != (pass == 0)) {
+        continue;
+      }
+      if (i != 0 && !may_steal) {
+        continue;
+      }
+      WorkerQueue & queue = *worker_queues_[queue_index];
+      std::lock_guard<std::mutex> guard(queue.mutex);
+      if (queue.executables.empty()) {
+        continue;
+      }
+      QueuedExecutable queued;
+      if (i == 0) {
+        // Own work is executed in the order it was distributed
+        queued = std::move(queue.executables.front());
+        queue.executables.pop_front();
+      } else {
+        queued = std::move(queue.executables.back());
+        queue.executables.pop_back();
+      }
+      queued_executables_.fetch_sub(1);
+      return queued;
+    }
+  }
+  return {};
+}
+
+bool
+MultiThreadedExecutor::has_queued_executables(size_t this_thread_number)
+{
+  WorkerQueue & queue = *worker_queues_[this_thread_number];
+  std::lock_guard<std::mutex> guard(queue.mutex);
+  return !queue.executables.empty();
+}
+
+void
+MultiThreadedExecutor::wait_and_distribute_executables(size_t this_thread_number)
+{
+  std::chrono::nanoseconds timeout = next_exec_timeout_;
+  if (
+    dynamic_thread_pool_ &&
+    (timeout < std::chrono::nanoseconds::zero() || timeout > shrink_idle_time_))
+  {
+    // Return from time to time, so that this thread can retire when it's idle
+    timeout = shrink_idle_time_;
+  }
+  auto any_exec = std::make_unique<rclcpp::AnyExecutable>();
+  if (!get_next_executable(*any_exec, timeout)) {
+    return;
+  }
+  // Mutually exclusive callback groups are marked as taken by get_next_ready_executable(),
+  // so each of them contributes at most one executable to this round.
+  // Only the queues of the running threads are targeted, the other ones are drained by stealing.
+  const size_t number_of_queues =
+    std::min(std::max<size_t>(active_threads_.load(), 1), worker_queues_.size());
+  size_t next_queue = this_thread_number;
+  do {
+    const size_t entity_node = get_entity_node(*any_exec);
+    const size_t group_thread = get_group_thread(*any_exec);
+    size_t queue_index = next_queue % number_of_queues;
+    if (group_thread < number_of_queues) {
+      // The thread which executed the callback group last still has its state in its caches
+      queue_index = group_thread;
+    } else if (numa_aware_ && entity_node != rclcpp::NumaTopology::unknown) {
+      // Round robin over the workers of the node of the entity, if it has any
+      for (size_t i = 0; i < number_of_queues; ++i) {
+        if (worker_nodes_[(next_queue + i) % number_of_queues] == entity_node) {
+          queue_index = (next_queue + i) % number_of_queues;
+          break;
+        }
+      }
+    }
+    WorkerQueue & queue = *worker_queues_[queue_index];
+    {
+      std::lock_guard<std::mutex> guard(queue.mutex);
+      queue.executables.push_back({std::move(any_exec), entity_node, {}});
+      if (dynamic_thread_pool_) {
+        queue.executables.back().queued_time = std::chrono::steady_clock::now();
+      }
+    }
+    queued_executables_.fetch_add(1);
+    if (callback_group_affinity_) {
+      // The executable is meant for a given thread, which must be the one woken up
+      work_cv_.notify_all();
+    } else {
+      work_cv_.notify_one();
+    }
+    next_queue = queue_index + 1;
+    any_exec = std::make_unique<rclcpp::AnyExecutable>();
+  } while (spinning.load() && get_next_ready_executable(*any_exec));
+}
+
+size_t
+MultiThreadedExecutor::get_entity_node(const rclcpp::AnyExecutable & any_exec)
+{
+  if (!numa_aware_) {
+    return rclcpp::NumaTopology::unknown;
+  }
+  const void * entity = nullptr;
+  if (any_exec.subscription) {
+    entity = any_exec.subscription.get();
+  } else if (any_exec.timer) {
+    entity = any_exec.timer.get();
+  } else if (any_exec.service) {
+    entity = any_exec.service.get();
+  } else if (any_exec.client) {
+    entity = any_exec.client.get();
+  } else if (any_exec.waitable) {
+    entity = any_exec.waitable.get();
+  } else {
+    return rclcpp::NumaTopology::unknown;
+  }
+  auto it = entity_nodes_.find(entity);
+  if (it != entity_nodes_.end()) {
+    return it->second;
+  }
+  // The address of a destroyed entity may be reused, so the cache is dropped from time to time
+  if (entity_nodes_.size() >= 1024) {
+    entity_nodes_.clear();
+  }
+  const size_t node = rclcpp::NumaTopology::get_node_of_address(entity);
+  entity_nodes_.emplace(entity, node);
+  return node;
+}
+
+void
+MultiThreadedExecutor::record_numa_execution(size_t this_thread_number, size_t entity_node)
+{
+  const size_t this_node = worker_nodes_[this_thread_number];
+  if (entity_node == rclcpp::NumaTopology::unknown || this_node == rclcpp::NumaTopology::unknown) {
+    return;
+  }
+  if (entity_node == this_node) {
+    numa_local_executions_.fetch_add(1, std::memory_order_relaxed);
+  } else {
+    numa_remote_executions_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+size_t
+MultiThreadedExecutor::get_group_thread(const rclcpp::AnyExecutable & any_exec)
+{
+  if (!callback_group_affinity_ || !any_exec.callback_group) {
+    return std::numeric_limits<size_t>::max();
+  }
+  std::lock_guard<std::mutex> lock(group_threads_mutex_);
+  auto it = group_threads_.find(any_exec.callback_group.get());
+  if (it == group_threads_.end()) {
+    return std::numeric_limits<size_t>::max();
+  }
+  return it->second;
+}
+
+void
+MultiThreadedExecutor::record_group_thread(
+  size_t this_thread_number,
+  const rclcpp::AnyExecutable & any_exec)
+{
+  if (!callback_group_affinity_ || !any_exec.callback_group) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(group_threads_mutex_);
+  auto it = group_threads_.find(any_exec.callback_group.get());
+  if (it != group_threads_.end()) {
+    if (it->second == this_thread_number) {
+      affine_executions_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      migrated_executions_.fetch_add(1, std::memory_order_relaxed);
+      it->second = this_thread_number;
+    }
+    return;
+  }
+  // The address of a destroyed callback group may be reused, so the map is dropped from time to
+  // time
+  if (group_threads_.size() >= 1024) {
+    group_threads_.clear();
+  }
+  group_threads_.emplace(any_exec.callback_group.get(), this_thread_number);
+}
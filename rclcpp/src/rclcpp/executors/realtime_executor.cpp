@@ -0,0 +1,427 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/executors/realtime_executor.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "rcpputils/scope_exit.hpp"
+
+#include "rclcpp/allocation_audit.hpp"
+#include "rclcpp/exceptions.hpp"
+#include "rclcpp/logging.hpp"
+
+using rclcpp::AllocationAudit;
+using rclcpp::AllocationCheck;
+using rclcpp::AllocationGuard;
+using rclcpp::AllocationSite;
+using rclcpp::executors::RealtimeExecutor;
+
+namespace
+{
+
+/// Take and handle like the executor does, without the std::function which may allocate.
+template<typename TakeT, typename HandleT>
+bool
+take_and_handle(
+  const char * action_description,
+  const char * topic_or_service_name,
+  TakeT && take_action,
+  HandleT && handle_action)
+{
+  bool taken = false;
+  try {
+    taken = take_action();
+  } catch (const rclcpp::exceptions::RCLError & rcl_error) {
+    RCLCPP_ERROR(
+      rclcpp::get_logger("rclcpp"),
+      "executor %s '%s' unexpectedly failed: %s",
+      action_description,
+      topic_or_service_name,
+      rcl_error.what());
+  }
+  if (taken) {
+    handle_action();
+  }
+  return taken;
+}
+
+}  // namespace
+
+RealtimeExecutor::RealtimeExecutor(
+  const rclcpp::ExecutorOptions & options,
+  AllocationCheck allocation_check)
+: StaticSingleThreadedExecutor(options), allocation_check_(allocation_check)
+{}
+
+RealtimeExecutor::~RealtimeExecutor()
+{
+  for (auto & slot : subscription_slots_) {
+    release_subscription_slot(slot);
+  }
+}
+
+void
+RealtimeExecutor::spin()
+{
+  if (spinning.exchange(true)) {
+    throw std::runtime_error("spin() called while already spinning");
+  }
+  RCPPUTILS_SCOPE_EXIT(this->spinning.store(false); );
+  prepare_entities();
+
+  const size_t initial_count = allocation_count_.load();
+  AllocationGuard guard(allocation_check_);
+  while (rclcpp::ok(this->context_) && spinning.load()) {
+    entities_collector_->refresh_wait_set();
+    execute_ready_executables();
+    allocation_count_.store(initial_count + guard.get_allocation_count());
+  }
+}
+
+void
+RealtimeExecutor::spin_some(std::chrono::nanoseconds max_duration)
+{
+  // In this context a 0 input max_duration means no duration limit
+  if (std::chrono::nanoseconds(0) == max_duration) {
+    max_duration = std::chrono::nanoseconds::max();
+  }
+  spin_some_guarded(max_duration, false);
+}
+
+void
+RealtimeExecutor::spin_all(std::chrono::nanoseconds max_duration)
+{
+  if (max_duration < std::chrono::nanoseconds(0)) {
+    throw std::invalid_argument("max_duration must be greater than or equal to 0");
+  }
+  spin_some_guarded(max_duration, true);
+}
+
+size_t
+RealtimeExecutor::get_allocation_count() const
+{
+  return allocation_count_.load();
+}
+
+void
+RealtimeExecutor::spin_once_impl(std::chrono::nanoseconds timeout)
+{
+  prepare_entities();
+  const size_t initial_count = allocation_count_.load();
+  AllocationGuard guard(allocation_check_);
+  if (rclcpp::ok(context_) && spinning.load()) {
+    entities_collector_->refresh_wait_set(timeout);
+    execute_ready_executables(true);
+  }
+  allocation_count_.store(initial_count + guard.get_allocation_count());
+}
+
+void
+RealtimeExecutor::spin_some_guarded(std::chrono::nanoseconds max_duration, bool exhaustive)
+{
+  if (spinning.exchange(true)) {
+    throw std::runtime_error("spin_some() called while already spinning");
+  }
+  RCPPUTILS_SCOPE_EXIT(this->spinning.store(false); );
+  prepare_entities();
+
+  const size_t initial_count = allocation_count_.load();
+  AllocationGuard guard(allocation_check_);
+  const auto start = std::chrono::steady_clock::now();
+  while (
+    rclcpp::ok(context_) && spinning.load() &&
+    (std::chrono::nanoseconds(0) == max_duration ||
+    std::chrono::steady_clock::now() - start < max_duration))
+  {
+    entities_collector_->refresh_wait_set(std::chrono::milliseconds::zero());
+    bool work_available = execute_ready_executables();
+    allocation_count_.store(initial_count + guard.get_allocation_count());
+    if (!work_available || !exhaustive) {
+      break;
+    }
+  }
+}
+
+bool
+RealtimeExecutor::execute_ready_executables(bool spin_once)
+{
+  bool any_ready_executable = false;
+
+  for (size_t i = 0; i < wait_set_.size_of_subscriptions; ++i) {
+    if (i < entities_collector_->get_number_of_subscriptions() && wait_set_.subscriptions[i]) {
+      if (i >= subscription_slots_.size()) {
+        // Only after a collection this executor didn't see
+        AllocationGuard allow(AllocationCheck::None);
+        prepare_slots();
+      }
+      execute_subscription_slot(subscription_slots_[i]);
+      if (spin_once) {
+        return true;
+      }
+      any_ready_executable = true;
+    }
+  }
+  for (size_t i = 0; i < wait_set_.size_of_timers; ++i) {
+    if (i < entities_collector_->get_number_of_timers() && wait_set_.timers[i]) {
+      const auto & timer = entities_collector_->get_timer(i);
+      if (timer->is_ready()) {
+        AllocationAudit::Scope audit_scope(timer.get(), AllocationSite::Timer);
+        timer->call();
+        execute_timer(timer);
+        if (spin_once) {
+          return true;
+        }
+        any_ready_executable = true;
+      }
+    }
+  }
+  for (size_t i = 0; i < wait_set_.size_of_services; ++i) {
+    if (i < entities_collector_->get_number_of_services() && wait_set_.services[i]) {
+      if (i >= service_slots_.size()) {
+        AllocationGuard allow(AllocationCheck::None);
+        prepare_slots();
+      }
+      execute_service_slot(service_slots_[i]);
+      if (spin_once) {
+        return true;
+      }
+      any_ready_executable = true;
+    }
+  }
+  for (size_t i = 0; i < wait_set_.size_of_clients; ++i) {
+    if (i < entities_collector_->get_number_of_clients() && wait_set_.clients[i]) {
+      if (i >= client_slots_.size()) {
+        AllocationGuard allow(AllocationCheck::None);
+        prepare_slots();
+      }
+      execute_client_slot(client_slots_[i]);
+      if (spin_once) {
+        return true;
+      }
+      any_ready_executable = true;
+    }
+  }
+  for (size_t i = 0; i < entities_collector_->get_number_of_waitables(); ++i) {
+    const auto & waitable = entities_collector_->get_waitable(i);
+    if (!waitable->is_ready(&wait_set_)) {
+      continue;
+    }
+    if (waitable.get() == entities_collector_.get()) {
+      // Entities were added or removed, collect them and prepare their storage again
+      AllocationGuard allow(AllocationCheck::None);
+      auto data = waitable->take_data();
+      waitable->execute(data);
+      prepare_slots();
+    } else {
+      AllocationAudit::Scope audit_scope(waitable.get(), AllocationSite::Waitable);
+      auto data = waitable->take_data();
+      waitable->execute(data);
+    }
+    if (spin_once) {
+      return true;
+    }
+    any_ready_executable = true;
+  }
+  return any_ready_executable;
+}
+
+void
+RealtimeExecutor::prepare_entities()
+{
+  if (!entities_collector_->is_init()) {
+    entities_collector_->init(&wait_set_, memory_strategy_);
+  }
+  prepare_slots();
+}
+
+void
+RealtimeExecutor::prepare_slots()
+{
+  const size_t number_of_subscriptions = entities_collector_->get_number_of_subscriptions();
+  for (size_t i = number_of_subscriptions; i < subscription_slots_.size(); ++i) {
+    release_subscription_slot(subscription_slots_[i]);
+  }
+  subscription_slots_.resize(number_of_subscriptions);
+  for (size_t i = 0; i < number_of_subscriptions; ++i) {
+    prepare_subscription_slot(subscription_slots_[i], entities_collector_->get_subscription(i));
+  }
+
+  service_slots_.resize(entities_collector_->get_number_of_services());
+  for (size_t i = 0; i < service_slots_.size(); ++i) {
+    prepare_service_slot(service_slots_[i], entities_collector_->get_service(i));
+  }
+
+  client_slots_.resize(entities_collector_->get_number_of_clients());
+  for (size_t i = 0; i < client_slots_.size(); ++i) {
+    prepare_client_slot(client_slots_[i], entities_collector_->get_client(i));
+  }
+}
+
+void
+RealtimeExecutor::prepare_subscription_slot(
+  Slot<rclcpp::SubscriptionBase> & slot,
+  const rclcpp::SubscriptionBase::SharedPtr & subscription)
+{
+  if (slot.entity == subscription) {
+    return;
+  }
+  release_subscription_slot(slot);
+  slot.entity = subscription;
+  if (subscription->is_serialized()) {
+    slot.serialized_message = subscription->create_serialized_message();
+    slot.use_count = slot.serialized_message.use_count();
+  } else if (!subscription->can_loan_messages()) {
+    slot.data = subscription->create_message();
+    slot.use_count = slot.data.use_count();
+  }
+}
+
+void
+RealtimeExecutor::prepare_service_slot(
+  Slot<rclcpp::ServiceBase> & slot, const rclcpp::ServiceBase::SharedPtr & service)
+{
+  if (slot.entity == service) {
+    return;
+  }
+  slot.entity = service;
+  slot.data = service->create_request();
+  slot.use_count = slot.data.use_count();
+  slot.request_header = service->create_request_header();
+}
+
+void
+RealtimeExecutor::prepare_client_slot(
+  Slot<rclcpp::ClientBase> & slot, const rclcpp::ClientBase::SharedPtr & client)
+{
+  if (slot.entity == client) {
+    return;
+  }
+  slot.entity = client;
+  slot.data = client->create_response();
+  slot.use_count = slot.data.use_count();
+  slot.request_header = client->create_request_header();
+}
+
+void
+RealtimeExecutor::release_subscription_slot(Slot<rclcpp::SubscriptionBase> & slot)
+{
+  if (!slot.entity) {
+    return;
+  }
+  if (slot.data) {
+    slot.entity->return_message(slot.data);
+  }
+  if (slot.serialized_message) {
+    slot.entity->return_serialized_message(slot.serialized_message);
+  }
+  slot = Slot<rclcpp::SubscriptionBase>();
+}
+
+void
+RealtimeExecutor::execute_subscription_slot(Slot<rclcpp::SubscriptionBase> & slot)
+{
+  AllocationAudit::Scope audit_scope(slot.entity.get(), AllocationSite::Subscription);
+  rclcpp::SubscriptionBase & subscription = *slot.entity;
+  if ((!slot.data && !slot.serialized_message) || subscription.get_prefetch_depth() > 0) {
+    // Loaned and prefetched messages don't need any storage from the executor
+    execute_subscription(slot.entity, max_messages_per_take_);
+    return;
+  }
+
+  size_t max_messages = subscription.get_max_messages_per_take();
+  if (0 == max_messages) {
+    max_messages = std::max<size_t>(max_messages_per_take_, 1);
+  }
+  for (size_t taken_count = 0; taken_count < max_messages; ++taken_count) {
+    rclcpp::MessageInfo message_info;
+    message_info.get_rmw_message_info().from_intra_process = false;
+
+    bool taken = false;
+    if (slot.serialized_message) {
+      taken = take_and_handle(
+        "taking a serialized message from topic", subscription.get_topic_name(),
+        [&]() {return subscription.take_serialized(*slot.serialized_message, message_info);},
+        [&]() {subscription.handle_serialized_message(slot.serialized_message, message_info);});
+      if (slot.serialized_message.use_count() > slot.use_count) {
+        // The callback kept the message, don't take into it anymore
+        subscription.return_serialized_message(slot.serialized_message);
+        slot.serialized_message = subscription.create_serialized_message();
+        slot.use_count = slot.serialized_message.use_count();
+      }
+    } else {
+      const bool needs_message_info = subscription.needs_message_info();
+      taken = take_and_handle(
+        "taking a message from topic", subscription.get_topic_name(),
+        [&]()
+        {
+          if (needs_message_info) {
+            return subscription.take_type_erased(slot.data.get(), message_info);
+          }
+          return subscription.take_type_erased_without_info(slot.data.get());
+        },
+        [&]() {subscription.handle_message(slot.data, message_info);});
+      if (slot.data.use_count() > slot.use_count) {
+        subscription.return_message(slot.data);
+        slot.data = subscription.create_message();
+        slot.use_count = slot.data.use_count();
+      }
+    }
+    if (!taken) {
+      break;
+    }
+  }
+}
+
+void
+RealtimeExecutor::execute_service_slot(Slot<rclcpp::ServiceBase> & slot)
+{
+  AllocationAudit::Scope audit_scope(slot.entity.get(), AllocationSite::Service);
+  rclcpp::ServiceBase & service = *slot.entity;
+  take_and_handle(
+    "taking a service server request from service", service.get_service_name(),
+    [&]() {return service.take_type_erased_request(slot.data.get(), *slot.request_header);},
+    [&]() {service.handle_request(slot.request_header, slot.data);});
+  // Deferred responses keep the request and its header
+  if (slot.data.use_count() > slot.use_count) {
+    slot.data = service.create_request();
+    slot.use_count = slot.data.use_count();
+  }
+  if (slot.request_header.use_count() > 1) {
+    slot.request_header = service.create_request_header();
+  }
+}
+
+void
+RealtimeExecutor::execute_client_slot(Slot<rclcpp::ClientBase> & slot)
+{
+  AllocationAudit::Scope audit_scope(slot.entity.get(), AllocationSite::Client);
+  rclcpp::ClientBase & client = *slot.entity;
+  take_and_handle(
+    "taking a service client response from service", client.get_service_name(),
+    [&]() {return client.take_type_erased_response(slot.data.get(), *slot.request_header);},
+    [&]() {client.handle_response(slot.request_header, slot.data);});
+  // The future of the request keeps its response
+  if (slot.data.use_count() > slot.use_count) {
+    slot.data = client.create_response();
+    slot.use_count = slot.data.use_count();
+  }
+  if (slot.request_header.use_count() > 1) {
+    slot.request_header = client.create_request_header();
+  }
+}
@@ -0,0 +1,347 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/executors/static_multi_threaded_executor.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "rcpputils/scope_exit.hpp"
+
+#include "rclcpp/logging.hpp"
+#include "rclcpp/thread.hpp"
+#include "rclcpp/utilities.hpp"
+
+using rclcpp::executors::StaticMultiThreadedExecutor;
+
+StaticMultiThreadedExecutor::StaticMultiThreadedExecutor(
+  const rclcpp::ExecutorOptions & options,
+  size_t number_of_threads)
+: StaticSingleThreadedExecutor(options),
+  thread_attributes_(options.thread_attributes)
+{
+  number_of_threads_ = number_of_threads > 0 ?
+    number_of_threads :
+    std::max(std::thread::hardware_concurrency(), 2U);
+
+  if (number_of_threads_ == 1) {
+    RCLCPP_WARN(
+      rclcpp::get_logger("rclcpp"),
+      "StaticMultiThreadedExecutor is used with a single thread.\n"
+      "Use the StaticSingleThreadedExecutor instead.");
+  }
+}
+
+StaticMultiThreadedExecutor::~StaticMultiThreadedExecutor() {}
+
+void
+StaticMultiThreadedExecutor::spin()
+{
+  if (spinning.exchange(true)) {
+    throw std::runtime_error("spin() called while already spinning");
+  }
+  RCPPUTILS_SCOPE_EXIT(this->spinning.store(false); );
+
+  // Set memory_strategy_ and exec_list_ based on weak_nodes_
+  // Prepare wait_set_ based on memory_strategy_
+  entities_collector_->init(&wait_set_, memory_strategy_);
+  build_entities_layout();
+
+  worker_queues_.clear();
+  for (size_t i = 0; i < number_of_threads_; ++i) {
+    worker_queues_.push_back(std::make_unique<WorkerQueue>());
+  }
+  workers_running_.store(true);
+
+  std::vector<rclcpp::Thread> threads;
+  auto stop_workers = [this, &threads]() {
+      workers_running_.store(false);
+      for (auto & queue : worker_queues_) {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        queue->cv.notify_all();
+      }
+      for (auto & thread : threads) {
+        thread.join();
+      }
+      threads.clear();
+      worker_queues_.clear();
+      std::lock_guard<std::mutex> lock(in_flight_mutex_);
+      in_flight_entities_.clear();
+    };
+
+  try {
+    for (size_t worker_id = 0; worker_id < number_of_threads_; ++worker_id) {
+      const rclcpp::ThreadAttributes attributes = worker_id < thread_attributes_.size() ?
+        thread_attributes_[worker_id] : rclcpp::ThreadAttributes();
+      threads.emplace_back(
+        attributes, std::bind(&StaticMultiThreadedExecutor::run_worker, this, worker_id));
+    }
+
+    while (rclcpp::ok(this->context_) && spinning.load()) {
+      // Refresh wait set and wait for work
+      entities_collector_->refresh_wait_set();
+      dispatch_ready_executables();
+    }
+  } catch (...) {
+    stop_workers();
+    throw;
+  }
+  stop_workers();
+}
+
+size_t
+StaticMultiThreadedExecutor::get_number_of_threads()
+{
+  return number_of_threads_;
+}
+
+void
+StaticMultiThreadedExecutor::build_entities_layout()
+{
+  entities_layout_.clear();
+  size_t next_worker = 0;
+  auto place = [this, &next_worker](
+    const void * entity, const rclcpp::CallbackGroup::SharedPtr & group, bool same_worker) {
+      entities_layout_[entity] = {next_worker, group};
+      if (!same_worker) {
+        next_worker = (next_worker + 1) % number_of_threads_;
+      }
+    };
+
+  for (const auto & weak_group : entities_collector_->get_all_callback_groups()) {
+    auto group = weak_group.lock();
+    if (!group) {
+      continue;
+    }
+    // The entities of a mutually exclusive group all go to the same worker.
+    bool same_worker = group->type() == rclcpp::CallbackGroupType::MutuallyExclusive;
+    group->find_timer_ptrs_if(
+      [&](const rclcpp::TimerBase::SharedPtr & timer) {
+        place(timer.get(), group, same_worker);
+        return false;
+      });
+    group->find_subscription_ptrs_if(
+      [&](const rclcpp::SubscriptionBase::SharedPtr & subscription) {
+        place(subscription.get(), group, same_worker);
+        return false;
+      });
+    group->find_service_ptrs_if(
+      [&](const rclcpp::ServiceBase::SharedPtr & service) {
+        place(service.get(), group, same_worker);
+        return false;
+      });
+    group->find_client_ptrs_if(
+      [&](const rclcpp::ClientBase::SharedPtr & client) {
+        place(client.get(), group, same_worker);
+        return false;
+      });
+    group->find_waitable_ptrs_if(
+      [&](const rclcpp::Waitable::SharedPtr & waitable) {
+        place(waitable.get(), group, same_worker);
+        return false;
+      });
+    if (same_worker) {
+      next_worker = (next_worker + 1) % number_of_threads_;
+    }
+  }
+}
+
+bool
+StaticMultiThreadedExecutor::is_in_flight(const void * entity)
+{
+  std::lock_guard<std::mutex> lock(in_flight_mutex_);
+  return in_flight_entities_.count(entity) != 0;
+}
+
+bool
+StaticMultiThreadedExecutor::dispatch(
+  const void * entity, std::unique_ptr<rclcpp::AnyExecutable> executable)
+{
+  auto it = entities_layout_.find(entity);
+  if (it == entities_layout_.end()) {
+    return false;
+  }
+  executable->callback_group = it->second.callback_group.lock();
+  if (!executable->callback_group) {
+    return false;
+  }
+  {
+    std::lock_guard<std::mutex> lock(in_flight_mutex_);
+    if (!in_flight_entities_.insert(entity).second) {
+      return false;
+    }
+  }
+  // The delay before execution is measured from the hand out to the worker
+  executable->ready_time = std::chrono::steady_clock::now();
+  auto & queue = *worker_queues_[it->second.worker_id];
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.executables.push_back(std::move(executable));
+  }
+  queue.cv.notify_one();
+  return true;
+}
+
+bool
+StaticMultiThreadedExecutor::dispatch_ready_executables()
+{
+  bool any_dispatched = false;
+  bool any_in_flight = false;
+  uint64_t completed_executions;
+  {
+    std::lock_guard<std::mutex> lock(in_flight_mutex_);
+    completed_executions = completed_executions_;
+  }
+
+  // Hand out all the ready subscriptions
+  for (size_t i = 0; i < wait_set_.size_of_subscriptions; ++i) {
+    if (i < entities_collector_->get_number_of_subscriptions() && wait_set_.subscriptions[i]) {
+      auto executable = std::make_unique<rclcpp::AnyExecutable>();
+      executable->subscription = entities_collector_->get_subscription(i);
+      const void * entity = executable->subscription.get();
+      if (dispatch(entity, std::move(executable))) {
+        any_dispatched = true;
+      } else {
+        any_in_flight = true;
+      }
+    }
+  }
+  // Hand out all the ready timers, a timer is marked as called before being handed out
+  for (size_t i = 0; i < wait_set_.size_of_timers; ++i) {
+    if (i < entities_collector_->get_number_of_timers() && wait_set_.timers[i]) {
+      auto timer = entities_collector_->get_timer(i);
+      if (is_in_flight(timer.get())) {
+        any_in_flight = true;
+        continue;
+      }
+      if (!timer->is_ready() || !timer->call()) {
+        continue;
+      }
+      auto executable = std::make_unique<rclcpp::AnyExecutable>();
+      executable->timer = timer;
+      if (dispatch(timer.get(), std::move(executable))) {
+        any_dispatched = true;
+      }
+    }
+  }
+  // Hand out all the ready services
+  for (size_t i = 0; i < wait_set_.size_of_services; ++i) {
+    if (i < entities_collector_->get_number_of_services() && wait_set_.services[i]) {
+      auto executable = std::make_unique<rclcpp::AnyExecutable>();
+      executable->service = entities_collector_->get_service(i);
+      const void * entity = executable->service.get();
+      if (dispatch(entity, std::move(executable))) {
+        any_dispatched = true;
+      } else {
+        any_in_flight = true;
+      }
+    }
+  }
+  // Hand out all the ready clients
+  for (size_t i = 0; i < wait_set_.size_of_clients; ++i) {
+    if (i < entities_collector_->get_number_of_clients() && wait_set_.clients[i]) {
+      auto executable = std::make_unique<rclcpp::AnyExecutable>();
+      executable->client = entities_collector_->get_client(i);
+      const void * entity = executable->client.get();
+      if (dispatch(entity, std::move(executable))) {
+        any_dispatched = true;
+      } else {
+        any_in_flight = true;
+      }
+    }
+  }
+  // Hand out all the ready waitables, their data is taken before waiting again
+  bool entities_changed = false;
+  for (size_t i = 0; i < entities_collector_->get_number_of_waitables(); ++i) {
+    auto waitable = entities_collector_->get_waitable(i);
+    if (!waitable->is_ready(&wait_set_)) {
+      continue;
+    }
+    if (waitable == entities_collector_) {
+      entities_changed = true;
+      continue;
+    }
+    if (is_in_flight(waitable.get())) {
+      any_in_flight = true;
+      continue;
+    }
+    auto executable = std::make_unique<rclcpp::AnyExecutable>();
+    executable->waitable = waitable;
+    executable->data = waitable->take_data();
+    if (dispatch(waitable.get(), std::move(executable))) {
+      any_dispatched = true;
+    }
+  }
+
+  if (entities_changed) {
+    // Rebuild the executable list, the wait set and the layout, this clears the wait set so
+    // it is done after handing out what was ready.
+    std::shared_ptr<void> data = entities_collector_->take_data();
+    entities_collector_->execute(data);
+    build_entities_layout();
+  } else if (!any_dispatched && any_in_flight) {
+    // Everything ready is still executing, waiting again would return right away.
+    std::unique_lock<std::mutex> lock(in_flight_mutex_);
+    in_flight_cv_.wait_for(
+      lock, std::chrono::milliseconds(10),
+      [this, completed_executions]() {
+        return completed_executions_ != completed_executions || !spinning.load();
+      });
+  }
+  return any_dispatched;
+}
+
+void
+StaticMultiThreadedExecutor::run_worker(size_t worker_id)
+{
+  auto & queue = *worker_queues_[worker_id];
+  while (true) {
+    std::unique_ptr<rclcpp::AnyExecutable> executable;
+    {
+      std::unique_lock<std::mutex> lock(queue.mutex);
+      queue.cv.wait(
+        lock, [this, &queue]() {return !queue.executables.empty() || !workers_running_.load();});
+      if (!workers_running_.load()) {
+        return;
+      }
+      executable = std::move(queue.executables.front());
+      queue.executables.pop_front();
+    }
+
+    const void * entity = nullptr;
+    if (executable->subscription) {
+      entity = executable->subscription.get();
+    } else if (executable->timer) {
+      entity = executable->timer.get();
+    } else if (executable->service) {
+      entity = executable->service.get();
+    } else if (executable->client) {
+      entity = executable->client.get();
+    } else if (executable->waitable) {
+      entity = executable->waitable.get();
+    }
+    execute_any_executable(*executable);
+
+    // The entity can be handed out again
+    std::lock_guard<std::mutex> lock(in_flight_mutex_);
+    in_flight_entities_.erase(entity);
+    completed_executions_++;
+    in_flight_cv_.notify_one();
+  }
+}
@@ -16,6 +16,7 @@
 
 #include <chrono>
 #include <memory>
+#include <stdexcept>
 #include <utility>
 #include <vector>
 
@@ -77,6 +78,14 @@ StaticSingleThreadedExecutor::spin_all(std::chrono::nanoseconds max_duration)
   return this->spin_some_impl(max_duration, true);
 }
 
+void
+StaticSingleThreadedExecutor::spin_some_with_quotas(const rclcpp::SpinQuotas & quotas)
+{
+  (void)quotas;
+  throw std::runtime_error(
+          "spin_some_with_quotas() is not supported by the StaticSingleThreadedExecutor");
+}
+
 void
 StaticSingleThreadedExecutor::spin_some_impl(std::chrono::nanoseconds max_duration, bool exhaustive)
 {
@@ -213,24 +222,23 @@ bool
 StaticSingleThreadedExecutor::execute_ready_executables(bool spin_once)
 {
   bool any_ready_executable = false;
+  ready_indices_.collect(wait_set_);
 
   // Execute all the ready subscriptions
-  for (size_t i = 0; i < wait_set_.size_of_subscriptions; ++i) {
+  for (size_t i : ready_indices_.subscriptions) {
     if (i < entities_collector_->get_number_of_subscriptions()) {
-      if (wait_set_.subscriptions[i]) {
-        execute_subscription(entities_collector_->get_subscription(i));
-        if (spin_once) {
-          return true;
-        }
-        any_ready_executable = true;
+      execute_subscription(entities_collector_->get_subscription(i), max_messages_per_take_);
+      if (spin_once) {
+        return true;
       }
+      any_ready_executable = true;
     }
   }
   // Execute all the ready timers
-  for (size_t i = 0; i < wait_set_.size_of_timers; ++i) {
+  for (size_t i : ready_indices_.timers) {
     if (i < entities_collector_->get_number_of_timers()) {
-      if (wait_set_.timers[i] && entities_collector_->get_timer(i)->is_ready()) {
-        auto timer = entities_collector_->get_timer(i);
+      auto timer = entities_collector_->get_timer(i);
+      if (timer->is_ready()) {
         timer->call();
         execute_timer(std::move(timer));
         if (spin_once) {
@@ -241,27 +249,23 @@ StaticSingleThreadedExecutor::execute_ready_executables(bool spin_once)
     }
   }
   // Execute all the ready services
-  for (size_t i = 0; i < wait_set_.size_of_services; ++i) {
+  for (size_t i : ready_indices_.services) {
     if (i < entities_collector_->get_number_of_services()) {
-      if (wait_set_.services[i]) {
-        execute_service(entities_collector_->get_service(i));
-        if (spin_once) {
-          return true;
-        }
-        any_ready_executable = true;
+      execute_service(entities_collector_->get_service(i));
+      if (spin_once) {
+        return true;
       }
+      any_ready_executable = true;
     }
   }
   // Execute all the ready clients
-  for (size_t i = 0; i < wait_set_.size_of_clients; ++i) {
+  for (size_t i : ready_indices_.clients) {
     if (i < entities_collector_->get_number_of_clients()) {
-      if (wait_set_.clients[i]) {
-        execute_client(entities_collector_->get_client(i));
-        if (spin_once) {
-          return true;
-        }
-        any_ready_executable = true;
+      execute_client(entities_collector_->get_client(i));
+      if (spin_once) {
+        return true;
       }
+      any_ready_executable = true;
     }
   }
   // Execute all the ready waitables
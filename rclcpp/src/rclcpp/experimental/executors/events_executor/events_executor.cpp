@@ -0,0 +1,629 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/experimental/executors/events_executor/events_executor.hpp"
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rcpputils/scope_exit.hpp"
+
+#include "rclcpp/exceptions.hpp"
+#include "rclcpp/logging.hpp"
+
+using namespace std::chrono_literals;
+
+using rclcpp::experimental::executors::EventsExecutor;
+using rclcpp::experimental::executors::ExecutorEvent;
+using rclcpp::experimental::executors::ExecutorEventType;
+
+namespace
+{
+
+/// Register callbacks for the entities that appear in next_entities and not in current_entities,
+/// unregister them for the ones that disappeared, then make current_entities match.
+template<typename EntityT, typename SetCallbackT, typename ClearCallbackT>
+void
+update_entities(
+  std::unordered_map<const void *, typename EntityT::WeakPtr> & current_entities,
+  const std::unordered_map<const void *, typename EntityT::WeakPtr> & next_entities,
+  SetCallbackT set_callback,
+  ClearCallbackT clear_callback)
+{
+  // Remove entities that are not there anymore, entries that expired are also dropped so that
+  // a new entity allocated at the same address gets its callback registered below.
+  for (auto it = current_entities.begin(); it != current_entities.end(); ) {
+    auto entity = it->second.lock();
+    if (!entity || next_entities.count(it->first) == 0) {
+      if (entity) {
+        clear_callback(entity);
+      }
+      it = current_entities.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  // Add new entities
+  for (const auto & pair : next_entities) {
+    if (current_entities.count(pair.first) != 0) {
+      continue;
+    }
+    auto entity = pair.second.lock();
+    if (entity) {
+      set_callback(entity);
+      current_entities.insert(pair);
+    }
+  }
+}
+
+}  // namespace
+
+EventsExecutor::EventsExecutor(
+  rclcpp::experimental::executors::EventsQueue::UniquePtr events_queue,
+  bool execute_timers_separate_thread,
+  const rclcpp::ExecutorOptions & options)
+: rclcpp::Executor(options),
+  events_queue_(std::move(events_queue))
+{
+  if (!events_queue_) {
+    throw std::invalid_argument("events_queue can't be a null pointer");
+  }
+
+  // The timers manager can be used either to only track timers (in this case an expired
+  // timer will generate an executor event and then it will be executed by the executor thread)
+  // or it can also take care of executing expired timers in its dedicated thread.
+  std::function<void(const rclcpp::TimerBase *)> timer_on_ready_cb = nullptr;
+  if (!execute_timers_separate_thread) {
+    timer_on_ready_cb = [this](const rclcpp::TimerBase * timer_id) {
+        ExecutorEvent event = {timer_id, -1, ExecutorEventType::TIMER_EVENT, 1};
+        this->events_queue_->enqueue(event);
+      };
+  }
+  timers_manager_ =
+    std::make_shared<rclcpp::experimental::TimersManager>(context_, timer_on_ready_cb);
+
+  // The interrupt and shutdown guard conditions are never added to a wait set by this executor,
+  // triggering them pushes an event that wakes up the spinning thread instead.
+  interrupt_guard_condition_.set_on_trigger_callback(this->create_notify_callback());
+  shutdown_guard_condition_->set_on_trigger_callback(this->create_notify_callback());
+}
+
+EventsExecutor::~EventsExecutor()
+{
+  timers_manager_->stop();
+  this->clear_all_callbacks();
+}
+
+void
+EventsExecutor::spin()
+{
+  if (spinning.exchange(true)) {
+    throw std::runtime_error("spin() called while already spinning");
+  }
+  RCPPUTILS_SCOPE_EXIT(this->spinning.store(false); );
+
+  timers_manager_->start();
+  RCPPUTILS_SCOPE_EXIT(timers_manager_->stop(); );
+
+  while (rclcpp::ok(context_) && spinning.load()) {
+    // Wait until we get an event
+    ExecutorEvent event;
+    bool has_event = events_queue_->dequeue(event);
+    if (has_event) {
+      this->execute_event(event);
+    }
+  }
+}
+
+void
+EventsExecutor::spin_some(std::chrono::nanoseconds max_duration)
+{
+  return this->spin_some_impl(max_duration, false);
+}
+
+void
+EventsExecutor::spin_all(std::chrono::nanoseconds max_duration)
+{
+  if (max_duration < 0ns) {
+    throw std::invalid_argument("max_duration must be greater than or equal to 0");
+  }
+  return this->spin_some_impl(max_duration, true);
+}
+
+void
+EventsExecutor::spin_some_with_quotas(const rclcpp::SpinQuotas & quotas)
+{
+  (void)quotas;
+  throw std::runtime_error("spin_some_with_quotas() is not supported by the EventsExecutor");
+}
+
+void
+EventsExecutor::spin_some_impl(std::chrono::nanoseconds max_duration, bool exhaustive)
+{
+  if (spinning.exchange(true)) {
+    throw std::runtime_error("spin_some() called while already spinning");
+  }
+  RCPPUTILS_SCOPE_EXIT(this->spinning.store(false); );
+
+  auto start = std::chrono::steady_clock::now();
+  auto max_duration_not_elapsed = [max_duration, start]() {
+      if (std::chrono::nanoseconds(0) == max_duration) {
+        // told to spin forever if need be
+        return true;
+      } else if (std::chrono::steady_clock::now() - start < max_duration) {
+        // told to spin only for some maximum amount of time
+        return true;
+      }
+      // spun too long
+      return false;
+    };
+
+  // Get the number of events and timers ready at start
+  const size_t ready_events_at_start = events_queue_->size();
+  size_t executed_events = 0;
+  const size_t ready_timers_at_start = timers_manager_->get_number_ready_timers();
+  size_t executed_timers = 0;
+
+  while (rclcpp::ok(context_) && spinning.load() && max_duration_not_elapsed()) {
+    // Execute first ready event from queue if exists
+    if (exhaustive || (executed_events < ready_events_at_start)) {
+      ExecutorEvent event;
+      bool has_event = events_queue_->dequeue(event, 0ns);
+      if (has_event) {
+        this->execute_event(event);
+        executed_events++;
+        continue;
+      }
+    }
+
+    // Execute first timer if it is ready
+    if (exhaustive || (executed_timers < ready_timers_at_start)) {
+      bool timer_executed = timers_manager_->execute_head_timer();
+      if (timer_executed) {
+        executed_timers++;
+        continue;
+      }
+    }
+
+    // If there's no more work available, exit
+    break;
+  }
+}
+
+void
+EventsExecutor::spin_once_impl(std::chrono::nanoseconds timeout)
+{
+  // In this context a negative input timeout means no timeout
+  if (timeout < 0ns) {
+    timeout = rclcpp::experimental::TimersManager::MAX_TIME;
+  }
+
+  // Select the smallest between input timeout and timer timeout
+  bool is_timer_timeout = false;
+  auto next_timer_timeout = timers_manager_->get_head_timeout();
+  if (next_timer_timeout < timeout) {
+    timeout = next_timer_timeout < 0ns ? 0ns : next_timer_timeout;
+    is_timer_timeout = true;
+  }
+
+  ExecutorEvent event;
+  bool has_event = events_queue_->dequeue(event, timeout);
+
+  // If we wake up from the wait with an event, it means that it
+  // arrived before any of the timers expired.
+  if (has_event) {
+    this->execute_event(event);
+  } else if (is_timer_timeout) {
+    timers_manager_->execute_head_timer();
+  }
+}
+
+void
+EventsExecutor::add_node(
+  rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_ptr, bool notify)
+{
+  // This field is unused because there is no wait set to rebuild: the executor does not need
+  // to be woken up when a node is added.
+  (void)notify;
+
+  rclcpp::Executor::add_node(node_ptr, false);
+  this->refresh_current_collection_from_callback_groups();
+}
+
+void
+EventsExecutor::add_node(std::shared_ptr<rclcpp::Node> node_ptr, bool notify)
+{
+  this->add_node(node_ptr->get_node_base_interface(), notify);
+}
+
+void
+EventsExecutor::remove_node(
+  rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_ptr, bool notify)
+{
+  // This field is unused because we don't have to wake up the executor when a node is removed.
+  (void)notify;
+
+  rclcpp::Executor::remove_node(node_ptr, false);
+  this->refresh_current_collection_from_callback_groups();
+}
+
+void
+EventsExecutor::remove_node(std::shared_ptr<rclcpp::Node> node_ptr, bool notify)
+{
+  this->remove_node(node_ptr->get_node_base_interface(), notify);
+}
+
+void
+EventsExecutor::add_callback_group(
+  rclcpp::CallbackGroup::SharedPtr group_ptr,
+  rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_ptr,
+  bool notify)
+{
+  // This field is unused because we don't have to wake up
+  // the executor when a callback group is added.
+  (void)notify;
+
+  rclcpp::Executor::add_callback_group(group_ptr, node_ptr, false);
+  this->refresh_current_collection_from_callback_groups();
+}
+
+void
+EventsExecutor::remove_callback_group(
+  rclcpp::CallbackGroup::SharedPtr group_ptr, bool notify)
+{
+  // This field is unused because we don't have to wake up
+  // the executor when a callback group is removed.
+  (void)notify;
+
+  rclcpp::Executor::remove_callback_group(group_ptr, false);
+  this->refresh_current_collection_from_callback_groups();
+}
+
+void
+EventsExecutor::execute_event(const ExecutorEvent & event)
+{
+  switch (event.type) {
+    case ExecutorEventType::CLIENT_EVENT:
+      {
+        auto client = this->retrieve_entity<rclcpp::ClientBase>(event.entity_key, clients_);
+        if (client) {
+          for (size_t i = 0; i < event.num_events; i++) {
+            execute_client(client);
+          }
+        }
+        break;
+      }
+    case ExecutorEventType::SUBSCRIPTION_EVENT:
+      {
+        auto subscription =
+          this->retrieve_entity<rclcpp::SubscriptionBase>(event.entity_key, subscriptions_);
+        if (subscription) {
+          for (size_t i = 0; i < event.num_events; i++) {
+            execute_subscription(subscription);
+          }
+        }
+        break;
+      }
+    case ExecutorEventType::SERVICE_EVENT:
+      {
+        auto service = this->retrieve_entity<rclcpp::ServiceBase>(event.entity_key, services_);
+        if (service) {
+          for (size_t i = 0; i < event.num_events; i++) {
+            execute_service(service);
+          }
+        }
+        break;
+      }
+    case ExecutorEventType::TIMER_EVENT:
+      {
+        timers_manager_->execute_ready_timer(
+          static_cast<const rclcpp::TimerBase *>(event.entity_key));
+        break;
+      }
+    case ExecutorEventType::WAITABLE_EVENT:
+      {
+        auto waitable = this->retrieve_entity<rclcpp::Waitable>(event.entity_key, waitables_);
+        if (waitable) {
+          for (size_t i = 0; i < event.num_events; i++) {
+            auto data = waitable->take_data_by_entity_id(event.waitable_data);
+            waitable->execute(data);
+          }
+        }
+        break;
+      }
+    case ExecutorEventType::NOTIFY_EVENT:
+      {
+        // Any number of triggers is handled by a single refresh of the collection.
+        if (rclcpp::ok(context_) && spinning.load()) {
+          this->refresh_current_collection_from_callback_groups();
+        }
+        break;
+      }
+  }
+}
+
+void
+EventsExecutor::refresh_current_collection_from_callback_groups()
+{
+  std::lock_guard<std::mutex> guard{mutex_};
+
+  // Pick up the callback groups created by associated nodes since the last refresh.
+  this->add_callback_groups_from_nodes_associated_to_executor();
+
+  // Drop the callback groups whose group or node has been destroyed.
+  for (auto it = weak_groups_to_nodes_.begin(); it != weak_groups_to_nodes_.end(); ) {
+    if (!it->first.expired() && !it->second.expired()) {
+      ++it;
+      continue;
+    }
+    weak_groups_to_nodes_associated_with_executor_.erase(it->first);
+    weak_groups_associated_with_executor_to_nodes_.erase(it->first);
+    auto gc_it = weak_groups_to_guard_conditions_.find(it->first);
+    if (gc_it != weak_groups_to_guard_conditions_.end()) {
+      memory_strategy_->remove_guard_condition(gc_it->second);
+      weak_groups_to_guard_conditions_.erase(gc_it);
+    }
+    it = weak_groups_to_nodes_.erase(it);
+  }
+
+  this->refresh_notify_guard_conditions();
+
+  // Collect all the entities of the callback groups associated with the executor.
+  EntitiesMap<rclcpp::SubscriptionBase> next_subscriptions;
+  EntitiesMap<rclcpp::ServiceBase> next_services;
+  EntitiesMap<rclcpp::ClientBase> next_clients;
+  EntitiesMap<rclcpp::TimerBase> next_timers;
+  EntitiesMap<rclcpp::Waitable> next_waitables;
+  for (const auto & pair : weak_groups_to_nodes_) {
+    auto group = pair.first.lock();
+    if (!group) {
+      continue;
+    }
+    group->collect_all_ptrs(
+      [&next_subscriptions](const rclcpp::SubscriptionBase::SharedPtr & subscription) {
+        next_subscriptions.emplace(subscription.get(), subscription);
+      },
+      [&next_services](const rclcpp::ServiceBase::SharedPtr & service) {
+        next_services.emplace(service.get(), service);
+      },
+      [&next_clients](const rclcpp::ClientBase::SharedPtr & client) {
+        next_clients.emplace(client.get(), client);
+      },
+      [&next_timers](const rclcpp::TimerBase::SharedPtr & timer) {
+        next_timers.emplace(timer.get(), timer);
+      },
+      [&next_waitables](const rclcpp::Waitable::SharedPtr & waitable) {
+        next_waitables.emplace(waitable.get(), waitable);
+      });
+  }
+
+  std::lock_guard<std::recursive_mutex> lock(collection_mutex_);
+
+  update_entities<rclcpp::TimerBase>(
+    timers_, next_timers,
+    [this](rclcpp::TimerBase::SharedPtr timer) {
+      timers_manager_->add_timer(timer);
+    },
+    [this](rclcpp::TimerBase::SharedPtr timer) {
+      timers_manager_->remove_timer(timer);
+    });
+
+  update_entities<rclcpp::SubscriptionBase>(
+    subscriptions_, next_subscriptions,
+    [this](rclcpp::SubscriptionBase::SharedPtr subscription) {
+      subscription->set_on_new_message_callback(
+        this->create_entity_callback(subscription.get(), ExecutorEventType::SUBSCRIPTION_EVENT));
+    },
+    [](rclcpp::SubscriptionBase::SharedPtr subscription) {
+      subscription->clear_on_new_message_callback();
+    });
+
+  update_entities<rclcpp::ServiceBase>(
+    services_, next_services,
+    [this](rclcpp::ServiceBase::SharedPtr service) {
+      service->set_on_new_request_callback(
+        this->create_entity_callback(service.get(), ExecutorEventType::SERVICE_EVENT));
+    },
+    [](rclcpp::ServiceBase::SharedPtr service) {
+      service->clear_on_new_request_callback();
+    });
+
+  update_entities<rclcpp::ClientBase>(
+    clients_, next_clients,
+    [this](rclcpp::ClientBase::SharedPtr client) {
+      client->set_on_new_response_callback(
+        this->create_entity_callback(client.get(), ExecutorEventType::CLIENT_EVENT));
+    },
+    [](rclcpp::ClientBase::SharedPtr client) {
+      client->clear_on_new_response_callback();
+    });
+
+  update_entities<rclcpp::Waitable>(
+    waitables_, next_waitables,
+    [this](rclcpp::Waitable::SharedPtr waitable) {
+      try {
+        waitable->set_on_ready_callback(this->create_waitable_callback(waitable.get()));
+      } catch (const std::runtime_error & ex) {
+        // Custom waitables are not required to support the listener APIs.
+        RCLCPP_WARN(
+          rclcpp::get_logger("rclcpp"),
+          "EventsExecutor can't execute waitable %p: %s",
+          static_cast<const void *>(waitable.get()), ex.what());
+      }
+    },
+    [](rclcpp::Waitable::SharedPtr waitable) {
+      try {
+        waitable->clear_on_ready_callback();
+      } catch (const std::runtime_error &) {
+        // Nothing was registered for waitables that don't support the listener APIs.
+      }
+    });
+}
+
+void
+EventsExecutor::refresh_notify_guard_conditions()
+{
+  // Nodes: their notify guard condition is triggered when callback groups are created.
+  WeakNodesToGuardConditionsMap next_node_guard_conditions;
+  for (const auto & weak_node : weak_nodes_) {
+    auto node = weak_node.lock();
+    if (!node) {
+      continue;
+    }
+    auto it = notify_guard_conditions_of_nodes_.find(weak_node);
+    if (it != notify_guard_conditions_of_nodes_.end()) {
+      next_node_guard_conditions.insert(*it);
+      continue;
+    }
+    rclcpp::GuardCondition * guard_condition = &node->get_notify_guard_condition();
+    guard_condition->set_on_trigger_callback(this->create_notify_callback());
+    next_node_guard_conditions.emplace(weak_node, guard_condition);
+  }
+  for (const auto & pair : notify_guard_conditions_of_nodes_) {
+    if (next_node_guard_conditions.count(pair.first) != 0) {
+      continue;
+    }
+    // Only touch the guard condition if the node owning it is still alive.
+    auto node = pair.first.lock();
+    if (node) {
+      pair.second->set_on_trigger_callback(nullptr);
+    }
+  }
+  notify_guard_conditions_of_nodes_ = std::move(next_node_guard_conditions);
+
+  // Callback groups: their notify guard condition is triggered when entities are created.
+  WeakCallbackGroupsToWeakGuardConditionsMap next_group_guard_conditions;
+  for (const auto & pair : weak_groups_to_nodes_) {
+    auto group = pair.first.lock();
+    auto node = pair.second.lock();
+    if (!group || !node || !node->get_context()->is_valid()) {
+      continue;
+    }
+    auto it = notify_guard_conditions_of_groups_.find(pair.first);
+    if (it != notify_guard_conditions_of_groups_.end() && !it->second.expired()) {
+      next_group_guard_conditions.insert(*it);
+      continue;
+    }
+    auto guard_condition = group->get_notify_guard_condition(node->get_context());
+    guard_condition->set_on_trigger_callback(this->create_notify_callback());
+    next_group_guard_conditions.emplace(pair.first, guard_condition);
+  }
+  for (const auto & pair : notify_guard_conditions_of_groups_) {
+    if (next_group_guard_conditions.count(pair.first) != 0) {
+      continue;
+    }
+    auto guard_condition = pair.second.lock();
+    if (guard_condition) {
+      guard_condition->set_on_trigger_callback(nullptr);
+    }
+  }
+  notify_guard_conditions_of_groups_ = std::move(next_group_guard_conditions);
+}
+
+void
+EventsExecutor::clear_all_callbacks()
+{
+  {
+    std::lock_guard<std::mutex> guard{mutex_};
+    for (const auto & pair : notify_guard_conditions_of_nodes_) {
+      auto node = pair.first.lock();
+      if (node) {
+        pair.second->set_on_trigger_callback(nullptr);
+      }
+    }
+    notify_guard_conditions_of_nodes_.clear();
+    for (const auto & pair : notify_guard_conditions_of_groups_) {
+      auto guard_condition = pair.second.lock();
+      if (guard_condition) {
+        guard_condition->set_on_trigger_callback(nullptr);
+      }
+    }
+    notify_guard_conditions_of_groups_.clear();
+  }
+
+  {
+    std::lock_guard<std::recursive_mutex> lock(collection_mutex_);
+    for (const auto & pair : subscriptions_) {
+      auto subscription = pair.second.lock();
+      if (subscription) {
+        subscription->clear_on_new_message_callback();
+      }
+    }
+    subscriptions_.clear();
+    for (const auto & pair : services_) {
+      auto service = pair.second.lock();
+      if (service) {
+        service->clear_on_new_request_callback();
+      }
+    }
+    services_.clear();
+    for (const auto & pair : clients_) {
+      auto client = pair.second.lock();
+      if (client) {
+        client->clear_on_new_response_callback();
+      }
+    }
+    clients_.clear();
+    for (const auto & pair : waitables_) {
+      auto waitable = pair.second.lock();
+      if (waitable) {
+        try {
+          waitable->clear_on_ready_callback();
+        } catch (const std::runtime_error &) {
+          // Nothing was registered for waitables that don't support the listener APIs.
+        }
+      }
+    }
+    waitables_.clear();
+    timers_.clear();
+    timers_manager_->clear();
+  }
+
+  interrupt_guard_condition_.set_on_trigger_callback(nullptr);
+  shutdown_guard_condition_->set_on_trigger_callback(nullptr);
+}
+
+std::function<void(size_t)>
+EventsExecutor::create_entity_callback(const void * entity_key, ExecutorEventType event_type)
+{
+  std::function<void(size_t)> callback = [this, entity_key, event_type](size_t num_events) {
+      ExecutorEvent event = {entity_key, -1, event_type, num_events};
+      this->events_queue_->enqueue(event);
+    };
+  return callback;
+}
+
+std::function<void(size_t, int)>
+EventsExecutor::create_waitable_callback(const rclcpp::Waitable * entity_key)
+{
+  std::function<void(size_t, int)> callback = [this, entity_key](size_t num_events, int id) {
+      ExecutorEvent event = {entity_key, id, ExecutorEventType::WAITABLE_EVENT, num_events};
+      this->events_queue_->enqueue(event);
+    };
+  return callback;
+}
+
+std::function<void(size_t)>
+EventsExecutor::create_notify_callback()
+{
+  std::function<void(size_t)> callback = [this](size_t num_events) {
+      ExecutorEvent event = {this, -1, ExecutorEventType::NOTIFY_EVENT, num_events};
+      this->events_queue_->enqueue(event);
+    };
+  return callback;
+}
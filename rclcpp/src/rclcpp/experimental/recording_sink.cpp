@@ -0,0 +1,557 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "rclcpp/experimental/recording_sink.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+using rclcpp::experimental::RecordingEntry;
+using rclcpp::experimental::RecordingSegmentReader;
+using rclcpp::experimental::RecordingSink;
+using rclcpp::experimental::RecordingSinkStatistics;
+using rclcpp::experimental::RecordingTopic;
+
+namespace
+{
+
+constexpr char segment_magic[8] = {'R', 'C', 'L', 'R', 'S', 'E', 'G', '1'};
+constexpr char index_magic[8] = {'R', 'C', 'L', 'R', 'I', 'D', 'X', '1'};
+
+/// Beginning of a segment file, completed when the segment is closed.
+struct SegmentHeader
+{
+  char magic[8];
+  uint64_t data_size;
+  uint64_t record_count;
+};
+
+/// Beginning of each record of a segment file, followed by the serialized data.
+struct RecordHeader
+{
+  int64_t source_timestamp;
+  int64_t received_timestamp;
+  uint32_t topic_id;
+  uint32_t size;
+};
+
+/// Beginning of an index file, followed by the topics and the index entries.
+struct IndexHeader
+{
+  char magic[8];
+  uint32_t topic_count;
+  uint32_t reserved;
+  uint64_t record_count;
+};
+
+/// Beginning of a topic in an index file, followed by its name and its type.
+struct IndexTopicHeader
+{
+  uint32_t id;
+  uint32_t name_size;
+  uint32_t type_size;
+  uint32_t reserved;
+};
+
+constexpr size_t record_alignment = 8;
+
+size_t
+aligned_size(size_t size)
+{
+  return (size + record_alignment - 1) & ~(record_alignment - 1);
+}
+
+[[noreturn]] void
+throw_errno(const std::string & what)
+{
+  throw std::system_error(errno, std::generic_category(), what);
+}
+
+std::string
+index_path_of(const std::string & segment_path)
+{
+  return std::filesystem::path(segment_path).replace_extension(".idx").string();
+}
+
+template<typename T>
+void
+append_bytes(std::vector<uint8_t> & buffer, const T & value)
+{
+  const auto bytes = reinterpret_cast<const uint8_t *>(&value);
+  buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+template<typename T>
+T
+read_bytes(const std::vector<uint8_t> & buffer, size_t & offset)
+{
+  if (offset + sizeof(T) > buffer.size()) {
+    throw std::runtime_error("truncated recording index");
+  }
+  T value;
+  std::memcpy(&value, buffer.data() + offset, sizeof(T));
+  offset += sizeof(T);
+  return value;
+}
+
+/// Entry of a record in an index file.
+struct IndexEntry
+{
+  uint64_t offset;
+  uint64_t size;
+  int64_t source_timestamp;
+  int64_t received_timestamp;
+  uint32_t topic_id;
+  uint32_t reserved;
+};
+
+}  // namespace
+
+/// A segment file mapped in memory, with the index of its records.
+class RecordingSink::Segment
+{
+public:
+  Segment(std::string path, size_t size, size_t max_records)
+  : path_(std::move(path)), capacity_(size), max_records_(max_records)
+  {
+    // Reserved once, so that the records don't allocate
+    entries_.reserve(max_records_);
+#ifdef _WIN32
+    throw std::runtime_error("the recording sink is not supported on Windows");
+#else
+    fd_ = ::open(path_.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0) {
+      throw_errno("failed to open recording segment '" + path_ + "'");
+    }
+#ifdef __linux__
+    // Allocate the blocks now rather than on the page faults of the records
+    int ret = ::posix_fallocate(fd_, 0, static_cast<off_t>(capacity_));
+#else
+    int ret = ::ftruncate(fd_, static_cast<off_t>(capacity_)) == 0 ? 0 : errno;
+#endif
+    if (ret != 0) {
+      ::close(fd_);
+      errno = ret;
+      throw_errno("failed to allocate recording segment '" + path_ + "'");
+    }
+    void * data = ::mmap(nullptr, capacity_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (data == MAP_FAILED) {
+      int error = errno;
+      ::close(fd_);
+      errno = error;
+      throw_errno("failed to map recording segment '" + path_ + "'");
+    }
+    data_ = static_cast<uint8_t *>(data);
+    SegmentHeader header{};
+    std::memcpy(header.magic, segment_magic, sizeof(segment_magic));
+    std::memcpy(data_, &header, sizeof(header));
+    used_ = sizeof(SegmentHeader);
+#endif
+  }
+
+  ~Segment()
+  {
+    if (data_) {
+      try {
+        close({});
+      } catch (...) {
+        // The index is lost, the records stay in the segment file
+      }
+    }
+  }
+
+  /// Return true if a message of the given size fits in the remaining space.
+  bool
+  can_append(size_t size) const
+  {
+    return entries_.size() < max_records_ &&
+           sizeof(RecordHeader) + aligned_size(size) <= capacity_ - used_;
+  }
+
+  bool
+  empty() const
+  {
+    return entries_.empty();
+  }
+
+  void
+  append(
+    uint32_t topic_id,
+    const rclcpp::SerializedMessageView & message,
+    int64_t source_timestamp,
+    int64_t received_timestamp)
+  {
+    RecordHeader header{
+      source_timestamp, received_timestamp, topic_id, static_cast<uint32_t>(message.size())};
+    std::memcpy(data_ + used_, &header, sizeof(header));
+    const size_t offset = used_ + sizeof(header);
+    if (!message.empty()) {
+      std::memcpy(data_ + offset, message.data(), message.size());
+    }
+    entries_.push_back(
+      {offset, message.size(), source_timestamp, received_timestamp, topic_id, 0u});
+    used_ = offset + aligned_size(message.size());
+  }
+
+  void
+  flush()
+  {
+#ifndef _WIN32
+    if (data_ && ::msync(data_, used_, MS_ASYNC) != 0) {
+      throw_errno("failed to flush recording segment '" + path_ + "'");
+    }
+#endif
+  }
+
+  /// Complete the header, unmap and truncate the segment, then write its index.
+  void
+  close(const std::vector<RecordingTopic> & topics)
+  {
+#ifndef _WIN32
+    SegmentHeader header{};
+    std::memcpy(header.magic, segment_magic, sizeof(segment_magic));
+    header.data_size = used_;
+    header.record_count = entries_.size();
+    std::memcpy(data_, &header, sizeof(header));
+    ::munmap(data_, capacity_);
+    data_ = nullptr;
+    int ret = ::ftruncate(fd_, static_cast<off_t>(used_));
+    int error = errno;
+    ::close(fd_);
+    if (ret != 0) {
+      errno = error;
+      throw_errno("failed to truncate recording segment '" + path_ + "'");
+    }
+
+    std::vector<uint8_t> index;
+    IndexHeader index_header{};
+    std::memcpy(index_header.magic, index_magic, sizeof(index_magic));
+    index_header.topic_count = static_cast<uint32_t>(topics.size());
+    index_header.record_count = entries_.size();
+    append_bytes(index, index_header);
+    for (const auto & topic : topics) {
+      IndexTopicHeader topic_header{
+        topic.id, static_cast<uint32_t>(topic.name.size()),
+        static_cast<uint32_t>(topic.type.size()), 0u};
+      append_bytes(index, topic_header);
+      index.insert(index.end(), topic.name.begin(), topic.name.end());
+      index.insert(index.end(), topic.type.begin(), topic.type.end());
+      index.resize(aligned_size(index.size()), 0u);
+    }
+    const auto entries_bytes = reinterpret_cast<const uint8_t *>(entries_.data());
+    index.insert(index.end(), entries_bytes, entries_bytes + entries_.size() * sizeof(IndexEntry));
+
+    const std::string index_path = index_path_of(path_);
+    int index_fd = ::open(index_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (index_fd < 0) {
+      throw_errno("failed to open recording index '" + index_path + "'");
+    }
+    size_t written = 0;
+    while (written < index.size()) {
+      ssize_t count = ::write(index_fd, index.data() + written, index.size() - written);
+      if (count < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        error = errno;
+        ::close(index_fd);
+        errno = error;
+        throw_errno("failed to write recording index '" + index_path + "'");
+      }
+      written += static_cast<size_t>(count);
+    }
+    ::close(index_fd);
+#else
+    (void)topics;
+#endif
+  }
+
+  const std::string &
+  get_path() const
+  {
+    return path_;
+  }
+
+private:
+  const std::string path_;
+  const size_t capacity_;
+  const size_t max_records_;
+  int fd_ = -1;
+  uint8_t * data_ = nullptr;
+  size_t used_ = 0;
+  std::vector<IndexEntry> entries_;
+};
+
+RecordingSink::RecordingSink(const RecordingSinkOptions & options)
+: options_(options)
+{
+  if (options_.directory.empty()) {
+    throw std::invalid_argument("the directory of the recording sink is empty");
+  }
+  if (options_.segment_size <= sizeof(SegmentHeader) + sizeof(RecordHeader)) {
+    throw std::invalid_argument("the segments of the recording sink are too small");
+  }
+  if (options_.max_records_per_segment == 0) {
+    throw std::invalid_argument("the segments of the recording sink can't hold a record");
+  }
+  std::filesystem::create_directories(options_.directory);
+}
+
+RecordingSink::~RecordingSink()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  try {
+    close_segment();
+  } catch (...) {
+    // The index of the last segment is lost, its records stay in the segment file
+  }
+}
+
+uint32_t
+RecordingSink::add_topic(const std::string & name, const std::string & type)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto id = static_cast<uint32_t>(topics_.size());
+  topics_.push_back({id, name, type});
+  return id;
+}
+
+bool
+RecordingSink::write(
+  uint32_t topic_id,
+  const rclcpp::SerializedMessageView & message,
+  int64_t source_timestamp,
+  int64_t received_timestamp)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (topic_id >= topics_.size()) {
+    throw std::invalid_argument("unknown topic id of the recording sink");
+  }
+  const size_t record_size = sizeof(RecordHeader) + aligned_size(message.size());
+  if (record_size > options_.segment_size - sizeof(SegmentHeader)) {
+    statistics_.dropped_count++;
+    return false;
+  }
+  if (segment_ && !segment_->can_append(message.size())) {
+    close_segment();
+  }
+  if (!segment_) {
+    open_segment();
+  }
+  segment_->append(topic_id, message, source_timestamp, received_timestamp);
+  statistics_.record_count++;
+  statistics_.byte_count += message.size();
+  return true;
+}
+
+void
+RecordingSink::flush()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (segment_) {
+    segment_->flush();
+  }
+}
+
+void
+RecordingSink::close()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  close_segment();
+}
+
+std::vector<std::string>
+RecordingSink::get_segment_paths() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return {segment_paths_.begin(), segment_paths_.end()};
+}
+
+std::vector<RecordingTopic>
+RecordingSink::get_topics() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return topics_;
+}
+
+RecordingSinkStatistics
+RecordingSink::get_statistics() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return statistics_;
+}
+
+void
+RecordingSink::open_segment()
+{
+  const std::string path = (std::filesystem::path(options_.directory) /
+    ("segment_" + std::to_string(next_segment_number_) + ".rec")).string();
+  segment_ = std::make_unique<Segment>(
+    path, options_.segment_size, options_.max_records_per_segment);
+  next_segment_number_++;
+  statistics_.segment_count++;
+  segment_paths_.push_back(path);
+  while (options_.max_segments != 0 && segment_paths_.size() > options_.max_segments) {
+    std::error_code error;
+    std::filesystem::remove(segment_paths_.front(), error);
+    std::filesystem::remove(index_path_of(segment_paths_.front()), error);
+    segment_paths_.pop_front();
+  }
+}
+
+void
+RecordingSink::close_segment()
+{
+  if (!segment_) {
+    return;
+  }
+  // Released first, so that a failure to close doesn't leave a half closed segment behind
+  auto segment = std::move(segment_);
+  segment->close(topics_);
+}
+
+RecordingSegmentReader::RecordingSegmentReader(const std::string & segment_path)
+{
+#ifdef _WIN32
+  (void)segment_path;
+  throw std::runtime_error("the recording segments are not supported on Windows");
+#else
+  const std::string index_path = index_path_of(segment_path);
+  int index_fd = ::open(index_path.c_str(), O_RDONLY);
+  if (index_fd < 0) {
+    throw_errno("failed to open recording index '" + index_path + "'");
+  }
+  std::vector<uint8_t> index;
+  uint8_t buffer[4096];
+  while (true) {
+    ssize_t count = ::read(index_fd, buffer, sizeof(buffer));
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      int error = errno;
+      ::close(index_fd);
+      errno = error;
+      throw_errno("failed to read recording index '" + index_path + "'");
+    }
+    if (count == 0) {
+      break;
+    }
+    index.insert(index.end(), buffer, buffer + count);
+  }
+  ::close(index_fd);
+
+  size_t offset = 0;
+  const auto index_header = read_bytes<IndexHeader>(index, offset);
+  if (std::memcmp(index_header.magic, index_magic, sizeof(index_magic)) != 0) {
+    throw std::runtime_error("'" + index_path + "' is not a recording index");
+  }
+  for (uint32_t i = 0; i < index_header.topic_count; ++i) {
+    const auto topic_header = read_bytes<IndexTopicHeader>(index, offset);
+    if (offset + topic_header.name_size + topic_header.type_size > index.size()) {
+      throw std::runtime_error("truncated recording index");
+    }
+    const auto name = reinterpret_cast<const char *>(index.data() + offset);
+    const auto type = name + topic_header.name_size;
+    topics_.push_back(
+      {topic_header.id, std::string(name, topic_header.name_size),
+        std::string(type, topic_header.type_size)});
+    offset = aligned_size(offset + topic_header.name_size + topic_header.type_size);
+  }
+  std::vector<IndexEntry> index_entries;
+  index_entries.reserve(index_header.record_count);
+  for (uint64_t i = 0; i < index_header.record_count; ++i) {
+    index_entries.push_back(read_bytes<IndexEntry>(index, offset));
+  }
+
+  int fd = ::open(segment_path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw_errno("failed to open recording segment '" + segment_path + "'");
+  }
+  struct stat status;
+  if (::fstat(fd, &status) != 0) {
+    int error = errno;
+    ::close(fd);
+    errno = error;
+    throw_errno("failed to stat recording segment '" + segment_path + "'");
+  }
+  data_size_ = static_cast<size_t>(status.st_size);
+  if (data_size_ < sizeof(SegmentHeader)) {
+    ::close(fd);
+    throw std::runtime_error("'" + segment_path + "' is not a recording segment");
+  }
+  void * data = ::mmap(nullptr, data_size_, PROT_READ, MAP_SHARED, fd, 0);
+  // The mapping stays valid once the file is closed
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    throw_errno("failed to map recording segment '" + segment_path + "'");
+  }
+  data_ = static_cast<const uint8_t *>(data);
+  if (std::memcmp(data_, segment_magic, sizeof(segment_magic)) != 0) {
+    ::munmap(const_cast<uint8_t *>(data_), data_size_);
+    throw std::runtime_error("'" + segment_path + "' is not a recording segment");
+  }
+  entries_.reserve(index_entries.size());
+  for (const auto & entry : index_entries) {
+    if (entry.offset + entry.size > data_size_) {
+      ::munmap(const_cast<uint8_t *>(data_), data_size_);
+      throw std::runtime_error("the index of '" + segment_path + "' doesn't match its records");
+    }
+    entries_.push_back(
+      {entry.topic_id, entry.source_timestamp, entry.received_timestamp,
+        rclcpp::SerializedMessageView(data_ + entry.offset, entry.size)});
+  }
+#endif
+}
+
+RecordingSegmentReader::~RecordingSegmentReader()
+{
+#ifndef _WIN32
+  if (data_) {
+    ::munmap(const_cast<uint8_t *>(data_), data_size_);
+  }
+#endif
+}
+
+const std::vector<RecordingTopic> &
+RecordingSegmentReader::get_topics() const
+{
+  return topics_;
+}
+
+size_t
+RecordingSegmentReader::size() const
+{
+  return entries_.size();
+}
+
+RecordingEntry
+RecordingSegmentReader::at(size_t index) const
+{
+  return entries_.at(index);
+}
@@ -0,0 +1,334 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/experimental/timers_manager.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/utilities.hpp"
+
+using rclcpp::experimental::TimersManager;
+
+TimersManager::TimersManager(
+  std::shared_ptr<rclcpp::Context> context,
+  std::function<void(const rclcpp::TimerBase *)> on_ready_callback)
+: on_ready_callback_(on_ready_callback),
+  context_(context)
+{
+}
+
+TimersManager::~TimersManager()
+{
+  // Remove all timers
+  this->clear();
+
+  // Make sure timers thread is stopped before destroying this object
+  this->stop();
+}
+
+void
+TimersManager::add_timer(rclcpp::TimerBase::SharedPtr timer)
+{
+  if (!timer) {
+    throw std::invalid_argument("TimersManager::add_timer() trying to add nullptr timer");
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(timers_mutex_);
+    auto it = std::find_if(
+      weak_timers_.begin(), weak_timers_.end(),
+      [&timer](const rclcpp::TimerBase::WeakPtr & weak_timer) {
+        return weak_timer.lock() == timer;
+      });
+    if (it != weak_timers_.end()) {
+      return;
+    }
+    weak_timers_.push_back(timer);
+    timers_updated_ = true;
+  }
+
+  // Notify that a timer has been added
+  timers_cv_.notify_one();
+}
+
+void
+TimersManager::remove_timer(rclcpp::TimerBase::SharedPtr timer)
+{
+  {
+    std::unique_lock<std::mutex> lock(timers_mutex_);
+    auto it = std::remove_if(
+      weak_timers_.begin(), weak_timers_.end(),
+      [&timer](const rclcpp::TimerBase::WeakPtr & weak_timer) {
+        auto locked_timer = weak_timer.lock();
+        return !locked_timer || locked_timer == timer;
+      });
+    if (it == weak_timers_.end()) {
+      return;
+    }
+    weak_timers_.erase(it, weak_timers_.end());
+    timers_updated_ = true;
+  }
+
+  // Notify timers thread such that it can re-compute its timeout
+  timers_cv_.notify_one();
+}
+
+void
+TimersManager::clear()
+{
+  {
+    // Lock mutex and then clear all data structures
+    std::unique_lock<std::mutex> lock(timers_mutex_);
+    weak_timers_.clear();
+    timers_updated_ = true;
+  }
+
+  // Notify timers thread such that it can re-compute its timeout
+  timers_cv_.notify_one();
+}
+
+void
+TimersManager::start()
+{
+  // Make sure that the thread is not already running
+  if (running_.exchange(true)) {
+    throw std::runtime_error("TimersManager::start() can't start timers thread as already running");
+  }
+
+  // The thread may have exited on its own because the context was shut down
+  if (timers_thread_.joinable()) {
+    timers_thread_.join();
+  }
+
+  timers_thread_ = std::thread(&TimersManager::run_timers, this);
+}
+
+void
+TimersManager::stop()
+{
+  running_ = false;
+
+  // Notify the timers manager thread to wake up
+  {
+    std::unique_lock<std::mutex> lock(timers_mutex_);
+    timers_updated_ = true;
+  }
+  timers_cv_.notify_one();
+
+  // Join timers thread if it's running
+  if (timers_thread_.joinable()) {
+    timers_thread_.join();
+  }
+}
+
+size_t
+TimersManager::get_number_ready_timers()
+{
+  // Do not allow to interfere with the thread running
+  if (running_) {
+    throw std::runtime_error(
+            "get_number_ready_timers() can't be used while timers thread is running");
+  }
+
+  std::unique_lock<std::mutex> lock(timers_mutex_);
+  return static_cast<size_t>(
+    std::count_if(
+      weak_timers_.begin(), weak_timers_.end(),
+      [](const rclcpp::TimerBase::WeakPtr & weak_timer) {
+        auto timer = weak_timer.lock();
+        return timer && timer->is_ready();
+      }));
+}
+
+std::chrono::nanoseconds
+TimersManager::get_head_timeout()
+{
+  // Do not allow to interfere with the thread running
+  if (running_) {
+    throw std::runtime_error(
+            "get_head_timeout() can't be used while timers thread is running");
+  }
+
+  std::unique_lock<std::mutex> lock(timers_mutex_);
+  std::chrono::nanoseconds timeout;
+  this->get_head_timer_unsafe(timeout);
+  return timeout;
+}
+
+size_t
+TimersManager::execute_ready_timers()
+{
+  // Do not allow to interfere with the thread running
+  if (running_) {
+    throw std::runtime_error(
+            "execute_ready_timers() can't be used while timers thread is running");
+  }
+
+  std::vector<rclcpp::TimerBase::SharedPtr> ready_timers;
+  {
+    std::unique_lock<std::mutex> lock(timers_mutex_);
+    ready_timers = this->collect_ready_timers_unsafe();
+  }
+
+  // Callbacks are executed without holding the lock, so that they can add or remove timers.
+  for (auto & timer : ready_timers) {
+    timer->execute_callback();
+  }
+  return ready_timers.size();
+}
+
+bool
+TimersManager::execute_head_timer()
+{
+  // Do not allow to interfere with the thread running
+  if (running_) {
+    throw std::runtime_error(
+            "execute_head_timer() can't be used while timers thread is running");
+  }
+
+  rclcpp::TimerBase::SharedPtr head_timer;
+  {
+    std::unique_lock<std::mutex> lock(timers_mutex_);
+    std::chrono::nanoseconds timeout;
+    head_timer = this->get_head_timer_unsafe(timeout);
+    if (!head_timer || timeout > std::chrono::nanoseconds::zero()) {
+      return false;
+    }
+    // Head timer is ready, mark it as called before releasing the lock.
+    if (!head_timer->call()) {
+      return false;
+    }
+  }
+
+  head_timer->execute_callback();
+  return true;
+}
+
+void
+TimersManager::execute_ready_timer(const rclcpp::TimerBase * timer_id)
+{
+  rclcpp::TimerBase::SharedPtr ready_timer;
+  {
+    std::unique_lock<std::mutex> lock(timers_mutex_);
+    for (const auto & weak_timer : weak_timers_) {
+      auto timer = weak_timer.lock();
+      if (timer && timer.get() == timer_id) {
+        ready_timer = std::move(timer);
+        break;
+      }
+    }
+  }
+
+  if (ready_timer) {
+    ready_timer->execute_callback();
+  }
+}
+
+rclcpp::TimerBase::SharedPtr
+TimersManager::get_head_timer_unsafe(std::chrono::nanoseconds & timeout)
+{
+  rclcpp::TimerBase::SharedPtr head_timer;
+  timeout = MAX_TIME;
+
+  auto it = weak_timers_.begin();
+  while (it != weak_timers_.end()) {
+    auto timer = it->lock();
+    if (!timer) {
+      // Timer has been destroyed, prune it from the storage
+      it = weak_timers_.erase(it);
+      continue;
+    }
+    ++it;
+    std::chrono::nanoseconds time_until_trigger = timer->time_until_trigger();
+    // Canceled timers report the maximum duration and never become the head timer
+    if (time_until_trigger == std::chrono::nanoseconds::max()) {
+      continue;
+    }
+    if (!head_timer || time_until_trigger < timeout) {
+      head_timer = timer;
+      timeout = time_until_trigger;
+    }
+  }
+
+  return head_timer;
+}
+
+std::vector<rclcpp::TimerBase::SharedPtr>
+TimersManager::collect_ready_timers_unsafe()
+{
+  std::vector<rclcpp::TimerBase::SharedPtr> ready_timers;
+  for (const auto & weak_timer : weak_timers_) {
+    auto timer = weak_timer.lock();
+    if (!timer || !timer->is_ready()) {
+      continue;
+    }
+    // Mark the timer as called, so that the next trigger time is computed right away
+    // and the same expiration is not reported twice.
+    if (timer->call()) {
+      ready_timers.push_back(std::move(timer));
+    }
+  }
+  return ready_timers;
+}
+
+void
+TimersManager::run_timers()
+{
+  while (rclcpp::ok(context_) && running_) {
+    std::vector<rclcpp::TimerBase::SharedPtr> ready_timers;
+    {
+      // Lock mutex
+      std::unique_lock<std::mutex> lock(timers_mutex_);
+
+      std::chrono::nanoseconds time_to_sleep;
+      this->get_head_timer_unsafe(time_to_sleep);
+
+      // No need to wait if a timer is already available
+      if (time_to_sleep > std::chrono::nanoseconds::zero()) {
+        if (time_to_sleep != MAX_TIME) {
+          // Wait until timeout or notification that timers have been updated
+          timers_cv_.wait_for(lock, time_to_sleep, [this]() {return timers_updated_;});
+        } else {
+          // Wait until notification that timers have been updated
+          timers_cv_.wait(lock, [this]() {return timers_updated_;});
+        }
+      }
+
+      // Reset timers updated flag
+      timers_updated_ = false;
+
+      if (!running_) {
+        break;
+      }
+
+      ready_timers = this->collect_ready_timers_unsafe();
+    }
+
+    for (auto & timer : ready_timers) {
+      if (on_ready_callback_) {
+        on_ready_callback_(timer.get());
+      } else {
+        timer->execute_callback();
+      }
+    }
+  }
+
+  // Make sure the running flag is set to false when we exit from this function
+  // to allow restarting the timers thread.
+  running_ = false;
+}
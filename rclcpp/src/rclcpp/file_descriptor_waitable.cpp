@@ -0,0 +1,413 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/file_descriptor_waitable.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/detail/add_guard_condition_to_rcl_wait_set.hpp"
+#include "rclcpp/logging.hpp"
+#include "rmw/impl/cpp/demangle.hpp"
+
+namespace rclcpp
+{
+namespace detail
+{
+
+/// Thread polling the file descriptors of all the FileDescriptorWaitable of the process.
+/**
+ * A file descriptor is polled while it's armed: it's disarmed when its events are reported to
+ * its waitable and armed again once the waitable executed its callback.
+ * The waitables are notified with the mutex locked, which their destructor locks to unregister,
+ * so that the thread never uses a destroyed waitable.
+ */
+class FileDescriptorMonitor
+{
+public:
+  static std::shared_ptr<FileDescriptorMonitor>
+  get_instance()
+  {
+    static std::mutex instance_mutex;
+    static std::weak_ptr<FileDescriptorMonitor> instance;
+    std::lock_guard<std::mutex> lock(instance_mutex);
+    auto monitor = instance.lock();
+    if (!monitor) {
+      monitor = std::make_shared<FileDescriptorMonitor>();
+      instance = monitor;
+    }
+    return monitor;
+  }
+
+  FileDescriptorMonitor()
+  {
+#ifdef _WIN32
+    throw std::runtime_error("file descriptor waitables are not supported on Windows");
+#else
+    if (::pipe(wake_pipe_) != 0) {
+      throw std::system_error(errno, std::generic_category(), "failed to create a pipe");
+    }
+    for (int fd : wake_pipe_) {
+      ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+      ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+    thread_ = std::thread(&FileDescriptorMonitor::run, this);
+#endif
+  }
+
+  ~FileDescriptorMonitor()
+  {
+#ifndef _WIN32
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopped_ = true;
+    }
+    wake();
+    thread_.join();
+    ::close(wake_pipe_[0]);
+    ::close(wake_pipe_[1]);
+#endif
+  }
+
+  uint64_t
+  add(FileDescriptorWaitable * waitable)
+  {
+    uint64_t id;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      id = next_id_++;
+      entries_.emplace(id, Entry{waitable, true});
+    }
+    wake();
+    return id;
+  }
+
+  void
+  remove(uint64_t id)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.erase(id);
+  }
+
+  void
+  arm(uint64_t id)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = entries_.find(id);
+      if (it == entries_.end() || it->second.armed) {
+        return;
+      }
+      it->second.armed = true;
+    }
+    wake();
+  }
+
+  void
+  wake()
+  {
+#ifndef _WIN32
+    const char byte = 0;
+    // A full pipe already wakes the thread up, so the result is ignored
+    ssize_t ret = ::write(wake_pipe_[1], &byte, 1);
+    (void)ret;
+#endif
+  }
+
+private:
+  struct Entry
+  {
+    FileDescriptorWaitable * waitable;
+    bool armed;
+  };
+
+#ifndef _WIN32
+  void
+  run()
+  {
+    // Reused by each iteration, they only grow with the number of file descriptors
+    std::vector<pollfd> pollfds;
+    std::vector<uint64_t> ids;
+    while (true) {
+      pollfds.clear();
+      ids.clear();
+      pollfds.push_back({wake_pipe_[0], POLLIN, 0});
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopped_) {
+          return;
+        }
+        for (const auto & pair : entries_) {
+          if (!pair.second.armed) {
+            continue;
+          }
+          const FileDescriptorEvents events = pair.second.waitable->get_events();
+          short poll_events = 0;
+          poll_events |= events.readable ? POLLIN : 0;
+          poll_events |= events.writable ? POLLOUT : 0;
+          pollfds.push_back({pair.second.waitable->get_fd(), poll_events, 0});
+          ids.push_back(pair.first);
+        }
+      }
+
+      if (::poll(pollfds.data(), pollfds.size(), -1) < 0) {
+        if (errno != EINTR) {
+          RCLCPP_ERROR(
+            rclcpp::get_logger("rclcpp"),
+            "failed to poll the file descriptors of the waitables: errno %d", errno);
+          std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        continue;
+      }
+
+      if (pollfds[0].revents != 0) {
+        char buffer[64];
+        while (::read(wake_pipe_[0], buffer, sizeof(buffer)) > 0) {}
+      }
+
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (size_t i = 1; i < pollfds.size(); ++i) {
+        if (pollfds[i].revents == 0) {
+          continue;
+        }
+        // The waitable may have been destroyed, or re-armed, while polling
+        auto it = entries_.find(ids[i - 1]);
+        if (it == entries_.end() || !it->second.armed) {
+          continue;
+        }
+        FileDescriptorEvents ready;
+        ready.readable = (pollfds[i].revents & POLLIN) != 0;
+        ready.writable = (pollfds[i].revents & POLLOUT) != 0;
+        ready.error = (pollfds[i].revents & (POLLERR | POLLHUP | POLLNVAL)) != 0;
+        it->second.armed = false;
+        it->second.waitable->notify_events(ready);
+      }
+    }
+  }
+
+  int wake_pipe_[2] = {-1, -1};
+#endif
+
+  std::mutex mutex_;
+  std::unordered_map<uint64_t, Entry> entries_;
+  uint64_t next_id_ = 0;
+  bool stopped_ = false;
+  std::thread thread_;
+};
+
+}  // namespace detail
+}  // namespace rclcpp
+
+using rclcpp::FileDescriptorEvents;
+using rclcpp::FileDescriptorWaitable;
+
+namespace
+{
+
+bool
+has_events(const FileDescriptorEvents & events)
+{
+  return events.readable || events.writable;
+}
+
+}  // namespace
+
+FileDescriptorWaitable::FileDescriptorWaitable(
+  int fd,
+  const FileDescriptorEvents & events,
+  Callback callback,
+  rclcpp::Context::SharedPtr context)
+: fd_(fd), callback_(std::move(callback)), gc_(context), events_(events)
+{
+  if (fd_ < 0) {
+    throw std::invalid_argument("the file descriptor of the waitable must not be negative");
+  }
+  if (!has_events(events_)) {
+    throw std::invalid_argument("the waitable must wait for the readable or writable events");
+  }
+  if (!callback_) {
+    throw std::invalid_argument("the callback of the file descriptor waitable is not callable");
+  }
+  gc_.set_trigger_coalescing(true);
+  monitor_ = detail::FileDescriptorMonitor::get_instance();
+  id_ = monitor_->add(this);
+}
+
+FileDescriptorWaitable::~FileDescriptorWaitable()
+{
+  monitor_->remove(id_);
+}
+
+int
+FileDescriptorWaitable::get_fd() const
+{
+  return fd_;
+}
+
+void
+FileDescriptorWaitable::set_events(const FileDescriptorEvents & events)
+{
+  if (!has_events(events)) {
+    throw std::invalid_argument("the waitable must wait for the readable or writable events");
+  }
+  {
+    std::lock_guard<std::mutex> lock(events_mutex_);
+    events_ = events;
+  }
+  // Poll the file descriptor again with the new events, if it's armed
+  monitor_->wake();
+}
+
+FileDescriptorEvents
+FileDescriptorWaitable::get_events() const
+{
+  std::lock_guard<std::mutex> lock(events_mutex_);
+  return events_;
+}
+
+void
+FileDescriptorWaitable::add_to_wait_set(rcl_wait_set_t * wait_set)
+{
+  rclcpp::detail::add_guard_condition_to_rcl_wait_set(*wait_set, gc_);
+}
+
+bool
+FileDescriptorWaitable::is_ready(rcl_wait_set_t * wait_set)
+{
+  (void)wait_set;
+  std::lock_guard<std::mutex> lock(events_mutex_);
+  return has_ready_events_;
+}
+
+std::shared_ptr<void>
+FileDescriptorWaitable::take_data()
+{
+  std::lock_guard<std::mutex> lock(events_mutex_);
+  if (!has_ready_events_) {
+    return nullptr;
+  }
+  has_ready_events_ = false;
+  return std::make_shared<FileDescriptorEvents>(ready_events_);
+}
+
+std::shared_ptr<void>
+FileDescriptorWaitable::take_data_by_entity_id(size_t id)
+{
+  (void)id;
+  return take_data();
+}
+
+void
+FileDescriptorWaitable::execute(std::shared_ptr<void> & data)
+{
+  if (!data) {
+    return;
+  }
+  auto events = std::static_pointer_cast<FileDescriptorEvents>(data);
+  try {
+    callback_(fd_, *events);
+  } catch (...) {
+    monitor_->arm(id_);
+    throw;
+  }
+  monitor_->arm(id_);
+}
+
+void
+FileDescriptorWaitable::set_on_ready_callback(std::function<void(size_t, int)> callback)
+{
+  if (!callback) {
+    throw std::invalid_argument(
+            "The callback passed to set_on_ready_callback "
+            "is not callable.");
+  }
+
+  // Note: we bind the int identifier argument to this waitable's entity types
+  auto new_callback =
+    [callback, this](size_t number_of_events) {
+      try {
+        callback(number_of_events, static_cast<int>(EntityType::FileDescriptor));
+      } catch (const std::exception & exception) {
+        RCLCPP_ERROR_STREAM(
+          rclcpp::get_logger("rclcpp"),
+          "rclcpp::FileDescriptorWaitable@" << this <<
+            " caught " << rmw::impl::cpp::demangle(exception) <<
+            " exception in user-provided callback for the 'on ready' callback: " <<
+            exception.what());
+      } catch (...) {
+        RCLCPP_ERROR_STREAM(
+          rclcpp::get_logger("rclcpp"),
+          "rclcpp::FileDescriptorWaitable@" << this <<
+            " caught unhandled exception in user-provided callback " <<
+            "for the 'on ready' callback");
+      }
+    };
+
+  std::lock_guard<std::mutex> lock(callback_mutex_);
+  on_ready_callback_ = new_callback;
+  if (unread_count_ > 0) {
+    on_ready_callback_(unread_count_);
+    unread_count_ = 0;
+  }
+}
+
+void
+FileDescriptorWaitable::clear_on_ready_callback()
+{
+  std::lock_guard<std::mutex> lock(callback_mutex_);
+  on_ready_callback_ = nullptr;
+}
+
+void
+FileDescriptorWaitable::notify_events(const FileDescriptorEvents & events)
+{
+  {
+    std::lock_guard<std::mutex> lock(events_mutex_);
+    ready_events_ = events;
+    has_ready_events_ = true;
+  }
+  try {
+    gc_.trigger();
+  } catch (const std::exception & exception) {
+    // Called by the monitor thread, e.g. after the shutdown of the context
+    RCLCPP_ERROR(
+      rclcpp::get_logger("rclcpp"),
+      "failed to trigger the guard condition of a file descriptor waitable: %s",
+      exception.what());
+  }
+
+  std::lock_guard<std::mutex> lock(callback_mutex_);
+  if (on_ready_callback_) {
+    on_ready_callback_(1);
+  } else {
+    // The events are coalesced until taken, so at most one is reported
+    unread_count_ = 1;
+  }
+}
@@ -0,0 +1,534 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/flight_recorder.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+// includes for semaphore notification code
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <dispatch/dispatch.h>
+#else  // posix
+#include <semaphore.h>
+#endif
+
+#include "rclcpp/allocation_guard.hpp"
+#include "rcutils/logging_macros.h"
+
+using rclcpp::FlightRecorder;
+using rclcpp::FlightRecorderEvent;
+using rclcpp::FlightRecorderEventType;
+using rclcpp::FlightRecorderThreadEvents;
+
+namespace
+{
+
+std::atomic_bool g_enabled{true};
+std::atomic_bool g_dump_on_deadline_missed{false};
+
+struct Slot
+{
+  std::atomic<int64_t> timestamp{0};
+  std::atomic<const void *> entity{nullptr};
+  std::atomic<int64_t> value{0};
+  std::atomic<uint8_t> type{0};
+};
+
+/// Ring of the events of a thread, only written by that thread.
+/**
+ * The writer publishes the index of an event in begin before writing its slot, and in end
+ * once written.
+ * A reader copies the slots up to end, then discards the ones which writes started since, as
+ * told by begin, may have overwritten while it was copying them.
+ */
+struct ThreadRing
+{
+  explicit ThreadRing(std::thread::id id)
+  : thread_id(id), slots(new Slot[FlightRecorder::thread_capacity])
+  {}
+
+  void
+  push(FlightRecorderEventType type, const void * entity, int64_t value) noexcept
+  {
+    const int64_t timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+    const uint64_t index = begin.load(std::memory_order_relaxed);
+    begin.store(index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    Slot & slot = slots[index % FlightRecorder::thread_capacity];
+    slot.timestamp.store(timestamp, std::memory_order_relaxed);
+    slot.entity.store(entity, std::memory_order_relaxed);
+    slot.value.store(value, std::memory_order_relaxed);
+    slot.type.store(static_cast<uint8_t>(type), std::memory_order_relaxed);
+    end.store(index + 1, std::memory_order_release);
+  }
+
+  FlightRecorderThreadEvents
+  read() const
+  {
+    constexpr uint64_t capacity = FlightRecorder::thread_capacity;
+    FlightRecorderThreadEvents thread_events;
+    thread_events.thread_id = thread_id;
+    const uint64_t last = end.load(std::memory_order_acquire);
+    uint64_t first = last > capacity ? last - capacity : 0;
+    first = std::max(first, cleared.load(std::memory_order_relaxed));
+    thread_events.events.reserve(last - first);
+    for (uint64_t index = first; index < last; ++index) {
+      const Slot & slot = slots[index % capacity];
+      thread_events.events.push_back(
+      {
+        slot.timestamp.load(std::memory_order_relaxed),
+        slot.entity.load(std::memory_order_relaxed),
+        slot.value.load(std::memory_order_relaxed),
+        static_cast<FlightRecorderEventType>(slot.type.load(std::memory_order_relaxed))
+      });
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t started = begin.load(std::memory_order_relaxed);
+    const uint64_t valid_first = started > capacity ? started - capacity : 0;
+    if (valid_first > first) {
+      const uint64_t torn = std::min(valid_first, last) - first;
+      thread_events.events.erase(
+        thread_events.events.begin(),
+        thread_events.events.begin() + static_cast<std::ptrdiff_t>(torn));
+      first += torn;
+    }
+    thread_events.lost_count = first;
+    return thread_events;
+  }
+
+  const std::thread::id thread_id;
+  std::atomic<uint64_t> begin{0};
+  std::atomic<uint64_t> end{0};
+  // Index of the first event not cleared
+  std::atomic<uint64_t> cleared{0};
+  std::unique_ptr<Slot[]> slots;
+};
+
+struct Registry
+{
+  std::mutex mutex;
+  std::vector<std::shared_ptr<ThreadRing>> rings;
+};
+
+Registry &
+get_registry()
+{
+  // Never destroyed, so that the threads exiting after the static destructors can unregister
+  static Registry * registry = new Registry();
+  return *registry;
+}
+
+// Plain thread local pointer, so that recording doesn't check the initialization of the holder
+thread_local ThreadRing * g_thread_ring = nullptr;
+// Set once the holder is destroyed, for the thread local destructors recording after it
+thread_local bool g_thread_ring_destroyed = false;
+
+/// Registers the ring of the thread, until the thread exits.
+struct ThreadRingHolder
+{
+  ~ThreadRingHolder()
+  {
+    // The later thread local destructors don't record, rather than using the freed ring
+    g_thread_ring = nullptr;
+    g_thread_ring_destroyed = true;
+    if (!ring) {
+      return;
+    }
+    Registry & registry = get_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.rings.erase(
+      std::remove(registry.rings.begin(), registry.rings.end(), ring), registry.rings.end());
+  }
+
+  std::shared_ptr<ThreadRing> ring;
+};
+
+thread_local ThreadRingHolder g_thread_ring_holder;
+
+ThreadRing *
+create_thread_ring() noexcept
+{
+  if (g_thread_ring_destroyed) {
+    return nullptr;
+  }
+  // Allocated once per thread, even in the code paths forbidding allocations
+  rclcpp::AllocationGuard allow(rclcpp::AllocationCheck::None);
+  try {
+    auto ring = std::make_shared<ThreadRing>(std::this_thread::get_id());
+    Registry & registry = get_registry();
+    {
+      std::lock_guard<std::mutex> lock(registry.mutex);
+      registry.rings.push_back(ring);
+    }
+    g_thread_ring_holder.ring = ring;
+    g_thread_ring = ring.get();
+  } catch (...) {
+    // Not recording is better than failing the recording thread
+  }
+  return g_thread_ring;
+}
+
+std::vector<std::shared_ptr<ThreadRing>>
+get_rings()
+{
+  Registry & registry = get_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  return registry.rings;
+}
+
+const char *
+to_string(FlightRecorderEventType type)
+{
+  switch (type) {
+    case FlightRecorderEventType::WaitStart:
+      return "wait_start";
+    case FlightRecorderEventType::WaitEnd:
+      return "wait_end";
+    case FlightRecorderEventType::CallbackStart:
+      return "callback_start";
+    case FlightRecorderEventType::CallbackEnd:
+      return "callback_end";
+    case FlightRecorderEventType::IntraProcessEnqueue:
+      return "intra_process_enqueue";
+    case FlightRecorderEventType::IntraProcessDrop:
+      return "intra_process_drop";
+    case FlightRecorderEventType::TimerLateness:
+      return "timer_lateness";
+    case FlightRecorderEventType::DeadlineMissed:
+      return "deadline_missed";
+  }
+  return "unknown";
+}
+
+/// Semaphore which can be posted from a signal handler.
+class DumpSemaphore
+{
+public:
+  DumpSemaphore()
+  {
+#if defined(_WIN32)
+    semaphore_ = CreateSemaphore(NULL, 0, 1, NULL);
+#elif defined(__APPLE__)
+    semaphore_ = dispatch_semaphore_create(0);
+#else  // posix
+    is_setup_ = (0 == sem_init(&semaphore_, 0, 0));
+#endif
+  }
+
+  ~DumpSemaphore()
+  {
+#if defined(_WIN32)
+    if (NULL != semaphore_) {
+      CloseHandle(semaphore_);
+    }
+#elif defined(__APPLE__)
+    dispatch_release(semaphore_);
+#else  // posix
+    if (is_setup_) {
+      sem_destroy(&semaphore_);
+    }
+#endif
+  }
+
+  void
+  wait()
+  {
+#if defined(_WIN32)
+    WaitForSingleObject(semaphore_, INFINITE);
+#elif defined(__APPLE__)
+    dispatch_semaphore_wait(semaphore_, DISPATCH_TIME_FOREVER);
+#else  // posix
+    int s;
+    do {
+      s = sem_wait(&semaphore_);
+    } while (-1 == s && EINTR == errno);
+#endif
+  }
+
+  void
+  post() noexcept
+  {
+    // A failure means that the semaphore is already posted, e.g. at its maximum count
+#if defined(_WIN32)
+    ReleaseSemaphore(semaphore_, 1, NULL);
+#elif defined(__APPLE__)
+    dispatch_semaphore_signal(semaphore_);
+#else  // posix
+    sem_post(&semaphore_);
+#endif
+  }
+
+private:
+#if defined(_WIN32)
+  HANDLE semaphore_;
+#elif defined(__APPLE__)
+  dispatch_semaphore_t semaphore_;
+#else  // posix
+  sem_t semaphore_;
+  bool is_setup_;
+#endif
+};
+
+/// Background thread writing the requested dumps to files.
+struct DumpThread
+{
+  ~DumpThread()
+  {
+    stop();
+  }
+
+  void
+  start(const std::string & prefix)
+  {
+    {
+      std::lock_guard<std::mutex> lock(path_mutex);
+      path_prefix = prefix;
+    }
+    if (running.exchange(true)) {
+      return;
+    }
+    try {
+      thread = std::thread([this]() {run();});
+    } catch (const std::system_error & exception) {
+      running.store(false);
+      throw std::runtime_error(
+              std::string("failed to start the flight recorder dump thread: ") +
+              exception.what());
+    }
+  }
+
+  void
+  stop()
+  {
+    running.store(false);
+    semaphore.post();
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+
+  void
+  request() noexcept
+  {
+    if (!running.load()) {
+      return;
+    }
+    requested.store(true);
+    semaphore.post();
+  }
+
+  void
+  run()
+  {
+    while (running.load()) {
+      semaphore.wait();
+      if (requested.exchange(false)) {
+        write_dump();
+      }
+    }
+  }
+
+  void
+  write_dump()
+  {
+    std::string path;
+    {
+      std::lock_guard<std::mutex> lock(path_mutex);
+      path = path_prefix + "." + std::to_string(dump_count.load());
+    }
+    std::ofstream file(path);
+    if (!file) {
+      RCUTILS_LOG_ERROR_NAMED(
+        "rclcpp", "Failed to open the flight recorder dump file '%s'", path.c_str());
+      return;
+    }
+    try {
+      FlightRecorder::dump(file);
+    } catch (const std::exception & exception) {
+      RCUTILS_LOG_ERROR_NAMED(
+        "rclcpp", "Failed to dump the flight recorder into '%s': %s", path.c_str(),
+        exception.what());
+      return;
+    }
+    dump_count.fetch_add(1);
+  }
+
+  // Serializes the starts and stops
+  std::mutex mutex;
+  std::thread thread;
+  std::atomic_bool running{false};
+  std::atomic_bool requested{false};
+  std::atomic<uint64_t> dump_count{0};
+  std::mutex path_mutex;
+  std::string path_prefix;
+  DumpSemaphore semaphore;
+};
+
+// Not a function static, whose initialization isn't safe in a signal handler
+DumpThread g_dump_thread;
+
+void
+dump_signal_handler(int signal_number)
+{
+  (void)signal_number;
+  FlightRecorder::request_dump();
+}
+
+}  // namespace
+
+void
+FlightRecorder::enable()
+{
+  g_enabled.store(true);
+}
+
+void
+FlightRecorder::disable()
+{
+  g_enabled.store(false);
+}
+
+bool
+FlightRecorder::is_enabled() noexcept
+{
+  return g_enabled.load(std::memory_order_relaxed);
+}
+
+void
+FlightRecorder::record(
+  FlightRecorderEventType type, const void * entity, int64_t value) noexcept
+{
+  if (!g_enabled.load(std::memory_order_relaxed)) {
+    return;
+  }
+  ThreadRing * ring = g_thread_ring;
+  if (!ring) {
+    ring = create_thread_ring();
+    if (!ring) {
+      return;
+    }
+  }
+  ring->push(type, entity, value);
+}
+
+void
+FlightRecorder::on_deadline_missed(const void * entity, int64_t total_count) noexcept
+{
+  record(FlightRecorderEventType::DeadlineMissed, entity, total_count);
+  if (g_dump_on_deadline_missed.load(std::memory_order_relaxed)) {
+    request_dump();
+  }
+}
+
+std::vector<FlightRecorderThreadEvents>
+FlightRecorder::get_snapshot()
+{
+  std::vector<FlightRecorderThreadEvents> snapshot;
+  for (const auto & ring : get_rings()) {
+    snapshot.push_back(ring->read());
+  }
+  return snapshot;
+}
+
+void
+FlightRecorder::dump(std::ostream & stream)
+{
+  const std::vector<FlightRecorderThreadEvents> snapshot = get_snapshot();
+  // The events of all the threads, ordered by timestamp then by thread
+  std::vector<std::tuple<int64_t, size_t, const FlightRecorderEvent *>> events;
+  for (size_t thread_index = 0; thread_index < snapshot.size(); ++thread_index) {
+    const FlightRecorderThreadEvents & thread_events = snapshot[thread_index];
+    stream << "# thread=" << thread_index << " id=" << thread_events.thread_id <<
+      " events=" << thread_events.events.size() << " lost=" << thread_events.lost_count << "\n";
+    for (const FlightRecorderEvent & event : thread_events.events) {
+      events.emplace_back(event.timestamp, thread_index, &event);
+    }
+  }
+  std::stable_sort(
+    events.begin(), events.end(),
+    [](const auto & lhs, const auto & rhs) {
+      return std::tie(std::get<0>(lhs), std::get<1>(lhs)) <
+      std::tie(std::get<0>(rhs), std::get<1>(rhs));
+    });
+  for (const auto & [timestamp, thread_index, event] : events) {
+    stream << timestamp << " thread=" << thread_index << " " << to_string(event->type) <<
+      " entity=" << event->entity << " value=" << event->value << "\n";
+  }
+  stream.flush();
+}
+
+void
+FlightRecorder::clear()
+{
+  for (const auto & ring : get_rings()) {
+    ring->cleared.store(ring->end.load());
+  }
+}
+
+void
+FlightRecorder::set_dump_path_prefix(const std::string & path_prefix)
+{
+  std::lock_guard<std::mutex> lock(g_dump_thread.mutex);
+  if (path_prefix.empty()) {
+    g_dump_thread.stop();
+  } else {
+    g_dump_thread.start(path_prefix);
+  }
+}
+
+void
+FlightRecorder::request_dump() noexcept
+{
+  g_dump_thread.request();
+}
+
+uint64_t
+FlightRecorder::get_dump_count() noexcept
+{
+  return g_dump_thread.dump_count.load();
+}
+
+void
+FlightRecorder::install_dump_signal_handler(int signal_number)
+{
+  if (SIG_ERR == std::signal(signal_number, &dump_signal_handler)) {
+    throw std::runtime_error(
+            "failed to install the flight recorder dump handler of signal " +
+            std::to_string(signal_number) + ": " + std::strerror(errno));
+  }
+}
+
+void
+FlightRecorder::set_dump_on_deadline_missed(bool dump_on_deadline_missed)
+{
+  g_dump_on_deadline_missed.store(dump_on_deadline_missed);
+}
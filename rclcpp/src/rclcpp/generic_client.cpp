@@ -0,0 +1,155 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/generic_client.hpp"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "rcl/error_handling.h"
+
+#include "rclcpp/exceptions.hpp"
+#include "rclcpp/expand_topic_or_service_name.hpp"
+
+using rclcpp::GenericClient;
+
+GenericClient::GenericClient(
+  rclcpp::node_interfaces::NodeBaseInterface * node_base,
+  rclcpp::node_interfaces::NodeGraphInterface::SharedPtr node_graph,
+  const std::string & service_name,
+  const std::string & service_type,
+  rcl_client_options_t & client_options)
+: ClientBase(node_base, node_graph),
+  service_type_(service_type),
+  type_support_(service_type)
+{
+  rcl_ret_t ret = rcl_client_init(
+    this->get_client_handle().get(),
+    this->get_rcl_node_handle(),
+    type_support_.get_service_type_support(),
+    service_name.c_str(),
+    &client_options);
+  if (ret != RCL_RET_OK) {
+    if (ret == RCL_RET_SERVICE_NAME_INVALID) {
+      auto rcl_node_handle = this->get_rcl_node_handle();
+      // this will throw on any validation problem
+      rcl_reset_error();
+      expand_topic_or_service_name(
+        service_name,
+        rcl_node_get_name(rcl_node_handle),
+        rcl_node_get_namespace(rcl_node_handle),
+        true);
+    }
+    rclcpp::exceptions::throw_from_rcl_error(ret, "could not create client");
+  }
+}
+
+std::shared_ptr<void>
+GenericClient::create_response()
+{
+  return type_support_.create_response();
+}
+
+std::shared_ptr<rmw_request_id_t>
+GenericClient::create_request_header()
+{
+  return std::make_shared<rmw_request_id_t>();
+}
+
+void
+GenericClient::handle_response(
+  std::shared_ptr<rmw_request_id_t> request_header,
+  std::shared_ptr<void> response)
+{
+  PendingRequest pending_request;
+  {
+    std::lock_guard<std::mutex> lock(pending_requests_mutex_);
+    auto it = pending_requests_.find(request_header->sequence_number);
+    if (it == pending_requests_.end()) {
+      // Removed by the user, or the response of another client
+      return;
+    }
+    pending_request = std::move(it->second);
+    pending_requests_.erase(it);
+  }
+
+  auto serialized_response = std::make_shared<rclcpp::SerializedMessage>();
+  type_support_.serialize_response(response.get(), *serialized_response);
+  pending_request.promise.set_value(std::move(serialized_response));
+  if (pending_request.callback) {
+    pending_request.callback(std::move(pending_request.future));
+  }
+}
+
+GenericClient::FutureAndRequestId
+GenericClient::async_send_request(const Request & request)
+{
+  Promise promise;
+  Future future = promise.get_future();
+  const int64_t request_id = async_send_request_impl(
+    request, PendingRequest{std::move(promise), nullptr, SharedFuture()});
+  return FutureAndRequestId(std::move(future), request_id);
+}
+
+bool
+GenericClient::remove_pending_request(int64_t request_id)
+{
+  std::lock_guard<std::mutex> lock(pending_requests_mutex_);
+  return pending_requests_.erase(request_id) != 0u;
+}
+
+bool
+GenericClient::remove_pending_request(const FutureAndRequestId & future)
+{
+  return remove_pending_request(future.request_id);
+}
+
+bool
+GenericClient::remove_pending_request(const SharedFutureAndRequestId & future)
+{
+  return remove_pending_request(future.request_id);
+}
+
+size_t
+GenericClient::prune_pending_requests()
+{
+  std::lock_guard<std::mutex> lock(pending_requests_mutex_);
+  const size_t count = pending_requests_.size();
+  pending_requests_.clear();
+  return count;
+}
+
+const std::string &
+GenericClient::get_service_type() const
+{
+  return service_type_;
+}
+
+int64_t
+GenericClient::async_send_request_impl(const Request & request, PendingRequest pending_request)
+{
+  // Deserialized before locking, only the sending is serialized with the responses
+  auto typed_request = type_support_.deserialize_request(request);
+  int64_t sequence_number;
+  std::lock_guard<std::mutex> lock(pending_requests_mutex_);
+  rcl_ret_t ret = rcl_send_request(
+    get_client_handle().get(), typed_request.get(), &sequence_number);
+  if (RCL_RET_OK != ret) {
+    rclcpp::exceptions::throw_from_rcl_error(ret, "failed to send request");
+  }
+  pending_requests_.emplace(sequence_number, std::move(pending_request));
+  return sequence_number;
+}
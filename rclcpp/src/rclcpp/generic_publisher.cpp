@@ -15,29 +15,164 @@
 
 #include "rclcpp/generic_publisher.hpp"
 
+#include <cstring>
 #include <memory>
+#include <stdexcept>
 #include <string>
+#include <vector>
+
+#include "rclcpp/experimental/intra_process_manager.hpp"
 
 namespace rclcpp
 {
 
 void GenericPublisher::publish(const rclcpp::SerializedMessage & message)
 {
+  rclcpp::topic_statistics::PublisherTopicStatistics::Scope topic_stats_scope(topic_stats_.get());
+  publish_serialized_message(message.get_rcl_serialized_message());
+}
+
+void GenericPublisher::publish(const rclcpp::SerializedMessageView & message)
+{
+  rclcpp::topic_statistics::PublisherTopicStatistics::Scope topic_stats_scope(topic_stats_.get());
+  publish_serialized_message(message.get_rcl_serialized_message());
+}
+
+void GenericPublisher::publish(const std::vector<rclcpp::SerializedMessageView> & fragments)
+{
+  if (fragments.size() == 1) {
+    publish(fragments.front());
+    return;
+  }
+  size_t size = 0;
+  for (const auto & fragment : fragments) {
+    size += fragment.size();
+  }
+  auto message = borrow_serialized_message(size);
+  rcl_serialized_message_t & gathered = message->get_rcl_serialized_message();
+  size_t offset = 0;
+  for (const auto & fragment : fragments) {
+    if (!fragment.empty()) {
+      std::memcpy(gathered.buffer + offset, fragment.data(), fragment.size());
+      offset += fragment.size();
+    }
+  }
+  gathered.buffer_length = size;
+  publish(*message);
+}
+
+GenericPublisher::LoanedSerializedMessage
+GenericPublisher::borrow_serialized_message(size_t capacity)
+{
+  LoanedSerializedMessage message;
+  if (serialized_message_pool_) {
+    message = serialized_message_pool_->borrow();
+  } else {
+    message = LoanedSerializedMessage(
+      new rclcpp::SerializedMessage(), [](rclcpp::SerializedMessage * released) {
+        delete released;
+      });
+  }
+  if (message->capacity() < capacity) {
+    message->reserve(capacity);
+  }
+  return message;
+}
+
+rclcpp::experimental::MessagePoolStatistics
+GenericPublisher::get_serialized_message_pool_statistics() const
+{
+  if (!serialized_message_pool_) {
+    return rclcpp::experimental::MessagePoolStatistics();
+  }
+  return serialized_message_pool_->get_statistics();
+}
+
+void GenericPublisher::publish_serialized_message(const rcl_serialized_message_t & message)
+{
+  if (topic_stats_) {
+    topic_stats_->on_serialized_publish(message.buffer_length);
+  }
+  if (!publish_intra_process(message) || skip_inter_process_publish()) {
+    return;
+  }
+  std::shared_ptr<rclcpp::SerializedMessage> compressed_message;
+  if (payload_compressor_) {
+    compressed_message = payload_compressor_->compress(message);
+  }
   auto return_code = rcl_publish_serialized_message(
-    get_publisher_handle().get(), &message.get_rcl_serialized_message(), NULL);
+    get_publisher_handle().get(),
+    compressed_message ? &compressed_message->get_rcl_serialized_message() : &message, NULL);
+  if (compressed_message) {
+    payload_compressor_->release(compressed_message);
+  }
 
   if (return_code != RCL_RET_OK) {
     rclcpp::exceptions::throw_from_rcl_error(return_code, "failed to publish serialized message");
   }
+  if (topic_stats_) {
+    topic_stats_->on_inter_process_publish();
+  }
 }
 
 void GenericPublisher::publish_as_loaned_msg(const rclcpp::SerializedMessage & message)
 {
+  rclcpp::topic_statistics::PublisherTopicStatistics::Scope topic_stats_scope(topic_stats_.get());
+  if (topic_stats_) {
+    topic_stats_->on_serialized_publish(message.size());
+  }
+  if (!publish_intra_process(message.get_rcl_serialized_message())) {
+    return;
+  }
   auto loaned_message = borrow_loaned_message();
   deserialize_message(message.get_rcl_serialized_message(), loaned_message);
   publish_loaned_message(loaned_message);
 }
 
+void
+GenericPublisher::setup_serialized_intra_process(
+  rclcpp::node_interfaces::NodeBaseInterface * node_base)
+{
+  // Unlike the typed publishers, fall back to inter-process communication, as the generic
+  // publishers are typically created for any topic, e.g. to replay it
+  auto qos = get_actual_qos();
+  if (
+    qos.history() != rclcpp::HistoryPolicy::KeepLast ||
+    qos.depth() == 0 ||
+    qos.durability() != rclcpp::DurabilityPolicy::Volatile)
+  {
+    return;
+  }
+
+  using rclcpp::experimental::IntraProcessManager;
+  auto ipm = node_base->get_context()->get_sub_context<IntraProcessManager>();
+  uint64_t intra_process_publisher_id = ipm->add_serialized_publisher(shared_from_this());
+  this->setup_intra_process(intra_process_publisher_id, ipm);
+}
+
+bool GenericPublisher::publish_intra_process(const rcl_serialized_message_t & message)
+{
+  if (!intra_process_is_enabled_) {
+    return true;
+  }
+  auto ipm = weak_ipm_.lock();
+  if (!ipm) {
+    throw std::runtime_error(
+            "intra process publish called after destruction of intra process manager");
+  }
+  const size_t intra_process_subscription_count =
+    ipm->get_subscription_count(intra_process_publisher_id_);
+  if (intra_process_subscription_count > 0) {
+    // A single copy, shared by all the subscriptions
+    ipm->do_serialized_intra_process_publish(
+      intra_process_publisher_id_, std::make_shared<const rclcpp::SerializedMessage>(message));
+    if (topic_stats_) {
+      topic_stats_->on_intra_process_publish();
+    }
+  }
+  return get_subscription_count() > intra_process_subscription_count;
+}
+
 void * GenericPublisher::borrow_loaned_message()
 {
   void * loaned_message = nullptr;
@@ -74,6 +209,9 @@ void GenericPublisher::publish_loaned_message(void * loaned_message)
   if (return_code != RCL_RET_OK) {
     rclcpp::exceptions::throw_from_rcl_error(return_code, "failed to publish loaned message");
   }
+  if (topic_stats_) {
+    topic_stats_->on_inter_process_publish();
+  }
 }
 
 }  // namespace rclcpp
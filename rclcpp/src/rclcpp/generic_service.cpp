@@ -0,0 +1,129 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/generic_service.hpp"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "rcl/error_handling.h"
+
+#include "rclcpp/exceptions.hpp"
+#include "rclcpp/expand_topic_or_service_name.hpp"
+#include "rclcpp/logging.hpp"
+
+using rclcpp::GenericService;
+
+GenericService::GenericService(
+  std::shared_ptr<rcl_node_t> node_handle,
+  const std::string & service_name,
+  const std::string & service_type,
+  AnyCallback callback,
+  rcl_service_options_t & service_options)
+: ServiceBase(node_handle),
+  service_type_(service_type),
+  type_support_(service_type),
+  callback_(std::move(callback))
+{
+  // rcl does the static memory allocation here
+  service_handle_ = std::shared_ptr<rcl_service_t>(
+    new rcl_service_t, [handle = node_handle_, service_name](rcl_service_t * service)
+    {
+      if (rcl_service_fini(service, handle.get()) != RCL_RET_OK) {
+        RCLCPP_ERROR(
+          rclcpp::get_node_logger(handle.get()).get_child("rclcpp"),
+          "Error in destruction of rcl service handle: %s",
+          rcl_get_error_string().str);
+        rcl_reset_error();
+      }
+      delete service;
+    });
+  *service_handle_.get() = rcl_get_zero_initialized_service();
+
+  rcl_ret_t ret = rcl_service_init(
+    service_handle_.get(),
+    node_handle.get(),
+    type_support_.get_service_type_support(),
+    service_name.c_str(),
+    &service_options);
+  if (ret != RCL_RET_OK) {
+    if (ret == RCL_RET_SERVICE_NAME_INVALID) {
+      auto rcl_node_handle = get_rcl_node_handle();
+      // this will throw on any validation problem
+      rcl_reset_error();
+      expand_topic_or_service_name(
+        service_name,
+        rcl_node_get_name(rcl_node_handle),
+        rcl_node_get_namespace(rcl_node_handle),
+        true);
+    }
+
+    rclcpp::exceptions::throw_from_rcl_error(ret, "could not create service");
+  }
+}
+
+std::shared_ptr<void>
+GenericService::create_request()
+{
+  return type_support_.create_request();
+}
+
+std::shared_ptr<rmw_request_id_t>
+GenericService::create_request_header()
+{
+  return std::make_shared<rmw_request_id_t>();
+}
+
+void
+GenericService::handle_request(
+  std::shared_ptr<rmw_request_id_t> request_header,
+  std::shared_ptr<void> request)
+{
+  auto serialized_request = std::make_shared<rclcpp::SerializedMessage>();
+  type_support_.serialize_request(request.get(), *serialized_request);
+  // The request in the type of the service isn't needed anymore
+  request.reset();
+
+  if (auto deferred_callback = std::get_if<DeferredCallbackType>(&callback_)) {
+    (*deferred_callback)(shared_from_this(), request_header, std::move(serialized_request));
+    return;
+  }
+  auto serialized_response = std::make_shared<rclcpp::SerializedMessage>();
+  if (auto callback = std::get_if<CallbackType>(&callback_)) {
+    (*callback)(std::move(serialized_request), serialized_response);
+  } else {
+    std::get<CallbackWithHeaderType>(callback_)(
+      request_header, std::move(serialized_request), serialized_response);
+  }
+  send_response(*request_header, *serialized_response);
+}
+
+void
+GenericService::send_response(
+  rmw_request_id_t & request_id,
+  const rclcpp::SerializedMessage & response)
+{
+  auto typed_response = type_support_.deserialize_response(response);
+  rcl_ret_t ret = rcl_send_response(get_service_handle().get(), &request_id, typed_response.get());
+  if (ret != RCL_RET_OK) {
+    rclcpp::exceptions::throw_from_rcl_error(ret, "failed to send response");
+  }
+}
+
+const std::string &
+GenericService::get_service_type() const
+{
+  return service_type_;
+}
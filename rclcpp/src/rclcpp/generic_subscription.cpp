@@ -17,10 +17,14 @@
 
 #include <memory>
 #include <string>
+#include <utility>
 
 #include "rcl/subscription.h"
+#include "rmw/types.h"
 
 #include "rclcpp/exceptions.hpp"
+#include "rclcpp/experimental/intra_process_manager.hpp"
+#include "rclcpp/experimental/subscription_intra_process_serialized.hpp"
 
 namespace rclcpp
 {
@@ -32,7 +36,12 @@ std::shared_ptr<void> GenericSubscription::create_message()
 
 std::shared_ptr<rclcpp::SerializedMessage> GenericSubscription::create_serialized_message()
 {
-  return std::make_shared<rclcpp::SerializedMessage>(0);
+  return serialized_message_pool_.acquire();
+}
+
+bool GenericSubscription::is_view_callback() const
+{
+  return static_cast<bool>(view_callback_);
 }
 
 void GenericSubscription::handle_message(
@@ -45,10 +54,24 @@ void GenericSubscription::handle_message(
 
 void
 GenericSubscription::handle_serialized_message(
-  const std::shared_ptr<rclcpp::SerializedMessage> & message,
-  const rclcpp::MessageInfo &)
+  const std::shared_ptr<rclcpp::SerializedMessage> & serialized_message,
+  const rclcpp::MessageInfo & message_info)
 {
-  callback_(message);
+  std::shared_ptr<rclcpp::SerializedMessage> message = serialized_message;
+  const bool is_compressed =
+    rclcpp::PayloadDecompressor::is_compressed(message->get_rcl_serialized_message());
+  if (is_compressed) {
+    message = payload_decompressor_.decompress(message->get_rcl_serialized_message());
+  }
+  if (view_callback_) {
+    // The buffer only is borrowed, it goes back to the pool once the callback returns
+    view_callback_(rclcpp::SerializedMessageView(*message), message_info);
+  } else {
+    callback_(message);
+  }
+  if (is_compressed) {
+    payload_decompressor_.release(message);
+  }
 }
 
 void GenericSubscription::handle_loaned_message(
@@ -69,7 +92,47 @@ void GenericSubscription::return_message(std::shared_ptr<void> & message)
 void GenericSubscription::return_serialized_message(
   std::shared_ptr<rclcpp::SerializedMessage> & message)
 {
-  message.reset();
+  serialized_message_pool_.release(message);
+}
+
+void
+GenericSubscription::setup_serialized_intra_process(
+  rclcpp::node_interfaces::NodeBaseInterface * node_base)
+{
+  // Unlike the typed subscriptions, fall back to inter-process communication, as the generic
+  // subscriptions are typically created for any topic, e.g. to record it
+  auto qos_profile = get_actual_qos();
+  if (
+    qos_profile.history() != rclcpp::HistoryPolicy::KeepLast ||
+    qos_profile.depth() == 0 ||
+    qos_profile.durability() != rclcpp::DurabilityPolicy::Volatile)
+  {
+    return;
+  }
+
+  rclcpp::experimental::SubscriptionIntraProcessSerialized::Callback callback = callback_;
+  if (view_callback_) {
+    // The view refers to the message shared by the intra-process subscriptions
+    callback = [view_callback = view_callback_](std::shared_ptr<rclcpp::SerializedMessage> message)
+      {
+        rclcpp::MessageInfo message_info(rmw_get_zero_initialized_message_info());
+        message_info.get_rmw_message_info().from_intra_process = true;
+        view_callback(rclcpp::SerializedMessageView(*message), message_info);
+      };
+  }
+
+  auto context = node_base->get_context();
+  subscription_intra_process_ =
+    std::make_shared<rclcpp::experimental::SubscriptionIntraProcessSerialized>(
+    std::move(callback),
+    context,
+    this->get_topic_name(),  // important to get like this, as it has the fully-qualified name
+    qos_profile);
+
+  using rclcpp::experimental::IntraProcessManager;
+  auto ipm = context->get_sub_context<IntraProcessManager>();
+  uint64_t intra_process_subscription_id = ipm->add_subscription(subscription_intra_process_);
+  this->setup_intra_process(intra_process_subscription_id, ipm);
 }
 
 }  // namespace rclcpp
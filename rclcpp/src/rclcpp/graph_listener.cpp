@@ -14,10 +14,13 @@
 
 #include "rclcpp/graph_listener.hpp"
 
+#include <algorithm>
 #include <cstdio>
 #include <exception>
+#include <functional>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "rcl/error_handling.h"
@@ -42,6 +45,7 @@ GraphListener::GraphListener(const std::shared_ptr<Context> & parent_context)
   rcl_parent_context_(parent_context->get_rcl_context()),
   is_started_(false),
   is_shutdown_(false),
+  graph_change_count_(0),
   interrupt_guard_condition_(parent_context)
 {
 }
@@ -180,6 +184,17 @@ GraphListener::run_loop()
       throw_from_rcl_error(ret, "failed to wait on wait set");
     }
 
+    // Count the graph change before notifying the nodes, which may query the graph again.
+    for (size_t i = 0u; i < node_graph_interfaces_size; ++i) {
+      const auto graph_gc = node_graph_interfaces_[i]->get_graph_guard_condition();
+      if (graph_gc && graph_gc == wait_set_.guard_conditions[graph_gc_indexes[i]]) {
+        graph_change_count_.fetch_add(1);
+        check_graph_change_filters();
+        check_service_waiters();
+        break;
+      }
+    }
+
     // Notify nodes who's guard conditions are set (triggered).
     for (size_t i = 0u; i < node_graph_interfaces_size; ++i) {
       const auto node_ptr = node_graph_interfaces_[i];
@@ -295,6 +310,22 @@ remove_node_(
   throw NodeNotFoundError();
 }
 
+template<typename GraphChangeFiltersT>
+static void
+remove_graph_change_filters_(
+  GraphChangeFiltersT * graph_change_filters,
+  rclcpp::node_interfaces::NodeGraphInterface * node_graph)
+{
+  graph_change_filters->erase(
+    std::remove_if(
+      graph_change_filters->begin(),
+      graph_change_filters->end(),
+      [node_graph](const auto & graph_change_filter) {
+        return graph_change_filter.node_graph == node_graph;
+      }),
+    graph_change_filters->end());
+}
+
 void
 GraphListener::remove_node(rclcpp::node_interfaces::NodeGraphInterface * node_graph)
 {
@@ -304,7 +335,8 @@ GraphListener::remove_node(rclcpp::node_interfaces::NodeGraphInterface * node_gr
   std::lock_guard<std::mutex> shutdown_lock(shutdown_mutex_);
   if (is_shutdown()) {
     // If shutdown, then the run loop has been joined, so we can remove them directly.
-    return remove_node_(&node_graph_interfaces_, node_graph);
+    remove_node_(&node_graph_interfaces_, node_graph);
+    return remove_graph_change_filters_(&graph_change_filters_, node_graph);
   }
   // Otherwise, first interrupt and lock against the run loop to safely remove the node.
   // Acquire the nodes mutex using the barrier to prevent the run loop from
@@ -316,6 +348,121 @@ GraphListener::remove_node(rclcpp::node_interfaces::NodeGraphInterface * node_gr
   // Store the now acquired node_graph_interfaces_mutex_ in the scoped lock using adopt_lock.
   std::lock_guard<std::mutex> nodes_lock(node_graph_interfaces_mutex_, std::adopt_lock);
   remove_node_(&node_graph_interfaces_, node_graph);
+  remove_graph_change_filters_(&graph_change_filters_, node_graph);
+}
+
+void
+GraphListener::add_graph_change_filter(
+  rclcpp::node_interfaces::NodeGraphInterface * node_graph,
+  const rclcpp::GraphEventFilter & filter,
+  std::function<bool()> callback)
+{
+  if (!node_graph) {
+    throw std::invalid_argument("node is nullptr");
+  }
+  std::lock_guard<std::mutex> shutdown_lock(shutdown_mutex_);
+  if (is_shutdown_.load()) {
+    throw GraphListenerShutdownError();
+  }
+
+  // Acquire the nodes mutex using the barrier to prevent the run loop from
+  // re-locking the nodes mutex after being interrupted.
+  acquire_nodes_lock_(
+    &node_graph_interfaces_barrier_mutex_,
+    &node_graph_interfaces_mutex_,
+    &interrupt_guard_condition_);
+  // Store the now acquired node_graph_interfaces_mutex_ in the scoped lock using adopt_lock.
+  std::lock_guard<std::mutex> nodes_lock(node_graph_interfaces_mutex_, std::adopt_lock);
+  if (!has_node_(&node_graph_interfaces_, node_graph)) {
+    throw NodeNotFoundError();
+  }
+  // The names not filtered yet start from their current state, while the run loop waits
+  // so that the changes after this query are checked by the run loop
+  query_graph_change_filter_states(
+    node_graph, filter, filtered_topic_states_, filtered_service_states_);
+  graph_change_filters_.push_back({node_graph, filter, std::move(callback)});
+}
+
+void
+GraphListener::query_graph_change_filter_states(
+  rclcpp::node_interfaces::NodeGraphInterface * node_graph,
+  const rclcpp::GraphEventFilter & filter,
+  TopicStates & topic_states,
+  ServiceStates & service_states)
+{
+  for (const auto & topic_name : filter.topic_names) {
+    if (topic_states.find(topic_name) == topic_states.end()) {
+      topic_states[topic_name] = {
+        node_graph->count_publishers(topic_name), node_graph->count_subscribers(topic_name)};
+    }
+  }
+  auto missing_service = std::find_if(
+    filter.service_names.begin(), filter.service_names.end(),
+    [&service_states](const std::string & service_name) {
+      return service_states.find(service_name) == service_states.end();
+    });
+  if (missing_service != filter.service_names.end()) {
+    const auto service_names_and_types = node_graph->get_service_names_and_types();
+    for (const auto & service_name : filter.service_names) {
+      service_states[service_name] =
+        service_names_and_types.find(service_name) != service_names_and_types.end();
+    }
+  }
+}
+
+void
+GraphListener::check_graph_change_filters()
+{
+  if (graph_change_filters_.empty()) {
+    return;
+  }
+  // Each topic and service is queried once for all the filters
+  TopicStates topic_states;
+  ServiceStates service_states;
+  bool query_failed = false;
+  try {
+    auto node_graph = graph_change_filters_.front().node_graph;
+    for (const auto & graph_change_filter : graph_change_filters_) {
+      query_graph_change_filter_states(
+        node_graph, graph_change_filter.filter, topic_states, service_states);
+    }
+  } catch (const std::exception & exc) {
+    RCLCPP_ERROR(
+      rclcpp::get_logger("rclcpp"),
+      "caught %s exception when querying the filtered graph changes, notifying all of them: %s",
+      rmw::impl::cpp::demangle(exc).c_str(), exc.what());
+    query_failed = true;
+  }
+
+  auto changed = [this, query_failed, &topic_states, &service_states](
+    const rclcpp::GraphEventFilter & filter) {
+      if (query_failed) {
+        return true;
+      }
+      for (const auto & topic_name : filter.topic_names) {
+        if (filtered_topic_states_[topic_name] != topic_states[topic_name]) {
+          return true;
+        }
+      }
+      for (const auto & service_name : filter.service_names) {
+        if (filtered_service_states_[service_name] != service_states[service_name]) {
+          return true;
+        }
+      }
+      return false;
+    };
+  for (auto it = graph_change_filters_.begin(); it != graph_change_filters_.end(); ) {
+    if (changed(it->filter) && !it->callback()) {
+      it = graph_change_filters_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  if (!query_failed) {
+    // The states of the names not filtered anymore are dropped
+    filtered_topic_states_ = std::move(topic_states);
+    filtered_service_states_ = std::move(service_states);
+  }
 }
 
 void
@@ -327,11 +474,100 @@ GraphListener::cleanup_wait_set()
   }
 }
 
+bool
+GraphListener::wait_for_service_ready(
+  const std::string & service_name,
+  const std::function<bool()> & is_ready,
+  std::chrono::nanoseconds timeout)
+{
+  ServiceWaiter waiter{&is_ready, {}, false, false};
+  std::unique_lock<std::mutex> service_waiters_lock(service_waiters_mutex_);
+  // Checked with the lock held, so that the graph changes after the check aren't missed
+  if (is_ready()) {
+    return true;
+  }
+  if (is_shutdown_.load() || timeout <= std::chrono::nanoseconds(0)) {
+    return false;
+  }
+  auto name_and_waiters = service_waiters_.emplace(service_name, std::list<ServiceWaiter *>());
+  auto & waiters = name_and_waiters.first->second;
+  auto waiter_it = waiters.insert(waiters.end(), &waiter);
+  auto pred = [this, &waiter]() {
+      return waiter.woken || is_shutdown_.load();
+    };
+  if (timeout == std::chrono::nanoseconds::max()) {
+    waiter.cv.wait(service_waiters_lock, pred);
+  } else {
+    waiter.cv.wait_for(service_waiters_lock, timeout, pred);
+  }
+  // The listening thread removes the waiters it wakes
+  if (!waiter.woken) {
+    waiters.erase(waiter_it);
+    if (waiters.empty()) {
+      service_waiters_.erase(name_and_waiters.first);
+    }
+  }
+  return waiter.ready;
+}
+
+void
+GraphListener::check_service_waiters()
+{
+  std::lock_guard<std::mutex> service_waiters_lock(service_waiters_mutex_);
+  for (auto name_it = service_waiters_.begin(); name_it != service_waiters_.end(); ) {
+    auto & waiters = name_it->second;
+    auto it = waiters.begin();
+    while (it != waiters.end()) {
+      ServiceWaiter * waiter = *it;
+      try {
+        waiter->ready = (*waiter->is_ready)();
+      } catch (const std::exception & exc) {
+        RCLCPP_ERROR(
+          rclcpp::get_logger("rclcpp"),
+          "caught %s exception when checking service '%s' in GraphListener: %s",
+          rmw::impl::cpp::demangle(exc).c_str(), name_it->first.c_str(), exc.what());
+        waiter->ready = false;
+        waiter->woken = true;
+      } catch (...) {
+        RCLCPP_ERROR(
+          rclcpp::get_logger("rclcpp"),
+          "caught unknown exception when checking service '%s' in GraphListener",
+          name_it->first.c_str());
+        waiter->ready = false;
+        waiter->woken = true;
+      }
+      if (waiter->ready) {
+        waiter->woken = true;
+      }
+      if (!waiter->woken) {
+        // The others waiters of the name are checked after this one on the next graph change
+        waiters.splice(waiters.end(), waiters, it);
+        break;
+      }
+      waiter->cv.notify_all();
+      it = waiters.erase(it);
+    }
+    if (waiters.empty()) {
+      name_it = service_waiters_.erase(name_it);
+    } else {
+      ++name_it;
+    }
+  }
+}
+
 void
 GraphListener::__shutdown()
 {
   std::lock_guard<std::mutex> shutdown_lock(shutdown_mutex_);
   if (!is_shutdown_.exchange(true)) {
+    {
+      std::lock_guard<std::mutex> service_waiters_lock(service_waiters_mutex_);
+      for (auto & name_and_waiters : service_waiters_) {
+        for (ServiceWaiter * waiter : name_and_waiters.second) {
+          waiter->cv.notify_all();
+        }
+      }
+    }
     if (is_started_) {
       interrupt_(&interrupt_guard_condition_);
       listener_thread_.join();
@@ -371,5 +607,11 @@ GraphListener::is_shutdown()
   return is_shutdown_.load();
 }
 
+uint64_t
+GraphListener::get_graph_change_count() const
+{
+  return graph_change_count_.load();
+}
+
 }  // namespace graph_listener
 }  // namespace rclcpp
@@ -74,9 +74,11 @@ GuardCondition::get_rcl_guard_condition() const
 void
 GuardCondition::trigger()
 {
-  rcl_ret_t ret = rcl_trigger_guard_condition(&rcl_guard_condition_);
-  if (RCL_RET_OK != ret) {
-    rclcpp::exceptions::throw_from_rcl_error(ret);
+  if (!coalesce_trigger()) {
+    rcl_ret_t ret = rcl_trigger_guard_condition(&rcl_guard_condition_);
+    if (RCL_RET_OK != ret) {
+      rclcpp::exceptions::throw_from_rcl_error(ret);
+    }
   }
 
   {
@@ -90,6 +92,61 @@ GuardCondition::trigger()
   }
 }
 
+bool
+GuardCondition::coalesce_trigger()
+{
+  if (!coalesce_triggers_.load(std::memory_order_relaxed)) {
+    return false;
+  }
+  TriggerState state = trigger_state_.load();
+  while (true) {
+    switch (state) {
+      case TriggerState::Idle:
+        if (trigger_state_.compare_exchange_weak(state, TriggerState::Triggered)) {
+          return false;
+        }
+        break;
+      case TriggerState::Triggered:
+        if (trigger_state_.compare_exchange_weak(state, TriggerState::Skipped)) {
+          return true;
+        }
+        break;
+      case TriggerState::Skipped:
+        return true;
+    }
+  }
+}
+
+void
+GuardCondition::set_trigger_coalescing(bool enabled)
+{
+  coalesce_triggers_.store(enabled);
+  if (!enabled) {
+    // Don't leave a skipped trigger behind.
+    reset_coalesced_triggers();
+  }
+}
+
+bool
+GuardCondition::get_trigger_coalescing() const
+{
+  return coalesce_triggers_.load();
+}
+
+void
+GuardCondition::reset_coalesced_triggers() const
+{
+  if (TriggerState::Skipped != trigger_state_.exchange(TriggerState::Idle)) {
+    return;
+  }
+  // A trigger was skipped since the last wait, it may have come after the wait had returned.
+  rcl_ret_t ret = rcl_trigger_guard_condition(
+    const_cast<rcl_guard_condition_t *>(&rcl_guard_condition_));
+  if (RCL_RET_OK != ret) {
+    rclcpp::exceptions::throw_from_rcl_error(ret);
+  }
+}
+
 bool
 GuardCondition::exchange_in_use_by_wait_set_state(bool in_use_state)
 {
@@ -109,6 +166,7 @@ GuardCondition::add_to_wait_set(rcl_wait_set_t * wait_set)
     wait_set_ = wait_set;
   }
 
+  reset_coalesced_triggers();
   rcl_ret_t ret = rcl_wait_set_add_guard_condition(wait_set, &this->rcl_guard_condition_, NULL);
   if (RCL_RET_OK != ret) {
     rclcpp::exceptions::throw_from_rcl_error(
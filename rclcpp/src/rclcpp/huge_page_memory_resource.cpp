@@ -0,0 +1,220 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/allocator/huge_page_memory_resource.hpp"
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+namespace rclcpp
+{
+namespace allocator
+{
+
+HugePageMemoryResource::HugePageMemoryResource(const HugePageMemoryResourceOptions & options)
+: options_(options)
+{
+  if (!options_.upstream) {
+    throw std::invalid_argument("upstream memory resource cannot be nullptr");
+  }
+  if (options_.huge_page_size == 0 ||
+    (options_.huge_page_size & (options_.huge_page_size - 1)) != 0)
+  {
+    throw std::invalid_argument("huge page size must be a power of two");
+  }
+}
+
+HugePageMemoryResource::~HugePageMemoryResource()
+{
+  release();
+}
+
+void
+HugePageMemoryResource::release()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto & [size, mappings] : cached_mappings_) {
+    for (void * pointer : mappings) {
+      unmap(pointer, size);
+      statistics_.mapped_bytes -= size;
+    }
+  }
+  cached_mappings_.clear();
+  statistics_.cached_bytes = 0;
+}
+
+HugePageStatistics
+HugePageMemoryResource::get_statistics() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return statistics_;
+}
+
+const HugePageMemoryResourceOptions &
+HugePageMemoryResource::get_options() const noexcept
+{
+  return options_;
+}
+
+void *
+HugePageMemoryResource::do_allocate(size_t bytes, size_t alignment)
+{
+  if (bytes < options_.min_size) {
+    void * pointer = options_.upstream->allocate(bytes, alignment);
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++statistics_.upstream_allocations;
+    return pointer;
+  }
+  if (alignment > options_.huge_page_size) {
+    throw std::bad_alloc();
+  }
+  const size_t size = get_size_class(bytes);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = cached_mappings_.find(size);
+    if (it != cached_mappings_.end() && !it->second.empty()) {
+      void * pointer = it->second.back();
+      it->second.pop_back();
+      statistics_.cached_bytes -= size;
+      ++statistics_.reuses;
+      return pointer;
+    }
+  }
+  // Mapping faults in the pages when prefaulting, which isn't done under the lock
+  bool huge_page_fallback = false;
+  void * pointer = map(size, huge_page_fallback);
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++statistics_.mappings;
+  if (huge_page_fallback) {
+    ++statistics_.huge_page_fallbacks;
+  }
+  statistics_.mapped_bytes += size;
+  return pointer;
+}
+
+void
+HugePageMemoryResource::do_deallocate(void * pointer, size_t bytes, size_t alignment)
+{
+  if (bytes < options_.min_size) {
+    options_.upstream->deallocate(pointer, bytes, alignment);
+    return;
+  }
+  const size_t size = get_size_class(bytes);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (statistics_.cached_bytes + size <= options_.max_cached_bytes) {
+      cached_mappings_[size].push_back(pointer);
+      statistics_.cached_bytes += size;
+      return;
+    }
+    statistics_.mapped_bytes -= size;
+  }
+  unmap(pointer, size);
+}
+
+bool
+HugePageMemoryResource::do_is_equal(const std::pmr::memory_resource & other) const noexcept
+{
+  return this == &other;
+}
+
+size_t
+HugePageMemoryResource::get_size_class(size_t bytes) const
+{
+  const size_t huge_page_size = options_.huge_page_size;
+  size_t pages = bytes / huge_page_size + (bytes % huge_page_size != 0 ? 1 : 0);
+  // Beyond four pages, only the two bits following the highest one are kept, rounding up, so
+  // that a size class is at most 25% larger than the allocations it serves.
+  if (pages > 4) {
+    size_t shift = 0;
+    while ((pages >> shift) >= 8) {
+      ++shift;
+    }
+    const size_t step = size_t(1) << shift;
+    pages = (pages + step - 1) & ~(step - 1);
+  }
+  return pages * huge_page_size;
+}
+
+void *
+HugePageMemoryResource::map(size_t size, bool & huge_page_fallback)
+{
+#ifdef __linux__
+  if (options_.mode == HugePageMode::Explicit) {
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+    if (options_.prefault) {
+      flags |= MAP_POPULATE;
+    }
+    void * pointer = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (pointer != MAP_FAILED) {
+      return pointer;
+    }
+    huge_page_fallback = true;
+  }
+  // Transparent huge pages need mappings aligned to the huge page size, so more is mapped and
+  // the excess unmapped
+  const size_t huge_page_size = options_.huge_page_size;
+  void * mapping = ::mmap(
+    nullptr, size + huge_page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mapping == MAP_FAILED) {
+    throw std::bad_alloc();
+  }
+  const uintptr_t begin = reinterpret_cast<uintptr_t>(mapping);
+  const uintptr_t aligned = (begin + huge_page_size - 1) & ~(uintptr_t(huge_page_size) - 1);
+  if (aligned > begin) {
+    ::munmap(mapping, aligned - begin);
+  }
+  const size_t tail = begin + huge_page_size - aligned;
+  if (tail > 0) {
+    ::munmap(reinterpret_cast<void *>(aligned + size), tail);
+  }
+  void * pointer = reinterpret_cast<void *>(aligned);
+  // Without transparent huge pages enabled for madvise, the memory still gets the normal pages
+  (void)::madvise(pointer, size, MADV_HUGEPAGE);
+  if (options_.prefault) {
+    const size_t page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    auto bytes = static_cast<volatile unsigned char *>(pointer);
+    for (size_t offset = 0; offset < size; offset += page_size) {
+      bytes[offset] = 0;
+    }
+  }
+  return pointer;
+#else
+  (void)huge_page_fallback;
+  return options_.upstream->allocate(size, options_.huge_page_size);
+#endif
+}
+
+void
+HugePageMemoryResource::unmap(void * pointer, size_t size)
+{
+#ifdef __linux__
+  ::munmap(pointer, size);
+#else
+  options_.upstream->deallocate(pointer, size, options_.huge_page_size);
+#endif
+}
+
+}  // namespace allocator
+}  // namespace rclcpp
@@ -44,6 +44,10 @@ InitOptions::InitOptions(const InitOptions & other)
 : InitOptions(*other.get_rcl_init_options())
 {
   shutdown_on_signal = other.shutdown_on_signal;
+  async_logging = other.async_logging;
+  rosout_batching = other.rosout_batching;
+  fast_teardown = other.fast_teardown;
+  worker_pool = other.worker_pool;
   initialize_logging_ = other.initialize_logging_;
 }
 
@@ -71,6 +75,10 @@ InitOptions::operator=(const InitOptions & other)
       rclcpp::exceptions::throw_from_rcl_error(ret, "failed to copy rcl init options");
     }
     this->shutdown_on_signal = other.shutdown_on_signal;
+    this->async_logging = other.async_logging;
+    this->rosout_batching = other.rosout_batching;
+    this->fast_teardown = other.fast_teardown;
+    this->worker_pool = other.worker_pool;
     this->initialize_logging_ = other.initialize_logging_;
   }
   return *this;
@@ -14,9 +14,13 @@
 
 #include "rclcpp/experimental/intra_process_manager.hpp"
 
+#include <algorithm>
 #include <atomic>
+#include <deque>
 #include <memory>
 #include <mutex>
+#include <stdexcept>
+#include <utility>
 
 namespace rclcpp
 {
@@ -26,6 +30,7 @@ namespace experimental
 static std::atomic<uint64_t> _next_unique_id {1};
 
 IntraProcessManager::IntraProcessManager()
+: routing_snapshot_(std::make_shared<const RoutingSnapshot>())
 {}
 
 IntraProcessManager::~IntraProcessManager()
@@ -33,12 +38,37 @@ IntraProcessManager::~IntraProcessManager()
 
 uint64_t
 IntraProcessManager::add_publisher(rclcpp::PublisherBase::SharedPtr publisher)
+{
+  return add_publisher_with_resolver(std::move(publisher), nullptr);
+}
+
+uint64_t
+IntraProcessManager::add_serialized_publisher(rclcpp::PublisherBase::SharedPtr publisher)
+{
+  return add_publisher_with_resolver(std::move(publisher), nullptr, true);
+}
+
+uint64_t
+IntraProcessManager::add_publisher_with_resolver(
+  rclcpp::PublisherBase::SharedPtr publisher,
+  SubscriptionResolver resolver,
+  bool serialized)
 {
   std::unique_lock<std::shared_timed_mutex> lock(mutex_);
 
   uint64_t pub_id = IntraProcessManager::get_next_unique_id();
 
   publishers_[pub_id] = publisher;
+  if (serialized) {
+    serialized_publishers_.insert(pub_id);
+  }
+  if (resolver) {
+    publisher_resolvers_[pub_id] = std::move(resolver);
+  }
+  auto qos = publisher->get_actual_qos();
+  if (qos.durability() == rclcpp::DurabilityPolicy::TransientLocal) {
+    publisher_histories_[pub_id] = std::make_shared<PublisherHistory>(qos.depth());
+  }
 
   // Initialize the subscriptions storage for this publisher.
   pub_to_subs_[pub_id] = SplittedSubscriptions();
@@ -49,11 +79,12 @@ IntraProcessManager::add_publisher(rclcpp::PublisherBase::SharedPtr publisher)
     if (!subscription) {
       continue;
     }
-    if (can_communicate(publisher, subscription)) {
+    if (can_communicate(pub_id, publisher, subscription)) {
       uint64_t sub_id = pair.first;
       insert_sub_id_for_pub(sub_id, pub_id, subscription->use_take_shared_method());
     }
   }
+  update_routing_snapshot();
 
   return pub_id;
 }
@@ -73,11 +104,15 @@ IntraProcessManager::add_subscription(SubscriptionIntraProcessBase::SharedPtr su
     if (!publisher) {
       continue;
     }
-    if (can_communicate(publisher, subscription)) {
-      uint64_t pub_id = pair.first;
+    uint64_t pub_id = pair.first;
+    if (can_communicate(pub_id, publisher, subscription)) {
       insert_sub_id_for_pub(sub_id, pub_id, subscription->use_take_shared_method());
+      if (subscription->get_actual_qos().durability() == rclcpp::DurabilityPolicy::TransientLocal) {
+        replay_history(pub_id, subscription);
+      }
     }
   }
+  update_routing_snapshot();
 
   return sub_id;
 }
@@ -87,7 +122,10 @@ IntraProcessManager::remove_subscription(uint64_t intra_process_subscription_id)
 {
   std::unique_lock<std::shared_timed_mutex> lock(mutex_);
 
-  subscriptions_.erase(intra_process_subscription_id);
+  if (0u == subscriptions_.erase(intra_process_subscription_id)) {
+    // Already removed, e.g. by clear()
+    return;
+  }
 
   for (auto & pair : pub_to_subs_) {
     pair.second.take_shared_subscriptions.erase(
@@ -104,6 +142,7 @@ IntraProcessManager::remove_subscription(uint64_t intra_process_subscription_id)
         intra_process_subscription_id),
       pair.second.take_ownership_subscriptions.end());
   }
+  update_routing_snapshot();
 }
 
 void
@@ -111,16 +150,89 @@ IntraProcessManager::remove_publisher(uint64_t intra_process_publisher_id)
 {
   std::unique_lock<std::shared_timed_mutex> lock(mutex_);
 
-  publishers_.erase(intra_process_publisher_id);
+  if (0u == publishers_.erase(intra_process_publisher_id)) {
+    // Already removed, e.g. by clear()
+    return;
+  }
   pub_to_subs_.erase(intra_process_publisher_id);
+  publisher_resolvers_.erase(intra_process_publisher_id);
+  publisher_histories_.erase(intra_process_publisher_id);
+  serialized_publishers_.erase(intra_process_publisher_id);
+  update_routing_snapshot();
+}
+
+void
+IntraProcessManager::clear()
+{
+  std::unique_lock<std::shared_timed_mutex> lock(mutex_);
+
+  publishers_.clear();
+  pub_to_subs_.clear();
+  publisher_resolvers_.clear();
+  publisher_histories_.clear();
+  serialized_publishers_.clear();
+  subscriptions_.clear();
+  routing_snapshot_.store(std::make_shared<const RoutingSnapshot>());
+}
+
+void
+IntraProcessManager::do_serialized_intra_process_publish(
+  uint64_t intra_process_publisher_id,
+  std::shared_ptr<const rclcpp::SerializedMessage> message)
+{
+  const auto snapshot = routing_snapshot_.load();
+  const PublisherRoute * route = find_route(*snapshot, intra_process_publisher_id);
+  if (route == nullptr) {
+    // Publisher is either invalid or no longer exists.
+    RCLCPP_WARN(
+      rclcpp::get_logger("rclcpp"),
+      "Calling do_serialized_intra_process_publish for invalid or no longer existing "
+      "publisher id");
+    return;
+  }
+
+  const rclcpp::SerializedMessage & message_ref = *message;
+  auto serialized_message = std::make_shared<LazySerializedMessage>(std::move(message));
+  for (const auto & routed_subscription : route->all_subscriptions) {
+    auto subscription_base = routed_subscription.subscription.lock();
+    if (subscription_base == nullptr) {
+      continue;
+    }
+    const auto content_filter = subscription_base->get_content_filter();
+    if (
+      subscription_base->drop_by_pause() ||
+      (content_filter && !content_filter->matches(message_ref)) ||
+      subscription_base->drop_by_rate_limit())
+    {
+      continue;
+    }
+    auto subscription = std::dynamic_pointer_cast<
+      rclcpp::experimental::SubscriptionIntraProcessSerialized>(subscription_base);
+    if (subscription == nullptr) {
+      throw std::runtime_error(
+              "failed to dynamic cast SubscriptionIntraProcessBase to "
+              "SubscriptionIntraProcessSerialized, which can happen when a publisher of "
+              "serialized messages wasn't registered with add_serialized_publisher");
+    }
+    subscription->provide_serialized_message(serialized_message);
+  }
 }
 
 bool
-IntraProcessManager::matches_any_publishers(const rmw_gid_t * id) const
+IntraProcessManager::matches_any_publishers(
+  const rmw_gid_t * id,
+  bool include_serialized_publishers) const
 {
   std::shared_lock<std::shared_timed_mutex> lock(mutex_);
 
   for (auto & publisher_pair : publishers_) {
+    if (
+      !include_serialized_publishers &&
+      serialized_publishers_.count(publisher_pair.first) != 0)
+    {
+      // This publisher doesn't deliver intra-process messages to this subscription
+      continue;
+    }
     auto publisher = publisher_pair.second.lock();
     if (!publisher) {
       continue;
@@ -135,10 +247,9 @@ IntraProcessManager::matches_any_publishers(const rmw_gid_t * id) const
 size_t
 IntraProcessManager::get_subscription_count(uint64_t intra_process_publisher_id) const
 {
-  std::shared_lock<std::shared_timed_mutex> lock(mutex_);
-
-  auto publisher_it = pub_to_subs_.find(intra_process_publisher_id);
-  if (publisher_it == pub_to_subs_.end()) {
+  const auto snapshot = routing_snapshot_.load();
+  const PublisherRoute * route = find_route(*snapshot, intra_process_publisher_id);
+  if (route == nullptr) {
     // Publisher is either invalid or no longer exists.
     RCLCPP_WARN(
       rclcpp::get_logger("rclcpp"),
@@ -146,11 +257,7 @@ IntraProcessManager::get_subscription_count(uint64_t intra_process_publisher_id)
     return 0;
   }
 
-  auto count =
-    publisher_it->second.take_shared_subscriptions.size() +
-    publisher_it->second.take_ownership_subscriptions.size();
-
-  return count;
+  return route->all_subscriptions.size();
 }
 
 SubscriptionIntraProcessBase::SharedPtr
@@ -207,8 +314,84 @@ IntraProcessManager::insert_sub_id_for_pub(
   }
 }
 
+void
+IntraProcessManager::update_routing_snapshot()
+{
+  auto snapshot = std::make_shared<RoutingSnapshot>();
+  snapshot->reserve(pub_to_subs_.size());
+  auto get_subscriptions = [this](
+    const std::vector<uint64_t> & sub_ids, const SubscriptionResolver * resolver)
+    {
+      RoutedSubscriptions subscriptions;
+      subscriptions.reserve(sub_ids.size());
+      for (uint64_t sub_id : sub_ids) {
+        auto subscription_it = subscriptions_.find(sub_id);
+        if (subscription_it == subscriptions_.end()) {
+          continue;
+        }
+        RoutedSubscription routed_subscription;
+        routed_subscription.subscription = subscription_it->second;
+        auto subscription = subscription_it->second.lock();
+        if (resolver != nullptr && subscription != nullptr) {
+          routed_subscription.typed_subscriptions = (*resolver)(*subscription);
+        }
+        subscriptions.push_back(std::move(routed_subscription));
+      }
+      return subscriptions;
+    };
+  for (const auto & pair : pub_to_subs_) {
+    auto resolver_it = publisher_resolvers_.find(pair.first);
+    const SubscriptionResolver * resolver =
+      resolver_it != publisher_resolvers_.end() ? &resolver_it->second : nullptr;
+    PublisherRoute route;
+    route.publisher_id = pair.first;
+    auto history_it = publisher_histories_.find(pair.first);
+    if (history_it != publisher_histories_.end()) {
+      route.history = history_it->second;
+    }
+    route.take_shared_subscriptions =
+      get_subscriptions(pair.second.take_shared_subscriptions, resolver);
+    route.take_ownership_subscriptions =
+      get_subscriptions(pair.second.take_ownership_subscriptions, resolver);
+    route.all_subscriptions = route.take_shared_subscriptions;
+    route.all_subscriptions.insert(
+      route.all_subscriptions.end(),
+      route.take_ownership_subscriptions.begin(),
+      route.take_ownership_subscriptions.end());
+    snapshot->push_back(std::move(route));
+  }
+  std::sort(
+    snapshot->begin(), snapshot->end(),
+    [](const PublisherRoute & a, const PublisherRoute & b) {
+      return a.publisher_id < b.publisher_id;
+    });
+  std::shared_ptr<const RoutingSnapshot> published_snapshot = std::move(snapshot);
+  routing_snapshot_.store(std::move(published_snapshot));
+}
+
+void
+IntraProcessManager::replay_history(
+  uint64_t pub_id,
+  const SubscriptionIntraProcessBase::SharedPtr & subscription)
+{
+  auto history_it = publisher_histories_.find(pub_id);
+  if (history_it == publisher_histories_.end()) {
+    return;
+  }
+  // Copy the entries, so that the publisher isn't blocked while the messages are given
+  std::deque<HistoryEntry> entries;
+  {
+    std::lock_guard<std::mutex> lock(history_it->second->mutex);
+    entries = history_it->second->entries;
+  }
+  for (const HistoryEntry & entry : entries) {
+    (this->*entry.replay)(entry, subscription);
+  }
+}
+
 bool
 IntraProcessManager::can_communicate(
+  uint64_t pub_id,
   rclcpp::PublisherBase::SharedPtr pub,
   rclcpp::experimental::SubscriptionIntraProcessBase::SharedPtr sub) const
 {
@@ -217,6 +400,14 @@ IntraProcessManager::can_communicate(
     return false;
   }
 
+  // serialized messages can only be given to the subscriptions of serialized messages
+  if (
+    serialized_publishers_.count(pub_id) != 0 &&
+    dynamic_cast<rclcpp::experimental::SubscriptionIntraProcessSerialized *>(sub.get()) == nullptr)
+  {
+    return false;
+  }
+
   auto check_result = rclcpp::qos_check_compatible(pub->get_actual_qos(), sub->get_actual_qos());
   if (check_result.compatibility == rclcpp::QoSCompatibility::Error) {
     return false;
@@ -0,0 +1,85 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/experimental/intra_process_service_manager.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+
+using rclcpp::experimental::IntraProcessServiceManager;
+using rclcpp::experimental::IntraProcessServiceWaitable;
+
+uint64_t
+IntraProcessServiceManager::add_service(IntraProcessServiceWaitable::SharedPtr service)
+{
+  std::unique_lock<std::shared_timed_mutex> lock(mutex_);
+  const uint64_t id = next_service_id_++;
+  services_[service->get_service_name()].push_back({id, service});
+  generation_++;
+  return id;
+}
+
+void
+IntraProcessServiceManager::remove_service(uint64_t intra_process_service_id)
+{
+  std::unique_lock<std::shared_timed_mutex> lock(mutex_);
+  for (auto it = services_.begin(); it != services_.end(); ++it) {
+    auto & services = it->second;
+    auto service_it = std::find_if(
+      services.begin(), services.end(),
+      [intra_process_service_id](const ServiceInfo & info) {
+        return info.id == intra_process_service_id;
+      });
+    if (service_it != services.end()) {
+      services.erase(service_it);
+      if (services.empty()) {
+        services_.erase(it);
+      }
+      generation_++;
+      return;
+    }
+  }
+}
+
+IntraProcessServiceWaitable::SharedPtr
+IntraProcessServiceManager::get_service(const std::string & service_name) const
+{
+  std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+  auto it = services_.find(service_name);
+  if (it == services_.end()) {
+    return nullptr;
+  }
+  for (const auto & info : it->second) {
+    auto service = info.service.lock();
+    if (service) {
+      return service;
+    }
+  }
+  return nullptr;
+}
+
+uint64_t
+IntraProcessServiceManager::get_generation() const
+{
+  return generation_.load();
+}
+
+uint64_t
+IntraProcessServiceManager::reserve_client_id()
+{
+  return next_client_id_++;
+}
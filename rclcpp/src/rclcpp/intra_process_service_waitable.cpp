@@ -0,0 +1,106 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/experimental/intra_process_service_waitable.hpp"
+
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "rmw/impl/cpp/demangle.hpp"
+
+#include "rclcpp/detail/add_guard_condition_to_rcl_wait_set.hpp"
+#include "rclcpp/logging.hpp"
+
+using rclcpp::experimental::IntraProcessServiceWaitable;
+
+IntraProcessServiceWaitable::IntraProcessServiceWaitable(
+  rclcpp::Context::SharedPtr context,
+  const std::string & service_name,
+  EntityType entity_type)
+: gc_(context), service_name_(service_name), entity_type_(entity_type)
+{
+  gc_.set_trigger_coalescing(true);
+}
+
+void
+IntraProcessServiceWaitable::add_to_wait_set(rcl_wait_set_t * wait_set)
+{
+  detail::add_guard_condition_to_rcl_wait_set(*wait_set, gc_);
+}
+
+const char *
+IntraProcessServiceWaitable::get_service_name() const
+{
+  return service_name_.c_str();
+}
+
+void
+IntraProcessServiceWaitable::set_on_ready_callback(std::function<void(size_t, int)> callback)
+{
+  if (!callback) {
+    throw std::invalid_argument(
+            "The callback passed to set_on_ready_callback "
+            "is not callable.");
+  }
+
+  // Note: we bind the int identifier argument to this waitable's entity type
+  auto new_callback =
+    [callback, this](size_t number_of_events) {
+      try {
+        callback(number_of_events, static_cast<int>(entity_type_));
+      } catch (const std::exception & exception) {
+        RCLCPP_ERROR_STREAM(
+          rclcpp::get_logger("rclcpp"),
+          "rclcpp::IntraProcessServiceWaitable@" << this <<
+            " caught " << rmw::impl::cpp::demangle(exception) <<
+            " exception in user-provided callback for the 'on ready' callback: " <<
+            exception.what());
+      } catch (...) {
+        RCLCPP_ERROR_STREAM(
+          rclcpp::get_logger("rclcpp"),
+          "rclcpp::IntraProcessServiceWaitable@" << this <<
+            " caught unhandled exception in user-provided callback " <<
+            "for the 'on ready' callback");
+      }
+    };
+
+  std::lock_guard<std::mutex> lock(callback_mutex_);
+  on_ready_callback_ = new_callback;
+  if (unread_count_ > 0) {
+    on_ready_callback_(unread_count_);
+    unread_count_ = 0;
+  }
+}
+
+void
+IntraProcessServiceWaitable::clear_on_ready_callback()
+{
+  std::lock_guard<std::mutex> lock(callback_mutex_);
+  on_ready_callback_ = nullptr;
+}
+
+void
+IntraProcessServiceWaitable::notify_ready()
+{
+  gc_.trigger();
+  std::lock_guard<std::mutex> lock(callback_mutex_);
+  if (on_ready_callback_) {
+    on_ready_callback_(1);
+  } else {
+    unread_count_++;
+  }
+}
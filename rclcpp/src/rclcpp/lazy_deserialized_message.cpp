@@ -0,0 +1,360 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "rclcpp/lazy_deserialized_message.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "rclcpp/serialization.hpp"
+
+#include "rcutils/error_handling.h"
+
+#include "rosidl_typesupport_introspection_cpp/field_types.hpp"
+#include "rosidl_typesupport_introspection_cpp/identifier.hpp"
+#include "rosidl_typesupport_introspection_cpp/message_introspection.hpp"
+
+using rclcpp::LazyDeserializedMessageBase;
+using rosidl_typesupport_introspection_cpp::MessageMember;
+using rosidl_typesupport_introspection_cpp::MessageMembers;
+
+namespace
+{
+
+// The CDR stream starts after the encapsulation header
+constexpr size_t kEncapsulationSize = 4u;
+constexpr uint8_t kEncapsulationCdrLittleEndian = 0x01;
+
+bool
+is_host_little_endian()
+{
+  const uint16_t value = 1u;
+  uint8_t first_byte;
+  std::memcpy(&first_byte, &value, 1u);
+  return first_byte == 1u;
+}
+
+/// Reader of the CDR stream of a serialized message, with the alignment relative to its start.
+class CdrReader
+{
+public:
+  CdrReader(const uint8_t * data, size_t size, size_t position)
+  : data_(data), size_(size), position_(position)
+  {}
+
+  bool
+  align(size_t alignment)
+  {
+    position_ = (position_ + alignment - 1) / alignment * alignment;
+    return position_ <= size_;
+  }
+
+  /// Read the given number of bytes, or only skip them if the output is nullptr.
+  bool
+  read(void * output, size_t size)
+  {
+    if (position_ > size_ || size_ - position_ < size) {
+      return false;
+    }
+    if (output != nullptr && size > 0u) {
+      std::memcpy(output, data_ + position_, size);
+    }
+    position_ += size;
+    return true;
+  }
+
+  bool
+  read_length(uint32_t & length)
+  {
+    return align(4u) && read(&length, sizeof(length));
+  }
+
+  const uint8_t *
+  data() const
+  {
+    return data_ + position_;
+  }
+
+  size_t
+  position() const
+  {
+    return position_;
+  }
+
+private:
+  const uint8_t * data_;
+  size_t size_;
+  size_t position_;
+};
+
+/// Return the serialized size of a primitive type, or zero if the type can't be decoded.
+size_t
+get_primitive_size(uint8_t type_id)
+{
+  namespace ts = rosidl_typesupport_introspection_cpp;
+  switch (type_id) {
+    case ts::ROS_TYPE_BOOLEAN:
+    case ts::ROS_TYPE_CHAR:
+    case ts::ROS_TYPE_OCTET:
+    case ts::ROS_TYPE_UINT8:
+    case ts::ROS_TYPE_INT8:
+      return 1u;
+    case ts::ROS_TYPE_UINT16:
+    case ts::ROS_TYPE_INT16:
+      return 2u;
+    case ts::ROS_TYPE_FLOAT:
+    case ts::ROS_TYPE_UINT32:
+    case ts::ROS_TYPE_INT32:
+      return 4u;
+    case ts::ROS_TYPE_DOUBLE:
+    case ts::ROS_TYPE_UINT64:
+    case ts::ROS_TYPE_INT64:
+      return 8u;
+    default:
+      // Long doubles and wide characters depend on the rmw implementation
+      return 0u;
+  }
+}
+
+bool
+process_members(CdrReader & reader, const MessageMembers & members, void * message);
+
+/// Decode a single value of the type of the member, or only skip it if the value is nullptr.
+bool
+process_value(CdrReader & reader, const MessageMember & member, void * value)
+{
+  namespace ts = rosidl_typesupport_introspection_cpp;
+  if (member.type_id_ == ts::ROS_TYPE_STRING) {
+    uint32_t length = 0u;
+    if (!reader.read_length(length)) {
+      return false;
+    }
+    // The length accounts for the null terminator
+    const char * characters = reinterpret_cast<const char *>(reader.data());
+    if (!reader.read(nullptr, length)) {
+      return false;
+    }
+    if (value != nullptr) {
+      static_cast<std::string *>(value)->assign(characters, length > 0u ? length - 1u : 0u);
+    }
+    return true;
+  }
+  if (member.type_id_ == ts::ROS_TYPE_MESSAGE) {
+    if (member.members_ == nullptr || member.members_->data == nullptr) {
+      return false;
+    }
+    return process_members(
+      reader, *static_cast<const MessageMembers *>(member.members_->data), value);
+  }
+  const size_t size = get_primitive_size(member.type_id_);
+  if (size == 0u || !reader.align(size)) {
+    return false;
+  }
+  if (member.type_id_ == ts::ROS_TYPE_BOOLEAN && value != nullptr) {
+    uint8_t byte = 0u;
+    if (!reader.read(&byte, 1u)) {
+      return false;
+    }
+    *static_cast<bool *>(value) = byte != 0u;
+    return true;
+  }
+  return reader.read(value, size);
+}
+
+/// Decode a member into its field in the message, or only skip it if the field is nullptr.
+bool
+process_member(CdrReader & reader, const MessageMember & member, void * field)
+{
+  namespace ts = rosidl_typesupport_introspection_cpp;
+  if (!member.is_array_) {
+    return process_value(reader, member, field);
+  }
+
+  const bool is_fixed_size_array = member.array_size_ > 0u && !member.is_upper_bound_;
+  size_t count = member.array_size_;
+  if (!is_fixed_size_array) {
+    uint32_t length = 0u;
+    if (!reader.read_length(length)) {
+      return false;
+    }
+    count = length;
+    if (field != nullptr) {
+      if (member.resize_function == nullptr) {
+        return false;
+      }
+      member.resize_function(field, count);
+    }
+  }
+  if (count == 0u) {
+    return true;
+  }
+
+  // Arrays of primitives are contiguous, e.g. the data of a point cloud is skipped at once
+  const size_t size = get_primitive_size(member.type_id_);
+  if (size > 0u && member.type_id_ != ts::ROS_TYPE_BOOLEAN) {
+    if (!reader.align(size)) {
+      return false;
+    }
+    if (field == nullptr) {
+      return count <= SIZE_MAX / size && reader.read(nullptr, count * size);
+    }
+    if (member.get_function == nullptr || count > SIZE_MAX / size) {
+      return false;
+    }
+    return reader.read(member.get_function(field, 0u), count * size);
+  }
+
+  for (size_t i = 0u; i < count; ++i) {
+    if (field == nullptr) {
+      if (!process_value(reader, member, nullptr)) {
+        return false;
+      }
+    } else if (member.type_id_ == ts::ROS_TYPE_BOOLEAN) {
+      // std::vector<bool> doesn't give access to its elements
+      bool value = false;
+      if (member.assign_function == nullptr || !process_value(reader, member, &value)) {
+        return false;
+      }
+      member.assign_function(field, i, &value);
+    } else {
+      if (member.get_function == nullptr ||
+        !process_value(reader, member, member.get_function(field, i)))
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/// Decode all the members of a message, or only skip them if the message is nullptr.
+bool
+process_members(CdrReader & reader, const MessageMembers & members, void * message)
+{
+  for (uint32_t i = 0u; i < members.member_count_; ++i) {
+    const MessageMember & member = members.members_[i];
+    void * field = message ? static_cast<uint8_t *>(message) + member.offset_ : nullptr;
+    if (!process_member(reader, member, field)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+LazyDeserializedMessageBase::LazyDeserializedMessageBase(
+  std::shared_ptr<const rclcpp::SerializedMessage> serialized_message,
+  const rosidl_message_type_support_t * type_support)
+: serialized_message_(std::move(serialized_message)), type_support_(type_support)
+{
+  if (!type_support_) {
+    throw std::invalid_argument("type support cannot be nullptr");
+  }
+}
+
+LazyDeserializedMessageBase::~LazyDeserializedMessageBase()
+{}
+
+std::shared_ptr<const rclcpp::SerializedMessage>
+LazyDeserializedMessageBase::get_serialized_message() const
+{
+  return serialized_message_;
+}
+
+bool
+LazyDeserializedMessageBase::resolve_members()
+{
+  if (members_resolved_) {
+    return members_ != nullptr;
+  }
+  members_resolved_ = true;
+
+  const auto & buffer = serialized_message_->get_rcl_serialized_message();
+  if (buffer.buffer_length < kEncapsulationSize || buffer.buffer[0] != 0u ||
+    buffer.buffer[1] != kEncapsulationCdrLittleEndian || !is_host_little_endian())
+  {
+    return false;
+  }
+  const rosidl_message_type_support_t * introspection_type_support =
+    get_message_typesupport_handle(
+    type_support_, rosidl_typesupport_introspection_cpp::typesupport_identifier);
+  if (!introspection_type_support) {
+    // The introspection type support library of the message isn't available
+    rcutils_reset_error();
+    return false;
+  }
+  members_ = introspection_type_support->data;
+  member_positions_.push_back(0u);
+  return members_ != nullptr;
+}
+
+bool
+LazyDeserializedMessageBase::decode_member(size_t member_offset, void * message)
+{
+  if (std::find(decoded_members_.begin(), decoded_members_.end(), member_offset) !=
+    decoded_members_.end())
+  {
+    return true;
+  }
+  if (!serialized_message_ || !resolve_members()) {
+    return false;
+  }
+  const auto & members = *static_cast<const MessageMembers *>(members_);
+  size_t index = 0u;
+  while (index < members.member_count_ && members.members_[index].offset_ != member_offset) {
+    ++index;
+  }
+  if (index == members.member_count_) {
+    return false;
+  }
+
+  const auto & buffer = serialized_message_->get_rcl_serialized_message();
+  const uint8_t * data = buffer.buffer + kEncapsulationSize;
+  const size_t size = buffer.buffer_length - kEncapsulationSize;
+  // The members before are skipped once, their positions are kept for the next fields
+  while (member_positions_.size() <= index) {
+    const size_t previous = member_positions_.size() - 1u;
+    CdrReader reader(data, size, member_positions_[previous]);
+    if (!process_member(reader, members.members_[previous], nullptr)) {
+      return false;
+    }
+    member_positions_.push_back(reader.position());
+  }
+
+  CdrReader reader(data, size, member_positions_[index]);
+  if (!process_member(
+      reader, members.members_[index], static_cast<uint8_t *>(message) + member_offset))
+  {
+    return false;
+  }
+  if (member_positions_.size() == index + 1u) {
+    member_positions_.push_back(reader.position());
+  }
+  decoded_members_.push_back(member_offset);
+  return true;
+}
+
+void
+LazyDeserializedMessageBase::deserialize(void * message) const
+{
+  rclcpp::SerializationBase serialization(type_support_);
+  serialization.deserialize_message(serialized_message_.get(), message);
+}
@@ -0,0 +1,240 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "rclcpp/memory_accounting.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using rclcpp::AccountingMemoryResource;
+using rclcpp::MemoryAccount;
+using rclcpp::MemoryAccounting;
+using rclcpp::MemoryUsage;
+
+namespace
+{
+
+std::atomic_bool g_enabled{false};
+
+struct Registry
+{
+  std::mutex mutex;
+  std::vector<const MemoryAccount *> accounts;
+};
+
+Registry &
+get_registry()
+{
+  static Registry registry;
+  return registry;
+}
+
+}  // namespace
+
+const char *
+rclcpp::to_string(MemoryEntityKind kind)
+{
+  switch (kind) {
+    case MemoryEntityKind::Publisher:
+      return "publisher";
+    case MemoryEntityKind::Subscription:
+      return "subscription";
+    case MemoryEntityKind::IntraProcessBuffer:
+      return "intra_process_buffer";
+    case MemoryEntityKind::MessagePool:
+      return "message_pool";
+    case MemoryEntityKind::Parameters:
+      return "parameters";
+    case MemoryEntityKind::Other:
+      return "other";
+  }
+  return "unknown";
+}
+
+MemoryAccount::MemoryAccount(
+  const std::string & node_name,
+  const std::string & entity_name,
+  MemoryEntityKind kind,
+  Probe probe)
+: node_name_(node_name), entity_name_(entity_name), kind_(kind), probe_(std::move(probe))
+{
+  MemoryAccounting::register_account(this);
+}
+
+MemoryAccount::~MemoryAccount()
+{
+  MemoryAccounting::unregister_account(this);
+}
+
+MemoryUsage
+MemoryAccount::get_usage() const
+{
+  MemoryUsage usage;
+  usage.node_name = node_name_;
+  usage.entity_name = entity_name_;
+  usage.kind = kind_;
+  usage.bytes_in_use = bytes_in_use_.load(std::memory_order_relaxed);
+  if (probe_) {
+    const MemorySample sample = probe_();
+    usage.bytes_in_use += sample.bytes_in_use;
+    update_high_water_mark(sample.high_water_mark);
+  }
+  update_high_water_mark(usage.bytes_in_use);
+  usage.high_water_mark = high_water_mark_.load(std::memory_order_relaxed);
+  return usage;
+}
+
+void
+MemoryAccount::reset_high_water_mark() noexcept
+{
+  high_water_mark_.store(bytes_in_use_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+void
+MemoryAccounting::enable()
+{
+  g_enabled.store(true);
+}
+
+void
+MemoryAccounting::disable()
+{
+  g_enabled.store(false);
+}
+
+bool
+MemoryAccounting::is_enabled() noexcept
+{
+  return g_enabled.load(std::memory_order_relaxed);
+}
+
+MemoryAccount::SharedPtr
+MemoryAccounting::create_account(
+  const std::string & node_name,
+  const std::string & entity_name,
+  MemoryEntityKind kind,
+  MemoryAccount::Probe probe)
+{
+  if (!is_enabled()) {
+    return nullptr;
+  }
+  return std::make_shared<MemoryAccount>(node_name, entity_name, kind, std::move(probe));
+}
+
+std::vector<MemoryUsage>
+MemoryAccounting::get_usage()
+{
+  auto & registry = get_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  std::vector<MemoryUsage> usage;
+  usage.reserve(registry.accounts.size());
+  for (const MemoryAccount * account : registry.accounts) {
+    usage.push_back(account->get_usage());
+  }
+  return usage;
+}
+
+std::vector<MemoryUsage>
+MemoryAccounting::get_usage(const std::string & node_name)
+{
+  auto & registry = get_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  std::vector<MemoryUsage> usage;
+  for (const MemoryAccount * account : registry.accounts) {
+    if (account->node_name_ == node_name) {
+      usage.push_back(account->get_usage());
+    }
+  }
+  return usage;
+}
+
+uint64_t
+MemoryAccounting::get_total_bytes_in_use(const std::string & node_name)
+{
+  uint64_t total = 0;
+  for (const auto & usage : get_usage(node_name)) {
+    total += usage.bytes_in_use;
+  }
+  return total;
+}
+
+void
+MemoryAccounting::register_account(const MemoryAccount * account)
+{
+  auto & registry = get_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.accounts.push_back(account);
+}
+
+void
+MemoryAccounting::unregister_account(const MemoryAccount * account)
+{
+  auto & registry = get_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  auto it = std::find(registry.accounts.begin(), registry.accounts.end(), account);
+  if (it != registry.accounts.end()) {
+    // The order of the accounts doesn't matter
+    *it = registry.accounts.back();
+    registry.accounts.pop_back();
+  }
+}
+
+AccountingMemoryResource::AccountingMemoryResource(
+  MemoryAccount::SharedPtr account,
+  std::pmr::memory_resource * upstream)
+: account_(std::move(account)), upstream_(upstream)
+{
+  if (!upstream_) {
+    throw std::invalid_argument("upstream memory resource cannot be nullptr");
+  }
+}
+
+const MemoryAccount::SharedPtr &
+AccountingMemoryResource::get_account() const noexcept
+{
+  return account_;
+}
+
+void *
+AccountingMemoryResource::do_allocate(size_t bytes, size_t alignment)
+{
+  void * pointer = upstream_->allocate(bytes, alignment);
+  if (account_) {
+    account_->on_allocate(bytes);
+  }
+  return pointer;
+}
+
+void
+AccountingMemoryResource::do_deallocate(void * pointer, size_t bytes, size_t alignment)
+{
+  upstream_->deallocate(pointer, bytes, alignment);
+  if (account_) {
+    account_->on_deallocate(bytes);
+  }
+}
+
+bool
+AccountingMemoryResource::do_is_equal(const std::pmr::memory_resource & other) const noexcept
+{
+  return this == &other;
+}
@@ -0,0 +1,72 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/allocator/memory_resource.hpp"
+
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+
+namespace rclcpp
+{
+namespace allocator
+{
+
+MemoryResourceType
+memory_resource_type_from_string(const std::string & name)
+{
+  if (name == "new_delete") {
+    return MemoryResourceType::NewDelete;
+  }
+  if (name == "synchronized_pool") {
+    return MemoryResourceType::SynchronizedPool;
+  }
+  if (name == "unsynchronized_pool") {
+    return MemoryResourceType::UnsynchronizedPool;
+  }
+  if (name == "monotonic") {
+    return MemoryResourceType::Monotonic;
+  }
+  if (name == "huge_page") {
+    return MemoryResourceType::HugePage;
+  }
+  throw std::invalid_argument("unknown memory resource type '" + name + "'");
+}
+
+std::shared_ptr<std::pmr::memory_resource>
+create_memory_resource(const MemoryResourceOptions & options)
+{
+  switch (options.type) {
+    case MemoryResourceType::NewDelete:
+      // Not owned, it lives until the end of the program
+      return std::shared_ptr<std::pmr::memory_resource>(
+        std::pmr::new_delete_resource(), [](std::pmr::memory_resource *) {});
+    case MemoryResourceType::SynchronizedPool:
+      return std::make_shared<std::pmr::synchronized_pool_resource>(options.pool_options);
+    case MemoryResourceType::UnsynchronizedPool:
+      return std::make_shared<std::pmr::unsynchronized_pool_resource>(options.pool_options);
+    case MemoryResourceType::Monotonic:
+      if (options.initial_size > 0) {
+        return std::make_shared<std::pmr::monotonic_buffer_resource>(options.initial_size);
+      }
+      return std::make_shared<std::pmr::monotonic_buffer_resource>();
+    case MemoryResourceType::HugePage:
+      return std::make_shared<HugePageMemoryResource>(options.huge_page);
+  }
+  throw std::invalid_argument("unknown memory resource type");
+}
+
+}  // namespace allocator
+}  // namespace rclcpp
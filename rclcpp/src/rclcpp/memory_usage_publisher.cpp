@@ -0,0 +1,81 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "rclcpp/memory_usage_publisher.hpp"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "libstatistics_collector/collector/generate_statistics_message.hpp"
+#include "libstatistics_collector/moving_average_statistics/types.hpp"
+
+using libstatistics_collector::collector::GenerateStatisticMessage;
+using libstatistics_collector::moving_average_statistics::StatisticData;
+using rclcpp::MemoryUsagePublisher;
+using statistics_msgs::msg::MetricsMessage;
+
+namespace
+{
+constexpr const char kBytesUnitName[] = "bytes";
+}  // namespace
+
+MemoryUsagePublisher::~MemoryUsagePublisher()
+{
+  if (timer_) {
+    timer_->cancel();
+  }
+}
+
+void
+MemoryUsagePublisher::publish()
+{
+  for (const auto & message : generate_messages()) {
+    publisher_->publish(message);
+  }
+}
+
+std::vector<MetricsMessage>
+MemoryUsagePublisher::generate_messages()
+{
+  const rclcpp::Time window_end = now();
+  std::vector<MetricsMessage> messages;
+  for (const auto & usage : rclcpp::MemoryAccounting::get_usage(node_name_)) {
+    StatisticData data;
+    data.average = static_cast<double>(usage.bytes_in_use);
+    data.min = data.average;
+    data.max = static_cast<double>(usage.high_water_mark);
+    data.standard_deviation = 0.0;
+    data.sample_count = 1;
+    messages.push_back(
+      GenerateStatisticMessage(
+        node_name_,
+        std::string(rclcpp::to_string(usage.kind)) + "/" + usage.entity_name,
+        kBytesUnitName,
+        window_start_,
+        window_end,
+        data));
+  }
+  window_start_ = window_end;
+  return messages;
+}
+
+rclcpp::Time
+MemoryUsagePublisher::now()
+{
+  return rclcpp::Time(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count());
+}
@@ -36,4 +36,16 @@ MessageInfo::get_rmw_message_info()
   return rmw_message_info_;
 }
 
+const rclcpp::MessageLineage &
+MessageInfo::get_lineage() const
+{
+  return lineage_;
+}
+
+void
+MessageInfo::set_lineage(const rclcpp::MessageLineage & lineage)
+{
+  lineage_ = lineage;
+}
+
 }  // namespace rclcpp
@@ -0,0 +1,177 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/message_lineage.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+
+namespace rclcpp
+{
+
+namespace
+{
+
+/// Flows of the messages of this thread.
+struct ThreadLineage
+{
+  /// Flow of the message whose callback runs.
+  MessageLineage current;
+  /// Flow of the messages being published.
+  MessageLineage published;
+};
+
+thread_local ThreadLineage g_thread_lineage;
+
+int64_t
+now_ns()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+}  // namespace
+
+MessageLineage
+start_message_flow()
+{
+  // The identifiers of a process follow a random start, so the flows of the processes
+  // recording their messages together are unlikely to collide
+  static const uint64_t first_flow_id = []() {
+      std::random_device random_device;
+      return (uint64_t(random_device()) << 32) | random_device();
+    }();
+  static std::atomic<uint64_t> flow_count{0};
+
+  MessageLineage lineage;
+  lineage.flow_id = first_flow_id + flow_count.fetch_add(1, std::memory_order_relaxed);
+  if (0 == lineage.flow_id) {
+    lineage.flow_id = first_flow_id + flow_count.fetch_add(1, std::memory_order_relaxed);
+  }
+  lineage.origin_timestamp = now_ns();
+  return lineage;
+}
+
+const MessageLineage &
+get_current_message_lineage()
+{
+  return g_thread_lineage.current;
+}
+
+MessageLineageScope::MessageLineageScope(const MessageLineage & lineage)
+: previous_lineage_(g_thread_lineage.current),
+  previous_published_lineage_(g_thread_lineage.published)
+{
+  g_thread_lineage.current = lineage;
+  // A callback run while a message is published, e.g. with a direct dispatch, doesn't
+  // publish in the flow of that message
+  g_thread_lineage.published = MessageLineage();
+}
+
+MessageLineageScope::~MessageLineageScope()
+{
+  g_thread_lineage.current = previous_lineage_;
+  g_thread_lineage.published = previous_published_lineage_;
+}
+
+MessageLineageTracker::MessageLineageTracker(size_t capacity)
+{
+  if (0 == capacity) {
+    throw std::invalid_argument("the capacity of a message lineage tracker must not be 0");
+  }
+  entries_.resize(capacity);
+}
+
+void
+MessageLineageTracker::record(const void * message)
+{
+  // Recorded even without a flow, so the flow of a message freed before being taken isn't
+  // given to the next one allocated at its address
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_[next_entry_].message = message;
+  entries_[next_entry_].lineage = detail::get_published_message_lineage();
+  next_entry_ = (next_entry_ + 1) % entries_.size();
+}
+
+MessageLineage
+MessageLineageTracker::take(const void * message)
+{
+  MessageLineage lineage;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // From the newest entry, which is the right one if an address was reused
+    for (size_t count = 1; count <= entries_.size(); ++count) {
+      Entry & entry = entries_[(next_entry_ + entries_.size() - count) % entries_.size()];
+      if (entry.message == message) {
+        lineage = entry.lineage;
+        entry = Entry();
+        break;
+      }
+    }
+  }
+  if (!lineage.is_valid()) {
+    untracked_count_.fetch_add(1, std::memory_order_relaxed);
+    return lineage;
+  }
+  const int64_t latency = now_ns() - lineage.origin_timestamp;
+  latency_histogram_.add_sample(static_cast<uint64_t>(std::max<int64_t>(latency, 0)));
+  return lineage;
+}
+
+topic_statistics::AtomicHistogram::Snapshot
+MessageLineageTracker::take_latency_snapshot()
+{
+  return latency_histogram_.take_snapshot();
+}
+
+uint64_t
+MessageLineageTracker::get_untracked_count() const
+{
+  return untracked_count_.load(std::memory_order_relaxed);
+}
+
+namespace detail
+{
+
+const MessageLineage &
+get_published_message_lineage()
+{
+  return g_thread_lineage.published;
+}
+
+PublishedLineageScope::PublishedLineageScope(bool enabled)
+: enabled_(enabled)
+{
+  if (!enabled_) {
+    return;
+  }
+  previous_published_lineage_ = g_thread_lineage.published;
+  g_thread_lineage.published = g_thread_lineage.current.is_valid() ?
+    g_thread_lineage.current : start_message_flow();
+}
+
+PublishedLineageScope::~PublishedLineageScope()
+{
+  if (enabled_) {
+    g_thread_lineage.published = previous_published_lineage_;
+  }
+}
+
+}  // namespace detail
+}  // namespace rclcpp
@@ -0,0 +1,460 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "rclcpp/multi_node_parameters_client.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <exception>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/create_timer.hpp"
+#include "rclcpp/parameter_client.hpp"
+
+using rclcpp::MultiNodeParametersClient;
+using rclcpp::RemoteParametersResult;
+using rclcpp::RemoteParametersStatus;
+
+class MultiNodeParametersClient::State
+{
+public:
+  /// A request to a remote node, queued or waiting for its reply.
+  struct Request
+  {
+    /// Send the request, its reply handler finishes it.
+    std::function<void()> send;
+    /// Complete the finished request without a reply.
+    std::function<void(RemoteParametersStatus)> fail;
+    std::chrono::steady_clock::time_point deadline;
+    bool finished = false;
+  };
+
+  struct RemoteNode
+  {
+    rclcpp::AsyncParametersClient::SharedPtr client;
+    std::deque<std::shared_ptr<Request>> queued;
+    std::list<std::shared_ptr<Request>> in_flight;
+  };
+
+  template<typename ResultT>
+  using ReplyCallback = std::function<void (std::shared_future<ResultT>)>;
+
+  /// Send a request through the client of a remote node, with the given reply callback.
+  template<typename ResultT>
+  using SendFunction =
+    std::function<void (rclcpp::AsyncParametersClient &, ReplyCallback<ResultT>)>;
+
+  State(size_t max_requests_in_flight, std::chrono::nanoseconds timeout)
+  : max_requests_in_flight_(max_requests_in_flight),
+    timeout_(timeout)
+  {}
+
+  /// Send a request to each of the given remote nodes and aggregate their results.
+  template<typename ResultT>
+  static
+  SharedFuture<ResultT>
+  send_requests(
+    const std::shared_ptr<State> & state,
+    const std::vector<std::pair<std::string, SendFunction<ResultT>>> & requests,
+    CallbackType<ResultT> callback);
+
+  /// Queue a request, then send the requests the remote node has room for.
+  void
+  submit(RemoteNode & remote_node, std::shared_ptr<Request> request)
+  {
+    std::vector<std::shared_ptr<Request>> ready_requests;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      remote_node.queued.push_back(std::move(request));
+      pop_ready_requests(remote_node, ready_requests);
+    }
+    send(ready_requests);
+  }
+
+  /// Finish a request and send the next queued one, return false if it was already finished.
+  bool
+  finish(RemoteNode & remote_node, const std::shared_ptr<Request> & request)
+  {
+    std::vector<std::shared_ptr<Request>> ready_requests;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (request->finished) {
+        return false;
+      }
+      request->finished = true;
+      remote_node.in_flight.remove(request);
+      pop_ready_requests(remote_node, ready_requests);
+    }
+    send(ready_requests);
+    return true;
+  }
+
+  /// Complete the requests whose remote node didn't reply in time.
+  void
+  check_timeouts()
+  {
+    const auto now = std::chrono::steady_clock::now();
+    std::vector<std::pair<RemoteNode *, std::shared_ptr<Request>>> expired_requests;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (auto & name_and_remote_node : remote_nodes) {
+        for (const auto & request : name_and_remote_node.second.in_flight) {
+          if (request->deadline <= now) {
+            expired_requests.emplace_back(&name_and_remote_node.second, request);
+          }
+        }
+      }
+    }
+    if (expired_requests.empty()) {
+      return;
+    }
+    for (auto & [remote_node, request] : expired_requests) {
+      if (finish(*remote_node, request)) {
+        request->fail(RemoteParametersStatus::Timeout);
+      }
+    }
+    // The late replies would be ignored, don't keep waiting for them
+    const auto time_point = std::chrono::system_clock::now() -
+      std::chrono::duration_cast<std::chrono::system_clock::duration>(timeout_);
+    for (auto & expired_request : expired_requests) {
+      expired_request.first->client->prune_requests_older_than(time_point);
+    }
+  }
+
+  size_t
+  get_requests_in_flight() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t count = 0;
+    for (const auto & name_and_remote_node : remote_nodes) {
+      count += name_and_remote_node.second.in_flight.size();
+    }
+    return count;
+  }
+
+  /// The remote nodes, by name, not modified after the construction of the client.
+  std::map<std::string, RemoteNode> remote_nodes;
+
+private:
+  /// Results of the requests sent to several nodes at once.
+  template<typename ResultT>
+  struct Aggregate
+  {
+    void
+    set_result(const std::string & node_name, RemoteParametersResult<ResultT> result)
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        results[node_name] = std::move(result);
+        if (--remaining > 0) {
+          return;
+        }
+      }
+      promise.set_value(std::move(results));
+      if (callback) {
+        callback(future);
+      }
+    }
+
+    std::mutex mutex;
+    Results<ResultT> results;
+    size_t remaining = 0;
+    std::promise<Results<ResultT>> promise;
+    SharedFuture<ResultT> future;
+    CallbackType<ResultT> callback;
+  };
+
+  void
+  pop_ready_requests(RemoteNode & remote_node, std::vector<std::shared_ptr<Request>> & ready)
+  {
+    while (!remote_node.queued.empty() && remote_node.in_flight.size() < max_requests_in_flight_) {
+      std::shared_ptr<Request> request = std::move(remote_node.queued.front());
+      remote_node.queued.pop_front();
+      request->deadline = std::chrono::steady_clock::now() +
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout_);
+      remote_node.in_flight.push_back(request);
+      ready.push_back(std::move(request));
+    }
+  }
+
+  static
+  void
+  send(const std::vector<std::shared_ptr<Request>> & requests)
+  {
+    for (const auto & request : requests) {
+      request->send();
+    }
+  }
+
+  const size_t max_requests_in_flight_;
+  const std::chrono::nanoseconds timeout_;
+  mutable std::mutex mutex_;
+};
+
+template<typename ResultT>
+MultiNodeParametersClient::SharedFuture<ResultT>
+MultiNodeParametersClient::State::send_requests(
+  const std::shared_ptr<State> & state,
+  const std::vector<std::pair<std::string, SendFunction<ResultT>>> & requests,
+  CallbackType<ResultT> callback)
+{
+  auto aggregate = std::make_shared<Aggregate<ResultT>>();
+  aggregate->remaining = requests.size();
+  aggregate->future = aggregate->promise.get_future().share();
+  aggregate->callback = std::move(callback);
+  if (requests.empty()) {
+    aggregate->promise.set_value({});
+    if (aggregate->callback) {
+      aggregate->callback(aggregate->future);
+    }
+    return aggregate->future;
+  }
+
+  std::weak_ptr<State> weak_state = state;
+  for (const auto & [name, send_function] : requests) {
+    RemoteNode & remote_node = state->remote_nodes.at(name);
+    auto request = std::make_shared<Request>();
+    std::weak_ptr<Request> weak_request = request;
+    request->fail =
+      [aggregate, name = name](RemoteParametersStatus status)
+      {
+        RemoteParametersResult<ResultT> result;
+        result.status = status;
+        aggregate->set_result(name, std::move(result));
+      };
+    request->send =
+      [weak_state, weak_request, &remote_node, aggregate, name = name,
+        send_function = send_function]()
+      {
+        // Finish the request unless it timed out meanwhile
+        auto finish = [weak_state, weak_request, &remote_node]() {
+            auto state = weak_state.lock();
+            auto request = weak_request.lock();
+            return state && request && state->finish(remote_node, request);
+          };
+        try {
+          send_function(
+            *remote_node.client,
+            [finish, aggregate, name](std::shared_future<ResultT> future) {
+              if (!finish()) {
+                return;
+              }
+              RemoteParametersResult<ResultT> result;
+              try {
+                result.result = future.get();
+                result.status = RemoteParametersStatus::Success;
+              } catch (const std::exception &) {
+                result.status = RemoteParametersStatus::Failure;
+              }
+              aggregate->set_result(name, std::move(result));
+            });
+        } catch (const std::exception &) {
+          if (finish()) {
+            RemoteParametersResult<ResultT> result;
+            result.status = RemoteParametersStatus::Failure;
+            aggregate->set_result(name, std::move(result));
+          }
+        }
+      };
+    state->submit(remote_node, std::move(request));
+  }
+  return aggregate->future;
+}
+
+MultiNodeParametersClient::MultiNodeParametersClient(
+  const rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_base_interface,
+  const rclcpp::node_interfaces::NodeTopicsInterface::SharedPtr node_topics_interface,
+  const rclcpp::node_interfaces::NodeGraphInterface::SharedPtr node_graph_interface,
+  const rclcpp::node_interfaces::NodeServicesInterface::SharedPtr node_services_interface,
+  const rclcpp::node_interfaces::NodeTimersInterface::SharedPtr node_timers_interface,
+  const std::vector<std::string> & remote_node_names,
+  const MultiNodeParametersClientOptions & options)
+{
+  if (options.max_requests_in_flight == 0) {
+    throw std::invalid_argument("max_requests_in_flight must be positive");
+  }
+  if (options.timeout <= std::chrono::nanoseconds::zero()) {
+    throw std::invalid_argument("timeout must be positive");
+  }
+
+  state_ = std::make_shared<State>(options.max_requests_in_flight, options.timeout);
+  for (const std::string & remote_node_name : remote_node_names) {
+    if (remote_node_name.empty()) {
+      throw std::invalid_argument("remote node name must not be empty");
+    }
+    State::RemoteNode & remote_node = state_->remote_nodes[remote_node_name];
+    if (!remote_node.client) {
+      remote_node.client = std::make_shared<rclcpp::AsyncParametersClient>(
+        node_base_interface,
+        node_topics_interface,
+        node_graph_interface,
+        node_services_interface,
+        remote_node_name,
+        options.qos_profile,
+        options.group);
+    }
+  }
+
+  // Checking several times per timeout bounds how late the timeouts are detected
+  const auto period = std::max<std::chrono::nanoseconds>(
+    options.timeout / 10, std::chrono::milliseconds(1));
+  std::weak_ptr<State> weak_state = state_;
+  timeout_timer_ = rclcpp::create_wall_timer(
+    period,
+    [weak_state]() {
+      auto state = weak_state.lock();
+      if (state) {
+        state->check_timeouts();
+      }
+    },
+    options.group,
+    node_base_interface.get(),
+    node_timers_interface.get());
+}
+
+MultiNodeParametersClient::~MultiNodeParametersClient()
+{
+  timeout_timer_->cancel();
+}
+
+std::vector<std::string>
+MultiNodeParametersClient::get_remote_node_names() const
+{
+  std::vector<std::string> names;
+  names.reserve(state_->remote_nodes.size());
+  for (const auto & name_and_remote_node : state_->remote_nodes) {
+    names.push_back(name_and_remote_node.first);
+  }
+  return names;
+}
+
+size_t
+MultiNodeParametersClient::get_requests_in_flight() const
+{
+  return state_->get_requests_in_flight();
+}
+
+MultiNodeParametersClient::SharedFuture<std::vector<rclcpp::Parameter>>
+MultiNodeParametersClient::get_parameters(
+  const std::vector<std::string> & names,
+  CallbackType<std::vector<rclcpp::Parameter>> callback)
+{
+  using ResultT = std::vector<rclcpp::Parameter>;
+  std::vector<std::pair<std::string, State::SendFunction<ResultT>>> requests;
+  for (const auto & name_and_remote_node : state_->remote_nodes) {
+    requests.emplace_back(
+      name_and_remote_node.first,
+      [names](rclcpp::AsyncParametersClient & client, State::ReplyCallback<ResultT> on_reply) {
+        client.get_parameters(names, std::move(on_reply));
+      });
+  }
+  return State::send_requests<ResultT>(state_, requests, std::move(callback));
+}
+
+MultiNodeParametersClient::SharedFuture<std::vector<rcl_interfaces::msg::ParameterDescriptor>>
+MultiNodeParametersClient::describe_parameters(
+  const std::vector<std::string> & names,
+  CallbackType<std::vector<rcl_interfaces::msg::ParameterDescriptor>> callback)
+{
+  using ResultT = std::vector<rcl_interfaces::msg::ParameterDescriptor>;
+  std::vector<std::pair<std::string, State::SendFunction<ResultT>>> requests;
+  for (const auto & name_and_remote_node : state_->remote_nodes) {
+    requests.emplace_back(
+      name_and_remote_node.first,
+      [names](rclcpp::AsyncParametersClient & client, State::ReplyCallback<ResultT> on_reply) {
+        client.describe_parameters(names, std::move(on_reply));
+      });
+  }
+  return State::send_requests<ResultT>(state_, requests, std::move(callback));
+}
+
+MultiNodeParametersClient::SharedFuture<std::vector<rcl_interfaces::msg::SetParametersResult>>
+MultiNodeParametersClient::set_parameters(
+  const std::vector<rclcpp::Parameter> & parameters,
+  CallbackType<std::vector<rcl_interfaces::msg::SetParametersResult>> callback)
+{
+  std::map<std::string, std::vector<rclcpp::Parameter>> parameters_by_node;
+  for (const auto & name_and_remote_node : state_->remote_nodes) {
+    parameters_by_node.emplace(name_and_remote_node.first, parameters);
+  }
+  return set_parameters(parameters_by_node, std::move(callback));
+}
+
+MultiNodeParametersClient::SharedFuture<std::vector<rcl_interfaces::msg::SetParametersResult>>
+MultiNodeParametersClient::set_parameters(
+  const std::map<std::string, std::vector<rclcpp::Parameter>> & parameters,
+  CallbackType<std::vector<rcl_interfaces::msg::SetParametersResult>> callback)
+{
+  using ResultT = std::vector<rcl_interfaces::msg::SetParametersResult>;
+  std::vector<std::pair<std::string, State::SendFunction<ResultT>>> requests;
+  for (const auto & [node_name, node_parameters] : parameters) {
+    if (state_->remote_nodes.count(node_name) == 0) {
+      throw std::invalid_argument("'" + node_name + "' is not a remote node of the client");
+    }
+    requests.emplace_back(
+      node_name,
+      [node_parameters = node_parameters](
+        rclcpp::AsyncParametersClient & client, State::ReplyCallback<ResultT> on_reply) {
+        client.set_parameters(node_parameters, std::move(on_reply));
+      });
+  }
+  return State::send_requests<ResultT>(state_, requests, std::move(callback));
+}
+
+MultiNodeParametersClient::SharedFuture<rcl_interfaces::msg::ListParametersResult>
+MultiNodeParametersClient::list_parameters(
+  const std::vector<std::string> & prefixes,
+  uint64_t depth,
+  CallbackType<rcl_interfaces::msg::ListParametersResult> callback)
+{
+  using ResultT = rcl_interfaces::msg::ListParametersResult;
+  std::vector<std::pair<std::string, State::SendFunction<ResultT>>> requests;
+  for (const auto & name_and_remote_node : state_->remote_nodes) {
+    requests.emplace_back(
+      name_and_remote_node.first,
+      [prefixes, depth](
+        rclcpp::AsyncParametersClient & client, State::ReplyCallback<ResultT> on_reply) {
+        client.list_parameters(prefixes, depth, std::move(on_reply));
+      });
+  }
+  return State::send_requests<ResultT>(state_, requests, std::move(callback));
+}
+
+bool
+MultiNodeParametersClient::wait_for_services_nanoseconds(std::chrono::nanoseconds timeout)
+{
+  for (const auto & name_and_remote_node : state_->remote_nodes) {
+    auto stamp = std::chrono::steady_clock::now();
+    if (!name_and_remote_node.second.client->wait_for_service(timeout)) {
+      return false;
+    }
+    if (timeout > std::chrono::nanoseconds::zero()) {
+      timeout -= std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - stamp);
+      if (timeout < std::chrono::nanoseconds::zero()) {
+        timeout = std::chrono::nanoseconds::zero();
+      }
+    }
+  }
+  return true;
+}
@@ -14,6 +14,7 @@
 
 #include <algorithm>
 #include <array>
+#include <functional>
 #include <limits>
 #include <map>
 #include <memory>
@@ -23,6 +24,8 @@
 
 #include "rcl/arguments.h"
 
+#include "rclcpp/create_generic_client.hpp"
+#include "rclcpp/detail/entity_creation_worker.hpp"
 #include "rclcpp/detail/qos_parameters.hpp"
 #include "rclcpp/exceptions.hpp"
 #include "rclcpp/graph_listener.hpp"
@@ -123,18 +126,19 @@ get_parameter_events_qos(
   const rclcpp::NodeOptions & options)
 {
   auto final_qos = options.parameter_event_qos();
-  const rcl_arguments_t * global_args = nullptr;
+  std::shared_ptr<rclcpp::detail::GlobalParameterOverrides> global_overrides;
   auto * rcl_options = options.get_rcl_node_options();
   if (rcl_options->use_global_arguments) {
-    auto context_ptr = node_base.get_context()->get_rcl_context();
-    global_args = &(context_ptr->global_arguments);
+    auto context = node_base.get_context();
+    global_overrides = context->get_sub_context<rclcpp::detail::GlobalParameterOverrides>(
+      context->get_rcl_context());
   }
 
   auto parameter_overrides = rclcpp::detail::resolve_parameter_overrides(
     node_base.get_fully_qualified_name(),
     options.parameter_overrides(),
     &rcl_options->arguments,
-    global_args);
+    global_overrides ? global_overrides->get_params() : nullptr);
 
   auto final_topic_name = node_base.resolve_topic_or_service_name("/parameter_events", false);
   auto prefix = "qos_overrides." + final_topic_name + ".";
@@ -165,9 +169,13 @@ Node::Node(
       options.context(),
       *(options.get_rcl_node_options()),
       options.use_intra_process_comms(),
-      options.enable_topic_statistics())),
-  node_graph_(new rclcpp::node_interfaces::NodeGraph(node_base_.get())),
-  node_logging_(new rclcpp::node_interfaces::NodeLogging(node_base_.get())),
+      options.enable_topic_statistics(),
+      nullptr,
+      options.entity_handoff())),
+  node_graph_(new rclcpp::node_interfaces::NodeGraph(
+      node_base_.get(), options.use_graph_cache())),
+  node_logging_(new rclcpp::node_interfaces::NodeLogging(
+      node_base_.get(), options.use_shared_publishers() && options.enable_rosout())),
   node_timers_(new rclcpp::node_interfaces::NodeTimers(node_base_.get())),
   node_topics_(new rclcpp::node_interfaces::NodeTopics(node_base_.get(), node_timers_.get())),
   node_services_(new rclcpp::node_interfaces::NodeServices(node_base_.get())),
@@ -193,7 +201,9 @@ Node::Node(
       get_parameter_events_qos(*node_base_, options),
       options.parameter_event_publisher_options(),
       options.allow_undeclared_parameters(),
-      options.automatically_declare_parameters_from_overrides()
+      options.automatically_declare_parameters_from_overrides(),
+      options.use_shared_publishers(),
+      options.parameter_state()
     )),
   node_time_source_(new rclcpp::node_interfaces::NodeTimeSource(
       node_base_,
@@ -204,7 +214,9 @@ Node::Node(
       node_clock_,
       node_parameters_,
       options.clock_qos(),
-      options.use_clock_thread()
+      options.use_clock_thread(),
+      options.clock_thread_attributes(),
+      !options.lightweight()
     )),
   node_waitables_(new rclcpp::node_interfaces::NodeWaitables(node_base_.get())),
   node_options_(options),
@@ -297,6 +309,12 @@ Node::get_fully_qualified_name() const
   return node_base_->get_fully_qualified_name();
 }
 
+std::vector<rclcpp::MemoryUsage>
+Node::get_memory_usage() const
+{
+  return rclcpp::MemoryAccounting::get_usage(node_base_->get_fully_qualified_name());
+}
+
 rclcpp::Logger
 Node::get_logger() const
 {
@@ -311,6 +329,23 @@ Node::create_callback_group(
   return node_base_->create_callback_group(group_type, automatically_add_to_executor_with_node);
 }
 
+rclcpp::GenericClient::SharedPtr
+Node::create_generic_client(
+  const std::string & service_name,
+  const std::string & service_type,
+  const rclcpp::QoS & qos,
+  rclcpp::CallbackGroup::SharedPtr group)
+{
+  return rclcpp::create_generic_client(
+    node_base_,
+    node_graph_,
+    node_services_,
+    extend_name_with_sub_namespace(service_name, this->get_sub_namespace()),
+    service_type,
+    qos,
+    group);
+}
+
 const rclcpp::ParameterValue &
 Node::declare_parameter(
   const std::string & name,
@@ -630,3 +665,10 @@ Node::get_node_options() const
 {
   return this->node_options_;
 }
+
+void
+Node::post_entity_creation(std::function<void()> creation)
+{
+  node_base_->get_context()->get_sub_context<rclcpp::detail::EntityCreationWorker>()->post(
+    std::move(creation));
+}
@@ -20,11 +20,14 @@
 #include "rclcpp/node_interfaces/node_base.hpp"
 
 #include "rcl/arguments.h"
+#include "rclcpp/entity_handoff.hpp"
 #include "rclcpp/exceptions.hpp"
 #include "rcutils/logging_macros.h"
 #include "rmw/validate_namespace.h"
 #include "rmw/validate_node_name.h"
 
+#include "../detail/node_startup_profile.hpp"
+#include "../detail/resolved_name_cache.hpp"
 #include "../logging_mutex.hpp"
 
 using rclcpp::exceptions::throw_from_rcl_error;
@@ -38,7 +41,8 @@ NodeBase::NodeBase(
   const rcl_node_options_t & rcl_node_options,
   bool use_intra_process_default,
   bool enable_topic_statistics_default,
-  rclcpp::CallbackGroup::SharedPtr default_callback_group)
+  rclcpp::CallbackGroup::SharedPtr default_callback_group,
+  std::shared_ptr<rclcpp::EntityHandoff> entity_handoff)
 : context_(context),
   use_intra_process_default_(use_intra_process_default),
   enable_topic_statistics_default_(enable_topic_statistics_default),
@@ -46,88 +50,96 @@ NodeBase::NodeBase(
   default_callback_group_(default_callback_group),
   associated_with_executor_(false),
   notify_guard_condition_(context),
-  notify_guard_condition_is_valid_(false)
+  notify_guard_condition_is_valid_(false),
+  resolved_names_(std::make_shared<rclcpp::detail::ResolvedNameCache>())
 {
-  // Create the rcl node and store it in a shared_ptr with a custom destructor.
-  std::unique_ptr<rcl_node_t> rcl_node(new rcl_node_t(rcl_get_zero_initialized_node()));
+  rclcpp::detail::NodeStartupPhaseTimer startup_timer(&rclcpp::NodeStartupProfile::node_base);
+  // The rcl node of the previous instance of the node is used, if it is handed over
+  if (entity_handoff) {
+    node_handle_ = entity_handoff->take_node(context_, node_name, namespace_, rcl_node_options);
+  }
+  if (!node_handle_) {
+    // Create the rcl node and store it in a shared_ptr with a custom destructor.
+    std::unique_ptr<rcl_node_t> rcl_node(new rcl_node_t(rcl_get_zero_initialized_node()));
 
-  std::shared_ptr<std::recursive_mutex> logging_mutex = get_global_logging_mutex();
+    std::shared_ptr<std::recursive_mutex> logging_mutex = get_global_logging_mutex();
 
-  rcl_ret_t ret;
-  {
-    std::lock_guard<std::recursive_mutex> guard(*logging_mutex);
-    // TODO(ivanpauno): /rosout Qos should be reconfigurable.
-    // TODO(ivanpauno): Instead of mutually excluding rcl_node_init with the global logger mutex,
-    // rcl_logging_rosout_init_publisher_for_node could be decoupled from there and be called
-    // here directly.
-    ret = rcl_node_init(
-      rcl_node.get(),
-      node_name.c_str(), namespace_.c_str(),
-      context_->get_rcl_context().get(), &rcl_node_options);
-  }
-  if (ret != RCL_RET_OK) {
-    if (ret == RCL_RET_NODE_INVALID_NAME) {
-      rcl_reset_error();  // discard rcl_node_init error
-      int validation_result;
-      size_t invalid_index;
-      rmw_ret_t rmw_ret =
-        rmw_validate_node_name(node_name.c_str(), &validation_result, &invalid_index);
-      if (rmw_ret != RMW_RET_OK) {
-        if (rmw_ret == RMW_RET_INVALID_ARGUMENT) {
-          throw_from_rcl_error(RCL_RET_INVALID_ARGUMENT, "failed to validate node name");
+    rcl_ret_t ret;
+    {
+      std::lock_guard<std::recursive_mutex> guard(*logging_mutex);
+      // TODO(ivanpauno): /rosout Qos should be reconfigurable.
+      // TODO(ivanpauno): Instead of mutually excluding rcl_node_init with the global logger mutex,
+      // rcl_logging_rosout_init_publisher_for_node could be decoupled from there and be called
+      // here directly.
+      ret = rcl_node_init(
+        rcl_node.get(),
+        node_name.c_str(), namespace_.c_str(),
+        context_->get_rcl_context().get(), &rcl_node_options);
+    }
+    if (ret != RCL_RET_OK) {
+      if (ret == RCL_RET_NODE_INVALID_NAME) {
+        rcl_reset_error();  // discard rcl_node_init error
+        int validation_result;
+        size_t invalid_index;
+        rmw_ret_t rmw_ret =
+          rmw_validate_node_name(node_name.c_str(), &validation_result, &invalid_index);
+        if (rmw_ret != RMW_RET_OK) {
+          if (rmw_ret == RMW_RET_INVALID_ARGUMENT) {
+            throw_from_rcl_error(RCL_RET_INVALID_ARGUMENT, "failed to validate node name");
+          }
+          throw_from_rcl_error(RCL_RET_ERROR, "failed to validate node name");
         }
-        throw_from_rcl_error(RCL_RET_ERROR, "failed to validate node name");
-      }
 
-      if (validation_result != RMW_NODE_NAME_VALID) {
-        throw rclcpp::exceptions::InvalidNodeNameError(
-                node_name.c_str(),
-                rmw_node_name_validation_result_string(validation_result),
-                invalid_index);
-      } else {
-        throw std::runtime_error("valid rmw node name but invalid rcl node name");
+        if (validation_result != RMW_NODE_NAME_VALID) {
+          throw rclcpp::exceptions::InvalidNodeNameError(
+                  node_name.c_str(),
+                  rmw_node_name_validation_result_string(validation_result),
+                  invalid_index);
+        } else {
+          throw std::runtime_error("valid rmw node name but invalid rcl node name");
+        }
       }
-    }
 
-    if (ret == RCL_RET_NODE_INVALID_NAMESPACE) {
-      rcl_reset_error();  // discard rcl_node_init error
-      int validation_result;
-      size_t invalid_index;
-      rmw_ret_t rmw_ret =
-        rmw_validate_namespace(namespace_.c_str(), &validation_result, &invalid_index);
-      if (rmw_ret != RMW_RET_OK) {
-        if (rmw_ret == RMW_RET_INVALID_ARGUMENT) {
-          throw_from_rcl_error(RCL_RET_INVALID_ARGUMENT, "failed to validate namespace");
+      if (ret == RCL_RET_NODE_INVALID_NAMESPACE) {
+        rcl_reset_error();  // discard rcl_node_init error
+        int validation_result;
+        size_t invalid_index;
+        rmw_ret_t rmw_ret =
+          rmw_validate_namespace(namespace_.c_str(), &validation_result, &invalid_index);
+        if (rmw_ret != RMW_RET_OK) {
+          if (rmw_ret == RMW_RET_INVALID_ARGUMENT) {
+            throw_from_rcl_error(RCL_RET_INVALID_ARGUMENT, "failed to validate namespace");
+          }
+          throw_from_rcl_error(RCL_RET_ERROR, "failed to validate namespace");
         }
-        throw_from_rcl_error(RCL_RET_ERROR, "failed to validate namespace");
-      }
 
-      if (validation_result != RMW_NAMESPACE_VALID) {
-        throw rclcpp::exceptions::InvalidNamespaceError(
-                namespace_.c_str(),
-                rmw_namespace_validation_result_string(validation_result),
-                invalid_index);
-      } else {
-        throw std::runtime_error("valid rmw node namespace but invalid rcl node namespace");
+        if (validation_result != RMW_NAMESPACE_VALID) {
+          throw rclcpp::exceptions::InvalidNamespaceError(
+                  namespace_.c_str(),
+                  rmw_namespace_validation_result_string(validation_result),
+                  invalid_index);
+        } else {
+          throw std::runtime_error("valid rmw node namespace but invalid rcl node namespace");
+        }
       }
+      throw_from_rcl_error(ret, "failed to initialize rcl node");
     }
-    throw_from_rcl_error(ret, "failed to initialize rcl node");
-  }
 
-  node_handle_.reset(
-    rcl_node.release(),
-    [logging_mutex](rcl_node_t * node) -> void {
-      std::lock_guard<std::recursive_mutex> guard(*logging_mutex);
-      // TODO(ivanpauno): Instead of mutually excluding rcl_node_fini with the global logger mutex,
-      // rcl_logging_rosout_fini_publisher_for_node could be decoupled from there and be called
-      // here directly.
-      if (rcl_node_fini(node) != RCL_RET_OK) {
-        RCUTILS_LOG_ERROR_NAMED(
-          "rclcpp",
-          "Error in destruction of rcl node handle: %s", rcl_get_error_string().str);
-      }
-      delete node;
-    });
+    node_handle_.reset(
+      rcl_node.release(),
+      [logging_mutex](rcl_node_t * node) -> void {
+        std::lock_guard<std::recursive_mutex> guard(*logging_mutex);
+        // TODO(ivanpauno): Instead of mutually excluding rcl_node_fini with the global logger
+        // mutex, rcl_logging_rosout_fini_publisher_for_node could be decoupled from there and be
+        // called here directly.
+        if (rcl_node_fini(node) != RCL_RET_OK) {
+          RCUTILS_LOG_ERROR_NAMED(
+            "rclcpp",
+            "Error in destruction of rcl node handle: %s", rcl_get_error_string().str);
+        }
+        delete node;
+      });
+  }
 
   // Create the default callback group, if needed.
   if (nullptr == default_callback_group_) {
@@ -272,19 +284,24 @@ std::string
 NodeBase::resolve_topic_or_service_name(
   const std::string & name, bool is_service, bool only_expand) const
 {
-  char * output_cstr = NULL;
-  auto allocator = rcl_get_default_allocator();
-  rcl_ret_t ret = rcl_node_resolve_name(
-    node_handle_.get(),
-    name.c_str(),
-    allocator,
-    is_service,
-    only_expand,
-    &output_cstr);
-  if (RCL_RET_OK != ret) {
-    throw_from_rcl_error(ret, "failed to resolve name", rcl_get_error_state());
-  }
-  std::string output{output_cstr};
-  allocator.deallocate(output_cstr, allocator.state);
-  return output;
+  // The remap rules of the node don't change, the resolved names are cached
+  return resolved_names_->get(
+    name, is_service, only_expand,
+    [this, &name, is_service, only_expand]() {
+      char * output_cstr = NULL;
+      auto allocator = rcl_get_default_allocator();
+      rcl_ret_t ret = rcl_node_resolve_name(
+        node_handle_.get(),
+        name.c_str(),
+        allocator,
+        is_service,
+        only_expand,
+        &output_cstr);
+      if (RCL_RET_OK != ret) {
+        throw_from_rcl_error(ret, "failed to resolve name", rcl_get_error_state());
+      }
+      std::string output{output_cstr};
+      allocator.deallocate(output_cstr, allocator.state);
+      return output;
+    });
 }
@@ -15,6 +15,7 @@
 #include "rclcpp/node_interfaces/node_graph.hpp"
 
 #include <algorithm>
+#include <cstdint>
 #include <map>
 #include <string>
 #include <tuple>
@@ -30,18 +31,33 @@
 #include "rclcpp/node_interfaces/node_graph_interface.hpp"
 #include "rcpputils/scope_exit.hpp"
 
+#include "../detail/graph_cache.hpp"
+#include "../detail/node_startup_profile.hpp"
+#include "../detail/resolved_name_cache.hpp"
+
 using rclcpp::node_interfaces::NodeGraph;
 using rclcpp::exceptions::throw_from_rcl_error;
 using rclcpp::graph_listener::GraphListener;
+using rclcpp::detail::GraphCache;
 
-NodeGraph::NodeGraph(rclcpp::node_interfaces::NodeBaseInterface * node_base)
+NodeGraph::NodeGraph(
+  rclcpp::node_interfaces::NodeBaseInterface * node_base,
+  bool use_graph_cache)
 : node_base_(node_base),
   graph_listener_(
     node_base->get_context()->get_sub_context<GraphListener>(node_base->get_context())
   ),
   should_add_to_graph_listener_(true),
-  graph_users_count_(0)
-{}
+  graph_cache_watched_(false),
+  graph_users_count_(0),
+  filtered_graph_users_count_(0),
+  expanded_names_(std::make_shared<rclcpp::detail::ResolvedNameCache>())
+{
+  rclcpp::detail::NodeStartupPhaseTimer startup_timer(&rclcpp::NodeStartupProfile::graph);
+  if (use_graph_cache) {
+    graph_cache_ = node_base->get_context()->get_sub_context<GraphCache>();
+  }
+}
 
 NodeGraph::~NodeGraph()
 {
@@ -54,14 +70,69 @@ NodeGraph::~NodeGraph()
   }
 }
 
+bool
+NodeGraph::get_graph_generation(uint64_t & generation) const
+{
+  if (!graph_cache_ || graph_listener_->is_shutdown()) {
+    return false;
+  }
+  if (!graph_cache_watched_.exchange(true)) {
+    // The graph listener waits on the graph guard condition of the node from now on,
+    // a graph change since the last wait is still seen by the next wait
+    try {
+      if (should_add_to_graph_listener_.exchange(false)) {
+        graph_listener_->add_node(const_cast<NodeGraph *>(this));
+      } else {
+        // Interrupt the wait of the graph listener, which then waits on the node as well
+        graph_listener_->has_node(const_cast<NodeGraph *>(this));
+      }
+      graph_listener_->start_if_not_started();
+    } catch (const rclcpp::graph_listener::GraphListenerShutdownError &) {
+      return false;
+    }
+  }
+  generation = graph_listener_->get_graph_change_count();
+  // Once shutdown, the graph listener doesn't count the graph changes anymore
+  return !graph_listener_->is_shutdown();
+}
+
+template<typename T, typename QueryT>
+T
+NodeGraph::query_graph(const std::string & key, QueryT && query) const
+{
+  uint64_t generation = 0;
+  if (!get_graph_generation(generation)) {
+    return query();
+  }
+  return graph_cache_->get<T>(key, generation, std::forward<QueryT>(query));
+}
+
+std::string
+NodeGraph::expand_name(const std::string & name, bool is_service) const
+{
+  return expanded_names_->get(
+    name, is_service, true,
+    [this, &name, is_service]() {
+      auto rcl_node_handle = node_base_->get_rcl_node_handle();
+      return rclcpp::expand_topic_or_service_name(
+        name,
+        rcl_node_get_name(rcl_node_handle),
+        rcl_node_get_namespace(rcl_node_handle),
+        is_service);
+    });
+}
+
+static
 std::map<std::string, std::vector<std::string>>
-NodeGraph::get_topic_names_and_types(bool no_demangle) const
+query_topic_names_and_types(
+  const rcl_node_t * node_handle,
+  bool no_demangle)
 {
   rcl_names_and_types_t topic_names_and_types = rcl_get_zero_initialized_names_and_types();
 
   rcl_allocator_t allocator = rcl_get_default_allocator();
   auto ret = rcl_get_topic_names_and_types(
-    node_base_->get_rcl_node_handle(),
+    node_handle,
     &allocator,
     no_demangle,
     &topic_names_and_types);
@@ -97,13 +168,24 @@ NodeGraph::get_topic_names_and_types(bool no_demangle) const
 }
 
 std::map<std::string, std::vector<std::string>>
-NodeGraph::get_service_names_and_types() const
+NodeGraph::get_topic_names_and_types(bool no_demangle) const
+{
+  return query_graph<std::map<std::string, std::vector<std::string>>>(
+    no_demangle ? "topic_names_and_types/no_demangle" : "topic_names_and_types",
+    [this, no_demangle]() {
+      return query_topic_names_and_types(node_base_->get_rcl_node_handle(), no_demangle);
+    });
+}
+
+static
+std::map<std::string, std::vector<std::string>>
+query_service_names_and_types(const rcl_node_t * node_handle)
 {
   rcl_names_and_types_t service_names_and_types = rcl_get_zero_initialized_names_and_types();
 
   rcl_allocator_t allocator = rcl_get_default_allocator();
   auto ret = rcl_get_service_names_and_types(
-    node_base_->get_rcl_node_handle(),
+    node_handle,
     &allocator,
     &service_names_and_types);
   if (ret != RCL_RET_OK) {
@@ -139,14 +221,26 @@ NodeGraph::get_service_names_and_types() const
 }
 
 std::map<std::string, std::vector<std::string>>
-NodeGraph::get_service_names_and_types_by_node(
+NodeGraph::get_service_names_and_types() const
+{
+  return query_graph<std::map<std::string, std::vector<std::string>>>(
+    "service_names_and_types",
+    [this]() {
+      return query_service_names_and_types(node_base_->get_rcl_node_handle());
+    });
+}
+
+static
+std::map<std::string, std::vector<std::string>>
+query_service_names_and_types_by_node(
+  const rcl_node_t * node_handle,
   const std::string & node_name,
-  const std::string & namespace_) const
+  const std::string & namespace_)
 {
   rcl_names_and_types_t service_names_and_types = rcl_get_zero_initialized_names_and_types();
   rcl_allocator_t allocator = rcl_get_default_allocator();
   rcl_ret_t ret = rcl_get_service_names_and_types_by_node(
-    node_base_->get_rcl_node_handle(),
+    node_handle,
     &allocator,
     node_name.c_str(),
     namespace_.c_str(),
@@ -181,9 +275,24 @@ NodeGraph::get_service_names_and_types_by_node(
 }
 
 std::map<std::string, std::vector<std::string>>
-NodeGraph::get_client_names_and_types_by_node(
+NodeGraph::get_service_names_and_types_by_node(
   const std::string & node_name,
   const std::string & namespace_) const
+{
+  return query_graph<std::map<std::string, std::vector<std::string>>>(
+    "service_names_and_types_by_node" + namespace_ + "/" + node_name,
+    [this, &node_name, &namespace_]() {
+      return query_service_names_and_types_by_node(
+        node_base_->get_rcl_node_handle(), node_name, namespace_);
+    });
+}
+
+static
+std::map<std::string, std::vector<std::string>>
+query_client_names_and_types_by_node(
+  const rcl_node_t * node_handle,
+  const std::string & node_name,
+  const std::string & namespace_)
 {
   rcl_names_and_types_t service_names_and_types = rcl_get_zero_initialized_names_and_types();
   auto service_names_and_types_finalizer = rcpputils::make_scope_exit(
@@ -195,7 +304,7 @@ NodeGraph::get_client_names_and_types_by_node(
     });
   rcl_allocator_t allocator = rcl_get_default_allocator();
   rcl_ret_t ret = rcl_get_client_names_and_types_by_node(
-    node_base_->get_rcl_node_handle(),
+    node_handle,
     &allocator,
     node_name.c_str(),
     namespace_.c_str(),
@@ -216,10 +325,25 @@ NodeGraph::get_client_names_and_types_by_node(
 }
 
 std::map<std::string, std::vector<std::string>>
-NodeGraph::get_publisher_names_and_types_by_node(
+NodeGraph::get_client_names_and_types_by_node(
+  const std::string & node_name,
+  const std::string & namespace_) const
+{
+  return query_graph<std::map<std::string, std::vector<std::string>>>(
+    "client_names_and_types_by_node" + namespace_ + "/" + node_name,
+    [this, &node_name, &namespace_]() {
+      return query_client_names_and_types_by_node(
+        node_base_->get_rcl_node_handle(), node_name, namespace_);
+    });
+}
+
+static
+std::map<std::string, std::vector<std::string>>
+query_publisher_names_and_types_by_node(
+  const rcl_node_t * node_handle,
   const std::string & node_name,
   const std::string & namespace_,
-  bool no_demangle) const
+  bool no_demangle)
 {
   rcl_names_and_types_t topic_names_and_types = rcl_get_zero_initialized_names_and_types();
   auto topic_names_and_types_finalizer = rcpputils::make_scope_exit(
@@ -231,7 +355,7 @@ NodeGraph::get_publisher_names_and_types_by_node(
     });
   rcl_allocator_t allocator = rcl_get_default_allocator();
   rcl_ret_t ret = rcl_get_publisher_names_and_types_by_node(
-    node_base_->get_rcl_node_handle(),
+    node_handle,
     &allocator,
     no_demangle,
     node_name.c_str(),
@@ -253,10 +377,27 @@ NodeGraph::get_publisher_names_and_types_by_node(
 }
 
 std::map<std::string, std::vector<std::string>>
-NodeGraph::get_subscriber_names_and_types_by_node(
+NodeGraph::get_publisher_names_and_types_by_node(
   const std::string & node_name,
   const std::string & namespace_,
   bool no_demangle) const
+{
+  return query_graph<std::map<std::string, std::vector<std::string>>>(
+    "publisher_names_and_types_by_node" + namespace_ + "/" + node_name +
+    (no_demangle ? "/no_demangle" : ""),
+    [this, &node_name, &namespace_, no_demangle]() {
+      return query_publisher_names_and_types_by_node(
+        node_base_->get_rcl_node_handle(), node_name, namespace_, no_demangle);
+    });
+}
+
+static
+std::map<std::string, std::vector<std::string>>
+query_subscriber_names_and_types_by_node(
+  const rcl_node_t * node_handle,
+  const std::string & node_name,
+  const std::string & namespace_,
+  bool no_demangle)
 {
   rcl_names_and_types_t topic_names_and_types = rcl_get_zero_initialized_names_and_types();
   auto topic_names_and_types_finalizer = rcpputils::make_scope_exit(
@@ -268,7 +409,7 @@ NodeGraph::get_subscriber_names_and_types_by_node(
     });
   rcl_allocator_t allocator = rcl_get_default_allocator();
   rcl_ret_t ret = rcl_get_subscriber_names_and_types_by_node(
-    node_base_->get_rcl_node_handle(),
+    node_handle,
     &allocator,
     no_demangle,
     node_name.c_str(),
@@ -289,6 +430,21 @@ NodeGraph::get_subscriber_names_and_types_by_node(
   return topics_and_types;
 }
 
+std::map<std::string, std::vector<std::string>>
+NodeGraph::get_subscriber_names_and_types_by_node(
+  const std::string & node_name,
+  const std::string & namespace_,
+  bool no_demangle) const
+{
+  return query_graph<std::map<std::string, std::vector<std::string>>>(
+    "subscriber_names_and_types_by_node" + namespace_ + "/" + node_name +
+    (no_demangle ? "/no_demangle" : ""),
+    [this, &node_name, &namespace_, no_demangle]() {
+      return query_subscriber_names_and_types_by_node(
+        node_base_->get_rcl_node_handle(), node_name, namespace_, no_demangle);
+    });
+}
+
 std::vector<std::string>
 NodeGraph::get_node_names() const
 {
@@ -317,8 +473,9 @@ NodeGraph::get_node_names() const
   return nodes;
 }
 
+static
 std::vector<std::tuple<std::string, std::string, std::string>>
-NodeGraph::get_node_names_with_enclaves() const
+query_node_names_with_enclaves(const rcl_node_t * node_handle)
 {
   rcutils_string_array_t node_names_c =
     rcutils_get_zero_initialized_string_array();
@@ -329,7 +486,7 @@ NodeGraph::get_node_names_with_enclaves() const
 
   auto allocator = rcl_get_default_allocator();
   auto ret = rcl_get_node_names_with_enclaves(
-    node_base_->get_rcl_node_handle(),
+    node_handle,
     allocator,
     &node_names_c,
     &node_namespaces_c,
@@ -392,8 +549,19 @@ NodeGraph::get_node_names_with_enclaves() const
   return node_tuples;
 }
 
+std::vector<std::tuple<std::string, std::string, std::string>>
+NodeGraph::get_node_names_with_enclaves() const
+{
+  return query_graph<std::vector<std::tuple<std::string, std::string, std::string>>>(
+    "node_names_with_enclaves",
+    [this]() {
+      return query_node_names_with_enclaves(node_base_->get_rcl_node_handle());
+    });
+}
+
+static
 std::vector<std::pair<std::string, std::string>>
-NodeGraph::get_node_names_and_namespaces() const
+query_node_names_and_namespaces(const rcl_node_t * node_handle)
 {
   rcutils_string_array_t node_names_c =
     rcutils_get_zero_initialized_string_array();
@@ -402,7 +570,7 @@ NodeGraph::get_node_names_and_namespaces() const
 
   auto allocator = rcl_get_default_allocator();
   auto ret = rcl_get_node_names(
-    node_base_->get_rcl_node_handle(),
+    node_handle,
     allocator,
     &node_names_c,
     &node_namespaces_c);
@@ -454,26 +622,36 @@ NodeGraph::get_node_names_and_namespaces() const
   return node_names;
 }
 
+std::vector<std::pair<std::string, std::string>>
+NodeGraph::get_node_names_and_namespaces() const
+{
+  return query_graph<std::vector<std::pair<std::string, std::string>>>(
+    "node_names_and_namespaces",
+    [this]() {
+      return query_node_names_and_namespaces(node_base_->get_rcl_node_handle());
+    });
+}
+
 size_t
 NodeGraph::count_publishers(const std::string & topic_name) const
 {
   auto rcl_node_handle = node_base_->get_rcl_node_handle();
 
-  auto fqdn = rclcpp::expand_topic_or_service_name(
-    topic_name,
-    rcl_node_get_name(rcl_node_handle),
-    rcl_node_get_namespace(rcl_node_handle),
-    false);    // false = not a service
-
-  size_t count;
-  auto ret = rcl_count_publishers(rcl_node_handle, fqdn.c_str(), &count);
-  if (ret != RMW_RET_OK) {
-    // *INDENT-OFF*
-    throw std::runtime_error(
-      std::string("could not count publishers: ") + rmw_get_error_string().str);
-    // *INDENT-ON*
-  }
-  return count;
+  auto fqdn = expand_name(topic_name, false);    // false = not a service
+
+  return query_graph<size_t>(
+    "count_publishers" + fqdn,
+    [rcl_node_handle, &fqdn]() {
+      size_t count;
+      auto ret = rcl_count_publishers(rcl_node_handle, fqdn.c_str(), &count);
+      if (ret != RMW_RET_OK) {
+        // *INDENT-OFF*
+        throw std::runtime_error(
+          std::string("could not count publishers: ") + rmw_get_error_string().str);
+        // *INDENT-ON*
+      }
+      return count;
+    });
 }
 
 size_t
@@ -481,21 +659,21 @@ NodeGraph::count_subscribers(const std::string & topic_name) const
 {
   auto rcl_node_handle = node_base_->get_rcl_node_handle();
 
-  auto fqdn = rclcpp::expand_topic_or_service_name(
-    topic_name,
-    rcl_node_get_name(rcl_node_handle),
-    rcl_node_get_namespace(rcl_node_handle),
-    false);    // false = not a service
-
-  size_t count;
-  auto ret = rcl_count_subscribers(rcl_node_handle, fqdn.c_str(), &count);
-  if (ret != RMW_RET_OK) {
-    // *INDENT-OFF*
-    throw std::runtime_error(
-      std::string("could not count subscribers: ") + rmw_get_error_string().str);
-    // *INDENT-ON*
-  }
-  return count;
+  auto fqdn = expand_name(topic_name, false);    // false = not a service
+
+  return query_graph<size_t>(
+    "count_subscribers" + fqdn,
+    [rcl_node_handle, &fqdn]() {
+      size_t count;
+      auto ret = rcl_count_subscribers(rcl_node_handle, fqdn.c_str(), &count);
+      if (ret != RMW_RET_OK) {
+        // *INDENT-OFF*
+        throw std::runtime_error(
+          std::string("could not count subscribers: ") + rmw_get_error_string().str);
+        // *INDENT-ON*
+      }
+      return count;
+    });
 }
 
 const rcl_guard_condition_t *
@@ -507,6 +685,10 @@ NodeGraph::get_graph_guard_condition() const
 void
 NodeGraph::notify_graph_change()
 {
+  if (graph_users_count_.load() == 0) {
+    // The graph cache and the filtered graph events are updated by the graph listener
+    return;
+  }
   {
     std::lock_guard<std::mutex> graph_changed_lock(graph_mutex_);
     bool bad_ptr_encountered = false;
@@ -566,6 +748,57 @@ NodeGraph::get_graph_event()
   return event;
 }
 
+rclcpp::Event::SharedPtr
+NodeGraph::get_filtered_graph_event(const rclcpp::GraphEventFilter & filter)
+{
+  rclcpp::GraphEventFilter expanded_filter;
+  for (const auto & topic_name : filter.topic_names) {
+    expanded_filter.topic_names.push_back(expand_name(topic_name, false));
+  }
+  for (const auto & service_name : filter.service_names) {
+    expanded_filter.service_names.push_back(expand_name(service_name, true));
+  }
+
+  auto event = rclcpp::Event::make_shared();
+  {
+    std::lock_guard<std::mutex> graph_changed_lock(graph_mutex_);
+    filtered_graph_events_.push_back(event);
+    filtered_graph_users_count_++;
+  }
+  // The graph listener queries the graph through this node, which must then not call it,
+  // so the graph cache watches the changes first if used
+  uint64_t generation = 0;
+  get_graph_generation(generation);
+  if (should_add_to_graph_listener_.exchange(false)) {
+    graph_listener_->add_node(this);
+  }
+  std::weak_ptr<rclcpp::Event> weak_event = event;
+  graph_listener_->add_graph_change_filter(
+    this,
+    expanded_filter,
+    [this, weak_event]() {
+      auto event = weak_event.lock();
+      std::lock_guard<std::mutex> graph_changed_lock(graph_mutex_);
+      if (!event) {
+        filtered_graph_events_.erase(
+          std::remove_if(
+            filtered_graph_events_.begin(),
+            filtered_graph_events_.end(),
+            [](const rclcpp::Event::WeakPtr & wptr) {
+              return wptr.expired();
+            }),
+          filtered_graph_events_.end());
+        filtered_graph_users_count_.store(filtered_graph_events_.size());
+        return false;
+      }
+      event->set();
+      graph_cv_.notify_all();
+      return true;
+    });
+  graph_listener_->start_if_not_started();
+  return event;
+}
+
 void
 NodeGraph::wait_for_graph_change(
   rclcpp::Event::SharedPtr event,
@@ -585,6 +818,12 @@ NodeGraph::wait_for_graph_change(
         break;
       }
     }
+    for (const auto & event_wptr : filtered_graph_events_) {
+      if (event_in_graph_events) {
+        break;
+      }
+      event_in_graph_events = event == event_wptr.lock();
+    }
     if (!event_in_graph_events) {
       throw EventNotRegisteredError();
     }
@@ -598,10 +837,26 @@ NodeGraph::wait_for_graph_change(
   }
 }
 
+bool
+NodeGraph::wait_for_service_ready(
+  const std::string & service_name,
+  const std::function<bool()> & is_ready,
+  std::chrono::nanoseconds timeout)
+{
+  // The graph listener wakes the waiters on the changes of the graph of this node
+  if (should_add_to_graph_listener_.exchange(false)) {
+    graph_listener_->add_node(this);
+  }
+  graph_listener_->start_if_not_started();
+  return graph_listener_->wait_for_service_ready(service_name, is_ready, timeout);
+}
+
 size_t
 NodeGraph::count_graph_users() const
 {
-  return graph_users_count_.load();
+  // The filtered graph events and the graph cache watch the graph changes as well
+  return graph_users_count_.load() + filtered_graph_users_count_.load() +
+         (graph_cache_watched_.load() ? 1u : 0u);
 }
 
 static
@@ -619,6 +874,7 @@ template<const char * EndpointType, typename FunctionT>
 static std::vector<rclcpp::TopicEndpointInfo>
 get_info_by_topic(
   rclcpp::node_interfaces::NodeBaseInterface * node_base,
+  rclcpp::detail::ResolvedNameCache & remapped_names,
   const std::string & topic_name,
   bool no_mangle,
   FunctionT rcl_get_info_by_topic)
@@ -629,37 +885,42 @@ get_info_by_topic(
   if (no_mangle) {
     fqdn = topic_name;
   } else {
-    fqdn = rclcpp::expand_topic_or_service_name(
-      topic_name,
-      rcl_node_get_name(rcl_node_handle),
-      rcl_node_get_namespace(rcl_node_handle),
-      false);    // false = not a service
-
-    // Get the node options
-    const rcl_node_options_t * node_options = rcl_node_get_options(rcl_node_handle);
-    if (nullptr == node_options) {
-      throw std::runtime_error("Need valid node options in get_info_by_topic()");
-    }
-    const rcl_arguments_t * global_args = nullptr;
-    if (node_options->use_global_arguments) {
-      global_args = &(rcl_node_handle->context->global_arguments);
-    }
-
-    char * remapped_topic_name = nullptr;
-    rcl_ret_t ret = rcl_remap_topic_name(
-      &(node_options->arguments),
-      global_args,
-      fqdn.c_str(),
-      rcl_node_get_name(rcl_node_handle),
-      rcl_node_get_namespace(rcl_node_handle),
-      node_options->allocator,
-      &remapped_topic_name);
-    if (RCL_RET_OK != ret) {
-      throw_from_rcl_error(ret, std::string("Failed to remap topic name ") + fqdn);
-    } else if (nullptr != remapped_topic_name) {
-      fqdn = remapped_topic_name;
-      node_options->allocator.deallocate(remapped_topic_name, node_options->allocator.state);
-    }
+    fqdn = remapped_names.get(
+      topic_name, false, false,
+      [rcl_node_handle, &topic_name]() {
+        std::string remapped_name = rclcpp::expand_topic_or_service_name(
+          topic_name,
+          rcl_node_get_name(rcl_node_handle),
+          rcl_node_get_namespace(rcl_node_handle),
+          false);    // false = not a service
+
+        // Get the node options
+        const rcl_node_options_t * node_options = rcl_node_get_options(rcl_node_handle);
+        if (nullptr == node_options) {
+          throw std::runtime_error("Need valid node options in get_info_by_topic()");
+        }
+        const rcl_arguments_t * global_args = nullptr;
+        if (node_options->use_global_arguments) {
+          global_args = &(rcl_node_handle->context->global_arguments);
+        }
+
+        char * remapped_topic_name = nullptr;
+        rcl_ret_t ret = rcl_remap_topic_name(
+          &(node_options->arguments),
+          global_args,
+          remapped_name.c_str(),
+          rcl_node_get_name(rcl_node_handle),
+          rcl_node_get_namespace(rcl_node_handle),
+          node_options->allocator,
+          &remapped_topic_name);
+        if (RCL_RET_OK != ret) {
+          throw_from_rcl_error(ret, std::string("Failed to remap topic name ") + remapped_name);
+        } else if (nullptr != remapped_topic_name) {
+          remapped_name = remapped_topic_name;
+          node_options->allocator.deallocate(remapped_topic_name, node_options->allocator.state);
+        }
+        return remapped_name;
+      });
   }
 
   rcutils_allocator_t allocator = rcutils_get_default_allocator();
@@ -698,11 +959,20 @@ NodeGraph::get_publishers_info_by_topic(
   const std::string & topic_name,
   bool no_mangle) const
 {
-  return get_info_by_topic<kPublisherEndpointTypeName>(
-    node_base_,
+  // Unless no_mangle is true, the topic name is expanded and remapped for this node
+  return query_graph<std::vector<rclcpp::TopicEndpointInfo>>(
+    no_mangle ?
+    "publishers_info_by_topic/no_mangle " + topic_name :
+    "publishers_info_by_topic " + std::string(node_base_->get_fully_qualified_name()) + " " +
     topic_name,
-    no_mangle,
-    rcl_get_publishers_info_by_topic);
+    [this, &topic_name, no_mangle]() {
+      return get_info_by_topic<kPublisherEndpointTypeName>(
+        node_base_,
+        *expanded_names_,
+        topic_name,
+        no_mangle,
+        rcl_get_publishers_info_by_topic);
+    });
 }
 
 static constexpr char kSubscriptionEndpointTypeName[] = "subscriptions";
@@ -711,11 +981,20 @@ NodeGraph::get_subscriptions_info_by_topic(
   const std::string & topic_name,
   bool no_mangle) const
 {
-  return get_info_by_topic<kSubscriptionEndpointTypeName>(
-    node_base_,
+  // Unless no_mangle is true, the topic name is expanded and remapped for this node
+  return query_graph<std::vector<rclcpp::TopicEndpointInfo>>(
+    no_mangle ?
+    "subscriptions_info_by_topic/no_mangle " + topic_name :
+    "subscriptions_info_by_topic " + std::string(node_base_->get_fully_qualified_name()) + " " +
     topic_name,
-    no_mangle,
-    rcl_get_subscriptions_info_by_topic);
+    [this, &topic_name, no_mangle]() {
+      return get_info_by_topic<kSubscriptionEndpointTypeName>(
+        node_base_,
+        *expanded_names_,
+        topic_name,
+        no_mangle,
+        rcl_get_subscriptions_info_by_topic);
+    });
 }
 
 std::string &
@@ -14,16 +14,29 @@
 
 #include "rclcpp/node_interfaces/node_logging.hpp"
 
+#include "../detail/shared_node_publishers.hpp"
+
 using rclcpp::node_interfaces::NodeLogging;
 
-NodeLogging::NodeLogging(rclcpp::node_interfaces::NodeBaseInterface * node_base)
+NodeLogging::NodeLogging(
+  rclcpp::node_interfaces::NodeBaseInterface * node_base,
+  bool use_shared_rosout)
 : node_base_(node_base)
 {
   logger_ = rclcpp::get_logger(NodeLogging::get_logger_name());
+  if (use_shared_rosout) {
+    auto context = node_base_->get_context();
+    shared_publishers_ = context->get_sub_context<rclcpp::detail::SharedNodePublishers>(
+      context->get_rcl_context(), context->get_init_options().rosout_batching);
+    shared_publishers_->add_rosout_logger(logger_.get_name());
+  }
 }
 
 NodeLogging::~NodeLogging()
 {
+  if (shared_publishers_) {
+    shared_publishers_->remove_rosout_logger(logger_.get_name());
+  }
 }
 
 rclcpp::Logger
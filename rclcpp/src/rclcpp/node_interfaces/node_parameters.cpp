@@ -16,8 +16,11 @@
 
 #include <rcl_yaml_param_parser/parser.h>
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <cmath>
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <functional>
@@ -26,42 +29,99 @@
 #include <memory>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "rcl_interfaces/srv/describe_parameters.hpp"
 #include "rcl_interfaces/srv/list_parameters.hpp"
 #include "rclcpp/create_publisher.hpp"
 #include "rclcpp/parameter_map.hpp"
+#include "rclcpp/serialization.hpp"
+#include "rclcpp/serialized_message.hpp"
 #include "rcutils/logging_macros.h"
 #include "rmw/qos_profiles.h"
 
+#include "../detail/node_startup_profile.hpp"
+#include "../detail/parameter_name_index.hpp"
 #include "../detail/resolve_parameter_overrides.hpp"
+#include "../detail/shared_node_publishers.hpp"
 
 using rclcpp::node_interfaces::NodeParameters;
+using rclcpp::detail::ParameterNameIndex;
+
+using ParameterInfos = std::unordered_map<std::string, rclcpp::node_interfaces::ParameterInfo>;
+using SharedParameterInfos = std::unordered_map<
+  std::string, std::shared_ptr<const rclcpp::node_interfaces::ParameterInfo>>;
+
+struct NodeParameters::ParametersSnapshot
+{
+  SharedParameterInfos parameters;
+  std::shared_ptr<const ParameterNameIndex> name_index;
+};
+
+/// Return an estimate of the memory used by a parameter, its name, value and descriptor.
+RCLCPP_LOCAL
+size_t
+get_parameter_memory_size(
+  const std::string & name, const rclcpp::node_interfaces::ParameterInfo & info)
+{
+  size_t size = sizeof(std::string) + name.capacity() +
+    sizeof(rclcpp::node_interfaces::ParameterInfo) + info.descriptor.name.capacity() +
+    info.descriptor.description.capacity() + info.descriptor.additional_constraints.capacity();
+  const rclcpp::ParameterValue & value = info.value;
+  switch (value.get_type()) {
+    case rclcpp::ParameterType::PARAMETER_STRING:
+      size += value.get<rclcpp::ParameterType::PARAMETER_STRING>().capacity();
+      break;
+    case rclcpp::ParameterType::PARAMETER_BYTE_ARRAY:
+      size += value.get<rclcpp::ParameterType::PARAMETER_BYTE_ARRAY>().capacity();
+      break;
+    case rclcpp::ParameterType::PARAMETER_BOOL_ARRAY:
+      size += value.get<rclcpp::ParameterType::PARAMETER_BOOL_ARRAY>().capacity();
+      break;
+    case rclcpp::ParameterType::PARAMETER_INTEGER_ARRAY:
+      size += value.get<rclcpp::ParameterType::PARAMETER_INTEGER_ARRAY>().capacity() *
+        sizeof(int64_t);
+      break;
+    case rclcpp::ParameterType::PARAMETER_DOUBLE_ARRAY:
+      size += value.get<rclcpp::ParameterType::PARAMETER_DOUBLE_ARRAY>().capacity() *
+        sizeof(double);
+      break;
+    case rclcpp::ParameterType::PARAMETER_STRING_ARRAY:
+      for (const auto & string : value.get<rclcpp::ParameterType::PARAMETER_STRING_ARRAY>()) {
+        size += sizeof(std::string) + string.capacity();
+      }
+      break;
+    default:
+      break;
+  }
+  return size;
+}
 
 RCLCPP_LOCAL
 void
 local_perform_automatically_declare_parameters_from_overrides(
   const std::map<std::string, rclcpp::ParameterValue> & parameter_overrides,
   std::function<bool(const std::string &)> has_parameter,
-  std::function<void(
-    const std::string &,
-    const rclcpp::ParameterValue &,
-    const rcl_interfaces::msg::ParameterDescriptor &,
-    bool)>
-  declare_parameter)
+  std::function<void(const std::vector<rclcpp::node_interfaces::ParameterDeclaration> &)>
+  declare_parameters)
 {
-  rcl_interfaces::msg::ParameterDescriptor descriptor;
-  descriptor.dynamic_typing = true;
+  std::vector<rclcpp::node_interfaces::ParameterDeclaration> declarations;
   for (const auto & pair : parameter_overrides) {
     if (!has_parameter(pair.first)) {
-      declare_parameter(
-        pair.first,
-        pair.second,
-        descriptor,
-        true);
+      rclcpp::node_interfaces::ParameterDeclaration declaration;
+      declaration.name = pair.first;
+      declaration.default_value = pair.second;
+      declaration.descriptor.dynamic_typing = true;
+      declarations.push_back(std::move(declaration));
     }
   }
+  if (!declarations.empty()) {
+    declare_parameters(declarations);
+  }
 }
 
 NodeParameters::NodeParameters(
@@ -76,12 +136,19 @@ NodeParameters::NodeParameters(
   const rclcpp::QoS & parameter_event_qos,
   const rclcpp::PublisherOptionsBase & parameter_event_publisher_options,
   bool allow_undeclared_parameters,
-  bool automatically_declare_parameters_from_overrides)
-: allow_undeclared_(allow_undeclared_parameters),
+  bool automatically_declare_parameters_from_overrides,
+  bool use_shared_parameter_event_publisher,
+  const std::vector<uint8_t> & parameter_state)
+: parameter_name_index_(std::make_shared<ParameterNameIndex>()),
+  parameters_snapshot_(
+    std::make_shared<const ParametersSnapshot>(
+      ParametersSnapshot{{}, std::make_shared<const ParameterNameIndex>()})),
+  allow_undeclared_(allow_undeclared_parameters),
   events_publisher_(nullptr),
   node_logging_(node_logging),
   node_clock_(node_clock)
 {
+  rclcpp::detail::NodeStartupPhaseTimer startup_timer(&rclcpp::NodeStartupProfile::parameters);
   using MessageT = rcl_interfaces::msg::ParameterEvent;
   using PublisherT = rclcpp::Publisher<MessageT>;
   using AllocatorT = std::allocator<void>;
@@ -94,7 +161,11 @@ NodeParameters::NodeParameters(
     parameter_service_ = std::make_shared<ParameterService>(node_base, node_services, this);
   }
 
-  if (start_parameter_event_publisher) {
+  if (start_parameter_event_publisher && use_shared_parameter_event_publisher) {
+    auto context = node_base->get_context();
+    shared_publishers_ = context->get_sub_context<rclcpp::detail::SharedNodePublishers>(
+      context->get_rcl_context(), context->get_init_options().rosout_batching);
+  } else if (start_parameter_event_publisher) {
     // TODO(ivanpauno): Qos of the `/parameters_event` topic should be somehow overridable.
     events_publisher_ = rclcpp::create_publisher<MessageT, AllocatorT, PublisherT>(
       node_topics,
@@ -113,15 +184,20 @@ NodeParameters::NodeParameters(
     throw std::runtime_error("Need valid node options in NodeParameters");
   }
 
-  const rcl_arguments_t * global_args = nullptr;
+  // The overrides of the global arguments are shared by the nodes of the context
+  std::shared_ptr<rclcpp::detail::GlobalParameterOverrides> global_overrides;
   if (options->use_global_arguments) {
-    auto context_ptr = node_base->get_context()->get_rcl_context();
-    global_args = &(context_ptr->global_arguments);
+    auto context = node_base->get_context();
+    global_overrides = context->get_sub_context<rclcpp::detail::GlobalParameterOverrides>(
+      context->get_rcl_context());
   }
   combined_name_ = node_base->get_fully_qualified_name();
 
   parameter_overrides_ = rclcpp::detail::resolve_parameter_overrides(
-    combined_name_, parameter_overrides, &options->arguments, global_args);
+    combined_name_, parameter_overrides, &options->arguments,
+    global_overrides ? global_overrides->get_params() : nullptr);
+
+  load_parameter_state(parameter_state);
 
   // If asked, initialize any parameters that ended up in the initial parameter values,
   // but did not get declared explcitily by this point.
@@ -130,17 +206,25 @@ NodeParameters::NodeParameters(
     local_perform_automatically_declare_parameters_from_overrides(
       this->get_parameter_overrides(),
       std::bind(&NodeParameters::has_parameter, this, _1),
-      [this](
-        const std::string & name,
-        const rclcpp::ParameterValue & default_value,
-        const rcl_interfaces::msg::ParameterDescriptor & parameter_descriptor,
-        bool ignore_override)
+      [this](const std::vector<ParameterDeclaration> & declarations)
       {
-        NodeParameters::declare_parameter(
-          name, default_value, parameter_descriptor, ignore_override);
+        NodeParameters::declare_parameters(declarations, true);
       }
     );
   }
+
+  memory_account_ = rclcpp::MemoryAccounting::create_account(
+    combined_name_, "parameters", rclcpp::MemoryEntityKind::Parameters,
+    [this]() {
+      rclcpp::MemorySample sample;
+      auto snapshot = parameters_snapshot_.load();
+      for (const auto & parameter : snapshot->parameters) {
+        sample.bytes_in_use += get_parameter_memory_size(parameter.first, *parameter.second);
+      }
+      // parameters_ holds the same parameters as its snapshot
+      sample.bytes_in_use *= 2;
+      return sample;
+    });
 }
 
 void
@@ -151,14 +235,9 @@ NodeParameters::perform_automatically_declare_parameters_from_overrides()
     [this](const std::string & name) {
       return this->has_parameter(name);
     },
-    [this](
-      const std::string & name,
-      const rclcpp::ParameterValue & default_value,
-      const rcl_interfaces::msg::ParameterDescriptor & parameter_descriptor,
-      bool ignore_override)
+    [this](const std::vector<ParameterDeclaration> & declarations)
     {
-      this->declare_parameter(
-        name, default_value, parameter_descriptor, ignore_override);
+      this->declare_parameters(declarations, true);
     }
   );
 }
@@ -166,10 +245,242 @@ NodeParameters::perform_automatically_declare_parameters_from_overrides()
 NodeParameters::~NodeParameters()
 {}
 
-RCLCPP_LOCAL
+// The state is the size of the serialized values, the values and then the descriptors.
+using ParameterStateSize = uint64_t;
+
+std::vector<uint8_t>
+NodeParameters::save_parameter_state() const
+{
+  const auto parameters = get_parameters_snapshot();
+  std::vector<std::string> names;
+  names.reserve(parameters->size());
+  for (const auto & parameter : *parameters) {
+    if (parameter.second->value.get_type() != rclcpp::PARAMETER_NOT_SET) {
+      names.push_back(parameter.first);
+    }
+  }
+  std::sort(names.begin(), names.end());
+
+  rcl_interfaces::msg::ParameterEvent values;
+  values.node = combined_name_;
+  values.new_parameters.reserve(names.size());
+  rcl_interfaces::srv::DescribeParameters::Response descriptors;
+  descriptors.descriptors.reserve(names.size());
+  for (const auto & name : names) {
+    const ParameterInfo & parameter_info = *parameters->at(name);
+    values.new_parameters.push_back(
+      rclcpp::Parameter(name, parameter_info.value).to_parameter_msg());
+    descriptors.descriptors.push_back(parameter_info.descriptor);
+  }
+
+  rclcpp::SerializedMessage serialized_values;
+  rclcpp::Serialization<rcl_interfaces::msg::ParameterEvent>().serialize_message(
+    &values, &serialized_values);
+  rclcpp::SerializedMessage serialized_descriptors;
+  rclcpp::Serialization<rcl_interfaces::srv::DescribeParameters::Response>().serialize_message(
+    &descriptors, &serialized_descriptors);
+
+  const auto & values_message = serialized_values.get_rcl_serialized_message();
+  const auto & descriptors_message = serialized_descriptors.get_rcl_serialized_message();
+  const ParameterStateSize values_size = values_message.buffer_length;
+  std::vector<uint8_t> state(
+    sizeof(values_size) + values_message.buffer_length + descriptors_message.buffer_length);
+  std::memcpy(state.data(), &values_size, sizeof(values_size));
+  std::memcpy(
+    state.data() + sizeof(values_size), values_message.buffer, values_message.buffer_length);
+  std::memcpy(
+    state.data() + sizeof(values_size) + values_message.buffer_length,
+    descriptors_message.buffer, descriptors_message.buffer_length);
+  return state;
+}
+
+static
+rclcpp::SerializedMessage
+__to_serialized_message(const uint8_t * data, size_t size)
+{
+  rclcpp::SerializedMessage serialized_message(size);
+  auto & rcl_message = serialized_message.get_rcl_serialized_message();
+  if (size > 0) {
+    std::memcpy(rcl_message.buffer, data, size);
+  }
+  rcl_message.buffer_length = size;
+  return serialized_message;
+}
+
+void
+NodeParameters::load_parameter_state(const std::vector<uint8_t> & parameter_state)
+{
+  if (parameter_state.empty()) {
+    return;
+  }
+  ParameterStateSize values_size = 0;
+  if (parameter_state.size() < sizeof(values_size)) {
+    throw std::invalid_argument("parameter state is too short");
+  }
+  std::memcpy(&values_size, parameter_state.data(), sizeof(values_size));
+  if (values_size > parameter_state.size() - sizeof(values_size)) {
+    throw std::invalid_argument("parameter state is truncated");
+  }
+  const uint8_t * values_data = parameter_state.data() + sizeof(values_size);
+  const uint8_t * descriptors_data = values_data + values_size;
+  const size_t descriptors_size = parameter_state.size() - sizeof(values_size) - values_size;
+
+  using DescriptorsT = rcl_interfaces::srv::DescribeParameters::Response;
+  rcl_interfaces::msg::ParameterEvent values;
+  DescriptorsT descriptors;
+  try {
+    auto serialized_values = __to_serialized_message(values_data, values_size);
+    rclcpp::Serialization<rcl_interfaces::msg::ParameterEvent>().deserialize_message(
+      &serialized_values, &values);
+    auto serialized_descriptors = __to_serialized_message(descriptors_data, descriptors_size);
+    rclcpp::Serialization<DescriptorsT>().deserialize_message(
+      &serialized_descriptors, &descriptors);
+  } catch (const std::runtime_error & e) {
+    throw std::invalid_argument(std::string("parameter state is malformed: ") + e.what());
+  }
+  if (values.new_parameters.size() != descriptors.descriptors.size()) {
+    throw std::invalid_argument("parameter state has a different number of values and descriptors");
+  }
+
+  for (size_t i = 0; i < values.new_parameters.size(); ++i) {
+    const auto & parameter = values.new_parameters[i];
+    if (parameter.name.empty() || parameter.name != descriptors.descriptors[i].name) {
+      throw std::invalid_argument(
+              "parameter state has a value without its descriptor: '" + parameter.name + "'");
+    }
+    ParameterInfo & parameter_info = restored_parameters_[parameter.name];
+    parameter_info.value = rclcpp::ParameterValue(parameter.value);
+    parameter_info.descriptor = descriptors.descriptors[i];
+  }
+}
+
+class NodeParameters::ParameterModificationScope
+{
+public:
+  explicit ParameterModificationScope(NodeParameters & node_parameters)
+  : node_parameters_(node_parameters)
+  {
+    if (0 == node_parameters_.modification_depth_++) {
+      node_parameters_.modifying_thread_.store(
+        std::this_thread::get_id(), std::memory_order_relaxed);
+    }
+  }
+
+  ~ParameterModificationScope()
+  {
+    // The nested modifications are published together by the outermost one
+    if (0 == --node_parameters_.modification_depth_) {
+      node_parameters_.update_parameters_snapshot();
+      node_parameters_.modifying_thread_.store(std::thread::id(), std::memory_order_relaxed);
+    }
+  }
+
+  /// Record a parameter the modification may change, compared with its copy when publishing.
+  void
+  add_parameter_name(const std::string & name)
+  {
+    node_parameters_.modified_parameter_names_.push_back(name);
+  }
+
+private:
+  NodeParameters & node_parameters_;
+};
+
+void
+NodeParameters::update_shared_parameters() const
+{
+  for (const std::string & name : modified_parameter_names_) {
+    auto parameter_it = parameters_.find(name);
+    auto shared_it = shared_parameters_.find(name);
+    if (parameter_it == parameters_.end()) {
+      if (shared_it != shared_parameters_.end()) {
+        shared_parameters_.erase(shared_it);
+        parameter_name_index_->remove(name);
+        shared_parameters_changed_ = true;
+      }
+    } else if (shared_it == shared_parameters_.end()) {
+      shared_parameters_.emplace(name, std::make_shared<const ParameterInfo>(parameter_it->second));
+      parameter_name_index_->add(name);
+      shared_parameters_changed_ = true;
+    } else if (
+      shared_it->second->value != parameter_it->second.value ||
+      shared_it->second->descriptor != parameter_it->second.descriptor)
+    {
+      // The previous copy stays in the snapshots still read
+      shared_it->second = std::make_shared<const ParameterInfo>(parameter_it->second);
+      shared_parameters_changed_ = true;
+    }
+  }
+}
+
+void
+NodeParameters::update_parameters_snapshot()
+{
+  update_shared_parameters();
+  modified_parameter_names_.clear();
+  // A failed modification, or one setting the same values, keeps the current snapshot
+  if (!shared_parameters_changed_) {
+    return;
+  }
+  shared_parameters_changed_ = false;
+
+  // The parameters themselves aren't copied, but the map of the pointers to all of them is:
+  // one node and one reference count increment per parameter, not only per changed one.
+  // Copying the index only copies the pointer to its root namespace.
+  auto name_index = std::make_shared<const ParameterNameIndex>(*parameter_name_index_);
+  parameters_snapshot_.store(
+    std::make_shared<const ParametersSnapshot>(
+      ParametersSnapshot{shared_parameters_, std::move(name_index)}));
+
+  for (auto cell_it = parameter_value_cells_.begin(); cell_it != parameter_value_cells_.end(); ) {
+    auto cell = cell_it->second.lock();
+    if (!cell) {
+      cell_it = parameter_value_cells_.erase(cell_it);
+      continue;
+    }
+    auto parameter_it = parameters_.find(cell_it->first);
+    const rclcpp::ParameterValue value =
+      parameter_it != parameters_.end() ? parameter_it->second.value : rclcpp::ParameterValue();
+    // The version of the handles changes only when the value changed
+    if (*cell->get_value() != value) {
+      cell->store(value);
+    }
+    ++cell_it;
+  }
+}
+
+std::shared_ptr<const NodeParameters::SharedParameterInfos>
+NodeParameters::get_parameters_snapshot() const
+{
+  // Only this thread stores its id, and it holds mutex_ while modifying the parameters,
+  // so the callbacks it calls read the parameters being modified
+  if (modifying_thread_.load(std::memory_order_relaxed) == std::this_thread::get_id()) {
+    update_shared_parameters();
+    return std::shared_ptr<const SharedParameterInfos>(
+      std::shared_ptr<void>(), &shared_parameters_);
+  }
+  auto snapshot = parameters_snapshot_.load();
+  return std::shared_ptr<const SharedParameterInfos>(snapshot, &snapshot->parameters);
+}
+
+std::shared_ptr<const ParameterNameIndex>
+NodeParameters::get_parameter_name_index(
+  std::shared_ptr<const SharedParameterInfos> & parameters) const
+{
+  if (modifying_thread_.load(std::memory_order_relaxed) == std::this_thread::get_id()) {
+    // The names of the parameters being declared or undeclared are indexed with them
+    parameters = get_parameters_snapshot();
+    return parameter_name_index_;
+  }
+  auto snapshot = parameters_snapshot_.load();
+  parameters = std::shared_ptr<const SharedParameterInfos>(snapshot, &snapshot->parameters);
+  return snapshot->name_index;
+}
+
+template<typename ParameterInfosT>
 bool
 __lockless_has_parameter(
-  const std::map<std::string, rclcpp::node_interfaces::ParameterInfo> & parameters,
+  const ParameterInfosT & parameters,
   const std::string & name)
 {
   return parameters.find(name) != parameters.end();
@@ -264,7 +575,7 @@ format_type_reason(
 RCLCPP_LOCAL
 rcl_interfaces::msg::SetParametersResult
 __check_parameters(
-  std::map<std::string, rclcpp::node_interfaces::ParameterInfo> & parameter_infos,
+  ParameterInfos & parameter_infos,
   const std::vector<rclcpp::Parameter> & parameters,
   bool allow_undeclared)
 {
@@ -397,7 +708,7 @@ RCLCPP_LOCAL
 rcl_interfaces::msg::SetParametersResult
 __set_parameters_atomically_common(
   const std::vector<rclcpp::Parameter> & parameters,
-  std::map<std::string, rclcpp::node_interfaces::ParameterInfo> & parameter_infos,
+  ParameterInfos & parameter_infos,
   OnSetCallbacksHandleContainer & on_set_callback_container,
   PostSetCallbacksHandleContainer & post_set_callback_container,
   bool allow_undeclared = false)
@@ -436,7 +747,7 @@ __declare_parameter_common(
   const std::string & name,
   const rclcpp::ParameterValue & default_value,
   const rcl_interfaces::msg::ParameterDescriptor & parameter_descriptor,
-  std::map<std::string, rclcpp::node_interfaces::ParameterInfo> & parameters_out,
+  ParameterInfos & parameters_out,
   const std::map<std::string, rclcpp::ParameterValue> & overrides,
   OnSetCallbacksHandleContainer & on_set_callback_container,
   PostSetCallbacksHandleContainer & post_set_callback_container,
@@ -444,7 +755,7 @@ __declare_parameter_common(
   bool ignore_override = false)
 {
   using rclcpp::node_interfaces::ParameterInfo;
-  std::map<std::string, ParameterInfo> parameter_infos {{name, ParameterInfo()}};
+  ParameterInfos parameter_infos {{name, ParameterInfo()}};
   parameter_infos.at(name).descriptor = parameter_descriptor;
 
   // Use the value from the overrides if available, otherwise use the default.
@@ -494,6 +805,66 @@ __declare_parameter_common(
   return result;
 }
 
+// Set the type of a statically typed parameter in its descriptor.
+RCLCPP_LOCAL
+void
+__set_declared_parameter_type(
+  const std::string & name,
+  rclcpp::ParameterType type,
+  const rclcpp::ParameterValue & default_value,
+  rcl_interfaces::msg::ParameterDescriptor & parameter_descriptor)
+{
+  if (!parameter_descriptor.dynamic_typing) {
+    if (rclcpp::PARAMETER_NOT_SET == type) {
+      type = default_value.get_type();
+    }
+    if (rclcpp::PARAMETER_NOT_SET == type) {
+      throw rclcpp::exceptions::InvalidParameterTypeException{
+              name,
+              "cannot declare a statically typed parameter with an uninitialized value"
+      };
+    }
+    parameter_descriptor.type = static_cast<uint8_t>(type);
+  }
+}
+
+// Throw the exception of a declaration whose initial value failed to be set.
+[[noreturn]]
+RCLCPP_LOCAL
+void
+__throw_declaration_failure(
+  const std::string & name,
+  const rcl_interfaces::msg::SetParametersResult & result)
+{
+  constexpr const char type_error_msg_start[] = "Wrong parameter type";
+  if (
+    0u == std::strncmp(
+      result.reason.c_str(), type_error_msg_start, sizeof(type_error_msg_start) - 1))
+  {
+    // TODO(ivanpauno): Refactor the logic so we don't need the above `strncmp` and we can
+    // detect between both exceptions more elegantly.
+    throw rclcpp::exceptions::InvalidParameterTypeException(name, result.reason);
+  }
+  throw rclcpp::exceptions::InvalidParameterValueException(
+          "parameter '" + name + "' could not be set: " + result.reason);
+}
+
+// Return true if a restored parameter was declared with the same descriptor, once named and typed.
+RCLCPP_LOCAL
+bool
+__matches_restored_descriptor(
+  const std::string & name,
+  rcl_interfaces::msg::ParameterDescriptor parameter_descriptor,
+  const rclcpp::node_interfaces::ParameterInfo & restored)
+{
+  parameter_descriptor.name = name;
+  if (parameter_descriptor.dynamic_typing) {
+    parameter_descriptor.type = restored.value.get_type();
+  }
+  return parameter_descriptor == restored.descriptor &&
+         parameter_descriptor.type == restored.value.get_type();
+}
+
 static
 const rclcpp::ParameterValue &
 declare_parameter_helper(
@@ -502,13 +873,12 @@ declare_parameter_helper(
   const rclcpp::ParameterValue & default_value,
   rcl_interfaces::msg::ParameterDescriptor parameter_descriptor,
   bool ignore_override,
-  std::map<std::string, rclcpp::node_interfaces::ParameterInfo> & parameters,
+  ParameterInfos & parameters,
   const std::map<std::string, rclcpp::ParameterValue> & overrides,
+  ParameterInfos & restored_parameters,
   OnSetCallbacksHandleContainer & on_set_callback_container,
   PostSetCallbacksHandleContainer & post_set_callback_container,
-  rclcpp::Publisher<rcl_interfaces::msg::ParameterEvent> * events_publisher,
-  const std::string & combined_name,
-  rclcpp::node_interfaces::NodeClockInterface & node_clock)
+  rcl_interfaces::msg::ParameterEvent & parameter_event)
 {
   // TODO(sloretz) parameter name validation
   if (name.empty()) {
@@ -521,51 +891,38 @@ declare_parameter_helper(
             "parameter '" + name + "' has already been declared");
   }
 
-  if (!parameter_descriptor.dynamic_typing) {
-    if (rclcpp::PARAMETER_NOT_SET == type) {
-      type = default_value.get_type();
-    }
-    if (rclcpp::PARAMETER_NOT_SET == type) {
-      throw rclcpp::exceptions::InvalidParameterTypeException{
-              name,
-              "cannot declare a statically typed parameter with an uninitialized value"
-      };
+  __set_declared_parameter_type(name, type, default_value, parameter_descriptor);
+
+  // A restored value declared the same way was already validated, otherwise it is validated
+  // like an override
+  auto restored_it = restored_parameters.find(name);
+  std::map<std::string, rclcpp::ParameterValue> restored_override;
+  if (restored_it != restored_parameters.end()) {
+    if (__matches_restored_descriptor(name, parameter_descriptor, restored_it->second)) {
+      parameters[name] = std::move(restored_it->second);
+      restored_parameters.erase(restored_it);
+      return parameters.at(name).value;
     }
-    parameter_descriptor.type = static_cast<uint8_t>(type);
+    restored_override.emplace(name, restored_it->second.value);
   }
 
-  rcl_interfaces::msg::ParameterEvent parameter_event;
   auto result = __declare_parameter_common(
     name,
     default_value,
     parameter_descriptor,
     parameters,
-    overrides,
+    restored_override.empty() ? overrides : restored_override,
     on_set_callback_container,
     post_set_callback_container,
     &parameter_event,
-    ignore_override);
+    ignore_override && restored_override.empty());
 
   // If it failed to be set, then throw an exception.
   if (!result.successful) {
-    constexpr const char type_error_msg_start[] = "Wrong parameter type";
-    if (
-      0u == std::strncmp(
-        result.reason.c_str(), type_error_msg_start, sizeof(type_error_msg_start) - 1))
-    {
-      // TODO(ivanpauno): Refactor the logic so we don't need the above `strncmp` and we can
-      // detect between both exceptions more elegantly.
-      throw rclcpp::exceptions::InvalidParameterTypeException(name, result.reason);
-    }
-    throw rclcpp::exceptions::InvalidParameterValueException(
-            "parameter '" + name + "' could not be set: " + result.reason);
+    __throw_declaration_failure(name, result);
   }
-
-  // Publish if events_publisher_ is not nullptr, which may be if disabled in the constructor.
-  if (nullptr != events_publisher) {
-    parameter_event.node = combined_name;
-    parameter_event.stamp = node_clock.get_clock()->now();
-    events_publisher->publish(parameter_event);
+  if (!restored_override.empty()) {
+    restored_parameters.erase(restored_it);
   }
 
   return parameters.at(name).value;
@@ -580,8 +937,11 @@ NodeParameters::declare_parameter(
 {
   std::lock_guard<std::recursive_mutex> lock(mutex_);
   ParameterMutationRecursionGuard guard(parameter_modification_enabled_);
+  ParameterModificationScope modification_scope(*this);
+  modification_scope.add_parameter_name(name);
 
-  return declare_parameter_helper(
+  rcl_interfaces::msg::ParameterEvent parameter_event;
+  const auto & value = declare_parameter_helper(
     name,
     rclcpp::PARAMETER_NOT_SET,
     default_value,
@@ -589,11 +949,12 @@ NodeParameters::declare_parameter(
     ignore_override,
     parameters_,
     parameter_overrides_,
+    restored_parameters_,
     on_set_parameters_callback_container_,
     post_set_parameters_callback_container_,
-    events_publisher_.get(),
-    combined_name_,
-    *node_clock_);
+    parameter_event);
+  publish_parameter_event(parameter_event);
+  return value;
 }
 
 const rclcpp::ParameterValue &
@@ -605,6 +966,8 @@ NodeParameters::declare_parameter(
 {
   std::lock_guard<std::recursive_mutex> lock(mutex_);
   ParameterMutationRecursionGuard guard(parameter_modification_enabled_);
+  ParameterModificationScope modification_scope(*this);
+  modification_scope.add_parameter_name(name);
 
   if (rclcpp::PARAMETER_NOT_SET == type) {
     throw std::invalid_argument{
@@ -617,7 +980,8 @@ NodeParameters::declare_parameter(
             "with `dynamic_typing=true`"};
   }
 
-  return declare_parameter_helper(
+  rcl_interfaces::msg::ParameterEvent parameter_event;
+  const auto & value = declare_parameter_helper(
     name,
     type,
     rclcpp::ParameterValue{},
@@ -625,11 +989,120 @@ NodeParameters::declare_parameter(
     ignore_override,
     parameters_,
     parameter_overrides_,
+    restored_parameters_,
     on_set_parameters_callback_container_,
     post_set_parameters_callback_container_,
-    events_publisher_.get(),
-    combined_name_,
-    *node_clock_);
+    parameter_event);
+  publish_parameter_event(parameter_event);
+  return value;
+}
+
+std::vector<rclcpp::ParameterValue>
+NodeParameters::declare_parameters(
+  const std::vector<ParameterDeclaration> & declarations,
+  bool ignore_overrides)
+{
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  ParameterMutationRecursionGuard guard(parameter_modification_enabled_);
+  ParameterModificationScope modification_scope(*this);
+  for (const ParameterDeclaration & declaration : declarations) {
+    modification_scope.add_parameter_name(declaration.name);
+  }
+
+  // Validate all the declarations before calling any callback, so nothing is declared on error
+  ParameterInfos parameter_infos;
+  std::vector<rclcpp::Parameter> initial_parameters;
+  initial_parameters.reserve(declarations.size());
+  std::vector<std::string> restored_names;
+  for (const ParameterDeclaration & declaration : declarations) {
+    const std::string & name = declaration.name;
+    // TODO(sloretz) parameter name validation
+    if (name.empty()) {
+      throw rclcpp::exceptions::InvalidParametersException("parameter name must not be empty");
+    }
+    if (__lockless_has_parameter(parameters_, name) || parameter_infos.count(name) > 0) {
+      throw rclcpp::exceptions::ParameterAlreadyDeclaredException(
+              "parameter '" + name + "' has already been declared");
+    }
+
+    ParameterInfo & parameter_info = parameter_infos[name];
+    parameter_info.descriptor = declaration.descriptor;
+    __set_declared_parameter_type(
+      name, declaration.type, declaration.default_value, parameter_info.descriptor);
+    parameter_info.descriptor.name = name;
+
+    // Use the restored value, or the value from the overrides if available, otherwise use the
+    // default.
+    const rclcpp::ParameterValue * initial_value = &declaration.default_value;
+    auto overrides_it = parameter_overrides_.find(name);
+    auto restored_it = restored_parameters_.find(name);
+    if (restored_it != restored_parameters_.end()) {
+      restored_names.push_back(name);
+      if (__matches_restored_descriptor(name, parameter_info.descriptor, restored_it->second)) {
+        // Already validated, the callbacks aren't called for this parameter
+        parameter_info = restored_it->second;
+        continue;
+      }
+      initial_value = &restored_it->second.value;
+    } else if (!ignore_overrides && overrides_it != parameter_overrides_.end()) {
+      initial_value = &overrides_it->second;
+    }
+
+    if (initial_value->get_type() == rclcpp::PARAMETER_NOT_SET) {
+      // Declared without a value, the callbacks aren't called for this parameter
+      if (parameter_info.descriptor.dynamic_typing) {
+        parameter_info.descriptor.type = rclcpp::PARAMETER_NOT_SET;
+      }
+      continue;
+    }
+    initial_parameters.emplace_back(name, *initial_value);
+
+    // Check the initial value complies with the descriptor.
+    auto result = __check_parameters(parameter_infos, {initial_parameters.back()}, false);
+    if (!result.successful) {
+      __throw_declaration_failure(name, result);
+    }
+  }
+
+  if (!initial_parameters.empty()) {
+    // Check with the user's callbacks, once for all the initial values.
+    auto result = __call_on_set_parameters_callbacks(
+      initial_parameters, on_set_parameters_callback_container_);
+    if (!result.successful) {
+      if (initial_parameters.size() == 1) {
+        __throw_declaration_failure(initial_parameters.front().get_name(), result);
+      }
+      throw rclcpp::exceptions::InvalidParameterValueException(
+              "parameters could not be set: " + result.reason);
+    }
+    for (const rclcpp::Parameter & parameter : initial_parameters) {
+      ParameterInfo & parameter_info = parameter_infos[parameter.get_name()];
+      parameter_info.descriptor.type = parameter.get_type();
+      parameter_info.value = parameter.get_parameter_value();
+    }
+    __call_post_set_parameters_callbacks(
+      initial_parameters, post_set_parameters_callback_container_);
+  }
+
+  // Add declared parameters to storage.
+  parameters_.merge(parameter_infos);
+  for (const std::string & name : restored_names) {
+    restored_parameters_.erase(name);
+  }
+
+  std::vector<rclcpp::ParameterValue> values;
+  values.reserve(declarations.size());
+  for (const ParameterDeclaration & declaration : declarations) {
+    values.push_back(parameters_.at(declaration.name).value);
+  }
+
+  rcl_interfaces::msg::ParameterEvent parameter_event;
+  parameter_event.new_parameters.reserve(initial_parameters.size());
+  for (const rclcpp::Parameter & parameter : initial_parameters) {
+    parameter_event.new_parameters.push_back(parameter.to_parameter_msg());
+  }
+  publish_parameter_event(parameter_event);
+  return values;
 }
 
 void
@@ -638,6 +1111,8 @@ NodeParameters::undeclare_parameter(const std::string & name)
   std::lock_guard<std::recursive_mutex> lock(mutex_);
 
   ParameterMutationRecursionGuard guard(parameter_modification_enabled_);
+  ParameterModificationScope modification_scope(*this);
+  modification_scope.add_parameter_name(name);
 
   auto parameter_info = parameters_.find(name);
   if (parameter_info == parameters_.end()) {
@@ -660,9 +1135,7 @@ NodeParameters::undeclare_parameter(const std::string & name)
 bool
 NodeParameters::has_parameter(const std::string & name) const
 {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
-
-  return __lockless_has_parameter(parameters_, name);
+  return __lockless_has_parameter(*get_parameters_snapshot(), name);
 }
 
 std::vector<rcl_interfaces::msg::SetParametersResult>
@@ -671,6 +1144,11 @@ NodeParameters::set_parameters(const std::vector<rclcpp::Parameter> & parameters
   std::vector<rcl_interfaces::msg::SetParametersResult> results;
   results.reserve(parameters.size());
 
+  // The parameters are set separately, but their changes are published together, after their
+  // snapshot
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  ParameterEventBatch batch(*this);
+  ParameterModificationScope modification_scope(*this);
   for (const auto & p : parameters) {
     auto result = set_parameters_atomically({{p}});
     results.push_back(result);
@@ -697,6 +1175,7 @@ NodeParameters::set_parameters_atomically(const std::vector<rclcpp::Parameter> &
   std::lock_guard<std::recursive_mutex> lock(mutex_);
 
   ParameterMutationRecursionGuard guard(parameter_modification_enabled_);
+  ParameterModificationScope modification_scope(*this);
 
   rcl_interfaces::msg::SetParametersResult result;
 
@@ -714,6 +1193,9 @@ NodeParameters::set_parameters_atomically(const std::vector<rclcpp::Parameter> &
       "pre_set_parameters_callback modifying the original parameters list.";
     return result;
   }
+  for (const auto & parameter : parameters_after_pre_set_callback) {
+    modification_scope.add_parameter_name(parameter.get_name());
+  }
 
   // Check if any of the parameters are read-only, or if any parameters are not
   // declared.
@@ -757,7 +1239,7 @@ NodeParameters::set_parameters_atomically(const std::vector<rclcpp::Parameter> &
   // We will use the staged changes as input to the "set atomically" action.
   // We explicitly avoid calling the user callbacks here, so that it may be called once, with
   // all the other parameters to be set (already declared parameters).
-  std::map<std::string, rclcpp::node_interfaces::ParameterInfo> staged_parameter_changes;
+  ParameterInfos staged_parameter_changes;
   rcl_interfaces::msg::ParameterEvent parameter_event_msg;
   parameter_event_msg.node = combined_name_;
   OnSetCallbacksHandleContainer empty_on_set_callback_container;
@@ -893,23 +1375,43 @@ NodeParameters::set_parameters_atomically(const std::vector<rclcpp::Parameter> &
     parameter_event_msg.changed_parameters.push_back(parameter.to_parameter_msg());
   }
 
-  // Publish if events_publisher_ is not nullptr, which may be if disabled in the constructor.
-  if (nullptr != events_publisher_) {
-    parameter_event_msg.stamp = node_clock_->get_clock()->now();
-    events_publisher_->publish(parameter_event_msg);
-  }
+  publish_parameter_event(parameter_event_msg);
   return result;
 }
 
+RCLCPP_LOCAL
+rclcpp::Parameter
+__get_parameter(
+  const SharedParameterInfos & parameters,
+  const std::string & name,
+  bool allow_undeclared)
+{
+  auto param_iter = parameters.find(name);
+  if (parameters.end() != param_iter) {
+    if (
+      param_iter->second->value.get_type() != rclcpp::ParameterType::PARAMETER_NOT_SET ||
+      param_iter->second->descriptor.dynamic_typing)
+    {
+      return rclcpp::Parameter{name, param_iter->second->value};
+    }
+    throw rclcpp::exceptions::ParameterUninitializedException(name);
+  } else if (allow_undeclared) {
+    return rclcpp::Parameter{name};
+  } else {
+    throw rclcpp::exceptions::ParameterNotDeclaredException(name);
+  }
+}
+
 std::vector<rclcpp::Parameter>
 NodeParameters::get_parameters(const std::vector<std::string> & names) const
 {
   std::vector<rclcpp::Parameter> results;
   results.reserve(names.size());
 
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  // All the parameters are read from the same snapshot
+  const auto parameters = get_parameters_snapshot();
   for (auto & name : names) {
-    results.emplace_back(this->get_parameter(name));
+    results.emplace_back(__get_parameter(*parameters, name, allow_undeclared_));
   }
   return results;
 }
@@ -917,22 +1419,7 @@ NodeParameters::get_parameters(const std::vector<std::string> & names) const
 rclcpp::Parameter
 NodeParameters::get_parameter(const std::string & name) const
 {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
-
-  auto param_iter = parameters_.find(name);
-  if (parameters_.end() != param_iter) {
-    if (
-      param_iter->second.value.get_type() != rclcpp::ParameterType::PARAMETER_NOT_SET ||
-      param_iter->second.descriptor.dynamic_typing)
-    {
-      return rclcpp::Parameter{name, param_iter->second.value};
-    }
-    throw rclcpp::exceptions::ParameterUninitializedException(name);
-  } else if (this->allow_undeclared_) {
-    return rclcpp::Parameter{name};
-  } else {
-    throw rclcpp::exceptions::ParameterNotDeclaredException(name);
-  }
+  return __get_parameter(*get_parameters_snapshot(), name, allow_undeclared_);
 }
 
 bool
@@ -940,14 +1427,14 @@ NodeParameters::get_parameter(
   const std::string & name,
   rclcpp::Parameter & parameter) const
 {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  const auto parameters = get_parameters_snapshot();
 
-  auto param_iter = parameters_.find(name);
+  auto param_iter = parameters->find(name);
   if (
-    parameters_.end() != param_iter &&
-    param_iter->second.value.get_type() != rclcpp::ParameterType::PARAMETER_NOT_SET)
+    parameters->end() != param_iter &&
+    param_iter->second->value.get_type() != rclcpp::ParameterType::PARAMETER_NOT_SET)
   {
-    parameter = {name, param_iter->second.value};
+    parameter = {name, param_iter->second->value};
     return true;
   } else {
     return false;
@@ -959,15 +1446,24 @@ NodeParameters::get_parameters_by_prefix(
   const std::string & prefix,
   std::map<std::string, rclcpp::Parameter> & parameters) const
 {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::shared_ptr<const SharedParameterInfos> parameter_infos;
+  const auto name_index = get_parameter_name_index(parameter_infos);
 
   std::string prefix_with_dot = prefix.empty() ? prefix : prefix + ".";
   bool ret = false;
 
-  for (const auto & param : parameters_) {
-    if (param.first.find(prefix_with_dot) == 0 && param.first.length() > prefix_with_dot.length()) {
+  std::vector<const std::string *> names;
+  if (prefix.empty()) {
+    name_index->get_names(ParameterNameIndex::any_distance, names);
+  } else {
+    name_index->get_names(prefix, ParameterNameIndex::any_distance, names);
+  }
+  for (const std::string * name : names) {
+    // A name ending with the separator is in the namespace of the prefix, but is the prefix
+    if (name->length() > prefix_with_dot.length()) {
       // Found one!
-      parameters[param.first.substr(prefix_with_dot.length())] = rclcpp::Parameter(param.second);
+      parameters[name->substr(prefix_with_dot.length())] =
+        rclcpp::Parameter(*parameter_infos->at(*name));
       ret = true;
     }
   }
@@ -978,14 +1474,14 @@ NodeParameters::get_parameters_by_prefix(
 std::vector<rcl_interfaces::msg::ParameterDescriptor>
 NodeParameters::describe_parameters(const std::vector<std::string> & names) const
 {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  const auto parameters = get_parameters_snapshot();
   std::vector<rcl_interfaces::msg::ParameterDescriptor> results;
   results.reserve(names.size());
 
   for (const auto & name : names) {
-    auto it = parameters_.find(name);
-    if (it != parameters_.cend()) {
-      results.push_back(it->second.descriptor);
+    auto it = parameters->find(name);
+    if (it != parameters->cend()) {
+      results.push_back(it->second->descriptor);
     } else if (allow_undeclared_) {
       // parameter not found, but undeclared allowed, so return empty
       rcl_interfaces::msg::ParameterDescriptor default_description;
@@ -1006,14 +1502,14 @@ NodeParameters::describe_parameters(const std::vector<std::string> & names) cons
 std::vector<uint8_t>
 NodeParameters::get_parameter_types(const std::vector<std::string> & names) const
 {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  const auto parameters = get_parameters_snapshot();
   std::vector<uint8_t> results;
   results.reserve(names.size());
 
   for (const auto & name : names) {
-    auto it = parameters_.find(name);
-    if (it != parameters_.cend()) {
-      results.push_back(it->second.value.get_type());
+    auto it = parameters->find(name);
+    if (it != parameters->cend()) {
+      results.push_back(it->second->value.get_type());
     } else if (allow_undeclared_) {
       // parameter not found, but undeclared allowed, so return not set
       results.push_back(rcl_interfaces::msg::ParameterType::PARAMETER_NOT_SET);
@@ -1032,41 +1528,54 @@ NodeParameters::get_parameter_types(const std::vector<std::string> & names) cons
 rcl_interfaces::msg::ListParametersResult
 NodeParameters::list_parameters(const std::vector<std::string> & prefixes, uint64_t depth) const
 {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  std::shared_ptr<const SharedParameterInfos> parameters;
+  const auto name_index = get_parameter_name_index(parameters);
   rcl_interfaces::msg::ListParametersResult result;
 
   // TODO(mikaelarguedas) define parameter separator different from "/" to avoid ambiguity
   // using "." for now
   const char * separator = ".";
-  for (auto & kv : parameters_) {
-    bool get_all = (prefixes.size() == 0) &&
-      ((depth == rcl_interfaces::srv::ListParameters::Request::DEPTH_RECURSIVE) ||
-      (static_cast<uint64_t>(std::count(kv.first.begin(), kv.first.end(), *separator)) < depth));
-    bool prefix_matches = std::any_of(
-      prefixes.cbegin(), prefixes.cend(),
-      [&kv, &depth, &separator](const std::string & prefix) {
-        if (kv.first == prefix) {
-          return true;
-        } else if (kv.first.find(prefix + separator) == 0) {
-          size_t length = prefix.length();
-          std::string substr = kv.first.substr(length);
-          // Cast as unsigned integer to avoid warning
-          return (depth == rcl_interfaces::srv::ListParameters::Request::DEPTH_RECURSIVE) ||
-          (static_cast<uint64_t>(std::count(substr.begin(), substr.end(), *separator)) < depth);
-        }
-        return false;
-      });
-    if (get_all || prefix_matches) {
-      result.names.push_back(kv.first);
-      size_t last_separator = kv.first.find_last_of(separator);
-      if (std::string::npos != last_separator) {
-        std::string prefix = kv.first.substr(0, last_separator);
-        if (
-          std::find(result.prefixes.cbegin(), result.prefixes.cend(), prefix) ==
-          result.prefixes.cend())
-        {
-          result.prefixes.push_back(prefix);
-        }
+  const bool recursive = depth == rcl_interfaces::srv::ListParameters::Request::DEPTH_RECURSIVE;
+  auto to_distance = [recursive](uint64_t distance) {
+      return recursive || distance >= ParameterNameIndex::any_distance ?
+             ParameterNameIndex::any_distance : static_cast<size_t>(distance);
+    };
+
+  // Only the namespaces of the prefixes are visited, down to the depth
+  std::vector<const std::string *> names;
+  if (prefixes.empty()) {
+    // Names with fewer separators than the depth
+    name_index->get_names(to_distance(depth), names);
+  }
+  for (const auto & prefix : prefixes) {
+    if (name_index->contains(prefix)) {
+      names.push_back(&parameters->find(prefix)->first);
+    }
+    // Names with fewer separators than the depth after the prefix, which ends with one
+    if (recursive || depth > 1) {
+      name_index->get_names(prefix, to_distance(depth - 1), names);
+    }
+  }
+
+  // The names are listed in order, once even when matching several prefixes
+  std::sort(
+    names.begin(), names.end(),
+    [](const std::string * lhs, const std::string * rhs) {return *lhs < *rhs;});
+  names.erase(
+    std::unique(
+      names.begin(), names.end(),
+      [](const std::string * lhs, const std::string * rhs) {return *lhs == *rhs;}),
+    names.end());
+
+  result.names.reserve(names.size());
+  std::unordered_set<std::string> listed_prefixes;
+  for (const std::string * name : names) {
+    result.names.push_back(*name);
+    size_t last_separator = name->find_last_of(separator);
+    if (std::string::npos != last_separator) {
+      std::string prefix = name->substr(0, last_separator);
+      if (listed_prefixes.insert(prefix).second) {
+        result.prefixes.push_back(std::move(prefix));
       }
     }
   }
@@ -1173,6 +1682,151 @@ NodeParameters::add_post_set_parameters_callback(
   return handle;
 }
 
+rclcpp::ParameterValueCell::SharedPtr
+NodeParameters::get_parameter_value_cell(const std::string & name)
+{
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+
+  auto parameter_it = parameters_.find(name);
+  if (parameter_it == parameters_.end()) {
+    throw rclcpp::exceptions::ParameterNotDeclaredException(name);
+  }
+  auto & weak_cell = parameter_value_cells_[name];
+  auto cell = weak_cell.lock();
+  if (!cell) {
+    cell = std::make_shared<ParameterValueCell>(name, parameter_it->second.value);
+    weak_cell = cell;
+  }
+  return cell;
+}
+
+void
+NodeParameters::begin_parameter_event_batch()
+{
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  parameter_event_batch_depth_++;
+}
+
+void
+NodeParameters::end_parameter_event_batch()
+{
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  if (0 == parameter_event_batch_depth_) {
+    throw std::runtime_error("no parameter event batch to end");
+  }
+  if (--parameter_event_batch_depth_ > 0) {
+    return;
+  }
+  rcl_interfaces::msg::ParameterEvent parameter_event;
+  std::swap(parameter_event, pending_parameter_event_);
+  publish_parameter_event(parameter_event);
+}
+
+namespace
+{
+
+std::atomic<bool> g_declaration_events_enabled{true};
+
+template<typename ParameterMsgsT>
+auto
+__find_parameter_msg(ParameterMsgsT & parameters, const std::string & name)
+{
+  return std::find_if(
+    parameters.begin(), parameters.end(),
+    [&name](const rcl_interfaces::msg::Parameter & parameter) {return parameter.name == name;});
+}
+
+/// Merge the changes of a parameter event into a pending parameter event.
+void
+__merge_parameter_event(
+  const rcl_interfaces::msg::ParameterEvent & parameter_event,
+  rcl_interfaces::msg::ParameterEvent & pending_parameter_event)
+{
+  for (const auto & parameter : parameter_event.new_parameters) {
+    auto deleted_it =
+      __find_parameter_msg(pending_parameter_event.deleted_parameters, parameter.name);
+    if (deleted_it != pending_parameter_event.deleted_parameters.end()) {
+      // Undeclared and declared again, only its value changed
+      pending_parameter_event.deleted_parameters.erase(deleted_it);
+      pending_parameter_event.changed_parameters.push_back(parameter);
+    } else {
+      pending_parameter_event.new_parameters.push_back(parameter);
+    }
+  }
+  for (const auto & parameter : parameter_event.changed_parameters) {
+    auto new_it = __find_parameter_msg(pending_parameter_event.new_parameters, parameter.name);
+    if (new_it != pending_parameter_event.new_parameters.end()) {
+      *new_it = parameter;
+      continue;
+    }
+    auto changed_it =
+      __find_parameter_msg(pending_parameter_event.changed_parameters, parameter.name);
+    if (changed_it != pending_parameter_event.changed_parameters.end()) {
+      *changed_it = parameter;
+    } else {
+      pending_parameter_event.changed_parameters.push_back(parameter);
+    }
+  }
+  for (const auto & parameter : parameter_event.deleted_parameters) {
+    auto new_it = __find_parameter_msg(pending_parameter_event.new_parameters, parameter.name);
+    if (new_it != pending_parameter_event.new_parameters.end()) {
+      // Declared and undeclared within the batch, it was never published
+      pending_parameter_event.new_parameters.erase(new_it);
+      continue;
+    }
+    auto changed_it =
+      __find_parameter_msg(pending_parameter_event.changed_parameters, parameter.name);
+    if (changed_it != pending_parameter_event.changed_parameters.end()) {
+      pending_parameter_event.changed_parameters.erase(changed_it);
+    }
+    pending_parameter_event.deleted_parameters.push_back(parameter);
+  }
+}
+
+}  // namespace
+
+void
+NodeParameters::publish_parameter_event(rcl_interfaces::msg::ParameterEvent & parameter_event)
+{
+  // Nothing is published if events_publisher_ and shared_publishers_ are nullptr, which may be
+  // if disabled in the constructor.
+  if (nullptr == events_publisher_ && nullptr == shared_publishers_) {
+    return;
+  }
+  if (!g_declaration_events_enabled.load(std::memory_order_relaxed)) {
+    parameter_event.new_parameters.clear();
+  }
+  if (parameter_event_batch_depth_ > 0) {
+    __merge_parameter_event(parameter_event, pending_parameter_event_);
+    return;
+  }
+  if (
+    parameter_event.new_parameters.empty() && parameter_event.changed_parameters.empty() &&
+    parameter_event.deleted_parameters.empty())
+  {
+    return;
+  }
+  parameter_event.node = combined_name_;
+  parameter_event.stamp = node_clock_->get_clock()->now();
+  if (shared_publishers_) {
+    shared_publishers_->publish_parameter_event(parameter_event);
+    return;
+  }
+  events_publisher_->publish(parameter_event);
+}
+
+void
+NodeParameters::set_declaration_events_enabled(bool enabled)
+{
+  g_declaration_events_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool
+NodeParameters::get_declaration_events_enabled()
+{
+  return g_declaration_events_enabled.load(std::memory_order_relaxed);
+}
+
 const std::map<std::string, rclcpp::ParameterValue> &
 NodeParameters::get_parameter_overrides() const
 {
@@ -40,6 +40,10 @@ NodeServices::add_service(
   }
 
   group->add_service(service_base_ptr);
+  auto intra_process_waitable = service_base_ptr->get_intra_process_waitable();
+  if (intra_process_waitable) {
+    group->add_waitable(intra_process_waitable);
+  }
 
   // Notify the executor that a new service was created using the parent Node.
   auto & node_gc = node_base_->get_notify_guard_condition();
@@ -67,6 +71,10 @@ NodeServices::add_client(
   }
 
   group->add_client(client_base_ptr);
+  auto intra_process_waitable = client_base_ptr->get_intra_process_waitable();
+  if (intra_process_waitable) {
+    group->add_waitable(intra_process_waitable);
+  }
 
   // Notify the executor that a new client was created using the parent Node.
   auto & node_gc = node_base_->get_notify_guard_condition();
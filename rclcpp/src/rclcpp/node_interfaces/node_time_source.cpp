@@ -17,6 +17,8 @@
 #include <memory>
 #include <string>
 
+#include "../detail/node_startup_profile.hpp"
+
 using rclcpp::node_interfaces::NodeTimeSource;
 
 NodeTimeSource::NodeTimeSource(
@@ -28,7 +30,9 @@ NodeTimeSource::NodeTimeSource(
   rclcpp::node_interfaces::NodeClockInterface::SharedPtr node_clock,
   rclcpp::node_interfaces::NodeParametersInterface::SharedPtr node_parameters,
   const rclcpp::QoS & qos,
-  bool use_clock_thread)
+  bool use_clock_thread,
+  const rclcpp::ThreadAttributes & clock_thread_attributes,
+  bool use_parameter_events)
 : node_base_(node_base),
   node_topics_(node_topics),
   node_graph_(node_graph),
@@ -38,6 +42,9 @@ NodeTimeSource::NodeTimeSource(
   node_parameters_(node_parameters),
   time_source_(qos, use_clock_thread)
 {
+  rclcpp::detail::NodeStartupPhaseTimer startup_timer(&rclcpp::NodeStartupProfile::time_source);
+  time_source_.set_clock_thread_attributes(clock_thread_attributes);
+  time_source_.set_use_parameter_events(use_parameter_events);
   time_source_.attachNode(
     node_base_,
     node_topics_,
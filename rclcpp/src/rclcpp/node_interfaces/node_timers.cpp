@@ -14,6 +14,7 @@
 
 #include "rclcpp/node_interfaces/node_timers.hpp"
 
+#include <memory>
 #include <string>
 
 #include "tracetools/tracetools.h"
@@ -56,3 +57,13 @@ NodeTimers::add_timer(
     static_cast<const void *>(timer->get_timer_handle().get()),
     static_cast<const void *>(node_base_->get_rcl_node_handle()));
 }
+
+rclcpp::TimerCoalescer::SharedPtr
+NodeTimers::get_timer_coalescer()
+{
+  std::lock_guard<std::mutex> lock(timer_coalescer_mutex_);
+  if (!timer_coalescer_) {
+    timer_coalescer_ = std::make_shared<rclcpp::TimerCoalescer>(node_base_, this);
+  }
+  return timer_coalescer_;
+}
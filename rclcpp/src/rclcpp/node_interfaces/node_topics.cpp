@@ -64,9 +64,10 @@ NodeTopics::add_publisher(
     callback_group = node_base_->get_default_callback_group();
   }
 
-  for (auto & key_event_pair : publisher->get_event_handlers()) {
-    auto publisher_event = key_event_pair.second;
-    callback_group->add_waitable(publisher_event);
+  // A single waitable dispatches all the QoS events of the publisher
+  auto publisher_events = publisher->get_composite_event_handler();
+  if (nullptr != publisher_events) {
+    callback_group->add_waitable(publisher_events);
   }
 
   // Notify the executor that a new publisher was created using the parent Node.
@@ -107,9 +108,10 @@ NodeTopics::add_subscription(
 
   callback_group->add_subscription(subscription);
 
-  for (auto & key_event_pair : subscription->get_event_handlers()) {
-    auto subscription_event = key_event_pair.second;
-    callback_group->add_waitable(subscription_event);
+  // A single waitable dispatches all the QoS events of the subscription
+  auto subscription_events = subscription->get_composite_event_handler();
+  if (nullptr != subscription_events) {
+    callback_group->add_waitable(subscription_events);
   }
 
   auto intra_process_waitable = subscription->get_intra_process_waitable();
@@ -118,6 +120,12 @@ NodeTopics::add_subscription(
     callback_group->add_waitable(intra_process_waitable);
   }
 
+  auto deserialization_waitable = subscription->get_deserialization_waitable();
+  if (nullptr != deserialization_waitable) {
+    // Add to the callback group to be notified about the messages deserialized off-thread.
+    callback_group->add_waitable(deserialization_waitable);
+  }
+
   // Notify the executor that a new subscription was created using the parent Node.
   auto & node_gc = node_base_->get_notify_guard_condition();
   try {
@@ -71,15 +71,22 @@ NodeOptions::operator=(const NodeOptions & other)
     this->context_ = other.context_;
     this->arguments_ = other.arguments_;
     this->parameter_overrides_ = other.parameter_overrides_;
+    this->parameter_state_ = other.parameter_state_;
+    this->entity_handoff_ = other.entity_handoff_;
     this->use_global_arguments_ = other.use_global_arguments_;
     this->enable_rosout_ = other.enable_rosout_;
     this->use_intra_process_comms_ = other.use_intra_process_comms_;
     this->enable_topic_statistics_ = other.enable_topic_statistics_;
+    this->use_graph_cache_ = other.use_graph_cache_;
     this->start_parameter_services_ = other.start_parameter_services_;
     this->start_parameter_event_publisher_ = other.start_parameter_event_publisher_;
+    this->start_lifecycle_services_ = other.start_lifecycle_services_;
+    this->lightweight_ = other.lightweight_;
+    this->use_shared_publishers_ = other.use_shared_publishers_;
     this->clock_type_ = other.clock_type_;
     this->clock_qos_ = other.clock_qos_;
     this->use_clock_thread_ = other.use_clock_thread_;
+    this->clock_thread_attributes_ = other.clock_thread_attributes_;
     this->parameter_event_qos_ = other.parameter_event_qos_;
     this->rosout_qos_ = other.rosout_qos_;
     this->parameter_event_publisher_options_ = other.parameter_event_publisher_options_;
@@ -100,7 +107,8 @@ NodeOptions::get_rcl_node_options() const
     *node_options_ = rcl_node_get_default_options();
     node_options_->allocator = this->allocator_;
     node_options_->use_global_arguments = this->use_global_arguments_;
-    node_options_->enable_rosout = this->enable_rosout_;
+    // With the shared publishers the log messages aren't published by rcl
+    node_options_->enable_rosout = this->enable_rosout_ && !this->use_shared_publishers_;
     node_options_->rosout_qos = this->rosout_qos_.get_rmw_qos_profile();
 
     int c_argc = 0;
@@ -181,6 +189,32 @@ NodeOptions::parameter_overrides(const std::vector<rclcpp::Parameter> & paramete
   return *this;
 }
 
+const std::vector<uint8_t> &
+NodeOptions::parameter_state() const
+{
+  return this->parameter_state_;
+}
+
+NodeOptions &
+NodeOptions::parameter_state(const std::vector<uint8_t> & parameter_state)
+{
+  this->parameter_state_ = parameter_state;
+  return *this;
+}
+
+const std::shared_ptr<rclcpp::EntityHandoff> &
+NodeOptions::entity_handoff() const
+{
+  return this->entity_handoff_;
+}
+
+NodeOptions &
+NodeOptions::entity_handoff(std::shared_ptr<rclcpp::EntityHandoff> entity_handoff)
+{
+  this->entity_handoff_ = std::move(entity_handoff);
+  return *this;
+}
+
 bool
 NodeOptions::use_global_arguments() const
 {
@@ -235,6 +269,19 @@ NodeOptions::enable_topic_statistics(bool enable_topic_statistics)
   return *this;
 }
 
+bool
+NodeOptions::use_graph_cache() const
+{
+  return this->use_graph_cache_;
+}
+
+NodeOptions &
+NodeOptions::use_graph_cache(bool use_graph_cache)
+{
+  this->use_graph_cache_ = use_graph_cache;
+  return *this;
+}
+
 bool
 NodeOptions::start_parameter_services() const
 {
@@ -248,6 +295,19 @@ NodeOptions::start_parameter_services(bool start_parameter_services)
   return *this;
 }
 
+bool
+NodeOptions::start_lifecycle_services() const
+{
+  return this->start_lifecycle_services_;
+}
+
+NodeOptions &
+NodeOptions::start_lifecycle_services(bool start_lifecycle_services)
+{
+  this->start_lifecycle_services_ = start_lifecycle_services;
+  return *this;
+}
+
 bool
 NodeOptions::start_parameter_event_publisher() const
 {
@@ -261,6 +321,38 @@ NodeOptions::start_parameter_event_publisher(bool start_parameter_event_publishe
   return *this;
 }
 
+bool
+NodeOptions::lightweight() const
+{
+  return this->lightweight_;
+}
+
+NodeOptions &
+NodeOptions::lightweight(bool lightweight)
+{
+  this->lightweight_ = lightweight;
+  if (lightweight) {
+    this->start_parameter_services(false);
+    this->start_parameter_event_publisher(false);
+    this->enable_rosout(false);
+  }
+  return *this;
+}
+
+bool
+NodeOptions::use_shared_publishers() const
+{
+  return this->use_shared_publishers_;
+}
+
+NodeOptions &
+NodeOptions::use_shared_publishers(bool use_shared_publishers)
+{
+  this->node_options_.reset();  // reset node options to make it be recreated on next access.
+  this->use_shared_publishers_ = use_shared_publishers;
+  return *this;
+}
+
 const rcl_clock_type_t &
 NodeOptions::clock_type() const
 {
@@ -300,6 +392,19 @@ NodeOptions::use_clock_thread(bool use_clock_thread)
   return *this;
 }
 
+const rclcpp::ThreadAttributes &
+NodeOptions::clock_thread_attributes() const
+{
+  return this->clock_thread_attributes_;
+}
+
+NodeOptions &
+NodeOptions::clock_thread_attributes(const rclcpp::ThreadAttributes & clock_thread_attributes)
+{
+  this->clock_thread_attributes_ = clock_thread_attributes;
+  return *this;
+}
+
 const rclcpp::QoS &
 NodeOptions::parameter_event_qos() const
 {
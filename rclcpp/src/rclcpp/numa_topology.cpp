@@ -0,0 +1,220 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/numa_topology.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using rclcpp::NumaTopology;
+
+namespace
+{
+
+#if defined(__linux__)
+// From linux/mempolicy.h, which isn't available everywhere.
+constexpr unsigned long kMpolFNode = 1;  // NOLINT(runtime/int)
+constexpr unsigned long kMpolFAddr = 2;  // NOLINT(runtime/int)
+
+/// Read the first line of a file, or return an empty string if it can't be read.
+std::string
+read_line(const std::string & path)
+{
+  std::ifstream file(path);
+  std::string line;
+  std::getline(file, line);
+  return line;
+}
+#endif
+
+std::vector<std::vector<size_t>>
+discover_host_node_cpus()
+{
+  std::vector<std::vector<size_t>> node_cpus;
+#if defined(__linux__)
+  try {
+    const std::string online = read_line("/sys/devices/system/node/online");
+    if (!online.empty()) {
+      // Nodes are indexed by their id, offline nodes and nodes made of memory only have no CPU
+      for (size_t node : NumaTopology::parse_cpu_list(online)) {
+        const std::string cpu_list = read_line(
+          "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        if (node >= node_cpus.size()) {
+          node_cpus.resize(node + 1);
+        }
+        node_cpus[node] = NumaTopology::parse_cpu_list(cpu_list);
+      }
+    }
+  } catch (const std::invalid_argument &) {
+    node_cpus.clear();
+  }
+#endif
+  const bool has_cpus = std::any_of(
+    node_cpus.begin(), node_cpus.end(),
+    [](const std::vector<size_t> & cpus) {return !cpus.empty();});
+  if (!has_cpus) {
+    node_cpus.clear();
+    std::vector<size_t> cpus(std::max(std::thread::hardware_concurrency(), 1U));
+    for (size_t cpu = 0; cpu < cpus.size(); ++cpu) {
+      cpus[cpu] = cpu;
+    }
+    node_cpus.push_back(std::move(cpus));
+  }
+  return node_cpus;
+}
+
+}  // namespace
+
+NumaTopology::NumaTopology(std::vector<std::vector<size_t>> node_cpus)
+: node_cpus_(std::move(node_cpus))
+{
+  for (size_t node = 0; node < node_cpus_.size(); ++node) {
+    if (!node_cpus_[node].empty()) {
+      cpu_node_ids_.push_back(node);
+    }
+    for (size_t cpu : node_cpus_[node]) {
+      if (cpu >= cpu_nodes_.size()) {
+        cpu_nodes_.resize(cpu + 1, unknown);
+      }
+      cpu_nodes_[cpu] = node;
+    }
+  }
+  if (cpu_node_ids_.empty()) {
+    throw std::invalid_argument("NUMA topology requires at least one node with CPUs");
+  }
+}
+
+const NumaTopology &
+NumaTopology::get_host_topology()
+{
+  static const NumaTopology topology(discover_host_node_cpus());
+  return topology;
+}
+
+std::vector<size_t>
+NumaTopology::parse_cpu_list(const std::string & cpu_list)
+{
+  std::vector<size_t> cpus;
+  size_t position = 0;
+  auto parse_number = [&cpu_list, &position]() {
+      const size_t start = position;
+      while (position < cpu_list.size() && cpu_list[position] >= '0' &&
+        cpu_list[position] <= '9')
+      {
+        ++position;
+      }
+      if (position == start) {
+        throw std::invalid_argument("malformed CPU list '" + cpu_list + "'");
+      }
+      return static_cast<size_t>(std::stoul(cpu_list.substr(start, position - start)));
+    };
+  while (position < cpu_list.size() && cpu_list[position] != '\n') {
+    const size_t first = parse_number();
+    size_t last = first;
+    if (position < cpu_list.size() && cpu_list[position] == '-') {
+      ++position;
+      last = parse_number();
+      if (last < first) {
+        throw std::invalid_argument("malformed CPU list '" + cpu_list + "'");
+      }
+    }
+    for (size_t cpu = first; cpu <= last; ++cpu) {
+      cpus.push_back(cpu);
+    }
+    if (position < cpu_list.size() && cpu_list[position] == ',') {
+      ++position;
+    }
+  }
+  return cpus;
+}
+
+size_t
+NumaTopology::get_number_of_nodes() const
+{
+  return node_cpus_.size();
+}
+
+const std::vector<size_t> &
+NumaTopology::get_node_cpus(size_t node) const
+{
+  return node_cpus_.at(node);
+}
+
+size_t
+NumaTopology::get_node_of_cpu(size_t cpu) const
+{
+  return cpu < cpu_nodes_.size() ? cpu_nodes_[cpu] : unknown;
+}
+
+size_t
+NumaTopology::get_current_node() const
+{
+#if defined(__linux__)
+  const int cpu = sched_getcpu();
+  if (cpu >= 0) {
+    return get_node_of_cpu(static_cast<size_t>(cpu));
+  }
+#endif
+  return unknown;
+}
+
+size_t
+NumaTopology::get_node_of_address(const void * address)
+{
+#if defined(__linux__) && defined(SYS_get_mempolicy)
+  int node = -1;
+  if (
+    syscall(
+      SYS_get_mempolicy, &node, nullptr, 0UL, const_cast<void *>(address),
+      kMpolFNode | kMpolFAddr) == 0 && node >= 0)
+  {
+    return static_cast<size_t>(node);
+  }
+#else
+  (void)address;
+#endif
+  return unknown;
+}
+
+std::vector<size_t>
+NumaTopology::get_worker_nodes(size_t number_of_workers) const
+{
+  std::vector<size_t> worker_nodes(number_of_workers);
+  for (size_t worker = 0; worker < number_of_workers; ++worker) {
+    worker_nodes[worker] = cpu_node_ids_[worker * cpu_node_ids_.size() / number_of_workers];
+  }
+  return worker_nodes;
+}
+
+std::vector<rclcpp::ThreadAttributes>
+NumaTopology::make_worker_thread_attributes(size_t number_of_workers) const
+{
+  std::vector<rclcpp::ThreadAttributes> attributes(number_of_workers);
+  const std::vector<size_t> worker_nodes = get_worker_nodes(number_of_workers);
+  for (size_t worker = 0; worker < number_of_workers; ++worker) {
+    attributes[worker].cpu_set = node_cpus_[worker_nodes[worker]];
+  }
+  return attributes;
+}
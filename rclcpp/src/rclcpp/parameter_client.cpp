@@ -386,6 +386,18 @@ AsyncParametersClient::wait_for_service_nanoseconds(std::chrono::nanoseconds tim
   return true;
 }
 
+size_t
+AsyncParametersClient::prune_requests_older_than(std::chrono::system_clock::time_point time_point)
+{
+  return
+    get_parameters_client_->prune_requests_older_than(time_point) +
+    get_parameter_types_client_->prune_requests_older_than(time_point) +
+    set_parameters_client_->prune_requests_older_than(time_point) +
+    set_parameters_atomically_client_->prune_requests_older_than(time_point) +
+    list_parameters_client_->prune_requests_older_than(time_point) +
+    describe_parameters_client_->prune_requests_older_than(time_point);
+}
+
 std::vector<rclcpp::Parameter>
 SyncParametersClient::get_parameters(
   const std::vector<std::string> & parameter_names,
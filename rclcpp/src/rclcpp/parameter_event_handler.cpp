@@ -13,9 +13,11 @@
 // limitations under the License.
 
 #include <functional>
+#include <list>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -33,6 +35,7 @@ ParameterEventHandler::add_parameter_event_callback(
   auto handle = std::make_shared<ParameterEventCallbackHandle>();
   handle->callback = callback;
   callbacks_->event_callbacks_.emplace_front(handle);
+  update_content_filter();
 
   return handle;
 }
@@ -50,6 +53,7 @@ ParameterEventHandler::remove_parameter_event_callback(
     });
   if (it != callbacks_->event_callbacks_.end()) {
     callbacks_->event_callbacks_.erase(it);
+    update_content_filter();
   } else {
     throw std::runtime_error("Callback doesn't exist");
   }
@@ -69,7 +73,12 @@ ParameterEventHandler::add_parameter_callback(
   handle->parameter_name = parameter_name;
   handle->node_name = full_node_name;
   // the last callback registered is executed first.
-  callbacks_->parameter_callbacks_[{parameter_name, full_node_name}].emplace_front(handle);
+  auto & container = callbacks_->parameter_callbacks_[{parameter_name, full_node_name}];
+  if (container.empty()) {
+    callbacks_->parameter_callback_nodes_[full_node_name]++;
+  }
+  container.emplace_front(handle);
+  update_content_filter();
 
   return handle;
 }
@@ -80,7 +89,12 @@ ParameterEventHandler::remove_parameter_callback(
 {
   std::lock_guard<std::recursive_mutex> lock(callbacks_->mutex_);
   auto handle = callback_handle.get();
-  auto & container = callbacks_->parameter_callbacks_[{handle->parameter_name, handle->node_name}];
+  auto container_it =
+    callbacks_->parameter_callbacks_.find({handle->parameter_name, handle->node_name});
+  if (container_it == callbacks_->parameter_callbacks_.end()) {
+    throw std::runtime_error("Callback doesn't exist");
+  }
+  auto & container = container_it->second;
   auto it = std::find_if(
     container.begin(),
     container.end(),
@@ -90,7 +104,12 @@ ParameterEventHandler::remove_parameter_callback(
   if (it != container.end()) {
     container.erase(it);
     if (container.empty()) {
-      callbacks_->parameter_callbacks_.erase({handle->parameter_name, handle->node_name});
+      callbacks_->parameter_callbacks_.erase(container_it);
+      auto node_it = callbacks_->parameter_callback_nodes_.find(handle->node_name);
+      if (--node_it->second == 0) {
+        callbacks_->parameter_callback_nodes_.erase(node_it);
+      }
+      update_content_filter();
     }
   } else {
     throw std::runtime_error("Callback doesn't exist");
@@ -166,30 +185,94 @@ ParameterEventHandler::Callbacks::event_callback(const rcl_interfaces::msg::Para
 {
   std::lock_guard<std::recursive_mutex> lock(mutex_);
 
-  for (auto it = parameter_callbacks_.begin(); it != parameter_callbacks_.end(); ++it) {
-    rclcpp::Parameter p;
-    if (get_parameter_from_event(event, p, it->first.first, it->first.second)) {
-      for (auto cb = it->second.begin(); cb != it->second.end(); ++cb) {
-        auto shared_handle = cb->lock();
-        if (nullptr != shared_handle) {
-          shared_handle->callback(p);
-        } else {
-          cb = it->second.erase(cb);
+  // Only the callbacks of the parameters of the event are looked up
+  if (parameter_callback_nodes_.find(event.node) != parameter_callback_nodes_.end()) {
+    std::pair<std::string, std::string> key{std::string(), event.node};
+    std::unordered_set<std::string> new_parameter_names;
+    auto call_parameter_callbacks = [this, &key](const rcl_interfaces::msg::Parameter & msg) {
+        key.first = msg.name;
+        auto it = parameter_callbacks_.find(key);
+        if (it == parameter_callbacks_.end()) {
+          return;
+        }
+        const auto p = rclcpp::Parameter::from_parameter_msg(msg);
+        for (auto cb = it->second.begin(); cb != it->second.end(); ) {
+          auto shared_handle = cb->lock();
+          if (nullptr != shared_handle) {
+            shared_handle->callback(p);
+            ++cb;
+          } else {
+            cb = it->second.erase(cb);
+          }
         }
+      };
+    for (const auto & new_parameter : event.new_parameters) {
+      if (!event.changed_parameters.empty()) {
+        new_parameter_names.insert(new_parameter.name);
+      }
+      call_parameter_callbacks(new_parameter);
+    }
+    for (const auto & changed_parameter : event.changed_parameters) {
+      // Like get_parameter_from_event(), a new parameter hides a changed one
+      if (new_parameter_names.count(changed_parameter.name) == 0) {
+        call_parameter_callbacks(changed_parameter);
       }
     }
   }
 
-  for (auto event_cb = event_callbacks_.begin(); event_cb != event_callbacks_.end(); ++event_cb) {
+  for (auto event_cb = event_callbacks_.begin(); event_cb != event_callbacks_.end(); ) {
     auto shared_event_handle = event_cb->lock();
     if (nullptr != shared_event_handle) {
       shared_event_handle->callback(event);
+      ++event_cb;
     } else {
       event_cb = event_callbacks_.erase(event_cb);
     }
   }
 }
 
+rclcpp::ContentFilterOptions
+ParameterEventHandler::get_content_filter(const std::vector<std::string> & node_names)
+{
+  // This is the maximum number of expression parameters
+  constexpr size_t max_node_names = 100;
+
+  rclcpp::ContentFilterOptions options;
+  if (node_names.empty() || node_names.size() > max_node_names) {
+    // The node names are never empty
+    options.filter_expression = "node <> %0";
+    options.expression_parameters.push_back("''");
+    return options;
+  }
+  for (size_t i = 0; i < node_names.size(); ++i) {
+    if (i > 0) {
+      options.filter_expression += " OR ";
+    }
+    options.filter_expression += "node = %" + std::to_string(i);
+    options.expression_parameters.push_back("'" + node_names[i] + "'");
+  }
+  return options;
+}
+
+void
+ParameterEventHandler::update_content_filter()
+{
+  if (!event_subscription_ || !event_subscription_->is_content_filter_enabled()) {
+    return;
+  }
+  std::vector<std::string> node_names;
+  // The event callbacks receive the events of all the nodes
+  if (callbacks_->event_callbacks_.empty()) {
+    node_names.reserve(callbacks_->parameter_callback_nodes_.size());
+    for (const auto & node : callbacks_->parameter_callback_nodes_) {
+      node_names.push_back(node.first);
+    }
+  }
+  const auto options = get_content_filter(node_names);
+  event_subscription_->set_content_filter(
+    options.filter_expression, options.expression_parameters);
+}
+
 std::string
 ParameterEventHandler::resolve_path(const std::string & path)
 {
@@ -0,0 +1,73 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "rclcpp/parameter_handle.hpp"
+
+#include <cstring>
+#include <memory>
+#include <string>
+
+using rclcpp::ParameterValueCell;
+
+ParameterValueCell::ParameterValueCell(
+  const std::string & name,
+  const rclcpp::ParameterValue & value)
+: name_(name)
+{
+  store(value);
+}
+
+const std::string &
+ParameterValueCell::get_name() const
+{
+  return name_;
+}
+
+std::shared_ptr<const rclcpp::ParameterValue>
+ParameterValueCell::get_value() const
+{
+  return std::atomic_load(&value_);
+}
+
+void
+ParameterValueCell::store(const rclcpp::ParameterValue & value)
+{
+  auto shared_value = std::make_shared<const rclcpp::ParameterValue>(value);
+  uint64_t bits = 0;
+  switch (value.get_type()) {
+    case ParameterType::PARAMETER_BOOL:
+      bits = value.get<bool>() ? 1u : 0u;
+      break;
+    case ParameterType::PARAMETER_INTEGER:
+      bits = static_cast<uint64_t>(value.get<int64_t>());
+      break;
+    case ParameterType::PARAMETER_DOUBLE:
+      {
+        const double double_value = value.get<double>();
+        std::memcpy(&bits, &double_value, sizeof(bits));
+      }
+      break;
+    default:
+      break;
+  }
+
+  const uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+  sequence_.store(sequence + 1, std::memory_order_relaxed);
+  // Released, the words are seen with the odd sequence stored before them
+  scalar_type_.store(static_cast<uint8_t>(value.get_type()), std::memory_order_release);
+  scalar_bits_.store(bits, std::memory_order_release);
+  std::atomic_store(&value_, std::shared_ptr<const rclcpp::ParameterValue>(shared_value));
+  sequence_.store(sequence + 2, std::memory_order_release);
+}
@@ -12,8 +12,13 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-#include <string>
+#include <filesystem>
+#include <memory>
+#include <mutex>
 #include <regex>
+#include <string>
+#include <system_error>
+#include <utility>
 #include <vector>
 
 #include "rcpputils/find_and_replace.hpp"
@@ -22,18 +27,32 @@
 
 using rclcpp::exceptions::InvalidParametersException;
 using rclcpp::exceptions::InvalidParameterValueException;
+using rclcpp::ParameterFileCache;
 using rclcpp::ParameterMap;
 using rclcpp::ParameterValue;
 
-static bool is_node_name_matched(const std::string & node_name, const char * node_fqn)
+static bool has_wildcard(const std::string & node_name)
+{
+  return std::string::npos != node_name.find('*');
+}
+
+static std::regex node_name_regex(const std::string & node_name)
 {
   // Update the regular expression ["/*" -> "(/\\w+)" and "/**" -> "(/\\w+)*"]
-  std::string regex = rcpputils::find_and_replace(node_name, "/*", "(/\\w+)");
-  return std::regex_match(node_fqn, std::regex(regex));
+  return std::regex(rcpputils::find_and_replace(node_name, "/*", "(/\\w+)"));
 }
 
-ParameterMap
-rclcpp::parameter_map_from(const rcl_params_t * const c_params, const char * node_fqn)
+static bool is_node_name_matched(const std::string & node_name, const char * node_fqn)
+{
+  // Node names only contain alphanumerics, underscores and slashes, so without wildcards the
+  // regular expression would only match the same name
+  if (!has_wildcard(node_name)) {
+    return node_name == node_fqn;
+  }
+  return std::regex_match(node_fqn, node_name_regex(node_name));
+}
+
+static void check_params(const rcl_params_t * const c_params)
 {
   if (NULL == c_params) {
     throw InvalidParametersException("parameters struct is NULL");
@@ -42,22 +61,53 @@ rclcpp::parameter_map_from(const rcl_params_t * const c_params, const char * nod
   } else if (NULL == c_params->params) {
     throw InvalidParametersException("node params array is NULL");
   }
+}
+
+static std::string get_node_name(const rcl_params_t * const c_params, size_t n)
+{
+  const char * c_node_name = c_params->node_names[n];
+  if (NULL == c_node_name) {
+    throw InvalidParametersException("Node name at index " + std::to_string(n) + " is NULL");
+  }
+
+  /// make sure there is a leading slash on the fully qualified node name
+  std::string node_name("/");
+  if ('/' != c_node_name[0]) {
+    node_name += c_node_name;
+  } else {
+    node_name = c_node_name;
+  }
+  return node_name;
+}
+
+static void append_node_parameters(
+  const rcl_params_t * const c_params, size_t n, std::vector<rclcpp::Parameter> & params_node)
+{
+  const rcl_node_params_t * const c_params_node = &(c_params->params[n]);
+
+  params_node.reserve(params_node.size() + c_params_node->num_params);
+
+  for (size_t p = 0; p < c_params_node->num_params; ++p) {
+    const char * const c_param_name = c_params_node->parameter_names[p];
+    if (NULL == c_param_name) {
+      std::string message(
+        "At node " + std::to_string(n) + " parameter " + std::to_string(p) + " name is NULL");
+      throw InvalidParametersException(message);
+    }
+    const rcl_variant_t * const c_param_value = &(c_params_node->parameter_values[p]);
+    params_node.emplace_back(c_param_name, rclcpp::parameter_value_from(c_param_value));
+  }
+}
+
+ParameterMap
+rclcpp::parameter_map_from(const rcl_params_t * const c_params, const char * node_fqn)
+{
+  check_params(c_params);
 
   // Convert c structs into a list of parameters to set
   ParameterMap parameters;
   for (size_t n = 0; n < c_params->num_nodes; ++n) {
-    const char * c_node_name = c_params->node_names[n];
-    if (NULL == c_node_name) {
-      throw InvalidParametersException("Node name at index " + std::to_string(n) + " is NULL");
-    }
-
-    /// make sure there is a leading slash on the fully qualified node name
-    std::string node_name("/");
-    if ('/' != c_node_name[0]) {
-      node_name += c_node_name;
-    } else {
-      node_name = c_node_name;
-    }
+    std::string node_name = get_node_name(c_params, n);
 
     if (node_fqn) {
       if (!is_node_name_matched(node_name, node_fqn)) {
@@ -68,21 +118,7 @@ rclcpp::parameter_map_from(const rcl_params_t * const c_params, const char * nod
       node_name = node_fqn;
     }
 
-    const rcl_node_params_t * const c_params_node = &(c_params->params[n]);
-
-    std::vector<Parameter> & params_node = parameters[node_name];
-    params_node.reserve(c_params_node->num_params);
-
-    for (size_t p = 0; p < c_params_node->num_params; ++p) {
-      const char * const c_param_name = c_params_node->parameter_names[p];
-      if (NULL == c_param_name) {
-        std::string message(
-          "At node " + std::to_string(n) + " parameter " + std::to_string(p) + " name is NULL");
-        throw InvalidParametersException(message);
-      }
-      const rcl_variant_t * const c_param_value = &(c_params_node->parameter_values[p]);
-      params_node.emplace_back(c_param_name, parameter_value_from(c_param_value));
-    }
+    append_node_parameters(c_params, n, parameters[node_name]);
   }
 
   return parameters;
@@ -150,15 +186,7 @@ rclcpp::parameter_value_from(const rcl_variant_t * const c_param_value)
 ParameterMap
 rclcpp::parameter_map_from_yaml_file(const std::string & yaml_filename, const char * node_fqn)
 {
-  rcutils_allocator_t allocator = rcutils_get_default_allocator();
-  rcl_params_t * rcl_parameters = rcl_yaml_node_struct_init(allocator);
-  RCPPUTILS_SCOPE_EXIT(rcl_yaml_node_struct_fini(rcl_parameters); );
-  const char * path = yaml_filename.c_str();
-  if (!rcl_parse_yaml_file(path, rcl_parameters)) {
-    rclcpp::exceptions::throw_from_rcl_error(RCL_RET_ERROR);
-  }
-
-  return rclcpp::parameter_map_from(rcl_parameters, node_fqn);
+  return ParameterFileCache::get_global_instance().get_parameter_map(yaml_filename, node_fqn);
 }
 
 std::vector<rclcpp::Parameter>
@@ -176,3 +204,186 @@ rclcpp::parameters_from_map(const ParameterMap & parameter_map, const char * nod
 
   return parameters;
 }
+
+namespace
+{
+
+/// Identify a version of a file, invalid when the file status can't be read.
+struct FileStamp
+{
+  bool valid = false;
+  std::filesystem::file_time_type write_time;
+  std::uintmax_t size = 0;
+
+  bool operator==(const FileStamp & other) const
+  {
+    return valid && other.valid && write_time == other.write_time && size == other.size;
+  }
+};
+
+FileStamp
+get_file_stamp(const std::string & yaml_filename)
+{
+  FileStamp stamp;
+  std::error_code time_error;
+  std::error_code size_error;
+  stamp.write_time = std::filesystem::last_write_time(yaml_filename, time_error);
+  stamp.size = std::filesystem::file_size(yaml_filename, size_error);
+  stamp.valid = !time_error && !size_error;
+  return stamp;
+}
+
+}  // namespace
+
+class ParameterFileCache::ParsedFile
+{
+public:
+  ParsedFile(const std::string & yaml_filename, const FileStamp & stamp)
+  : c_params_(
+      rcl_yaml_node_struct_init(rcutils_get_default_allocator()), rcl_yaml_node_struct_fini),
+    stamp_(stamp)
+  {
+    if (!c_params_) {
+      throw std::bad_alloc();
+    }
+    if (!rcl_parse_yaml_file(yaml_filename.c_str(), c_params_.get())) {
+      rclcpp::exceptions::throw_from_rcl_error(RCL_RET_ERROR);
+    }
+    check_params(c_params_.get());
+    entries_.resize(c_params_->num_nodes);
+    for (size_t n = 0; n < entries_.size(); ++n) {
+      entries_[n].node_name = get_node_name(c_params_.get(), n);
+      if (has_wildcard(entries_[n].node_name)) {
+        entries_[n].regex = std::make_unique<std::regex>(node_name_regex(entries_[n].node_name));
+      }
+    }
+  }
+
+  const FileStamp &
+  get_stamp() const
+  {
+    return stamp_;
+  }
+
+  /// Get the parameters of the entries matching the node, nullptr if none does.
+  std::shared_ptr<const std::vector<rclcpp::Parameter>>
+  get_node_parameters(const std::string & node_fqn)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = node_parameters_.find(node_fqn);
+    if (it != node_parameters_.end()) {
+      return it->second;
+    }
+    std::shared_ptr<std::vector<rclcpp::Parameter>> parameters;
+    for (size_t n = 0; n < entries_.size(); ++n) {
+      const Entry & entry = entries_[n];
+      if (entry.regex ? !std::regex_match(node_fqn, *entry.regex) : entry.node_name != node_fqn) {
+        continue;
+      }
+      if (!parameters) {
+        parameters = std::make_shared<std::vector<rclcpp::Parameter>>();
+      }
+      append_node_parameters(c_params_.get(), n, *parameters);
+    }
+    node_parameters_.emplace(node_fqn, parameters);
+    return parameters;
+  }
+
+  ParameterMap
+  get_parameter_map()
+  {
+    ParameterMap parameters;
+    for (size_t n = 0; n < entries_.size(); ++n) {
+      append_node_parameters(c_params_.get(), n, parameters[entries_[n].node_name]);
+    }
+    return parameters;
+  }
+
+private:
+  struct Entry
+  {
+    std::string node_name;
+    /// Only compiled for the node names with wildcards.
+    std::unique_ptr<std::regex> regex;
+  };
+
+  std::unique_ptr<rcl_params_t, decltype(&rcl_yaml_node_struct_fini)> c_params_;
+  const FileStamp stamp_;
+  std::vector<Entry> entries_;
+  std::mutex mutex_;
+  std::unordered_map<
+    std::string, std::shared_ptr<const std::vector<rclcpp::Parameter>>> node_parameters_;
+};
+
+ParameterFileCache::ParameterFileCache() = default;
+
+ParameterFileCache::~ParameterFileCache() = default;
+
+ParameterFileCache &
+ParameterFileCache::get_global_instance()
+{
+  static ParameterFileCache cache;
+  return cache;
+}
+
+std::shared_ptr<ParameterFileCache::ParsedFile>
+ParameterFileCache::get_parsed_file(const std::string & yaml_filename)
+{
+  const FileStamp stamp = get_file_stamp(yaml_filename);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = files_.find(yaml_filename);
+    if (it != files_.end() && it->second->get_stamp() == stamp) {
+      return it->second;
+    }
+  }
+
+  // Parse without holding the lock, other files can be loaded meanwhile
+  auto parsed_file = std::make_shared<ParsedFile>(yaml_filename, stamp);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (stamp.valid) {
+    files_[yaml_filename] = parsed_file;
+  } else {
+    files_.erase(yaml_filename);
+  }
+  return parsed_file;
+}
+
+std::vector<rclcpp::Parameter>
+ParameterFileCache::get_parameters(const std::string & yaml_filename, const std::string & node_fqn)
+{
+  auto parameters = get_parsed_file(yaml_filename)->get_node_parameters(node_fqn);
+  if (!parameters) {
+    return {};
+  }
+  return *parameters;
+}
+
+ParameterMap
+ParameterFileCache::get_parameter_map(const std::string & yaml_filename, const char * node_fqn)
+{
+  auto parsed_file = get_parsed_file(yaml_filename);
+  if (!node_fqn) {
+    return parsed_file->get_parameter_map();
+  }
+  ParameterMap parameters;
+  auto node_parameters = parsed_file->get_node_parameters(node_fqn);
+  if (node_parameters) {
+    parameters.emplace(node_fqn, *node_parameters);
+  }
+  return parameters;
+}
+
+void
+ParameterFileCache::clear()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  files_.clear();
+}
+
+size_t
+ParameterFileCache::get_file_count() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return files_.size();
+}
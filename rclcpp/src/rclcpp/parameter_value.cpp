@@ -14,7 +14,9 @@
 
 #include "rclcpp/parameter_value.hpp"
 
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 using rclcpp::ParameterType;
@@ -108,134 +110,293 @@ rclcpp::to_string(const ParameterValue & value)
   }
 }
 
-ParameterValue::ParameterValue()
+namespace
+{
+
+using ValueMessage = rcl_interfaces::msg::ParameterValue;
+
+/// Return the storage shared by the values which aren't arrays.
+const std::shared_ptr<const ValueMessage> &
+not_set_storage()
 {
-  value_.type = rcl_interfaces::msg::ParameterType::PARAMETER_NOT_SET;
+  // The values not set are the most common, e.g. the default ones, they share one storage
+  static const std::shared_ptr<const ValueMessage> not_set = std::make_shared<ValueMessage>();
+  return not_set;
 }
 
-ParameterValue::ParameterValue(const rcl_interfaces::msg::ParameterValue & value)
+/// Return the shared storage of an array, set by the given function.
+template<typename SetT>
+std::shared_ptr<const ValueMessage>
+make_array_value(SetT && set)
 {
-  value_ = value;
-  switch (value.type) {
-    case PARAMETER_BOOL:
-    case PARAMETER_INTEGER:
-    case PARAMETER_DOUBLE:
-    case PARAMETER_STRING:
-    case PARAMETER_BYTE_ARRAY:
-    case PARAMETER_BOOL_ARRAY:
-    case PARAMETER_INTEGER_ARRAY:
-    case PARAMETER_DOUBLE_ARRAY:
-    case PARAMETER_STRING_ARRAY:
-    case PARAMETER_NOT_SET:
+  auto value = std::make_shared<ValueMessage>();
+  set(*value);
+  return value;
+}
+
+bool
+is_array_type(uint8_t type)
+{
+  switch (type) {
+    case rclcpp::PARAMETER_BYTE_ARRAY:
+    case rclcpp::PARAMETER_BOOL_ARRAY:
+    case rclcpp::PARAMETER_INTEGER_ARRAY:
+    case rclcpp::PARAMETER_DOUBLE_ARRAY:
+    case rclcpp::PARAMETER_STRING_ARRAY:
+      return true;
+    default:
+      return false;
+  }
+}
+
+void
+check_type(uint8_t type)
+{
+  switch (type) {
+    case rclcpp::PARAMETER_BOOL:
+    case rclcpp::PARAMETER_INTEGER:
+    case rclcpp::PARAMETER_DOUBLE:
+    case rclcpp::PARAMETER_STRING:
+    case rclcpp::PARAMETER_BYTE_ARRAY:
+    case rclcpp::PARAMETER_BOOL_ARRAY:
+    case rclcpp::PARAMETER_INTEGER_ARRAY:
+    case rclcpp::PARAMETER_DOUBLE_ARRAY:
+    case rclcpp::PARAMETER_STRING_ARRAY:
+    case rclcpp::PARAMETER_NOT_SET:
       break;
     default:
       // TODO(wjwwood): use custom exception
-      throw std::runtime_error("Unknown type: " + std::to_string(value.type));
+      throw std::runtime_error("Unknown type: " + std::to_string(type));
   }
 }
 
-ParameterValue::ParameterValue(const bool bool_value)
+}  // namespace
+
+ParameterValue::ParameterValue()
+: array_value_(not_set_storage())
+{}
+
+ParameterValue::ParameterValue(const rcl_interfaces::msg::ParameterValue & value)
+: ParameterValue(rcl_interfaces::msg::ParameterValue(value))
+{}
+
+ParameterValue::ParameterValue(rcl_interfaces::msg::ParameterValue && value)
 {
-  value_.bool_value = bool_value;
-  value_.type = rcl_interfaces::msg::ParameterType::PARAMETER_BOOL;
+  check_type(value.type);
+  type_ = value.type;
+  bool_value_ = value.bool_value;
+  integer_value_ = value.integer_value;
+  double_value_ = value.double_value;
+  string_value_ = std::move(value.string_value);
+  if (is_array_type(type_)) {
+    array_value_ = std::make_shared<const ValueMessage>(std::move(value));
+  } else {
+    array_value_ = not_set_storage();
+  }
 }
 
+ParameterValue::ParameterValue(const bool bool_value)
+: type_(rcl_interfaces::msg::ParameterType::PARAMETER_BOOL),
+  bool_value_(bool_value),
+  array_value_(not_set_storage())
+{}
+
 ParameterValue::ParameterValue(const int int_value)
-{
-  value_.integer_value = int_value;
-  value_.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER;
-}
+: ParameterValue(static_cast<int64_t>(int_value))
+{}
 
 ParameterValue::ParameterValue(const int64_t int_value)
-{
-  value_.integer_value = int_value;
-  value_.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER;
-}
+: type_(rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER),
+  integer_value_(int_value),
+  array_value_(not_set_storage())
+{}
 
 ParameterValue::ParameterValue(const float double_value)
-{
-  value_.double_value = static_cast<double>(double_value);
-  value_.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
-}
+: ParameterValue(static_cast<double>(double_value))
+{}
 
 ParameterValue::ParameterValue(const double double_value)
-{
-  value_.double_value = double_value;
-  value_.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
-}
+: type_(rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE),
+  double_value_(double_value),
+  array_value_(not_set_storage())
+{}
 
 ParameterValue::ParameterValue(const std::string & string_value)
-{
-  value_.string_value = string_value;
-  value_.type = rcl_interfaces::msg::ParameterType::PARAMETER_STRING;
-}
+: ParameterValue(std::string(string_value))
+{}
+
+ParameterValue::ParameterValue(std::string && string_value)
+: type_(rcl_interfaces::msg::ParameterType::PARAMETER_STRING),
+  string_value_(std::move(string_value)),
+  array_value_(not_set_storage())
+{}
 
 ParameterValue::ParameterValue(const char * string_value)
 : ParameterValue(std::string(string_value))
 {}
 
 ParameterValue::ParameterValue(const std::vector<uint8_t> & byte_array_value)
-{
-  value_.byte_array_value = byte_array_value;
-  value_.type = rcl_interfaces::msg::ParameterType::PARAMETER_BYTE_ARRAY;
-}
+: ParameterValue(std::vector<uint8_t>(byte_array_value))
+{}
+
+ParameterValue::ParameterValue(std::vector<uint8_t> && byte_array_value)
+: type_(rcl_interfaces::msg::ParameterType::PARAMETER_BYTE_ARRAY),
+  array_value_(make_array_value(
+      [&byte_array_value](ValueMessage & value) {
+        value.byte_array_value = std::move(byte_array_value);
+      }))
+{}
 
 ParameterValue::ParameterValue(const std::vector<bool> & bool_array_value)
-{
-  value_.bool_array_value = bool_array_value;
-  value_.type = rcl_interfaces::msg::ParameterType::PARAMETER_BOOL_ARRAY;
-}
+: ParameterValue(std::vector<bool>(bool_array_value))
+{}
+
+ParameterValue::ParameterValue(std::vector<bool> && bool_array_value)
+: type_(rcl_interfaces::msg::ParameterType::PARAMETER_BOOL_ARRAY),
+  array_value_(make_array_value(
+      [&bool_array_value](ValueMessage & value) {
+        value.bool_array_value = std::move(bool_array_value);
+      }))
+{}
 
 ParameterValue::ParameterValue(const std::vector<int> & int_array_value)
-{
-  value_.integer_array_value.assign(int_array_value.cbegin(), int_array_value.cend());
-  value_.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER_ARRAY;
-}
+: ParameterValue(std::vector<int64_t>(int_array_value.cbegin(), int_array_value.cend()))
+{}
 
 ParameterValue::ParameterValue(const std::vector<int64_t> & int_array_value)
-{
-  value_.integer_array_value = int_array_value;
-  value_.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER_ARRAY;
-}
+: ParameterValue(std::vector<int64_t>(int_array_value))
+{}
+
+ParameterValue::ParameterValue(std::vector<int64_t> && int_array_value)
+: type_(rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER_ARRAY),
+  array_value_(make_array_value(
+      [&int_array_value](ValueMessage & value) {
+        value.integer_array_value = std::move(int_array_value);
+      }))
+{}
 
 ParameterValue::ParameterValue(const std::vector<float> & float_array_value)
+: ParameterValue(std::vector<double>(float_array_value.cbegin(), float_array_value.cend()))
+{}
+
+ParameterValue::ParameterValue(const std::vector<double> & double_array_value)
+: ParameterValue(std::vector<double>(double_array_value))
+{}
+
+ParameterValue::ParameterValue(std::vector<double> && double_array_value)
+: type_(rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE_ARRAY),
+  array_value_(make_array_value(
+      [&double_array_value](ValueMessage & value) {
+        value.double_array_value = std::move(double_array_value);
+      }))
+{}
+
+ParameterValue::ParameterValue(const std::vector<std::string> & string_array_value)
+: ParameterValue(std::vector<std::string>(string_array_value))
+{}
+
+ParameterValue::ParameterValue(std::vector<std::string> && string_array_value)
+: type_(rcl_interfaces::msg::ParameterType::PARAMETER_STRING_ARRAY),
+  array_value_(make_array_value(
+      [&string_array_value](ValueMessage & value) {
+        value.string_array_value = std::move(string_array_value);
+      }))
+{}
+
+ParameterValue::ParameterValue(ParameterValue && other) noexcept
+: type_(other.type_),
+  bool_value_(other.bool_value_),
+  integer_value_(other.integer_value_),
+  double_value_(other.double_value_),
+  string_value_(std::move(other.string_value_)),
+  array_value_(std::move(other.array_value_))
 {
-  value_.double_array_value.assign(float_array_value.cbegin(), float_array_value.cend());
-  value_.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE_ARRAY;
+  // The implicit move would leave the storage of the other value null
+  other.reset();
 }
 
-ParameterValue::ParameterValue(const std::vector<double> & double_array_value)
+ParameterValue &
+ParameterValue::operator=(ParameterValue && other) noexcept
 {
-  value_.double_array_value = double_array_value;
-  value_.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE_ARRAY;
+  if (this != &other) {
+    type_ = other.type_;
+    bool_value_ = other.bool_value_;
+    integer_value_ = other.integer_value_;
+    double_value_ = other.double_value_;
+    string_value_ = std::move(other.string_value_);
+    array_value_ = std::move(other.array_value_);
+    other.reset();
+  }
+  return *this;
 }
 
-ParameterValue::ParameterValue(const std::vector<std::string> & string_array_value)
+void
+ParameterValue::reset() noexcept
 {
-  value_.string_array_value = string_array_value;
-  value_.type = rcl_interfaces::msg::ParameterType::PARAMETER_STRING_ARRAY;
+  type_ = rcl_interfaces::msg::ParameterType::PARAMETER_NOT_SET;
+  bool_value_ = false;
+  integer_value_ = 0;
+  double_value_ = 0.0;
+  string_value_.clear();
+  array_value_ = not_set_storage();
 }
 
 ParameterType
 ParameterValue::get_type() const
 {
-  return static_cast<ParameterType>(value_.type);
+  return static_cast<ParameterType>(type_);
 }
 
 rcl_interfaces::msg::ParameterValue
 ParameterValue::to_value_msg() const
 {
-  return value_;
+  // Copies the array of an array type, the storage of the other types is empty
+  rcl_interfaces::msg::ParameterValue value = *array_value_;
+  value.type = type_;
+  value.bool_value = bool_value_;
+  value.integer_value = integer_value_;
+  value.double_value = double_value_;
+  value.string_value = string_value_;
+  return value;
 }
 
 bool
 ParameterValue::operator==(const ParameterValue & rhs) const
 {
-  return this->value_ == rhs.value_;
+  if (this->type_ != rhs.type_) {
+    return false;
+  }
+  // The copies share the storage of their arrays
+  const bool shared = this->array_value_ == rhs.array_value_;
+  switch (this->type_) {
+    case rclcpp::PARAMETER_BOOL:
+      return this->bool_value_ == rhs.bool_value_;
+    case rclcpp::PARAMETER_INTEGER:
+      return this->integer_value_ == rhs.integer_value_;
+    case rclcpp::PARAMETER_DOUBLE:
+      return this->double_value_ == rhs.double_value_;
+    case rclcpp::PARAMETER_STRING:
+      return this->string_value_ == rhs.string_value_;
+    case rclcpp::PARAMETER_BYTE_ARRAY:
+      return shared || this->array_value_->byte_array_value == rhs.array_value_->byte_array_value;
+    case rclcpp::PARAMETER_BOOL_ARRAY:
+      return shared || this->array_value_->bool_array_value == rhs.array_value_->bool_array_value;
+    case rclcpp::PARAMETER_INTEGER_ARRAY:
+      return shared ||
+             this->array_value_->integer_array_value == rhs.array_value_->integer_array_value;
+    case rclcpp::PARAMETER_DOUBLE_ARRAY:
+      return shared ||
+             this->array_value_->double_array_value == rhs.array_value_->double_array_value;
+    case rclcpp::PARAMETER_STRING_ARRAY:
+      return shared ||
+             this->array_value_->string_array_value == rhs.array_value_->string_array_value;
+    default:
+      return true;
+  }
 }
 
 bool
 ParameterValue::operator!=(const ParameterValue & rhs) const
 {
-  return this->value_ != rhs.value_;
+  return !(*this == rhs);
 }
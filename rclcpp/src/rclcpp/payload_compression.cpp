@@ -0,0 +1,409 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "rclcpp/payload_compression.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace rclcpp
+{
+
+namespace
+{
+
+// LZ4 block format, see https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md
+constexpr size_t lz4_min_match = 4;
+// The last match starts at least 12 bytes before the end, the last 5 bytes are literals
+constexpr size_t lz4_match_start_limit = 12;
+constexpr size_t lz4_last_literals = 5;
+constexpr size_t lz4_max_offset = 65535;
+constexpr unsigned int lz4_hash_log = 12;
+
+inline uint32_t
+read_uint32(const uint8_t * data)
+{
+  uint32_t value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+inline uint32_t
+hash_position(const uint8_t * data)
+{
+  return (read_uint32(data) * 2654435761u) >> (32 - lz4_hash_log);
+}
+
+inline uint8_t *
+write_length(uint8_t * output, size_t length)
+{
+  for (; length >= 255; length -= 255) {
+    *output++ = 255;
+  }
+  *output++ = static_cast<uint8_t>(length);
+  return output;
+}
+
+uint8_t *
+write_sequence(
+  uint8_t * output, const uint8_t * literals, size_t literal_length,
+  size_t offset, size_t match_length)
+{
+  uint8_t * token = output++;
+  *token = static_cast<uint8_t>(std::min<size_t>(literal_length, 15) << 4);
+  if (literal_length >= 15) {
+    output = write_length(output, literal_length - 15);
+  }
+  if (literal_length > 0) {
+    std::memcpy(output, literals, literal_length);
+    output += literal_length;
+  }
+  if (0 == match_length) {
+    return output;
+  }
+  *output++ = static_cast<uint8_t>(offset & 0xff);
+  *output++ = static_cast<uint8_t>(offset >> 8);
+  const size_t length = match_length - lz4_min_match;
+  *token |= static_cast<uint8_t>(std::min<size_t>(length, 15));
+  if (length >= 15) {
+    output = write_length(output, length - 15);
+  }
+  return output;
+}
+
+bool
+read_length(const uint8_t * input, size_t size, size_t & position, size_t & length)
+{
+  uint8_t byte;
+  do {
+    if (position >= size) {
+      return false;
+    }
+    byte = input[position++];
+    length += byte;
+  } while (255 == byte);
+  return true;
+}
+
+// The header of the compressed payloads: magic, encoding length, encoding, uncompressed size.
+// A serialized message starts with the encapsulation kind, whose first byte is always zero.
+constexpr uint8_t payload_magic[4] = {'R', 'C', 'Z', 1};
+constexpr size_t payload_size_length = 8;
+
+struct PayloadHeader
+{
+  std::string encoding;
+  uint64_t uncompressed_size;
+  size_t header_length;
+};
+
+PayloadHeader
+read_payload_header(const rcl_serialized_message_t & serialized_message)
+{
+  const uint8_t * buffer = serialized_message.buffer;
+  const size_t length = serialized_message.buffer_length;
+  if (!PayloadDecompressor::is_compressed(serialized_message) ||
+    length < sizeof(payload_magic) + 1)
+  {
+    throw std::runtime_error("serialized message isn't compressed");
+  }
+  const size_t encoding_length = buffer[sizeof(payload_magic)];
+  const size_t header_length = sizeof(payload_magic) + 1 + encoding_length + payload_size_length;
+  if (length < header_length) {
+    throw std::runtime_error("compressed serialized message is truncated");
+  }
+  PayloadHeader header;
+  header.encoding.assign(
+    reinterpret_cast<const char *>(buffer + sizeof(payload_magic) + 1), encoding_length);
+  header.uncompressed_size = 0;
+  const uint8_t * size = buffer + header_length - payload_size_length;
+  for (size_t i = 0; i < payload_size_length; ++i) {
+    header.uncompressed_size |= static_cast<uint64_t>(size[i]) << (8 * i);
+  }
+  header.header_length = header_length;
+  return header;
+}
+
+class PayloadCodecRegistry
+{
+public:
+  PayloadCodecRegistry()
+  {
+    codecs_["lz4"] = std::make_shared<LZ4PayloadCodec>();
+  }
+
+  std::mutex mutex_;
+  std::map<std::string, PayloadCodec::SharedPtr> codecs_;
+};
+
+PayloadCodecRegistry &
+get_registry()
+{
+  static PayloadCodecRegistry registry;
+  return registry;
+}
+
+}  // namespace
+
+PayloadCodec::~PayloadCodec() = default;
+
+std::string
+LZ4PayloadCodec::get_encoding() const
+{
+  return "lz4";
+}
+
+int
+LZ4PayloadCodec::get_default_level() const
+{
+  return 1;
+}
+
+size_t
+LZ4PayloadCodec::get_max_compressed_size(size_t size) const
+{
+  return size + size / 255 + 16;
+}
+
+size_t
+LZ4PayloadCodec::compress(
+  const uint8_t * input, size_t size, uint8_t * output, size_t capacity, int level) const
+{
+  if (capacity < get_max_compressed_size(size)) {
+    throw std::invalid_argument("the output buffer is smaller than the maximum compressed size");
+  }
+  // Higher levels skip ahead more slowly through the data without matches
+  const unsigned int skip_strength = 5u + static_cast<unsigned int>(std::clamp(level, 1, 9));
+  uint8_t * const output_begin = output;
+  size_t anchor = 0;
+  if (size > lz4_match_start_limit) {
+    uint32_t table[1u << lz4_hash_log] = {};
+    const size_t match_start_limit = size - lz4_match_start_limit;
+    const size_t match_end_limit = size - lz4_last_literals;
+    size_t position = 1;
+    while (position < match_start_limit) {
+      const uint32_t hash = hash_position(input + position);
+      size_t reference = table[hash];
+      table[hash] = static_cast<uint32_t>(position);
+      if (reference >= position || position - reference > lz4_max_offset ||
+        read_uint32(input + reference) != read_uint32(input + position))
+      {
+        position += 1 + ((position - anchor) >> skip_strength);
+        continue;
+      }
+      while (position > anchor && reference > 0 && input[position - 1] == input[reference - 1]) {
+        --position;
+        --reference;
+      }
+      size_t match_length = lz4_min_match;
+      while (position + match_length < match_end_limit &&
+        input[position + match_length] == input[reference + match_length])
+      {
+        ++match_length;
+      }
+      output = write_sequence(
+        output, input + anchor, position - anchor, position - reference, match_length);
+      position += match_length;
+      anchor = position;
+      if (position < match_start_limit) {
+        table[hash_position(input + position - 2)] = static_cast<uint32_t>(position - 2);
+      }
+    }
+  }
+  output = write_sequence(output, input + anchor, size - anchor, 0, 0);
+  return static_cast<size_t>(output - output_begin);
+}
+
+void
+LZ4PayloadCodec::decompress(
+  const uint8_t * input, size_t size, uint8_t * output, size_t output_size) const
+{
+  size_t position = 0;
+  size_t output_position = 0;
+  for (;;) {
+    if (position >= size) {
+      throw std::runtime_error("lz4 payload is truncated");
+    }
+    const uint8_t token = input[position++];
+    size_t literal_length = token >> 4;
+    if (15 == literal_length && !read_length(input, size, position, literal_length)) {
+      throw std::runtime_error("lz4 payload is truncated");
+    }
+    if (literal_length > size - position || literal_length > output_size - output_position) {
+      throw std::runtime_error("lz4 payload is corrupted");
+    }
+    if (literal_length > 0) {
+      std::memcpy(output + output_position, input + position, literal_length);
+    }
+    position += literal_length;
+    output_position += literal_length;
+    if (position == size) {
+      break;
+    }
+    if (size - position < 2) {
+      throw std::runtime_error("lz4 payload is truncated");
+    }
+    const size_t offset = input[position] | (static_cast<size_t>(input[position + 1]) << 8);
+    position += 2;
+    if (0 == offset || offset > output_position) {
+      throw std::runtime_error("lz4 payload is corrupted");
+    }
+    size_t match_length = token & 0x0f;
+    if (15 == match_length && !read_length(input, size, position, match_length)) {
+      throw std::runtime_error("lz4 payload is truncated");
+    }
+    match_length += lz4_min_match;
+    if (match_length > output_size - output_position) {
+      throw std::runtime_error("lz4 payload is corrupted");
+    }
+    // The match may overlap the bytes it produces, so it's copied byte by byte
+    const uint8_t * match = output + output_position - offset;
+    uint8_t * destination = output + output_position;
+    for (size_t i = 0; i < match_length; ++i) {
+      destination[i] = match[i];
+    }
+    output_position += match_length;
+  }
+  if (output_position != output_size) {
+    throw std::runtime_error("lz4 payload doesn't have the expected size");
+  }
+}
+
+void
+register_payload_codec(PayloadCodec::SharedPtr codec)
+{
+  if (!codec) {
+    throw std::invalid_argument("payload codec is null");
+  }
+  std::string encoding = codec->get_encoding();
+  if (encoding.empty() || encoding.size() > 255) {
+    throw std::invalid_argument("payload codec encoding must have 1 to 255 characters");
+  }
+  auto & registry = get_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex_);
+  registry.codecs_[std::move(encoding)] = std::move(codec);
+}
+
+PayloadCodec::SharedPtr
+get_payload_codec(const std::string & encoding)
+{
+  auto & registry = get_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex_);
+  auto it = registry.codecs_.find(encoding);
+  if (it == registry.codecs_.end()) {
+    return nullptr;
+  }
+  return it->second;
+}
+
+PayloadCompressor::PayloadCompressor(const PayloadCompressionOptions & options)
+: options_(options),
+  codec_(get_payload_codec(options.encoding))
+{
+  if (!codec_) {
+    throw std::invalid_argument(
+            "no payload codec is registered for the encoding '" + options.encoding + "'");
+  }
+}
+
+std::shared_ptr<rclcpp::SerializedMessage>
+PayloadCompressor::compress(const rcl_serialized_message_t & serialized_message)
+{
+  const size_t size = serialized_message.buffer_length;
+  if (size < options_.min_size || 0u == size) {
+    return nullptr;
+  }
+  const std::string encoding = codec_->get_encoding();
+  const size_t header_length =
+    sizeof(payload_magic) + 1 + encoding.size() + payload_size_length;
+  auto message = pool_.acquire(header_length + codec_->get_max_compressed_size(size));
+  auto & rcl_message = message->get_rcl_serialized_message();
+
+  uint8_t * header = rcl_message.buffer;
+  std::memcpy(header, payload_magic, sizeof(payload_magic));
+  header[sizeof(payload_magic)] = static_cast<uint8_t>(encoding.size());
+  std::memcpy(header + sizeof(payload_magic) + 1, encoding.data(), encoding.size());
+  uint8_t * size_bytes = header + header_length - payload_size_length;
+  for (size_t i = 0; i < payload_size_length; ++i) {
+    size_bytes[i] = static_cast<uint8_t>(static_cast<uint64_t>(size) >> (8 * i));
+  }
+
+  const int level = 0 == options_.level ? codec_->get_default_level() : options_.level;
+  const size_t compressed_size = codec_->compress(
+    serialized_message.buffer, size, rcl_message.buffer + header_length,
+    rcl_message.buffer_capacity - header_length, level);
+  if (header_length + compressed_size >= size) {
+    // Incompressible data is published as is, the subscriptions don't need to copy it then
+    pool_.release(message);
+    return nullptr;
+  }
+  rcl_message.buffer_length = header_length + compressed_size;
+  return message;
+}
+
+void
+PayloadCompressor::release(std::shared_ptr<rclcpp::SerializedMessage> & message)
+{
+  pool_.release(message);
+}
+
+PayloadCodec::SharedPtr
+PayloadCompressor::get_codec() const
+{
+  return codec_;
+}
+
+PayloadDecompressor::PayloadDecompressor() = default;
+
+bool
+PayloadDecompressor::is_compressed(const rcl_serialized_message_t & serialized_message)
+{
+  return serialized_message.buffer_length >= sizeof(payload_magic) &&
+         0 == std::memcmp(serialized_message.buffer, payload_magic, sizeof(payload_magic));
+}
+
+std::shared_ptr<rclcpp::SerializedMessage>
+PayloadDecompressor::decompress(const rcl_serialized_message_t & serialized_message)
+{
+  const PayloadHeader header = read_payload_header(serialized_message);
+  auto codec = get_payload_codec(header.encoding);
+  if (!codec) {
+    throw std::runtime_error(
+            "no payload codec is registered for the encoding '" + header.encoding + "'");
+  }
+  const size_t uncompressed_size = static_cast<size_t>(header.uncompressed_size);
+  auto message = pool_.acquire(uncompressed_size);
+  auto & rcl_message = message->get_rcl_serialized_message();
+  codec->decompress(
+    serialized_message.buffer + header.header_length,
+    serialized_message.buffer_length - header.header_length,
+    rcl_message.buffer, uncompressed_size);
+  rcl_message.buffer_length = uncompressed_size;
+  return message;
+}
+
+void
+PayloadDecompressor::release(std::shared_ptr<rclcpp::SerializedMessage> & message)
+{
+  pool_.release(message);
+}
+
+}  // namespace rclcpp
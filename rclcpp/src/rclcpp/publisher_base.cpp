@@ -23,6 +23,7 @@
 #include <sstream>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "rcutils/logging_macros.h"
@@ -39,8 +40,37 @@
 #include "rclcpp/node.hpp"
 #include "rclcpp/qos_event.hpp"
 
+#include "./detail/entity_handoff.hpp"
+
 using rclcpp::PublisherBase;
 
+namespace
+{
+
+/// rcl publisher finalized on destruction, with the node it is created on.
+struct RclPublisher
+{
+  explicit RclPublisher(std::shared_ptr<rcl_node_t> node_handle)
+  : node_handle(std::move(node_handle))
+  {}
+
+  ~RclPublisher()
+  {
+    if (rcl_publisher_fini(&handle, node_handle.get()) != RCL_RET_OK) {
+      RCLCPP_ERROR(
+        rclcpp::get_node_logger(node_handle.get()).get_child("rclcpp"),
+        "Error in destruction of rcl publisher handle: %s",
+        rcl_get_error_string().str);
+      rcl_reset_error();
+    }
+  }
+
+  rcl_publisher_t handle = rcl_get_zero_initialized_publisher();
+  const std::shared_ptr<rcl_node_t> node_handle;
+};
+
+}  // namespace
+
 PublisherBase::PublisherBase(
   rclcpp::node_interfaces::NodeBaseInterface * node_base,
   const std::string & topic,
@@ -54,40 +84,33 @@ PublisherBase::PublisherBase(
   type_support_(type_support),
   event_callbacks_(event_callbacks)
 {
-  auto custom_deleter = [node_handle = this->rcl_node_handle_](rcl_publisher_t * rcl_pub)
-    {
-      if (rcl_publisher_fini(rcl_pub, node_handle.get()) != RCL_RET_OK) {
-        RCLCPP_ERROR(
-          rclcpp::get_node_logger(node_handle.get()).get_child("rclcpp"),
-          "Error in destruction of rcl publisher handle: %s",
-          rcl_get_error_string().str);
+  // The publisher of the previous instance of the node is used, if it is handed over
+  publisher_handle_ = rclcpp::detail::take_handed_over_publisher(
+    node_base, topic, type_support, publisher_options);
+  if (!publisher_handle_) {
+    // One allocation for the rcl publisher and the control block of its shared pointer
+    auto rcl_publisher = std::make_shared<RclPublisher>(rcl_node_handle_);
+    publisher_handle_ = std::shared_ptr<rcl_publisher_t>(rcl_publisher, &rcl_publisher->handle);
+
+    rcl_ret_t ret = rcl_publisher_init(
+      publisher_handle_.get(),
+      rcl_node_handle_.get(),
+      &type_support,
+      topic.c_str(),
+      &publisher_options);
+    if (ret != RCL_RET_OK) {
+      if (ret == RCL_RET_TOPIC_NAME_INVALID) {
+        auto rcl_node_handle = rcl_node_handle_.get();
+        // this will throw on any validation problem
         rcl_reset_error();
+        expand_topic_or_service_name(
+          topic,
+          rcl_node_get_name(rcl_node_handle),
+          rcl_node_get_namespace(rcl_node_handle));
       }
-      delete rcl_pub;
-    };
-
-  publisher_handle_ = std::shared_ptr<rcl_publisher_t>(
-    new rcl_publisher_t, custom_deleter);
-  *publisher_handle_.get() = rcl_get_zero_initialized_publisher();
 
-  rcl_ret_t ret = rcl_publisher_init(
-    publisher_handle_.get(),
-    rcl_node_handle_.get(),
-    &type_support,
-    topic.c_str(),
-    &publisher_options);
-  if (ret != RCL_RET_OK) {
-    if (ret == RCL_RET_TOPIC_NAME_INVALID) {
-      auto rcl_node_handle = rcl_node_handle_.get();
-      // this will throw on any validation problem
-      rcl_reset_error();
-      expand_topic_or_service_name(
-        topic,
-        rcl_node_get_name(rcl_node_handle),
-        rcl_node_get_namespace(rcl_node_handle));
+      rclcpp::exceptions::throw_from_rcl_error(ret, "could not create publisher");
     }
-
-    rclcpp::exceptions::throw_from_rcl_error(ret, "could not create publisher");
   }
   // Life time of this object is tied to the publisher handle.
   rmw_publisher_t * publisher_rmw_handle = rcl_publisher_get_rmw_handle(publisher_handle_.get());
@@ -108,7 +131,11 @@ PublisherBase::PublisherBase(
 PublisherBase::~PublisherBase()
 {
   // must fini the events before fini-ing the publisher
+  composite_event_handler_.reset();
   event_handlers_.clear();
+  // or before handing it over to the next instance of the node
+  rclcpp::detail::keep_handed_over_publisher(
+    publisher_handle_, rcl_node_handle_.get(), type_support_);
 
   auto ipm = weak_ipm_.lock();
 
@@ -201,6 +228,12 @@ PublisherBase::get_event_handlers() const
   return event_handlers_;
 }
 
+std::shared_ptr<rclcpp::CompositeQOSEventHandler>
+PublisherBase::get_composite_event_handler() const
+{
+  return composite_event_handler_;
+}
+
 size_t
 PublisherBase::get_subscription_count() const
 {
@@ -243,6 +276,47 @@ PublisherBase::get_intra_process_subscription_count() const
   return ipm->get_subscription_count(intra_process_publisher_id_);
 }
 
+bool
+PublisherBase::has_inter_process_subscriptions() const
+{
+  return get_subscription_count() > get_intra_process_subscription_count();
+}
+
+bool
+PublisherBase::has_intra_process_subscriptions() const
+{
+  return get_intra_process_subscription_count() > 0;
+}
+
+bool
+PublisherBase::skips_publish_without_subscriptions() const
+{
+  return skip_publish_without_subscriptions_;
+}
+
+uint64_t
+PublisherBase::get_skipped_publish_count() const
+{
+  return skipped_publish_count_.load(std::memory_order_relaxed);
+}
+
+void
+PublisherBase::set_skip_publish_without_subscriptions(bool skip)
+{
+  skip_publish_without_subscriptions_ =
+    skip && get_actual_qos().durability() == rclcpp::DurabilityPolicy::Volatile;
+}
+
+bool
+PublisherBase::skip_inter_process_publish()
+{
+  if (!skip_publish_without_subscriptions_ || has_inter_process_subscriptions()) {
+    return false;
+  }
+  skipped_publish_count_.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
 rclcpp::QoS
 PublisherBase::get_actual_qos() const
 {
@@ -297,6 +371,19 @@ PublisherBase::setup_intra_process(
   intra_process_is_enabled_ = true;
 }
 
+void
+PublisherBase::set_topic_statistics(
+  rclcpp::topic_statistics::PublisherTopicStatistics::SharedPtr topic_stats)
+{
+  topic_stats_ = std::move(topic_stats);
+}
+
+rclcpp::topic_statistics::PublisherTopicStatistics::SharedPtr
+PublisherBase::get_topic_statistics() const
+{
+  return topic_stats_;
+}
+
 void
 PublisherBase::default_incompatible_qos_callback(
   rclcpp::QOSOfferedIncompatibleQoSInfo & event) const
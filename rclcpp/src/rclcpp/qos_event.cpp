@@ -12,7 +12,12 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <functional>
+#include <memory>
+#include <stdexcept>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "rclcpp/qos_event.hpp"
 
@@ -92,4 +97,115 @@ QOSEventHandlerBase::set_on_new_event_callback(
   }
 }
 
+CompositeQOSEventHandler::~CompositeQOSEventHandler()
+{}
+
+void
+CompositeQOSEventHandler::add_handler(std::shared_ptr<QOSEventHandlerBase> handler)
+{
+  handlers_.push_back(std::move(handler));
+}
+
+const std::vector<std::shared_ptr<QOSEventHandlerBase>> &
+CompositeQOSEventHandler::get_handlers() const
+{
+  return handlers_;
+}
+
+size_t
+CompositeQOSEventHandler::get_number_of_ready_events()
+{
+  size_t number_of_events = 0;
+  for (const auto & handler : handlers_) {
+    number_of_events += handler->get_number_of_ready_events();
+  }
+  return number_of_events;
+}
+
+void
+CompositeQOSEventHandler::add_to_wait_set(rcl_wait_set_t * wait_set)
+{
+  for (const auto & handler : handlers_) {
+    handler->add_to_wait_set(wait_set);
+  }
+}
+
+bool
+CompositeQOSEventHandler::is_ready(rcl_wait_set_t * wait_set)
+{
+  ready_handlers_.clear();
+  for (size_t i = 0; i < handlers_.size(); ++i) {
+    if (handlers_[i]->is_ready(wait_set)) {
+      ready_handlers_.push_back(i);
+    }
+  }
+  return !ready_handlers_.empty();
+}
+
+std::shared_ptr<void>
+CompositeQOSEventHandler::take_data()
+{
+  auto taken_events = std::make_shared<TakenEvents>();
+  taken_events->reserve(ready_handlers_.size());
+  for (size_t index : ready_handlers_) {
+    auto data = handlers_[index]->take_data();
+    if (data) {
+      taken_events->emplace_back(index, std::move(data));
+    }
+  }
+  ready_handlers_.clear();
+  return std::static_pointer_cast<void>(taken_events);
+}
+
+std::shared_ptr<void>
+CompositeQOSEventHandler::take_data_by_entity_id(size_t id)
+{
+  if (id >= handlers_.size()) {
+    throw std::out_of_range("no QOS event handler with the given id");
+  }
+  auto taken_events = std::make_shared<TakenEvents>();
+  auto data = handlers_[id]->take_data();
+  if (data) {
+    taken_events->emplace_back(id, std::move(data));
+  }
+  return std::static_pointer_cast<void>(taken_events);
+}
+
+void
+CompositeQOSEventHandler::execute(std::shared_ptr<void> & data)
+{
+  if (!data) {
+    throw std::runtime_error("'data' is empty");
+  }
+  auto taken_events = std::static_pointer_cast<TakenEvents>(data);
+  for (auto & taken_event : *taken_events) {
+    handlers_[taken_event.first]->execute(taken_event.second);
+  }
+}
+
+void
+CompositeQOSEventHandler::set_on_ready_callback(std::function<void(size_t, int)> callback)
+{
+  if (!callback) {
+    throw std::invalid_argument(
+            "The callback passed to set_on_ready_callback "
+            "is not callable.");
+  }
+  for (size_t i = 0; i < handlers_.size(); ++i) {
+    // Identify the event by the index of its handler, instead of the event entity type
+    handlers_[i]->set_on_ready_callback(
+      [callback, i](size_t number_of_events, int) {
+        callback(number_of_events, static_cast<int>(i));
+      });
+  }
+}
+
+void
+CompositeQOSEventHandler::clear_on_ready_callback()
+{
+  for (const auto & handler : handlers_) {
+    handler->clear_on_ready_callback();
+  }
+}
+
 }  // namespace rclcpp
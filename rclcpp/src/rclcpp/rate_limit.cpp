@@ -0,0 +1,129 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/rate_limit.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+using rclcpp::RateLimiter;
+using rclcpp::RateLimitOptions;
+using rclcpp::RateLimitPolicy;
+
+namespace
+{
+
+int64_t
+to_period_ns(const RateLimitOptions & options)
+{
+  switch (options.policy) {
+    case RateLimitPolicy::Disabled:
+      throw std::invalid_argument("a rate limiter can't be created for a disabled rate limit");
+    case RateLimitPolicy::KeepEveryNth:
+      if (options.keep_every_nth == 0) {
+        throw std::invalid_argument("keep_every_nth must be greater than 0");
+      }
+      return 0;
+    case RateLimitPolicy::MaxFrequency:
+    case RateLimitPolicy::LatestPerInterval:
+      break;
+  }
+  if (!(options.max_frequency > 0.0)) {
+    throw std::invalid_argument("max_frequency must be greater than 0");
+  }
+  return std::llround(1e9 / options.max_frequency);
+}
+
+int64_t
+to_ns(RateLimiter::Clock::time_point time)
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+}  // namespace
+
+RateLimiter::RateLimiter(const RateLimitOptions & options)
+: options_(options),
+  period_ns_(to_period_ns(options))
+{}
+
+bool
+RateLimiter::try_keep(Clock::time_point now)
+{
+  bool kept = false;
+  if (options_.policy == RateLimitPolicy::KeepEveryNth) {
+    kept = message_count_.fetch_add(1) % options_.keep_every_nth == 0;
+  } else {
+    const int64_t now_ns = to_ns(now);
+    int64_t next_due_ns = next_due_ns_.load();
+    while (now_ns >= next_due_ns) {
+      // Only one of the concurrent calls due at the same time keeps its message
+      if (next_due_ns_.compare_exchange_weak(next_due_ns, now_ns + period_ns_)) {
+        kept = true;
+        break;
+      }
+    }
+  }
+  (kept ? kept_count_ : dropped_count_).fetch_add(1, std::memory_order_relaxed);
+  return kept;
+}
+
+bool
+RateLimiter::is_due(Clock::time_point now) const
+{
+  if (options_.policy == RateLimitPolicy::KeepEveryNth) {
+    return message_count_.load() % options_.keep_every_nth == 0;
+  }
+  return to_ns(now) >= next_due_ns_.load();
+}
+
+void
+RateLimiter::on_kept(Clock::time_point now)
+{
+  if (options_.policy == RateLimitPolicy::KeepEveryNth) {
+    message_count_.fetch_add(1);
+  } else {
+    next_due_ns_.store(to_ns(now) + period_ns_);
+  }
+  kept_count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void
+RateLimiter::on_dropped()
+{
+  if (options_.policy == RateLimitPolicy::KeepEveryNth) {
+    message_count_.fetch_add(1);
+  }
+  dropped_count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+const RateLimitOptions &
+RateLimiter::get_options() const
+{
+  return options_;
+}
+
+uint64_t
+RateLimiter::get_kept_count() const
+{
+  return kept_count_.load(std::memory_order_relaxed);
+}
+
+uint64_t
+RateLimiter::get_dropped_count() const
+{
+  return dropped_count_.load(std::memory_order_relaxed);
+}
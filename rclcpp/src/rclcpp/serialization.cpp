@@ -14,7 +14,12 @@
 
 #include "rclcpp/serialization.hpp"
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
 #include <memory>
+#include <stdexcept>
 #include <string>
 
 #include "rclcpp/exceptions.hpp"
@@ -22,8 +27,69 @@
 
 #include "rcpputils/asserts.hpp"
 
+#include "rcutils/error_handling.h"
+
 #include "rmw/rmw.h"
 
+namespace
+{
+
+constexpr size_t kFrameHeaderSize = 8u;
+constexpr size_t kFrameAlignment = 8u;
+
+size_t
+get_frame_size(size_t payload_size)
+{
+  const size_t padded_size =
+    (payload_size + kFrameAlignment - 1) / kFrameAlignment * kFrameAlignment;
+  return kFrameHeaderSize + padded_size;
+}
+
+void
+write_frame_header(uint8_t * header, size_t payload_size)
+{
+  std::memset(header, 0, kFrameHeaderSize);
+  for (size_t i = 0; i < 4u; ++i) {
+    header[i] = static_cast<uint8_t>(payload_size >> (8u * i));
+  }
+}
+
+size_t
+read_frame_header(const uint8_t * header)
+{
+  size_t payload_size = 0u;
+  for (size_t i = 0; i < 4u; ++i) {
+    payload_size |= static_cast<size_t>(header[i]) << (8u * i);
+  }
+  return payload_size;
+}
+
+/// Call the function with the payload of every frame, validating the buffer layout.
+template<typename FunctionT>
+size_t
+for_each_frame(const rcl_serialized_message_t & buffer, FunctionT && function)
+{
+  size_t count = 0u;
+  size_t offset = 0u;
+  while (offset < buffer.buffer_length) {
+    if (buffer.buffer_length - offset < kFrameHeaderSize) {
+      throw std::invalid_argument("Framed buffer is truncated within a frame header.");
+    }
+    const size_t payload_size = read_frame_header(buffer.buffer + offset);
+    if (payload_size == 0u ||
+      get_frame_size(payload_size) > buffer.buffer_length - offset)
+    {
+      throw std::invalid_argument("Framed buffer holds a frame of invalid size.");
+    }
+    function(count, buffer.buffer + offset + kFrameHeaderSize, payload_size);
+    offset += get_frame_size(payload_size);
+    ++count;
+  }
+  return count;
+}
+
+}  // namespace
+
 namespace rclcpp
 {
 
@@ -69,4 +135,116 @@ void SerializationBase::deserialize_message(
   }
 }
 
+void SerializationBase::serialize_messages(
+  const void * const * ros_messages, size_t count,
+  SerializedMessage * serialized_messages) const
+{
+  if (count == 0u) {
+    return;
+  }
+  rcpputils::check_true(nullptr != ros_messages, "ROS messages are nullpointer.");
+  rcpputils::check_true(nullptr != serialized_messages, "Serialized messages are nullpointer.");
+
+  const size_t size_hint = get_serialized_size_hint();
+  for (size_t i = 0; i < count; ++i) {
+    if (serialized_messages[i].capacity() < size_hint) {
+      serialized_messages[i].reserve(size_hint);
+    }
+    serialize_message(ros_messages[i], &serialized_messages[i]);
+  }
+}
+
+void SerializationBase::serialize_messages_framed(
+  const void * const * ros_messages, size_t count,
+  SerializedMessage * serialized_buffer) const
+{
+  rcpputils::check_true(nullptr != serialized_buffer, "Serialized buffer is nullpointer.");
+  rcpputils::check_true(
+    count == 0u || nullptr != ros_messages, "ROS messages are nullpointer.");
+
+  auto & buffer = serialized_buffer->get_rcl_serialized_message();
+  buffer.buffer_length = 0u;
+  if (count == 0u) {
+    return;
+  }
+
+  const size_t size_hint = get_serialized_size_hint();
+  if (size_hint > 0u && buffer.buffer_capacity < count * get_frame_size(size_hint)) {
+    serialized_buffer->reserve(count * get_frame_size(size_hint));
+  }
+
+  // rmw serializes into the start of a serialized message, so each message goes through a
+  // scratch message reused for the whole batch before being appended to the framed buffer
+  SerializedMessage scratch(size_hint, buffer.allocator);
+  for (size_t i = 0; i < count; ++i) {
+    serialize_message(ros_messages[i], &scratch);
+    const size_t payload_size = scratch.size();
+    if (payload_size == 0u || payload_size > std::numeric_limits<uint32_t>::max()) {
+      throw std::invalid_argument("Serialized message size can't be framed.");
+    }
+    const size_t offset = buffer.buffer_length;
+    const size_t frame_size = get_frame_size(payload_size);
+    if (buffer.buffer_capacity - offset < frame_size) {
+      serialized_buffer->reserve(std::max(buffer.buffer_capacity * 2, offset + frame_size));
+    }
+    write_frame_header(buffer.buffer + offset, payload_size);
+    std::memcpy(
+      buffer.buffer + offset + kFrameHeaderSize,
+      scratch.get_rcl_serialized_message().buffer, payload_size);
+    std::memset(
+      buffer.buffer + offset + kFrameHeaderSize + payload_size, 0,
+      frame_size - kFrameHeaderSize - payload_size);
+    buffer.buffer_length = offset + frame_size;
+  }
+}
+
+void SerializationBase::deserialize_messages_framed(
+  const SerializedMessage * serialized_buffer, void * const * ros_messages,
+  size_t count) const
+{
+  rcpputils::check_true(nullptr != type_support_, "Typesupport is nullpointer.");
+  rcpputils::check_true(nullptr != serialized_buffer, "Serialized buffer is nullpointer.");
+  rcpputils::check_true(
+    count == 0u || nullptr != ros_messages, "ROS messages are nullpointer.");
+
+  const auto & buffer = serialized_buffer->get_rcl_serialized_message();
+  if (get_framed_message_count(serialized_buffer) != count) {
+    throw std::invalid_argument("Framed buffer doesn't hold the given number of messages.");
+  }
+  for_each_frame(
+    buffer,
+    [this, &buffer, ros_messages](size_t index, const uint8_t * payload, size_t payload_size) {
+      rcpputils::check_true(nullptr != ros_messages[index], "ROS message is a nullpointer.");
+      // The frame is viewed in place, rmw only reads the view
+      rcl_serialized_message_t frame = buffer;
+      frame.buffer = const_cast<uint8_t *>(payload);
+      frame.buffer_length = payload_size;
+      frame.buffer_capacity = payload_size;
+      const auto ret = rmw_deserialize(&frame, type_support_, ros_messages[index]);
+      if (ret != RMW_RET_OK) {
+        rclcpp::exceptions::throw_from_rcl_error(ret, "Failed to deserialize ROS message.");
+      }
+    });
+}
+
+size_t SerializationBase::get_framed_message_count(const SerializedMessage * serialized_buffer)
+{
+  rcpputils::check_true(nullptr != serialized_buffer, "Serialized buffer is nullpointer.");
+  return for_each_frame(
+    serialized_buffer->get_rcl_serialized_message(),
+    [](size_t, const uint8_t *, size_t) {});
+}
+
+size_t SerializationBase::get_serialized_size_hint() const
+{
+  size_t size = 0u;
+  const auto ret = rmw_get_serialized_message_size(type_support_, nullptr, &size);
+  if (ret != RMW_RET_OK) {
+    // Unbounded types and most rmw implementations don't report a size
+    rcutils_reset_error();
+    return 0u;
+  }
+  return size;
+}
+
 }  // namespace rclcpp
@@ -0,0 +1,93 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/serialized_message_pool.hpp"
+
+#include <memory>
+#include <mutex>
+#include <utility>
+
+using rclcpp::SerializedMessagePool;
+
+SerializedMessagePool::SerializedMessagePool(size_t depth)
+: depth_(depth)
+{
+  free_messages_.reserve(depth_);
+}
+
+std::shared_ptr<rclcpp::SerializedMessage>
+SerializedMessagePool::acquire(size_t capacity)
+{
+  std::shared_ptr<rclcpp::SerializedMessage> message;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (free_messages_.empty()) {
+      allocation_count_++;
+    } else {
+      message = std::move(free_messages_.back());
+      free_messages_.pop_back();
+    }
+  }
+  if (!message) {
+    return std::make_shared<rclcpp::SerializedMessage>(capacity);
+  }
+  if (message->capacity() < capacity) {
+    message->reserve(capacity);
+  }
+  return message;
+}
+
+void
+SerializedMessagePool::release(std::shared_ptr<rclcpp::SerializedMessage> & message)
+{
+  if (!message || message.use_count() != 1) {
+    // Still used elsewhere, it can't be reused
+    message.reset();
+    return;
+  }
+  message->get_rcl_serialized_message().buffer_length = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (free_messages_.size() < depth_) {
+      free_messages_.push_back(std::move(message));
+      return;
+    }
+  }
+  message.reset();
+}
+
+size_t
+SerializedMessagePool::get_free_count() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return free_messages_.size();
+}
+
+size_t
+SerializedMessagePool::get_free_capacity() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t capacity = 0;
+  for (const auto & message : free_messages_) {
+    capacity += message->capacity();
+  }
+  return capacity;
+}
+
+size_t
+SerializedMessagePool::get_allocation_count() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return allocation_count_;
+}
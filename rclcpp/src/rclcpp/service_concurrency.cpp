@@ -0,0 +1,184 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/service_concurrency.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <utility>
+
+using rclcpp::ServiceRequestScheduler;
+using rclcpp::ServiceRequestStatistics;
+
+ServiceRequestScheduler::ServiceRequestScheduler(const ServiceConcurrencyOptions & options)
+: options_(options)
+{
+  if (options_.max_concurrent_requests == 0) {
+    throw std::invalid_argument("max_concurrent_requests must be greater than 0");
+  }
+}
+
+void
+ServiceRequestScheduler::submit(Job job, Job reject_job)
+{
+  Request request{std::move(job), std::move(reject_job), 0, std::chrono::steady_clock::now()};
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (
+      statistics_.running_requests >= options_.max_concurrent_requests &&
+      options_.max_queue_depth > 0 && queue_.size() >= options_.max_queue_depth)
+    {
+      statistics_.rejected_requests++;
+      lock.unlock();
+      // Without a ticket, the rejection isn't held back by the previous responses
+      if (request.reject_job) {
+        auto send = request.reject_job();
+        if (send) {
+          send();
+        }
+      }
+      return;
+    }
+    request.ticket = next_ticket_++;
+    if (statistics_.running_requests >= options_.max_concurrent_requests) {
+      queue_.push_back(std::move(request));
+      statistics_.queue_depth = queue_.size();
+      statistics_.max_queue_depth = std::max(statistics_.max_queue_depth, queue_.size());
+      return;
+    }
+    statistics_.running_requests++;
+  }
+  if (options_.thread_pool) {
+    options_.thread_pool->post(
+      [self = shared_from_this(), request = std::move(request)]() mutable {
+        self->run(std::move(request));
+      });
+    return;
+  }
+  run(std::move(request));
+}
+
+void
+ServiceRequestScheduler::run(Request request)
+{
+  std::exception_ptr exception;
+  for (;;) {
+    const auto start_time = std::chrono::steady_clock::now();
+    const bool expired = options_.max_queue_time > std::chrono::nanoseconds::zero() &&
+      start_time - request.submit_time > options_.max_queue_time;
+    SendResponse send;
+    try {
+      if (!expired) {
+        send = request.job();
+      } else if (request.reject_job) {
+        send = request.reject_job();
+      }
+    } catch (...) {
+      if (!exception) {
+        exception = std::current_exception();
+      }
+    }
+    const auto end_time = std::chrono::steady_clock::now();
+    try {
+      // Sent even without a response, so that the following responses aren't held back
+      send_response(request.ticket, std::move(send));
+    } catch (...) {
+      if (!exception) {
+        exception = std::current_exception();
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (expired) {
+      statistics_.expired_requests++;
+    } else {
+      const auto queue_time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        start_time - request.submit_time);
+      const auto service_time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        end_time - start_time);
+      statistics_.handled_requests++;
+      statistics_.total_queue_time += queue_time;
+      statistics_.max_queue_time = std::max(statistics_.max_queue_time, queue_time);
+      statistics_.total_service_time += service_time;
+      statistics_.max_service_time = std::max(statistics_.max_service_time, service_time);
+    }
+    if (queue_.empty()) {
+      statistics_.running_requests--;
+      break;
+    }
+    request = std::move(queue_.front());
+    queue_.pop_front();
+    statistics_.queue_depth = queue_.size();
+  }
+  if (exception) {
+    std::rethrow_exception(exception);
+  }
+}
+
+void
+ServiceRequestScheduler::send_response(uint64_t ticket, SendResponse send)
+{
+  if (!options_.ordered_responses) {
+    if (send) {
+      send();
+    }
+    return;
+  }
+  std::lock_guard<std::mutex> lock(responses_mutex_);
+  pending_responses_.emplace(ticket, std::move(send));
+  std::exception_ptr exception;
+  for (auto it = pending_responses_.begin();
+    it != pending_responses_.end() && it->first == next_response_ticket_;
+    it = pending_responses_.erase(it))
+  {
+    next_response_ticket_++;
+    if (!it->second) {
+      continue;
+    }
+    try {
+      it->second();
+    } catch (...) {
+      if (!exception) {
+        exception = std::current_exception();
+      }
+    }
+  }
+  if (exception) {
+    std::rethrow_exception(exception);
+  }
+}
+
+const rclcpp::ServiceConcurrencyOptions &
+ServiceRequestScheduler::get_options() const
+{
+  return options_;
+}
+
+ServiceRequestStatistics
+ServiceRequestScheduler::get_statistics() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return statistics_;
+}
+
+void
+ServiceRequestScheduler::reset_statistics()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  ServiceRequestStatistics statistics;
+  statistics.running_requests = statistics_.running_requests;
+  statistics.queue_depth = statistics_.queue_depth;
+  statistics_ = statistics;
+}
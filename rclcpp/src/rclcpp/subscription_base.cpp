@@ -14,10 +14,14 @@
 
 #include "rclcpp/subscription_base.hpp"
 
+#include <chrono>
 #include <cstdio>
 #include <memory>
+#include <optional>
+#include <stdexcept>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "rcpputils/scope_exit.hpp"
@@ -28,12 +32,42 @@
 #include "rclcpp/logging.hpp"
 #include "rclcpp/node_interfaces/node_base_interface.hpp"
 #include "rclcpp/qos_event.hpp"
+#include "rclcpp/serialization.hpp"
+
+#include "./detail/entity_handoff.hpp"
 
 #include "rmw/error_handling.h"
 #include "rmw/rmw.h"
 
 using rclcpp::SubscriptionBase;
 
+namespace
+{
+
+/// rcl subscription finalized on destruction, with the node it is created on.
+struct RclSubscription
+{
+  explicit RclSubscription(std::shared_ptr<rcl_node_t> node_handle)
+  : node_handle(std::move(node_handle))
+  {}
+
+  ~RclSubscription()
+  {
+    if (rcl_subscription_fini(&handle, node_handle.get()) != RCL_RET_OK) {
+      RCLCPP_ERROR(
+        rclcpp::get_node_logger(node_handle.get()).get_child("rclcpp"),
+        "Error in destruction of rcl subscription handle: %s",
+        rcl_get_error_string().str);
+      rcl_reset_error();
+    }
+  }
+
+  rcl_subscription_t handle = rcl_get_zero_initialized_subscription();
+  const std::shared_ptr<rcl_node_t> node_handle;
+};
+
+}  // namespace
+
 SubscriptionBase::SubscriptionBase(
   rclcpp::node_interfaces::NodeBaseInterface * node_base,
   const rosidl_message_type_support_t & type_support_handle,
@@ -51,39 +85,33 @@ SubscriptionBase::SubscriptionBase(
   type_support_(type_support_handle),
   is_serialized_(is_serialized)
 {
-  auto custom_deletor = [node_handle = this->node_handle_](rcl_subscription_t * rcl_subs)
-    {
-      if (rcl_subscription_fini(rcl_subs, node_handle.get()) != RCL_RET_OK) {
-        RCLCPP_ERROR(
-          rclcpp::get_node_logger(node_handle.get()).get_child("rclcpp"),
-          "Error in destruction of rcl subscription handle: %s",
-          rcl_get_error_string().str);
+  // The subscription of the previous instance of the node is used, if it is handed over
+  subscription_handle_ = rclcpp::detail::take_handed_over_subscription(
+    node_base, topic_name, type_support_handle, subscription_options);
+  if (!subscription_handle_) {
+    // One allocation for the rcl subscription and the control block of its shared pointer
+    auto rcl_subscription = std::make_shared<RclSubscription>(node_handle_);
+    subscription_handle_ = std::shared_ptr<rcl_subscription_t>(
+      rcl_subscription, &rcl_subscription->handle);
+
+    rcl_ret_t ret = rcl_subscription_init(
+      subscription_handle_.get(),
+      node_handle_.get(),
+      &type_support_handle,
+      topic_name.c_str(),
+      &subscription_options);
+    if (ret != RCL_RET_OK) {
+      if (ret == RCL_RET_TOPIC_NAME_INVALID) {
+        auto rcl_node_handle = node_handle_.get();
+        // this will throw on any validation problem
         rcl_reset_error();
+        expand_topic_or_service_name(
+          topic_name,
+          rcl_node_get_name(rcl_node_handle),
+          rcl_node_get_namespace(rcl_node_handle));
       }
-      delete rcl_subs;
-    };
-
-  subscription_handle_ = std::shared_ptr<rcl_subscription_t>(
-    new rcl_subscription_t, custom_deletor);
-  *subscription_handle_.get() = rcl_get_zero_initialized_subscription();
-
-  rcl_ret_t ret = rcl_subscription_init(
-    subscription_handle_.get(),
-    node_handle_.get(),
-    &type_support_handle,
-    topic_name.c_str(),
-    &subscription_options);
-  if (ret != RCL_RET_OK) {
-    if (ret == RCL_RET_TOPIC_NAME_INVALID) {
-      auto rcl_node_handle = node_handle_.get();
-      // this will throw on any validation problem
-      rcl_reset_error();
-      expand_topic_or_service_name(
-        topic_name,
-        rcl_node_get_name(rcl_node_handle),
-        rcl_node_get_namespace(rcl_node_handle));
+      rclcpp::exceptions::throw_from_rcl_error(ret, "could not create subscription");
     }
-    rclcpp::exceptions::throw_from_rcl_error(ret, "could not create subscription");
   }
 
   bind_event_callbacks(event_callbacks_, use_default_callbacks);
@@ -91,6 +119,13 @@ SubscriptionBase::SubscriptionBase(
 
 SubscriptionBase::~SubscriptionBase()
 {
+  // A subscription handed over to the next instance of the node must not call this one anymore
+  if (rclcpp::detail::is_handing_over_node(node_handle_.get())) {
+    clear_on_new_message_callback();
+    rclcpp::detail::keep_handed_over_subscription(
+      subscription_handle_, node_handle_.get(), type_support_);
+  }
+
   if (!use_intra_process_) {
     return;
   }
@@ -167,6 +202,12 @@ SubscriptionBase::get_event_handlers() const
   return event_handlers_;
 }
 
+std::shared_ptr<rclcpp::CompositeQOSEventHandler>
+SubscriptionBase::get_composite_event_handler() const
+{
+  return composite_event_handler_;
+}
+
 rclcpp::QoS
 SubscriptionBase::get_actual_qos() const
 {
@@ -183,26 +224,89 @@ SubscriptionBase::get_actual_qos() const
 bool
 SubscriptionBase::take_type_erased(void * message_out, rclcpp::MessageInfo & message_info_out)
 {
-  rcl_ret_t ret = rcl_take(
-    this->get_subscription_handle().get(),
+  if (rate_limiter_) {
+    const RateLimitTake rate_limit_take = take_rate_limited(message_info_out);
+    if (RateLimitTake::Nothing == rate_limit_take) {
+      return false;
+    }
+    if (RateLimitTake::Latest == rate_limit_take) {
+      rclcpp::SerializationBase(&type_support_).deserialize_message(
+        &get_take_buffers().latest_message, message_out);
+      rate_limiter_->on_kept();
+      return true;
+    }
+  }
+  if (std::atomic_load(&inter_process_content_filter_) || max_message_age_.count() > 0) {
+    // The message is filtered, and its age checked, before being deserialized
+    rclcpp::SerializedMessage & filtered_message = get_take_buffers().filtered_message;
+    if (!take_serialized_message(filtered_message, message_info_out)) {
+      return false;
+    }
+    rclcpp::SerializationBase(&type_support_).deserialize_message(
+      &filtered_message, message_out);
+    TRACEPOINT(rclcpp_take, static_cast<const void *>(message_out));
+  } else {
+    rcl_ret_t ret = rcl_take(
+      this->get_subscription_handle().get(),
+      message_out,
+      &message_info_out.get_rmw_message_info(),
+      nullptr  // rmw_subscription_allocation_t is unused here
+    );
+    TRACEPOINT(rclcpp_take, static_cast<const void *>(message_out));
+    if (RCL_RET_SUBSCRIPTION_TAKE_FAILED == ret) {
+      return false;
+    } else if (RCL_RET_OK != ret) {
+      rclcpp::exceptions::throw_from_rcl_error(ret);
+    }
+    if (
+      matches_any_intra_process_publishers(&message_info_out.get_rmw_message_info().publisher_gid))
+    {
+      // In this case, the message will be delivered via intra-process and
+      // we should ignore this copy of the message.
+      return false;
+    }
+  }
+  if (rate_limiter_) {
+    rate_limiter_->on_kept();
+  }
+  return true;
+}
+
+bool
+SubscriptionBase::take_type_erased_without_info(void * message_out)
+{
+  if (
+    rate_limiter_ || std::atomic_load(&inter_process_content_filter_) ||
+    max_message_age_.count() > 0)
+  {
+    // The messages are taken serialized first, with their message info
+    rclcpp::MessageInfo message_info;
+    return take_type_erased(message_out, message_info);
+  }
+  bool taken = false;
+  rmw_ret_t ret = rmw_take(
+    rcl_subscription_get_rmw_handle(subscription_handle_.get()),
     message_out,
-    &message_info_out.get_rmw_message_info(),
+    &taken,
     nullptr  // rmw_subscription_allocation_t is unused here
   );
   TRACEPOINT(rclcpp_take, static_cast<const void *>(message_out));
-  if (RCL_RET_SUBSCRIPTION_TAKE_FAILED == ret) {
-    return false;
-  } else if (RCL_RET_OK != ret) {
+  if (RMW_RET_OK != ret) {
     rclcpp::exceptions::throw_from_rcl_error(ret);
   }
-  if (
-    matches_any_intra_process_publishers(&message_info_out.get_rmw_message_info().publisher_gid))
-  {
-    // In this case, the message will be delivered via intra-process and
-    // we should ignore this copy of the message.
-    return false;
-  }
-  return true;
+  return taken;
+}
+
+bool
+SubscriptionBase::needs_message_info() const
+{
+  return message_info_needed_ || use_intra_process_;
+}
+
+void
+SubscriptionBase::set_message_info_needed(bool needed)
+{
+  message_info_needed_ = needed;
 }
 
 bool
@@ -210,19 +314,94 @@ SubscriptionBase::take_serialized(
   rclcpp::SerializedMessage & message_out,
   rclcpp::MessageInfo & message_info_out)
 {
-  rcl_ret_t ret = rcl_take_serialized_message(
-    this->get_subscription_handle().get(),
-    &message_out.get_rcl_serialized_message(),
-    &message_info_out.get_rmw_message_info(),
-    nullptr);
-  if (RCL_RET_SUBSCRIPTION_TAKE_FAILED == ret) {
+  if (rate_limiter_) {
+    const RateLimitTake rate_limit_take = take_rate_limited(message_info_out);
+    if (RateLimitTake::Nothing == rate_limit_take) {
+      return false;
+    }
+    if (RateLimitTake::Latest == rate_limit_take) {
+      std::swap(message_out, get_take_buffers().latest_message);
+      rate_limiter_->on_kept();
+      return true;
+    }
+  }
+  if (!take_serialized_message(message_out, message_info_out)) {
     return false;
-  } else if (RCL_RET_OK != ret) {
-    rclcpp::exceptions::throw_from_rcl_error(ret);
+  }
+  if (rate_limiter_) {
+    rate_limiter_->on_kept();
   }
   return true;
 }
 
+SubscriptionBase::RateLimitTake
+SubscriptionBase::take_rate_limited(rclcpp::MessageInfo & message_info_out)
+{
+  TakeBuffers & buffers = get_take_buffers();
+  const auto now = rclcpp::RateLimiter::Clock::now();
+  while (!rate_limiter_->is_due(now)) {
+    if (!take_serialized_message(buffers.dropped_message, message_info_out)) {
+      return RateLimitTake::Nothing;
+    }
+    rate_limiter_->on_dropped();
+  }
+  if (rate_limiter_->get_options().policy != rclcpp::RateLimitPolicy::LatestPerInterval) {
+    return RateLimitTake::Next;
+  }
+  // Skip the messages queued while the interval elapsed, only the newest one is kept
+  if (!take_serialized_message(buffers.latest_message, message_info_out)) {
+    return RateLimitTake::Nothing;
+  }
+  rclcpp::MessageInfo newer_message_info;
+  while (take_serialized_message(buffers.dropped_message, newer_message_info)) {
+    std::swap(buffers.latest_message, buffers.dropped_message);
+    message_info_out = newer_message_info;
+    rate_limiter_->on_dropped();
+  }
+  return RateLimitTake::Latest;
+}
+
+SubscriptionBase::TakeBuffers &
+SubscriptionBase::get_take_buffers()
+{
+  thread_local TakeBuffers take_buffers;
+  return take_buffers;
+}
+
+bool
+SubscriptionBase::take_serialized_message(
+  rclcpp::SerializedMessage & message_out,
+  rclcpp::MessageInfo & message_info_out)
+{
+  const auto content_filter = std::atomic_load(&inter_process_content_filter_);
+  for (;;) {
+    rcl_ret_t ret = rcl_take_serialized_message(
+      this->get_subscription_handle().get(),
+      &message_out.get_rcl_serialized_message(),
+      &message_info_out.get_rmw_message_info(),
+      nullptr);
+    if (RCL_RET_SUBSCRIPTION_TAKE_FAILED == ret) {
+      return false;
+    } else if (RCL_RET_OK != ret) {
+      rclcpp::exceptions::throw_from_rcl_error(ret);
+    }
+    if (
+      matches_any_intra_process_publishers(&message_info_out.get_rmw_message_info().publisher_gid))
+    {
+      // In this case, the message will be delivered via intra-process and
+      // we should ignore this copy of the message.
+      return false;
+    }
+    if (drop_by_age(message_info_out)) {
+      continue;
+    }
+    // The messages not matching the filter are skipped, the middleware didn't filter them
+    if (!content_filter || content_filter->matches(message_out)) {
+      return true;
+    }
+  }
+}
+
 const rosidl_message_type_support_t &
 SubscriptionBase::get_message_type_support_handle() const
 {
@@ -235,6 +414,174 @@ SubscriptionBase::is_serialized() const
   return is_serialized_;
 }
 
+void
+SubscriptionBase::set_max_messages_per_take(size_t max_messages_per_take)
+{
+  max_messages_per_take_.store(max_messages_per_take);
+}
+
+size_t
+SubscriptionBase::get_max_messages_per_take() const
+{
+  return max_messages_per_take_.load();
+}
+
+std::shared_ptr<const rclcpp::RateLimiter>
+SubscriptionBase::get_rate_limiter() const
+{
+  return rate_limiter_;
+}
+
+bool
+SubscriptionBase::drop_by_rate_limit()
+{
+  return rate_limiter_ && !rate_limiter_->try_keep();
+}
+
+std::chrono::nanoseconds
+SubscriptionBase::get_max_message_age() const
+{
+  return max_message_age_;
+}
+
+uint64_t
+SubscriptionBase::get_expired_message_count() const
+{
+  uint64_t count = expired_message_count_.load();
+  if (subscription_intra_process_) {
+    count += subscription_intra_process_->get_expired_message_count();
+  }
+  return count;
+}
+
+bool
+SubscriptionBase::drop_by_age(const rclcpp::MessageInfo & message_info)
+{
+  const rmw_time_point_value_t source_timestamp =
+    message_info.get_rmw_message_info().source_timestamp;
+  if (max_message_age_.count() <= 0 || source_timestamp <= 0) {
+    return false;
+  }
+  const auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::system_clock::now().time_since_epoch());
+  if (now - std::chrono::nanoseconds(source_timestamp) <= max_message_age_) {
+    return false;
+  }
+  expired_message_count_.fetch_add(1);
+  return true;
+}
+
+void
+SubscriptionBase::set_max_message_age(std::chrono::nanoseconds max_message_age)
+{
+  if (max_message_age.count() < 0) {
+    throw std::invalid_argument("the maximum age of the messages must not be negative");
+  }
+  max_message_age_ = max_message_age;
+}
+
+void
+SubscriptionBase::pause()
+{
+  paused_.store(true);
+  if (subscription_intra_process_) {
+    subscription_intra_process_->set_paused(true);
+  }
+}
+
+void
+SubscriptionBase::resume()
+{
+  paused_.store(false);
+  if (subscription_intra_process_) {
+    subscription_intra_process_->set_paused(false);
+  }
+}
+
+bool
+SubscriptionBase::is_paused() const
+{
+  return paused_.load();
+}
+
+uint64_t
+SubscriptionBase::get_paused_dropped_count() const
+{
+  uint64_t count = paused_dropped_count_.load();
+  if (subscription_intra_process_) {
+    count += subscription_intra_process_->get_paused_dropped_count();
+  }
+  return count;
+}
+
+size_t
+SubscriptionBase::drop_paused_messages(size_t max_messages)
+{
+  rclcpp::SerializedMessage & dropped_message = get_take_buffers().dropped_message;
+  rclcpp::MessageInfo message_info;
+  size_t dropped_count = 0;
+  while (dropped_count < max_messages && take_serialized_message(dropped_message, message_info)) {
+    ++dropped_count;
+  }
+  paused_dropped_count_.fetch_add(dropped_count);
+  return dropped_count;
+}
+
+void
+SubscriptionBase::set_rate_limit(const rclcpp::RateLimitOptions & options)
+{
+  if (options.policy == rclcpp::RateLimitPolicy::Disabled) {
+    rate_limiter_.reset();
+    return;
+  }
+  rate_limiter_ = std::make_shared<rclcpp::RateLimiter>(options);
+}
+
+bool
+SubscriptionBase::drop_by_content_filter(const void * message) const
+{
+  const auto content_filter = std::atomic_load(&inter_process_content_filter_);
+  return content_filter && !content_filter->matches(message);
+}
+
+void
+SubscriptionBase::setup_content_filter(const rclcpp::ContentFilterOptions & options)
+{
+  if (options.filter_expression.empty()) {
+    return;
+  }
+  set_client_content_filter(options, is_cft_enabled());
+}
+
+void
+SubscriptionBase::set_client_content_filter(
+  const rclcpp::ContentFilterOptions & options,
+  bool middleware_filters)
+{
+  std::shared_ptr<const rclcpp::ContentFilter> content_filter;
+  if (!options.filter_expression.empty()) {
+    try {
+      content_filter = std::make_shared<const rclcpp::ContentFilter>(options, &type_support_);
+    } catch (const std::invalid_argument & exception) {
+      if (!middleware_filters) {
+        throw;
+      }
+      // The middleware supports more expressions, only the intra-process messages aren't filtered
+      RCLCPP_WARN(
+        node_logger_,
+        "The intra-process messages of the subscription on topic '%s' aren't filtered: %s",
+        get_topic_name(), exception.what());
+    }
+  }
+  std::atomic_store(&content_filter_, content_filter);
+  std::atomic_store(
+    &inter_process_content_filter_,
+    middleware_filters ? std::shared_ptr<const rclcpp::ContentFilter>() : content_filter);
+  if (subscription_intra_process_) {
+    subscription_intra_process_->set_content_filter(content_filter);
+  }
+}
+
 size_t
 SubscriptionBase::get_publisher_count() const
 {
@@ -258,6 +605,38 @@ SubscriptionBase::setup_intra_process(
   intra_process_subscription_id_ = intra_process_subscription_id;
   weak_ipm_ = weak_ipm;
   use_intra_process_ = true;
+  if (rate_limiter_ && subscription_intra_process_) {
+    subscription_intra_process_->set_rate_limiter(rate_limiter_);
+  }
+  if (subscription_intra_process_) {
+    subscription_intra_process_->set_content_filter(std::atomic_load(&content_filter_));
+    subscription_intra_process_->set_paused(paused_.load());
+    subscription_intra_process_->set_max_message_age(max_message_age_);
+  }
+}
+
+bool
+SubscriptionBase::keeps_loaned_messages() const
+{
+  return false;
+}
+
+rclcpp::Waitable::SharedPtr
+SubscriptionBase::get_deserialization_waitable() const
+{
+  return nullptr;
+}
+
+size_t
+SubscriptionBase::get_prefetch_depth() const
+{
+  return 0;
+}
+
+bool
+SubscriptionBase::take_and_prefetch()
+{
+  return false;
 }
 
 bool
@@ -285,6 +664,15 @@ SubscriptionBase::get_intra_process_waitable() const
   return ipm->get_subscription_intra_process(intra_process_subscription_id_);
 }
 
+std::optional<rclcpp::experimental::buffers::BufferMetrics>
+SubscriptionBase::get_intra_process_buffer_metrics() const
+{
+  if (!use_intra_process_ || !subscription_intra_process_) {
+    return std::nullopt;
+  }
+  return subscription_intra_process_->get_buffer_metrics();
+}
+
 void
 SubscriptionBase::default_incompatible_qos_callback(
   rclcpp::QOSRequestedIncompatibleQoSInfo & event) const
@@ -311,7 +699,11 @@ SubscriptionBase::matches_any_intra_process_publishers(const rmw_gid_t * sender_
             "intra process publisher check called "
             "after destruction of intra process manager");
   }
-  return ipm->matches_any_publishers(sender_gid);
+  // The publishers of serialized messages only deliver to the subscriptions of serialized messages
+  const bool include_serialized_publishers =
+    dynamic_cast<rclcpp::experimental::SubscriptionIntraProcessSerialized *>(
+    subscription_intra_process_.get()) != nullptr;
+  return ipm->matches_any_publishers(sender_gid, include_serialized_publishers);
 }
 
 bool
@@ -397,6 +789,12 @@ SubscriptionBase::is_cft_enabled() const
   return rcl_subscription_is_cft_enabled(subscription_handle_.get());
 }
 
+bool
+SubscriptionBase::is_content_filter_enabled() const
+{
+  return is_cft_enabled() || std::atomic_load(&inter_process_content_filter_) != nullptr;
+}
+
 void
 SubscriptionBase::set_content_filter(
   const std::string & filter_expression,
@@ -434,14 +832,26 @@ SubscriptionBase::set_content_filter(
     subscription_handle_.get(),
     &options);
 
+  if (RCL_RET_UNSUPPORTED == ret) {
+    // The middleware doesn't filter the messages, rclcpp does
+    rcl_reset_error();
+    set_client_content_filter({filter_expression, expression_parameters}, false);
+    return;
+  }
   if (RCL_RET_OK != ret) {
     rclcpp::exceptions::throw_from_rcl_error(ret, "failed to set cft expression parameters");
   }
+  set_client_content_filter({filter_expression, expression_parameters}, true);
 }
 
 rclcpp::ContentFilterOptions
 SubscriptionBase::get_content_filter() const
 {
+  if (!is_cft_enabled()) {
+    const auto content_filter = std::atomic_load(&content_filter_);
+    return content_filter ? content_filter->get_options() : rclcpp::ContentFilterOptions();
+  }
+
   rclcpp::ContentFilterOptions ret_options;
   rcl_subscription_content_filter_options_t options =
     rcl_get_zero_initialized_subscription_content_filter_options();
@@ -0,0 +1,297 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "rclcpp/experimental/subscription_deserialization_waitable.hpp"
+
+#include <exception>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "rmw/impl/cpp/demangle.hpp"
+
+#include "rclcpp/detail/add_guard_condition_to_rcl_wait_set.hpp"
+#include "rclcpp/logging.hpp"
+#include "rclcpp/subscription_base.hpp"
+
+using rclcpp::experimental::SubscriptionDeserializationWaitable;
+
+struct SubscriptionDeserializationWaitable::PendingMessage
+{
+  std::weak_ptr<rclcpp::SubscriptionBase> subscription;
+  std::shared_ptr<const rclcpp::SerializedMessage> serialized_message;
+  rclcpp::MessageInfo message_info;
+  std::shared_ptr<void> message;
+  std::exception_ptr error;
+  bool deserialized = false;
+};
+
+SubscriptionDeserializationWaitable::SubscriptionDeserializationWaitable(
+  rclcpp::Context::SharedPtr context,
+  rclcpp::DeserializationThreadPool::SharedPtr thread_pool,
+  DeserializeFunction deserialize)
+: gc_(context), thread_pool_(std::move(thread_pool)), deserialize_(std::move(deserialize))
+{
+  if (!thread_pool_) {
+    throw std::invalid_argument("thread pool cannot be nullptr");
+  }
+  if (!deserialize_) {
+    throw std::invalid_argument("deserialize function must be callable");
+  }
+  gc_.set_trigger_coalescing(true);
+}
+
+void
+SubscriptionDeserializationWaitable::deserialize_async(
+  std::weak_ptr<rclcpp::SubscriptionBase> subscription,
+  std::shared_ptr<const rclcpp::SerializedMessage> serialized_message,
+  const rclcpp::MessageInfo & message_info)
+{
+  auto pending_message = std::make_shared<PendingMessage>();
+  pending_message->subscription = std::move(subscription);
+  pending_message->serialized_message = std::move(serialized_message);
+  pending_message->message_info = message_info;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_messages_.push_back(pending_message);
+  }
+  thread_pool_->post(
+    [self = shared_from_this(), pending_message]() {
+      std::shared_ptr<void> message;
+      std::exception_ptr error;
+      try {
+        message = self->deserialize_(*pending_message->serialized_message);
+      } catch (...) {
+        error = std::current_exception();
+      }
+      {
+        std::lock_guard<std::mutex> lock(self->mutex_);
+        pending_message->message = std::move(message);
+        pending_message->error = error;
+        pending_message->deserialized = true;
+        // The serialized message can be reused by the subscription from now on
+        pending_message->serialized_message.reset();
+      }
+      self->on_deserialized();
+    });
+}
+
+bool
+SubscriptionDeserializationWaitable::take_and_prefetch(
+  const std::shared_ptr<rclcpp::SubscriptionBase> & subscription,
+  size_t prefetch_depth)
+{
+  if (!take_next_message(*subscription)) {
+    return false;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (prefetching_) {
+      return true;
+    }
+    prefetching_ = true;
+  }
+  std::weak_ptr<rclcpp::SubscriptionBase> weak_subscription = subscription;
+  thread_pool_->post(
+    [self = shared_from_this(), weak_subscription, prefetch_depth]() {
+      self->prefetch(weak_subscription, prefetch_depth);
+    });
+  return true;
+}
+
+bool
+SubscriptionDeserializationWaitable::take_next_message(rclcpp::SubscriptionBase & subscription)
+{
+  auto serialized_message = std::make_shared<rclcpp::SerializedMessage>();
+  rclcpp::MessageInfo message_info;
+  message_info.get_rmw_message_info().from_intra_process = false;
+  std::lock_guard<std::mutex> lock(take_mutex_);
+  if (!subscription.take_serialized(*serialized_message, message_info)) {
+    return false;
+  }
+  // The subscription queues it with deserialize_async()
+  subscription.handle_serialized_message(serialized_message, message_info);
+  return true;
+}
+
+void
+SubscriptionDeserializationWaitable::prefetch(
+  std::weak_ptr<rclcpp::SubscriptionBase> weak_subscription,
+  size_t prefetch_depth)
+{
+  for (;;) {
+    auto subscription = weak_subscription.lock();
+    if (!subscription || subscription->is_paused() ||
+      get_number_of_pending_messages() >= prefetch_depth)
+    {
+      break;
+    }
+    bool taken = false;
+    try {
+      taken = take_next_message(*subscription);
+    } catch (const std::exception & exception) {
+      RCLCPP_ERROR(
+        rclcpp::get_logger("rclcpp"),
+        "failed to prefetch a message from topic '%s': %s",
+        subscription->get_topic_name(), exception.what());
+    }
+    if (!taken) {
+      break;
+    }
+  }
+  // A message arriving from now on is taken by the executor, which prefetches again
+  std::lock_guard<std::mutex> lock(mutex_);
+  prefetching_ = false;
+}
+
+size_t
+SubscriptionDeserializationWaitable::get_number_of_pending_messages() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return pending_messages_.size();
+}
+
+void
+SubscriptionDeserializationWaitable::add_to_wait_set(rcl_wait_set_t * wait_set)
+{
+  detail::add_guard_condition_to_rcl_wait_set(*wait_set, gc_);
+}
+
+bool
+SubscriptionDeserializationWaitable::is_ready(rcl_wait_set_t * wait_set)
+{
+  (void)wait_set;
+  std::lock_guard<std::mutex> lock(mutex_);
+  return !pending_messages_.empty() && pending_messages_.front()->deserialized;
+}
+
+std::shared_ptr<void>
+SubscriptionDeserializationWaitable::take_data()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (pending_messages_.empty() || !pending_messages_.front()->deserialized) {
+    return nullptr;
+  }
+  auto pending_message = std::move(pending_messages_.front());
+  pending_messages_.pop_front();
+  if (notified_count_ > 0) {
+    notified_count_--;
+  }
+  if (!pending_messages_.empty() && pending_messages_.front()->deserialized) {
+    // Wake up the executor again for the next message, deserialized out of order
+    gc_.trigger();
+  }
+  return pending_message;
+}
+
+std::shared_ptr<void>
+SubscriptionDeserializationWaitable::take_data_by_entity_id(size_t id)
+{
+  (void)id;
+  return take_data();
+}
+
+void
+SubscriptionDeserializationWaitable::execute(std::shared_ptr<void> & data)
+{
+  if (!data) {
+    return;
+  }
+  auto pending_message = std::static_pointer_cast<PendingMessage>(data);
+  if (pending_message->error) {
+    std::rethrow_exception(pending_message->error);
+  }
+  auto subscription = pending_message->subscription.lock();
+  if (subscription) {
+    subscription->handle_message(pending_message->message, pending_message->message_info);
+  }
+}
+
+void
+SubscriptionDeserializationWaitable::on_deserialized()
+{
+  size_t ready_count = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Messages are handled in order, so only the ones at the front are ready
+    size_t deserialized_count = 0;
+    while (deserialized_count < pending_messages_.size() &&
+      pending_messages_[deserialized_count]->deserialized)
+    {
+      deserialized_count++;
+    }
+    if (deserialized_count > notified_count_) {
+      ready_count = deserialized_count - notified_count_;
+      notified_count_ = deserialized_count;
+    }
+  }
+  if (ready_count == 0) {
+    return;
+  }
+  gc_.trigger();
+  std::lock_guard<std::mutex> lock(callback_mutex_);
+  if (on_ready_callback_) {
+    on_ready_callback_(ready_count);
+  } else {
+    unread_count_ += ready_count;
+  }
+}
+
+void
+SubscriptionDeserializationWaitable::set_on_ready_callback(
+  std::function<void(size_t, int)> callback)
+{
+  if (!callback) {
+    throw std::invalid_argument(
+            "The callback passed to set_on_ready_callback "
+            "is not callable.");
+  }
+
+  // Note: we bind the int identifier argument to this waitable's entity type
+  auto new_callback =
+    [callback, this](size_t number_of_events) {
+      try {
+        callback(number_of_events, static_cast<int>(EntityType::Subscription));
+      } catch (const std::exception & exception) {
+        RCLCPP_ERROR_STREAM(
+          rclcpp::get_logger("rclcpp"),
+          "rclcpp::SubscriptionDeserializationWaitable@" << this <<
+            " caught " << rmw::impl::cpp::demangle(exception) <<
+            " exception in user-provided callback for the 'on ready' callback: " <<
+            exception.what());
+      } catch (...) {
+        RCLCPP_ERROR_STREAM(
+          rclcpp::get_logger("rclcpp"),
+          "rclcpp::SubscriptionDeserializationWaitable@" << this <<
+            " caught unhandled exception in user-provided callback " <<
+            "for the 'on ready' callback");
+      }
+    };
+
+  std::lock_guard<std::mutex> lock(callback_mutex_);
+  on_ready_callback_ = new_callback;
+  if (unread_count_ > 0) {
+    on_ready_callback_(unread_count_);
+    unread_count_ = 0;
+  }
+}
+
+void
+SubscriptionDeserializationWaitable::clear_on_ready_callback()
+{
+  std::lock_guard<std::mutex> lock(callback_mutex_);
+  on_ready_callback_ = nullptr;
+}
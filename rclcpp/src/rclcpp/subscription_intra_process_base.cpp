@@ -13,10 +13,43 @@
 // limitations under the License.
 
 #include "rclcpp/experimental/subscription_intra_process_base.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/callback_group.hpp"
 #include "rclcpp/detail/add_guard_condition_to_rcl_wait_set.hpp"
 
+using rclcpp::experimental::IntraProcessDeliveryScope;
 using rclcpp::experimental::SubscriptionIntraProcessBase;
 
+namespace
+{
+
+/// Number of direct dispatches nested on this thread.
+thread_local size_t g_direct_dispatch_depth = 0;
+
+/// Deliveries recorded by the innermost IntraProcessDeliveryScope of this thread.
+thread_local std::vector<const rclcpp::Waitable *> * g_recorded_deliveries = nullptr;
+
+}  // namespace
+
+IntraProcessDeliveryScope::IntraProcessDeliveryScope(
+  std::vector<const rclcpp::Waitable *> & deliveries)
+: previous_deliveries_(g_recorded_deliveries)
+{
+  g_recorded_deliveries = &deliveries;
+}
+
+IntraProcessDeliveryScope::~IntraProcessDeliveryScope()
+{
+  g_recorded_deliveries = previous_deliveries_;
+}
+
 void
 SubscriptionIntraProcessBase::add_to_wait_set(rcl_wait_set_t * wait_set)
 {
@@ -34,3 +67,187 @@ SubscriptionIntraProcessBase::get_actual_qos() const
 {
   return qos_profile_;
 }
+
+void
+SubscriptionIntraProcessBase::set_direct_dispatch(
+  std::weak_ptr<rclcpp::CallbackGroup> callback_group,
+  size_t max_depth)
+{
+  direct_dispatch_callback_group_ = std::move(callback_group);
+  direct_dispatch_max_depth_.store(max_depth, std::memory_order_release);
+}
+
+bool
+SubscriptionIntraProcessBase::is_direct_dispatch_enabled() const
+{
+  return direct_dispatch_max_depth_.load(std::memory_order_acquire) != 0;
+}
+
+void
+SubscriptionIntraProcessBase::set_rate_limiter(std::shared_ptr<rclcpp::RateLimiter> rate_limiter)
+{
+  rate_limiter_ = std::move(rate_limiter);
+}
+
+bool
+SubscriptionIntraProcessBase::drop_by_rate_limit()
+{
+  return rate_limiter_ && !rate_limiter_->try_keep();
+}
+
+void
+SubscriptionIntraProcessBase::set_paused(bool paused)
+{
+  paused_.store(paused);
+}
+
+bool
+SubscriptionIntraProcessBase::is_paused() const
+{
+  return paused_.load();
+}
+
+bool
+SubscriptionIntraProcessBase::drop_by_pause()
+{
+  if (!paused_.load()) {
+    return false;
+  }
+  paused_dropped_count_.fetch_add(1);
+  return true;
+}
+
+void
+SubscriptionIntraProcessBase::add_paused_dropped_count(uint64_t count)
+{
+  paused_dropped_count_.fetch_add(count);
+}
+
+uint64_t
+SubscriptionIntraProcessBase::get_paused_dropped_count() const
+{
+  return paused_dropped_count_.load();
+}
+
+void
+SubscriptionIntraProcessBase::set_max_message_age(std::chrono::nanoseconds max_message_age)
+{
+  max_message_age_ = max_message_age;
+  if (max_message_age_.count() > 0) {
+    // Room for the messages queued and the ones dropped by the buffer meanwhile
+    queued_messages_.resize(std::max<size_t>(2 * qos_profile_.depth(), 1));
+  }
+}
+
+void
+SubscriptionIntraProcessBase::record_queue_time(const void * message)
+{
+  if (max_message_age_.count() <= 0) {
+    return;
+  }
+  const auto now = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> lock(queued_messages_mutex_);
+  queued_messages_[next_queued_message_] = {message, now};
+  next_queued_message_ = (next_queued_message_ + 1) % queued_messages_.size();
+}
+
+bool
+SubscriptionIntraProcessBase::drop_by_age(const void * message)
+{
+  if (max_message_age_.count() <= 0) {
+    return false;
+  }
+  std::chrono::steady_clock::time_point queue_time;
+  bool found = false;
+  {
+    std::lock_guard<std::mutex> lock(queued_messages_mutex_);
+    // From the newest entry, which is the right one if an address was reused
+    const size_t size = queued_messages_.size();
+    for (size_t count = 1; count <= size; ++count) {
+      QueuedMessage & entry = queued_messages_[(next_queued_message_ + size - count) % size];
+      if (entry.message == message) {
+        queue_time = entry.queue_time;
+        entry = QueuedMessage();
+        found = true;
+        break;
+      }
+    }
+  }
+  if (!found || std::chrono::steady_clock::now() - queue_time <= max_message_age_) {
+    return false;
+  }
+  expired_message_count_.fetch_add(1);
+  return true;
+}
+
+uint64_t
+SubscriptionIntraProcessBase::get_expired_message_count() const
+{
+  return expired_message_count_.load();
+}
+
+void
+SubscriptionIntraProcessBase::set_content_filter(
+  std::shared_ptr<const rclcpp::ContentFilter> content_filter)
+{
+  std::atomic_store(&content_filter_, std::move(content_filter));
+}
+
+std::shared_ptr<const rclcpp::ContentFilter>
+SubscriptionIntraProcessBase::get_content_filter() const
+{
+  return std::atomic_load(&content_filter_);
+}
+
+void
+SubscriptionIntraProcessBase::notify_new_message()
+{
+  if (try_dispatch_direct()) {
+    return;
+  }
+  trigger_guard_condition();
+  invoke_on_new_message();
+  if (g_recorded_deliveries) {
+    const rclcpp::Waitable * waitable = this;
+    auto & deliveries = *g_recorded_deliveries;
+    if (std::find(deliveries.begin(), deliveries.end(), waitable) == deliveries.end()) {
+      deliveries.push_back(waitable);
+    }
+  }
+}
+
+bool
+SubscriptionIntraProcessBase::try_dispatch_direct()
+{
+  const size_t max_depth = direct_dispatch_max_depth_.load(std::memory_order_acquire);
+  if (max_depth == 0 || g_direct_dispatch_depth >= max_depth) {
+    return false;
+  }
+  auto callback_group = direct_dispatch_callback_group_.lock();
+  if (!callback_group) {
+    return false;
+  }
+  const uint64_t skip_count = callback_group->get_reservation_statistics().skip_count;
+  if (!callback_group->try_reserve()) {
+    return false;
+  }
+
+  auto finish = [&callback_group, skip_count]() {
+      g_direct_dispatch_depth--;
+      callback_group->release();
+      if (callback_group->get_reservation_statistics().skip_count != skip_count) {
+        // An executor left work of the group behind while it was reserved here
+        callback_group->trigger_notify_guard_condition();
+      }
+    };
+  g_direct_dispatch_depth++;
+  try {
+    auto data = take_data();
+    execute(data);
+  } catch (...) {
+    finish();
+    throw;
+  }
+  finish();
+  return true;
+}
@@ -0,0 +1,98 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/experimental/subscription_intra_process_serialized.hpp"
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+using rclcpp::experimental::LazySerializedMessage;
+using rclcpp::experimental::SubscriptionIntraProcessSerialized;
+
+SubscriptionIntraProcessSerialized::SubscriptionIntraProcessSerialized(
+  Callback callback,
+  rclcpp::Context::SharedPtr context,
+  const std::string & topic_name,
+  const rclcpp::QoS & qos_profile)
+: SubscriptionIntraProcessBase(context, topic_name, qos_profile),
+  callback_(std::move(callback)),
+  buffer_(qos_profile.depth())
+{
+  if (!callback_) {
+    throw std::invalid_argument("intra-process serialized message callback cannot be empty");
+  }
+}
+
+bool
+SubscriptionIntraProcessSerialized::is_ready(rcl_wait_set_t * wait_set)
+{
+  (void) wait_set;
+  return buffer_.has_data();
+}
+
+std::shared_ptr<void>
+SubscriptionIntraProcessSerialized::take_data()
+{
+  // The messages queued for too long are dropped, up to the first one still fresh
+  LazySerializedMessage::SharedPtr message = buffer_.dequeue();
+  while (message && drop_by_age(message.get())) {
+    message = buffer_.dequeue();
+  }
+  return message;
+}
+
+void
+SubscriptionIntraProcessSerialized::execute(std::shared_ptr<void> & data)
+{
+  if (!data) {
+    return;
+  }
+  if (is_paused()) {
+    // Queued before the subscription was paused
+    add_paused_dropped_count(1);
+    return;
+  }
+  auto message = std::static_pointer_cast<LazySerializedMessage>(data);
+  // The serialized message is shared with the other subscriptions
+  callback_(std::const_pointer_cast<rclcpp::SerializedMessage>(message->get_serialized_message()));
+}
+
+bool
+SubscriptionIntraProcessSerialized::use_take_shared_method() const
+{
+  return true;
+}
+
+rclcpp::experimental::buffers::BufferMetrics
+SubscriptionIntraProcessSerialized::get_buffer_metrics() const
+{
+  return buffer_.get_metrics();
+}
+
+void
+SubscriptionIntraProcessSerialized::provide_serialized_message(
+  LazySerializedMessage::SharedPtr message)
+{
+  record_queue_time(message.get());
+  buffer_.enqueue(std::move(message));
+  notify_new_message();
+}
+
+void
+SubscriptionIntraProcessSerialized::trigger_guard_condition()
+{
+  gc_.trigger();
+}
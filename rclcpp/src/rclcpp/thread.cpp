@@ -0,0 +1,247 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/thread.hpp"
+
+#include <exception>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#if !defined(_WIN32)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using rclcpp::Thread;
+
+struct Thread::Impl
+{
+#if defined(_WIN32)
+  std::thread thread;
+#else
+  pthread_t handle;
+#endif
+};
+
+namespace
+{
+
+void
+set_current_thread_name(const std::string & name)
+{
+  if (name.empty()) {
+    return;
+  }
+  // Failing to set the name is harmless, so errors are ignored.
+#if defined(__linux__)
+  // The name must fit in 16 bytes, including the terminating null byte.
+  pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+#elif defined(__APPLE__)
+  pthread_setname_np(name.c_str());
+#endif
+}
+
+#if !defined(_WIN32)
+
+struct StartData
+{
+  std::function<void()> function;
+  std::string name;
+};
+
+void *
+thread_main(void * arg)
+{
+  std::unique_ptr<StartData> data(static_cast<StartData *>(arg));
+  set_current_thread_name(data->name);
+  data->function();
+  return nullptr;
+}
+
+void
+check_pthread_result(int ret, const char * what)
+{
+  if (ret != 0) {
+    throw std::system_error(ret, std::generic_category(), what);
+  }
+}
+
+/// pthread_attr_t which is destroyed when leaving the scope.
+class ScopedPthreadAttr
+{
+public:
+  ScopedPthreadAttr()
+  {
+    check_pthread_result(pthread_attr_init(&attr_), "failed to initialize thread attributes");
+  }
+
+  ~ScopedPthreadAttr()
+  {
+    pthread_attr_destroy(&attr_);
+  }
+
+  pthread_attr_t *
+  get()
+  {
+    return &attr_;
+  }
+
+private:
+  pthread_attr_t attr_;
+};
+
+void
+set_scheduling_attributes(pthread_attr_t * attr, const rclcpp::ThreadAttributes & attributes)
+{
+  int policy = SCHED_OTHER;
+  switch (attributes.scheduling_policy) {
+    case rclcpp::ThreadSchedulingPolicy::Inherit:
+      return;
+    case rclcpp::ThreadSchedulingPolicy::Other:
+      policy = SCHED_OTHER;
+      break;
+    case rclcpp::ThreadSchedulingPolicy::Fifo:
+      policy = SCHED_FIFO;
+      break;
+    case rclcpp::ThreadSchedulingPolicy::RoundRobin:
+      policy = SCHED_RR;
+      break;
+  }
+  if (
+    attributes.priority < sched_get_priority_min(policy) ||
+    attributes.priority > sched_get_priority_max(policy))
+  {
+    throw std::invalid_argument(
+            "thread priority " + std::to_string(attributes.priority) +
+            " is out of range for the requested scheduling policy");
+  }
+  check_pthread_result(
+    pthread_attr_setinheritsched(attr, PTHREAD_EXPLICIT_SCHED),
+    "failed to set explicit thread scheduling");
+  check_pthread_result(
+    pthread_attr_setschedpolicy(attr, policy), "failed to set thread scheduling policy");
+  sched_param param{};
+  param.sched_priority = attributes.priority;
+  check_pthread_result(
+    pthread_attr_setschedparam(attr, &param), "failed to set thread priority");
+}
+
+void
+set_affinity_attributes(pthread_attr_t * attr, const rclcpp::ThreadAttributes & attributes)
+{
+  if (attributes.cpu_set.empty()) {
+    return;
+  }
+#if defined(__linux__)
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  for (size_t cpu : attributes.cpu_set) {
+    if (cpu >= CPU_SETSIZE) {
+      throw std::invalid_argument("CPU index " + std::to_string(cpu) + " is out of range");
+    }
+    CPU_SET(cpu, &cpu_set);
+  }
+  check_pthread_result(
+    pthread_attr_setaffinity_np(attr, sizeof(cpu_set), &cpu_set),
+    "failed to set thread CPU affinity");
+#else
+  (void)attr;
+  throw std::runtime_error("thread CPU affinity is not supported on this platform");
+#endif
+}
+
+#endif
+
+}  // namespace
+
+Thread::Thread() noexcept = default;
+
+Thread::Thread(const ThreadAttributes & attributes, std::function<void()> function)
+: impl_(std::make_unique<Impl>())
+{
+#if defined(_WIN32)
+  if (
+    !attributes.cpu_set.empty() ||
+    attributes.scheduling_policy != ThreadSchedulingPolicy::Inherit ||
+    attributes.stack_size != 0)
+  {
+    throw std::runtime_error("only the thread name attribute is supported on this platform");
+  }
+  // Windows thread names are not set, they require a recent Windows SDK.
+  impl_->thread = std::thread(std::move(function));
+#else
+  ScopedPthreadAttr attr;
+  if (attributes.stack_size != 0) {
+    check_pthread_result(
+      pthread_attr_setstacksize(attr.get(), attributes.stack_size),
+      "failed to set thread stack size");
+  }
+  set_scheduling_attributes(attr.get(), attributes);
+  set_affinity_attributes(attr.get(), attributes);
+
+  auto data = std::make_unique<StartData>();
+  data->function = std::move(function);
+  data->name = attributes.name;
+  check_pthread_result(
+    pthread_create(&impl_->handle, attr.get(), &thread_main, data.get()),
+    "failed to create thread");
+  // The new thread owns the start data from now on.
+  data.release();
+#endif
+}
+
+Thread::Thread(Thread && other) noexcept = default;
+
+Thread &
+Thread::operator=(Thread && other) noexcept
+{
+  if (joinable()) {
+    std::terminate();
+  }
+  impl_ = std::move(other.impl_);
+  return *this;
+}
+
+Thread::~Thread()
+{
+  if (joinable()) {
+    std::terminate();
+  }
+}
+
+bool
+Thread::joinable() const noexcept
+{
+  return impl_ != nullptr;
+}
+
+void
+Thread::join()
+{
+  if (!joinable()) {
+    throw std::system_error(
+            std::make_error_code(std::errc::invalid_argument), "thread is not joinable");
+  }
+#if defined(_WIN32)
+  impl_->thread.join();
+#else
+  check_pthread_result(pthread_join(impl_->handle, nullptr), "failed to join thread");
+#endif
+  impl_.reset();
+}
@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <iterator>
 #include <memory>
 #include <string>
 #include <utility>
@@ -27,6 +29,7 @@
 #include "rclcpp/node.hpp"
 #include "rclcpp/parameter_client.hpp"
 #include "rclcpp/parameter_events_filter.hpp"
+#include "rclcpp/thread.hpp"
 #include "rclcpp/time.hpp"
 #include "rclcpp/time_source.hpp"
 
@@ -37,7 +40,9 @@ class ClocksState final
 {
 public:
   ClocksState()
-  : logger_(rclcpp::get_logger("rclcpp"))
+  : logger_(rclcpp::get_logger("rclcpp")),
+    associated_clocks_(std::make_shared<const ClockList>()),
+    shared_ros_time_(std::make_shared<SharedRosTime>())
   {
   }
 
@@ -54,12 +59,9 @@ public:
 
     // Update all attached clocks to zero or last recorded time
     std::lock_guard<std::mutex> guard(clock_list_lock_);
-    auto time_msg = std::make_shared<builtin_interfaces::msg::Time>();
-    if (last_msg_set_) {
-      time_msg = std::make_shared<builtin_interfaces::msg::Time>(last_msg_set_->clock);
-    }
-    for (auto it = associated_clocks_.begin(); it != associated_clocks_.end(); ++it) {
-      set_clock(time_msg, true, *it);
+    for (const auto & clock : *associated_clocks_) {
+      set_clock(shared_ros_time_->get(), true, clock);
+      clock->set_shared_ros_time(shared_ros_time_);
     }
   }
 
@@ -76,9 +78,9 @@ public:
 
     // Update all attached clocks
     std::lock_guard<std::mutex> guard(clock_list_lock_);
-    for (auto it = associated_clocks_.begin(); it != associated_clocks_.end(); ++it) {
-      auto msg = std::make_shared<builtin_interfaces::msg::Time>();
-      set_clock(msg, false, *it);
+    for (const auto & clock : *associated_clocks_) {
+      clock->set_shared_ros_time(nullptr);
+      set_clock(0, false, clock);
     }
   }
 
@@ -99,22 +101,28 @@ public:
       }
     }
     std::lock_guard<std::mutex> guard(clock_list_lock_);
-    associated_clocks_.push_back(clock);
-    // Set the clock to zero unless there's a recently received message
-    auto time_msg = std::make_shared<builtin_interfaces::msg::Time>();
-    if (last_msg_set_) {
-      time_msg = std::make_shared<builtin_interfaces::msg::Time>(last_msg_set_->clock);
+    auto clocks = std::make_shared<ClockList>(*associated_clocks_);
+    clocks->push_back(clock);
+    std::atomic_store(&associated_clocks_, std::shared_ptr<const ClockList>(std::move(clocks)));
+    // Set the clock to zero unless there's a recently received time, read once the clock is
+    // published so that it doesn't miss a time received meanwhile
+    set_clock(shared_ros_time_->get(), ros_time_active_, clock);
+    if (ros_time_active_) {
+      clock->set_shared_ros_time(shared_ros_time_);
     }
-    set_clock(time_msg, ros_time_active_, clock);
   }
 
   // Detach a clock
   void detachClock(rclcpp::Clock::SharedPtr clock)
   {
     std::lock_guard<std::mutex> guard(clock_list_lock_);
-    auto result = std::find(associated_clocks_.begin(), associated_clocks_.end(), clock);
-    if (result != associated_clocks_.end()) {
-      associated_clocks_.erase(result);
+    auto result = std::find(associated_clocks_->begin(), associated_clocks_->end(), clock);
+    if (result != associated_clocks_->end()) {
+      auto clocks = std::make_shared<ClockList>(associated_clocks_->begin(), result);
+      clocks->insert(clocks->end(), std::next(result), associated_clocks_->end());
+      std::atomic_store(&associated_clocks_, std::shared_ptr<const ClockList>(std::move(clocks)));
+      // The detached clock keeps the last time
+      clock->set_shared_ros_time(nullptr);
     } else {
       RCLCPP_ERROR(logger_, "failed to remove clock");
     }
@@ -122,31 +130,31 @@ public:
 
   // Internal helper function used inside iterators
   static void set_clock(
-    const builtin_interfaces::msg::Time::SharedPtr msg,
+    rcl_time_point_value_t nanoseconds,
     bool set_ros_time_enabled,
     rclcpp::Clock::SharedPtr clock)
   {
     std::lock_guard<std::mutex> clock_guard(clock->get_clock_mutex());
 
     if (clock->get_clock_type() == RCL_ROS_TIME) {
+      // The time source sets the rcl clock without using it elsewhere
+      rcl_clock_t * clock_handle = clock->get_time_source_clock_handle();
       // Do change
       if (!set_ros_time_enabled && clock->ros_time_is_active()) {
-        auto ret = rcl_disable_ros_time_override(clock->get_clock_handle());
+        auto ret = rcl_disable_ros_time_override(clock_handle);
         if (ret != RCL_RET_OK) {
           rclcpp::exceptions::throw_from_rcl_error(
             ret, "Failed to disable ros_time_override_status");
         }
       } else if (set_ros_time_enabled && !clock->ros_time_is_active()) {
-        auto ret = rcl_enable_ros_time_override(clock->get_clock_handle());
+        auto ret = rcl_enable_ros_time_override(clock_handle);
         if (ret != RCL_RET_OK) {
           rclcpp::exceptions::throw_from_rcl_error(
             ret, "Failed to enable ros_time_override_status");
         }
       }
 
-      auto ret = rcl_set_ros_time_override(
-        clock->get_clock_handle(),
-        rclcpp::Time(*msg).nanoseconds());
+      auto ret = rcl_set_ros_time_override(clock_handle, nanoseconds);
       if (ret != RCL_RET_OK) {
         rclcpp::exceptions::throw_from_rcl_error(
           ret, "Failed to set ros_time_override_status");
@@ -157,27 +165,33 @@ public:
     }
   }
 
-  // Internal helper function
-  void set_all_clocks(
-    const builtin_interfaces::msg::Time::SharedPtr msg,
-    bool set_ros_time_enabled)
+  // Set the ROS time received on the clock topic
+  /**
+   * The time is stored once for the clocks reading the shared time, and only the other clocks,
+   * whose rcl clock is used for timers or jump callbacks, are set and so locked.
+   * The clocks are iterated without locking the list.
+   */
+  void set_ros_time(rcl_time_point_value_t nanoseconds)
   {
-    std::lock_guard<std::mutex> guard(clock_list_lock_);
-    for (auto it = associated_clocks_.begin(); it != associated_clocks_.end(); ++it) {
-      set_clock(msg, set_ros_time_enabled, *it);
+    shared_ros_time_->set(nanoseconds);
+    const auto clocks = std::atomic_load(&associated_clocks_);
+    for (const auto & clock : *clocks) {
+      if (!clock->is_using_shared_ros_time()) {
+        set_clock(nanoseconds, true, clock);
+      }
     }
   }
 
-  // Cache the last clock message received
-  void cache_last_msg(std::shared_ptr<const rosgraph_msgs::msg::Clock> msg)
+  // Cache the last time received, in case ROS time is enabled or a new clock is attached
+  void cache_last_time(rcl_time_point_value_t nanoseconds)
   {
-    last_msg_set_ = msg;
+    shared_ros_time_->set(nanoseconds);
   }
 
   bool are_all_clocks_rcl_ros_time()
   {
     std::lock_guard<std::mutex> guard(clock_list_lock_);
-    for (auto & clock : associated_clocks_) {
+    for (auto & clock : *associated_clocks_) {
       std::lock_guard<std::mutex> clock_guard(clock->get_clock_mutex());
       if (clock->get_clock_type() != RCL_ROS_TIME) {
         return false;
@@ -187,19 +201,22 @@ public:
   }
 
 private:
+  using ClockList = std::vector<rclcpp::Clock::SharedPtr>;
+
   // Store (and update on node attach) logger for logging.
   Logger logger_;
 
-  // A lock to protect iterating the associated_clocks_ field.
+  // A lock to protect modifying the associated_clocks_ field.
   std::mutex clock_list_lock_;
-  // A vector to store references to associated clocks.
-  std::vector<rclcpp::Clock::SharedPtr> associated_clocks_;
+  // The associated clocks, replaced when a clock is attached or detached.
+  // Accessed with std::atomic_load() and std::atomic_store() only.
+  std::shared_ptr<const ClockList> associated_clocks_;
 
   // Local storage of validity of ROS time
   // This is needed when new clocks are added.
   bool ros_time_active_{false};
-  // Last set message to be passed to newly registered clocks
-  std::shared_ptr<const rosgraph_msgs::msg::Clock> last_msg_set_;
+  // Last time received, read directly by the clocks while ROS time is active
+  SharedRosTime::SharedPtr shared_ros_time_;
 };
 
 class TimeSource::NodeState final
@@ -240,6 +257,30 @@ public:
     return clock_executor_thread_.joinable();
   }
 
+  // Get the attributes the clock thread is created with
+  const rclcpp::ThreadAttributes & get_clock_thread_attributes() const
+  {
+    return clock_thread_attributes_;
+  }
+
+  // Set the attributes the clock thread is created with
+  void set_clock_thread_attributes(const rclcpp::ThreadAttributes & attributes)
+  {
+    clock_thread_attributes_ = attributes;
+  }
+
+  // Get whether use_sim_time is followed through the /parameter_events subscription
+  bool get_use_parameter_events() const
+  {
+    return use_parameter_events_;
+  }
+
+  // Set whether use_sim_time is followed through the /parameter_events subscription
+  void set_use_parameter_events(bool use_parameter_events)
+  {
+    use_parameter_events_ = use_parameter_events;
+  }
+
   // Attach a node to this time source
   void attachNode(
     rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_base_interface,
@@ -289,6 +330,12 @@ public:
     on_set_parameters_callback_ = node_parameters_->add_on_set_parameters_callback(
       std::bind(&TimeSource::NodeState::on_set_parameters, this, std::placeholders::_1));
 
+    if (!use_parameter_events_) {
+      // The parameters set on the node are seen without a subscription of the node
+      post_set_parameters_callback_ = node_parameters_->add_post_set_parameters_callback(
+        std::bind(&TimeSource::NodeState::on_parameters_set, this, std::placeholders::_1));
+      return;
+    }
 
     // TODO(tfoote) use parameters interface not subscribe to events via topic ticketed #609
     parameter_subscription_ = rclcpp::AsyncParametersClient::on_parameter_event(
@@ -313,6 +360,10 @@ public:
       node_parameters_->remove_on_set_parameters_callback(on_set_parameters_callback_.get());
     }
     on_set_parameters_callback_.reset();
+    if (post_set_parameters_callback_) {
+      node_parameters_->remove_post_set_parameters_callback(post_set_parameters_callback_.get());
+    }
+    post_set_parameters_callback_.reset();
     parameter_subscription_.reset();
     node_base_.reset();
     node_topics_.reset();
@@ -338,7 +389,9 @@ private:
 
   // Dedicated thread for clock subscription.
   bool use_clock_thread_;
-  std::thread clock_executor_thread_;
+  rclcpp::ThreadAttributes clock_thread_attributes_;
+  bool use_parameter_events_{true};
+  rclcpp::Thread clock_executor_thread_;
 
   // Preserve the node reference
   rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_base_{nullptr};
@@ -369,12 +422,11 @@ private:
     if (!clocks_state_.is_ros_time_active() && SET_TRUE == this->parameter_state_) {
       clocks_state_.enable_ros_time();
     }
-    // Cache the last message in case a new clock is attached.
-    clocks_state_.cache_last_msg(msg);
-    auto time_msg = std::make_shared<builtin_interfaces::msg::Time>(msg->clock);
-
+    const rcl_time_point_value_t nanoseconds = rclcpp::Time(msg->clock).nanoseconds();
     if (SET_TRUE == this->parameter_state_) {
-      clocks_state_.set_all_clocks(time_msg, true);
+      clocks_state_.set_ros_time(nanoseconds);
+    } else {
+      clocks_state_.cache_last_time(nanoseconds);
     }
   }
 
@@ -408,7 +460,8 @@ private:
         std::make_shared<rclcpp::executors::SingleThreadedExecutor>(exec_options);
       if (!clock_executor_thread_.joinable()) {
         cancel_clock_executor_promise_ = std::promise<void>{};
-        clock_executor_thread_ = std::thread(
+        clock_executor_thread_ = rclcpp::Thread(
+          clock_thread_attributes_,
           [this]() {
             auto future = cancel_clock_executor_promise_.get_future();
             clock_executor_->add_callback_group(clock_callback_group_, node_base_);
@@ -450,6 +503,9 @@ private:
   // On set Parameters callback handle
   node_interfaces::OnSetParametersCallbackHandle::SharedPtr on_set_parameters_callback_{nullptr};
 
+  // Post set Parameters callback handle, replacing the parameter event subscription
+  node_interfaces::PostSetParametersCallbackHandle::SharedPtr post_set_parameters_callback_;
+
   // Parameter Event subscription
   using ParamSubscriptionT = rclcpp::Subscription<rcl_interfaces::msg::ParameterEvent>;
   std::shared_ptr<ParamSubscriptionT> parameter_subscription_;
@@ -475,6 +531,25 @@ private:
     return result;
   }
 
+  // Callback for the parameters set on the node, instead of the parameter events
+  void on_parameters_set(const std::vector<rclcpp::Parameter> & parameters)
+  {
+    for (const auto & param : parameters) {
+      if (param.get_name() != "use_sim_time" || param.get_type() != rclcpp::PARAMETER_BOOL) {
+        continue;
+      }
+      if (param.as_bool()) {
+        parameter_state_ = SET_TRUE;
+        clocks_state_.enable_ros_time();
+        create_clock_sub();
+      } else {
+        parameter_state_ = SET_FALSE;
+        destroy_clock_sub();
+        clocks_state_.disable_ros_time();
+      }
+    }
+  }
+
   // Callback for parameter updates
   void on_parameter_event(std::shared_ptr<const rcl_interfaces::msg::ParameterEvent> event)
   {
@@ -537,6 +612,8 @@ TimeSource::TimeSource(
 void TimeSource::attachNode(rclcpp::Node::SharedPtr node)
 {
   node_state_->set_use_clock_thread(node->get_node_options().use_clock_thread());
+  node_state_->set_clock_thread_attributes(node->get_node_options().clock_thread_attributes());
+  node_state_->set_use_parameter_events(!node->get_node_options().lightweight());
   attachNode(
     node->get_node_base_interface(),
     node->get_node_topics_interface(),
@@ -568,10 +645,14 @@ void TimeSource::attachNode(
 
 void TimeSource::detachNode()
 {
+  rclcpp::ThreadAttributes clock_thread_attributes = node_state_->get_clock_thread_attributes();
+  const bool use_parameter_events = node_state_->get_use_parameter_events();
   node_state_.reset();
   node_state_ = std::make_shared<NodeState>(
     constructed_qos_,
     constructed_use_clock_thread_);
+  node_state_->set_clock_thread_attributes(clock_thread_attributes);
+  node_state_->set_use_parameter_events(use_parameter_events);
 }
 
 void TimeSource::attachClock(std::shared_ptr<rclcpp::Clock> clock)
@@ -599,6 +680,26 @@ bool TimeSource::clock_thread_is_joinable()
   return node_state_->clock_thread_is_joinable();
 }
 
+rclcpp::ThreadAttributes TimeSource::get_clock_thread_attributes()
+{
+  return node_state_->get_clock_thread_attributes();
+}
+
+void TimeSource::set_clock_thread_attributes(const rclcpp::ThreadAttributes & attributes)
+{
+  node_state_->set_clock_thread_attributes(attributes);
+}
+
+bool TimeSource::get_use_parameter_events()
+{
+  return node_state_->get_use_parameter_events();
+}
+
+void TimeSource::set_use_parameter_events(bool use_parameter_events)
+{
+  node_state_->set_use_parameter_events(use_parameter_events);
+}
+
 TimeSource::~TimeSource()
 {
 }
@@ -14,6 +14,7 @@
 
 #include "rclcpp/timer.hpp"
 
+#include <algorithm>
 #include <chrono>
 #include <string>
 #include <memory>
@@ -21,6 +22,7 @@
 
 #include "rclcpp/contexts/default_context.hpp"
 #include "rclcpp/exceptions.hpp"
+#include "rclcpp/flight_recorder.hpp"
 
 #include "rcutils/logging_macros.h"
 
@@ -127,6 +129,86 @@ TimerBase::time_until_trigger()
   return std::chrono::nanoseconds(time_until_next_call);
 }
 
+std::chrono::nanoseconds
+TimerBase::get_period() const
+{
+  int64_t period = 0;
+  rcl_ret_t ret = rcl_timer_get_period(timer_handle_.get(), &period);
+  if (ret != RCL_RET_OK) {
+    rclcpp::exceptions::throw_from_rcl_error(ret, "Timer could not get its period");
+  }
+  return std::chrono::nanoseconds(period);
+}
+
+TimerBase::LatenessStatistics
+TimerBase::get_lateness_statistics() const
+{
+  std::lock_guard<std::mutex> lock(lateness_statistics_mutex_);
+  return lateness_statistics_;
+}
+
+void
+TimerBase::reset_lateness_statistics()
+{
+  std::lock_guard<std::mutex> lock(lateness_statistics_mutex_);
+  lateness_statistics_ = LatenessStatistics();
+}
+
+void
+TimerBase::record_lateness(std::chrono::nanoseconds lateness)
+{
+  std::lock_guard<std::mutex> lock(lateness_statistics_mutex_);
+  lateness_statistics_.call_count++;
+  lateness_statistics_.last_lateness = lateness;
+  lateness_statistics_.max_lateness = std::max(lateness_statistics_.max_lateness, lateness);
+  lateness_statistics_.total_lateness += lateness;
+}
+
+rclcpp::TimerStatistics::SharedPtr
+TimerBase::enable_statistics()
+{
+  std::lock_guard<std::mutex> lock(statistics_mutex_);
+  if (!statistics_) {
+    statistics_ = std::make_shared<TimerStatistics>();
+    statistics_ptr_.store(statistics_.get(), std::memory_order_release);
+  }
+  return statistics_;
+}
+
+rclcpp::TimerStatistics::SharedPtr
+TimerBase::get_statistics() const
+{
+  std::lock_guard<std::mutex> lock(statistics_mutex_);
+  return statistics_;
+}
+
+void
+TimerBase::record_call_statistics()
+{
+  TimerStatistics * statistics = statistics_ptr_.load(std::memory_order_acquire);
+  const bool record_lateness = rclcpp::FlightRecorder::is_enabled();
+  if (!statistics && !record_lateness) {
+    return;
+  }
+  int64_t time_until_next_call = 0;
+  rcl_ret_t ret = rcl_timer_get_time_until_next_call(
+    timer_handle_.get(), &time_until_next_call);
+  if (ret != RCL_RET_OK) {
+    // Canceled, the call fails and won't be measured
+    rcl_reset_error();
+    return;
+  }
+  if (record_lateness) {
+    // The next call time is still the one of this call, which is late if it is in the past
+    rclcpp::FlightRecorder::record(
+      rclcpp::FlightRecorderEventType::TimerLateness, this, -time_until_next_call);
+  }
+  if (!statistics) {
+    return;
+  }
+  statistics->on_call(clock_->now().nanoseconds() + time_until_next_call, get_period());
+}
+
 std::shared_ptr<const rcl_timer_t>
 TimerBase::get_timer_handle()
 {
@@ -0,0 +1,225 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/timer_coalescer.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/create_timer.hpp"
+#include "rclcpp/node_interfaces/node_base_interface.hpp"
+#include "rclcpp/node_interfaces/node_timers_interface.hpp"
+
+using rclcpp::CoalescedTimer;
+using rclcpp::TimerCoalescer;
+
+CoalescedTimer::CoalescedTimer(
+  std::weak_ptr<TimerCoalescer> coalescer,
+  std::shared_ptr<Member> member,
+  std::chrono::nanoseconds period)
+: coalescer_(std::move(coalescer)), member_(std::move(member)), period_(period)
+{}
+
+CoalescedTimer::~CoalescedTimer()
+{
+  cancel();
+}
+
+void
+CoalescedTimer::cancel()
+{
+  if (member_->canceled.exchange(true)) {
+    return;
+  }
+  if (auto coalescer = coalescer_.lock()) {
+    coalescer->remove_member(member_, period_);
+  }
+}
+
+bool
+CoalescedTimer::is_canceled() const
+{
+  return member_->canceled.load();
+}
+
+std::chrono::nanoseconds
+CoalescedTimer::get_period() const
+{
+  return period_;
+}
+
+TimerCoalescer::TimerCoalescer(
+  rclcpp::node_interfaces::NodeBaseInterface * node_base,
+  rclcpp::node_interfaces::NodeTimersInterface * node_timers)
+: node_base_(node_base),
+  node_timers_(node_timers),
+  steady_clock_(std::make_shared<rclcpp::Clock>(RCL_STEADY_TIME))
+{
+  if (node_base_ == nullptr) {
+    throw std::invalid_argument{"input node_base cannot be null"};
+  }
+  if (node_timers_ == nullptr) {
+    throw std::invalid_argument{"input node_timers cannot be null"};
+  }
+}
+
+TimerCoalescer::~TimerCoalescer()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto & entry : shared_timers_) {
+    entry.second->timer->cancel();
+  }
+}
+
+CoalescedTimer::SharedPtr
+TimerCoalescer::add_timer(
+  rclcpp::Clock::SharedPtr clock,
+  std::chrono::nanoseconds period,
+  std::chrono::nanoseconds tolerance,
+  std::function<void ()> callback,
+  rclcpp::CallbackGroup::SharedPtr group)
+{
+  if (clock == nullptr) {
+    throw std::invalid_argument{"clock cannot be null"};
+  }
+  if (!callback) {
+    throw std::invalid_argument{"coalesced timer callback cannot be empty"};
+  }
+  if (period < std::chrono::nanoseconds::zero()) {
+    throw std::invalid_argument{"timer period cannot be negative"};
+  }
+  if (tolerance < std::chrono::nanoseconds::zero()) {
+    throw std::invalid_argument{"timer coalescing tolerance cannot be negative"};
+  }
+  if (!group) {
+    group = node_base_->get_default_callback_group();
+  }
+
+  auto member = std::make_shared<CoalescedTimer::Member>();
+  member->callback = std::move(callback);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Join the shared timer with the closest period within the tolerance
+  std::shared_ptr<SharedTimer> shared_timer;
+  const auto lower = period > tolerance ? period - tolerance : std::chrono::nanoseconds::zero();
+  const auto upper = std::chrono::nanoseconds::max() - tolerance > period ?
+    period + tolerance : std::chrono::nanoseconds::max();
+  for (
+    auto it = shared_timers_.lower_bound(lower);
+    it != shared_timers_.end() && it->first <= upper; ++it)
+  {
+    if (it->second->clock != clock || it->second->group.lock() != group) {
+      continue;
+    }
+    if (
+      !shared_timer ||
+      std::chrono::abs(it->first - period) < std::chrono::abs(shared_timer->period - period))
+    {
+      shared_timer = it->second;
+    }
+  }
+
+  if (shared_timer) {
+    std::lock_guard<std::mutex> members_lock(shared_timer->members_mutex);
+    shared_timer->members.push_back(member);
+  } else {
+    shared_timer = std::make_shared<SharedTimer>();
+    shared_timer->clock = clock;
+    shared_timer->group = group;
+    shared_timer->period = period;
+    shared_timer->members.push_back(member);
+    std::weak_ptr<SharedTimer> weak_shared_timer = shared_timer;
+    shared_timer->timer = rclcpp::create_timer(
+      std::move(clock), period,
+      [weak_shared_timer]() {call_members(weak_shared_timer);},
+      group, node_base_, node_timers_);
+    shared_timers_.emplace(period, shared_timer);
+  }
+  return CoalescedTimer::SharedPtr(
+    new CoalescedTimer(weak_from_this(), std::move(member), shared_timer->period));
+}
+
+rclcpp::Clock::SharedPtr
+TimerCoalescer::get_steady_clock() const
+{
+  return steady_clock_;
+}
+
+size_t
+TimerCoalescer::get_number_of_shared_timers() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return shared_timers_.size();
+}
+
+size_t
+TimerCoalescer::get_number_of_coalesced_timers() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t number_of_timers = 0;
+  for (const auto & entry : shared_timers_) {
+    std::lock_guard<std::mutex> members_lock(entry.second->members_mutex);
+    number_of_timers += entry.second->members.size();
+  }
+  return number_of_timers;
+}
+
+void
+TimerCoalescer::remove_member(
+  const std::shared_ptr<CoalescedTimer::Member> & member,
+  std::chrono::nanoseconds period)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto range = shared_timers_.equal_range(period);
+  for (auto it = range.first; it != range.second; ++it) {
+    SharedTimer & shared_timer = *it->second;
+    std::unique_lock<std::mutex> members_lock(shared_timer.members_mutex);
+    auto member_it =
+      std::find(shared_timer.members.begin(), shared_timer.members.end(), member);
+    if (member_it == shared_timer.members.end()) {
+      continue;
+    }
+    shared_timer.members.erase(member_it);
+    if (shared_timer.members.empty()) {
+      members_lock.unlock();
+      shared_timer.timer->cancel();
+      // The timer is removed from its callback group once destroyed
+      shared_timers_.erase(it);
+    }
+    return;
+  }
+}
+
+void
+TimerCoalescer::call_members(const std::weak_ptr<SharedTimer> & weak_shared_timer)
+{
+  auto shared_timer = weak_shared_timer.lock();
+  if (!shared_timer) {
+    return;
+  }
+  std::vector<std::shared_ptr<CoalescedTimer::Member>> members;
+  {
+    std::lock_guard<std::mutex> members_lock(shared_timer->members_mutex);
+    members = shared_timer->members;
+  }
+  for (const auto & member : members) {
+    // An earlier callback may have canceled this timer
+    if (!member->canceled.load()) {
+      member->callback();
+    }
+  }
+}
@@ -0,0 +1,101 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/timer_statistics.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+#include "rclcpp/clock.hpp"
+
+using rclcpp::TimerStatistics;
+
+namespace
+{
+
+double
+to_milliseconds(int64_t nanoseconds)
+{
+  return std::chrono::duration<double, std::milli>(std::chrono::nanoseconds(nanoseconds)).count();
+}
+
+}  // namespace
+
+TimerStatistics::CallbackScope::CallbackScope(
+  TimerStatistics * statistics,
+  rclcpp::Clock & clock)
+: statistics_(statistics)
+{
+  if (!statistics_) {
+    return;
+  }
+  statistics_->record_start(clock.now().nanoseconds());
+  start_ = std::chrono::steady_clock::now();
+}
+
+TimerStatistics::CallbackScope::~CallbackScope()
+{
+  if (!statistics_) {
+    return;
+  }
+  const auto duration = std::chrono::steady_clock::now() - start_;
+  statistics_->execution_time_.add_sample(
+    to_milliseconds(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()));
+}
+
+TimerStatistics::TimerStatistics()
+{}
+
+TimerStatistics::Snapshot
+TimerStatistics::get_snapshot() const
+{
+  StatisticData execution_time = execution_time_.get_statistics();
+  return Snapshot{
+    execution_time.sample_count,
+    missed_periods_.load(std::memory_order_relaxed),
+    lateness_.get_statistics(),
+    execution_time,
+    lateness_histogram_.get_snapshot()};
+}
+
+TimerStatistics::Snapshot
+TimerStatistics::take_snapshot()
+{
+  StatisticData execution_time = execution_time_.take_statistics();
+  return Snapshot{
+    execution_time.sample_count,
+    missed_periods_.exchange(0, std::memory_order_relaxed),
+    lateness_.take_statistics(),
+    execution_time,
+    lateness_histogram_.take_snapshot()};
+}
+
+void
+TimerStatistics::record_start(int64_t start_time) noexcept
+{
+  const int64_t scheduled_time = scheduled_time_.exchange(
+    kNoScheduledTime, std::memory_order_relaxed);
+  // The callback may be executed without calling the timer, e.g. by the user, it isn't late then
+  if (kNoScheduledTime == scheduled_time) {
+    return;
+  }
+  const int64_t lateness = std::max<int64_t>(0, start_time - scheduled_time);
+  lateness_histogram_.add_sample(static_cast<uint64_t>(lateness));
+  lateness_.add_sample(to_milliseconds(lateness));
+  const int64_t period = period_.load(std::memory_order_relaxed);
+  if (period > 0 && lateness >= period) {
+    missed_periods_.fetch_add(static_cast<uint64_t>(lateness / period), std::memory_order_relaxed);
+  }
+}
@@ -0,0 +1,343 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/timer_wheel.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/create_timer.hpp"
+
+using rclcpp::TimerWheel;
+
+namespace
+{
+
+/// Return the number of whole ticks elapsed from the start time to the given time.
+uint64_t
+get_elapsed_ticks(
+  std::chrono::steady_clock::time_point start_time,
+  std::chrono::nanoseconds resolution,
+  std::chrono::steady_clock::time_point time)
+{
+  if (time <= start_time) {
+    return 0;
+  }
+  return static_cast<uint64_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(time - start_time) / resolution);
+}
+
+}  // namespace
+
+TimerWheel::TimerWheel(
+  std::chrono::nanoseconds resolution,
+  std::chrono::steady_clock::time_point start_time)
+: resolution_(resolution), start_time_(start_time)
+{
+  if (resolution_ <= std::chrono::nanoseconds::zero()) {
+    throw std::invalid_argument("timer wheel resolution must be positive");
+  }
+  for (auto & level : slots_) {
+    level.fill(kNone);
+  }
+}
+
+TimerWheel::~TimerWheel()
+{
+  if (tick_timer_) {
+    tick_timer_->cancel();
+  }
+}
+
+TimerWheel::TimerId
+TimerWheel::add_timer(std::chrono::nanoseconds period, Callback callback)
+{
+  if (period < std::chrono::nanoseconds::zero()) {
+    throw std::invalid_argument("timer wheel period must not be negative");
+  }
+  if (!callback) {
+    throw std::invalid_argument("timer wheel callback must not be empty");
+  }
+  // Round up to whole ticks, a timer expires at the earliest on the next tick
+  const uint64_t period_ticks = std::max<uint64_t>(
+    1u, static_cast<uint64_t>((period.count() + resolution_.count() - 1) / resolution_.count()));
+  const uint64_t now_tick =
+    get_elapsed_ticks(start_time_, resolution_, std::chrono::steady_clock::now());
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  uint32_t index = free_entries_;
+  if (index != kNone) {
+    free_entries_ = entries_[index].next;
+  } else {
+    if (entries_.size() >= kNone) {
+      throw std::length_error("timer wheel is full");
+    }
+    index = static_cast<uint32_t>(entries_.size());
+    entries_.emplace_back();
+  }
+  Entry & entry = entries_[index];
+  entry.callback = std::make_shared<const Callback>(std::move(callback));
+  entry.period_ticks = period_ticks;
+  // When this wheel lags behind, the period starts from the actual time
+  entry.expiry_tick = std::max(now_tick, current_tick_) + period_ticks;
+  entry.last_advance = 0;
+  entry.active = true;
+  link(index);
+  if (++size_ == 1) {
+    update_tick_timer();
+  }
+  return (static_cast<TimerId>(entry.generation) << 32) | index;
+}
+
+bool
+TimerWheel::cancel(TimerId timer_id)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  const uint32_t index = find_entry(timer_id);
+  if (index == kNone) {
+    return false;
+  }
+  unlink(index);
+  Entry & entry = entries_[index];
+  entry.callback.reset();
+  entry.active = false;
+  // Identifiers aren't reused, as long as the generation doesn't wrap around
+  ++entry.generation;
+  entry.next = free_entries_;
+  free_entries_ = index;
+  if (--size_ == 0) {
+    update_tick_timer();
+  }
+  return true;
+}
+
+bool
+TimerWheel::reset(TimerId timer_id)
+{
+  const uint64_t now_tick =
+    get_elapsed_ticks(start_time_, resolution_, std::chrono::steady_clock::now());
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  const uint32_t index = find_entry(timer_id);
+  if (index == kNone) {
+    return false;
+  }
+  unlink(index);
+  Entry & entry = entries_[index];
+  entry.expiry_tick = std::max(now_tick, current_tick_) + entry.period_ticks;
+  link(index);
+  return true;
+}
+
+size_t
+TimerWheel::size() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return size_;
+}
+
+std::chrono::nanoseconds
+TimerWheel::get_resolution() const
+{
+  return resolution_;
+}
+
+size_t
+TimerWheel::advance(std::chrono::steady_clock::time_point now)
+{
+  const uint64_t target_tick = get_elapsed_ticks(start_time_, resolution_, now);
+
+  struct Expired
+  {
+    std::shared_ptr<const Callback> callback;
+    TimerId timer_id;
+  };
+  std::vector<Expired> expired;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++advance_count_;
+    if (size_ == 0) {
+      // Nothing to expire or to cascade
+      current_tick_ = std::max(current_tick_, target_tick);
+    }
+    while (current_tick_ < target_tick) {
+      ++current_tick_;
+      // Refill the lower levels each time they wrap around
+      for (size_t level = 1; level < kLevels; ++level) {
+        if (((current_tick_ >> (kSlotBits * (level - 1))) & (kSlotsPerLevel - 1)) != 0) {
+          break;
+        }
+        cascade(level);
+      }
+      if ((current_tick_ & ((uint64_t{1} << (kSlotBits * kLevels)) - 1)) == 0) {
+        cascade(kLevels);
+      }
+
+      uint32_t & slot = slots_[0][current_tick_ & (kSlotsPerLevel - 1)];
+      while (slot != kNone) {
+        const uint32_t index = slot;
+        unlink(index);
+        Entry & entry = entries_[index];
+        // Periodic timers stay in phase, even when expirations were missed
+        entry.expiry_tick += entry.period_ticks;
+        if (entry.expiry_tick <= current_tick_) {
+          const uint64_t missed = (current_tick_ - entry.expiry_tick) / entry.period_ticks + 1;
+          entry.expiry_tick += missed * entry.period_ticks;
+        }
+        link(index);
+        if (entry.last_advance != advance_count_) {
+          entry.last_advance = advance_count_;
+          const TimerId timer_id = (static_cast<TimerId>(entry.generation) << 32) | index;
+          expired.push_back({entry.callback, timer_id});
+        }
+      }
+    }
+  }
+
+  size_t called = 0;
+  for (const Expired & timer : expired) {
+    {
+      // An earlier callback may have canceled this timer
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (find_entry(timer.timer_id) == kNone) {
+        continue;
+      }
+    }
+    (*timer.callback)();
+    ++called;
+  }
+  return called;
+}
+
+void
+TimerWheel::set_tick_timer(rclcpp::TimerBase::SharedPtr tick_timer)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  tick_timer_ = std::move(tick_timer);
+  tick_timer_running_ = true;
+  update_tick_timer();
+}
+
+uint32_t
+TimerWheel::find_entry(TimerId timer_id) const
+{
+  const auto index = static_cast<uint32_t>(timer_id & 0xFFFFFFFFu);
+  const auto generation = static_cast<uint32_t>(timer_id >> 32);
+  if (
+    index >= entries_.size() || !entries_[index].active ||
+    entries_[index].generation != generation)
+  {
+    return kNone;
+  }
+  return index;
+}
+
+void
+TimerWheel::link(uint32_t index)
+{
+  Entry & entry = entries_[index];
+  const uint64_t delta = entry.expiry_tick - current_tick_;
+  uint32_t * head = &overflow_;
+  entry.slot = kNone;
+  for (size_t level = 0; level < kLevels; ++level) {
+    if (delta < (uint64_t{1} << (kSlotBits * (level + 1)))) {
+      const auto slot = static_cast<uint32_t>(
+        (entry.expiry_tick >> (kSlotBits * level)) & (kSlotsPerLevel - 1));
+      entry.slot = static_cast<uint32_t>(level * kSlotsPerLevel + slot);
+      head = &slots_[level][slot];
+      break;
+    }
+  }
+  entry.previous = kNone;
+  entry.next = *head;
+  if (*head != kNone) {
+    entries_[*head].previous = index;
+  }
+  *head = index;
+}
+
+void
+TimerWheel::unlink(uint32_t index)
+{
+  Entry & entry = entries_[index];
+  if (entry.previous != kNone) {
+    entries_[entry.previous].next = entry.next;
+  } else if (entry.slot == kNone) {
+    overflow_ = entry.next;
+  } else {
+    slots_[entry.slot / kSlotsPerLevel][entry.slot % kSlotsPerLevel] = entry.next;
+  }
+  if (entry.next != kNone) {
+    entries_[entry.next].previous = entry.previous;
+  }
+  entry.previous = kNone;
+  entry.next = kNone;
+}
+
+void
+TimerWheel::cascade(size_t level)
+{
+  uint32_t * head = level < kLevels ?
+    &slots_[level][(current_tick_ >> (kSlotBits * level)) & (kSlotsPerLevel - 1)] :
+    &overflow_;
+  uint32_t index = *head;
+  *head = kNone;
+  while (index != kNone) {
+    const uint32_t next = entries_[index].next;
+    link(index);
+    index = next;
+  }
+}
+
+void
+TimerWheel::update_tick_timer()
+{
+  if (!tick_timer_) {
+    return;
+  }
+  const bool running = size_ > 0;
+  if (running == tick_timer_running_) {
+    return;
+  }
+  tick_timer_running_ = running;
+  if (running) {
+    tick_timer_->reset();
+  } else {
+    tick_timer_->cancel();
+  }
+}
+
+TimerWheel::SharedPtr
+rclcpp::create_timer_wheel(
+  rclcpp::node_interfaces::NodeBaseInterface * node_base,
+  rclcpp::node_interfaces::NodeTimersInterface * node_timers,
+  std::chrono::nanoseconds resolution,
+  rclcpp::CallbackGroup::SharedPtr group)
+{
+  auto wheel = std::make_shared<TimerWheel>(resolution);
+  std::weak_ptr<TimerWheel> weak_wheel = wheel;
+  auto tick_timer = rclcpp::create_wall_timer(
+    resolution,
+    [weak_wheel]() {
+      if (auto wheel = weak_wheel.lock()) {
+        wheel->advance(std::chrono::steady_clock::now());
+      }
+    },
+    std::move(group), node_base, node_timers);
+  wheel->set_tick_timer(std::move(tick_timer));
+  return wheel;
+}
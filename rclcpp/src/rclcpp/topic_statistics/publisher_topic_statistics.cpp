@@ -0,0 +1,177 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "rclcpp/topic_statistics/publisher_topic_statistics.hpp"
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "libstatistics_collector/collector/generate_statistics_message.hpp"
+
+#include "rclcpp/publisher.hpp"
+#include "rclcpp/timer.hpp"
+
+using rclcpp::topic_statistics::PublisherTopicStatistics;
+
+namespace
+{
+
+thread_local PublisherTopicStatistics * g_current_statistics = nullptr;
+
+int64_t
+get_steady_nanoseconds()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int64_t
+get_current_nanoseconds_since_epoch()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+double
+to_milliseconds(int64_t nanoseconds)
+{
+  return std::chrono::duration<double, std::milli>(std::chrono::nanoseconds(nanoseconds)).count();
+}
+
+}  // namespace
+
+PublisherTopicStatistics::Scope::Scope(PublisherTopicStatistics * statistics) noexcept
+: statistics_(nullptr), parent_(g_current_statistics), start_(0)
+{
+  if (!statistics || statistics == parent_) {
+    return;
+  }
+  statistics_ = statistics;
+  g_current_statistics = statistics;
+  start_ = get_steady_nanoseconds();
+}
+
+PublisherTopicStatistics::Scope::~Scope()
+{
+  if (!statistics_) {
+    return;
+  }
+  statistics_->record_publish(start_, get_steady_nanoseconds());
+  g_current_statistics = parent_;
+}
+
+PublisherTopicStatistics::PublisherTopicStatistics(
+  const std::string & node_name,
+  std::shared_ptr<MetricsPublisher> publisher)
+: node_name_(node_name),
+  publisher_(std::move(publisher)),
+  window_start_(get_current_nanoseconds_since_epoch())
+{
+  if (nullptr == publisher_) {
+    throw std::invalid_argument("publisher pointer is nullptr");
+  }
+}
+
+PublisherTopicStatistics::~PublisherTopicStatistics()
+{
+  if (publisher_timer_) {
+    publisher_timer_->cancel();
+    publisher_timer_.reset();
+  }
+  publisher_.reset();
+}
+
+void
+PublisherTopicStatistics::set_publisher_timer(std::shared_ptr<rclcpp::TimerBase> publisher_timer)
+{
+  publisher_timer_ = std::move(publisher_timer);
+}
+
+void
+PublisherTopicStatistics::publish_message_and_reset_measurements()
+{
+  using libstatistics_collector::collector::GenerateStatisticMessage;
+
+  rclcpp::Time window_end{get_current_nanoseconds_since_epoch()};
+  std::vector<statistics_msgs::msg::MetricsMessage> msgs;
+  msgs.push_back(
+    GenerateStatisticMessage(
+      node_name_, kPublishPeriodName, kMillisecondUnitName, window_start_, window_end,
+      publish_period_.take_statistics()));
+  msgs.push_back(
+    GenerateStatisticMessage(
+      node_name_, kPublishDurationName, kMillisecondUnitName, window_start_, window_end,
+      publish_duration_.take_statistics()));
+  msgs.push_back(
+    GenerateStatisticMessage(
+      node_name_, kSerializedMessageSizeName, kByteUnitName, window_start_, window_end,
+      serialized_message_size_.take_statistics()));
+
+  const std::pair<const char *, uint64_t> counts[] = {
+    {kIntraProcessPublishedMessagesName,
+      intra_process_count_.exchange(0, std::memory_order_relaxed)},
+    {kInterProcessPublishedMessagesName,
+      inter_process_count_.exchange(0, std::memory_order_relaxed)},
+  };
+  for (const auto & count : counts) {
+    // A single sample, taken at the end of the window
+    StatisticData data;
+    data.average = static_cast<double>(count.second);
+    data.min = data.average;
+    data.max = data.average;
+    data.standard_deviation = 0.0;
+    data.sample_count = 1;
+    msgs.push_back(
+      GenerateStatisticMessage(
+        node_name_, count.first, kPublishedMessagesUnitName, window_start_, window_end, data));
+  }
+
+  for (auto & msg : msgs) {
+    publisher_->publish(msg);
+  }
+  window_start_ = window_end;
+}
+
+std::vector<PublisherTopicStatistics::StatisticData>
+PublisherTopicStatistics::get_current_collector_data() const
+{
+  return {
+    publish_period_.get_statistics(),
+    publish_duration_.get_statistics(),
+    serialized_message_size_.get_statistics()};
+}
+
+std::pair<uint64_t, uint64_t>
+PublisherTopicStatistics::get_current_published_message_counts() const
+{
+  return {
+    intra_process_count_.load(std::memory_order_relaxed),
+    inter_process_count_.load(std::memory_order_relaxed)};
+}
+
+void
+PublisherTopicStatistics::record_publish(int64_t start, int64_t end) noexcept
+{
+  publish_duration_.add_sample(to_milliseconds(end - start));
+  const int64_t last_publish_time = last_publish_time_.exchange(start, std::memory_order_relaxed);
+  // The first call only starts the measurement, the concurrent ones may be out of order
+  if (last_publish_time != kNoPublishTime && start >= last_publish_time) {
+    publish_period_.add_sample(to_milliseconds(start - last_publish_time));
+  }
+}
@@ -0,0 +1,135 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/topic_statistics/timer_statistics_publisher.hpp"
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "libstatistics_collector/collector/generate_statistics_message.hpp"
+
+using rclcpp::topic_statistics::TimerStatisticsPublisher;
+
+namespace
+{
+
+int64_t
+get_current_nanoseconds_since_epoch()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+/// Return the statistics of a single sample, taken at the end of the window.
+rclcpp::TimerStatistics::StatisticData
+single_sample(double value)
+{
+  rclcpp::TimerStatistics::StatisticData data;
+  data.average = value;
+  data.min = value;
+  data.max = value;
+  data.standard_deviation = 0.0;
+  data.sample_count = 1;
+  return data;
+}
+
+}  // namespace
+
+TimerStatisticsPublisher::TimerStatisticsPublisher(
+  const std::string & source_name,
+  rclcpp::TimerStatistics::SharedPtr statistics,
+  std::shared_ptr<MetricsPublisher> publisher)
+: source_name_(source_name),
+  statistics_(std::move(statistics)),
+  publisher_(std::move(publisher)),
+  window_start_(get_current_nanoseconds_since_epoch())
+{
+  if (nullptr == statistics_) {
+    throw std::invalid_argument("statistics pointer is nullptr");
+  }
+  if (nullptr == publisher_) {
+    throw std::invalid_argument("publisher pointer is nullptr");
+  }
+}
+
+TimerStatisticsPublisher::~TimerStatisticsPublisher()
+{
+  if (publisher_timer_) {
+    publisher_timer_->cancel();
+    publisher_timer_.reset();
+  }
+  publisher_.reset();
+}
+
+void
+TimerStatisticsPublisher::set_publisher_timer(std::shared_ptr<rclcpp::TimerBase> publisher_timer)
+{
+  publisher_timer_ = std::move(publisher_timer);
+}
+
+void
+TimerStatisticsPublisher::publish_message_and_reset_measurements()
+{
+  rclcpp::Time window_end{get_current_nanoseconds_since_epoch()};
+  for (auto & msg : generate_messages(
+      source_name_, statistics_->take_snapshot(), window_start_, window_end))
+  {
+    publisher_->publish(msg);
+  }
+  window_start_ = window_end;
+}
+
+std::vector<statistics_msgs::msg::MetricsMessage>
+TimerStatisticsPublisher::generate_messages(
+  const std::string & source_name,
+  const rclcpp::TimerStatistics::Snapshot & snapshot,
+  const rclcpp::Time & window_start,
+  const rclcpp::Time & window_end)
+{
+  using libstatistics_collector::collector::GenerateStatisticMessage;
+
+  std::vector<statistics_msgs::msg::MetricsMessage> msgs;
+  msgs.push_back(
+    GenerateStatisticMessage(
+      source_name, kTimerLatenessName, kMillisecondUnitName, window_start, window_end,
+      snapshot.lateness));
+  if (snapshot.lateness_histogram.get_count() > 0) {
+    const std::pair<const char *, double> percentiles[] = {
+      {kTimerLatenessP50Name, 50.0},
+      {kTimerLatenessP90Name, 90.0},
+      {kTimerLatenessP99Name, 99.0},
+    };
+    for (const auto & percentile : percentiles) {
+      const auto lateness = std::chrono::nanoseconds(
+        snapshot.lateness_histogram.get_value_at_percentile(percentile.second));
+      msgs.push_back(
+        GenerateStatisticMessage(
+          source_name, percentile.first, kMillisecondUnitName, window_start, window_end,
+          single_sample(std::chrono::duration<double, std::milli>(lateness).count())));
+    }
+  }
+  msgs.push_back(
+    GenerateStatisticMessage(
+      source_name, kTimerExecutionTimeName, kMillisecondUnitName, window_start, window_end,
+      snapshot.execution_time));
+  msgs.push_back(
+    GenerateStatisticMessage(
+      source_name, kTimerMissedPeriodsName, kTimerMissedPeriodsUnitName, window_start,
+      window_end, single_sample(static_cast<double>(snapshot.missed_periods))));
+  return msgs;
+}
@@ -28,6 +28,7 @@
 #include "rcpputils/shared_library.hpp"
 #include "rcpputils/find_library.hpp"
 #include "rosidl_runtime_cpp/message_type_support_decl.hpp"
+#include "rosidl_runtime_cpp/service_type_support_decl.hpp"
 
 namespace rclcpp
 {
@@ -133,4 +134,30 @@ get_typesupport_handle(
   }
 }
 
+const rosidl_service_type_support_t *
+get_service_typesupport_handle(
+  const std::string & type,
+  const std::string & typesupport_identifier,
+  rcpputils::SharedLibrary & library)
+{
+  std::string package_name;
+  std::string middle_module;
+  std::string type_name;
+  std::tie(package_name, middle_module, type_name) = extract_type_identifier(type);
+
+  try {
+    std::string symbol_name = typesupport_identifier + "__get_service_type_support_handle__" +
+      package_name + "__" + (middle_module.empty() ? "srv" : middle_module) + "__" + type_name;
+
+    const rosidl_service_type_support_t * (* get_ts)() = nullptr;
+    // This will throw runtime_error if the symbol was not found.
+    get_ts = reinterpret_cast<decltype(get_ts)>(library.get_symbol(symbol_name));
+    return get_ts();
+  } catch (std::runtime_error &) {
+    throw std::runtime_error{
+            "Something went wrong loading the typesupport library for service type " +
+            package_name + "/" + type_name + ". Library could not be found."};
+  }
+}
+
 }  // namespace rclcpp
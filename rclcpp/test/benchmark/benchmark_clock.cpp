@@ -0,0 +1,103 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "performance_test_fixture/performance_test_fixture.hpp"
+
+#include "rclcpp/clock.hpp"
+#include "rclcpp/time.hpp"
+
+using performance_test_fixture::PerformanceTest;
+
+namespace
+{
+
+void
+benchmark_rcl_clock_get_now(benchmark::State & state, rclcpp::Clock & clock)
+{
+  rcl_clock_t * clock_handle = clock.get_clock_handle();
+  rcl_time_point_value_t nanoseconds = 0;
+  for (auto _ : state) {
+    (void)_;
+    if (rcl_clock_get_now(clock_handle, &nanoseconds) != RCL_RET_OK) {
+      state.SkipWithError("rcl_clock_get_now failed");
+      break;
+    }
+    benchmark::DoNotOptimize(nanoseconds);
+  }
+}
+
+void
+benchmark_now(benchmark::State & state, const rclcpp::Clock & clock)
+{
+  for (auto _ : state) {
+    (void)_;
+    rclcpp::Time now = clock.now();
+    benchmark::DoNotOptimize(now);
+  }
+}
+
+void
+benchmark_now_nanoseconds(benchmark::State & state, const rclcpp::Clock & clock)
+{
+  for (auto _ : state) {
+    (void)_;
+    rcl_time_point_value_t nanoseconds = clock.now_nanoseconds();
+    benchmark::DoNotOptimize(nanoseconds);
+  }
+}
+
+}  // namespace
+
+BENCHMARK_F(PerformanceTest, steady_rcl_clock_get_now)(benchmark::State & state)
+{
+  rclcpp::Clock clock(RCL_STEADY_TIME);
+  reset_heap_counters();
+  benchmark_rcl_clock_get_now(state, clock);
+}
+
+BENCHMARK_F(PerformanceTest, steady_now)(benchmark::State & state)
+{
+  rclcpp::Clock clock(RCL_STEADY_TIME);
+  reset_heap_counters();
+  benchmark_now(state, clock);
+}
+
+BENCHMARK_F(PerformanceTest, steady_now_nanoseconds)(benchmark::State & state)
+{
+  rclcpp::Clock clock(RCL_STEADY_TIME);
+  reset_heap_counters();
+  benchmark_now_nanoseconds(state, clock);
+}
+
+BENCHMARK_F(PerformanceTest, system_rcl_clock_get_now)(benchmark::State & state)
+{
+  rclcpp::Clock clock(RCL_SYSTEM_TIME);
+  reset_heap_counters();
+  benchmark_rcl_clock_get_now(state, clock);
+}
+
+BENCHMARK_F(PerformanceTest, system_now)(benchmark::State & state)
+{
+  rclcpp::Clock clock(RCL_SYSTEM_TIME);
+  reset_heap_counters();
+  benchmark_now(state, clock);
+}
+
+BENCHMARK_F(PerformanceTest, system_now_nanoseconds)(benchmark::State & state)
+{
+  rclcpp::Clock clock(RCL_SYSTEM_TIME);
+  reset_heap_counters();
+  benchmark_now_nanoseconds(state, clock);
+}
@@ -0,0 +1,131 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstddef>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+#include "performance_test_fixture/performance_test_fixture.hpp"
+
+#include "rclcpp/rclcpp.hpp"
+#include "test_msgs/msg/empty.hpp"
+
+using performance_test_fixture::PerformanceTest;
+using MessageT = test_msgs::msg::Empty;
+
+namespace
+{
+
+/// Number of entities created at once, on distinct topics.
+constexpr size_t kNumberOfEntities = 1000;
+
+/// Return the resident set size of the process in bytes, 0 where it isn't known.
+size_t
+resident_set_size()
+{
+#ifdef __linux__
+  std::ifstream statm("/proc/self/statm");
+  size_t total_pages = 0;
+  size_t resident_pages = 0;
+  if (statm >> total_pages >> resident_pages) {
+    return resident_pages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  }
+#endif
+  return 0;
+}
+
+}  // namespace
+
+class EntityFootprintPerformanceTest : public PerformanceTest
+{
+public:
+  void SetUp(benchmark::State & state)
+  {
+    rclcpp::init(0, nullptr);
+    node_ = std::make_shared<rclcpp::Node>(
+      "node", rclcpp::NodeOptions().start_parameter_services(false));
+    performance_test_fixture::PerformanceTest::SetUp(state);
+  }
+
+  void TearDown(benchmark::State & state)
+  {
+    performance_test_fixture::PerformanceTest::TearDown(state);
+    node_.reset();
+    rclcpp::shutdown();
+  }
+
+protected:
+  /// Time the creation of the entities, and report the memory they use once created.
+  /**
+   * The resident set size is measured on a first batch, as the next ones reuse its pages.
+   */
+  template<typename CreateT>
+  void
+  benchmark_footprint(benchmark::State & state, size_t entity_size, CreateT create)
+  {
+    std::vector<std::shared_ptr<void>> entities;
+    entities.reserve(kNumberOfEntities);
+    const size_t rss_before = resident_set_size();
+    for (size_t i = 0; i < kNumberOfEntities; ++i) {
+      entities.push_back(create("topic_" + std::to_string(i)));
+    }
+    const size_t rss_after = resident_set_size();
+    entities.clear();
+
+    reset_heap_counters();
+    for (auto _ : state) {
+      (void)_;
+      for (size_t i = 0; i < kNumberOfEntities; ++i) {
+        entities.push_back(create("topic_" + std::to_string(i)));
+      }
+      benchmark::ClobberMemory();
+
+      state.PauseTiming();
+      entities.clear();
+      state.ResumeTiming();
+    }
+    state.counters["sizeof"] = static_cast<double>(entity_size);
+    if (rss_before > 0 && rss_after > rss_before) {
+      state.counters["rss_bytes_per_entity"] =
+        static_cast<double>(rss_after - rss_before) / static_cast<double>(kNumberOfEntities);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * kNumberOfEntities));
+  }
+
+  rclcpp::Node::SharedPtr node_;
+};
+
+BENCHMARK_F(EntityFootprintPerformanceTest, subscriptions)(benchmark::State & state)
+{
+  benchmark_footprint(
+    state, sizeof(rclcpp::Subscription<MessageT>),
+    [this](const std::string & topic) {
+        return node_->create_subscription<MessageT>(topic, 10, [](MessageT::ConstSharedPtr) {});
+      });
+}
+
+BENCHMARK_F(EntityFootprintPerformanceTest, publishers)(benchmark::State & state)
+{
+  benchmark_footprint(
+    state, sizeof(rclcpp::Publisher<MessageT>),
+    [this](const std::string & topic) {
+        return node_->create_publisher<MessageT>(topic, 10);
+      });
+}
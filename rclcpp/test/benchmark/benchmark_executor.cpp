@@ -19,10 +19,14 @@
 
 #include "performance_test_fixture/performance_test_fixture.hpp"
 
+#include "rclcpp/allocation_audit.hpp"
 #include "rclcpp/rclcpp.hpp"
 #include "rcpputils/scope_exit.hpp"
 #include "test_msgs/msg/empty.hpp"
 
+// Report the allocations to the allocation audit
+#include "rclcpp/allocation_guard_operators.hpp"
+
 using namespace std::chrono_literals;
 using performance_test_fixture::PerformanceTest;
 
@@ -48,9 +52,12 @@ public:
           "/empty_msgs_" + std::to_string(i), rclcpp::QoS(10), std::move(callback)));
     }
     PerformanceTest::SetUp(st);
+    rclcpp::AllocationAudit::enable();
   }
   void TearDown(benchmark::State & st)
   {
+    rclcpp::AllocationAudit::disable();
+    report_audited_allocations(st);
     PerformanceTest::TearDown(st);
     subscriptions.clear();
     publishers.clear();
@@ -58,6 +65,31 @@ public:
     rclcpp::shutdown();
   }
 
+  /// Reset the allocation audit and the heap counters, once the executor is warmed up.
+  void reset_allocation_counters()
+  {
+    rclcpp::AllocationAudit::reset();
+    reset_heap_counters();
+  }
+
+  /// Add the allocations made per iteration by the publishers and the callbacks to the counters.
+  void report_audited_allocations(benchmark::State & st)
+  {
+    uint64_t publish_allocations = 0;
+    uint64_t callback_allocations = 0;
+    for (const auto & record : rclcpp::AllocationAudit::get_records()) {
+      if (record.site == rclcpp::AllocationSite::Publish) {
+        publish_allocations += record.allocation_count;
+      } else {
+        callback_allocations += record.allocation_count;
+      }
+    }
+    st.counters["publish_allocations"] = benchmark::Counter(
+      static_cast<double>(publish_allocations), benchmark::Counter::kAvgIterations);
+    st.counters["callback_allocations"] = benchmark::Counter(
+      static_cast<double>(callback_allocations), benchmark::Counter::kAvgIterations);
+  }
+
   test_msgs::msg::Empty empty_msgs;
   std::vector<rclcpp::Node::SharedPtr> nodes;
   std::vector<rclcpp::Publisher<test_msgs::msg::Empty>::SharedPtr> publishers;
@@ -75,7 +107,7 @@ BENCHMARK_F(PerformanceTestExecutor, single_thread_executor_spin_some)(benchmark
   }
 
   callback_count = 0;
-  reset_heap_counters();
+  reset_allocation_counters();
 
   for (auto _ : st) {
     (void)_;
@@ -102,7 +134,7 @@ BENCHMARK_F(PerformanceTestExecutor, multi_thread_executor_spin_some)(benchmark:
   }
 
   callback_count = 0;
-  reset_heap_counters();
+  reset_allocation_counters();
 
   for (auto _ : st) {
     (void)_;
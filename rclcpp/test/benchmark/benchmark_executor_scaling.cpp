@@ -0,0 +1,264 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "performance_test_fixture/performance_test_fixture.hpp"
+
+#include "rclcpp/rclcpp.hpp"
+#include "test_msgs/msg/empty.hpp"
+
+using namespace std::chrono_literals;
+using performance_test_fixture::PerformanceTest;
+using rclcpp::executors::MultiThreadedExecutor;
+
+namespace
+{
+
+/// Executors compared by the benchmarks, selected by their second argument.
+enum ExecutorKind : int64_t
+{
+  SingleThreaded,
+  StaticSingleThreaded,
+  MultiThreaded,
+  MultiThreadedWorkStealing
+};
+
+/// Number of topics the subscriptions are spread over, which is the number of publishers.
+constexpr size_t kNumberOfTopics = 10;
+/// Time after which a message which wasn't delivered is considered lost.
+constexpr auto kDeliveryTimeout = 10s;
+
+/// Register the entity counts with each executor, and the thread counts of the multi threaded.
+void
+scaling_arguments(benchmark::internal::Benchmark * benchmark)
+{
+  benchmark->ArgNames({"entities", "executor", "threads"});
+  for (int64_t entities : {10, 100, 1000, 10000}) {
+    benchmark->Args({entities, SingleThreaded, 1});
+    benchmark->Args({entities, StaticSingleThreaded, 1});
+    for (int64_t threads : {1, 2, 4, 8, 16, 32, 64}) {
+      benchmark->Args({entities, MultiThreaded, threads});
+      benchmark->Args({entities, MultiThreadedWorkStealing, threads});
+    }
+  }
+  benchmark->UseRealTime();
+}
+
+/// Register the entity counts with each executor, for the benchmarks spinning from one thread.
+void
+single_thread_arguments(benchmark::internal::Benchmark * benchmark)
+{
+  benchmark->ArgNames({"entities", "executor", "threads"});
+  for (int64_t entities : {10, 100, 1000, 10000}) {
+    for (int64_t executor : {SingleThreaded, StaticSingleThreaded, MultiThreaded}) {
+      benchmark->Args({entities, executor, 1});
+    }
+  }
+}
+
+}  // namespace
+
+/// Executor with as many subscriptions as timers, the timers never firing during the benchmark.
+/**
+ * The arguments are the number of subscriptions and of timers, the ExecutorKind and the number
+ * of threads of the MultiThreadedExecutor.
+ * The subscriptions are spread over kNumberOfTopics topics and belong to a reentrant callback
+ * group, so that all the threads of a multi threaded executor can execute them.
+ */
+class ExecutorScalingPerformanceTest : public PerformanceTest
+{
+public:
+  void SetUp(benchmark::State & state)
+  {
+    rclcpp::init(0, nullptr);
+    node = std::make_shared<rclcpp::Node>("executor_scaling_node");
+    group = node->create_callback_group(rclcpp::CallbackGroupType::Reentrant);
+    for (size_t i = 0; i < kNumberOfTopics; ++i) {
+      publishers.push_back(
+        node->create_publisher<test_msgs::msg::Empty>(
+          "executor_scaling_topic_" + std::to_string(i), rclcpp::QoS(10)));
+    }
+    rclcpp::SubscriptionOptions options;
+    options.callback_group = group;
+    const auto entities = static_cast<size_t>(state.range(0));
+    for (size_t i = 0; i < entities; ++i) {
+      subscriptions.push_back(
+        node->create_subscription<test_msgs::msg::Empty>(
+          "executor_scaling_topic_" + std::to_string(i % kNumberOfTopics), rclcpp::QoS(10),
+          [this](test_msgs::msg::Empty::ConstSharedPtr) {
+            callback_count.fetch_add(1, std::memory_order_release);
+          }, options));
+      timers.push_back(node->create_wall_timer(1h, []() {}, group));
+    }
+    probe_publisher = node->create_publisher<test_msgs::msg::Empty>(
+      "executor_scaling_probe", rclcpp::QoS(10));
+    probe_subscription = node->create_subscription<test_msgs::msg::Empty>(
+      "executor_scaling_probe", rclcpp::QoS(10),
+      [this](test_msgs::msg::Empty::ConstSharedPtr) {
+        callback_count.fetch_add(1, std::memory_order_release);
+      }, options);
+    callback_count = 0;
+
+    const auto threads = static_cast<size_t>(state.range(2));
+    switch (state.range(1)) {
+      case StaticSingleThreaded:
+        executor = std::make_unique<rclcpp::executors::StaticSingleThreadedExecutor>();
+        break;
+      case MultiThreaded:
+        executor = std::make_unique<MultiThreadedExecutor>(rclcpp::ExecutorOptions(), threads);
+        break;
+      case MultiThreadedWorkStealing:
+        executor = std::make_unique<MultiThreadedExecutor>(
+          rclcpp::ExecutorOptions(), threads, false, std::chrono::nanoseconds(-1),
+          MultiThreadedExecutor::SchedulingMode::WorkStealing);
+        break;
+      case SingleThreaded:
+      default:
+        executor = std::make_unique<rclcpp::executors::SingleThreadedExecutor>();
+        break;
+    }
+    executor->add_node(node);
+    PerformanceTest::SetUp(state);
+  }
+
+  void TearDown(benchmark::State & state)
+  {
+    PerformanceTest::TearDown(state);
+    stop_spinning();
+    executor.reset();
+    timers.clear();
+    probe_subscription.reset();
+    probe_publisher.reset();
+    subscriptions.clear();
+    publishers.clear();
+    group.reset();
+    node.reset();
+    rclcpp::shutdown();
+  }
+
+  /// Spin the executor in another thread, once all the subscriptions are matched.
+  void start_spinning()
+  {
+    const auto end = std::chrono::steady_clock::now() + kDeliveryTimeout;
+    for (const auto & publisher : publishers) {
+      const size_t expected = (subscriptions.size() + kNumberOfTopics - 1) / kNumberOfTopics;
+      while (
+        publisher->get_subscription_count() < expected && std::chrono::steady_clock::now() < end)
+      {
+        std::this_thread::sleep_for(1ms);
+      }
+    }
+    while (
+      probe_publisher->get_subscription_count() < 1 && std::chrono::steady_clock::now() < end)
+    {
+      std::this_thread::sleep_for(1ms);
+    }
+    spinner = std::thread([this]() {executor->spin();});
+  }
+
+  void stop_spinning()
+  {
+    executor->cancel();
+    if (spinner.joinable()) {
+      spinner.join();
+    }
+  }
+
+  /// Wait until the callbacks were executed the given number of times, false on timeout.
+  bool wait_for_callbacks(uint64_t expected)
+  {
+    const auto end = std::chrono::steady_clock::now() + kDeliveryTimeout;
+    while (callback_count.load(std::memory_order_acquire) < expected) {
+      if (std::chrono::steady_clock::now() > end) {
+        return false;
+      }
+      std::this_thread::yield();
+    }
+    return true;
+  }
+
+protected:
+  rclcpp::Node::SharedPtr node;
+  rclcpp::CallbackGroup::SharedPtr group;
+  std::vector<rclcpp::Publisher<test_msgs::msg::Empty>::SharedPtr> publishers;
+  std::vector<rclcpp::Subscription<test_msgs::msg::Empty>::SharedPtr> subscriptions;
+  std::vector<rclcpp::TimerBase::SharedPtr> timers;
+  /// Publisher and subscription of their own topic, to measure the delivery of a single message.
+  rclcpp::Publisher<test_msgs::msg::Empty>::SharedPtr probe_publisher;
+  rclcpp::Subscription<test_msgs::msg::Empty>::SharedPtr probe_subscription;
+  std::unique_ptr<rclcpp::Executor> executor;
+  std::thread spinner;
+  std::atomic<uint64_t> callback_count{0};
+  test_msgs::msg::Empty message;
+};
+
+/// Cost of a wakeup which finds no work, collecting and waiting on all the entities.
+BENCHMARK_DEFINE_F(ExecutorScalingPerformanceTest, idle_wakeup)(benchmark::State & state)
+{
+  // The first spin collects the entities, which later spins may reuse
+  executor->spin_once(0ns);
+  reset_heap_counters();
+  for (auto _ : state) {
+    (void)_;
+    executor->spin_once(0ns);
+  }
+}
+BENCHMARK_REGISTER_F(ExecutorScalingPerformanceTest, idle_wakeup)->Apply(single_thread_arguments);
+
+/// Rate at which the executor dispatches a message to every subscription.
+BENCHMARK_DEFINE_F(ExecutorScalingPerformanceTest, dispatch_throughput)(benchmark::State & state)
+{
+  start_spinning();
+  reset_heap_counters();
+  uint64_t expected = 0;
+  for (auto _ : state) {
+    (void)_;
+    for (const auto & publisher : publishers) {
+      publisher->publish(message);
+    }
+    expected += subscriptions.size();
+    if (!wait_for_callbacks(expected)) {
+      state.SkipWithError("A message was not received");
+      break;
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(callback_count.load()));
+}
+BENCHMARK_REGISTER_F(ExecutorScalingPerformanceTest, dispatch_throughput)->Apply(scaling_arguments);
+
+/// Time from publishing a single message to its callback, among all the idle entities.
+BENCHMARK_DEFINE_F(ExecutorScalingPerformanceTest, message_overhead)(benchmark::State & state)
+{
+  start_spinning();
+  reset_heap_counters();
+  uint64_t expected = 0;
+  for (auto _ : state) {
+    (void)_;
+    probe_publisher->publish(message);
+    expected += 1;
+    if (!wait_for_callbacks(expected)) {
+      state.SkipWithError("A message was not received");
+      break;
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(callback_count.load()));
+}
+BENCHMARK_REGISTER_F(ExecutorScalingPerformanceTest, message_overhead)->Apply(scaling_arguments);
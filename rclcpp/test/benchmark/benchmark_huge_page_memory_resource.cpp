@@ -0,0 +1,130 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "rclcpp/allocator/huge_page_memory_resource.hpp"
+#include "rclcpp/allocator/memory_resource.hpp"
+
+using rclcpp::allocator::HugePageMemoryResource;
+using rclcpp::allocator::HugePageMemoryResourceOptions;
+using rclcpp::allocator::HugePageMode;
+using rclcpp::allocator::MemoryResourceAllocator;
+
+namespace
+{
+
+/// Memory resources compared, selected by the last argument of the benchmarks.
+enum ResourceKind : int64_t
+{
+  NewDelete,
+  TransparentHugePages,
+  ExplicitHugePages
+};
+
+// The buffers of the fields of large messages, e.g. the data of a point cloud
+using BufferT = std::vector<uint8_t, MemoryResourceAllocator<uint8_t>>;
+
+std::unique_ptr<std::pmr::memory_resource>
+create_resource(int64_t kind)
+{
+  if (kind == NewDelete) {
+    return nullptr;
+  }
+  HugePageMemoryResourceOptions options;
+  options.mode = kind == ExplicitHugePages ? HugePageMode::Explicit : HugePageMode::Transparent;
+  return std::make_unique<HugePageMemoryResource>(options);
+}
+
+/// Return the page faults of the process so far.
+int64_t
+page_faults()
+{
+#ifndef _WIN32
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_minflt + usage.ru_majflt;
+#else
+  return 0;
+#endif
+}
+
+void
+message_sizes(benchmark::internal::Benchmark * benchmark)
+{
+  benchmark->ArgNames({"size", "resource"});
+  for (int64_t size : {10 * 1024 * 1024, 50 * 1024 * 1024}) {
+    for (int64_t kind : {NewDelete, TransparentHugePages, ExplicitHugePages}) {
+      benchmark->Args({size, kind});
+    }
+  }
+  benchmark->UseRealTime();
+}
+
+}  // namespace
+
+/// Copy a large message, as the intra-process delivery does for each extra subscription.
+static void
+intra_process_copy(benchmark::State & state)
+{
+  const size_t size = static_cast<size_t>(state.range(0));
+  auto resource = create_resource(state.range(1));
+  std::pmr::memory_resource * memory =
+    resource ? resource.get() : std::pmr::new_delete_resource();
+  BufferT message(size, 1, memory);
+
+  const int64_t faults_before = page_faults();
+  for (auto _ : state) {
+    BufferT copy(message);
+    benchmark::DoNotOptimize(copy.data());
+    benchmark::ClobberMemory();
+  }
+  state.counters["page_faults"] = benchmark::Counter(
+    static_cast<double>(page_faults() - faults_before), benchmark::Counter::kAvgIterations);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * size));
+}
+BENCHMARK(intra_process_copy)->Apply(message_sizes);
+
+/// Fill a freshly allocated message, as a publisher does before publishing it.
+static void
+fill_new_message(benchmark::State & state)
+{
+  const size_t size = static_cast<size_t>(state.range(0));
+  auto resource = create_resource(state.range(1));
+  std::pmr::memory_resource * memory =
+    resource ? resource.get() : std::pmr::new_delete_resource();
+
+  const int64_t faults_before = page_faults();
+  for (auto _ : state) {
+    auto message = std::make_unique<BufferT>(memory);
+    message->resize(size);
+    std::memset(message->data(), 1, size);
+    benchmark::DoNotOptimize(message->data());
+    benchmark::ClobberMemory();
+  }
+  state.counters["page_faults"] = benchmark::Counter(
+    static_cast<double>(page_faults() - faults_before), benchmark::Counter::kAvgIterations);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * size));
+}
+BENCHMARK(fill_new_message)->Apply(message_sizes);
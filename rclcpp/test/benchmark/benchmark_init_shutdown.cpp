@@ -12,9 +12,14 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "performance_test_fixture/performance_test_fixture.hpp"
 
 #include "rclcpp/rclcpp.hpp"
+#include "test_msgs/msg/empty.hpp"
 
 using performance_test_fixture::PerformanceTest;
 
@@ -53,3 +58,74 @@ BENCHMARK_F(PerformanceTest, rclcpp_shutdown)(benchmark::State & state)
     benchmark::ClobberMemory();
   }
 }
+
+/// Register the combinations of node count and teardown mode, each iteration is long.
+void
+teardown_arguments(benchmark::internal::Benchmark * benchmark)
+{
+  benchmark->ArgNames({"nodes", "fast_teardown"});
+  for (int64_t nodes : {10, 100, 500}) {
+    for (int64_t fast_teardown : {0, 1}) {
+      benchmark->Args({nodes, fast_teardown});
+    }
+  }
+  benchmark->Unit(benchmark::kMillisecond);
+  benchmark->Iterations(3);
+}
+
+/*
+ * Shutdown of a context followed by the destruction of many nodes, as a container exiting.
+ * The arguments are the number of nodes, with 4 intra-process publishers and subscriptions
+ * each, and whether rclcpp::InitOptions::fast_teardown is enabled.
+ */
+BENCHMARK_DEFINE_F(PerformanceTest, shutdown_and_teardown)(benchmark::State & state)
+{
+  const auto number_of_nodes = static_cast<size_t>(state.range(0));
+  rclcpp::InitOptions init_options;
+  init_options.fast_teardown = state.range(1) != 0;
+  const auto node_options = rclcpp::NodeOptions()
+    .use_intra_process_comms(true)
+    .start_parameter_services(false)
+    .start_parameter_event_publisher(false);
+
+  std::vector<rclcpp::Node::SharedPtr> nodes;
+  std::vector<std::shared_ptr<void>> entities;
+  auto setup = [&]() {
+      rclcpp::init(0, nullptr, init_options);
+      for (size_t i = 0; i < number_of_nodes; ++i) {
+        auto node = std::make_shared<rclcpp::Node>("node_" + std::to_string(i), node_options);
+        for (size_t j = 0; j < 4u; ++j) {
+          const std::string topic = "topic_" + std::to_string((i + j) % 16);
+          entities.push_back(node->create_publisher<test_msgs::msg::Empty>(topic, 10));
+          entities.push_back(
+            node->create_subscription<test_msgs::msg::Empty>(
+              topic, 10, [](test_msgs::msg::Empty::ConstSharedPtr) {}));
+        }
+        nodes.push_back(std::move(node));
+      }
+    };
+  auto teardown = [&]() {
+      rclcpp::shutdown();
+      // The entities are released node by node, as in the destruction of components
+      for (size_t i = nodes.size(); i > 0; --i) {
+        entities.resize((i - 1) * 8);
+        nodes.pop_back();
+      }
+    };
+
+  // Warmup and prime caches
+  setup();
+  teardown();
+
+  reset_heap_counters();
+  for (auto _ : state) {
+    (void)_;
+    state.PauseTiming();
+    setup();
+    state.ResumeTiming();
+
+    teardown();
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK_REGISTER_F(PerformanceTest, shutdown_and_teardown)->Apply(teardown_arguments);
@@ -0,0 +1,84 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "rclcpp/local_message_ptr.hpp"
+
+using rclcpp::LocalMessagePtr;
+
+namespace
+{
+
+// A small message, so that the handles and not the message dominate
+struct Message
+{
+  uint64_t stamp;
+  double value;
+};
+
+void
+copy_counts(benchmark::internal::Benchmark * benchmark)
+{
+  benchmark->ArgNames({"copies"});
+  for (int64_t copies : {0, 1, 4, 16}) {
+    benchmark->Arg(copies);
+  }
+}
+
+}  // namespace
+
+/// Hand a message received as a std::shared_ptr to a callback keeping copies of it.
+template<typename PtrT>
+static void
+callback_from_shared(benchmark::State & state)
+{
+  const auto message = std::make_shared<const Message>(Message{42u, 1.0});
+  std::vector<PtrT> copies;
+  copies.reserve(static_cast<size_t>(state.range(0)));
+  for (auto _ : state) {
+    PtrT handle(message);
+    for (int64_t i = 0; i < state.range(0); ++i) {
+      copies.push_back(handle);
+    }
+    benchmark::DoNotOptimize(handle.get());
+    copies.clear();
+  }
+}
+
+/// Hand a message received with ownership, e.g. intra-process, to a callback keeping copies.
+template<typename PtrT>
+static void
+callback_from_unique(benchmark::State & state)
+{
+  std::vector<PtrT> copies;
+  copies.reserve(static_cast<size_t>(state.range(0)));
+  for (auto _ : state) {
+    PtrT handle(std::make_unique<Message>(Message{42u, 1.0}));
+    for (int64_t i = 0; i < state.range(0); ++i) {
+      copies.push_back(handle);
+    }
+    benchmark::DoNotOptimize(handle.get());
+    copies.clear();
+  }
+}
+
+BENCHMARK_TEMPLATE(callback_from_shared, std::shared_ptr<const Message>)->Apply(copy_counts);
+BENCHMARK_TEMPLATE(callback_from_shared, LocalMessagePtr<Message>)->Apply(copy_counts);
+BENCHMARK_TEMPLATE(callback_from_unique, std::shared_ptr<const Message>)->Apply(copy_counts);
+BENCHMARK_TEMPLATE(callback_from_unique, LocalMessagePtr<Message>)->Apply(copy_counts);
@@ -14,8 +14,10 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "performance_test_fixture/performance_test_fixture.hpp"
+#include "rclcpp/create_nodes.hpp"
 #include "rclcpp/rclcpp.hpp"
 
 using performance_test_fixture::PerformanceTest;
@@ -81,3 +83,60 @@ BENCHMARK_F(NodePerformanceTest, destroy_node)(benchmark::State & state)
     node.reset();
   }
 }
+
+constexpr size_t kNumberOfNodes = 50;
+
+BENCHMARK_F(NodePerformanceTest, create_nodes_one_by_one)(benchmark::State & state)
+{
+  reset_heap_counters();
+  for (auto _ : state) {
+    (void)_;
+    std::vector<rclcpp::Node::SharedPtr> nodes;
+    for (size_t i = 0; i < kNumberOfNodes; ++i) {
+      nodes.push_back(std::make_shared<rclcpp::Node>("node_" + std::to_string(i)));
+    }
+    benchmark::ClobberMemory();
+
+    state.PauseTiming();
+    nodes.clear();
+    state.ResumeTiming();
+  }
+}
+
+BENCHMARK_F(NodePerformanceTest, create_nodes_in_bulk)(benchmark::State & state)
+{
+  std::vector<rclcpp::NodeCreationRequest> requests;
+  for (size_t i = 0; i < kNumberOfNodes; ++i) {
+    requests.push_back({"node_" + std::to_string(i), "", rclcpp::NodeOptions()});
+  }
+
+  // Report the time spent per node in each phase of the creation
+  rclcpp::NodeStartupProfile total;
+  reset_heap_counters();
+  for (auto _ : state) {
+    (void)_;
+    rclcpp::NodeStartupProfile profile;
+    auto nodes = rclcpp::create_nodes(requests, 0, &profile);
+    benchmark::ClobberMemory();
+
+    state.PauseTiming();
+    total.number_of_nodes += profile.number_of_nodes;
+    total.construction += profile.construction;
+    total.node_base += profile.node_base;
+    total.graph += profile.graph;
+    total.parameters += profile.parameters;
+    total.time_source += profile.time_source;
+    nodes.clear();
+    state.ResumeTiming();
+  }
+  if (total.number_of_nodes > 0) {
+    auto per_node = [&total](std::chrono::nanoseconds duration) {
+        return static_cast<double>(duration.count()) / static_cast<double>(total.number_of_nodes);
+      };
+    state.counters["construction_ns"] = per_node(total.construction);
+    state.counters["node_base_ns"] = per_node(total.node_base);
+    state.counters["graph_ns"] = per_node(total.graph);
+    state.counters["parameters_ns"] = per_node(total.parameters);
+    state.counters["time_source_ns"] = per_node(total.time_source);
+  }
+}
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -276,3 +277,199 @@ BENCHMARK_F(NodeParametersInterfaceTest, list_parameters_miss)(benchmark::State
     }
   }
 }
+
+class NodeManyParametersInterfaceTest : public performance_test_fixture::PerformanceTest
+{
+public:
+  static constexpr size_t group_count = 50;
+  static constexpr size_t parameters_per_group = 100;
+
+  void SetUp(benchmark::State & state)
+  {
+    rclcpp::init(0, nullptr);
+    node = std::make_shared<rclcpp::Node>("my_node");
+
+    // 5000 parameters in 50 namespaces, declared at once
+    std::vector<rclcpp::node_interfaces::ParameterDeclaration> declarations;
+    for (size_t group = 0; group < group_count; ++group) {
+      for (size_t i = 0; i < parameters_per_group; ++i) {
+        rclcpp::node_interfaces::ParameterDeclaration declaration;
+        declaration.name = get_parameter_name(group, i);
+        declaration.default_value = rclcpp::ParameterValue(static_cast<int64_t>(i));
+        declarations.push_back(declaration);
+      }
+    }
+    node->get_node_parameters_interface()->declare_parameters(declarations);
+
+    performance_test_fixture::PerformanceTest::SetUp(state);
+  }
+
+  void TearDown(benchmark::State & state)
+  {
+    performance_test_fixture::PerformanceTest::TearDown(state);
+
+    node.reset();
+    rclcpp::shutdown();
+  }
+
+  static std::string get_group_name(size_t group)
+  {
+    return "my_group_" + std::to_string(group);
+  }
+
+  static std::string get_parameter_name(size_t group, size_t i)
+  {
+    return get_group_name(group) + ".my_param_" + std::to_string(i);
+  }
+
+protected:
+  rclcpp::Node::SharedPtr node;
+};
+
+BENCHMARK_F(NodeManyParametersInterfaceTest, get_parameter)(benchmark::State & state)
+{
+  const std::string name = get_parameter_name(group_count / 2, parameters_per_group / 2);
+  rclcpp::Parameter value;
+
+  reset_heap_counters();
+
+  for (auto _ : state) {
+    (void)_;
+    node->get_parameter(name, value);
+  }
+}
+
+BENCHMARK_F(NodeManyParametersInterfaceTest, set_parameters)(benchmark::State & state)
+{
+  const std::string name = get_parameter_name(group_count / 2, parameters_per_group / 2);
+  const std::vector<rclcpp::Parameter> param_values1 {rclcpp::Parameter(name, 1)};
+  const std::vector<rclcpp::Parameter> param_values2 {rclcpp::Parameter(name, 2)};
+
+  reset_heap_counters();
+
+  for (auto _ : state) {
+    (void)_;
+    node->set_parameters(param_values2);
+    node->set_parameters(param_values1);
+  }
+}
+
+BENCHMARK_F(NodeManyParametersInterfaceTest, declare_undeclare)(benchmark::State & state)
+{
+  // One parameter at a time, in a namespace of the parameters declared at once
+  const std::string name = get_group_name(group_count / 2) + ".my_other_param";
+  rcl_interfaces::msg::ParameterDescriptor descriptor;
+  descriptor.dynamic_typing = true;
+
+  reset_heap_counters();
+
+  for (auto _ : state) {
+    (void)_;
+    node->declare_parameter(name, rclcpp::ParameterValue{}, descriptor);
+    node->undeclare_parameter(name);
+  }
+}
+
+BENCHMARK_F(NodeManyParametersInterfaceTest, declare_parameter_one_at_a_time)(
+  benchmark::State & state)
+{
+  // A group of parameters declared one at a time, next to the parameters declared at once
+  std::vector<std::string> names;
+  for (size_t i = 0; i < parameters_per_group; ++i) {
+    names.push_back(get_parameter_name(group_count, i));
+  }
+  rcl_interfaces::msg::ParameterDescriptor descriptor;
+  descriptor.dynamic_typing = true;
+
+  reset_heap_counters();
+
+  for (auto _ : state) {
+    (void)_;
+    for (const std::string & name : names) {
+      node->declare_parameter(name, rclcpp::ParameterValue(static_cast<int64_t>(1)), descriptor);
+    }
+    state.PauseTiming();
+    for (const std::string & name : names) {
+      node->undeclare_parameter(name);
+    }
+    state.ResumeTiming();
+  }
+}
+
+BENCHMARK_F(NodeManyParametersInterfaceTest, list_parameters_hit)(benchmark::State & state)
+{
+  rcl_interfaces::msg::ListParametersResult param_list;
+  const std::vector<std::string> prefixes
+  {
+    get_group_name(group_count / 2),
+  };
+
+  reset_heap_counters();
+
+  for (auto _ : state) {
+    (void)_;
+    param_list = node->list_parameters(prefixes, 10);
+    if (param_list.names.size() != parameters_per_group) {
+      state.SkipWithError("Expected node names");
+      break;
+    }
+  }
+}
+
+BENCHMARK_F(NodeManyParametersInterfaceTest, list_parameters_miss)(benchmark::State & state)
+{
+  rcl_interfaces::msg::ListParametersResult param_list;
+  const std::vector<std::string> prefixes
+  {
+    "your_group",
+  };
+
+  reset_heap_counters();
+
+  for (auto _ : state) {
+    (void)_;
+    param_list = node->list_parameters(prefixes, 10);
+    if (param_list.names.size() != 0) {
+      state.SkipWithError("Expected no node names");
+      break;
+    }
+  }
+}
+
+BENCHMARK_F(NodeManyParametersInterfaceTest, list_parameters_top_level)(benchmark::State & state)
+{
+  rcl_interfaces::msg::ListParametersResult param_list;
+
+  reset_heap_counters();
+
+  for (auto _ : state) {
+    (void)_;
+    // Only the parameters outside of the namespaces, like use_sim_time
+    param_list = node->list_parameters({}, 1);
+    if (param_list.names.size() >= parameters_per_group) {
+      state.SkipWithError("Expected no parameter of the namespaces");
+      break;
+    }
+  }
+}
+
+BENCHMARK_F(NodeManyParametersInterfaceTest, get_parameters_by_prefix)(benchmark::State & state)
+{
+  const std::string prefix = get_group_name(group_count / 2);
+  const auto node_parameters = node->get_node_parameters_interface();
+  std::map<std::string, rclcpp::Parameter> parameters;
+
+  reset_heap_counters();
+
+  for (auto _ : state) {
+    (void)_;
+    parameters.clear();
+    if (
+      !node_parameters->get_parameters_by_prefix(prefix, parameters) ||
+      parameters.size() != parameters_per_group)
+    {
+      state.SkipWithError("Expected parameters");
+      break;
+    }
+  }
+}
@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <chrono>
 #include <memory>
 #include <vector>
 #include <string>
@@ -335,3 +337,69 @@ BENCHMARK_F(ParameterClientTest, list_parameters_miss)(benchmark::State & state)
     }
   }
 }
+
+class MultiNodeParametersClientTest : public RemoteNodeTest
+{
+public:
+  static constexpr size_t remote_node_count = 20;
+
+  void SetUp(benchmark::State & state)
+  {
+    RemoteNodeTest::SetUp(state);
+
+    rclcpp::init(0, nullptr);
+    node = std::make_shared<rclcpp::Node>("my_node");
+
+    std::vector<std::string> remote_node_names;
+    for (size_t i = 0; i < remote_node_count; ++i) {
+      auto other_node = std::make_shared<rclcpp::Node>(
+        remote_node_name + "_" + std::to_string(i), rclcpp::NodeOptions().context(remote_context));
+      other_node->declare_parameter("my_param", rclcpp::ParameterValue("param_value"));
+      remote_executor->add_node(other_node);
+      remote_nodes.push_back(other_node);
+      remote_node_names.push_back(other_node->get_fully_qualified_name());
+    }
+
+    params_client = std::make_shared<rclcpp::MultiNodeParametersClient>(node, remote_node_names);
+    if (!params_client->wait_for_services(std::chrono::seconds(10))) {
+      state.SkipWithError("Client failed to become ready");
+    }
+  }
+
+  void TearDown(benchmark::State & state)
+  {
+    params_client.reset();
+    RemoteNodeTest::TearDown(state);
+    remote_nodes.clear();
+
+    rclcpp::shutdown();
+    node.reset();
+  }
+
+protected:
+  rclcpp::Node::SharedPtr node;
+  std::vector<rclcpp::Node::SharedPtr> remote_nodes;
+  rclcpp::MultiNodeParametersClient::SharedPtr params_client;
+};
+
+BENCHMARK_F(MultiNodeParametersClientTest, get_parameters_fan_out)(benchmark::State & state)
+{
+  for (auto _ : state) {
+    (void)_;
+    auto future = params_client->get_parameters({"my_param"});
+    if (rclcpp::spin_until_future_complete(node, future) != rclcpp::FutureReturnCode::SUCCESS) {
+      state.SkipWithError("Failed to get the parameters");
+      break;
+    }
+    const auto results = future.get();
+    if (
+      !std::all_of(
+        results.begin(), results.end(), [](const auto & result) {
+          return result.second.status == rclcpp::RemoteParametersStatus::Success;
+        }))
+    {
+      state.SkipWithError("Got no parameters from a node");
+      break;
+    }
+  }
+}
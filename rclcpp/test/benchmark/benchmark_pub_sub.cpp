@@ -0,0 +1,347 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "performance_test_fixture/performance_test_fixture.hpp"
+
+#include "rclcpp/experimental/executors/events_executor/events_executor.hpp"
+#include "rclcpp/rclcpp.hpp"
+#include "test_msgs/msg/unbounded_sequences.hpp"
+
+using namespace std::chrono_literals;
+using performance_test_fixture::PerformanceTest;
+using MessageT = test_msgs::msg::UnboundedSequences;
+
+namespace
+{
+
+/// Executors spinning the subscriptions, selected by the last argument of the benchmarks.
+enum ExecutorKind : int64_t
+{
+  SingleThreaded,
+  MultiThreaded,
+  StaticSingleThreaded,
+  Events
+};
+
+/// Number of messages published before waiting for their delivery, for the throughput.
+constexpr size_t kBurstSize = 100;
+/// Upper bound of the payload of a burst, fewer large messages are published per burst.
+constexpr size_t kMaxBurstBytes = 8 * 1024 * 1024;
+/// Number of latencies kept to compute the percentiles, the next ones are dropped.
+constexpr size_t kMaxLatencySamples = 1u << 20;
+/// Time after which a message which wasn't delivered is considered lost.
+constexpr auto kDeliveryTimeout = 5s;
+
+/// Register the combinations of message size, subscriber count, ownership and executor.
+void
+pub_sub_arguments(benchmark::internal::Benchmark * benchmark)
+{
+  benchmark->ArgNames({"size", "subscribers", "unique", "executor"});
+  for (int64_t size : {64, 64 * 1024, 1024 * 1024}) {
+    for (int64_t subscribers : {1, 4}) {
+      for (int64_t unique : {0, 1}) {
+        for (int64_t executor : {SingleThreaded, MultiThreaded, StaticSingleThreaded, Events}) {
+          benchmark->Args({size, subscribers, unique, executor});
+        }
+      }
+    }
+  }
+  benchmark->UseRealTime();
+}
+
+int64_t
+now_ns()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+}  // namespace
+
+/// Publish messages to subscriptions of the same node, spun by an executor in another thread.
+/**
+ * The arguments are the size of the payload, the number of subscriptions, whether the
+ * callbacks take unique ownership of the messages, and the ExecutorKind.
+ * Messages are always published as unique pointers, so that intra-process communication can
+ * move them to a single unique subscription and share them between shared subscriptions.
+ *
+ * Each message carries the time it was published at, so that the latency from the publish
+ * call to each callback is measured; its percentiles are reported as counters in microseconds.
+ * The "inter-process" benchmarks disable intra-process communication, so the messages go
+ * through the middleware, although the subscriptions live in the same process.
+ */
+class PubSubPerformanceTest : public PerformanceTest
+{
+public:
+  void SetUp(benchmark::State & state)
+  {
+    rclcpp::init(0, nullptr);
+    prototype.uint8_values.resize(static_cast<size_t>(state.range(0)));
+    prototype.int64_values.resize(1);
+    latencies.assign(kMaxLatencySamples, 0);
+    latency_count = 0;
+    delivered = 0;
+    PerformanceTest::SetUp(state);
+  }
+
+  void TearDown(benchmark::State & state)
+  {
+    PerformanceTest::TearDown(state);
+    stop_spinning();
+    subscriptions.clear();
+    publisher.reset();
+    node.reset();
+    rclcpp::shutdown();
+  }
+
+  /// Create the node, the publisher, the subscriptions and start the executor.
+  void create_entities(benchmark::State & state, bool use_intra_process)
+  {
+    node = std::make_shared<rclcpp::Node>(
+      "pub_sub_performance_node", rclcpp::NodeOptions().use_intra_process_comms(use_intra_process));
+    const rclcpp::QoS qos = rclcpp::QoS(kBurstSize).reliable();
+    publisher = node->create_publisher<MessageT>("pub_sub_performance_topic", qos);
+    const bool unique = state.range(2) != 0;
+    for (int64_t i = 0; i < state.range(1); ++i) {
+      if (unique) {
+        subscriptions.push_back(
+          node->create_subscription<MessageT>(
+            "pub_sub_performance_topic", qos, [this](MessageT::UniquePtr message) {
+              on_message(*message);
+            }));
+      } else {
+        subscriptions.push_back(
+          node->create_subscription<MessageT>(
+            "pub_sub_performance_topic", qos, [this](MessageT::ConstSharedPtr message) {
+              on_message(*message);
+            }));
+      }
+    }
+
+    switch (state.range(3)) {
+      case MultiThreaded:
+        executor = std::make_unique<rclcpp::executors::MultiThreadedExecutor>();
+        break;
+      case StaticSingleThreaded:
+        executor = std::make_unique<rclcpp::executors::StaticSingleThreadedExecutor>();
+        break;
+      case Events:
+        executor = std::make_unique<rclcpp::experimental::executors::EventsExecutor>();
+        break;
+      case SingleThreaded:
+      default:
+        executor = std::make_unique<rclcpp::executors::SingleThreadedExecutor>();
+        break;
+    }
+    executor->add_node(node);
+    spinner = std::thread([this]() {executor->spin();});
+
+    // Wait for the subscriptions to be matched and the executor to be spinning
+    const auto end = std::chrono::steady_clock::now() + kDeliveryTimeout;
+    while (
+      publisher->get_subscription_count() + publisher->get_intra_process_subscription_count() <
+      subscriptions.size() && std::chrono::steady_clock::now() < end)
+    {
+      std::this_thread::sleep_for(1ms);
+    }
+  }
+
+  void stop_spinning()
+  {
+    if (executor) {
+      executor->cancel();
+    }
+    if (spinner.joinable()) {
+      spinner.join();
+    }
+    executor.reset();
+  }
+
+  /// Return a copy of the prototype message, to be published.
+  MessageT::UniquePtr make_message()
+  {
+    return std::make_unique<MessageT>(prototype);
+  }
+
+  /// Stamp and publish the message.
+  void publish(MessageT::UniquePtr message)
+  {
+    message->int64_values[0] = now_ns();
+    publisher->publish(std::move(message));
+  }
+
+  /// Wait until the given number of callbacks were executed since the start, false on timeout.
+  bool wait_for_delivery(uint64_t expected)
+  {
+    const auto end = std::chrono::steady_clock::now() + kDeliveryTimeout;
+    while (delivered.load(std::memory_order_acquire) < expected) {
+      if (std::chrono::steady_clock::now() > end) {
+        return false;
+      }
+      std::this_thread::yield();
+    }
+    return true;
+  }
+
+  /// Report the throughput and the percentiles of the latencies.
+  void report(benchmark::State & state)
+  {
+    const uint64_t callbacks = delivered.load();
+    state.SetItemsProcessed(static_cast<int64_t>(callbacks));
+    state.SetBytesProcessed(static_cast<int64_t>(callbacks) * state.range(0));
+    const size_t count = std::min<size_t>(latency_count.load(), latencies.size());
+    if (count == 0) {
+      return;
+    }
+    std::sort(latencies.begin(), latencies.begin() + static_cast<std::ptrdiff_t>(count));
+    auto percentile = [this, count](double rank) {
+        const size_t index = std::min(
+          count - 1, static_cast<size_t>(rank / 100.0 * static_cast<double>(count)));
+        return static_cast<double>(latencies[index]) / 1000.0;
+      };
+    state.counters["latency_p50_us"] = percentile(50.0);
+    state.counters["latency_p90_us"] = percentile(90.0);
+    state.counters["latency_p99_us"] = percentile(99.0);
+    state.counters["latency_p99.9_us"] = percentile(99.9);
+    state.counters["latency_max_us"] = percentile(100.0);
+  }
+
+  /// Publish one message at a time, waiting for all the callbacks before the next one.
+  void run_latency(benchmark::State & state)
+  {
+    const uint64_t subscriber_count = subscriptions.size();
+    // Warm up the buffers and the executor
+    publish(make_message());
+    if (!wait_for_delivery(subscriber_count)) {
+      state.SkipWithError("The warm up message was not received");
+      return;
+    }
+    delivered = 0;
+    latency_count = 0;
+    reset_heap_counters();
+
+    uint64_t expected = 0;
+    for (auto _ : state) {
+      (void)_;
+      state.PauseTiming();
+      auto message = make_message();
+      state.ResumeTiming();
+
+      publish(std::move(message));
+      expected += subscriber_count;
+      if (!wait_for_delivery(expected)) {
+        state.SkipWithError("A message was not received");
+        break;
+      }
+    }
+    report(state);
+  }
+
+  /// Publish bursts of up to kBurstSize messages, waiting for all the callbacks after each one.
+  void run_throughput(benchmark::State & state)
+  {
+    const uint64_t subscriber_count = subscriptions.size();
+    publish(make_message());
+    if (!wait_for_delivery(subscriber_count)) {
+      state.SkipWithError("The warm up message was not received");
+      return;
+    }
+    delivered = 0;
+    latency_count = 0;
+    reset_heap_counters();
+
+    const size_t burst_size = std::max<size_t>(
+      1, std::min(kBurstSize, kMaxBurstBytes / static_cast<size_t>(state.range(0))));
+    std::vector<MessageT::UniquePtr> burst(burst_size);
+    uint64_t expected = 0;
+    for (auto _ : state) {
+      (void)_;
+      state.PauseTiming();
+      for (auto & message : burst) {
+        message = make_message();
+      }
+      state.ResumeTiming();
+
+      for (auto & message : burst) {
+        publish(std::move(message));
+      }
+      expected += burst_size * subscriber_count;
+      if (!wait_for_delivery(expected)) {
+        state.SkipWithError("A message was not received");
+        break;
+      }
+    }
+    report(state);
+  }
+
+protected:
+  void on_message(const MessageT & message)
+  {
+    const int64_t latency = now_ns() - message.int64_values[0];
+    const size_t index = latency_count.fetch_add(1, std::memory_order_relaxed);
+    if (index < latencies.size()) {
+      latencies[index] = latency;
+    }
+    delivered.fetch_add(1, std::memory_order_release);
+  }
+
+  MessageT prototype;
+  rclcpp::Node::SharedPtr node;
+  rclcpp::Publisher<MessageT>::SharedPtr publisher;
+  std::vector<rclcpp::Subscription<MessageT>::SharedPtr> subscriptions;
+  std::unique_ptr<rclcpp::Executor> executor;
+  std::thread spinner;
+  std::vector<int64_t> latencies;
+  std::atomic<size_t> latency_count{0};
+  std::atomic<uint64_t> delivered{0};
+};
+
+BENCHMARK_DEFINE_F(PubSubPerformanceTest, intra_process_latency)(benchmark::State & state)
+{
+  create_entities(state, true);
+  run_latency(state);
+}
+BENCHMARK_REGISTER_F(PubSubPerformanceTest, intra_process_latency)->Apply(pub_sub_arguments);
+
+BENCHMARK_DEFINE_F(PubSubPerformanceTest, intra_process_throughput)(benchmark::State & state)
+{
+  create_entities(state, true);
+  run_throughput(state);
+}
+BENCHMARK_REGISTER_F(PubSubPerformanceTest, intra_process_throughput)->Apply(pub_sub_arguments);
+
+BENCHMARK_DEFINE_F(PubSubPerformanceTest, inter_process_latency)(benchmark::State & state)
+{
+  create_entities(state, false);
+  run_latency(state);
+}
+BENCHMARK_REGISTER_F(PubSubPerformanceTest, inter_process_latency)->Apply(pub_sub_arguments);
+
+BENCHMARK_DEFINE_F(PubSubPerformanceTest, inter_process_throughput)(benchmark::State & state)
+{
+  create_entities(state, false);
+  run_throughput(state);
+}
+BENCHMARK_REGISTER_F(PubSubPerformanceTest, inter_process_throughput)->Apply(pub_sub_arguments);
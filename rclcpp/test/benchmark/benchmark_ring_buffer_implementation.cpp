@@ -0,0 +1,98 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "rclcpp/experimental/buffers/lock_free_ring_buffer_implementation.hpp"
+#include "rclcpp/experimental/buffers/ring_buffer_implementation.hpp"
+
+using rclcpp::experimental::buffers::MultiProducerRingBufferImplementation;
+using rclcpp::experimental::buffers::RingBufferImplementation;
+using rclcpp::experimental::buffers::SingleProducerRingBufferImplementation;
+
+namespace
+{
+
+constexpr size_t kCapacity = 64;
+// The elements of the intra-process buffers are shared or unique pointers
+using BufferT = std::shared_ptr<const int>;
+
+}  // namespace
+
+/// Enqueue and dequeue from the same thread.
+template<typename BufferImplementationT>
+static void
+enqueue_dequeue(benchmark::State & state)
+{
+  BufferImplementationT buffer(kCapacity);
+  auto message = std::make_shared<const int>(42);
+  for (auto _ : state) {
+    buffer.enqueue(message);
+    benchmark::DoNotOptimize(buffer.dequeue());
+  }
+}
+
+/// Enqueue from the given number of producers, while a consumer thread dequeues.
+template<typename BufferImplementationT>
+static void
+contended_enqueue(benchmark::State & state)
+{
+  BufferImplementationT buffer(kCapacity);
+  std::atomic<bool> done{false};
+  std::thread consumer([&buffer, &done]() {
+      while (!done.load(std::memory_order_relaxed)) {
+        if (buffer.has_data()) {
+          benchmark::DoNotOptimize(buffer.dequeue());
+        }
+      }
+    });
+
+  // Other producers than the benchmarking thread
+  std::vector<std::thread> producers;
+  for (int64_t i = 1; i < state.range(0); ++i) {
+    producers.emplace_back(
+      [&buffer, &done]() {
+        auto message = std::make_shared<const int>(42);
+        while (!done.load(std::memory_order_relaxed)) {
+          buffer.enqueue(message);
+        }
+      });
+  }
+
+  auto message = std::make_shared<const int>(42);
+  for (auto _ : state) {
+    buffer.enqueue(message);
+  }
+  done.store(true);
+  for (auto & producer : producers) {
+    producer.join();
+  }
+  consumer.join();
+}
+
+BENCHMARK_TEMPLATE(enqueue_dequeue, RingBufferImplementation<BufferT>);
+BENCHMARK_TEMPLATE(enqueue_dequeue, SingleProducerRingBufferImplementation<BufferT>);
+BENCHMARK_TEMPLATE(enqueue_dequeue, MultiProducerRingBufferImplementation<BufferT>);
+
+BENCHMARK_TEMPLATE(contended_enqueue, RingBufferImplementation<BufferT>)
+->Arg(1)->Arg(4)->UseRealTime();
+BENCHMARK_TEMPLATE(contended_enqueue, SingleProducerRingBufferImplementation<BufferT>)
+->Arg(1)->UseRealTime();
+BENCHMARK_TEMPLATE(contended_enqueue, MultiProducerRingBufferImplementation<BufferT>)
+->Arg(1)->Arg(4)->UseRealTime();
@@ -0,0 +1,285 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "performance_test_fixture/performance_test_fixture.hpp"
+
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp/serialization.hpp"
+#include "rclcpp/serialized_message.hpp"
+#include "rclcpp/type_adapter.hpp"
+#include "test_msgs/msg/unbounded_sequences.hpp"
+
+using performance_test_fixture::PerformanceTest;
+
+namespace
+{
+
+/// Custom type of the type adaptation benchmarks, holding the payload like a user type would.
+struct ByteBuffer
+{
+  std::vector<uint8_t> data;
+};
+
+/// Fill the byte sequence of the message, so its serialized form is about `size` bytes.
+void
+fill_message(test_msgs::msg::UnboundedSequences & message, size_t size)
+{
+  message.uint8_values.resize(size);
+  for (size_t i = 0; i < size; ++i) {
+    message.uint8_values[i] = static_cast<uint8_t>(i);
+  }
+}
+
+/// Register the message sizes, from a small message up to a camera image or a point cloud.
+void
+message_sizes(benchmark::internal::Benchmark * benchmark)
+{
+  for (int64_t size : {64, 1024, 64 * 1024, 1024 * 1024, 16 * 1024 * 1024}) {
+    benchmark->Arg(size);
+  }
+}
+
+}  // namespace
+
+namespace rclcpp
+{
+
+template<>
+struct TypeAdapter<ByteBuffer, test_msgs::msg::UnboundedSequences>
+{
+  using is_specialized = std::true_type;
+  using custom_type = ByteBuffer;
+  using ros_message_type = test_msgs::msg::UnboundedSequences;
+
+  static void
+  convert_to_ros_message(const custom_type & source, ros_message_type & destination)
+  {
+    destination.uint8_values = source.data;
+  }
+
+  static void
+  convert_to_custom(const ros_message_type & source, custom_type & destination)
+  {
+    destination.data = source.uint8_values;
+  }
+};
+
+}  // namespace rclcpp
+
+using ByteBufferAdapter = rclcpp::TypeAdapter<ByteBuffer, test_msgs::msg::UnboundedSequences>;
+
+class SerializationPerformanceTest : public PerformanceTest
+{
+public:
+  void SetUp(benchmark::State & state)
+  {
+    fill_message(message, static_cast<size_t>(state.range(0)));
+    serialization.serialize_message(&message, &serialized_message);
+    PerformanceTest::SetUp(state);
+  }
+
+  void TearDown(benchmark::State & state)
+  {
+    state.SetBytesProcessed(
+      static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(serialized_message.size()));
+    PerformanceTest::TearDown(state);
+  }
+
+protected:
+  rclcpp::Serialization<test_msgs::msg::UnboundedSequences> serialization;
+  test_msgs::msg::UnboundedSequences message;
+  rclcpp::SerializedMessage serialized_message;
+};
+
+BENCHMARK_DEFINE_F(SerializationPerformanceTest, serialize)(benchmark::State & state)
+{
+  // The buffer already has the capacity for the message, as with a reused serialized message
+  reset_heap_counters();
+  for (auto _ : state) {
+    (void)_;
+    serialization.serialize_message(&message, &serialized_message);
+    benchmark::DoNotOptimize(serialized_message);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK_REGISTER_F(SerializationPerformanceTest, serialize)->Apply(message_sizes);
+
+BENCHMARK_DEFINE_F(SerializationPerformanceTest, serialize_new_buffer)(benchmark::State & state)
+{
+  reset_heap_counters();
+  for (auto _ : state) {
+    (void)_;
+    rclcpp::SerializedMessage new_serialized_message;
+    serialization.serialize_message(&message, &new_serialized_message);
+    benchmark::DoNotOptimize(new_serialized_message);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK_REGISTER_F(SerializationPerformanceTest, serialize_new_buffer)->Apply(message_sizes);
+
+BENCHMARK_DEFINE_F(SerializationPerformanceTest, deserialize)(benchmark::State & state)
+{
+  // The sequence already has the size of the message, as with a reused message
+  test_msgs::msg::UnboundedSequences deserialized_message;
+  serialization.deserialize_message(&serialized_message, &deserialized_message);
+  reset_heap_counters();
+  for (auto _ : state) {
+    (void)_;
+    serialization.deserialize_message(&serialized_message, &deserialized_message);
+    benchmark::DoNotOptimize(deserialized_message);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK_REGISTER_F(SerializationPerformanceTest, deserialize)->Apply(message_sizes);
+
+BENCHMARK_DEFINE_F(SerializationPerformanceTest, deserialize_new_message)(benchmark::State & state)
+{
+  reset_heap_counters();
+  for (auto _ : state) {
+    (void)_;
+    test_msgs::msg::UnboundedSequences deserialized_message;
+    serialization.deserialize_message(&serialized_message, &deserialized_message);
+    benchmark::DoNotOptimize(deserialized_message);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK_REGISTER_F(SerializationPerformanceTest, deserialize_new_message)->Apply(message_sizes);
+
+BENCHMARK_DEFINE_F(SerializationPerformanceTest, type_adapter_round_trip)(benchmark::State & state)
+{
+  // What a publisher and a subscription of the custom type do around the middleware
+  ByteBuffer custom_message;
+  custom_message.data = message.uint8_values;
+  ByteBuffer received_message;
+  test_msgs::msg::UnboundedSequences ros_message;
+  reset_heap_counters();
+  for (auto _ : state) {
+    (void)_;
+    ByteBufferAdapter::convert_to_ros_message(custom_message, ros_message);
+    serialization.serialize_message(&ros_message, &serialized_message);
+    serialization.deserialize_message(&serialized_message, &ros_message);
+    ByteBufferAdapter::convert_to_custom(ros_message, received_message);
+    benchmark::DoNotOptimize(received_message);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK_REGISTER_F(SerializationPerformanceTest, type_adapter_round_trip)->Apply(message_sizes);
+
+BENCHMARK_DEFINE_F(SerializationPerformanceTest, type_adapter_conversions)(
+  benchmark::State & state)
+{
+  // Only the cost of the conversions, to compare with the round trip
+  ByteBuffer custom_message;
+  custom_message.data = message.uint8_values;
+  ByteBuffer received_message;
+  test_msgs::msg::UnboundedSequences ros_message;
+  reset_heap_counters();
+  for (auto _ : state) {
+    (void)_;
+    ByteBufferAdapter::convert_to_ros_message(custom_message, ros_message);
+    ByteBufferAdapter::convert_to_custom(ros_message, received_message);
+    benchmark::DoNotOptimize(received_message);
+    benchmark::ClobberMemory();
+  }
+}
+BENCHMARK_REGISTER_F(SerializationPerformanceTest, type_adapter_conversions)->Apply(message_sizes);
+
+class PublishPerformanceTest : public PerformanceTest
+{
+public:
+  void SetUp(benchmark::State & state)
+  {
+    rclcpp::init(0, nullptr);
+    node = std::make_shared<rclcpp::Node>("publish_performance_node");
+    publisher = node->create_publisher<test_msgs::msg::UnboundedSequences>(
+      "publish_performance_topic", rclcpp::QoS(10));
+    adapted_publisher = node->create_publisher<ByteBufferAdapter>(
+      "publish_performance_adapted_topic", rclcpp::QoS(10));
+    fill_message(message, static_cast<size_t>(state.range(0)));
+    PerformanceTest::SetUp(state);
+  }
+
+  void TearDown(benchmark::State & state)
+  {
+    state.SetBytesProcessed(
+      static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(state.range(0)));
+    PerformanceTest::TearDown(state);
+    adapted_publisher.reset();
+    publisher.reset();
+    node.reset();
+    rclcpp::shutdown();
+  }
+
+protected:
+  rclcpp::Node::SharedPtr node;
+  rclcpp::Publisher<test_msgs::msg::UnboundedSequences>::SharedPtr publisher;
+  rclcpp::Publisher<ByteBufferAdapter>::SharedPtr adapted_publisher;
+  test_msgs::msg::UnboundedSequences message;
+};
+
+BENCHMARK_DEFINE_F(PublishPerformanceTest, publish_copy)(benchmark::State & state)
+{
+  publisher->publish(message);
+  reset_heap_counters();
+  for (auto _ : state) {
+    (void)_;
+    publisher->publish(message);
+  }
+}
+BENCHMARK_REGISTER_F(PublishPerformanceTest, publish_copy)->Apply(message_sizes);
+
+BENCHMARK_DEFINE_F(PublishPerformanceTest, publish_loaned)(benchmark::State & state)
+{
+  // Without loans from the middleware, rclcpp allocates the message it lends
+  state.counters["middleware_loans"] = publisher->can_loan_messages() ? 1 : 0;
+  reset_heap_counters();
+  for (auto _ : state) {
+    (void)_;
+    auto loaned_message = publisher->borrow_loaned_message();
+    loaned_message.get().uint8_values = message.uint8_values;
+    publisher->publish(std::move(loaned_message));
+  }
+}
+BENCHMARK_REGISTER_F(PublishPerformanceTest, publish_loaned)->Apply(message_sizes);
+
+BENCHMARK_DEFINE_F(PublishPerformanceTest, publish_serialized)(benchmark::State & state)
+{
+  rclcpp::Serialization<test_msgs::msg::UnboundedSequences> serialization;
+  rclcpp::SerializedMessage serialized_message;
+  serialization.serialize_message(&message, &serialized_message);
+  reset_heap_counters();
+  for (auto _ : state) {
+    (void)_;
+    publisher->publish(serialized_message);
+  }
+}
+BENCHMARK_REGISTER_F(PublishPerformanceTest, publish_serialized)->Apply(message_sizes);
+
+BENCHMARK_DEFINE_F(PublishPerformanceTest, publish_type_adapted)(benchmark::State & state)
+{
+  ByteBuffer custom_message;
+  custom_message.data = message.uint8_values;
+  reset_heap_counters();
+  for (auto _ : state) {
+    (void)_;
+    adapted_publisher->publish(custom_message);
+  }
+}
+BENCHMARK_REGISTER_F(PublishPerformanceTest, publish_type_adapted)->Apply(message_sizes);
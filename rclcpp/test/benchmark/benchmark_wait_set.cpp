@@ -0,0 +1,109 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "performance_test_fixture/performance_test_fixture.hpp"
+
+#include "rclcpp/rclcpp.hpp"
+#include "test_msgs/msg/empty.hpp"
+
+using performance_test_fixture::PerformanceTest;
+
+constexpr size_t kNumberOfSubscriptions = 4;
+
+class PerformanceTestWaitSet : public PerformanceTest
+{
+public:
+  void SetUp(benchmark::State & st)
+  {
+    rclcpp::init(0, nullptr);
+    node = std::make_shared<rclcpp::Node>("my_node");
+    for (size_t i = 0; i < kNumberOfSubscriptions; ++i) {
+      subscriptions.push_back(
+        node->create_subscription<test_msgs::msg::Empty>(
+          "/empty_msgs_" + std::to_string(i), rclcpp::QoS(10),
+          [](test_msgs::msg::Empty::ConstSharedPtr) {}));
+    }
+    guard_condition = std::make_shared<rclcpp::GuardCondition>();
+    PerformanceTest::SetUp(st);
+  }
+
+  void TearDown(benchmark::State & st)
+  {
+    PerformanceTest::TearDown(st);
+    guard_condition.reset();
+    subscriptions.clear();
+    node.reset();
+    rclcpp::shutdown();
+  }
+
+  /// Wait once per iteration, on the triggered guard condition and the idle subscriptions.
+  template<class WaitSetT>
+  void
+  wait_repeatedly(WaitSetT & wait_set, benchmark::State & st)
+  {
+    // Warm up, so that only the cost of the following waits is measured
+    guard_condition->trigger();
+    if (wait_set.wait(std::chrono::seconds(1)).kind() != rclcpp::WaitResultKind::Ready) {
+      st.SkipWithError("The wait set wasn't ready");
+      return;
+    }
+    reset_heap_counters();
+
+    for (auto _ : st) {
+      (void)_;
+      guard_condition->trigger();
+      auto wait_result = wait_set.wait(std::chrono::seconds(1));
+      if (wait_result.kind() != rclcpp::WaitResultKind::Ready) {
+        st.SkipWithError("The wait set wasn't ready");
+        break;
+      }
+    }
+  }
+
+  rclcpp::Node::SharedPtr node;
+  std::vector<rclcpp::SubscriptionBase::SharedPtr> subscriptions;
+  rclcpp::GuardCondition::SharedPtr guard_condition;
+};
+
+BENCHMARK_F(PerformanceTestWaitSet, static_storage_wait)(benchmark::State & st)
+{
+  rclcpp::StaticWaitSet<kNumberOfSubscriptions, 1, 0, 0, 0, 0> wait_set(
+    {{{subscriptions[0]}, {subscriptions[1]}, {subscriptions[2]}, {subscriptions[3]}}},
+    {guard_condition});
+  wait_repeatedly(wait_set, st);
+}
+
+BENCHMARK_F(PerformanceTestWaitSet, dynamic_storage_wait)(benchmark::State & st)
+{
+  rclcpp::WaitSet wait_set;
+  for (const auto & subscription : subscriptions) {
+    wait_set.add_subscription(subscription);
+  }
+  wait_set.add_guard_condition(guard_condition);
+  wait_repeatedly(wait_set, st);
+}
+
+BENCHMARK_F(PerformanceTestWaitSet, thread_safe_dynamic_storage_wait)(benchmark::State & st)
+{
+  rclcpp::ThreadSafeWaitSet wait_set;
+  for (const auto & subscription : subscriptions) {
+    wait_set.add_subscription(subscription);
+  }
+  wait_set.add_guard_condition(guard_condition);
+  wait_repeatedly(wait_set, st);
+}
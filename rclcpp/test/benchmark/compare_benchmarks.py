@@ -0,0 +1,259 @@
+#!/usr/bin/env python3
+# Copyright 2022 Open Source Robotics Foundation, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+Run the benchmarks of the rclcpp packages and compare their results against a baseline.
+
+The benchmarks are the ``add_performance_test`` and ``ament_add_google_benchmark`` targets of
+rclcpp, rclcpp_action, rclcpp_components and rclcpp_lifecycle.
+Each of them writes the Google Benchmark results of the package into
+``<build-base>/<package>/test_results/<package>/<target>.google_benchmark.json``.
+
+The results are normalized into a single json file mapping ``<package>/<benchmark name>`` to
+metrics.
+The times are taken in nanoseconds and the counters are kept by name, e.g. the allocation
+counts reported by performance_test_fixture.
+
+Typical use, from the root of a colcon workspace::
+
+    # Run the benchmarks and store the results as the baseline
+    compare_benchmarks.py run --output baseline.json
+    # After a change, run them again and compare, failing on regressions
+    compare_benchmarks.py run --output current.json
+    compare_benchmarks.py compare baseline.json current.json --time-threshold 0.1
+
+The baseline can also be downloaded, by giving an http(s) URL instead of a path.
+"""
+
+import argparse
+import fnmatch
+import glob
+import json
+import os
+import subprocess
+import sys
+import urllib.request
+
+PACKAGES = ['rclcpp', 'rclcpp_action', 'rclcpp_components', 'rclcpp_lifecycle']
+
+TIME_UNITS_IN_NS = {'ns': 1.0, 'us': 1e3, 'ms': 1e6, 's': 1e9}
+
+TIME_METRICS = ['real_time_ns', 'cpu_time_ns']
+
+
+def run_benchmarks(build_base, packages):
+    """Run the benchmark tests of each package, return False if one of them failed."""
+    env = dict(os.environ)
+    # performance_test_fixture skips the performance tests unless asked to run them
+    env['AMENT_RUN_PERFORMANCE_TESTS'] = '1'
+    success = True
+    for package in packages:
+        package_build = os.path.join(build_base, package)
+        if not os.path.isdir(package_build):
+            print(f"Skipping '{package}', it isn't built in '{build_base}'", file=sys.stderr)
+            continue
+        ret = subprocess.run(
+            ['ctest', '--test-dir', package_build, '-R', 'benchmark', '--output-on-failure'],
+            env=env)
+        success = success and ret.returncode == 0
+    return success
+
+
+def is_allocation_counter(name):
+    return 'alloc' in name
+
+
+def normalize_benchmark(benchmark):
+    """Return the metrics of a Google Benchmark result, the times converted to nanoseconds."""
+    scale = TIME_UNITS_IN_NS.get(benchmark.get('time_unit', 'ns'), 1.0)
+    metrics = {
+        'real_time_ns': benchmark['real_time'] * scale,
+        'cpu_time_ns': benchmark['cpu_time'] * scale,
+    }
+    ignored = {
+        'name', 'run_name', 'run_type', 'repetitions', 'repetition_index', 'threads',
+        'family_index', 'per_family_instance_index', 'aggregate_name', 'aggregate_unit',
+        'iterations', 'real_time', 'cpu_time', 'time_unit', 'error_occurred', 'error_message',
+        'label',
+    }
+    for key, value in benchmark.items():
+        if key not in ignored and isinstance(value, (int, float)):
+            metrics[key] = float(value)
+    return metrics
+
+
+def collect_results(build_base, packages):
+    """Return the normalized results of the packages, found in their test results."""
+    results = {}
+    for package in packages:
+        pattern = os.path.join(
+            build_base, package, 'test_results', package, '*.google_benchmark.json')
+        for path in sorted(glob.glob(pattern)):
+            with open(path, 'r') as f:
+                output = json.load(f)
+            results.update(normalize_output(package, output))
+    return results
+
+
+def normalize_output(package, output):
+    """Return the normalized results of the Google Benchmark output of a package."""
+    results = {}
+    # With repetitions, the medians are compared, otherwise the single runs
+    has_aggregates = any(
+        b.get('run_type') == 'aggregate' for b in output.get('benchmarks', []))
+    for benchmark in output.get('benchmarks', []):
+        if benchmark.get('error_occurred'):
+            continue
+        if has_aggregates:
+            if benchmark.get('aggregate_name') != 'median':
+                continue
+            name = benchmark.get('run_name', benchmark['name'])
+        else:
+            name = benchmark['name']
+        results[f'{package}/{name}'] = normalize_benchmark(benchmark)
+    return results
+
+
+def load_results(location):
+    """Load normalized results from a path or an http(s) URL."""
+    if location.startswith('http://') or location.startswith('https://'):
+        with urllib.request.urlopen(location) as response:
+            return json.loads(response.read().decode('utf-8'))
+    with open(location, 'r') as f:
+        return json.load(f)
+
+
+def load_thresholds(path):
+    """
+    Load the thresholds overriding the defaults for some benchmarks.
+
+    The file holds a json list of objects such as
+    ``{"pattern": "rclcpp/*_latency*", "time": 0.25, "allocations": 2}``.
+    The first pattern matching a benchmark name, with fnmatch, gives its thresholds.
+    """
+    if not path:
+        return []
+    with open(path, 'r') as f:
+        return json.load(f)
+
+
+def thresholds_of(name, overrides, time_threshold, allocation_threshold):
+    for override in overrides:
+        if fnmatch.fnmatch(name, override['pattern']):
+            return (
+                override.get('time', time_threshold),
+                override.get('allocations', allocation_threshold))
+    return time_threshold, allocation_threshold
+
+
+def compare(baseline, current, time_threshold, allocation_threshold, overrides):
+    """
+    Compare the current results to the baseline.
+
+    A time regresses when it grows by more than the relative time threshold, an allocation
+    counter when it grows by more than the absolute allocation threshold.
+    Return the list of regressions and the list of the benchmarks missing from the results.
+    """
+    regressions = []
+    for name in sorted(set(baseline) & set(current)):
+        name_time_threshold, name_allocation_threshold = thresholds_of(
+            name, overrides, time_threshold, allocation_threshold)
+        for metric, base_value in sorted(baseline[name].items()):
+            if metric not in current[name]:
+                continue
+            value = current[name][metric]
+            if metric in TIME_METRICS:
+                if base_value > 0 and value > base_value * (1.0 + name_time_threshold):
+                    regressions.append((name, metric, base_value, value))
+            elif is_allocation_counter(metric):
+                if value > base_value + name_allocation_threshold:
+                    regressions.append((name, metric, base_value, value))
+    missing = sorted(set(baseline) - set(current))
+    return regressions, missing
+
+
+def print_comparison(baseline, current, regressions, missing):
+    for name in sorted(set(baseline) & set(current)):
+        base = baseline[name]['real_time_ns']
+        value = current[name]['real_time_ns']
+        change = (value - base) / base * 100.0 if base > 0 else 0.0
+        print(f'{name}: {base:.0f} ns -> {value:.0f} ns ({change:+.1f}%)')
+    for name in sorted(set(current) - set(baseline)):
+        print(f'{name}: new benchmark')
+    for name in missing:
+        print(f'{name}: missing from the results', file=sys.stderr)
+    for name, metric, base_value, value in regressions:
+        print(
+            f'REGRESSION {name} {metric}: {base_value:.1f} -> {value:.1f}', file=sys.stderr)
+
+
+def main(argv=sys.argv[1:]):
+    parser = argparse.ArgumentParser(
+        description=__doc__.split('\n\n')[0].strip(),
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+    subparsers = parser.add_subparsers(dest='command', required=True)
+
+    run_parser = subparsers.add_parser(
+        'run', help='Run the benchmarks and write their normalized results')
+    run_parser.add_argument(
+        '--build-base', default='build', help='The build directory of the workspace')
+    run_parser.add_argument(
+        '--packages', nargs='+', default=PACKAGES, help='The packages to benchmark')
+    run_parser.add_argument(
+        '--skip-run', action='store_true',
+        help='Only collect the results of a previous run of the benchmarks')
+    run_parser.add_argument('--output', required=True, help='The file to write the results to')
+
+    compare_parser = subparsers.add_parser(
+        'compare', help='Compare normalized results against a baseline')
+    compare_parser.add_argument('baseline', help='Path or http(s) URL of the baseline')
+    compare_parser.add_argument('current', help='Path of the results to compare')
+    compare_parser.add_argument(
+        '--time-threshold', type=float, default=0.1,
+        help='Relative increase of a time considered a regression')
+    compare_parser.add_argument(
+        '--allocation-threshold', type=float, default=0.0,
+        help='Increase of an allocation count considered a regression')
+    compare_parser.add_argument(
+        '--thresholds', help='json file of thresholds overriding the defaults per benchmark')
+    compare_parser.add_argument(
+        '--fail-on-missing', action='store_true',
+        help='Also fail when benchmarks of the baseline are missing from the results')
+
+    args = parser.parse_args(argv)
+
+    if args.command == 'run':
+        success = True
+        if not args.skip_run:
+            success = run_benchmarks(args.build_base, args.packages)
+        results = collect_results(args.build_base, args.packages)
+        with open(args.output, 'w') as f:
+            json.dump(results, f, indent=2, sort_keys=True)
+        print(f"Wrote the results of {len(results)} benchmarks to '{args.output}'")
+        return 0 if success and results else 1
+
+    baseline = load_results(args.baseline)
+    current = load_results(args.current)
+    regressions, missing = compare(
+        baseline, current, args.time_threshold, args.allocation_threshold,
+        load_thresholds(args.thresholds))
+    print_comparison(baseline, current, regressions, missing)
+    if regressions or (args.fail_on_missing and missing):
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,133 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "rclcpp/allocator/callback_arena.hpp"
+#include "rclcpp/strategies/callback_arena_memory_strategy.hpp"
+
+using rclcpp::allocator::CallbackArena;
+using rclcpp::allocator::CallbackArenaAllocator;
+using rclcpp::allocator::CallbackArenaScope;
+
+TEST(TestCallbackArena, allocate_and_reset) {
+  CallbackArena arena(64);
+  EXPECT_EQ(64u, arena.get_capacity());
+  EXPECT_EQ(0u, arena.get_used());
+
+  void * first = arena.allocate(10);
+  void * second = arena.allocate(10);
+  EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(second) % alignof(std::max_align_t));
+  EXPECT_NE(first, second);
+  EXPECT_GE(arena.get_used(), 20u);
+
+  arena.reset();
+  EXPECT_EQ(0u, arena.get_used());
+  EXPECT_EQ(first, arena.allocate(10));
+}
+
+TEST(TestCallbackArena, grow_and_merge) {
+  CallbackArena arena(32);
+  arena.allocate(24);
+  arena.allocate(100);
+  const size_t grown_capacity = arena.get_capacity();
+  EXPECT_GT(grown_capacity, 32u);
+
+  // After the reset the same allocations fit in a single chunk
+  arena.reset();
+  EXPECT_EQ(grown_capacity, arena.get_capacity());
+  arena.allocate(24);
+  arena.allocate(100);
+  EXPECT_EQ(grown_capacity, arena.get_capacity());
+
+  EXPECT_THROW(arena.allocate(8, 3), std::bad_alloc);
+}
+
+TEST(TestCallbackArena, scope) {
+  EXPECT_EQ(nullptr, CallbackArena::get_current());
+  {
+    CallbackArenaScope scope(256);
+    CallbackArena * arena = CallbackArena::get_current();
+    ASSERT_NE(nullptr, arena);
+    EXPECT_GE(arena->get_capacity(), 256u);
+    arena->allocate(16);
+    {
+      // Nested scopes share the arena and don't reset it
+      CallbackArenaScope nested_scope(16);
+      EXPECT_EQ(arena, CallbackArena::get_current());
+      arena->allocate(16);
+    }
+    EXPECT_EQ(arena, CallbackArena::get_current());
+    EXPECT_GE(arena->get_used(), 32u);
+  }
+  EXPECT_EQ(nullptr, CallbackArena::get_current());
+
+  {
+    CallbackArenaScope scope(1024);
+    ASSERT_NE(nullptr, CallbackArena::get_current());
+    EXPECT_GE(CallbackArena::get_current()->get_capacity(), 1024u);
+    EXPECT_EQ(0u, CallbackArena::get_current()->get_used());
+  }
+}
+
+TEST(TestCallbackArena, allocator) {
+  // Without an arena the memory comes from the heap
+  std::vector<int, CallbackArenaAllocator<int>> heap_vector(100, 1);
+  EXPECT_EQ(1, heap_vector[99]);
+
+  {
+    CallbackArenaScope scope(4096);
+    CallbackArena * arena = CallbackArena::get_current();
+    std::vector<int, CallbackArenaAllocator<int>> vector;
+    for (int i = 0; i < 100; ++i) {
+      vector.push_back(i);
+    }
+    EXPECT_EQ(99, vector.back());
+    EXPECT_GE(arena->get_used(), 100 * sizeof(int));
+
+    // Memory from the heap can still be released within the scope
+    heap_vector.clear();
+    heap_vector.shrink_to_fit();
+
+    auto shared = std::allocate_shared<int>(CallbackArenaAllocator<int>(), 42);
+    EXPECT_EQ(42, *shared);
+  }
+  EXPECT_EQ(CallbackArenaAllocator<int>(), CallbackArenaAllocator<double>());
+}
+
+struct ArenaTestMessage
+{
+  int64_t data[8];
+};
+
+TEST(TestCallbackArena, message_memory_strategy) {
+  using rclcpp::strategies::callback_arena_memory_strategy::CallbackArenaMessageMemoryStrategy;
+  auto strategy = std::make_shared<CallbackArenaMessageMemoryStrategy<ArenaTestMessage>>();
+
+  auto message = strategy->borrow_message();
+  ASSERT_NE(nullptr, message);
+  strategy->return_message(message);
+
+  CallbackArenaScope scope(4096);
+  CallbackArena * arena = CallbackArena::get_current();
+  const size_t used = arena->get_used();
+  message = strategy->borrow_message();
+  ASSERT_NE(nullptr, message);
+  EXPECT_GE(arena->get_used(), used + sizeof(ArenaTestMessage));
+  strategy->return_message(message);
+}
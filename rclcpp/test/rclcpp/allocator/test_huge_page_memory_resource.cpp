@@ -0,0 +1,146 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+#include "rclcpp/allocator/huge_page_memory_resource.hpp"
+#include "rclcpp/allocator/memory_resource.hpp"
+
+using rclcpp::allocator::HugePageMemoryResource;
+using rclcpp::allocator::HugePageMemoryResourceOptions;
+using rclcpp::allocator::HugePageMode;
+using rclcpp::allocator::MemoryResourceAllocator;
+
+namespace
+{
+
+constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+}  // namespace
+
+TEST(TestHugePageMemoryResource, construction) {
+  HugePageMemoryResourceOptions options;
+  options.upstream = nullptr;
+  EXPECT_THROW(HugePageMemoryResource{options}, std::invalid_argument);
+  options = HugePageMemoryResourceOptions();
+  options.huge_page_size = 3 * 1024 * 1024;
+  EXPECT_THROW(HugePageMemoryResource{options}, std::invalid_argument);
+
+  HugePageMemoryResource resource;
+  EXPECT_TRUE(resource.is_equal(resource));
+  HugePageMemoryResource other;
+  EXPECT_FALSE(resource.is_equal(other));
+}
+
+TEST(TestHugePageMemoryResource, small_allocations) {
+  HugePageMemoryResource resource;
+  void * pointer = resource.allocate(1024, alignof(std::max_align_t));
+  ASSERT_NE(nullptr, pointer);
+  std::memset(pointer, 1, 1024);
+  resource.deallocate(pointer, 1024, alignof(std::max_align_t));
+
+  auto statistics = resource.get_statistics();
+  EXPECT_EQ(1u, statistics.upstream_allocations);
+  EXPECT_EQ(0u, statistics.mappings);
+  EXPECT_EQ(0u, statistics.mapped_bytes);
+}
+
+TEST(TestHugePageMemoryResource, reuse) {
+  HugePageMemoryResource resource;
+  const size_t size = 10 * 1024 * 1024;
+  void * pointer = resource.allocate(size, alignof(std::max_align_t));
+  ASSERT_NE(nullptr, pointer);
+#ifdef __linux__
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(pointer) % kHugePageSize);
+#endif
+  std::memset(pointer, 1, size);
+  resource.deallocate(pointer, size, alignof(std::max_align_t));
+  auto statistics = resource.get_statistics();
+  EXPECT_EQ(1u, statistics.mappings);
+  EXPECT_EQ(0u, statistics.reuses);
+  EXPECT_GE(statistics.cached_bytes, size);
+  EXPECT_LE(statistics.cached_bytes, size + size / 4 + kHugePageSize);
+  EXPECT_EQ(statistics.cached_bytes, statistics.mapped_bytes);
+
+  // A slightly smaller allocation is in the same size class
+  void * reused = resource.allocate(size - 1024, alignof(std::max_align_t));
+  EXPECT_EQ(pointer, reused);
+  statistics = resource.get_statistics();
+  EXPECT_EQ(1u, statistics.mappings);
+  EXPECT_EQ(1u, statistics.reuses);
+  EXPECT_EQ(0u, statistics.cached_bytes);
+  resource.deallocate(reused, size - 1024, alignof(std::max_align_t));
+
+  resource.release();
+  statistics = resource.get_statistics();
+  EXPECT_EQ(0u, statistics.cached_bytes);
+  EXPECT_EQ(0u, statistics.mapped_bytes);
+}
+
+TEST(TestHugePageMemoryResource, max_cached_bytes) {
+  HugePageMemoryResourceOptions options;
+  options.max_cached_bytes = 0;
+  HugePageMemoryResource resource(options);
+  for (size_t i = 0; i < 3; ++i) {
+    void * pointer = resource.allocate(4 * 1024 * 1024, alignof(std::max_align_t));
+    resource.deallocate(pointer, 4 * 1024 * 1024, alignof(std::max_align_t));
+  }
+  auto statistics = resource.get_statistics();
+  EXPECT_EQ(3u, statistics.mappings);
+  EXPECT_EQ(0u, statistics.reuses);
+  EXPECT_EQ(0u, statistics.mapped_bytes);
+}
+
+TEST(TestHugePageMemoryResource, over_aligned) {
+  HugePageMemoryResource resource;
+  EXPECT_THROW((void)resource.allocate(4 * 1024 * 1024, 2 * kHugePageSize), std::bad_alloc);
+}
+
+TEST(TestHugePageMemoryResource, explicit_huge_pages) {
+  // Whether huge pages are reserved or not, the allocations succeed
+  HugePageMemoryResourceOptions options;
+  options.mode = HugePageMode::Explicit;
+  options.prefault = true;
+  HugePageMemoryResource resource(options);
+  const size_t size = 3 * 1024 * 1024;
+  void * pointer = resource.allocate(size, alignof(std::max_align_t));
+  ASSERT_NE(nullptr, pointer);
+  std::memset(pointer, 1, size);
+  resource.deallocate(pointer, size, alignof(std::max_align_t));
+  auto statistics = resource.get_statistics();
+  EXPECT_EQ(1u, statistics.mappings);
+  EXPECT_LE(statistics.huge_page_fallbacks, 1u);
+}
+
+TEST(TestHugePageMemoryResource, allocator) {
+  HugePageMemoryResource resource;
+  using VectorT = std::vector<uint8_t, MemoryResourceAllocator<uint8_t>>;
+  for (size_t i = 0; i < 4; ++i) {
+    VectorT message(4 * 1024 * 1024, static_cast<uint8_t>(i), &resource);
+    // The copies of the intra-process delivery keep the memory resource
+    VectorT copy(message);
+    EXPECT_EQ(&resource, copy.get_allocator().resource());
+    EXPECT_EQ(i, copy.back());
+  }
+  auto statistics = resource.get_statistics();
+  EXPECT_EQ(2u, statistics.mappings);
+  EXPECT_EQ(6u, statistics.reuses);
+}
@@ -0,0 +1,184 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+#include "rclcpp/allocator/allocator_common.hpp"
+#include "rclcpp/allocator/memory_resource.hpp"
+#include "rclcpp/publisher_options.hpp"
+#include "rclcpp/subscription_options.hpp"
+
+using rclcpp::allocator::MemoryResourceAllocator;
+using rclcpp::allocator::MemoryResourceOptions;
+using rclcpp::allocator::MemoryResourceType;
+
+// Memory resource checking that the memory is released with the size it was allocated with
+class CheckingMemoryResource : public std::pmr::memory_resource
+{
+public:
+  size_t allocation_count = 0;
+  std::map<void *, size_t> live_allocations;
+  bool size_mismatch = false;
+
+private:
+  void * do_allocate(size_t bytes, size_t alignment) override
+  {
+    void * pointer = std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    ++allocation_count;
+    live_allocations[pointer] = bytes;
+    return pointer;
+  }
+
+  void do_deallocate(void * pointer, size_t bytes, size_t alignment) override
+  {
+    auto it = live_allocations.find(pointer);
+    if (it == live_allocations.end() || it->second != bytes) {
+      size_mismatch = true;
+    } else {
+      live_allocations.erase(it);
+    }
+    std::pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+  }
+
+  bool do_is_equal(const std::pmr::memory_resource & other) const noexcept override
+  {
+    return this == &other;
+  }
+};
+
+TEST(TestMemoryResource, allocator) {
+  CheckingMemoryResource resource;
+  MemoryResourceAllocator<> allocator(&resource);
+  EXPECT_EQ(&resource, allocator.resource());
+  {
+    std::vector<int, MemoryResourceAllocator<int>> vector(allocator);
+    for (int i = 0; i < 100; ++i) {
+      vector.push_back(i);
+    }
+    EXPECT_GT(resource.allocation_count, 0u);
+
+    // Copies of the container keep the memory resource
+    auto copy = vector;
+    EXPECT_EQ(&resource, copy.get_allocator().resource());
+  }
+  EXPECT_TRUE(resource.live_allocations.empty());
+  EXPECT_FALSE(resource.size_mismatch);
+
+  EXPECT_EQ(MemoryResourceAllocator<>(), MemoryResourceAllocator<int>());
+  EXPECT_NE(allocator, MemoryResourceAllocator<>());
+  EXPECT_EQ(std::pmr::get_default_resource(), MemoryResourceAllocator<>().resource());
+  EXPECT_THROW(MemoryResourceAllocator<>(nullptr), std::invalid_argument);
+}
+
+TEST(TestMemoryResource, deleter) {
+  CheckingMemoryResource resource;
+  MemoryResourceAllocator<int64_t> allocator(&resource);
+  using Deleter = rclcpp::allocator::Deleter<MemoryResourceAllocator<int64_t>, int64_t>;
+
+  // The deleters release a single element whatever the allocated size
+  int64_t * values = allocator.allocate(8);
+  Deleter deleter;
+  rclcpp::allocator::set_allocator_for_deleter(&deleter, &allocator);
+  std::unique_ptr<int64_t, Deleter> pointer(values, deleter);
+  pointer.reset();
+
+  auto shared = std::allocate_shared<int64_t>(allocator, 42);
+  EXPECT_EQ(42, *shared);
+  shared.reset();
+
+  EXPECT_TRUE(resource.live_allocations.empty());
+  EXPECT_FALSE(resource.size_mismatch);
+}
+
+#ifndef _WIN32
+TEST(TestMemoryResource, rcl_allocator) {
+  CheckingMemoryResource resource;
+  MemoryResourceAllocator<char> allocator(&resource);
+  rcl_allocator_t rcl_allocator = rclcpp::allocator::get_rcl_allocator<char>(allocator);
+
+  auto memory = static_cast<char *>(rcl_allocator.allocate(6, rcl_allocator.state));
+  ASSERT_NE(nullptr, memory);
+  std::memcpy(memory, "hello", 6);
+  memory = static_cast<char *>(rcl_allocator.reallocate(memory, 1024, rcl_allocator.state));
+  ASSERT_NE(nullptr, memory);
+  EXPECT_STREQ("hello", memory);
+  rcl_allocator.deallocate(memory, rcl_allocator.state);
+
+  auto zeroed = static_cast<char *>(rcl_allocator.zero_allocate(4, 4, rcl_allocator.state));
+  ASSERT_NE(nullptr, zeroed);
+  EXPECT_EQ(0, zeroed[15]);
+  rcl_allocator.deallocate(zeroed, rcl_allocator.state);
+
+  EXPECT_EQ(3u, resource.allocation_count);
+  EXPECT_TRUE(resource.live_allocations.empty());
+  EXPECT_FALSE(resource.size_mismatch);
+}
+#endif
+
+TEST(TestMemoryResource, create_memory_resource) {
+  EXPECT_EQ(
+    MemoryResourceType::NewDelete,
+    rclcpp::allocator::memory_resource_type_from_string("new_delete"));
+  EXPECT_EQ(
+    MemoryResourceType::SynchronizedPool,
+    rclcpp::allocator::memory_resource_type_from_string("synchronized_pool"));
+  EXPECT_EQ(
+    MemoryResourceType::UnsynchronizedPool,
+    rclcpp::allocator::memory_resource_type_from_string("unsynchronized_pool"));
+  EXPECT_EQ(
+    MemoryResourceType::Monotonic,
+    rclcpp::allocator::memory_resource_type_from_string("monotonic"));
+  EXPECT_EQ(
+    MemoryResourceType::HugePage,
+    rclcpp::allocator::memory_resource_type_from_string("huge_page"));
+  EXPECT_THROW(
+    rclcpp::allocator::memory_resource_type_from_string("unknown"), std::invalid_argument);
+
+  for (auto type : {MemoryResourceType::NewDelete, MemoryResourceType::SynchronizedPool,
+      MemoryResourceType::UnsynchronizedPool, MemoryResourceType::Monotonic,
+      MemoryResourceType::HugePage})
+  {
+    MemoryResourceOptions options;
+    options.type = type;
+    options.initial_size = 1024;
+    auto resource = rclcpp::allocator::create_memory_resource(options);
+    ASSERT_NE(nullptr, resource);
+    std::vector<int, MemoryResourceAllocator<int>> vector(100, 1, resource.get());
+    EXPECT_EQ(1, vector[99]);
+  }
+  EXPECT_EQ(
+    std::pmr::new_delete_resource(), rclcpp::allocator::create_memory_resource().get());
+}
+
+TEST(TestMemoryResource, options) {
+  auto resource = rclcpp::allocator::create_memory_resource(
+    {MemoryResourceType::SynchronizedPool, {}, 0});
+
+  rclcpp::PublisherOptionsWithMemoryResource publisher_options;
+  EXPECT_EQ(std::pmr::get_default_resource(), publisher_options.get_allocator()->resource());
+  publisher_options.allocator =
+    std::make_shared<MemoryResourceAllocator<>>(resource.get());
+  EXPECT_EQ(resource.get(), publisher_options.get_allocator()->resource());
+
+  rclcpp::SubscriptionOptionsWithMemoryResource subscription_options;
+  subscription_options.allocator = publisher_options.allocator;
+  EXPECT_EQ(*publisher_options.get_allocator(), *subscription_options.get_allocator());
+}
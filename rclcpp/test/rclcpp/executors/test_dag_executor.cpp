@@ -0,0 +1,153 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/executors/dag_executor.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+using namespace std::chrono_literals;
+
+class TestDagExecutor : public ::testing::Test
+{
+protected:
+  static void SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  static void TearDownTestCase()
+  {
+    rclcpp::shutdown();
+  }
+};
+
+TEST_F(TestDagExecutor, topological_order) {
+  rclcpp::executors::DagPipeline pipeline("explicit");
+  auto noop = []() {};
+  pipeline.add_stage("fuse", noop, {"camera", "lidar"});
+  pipeline.add_stage("lidar", noop);
+  pipeline.add_stage("camera", noop);
+  pipeline.add_stage("plan", noop, {"fuse"});
+  EXPECT_EQ(4u, pipeline.get_number_of_stages());
+  EXPECT_EQ(
+    (std::vector<std::string>{"lidar", "camera", "fuse", "plan"}),
+    pipeline.get_topological_order());
+
+  rclcpp::executors::DagPipeline topics("topics");
+  topics.add_stage_with_topics("plan", noop, {"objects"}, {"path"});
+  topics.add_stage_with_topics("detect", noop, {"image"}, {"objects"});
+  topics.add_stage_with_topics("control", noop, {"path", "objects"}, {});
+  EXPECT_EQ(
+    (std::vector<std::string>{"detect", "plan", "control"}),
+    topics.get_topological_order());
+}
+
+TEST_F(TestDagExecutor, invalid_pipelines) {
+  auto noop = []() {};
+  rclcpp::executors::DagPipeline pipeline("invalid");
+  pipeline.add_stage("a", noop, {"b"});
+  EXPECT_THROW(pipeline.add_stage("a", noop), std::invalid_argument);
+  EXPECT_THROW(pipeline.add_stage("empty", nullptr), std::invalid_argument);
+  // b is unknown
+  EXPECT_THROW(pipeline.get_topological_order(), std::invalid_argument);
+  pipeline.add_stage("b", noop, {"c"});
+  pipeline.add_stage("c", noop, {"a"});
+  EXPECT_THROW(pipeline.get_topological_order(), std::invalid_argument);
+
+  rclcpp::executors::DagExecutor executor;
+  EXPECT_THROW(executor.add_pipeline(pipeline), std::invalid_argument);
+  EXPECT_THROW(executor.run_pipeline(0), std::out_of_range);
+}
+
+/*
+   Test that the stages of a diamond run after their dependencies, with the branches in parallel.
+ */
+TEST_F(TestDagExecutor, run_diamond) {
+  rclcpp::executors::DagExecutor executor(rclcpp::ExecutorOptions(), 4u);
+  EXPECT_EQ(4u, executor.get_number_of_threads());
+
+  std::mutex mutex;
+  std::vector<std::string> completed;
+  auto stage = [&](const std::string & name) {
+      return [&, name]() {
+               std::this_thread::sleep_for(1ms);
+               std::lock_guard<std::mutex> lock(mutex);
+               completed.push_back(name);
+             };
+    };
+  rclcpp::executors::DagPipeline pipeline("diamond");
+  pipeline.add_stage("source", stage("source"));
+  pipeline.add_stage("left", stage("left"), {"source"});
+  pipeline.add_stage("right", stage("right"), {"source"});
+  pipeline.add_stage("sink", stage("sink"), {"left", "right"});
+  const size_t index = executor.add_pipeline(pipeline);
+
+  for (size_t run = 0; run < 10; ++run) {
+    completed.clear();
+    executor.run_pipeline(index);
+    ASSERT_EQ(4u, completed.size());
+    EXPECT_EQ("source", completed.front());
+    EXPECT_EQ("sink", completed.back());
+  }
+}
+
+TEST_F(TestDagExecutor, stage_exception) {
+  for (size_t number_of_threads : {1u, 3u}) {
+    rclcpp::executors::DagExecutor executor(rclcpp::ExecutorOptions(), number_of_threads);
+    std::atomic_int runs{0};
+    rclcpp::executors::DagPipeline pipeline("throwing");
+    pipeline.add_stage("first", []() {throw std::runtime_error("stage failed");});
+    pipeline.add_stage("second", [&runs]() {++runs;}, {"first"});
+    const size_t index = executor.add_pipeline(pipeline);
+    EXPECT_THROW(executor.run_pipeline(index), std::runtime_error);
+    EXPECT_EQ(0, runs.load());
+    // The pipeline runs again after a failure
+    EXPECT_THROW(executor.run_pipeline(index), std::runtime_error);
+  }
+}
+
+TEST_F(TestDagExecutor, timer_trigger) {
+  rclcpp::executors::DagExecutor executor(rclcpp::ExecutorOptions(), 2u);
+  auto node = std::make_shared<rclcpp::Node>("test_dag_executor_timer");
+  std::atomic_int timer_count{0};
+  std::vector<int> stages_seen;
+  auto timer = node->create_wall_timer(1ms, [&timer_count]() {++timer_count;});
+
+  rclcpp::executors::DagPipeline pipeline("timer");
+  pipeline.add_stage_with_topics(
+    "read", [&]() {stages_seen.push_back(timer_count.load());}, {}, {"sample"});
+  pipeline.add_stage_with_topics(
+    "write", [&]() {stages_seen.push_back(-timer_count.load());}, {"sample"}, {});
+  pipeline.set_trigger(timer);
+  executor.add_pipeline(pipeline);
+  EXPECT_THROW(executor.add_pipeline(pipeline), std::invalid_argument);
+
+  executor.add_node(node);
+  auto start = std::chrono::steady_clock::now();
+  while (timer_count == 0 && std::chrono::steady_clock::now() - start < 10s) {
+    executor.spin_once(10ms);
+  }
+  ASSERT_EQ(1, timer_count.load());
+  EXPECT_EQ((std::vector<int>{1, -1}), stages_seen);
+}
@@ -0,0 +1,305 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp/experimental/executors/events_executor/events_executor.hpp"
+
+#include "test_msgs/msg/empty.hpp"
+#include "test_msgs/srv/empty.hpp"
+
+using namespace std::chrono_literals;
+
+using rclcpp::experimental::executors::EventsExecutor;
+
+class TestEventsExecutor : public ::testing::Test
+{
+public:
+  void SetUp()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  void TearDown()
+  {
+    rclcpp::shutdown();
+  }
+};
+
+TEST_F(TestEventsExecutor, null_events_queue) {
+  EXPECT_THROW(EventsExecutor executor(nullptr), std::invalid_argument);
+}
+
+TEST_F(TestEventsExecutor, run_pub_sub) {
+  auto node = std::make_shared<rclcpp::Node>("node", "ns");
+
+  std::atomic<bool> msg_received {false};
+  auto subscription = node->create_subscription<test_msgs::msg::Empty>(
+    "topic", rclcpp::SensorDataQoS(),
+    [&msg_received](test_msgs::msg::Empty::ConstSharedPtr msg)
+    {
+      (void)msg;
+      msg_received = true;
+    });
+
+  auto publisher = node->create_publisher<test_msgs::msg::Empty>("topic", rclcpp::SensorDataQoS());
+
+  EventsExecutor executor;
+  executor.add_node(node);
+
+  bool spin_exited = false;
+  std::thread spinner([&spin_exited, &executor]() {
+      executor.spin();
+      spin_exited = true;
+    });
+
+  auto start = std::chrono::steady_clock::now();
+  while (!msg_received && (std::chrono::steady_clock::now() - start < 10s)) {
+    publisher->publish(std::make_unique<test_msgs::msg::Empty>());
+    std::this_thread::sleep_for(10ms);
+  }
+
+  EXPECT_TRUE(msg_received);
+
+  executor.cancel();
+  spinner.join();
+  EXPECT_TRUE(spin_exited);
+}
+
+TEST_F(TestEventsExecutor, run_clients_servers) {
+  auto node = std::make_shared<rclcpp::Node>("node", "ns");
+
+  bool request_received = false;
+  bool response_received = false;
+  rclcpp::Service<test_msgs::srv::Empty>::SharedPtr service =
+    node->create_service<test_msgs::srv::Empty>(
+    "service",
+    [&request_received](
+      const test_msgs::srv::Empty::Request::SharedPtr,
+      test_msgs::srv::Empty::Response::SharedPtr)
+    {
+      request_received = true;
+    });
+  rclcpp::Client<test_msgs::srv::Empty>::SharedPtr client =
+    node->create_client<test_msgs::srv::Empty>("service");
+
+  EventsExecutor executor;
+  executor.add_node(node);
+
+  bool spin_exited = false;
+  std::thread spinner([&spin_exited, &executor]() {
+      executor.spin();
+      spin_exited = true;
+    });
+
+  ASSERT_TRUE(client->wait_for_service(10s));
+  auto request = std::make_shared<test_msgs::srv::Empty::Request>();
+  client->async_send_request(
+    request,
+    [&response_received](rclcpp::Client<test_msgs::srv::Empty>::SharedFuture)
+    {
+      response_received = true;
+    });
+
+  auto start = std::chrono::steady_clock::now();
+  while (!response_received && (std::chrono::steady_clock::now() - start < 10s)) {
+    std::this_thread::sleep_for(10ms);
+  }
+
+  EXPECT_TRUE(request_received);
+  EXPECT_TRUE(response_received);
+
+  executor.cancel();
+  spinner.join();
+  EXPECT_TRUE(spin_exited);
+}
+
+TEST_F(TestEventsExecutor, spin_once_max_duration_timeout) {
+  auto node = std::make_shared<rclcpp::Node>("node", "ns");
+
+  EventsExecutor executor;
+  executor.add_node(node);
+
+  // Consume previous events so we have a fresh start
+  executor.spin_all(1s);
+
+  size_t t_runs = 0;
+  auto t = node->create_wall_timer(
+    10s,
+    [&]() {
+      t_runs++;
+    });
+
+  // Take care of the events generated by the timer creation
+  executor.spin_all(1s);
+  EXPECT_EQ(0u, t_runs);
+
+  auto start = std::chrono::steady_clock::now();
+  // This second spin_once should take the full 10ms and not execute the timer
+  executor.spin_once(10ms);
+  auto end = std::chrono::steady_clock::now();
+
+  EXPECT_EQ(0u, t_runs);
+  EXPECT_TRUE(std::chrono::duration_cast<std::chrono::milliseconds>(end - start) >= 10ms);
+}
+
+TEST_F(TestEventsExecutor, spin_once_max_duration_timer) {
+  auto node = std::make_shared<rclcpp::Node>("node", "ns");
+
+  EventsExecutor executor;
+  executor.add_node(node);
+
+  size_t t_runs = 0;
+  auto t = node->create_wall_timer(
+    10ms,
+    [&]() {
+      t_runs++;
+    });
+
+  // Consume the event generated by the timer creation
+  executor.spin_all(1s);
+
+  auto start = std::chrono::steady_clock::now();
+  while (t_runs == 0u && (std::chrono::steady_clock::now() - start < 1s)) {
+    executor.spin_once(50ms);
+  }
+
+  EXPECT_EQ(1u, t_runs);
+}
+
+TEST_F(TestEventsExecutor, spin_some_max_duration) {
+  auto node = std::make_shared<rclcpp::Node>("node", "ns");
+
+  size_t t_runs = 0;
+  auto t = node->create_wall_timer(
+    10ms,
+    [&]() {
+      // Block for 200ms
+      std::this_thread::sleep_for(200ms);
+      t_runs++;
+    });
+
+  // Sleep some time for the timer to be ready when spin
+  std::this_thread::sleep_for(10ms);
+
+  EventsExecutor executor;
+  executor.add_node(node);
+
+  auto start = std::chrono::steady_clock::now();
+  executor.spin_some(10ms);
+  auto end = std::chrono::steady_clock::now();
+
+  EXPECT_EQ(1u, t_runs);
+  EXPECT_TRUE(end - start > 200ms);
+}
+
+TEST_F(TestEventsExecutor, entities_created_after_add_node) {
+  auto node = std::make_shared<rclcpp::Node>("node", "ns");
+
+  EventsExecutor executor;
+  executor.add_node(node);
+
+  bool spin_exited = false;
+  std::thread spinner([&spin_exited, &executor]() {
+      executor.spin();
+      spin_exited = true;
+    });
+
+  // Entities created while spinning are picked up when the node notifies the executor.
+  std::atomic<size_t> t_runs {0};
+  auto group = node->create_callback_group(rclcpp::CallbackGroupType::MutuallyExclusive);
+  auto t = node->create_wall_timer(1ms, [&t_runs]() {t_runs++;}, group);
+
+  auto start = std::chrono::steady_clock::now();
+  while (t_runs == 0u && (std::chrono::steady_clock::now() - start < 10s)) {
+    std::this_thread::sleep_for(1ms);
+  }
+  EXPECT_LT(0u, t_runs.load());
+
+  executor.cancel();
+  spinner.join();
+  EXPECT_TRUE(spin_exited);
+
+  // The timer stops running once its callback group is gone.
+  t.reset();
+  group.reset();
+  executor.spin_some();
+}
+
+TEST_F(TestEventsExecutor, cancel_while_timers_running) {
+  auto node = std::make_shared<rclcpp::Node>("node", "ns");
+
+  EventsExecutor executor;
+  executor.add_node(node);
+
+  size_t t1_runs = 0;
+  auto t1 = node->create_wall_timer(
+    1ms,
+    [&]() {
+      t1_runs++;
+      std::this_thread::sleep_for(50ms);
+    });
+
+  size_t t2_runs = 0;
+  auto t2 = node->create_wall_timer(
+    1ms,
+    [&]() {
+      t2_runs++;
+      std::this_thread::sleep_for(50ms);
+    });
+
+  std::thread spinner([&executor]() {executor.spin();});
+
+  std::this_thread::sleep_for(10ms);
+  // Call cancel while t1 callback is still being executed
+  executor.cancel();
+  spinner.join();
+
+  // Depending on the latency on the system, t2 may start to execute before cancel is signaled
+  EXPECT_GE(1u, t1_runs);
+  EXPECT_GE(1u, t2_runs);
+}
+
+TEST_F(TestEventsExecutor, destroy_entities) {
+  auto node_pub = std::make_shared<rclcpp::Node>("node_pub");
+  auto publisher = node_pub->create_publisher<test_msgs::msg::Empty>("topic", rclcpp::QoS(10));
+  auto timer = node_pub->create_wall_timer(
+    2ms, [&]() {publisher->publish(std::make_unique<test_msgs::msg::Empty>());});
+  EventsExecutor executor_pub;
+  executor_pub.add_node(node_pub);
+  std::thread spinner([&executor_pub]() {executor_pub.spin();});
+
+  // Create a node and destroy its subscriptions while the executor is spinning
+  const int num_iterations = 100;
+  for (int i = 0; i < num_iterations; i++) {
+    auto node_sub = std::make_shared<rclcpp::Node>("node_sub");
+    auto subscription = node_sub->create_subscription<test_msgs::msg::Empty>(
+      "topic", rclcpp::QoS(10), [](test_msgs::msg::Empty::ConstSharedPtr) {});
+    EventsExecutor executor_sub;
+    executor_sub.add_node(node_sub);
+    executor_sub.spin_some(1ms);
+    subscription.reset();
+    executor_sub.spin_some(1ms);
+  }
+
+  executor_pub.cancel();
+  spinner.join();
+}
@@ -0,0 +1,108 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include "rclcpp/experimental/executors/events_executor/simple_events_queue.hpp"
+
+using namespace std::chrono_literals;
+
+using rclcpp::experimental::executors::ExecutorEvent;
+using rclcpp::experimental::executors::ExecutorEventType;
+using rclcpp::experimental::executors::SimpleEventsQueue;
+
+TEST(TestEventsQueue, SimpleQueueTest)
+{
+  // Create a SimpleEventsQueue and a local queue
+  auto simple_queue = std::make_unique<SimpleEventsQueue>();
+  ExecutorEvent event {};
+  bool ret = false;
+
+  // Make sure the queue is empty at startup
+  EXPECT_TRUE(simple_queue->empty());
+  EXPECT_EQ(simple_queue->size(), 0u);
+
+  // Push 11 messages
+  for (uint32_t i = 1; i < 11; i++) {
+    ExecutorEvent stub_event {};
+    stub_event.num_events = i;
+    simple_queue->enqueue(stub_event);
+
+    EXPECT_FALSE(simple_queue->empty());
+    EXPECT_EQ(simple_queue->size(), i);
+  }
+
+  // Pop one message
+  ret = simple_queue->dequeue(event);
+  EXPECT_TRUE(ret);
+  EXPECT_FALSE(simple_queue->empty());
+  EXPECT_EQ(simple_queue->size(), 9u);
+  EXPECT_EQ(event.num_events, 1u);
+
+  // Pop remaining messages in order
+  for (uint32_t i = 2; i < 11; i++) {
+    ret = simple_queue->dequeue(event, std::chrono::nanoseconds(0));
+    EXPECT_TRUE(ret);
+    EXPECT_EQ(event.num_events, i);
+  }
+  EXPECT_TRUE(simple_queue->empty());
+  EXPECT_EQ(simple_queue->size(), 0u);
+
+  // Lets push an event into the queue and get it back
+  ExecutorEvent push_event = {
+    simple_queue.get(),
+    99,
+    ExecutorEventType::SUBSCRIPTION_EVENT,
+    1};
+
+  simple_queue->enqueue(push_event);
+  ret = simple_queue->dequeue(event);
+  EXPECT_TRUE(ret);
+  EXPECT_EQ(push_event.entity_key, event.entity_key);
+  EXPECT_EQ(push_event.waitable_data, event.waitable_data);
+  EXPECT_EQ(push_event.type, event.type);
+  EXPECT_EQ(push_event.num_events, event.num_events);
+}
+
+TEST(TestEventsQueue, DequeueTimeout)
+{
+  SimpleEventsQueue simple_queue;
+  ExecutorEvent event {};
+
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_FALSE(simple_queue.dequeue(event, 10ms));
+  EXPECT_GE(std::chrono::steady_clock::now() - start, 10ms);
+}
+
+TEST(TestEventsQueue, DequeueWakesUpOnEnqueue)
+{
+  SimpleEventsQueue simple_queue;
+  ExecutorEvent event {};
+
+  std::thread producer([&simple_queue]() {
+      std::this_thread::sleep_for(10ms);
+      ExecutorEvent stub_event {};
+      stub_event.num_events = 3;
+      simple_queue.enqueue(stub_event);
+    });
+
+  // Blocks without a timeout until the producer enqueues the event.
+  EXPECT_TRUE(simple_queue.dequeue(event));
+  EXPECT_EQ(event.num_events, 3u);
+  producer.join();
+}
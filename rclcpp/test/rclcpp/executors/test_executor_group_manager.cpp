@@ -0,0 +1,150 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/executors/executor_group_manager.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+using namespace std::chrono_literals;
+using rclcpp::executors::ExecutorGroupManager;
+
+class TestExecutorGroupManager : public ::testing::Test
+{
+public:
+  void SetUp()
+  {
+    rclcpp::init(0, nullptr);
+    node = std::make_shared<rclcpp::Node>("test_executor_group_manager_node");
+    executor0 = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+    executor1 = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+  }
+
+  void TearDown()
+  {
+    executor0.reset();
+    executor1.reset();
+    node.reset();
+    rclcpp::shutdown();
+  }
+
+  rclcpp::CallbackGroup::SharedPtr
+  create_busy_group(std::atomic<size_t> & count)
+  {
+    auto group = node->create_callback_group(
+      rclcpp::CallbackGroupType::MutuallyExclusive, false);
+    timers.push_back(
+      node->create_wall_timer(
+        1ms, [&count]() {
+          // Keep the executor busy, so that the group has a measurable load
+          std::this_thread::sleep_for(1ms);
+          ++count;
+        }, group));
+    return group;
+  }
+
+  rclcpp::Node::SharedPtr node;
+  rclcpp::Executor::SharedPtr executor0;
+  rclcpp::Executor::SharedPtr executor1;
+  std::vector<rclcpp::TimerBase::SharedPtr> timers;
+};
+
+TEST_F(TestExecutorGroupManager, invalid_arguments) {
+  ExecutorGroupManager manager;
+  std::atomic<size_t> count{0};
+  auto group = create_busy_group(count);
+  EXPECT_THROW(
+    manager.add_callback_group(group, node->get_node_base_interface()), std::runtime_error);
+  EXPECT_THROW(manager.add_executor(nullptr), std::invalid_argument);
+  EXPECT_THROW(manager.add_executor(executor0, 0.0), std::invalid_argument);
+  EXPECT_EQ(0u, manager.add_executor(executor0));
+  EXPECT_EQ(1u, manager.get_number_of_executors());
+  EXPECT_THROW(
+    manager.add_callback_group(nullptr, node->get_node_base_interface()),
+    std::invalid_argument);
+  EXPECT_THROW(manager.add_callback_group(group, nullptr), std::invalid_argument);
+  EXPECT_THROW(
+    manager.add_callback_group(group, node->get_node_base_interface(), {1}),
+    std::invalid_argument);
+  EXPECT_THROW(manager.get_executor_index(group), std::runtime_error);
+  EXPECT_THROW(manager.remove_callback_group(group), std::runtime_error);
+
+  EXPECT_EQ(0u, manager.add_callback_group(group, node->get_node_base_interface()));
+  EXPECT_THROW(
+    manager.add_callback_group(group, node->get_node_base_interface()), std::runtime_error);
+  manager.remove_callback_group(group);
+  EXPECT_THROW(manager.get_executor_index(group), std::runtime_error);
+}
+
+TEST_F(TestExecutorGroupManager, add_to_least_loaded) {
+  ExecutorGroupManager manager;
+  manager.add_executor(executor0);
+  manager.add_executor(executor1);
+  std::atomic<size_t> count0{0};
+  std::atomic<size_t> count1{0};
+  auto group0 = create_busy_group(count0);
+  auto group1 = create_busy_group(count1);
+  // Without any load, the executor with the fewest groups is chosen
+  EXPECT_EQ(0u, manager.add_callback_group(group0, node->get_node_base_interface()));
+  EXPECT_EQ(1u, manager.add_callback_group(group1, node->get_node_base_interface()));
+  EXPECT_EQ(0u, manager.get_executor_index(group0));
+  EXPECT_EQ(1u, manager.get_executor_index(group1));
+  EXPECT_EQ(0u, manager.rebalance());
+}
+
+TEST_F(TestExecutorGroupManager, rebalance) {
+  ExecutorGroupManager manager;
+  manager.add_executor(executor0);
+  manager.add_executor(executor1);
+  std::atomic<size_t> pinned_count{0};
+  std::atomic<size_t> movable_count{0};
+  auto pinned = create_busy_group(pinned_count);
+  auto movable = create_busy_group(movable_count);
+  EXPECT_EQ(
+    0u, manager.add_callback_group(movable, node->get_node_base_interface(), {0, 1}));
+  EXPECT_EQ(0u, manager.add_callback_group(pinned, node->get_node_base_interface(), {0}));
+
+  // Both groups load the first executor
+  const auto end = std::chrono::steady_clock::now() + 10s;
+  while ((pinned_count < 5 || movable_count < 5) && std::chrono::steady_clock::now() < end) {
+    executor0->spin_some(10ms);
+  }
+  ASSERT_GE(pinned_count, 5u);
+  ASSERT_GE(movable_count, 5u);
+
+  // Only the group allowed on the second executor can move to it
+  EXPECT_EQ(1u, manager.rebalance());
+  EXPECT_EQ(0u, manager.get_executor_index(pinned));
+  EXPECT_EQ(1u, manager.get_executor_index(movable));
+  auto loads = manager.get_callback_group_loads();
+  ASSERT_EQ(2u, loads.size());
+  for (const auto & load : loads) {
+    EXPECT_GT(load.execution_time, 0ns);
+  }
+
+  // The moved group now runs on the second executor
+  const size_t moved_count = movable_count;
+  while (movable_count == moved_count && std::chrono::steady_clock::now() < end) {
+    executor1->spin_some(10ms);
+  }
+  EXPECT_GT(movable_count, moved_count);
+}
@@ -14,14 +14,18 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
 #include <chrono>
 #include <string>
 #include <memory>
+#include <thread>
+#include <vector>
 
 #include "rclcpp/exceptions.hpp"
 #include "rclcpp/node.hpp"
 #include "rclcpp/rclcpp.hpp"
 #include "rclcpp/executors.hpp"
+#include "rclcpp/numa_topology.hpp"
 
 using namespace std::chrono_literals;
 
@@ -97,3 +101,288 @@ TEST_F(TestMultiThreadedExecutor, timer_over_take) {
   executor.add_node(node);
   executor.spin();
 }
+
+/*
+   Test that the work stealing mode never runs callbacks of a mutually exclusive group in parallel.
+ */
+TEST_F(TestMultiThreadedExecutor, work_stealing_mutually_exclusive) {
+  rclcpp::executors::MultiThreadedExecutor executor(
+    rclcpp::ExecutorOptions(), 4u, false, std::chrono::nanoseconds(-1),
+    rclcpp::executors::MultiThreadedExecutor::SchedulingMode::WorkStealing);
+  EXPECT_EQ(
+    rclcpp::executors::MultiThreadedExecutor::SchedulingMode::WorkStealing,
+    executor.get_scheduling_mode());
+
+  std::shared_ptr<rclcpp::Node> node =
+    std::make_shared<rclcpp::Node>("test_multi_threaded_executor_work_stealing_exclusive");
+  auto cbg = node->create_callback_group(rclcpp::CallbackGroupType::MutuallyExclusive);
+
+  std::atomic_int running {0};
+  std::atomic_int max_running {0};
+  std::atomic_int count {0};
+  auto timer_callback = [&]() {
+      int now_running = ++running;
+      int expected = max_running.load();
+      while (now_running > expected && !max_running.compare_exchange_weak(expected, now_running)) {
+      }
+      std::this_thread::sleep_for(1ms);
+      --running;
+      if (++count >= 40) {
+        executor.cancel();
+      }
+    };
+
+  std::vector<rclcpp::TimerBase::SharedPtr> timers;
+  for (size_t i = 0; i < 4u; ++i) {
+    timers.push_back(node->create_wall_timer(1ms, timer_callback, cbg));
+  }
+  executor.add_node(node);
+  executor.spin();
+
+  EXPECT_GE(count.load(), 40);
+  EXPECT_EQ(1, max_running.load());
+}
+
+/*
+   Test that the work stealing mode runs callbacks of a reentrant group in parallel.
+ */
+TEST_F(TestMultiThreadedExecutor, work_stealing_reentrant) {
+  rclcpp::executors::MultiThreadedExecutor executor(
+    rclcpp::ExecutorOptions(), 4u, false, std::chrono::nanoseconds(-1),
+    rclcpp::executors::MultiThreadedExecutor::SchedulingMode::WorkStealing);
+
+  std::shared_ptr<rclcpp::Node> node =
+    std::make_shared<rclcpp::Node>("test_multi_threaded_executor_work_stealing_reentrant");
+  auto cbg = node->create_callback_group(rclcpp::CallbackGroupType::Reentrant);
+
+  // Each callback only returns once both of them are running at the same time
+  std::atomic_int arrived {0};
+  std::atomic_bool both_running {false};
+  auto timer_callback = [&]() {
+      if (both_running) {
+        return;
+      }
+      ++arrived;
+      auto start = std::chrono::steady_clock::now();
+      while (arrived.load() < 2 && std::chrono::steady_clock::now() - start < 5s) {
+        std::this_thread::yield();
+      }
+      if (arrived.load() >= 2) {
+        both_running = true;
+      }
+      executor.cancel();
+    };
+
+  auto timer1 = node->create_wall_timer(10ms, timer_callback, cbg);
+  auto timer2 = node->create_wall_timer(10ms, timer_callback, cbg);
+  executor.add_node(node);
+  executor.spin();
+
+  EXPECT_TRUE(both_running.load());
+}
+
+/*
+   Test that the worker threads are created with the attributes given in the executor options.
+ */
+TEST_F(TestMultiThreadedExecutor, thread_attributes) {
+  rclcpp::ExecutorOptions options;
+  options.thread_attributes.resize(2);
+  options.thread_attributes[0].name = "worker_0";
+  options.thread_attributes[1].name = "worker_1";
+  rclcpp::executors::MultiThreadedExecutor executor(options, 2u);
+
+  std::shared_ptr<rclcpp::Node> node =
+    std::make_shared<rclcpp::Node>("test_multi_threaded_executor_thread_attributes");
+
+  std::atomic_bool caller_thread_used {false};
+  const auto caller_thread_id = std::this_thread::get_id();
+  std::atomic_int count {0};
+  auto timer = node->create_wall_timer(
+    1ms, [&]() {
+      if (std::this_thread::get_id() == caller_thread_id) {
+        caller_thread_used = true;
+      }
+      if (++count >= 10) {
+        executor.cancel();
+      }
+    });
+  executor.add_node(node);
+  executor.spin();
+
+  EXPECT_GE(count.load(), 10);
+  EXPECT_FALSE(caller_thread_used.load());
+}
+
+/*
+   Test that the NUMA aware mode binds the workers and counts the executions.
+ */
+TEST_F(TestMultiThreadedExecutor, numa_aware) {
+  rclcpp::ExecutorOptions options;
+  options.numa_aware = true;
+  rclcpp::executors::MultiThreadedExecutor executor(
+    options, 2u, false, std::chrono::nanoseconds(-1),
+    rclcpp::executors::MultiThreadedExecutor::SchedulingMode::WorkStealing);
+
+  std::shared_ptr<rclcpp::Node> node =
+    std::make_shared<rclcpp::Node>("test_multi_threaded_executor_numa_aware");
+
+  const rclcpp::NumaTopology & topology = rclcpp::NumaTopology::get_host_topology();
+  const std::vector<size_t> worker_nodes = topology.get_worker_nodes(2u);
+  std::atomic_bool wrong_node {false};
+  std::atomic_int count {0};
+  auto timer = node->create_wall_timer(
+    1ms, [&]() {
+      const size_t current_node = topology.get_current_node();
+      if (
+        current_node != rclcpp::NumaTopology::unknown &&
+        current_node != worker_nodes[0] && current_node != worker_nodes[1])
+      {
+        wrong_node = true;
+      }
+      if (++count >= 10) {
+        executor.cancel();
+      }
+    });
+  executor.add_node(node);
+  executor.spin();
+
+  EXPECT_GE(count.load(), 10);
+  EXPECT_FALSE(wrong_node.load());
+  auto statistics = executor.get_numa_statistics();
+  EXPECT_LE(
+    statistics.local_executions + statistics.remote_executions, static_cast<uint64_t>(count));
+  if (rclcpp::NumaTopology::get_node_of_address(timer.get()) != rclcpp::NumaTopology::unknown) {
+    EXPECT_EQ(
+      statistics.local_executions + statistics.remote_executions, static_cast<uint64_t>(count));
+  }
+  if (topology.get_number_of_nodes() == 1u) {
+    EXPECT_EQ(0u, statistics.remote_executions);
+  }
+}
+
+/*
+   Test that a dynamic thread pool grows under load and shrinks back once idle.
+ */
+TEST_F(TestMultiThreadedExecutor, dynamic_thread_pool) {
+  rclcpp::executors::MultiThreadedExecutor shared_wait_executor;
+  EXPECT_THROW(shared_wait_executor.set_dynamic_thread_pool(1u, 4u), std::invalid_argument);
+
+  rclcpp::executors::MultiThreadedExecutor executor(
+    rclcpp::ExecutorOptions(), 2u, false, std::chrono::nanoseconds(-1),
+    rclcpp::executors::MultiThreadedExecutor::SchedulingMode::WorkStealing);
+  EXPECT_THROW(executor.set_dynamic_thread_pool(0u, 4u), std::invalid_argument);
+  EXPECT_THROW(executor.set_dynamic_thread_pool(2u, 1u), std::invalid_argument);
+  executor.set_dynamic_thread_pool(1u, 4u, 1ms, 100ms);
+  EXPECT_EQ(4u, executor.get_number_of_threads());
+
+  std::shared_ptr<rclcpp::Node> node =
+    std::make_shared<rclcpp::Node>("test_multi_threaded_executor_dynamic_thread_pool");
+  auto cbg = node->create_callback_group(rclcpp::CallbackGroupType::Reentrant);
+  // Callbacks longer than the period of the timers back up the queues
+  std::vector<rclcpp::TimerBase::SharedPtr> timers;
+  for (size_t i = 0; i < 4; ++i) {
+    timers.push_back(
+      node->create_wall_timer(
+        5ms, []() {std::this_thread::sleep_for(20ms);}, cbg));
+  }
+  executor.add_node(node);
+  std::thread spinner([&executor]() {executor.spin();});
+
+  auto wait_for_active_threads = [&executor](auto predicate) {
+      const auto end = std::chrono::steady_clock::now() + 10s;
+      while (
+        !predicate(executor.get_number_of_active_threads()) &&
+        std::chrono::steady_clock::now() < end)
+      {
+        std::this_thread::sleep_for(1ms);
+      }
+      return executor.get_number_of_active_threads();
+    };
+  EXPECT_GT(wait_for_active_threads([](size_t active) {return active > 1u;}), 1u);
+  EXPECT_LE(executor.get_number_of_active_threads(), 4u);
+
+  for (auto & timer : timers) {
+    timer->cancel();
+  }
+  EXPECT_EQ(1u, wait_for_active_threads([](size_t active) {return active == 1u;}));
+
+  executor.cancel();
+  spinner.join();
+}
+
+/*
+   Test that a mutually exclusive group keeps running on the same thread with the affinity.
+ */
+TEST_F(TestMultiThreadedExecutor, callback_group_affinity) {
+  rclcpp::executors::MultiThreadedExecutor shared_wait_executor;
+  EXPECT_THROW(shared_wait_executor.set_callback_group_affinity(), std::invalid_argument);
+
+  rclcpp::executors::MultiThreadedExecutor executor(
+    rclcpp::ExecutorOptions(), 4u, false, std::chrono::nanoseconds(-1),
+    rclcpp::executors::MultiThreadedExecutor::SchedulingMode::WorkStealing);
+  EXPECT_THROW(executor.set_callback_group_affinity(-1ms), std::invalid_argument);
+  executor.set_callback_group_affinity(10ms);
+
+  std::shared_ptr<rclcpp::Node> node =
+    std::make_shared<rclcpp::Node>("test_multi_threaded_executor_callback_group_affinity");
+  auto cbg = node->create_callback_group(rclcpp::CallbackGroupType::MutuallyExclusive);
+  std::atomic_int running {0};
+  std::atomic_int max_running {0};
+  std::atomic_int count {0};
+  auto timer_callback = [&]() {
+      int now_running = ++running;
+      int expected = max_running.load();
+      while (now_running > expected && !max_running.compare_exchange_weak(expected, now_running)) {
+      }
+      --running;
+      if (++count >= 40) {
+        executor.cancel();
+      }
+    };
+  std::vector<rclcpp::TimerBase::SharedPtr> timers;
+  for (size_t i = 0; i < 2u; ++i) {
+    timers.push_back(node->create_wall_timer(1ms, timer_callback, cbg));
+  }
+  executor.add_node(node);
+  executor.spin();
+
+  EXPECT_GE(count.load(), 40);
+  EXPECT_EQ(1, max_running.load());
+  auto statistics = executor.get_affinity_statistics();
+  EXPECT_GT(statistics.affine_executions, 0u);
+  EXPECT_GE(statistics.affine_executions + statistics.migrated_executions, 39u);
+}
+
+/*
+   Test that each thread accounts its time, the waiting threads being idle meanwhile.
+ */
+TEST_F(TestMultiThreadedExecutor, time_accounting) {
+  rclcpp::executors::MultiThreadedExecutor executor(rclcpp::ExecutorOptions(), 2u);
+  executor.set_time_accounting_enabled(true);
+
+  std::shared_ptr<rclcpp::Node> node =
+    std::make_shared<rclcpp::Node>("test_multi_threaded_executor_time_accounting");
+  std::atomic_int count {0};
+  auto timer = node->create_wall_timer(
+    1ms, [&]() {
+      if (++count >= 10) {
+        executor.cancel();
+      }
+    });
+  executor.add_node(node);
+  executor.spin();
+  EXPECT_GE(count.load(), 10);
+
+  auto thread_times = executor.get_thread_times();
+  ASSERT_GE(thread_times.size(), 1u);
+  EXPECT_LE(thread_times.size(), 2u);
+  uint64_t executions = 0;
+  uint64_t waits = 0;
+  for (const auto & times : thread_times) {
+    executions += times.execute.count;
+    waits += times.wait.count;
+    EXPECT_LE(times.utilization(), 1.0);
+  }
+  EXPECT_GE(executions, static_cast<uint64_t>(count.load()));
+  EXPECT_GE(waits, 1u);
+}
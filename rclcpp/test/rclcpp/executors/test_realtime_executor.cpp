@@ -0,0 +1,145 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "rclcpp/allocation_guard.hpp"
+#include "rclcpp/executors/realtime_executor.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+#include "test_msgs/msg/basic_types.hpp"
+
+// Count the allocations of this test
+#include "rclcpp/allocation_guard_operators.hpp"
+
+using namespace std::chrono_literals;
+using rclcpp::AllocationCheck;
+using rclcpp::AllocationGuard;
+
+namespace
+{
+
+// Escapes, so that the allocations can't be elided
+std::unique_ptr<int> sink;
+
+}  // namespace
+
+class TestRealtimeExecutor : public ::testing::Test
+{
+public:
+  void SetUp()
+  {
+    rclcpp::init(0, nullptr);
+    node = std::make_shared<rclcpp::Node>("test_realtime_executor_node");
+  }
+
+  void TearDown()
+  {
+    node.reset();
+    rclcpp::shutdown();
+  }
+
+  /// Publish messages until the given number of them was received.
+  void publish_and_spin(
+    rclcpp::executors::RealtimeExecutor & executor, std::function<size_t()> get_received,
+    size_t count)
+  {
+    auto publisher = node->create_publisher<test_msgs::msg::BasicTypes>("topic", 10);
+    const auto end = std::chrono::steady_clock::now() + 10s;
+    while (get_received() < count && std::chrono::steady_clock::now() < end) {
+      publisher->publish(test_msgs::msg::BasicTypes());
+      executor.spin_some(10ms);
+    }
+    ASSERT_GE(get_received(), count);
+  }
+
+  rclcpp::Node::SharedPtr node;
+};
+
+TEST_F(TestRealtimeExecutor, allocation_guard) {
+  {
+    AllocationGuard guard(AllocationCheck::Count);
+    EXPECT_EQ(AllocationCheck::Count, AllocationGuard::get_current_check());
+    sink.reset(new int(1));
+    EXPECT_EQ(1u, guard.get_allocation_count());
+    {
+      // Allowed by a nested guard
+      AllocationGuard allow(AllocationCheck::None);
+      sink.reset(new int(2));
+    }
+    EXPECT_EQ(1u, guard.get_allocation_count());
+    EXPECT_EQ(AllocationCheck::Count, AllocationGuard::get_current_check());
+  }
+  EXPECT_EQ(AllocationCheck::None, AllocationGuard::get_current_check());
+
+  EXPECT_DEATH(
+    {
+      AllocationGuard guard(AllocationCheck::Abort);
+      sink.reset(new int(3));
+    }, "forbidding allocations");
+}
+
+TEST_F(TestRealtimeExecutor, reuse_messages) {
+  std::vector<const test_msgs::msg::BasicTypes *> messages;
+  auto subscription = node->create_subscription<test_msgs::msg::BasicTypes>(
+    "topic", 10, [&messages](const test_msgs::msg::BasicTypes & msg) {
+      messages.push_back(&msg);
+    });
+  messages.reserve(10);
+  rclcpp::executors::RealtimeExecutor executor;
+  executor.add_node(node);
+
+  publish_and_spin(executor, [&messages]() {return messages.size();}, 3);
+  // Always taken into the same message
+  EXPECT_EQ(messages[0], messages[1]);
+  EXPECT_EQ(messages[0], messages[2]);
+}
+
+TEST_F(TestRealtimeExecutor, kept_messages) {
+  std::vector<std::shared_ptr<const test_msgs::msg::BasicTypes>> messages;
+  auto subscription = node->create_subscription<test_msgs::msg::BasicTypes>(
+    "topic", 10, [&messages](std::shared_ptr<const test_msgs::msg::BasicTypes> msg) {
+      messages.push_back(msg);
+    });
+  rclcpp::executors::RealtimeExecutor executor;
+  executor.add_node(node);
+
+  publish_and_spin(executor, [&messages]() {return messages.size();}, 2);
+  // The message kept by the callback isn't taken into again
+  EXPECT_NE(messages[0], messages[1]);
+}
+
+TEST_F(TestRealtimeExecutor, count_allocations) {
+  bool called = false;
+  auto timer = node->create_wall_timer(
+    1ms, [&called]() {
+      sink.reset(new int(4));
+      called = true;
+    });
+  rclcpp::executors::RealtimeExecutor executor;
+  executor.add_node(node);
+  EXPECT_EQ(0u, executor.get_allocation_count());
+
+  const auto end = std::chrono::steady_clock::now() + 10s;
+  while (!called && std::chrono::steady_clock::now() < end) {
+    executor.spin_once(10ms);
+  }
+  ASSERT_TRUE(called);
+  EXPECT_GE(executor.get_allocation_count(), 1u);
+}
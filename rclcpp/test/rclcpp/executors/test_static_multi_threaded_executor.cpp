@@ -0,0 +1,142 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/executors/static_multi_threaded_executor.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+using namespace std::chrono_literals;
+
+class TestStaticMultiThreadedExecutor : public ::testing::Test
+{
+protected:
+  static void SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  static void TearDownTestCase()
+  {
+    rclcpp::shutdown();
+  }
+};
+
+TEST_F(TestStaticMultiThreadedExecutor, number_of_threads) {
+  rclcpp::executors::StaticMultiThreadedExecutor executor(rclcpp::ExecutorOptions(), 3u);
+  EXPECT_EQ(3u, executor.get_number_of_threads());
+  rclcpp::executors::StaticMultiThreadedExecutor default_executor;
+  EXPECT_GE(default_executor.get_number_of_threads(), 2u);
+}
+
+/*
+   Test that the entities of a mutually exclusive callback group never run at the same time.
+ */
+TEST_F(TestStaticMultiThreadedExecutor, mutually_exclusive) {
+  rclcpp::executors::StaticMultiThreadedExecutor executor(rclcpp::ExecutorOptions(), 4u);
+  auto node = std::make_shared<rclcpp::Node>("test_static_multi_threaded_executor_me");
+  auto group = node->create_callback_group(rclcpp::CallbackGroupType::MutuallyExclusive);
+
+  std::atomic_int running{0};
+  std::atomic_bool overlapped{false};
+  std::atomic_int count{0};
+  auto callback = [&]() {
+      if (running.fetch_add(1) != 0) {
+        overlapped = true;
+      }
+      std::this_thread::sleep_for(2ms);
+      running.fetch_sub(1);
+      if (++count >= 20) {
+        executor.cancel();
+      }
+    };
+  auto timer1 = node->create_wall_timer(1ms, callback, group);
+  auto timer2 = node->create_wall_timer(1ms, callback, group);
+  auto timer3 = node->create_wall_timer(1ms, callback, group);
+
+  executor.add_node(node);
+  std::thread spinner([&executor]() {executor.spin();});
+  auto start = std::chrono::steady_clock::now();
+  while (count < 20 && std::chrono::steady_clock::now() - start < 10s) {
+    std::this_thread::sleep_for(10ms);
+  }
+  executor.cancel();
+  spinner.join();
+  EXPECT_GE(count.load(), 20);
+  EXPECT_FALSE(overlapped.load());
+}
+
+/*
+   Test that the entities of a reentrant callback group are executed in parallel.
+ */
+TEST_F(TestStaticMultiThreadedExecutor, reentrant_in_parallel) {
+  rclcpp::executors::StaticMultiThreadedExecutor executor(rclcpp::ExecutorOptions(), 2u);
+  auto node = std::make_shared<rclcpp::Node>("test_static_multi_threaded_executor_reentrant");
+  auto group = node->create_callback_group(rclcpp::CallbackGroupType::Reentrant);
+
+  // Each callback waits for the other one to start, which only works if they run in parallel
+  std::atomic_int started{0};
+  std::atomic_bool met{false};
+  auto callback = [&]() {
+      started++;
+      auto start = std::chrono::steady_clock::now();
+      while (started.load() < 2 && std::chrono::steady_clock::now() - start < 1s) {
+        std::this_thread::yield();
+      }
+      if (started.load() >= 2) {
+        met = true;
+      }
+    };
+  rclcpp::TimerBase::SharedPtr timer1;
+  rclcpp::TimerBase::SharedPtr timer2;
+  timer1 = node->create_wall_timer(10ms, [&]() {callback(); timer1->cancel();}, group);
+  timer2 = node->create_wall_timer(10ms, [&]() {callback(); timer2->cancel();}, group);
+
+  executor.add_node(node);
+  std::thread spinner([&executor]() {executor.spin();});
+  auto start = std::chrono::steady_clock::now();
+  while (!met && std::chrono::steady_clock::now() - start < 10s) {
+    std::this_thread::sleep_for(10ms);
+  }
+  executor.cancel();
+  spinner.join();
+  EXPECT_TRUE(met.load());
+}
+
+/*
+   Test that the layout is rebuilt when an entity is added while spinning.
+ */
+TEST_F(TestStaticMultiThreadedExecutor, entity_added_while_spinning) {
+  rclcpp::executors::StaticMultiThreadedExecutor executor(rclcpp::ExecutorOptions(), 2u);
+  auto node = std::make_shared<rclcpp::Node>("test_static_multi_threaded_executor_added");
+  executor.add_node(node);
+  std::thread spinner([&executor]() {executor.spin();});
+  std::this_thread::sleep_for(50ms);
+
+  std::atomic_bool called{false};
+  auto timer = node->create_wall_timer(1ms, [&called]() {called = true;});
+  auto start = std::chrono::steady_clock::now();
+  while (!called && std::chrono::steady_clock::now() - start < 10s) {
+    std::this_thread::sleep_for(10ms);
+  }
+  executor.cancel();
+  spinner.join();
+  EXPECT_TRUE(called.load());
+}
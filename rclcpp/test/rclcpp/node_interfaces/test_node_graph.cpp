@@ -14,9 +14,12 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -533,6 +536,28 @@ TEST_F(TestNodeGraph, count_subscribers_rcl_error)
     std::runtime_error("could not count subscribers: error not set"));
 }
 
+TEST_F(TestNodeGraph, expanded_names_cached)
+{
+  const rclcpp::QoS publisher_qos(1);
+  auto publisher = node()->create_publisher<test_msgs::msg::Empty>("topic", publisher_qos);
+  EXPECT_EQ(0u, node_graph()->count_subscribers("~/topic"));
+  EXPECT_EQ(0u, node_graph()->count_subscribers("~/topic"));
+
+  // The remapped name is cached, the remapping isn't run again
+  EXPECT_NO_THROW(node_graph()->get_publishers_info_by_topic("topic", false));
+  {
+    auto mock = mocking_utils::patch_and_return(
+      "lib:rclcpp", rcl_remap_topic_name, RCL_RET_ERROR);
+    EXPECT_NO_THROW(node_graph()->get_publishers_info_by_topic("topic", false));
+  }
+
+  // Invalid names aren't cached and throw on each call
+  EXPECT_THROW(
+    node_graph()->count_publishers("invalid topic"), rclcpp::exceptions::InvalidTopicNameError);
+  EXPECT_THROW(
+    node_graph()->count_publishers("invalid topic"), rclcpp::exceptions::InvalidTopicNameError);
+}
+
 TEST_F(TestNodeGraph, notify_shutdown)
 {
   EXPECT_NO_THROW(node()->get_node_graph_interface()->notify_shutdown());
@@ -695,3 +720,59 @@ TEST_F(TestNodeGraph, get_info_by_topic_endpoint_info_array_fini_error)
     node_graph()->get_publishers_info_by_topic("topic", false),
     rclcpp::exceptions::RCLError);
 }
+
+TEST_F(TestNodeGraph, use_graph_cache)
+{
+  auto options = rclcpp::NodeOptions().use_graph_cache(true);
+  auto cached_node = std::make_shared<rclcpp::Node>("cached_node", node_namespace, options);
+  auto other_node = std::make_shared<rclcpp::Node>("other_cached_node", node_namespace, options);
+  auto node_graph = cached_node->get_node_graph_interface();
+
+  EXPECT_EQ(0u, node_graph->count_publishers("cached_topic"));
+  // The graph listener watches the graph changes for the graph cache
+  EXPECT_LE(1u, node_graph->count_graph_users());
+
+  // The results cached before a graph change aren't returned after it
+  const rclcpp::QoS publisher_qos(1);
+  auto publisher =
+    other_node->create_publisher<test_msgs::msg::Empty>("cached_topic", publisher_qos);
+  size_t count = 0;
+  for (size_t tries = 0; tries < 100; ++tries) {
+    count = node_graph->count_publishers("cached_topic");
+    if (count > 0u) {
+      break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(1u, count);
+  EXPECT_EQ(1u, other_node->count_publishers("cached_topic"));
+  EXPECT_EQ(1u, node_graph->get_publishers_info_by_topic("cached_topic").size());
+
+  auto names = node_graph->get_node_names();
+  EXPECT_NE(
+    names.end(), std::find(names.begin(), names.end(), "/ns/other_cached_node"));
+}
+
+TEST_F(TestNodeGraph, get_filtered_graph_event)
+{
+  auto node_graph = node()->get_node_graph_interface();
+  rclcpp::GraphEventFilter filter;
+  filter.topic_names.push_back("filtered_topic");
+  auto event = node_graph->get_filtered_graph_event(filter);
+  ASSERT_NE(nullptr, event);
+  EXPECT_LE(1u, node_graph->count_graph_users());
+
+  // A change of another topic doesn't set the event
+  const rclcpp::QoS publisher_qos(1);
+  auto other_publisher =
+    node()->create_publisher<test_msgs::msg::Empty>("other_topic", publisher_qos);
+  EXPECT_NO_THROW(node_graph->wait_for_graph_change(event, std::chrono::milliseconds(100)));
+  EXPECT_FALSE(event->check_and_clear());
+
+  auto publisher =
+    node()->create_publisher<test_msgs::msg::Empty>("filtered_topic", publisher_qos);
+  for (size_t tries = 0; tries < 100 && !event->check(); ++tries) {
+    node_graph->wait_for_graph_change(event, std::chrono::milliseconds(10));
+  }
+  EXPECT_TRUE(event->check_and_clear());
+}
@@ -21,8 +21,12 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "rclcpp/node.hpp"
@@ -118,6 +122,66 @@ TEST_F(TestNodeParameters, list_parameters)
     list_result4.names.end());
 }
 
+TEST_F(TestNodeParameters, list_parameters_namespaces)
+{
+  for (const char * name : {"ns.b", "ns.a", "ns.a.x", "ns.a.x.y", "ns_other", "ns.c.z"}) {
+    node_parameters->declare_parameter(name, rclcpp::ParameterValue(1), {}, false);
+  }
+
+  auto list_result = node_parameters->list_parameters({"ns"}, 2u);
+  EXPECT_EQ((std::vector<std::string>{"ns.a", "ns.b"}), list_result.names);
+  EXPECT_EQ((std::vector<std::string>{"ns"}), list_result.prefixes);
+
+  // The names matching several prefixes are listed once, in order
+  list_result = node_parameters->list_parameters({"ns.a", "ns", "ns.c"}, 3u);
+  EXPECT_EQ(
+    (std::vector<std::string>{"ns.a", "ns.a.x", "ns.a.x.y", "ns.b", "ns.c.z"}), list_result.names);
+  EXPECT_EQ((std::vector<std::string>{"ns", "ns.a", "ns.a.x", "ns.c"}), list_result.prefixes);
+
+  list_result = node_parameters->list_parameters({"ns.a"}, 1u);
+  EXPECT_EQ((std::vector<std::string>{"ns.a"}), list_result.names);
+  list_result = node_parameters->list_parameters({"n", "ns.d"}, 0u);
+  EXPECT_TRUE(list_result.names.empty());
+
+  std::map<std::string, rclcpp::Parameter> parameters;
+  EXPECT_TRUE(node_parameters->get_parameters_by_prefix("ns.a", parameters));
+  ASSERT_EQ(2u, parameters.size());
+  EXPECT_EQ("ns.a.x", parameters.at("x").get_name());
+  EXPECT_EQ("ns.a.x.y", parameters.at("x.y").get_name());
+  parameters.clear();
+  EXPECT_FALSE(node_parameters->get_parameters_by_prefix("ns.b", parameters));
+
+  // The parameters are listed from the callbacks called while declaring one
+  size_t listed = 0;
+  auto handle = node_parameters->add_on_set_parameters_callback(
+    [this, &listed](const std::vector<rclcpp::Parameter> &) {
+      listed = node_parameters->list_parameters({"ns.c"}, 0u).names.size();
+      rcl_interfaces::msg::SetParametersResult result;
+      result.successful = true;
+      return result;
+    });
+  rcl_interfaces::msg::ParameterDescriptor descriptor;
+  descriptor.dynamic_typing = true;
+  node_parameters->declare_parameter("ns.c.w", rclcpp::ParameterValue(1), descriptor, false);
+  EXPECT_EQ(1u, listed);
+  EXPECT_EQ(2u, node_parameters->list_parameters({"ns.c"}, 0u).names.size());
+  node_parameters->remove_on_set_parameters_callback(handle.get());
+
+  node_parameters->undeclare_parameter("ns.c.w");
+  list_result = node_parameters->list_parameters({"ns.c"}, 0u);
+  EXPECT_EQ((std::vector<std::string>{"ns.c.z"}), list_result.names);
+
+  // The namespaces are removed with their last parameter
+  node_parameters->declare_parameter("ns.d.e.f", rclcpp::ParameterValue(1), descriptor, false);
+  list_result = node_parameters->list_parameters({"ns.d"}, 0u);
+  EXPECT_EQ((std::vector<std::string>{"ns.d.e.f"}), list_result.names);
+  node_parameters->undeclare_parameter("ns.d.e.f");
+  EXPECT_TRUE(node_parameters->list_parameters({"ns.d"}, 0u).names.empty());
+  list_result = node_parameters->list_parameters({"ns"}, 0u);
+  EXPECT_EQ(
+    (std::vector<std::string>{"ns.a", "ns.a.x", "ns.a.x.y", "ns.b", "ns.c.z"}), list_result.names);
+}
+
 TEST_F(TestNodeParameters, parameter_overrides)
 {
   rclcpp::NodeOptions node_options;
@@ -447,3 +511,292 @@ TEST_F(TestNodeParameters, complicated_wildcards)
     EXPECT_EQ(0u, parameter_overrides.size());
   }
 }
+
+TEST_F(TestNodeParameters, read_parameters_while_set) {
+  node_parameters->declare_parameter("first", rclcpp::ParameterValue(0));
+  node_parameters->declare_parameter("second", rclcpp::ParameterValue(0));
+
+  // The callbacks read the parameters being set, before and after they are stored
+  int64_t value_read_on_set = -1;
+  int64_t value_read_post_set = -1;
+  auto on_set_handle = node_parameters->add_on_set_parameters_callback(
+    [&](const std::vector<rclcpp::Parameter> &) {
+      value_read_on_set = node_parameters->get_parameter("first").as_int();
+      rcl_interfaces::msg::SetParametersResult result;
+      result.successful = true;
+      return result;
+    });
+  auto post_set_handle = node_parameters->add_post_set_parameters_callback(
+    [&](const std::vector<rclcpp::Parameter> &) {
+      value_read_post_set = node_parameters->get_parameter("first").as_int();
+    });
+  ASSERT_TRUE(
+    node_parameters->set_parameters_atomically(
+      {rclcpp::Parameter("first", 1), rclcpp::Parameter("second", 1)}).successful);
+  EXPECT_EQ(0, value_read_on_set);
+  EXPECT_EQ(1, value_read_post_set);
+  node_parameters->remove_on_set_parameters_callback(on_set_handle.get());
+  node_parameters->remove_post_set_parameters_callback(post_set_handle.get());
+
+  // The parameters set atomically are read together by the other threads
+  std::atomic<bool> done{false};
+  std::atomic<size_t> inconsistent_reads{0};
+  std::vector<std::thread> readers;
+  for (size_t i = 0; i < 4; ++i) {
+    readers.emplace_back(
+      [&]() {
+        while (!done) {
+          const auto parameters = node_parameters->get_parameters({"first", "second"});
+          if (parameters[0].as_int() != parameters[1].as_int()) {
+            ++inconsistent_reads;
+          }
+          EXPECT_TRUE(node_parameters->has_parameter("first"));
+        }
+      });
+  }
+  for (int64_t value = 2; value < 500; ++value) {
+    ASSERT_TRUE(
+      node_parameters->set_parameters_atomically(
+        {rclcpp::Parameter("first", value), rclcpp::Parameter("second", value)}).successful);
+  }
+  done = true;
+  for (auto & reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(0u, inconsistent_reads);
+  EXPECT_EQ(499, node_parameters->get_parameter("second").as_int());
+}
+
+TEST_F(TestNodeParameters, set_parameters_snapshot) {
+  const rclcpp::ParameterValue & first =
+    node_parameters->declare_parameter("first", rclcpp::ParameterValue(0));
+  node_parameters->declare_parameter("second", rclcpp::ParameterValue(0));
+
+  // The parameters set separately by set_parameters() are read together by the other threads
+  std::atomic<bool> done{false};
+  std::atomic<size_t> inconsistent_reads{0};
+  std::thread reader(
+    [&]() {
+      while (!done) {
+        const auto parameters = node_parameters->get_parameters({"first", "second"});
+        if (parameters[0].as_int() != parameters[1].as_int()) {
+          ++inconsistent_reads;
+        }
+      }
+    });
+  for (int64_t value = 1; value < 500; ++value) {
+    const auto results = node_parameters->set_parameters(
+      {rclcpp::Parameter("first", value), rclcpp::Parameter("second", value)});
+    ASSERT_TRUE(results[0].successful);
+    ASSERT_TRUE(results[1].successful);
+  }
+  done = true;
+  reader.join();
+  EXPECT_EQ(0u, inconsistent_reads);
+
+  // The returned reference stays valid while the parameter is set, or fails to be set
+  EXPECT_EQ(499, first.get<int64_t>());
+  EXPECT_FALSE(
+    node_parameters->set_parameters_atomically({rclcpp::Parameter("first", "string")}).successful);
+  EXPECT_EQ(499, first.get<int64_t>());
+  EXPECT_EQ(499, node_parameters->get_parameter("first").as_int());
+  EXPECT_TRUE(
+    node_parameters->set_parameters_atomically({rclcpp::Parameter("first", 7)}).successful);
+  EXPECT_EQ(7, first.get<int64_t>());
+  EXPECT_EQ(7, node_parameters->get_parameter("first").as_int());
+
+  // Setting the same value leaves the parameter as is
+  EXPECT_TRUE(
+    node_parameters->set_parameters_atomically({rclcpp::Parameter("first", 7)}).successful);
+  EXPECT_EQ(7, first.get<int64_t>());
+  EXPECT_EQ(7, node_parameters->get_parameter("first").as_int());
+}
+
+TEST_F(TestNodeParameters, batch_parameter_events) {
+  std::vector<rcl_interfaces::msg::ParameterEvent> events;
+  auto subscription = node->create_subscription<rcl_interfaces::msg::ParameterEvent>(
+    "/parameter_events", rclcpp::ParameterEventsQoS(),
+    [&events](const rcl_interfaces::msg::ParameterEvent & event) {
+      if (event.node == "/ns/node") {
+        events.push_back(event);
+      }
+    });
+  auto wait_for_events = [this, &events](size_t count) {
+      const auto start = std::chrono::steady_clock::now();
+      while (
+        events.size() < count &&
+        std::chrono::steady_clock::now() - start < std::chrono::seconds(10))
+      {
+        rclcpp::spin_some(node);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+      return events.size();
+    };
+
+  {
+    rclcpp::node_interfaces::ParameterEventBatch batch(*node_parameters);
+    node_parameters->declare_parameter("first", rclcpp::ParameterValue(0));
+    node_parameters->declare_parameter("second", rclcpp::ParameterValue(0));
+    node_parameters->set_parameters({rclcpp::Parameter("first", 1)});
+    {
+      rclcpp::node_interfaces::ParameterEventBatch nested_batch(*node_parameters);
+      node_parameters->declare_parameter("third", rclcpp::ParameterValue(0));
+    }
+  }
+  ASSERT_EQ(1u, wait_for_events(1));
+  ASSERT_EQ(3u, events[0].new_parameters.size());
+  EXPECT_EQ("first", events[0].new_parameters[0].name);
+  EXPECT_EQ(1, events[0].new_parameters[0].value.integer_value);
+  EXPECT_TRUE(events[0].changed_parameters.empty());
+
+  // The changes of the parameters set separately are published together
+  auto results = node_parameters->set_parameters(
+    {rclcpp::Parameter("first", 2), rclcpp::Parameter("second", 2)});
+  ASSERT_EQ(2u, results.size());
+  ASSERT_EQ(2u, wait_for_events(2));
+  EXPECT_EQ(2u, events[1].changed_parameters.size());
+
+  // Without the declarations, only the changes are published
+  rclcpp::node_interfaces::NodeParameters::set_declaration_events_enabled(false);
+  node_parameters->declare_parameter("fourth", rclcpp::ParameterValue(0));
+  node_parameters->set_parameters({rclcpp::Parameter("fourth", 4)});
+  rclcpp::node_interfaces::NodeParameters::set_declaration_events_enabled(true);
+  ASSERT_EQ(3u, wait_for_events(3));
+  EXPECT_TRUE(events[2].new_parameters.empty());
+  ASSERT_EQ(1u, events[2].changed_parameters.size());
+  EXPECT_EQ("fourth", events[2].changed_parameters[0].name);
+
+  EXPECT_THROW(node_parameters->end_parameter_event_batch(), std::runtime_error);
+}
+
+TEST_F(TestNodeParameters, declare_parameters) {
+  size_t on_set_calls = 0;
+  size_t post_set_calls = 0;
+  std::vector<rclcpp::Parameter> set_parameters;
+  auto on_set_handle = node_parameters->add_on_set_parameters_callback(
+    [&on_set_calls](const std::vector<rclcpp::Parameter> & parameters) {
+      ++on_set_calls;
+      rcl_interfaces::msg::SetParametersResult result;
+      result.successful = true;
+      for (const auto & parameter : parameters) {
+        if (parameter.get_name() == "rejected") {
+          result.successful = false;
+          result.reason = "rejected";
+        }
+      }
+      return result;
+    });
+  auto post_set_handle = node_parameters->add_post_set_parameters_callback(
+    [&post_set_calls, &set_parameters](const std::vector<rclcpp::Parameter> & parameters) {
+      ++post_set_calls;
+      set_parameters = parameters;
+    });
+
+  std::vector<rclcpp::node_interfaces::ParameterDeclaration> declarations(3);
+  declarations[0].name = "first";
+  declarations[0].default_value = rclcpp::ParameterValue(1);
+  declarations[1].name = "second";
+  declarations[1].default_value = rclcpp::ParameterValue("two");
+  declarations[2].name = "third";
+  declarations[2].type = rclcpp::PARAMETER_DOUBLE;
+  auto values = node_parameters->declare_parameters(declarations);
+  ASSERT_EQ(3u, values.size());
+  EXPECT_EQ(1, values[0].get<int64_t>());
+  EXPECT_EQ("two", values[1].get<std::string>());
+  EXPECT_EQ(rclcpp::PARAMETER_NOT_SET, values[2].get_type());
+  EXPECT_EQ(1u, on_set_calls);
+  EXPECT_EQ(1u, post_set_calls);
+  ASSERT_EQ(2u, set_parameters.size());
+  EXPECT_EQ("second", set_parameters[1].get_name());
+  EXPECT_TRUE(node_parameters->has_parameter("third"));
+  EXPECT_EQ(
+    rclcpp::PARAMETER_DOUBLE,
+    node_parameters->describe_parameters({"third"})[0].type);
+
+  // Nothing is declared when any declaration fails
+  std::vector<rclcpp::node_interfaces::ParameterDeclaration> invalid_declarations(2);
+  invalid_declarations[0].name = "fourth";
+  invalid_declarations[0].default_value = rclcpp::ParameterValue(4);
+  invalid_declarations[1].name = "first";
+  invalid_declarations[1].default_value = rclcpp::ParameterValue(1);
+  EXPECT_THROW(
+    node_parameters->declare_parameters(invalid_declarations),
+    rclcpp::exceptions::ParameterAlreadyDeclaredException);
+  invalid_declarations[1].name = "fourth";
+  EXPECT_THROW(
+    node_parameters->declare_parameters(invalid_declarations),
+    rclcpp::exceptions::ParameterAlreadyDeclaredException);
+  invalid_declarations[1].name = "fifth";
+  invalid_declarations[1].type = rclcpp::PARAMETER_STRING;
+  EXPECT_THROW(
+    node_parameters->declare_parameters(invalid_declarations),
+    rclcpp::exceptions::InvalidParameterTypeException);
+  invalid_declarations[1].name = "rejected";
+  invalid_declarations[1].type = rclcpp::PARAMETER_NOT_SET;
+  EXPECT_THROW(
+    node_parameters->declare_parameters(invalid_declarations),
+    rclcpp::exceptions::InvalidParameterValueException);
+  EXPECT_FALSE(node_parameters->has_parameter("fourth"));
+  EXPECT_EQ(1u, post_set_calls);
+  EXPECT_EQ(2u, on_set_calls);
+
+  EXPECT_TRUE(node_parameters->declare_parameters({}).empty());
+}
+
+TEST_F(TestNodeParameters, parameter_state) {
+  node->declare_parameter("restored_int", 1);
+  node->declare_parameter("restored_string", "one");
+  node->set_parameter(rclcpp::Parameter("restored_int", 5));
+  const std::vector<uint8_t> state = node_parameters->save_parameter_state();
+  ASSERT_FALSE(state.empty());
+
+  rclcpp::NodeOptions options;
+  options.parameter_state(state);
+  auto restarted_node = std::make_shared<rclcpp::Node>("restarted_node", "ns", options);
+  size_t on_set_calls = 0;
+  auto on_set_handle = restarted_node->add_on_set_parameters_callback(
+    [&on_set_calls](const std::vector<rclcpp::Parameter> &) {
+      ++on_set_calls;
+      rcl_interfaces::msg::SetParametersResult result;
+      result.successful = true;
+      return result;
+    });
+
+  // Declared the same way, the restored value isn't validated again
+  EXPECT_EQ(5, restarted_node->declare_parameter("restored_int", 1));
+  EXPECT_EQ(0u, on_set_calls);
+  // Declared with another descriptor, the restored value is validated like an override
+  rcl_interfaces::msg::ParameterDescriptor descriptor;
+  descriptor.read_only = true;
+  EXPECT_EQ(
+    "one", restarted_node->declare_parameter("restored_string", "two", descriptor));
+  EXPECT_EQ(1u, on_set_calls);
+  EXPECT_TRUE(restarted_node->describe_parameter("restored_string").read_only);
+  EXPECT_EQ(3, restarted_node->declare_parameter("not_restored", 3));
+
+
+  // The declarations of many parameters restore them the same way
+  auto bulk_node = std::make_shared<rclcpp::Node>("bulk_node", "ns", options);
+  auto bulk_parameters = bulk_node->get_node_parameters_interface();
+  on_set_handle = bulk_node->add_on_set_parameters_callback(
+    [&on_set_calls](const std::vector<rclcpp::Parameter> &) {
+      ++on_set_calls;
+      rcl_interfaces::msg::SetParametersResult result;
+      result.successful = true;
+      return result;
+    });
+  std::vector<rclcpp::node_interfaces::ParameterDeclaration> declarations(2);
+  declarations[0].name = "restored_int";
+  declarations[0].default_value = rclcpp::ParameterValue(1);
+  declarations[1].name = "restored_string";
+  declarations[1].default_value = rclcpp::ParameterValue("two");
+  auto values = bulk_parameters->declare_parameters(declarations);
+  ASSERT_EQ(2u, values.size());
+  EXPECT_EQ(5, values[0].get<int64_t>());
+  EXPECT_EQ("one", values[1].get<std::string>());
+  EXPECT_EQ(1u, on_set_calls);
+
+  options.parameter_state({1, 2, 3});
+  EXPECT_THROW(
+    std::make_shared<rclcpp::Node>("malformed_node", "ns", options), std::invalid_argument);
+}
@@ -16,6 +16,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 #include <utility>
 
@@ -905,3 +906,134 @@ TEST_F(TestAllocatorMemoryStrategy, get_next_waitable_out_of_scope) {
   allocator_memory_strategy()->get_next_waitable(result, weak_groups_to_nodes);
   EXPECT_EQ(nullptr, result.node_base);
 }
+
+TEST_F(TestAllocatorMemoryStrategy, restore_collected_entities) {
+  // Nothing was collected yet
+  EXPECT_FALSE(allocator_memory_strategy()->restore_collected_entities());
+
+  auto node = create_node_with_disabled_callback_groups("node");
+  auto callback_group =
+    node->create_callback_group(rclcpp::CallbackGroupType::MutuallyExclusive);
+  auto timer = node->create_wall_timer(std::chrono::seconds(10), []() {}, callback_group);
+  WeakCallbackGroupsToNodesMap weak_groups_to_nodes;
+  node->for_each_callback_group(
+    [node, &weak_groups_to_nodes](rclcpp::CallbackGroup::SharedPtr group_ptr)
+    {
+      weak_groups_to_nodes.insert(
+        std::pair<rclcpp::CallbackGroup::WeakPtr,
+        rclcpp::node_interfaces::NodeBaseInterface::WeakPtr>(
+          group_ptr,
+          node->get_node_base_interface()));
+    });
+  allocator_memory_strategy()->collect_entities(weak_groups_to_nodes);
+  EXPECT_EQ(1u, allocator_memory_strategy()->number_of_ready_timers());
+
+  allocator_memory_strategy()->clear_handles();
+  EXPECT_EQ(0u, allocator_memory_strategy()->number_of_ready_timers());
+  EXPECT_TRUE(allocator_memory_strategy()->restore_collected_entities());
+  EXPECT_EQ(1u, allocator_memory_strategy()->number_of_ready_timers());
+
+  // The collection is outdated once one of its entities is destroyed
+  allocator_memory_strategy()->clear_handles();
+  timer.reset();
+  EXPECT_FALSE(allocator_memory_strategy()->restore_collected_entities());
+  EXPECT_EQ(0u, allocator_memory_strategy()->number_of_ready_timers());
+}
+
+TEST_F(TestAllocatorMemoryStrategy, get_next_timer_earliest_deadline_first) {
+  auto node = create_node_with_disabled_callback_groups("node");
+  auto callback_group =
+    node->create_callback_group(rclcpp::CallbackGroupType::Reentrant);
+  // Collected first, but its deadline is far away
+  auto slow_timer = node->create_wall_timer(
+    std::chrono::milliseconds(100), []() {}, callback_group);
+  auto fast_timer = node->create_wall_timer(
+    std::chrono::milliseconds(1), []() {}, callback_group);
+  WeakCallbackGroupsToNodesMap weak_groups_to_nodes;
+  weak_groups_to_nodes.insert(
+    std::pair<rclcpp::CallbackGroup::WeakPtr,
+    rclcpp::node_interfaces::NodeBaseInterface::WeakPtr>(
+      callback_group,
+      node->get_node_base_interface()));
+  // Let both timers become ready
+  std::this_thread::sleep_for(std::chrono::milliseconds(150));
+
+  EXPECT_TRUE(
+    allocator_memory_strategy()->set_timer_dispatch_order(
+      rclcpp::memory_strategy::TimerDispatchOrder::EarliestDeadlineFirst));
+  allocator_memory_strategy()->collect_entities(weak_groups_to_nodes);
+  ASSERT_EQ(2u, allocator_memory_strategy()->number_of_ready_timers());
+
+  rclcpp::AnyExecutable first;
+  allocator_memory_strategy()->get_next_timer(first, weak_groups_to_nodes);
+  EXPECT_EQ(fast_timer, first.timer);
+  rclcpp::AnyExecutable second;
+  allocator_memory_strategy()->get_next_timer(second, weak_groups_to_nodes);
+  EXPECT_EQ(slow_timer, second.timer);
+
+  // Both timers ran late and it was reported
+  auto fast_statistics = fast_timer->get_lateness_statistics();
+  EXPECT_EQ(1u, fast_statistics.call_count);
+  EXPECT_GT(fast_statistics.last_lateness, std::chrono::milliseconds(100));
+  EXPECT_EQ(fast_statistics.last_lateness, fast_statistics.max_lateness);
+  EXPECT_EQ(1u, slow_timer->get_lateness_statistics().call_count);
+  fast_timer->reset_lateness_statistics();
+  EXPECT_EQ(0u, fast_timer->get_lateness_statistics().call_count);
+
+  EXPECT_TRUE(
+    allocator_memory_strategy()->set_timer_dispatch_order(
+      rclcpp::memory_strategy::TimerDispatchOrder::CollectionOrder));
+}
+
+TEST_F(TestAllocatorMemoryStrategy, get_next_timer_round_robin) {
+  auto node = create_node_with_disabled_callback_groups("node");
+  auto group_a = node->create_callback_group(rclcpp::CallbackGroupType::MutuallyExclusive);
+  auto group_b = node->create_callback_group(rclcpp::CallbackGroupType::MutuallyExclusive);
+  std::vector<rclcpp::TimerBase::SharedPtr> timers;
+  for (auto & group : {group_a, group_b}) {
+    for (size_t i = 0; i < 2; ++i) {
+      timers.push_back(node->create_wall_timer(std::chrono::milliseconds(1), []() {}, group));
+    }
+  }
+  WeakCallbackGroupsToNodesMap weak_groups_to_nodes;
+  for (auto & group : {group_a, group_b}) {
+    weak_groups_to_nodes.insert(
+      std::pair<rclcpp::CallbackGroup::WeakPtr,
+      rclcpp::node_interfaces::NodeBaseInterface::WeakPtr>(
+        group,
+        node->get_node_base_interface()));
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  allocator_memory_strategy()->collect_entities(weak_groups_to_nodes);
+  ASSERT_EQ(4u, allocator_memory_strategy()->number_of_ready_timers());
+
+  // The groups are served in turn, even though both timers of a group were collected together
+  rclcpp::CallbackGroup::SharedPtr last_group;
+  for (size_t i = 0; i < 2; ++i) {
+    rclcpp::AnyExecutable result;
+    allocator_memory_strategy()->get_next_timer(result, weak_groups_to_nodes);
+    ASSERT_NE(nullptr, result.timer);
+    EXPECT_NE(last_group, result.callback_group);
+    EXPECT_FALSE(result.callback_group->can_be_taken_from().load());
+    last_group = result.callback_group;
+  }
+  EXPECT_TRUE(group_a->can_be_taken_from().load());
+  EXPECT_TRUE(group_b->can_be_taken_from().load());
+
+  // While both groups are reserved, their ready work is skipped and counted
+  group_a->reset_reservation_statistics();
+  group_b->reset_reservation_statistics();
+  rclcpp::AnyExecutable first;
+  allocator_memory_strategy()->get_next_timer(first, weak_groups_to_nodes);
+  rclcpp::AnyExecutable second;
+  allocator_memory_strategy()->get_next_timer(second, weak_groups_to_nodes);
+  ASSERT_NE(nullptr, first.timer);
+  ASSERT_NE(nullptr, second.timer);
+  EXPECT_NE(first.callback_group, second.callback_group);
+  EXPECT_EQ(0u, allocator_memory_strategy()->number_of_ready_timers());
+  EXPECT_EQ(1u, group_a->get_reservation_statistics().reservation_count);
+  EXPECT_EQ(1u, group_b->get_reservation_statistics().reservation_count);
+
+  EXPECT_FALSE(first.callback_group->try_reserve());
+  EXPECT_EQ(1u, first.callback_group->get_reservation_statistics().skip_count);
+}
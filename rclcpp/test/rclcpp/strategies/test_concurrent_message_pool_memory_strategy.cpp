@@ -0,0 +1,142 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "rclcpp/strategies/concurrent_message_pool_memory_strategy.hpp"
+#include "test_msgs/msg/basic_types.hpp"
+#include "test_msgs/msg/empty.hpp"
+
+using rclcpp::strategies::message_pool_memory_strategy::ConcurrentMessagePool;
+using rclcpp::strategies::message_pool_memory_strategy::ConcurrentMessagePoolMemoryStrategy;
+using rclcpp::strategies::message_pool_memory_strategy::MessagePoolOptions;
+using rclcpp::strategies::message_pool_memory_strategy::MessagePoolSet;
+
+TEST(TestConcurrentMessagePoolMemoryStrategy, prewarm_and_reuse) {
+  MessagePoolOptions options;
+  options.initial_size = 4;
+  ConcurrentMessagePoolMemoryStrategy<test_msgs::msg::BasicTypes> strategy(options);
+  auto pool = strategy.get_pool();
+  EXPECT_EQ(4u, pool->get_statistics().size);
+  EXPECT_EQ(4u, pool->get_statistics().depot_size);
+
+  auto message = strategy.borrow_message();
+  ASSERT_NE(nullptr, message);
+  auto * raw_message = message.get();
+  strategy.return_message(message);
+  EXPECT_EQ(nullptr, message);
+
+  // The returned message is cached by this thread and borrowed again
+  message = strategy.borrow_message();
+  EXPECT_EQ(raw_message, message.get());
+  strategy.return_message(message);
+
+  auto statistics = pool->get_statistics();
+  EXPECT_EQ(2u, statistics.hit_count);
+  EXPECT_EQ(0u, statistics.miss_count);
+  EXPECT_EQ(4u, statistics.size);
+}
+
+TEST(TestConcurrentMessagePoolMemoryStrategy, grow_with_limit) {
+  MessagePoolOptions options;
+  options.max_size = 2;
+  options.thread_cache_size = 0;
+  auto pool = std::make_shared<ConcurrentMessagePool<test_msgs::msg::Empty>>(options);
+
+  auto first = pool->acquire();
+  auto second = pool->acquire();
+  auto third = pool->acquire();
+  ASSERT_NE(nullptr, third);
+  auto statistics = pool->get_statistics();
+  EXPECT_EQ(0u, statistics.hit_count);
+  EXPECT_EQ(3u, statistics.miss_count);
+  EXPECT_EQ(1u, statistics.overflow_count);
+  EXPECT_EQ(2u, statistics.size);
+
+  pool->release(first);
+  pool->release(second);
+  // The message allocated beyond the limit isn't pooled
+  pool->release(third);
+  EXPECT_EQ(2u, pool->get_statistics().depot_size);
+
+  // A message still referenced elsewhere leaves the pool
+  auto kept = pool->acquire();
+  auto copy = kept;
+  pool->release(kept);
+  statistics = pool->get_statistics();
+  EXPECT_EQ(1u, statistics.size);
+  EXPECT_EQ(1u, statistics.depot_size);
+
+  auto unrecognized = std::make_shared<test_msgs::msg::Empty>();
+  EXPECT_NO_THROW(pool->release(unrecognized));
+  EXPECT_EQ(nullptr, unrecognized);
+}
+
+TEST(TestConcurrentMessagePoolMemoryStrategy, multiple_threads) {
+  MessagePoolOptions options;
+  options.initial_size = 16;
+  options.max_size = 16;
+  options.thread_cache_size = 4;
+  auto pool = std::make_shared<ConcurrentMessagePool<test_msgs::msg::BasicTypes>>(options);
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < 4; ++i) {
+    threads.emplace_back(
+      [pool]() {
+        for (size_t j = 0; j < 1000; ++j) {
+          auto first = pool->acquire();
+          auto second = pool->acquire();
+          first->int32_value = static_cast<int32_t>(j);
+          pool->release(first);
+          pool->release(second);
+        }
+      });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  auto statistics = pool->get_statistics();
+  EXPECT_EQ(8000u, statistics.hit_count + statistics.miss_count);
+  EXPECT_EQ(16u, statistics.size);
+}
+
+TEST(TestConcurrentMessagePoolMemoryStrategy, pool_set) {
+  MessagePoolSet pools;
+  MessagePoolOptions options;
+  options.initial_size = 3;
+  auto basic_types_pool = pools.add_pool<test_msgs::msg::BasicTypes>(options);
+  EXPECT_EQ(basic_types_pool, pools.get_pool<test_msgs::msg::BasicTypes>());
+  EXPECT_EQ(3u, basic_types_pool->get_statistics().size);
+
+  auto empty_strategy = pools.create_memory_strategy<test_msgs::msg::Empty>();
+  auto message = empty_strategy->borrow_message();
+  ASSERT_NE(nullptr, message);
+  empty_strategy->return_message(message);
+
+  auto statistics = pools.get_statistics();
+  EXPECT_EQ(0u, statistics.hit_count);
+  EXPECT_EQ(1u, statistics.miss_count);
+  EXPECT_EQ(4u, statistics.size);
+}
+
+TEST(TestConcurrentMessagePoolMemoryStrategy, null_pool) {
+  EXPECT_THROW(
+    ConcurrentMessagePoolMemoryStrategy<test_msgs::msg::Empty>(
+      ConcurrentMessagePool<test_msgs::msg::Empty>::SharedPtr()),
+    std::invalid_argument);
+}
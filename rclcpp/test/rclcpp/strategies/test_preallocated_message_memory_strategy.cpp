@@ -0,0 +1,85 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "rclcpp/strategies/preallocated_message_memory_strategy.hpp"
+#include "test_msgs/msg/unbounded_sequences.hpp"
+
+using rclcpp::strategies::message_pool_memory_strategy::PreallocatedMessageMemoryStrategy;
+using test_msgs::msg::UnboundedSequences;
+
+TEST(TestPreallocatedMessageMemoryStrategy, invalid_messages) {
+  EXPECT_THROW(
+    PreallocatedMessageMemoryStrategy<UnboundedSequences>(
+      std::vector<std::shared_ptr<UnboundedSequences>>()),
+    std::invalid_argument);
+  EXPECT_THROW(
+    PreallocatedMessageMemoryStrategy<UnboundedSequences>(
+      std::shared_ptr<UnboundedSequences>()),
+    std::invalid_argument);
+}
+
+TEST(TestPreallocatedMessageMemoryStrategy, reuse_keeps_capacity) {
+  auto preallocated = std::make_shared<UnboundedSequences>();
+  preallocated->int32_values.reserve(1000);
+  PreallocatedMessageMemoryStrategy<UnboundedSequences> strategy(preallocated);
+
+  auto message = strategy.borrow_message();
+  EXPECT_EQ(preallocated, message);
+  message->int32_values.resize(10);
+  strategy.return_message(message);
+  EXPECT_EQ(nullptr, message);
+
+  // The instance isn't reset, the next take overwrites it
+  message = strategy.borrow_message();
+  EXPECT_EQ(preallocated, message);
+  EXPECT_EQ(10u, message->int32_values.size());
+  EXPECT_LE(1000u, message->int32_values.capacity());
+  strategy.return_message(message);
+  EXPECT_EQ(0u, strategy.get_fallback_count());
+}
+
+TEST(TestPreallocatedMessageMemoryStrategy, ring) {
+  std::vector<std::shared_ptr<UnboundedSequences>> preallocated = {
+    std::make_shared<UnboundedSequences>(), std::make_shared<UnboundedSequences>()};
+  PreallocatedMessageMemoryStrategy<UnboundedSequences> strategy(preallocated);
+
+  auto first = strategy.borrow_message();
+  auto second = strategy.borrow_message();
+  EXPECT_NE(first, second);
+  EXPECT_TRUE(first == preallocated[0] || first == preallocated[1]);
+  EXPECT_TRUE(second == preallocated[0] || second == preallocated[1]);
+
+  // All the instances are borrowed, the message is allocated
+  auto allocated = strategy.borrow_message();
+  ASSERT_NE(nullptr, allocated);
+  EXPECT_NE(preallocated[0], allocated);
+  EXPECT_NE(preallocated[1], allocated);
+  EXPECT_EQ(1u, strategy.get_fallback_count());
+  strategy.return_message(allocated);
+  EXPECT_EQ(nullptr, allocated);
+
+  auto * returned = first.get();
+  strategy.return_message(first);
+  auto borrowed = strategy.borrow_message();
+  EXPECT_EQ(returned, borrowed.get());
+  strategy.return_message(borrowed);
+  strategy.return_message(second);
+  EXPECT_EQ(1u, strategy.get_fallback_count());
+}
@@ -0,0 +1,208 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp/strategies/ready_set_memory_strategy.hpp"
+#include "rcpputils/scope_exit.hpp"
+#include "test_msgs/msg/empty.hpp"
+
+using rclcpp::memory_strategies::ready_set_memory_strategy::ReadySetMemoryStrategy;
+typedef std::map<rclcpp::CallbackGroup::WeakPtr,
+    rclcpp::node_interfaces::NodeBaseInterface::WeakPtr,
+    std::owner_less<rclcpp::CallbackGroup::WeakPtr>> WeakCallbackGroupsToNodesMap;
+
+class TestReadySetMemoryStrategy : public ::testing::Test
+{
+public:
+  void SetUp() override
+  {
+    rclcpp::init(0, nullptr);
+    memory_strategy_ = std::make_shared<ReadySetMemoryStrategy<>>();
+    node_ = std::make_shared<rclcpp::Node>("node", "ns");
+    callback_group_ = node_->create_callback_group(
+      rclcpp::CallbackGroupType::MutuallyExclusive, false);
+    weak_groups_to_nodes_.insert(
+      std::pair<rclcpp::CallbackGroup::WeakPtr,
+      rclcpp::node_interfaces::NodeBaseInterface::WeakPtr>(
+        callback_group_, node_->get_node_base_interface()));
+  }
+
+  void TearDown() override
+  {
+    memory_strategy_.reset();
+    callback_group_.reset();
+    node_.reset();
+    rclcpp::shutdown();
+  }
+
+  /// Wait on the collected entities and record the ready ones in the memory strategy.
+  void wait(std::chrono::nanoseconds timeout)
+  {
+    rcl_wait_set_t wait_set = rcl_get_zero_initialized_wait_set();
+    auto context = node_->get_node_base_interface()->get_context();
+    ASSERT_EQ(
+      RCL_RET_OK,
+      rcl_wait_set_init(
+        &wait_set,
+        memory_strategy_->number_of_ready_subscriptions(),
+        memory_strategy_->number_of_guard_conditions(),
+        memory_strategy_->number_of_ready_timers(),
+        memory_strategy_->number_of_ready_clients(),
+        memory_strategy_->number_of_ready_services(),
+        memory_strategy_->number_of_ready_events(),
+        context->get_rcl_context().get(),
+        rcl_get_default_allocator()));
+    RCPPUTILS_SCOPE_EXIT(
+    {
+      EXPECT_EQ(RCL_RET_OK, rcl_wait_set_fini(&wait_set));
+    });
+    ASSERT_TRUE(memory_strategy_->add_handles_to_wait_set(&wait_set));
+    rcl_ret_t ret = rcl_wait(&wait_set, timeout.count());
+    ASSERT_TRUE(ret == RCL_RET_OK || ret == RCL_RET_TIMEOUT);
+    memory_strategy_->remove_null_handles(&wait_set);
+  }
+
+protected:
+  std::shared_ptr<ReadySetMemoryStrategy<>> memory_strategy_;
+  std::shared_ptr<rclcpp::Node> node_;
+  rclcpp::CallbackGroup::SharedPtr callback_group_;
+  WeakCallbackGroupsToNodesMap weak_groups_to_nodes_;
+};
+
+TEST_F(TestReadySetMemoryStrategy, only_ready_timers_are_visited) {
+  auto slow_timer = node_->create_wall_timer(
+    std::chrono::seconds(100), []() {}, callback_group_);
+  auto fast_timer = node_->create_wall_timer(
+    std::chrono::milliseconds(1), []() {}, callback_group_);
+  memory_strategy_->collect_entities(weak_groups_to_nodes_);
+  EXPECT_EQ(2u, memory_strategy_->number_of_ready_timers());
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  wait(std::chrono::seconds(1));
+  // The size of the wait set doesn't change, but only the ready timer is pending
+  EXPECT_EQ(2u, memory_strategy_->number_of_ready_timers());
+  EXPECT_EQ(1u, memory_strategy_->number_of_pending_ready_entities());
+
+  rclcpp::AnyExecutable result;
+  memory_strategy_->get_next_timer(result, weak_groups_to_nodes_);
+  EXPECT_EQ(fast_timer, result.timer);
+  EXPECT_EQ(callback_group_, result.callback_group);
+  EXPECT_EQ(node_->get_node_base_interface(), result.node_base);
+  EXPECT_EQ(0u, memory_strategy_->number_of_pending_ready_entities());
+
+  rclcpp::AnyExecutable none;
+  memory_strategy_->get_next_timer(none, weak_groups_to_nodes_);
+  EXPECT_EQ(nullptr, none.timer);
+}
+
+TEST_F(TestReadySetMemoryStrategy, only_ready_subscriptions_are_visited) {
+  std::vector<rclcpp::Subscription<test_msgs::msg::Empty>::SharedPtr> subscriptions;
+  rclcpp::SubscriptionOptions options;
+  options.callback_group = callback_group_;
+  for (size_t i = 0; i < 10; ++i) {
+    subscriptions.push_back(
+      node_->create_subscription<test_msgs::msg::Empty>(
+        "topic" + std::to_string(i), 10, [](test_msgs::msg::Empty::ConstSharedPtr) {}, options));
+  }
+  auto publisher = node_->create_publisher<test_msgs::msg::Empty>("topic7", 10);
+  memory_strategy_->collect_entities(weak_groups_to_nodes_);
+  EXPECT_EQ(10u, memory_strategy_->number_of_ready_subscriptions());
+
+  auto end = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (publisher->get_subscription_count() == 0 && std::chrono::steady_clock::now() < end) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  publisher->publish(test_msgs::msg::Empty());
+  do {
+    ASSERT_TRUE(memory_strategy_->restore_collected_entities());
+    wait(std::chrono::milliseconds(100));
+  } while (memory_strategy_->number_of_pending_ready_entities() == 0 &&
+  std::chrono::steady_clock::now() < end);
+  EXPECT_EQ(1u, memory_strategy_->number_of_pending_ready_entities());
+
+  rclcpp::AnyExecutable result;
+  memory_strategy_->get_next_subscription(result, weak_groups_to_nodes_);
+  EXPECT_EQ(subscriptions[7], result.subscription);
+}
+
+TEST_F(TestReadySetMemoryStrategy, mutually_exclusive_group_is_skipped) {
+  auto timer = node_->create_wall_timer(
+    std::chrono::milliseconds(1), []() {}, callback_group_);
+  memory_strategy_->collect_entities(weak_groups_to_nodes_);
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  wait(std::chrono::seconds(1));
+
+  callback_group_->can_be_taken_from() = false;
+  rclcpp::AnyExecutable skipped;
+  memory_strategy_->get_next_timer(skipped, weak_groups_to_nodes_);
+  EXPECT_EQ(nullptr, skipped.timer);
+  // The timer is left to be checked again
+  EXPECT_EQ(1u, memory_strategy_->number_of_pending_ready_entities());
+
+  callback_group_->can_be_taken_from() = true;
+  rclcpp::AnyExecutable result;
+  memory_strategy_->get_next_timer(result, weak_groups_to_nodes_);
+  EXPECT_EQ(timer, result.timer);
+}
+
+TEST_F(TestReadySetMemoryStrategy, restore_collected_entities) {
+  // Nothing was collected yet
+  EXPECT_FALSE(memory_strategy_->restore_collected_entities());
+
+  auto timer = node_->create_wall_timer(std::chrono::seconds(10), []() {}, callback_group_);
+  memory_strategy_->collect_entities(weak_groups_to_nodes_);
+  EXPECT_EQ(1u, memory_strategy_->number_of_ready_timers());
+
+  memory_strategy_->clear_handles();
+  EXPECT_EQ(0u, memory_strategy_->number_of_ready_timers());
+  EXPECT_TRUE(memory_strategy_->restore_collected_entities());
+  EXPECT_EQ(1u, memory_strategy_->number_of_ready_timers());
+
+  // The collection is outdated once one of its entities is destroyed
+  memory_strategy_->clear_handles();
+  timer.reset();
+  EXPECT_FALSE(memory_strategy_->restore_collected_entities());
+  EXPECT_EQ(0u, memory_strategy_->number_of_ready_timers());
+}
+
+TEST_F(TestReadySetMemoryStrategy, executor) {
+  rclcpp::ExecutorOptions options;
+  options.memory_strategy = memory_strategy_;
+  rclcpp::executors::SingleThreadedExecutor executor(options);
+  size_t count = 0;
+  auto timer = node_->create_wall_timer(
+    std::chrono::milliseconds(1), [&count]() {count++;}, callback_group_);
+  std::vector<rclcpp::TimerBase::SharedPtr> idle_timers;
+  for (size_t i = 0; i < 100; ++i) {
+    idle_timers.push_back(
+      node_->create_wall_timer(std::chrono::seconds(100), []() {}, callback_group_));
+  }
+  executor.add_callback_group(callback_group_, node_->get_node_base_interface());
+
+  auto end = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (count < 10 && std::chrono::steady_clock::now() < end) {
+    executor.spin_once(std::chrono::milliseconds(100));
+  }
+  EXPECT_EQ(10u, count);
+}
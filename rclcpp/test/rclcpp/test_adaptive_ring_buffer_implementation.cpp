@@ -0,0 +1,195 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "rclcpp/experimental/buffers/adaptive_ring_buffer_implementation.hpp"
+#include "rclcpp/experimental/create_intra_process_buffer.hpp"
+
+using rclcpp::experimental::buffers::AdaptiveBufferImplementationFactory;
+using rclcpp::experimental::buffers::AdaptiveBufferOptions;
+using rclcpp::experimental::buffers::AdaptiveRingBufferImplementation;
+using rclcpp::experimental::buffers::BufferResize;
+
+namespace
+{
+
+AdaptiveBufferOptions
+make_options(size_t min_depth, size_t max_depth, std::vector<BufferResize> * resizes = nullptr)
+{
+  AdaptiveBufferOptions options;
+  options.min_depth = min_depth;
+  options.max_depth = max_depth;
+  options.shrink_window = 4;
+  if (resizes) {
+    options.on_resize = [resizes](const BufferResize & resize) {
+        resizes->push_back(resize);
+      };
+  }
+  return options;
+}
+
+}  // namespace
+
+TEST(TestAdaptiveRingBufferImplementation, grows_during_bursts) {
+  std::vector<BufferResize> resizes;
+  AdaptiveRingBufferImplementation<size_t> buffer(make_options(2, 8, &resizes));
+  EXPECT_EQ(2u, buffer.get_capacity());
+  EXPECT_FALSE(buffer.has_data());
+  EXPECT_EQ(0u, buffer.dequeue());
+
+  // A burst of 5 elements is kept whole, the capacity doubling twice
+  for (size_t i = 1; i <= 5; ++i) {
+    buffer.enqueue(i);
+  }
+  EXPECT_EQ(8u, buffer.get_capacity());
+  ASSERT_EQ(2u, resizes.size());
+  EXPECT_EQ(2u, resizes[0].previous_capacity);
+  EXPECT_EQ(4u, resizes[0].capacity);
+  EXPECT_EQ(2u, resizes[0].depth);
+  EXPECT_EQ(4u, resizes[1].previous_capacity);
+  EXPECT_EQ(8u, resizes[1].capacity);
+  for (size_t i = 1; i <= 5; ++i) {
+    EXPECT_EQ(i, buffer.dequeue());
+  }
+  EXPECT_FALSE(buffer.has_data());
+
+  // Beyond the maximum depth, the oldest elements are dropped
+  for (size_t i = 1; i <= 10; ++i) {
+    buffer.enqueue(i);
+  }
+  EXPECT_EQ(8u, buffer.get_capacity());
+  EXPECT_EQ(3u, buffer.dequeue());
+
+  auto metrics = buffer.get_metrics();
+  EXPECT_EQ(8u, metrics.capacity);
+  EXPECT_EQ(7u, metrics.depth);
+  EXPECT_EQ(8u, metrics.high_water_mark);
+  EXPECT_EQ(15u, metrics.enqueued_count);
+  EXPECT_EQ(6u, metrics.dequeued_count);
+  EXPECT_EQ(2u, metrics.dropped_count);
+  EXPECT_EQ(2u, metrics.resize_count);
+
+  buffer.clear();
+  EXPECT_FALSE(buffer.has_data());
+}
+
+TEST(TestAdaptiveRingBufferImplementation, shrinks_when_the_consumer_keeps_up) {
+  std::vector<BufferResize> resizes;
+  AdaptiveRingBufferImplementation<size_t> buffer(make_options(1, 8, &resizes));
+  for (size_t i = 0; i < 8; ++i) {
+    buffer.enqueue(i);
+  }
+  EXPECT_EQ(8u, buffer.get_capacity());
+  while (buffer.has_data()) {
+    buffer.dequeue();
+  }
+  resizes.clear();
+
+  // Each window of 4 enqueues consumed right away halves the capacity
+  for (size_t i = 0; i < 4 * 4; ++i) {
+    buffer.enqueue(i);
+    EXPECT_EQ(i, buffer.dequeue());
+  }
+  EXPECT_EQ(1u, buffer.get_capacity());
+  ASSERT_EQ(3u, resizes.size());
+  EXPECT_EQ(8u, resizes[0].previous_capacity);
+  EXPECT_EQ(4u, resizes[0].capacity);
+  EXPECT_EQ(1u, resizes[0].depth);
+  EXPECT_EQ(1u, resizes[2].capacity);
+
+  // A buffer more than half full in a window keeps its capacity
+  buffer.enqueue(0);
+  buffer.enqueue(1);
+  EXPECT_EQ(2u, buffer.get_capacity());
+  buffer.dequeue();
+  buffer.dequeue();
+  for (size_t i = 0; i < 3; ++i) {
+    buffer.enqueue(i);
+    buffer.dequeue();
+  }
+  EXPECT_EQ(2u, buffer.get_capacity());
+  EXPECT_EQ(7u, buffer.get_metrics().resize_count);
+}
+
+TEST(TestAdaptiveRingBufferImplementation, memory_budget) {
+  auto options = make_options(1, 16);
+  options.memory_budget = 10;
+  AdaptiveRingBufferImplementation<std::string> buffer(
+    options, [](const std::string & element) {return element.size();});
+
+  buffer.enqueue("1234");
+  buffer.enqueue("5678");
+  EXPECT_EQ(2u, buffer.get_capacity());
+  EXPECT_EQ(8u, buffer.get_memory_usage());
+  // The buffer doesn't grow beyond the budget, the oldest element is dropped
+  buffer.enqueue("abcd");
+  EXPECT_EQ(2u, buffer.get_capacity());
+  EXPECT_EQ(8u, buffer.get_memory_usage());
+  // Nor keeps elements which don't fit, only the newest one
+  buffer.enqueue("0123456789ab");
+  EXPECT_EQ(12u, buffer.get_memory_usage());
+  EXPECT_EQ("0123456789ab", buffer.dequeue());
+  EXPECT_FALSE(buffer.has_data());
+  EXPECT_EQ(0u, buffer.get_memory_usage());
+  EXPECT_EQ(3u, buffer.get_metrics().dropped_count);
+}
+
+TEST(TestAdaptiveRingBufferImplementation, invalid_options) {
+  EXPECT_THROW(
+    AdaptiveRingBufferImplementation<size_t>(make_options(0, 8)), std::invalid_argument);
+  EXPECT_THROW(
+    AdaptiveRingBufferImplementation<size_t>(make_options(4, 2)), std::invalid_argument);
+}
+
+TEST(TestAdaptiveRingBufferImplementation, factory) {
+  AdaptiveBufferOptions options;
+  options.min_depth = 1;
+  options.memory_budget = 3 * 100;
+  auto factory = std::make_shared<AdaptiveBufferImplementationFactory<std::vector<char>>>(
+    options, [](const std::vector<char> & message) {return message.size();});
+
+  // The maximum depth defaults to the depth of the QoS
+  auto buffer = rclcpp::experimental::create_intra_process_buffer<std::vector<char>>(
+    rclcpp::IntraProcessBufferType::UniquePtr, rclcpp::QoS(2),
+    std::make_shared<std::allocator<void>>(),
+    rclcpp::IntraProcessBufferImplementation::Default, factory);
+  for (char i = 0; i < 3; ++i) {
+    buffer->add_unique(std::make_unique<std::vector<char>>(100, i));
+  }
+  auto metrics = buffer->get_metrics();
+  EXPECT_EQ(2u, metrics.capacity);
+  EXPECT_EQ(1u, metrics.dropped_count);
+  EXPECT_EQ(1u, metrics.resize_count);
+  EXPECT_EQ(1, buffer->consume_unique()->front());
+
+  // Each subscription gets its own buffer, the budget applying to the message sizes
+  auto shared_buffer = rclcpp::experimental::create_intra_process_buffer<std::vector<char>>(
+    rclcpp::IntraProcessBufferType::SharedPtr, rclcpp::QoS(10),
+    std::make_shared<std::allocator<void>>(),
+    rclcpp::IntraProcessBufferImplementation::Default, factory);
+  for (char i = 0; i < 5; ++i) {
+    shared_buffer->add_shared(std::make_shared<const std::vector<char>>(100, i));
+  }
+  metrics = shared_buffer->get_metrics();
+  EXPECT_EQ(4u, metrics.capacity);
+  EXPECT_EQ(3u, metrics.depth);
+  EXPECT_EQ(2u, metrics.dropped_count);
+  EXPECT_EQ(2, shared_buffer->consume_shared()->front());
+}
@@ -0,0 +1,153 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+
+#include "rclcpp/allocation_audit.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+#include "test_msgs/msg/empty.hpp"
+
+// Count the allocations of this test
+#include "rclcpp/allocation_guard_operators.hpp"
+
+using namespace std::chrono_literals;
+using rclcpp::AllocationAudit;
+using rclcpp::AllocationAuditRecord;
+using rclcpp::AllocationSite;
+
+namespace
+{
+
+// Escapes, so that the allocations can't be elided
+std::unique_ptr<int> sink;
+
+const AllocationAuditRecord *
+find_record(
+  const std::vector<AllocationAuditRecord> & records, const void * entity, AllocationSite site)
+{
+  for (const auto & record : records) {
+    if (record.entity == entity && record.site == site) {
+      return &record;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+class TestAllocationAudit : public ::testing::Test
+{
+public:
+  void SetUp()
+  {
+    AllocationAudit::reset();
+    AllocationAudit::enable();
+  }
+
+  void TearDown()
+  {
+    AllocationAudit::disable();
+    AllocationAudit::reset();
+  }
+};
+
+TEST_F(TestAllocationAudit, scopes) {
+  int publisher = 0;
+  int subscription = 0;
+  {
+    AllocationAudit::Scope callback_scope(&subscription, AllocationSite::Subscription);
+    sink.reset(new int(1));
+    {
+      AllocationAudit::Scope publish_scope(&publisher, AllocationSite::Publish);
+      {
+        // Same entity and site, counted by the enclosing scope
+        AllocationAudit::Scope nested_scope(&publisher, AllocationSite::Publish);
+        sink.reset(new int(2));
+      }
+      sink.reset(new int(3));
+    }
+  }
+  {
+    AllocationAudit::Scope callback_scope(&subscription, AllocationSite::Subscription);
+  }
+
+  const auto records = AllocationAudit::get_records();
+  ASSERT_EQ(2u, records.size());
+  const auto * publish_record = find_record(records, &publisher, AllocationSite::Publish);
+  ASSERT_NE(nullptr, publish_record);
+  EXPECT_EQ(1u, publish_record->execution_count);
+  EXPECT_EQ(2u, publish_record->allocation_count);
+  EXPECT_EQ(2 * sizeof(int), publish_record->allocated_bytes);
+  const auto * callback_record =
+    find_record(records, &subscription, AllocationSite::Subscription);
+  ASSERT_NE(nullptr, callback_record);
+  EXPECT_EQ(2u, callback_record->execution_count);
+  EXPECT_EQ(1u, callback_record->allocation_count);
+  EXPECT_EQ(3u, AllocationAudit::get_allocation_count());
+
+  EXPECT_THROW(AllocationAudit::assert_no_allocations(), std::runtime_error);
+  AllocationAudit::reset();
+  EXPECT_NO_THROW(AllocationAudit::assert_no_allocations());
+}
+
+TEST_F(TestAllocationAudit, disabled) {
+  AllocationAudit::disable();
+  EXPECT_FALSE(AllocationAudit::is_enabled());
+  int entity = 0;
+  {
+    AllocationAudit::Scope scope(&entity, AllocationSite::Timer);
+    sink.reset(new int(1));
+  }
+  {
+    AllocationAudit::Scope scope(nullptr, AllocationSite::Timer);
+  }
+  EXPECT_TRUE(AllocationAudit::get_records().empty());
+}
+
+TEST_F(TestAllocationAudit, publish_and_execute) {
+  rclcpp::init(0, nullptr);
+  {
+    auto node = std::make_shared<rclcpp::Node>("test_allocation_audit_node");
+    size_t received = 0;
+    auto subscription = node->create_subscription<test_msgs::msg::Empty>(
+      "topic", 10, [&received](const test_msgs::msg::Empty &) {received++;});
+    auto publisher = node->create_publisher<test_msgs::msg::Empty>("topic", 10);
+    rclcpp::executors::SingleThreadedExecutor executor;
+    executor.add_node(node);
+
+    const auto end = std::chrono::steady_clock::now() + 10s;
+    while (received == 0 && std::chrono::steady_clock::now() < end) {
+      publisher->publish(test_msgs::msg::Empty());
+      executor.spin_some(10ms);
+    }
+    ASSERT_GT(received, 0u);
+
+    const auto records = AllocationAudit::get_records();
+    const auto * publish_record = find_record(records, publisher.get(), AllocationSite::Publish);
+    ASSERT_NE(nullptr, publish_record);
+    EXPECT_GT(publish_record->execution_count, 0u);
+    const auto * callback_record =
+      find_record(
+      records, static_cast<rclcpp::SubscriptionBase *>(subscription.get()),
+      AllocationSite::Subscription);
+    ASSERT_NE(nullptr, callback_record);
+    EXPECT_GE(callback_record->execution_count, received);
+  }
+  rclcpp::shutdown();
+}
@@ -16,8 +16,10 @@
 
 #include <functional>
 #include <memory>
+#include <stdexcept>
 #include <string>
 #include <utility>
+#include <vector>
 
 // TODO(aprotyas): Figure out better way to suppress deprecation warnings.
 #define RCLCPP_AVOID_DEPRECATIONS_FOR_UNIT_TESTS 1
@@ -198,6 +200,18 @@ TEST_F(TestAnySubscriptionCallback, is_serialized_message_callback) {
   }
 }
 
+TEST_F(TestAnySubscriptionCallback, uses_message_info) {
+  rclcpp::AnySubscriptionCallback<test_msgs::msg::Empty> asc;
+  asc.set([](std::shared_ptr<const test_msgs::msg::Empty>) {});
+  EXPECT_FALSE(asc.uses_message_info());
+  asc.set([](const test_msgs::msg::Empty &, const rclcpp::MessageInfo &) {});
+  EXPECT_TRUE(asc.uses_message_info());
+  asc.set([](const rclcpp::SerializedMessage &) {});
+  EXPECT_FALSE(asc.uses_message_info());
+  asc.set([](const std::vector<std::shared_ptr<const test_msgs::msg::Empty>> &) {});
+  EXPECT_FALSE(asc.uses_message_info());
+}
+
 TEST_F(TestAnySubscriptionCallback, unset_dispatch_throw) {
   EXPECT_THROW(
     any_subscription_callback_.dispatch(msg_shared_ptr_, message_info_),
@@ -724,3 +738,314 @@ INSTANTIATE_TEST_SUITE_P(
   ),
   format_parameter_with_ta
 );
+
+//
+// Versions of `const std::vector<std::shared_ptr<const MessageT>> &`
+//
+void batch_free_func(const std::vector<std::shared_ptr<const test_msgs::msg::Empty>> &) {}
+
+INSTANTIATE_TEST_SUITE_P(
+  SharedConstPtrBatchCallbackTests,
+  DispatchTests,
+  ::testing::Values(
+    // lambda
+    InstanceContext{"lambda", rclcpp::AnySubscriptionCallback<test_msgs::msg::Empty>().set(
+        [](const std::vector<std::shared_ptr<const test_msgs::msg::Empty>> &) {})},
+    // free function
+    InstanceContext{"free_function", rclcpp::AnySubscriptionCallback<test_msgs::msg::Empty>().set(
+        batch_free_func)}
+  ),
+  format_parameter
+);
+
+INSTANTIATE_TEST_SUITE_P(
+  SharedConstPtrBatchTACallbackTests,
+  DispatchTestsWithTA,
+  ::testing::Values(
+    // lambda
+    InstanceContext<MyTA>{"lambda_ta", rclcpp::AnySubscriptionCallback<MyTA>().set(
+        [](const std::vector<std::shared_ptr<const MyEmpty>> &) {})}
+  ),
+  format_parameter_with_ta
+);
+
+TEST_F(TestAnySubscriptionCallback, batch_dispatch) {
+  using MessageBatch = std::vector<std::shared_ptr<const test_msgs::msg::Empty>>;
+  size_t number_of_messages = 0;
+  auto batch_callback = rclcpp::AnySubscriptionCallback<test_msgs::msg::Empty>().set(
+    [&number_of_messages](const MessageBatch & msgs) {
+      number_of_messages += msgs.size();
+    });
+  EXPECT_TRUE(batch_callback.is_batch_callback());
+  EXPECT_TRUE(batch_callback.use_take_shared_method());
+
+  MessageBatch messages(3, msg_shared_ptr_);
+  batch_callback.dispatch_intra_process_batch(messages);
+  EXPECT_EQ(3u, number_of_messages);
+  // Messages not taken from the intra-process buffer are given one at a time
+  batch_callback.dispatch(msg_shared_ptr_, message_info_);
+  EXPECT_EQ(4u, number_of_messages);
+
+  auto callback = rclcpp::AnySubscriptionCallback<test_msgs::msg::Empty>().set(
+    [](std::shared_ptr<const test_msgs::msg::Empty>) {});
+  EXPECT_FALSE(callback.is_batch_callback());
+  EXPECT_THROW(callback.dispatch_intra_process_batch(messages), std::runtime_error);
+}
+
+//
+// Versions of `rclcpp::SubscriptionLoanedMessage<MessageT>`
+//
+void loaned_free_func(rclcpp::SubscriptionLoanedMessage<test_msgs::msg::Empty>) {}
+void loaned_with_info_free_func(
+  rclcpp::SubscriptionLoanedMessage<test_msgs::msg::Empty>, const rclcpp::MessageInfo &)
+{}
+
+INSTANTIATE_TEST_SUITE_P(
+  LoanedMessageCallbackTests,
+  DispatchTests,
+  ::testing::Values(
+    // lambda
+    InstanceContext{"lambda", rclcpp::AnySubscriptionCallback<test_msgs::msg::Empty>().set(
+        [](rclcpp::SubscriptionLoanedMessage<test_msgs::msg::Empty>) {})},
+    InstanceContext{"lambda_with_info",
+      rclcpp::AnySubscriptionCallback<test_msgs::msg::Empty>().set(
+        [](rclcpp::SubscriptionLoanedMessage<test_msgs::msg::Empty>,
+        const rclcpp::MessageInfo &) {})},
+    // free function
+    InstanceContext{"free_function", rclcpp::AnySubscriptionCallback<test_msgs::msg::Empty>().set(
+        loaned_free_func)},
+    InstanceContext{"free_function_with_info",
+      rclcpp::AnySubscriptionCallback<test_msgs::msg::Empty>().set(
+        loaned_with_info_free_func)}
+  ),
+  format_parameter
+);
+
+INSTANTIATE_TEST_SUITE_P(
+  LoanedMessageTACallbackTests,
+  DispatchTestsWithTA,
+  ::testing::Values(
+    // lambda
+    InstanceContext<MyTA>{"lambda_ta", rclcpp::AnySubscriptionCallback<MyTA>().set(
+        [](rclcpp::SubscriptionLoanedMessage<test_msgs::msg::Empty>) {})}
+  ),
+  format_parameter_with_ta
+);
+
+TEST_F(TestAnySubscriptionCallback, loaned_message_dispatch) {
+  using LoanedMessage = rclcpp::SubscriptionLoanedMessage<test_msgs::msg::Empty>;
+  std::vector<LoanedMessage> kept_messages;
+  auto loaned_callback = rclcpp::AnySubscriptionCallback<test_msgs::msg::Empty>().set(
+    [&kept_messages](LoanedMessage msg) {
+      kept_messages.push_back(std::move(msg));
+    });
+  EXPECT_TRUE(loaned_callback.is_loaned_message_callback());
+  EXPECT_TRUE(loaned_callback.use_take_shared_method());
+
+  // The messages given to the callback can be kept after it returns
+  loaned_callback.dispatch_loaned_message(LoanedMessage(msg_shared_ptr_), message_info_);
+  loaned_callback.dispatch(msg_shared_ptr_, message_info_);
+  ASSERT_EQ(2u, kept_messages.size());
+  EXPECT_EQ(msg_shared_ptr_.get(), &kept_messages[0].get());
+  EXPECT_EQ(msg_shared_ptr_.get(), kept_messages[1].operator->());
+  EXPECT_FALSE(kept_messages[0].is_loaned());
+  EXPECT_EQ(3, msg_shared_ptr_.use_count());
+
+  kept_messages[0].reset();
+  EXPECT_FALSE(kept_messages[0]);
+  EXPECT_THROW(kept_messages[0].get(), std::runtime_error);
+  kept_messages.clear();
+  EXPECT_EQ(1, msg_shared_ptr_.use_count());
+
+  EXPECT_THROW(LoanedMessage(nullptr, msg_shared_ptr_.get()), std::invalid_argument);
+
+  auto callback = rclcpp::AnySubscriptionCallback<test_msgs::msg::Empty>().set(
+    [](std::shared_ptr<const test_msgs::msg::Empty>) {});
+  EXPECT_FALSE(callback.is_loaned_message_callback());
+  EXPECT_THROW(
+    callback.dispatch_loaned_message(LoanedMessage(msg_shared_ptr_), message_info_),
+    std::runtime_error);
+}
+
+//
+// Versions of `std::shared_ptr<rclcpp::LazyDeserializedMessage<MessageT>>`
+//
+using LazyEmpty = rclcpp::LazyDeserializedMessage<test_msgs::msg::Empty>;
+void lazy_free_func(std::shared_ptr<LazyEmpty>) {}
+void lazy_with_info_free_func(std::shared_ptr<LazyEmpty>, const rclcpp::MessageInfo &) {}
+
+INSTANTIATE_TEST_SUITE_P(
+  LazyMessageCallbackTests,
+  DispatchTests,
+  ::testing::Values(
+    // lambda
+    InstanceContext{"lambda", rclcpp::AnySubscriptionCallback<test_msgs::msg::Empty>().set(
+        [](std::shared_ptr<LazyEmpty>) {})},
+    InstanceContext{"lambda_with_info",
+      rclcpp::AnySubscriptionCallback<test_msgs::msg::Empty>().set(
+        [](std::shared_ptr<LazyEmpty>, const rclcpp::MessageInfo &) {})},
+    // free function
+    InstanceContext{"free_function", rclcpp::AnySubscriptionCallback<test_msgs::msg::Empty>().set(
+        lazy_free_func)},
+    InstanceContext{"free_function_with_info",
+      rclcpp::AnySubscriptionCallback<test_msgs::msg::Empty>().set(
+        lazy_with_info_free_func)}
+  ),
+  format_parameter
+);
+
+INSTANTIATE_TEST_SUITE_P(
+  LazyMessageTACallbackTests,
+  DispatchTestsWithTA,
+  ::testing::Values(
+    // lambda
+    InstanceContext<MyTA>{"lambda_ta", rclcpp::AnySubscriptionCallback<MyTA>().set(
+        [](std::shared_ptr<LazyEmpty>) {})}
+  ),
+  format_parameter_with_ta
+);
+
+TEST_F(TestAnySubscriptionCallback, lazy_message_dispatch) {
+  std::vector<std::shared_ptr<LazyEmpty>> lazy_messages;
+  auto lazy_callback = rclcpp::AnySubscriptionCallback<test_msgs::msg::Empty>().set(
+    [&lazy_messages](std::shared_ptr<LazyEmpty> msg) {
+      lazy_messages.push_back(std::move(msg));
+    });
+  EXPECT_TRUE(lazy_callback.is_lazy_message_callback());
+  // The messages are taken serialized
+  EXPECT_TRUE(lazy_callback.is_serialized_message_callback());
+
+  auto serialized_message = std::make_shared<rclcpp::SerializedMessage>();
+  lazy_callback.dispatch(serialized_message, message_info_);
+  ASSERT_EQ(1u, lazy_messages.size());
+  EXPECT_EQ(serialized_message, lazy_messages[0]->get_serialized_message());
+  EXPECT_FALSE(lazy_messages[0]->is_deserialized());
+
+  // The messages received deserialized are shared
+  lazy_callback.dispatch(msg_shared_ptr_, message_info_);
+  lazy_callback.dispatch_intra_process(
+    std::shared_ptr<const test_msgs::msg::Empty>(msg_shared_ptr_), message_info_);
+  ASSERT_EQ(3u, lazy_messages.size());
+  EXPECT_TRUE(lazy_messages[1]->is_deserialized());
+  EXPECT_EQ(msg_shared_ptr_, lazy_messages[1]->get_message());
+  EXPECT_EQ(msg_shared_ptr_, lazy_messages[2]->get_message());
+  EXPECT_EQ(nullptr, lazy_messages[2]->get_serialized_message());
+
+  auto callback = rclcpp::AnySubscriptionCallback<test_msgs::msg::Empty>().set(
+    [](std::shared_ptr<const test_msgs::msg::Empty>) {});
+  EXPECT_FALSE(callback.is_lazy_message_callback());
+}
+
+//
+// Versions of `rclcpp::LocalMessagePtr<MessageT>`
+//
+using LocalEmpty = rclcpp::LocalMessagePtr<test_msgs::msg::Empty>;
+void local_free_func(LocalEmpty) {}
+void local_with_info_free_func(LocalEmpty, const rclcpp::MessageInfo &) {}
+
+INSTANTIATE_TEST_SUITE_P(
+  LocalMessageCallbackTests,
+  DispatchTests,
+  ::testing::Values(
+    // lambda
+    InstanceContext{"lambda", rclcpp::AnySubscriptionCallback<test_msgs::msg::Empty>().set(
+        [](LocalEmpty) {})},
+    InstanceContext{"lambda_with_info",
+      rclcpp::AnySubscriptionCallback<test_msgs::msg::Empty>().set(
+        [](LocalEmpty, const rclcpp::MessageInfo &) {})},
+    // free function
+    InstanceContext{"free_function", rclcpp::AnySubscriptionCallback<test_msgs::msg::Empty>().set(
+        local_free_func)},
+    InstanceContext{"free_function_with_info",
+      rclcpp::AnySubscriptionCallback<test_msgs::msg::Empty>().set(
+        local_with_info_free_func)}
+  ),
+  format_parameter
+);
+
+INSTANTIATE_TEST_SUITE_P(
+  LocalMessageTACallbackTests,
+  DispatchTestsWithTA,
+  ::testing::Values(
+    // lambda
+    InstanceContext<MyTA>{"lambda_ta", rclcpp::AnySubscriptionCallback<MyTA>().set(
+        [](LocalEmpty) {})}
+  ),
+  format_parameter_with_ta
+);
+
+TEST_F(TestAnySubscriptionCallback, local_message_dispatch) {
+  std::vector<LocalEmpty> kept_messages;
+  auto local_callback = rclcpp::AnySubscriptionCallback<test_msgs::msg::Empty>().set(
+    [&kept_messages](LocalEmpty msg) {
+      // The copies only count their references locally
+      kept_messages.push_back(msg);
+      kept_messages.push_back(msg);
+    });
+  EXPECT_TRUE(local_callback.is_local_message_callback());
+  EXPECT_TRUE(local_callback.use_take_shared_method());
+
+  // The messages received shared are shared, without being copied
+  local_callback.dispatch(msg_shared_ptr_, message_info_);
+  local_callback.dispatch_intra_process(
+    std::shared_ptr<const test_msgs::msg::Empty>(msg_shared_ptr_), message_info_);
+  ASSERT_EQ(4u, kept_messages.size());
+  EXPECT_EQ(msg_shared_ptr_.get(), kept_messages[0].get());
+  EXPECT_EQ(msg_shared_ptr_.get(), kept_messages[2].operator->());
+  EXPECT_EQ(2u, kept_messages[0].use_count());
+  EXPECT_EQ(3, msg_shared_ptr_.use_count());
+
+  // The messages received owned are owned by the handles
+  auto unique_message = get_unique_ptr_msg();
+  auto unique_message_ptr = unique_message.get();
+  local_callback.dispatch_intra_process(std::move(unique_message), message_info_);
+  ASSERT_EQ(6u, kept_messages.size());
+  EXPECT_EQ(unique_message_ptr, kept_messages[4].get());
+
+  // The messages can be shared with other threads, still without a copy
+  auto shared = kept_messages[4].get_shared();
+  EXPECT_EQ(unique_message_ptr, shared.get());
+  EXPECT_EQ(shared, kept_messages[5].get_shared());
+  kept_messages.clear();
+  EXPECT_EQ(1, shared.use_count());
+  EXPECT_EQ(1, msg_shared_ptr_.use_count());
+
+  LocalEmpty handle(msg_shared_ptr_);
+  LocalEmpty moved(std::move(handle));
+  EXPECT_FALSE(handle);
+  EXPECT_EQ(0u, handle.use_count());
+  EXPECT_EQ(nullptr, handle.get_shared());
+  handle = moved;
+  EXPECT_EQ(2u, moved.use_count());
+  moved.reset();
+  EXPECT_FALSE(moved);
+  EXPECT_EQ(1u, handle.use_count());
+  EXPECT_FALSE(LocalEmpty(std::shared_ptr<const test_msgs::msg::Empty>()));
+
+  auto callback = rclcpp::AnySubscriptionCallback<test_msgs::msg::Empty>().set(
+    [](std::shared_ptr<const test_msgs::msg::Empty>) {});
+  EXPECT_FALSE(callback.is_local_message_callback());
+}
+
+TEST_F(TestAnySubscriptionCallback, dispatch_after_variant_change) {
+  size_t shared_count = 0;
+  size_t const_ref_count = 0;
+  auto callback = rclcpp::AnySubscriptionCallback<test_msgs::msg::Empty>().set(
+    [&shared_count](std::shared_ptr<const test_msgs::msg::Empty>) {++shared_count;});
+  callback.dispatch(msg_shared_ptr_, message_info_);
+  callback.dispatch_intra_process(get_unique_ptr_msg(), message_info_);
+  EXPECT_EQ(2u, shared_count);
+
+  // The dispatch is resolved again for a callback changed through the variant
+  using ConstRefCallback = std::function<void (const test_msgs::msg::Empty &)>;
+  callback.get_variant() = ConstRefCallback(
+    [&const_ref_count](const test_msgs::msg::Empty &) {++const_ref_count;});
+  callback.dispatch(msg_shared_ptr_, message_info_);
+  callback.dispatch_intra_process(
+    std::shared_ptr<const test_msgs::msg::Empty>(msg_shared_ptr_), message_info_);
+  EXPECT_EQ(2u, shared_count);
+  EXPECT_EQ(2u, const_ref_count);
+
+  callback.get_variant() = ConstRefCallback();
+  EXPECT_THROW(callback.dispatch(msg_shared_ptr_, message_info_), std::runtime_error);
+}
@@ -0,0 +1,260 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/detail/async_logging_backend.hpp"
+
+using rclcpp::detail::AsyncLoggingBackend;
+
+namespace
+{
+
+struct WrittenLog
+{
+  int severity;
+  std::string name;
+  std::string message;
+};
+
+std::mutex g_written_mutex;
+std::vector<WrittenLog> g_written;
+
+void
+record_log(
+  const rcutils_log_location_t *, int severity, const char * name,
+  rcutils_time_point_value_t, const char * format, va_list * args)
+{
+  char message[2048];
+  std::vsnprintf(message, sizeof(message), format, *args);
+  std::lock_guard<std::mutex> lock(g_written_mutex);
+  g_written.push_back({severity, name, message});
+}
+
+std::vector<WrittenLog>
+take_written()
+{
+  std::lock_guard<std::mutex> lock(g_written_mutex);
+  std::vector<WrittenLog> written;
+  written.swap(g_written);
+  return written;
+}
+
+bool
+log(AsyncLoggingBackend & backend, int severity, const char * name, const char * format, ...)
+{
+  static rcutils_log_location_t location = {"log", __FILE__, __LINE__};
+  rcutils_time_point_value_t now = 0;
+  EXPECT_EQ(RCUTILS_RET_OK, rcutils_system_time_now(&now));
+  va_list args;
+  va_start(args, format);
+  const bool buffered = backend.enqueue(&location, severity, name, now, format, &args);
+  va_end(args);
+  return buffered;
+}
+
+rclcpp::AsyncLoggingOptions
+make_options(size_t depth, std::chrono::milliseconds flush_period = std::chrono::hours(1))
+{
+  rclcpp::AsyncLoggingOptions options;
+  options.depth = depth;
+  options.flush_period = flush_period;
+  return options;
+}
+
+}  // namespace
+
+class TestAsyncLoggingBackend : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    take_written();
+    backend = std::make_unique<AsyncLoggingBackend>(logging_mutex);
+  }
+
+  void TearDown() override
+  {
+    backend.reset();
+    take_written();
+  }
+
+  std::shared_ptr<std::recursive_mutex> logging_mutex = std::make_shared<std::recursive_mutex>();
+  std::unique_ptr<AsyncLoggingBackend> backend;
+};
+
+TEST_F(TestAsyncLoggingBackend, invalid_arguments) {
+  EXPECT_THROW(AsyncLoggingBackend(nullptr), std::invalid_argument);
+  EXPECT_THROW(backend->start(make_options(1), nullptr), std::invalid_argument);
+  EXPECT_FALSE(backend->is_started());
+}
+
+TEST_F(TestAsyncLoggingBackend, disabled) {
+  backend->start(make_options(0), record_log);
+  EXPECT_FALSE(backend->is_started());
+  EXPECT_FALSE(log(*backend, RCUTILS_LOG_SEVERITY_INFO, "logger", "not buffered"));
+  // Returns right away
+  backend->flush();
+  EXPECT_TRUE(take_written().empty());
+}
+
+TEST_F(TestAsyncLoggingBackend, flush) {
+  backend->start(make_options(8), record_log);
+  ASSERT_TRUE(backend->is_started());
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(log(*backend, RCUTILS_LOG_SEVERITY_INFO, "logger", "message %d", i));
+  }
+  // Fatal messages are written by the caller
+  EXPECT_FALSE(log(*backend, RCUTILS_LOG_SEVERITY_FATAL, "logger", "fatal"));
+  backend->flush();
+
+  auto written = take_written();
+  ASSERT_EQ(3u, written.size());
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(RCUTILS_LOG_SEVERITY_INFO, written[i].severity);
+    EXPECT_EQ("logger", written[i].name);
+    EXPECT_EQ("message " + std::to_string(i), written[i].message);
+  }
+  auto statistics = backend->get_statistics();
+  EXPECT_EQ(3u, statistics.enqueued_count);
+  EXPECT_EQ(3u, statistics.written_count);
+  EXPECT_EQ(0u, statistics.dropped_count);
+  EXPECT_EQ(0u, statistics.truncated_count);
+}
+
+TEST_F(TestAsyncLoggingBackend, flush_period) {
+  backend->start(make_options(8, std::chrono::milliseconds(1)), record_log);
+  EXPECT_TRUE(log(*backend, RCUTILS_LOG_SEVERITY_WARN, "logger", "periodic"));
+  auto start = std::chrono::steady_clock::now();
+  while (backend->get_statistics().written_count == 0u &&
+    std::chrono::steady_clock::now() - start < std::chrono::seconds(10))
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  auto written = take_written();
+  ASSERT_EQ(1u, written.size());
+  EXPECT_EQ("periodic", written[0].message);
+}
+
+TEST_F(TestAsyncLoggingBackend, stop_with_logging_mutex_held) {
+  backend->start(make_options(8), record_log);
+  EXPECT_TRUE(log(*backend, RCUTILS_LOG_SEVERITY_INFO, "logger", "written on stop"));
+  {
+    std::lock_guard<std::recursive_mutex> guard(*logging_mutex);
+    backend->stop();
+  }
+  EXPECT_FALSE(backend->is_started());
+  EXPECT_FALSE(log(*backend, RCUTILS_LOG_SEVERITY_INFO, "logger", "not buffered"));
+
+  auto written = take_written();
+  ASSERT_EQ(1u, written.size());
+  EXPECT_EQ("written on stop", written[0].message);
+  EXPECT_EQ(1u, backend->get_statistics().enqueued_count);
+
+  // Restarted with new buffers, the statistics are kept
+  backend->start(make_options(8), record_log);
+  EXPECT_TRUE(log(*backend, RCUTILS_LOG_SEVERITY_INFO, "logger", "restarted"));
+  backend->flush();
+  written = take_written();
+  ASSERT_EQ(1u, written.size());
+  EXPECT_EQ("restarted", written[0].message);
+  EXPECT_EQ(2u, backend->get_statistics().written_count);
+}
+
+TEST_F(TestAsyncLoggingBackend, drop_when_full) {
+  backend->start(make_options(2), record_log);
+  {
+    // The background thread can't write while the logging mutex is held
+    std::lock_guard<std::recursive_mutex> guard(*logging_mutex);
+    for (int i = 0; i < 5; ++i) {
+      EXPECT_TRUE(log(*backend, RCUTILS_LOG_SEVERITY_INFO, "logger", "message %d", i));
+    }
+    auto statistics = backend->get_statistics();
+    EXPECT_EQ(2u, statistics.enqueued_count);
+    EXPECT_EQ(3u, statistics.dropped_count);
+  }
+  backend->flush();
+
+  auto written = take_written();
+  ASSERT_EQ(3u, written.size());
+  EXPECT_EQ("message 0", written[0].message);
+  EXPECT_EQ("message 1", written[1].message);
+  EXPECT_EQ(RCUTILS_LOG_SEVERITY_WARN, written[2].severity);
+  EXPECT_EQ("rclcpp", written[2].name);
+  EXPECT_EQ(0u, written[2].message.find("3 log messages were dropped"));
+}
+
+TEST_F(TestAsyncLoggingBackend, truncated) {
+  backend->start(make_options(4), record_log);
+  const std::string long_name(AsyncLoggingBackend::max_name_size, 'n');
+  const std::string long_message(AsyncLoggingBackend::max_message_size, 'm');
+  EXPECT_TRUE(log(*backend, RCUTILS_LOG_SEVERITY_INFO, long_name.c_str(), "short"));
+  EXPECT_TRUE(log(*backend, RCUTILS_LOG_SEVERITY_INFO, "logger", "%s", long_message.c_str()));
+  backend->flush();
+
+  auto written = take_written();
+  ASSERT_EQ(2u, written.size());
+  EXPECT_EQ(long_name.substr(0, AsyncLoggingBackend::max_name_size - 1), written[0].name);
+  EXPECT_EQ(long_message.substr(0, AsyncLoggingBackend::max_message_size - 1), written[1].message);
+  EXPECT_EQ(2u, backend->get_statistics().truncated_count);
+}
+
+TEST_F(TestAsyncLoggingBackend, threads) {
+  constexpr int thread_count = 4;
+  constexpr int message_count = 100;
+  backend->start(make_options(message_count), record_log);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < thread_count; ++t) {
+    threads.emplace_back(
+      [this, t]() {
+        const std::string name = "thread_" + std::to_string(t);
+        for (int i = 0; i < message_count; ++i) {
+          log(*backend, RCUTILS_LOG_SEVERITY_INFO, name.c_str(), "%d", i);
+        }
+      });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  backend->flush();
+
+  auto written = take_written();
+  auto statistics = backend->get_statistics();
+  EXPECT_EQ(statistics.enqueued_count, written.size());
+  EXPECT_EQ(written.size(), statistics.written_count);
+  EXPECT_EQ(
+    static_cast<uint64_t>(thread_count * message_count),
+    statistics.enqueued_count + statistics.dropped_count);
+  // The messages of each thread keep their order
+  std::vector<int> next(thread_count, -1);
+  for (const auto & entry : written) {
+    const int t = std::stoi(entry.name.substr(entry.name.find('_') + 1));
+    const int i = std::stoi(entry.message);
+    EXPECT_LT(next[t], i);
+    next[t] = i;
+  }
+
+  // The buffers of the exited threads are removed once written, their counts are kept
+  backend->flush();
+  EXPECT_EQ(statistics.enqueued_count, backend->get_statistics().enqueued_count);
+}
@@ -14,9 +14,13 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <future>
 #include <string>
 #include <memory>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include "rclcpp/exceptions.hpp"
 #include "rclcpp/rclcpp.hpp"
@@ -26,6 +30,7 @@
 #include "../mocking_utils/patch.hpp"
 #include "../utils/rclcpp_gtest_macros.hpp"
 
+#include "test_msgs/srv/basic_types.hpp"
 #include "test_msgs/srv/empty.hpp"
 
 using namespace std::chrono_literals;
@@ -202,6 +207,36 @@ TEST_F(TestClient, wait_for_service) {
   EXPECT_TRUE(client->service_is_ready());
 }
 
+TEST_F(TestClient, wait_for_service_many_waiters) {
+  const std::string service_name = "shared_service";
+  auto other_client = node->create_client<test_msgs::srv::Empty>("other_service");
+  std::vector<rclcpp::Client<test_msgs::srv::Empty>::SharedPtr> clients;
+  std::vector<std::thread> threads;
+  std::atomic_size_t ready_count(0);
+  for (size_t i = 0; i < 4; ++i) {
+    clients.push_back(node->create_client<test_msgs::srv::Empty>(service_name));
+    threads.emplace_back(
+      [client = clients.back(), &ready_count]() {
+        if (client->wait_for_service(std::chrono::seconds(10))) {
+          ready_count++;
+        }
+      });
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(0u, ready_count.load());
+
+  auto callback = [](
+    const test_msgs::srv::Empty::Request::SharedPtr,
+    test_msgs::srv::Empty::Response::SharedPtr) {};
+  auto service =
+    node->create_service<test_msgs::srv::Empty>(service_name, std::move(callback));
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(4u, ready_count.load());
+  EXPECT_FALSE(other_client->wait_for_service(std::chrono::milliseconds(10)));
+}
+
 /*
    Testing client construction and destruction for subnodes.
  */
@@ -327,6 +362,89 @@ TEST_F(TestClientWithServer, test_client_remove_pending_request) {
   EXPECT_TRUE(client->remove_pending_request(future));
 }
 
+TEST_F(TestClientWithServer, async_send_request_batch) {
+  using SharedBatchFuture = rclcpp::Client<test_msgs::srv::Empty>::SharedBatchFuture;
+
+  auto client = node->create_client<test_msgs::srv::Empty>(service_name);
+  ASSERT_TRUE(client->wait_for_service(std::chrono::seconds(1)));
+  client->set_max_outstanding_requests(2);
+  EXPECT_EQ(2u, client->get_max_outstanding_requests());
+
+  std::vector<test_msgs::srv::Empty::Request::SharedPtr> requests;
+  for (size_t i = 0; i < 5; ++i) {
+    requests.push_back(std::make_shared<test_msgs::srv::Empty::Request>());
+  }
+  bool called = false;
+  auto future = client->async_send_request_batch(
+    requests, [&called](SharedBatchFuture) {called = true;});
+  // The requests beyond the window wait for the responses
+  EXPECT_EQ(3u, client->get_queued_request_count());
+
+  auto start = std::chrono::steady_clock::now();
+  while (!called && (std::chrono::steady_clock::now() - start) < 5s) {
+    rclcpp::spin_some(node);
+  }
+  ASSERT_TRUE(called);
+  auto responses = future.get();
+  ASSERT_EQ(5u, responses.size());
+  for (const auto & response : responses) {
+    EXPECT_NE(nullptr, response);
+  }
+  EXPECT_EQ(0u, client->get_queued_request_count());
+
+  // The requests removed before their response leave a nullptr response
+  future = client->async_send_request_batch(requests);
+  EXPECT_EQ(2u, client->prune_pending_requests());
+  responses = future.get();
+  ASSERT_EQ(5u, responses.size());
+  EXPECT_EQ(nullptr, responses[0]);
+  EXPECT_TRUE(client->async_send_request_batch({}).get().empty());
+}
+
+TEST_F(TestClientWithServer, async_send_request_timeout) {
+  using SharedFuture = rclcpp::Client<test_msgs::srv::Empty>::SharedFuture;
+
+  // The node isn't spun, so the service never responds
+  auto client = node->create_client<test_msgs::srv::Empty>(service_name);
+  auto request = std::make_shared<test_msgs::srv::Empty::Request>();
+  auto future = client->async_send_request(request, 10ms);
+  ASSERT_EQ(std::future_status::ready, future.wait_for(5s));
+  EXPECT_THROW(future.get(), rclcpp::exceptions::RequestTimeoutError);
+  EXPECT_FALSE(client->remove_pending_request(future.request_id));
+
+  // The callback is called with the failed future
+  std::promise<SharedFuture> called;
+  auto shared_future = client->async_send_request(
+    request, [&called](SharedFuture future) {called.set_value(future);}, 10ms);
+  auto called_future = called.get_future();
+  ASSERT_EQ(std::future_status::ready, called_future.wait_for(5s));
+  EXPECT_THROW(called_future.get().get(), rclcpp::exceptions::RequestTimeoutError);
+
+  // The timeout of the client applies to the batched requests as well
+  EXPECT_EQ(0ns, client->get_request_timeout());
+  client->set_request_timeout(10ms);
+  EXPECT_EQ(10ms, client->get_request_timeout());
+  auto batch_future = client->async_send_request_batch({request, request});
+  ASSERT_EQ(std::future_status::ready, batch_future.wait_for(5s));
+  auto responses = batch_future.get();
+  ASSERT_EQ(2u, responses.size());
+  EXPECT_EQ(nullptr, responses[0]);
+  EXPECT_EQ(nullptr, responses[1]);
+
+  // A request answered before its timeout completes normally
+  client->set_request_timeout(10s);
+  ASSERT_TRUE(client->wait_for_service(1s));
+  future = client->async_send_request(request);
+  auto start = std::chrono::steady_clock::now();
+  while (future.wait_for(0s) != std::future_status::ready &&
+    (std::chrono::steady_clock::now() - start) < 5s)
+  {
+    rclcpp::spin_some(node);
+  }
+  ASSERT_EQ(std::future_status::ready, future.wait_for(0s));
+  EXPECT_NE(nullptr, future.get());
+}
+
 TEST_F(TestClientWithServer, prune_requests_older_than_no_pruned) {
   auto client = node->create_client<test_msgs::srv::Empty>(service_name);
   auto request = std::make_shared<test_msgs::srv::Empty::Request>();
@@ -601,3 +719,40 @@ TEST_F(TestClient, client_qos_depth) {
 
   EXPECT_EQ(client_cb_count_, client_qos_profile.depth());
 }
+
+TEST_F(TestClient, intra_process_request) {
+  using test_msgs::srv::BasicTypes;
+  auto options = rclcpp::NodeOptions().use_intra_process_comms(true);
+  auto ipc_node = std::make_shared<rclcpp::Node>("ipc_node", "ns", options);
+
+  BasicTypes::Request::SharedPtr received_request;
+  auto service = ipc_node->create_service<BasicTypes>(
+    "ipc_service",
+    [&received_request](
+      const BasicTypes::Request::SharedPtr request,
+      BasicTypes::Response::SharedPtr response) {
+      received_request = request;
+      response->int64_value = request->int64_value + 1;
+    });
+  ASSERT_NE(nullptr, service->get_intra_process_waitable());
+
+  auto client = ipc_node->create_client<BasicTypes>("ipc_service");
+  ASSERT_NE(nullptr, client->get_intra_process_waitable());
+
+  auto request = std::make_shared<BasicTypes::Request>();
+  request->int64_value = 41;
+  auto future = client->async_send_request(request);
+  ASSERT_EQ(
+    rclcpp::FutureReturnCode::SUCCESS,
+    rclcpp::spin_until_future_complete(ipc_node, future, std::chrono::seconds(5)));
+  // The request was given by pointer, not copied through the middleware
+  EXPECT_EQ(request, received_request);
+  EXPECT_EQ(42, future.get()->int64_value);
+  EXPECT_FALSE(client->remove_pending_request(future.request_id));
+
+  // Without a service in the same context, the request goes through the middleware
+  auto other_client = ipc_node->create_client<BasicTypes>("no_ipc_service");
+  auto other_future = other_client->async_send_request(request);
+  EXPECT_GT(other_future.request_id, 0);
+  EXPECT_TRUE(other_client->remove_pending_request(other_future));
+}
@@ -0,0 +1,141 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rclcpp/content_filter.hpp"
+#include "rclcpp/serialization.hpp"
+#include "rclcpp/serialized_message.hpp"
+
+#include "rosidl_typesupport_cpp/message_type_support.hpp"
+
+#include "test_msgs/msg/basic_types.hpp"
+#include "test_msgs/msg/nested.hpp"
+#include "test_msgs/msg/strings.hpp"
+#include "test_msgs/msg/unbounded_sequences.hpp"
+
+template<typename MessageT>
+rclcpp::ContentFilter
+make_filter(
+  const std::string & filter_expression,
+  const std::vector<std::string> & expression_parameters = {})
+{
+  return rclcpp::ContentFilter(
+    {filter_expression, expression_parameters},
+    rosidl_typesupport_cpp::get_message_type_support_handle<MessageT>());
+}
+
+template<typename MessageT>
+bool
+matches(
+  const std::string & filter_expression,
+  const MessageT & message,
+  const std::vector<std::string> & expression_parameters = {})
+{
+  auto content_filter = make_filter<MessageT>(filter_expression, expression_parameters);
+  return content_filter.matches(&message);
+}
+
+TEST(TestContentFilter, comparisons) {
+  test_msgs::msg::BasicTypes message;
+  message.int32_value = -3;
+  message.uint64_value = 18446744073709551615u;
+  message.float64_value = 2.5;
+  message.bool_value = true;
+
+  EXPECT_TRUE(matches("int32_value = -3", message));
+  EXPECT_FALSE(matches("int32_value <> -3", message));
+  EXPECT_TRUE(matches("int32_value != 3 AND int32_value < 0", message));
+  EXPECT_TRUE(matches("float64_value > 2 AND float64_value <= 2.5", message));
+  EXPECT_TRUE(matches("uint64_value > 9223372036854775807", message));
+  EXPECT_TRUE(matches("bool_value = TRUE and bool_value <> false", message));
+  EXPECT_TRUE(matches("float64_value > int32_value", message));
+  EXPECT_TRUE(matches("0 > int32_value", message));
+  EXPECT_TRUE(matches("int32_value BETWEEN -5 AND 0", message));
+  EXPECT_FALSE(matches("int32_value NOT BETWEEN %0 AND %1", message, {"-5", "0"}));
+  EXPECT_TRUE(matches("int32_value = 1 OR int32_value = -3 AND bool_value = TRUE", message));
+  EXPECT_FALSE(matches("(int32_value = 1 OR int32_value = -3) AND bool_value = FALSE", message));
+  EXPECT_TRUE(matches("NOT (int32_value = 1 OR float64_value = 1)", message));
+}
+
+TEST(TestContentFilter, strings) {
+  test_msgs::msg::Strings message;
+  message.string_value = "base_link";
+
+  EXPECT_TRUE(matches("string_value = 'base_link'", message));
+  EXPECT_TRUE(matches("string_value = %0", message, {"'base_link'"}));
+  EXPECT_TRUE(matches("string_value > 'a'", message));
+  EXPECT_TRUE(matches("string_value LIKE 'base%'", message));
+  EXPECT_TRUE(matches("string_value like '_ase_%k'", message));
+  EXPECT_FALSE(matches("string_value LIKE 'base'", message));
+  EXPECT_FALSE(matches("string_value NOT LIKE '%link'", message));
+}
+
+TEST(TestContentFilter, fields) {
+  test_msgs::msg::Nested nested;
+  nested.basic_types_value.int16_value = 7;
+  EXPECT_TRUE(matches("basic_types_value.int16_value = 7", nested));
+
+  test_msgs::msg::UnboundedSequences sequences;
+  sequences.int32_values = {1, 2};
+  sequences.bool_values = {false, true};
+  sequences.string_values = {"x", "yz"};
+  EXPECT_TRUE(matches("int32_values[1] = 2 AND bool_values[1] = TRUE", sequences));
+  EXPECT_TRUE(matches("string_values[0] = 'x'", sequences));
+  // An element beyond the size of the sequence doesn't match
+  EXPECT_FALSE(matches("int32_values[2] = 0", sequences));
+  EXPECT_FALSE(matches("int32_values[2] <> 0", sequences));
+}
+
+TEST(TestContentFilter, invalid_expressions) {
+  using MessageT = test_msgs::msg::UnboundedSequences;
+  for (const auto & expression : {
+      "", "unknown = 1", "int32_values = 1", "int32_values[0] = '1'", "alignment_check LIKE 'a'",
+      "1 = 1", "int32_values[0] = 1 AND", "(int32_values[0] = 1", "int32_values[0] = 1)",
+      "int32_values[0] ~ 1", "int32_values[0] BETWEEN 1 2", "int32_values[0] = %0",
+      "string_values[0] = 'x", "alignment_check[0] = 1", "basic_types_values[0] = 1"})
+  {
+    EXPECT_THROW(make_filter<MessageT>(expression), std::invalid_argument) << expression;
+  }
+  // The parameters are literals, the strings are quoted
+  EXPECT_THROW(
+    make_filter<MessageT>("string_values[0] = %0", {"x"}), std::invalid_argument);
+  EXPECT_THROW(make_filter<MessageT>("alignment_check = %0", {"1 2"}), std::invalid_argument);
+  EXPECT_THROW(
+    rclcpp::ContentFilter({"alignment_check = 1", {}}, nullptr), std::invalid_argument);
+}
+
+TEST(TestContentFilter, serialized_message) {
+  test_msgs::msg::Strings message;
+  message.string_value = "base_link";
+  message.bounded_string_value = "map";
+  rclcpp::Serialization<test_msgs::msg::Strings> serialization;
+  rclcpp::SerializedMessage serialized_message;
+  serialization.serialize_message(&message, &serialized_message);
+
+  auto content_filter = make_filter<test_msgs::msg::Strings>(
+    "string_value = 'base_link' AND bounded_string_value LIKE 'm%'");
+  EXPECT_TRUE(content_filter.matches(serialized_message));
+
+  message.bounded_string_value = "odom";
+  serialization.serialize_message(&message, &serialized_message);
+  EXPECT_FALSE(content_filter.matches(serialized_message));
+  EXPECT_EQ(
+    "string_value = 'base_link' AND bounded_string_value LIKE 'm%'",
+    content_filter.get_options().filter_expression);
+}
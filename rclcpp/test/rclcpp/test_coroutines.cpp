@@ -0,0 +1,129 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include "rclcpp/experimental/coroutines.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+#include "test_msgs/srv/empty.hpp"
+
+using namespace std::chrono_literals;
+
+class TestCoroutines : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    rclcpp::init(0, nullptr);
+    node_ = std::make_shared<rclcpp::Node>("test_coroutines", "ns");
+    executor_.add_node(node_);
+  }
+
+  void TearDown() override
+  {
+    executor_.remove_node(node_);
+    node_.reset();
+    rclcpp::shutdown();
+  }
+
+  template<typename PredicateT>
+  void spin_until(PredicateT predicate)
+  {
+    auto end = std::chrono::steady_clock::now() + 5s;
+    while (!predicate() && std::chrono::steady_clock::now() < end) {
+      executor_.spin_once(10ms);
+    }
+  }
+
+  rclcpp::Node::SharedPtr node_;
+  rclcpp::executors::SingleThreadedExecutor executor_;
+};
+
+TEST_F(TestCoroutines, async_sleep_for) {
+  bool started = false;
+  bool done = false;
+  std::thread::id resumed_in;
+  auto coroutine =
+    [this, &started, &done, &resumed_in]() -> rclcpp::experimental::Task {
+      started = true;
+      co_await rclcpp::experimental::async_sleep_for(node_, 10ms);
+      resumed_in = std::this_thread::get_id();
+      done = true;
+    };
+
+  auto start = std::chrono::steady_clock::now();
+  coroutine();
+  // The coroutine runs until its first suspension point
+  EXPECT_TRUE(started);
+  EXPECT_FALSE(done);
+
+  spin_until([&done]() {return done;});
+  EXPECT_TRUE(done);
+  EXPECT_GE(std::chrono::steady_clock::now() - start, 10ms);
+  // Resumed by the executor, in the spinning thread
+  EXPECT_EQ(std::this_thread::get_id(), resumed_in);
+}
+
+TEST_F(TestCoroutines, yield_to_executor) {
+  size_t iterations = 0;
+  size_t timer_calls = 0;
+  auto timer = node_->create_wall_timer(0ms, [&timer_calls]() {timer_calls++;});
+  auto coroutine =
+    [this, &iterations]() -> rclcpp::experimental::Task {
+      for (; iterations < 10; ++iterations) {
+        co_await rclcpp::experimental::async_sleep_for(node_, 0ms);
+      }
+    };
+
+  coroutine();
+  spin_until([&iterations]() {return iterations == 10;});
+  EXPECT_EQ(10u, iterations);
+  // Other callbacks ran while the coroutine was suspended
+  EXPECT_GT(timer_calls, 0u);
+}
+
+TEST_F(TestCoroutines, async_send_request) {
+  using test_msgs::srv::Empty;
+  size_t requests = 0;
+  auto service = node_->create_service<Empty>(
+    "service",
+    [&requests](
+      const Empty::Request::SharedPtr, Empty::Response::SharedPtr) {requests++;});
+  auto client = node_->create_client<Empty>("service");
+  ASSERT_TRUE(client->wait_for_service(5s));
+
+  size_t responses = 0;
+  auto coroutine =
+    [&client, &responses]() -> rclcpp::experimental::Task {
+      for (size_t i = 0; i < 3; ++i) {
+        auto response = co_await rclcpp::experimental::async_send_request(
+          client, std::make_shared<Empty::Request>());
+        if (response) {
+          responses++;
+        }
+      }
+    };
+
+  // Sequential requests are served by the thread the coroutine is waiting in
+  coroutine();
+  spin_until([&responses]() {return responses == 3;});
+  EXPECT_EQ(3u, requests);
+  EXPECT_EQ(3u, responses);
+  EXPECT_EQ(0u, client->prune_pending_requests());
+}
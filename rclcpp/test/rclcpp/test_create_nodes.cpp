@@ -0,0 +1,76 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rclcpp/create_nodes.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+class TestCreateNodes : public ::testing::Test
+{
+protected:
+  static void SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  static void TearDownTestCase()
+  {
+    rclcpp::shutdown();
+  }
+};
+
+TEST_F(TestCreateNodes, create_nodes) {
+  std::vector<rclcpp::NodeCreationRequest> requests;
+  for (size_t i = 0; i < 20; ++i) {
+    rclcpp::NodeOptions options;
+    options.parameter_overrides({{"index", static_cast<int64_t>(i)}});
+    requests.push_back({"node_" + std::to_string(i), "ns", options});
+  }
+
+  rclcpp::NodeStartupProfile profile;
+  auto nodes = rclcpp::create_nodes(requests, 4, &profile);
+  ASSERT_EQ(20u, nodes.size());
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    ASSERT_NE(nullptr, nodes[i]);
+    EXPECT_EQ("node_" + std::to_string(i), nodes[i]->get_name());
+    EXPECT_EQ("/ns", std::string(nodes[i]->get_namespace()));
+    EXPECT_EQ(
+      static_cast<int64_t>(i), nodes[i]->declare_parameter<int64_t>("index", -1));
+  }
+
+  EXPECT_EQ(20u, profile.number_of_nodes);
+  EXPECT_GT(profile.wall_time.count(), 0);
+  EXPECT_GT(profile.node_base.count(), 0);
+  EXPECT_GT(profile.parameters.count(), 0);
+  EXPECT_GE(
+    profile.construction,
+    profile.node_base + profile.graph + profile.parameters + profile.time_source);
+  EXPECT_NE(std::string::npos, rclcpp::to_string(profile).find("nodes: 20"));
+
+  EXPECT_TRUE(rclcpp::create_nodes({}).empty());
+}
+
+TEST_F(TestCreateNodes, invalid_node_name) {
+  std::vector<rclcpp::NodeCreationRequest> requests;
+  requests.push_back({"valid_node", "", rclcpp::NodeOptions()});
+  requests.push_back({"invalid node", "", rclcpp::NodeOptions()});
+  EXPECT_THROW(
+    rclcpp::create_nodes(requests, 2),
+    rclcpp::exceptions::InvalidNodeNameError);
+}
@@ -0,0 +1,84 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "rclcpp/deserialization_thread_pool.hpp"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+TEST(TestDeserializationThreadPool, run_jobs) {
+  std::atomic<size_t> count{0};
+  {
+    rclcpp::DeserializationThreadPool thread_pool(3);
+    EXPECT_EQ(3u, thread_pool.get_number_of_threads());
+    for (size_t i = 0; i < 1000; ++i) {
+      thread_pool.post([&count]() {count++;});
+    }
+    // A throwing job doesn't stop its worker thread
+    thread_pool.post([]() {throw std::runtime_error("failed job");});
+    EXPECT_THROW(thread_pool.post(nullptr), std::invalid_argument);
+  }
+  // The queued jobs are run before the worker threads are joined
+  EXPECT_EQ(1000u, count.load());
+
+  rclcpp::DeserializationThreadPool default_thread_pool;
+  EXPECT_GE(default_thread_pool.get_number_of_threads(), 1u);
+}
+
+#if defined(__linux__)
+TEST(TestDeserializationThreadPool, thread_attributes) {
+  std::vector<rclcpp::ThreadAttributes> thread_attributes(1);
+  thread_attributes[0].cpu_set = {0};
+  thread_attributes[0].name = "pinned_worker";
+
+  std::mutex mutex;
+  std::set<std::string> names;
+  {
+    // The second worker isn't given attributes
+    rclcpp::DeserializationThreadPool thread_pool(2, thread_attributes);
+    EXPECT_EQ(2u, thread_pool.get_number_of_threads());
+    for (size_t i = 0; i < 100; ++i) {
+      thread_pool.post(
+        [&]() {
+          char buffer[16] = {};
+          pthread_getname_np(pthread_self(), buffer, sizeof(buffer));
+          if (std::string(buffer) == "pinned_worker") {
+            EXPECT_EQ(0, sched_getcpu());
+          }
+          std::lock_guard<std::mutex> lock(mutex);
+          names.insert(buffer);
+        });
+    }
+  }
+  EXPECT_LE(names.size(), 2u);
+
+  // The threads started already are joined if another one cannot be created
+  thread_attributes.resize(2);
+  thread_attributes[1].cpu_set = {CPU_SETSIZE};
+  EXPECT_THROW(
+    rclcpp::DeserializationThreadPool(2, thread_attributes), std::invalid_argument);
+}
+#endif
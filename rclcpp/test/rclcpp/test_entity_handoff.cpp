@@ -0,0 +1,98 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+#include "rclcpp/entity_handoff.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+#include "test_msgs/msg/empty.hpp"
+
+using test_msgs::msg::Empty;
+
+class TestEntityHandoff : public ::testing::Test
+{
+protected:
+  static void SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  static void TearDownTestCase()
+  {
+    rclcpp::shutdown();
+  }
+};
+
+TEST_F(TestEntityHandoff, reuse_entities) {
+  const auto options = rclcpp::NodeOptions()
+    .start_parameter_services(false)
+    .start_parameter_event_publisher(false);
+  auto node = std::make_shared<rclcpp::Node>("handoff_node", "/ns", options);
+  auto publisher = node->create_publisher<Empty>("topic", 10);
+  auto other_publisher = node->create_publisher<Empty>("other_topic", 10);
+  auto subscription = node->create_subscription<Empty>("topic", 10, [](Empty::ConstSharedPtr) {});
+  const rmw_gid_t gid = publisher->get_gid();
+  const rcl_node_t * rcl_node = node->get_node_base_interface()->get_rcl_node_handle();
+  const rcl_subscription_t * rcl_subscription = subscription->get_subscription_handle().get();
+
+  auto handoff = std::make_shared<rclcpp::EntityHandoff>(*node->get_node_base_interface());
+  EXPECT_THROW(
+    std::make_shared<rclcpp::EntityHandoff>(*node->get_node_base_interface()),
+    std::invalid_argument);
+  publisher.reset();
+  other_publisher.reset();
+  subscription.reset();
+  node.reset();
+  EXPECT_EQ(2u, handoff->get_number_of_kept_publishers());
+  EXPECT_EQ(1u, handoff->get_number_of_kept_subscriptions());
+
+  // Another node doesn't take the entities
+  auto other_node = std::make_shared<rclcpp::Node>(
+    "other_node", "/ns", rclcpp::NodeOptions(options).entity_handoff(handoff));
+  EXPECT_NE(rcl_node, other_node->get_node_base_interface()->get_rcl_node_handle());
+  auto other_node_publisher = other_node->create_publisher<Empty>("/ns/topic", 10);
+  EXPECT_FALSE(*other_node_publisher == gid);
+  EXPECT_EQ(2u, handoff->get_number_of_kept_publishers());
+
+  // The new instance of the node takes the entities of the same topic, type and QoS
+  node = std::make_shared<rclcpp::Node>(
+    "handoff_node", "/ns", rclcpp::NodeOptions(options).entity_handoff(handoff));
+  EXPECT_EQ(rcl_node, node->get_node_base_interface()->get_rcl_node_handle());
+  EXPECT_STREQ("/ns/handoff_node", node->get_fully_qualified_name());
+  publisher = node->create_publisher<Empty>("topic", 10);
+  EXPECT_TRUE(*publisher == gid);
+  other_publisher = node->create_publisher<Empty>("other_topic", rclcpp::QoS(10).transient_local());
+  subscription = node->create_subscription<Empty>("topic", 10, [](Empty::ConstSharedPtr) {});
+  EXPECT_EQ(rcl_subscription, subscription->get_subscription_handle().get());
+  EXPECT_EQ(2u, handoff->get_number_of_reused_entities());
+  EXPECT_EQ(1u, handoff->get_number_of_kept_publishers());
+  EXPECT_EQ(0u, handoff->get_number_of_kept_subscriptions());
+
+  // The entities taken stay in use, the others are finalized
+  handoff->finish();
+  EXPECT_EQ(0u, handoff->get_number_of_kept_publishers());
+  EXPECT_TRUE(rcl_publisher_is_valid(publisher->get_publisher_handle().get()));
+  auto rcl_node_handle = handoff->take_node(
+    node->get_node_base_interface()->get_context(), "handoff_node", "/ns",
+    rcl_node_get_default_options());
+  EXPECT_EQ(nullptr, rcl_node_handle);
+
+  // Once finished, the entities destroyed aren't kept anymore
+  publisher.reset();
+  EXPECT_EQ(0u, handoff->get_number_of_kept_publishers());
+}
@@ -15,15 +15,21 @@
 #include <gtest/gtest.h>
 
 #include <chrono>
+#include <future>
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "rclcpp/executor.hpp"
 #include "rclcpp/memory_strategy.hpp"
 #include "rclcpp/executors/single_threaded_executor.hpp"
+#include "rclcpp/executors/static_single_threaded_executor.hpp"
 #include "rclcpp/strategies/allocator_memory_strategy.hpp"
 
+#include "test_msgs/msg/empty.hpp"
+
 #include "../mocking_utils/patch.hpp"
 #include "../utils/rclcpp_gtest_macros.hpp"
 
@@ -577,3 +583,379 @@ TEST_F(TestExecutor, is_spinning) {
 
   ASSERT_TRUE(timer_called);
 }
+
+TEST_F(TestExecutor, entities_added_after_wait) {
+  DummyExecutor dummy;
+  auto node = std::make_shared<rclcpp::Node>("node", "ns");
+  dummy.add_node(node);
+  // The first wait collects the entities
+  dummy.spin_some(std::chrono::milliseconds(1));
+
+  bool timer_fired = false;
+  auto timer = node->create_wall_timer(
+    std::chrono::milliseconds(1), [&timer_fired]() {timer_fired = true;});
+  auto start = std::chrono::steady_clock::now();
+  while (!timer_fired && std::chrono::steady_clock::now() - start < std::chrono::seconds(1)) {
+    dummy.spin_some(std::chrono::milliseconds(1));
+  }
+  EXPECT_TRUE(timer_fired);
+}
+
+TEST_F(TestExecutor, entities_destroyed_after_wait) {
+  DummyExecutor dummy;
+  auto node = std::make_shared<rclcpp::Node>("node", "ns");
+  int count = 0;
+  auto timer = node->create_wall_timer(
+    std::chrono::milliseconds(1), [&count]() {count++;});
+  dummy.add_node(node);
+  auto start = std::chrono::steady_clock::now();
+  while (count == 0 && std::chrono::steady_clock::now() - start < std::chrono::seconds(1)) {
+    dummy.spin_some(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(1, count);
+
+  // The cached collection must not keep the destroyed timer
+  std::weak_ptr<const rcl_timer_t> weak_handle = timer->get_timer_handle();
+  timer.reset();
+  dummy.spin_some(std::chrono::milliseconds(1));
+  EXPECT_TRUE(weak_handle.expired());
+  EXPECT_EQ(1, count);
+}
+
+TEST_F(TestExecutor, callback_group_priorities) {
+  DummyExecutor dummy;
+  auto node = std::make_shared<rclcpp::Node>("node", "ns");
+  auto group_a = node->create_callback_group(rclcpp::CallbackGroupType::MutuallyExclusive);
+  auto group_b = node->create_callback_group(rclcpp::CallbackGroupType::MutuallyExclusive);
+  std::vector<std::string> order;
+  auto timer_a = node->create_wall_timer(
+    std::chrono::milliseconds(1), [&order]() {order.push_back("a");}, group_a);
+  auto timer_b = node->create_wall_timer(
+    std::chrono::milliseconds(1), [&order]() {order.push_back("b");}, group_b);
+  dummy.add_node(node);
+
+  auto spin_both_ready = [&]() {
+      order.clear();
+      auto end = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+      while (order.size() < 2 && std::chrono::steady_clock::now() < end) {
+        order.clear();
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        dummy.spin_some();
+      }
+    };
+
+  group_a->set_priority(10);
+  EXPECT_EQ(10, group_a->get_priority());
+  spin_both_ready();
+  ASSERT_EQ(2u, order.size());
+  EXPECT_EQ("a", order[0]);
+  EXPECT_EQ("b", order[1]);
+
+  group_a->set_priority(0);
+  group_b->set_priority(10);
+  spin_both_ready();
+  ASSERT_EQ(2u, order.size());
+  EXPECT_EQ("b", order[0]);
+  EXPECT_EQ("a", order[1]);
+
+  // The low priority group waited behind the high priority one
+  auto low_statistics = group_a->get_starvation_statistics();
+  EXPECT_GT(low_statistics.dispatch_count, 0u);
+  EXPECT_GT(low_statistics.starved_count, 0u);
+  EXPECT_LE(low_statistics.max_wait_time, low_statistics.total_wait_time);
+  auto high_statistics = group_b->get_starvation_statistics();
+  EXPECT_GT(high_statistics.dispatch_count, 0u);
+
+  group_a->reset_starvation_statistics();
+  EXPECT_EQ(0u, group_a->get_starvation_statistics().dispatch_count);
+}
+
+TEST_F(TestExecutor, callback_group_priorities_remove_group) {
+  DummyExecutor dummy;
+  auto node = std::make_shared<rclcpp::Node>("node", "ns");
+  auto high_group = node->create_callback_group(
+    rclcpp::CallbackGroupType::MutuallyExclusive, false);
+  auto low_group = node->create_callback_group(
+    rclcpp::CallbackGroupType::MutuallyExclusive, false);
+  high_group->set_priority(1);
+  int low_count = 0;
+  auto high_timer = node->create_wall_timer(
+    std::chrono::milliseconds(1), []() {}, high_group);
+  auto low_timer = node->create_wall_timer(
+    std::chrono::milliseconds(1), [&low_count]() {low_count++;}, low_group);
+  dummy.add_callback_group(high_group, node->get_node_base_interface());
+  dummy.add_callback_group(low_group, node->get_node_base_interface());
+
+  // Both timers are taken, only the high priority one is dispatched
+  std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  dummy.spin_once(std::chrono::milliseconds(0));
+  // Removing the group releases the executable which was taken but not dispatched
+  dummy.remove_callback_group(low_group);
+  EXPECT_TRUE(low_group->can_be_taken_from().load());
+  dummy.spin_some();
+  EXPECT_EQ(0, low_count);
+}
+
+TEST_F(TestExecutor, callback_statistics) {
+  DummyExecutor dummy;
+  EXPECT_FALSE(dummy.get_callback_statistics_enabled());
+  auto node = std::make_shared<rclcpp::Node>("node", "ns");
+  size_t count = 0;
+  auto timer = node->create_wall_timer(
+    std::chrono::milliseconds(1), [&count]() {
+      count++;
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    });
+  dummy.add_node(node);
+
+  auto spin_until_executed = [&]() {
+      count = 0;
+      auto end = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+      while (count == 0 && std::chrono::steady_clock::now() < end) {
+        dummy.spin_once(std::chrono::milliseconds(10));
+      }
+    };
+
+  // Nothing is collected unless enabled
+  spin_until_executed();
+  ASSERT_EQ(1u, count);
+  EXPECT_TRUE(dummy.get_callback_statistics().empty());
+
+  dummy.set_callback_statistics_enabled(true);
+  EXPECT_TRUE(dummy.get_callback_statistics_enabled());
+  spin_until_executed();
+  ASSERT_EQ(1u, count);
+  auto statistics = dummy.get_callback_statistics();
+  ASSERT_EQ(1u, statistics.size());
+  EXPECT_EQ(timer.get(), statistics[0].entity);
+  EXPECT_EQ(rclcpp::CallbackKind::Timer, statistics[0].kind);
+  EXPECT_EQ(1u, statistics[0].execution_time.count());
+  EXPECT_GE(statistics[0].execution_time.min(), std::chrono::milliseconds(1));
+  EXPECT_EQ(1u, statistics[0].ready_delay.count());
+  EXPECT_EQ(0u, statistics[0].hardware_counters.count);
+
+  dummy.reset_callback_statistics();
+  EXPECT_TRUE(dummy.get_callback_statistics().empty());
+
+  // The hardware counters are sampled where the system gives access to them
+  EXPECT_FALSE(dummy.get_hardware_counters_enabled());
+  dummy.set_hardware_counters_enabled(true);
+  EXPECT_TRUE(dummy.get_hardware_counters_enabled());
+  spin_until_executed();
+  ASSERT_EQ(1u, count);
+  statistics = dummy.get_callback_statistics();
+  ASSERT_EQ(1u, statistics.size());
+  EXPECT_EQ(1u, statistics[0].execution_time.count());
+  EXPECT_LE(statistics[0].hardware_counters.count, 1u);
+}
+
+TEST_F(TestExecutor, time_accounting) {
+  DummyExecutor dummy;
+  EXPECT_FALSE(dummy.get_time_accounting_enabled());
+  auto node = std::make_shared<rclcpp::Node>("node", "ns");
+  size_t count = 0;
+  auto timer = node->create_wall_timer(
+    std::chrono::milliseconds(1), [&count]() {
+      count++;
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    });
+  dummy.add_node(node);
+
+  auto spin_until_executed = [&]() {
+      count = 0;
+      auto end = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+      while (count == 0 && std::chrono::steady_clock::now() < end) {
+        dummy.spin_once(std::chrono::milliseconds(10));
+      }
+    };
+
+  // Nothing is accounted unless enabled
+  spin_until_executed();
+  ASSERT_EQ(1u, count);
+  EXPECT_TRUE(dummy.get_thread_times().empty());
+
+  dummy.set_time_accounting_enabled(true);
+  EXPECT_TRUE(dummy.get_time_accounting_enabled());
+  spin_until_executed();
+  ASSERT_EQ(1u, count);
+  auto thread_times = dummy.get_thread_times();
+  ASSERT_EQ(1u, thread_times.size());
+  EXPECT_EQ(std::this_thread::get_id(), thread_times[0].thread_id);
+  EXPECT_EQ(1u, thread_times[0].execute.count);
+  EXPECT_GE(thread_times[0].execute.duration, std::chrono::milliseconds(1));
+  EXPECT_GE(thread_times[0].wait.count, 1u);
+  EXPECT_GE(thread_times[0].collect.count, 1u);
+  EXPECT_GE(thread_times[0].select.count, 1u);
+  EXPECT_EQ(0u, thread_times[0].idle.count);
+  EXPECT_GT(thread_times[0].utilization(), 0.0);
+  EXPECT_LE(thread_times[0].utilization(), 1.0);
+
+  dummy.reset_thread_times();
+  thread_times = dummy.get_thread_times();
+  ASSERT_EQ(1u, thread_times.size());
+  EXPECT_EQ(std::chrono::nanoseconds(0), thread_times[0].total());
+}
+
+TEST_F(TestExecutor, spin_until_future_complete_wake_on_future_complete) {
+  rclcpp::ExecutorOptions options;
+  options.wake_on_future_complete = true;
+  rclcpp::executors::SingleThreadedExecutor executor(options);
+  auto node = std::make_shared<rclcpp::Node>("node", "ns");
+  executor.add_node(node);
+
+  std::promise<void> promise;
+  std::shared_future<void> future = promise.get_future().share();
+  std::thread completer([&promise]() {
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      promise.set_value();
+    });
+
+  // Nothing else wakes the executor up, it would otherwise wait for the whole timeout
+  auto start = std::chrono::steady_clock::now();
+  auto ret = executor.spin_until_future_complete(future, std::chrono::seconds(10));
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  completer.join();
+  EXPECT_EQ(rclcpp::FutureReturnCode::SUCCESS, ret);
+  EXPECT_LT(elapsed, std::chrono::seconds(5));
+
+  // The executor can spin again afterwards
+  std::promise<void> other_promise;
+  std::shared_future<void> other_future = other_promise.get_future().share();
+  EXPECT_EQ(
+    rclcpp::FutureReturnCode::TIMEOUT,
+    executor.spin_until_future_complete(other_future, std::chrono::milliseconds(20)));
+}
+
+TEST_F(TestExecutor, busy_poll_budget) {
+  rclcpp::ExecutorOptions options;
+  options.busy_poll_budget = std::chrono::milliseconds(5);
+  rclcpp::executors::SingleThreadedExecutor executor(options);
+  auto node = std::make_shared<rclcpp::Node>("node", "ns");
+  size_t count = 0;
+  auto timer = node->create_wall_timer(
+    std::chrono::milliseconds(1), [&count]() {count++;});
+  executor.add_node(node);
+
+  // Timers becoming ready while polling or while blocked are both executed
+  auto end = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+  while (count < 10 && std::chrono::steady_clock::now() < end) {
+    executor.spin_once(std::chrono::milliseconds(100));
+  }
+  EXPECT_EQ(10u, count);
+
+  // The timeout is respected while polling
+  timer->cancel();
+  auto start = std::chrono::steady_clock::now();
+  executor.spin_once(std::chrono::milliseconds(20));
+  EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+  executor.spin_once(std::chrono::milliseconds(0));
+}
+
+TEST_F(TestExecutor, dataflow_chain_depth) {
+  using test_msgs::msg::Empty;
+  auto run_chain = [](size_t dataflow_chain_depth) {
+      rclcpp::ExecutorOptions options;
+      options.dataflow_chain_depth = dataflow_chain_depth;
+      rclcpp::executors::SingleThreadedExecutor executor(options);
+      auto node = std::make_shared<rclcpp::Node>(
+        "node", "ns", rclcpp::NodeOptions().use_intra_process_comms(true));
+      auto publisher_a = node->create_publisher<Empty>("a", 10);
+      auto publisher_b = node->create_publisher<Empty>("b", 10);
+      auto publisher_c = node->create_publisher<Empty>("c", 10);
+      std::vector<std::string> executed;
+      auto subscription_a = node->create_subscription<Empty>(
+        "a", 10, [&](Empty::UniquePtr) {
+          executed.push_back("a");
+          publisher_b->publish(std::make_unique<Empty>());
+        });
+      auto subscription_b = node->create_subscription<Empty>(
+        "b", 10, [&](Empty::UniquePtr) {
+          executed.push_back("b");
+          publisher_c->publish(std::make_unique<Empty>());
+        });
+      auto subscription_c = node->create_subscription<Empty>(
+        "c", 10, [&](Empty::UniquePtr) {executed.push_back("c");});
+      executor.add_node(node);
+
+      publisher_a->publish(std::make_unique<Empty>());
+      executor.spin_once(std::chrono::seconds(1));
+      auto executed_in_one_spin = executed;
+      // The rest of the chain is left to the following spins
+      for (size_t spin = 0; spin < 10 && executed.size() < 3; ++spin) {
+        executor.spin_once(std::chrono::seconds(1));
+      }
+      EXPECT_EQ((std::vector<std::string>{"a", "b", "c"}), executed);
+      return executed_in_one_spin;
+    };
+
+  EXPECT_EQ((std::vector<std::string>{"a"}), run_chain(0));
+  EXPECT_EQ((std::vector<std::string>{"a", "b"}), run_chain(1));
+  EXPECT_EQ((std::vector<std::string>{"a", "b", "c"}), run_chain(2));
+}
+
+TEST_F(TestExecutor, spin_some_with_quotas) {
+  using test_msgs::msg::Empty;
+  rclcpp::executors::SingleThreadedExecutor executor;
+  auto node = std::make_shared<rclcpp::Node>(
+    "node", "ns", rclcpp::NodeOptions().use_intra_process_comms(true));
+  auto publisher_a = node->create_publisher<Empty>("a", 10);
+  auto publisher_b = node->create_publisher<Empty>("b", 10);
+  size_t executed_a = 0;
+  size_t executed_b = 0;
+  auto subscription_a = node->create_subscription<Empty>(
+    "a", 10, [&executed_a](Empty::UniquePtr) {++executed_a;});
+  auto subscription_b = node->create_subscription<Empty>(
+    "b", 10, [&executed_b](Empty::UniquePtr) {++executed_b;});
+  executor.add_node(node);
+
+  // The busy subscription is executed once per call, like the other one
+  for (size_t i = 0; i < 5; ++i) {
+    publisher_a->publish(std::make_unique<Empty>());
+  }
+  publisher_b->publish(std::make_unique<Empty>());
+  executor.spin_some_with_quotas(rclcpp::SpinQuotas());
+  EXPECT_EQ(1u, executed_a);
+  EXPECT_EQ(1u, executed_b);
+
+  rclcpp::SpinQuotas quotas;
+  quotas.max_executions_per_entity = 2;
+  executor.spin_some_with_quotas(quotas);
+  EXPECT_EQ(3u, executed_a);
+  EXPECT_EQ(1u, executed_b);
+
+  quotas.max_executions_per_entity = 0;
+  executor.spin_some_with_quotas(quotas);
+  EXPECT_EQ(5u, executed_a);
+  EXPECT_EQ(1u, executed_b);
+
+  // With one execution per call in their callback group, the subscriptions are executed in turn
+  for (size_t i = 0; i < 3; ++i) {
+    publisher_a->publish(std::make_unique<Empty>());
+    publisher_b->publish(std::make_unique<Empty>());
+  }
+  quotas = rclcpp::SpinQuotas();
+  quotas.max_executions_per_group = 1;
+  executor.spin_some_with_quotas(quotas);
+  EXPECT_EQ(5u, executed_a);
+  EXPECT_EQ(2u, executed_b);
+  executor.spin_some_with_quotas(quotas);
+  EXPECT_EQ(6u, executed_a);
+  EXPECT_EQ(2u, executed_b);
+  executor.spin_some_with_quotas(quotas);
+  EXPECT_EQ(6u, executed_a);
+  EXPECT_EQ(3u, executed_b);
+}
+
+TEST_F(TestExecutor, spin_some_with_quotas_invalid) {
+  DummyExecutor executor;
+  rclcpp::SpinQuotas quotas;
+  quotas.max_duration = std::chrono::nanoseconds(-1);
+  EXPECT_THROW(executor.spin_some_with_quotas(quotas), std::invalid_argument);
+  quotas = rclcpp::SpinQuotas();
+  quotas.max_time_per_group = std::chrono::nanoseconds(-1);
+  EXPECT_THROW(executor.spin_some_with_quotas(quotas), std::invalid_argument);
+
+  rclcpp::executors::StaticSingleThreadedExecutor static_executor;
+  EXPECT_THROW(
+    static_executor.spin_some_with_quotas(rclcpp::SpinQuotas()), std::runtime_error);
+}
@@ -0,0 +1,144 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/executor_callback_statistics.hpp"
+
+using namespace std::chrono_literals;
+
+TEST(TestLatencyHistogram, record) {
+  rclcpp::LatencyHistogram histogram;
+  EXPECT_EQ(0u, histogram.count());
+  EXPECT_EQ(0ns, histogram.percentile(50.0));
+
+  histogram.record(0ns);
+  histogram.record(1ns);
+  histogram.record(3ns);
+  histogram.record(1000ns);
+  // Negative durations are ignored
+  histogram.record(-5ns);
+
+  EXPECT_EQ(4u, histogram.count());
+  EXPECT_EQ(1u, histogram.bucket_count(0));
+  EXPECT_EQ(1u, histogram.bucket_count(1));
+  EXPECT_EQ(1u, histogram.bucket_count(2));
+  EXPECT_EQ(1u, histogram.bucket_count(10));
+  EXPECT_EQ(0u, histogram.bucket_count(rclcpp::LatencyHistogram::NUMBER_OF_BUCKETS));
+  EXPECT_EQ(0ns, histogram.min());
+  EXPECT_EQ(1000ns, histogram.max());
+  EXPECT_EQ(251ns, histogram.mean());
+  EXPECT_EQ(4ns, histogram.percentile(75.0));
+  EXPECT_EQ(1000ns, histogram.percentile(100.0));
+}
+
+TEST(TestLatencyHistogram, merge) {
+  rclcpp::LatencyHistogram a;
+  rclcpp::LatencyHistogram b;
+  a.record(10ns);
+  b.record(2ns);
+  b.record(100ns);
+  a.merge(b);
+  EXPECT_EQ(3u, a.count());
+  EXPECT_EQ(2ns, a.min());
+  EXPECT_EQ(100ns, a.max());
+  EXPECT_EQ(1u, a.bucket_count(7));
+}
+
+TEST(TestExecutorCallbackStatistics, record_from_several_threads) {
+  rclcpp::ExecutorCallbackStatistics statistics;
+  int group, subscription, timer;
+  auto record = [&]() {
+      for (size_t i = 0; i < 100; ++i) {
+        statistics.record(
+          &group, &subscription, rclcpp::CallbackKind::Subscription, "/topic", 5ns, 10ns);
+      }
+    };
+  std::thread thread1(record);
+  std::thread thread2(record);
+  thread1.join();
+  thread2.join();
+  statistics.record(&group, &timer, rclcpp::CallbackKind::Timer, nullptr, -1ns, 1ms);
+
+  auto callbacks = statistics.get_statistics();
+  ASSERT_EQ(2u, callbacks.size());
+  for (const auto & callback : callbacks) {
+    EXPECT_EQ(&group, callback.callback_group);
+    if (callback.entity == &subscription) {
+      EXPECT_EQ(rclcpp::CallbackKind::Subscription, callback.kind);
+      EXPECT_EQ("/topic", callback.name);
+      EXPECT_EQ(200u, callback.execution_time.count());
+      EXPECT_EQ(200u, callback.ready_delay.count());
+    } else {
+      EXPECT_EQ(&timer, callback.entity);
+      EXPECT_EQ(rclcpp::CallbackKind::Timer, callback.kind);
+      EXPECT_EQ(1u, callback.execution_time.count());
+      EXPECT_EQ(1ms, callback.execution_time.max());
+      // The ready delay was unknown
+      EXPECT_EQ(0u, callback.ready_delay.count());
+    }
+  }
+
+  statistics.reset();
+  EXPECT_TRUE(statistics.get_statistics().empty());
+}
+
+TEST(TestExecutorCallbackStatistics, independent_objects) {
+  int group, entity;
+  {
+    rclcpp::ExecutorCallbackStatistics statistics;
+    statistics.record(&group, &entity, rclcpp::CallbackKind::Waitable, nullptr, 0ns, 0ns);
+    EXPECT_EQ(1u, statistics.get_statistics().size());
+  }
+  rclcpp::ExecutorCallbackStatistics statistics;
+  EXPECT_TRUE(statistics.get_statistics().empty());
+  statistics.record(&group, &entity, rclcpp::CallbackKind::Waitable, nullptr, 0ns, 0ns);
+  EXPECT_EQ(1u, statistics.get_statistics().size());
+}
+
+TEST(TestExecutorCallbackStatistics, hardware_counters) {
+  int group, entity;
+  rclcpp::ExecutorCallbackStatistics statistics;
+  rclcpp::HardwareCounters counters;
+  counters.count = 1;
+  counters.instructions = 1000;
+  counters.cycles = 2000;
+  counters.cache_misses = 10;
+  counters.context_switches = 1;
+  statistics.record(
+    &group, &entity, rclcpp::CallbackKind::Waitable, nullptr, 0ns, 1ms, &counters);
+  statistics.record(
+    &group, &entity, rclcpp::CallbackKind::Waitable, nullptr, 0ns, 1ms, &counters);
+  // Executions without counters are only accounted in the histograms
+  statistics.record(&group, &entity, rclcpp::CallbackKind::Waitable, nullptr, 0ns, 1ms);
+  std::thread thread(
+    [&]() {
+      statistics.record(
+        &group, &entity, rclcpp::CallbackKind::Waitable, nullptr, 0ns, 1ms, &counters);
+    });
+  thread.join();
+
+  auto callbacks = statistics.get_statistics();
+  ASSERT_EQ(1u, callbacks.size());
+  EXPECT_EQ(4u, callbacks[0].execution_time.count());
+  EXPECT_EQ(3u, callbacks[0].hardware_counters.count);
+  EXPECT_EQ(3000u, callbacks[0].hardware_counters.instructions);
+  EXPECT_EQ(6000u, callbacks[0].hardware_counters.cycles);
+  EXPECT_EQ(30u, callbacks[0].hardware_counters.cache_misses);
+  EXPECT_EQ(3u, callbacks[0].hardware_counters.context_switches);
+}
@@ -0,0 +1,161 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/executor_state_publisher.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+#include "test_msgs/msg/empty.hpp"
+
+using namespace std::chrono_literals;
+
+class TestExecutorSnapshot : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    rclcpp::init(0, nullptr);
+    node = std::make_shared<rclcpp::Node>(
+      "test_executor_snapshot_node", rclcpp::NodeOptions().use_intra_process_comms(true));
+  }
+
+  void TearDown() override
+  {
+    node.reset();
+    rclcpp::shutdown();
+  }
+
+  rclcpp::Node::SharedPtr node;
+};
+
+TEST_F(TestExecutorSnapshot, empty) {
+  rclcpp::executors::SingleThreadedExecutor executor;
+  auto snapshot = executor.get_introspection_snapshot();
+  EXPECT_FALSE(snapshot.spinning);
+  EXPECT_FALSE(snapshot.ready_states_valid);
+  EXPECT_TRUE(snapshot.callback_groups.empty());
+  EXPECT_TRUE(snapshot.subscriptions.empty());
+  EXPECT_TRUE(snapshot.timers.empty());
+}
+
+TEST_F(TestExecutorSnapshot, busy_group) {
+  auto group = node->create_callback_group(rclcpp::CallbackGroupType::MutuallyExclusive);
+  std::atomic_bool entered {false};
+  std::atomic_bool release {false};
+  // The timer blocks the group the first time it's executed, becoming overdue meanwhile
+  auto timer = node->create_wall_timer(
+    1ms, [&]() {
+      if (!entered.exchange(true)) {
+        while (!release.load()) {
+          std::this_thread::sleep_for(1ms);
+        }
+      }
+    }, group);
+  rclcpp::SubscriptionOptions options;
+  options.callback_group = group;
+  auto subscription = node->create_subscription<test_msgs::msg::Empty>(
+    "snapshot_topic", 10, [](test_msgs::msg::Empty::ConstSharedPtr) {}, options);
+  auto publisher = node->create_publisher<test_msgs::msg::Empty>("snapshot_topic", 10);
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  std::thread spinner([&executor]() {executor.spin();});
+  const auto end = std::chrono::steady_clock::now() + 10s;
+  while (!entered.load() && std::chrono::steady_clock::now() < end) {
+    std::this_thread::sleep_for(1ms);
+  }
+  ASSERT_TRUE(entered.load());
+  for (size_t i = 0; i < 3; ++i) {
+    publisher->publish(test_msgs::msg::Empty());
+  }
+  std::this_thread::sleep_for(20ms);
+
+  auto snapshot = executor.get_introspection_snapshot();
+  release = true;
+  executor.cancel();
+  spinner.join();
+
+  EXPECT_TRUE(snapshot.spinning);
+  ASSERT_EQ(1u, snapshot.subscriptions.size());
+  const auto & subscription_state = snapshot.subscriptions[0];
+  EXPECT_EQ("/test_executor_snapshot_node", subscription_state.node_name);
+  EXPECT_EQ("/snapshot_topic", subscription_state.topic_name);
+  EXPECT_FALSE(subscription_state.paused);
+  EXPECT_TRUE(subscription_state.intra_process);
+  EXPECT_EQ(3u, subscription_state.intra_process_depth);
+  EXPECT_EQ(10u, subscription_state.intra_process_capacity);
+
+  ASSERT_LT(subscription_state.callback_group, snapshot.callback_groups.size());
+  const auto & group_state = snapshot.callback_groups[subscription_state.callback_group];
+  EXPECT_EQ(rclcpp::CallbackGroupType::MutuallyExclusive, group_state.type);
+  EXPECT_TRUE(group_state.busy);
+  // The default callback group of the node isn't busy
+  EXPECT_EQ(
+    1, std::count_if(
+      snapshot.callback_groups.begin(), snapshot.callback_groups.end(),
+      [](const auto & state) {return state.busy;}));
+
+  ASSERT_EQ(1u, snapshot.timers.size());
+  EXPECT_EQ(subscription_state.callback_group, snapshot.timers[0].callback_group);
+  EXPECT_EQ(1ms, snapshot.timers[0].period);
+  EXPECT_FALSE(snapshot.timers[0].canceled);
+  EXPECT_GT(snapshot.timers[0].overdue, 10ms);
+}
+
+TEST_F(TestExecutorSnapshot, publisher) {
+  rclcpp::executors::SingleThreadedExecutor executor;
+  auto timer = node->create_wall_timer(1h, []() {});
+  auto subscription = node->create_subscription<test_msgs::msg::Empty>(
+    "snapshot_topic", 10, [](test_msgs::msg::Empty::ConstSharedPtr) {});
+  executor.add_node(node);
+
+  // Without a period, the state is only published on request
+  auto state_publisher = std::make_shared<rclcpp::ExecutorStatePublisher>(*node, executor, 0ns);
+  auto messages = state_publisher->generate_messages();
+  std::vector<std::string> metrics;
+  for (const auto & message : messages) {
+    EXPECT_EQ("/test_executor_snapshot_node", message.measurement_source_name);
+    metrics.push_back(message.metrics_source);
+  }
+  EXPECT_NE(
+    metrics.end(), std::find(metrics.begin(), metrics.end(), "callback_group/0/busy"));
+  EXPECT_NE(
+    metrics.end(), std::find(metrics.begin(), metrics.end(), "subscription/snapshot_topic/ready"));
+  EXPECT_NE(
+    metrics.end(), std::find(
+      metrics.begin(), metrics.end(), "subscription/snapshot_topic/intra_process_depth"));
+  EXPECT_NE(metrics.end(), std::find(metrics.begin(), metrics.end(), "timer/0/overdue"));
+
+  size_t received = 0;
+  auto state_subscription = node->create_subscription<statistics_msgs::msg::MetricsMessage>(
+    rclcpp::ExecutorStatePublisher::default_topic_name, 100,
+    [&received](statistics_msgs::msg::MetricsMessage::ConstSharedPtr) {
+      ++received;
+    });
+  const auto end = std::chrono::steady_clock::now() + 10s;
+  while (received == 0 && std::chrono::steady_clock::now() < end) {
+    state_publisher->publish();
+    executor.spin_some(10ms);
+  }
+  EXPECT_GT(received, 0u);
+}
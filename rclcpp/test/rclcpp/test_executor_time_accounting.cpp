@@ -0,0 +1,92 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/executor_time_accounting.hpp"
+
+using namespace std::chrono_literals;
+
+TEST(TestExecutorThreadTimes, utilization) {
+  rclcpp::ExecutorThreadTimes times;
+  EXPECT_EQ(0ns, times.total());
+  EXPECT_EQ(0.0, times.utilization());
+
+  times.collect.duration = 10ns;
+  times.wait.duration = 50ns;
+  times.select.duration = 5ns;
+  times.execute.duration = 25ns;
+  times.idle.duration = 10ns;
+  EXPECT_EQ(100ns, times.total());
+  EXPECT_DOUBLE_EQ(0.4, times.utilization());
+  EXPECT_EQ(&times.wait, &times.get(rclcpp::ExecutorActivity::Wait));
+  EXPECT_EQ(&times.idle, &times.get(rclcpp::ExecutorActivity::Idle));
+}
+
+TEST(TestExecutorTimeAccounting, record_from_several_threads) {
+  rclcpp::ExecutorTimeAccounting accounting;
+  EXPECT_TRUE(accounting.get_thread_times().empty());
+
+  accounting.record(rclcpp::ExecutorActivity::Wait, 100ns);
+  accounting.record(rclcpp::ExecutorActivity::Wait, 50ns);
+  // Negative durations are ignored
+  accounting.record(rclcpp::ExecutorActivity::Execute, -1ns);
+  std::thread other([&accounting]() {
+      accounting.record(rclcpp::ExecutorActivity::Execute, 30ns);
+      rclcpp::ExecutorTimeAccounting::Scope scope(&accounting, rclcpp::ExecutorActivity::Select);
+    });
+  other.join();
+  {
+    // A scope without accounting does nothing
+    rclcpp::ExecutorTimeAccounting::Scope scope(nullptr, rclcpp::ExecutorActivity::Collect);
+  }
+
+  auto thread_times = accounting.get_thread_times();
+  ASSERT_EQ(2u, thread_times.size());
+  EXPECT_EQ(std::this_thread::get_id(), thread_times[0].thread_id);
+  EXPECT_EQ(150ns, thread_times[0].wait.duration);
+  EXPECT_EQ(2u, thread_times[0].wait.count);
+  EXPECT_EQ(0u, thread_times[0].execute.count);
+  EXPECT_EQ(0u, thread_times[0].collect.count);
+  EXPECT_EQ(0.0, thread_times[0].utilization());
+  EXPECT_EQ(30ns, thread_times[1].execute.duration);
+  EXPECT_EQ(1u, thread_times[1].execute.count);
+  EXPECT_EQ(1u, thread_times[1].select.count);
+  EXPECT_EQ(1.0, thread_times[1].utilization());
+
+  accounting.reset();
+  thread_times = accounting.get_thread_times();
+  ASSERT_EQ(2u, thread_times.size());
+  EXPECT_EQ(0ns, thread_times[0].total());
+  EXPECT_EQ(0u, thread_times[0].wait.count);
+  EXPECT_EQ(0ns, thread_times[1].total());
+}
+
+TEST(TestExecutorTimeAccounting, independent_objects) {
+  std::vector<rclcpp::ExecutorThreadTimes> thread_times;
+  {
+    rclcpp::ExecutorTimeAccounting first;
+    first.record(rclcpp::ExecutorActivity::Collect, 1ns);
+  }
+  rclcpp::ExecutorTimeAccounting second;
+  second.record(rclcpp::ExecutorActivity::Idle, 2ns);
+  thread_times = second.get_thread_times();
+  ASSERT_EQ(1u, thread_times.size());
+  EXPECT_EQ(0ns, thread_times[0].collect.duration);
+  EXPECT_EQ(2ns, thread_times[0].idle.duration);
+}
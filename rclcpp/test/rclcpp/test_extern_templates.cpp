@@ -0,0 +1,75 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "rclcpp/extern_templates.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+#include "test_msgs/msg/empty.hpp"
+
+// The declarations and the instantiations are usually in a header and a source file of
+// another library, they are both used here to check they compile together.
+RCLCPP_DECLARE_MESSAGE_TEMPLATES(test_msgs::msg::Empty, );
+RCLCPP_INSTANTIATE_MESSAGE_TEMPLATES(test_msgs::msg::Empty);
+
+using namespace std::chrono_literals;
+
+class TestExternTemplates : public ::testing::Test
+{
+public:
+  static void SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  static void TearDownTestCase()
+  {
+    rclcpp::shutdown();
+  }
+};
+
+template<typename MessageT>
+size_t
+publish_and_receive(const std::string & topic)
+{
+  auto node = std::make_shared<rclcpp::Node>("test_extern_templates");
+  size_t received = 0;
+  auto subscription = node->create_subscription<MessageT>(
+    topic, 10, [&received](const MessageT &) {++received;});
+  auto publisher = node->create_publisher<MessageT>(topic, 10);
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  const auto end = std::chrono::steady_clock::now() + 10s;
+  while (received == 0 && std::chrono::steady_clock::now() < end) {
+    publisher->publish(MessageT());
+    executor.spin_some(10ms);
+  }
+  return received;
+}
+
+TEST_F(TestExternTemplates, instantiated_by_rclcpp) {
+  EXPECT_GT(
+    publish_and_receive<rcl_interfaces::msg::ParameterEvent>("extern_parameter_events"), 0u);
+  EXPECT_GT(publish_and_receive<rosgraph_msgs::msg::Clock>("extern_clock"), 0u);
+}
+
+TEST_F(TestExternTemplates, instantiated_by_the_macros) {
+  EXPECT_GT(publish_and_receive<test_msgs::msg::Empty>("extern_empty"), 0u);
+}
@@ -0,0 +1,170 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <stdexcept>
+
+#include "rclcpp/file_descriptor_waitable.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+using namespace std::chrono_literals;
+
+class TestFileDescriptorWaitable : public ::testing::Test
+{
+public:
+  void SetUp()
+  {
+    rclcpp::init(0, nullptr);
+    node = std::make_shared<rclcpp::Node>("test_file_descriptor_waitable_node");
+    ASSERT_EQ(0, ::pipe(pipe_fds));
+  }
+
+  void TearDown()
+  {
+    node.reset();
+    ::close(pipe_fds[0]);
+    ::close(pipe_fds[1]);
+    rclcpp::shutdown();
+  }
+
+  /// Spin the executor until the predicate is true or the timeout elapsed.
+  template<typename PredicateT>
+  bool
+  spin_until(rclcpp::Executor & executor, PredicateT predicate, std::chrono::nanoseconds timeout)
+  {
+    const auto end = std::chrono::steady_clock::now() + timeout;
+    while (!predicate() && std::chrono::steady_clock::now() < end) {
+      executor.spin_once(10ms);
+    }
+    return predicate();
+  }
+
+  rclcpp::Node::SharedPtr node;
+  int pipe_fds[2] = {-1, -1};
+};
+
+TEST_F(TestFileDescriptorWaitable, construction) {
+  auto callback = [](int, const rclcpp::FileDescriptorEvents &) {};
+  rclcpp::FileDescriptorEvents readable;
+  readable.readable = true;
+  EXPECT_THROW(
+    rclcpp::FileDescriptorWaitable(-1, readable, callback),
+    std::invalid_argument);
+  EXPECT_THROW(
+    rclcpp::FileDescriptorWaitable(pipe_fds[0], rclcpp::FileDescriptorEvents(), callback),
+    std::invalid_argument);
+  EXPECT_THROW(
+    rclcpp::FileDescriptorWaitable(pipe_fds[0], readable, nullptr),
+    std::invalid_argument);
+
+  rclcpp::FileDescriptorWaitable waitable(pipe_fds[0], readable, callback);
+  EXPECT_EQ(pipe_fds[0], waitable.get_fd());
+  EXPECT_TRUE(waitable.get_events().readable);
+  EXPECT_FALSE(waitable.get_events().writable);
+  EXPECT_EQ(1u, waitable.get_number_of_ready_guard_conditions());
+  EXPECT_THROW(waitable.set_events(rclcpp::FileDescriptorEvents()), std::invalid_argument);
+}
+
+TEST_F(TestFileDescriptorWaitable, readable) {
+  size_t executions = 0;
+  size_t bytes_read = 0;
+  rclcpp::FileDescriptorEvents readable;
+  readable.readable = true;
+  auto waitable = rclcpp::create_file_descriptor_waitable(
+    *node, pipe_fds[0], readable,
+    [&](int fd, const rclcpp::FileDescriptorEvents & events) {
+      EXPECT_TRUE(events.readable);
+      EXPECT_FALSE(events.writable);
+      char buffer[16];
+      ssize_t ret = ::read(fd, buffer, sizeof(buffer));
+      ASSERT_GT(ret, 0);
+      bytes_read += static_cast<size_t>(ret);
+      ++executions;
+    });
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+
+  // Nothing to read, the callback is not executed
+  executor.spin_some(100ms);
+  EXPECT_EQ(0u, executions);
+
+  ASSERT_EQ(3, ::write(pipe_fds[1], "abc", 3));
+  ASSERT_TRUE(spin_until(executor, [&]() {return bytes_read == 3;}, 10s));
+  const size_t executions_after_read = executions;
+
+  // Drained by the callback, the file descriptor doesn't trigger it again
+  executor.spin_some(100ms);
+  EXPECT_EQ(executions_after_read, executions);
+
+  // Polled again after the execution of the callback
+  ASSERT_EQ(2, ::write(pipe_fds[1], "de", 2));
+  ASSERT_TRUE(spin_until(executor, [&]() {return bytes_read == 5;}, 10s));
+}
+
+TEST_F(TestFileDescriptorWaitable, writable) {
+  size_t executions = 0;
+  rclcpp::FileDescriptorEvents writable;
+  writable.writable = true;
+  auto waitable = rclcpp::create_file_descriptor_waitable(
+    *node, pipe_fds[1], writable,
+    [&](int, const rclcpp::FileDescriptorEvents & events) {
+      EXPECT_TRUE(events.writable);
+      ++executions;
+    });
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  ASSERT_TRUE(spin_until(executor, [&]() {return executions > 0;}, 10s));
+
+  // Waiting for readable data instead, which never comes
+  rclcpp::FileDescriptorEvents readable;
+  readable.readable = true;
+  waitable->set_events(readable);
+  executor.spin_some(100ms);
+  const size_t executions_after_change = executions;
+  executor.spin_some(100ms);
+  EXPECT_EQ(executions_after_change, executions);
+}
+
+TEST_F(TestFileDescriptorWaitable, on_ready_callback) {
+  rclcpp::FileDescriptorEvents readable;
+  readable.readable = true;
+  rclcpp::FileDescriptorWaitable waitable(
+    pipe_fds[0], readable, [](int, const rclcpp::FileDescriptorEvents &) {});
+
+  std::promise<int> ready;
+  auto future = ready.get_future();
+  waitable.set_on_ready_callback(
+    [&ready](size_t count, int entity) {
+      EXPECT_EQ(1u, count);
+      ready.set_value(entity);
+    });
+  ASSERT_EQ(1, ::write(pipe_fds[1], "a", 1));
+  ASSERT_EQ(std::future_status::ready, future.wait_for(10s));
+  EXPECT_EQ(
+    static_cast<int>(rclcpp::FileDescriptorWaitable::EntityType::FileDescriptor), future.get());
+  waitable.clear_on_ready_callback();
+
+  std::shared_ptr<void> data = waitable.take_data_by_entity_id(0);
+  ASSERT_NE(nullptr, data);
+  EXPECT_TRUE(std::static_pointer_cast<rclcpp::FileDescriptorEvents>(data)->readable);
+  EXPECT_EQ(nullptr, waitable.take_data());
+}
@@ -0,0 +1,291 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/flight_recorder.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+using namespace std::chrono_literals;
+using rclcpp::FlightRecorder;
+using rclcpp::FlightRecorderEvent;
+using rclcpp::FlightRecorderEventType;
+using rclcpp::FlightRecorderThreadEvents;
+
+namespace
+{
+
+/// Return the events recorded by a thread, empty if it has none.
+FlightRecorderThreadEvents
+get_thread_events(std::thread::id thread_id = std::this_thread::get_id())
+{
+  for (auto & thread_events : FlightRecorder::get_snapshot()) {
+    if (thread_events.thread_id == thread_id) {
+      return thread_events;
+    }
+  }
+  return FlightRecorderThreadEvents{thread_id, 0, {}};
+}
+
+size_t
+count_events(
+  const std::vector<FlightRecorderEvent> & events, FlightRecorderEventType type,
+  const void * entity)
+{
+  size_t count = 0;
+  for (const auto & event : events) {
+    if (event.type == type && event.entity == entity) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+bool
+wait_for_dump_count(uint64_t dump_count)
+{
+  const auto deadline = std::chrono::steady_clock::now() + 5s;
+  while (FlightRecorder::get_dump_count() < dump_count) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(1ms);
+  }
+  return true;
+}
+
+/// Records from its destructor, once the thread exits.
+struct RecordOnThreadExit
+{
+  ~RecordOnThreadExit()
+  {
+    FlightRecorder::record(FlightRecorderEventType::CallbackEnd);
+  }
+};
+
+}  // namespace
+
+class TestFlightRecorder : public ::testing::Test
+{
+public:
+  void SetUp()
+  {
+    FlightRecorder::enable();
+    FlightRecorder::clear();
+  }
+
+  void TearDown()
+  {
+    FlightRecorder::set_dump_path_prefix("");
+    FlightRecorder::set_dump_on_deadline_missed(false);
+    FlightRecorder::enable();
+  }
+};
+
+TEST_F(TestFlightRecorder, record) {
+  int entity = 0;
+  FlightRecorder::record(FlightRecorderEventType::CallbackStart, &entity);
+  FlightRecorder::record(FlightRecorderEventType::TimerLateness, &entity, 42);
+  FlightRecorder::record(FlightRecorderEventType::CallbackEnd, &entity);
+
+  const auto thread_events = get_thread_events();
+  ASSERT_EQ(3u, thread_events.events.size());
+  EXPECT_EQ(FlightRecorderEventType::CallbackStart, thread_events.events[0].type);
+  EXPECT_EQ(&entity, thread_events.events[0].entity);
+  EXPECT_EQ(FlightRecorderEventType::TimerLateness, thread_events.events[1].type);
+  EXPECT_EQ(42, thread_events.events[1].value);
+  EXPECT_EQ(FlightRecorderEventType::CallbackEnd, thread_events.events[2].type);
+  EXPECT_LE(thread_events.events[0].timestamp, thread_events.events[2].timestamp);
+
+  // The cleared events are counted as lost
+  FlightRecorder::clear();
+  const auto cleared_events = get_thread_events();
+  EXPECT_TRUE(cleared_events.events.empty());
+  EXPECT_EQ(thread_events.lost_count + 3, cleared_events.lost_count);
+}
+
+TEST_F(TestFlightRecorder, disabled) {
+  FlightRecorder::disable();
+  EXPECT_FALSE(FlightRecorder::is_enabled());
+  FlightRecorder::record(FlightRecorderEventType::WaitStart);
+  EXPECT_TRUE(get_thread_events().events.empty());
+  FlightRecorder::enable();
+  EXPECT_TRUE(FlightRecorder::is_enabled());
+  FlightRecorder::record(FlightRecorderEventType::WaitStart);
+  EXPECT_EQ(1u, get_thread_events().events.size());
+}
+
+TEST_F(TestFlightRecorder, overwrites_oldest_events) {
+  const uint64_t lost_count = get_thread_events().lost_count;
+  const size_t count = FlightRecorder::thread_capacity + 10;
+  for (size_t i = 0; i < count; ++i) {
+    FlightRecorder::record(FlightRecorderEventType::WaitEnd, nullptr, static_cast<int64_t>(i));
+  }
+  const auto thread_events = get_thread_events();
+  ASSERT_EQ(FlightRecorder::thread_capacity, thread_events.events.size());
+  EXPECT_EQ(lost_count + 10, thread_events.lost_count);
+  EXPECT_EQ(10, thread_events.events.front().value);
+  EXPECT_EQ(static_cast<int64_t>(count - 1), thread_events.events.back().value);
+}
+
+TEST_F(TestFlightRecorder, threads) {
+  std::atomic_bool recorded{false};
+  std::atomic_bool done{false};
+  std::thread thread([&]() {
+      FlightRecorder::record(FlightRecorderEventType::IntraProcessEnqueue);
+      recorded.store(true);
+      while (!done.load()) {
+        std::this_thread::sleep_for(1ms);
+      }
+    });
+  const std::thread::id thread_id = thread.get_id();
+  while (!recorded.load()) {
+    std::this_thread::sleep_for(1ms);
+  }
+  EXPECT_EQ(1u, get_thread_events(thread_id).events.size());
+  EXPECT_TRUE(get_thread_events().events.empty());
+  done.store(true);
+  thread.join();
+  // The ring of the thread is released when it exits
+  for (const auto & thread_events : FlightRecorder::get_snapshot()) {
+    EXPECT_NE(thread_id, thread_events.thread_id);
+  }
+}
+
+TEST_F(TestFlightRecorder, record_after_thread_ring) {
+  std::thread thread([]() {
+      // Constructed before the ring of the thread, so destroyed after it
+      thread_local RecordOnThreadExit record_on_exit;
+      (void)record_on_exit;
+      FlightRecorder::record(FlightRecorderEventType::CallbackStart);
+    });
+  const std::thread::id thread_id = thread.get_id();
+  thread.join();
+  // The recording after the ring was released is skipped
+  for (const auto & thread_events : FlightRecorder::get_snapshot()) {
+    EXPECT_NE(thread_id, thread_events.thread_id);
+  }
+}
+
+TEST_F(TestFlightRecorder, read_while_recording) {
+  std::atomic_bool done{false};
+  std::thread thread([&]() {
+      for (int64_t i = 0; !done.load(); ++i) {
+        FlightRecorder::record(FlightRecorderEventType::WaitEnd, nullptr, i);
+      }
+    });
+  const std::thread::id thread_id = thread.get_id();
+  for (size_t snapshot = 0; snapshot < 100; ++snapshot) {
+    // Whatever the events overwritten during the read, the ones kept are consecutive
+    const auto events = get_thread_events(thread_id).events;
+    for (size_t i = 1; i < events.size(); ++i) {
+      ASSERT_EQ(events[i - 1].value + 1, events[i].value);
+      ASSERT_LE(events[i - 1].timestamp, events[i].timestamp);
+    }
+  }
+  done.store(true);
+  thread.join();
+}
+
+TEST_F(TestFlightRecorder, dump) {
+  int entity = 0;
+  FlightRecorder::record(FlightRecorderEventType::CallbackStart, &entity);
+  FlightRecorder::record(FlightRecorderEventType::CallbackEnd, &entity);
+  std::ostringstream stream;
+  FlightRecorder::dump(stream);
+  const std::string dump = stream.str();
+  EXPECT_NE(std::string::npos, dump.find("callback_start"));
+  EXPECT_NE(std::string::npos, dump.find("callback_end"));
+  EXPECT_LT(dump.find("callback_start"), dump.find("callback_end"));
+}
+
+TEST_F(TestFlightRecorder, dump_files) {
+  const std::string prefix = (std::filesystem::temp_directory_path() /
+    ("test_flight_recorder_" + std::to_string(std::chrono::steady_clock::now()
+    .time_since_epoch().count()))).string();
+  // Ignored without the dump thread
+  FlightRecorder::request_dump();
+  const uint64_t dump_count = FlightRecorder::get_dump_count();
+
+  FlightRecorder::set_dump_path_prefix(prefix);
+  FlightRecorder::record(FlightRecorderEventType::WaitStart);
+  FlightRecorder::request_dump();
+  ASSERT_TRUE(wait_for_dump_count(dump_count + 1));
+  const std::string path = prefix + "." + std::to_string(dump_count);
+  std::ifstream file(path);
+  std::stringstream content;
+  content << file.rdbuf();
+  EXPECT_NE(std::string::npos, content.str().find("wait_start"));
+
+  // Missed deadlines only request dumps once asked to
+  int entity = 0;
+  FlightRecorder::on_deadline_missed(&entity, 1);
+  EXPECT_EQ(1u, count_events(
+      get_thread_events().events, FlightRecorderEventType::DeadlineMissed, &entity));
+  FlightRecorder::set_dump_on_deadline_missed(true);
+  FlightRecorder::on_deadline_missed(&entity, 2);
+  ASSERT_TRUE(wait_for_dump_count(dump_count + 2));
+
+#if !defined(_WIN32)
+  FlightRecorder::install_dump_signal_handler(SIGUSR1);
+  std::raise(SIGUSR1);
+  ASSERT_TRUE(wait_for_dump_count(dump_count + 3));
+  std::signal(SIGUSR1, SIG_DFL);
+#endif
+
+  FlightRecorder::set_dump_path_prefix("");
+  for (uint64_t index = dump_count; index < FlightRecorder::get_dump_count(); ++index) {
+    std::filesystem::remove(prefix + "." + std::to_string(index));
+  }
+}
+
+TEST_F(TestFlightRecorder, executor_events) {
+  rclcpp::init(0, nullptr);
+  {
+    auto node = std::make_shared<rclcpp::Node>("test_flight_recorder_node");
+    size_t called = 0;
+    auto timer = node->create_wall_timer(1ms, [&called]() {++called;});
+    rclcpp::executors::SingleThreadedExecutor executor;
+    executor.add_node(node);
+    while (called == 0) {
+      executor.spin_once(100ms);
+    }
+
+    const auto events = get_thread_events().events;
+    const void * timer_base = static_cast<const rclcpp::TimerBase *>(timer.get());
+    EXPECT_LE(1u, count_events(events, FlightRecorderEventType::WaitStart, nullptr));
+    EXPECT_LE(1u, count_events(events, FlightRecorderEventType::WaitEnd, nullptr));
+    EXPECT_EQ(1u, count_events(events, FlightRecorderEventType::CallbackStart, timer_base));
+    EXPECT_EQ(1u, count_events(events, FlightRecorderEventType::CallbackEnd, timer_base));
+    ASSERT_EQ(1u, count_events(events, FlightRecorderEventType::TimerLateness, timer_base));
+    for (const auto & event : events) {
+      if (event.type == FlightRecorderEventType::TimerLateness) {
+        EXPECT_LE(0, event.value);
+      }
+    }
+  }
+  rclcpp::shutdown();
+}
@@ -15,7 +15,9 @@
 
 #include <gmock/gmock.h>
 
+#include <cstring>
 #include <future>
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -263,3 +265,237 @@ TEST_F(RclcppGenericNodeFixture, generic_publisher_uses_qos)
   // It normally takes < 20ms, 5s chosen as "a very long time"
   ASSERT_TRUE(wait_for(connected, 5s));
 }
+
+TEST_F(RclcppGenericNodeFixture, intra_process_generic_subscription)
+{
+  using namespace std::chrono_literals;
+  std::string topic_name = "/intra_process_string_topic";
+  std::string topic_type = "test_msgs/msg/Strings";
+  auto node = std::make_shared<rclcpp::Node>(
+    "intra_process_node", rclcpp::NodeOptions().use_intra_process_comms(true));
+
+  std::vector<std::shared_ptr<rclcpp::SerializedMessage>> messages;
+  auto callback = [&messages](std::shared_ptr<rclcpp::SerializedMessage> message) {
+      messages.push_back(message);
+    };
+  auto subscription1 = node->create_generic_subscription(
+    topic_name, topic_type, rclcpp::QoS(10), callback);
+  auto subscription2 = node->create_generic_subscription(
+    topic_name, topic_type, rclcpp::QoS(10), callback);
+  auto typed_publisher = node->create_publisher<test_msgs::msg::Strings>(topic_name, 10);
+  auto generic_publisher = node->create_generic_publisher(topic_name, topic_type, 10);
+  EXPECT_EQ(2u, typed_publisher->get_intra_process_subscription_count());
+  EXPECT_EQ(2u, generic_publisher->get_intra_process_subscription_count());
+
+  test_msgs::msg::Strings message;
+  message.string_value = "typed";
+  typed_publisher->publish(message);
+  generic_publisher->publish(serialize_message<std::string, test_msgs::msg::Strings>("generic"));
+
+  auto received = [&messages, &node]() {
+      rclcpp::spin_some(node);
+      return messages.size() >= 4;
+    };
+  ASSERT_TRUE(wait_for(received, 5s));
+  // Each message is serialized once, and shared by the subscriptions
+  ASSERT_EQ(4u, messages.size());
+  std::map<rclcpp::SerializedMessage *, std::string> received_messages;
+  rclcpp::Serialization<test_msgs::msg::Strings> serialization;
+  for (const auto & serialized_message : messages) {
+    test_msgs::msg::Strings deserialized_message;
+    serialization.deserialize_message(serialized_message.get(), &deserialized_message);
+    received_messages[serialized_message.get()] = deserialized_message.string_value;
+  }
+  ASSERT_EQ(2u, received_messages.size());
+  EXPECT_THAT(
+    received_messages,
+    UnorderedElementsAre(Pair(_, StrEq("typed")), Pair(_, StrEq("generic"))));
+
+  // The messages aren't also received from the middleware
+  std::this_thread::sleep_for(100ms);
+  rclcpp::spin_some(node);
+  EXPECT_EQ(4u, messages.size());
+}
+
+TEST_F(RclcppGenericNodeFixture, generic_subscription_view_callback_forwards_messages)
+{
+  using namespace std::chrono_literals;
+  std::string input_topic = "/view_input_topic";
+  std::string output_topic = "/view_output_topic";
+  std::string topic_type = "test_msgs/msg/Strings";
+
+  auto relay_publisher = node_->create_generic_publisher(output_topic, topic_type, 10);
+  size_t forwarded_count = 0;
+  auto relay_subscription = node_->create_generic_subscription(
+    input_topic, topic_type, rclcpp::QoS(10),
+    [&forwarded_count, &relay_publisher](
+      const rclcpp::SerializedMessageView & message, const rclcpp::MessageInfo & message_info) {
+      EXPECT_FALSE(message_info.get_rmw_message_info().from_intra_process);
+      EXPECT_FALSE(message.empty());
+      relay_publisher->publish(message);
+      forwarded_count++;
+    });
+
+  std::vector<std::string> received_messages;
+  auto output_subscription = publisher_node_->create_subscription<test_msgs::msg::Strings>(
+    output_topic, 10, [&received_messages](const test_msgs::msg::Strings & message) {
+      received_messages.push_back(message.string_value);
+    });
+  auto input_publisher = publisher_node_->create_publisher<test_msgs::msg::Strings>(
+    input_topic, 10);
+
+  auto connected = [&]() -> bool {
+      return input_publisher->get_subscription_count() &&
+             relay_publisher->get_subscription_count();
+    };
+  ASSERT_TRUE(wait_for(connected, 5s));
+
+  test_msgs::msg::Strings message;
+  message.string_value = "forwarded";
+  input_publisher->publish(message);
+
+  auto received = [&]() {
+      rclcpp::spin_some(publisher_node_);
+      return !received_messages.empty();
+    };
+  ASSERT_TRUE(wait_for(received, 5s));
+  EXPECT_EQ(1u, forwarded_count);
+  EXPECT_THAT(received_messages, ElementsAre(StrEq("forwarded")));
+}
+
+TEST_F(RclcppGenericNodeFixture, intra_process_generic_subscription_view_callback)
+{
+  using namespace std::chrono_literals;
+  std::string topic_name = "/intra_process_view_topic";
+  std::string topic_type = "test_msgs/msg/Strings";
+  auto node = std::make_shared<rclcpp::Node>(
+    "intra_process_view_node", rclcpp::NodeOptions().use_intra_process_comms(true));
+
+  std::vector<std::string> messages;
+  auto subscription = node->create_generic_subscription(
+    topic_name, topic_type, rclcpp::QoS(10),
+    [&messages](
+      const rclcpp::SerializedMessageView & message, const rclcpp::MessageInfo & message_info) {
+      EXPECT_TRUE(message_info.get_rmw_message_info().from_intra_process);
+      rclcpp::SerializedMessage serialized_message(message.get_rcl_serialized_message());
+      rclcpp::Serialization<test_msgs::msg::Strings> serialization;
+      test_msgs::msg::Strings deserialized_message;
+      serialization.deserialize_message(&serialized_message, &deserialized_message);
+      messages.push_back(deserialized_message.string_value);
+    });
+  EXPECT_TRUE(subscription->is_view_callback());
+  auto generic_publisher = node->create_generic_publisher(topic_name, topic_type, 10);
+  EXPECT_EQ(1u, generic_publisher->get_intra_process_subscription_count());
+
+  auto serialized_message = serialize_message<std::string, test_msgs::msg::Strings>("view");
+  generic_publisher->publish(rclcpp::SerializedMessageView(serialized_message));
+
+  auto received = [&messages, &node]() {
+      rclcpp::spin_some(node);
+      return !messages.empty();
+    };
+  ASSERT_TRUE(wait_for(received, 5s));
+  EXPECT_THAT(messages, ElementsAre(StrEq("view")));
+}
+
+TEST_F(RclcppGenericNodeFixture, publish_fragments_and_borrowed_messages)
+{
+  using namespace std::chrono_literals;
+  std::string topic_name = "/fragments_topic";
+  std::string topic_type = "test_msgs/msg/Strings";
+  auto node = std::make_shared<rclcpp::Node>(
+    "fragments_node", rclcpp::NodeOptions().use_intra_process_comms(true));
+
+  std::vector<std::string> messages;
+  auto subscription = node->create_generic_subscription(
+    topic_name, topic_type, rclcpp::QoS(10),
+    [&messages](std::shared_ptr<rclcpp::SerializedMessage> message) {
+      rclcpp::Serialization<test_msgs::msg::Strings> serialization;
+      test_msgs::msg::Strings deserialized_message;
+      serialization.deserialize_message(message.get(), &deserialized_message);
+      messages.push_back(deserialized_message.string_value);
+    });
+  rclcpp::PublisherOptions options;
+  options.loaned_message_pool_depth = 1;
+  auto generic_publisher = node->create_generic_publisher(
+    topic_name, topic_type, 10, options);
+
+  // The serialized message is forwarded in three parts
+  auto serialized_message = serialize_message<std::string, test_msgs::msg::Strings>(
+    "fragments");
+  const uint8_t * data = serialized_message.get_rcl_serialized_message().buffer;
+  const size_t size = serialized_message.size();
+  std::vector<rclcpp::SerializedMessageView> fragments {
+    rclcpp::SerializedMessageView(data, 4),
+    rclcpp::SerializedMessageView(data + 4, 0),
+    rclcpp::SerializedMessageView(data + 4, size - 4)};
+  generic_publisher->publish(fragments);
+
+  {
+    auto borrowed = generic_publisher->borrow_serialized_message(size);
+    ASSERT_GE(borrowed->capacity(), size);
+    auto & borrowed_message = borrowed->get_rcl_serialized_message();
+    std::memcpy(borrowed_message.buffer, data, size);
+    borrowed_message.buffer_length = size;
+    generic_publisher->publish(*borrowed);
+  }
+  auto statistics = generic_publisher->get_serialized_message_pool_statistics();
+  EXPECT_EQ(1u, statistics.allocations);
+  EXPECT_EQ(1u, statistics.reuses);
+
+  auto received = [&messages, &node]() {
+      rclcpp::spin_some(node);
+      return messages.size() >= 2u;
+    };
+  ASSERT_TRUE(wait_for(received, 5s));
+  EXPECT_THAT(messages, ElementsAre(StrEq("fragments"), StrEq("fragments")));
+}
+
+TEST_F(RclcppGenericNodeFixture, compressed_payloads_are_decompressed)
+{
+  using namespace std::chrono_literals;
+  std::string topic_name = "/compressed_string_topic";
+  std::string topic_type = "test_msgs/msg/Strings";
+
+  rclcpp::PublisherOptions publisher_options;
+  publisher_options.payload_compression.encoding = "lz4";
+  auto publisher = publisher_node_->create_generic_publisher(
+    topic_name, topic_type, rclcpp::QoS(10), publisher_options);
+
+  std::vector<std::string> generic_messages;
+  auto generic_subscription = node_->create_generic_subscription(
+    topic_name, topic_type, rclcpp::QoS(10),
+    [&generic_messages](std::shared_ptr<rclcpp::SerializedMessage> message) {
+      EXPECT_FALSE(
+        rclcpp::PayloadDecompressor::is_compressed(message->get_rcl_serialized_message()));
+      rclcpp::Serialization<test_msgs::msg::Strings> serialization;
+      test_msgs::msg::Strings deserialized_message;
+      serialization.deserialize_message(message.get(), &deserialized_message);
+      generic_messages.push_back(deserialized_message.string_value);
+    });
+
+  rclcpp::SubscriptionOptions subscription_options;
+  subscription_options.decompress_payloads = true;
+  std::vector<std::string> typed_messages;
+  auto typed_subscription = node_->create_subscription<test_msgs::msg::Strings>(
+    topic_name, rclcpp::QoS(10),
+    [&typed_messages](const test_msgs::msg::Strings & message) {
+      typed_messages.push_back(message.string_value);
+    },
+    subscription_options);
+
+  auto connected = [&]() -> bool {
+      return publisher->get_subscription_count() == 2u;
+    };
+  ASSERT_TRUE(wait_for(connected, 5s));
+
+  const std::string data(10000, 'c');
+  publisher->publish(serialize_message<std::string, test_msgs::msg::Strings>(data));
+
+  auto received = [&]() {
+      return !generic_messages.empty() && !typed_messages.empty();
+    };
+  ASSERT_TRUE(wait_for(received, 5s));
+  EXPECT_THAT(generic_messages, ElementsAre(StrEq(data)));
+  EXPECT_THAT(typed_messages, ElementsAre(StrEq(data)));
+}
@@ -0,0 +1,180 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp/serialization.hpp"
+#include "rclcpp/serialized_message.hpp"
+
+#include "test_msgs/srv/basic_types.hpp"
+
+using namespace std::chrono_literals;
+
+using BasicTypes = test_msgs::srv::BasicTypes;
+
+class TestGenericService : public ::testing::Test
+{
+public:
+  static void SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  static void TearDownTestCase()
+  {
+    rclcpp::shutdown();
+  }
+
+protected:
+  void SetUp()
+  {
+    node_ = std::make_shared<rclcpp::Node>("test_generic_service", "/ns");
+  }
+
+  void TearDown()
+  {
+    node_.reset();
+  }
+
+  static rclcpp::SerializedMessage serialize_request(int32_t value)
+  {
+    BasicTypes::Request request;
+    request.int32_value = value;
+    request.string_value = "request";
+    rclcpp::SerializedMessage serialized;
+    rclcpp::Serialization<BasicTypes::Request>().serialize_message(&request, &serialized);
+    return serialized;
+  }
+
+  static BasicTypes::Request deserialize_request(const rclcpp::SerializedMessage & serialized)
+  {
+    BasicTypes::Request request;
+    rclcpp::Serialization<BasicTypes::Request>().deserialize_message(&serialized, &request);
+    return request;
+  }
+
+  static rclcpp::SerializedMessage serialize_response(int32_t value)
+  {
+    BasicTypes::Response response;
+    response.int32_value = value;
+    response.string_value = "response";
+    rclcpp::SerializedMessage serialized;
+    rclcpp::Serialization<BasicTypes::Response>().serialize_message(&response, &serialized);
+    return serialized;
+  }
+
+  static BasicTypes::Response deserialize_response(const rclcpp::SerializedMessage & serialized)
+  {
+    BasicTypes::Response response;
+    rclcpp::Serialization<BasicTypes::Response>().deserialize_message(&serialized, &response);
+    return response;
+  }
+
+  rclcpp::Node::SharedPtr node_;
+};
+
+TEST_F(TestGenericService, construction_and_destruction) {
+  auto service = node_->create_generic_service(
+    "service", "test_msgs/srv/BasicTypes",
+    [](
+      const rclcpp::GenericService::SharedRequest,
+      rclcpp::GenericService::SharedResponse) {});
+  EXPECT_EQ("test_msgs/srv/BasicTypes", service->get_service_type());
+  EXPECT_STREQ("/ns/service", service->get_service_name());
+
+  auto client = node_->create_generic_client("service", "test_msgs/srv/BasicTypes");
+  EXPECT_EQ("test_msgs/srv/BasicTypes", client->get_service_type());
+  EXPECT_STREQ("/ns/service", client->get_service_name());
+
+  EXPECT_THROW(
+    node_->create_generic_client("service", "test_msgs/srv/NotAType"), std::runtime_error);
+  EXPECT_THROW(
+    node_->create_generic_client("service", "not_a_package/srv/BasicTypes"), std::runtime_error);
+}
+
+TEST_F(TestGenericService, request_and_response) {
+  auto service = node_->create_generic_service(
+    "service", "test_msgs/srv/BasicTypes",
+    [](
+      const rclcpp::GenericService::SharedRequest request,
+      rclcpp::GenericService::SharedResponse response) {
+      *response = serialize_response(deserialize_request(*request).int32_value + 1);
+    });
+  auto client = node_->create_generic_client("service", "test_msgs/srv/BasicTypes");
+  ASSERT_TRUE(client->wait_for_service(5s));
+
+  auto future = client->async_send_request(serialize_request(41));
+  ASSERT_EQ(
+    rclcpp::FutureReturnCode::SUCCESS,
+    rclcpp::spin_until_future_complete(node_, future, 5s));
+  auto response = deserialize_response(*future.get());
+  EXPECT_EQ(42, response.int32_value);
+  EXPECT_EQ("response", response.string_value);
+  EXPECT_EQ(0u, client->prune_pending_requests());
+}
+
+TEST_F(TestGenericService, deferred_response_and_callback) {
+  std::shared_ptr<rmw_request_id_t> deferred_header;
+  int32_t deferred_value = 0;
+  auto service = node_->create_generic_service(
+    "service", "test_msgs/srv/BasicTypes",
+    [&deferred_header, &deferred_value](
+      std::shared_ptr<rclcpp::GenericService>,
+      const std::shared_ptr<rmw_request_id_t> request_header,
+      const rclcpp::GenericService::SharedRequest request) {
+      deferred_header = request_header;
+      deferred_value = deserialize_request(*request).int32_value;
+    });
+  auto client = node_->create_generic_client("service", "test_msgs/srv/BasicTypes");
+  ASSERT_TRUE(client->wait_for_service(5s));
+
+  bool callback_called = false;
+  auto future = client->async_send_request(
+    serialize_request(10),
+    [&callback_called](rclcpp::GenericClient::SharedFuture future) {
+      callback_called = true;
+      EXPECT_EQ(20, deserialize_response(*future.get()).int32_value);
+    });
+
+  auto start = std::chrono::steady_clock::now();
+  while (!deferred_header && std::chrono::steady_clock::now() - start < 5s) {
+    rclcpp::spin_some(node_);
+  }
+  ASSERT_NE(nullptr, deferred_header);
+  EXPECT_EQ(10, deferred_value);
+  EXPECT_EQ(std::future_status::timeout, future.wait_for(0s));
+
+  service->send_response(*deferred_header, serialize_response(deferred_value * 2));
+  ASSERT_EQ(
+    rclcpp::FutureReturnCode::SUCCESS,
+    rclcpp::spin_until_future_complete(node_, future, 5s));
+  EXPECT_TRUE(callback_called);
+}
+
+TEST_F(TestGenericService, remove_pending_request) {
+  auto client = node_->create_generic_client("service", "test_msgs/srv/BasicTypes");
+
+  auto future = client->async_send_request(serialize_request(1));
+  EXPECT_TRUE(client->remove_pending_request(future));
+  EXPECT_FALSE(client->remove_pending_request(future));
+
+  client->async_send_request(serialize_request(2));
+  client->async_send_request(serialize_request(3));
+  EXPECT_EQ(2u, client->prune_pending_requests());
+}
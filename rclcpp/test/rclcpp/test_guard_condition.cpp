@@ -182,3 +182,67 @@ TEST_F(TestGuardCondition, callback_and_waitset) {
   EXPECT_EQ(rclcpp::WaitResultKind::Ready, wait_set.wait(std::chrono::seconds(1)).kind());
   EXPECT_EQ(c1.load(), 1u);
 }
+
+/*
+ * Testing that coalesced triggers reach the rcl guard condition once per wait
+ */
+TEST_F(TestGuardCondition, trigger_coalescing) {
+  auto gc = std::make_shared<rclcpp::GuardCondition>();
+  EXPECT_FALSE(gc->get_trigger_coalescing());
+  gc->set_trigger_coalescing(true);
+  EXPECT_TRUE(gc->get_trigger_coalescing());
+
+  {
+    size_t rcl_triggers = 0;
+    auto mock = mocking_utils::patch(
+      "lib:rclcpp", rcl_trigger_guard_condition, [&rcl_triggers](rcl_guard_condition_t *) {
+        ++rcl_triggers;
+        return RCL_RET_OK;
+      });
+
+    gc->trigger();
+    gc->trigger();
+    gc->trigger();
+    EXPECT_EQ(1u, rcl_triggers);
+
+    // A skipped trigger is replayed when the guard condition is waited on again.
+    gc->reset_coalesced_triggers();
+    EXPECT_EQ(2u, rcl_triggers);
+    gc->reset_coalesced_triggers();
+    EXPECT_EQ(2u, rcl_triggers);
+
+    gc->trigger();
+    EXPECT_EQ(3u, rcl_triggers);
+    gc->reset_coalesced_triggers();
+    EXPECT_EQ(3u, rcl_triggers);
+
+    // The callback is called for every trigger.
+    size_t callback_count = 0;
+    gc->set_on_trigger_callback([&callback_count](size_t count) {callback_count += count;});
+    gc->trigger();
+    gc->trigger();
+    EXPECT_EQ(4u, rcl_triggers);
+    EXPECT_EQ(2u, callback_count);
+    gc->set_on_trigger_callback(nullptr);
+
+    // Disabling the coalescing replays the skipped trigger.
+    gc->set_trigger_coalescing(false);
+    EXPECT_EQ(5u, rcl_triggers);
+    gc->trigger();
+    gc->trigger();
+    EXPECT_EQ(7u, rcl_triggers);
+  }
+
+  gc->set_trigger_coalescing(true);
+  rclcpp::WaitSet wait_set;
+  wait_set.add_guard_condition(gc);
+
+  gc->trigger();
+  gc->trigger();
+  EXPECT_EQ(rclcpp::WaitResultKind::Ready, wait_set.wait(std::chrono::seconds(1)).kind());
+  EXPECT_EQ(rclcpp::WaitResultKind::Timeout, wait_set.wait(std::chrono::milliseconds(0)).kind());
+
+  // Once waited on, the next trigger wakes the wait set up again.
+  gc->trigger();
+  EXPECT_EQ(rclcpp::WaitResultKind::Ready, wait_set.wait(std::chrono::seconds(1)).kind());
+}
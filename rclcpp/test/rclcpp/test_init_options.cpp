@@ -14,6 +14,7 @@
 
 #include <gtest/gtest.h>
 
+#include <chrono>
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -65,6 +66,52 @@ TEST(TestInitOptions, test_initialize_logging) {
   }
 }
 
+TEST(TestInitOptions, test_async_logging) {
+  auto options = rclcpp::InitOptions();
+  EXPECT_EQ(0u, options.async_logging.depth);
+  options.async_logging.depth = 16;
+  options.async_logging.flush_period = std::chrono::milliseconds(5);
+
+  auto options_copy = rclcpp::InitOptions(options);
+  EXPECT_EQ(16u, options_copy.async_logging.depth);
+  EXPECT_EQ(std::chrono::milliseconds(5), options_copy.async_logging.flush_period);
+
+  rclcpp::InitOptions options_assigned;
+  options_assigned = options;
+  EXPECT_EQ(16u, options_assigned.async_logging.depth);
+}
+
+TEST(TestInitOptions, test_fast_teardown) {
+  auto options = rclcpp::InitOptions();
+  EXPECT_FALSE(options.fast_teardown);
+  options.fast_teardown = true;
+
+  auto options_copy = rclcpp::InitOptions(options);
+  EXPECT_TRUE(options_copy.fast_teardown);
+
+  rclcpp::InitOptions options_assigned;
+  options_assigned = options;
+  EXPECT_TRUE(options_assigned.fast_teardown);
+}
+
+TEST(TestInitOptions, test_worker_pool) {
+  auto options = rclcpp::InitOptions();
+  EXPECT_EQ(0u, options.worker_pool.number_of_threads);
+  EXPECT_TRUE(options.worker_pool.thread_attributes.empty());
+  options.worker_pool.number_of_threads = 2;
+  options.worker_pool.thread_attributes.resize(1);
+  options.worker_pool.thread_attributes[0].cpu_set = {1};
+
+  auto options_copy = rclcpp::InitOptions(options);
+  EXPECT_EQ(2u, options_copy.worker_pool.number_of_threads);
+  ASSERT_EQ(1u, options_copy.worker_pool.thread_attributes.size());
+  EXPECT_EQ(std::vector<size_t>{1}, options_copy.worker_pool.thread_attributes[0].cpu_set);
+
+  rclcpp::InitOptions options_assigned;
+  options_assigned = options;
+  EXPECT_EQ(2u, options_assigned.worker_pool.number_of_threads);
+}
+
 TEST(TestInitOptions, test_domain_id) {
   rcl_allocator_t allocator = rcl_get_default_allocator();
   auto options = rclcpp::InitOptions(allocator);
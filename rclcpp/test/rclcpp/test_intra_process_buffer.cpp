@@ -14,10 +14,12 @@
 
 
 #include <memory>
+#include <stdexcept>
 #include <utility>
 
 #include "gtest/gtest.h"
 
+#include "rclcpp/experimental/create_intra_process_buffer.hpp"
 #include "rclcpp/rclcpp.hpp"
 
 /*
@@ -238,3 +240,88 @@ TEST(TestIntraProcessBuffer, unique_buffer_consume) {
   EXPECT_EQ(original_value, *popped_unique_msg);
   EXPECT_EQ(original_message_pointer, popped_message_pointer);
 }
+
+template<typename BufferT>
+class CountingBufferImplementation
+  : public rclcpp::experimental::buffers::RingBufferImplementation<BufferT>
+{
+public:
+  explicit CountingBufferImplementation(size_t capacity)
+  : rclcpp::experimental::buffers::RingBufferImplementation<BufferT>(capacity)
+  {
+    ++instances;
+    last_capacity = capacity;
+  }
+
+  void enqueue(BufferT request) override
+  {
+    ++enqueued;
+    rclcpp::experimental::buffers::RingBufferImplementation<BufferT>::enqueue(std::move(request));
+  }
+
+  static size_t instances;
+  static size_t last_capacity;
+  static size_t enqueued;
+};
+
+template<typename BufferT>
+size_t CountingBufferImplementation<BufferT>::instances = 0;
+template<typename BufferT>
+size_t CountingBufferImplementation<BufferT>::last_capacity = 0;
+template<typename BufferT>
+size_t CountingBufferImplementation<BufferT>::enqueued = 0;
+
+/*
+  Create intra-process buffers with the implementation of a factory
+  - The implementation is created with the depth of the QoS for both buffer types
+  - A factory not creating the buffer type is rejected
+ */
+TEST(TestIntraProcessBuffer, buffer_factory) {
+  using MessageT = char;
+  using SharedMessageT = std::shared_ptr<const MessageT>;
+  using UniqueMessageT = std::unique_ptr<MessageT>;
+  using rclcpp::experimental::buffers::DepthBufferImplementationFactory;
+  auto factory = std::make_shared<
+    DepthBufferImplementationFactory<CountingBufferImplementation, MessageT>>();
+  auto allocator = std::make_shared<std::allocator<void>>();
+
+  auto shared_buffer = rclcpp::experimental::create_intra_process_buffer<MessageT>(
+    rclcpp::IntraProcessBufferType::SharedPtr, rclcpp::QoS(3), allocator,
+    rclcpp::IntraProcessBufferImplementation::Default, factory);
+  EXPECT_EQ(1u, CountingBufferImplementation<SharedMessageT>::instances);
+  EXPECT_EQ(3u, CountingBufferImplementation<SharedMessageT>::last_capacity);
+  shared_buffer->add_shared(std::make_shared<char>('a'));
+  EXPECT_EQ(1u, CountingBufferImplementation<SharedMessageT>::enqueued);
+  EXPECT_EQ('a', *shared_buffer->consume_shared());
+
+  auto unique_buffer = rclcpp::experimental::create_intra_process_buffer<MessageT>(
+    rclcpp::IntraProcessBufferType::UniquePtr, rclcpp::QoS(5), allocator,
+    rclcpp::IntraProcessBufferImplementation::Default, factory);
+  EXPECT_EQ(1u, CountingBufferImplementation<UniqueMessageT>::instances);
+  EXPECT_EQ(5u, CountingBufferImplementation<UniqueMessageT>::last_capacity);
+  unique_buffer->add_unique(std::make_unique<char>('b'));
+  EXPECT_EQ('b', *unique_buffer->consume_unique());
+
+  class UniqueOnlyFactory
+    : public rclcpp::experimental::buffers::BufferImplementationFactory<UniqueMessageT>
+  {
+  public:
+    std::unique_ptr<rclcpp::experimental::buffers::BufferImplementationBase<UniqueMessageT>>
+    create_buffer_implementation(const rclcpp::QoS &) override
+    {
+      return nullptr;
+    }
+  };
+  auto unique_only_factory = std::make_shared<UniqueOnlyFactory>();
+  EXPECT_THROW(
+    rclcpp::experimental::create_intra_process_buffer<MessageT>(
+      rclcpp::IntraProcessBufferType::SharedPtr, rclcpp::QoS(1), allocator,
+      rclcpp::IntraProcessBufferImplementation::Default, unique_only_factory),
+    std::invalid_argument);
+  // No buffer created
+  EXPECT_THROW(
+    rclcpp::experimental::create_intra_process_buffer<MessageT>(
+      rclcpp::IntraProcessBufferType::UniquePtr, rclcpp::QoS(1), allocator,
+      rclcpp::IntraProcessBufferImplementation::Default, unique_only_factory),
+    std::invalid_argument);
+}
@@ -22,7 +22,9 @@
 
 #define RCLCPP_BUILDING_LIBRARY 1
 #include "rclcpp/allocator/allocator_common.hpp"
+#include "rclcpp/content_filter.hpp"
 #include "rclcpp/context.hpp"
+#include "rclcpp/experimental/lazy_serialized_message.hpp"
 #include "rclcpp/macros.hpp"
 #include "rclcpp/qos.hpp"
 #include "rmw/types.h"
@@ -81,19 +83,18 @@ public:
   }
 
   bool
-  operator==(const rmw_gid_t & gid) const
+  operator==(const rmw_gid_t & other) const
   {
-    (void)gid;
-    return false;
+    return &other == &gid;
   }
 
   bool
-  operator==(const rmw_gid_t * gid) const
+  operator==(const rmw_gid_t * other) const
   {
-    (void)gid;
-    return false;
+    return other == &gid;
   }
 
+  rmw_gid_t gid {};
   rclcpp::QoS qos_profile;
   std::string topic_name;
   uint64_t intra_process_publisher_id_;
@@ -221,6 +222,24 @@ public:
     return topic_name.c_str();
   }
 
+  bool
+  drop_by_rate_limit()
+  {
+    return false;
+  }
+
+  bool
+  drop_by_pause()
+  {
+    return false;
+  }
+
+  std::shared_ptr<const rclcpp::ContentFilter>
+  get_content_filter() const
+  {
+    return nullptr;
+  }
+
   rclcpp::QoS qos_profile;
   std::string topic_name;
 };
@@ -304,6 +323,31 @@ public:
   }
 };
 
+class SubscriptionIntraProcessSerialized : public SubscriptionIntraProcessBase
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(SubscriptionIntraProcessSerialized)
+
+  explicit SubscriptionIntraProcessSerialized(rclcpp::QoS qos = rclcpp::QoS(10))
+  : SubscriptionIntraProcessBase(nullptr, "topic", qos)
+  {
+  }
+
+  void
+  provide_serialized_message(rclcpp::experimental::LazySerializedMessage::SharedPtr msg)
+  {
+    messages.push_back(std::move(msg));
+  }
+
+  bool
+  use_take_shared_method() const
+  {
+    return true;
+  }
+
+  std::vector<rclcpp::experimental::LazySerializedMessage::SharedPtr> messages;
+};
+
 }  // namespace mock
 }  // namespace experimental
 }  // namespace rclcpp
@@ -314,6 +358,7 @@ public:
 #define RCLCPP__EXPERIMENTAL__SUBSCRIPTION_INTRA_PROCESS_HPP_
 #define RCLCPP__EXPERIMENTAL__SUBSCRIPTION_INTRA_PROCESS_BUFFER_HPP_
 #define RCLCPP__EXPERIMENTAL__SUBSCRIPTION_INTRA_PROCESS_BASE_HPP_
+#define RCLCPP__EXPERIMENTAL__SUBSCRIPTION_INTRA_PROCESS_SERIALIZED_HPP_
 // Force ipm to use our mock publisher class.
 #define Publisher mock::Publisher
 #define PublisherBase mock::PublisherBase
@@ -321,12 +366,14 @@ public:
 #define SubscriptionIntraProcessBase mock::SubscriptionIntraProcessBase
 #define SubscriptionIntraProcessBuffer mock::SubscriptionIntraProcessBuffer
 #define SubscriptionIntraProcess mock::SubscriptionIntraProcess
+#define SubscriptionIntraProcessSerialized mock::SubscriptionIntraProcessSerialized
 #include "../src/rclcpp/intra_process_manager.cpp"  // NOLINT
 #undef Publisher
 #undef PublisherBase
 #undef IntraProcessBuffer
 #undef SubscriptionIntraProcessBase
 #undef SubscriptionIntraProcess
+#undef SubscriptionIntraProcessSerialized
 
 using ::testing::_;
 using ::testing::UnorderedElementsAre;
@@ -423,6 +470,46 @@ TEST(TestIntraProcessManager, add_pub_sub) {
   ASSERT_EQ(1u, p3_subs);
 }
 
+/*
+   This tests the removal of all the entities at once:
+   - Add two publishers and a subscription, and clear the manager.
+   - The publishers are expected to have no subscription anymore.
+   - Removing the cleared entities is expected to be a no-op.
+   - Entities added afterwards are expected to communicate again.
+ */
+TEST(TestIntraProcessManager, clear) {
+  using IntraProcessManagerT = rclcpp::experimental::IntraProcessManager;
+  using MessageT = rcl_interfaces::msg::Log;
+  using PublisherT = rclcpp::mock::Publisher<MessageT>;
+  using SubscriptionIntraProcessT = rclcpp::experimental::mock::SubscriptionIntraProcess<MessageT>;
+
+  auto ipm = std::make_shared<IntraProcessManagerT>();
+
+  auto p1 = std::make_shared<PublisherT>(rclcpp::QoS(10).best_effort());
+  auto p2 = std::make_shared<PublisherT>(rclcpp::QoS(10).best_effort());
+  auto s1 = std::make_shared<SubscriptionIntraProcessT>(rclcpp::QoS(10).best_effort());
+
+  auto p1_id = ipm->add_publisher(p1);
+  auto p2_id = ipm->add_publisher(p2);
+  auto s1_id = ipm->add_subscription(s1);
+  ASSERT_EQ(1u, ipm->get_subscription_count(p1_id));
+  ASSERT_EQ(1u, ipm->get_subscription_count(p2_id));
+
+  ipm->clear();
+  EXPECT_EQ(0u, ipm->get_subscription_count(p1_id));
+  EXPECT_EQ(0u, ipm->get_subscription_count(p2_id));
+  EXPECT_FALSE(ipm->matches_any_publishers(&p1->gid));
+
+  EXPECT_NO_THROW(ipm->remove_subscription(s1_id));
+  EXPECT_NO_THROW(ipm->remove_publisher(p1_id));
+
+  auto p3 = std::make_shared<PublisherT>(rclcpp::QoS(10).best_effort());
+  auto s2 = std::make_shared<SubscriptionIntraProcessT>(rclcpp::QoS(10).best_effort());
+  auto p3_id = ipm->add_publisher(p3);
+  ipm->add_subscription(s2);
+  EXPECT_EQ(1u, ipm->get_subscription_count(p3_id));
+}
+
 /*
    This tests the minimal usage of the class where there is a single subscription per publisher:
    - Publishes a unique_ptr message with a subscription requesting ownership.
@@ -712,3 +799,167 @@ TEST(TestIntraProcessManager, multiple_subscriptions_different_type) {
   EXPECT_EQ(original_message_pointer, received_message_pointer_10);
   EXPECT_NE(original_message_pointer, received_message_pointer_11);
 }
+
+/*
+   This tests the publication of a message kept by the publisher:
+   - Without subscriptions the message isn't copied.
+   - Publishes with 2 subscriptions not requesting ownership.
+   - Both are expected to receive the same copy, which is returned.
+   - Publishes with 1 subscription requesting ownership and 1 not.
+   - The one requesting ownership is expected to receive its own copy, while the other
+     receives the returned copy if requested.
+ */
+TEST(TestIntraProcessManager, publish_copy) {
+  using IntraProcessManagerT = rclcpp::experimental::IntraProcessManager;
+  using MessageT = rcl_interfaces::msg::Log;
+  using PublisherT = rclcpp::mock::Publisher<MessageT>;
+  using SubscriptionIntraProcessT = rclcpp::experimental::mock::SubscriptionIntraProcess<MessageT>;
+
+  auto ipm = std::make_shared<IntraProcessManagerT>();
+
+  auto p1 = std::make_shared<PublisherT>();
+  auto p1_id = ipm->add_publisher(p1);
+  p1->set_intra_process_manager(p1_id, ipm);
+
+  MessageT msg;
+  msg.msg = "kept";
+  auto & allocator = *p1->message_allocator_;
+  EXPECT_EQ(
+    nullptr, (ipm->do_intra_process_publish_copy<MessageT, MessageT>(p1_id, msg, allocator)));
+
+  auto s1 = std::make_shared<SubscriptionIntraProcessT>();
+  s1->take_shared_method = true;
+  auto s1_id = ipm->add_subscription(s1);
+  auto s2 = std::make_shared<SubscriptionIntraProcessT>();
+  s2->take_shared_method = true;
+  ipm->add_subscription(s2);
+
+  auto shared_msg = ipm->do_intra_process_publish_copy<MessageT, MessageT>(p1_id, msg, allocator);
+  ASSERT_NE(nullptr, shared_msg);
+  auto shared_message_pointer = reinterpret_cast<std::uintptr_t>(shared_msg.get());
+  ASSERT_NE(reinterpret_cast<std::uintptr_t>(&msg), shared_message_pointer);
+  ASSERT_EQ(shared_message_pointer, s1->pop());
+  ASSERT_EQ(shared_message_pointer, s2->pop());
+  ASSERT_EQ("kept", s2->buffer->shared_msg->msg);
+
+  ipm->remove_subscription(s1_id);
+  auto s3 = std::make_shared<SubscriptionIntraProcessT>();
+  s3->take_shared_method = false;
+  ipm->add_subscription(s3);
+
+  EXPECT_EQ(
+    nullptr, (ipm->do_intra_process_publish_copy<MessageT, MessageT>(p1_id, msg, allocator)));
+  auto received_message_pointer_2 = s2->pop();
+  auto received_message_pointer_3 = s3->pop();
+  ASSERT_NE(0u, received_message_pointer_2);
+  ASSERT_NE(0u, received_message_pointer_3);
+  ASSERT_NE(received_message_pointer_2, received_message_pointer_3);
+  ASSERT_EQ("kept", s3->buffer->unique_msg->msg);
+
+  shared_msg = ipm->do_intra_process_publish_copy<MessageT, MessageT>(
+    p1_id, msg, allocator, nullptr, nullptr, true);
+  ASSERT_NE(nullptr, shared_msg);
+  ASSERT_EQ(reinterpret_cast<std::uintptr_t>(shared_msg.get()), s2->pop());
+  received_message_pointer_3 = s3->pop();
+  ASSERT_NE(0u, received_message_pointer_3);
+  ASSERT_NE(reinterpret_cast<std::uintptr_t>(shared_msg.get()), received_message_pointer_3);
+}
+
+/*
+   This tests the history of a transient local publisher:
+   - Publishes 3 messages with a transient local publisher of depth 2 and no subscription.
+   - Add a transient local subscription not requesting ownership.
+   - The last message is expected to be the last one published, shared with the subscription.
+   - Add a transient local subscription requesting ownership.
+   - It's expected to receive a copy of the last message.
+ */
+TEST(TestIntraProcessManager, transient_local_history) {
+  using IntraProcessManagerT = rclcpp::experimental::IntraProcessManager;
+  using MessageT = rcl_interfaces::msg::Log;
+  using PublisherT = rclcpp::mock::Publisher<MessageT>;
+  using SubscriptionIntraProcessT = rclcpp::experimental::mock::SubscriptionIntraProcess<MessageT>;
+
+  auto ipm = std::make_shared<IntraProcessManagerT>();
+
+  auto p1 = std::make_shared<PublisherT>(rclcpp::QoS(2).transient_local());
+  auto p1_id = ipm->add_publisher(p1);
+  p1->set_intra_process_manager(p1_id, ipm);
+
+  std::uintptr_t original_message_pointer = 0;
+  for (size_t i = 0; i < 3; ++i) {
+    auto unique_msg = std::make_unique<MessageT>();
+    unique_msg->msg = std::to_string(i);
+    original_message_pointer = reinterpret_cast<std::uintptr_t>(unique_msg.get());
+    p1->publish(std::move(unique_msg));
+  }
+
+  auto s1 = std::make_shared<SubscriptionIntraProcessT>(rclcpp::QoS(10).transient_local());
+  s1->take_shared_method = true;
+  ipm->add_subscription(s1);
+  ASSERT_EQ(original_message_pointer, s1->pop());
+  ASSERT_EQ("2", s1->buffer->shared_msg->msg);
+
+  auto s2 = std::make_shared<SubscriptionIntraProcessT>(rclcpp::QoS(10).transient_local());
+  s2->take_shared_method = false;
+  ipm->add_subscription(s2);
+  auto received_message_pointer = s2->pop();
+  ASSERT_NE(0u, received_message_pointer);
+  ASSERT_NE(original_message_pointer, received_message_pointer);
+  ASSERT_EQ("2", s2->buffer->unique_msg->msg);
+}
+
+/*
+   This tests the subscriptions of serialized messages
+   - Creates 1 publisher of typed messages and 1 publisher of serialized messages
+   - Creates 1 typed subscription and 2 subscriptions of serialized messages
+   - The typed message is wrapped once for both subscriptions of serialized messages
+   - The serialized message is only given to the subscriptions of serialized messages
+ */
+TEST(TestIntraProcessManager, serialized_subscriptions) {
+  using IntraProcessManagerT = rclcpp::experimental::IntraProcessManager;
+  using MessageT = rcl_interfaces::msg::Log;
+  using PublisherT = rclcpp::mock::Publisher<MessageT>;
+  using SubscriptionIntraProcessT = rclcpp::experimental::mock::SubscriptionIntraProcess<MessageT>;
+  using SerializedSubscriptionT = rclcpp::experimental::mock::SubscriptionIntraProcessSerialized;
+
+  auto ipm = std::make_shared<IntraProcessManagerT>();
+
+  auto p1 = std::make_shared<PublisherT>();
+  auto p1_id = ipm->add_publisher(p1);
+  p1->set_intra_process_manager(p1_id, ipm);
+  auto p2 = std::make_shared<PublisherT>();
+  auto p2_id = ipm->add_serialized_publisher(p2);
+
+  auto s1 = std::make_shared<SubscriptionIntraProcessT>();
+  s1->take_shared_method = false;
+  ipm->add_subscription(s1);
+  auto s2 = std::make_shared<SerializedSubscriptionT>();
+  ipm->add_subscription(s2);
+  auto s3 = std::make_shared<SerializedSubscriptionT>();
+  ipm->add_subscription(s3);
+
+  EXPECT_EQ(3u, ipm->get_subscription_count(p1_id));
+  EXPECT_EQ(2u, ipm->get_subscription_count(p2_id));
+
+  auto unique_msg = std::make_unique<MessageT>();
+  auto original_message_pointer = reinterpret_cast<std::uintptr_t>(unique_msg.get());
+  p1->publish(std::move(unique_msg));
+  // The typed subscription takes ownership, the others share a copy
+  EXPECT_EQ(original_message_pointer, s1->pop());
+  ASSERT_EQ(1u, s2->messages.size());
+  ASSERT_EQ(1u, s3->messages.size());
+  EXPECT_EQ(s2->messages[0], s3->messages[0]);
+
+  auto serialized_msg = std::make_shared<const rclcpp::SerializedMessage>(16u);
+  ipm->do_serialized_intra_process_publish(p2_id, serialized_msg);
+  ASSERT_EQ(2u, s2->messages.size());
+  ASSERT_EQ(2u, s3->messages.size());
+  EXPECT_EQ(serialized_msg, s2->messages[1]->get_serialized_message());
+  EXPECT_EQ(serialized_msg, s3->messages[1]->get_serialized_message());
+  EXPECT_EQ(0u, s1->pop());
+
+  // The typed subscriptions receive the serialized messages from the middleware
+  EXPECT_TRUE(ipm->matches_any_publishers(&p1->gid));
+  EXPECT_FALSE(ipm->matches_any_publishers(&p2->gid));
+  EXPECT_TRUE(ipm->matches_any_publishers(&p2->gid, true));
+}
@@ -17,6 +17,7 @@
 #include <chrono>
 #include <list>
 #include <memory>
+#include <memory_resource>
 #include <string>
 #include <type_traits>
 #include <utility>
@@ -25,6 +26,7 @@
 
 #include "rclcpp/rclcpp.hpp"
 #include "rclcpp/allocator/allocator_common.hpp"
+#include "rclcpp/allocator/memory_resource.hpp"
 #include "rclcpp/strategies/allocator_memory_strategy.hpp"
 
 // For demonstration purposes only, not necessary for allocator_traits
@@ -301,3 +303,21 @@ TEST(TestIntraProcessManagerWithAllocators, custom_allocator_wrong) {
     std::runtime_error  // expected exception
   >(allocator, allocator, my_allocator, my_allocator, my_allocator, allocator);
 }
+
+/*
+   This tests the case where both sides allocate from the same memory resource.
+ */
+TEST(TestIntraProcessManagerWithAllocators, memory_resource_allocator) {
+  using MemoryResourceAllocatorT = rclcpp::allocator::MemoryResourceAllocator<>;
+  std::pmr::synchronized_pool_resource resource;
+  auto allocator = MemoryResourceAllocatorT(&resource);
+  do_custom_allocator_test<
+    MemoryResourceAllocatorT,
+    MemoryResourceAllocatorT,
+    MemoryResourceAllocatorT,
+    MemoryResourceAllocatorT,
+    MemoryResourceAllocatorT,
+    std::allocator<void>,
+    void  // no exception expected
+  >(allocator, allocator, allocator, allocator, allocator, std::allocator<void>());
+}
@@ -0,0 +1,155 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/experimental/keyed_cache.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+#include "rclcpp/msg/header.hpp"
+
+using namespace std::chrono_literals;
+using rclcpp::experimental::KeyedCacheOptions;
+using rclcpp::msg::Header;
+
+using Cache = rclcpp::experimental::KeyedCache<Header, std::string>;
+
+namespace
+{
+std::shared_ptr<const Header>
+make_header(const std::string & frame_id, int32_t sec)
+{
+  auto message = std::make_shared<Header>();
+  message->frame_id = frame_id;
+  message->stamp.sec = sec;
+  return message;
+}
+
+std::string
+frame_id_of(const Header & message)
+{
+  return message.frame_id;
+}
+}  // namespace
+
+TEST(TestKeyedCache, invalid_arguments) {
+  EXPECT_THROW(Cache(KeyedCacheOptions(), nullptr), std::invalid_argument);
+  auto cache = Cache::make_shared(KeyedCacheOptions(), frame_id_of);
+  EXPECT_THROW(cache->add_message(nullptr), std::invalid_argument);
+}
+
+TEST(TestKeyedCache, latest_value_per_key) {
+  auto cache = Cache::make_shared(KeyedCacheOptions(), frame_id_of);
+  cache->add_message(make_header("robot1", 1));
+  cache->add_message(make_header("robot2", 1));
+  cache->add_message(make_header("robot1", 2));
+  EXPECT_EQ(2u, cache->size());
+  EXPECT_EQ(2, cache->get("robot1")->stamp.sec);
+  EXPECT_EQ(nullptr, cache->get("robot3"));
+
+  // Each key changed once, with its latest message, in update order
+  auto changed = cache->take_changed();
+  ASSERT_EQ(2u, changed.size());
+  EXPECT_EQ("robot1", changed[0].first);
+  EXPECT_EQ(2, changed[0].second->stamp.sec);
+  EXPECT_EQ("robot2", changed[1].first);
+  EXPECT_TRUE(cache->take_changed().empty());
+
+  EXPECT_TRUE(cache->erase("robot1"));
+  EXPECT_FALSE(cache->erase("robot1"));
+  cache->clear();
+  EXPECT_EQ(0u, cache->size());
+}
+
+TEST(TestKeyedCache, eviction) {
+  KeyedCacheOptions options;
+  options.max_keys = 2;
+  auto cache = Cache::make_shared(options, frame_id_of);
+  cache->add_message(make_header("robot1", 1));
+  cache->add_message(make_header("robot2", 1));
+  cache->add_message(make_header("robot1", 2));
+  // The least recently updated key is evicted
+  cache->add_message(make_header("robot3", 1));
+  EXPECT_EQ(2u, cache->size());
+  EXPECT_EQ(nullptr, cache->get("robot2"));
+  EXPECT_EQ(1u, cache->get_evicted_count());
+  auto changed = cache->take_changed();
+  ASSERT_EQ(2u, changed.size());
+  EXPECT_EQ("robot1", changed[0].first);
+  EXPECT_EQ("robot3", changed[1].first);
+
+  options.max_keys = 0;
+  options.max_age = 10ms;
+  cache = Cache::make_shared(options, frame_id_of);
+  cache->add_message(make_header("robot1", 1));
+  std::this_thread::sleep_for(20ms);
+  cache->add_message(make_header("robot2", 1));
+  EXPECT_EQ(nullptr, cache->get("robot1"));
+  EXPECT_EQ(1u, cache->get_evicted_count());
+}
+
+TEST(TestKeyedCache, batch_per_executor_pass) {
+  rclcpp::init(0, nullptr);
+  {
+    auto node = std::make_shared<rclcpp::Node>(
+      "test_keyed_cache_node", rclcpp::NodeOptions().use_intra_process_comms(true));
+    std::vector<std::vector<Cache::Entry>> batches;
+    auto cache = Cache::make_shared(
+      KeyedCacheOptions(), frame_id_of,
+      [&batches](const std::vector<Cache::Entry> & changed) {
+        batches.push_back(changed);
+      });
+    cache->subscribe(*node, "keyed_topic", rclcpp::QoS(10));
+    auto publisher = node->create_publisher<Header>("keyed_topic", 10);
+
+    rclcpp::executors::SingleThreadedExecutor executor;
+    executor.add_node(node);
+    // The changes before the executor pass are handled in a single batch
+    cache->add_message(make_header("robot1", 1));
+    cache->add_message(make_header("robot2", 1));
+    cache->add_message(make_header("robot1", 2));
+    executor.spin_some(10ms);
+    ASSERT_EQ(1u, batches.size());
+    ASSERT_EQ(2u, batches[0].size());
+    EXPECT_EQ("robot1", batches[0][0].first);
+    EXPECT_EQ(2, batches[0][0].second->stamp.sec);
+    EXPECT_EQ("robot2", batches[0][1].first);
+    executor.spin_some(10ms);
+    EXPECT_EQ(1u, batches.size());
+
+    // The messages of the subscription are batched as well
+    publisher->publish(*make_header("robot3", 1));
+    publisher->publish(*make_header("robot3", 2));
+    const auto end = std::chrono::steady_clock::now() + 10s;
+    auto latest = [&batches]() {
+        return batches.size() > 1 ? batches.back().back().second->stamp.sec : 0;
+      };
+    while (latest() != 2 && std::chrono::steady_clock::now() < end) {
+      executor.spin_some(10ms);
+    }
+    EXPECT_EQ(2, latest());
+    EXPECT_EQ("robot3", batches.back().back().first);
+    EXPECT_LE(batches.size(), 3u);
+  }
+  rclcpp::shutdown();
+}
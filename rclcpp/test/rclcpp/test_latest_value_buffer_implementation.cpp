@@ -0,0 +1,125 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <utility>
+
+#include "gtest/gtest.h"
+
+#include "rclcpp/experimental/buffers/latest_value_buffer_implementation.hpp"
+#include "rclcpp/experimental/create_intra_process_buffer.hpp"
+
+using rclcpp::experimental::buffers::LatestValueBufferImplementation;
+
+TEST(TestLatestValueBufferImplementation, basic_usage) {
+  LatestValueBufferImplementation<size_t> buffer;
+  EXPECT_FALSE(buffer.has_data());
+  // Empty
+  EXPECT_EQ(0u, buffer.dequeue());
+
+  buffer.enqueue(1);
+  EXPECT_TRUE(buffer.has_data());
+  EXPECT_EQ(1u, buffer.dequeue());
+  EXPECT_FALSE(buffer.has_data());
+
+  // The element not dequeued yet is replaced
+  buffer.enqueue(2);
+  buffer.enqueue(3);
+  EXPECT_EQ(3u, buffer.dequeue());
+  EXPECT_FALSE(buffer.has_data());
+
+  buffer.enqueue(4);
+  buffer.clear();
+  EXPECT_FALSE(buffer.has_data());
+}
+
+TEST(TestLatestValueBufferImplementation, replaced_elements_are_released) {
+  LatestValueBufferImplementation<std::shared_ptr<int>> buffer;
+  auto first = std::make_shared<int>(1);
+  buffer.enqueue(first);
+  EXPECT_EQ(2, first.use_count());
+  buffer.enqueue(std::make_shared<int>(2));
+  EXPECT_EQ(1, first.use_count());
+  EXPECT_EQ(2, *buffer.dequeue());
+}
+
+TEST(TestLatestValueBufferImplementation, metrics) {
+  LatestValueBufferImplementation<size_t> buffer;
+  auto metrics = buffer.get_metrics();
+  EXPECT_EQ(1u, metrics.capacity);
+  EXPECT_EQ(0u, metrics.depth);
+  EXPECT_EQ(0u, metrics.high_water_mark);
+
+  buffer.enqueue(1);
+  buffer.enqueue(2);
+  buffer.enqueue(3);
+  metrics = buffer.get_metrics();
+  EXPECT_EQ(1u, metrics.depth);
+  EXPECT_EQ(1u, metrics.high_water_mark);
+  EXPECT_EQ(3u, metrics.enqueued_count);
+  EXPECT_EQ(0u, metrics.dequeued_count);
+  EXPECT_EQ(2u, metrics.dropped_count);
+
+  EXPECT_EQ(3u, buffer.dequeue());
+  // Dequeuing from an empty buffer isn't counted
+  EXPECT_EQ(0u, buffer.dequeue());
+  metrics = buffer.get_metrics();
+  EXPECT_EQ(0u, metrics.depth);
+  EXPECT_EQ(1u, metrics.dequeued_count);
+  EXPECT_EQ(2u, metrics.dropped_count);
+}
+
+TEST(TestLatestValueBufferImplementation, concurrent_consumer) {
+  // The values are dequeued in order, the ones replaced are dropped
+  constexpr size_t kCount = 100000;
+  LatestValueBufferImplementation<size_t> buffer;
+  std::atomic<bool> done{false};
+  std::thread producer([&buffer, &done]() {
+      for (size_t i = 1; i <= kCount; ++i) {
+        buffer.enqueue(i);
+      }
+      done.store(true);
+    });
+
+  size_t last = 0;
+  size_t dequeued = 0;
+  bool ordered = true;
+  while (!done.load() || buffer.has_data()) {
+    const size_t value = buffer.dequeue();
+    if (value == 0) {
+      continue;
+    }
+    ordered = ordered && value > last;
+    last = value;
+    ++dequeued;
+  }
+  producer.join();
+  EXPECT_TRUE(ordered);
+  EXPECT_EQ(kCount, last);
+
+  const auto metrics = buffer.get_metrics();
+  EXPECT_EQ(kCount, metrics.enqueued_count);
+  EXPECT_EQ(dequeued, metrics.dequeued_count);
+  EXPECT_EQ(kCount - dequeued, metrics.dropped_count);
+}
+
+TEST(TestLatestValueBufferImplementation, create) {
+  using BufferT = std::shared_ptr<const int>;
+  // The depth of the QoS is ignored
+  auto buffer = rclcpp::experimental::create_intra_process_buffer_implementation<BufferT>(
+    rclcpp::IntraProcessBufferImplementation::LatestValue, 10);
+  EXPECT_NE(nullptr, dynamic_cast<LatestValueBufferImplementation<BufferT> *>(buffer.get()));
+}
@@ -0,0 +1,85 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <memory>
+
+#include "rclcpp/lazy_deserialized_message.hpp"
+#include "rclcpp/serialization.hpp"
+#include "rclcpp/serialized_message.hpp"
+
+#include "test_msgs/message_fixtures.hpp"
+#include "test_msgs/msg/builtins.hpp"
+#include "test_msgs/msg/unbounded_sequences.hpp"
+
+template<typename MessageT>
+std::shared_ptr<rclcpp::SerializedMessage>
+serialize(const MessageT & message)
+{
+  static const rclcpp::Serialization<MessageT> serialization;
+  auto serialized_message = std::make_shared<rclcpp::SerializedMessage>();
+  serialization.serialize_message(&message, serialized_message.get());
+  return serialized_message;
+}
+
+TEST(TestLazyDeserializedMessage, get_field) {
+  using MessageT = test_msgs::msg::UnboundedSequences;
+  for (const auto & message : get_messages_unbounded_sequences()) {
+    rclcpp::LazyDeserializedMessage<MessageT> lazy_message(serialize(*message));
+
+    // The fields are decoded in any order, skipping the ones before
+    EXPECT_EQ(message->alignment_check, lazy_message.get_field(&MessageT::alignment_check));
+    EXPECT_EQ(message->string_values, lazy_message.get_field(&MessageT::string_values));
+    EXPECT_EQ(message->bool_values, lazy_message.get_field(&MessageT::bool_values));
+    EXPECT_EQ(
+      message->basic_types_values, lazy_message.get_field(&MessageT::basic_types_values));
+    EXPECT_EQ(message->float64_values, lazy_message.get_field(&MessageT::float64_values));
+    EXPECT_FALSE(lazy_message.is_deserialized());
+
+    EXPECT_EQ(*message, *lazy_message.get_message());
+    EXPECT_TRUE(lazy_message.is_deserialized());
+    EXPECT_EQ(message->int8_values, lazy_message.get_field(&MessageT::int8_values));
+  }
+}
+
+TEST(TestLazyDeserializedMessage, get_nested_field) {
+  using MessageT = test_msgs::msg::Builtins;
+  for (const auto & message : get_messages_builtins()) {
+    rclcpp::LazyDeserializedMessage<MessageT> lazy_message(serialize(*message));
+    EXPECT_EQ(message->time_value, lazy_message.get_field(&MessageT::time_value));
+    EXPECT_EQ(message->duration_value, lazy_message.get_field(&MessageT::duration_value));
+    EXPECT_FALSE(lazy_message.is_deserialized());
+  }
+}
+
+TEST(TestLazyDeserializedMessage, deserialized_message) {
+  using MessageT = test_msgs::msg::Builtins;
+  auto message = get_messages_builtins()[0];
+  rclcpp::LazyDeserializedMessage<MessageT> lazy_message(
+    std::shared_ptr<const MessageT>(message));
+  EXPECT_TRUE(lazy_message.is_deserialized());
+  EXPECT_EQ(nullptr, lazy_message.get_serialized_message());
+  EXPECT_EQ(message, lazy_message.get_message());
+  EXPECT_EQ(&message->time_value, &lazy_message.get_field(&MessageT::time_value));
+
+  EXPECT_THROW(
+    rclcpp::LazyDeserializedMessage<MessageT>(std::shared_ptr<const MessageT>()),
+    std::invalid_argument);
+  EXPECT_THROW(
+    rclcpp::LazyDeserializedMessage<MessageT>(
+      std::shared_ptr<const rclcpp::SerializedMessage>()),
+    std::invalid_argument);
+}
@@ -192,3 +192,38 @@ TEST_F(TestLoanedMessage, move_loaned_message) {
   ASSERT_EQ(42.0f, loaned_msg_moved_to.get().float32_value);
   SUCCEED();
 }
+
+TEST_F(TestLoanedMessage, loan_from_pool) {
+  auto node = std::make_shared<rclcpp::Node>("loaned_message_test_node");
+  rclcpp::PublisherOptions options;
+  options.loaned_message_pool_depth = 1;
+  auto pub = node->create_publisher<MessageT>("loaned_message_test_topic", 1, options);
+  if (pub->can_loan_messages()) {
+    // The pool isn't used when the middleware loans the messages
+    EXPECT_EQ(0u, pub->get_loaned_message_pool_statistics().depth);
+    return;
+  }
+
+  const MessageT * message = nullptr;
+  {
+    auto loaned_msg = pub->borrow_loaned_message();
+    ASSERT_TRUE(loaned_msg.is_valid());
+    message = &loaned_msg.get();
+    loaned_msg.get().float32_value = 42.0f;
+    pub->publish(std::move(loaned_msg));
+  }
+  {
+    // The published message went back to the pool
+    auto loaned_msg = pub->borrow_loaned_message();
+    EXPECT_EQ(message, &loaned_msg.get());
+    EXPECT_EQ(42.0f, loaned_msg.get().float32_value);
+    auto released = loaned_msg.release();
+    EXPECT_EQ(message, released.get());
+  }
+  auto statistics = pub->get_loaned_message_pool_statistics();
+  EXPECT_EQ(1u, statistics.depth);
+  EXPECT_EQ(0u, statistics.in_use);
+  EXPECT_EQ(1u, statistics.allocations);
+  EXPECT_EQ(1u, statistics.reuses);
+  EXPECT_EQ(1u, statistics.free);
+}
@@ -0,0 +1,285 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "rclcpp/experimental/buffers/lock_free_ring_buffer_implementation.hpp"
+#include "rclcpp/experimental/create_intra_process_buffer.hpp"
+
+using rclcpp::experimental::buffers::MultiProducerRingBufferImplementation;
+using rclcpp::experimental::buffers::SingleProducerRingBufferImplementation;
+
+template<typename T>
+class TestLockFreeRingBufferImplementation : public ::testing::Test
+{
+};
+
+using BufferImplementations = ::testing::Types<
+  SingleProducerRingBufferImplementation<size_t>,
+  MultiProducerRingBufferImplementation<size_t>>;
+
+TYPED_TEST_SUITE(TestLockFreeRingBufferImplementation, BufferImplementations, );
+
+TYPED_TEST(TestLockFreeRingBufferImplementation, constructor) {
+  EXPECT_THROW(TypeParam rb(0), std::invalid_argument);
+
+  TypeParam rb(1);
+  EXPECT_FALSE(rb.has_data());
+  EXPECT_FALSE(rb.is_full());
+}
+
+TYPED_TEST(TestLockFreeRingBufferImplementation, basic_usage) {
+  TypeParam rb(2);
+
+  rb.enqueue(1);
+  EXPECT_TRUE(rb.has_data());
+  EXPECT_FALSE(rb.is_full());
+  EXPECT_EQ(1u, rb.dequeue());
+  EXPECT_FALSE(rb.has_data());
+
+  rb.enqueue(2);
+  rb.enqueue(3);
+  EXPECT_TRUE(rb.is_full());
+
+  // The oldest element is dropped
+  rb.enqueue(4);
+  EXPECT_TRUE(rb.is_full());
+  EXPECT_EQ(3u, rb.dequeue());
+  EXPECT_FALSE(rb.is_full());
+  EXPECT_EQ(4u, rb.dequeue());
+  EXPECT_FALSE(rb.has_data());
+  // Empty
+  EXPECT_EQ(0u, rb.dequeue());
+
+  rb.enqueue(5);
+  rb.clear();
+  EXPECT_FALSE(rb.has_data());
+}
+
+TYPED_TEST(TestLockFreeRingBufferImplementation, capacity_of_one) {
+  TypeParam rb(1);
+
+  rb.enqueue(1);
+  EXPECT_TRUE(rb.is_full());
+  // The oldest element is dropped
+  rb.enqueue(2);
+  rb.enqueue(3);
+  EXPECT_TRUE(rb.is_full());
+  EXPECT_EQ(3u, rb.dequeue());
+  EXPECT_FALSE(rb.has_data());
+  EXPECT_EQ(0u, rb.dequeue());
+
+  rb.enqueue(4);
+  EXPECT_EQ(4u, rb.dequeue());
+
+  const auto metrics = rb.get_metrics();
+  EXPECT_EQ(1u, metrics.capacity);
+  EXPECT_EQ(4u, metrics.enqueued_count);
+  EXPECT_EQ(2u, metrics.dequeued_count);
+  EXPECT_EQ(2u, metrics.dropped_count);
+  EXPECT_EQ(1u, metrics.high_water_mark);
+}
+
+TYPED_TEST(TestLockFreeRingBufferImplementation, concurrent_consumer) {
+  // The values of a producer are dequeued in order, some may be dropped
+  constexpr size_t kCount = 100000;
+  TypeParam rb(16);
+  std::atomic<bool> done{false};
+  std::thread producer([&rb, &done]() {
+      for (size_t i = 1; i <= kCount; ++i) {
+        rb.enqueue(i);
+      }
+      done.store(true);
+    });
+
+  size_t last = 0;
+  size_t dequeued = 0;
+  bool ordered = true;
+  while (!done.load() || rb.has_data()) {
+    const size_t value = rb.dequeue();
+    if (value == 0) {
+      continue;
+    }
+    ordered = ordered && value > last;
+    last = value;
+    ++dequeued;
+  }
+  producer.join();
+  EXPECT_TRUE(ordered);
+  EXPECT_EQ(kCount, last);
+  EXPECT_GT(dequeued, 0u);
+
+  const auto metrics = rb.get_metrics();
+  EXPECT_EQ(0u, metrics.depth);
+  EXPECT_EQ(kCount, metrics.enqueued_count);
+  EXPECT_EQ(dequeued, metrics.dequeued_count);
+  EXPECT_EQ(kCount - dequeued, metrics.dropped_count);
+  EXPECT_LE(metrics.high_water_mark, 16u);
+}
+
+TYPED_TEST(TestLockFreeRingBufferImplementation, metrics) {
+  TypeParam rb(2);
+  auto metrics = rb.get_metrics();
+  EXPECT_EQ(2u, metrics.capacity);
+  EXPECT_EQ(0u, metrics.depth);
+  EXPECT_EQ(0u, metrics.high_water_mark);
+
+  rb.enqueue(1);
+  rb.enqueue(2);
+  rb.enqueue(3);
+  metrics = rb.get_metrics();
+  EXPECT_EQ(2u, metrics.depth);
+  EXPECT_EQ(2u, metrics.high_water_mark);
+  EXPECT_EQ(3u, metrics.enqueued_count);
+  EXPECT_EQ(0u, metrics.dequeued_count);
+  EXPECT_EQ(1u, metrics.dropped_count);
+
+  EXPECT_EQ(2u, rb.dequeue());
+  EXPECT_EQ(3u, rb.dequeue());
+  // Dequeuing from an empty buffer isn't counted
+  EXPECT_EQ(0u, rb.dequeue());
+  metrics = rb.get_metrics();
+  EXPECT_EQ(0u, metrics.depth);
+  EXPECT_EQ(2u, metrics.high_water_mark);
+  EXPECT_EQ(2u, metrics.dequeued_count);
+  EXPECT_EQ(1u, metrics.dropped_count);
+}
+
+TEST(TestMultiProducerRingBufferImplementation, concurrent_producers) {
+  constexpr size_t kProducers = 4;
+  constexpr size_t kCount = 20000;
+  // Large enough to never drop
+  MultiProducerRingBufferImplementation<size_t> rb(kProducers * kCount);
+  std::vector<std::thread> producers;
+  for (size_t p = 0; p < kProducers; ++p) {
+    producers.emplace_back(
+      [&rb, p]() {
+        for (size_t i = 1; i <= kCount; ++i) {
+          rb.enqueue(p * kCount + i);
+        }
+      });
+  }
+  for (auto & producer : producers) {
+    producer.join();
+  }
+
+  std::vector<size_t> last(kProducers, 0);
+  size_t dequeued = 0;
+  while (rb.has_data()) {
+    const size_t value = rb.dequeue();
+    const size_t p = (value - 1) / kCount;
+    ASSERT_LT(p, kProducers);
+    EXPECT_GT(value, last[p]);
+    last[p] = value;
+    ++dequeued;
+  }
+  EXPECT_EQ(kProducers * kCount, dequeued);
+}
+
+namespace
+{
+
+/// Run producers never letting more than the capacity be in flight, return the dropped count.
+/**
+ * The consumer keeps moving the dequeue position past the positions the producers read, which
+ * must not make them drop anything.
+ */
+uint64_t
+run_producers_below_capacity(size_t capacity)
+{
+  constexpr size_t kProducers = 4;
+  constexpr size_t kCount = 20000;
+  MultiProducerRingBufferImplementation<size_t> rb(capacity);
+  std::atomic<size_t> in_flight{0};
+  std::vector<std::thread> producers;
+  for (size_t p = 0; p < kProducers; ++p) {
+    producers.emplace_back(
+      [&rb, &in_flight, capacity, p]() {
+        for (size_t i = 1; i <= kCount; ++i) {
+          size_t expected = in_flight.load();
+          while (expected >= capacity || !in_flight.compare_exchange_weak(expected, expected + 1)) {
+            if (expected >= capacity) {
+              std::this_thread::yield();
+              expected = in_flight.load();
+            }
+          }
+          rb.enqueue(p * kCount + i);
+        }
+      });
+  }
+
+  std::vector<size_t> last(kProducers, 0);
+  size_t dequeued = 0;
+  uint64_t dropped = 0;
+  while (dequeued + dropped < kProducers * kCount) {
+    const size_t value = rb.dequeue();
+    // Release the dropped values too, so that a failure doesn't block the producers
+    const uint64_t dropped_count = rb.get_metrics().dropped_count;
+    in_flight.fetch_sub(dropped_count - dropped);
+    dropped = dropped_count;
+    if (value == 0) {
+      std::this_thread::yield();
+      continue;
+    }
+    in_flight.fetch_sub(1);
+    const size_t p = (value - 1) / kCount;
+    EXPECT_LT(p, kProducers);
+    EXPECT_GT(value, last[p % kProducers]);
+    last[p % kProducers] = value;
+    ++dequeued;
+  }
+  for (auto & producer : producers) {
+    producer.join();
+  }
+  EXPECT_LE(rb.get_metrics().high_water_mark, capacity);
+  return dropped;
+}
+
+}  // namespace
+
+TEST(TestMultiProducerRingBufferImplementation, no_drop_below_capacity) {
+  EXPECT_EQ(0u, run_producers_below_capacity(1));
+  EXPECT_EQ(0u, run_producers_below_capacity(8));
+}
+
+TEST(TestCreateIntraProcessBufferImplementation, implementations) {
+  using rclcpp::IntraProcessBufferImplementation;
+  using rclcpp::experimental::create_intra_process_buffer_implementation;
+  using BufferT = std::shared_ptr<const int>;
+
+  auto mutex_buffer = create_intra_process_buffer_implementation<BufferT>(
+    IntraProcessBufferImplementation::MutexRingBuffer, 1);
+  EXPECT_NE(
+    nullptr,
+    dynamic_cast<rclcpp::experimental::buffers::RingBufferImplementation<BufferT> *>(
+      mutex_buffer.get()));
+  auto single_producer_buffer = create_intra_process_buffer_implementation<BufferT>(
+    IntraProcessBufferImplementation::SingleProducerRingBuffer, 1);
+  EXPECT_NE(
+    nullptr,
+    dynamic_cast<SingleProducerRingBufferImplementation<BufferT> *>(
+      single_producer_buffer.get()));
+  auto default_buffer = create_intra_process_buffer_implementation<BufferT>(
+    IntraProcessBufferImplementation::Default, 1);
+  EXPECT_NE(
+    nullptr,
+    dynamic_cast<MultiProducerRingBufferImplementation<BufferT> *>(default_buffer.get()));
+}
@@ -229,6 +229,39 @@ TEST_F(TestLoggingMacros, test_throttle) {
   }
 }
 
+TEST_F(TestLoggingMacros, test_throttle_steady) {
+  using namespace std::chrono_literals;
+  for (uint64_t i = 0; i < 3; ++i) {
+    RCLCPP_DEBUG_THROTTLE_STEADY(g_logger, 10000, "Throttling %d", static_cast<int>(i));
+  }
+  EXPECT_EQ(1u, g_log_calls);
+  EXPECT_EQ("Throttling 0", g_last_log_event.message);
+  for (uint64_t i = 0; i < 6; ++i) {
+    RCLCPP_DEBUG_STREAM_THROTTLE_STEADY(g_logger, 100, "Throttling " << i);
+    std::this_thread::sleep_for(50ms);
+  }
+  EXPECT_EQ(4u, g_log_calls);
+  EXPECT_EQ("Throttling 4", g_last_log_event.message);
+}
+
+TEST_F(TestLoggingMacros, test_stream_disabled_logger) {
+  int evaluations = 0;
+  auto argument = [&evaluations]() {
+      return ++evaluations;
+    };
+  ASSERT_EQ(
+    RCUTILS_RET_OK, rcutils_logging_set_logger_level("name", RCUTILS_LOG_SEVERITY_INFO));
+  RCLCPP_DEBUG_STREAM(g_logger, "message " << argument());
+  EXPECT_EQ(0u, g_log_calls);
+  EXPECT_EQ(0, evaluations);
+  RCLCPP_INFO_STREAM(g_logger, "message " << argument());
+  EXPECT_EQ(1u, g_log_calls);
+  EXPECT_EQ(1, evaluations);
+  EXPECT_EQ("message 1", g_last_log_event.message);
+  ASSERT_EQ(
+    RCUTILS_RET_OK, rcutils_logging_set_logger_level("name", RCUTILS_LOG_SEVERITY_UNSET));
+}
+
 TEST_F(TestLoggingMacros, test_parameter_expression) {
   RCLCPP_DEBUG_STREAM(*&g_logger, "message");
   EXPECT_EQ(1u, g_log_calls);
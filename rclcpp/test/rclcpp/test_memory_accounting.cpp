@@ -0,0 +1,170 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "rclcpp/memory_accounting.hpp"
+#include "rclcpp/memory_usage_publisher.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+#include "test_msgs/msg/empty.hpp"
+
+using namespace std::chrono_literals;
+using rclcpp::MemoryAccounting;
+using rclcpp::MemoryEntityKind;
+using rclcpp::MemoryUsage;
+
+namespace
+{
+const MemoryUsage *
+find_usage(const std::vector<MemoryUsage> & usage, MemoryEntityKind kind)
+{
+  for (const auto & entry : usage) {
+    if (entry.kind == kind) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+}  // namespace
+
+class TestMemoryAccounting : public ::testing::Test
+{
+public:
+  void SetUp()
+  {
+    MemoryAccounting::enable();
+    rclcpp::init(0, nullptr);
+  }
+
+  void TearDown()
+  {
+    rclcpp::shutdown();
+    MemoryAccounting::disable();
+  }
+};
+
+TEST_F(TestMemoryAccounting, accounts) {
+  MemoryAccounting::disable();
+  EXPECT_EQ(nullptr, MemoryAccounting::create_account("/node", "entity", MemoryEntityKind::Other));
+  MemoryAccounting::enable();
+
+  auto account = MemoryAccounting::create_account(
+    "/node", "entity", MemoryEntityKind::Other, []() {
+      rclcpp::MemorySample sample;
+      sample.bytes_in_use = 10;
+      sample.high_water_mark = 20;
+      return sample;
+    });
+  ASSERT_NE(nullptr, account);
+  account->on_allocate(100);
+  account->on_deallocate(40);
+  auto usage = MemoryAccounting::get_usage("/node");
+  ASSERT_EQ(1u, usage.size());
+  EXPECT_EQ("entity", usage[0].entity_name);
+  EXPECT_EQ(70u, usage[0].bytes_in_use);
+  EXPECT_EQ(100u, usage[0].high_water_mark);
+  EXPECT_EQ(70u, MemoryAccounting::get_total_bytes_in_use("/node"));
+
+  account.reset();
+  EXPECT_TRUE(MemoryAccounting::get_usage("/node").empty());
+}
+
+TEST_F(TestMemoryAccounting, memory_resource) {
+  EXPECT_THROW(rclcpp::AccountingMemoryResource(nullptr, nullptr), std::invalid_argument);
+  auto account = MemoryAccounting::create_account(
+    "/node", "entity", MemoryEntityKind::Publisher);
+  rclcpp::AccountingMemoryResource resource(account);
+  {
+    std::pmr::vector<int> values(&resource);
+    values.resize(1000);
+    EXPECT_GE(account->get_usage().bytes_in_use, 1000u * sizeof(int));
+  }
+  EXPECT_EQ(0u, account->get_usage().bytes_in_use);
+  EXPECT_GE(account->get_usage().high_water_mark, 1000u * sizeof(int));
+  account->reset_high_water_mark();
+  EXPECT_EQ(0u, account->get_usage().high_water_mark);
+}
+
+TEST_F(TestMemoryAccounting, node_entities) {
+  auto node = std::make_shared<rclcpp::Node>(
+    "test_memory_accounting_node", rclcpp::NodeOptions().use_intra_process_comms(true));
+  node->declare_parameter("large_parameter", std::string(1000, 'x'));
+
+  rclcpp::PublisherOptions publisher_options;
+  publisher_options.intra_process_message_pool_depth = 4;
+  auto publisher = node->create_publisher<test_msgs::msg::Empty>(
+    "topic", 10, publisher_options);
+  auto subscription = node->create_subscription<test_msgs::msg::Empty>(
+    "topic", 10, [](test_msgs::msg::Empty::ConstSharedPtr) {});
+
+  auto usage = node->get_memory_usage();
+  const MemoryUsage * parameters = find_usage(usage, MemoryEntityKind::Parameters);
+  ASSERT_NE(nullptr, parameters);
+  EXPECT_EQ("/test_memory_accounting_node", parameters->node_name);
+  EXPECT_GE(parameters->bytes_in_use, 1000u);
+  EXPECT_NE(nullptr, find_usage(usage, MemoryEntityKind::Subscription));
+  EXPECT_NE(nullptr, find_usage(usage, MemoryEntityKind::MessagePool));
+  const MemoryUsage * buffer = find_usage(usage, MemoryEntityKind::IntraProcessBuffer);
+  ASSERT_NE(nullptr, buffer);
+  EXPECT_EQ(0u, buffer->bytes_in_use);
+
+  // The messages queued for the subscription, not taken by an executor
+  for (size_t i = 0; i < 3; ++i) {
+    publisher->publish(test_msgs::msg::Empty());
+  }
+  usage = node->get_memory_usage();
+  buffer = find_usage(usage, MemoryEntityKind::IntraProcessBuffer);
+  ASSERT_NE(nullptr, buffer);
+  EXPECT_EQ(3u * sizeof(test_msgs::msg::Empty), buffer->bytes_in_use);
+  EXPECT_EQ(3u * sizeof(test_msgs::msg::Empty), buffer->high_water_mark);
+
+  subscription.reset();
+  usage = node->get_memory_usage();
+  EXPECT_EQ(nullptr, find_usage(usage, MemoryEntityKind::IntraProcessBuffer));
+}
+
+TEST_F(TestMemoryAccounting, publisher) {
+  auto node = std::make_shared<rclcpp::Node>("test_memory_usage_publisher_node");
+  auto memory_usage_publisher = std::make_shared<rclcpp::MemoryUsagePublisher>(*node, 1h);
+  auto messages = memory_usage_publisher->generate_messages();
+  ASSERT_EQ(node->get_memory_usage().size(), messages.size());
+  ASSERT_FALSE(messages.empty());
+  EXPECT_EQ("/test_memory_usage_publisher_node", messages[0].measurement_source_name);
+  EXPECT_EQ("bytes", messages[0].unit);
+
+  size_t received = 0;
+  auto subscription = node->create_subscription<statistics_msgs::msg::MetricsMessage>(
+    rclcpp::MemoryUsagePublisher::default_topic_name, 10,
+    [&received](statistics_msgs::msg::MetricsMessage::ConstSharedPtr message) {
+      EXPECT_EQ("/test_memory_usage_publisher_node", message->measurement_source_name);
+      ++received;
+    });
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  const auto end = std::chrono::steady_clock::now() + 10s;
+  while (received == 0 && std::chrono::steady_clock::now() < end) {
+    memory_usage_publisher->publish();
+    executor.spin_some(10ms);
+  }
+  EXPECT_GT(received, 0u);
+}
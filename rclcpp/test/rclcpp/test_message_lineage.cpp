@@ -0,0 +1,111 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <stdexcept>
+
+#include "rclcpp/message_lineage.hpp"
+
+using rclcpp::MessageLineage;
+using rclcpp::MessageLineageScope;
+using rclcpp::MessageLineageTracker;
+using rclcpp::detail::PublishedLineageScope;
+
+TEST(TestMessageLineage, start_message_flow) {
+  EXPECT_FALSE(MessageLineage().is_valid());
+
+  const MessageLineage first = rclcpp::start_message_flow();
+  const MessageLineage second = rclcpp::start_message_flow();
+  EXPECT_TRUE(first.is_valid());
+  EXPECT_TRUE(second.is_valid());
+  EXPECT_NE(first.flow_id, second.flow_id);
+  EXPECT_GT(first.origin_timestamp, 0);
+  EXPECT_LE(first.origin_timestamp, second.origin_timestamp);
+}
+
+TEST(TestMessageLineage, scopes) {
+  EXPECT_FALSE(rclcpp::get_current_message_lineage().is_valid());
+  EXPECT_FALSE(rclcpp::detail::get_published_message_lineage().is_valid());
+
+  {
+    // Without a current flow, a new one is published
+    PublishedLineageScope published_scope(true);
+    const MessageLineage published = rclcpp::detail::get_published_message_lineage();
+    EXPECT_TRUE(published.is_valid());
+
+    // The flow of the message received is continued
+    MessageLineageScope scope(published);
+    EXPECT_EQ(published.flow_id, rclcpp::get_current_message_lineage().flow_id);
+    EXPECT_FALSE(rclcpp::detail::get_published_message_lineage().is_valid());
+    {
+      PublishedLineageScope nested_published_scope(true);
+      EXPECT_EQ(published.flow_id, rclcpp::detail::get_published_message_lineage().flow_id);
+      EXPECT_EQ(
+        published.origin_timestamp,
+        rclcpp::detail::get_published_message_lineage().origin_timestamp);
+    }
+    {
+      PublishedLineageScope disabled_scope(false);
+      EXPECT_FALSE(rclcpp::detail::get_published_message_lineage().is_valid());
+    }
+  }
+  EXPECT_FALSE(rclcpp::get_current_message_lineage().is_valid());
+  EXPECT_FALSE(rclcpp::detail::get_published_message_lineage().is_valid());
+}
+
+TEST(TestMessageLineage, tracker) {
+  EXPECT_THROW(MessageLineageTracker(0), std::invalid_argument);
+
+  MessageLineageTracker tracker(2);
+  int messages[3];
+  const MessageLineage published = [&tracker, &messages]() {
+      PublishedLineageScope published_scope(true);
+      tracker.record(&messages[0]);
+      tracker.record(&messages[1]);
+      return rclcpp::detail::get_published_message_lineage();
+    }();
+  // Recorded without a flow
+  tracker.record(&messages[2]);
+
+  // The oldest message was forgotten
+  EXPECT_FALSE(tracker.take(&messages[0]).is_valid());
+  EXPECT_EQ(published.flow_id, tracker.take(&messages[1]).flow_id);
+  EXPECT_FALSE(tracker.take(&messages[1]).is_valid());
+  EXPECT_FALSE(tracker.take(&messages[2]).is_valid());
+  EXPECT_EQ(3u, tracker.get_untracked_count());
+
+  auto snapshot = tracker.take_latency_snapshot();
+  EXPECT_EQ(1u, snapshot.get_count());
+  EXPECT_GE(snapshot.get_value_at_percentile(100.0), 0u);
+  EXPECT_EQ(0u, tracker.take_latency_snapshot().get_count());
+}
+
+TEST(TestMessageLineage, tracker_reused_address) {
+  MessageLineageTracker tracker(4);
+  int message;
+  {
+    PublishedLineageScope published_scope(true);
+    tracker.record(&message);
+  }
+  // A message freed before being taken, then another one allocated at its address
+  MessageLineage second;
+  {
+    PublishedLineageScope published_scope(true);
+    tracker.record(&message);
+    second = rclcpp::detail::get_published_message_lineage();
+  }
+  EXPECT_EQ(second.flow_id, tracker.take(&message).flow_id);
+}
@@ -0,0 +1,98 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "rclcpp/experimental/message_pool.hpp"
+
+using rclcpp::experimental::MessagePool;
+
+TEST(TestMessagePool, invalid_depth) {
+  EXPECT_THROW(MessagePool<std::vector<char>>(0), std::invalid_argument);
+}
+
+TEST(TestMessagePool, recycle_messages) {
+  MessagePool<std::vector<char>> pool(2);
+  const std::vector<char> message(1024, 'a');
+
+  auto first = pool.copy(message);
+  const char * data = first->data();
+  EXPECT_EQ(message, *first);
+  first.reset();
+
+  // The capacity of the released message is reused
+  auto second = pool.copy(std::vector<char>(512, 'b'));
+  EXPECT_EQ(data, second->data());
+  EXPECT_EQ(std::vector<char>(512, 'b'), *second);
+
+  auto third = pool.copy(message);
+  auto fourth = pool.copy(message);
+  auto statistics = pool.get_statistics();
+  EXPECT_EQ(2u, statistics.depth);
+  EXPECT_EQ(3u, statistics.in_use);
+  EXPECT_EQ(3u, statistics.high_water_mark);
+  EXPECT_EQ(3u, statistics.allocations);
+  EXPECT_EQ(1u, statistics.reuses);
+
+  // Only depth messages are kept
+  second.reset();
+  third.reset();
+  fourth.reset();
+  statistics = pool.get_statistics();
+  EXPECT_EQ(0u, statistics.in_use);
+  EXPECT_EQ(3u, statistics.high_water_mark);
+  pool.copy(message);
+  pool.copy(message);
+  EXPECT_EQ(3u, pool.get_statistics().allocations);
+  EXPECT_EQ(3u, pool.get_statistics().reuses);
+}
+
+TEST(TestMessagePool, borrow_messages) {
+  MessagePool<std::vector<char>> pool(1);
+  auto first = pool.borrow();
+  EXPECT_TRUE(first->empty());
+  first->assign(1024, 'a');
+  const char * data = first->data();
+  first.reset();
+
+  // A recycled message keeps its value and its memory
+  auto second = pool.borrow();
+  EXPECT_EQ(std::vector<char>(1024, 'a'), *second);
+  EXPECT_EQ(data, second->data());
+  auto third = pool.borrow();
+  EXPECT_TRUE(third->empty());
+
+  auto statistics = pool.get_statistics();
+  EXPECT_EQ(2u, statistics.in_use);
+  EXPECT_EQ(2u, statistics.allocations);
+  EXPECT_EQ(1u, statistics.reuses);
+  second.reset();
+  third.reset();
+  EXPECT_EQ(0u, pool.get_statistics().in_use);
+  EXPECT_EQ(1u, pool.get_statistics().free);
+}
+
+TEST(TestMessagePool, outlive_pool) {
+  std::shared_ptr<std::vector<char>> message;
+  {
+    MessagePool<std::vector<char>> pool(1);
+    message = pool.copy(std::vector<char>(16, 'a'));
+  }
+  EXPECT_EQ(16u, message->size());
+  message.reset();
+}
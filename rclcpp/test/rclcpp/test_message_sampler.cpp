@@ -0,0 +1,114 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <future>
+#include <memory>
+
+#include "rclcpp/message_sampler.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+#include "test_msgs/msg/basic_types.hpp"
+
+using namespace std::chrono_literals;
+using test_msgs::msg::BasicTypes;
+
+class TestMessageSampler : public ::testing::Test
+{
+public:
+  void SetUp()
+  {
+    rclcpp::init(0, nullptr);
+    node = std::make_shared<rclcpp::Node>("test_message_sampler_node");
+    publisher = node->create_publisher<BasicTypes>("sampled_topic", 10);
+    sampler = std::make_shared<rclcpp::MessageSampler<BasicTypes>>(*node, "sampled_topic");
+  }
+
+  void TearDown()
+  {
+    sampler.reset();
+    publisher.reset();
+    node.reset();
+    rclcpp::shutdown();
+  }
+
+  /// Publish the value until the sampler returns a message with it.
+  std::shared_ptr<const BasicTypes>
+  publish_and_wait(int32_t value)
+  {
+    BasicTypes message;
+    message.int32_value = value;
+    const auto end = std::chrono::steady_clock::now() + 10s;
+    while (std::chrono::steady_clock::now() < end) {
+      publisher->publish(message);
+      auto sample = sampler->wait_next(100ms);
+      if (sample && sample->int32_value == value) {
+        return sample;
+      }
+    }
+    return nullptr;
+  }
+
+  rclcpp::Node::SharedPtr node;
+  rclcpp::Publisher<BasicTypes>::SharedPtr publisher;
+  rclcpp::MessageSampler<BasicTypes>::SharedPtr sampler;
+};
+
+TEST_F(TestMessageSampler, timeout) {
+  EXPECT_EQ(nullptr, sampler->get_latest());
+  EXPECT_EQ(nullptr, sampler->get_latest(10ms));
+  const auto start = std::chrono::steady_clock::now();
+  EXPECT_EQ(nullptr, sampler->wait_next(50ms));
+  EXPECT_GE(std::chrono::steady_clock::now() - start, 50ms);
+  EXPECT_EQ(0u, sampler->get_received_count());
+}
+
+TEST_F(TestMessageSampler, wait_next_and_get_latest) {
+  auto first = publish_and_wait(1);
+  ASSERT_NE(nullptr, first);
+  EXPECT_EQ(first, sampler->get_latest());
+  // Nothing new was published since
+  EXPECT_EQ(nullptr, sampler->wait_next(10ms));
+  EXPECT_EQ(1, sampler->get_latest()->int32_value);
+
+  auto second = publish_and_wait(2);
+  ASSERT_NE(nullptr, second);
+  // The first sample is still held, so it hasn't been reused
+  EXPECT_EQ(1, first->int32_value);
+  EXPECT_EQ(2, sampler->get_latest(10ms)->int32_value);
+  EXPECT_GE(sampler->get_received_count(), 2u);
+}
+
+TEST_F(TestMessageSampler, spinning_the_node) {
+  // The executor doesn't take the messages of the sampler
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  executor.spin_some(10ms);
+  ASSERT_NE(nullptr, publish_and_wait(3));
+  executor.spin_some(10ms);
+}
+
+TEST_F(TestMessageSampler, shutdown) {
+  auto wait = std::async(
+    std::launch::async, [this]() {
+      return sampler->wait_next();
+    });
+  EXPECT_EQ(std::future_status::timeout, wait.wait_for(50ms));
+  rclcpp::shutdown();
+  ASSERT_EQ(std::future_status::ready, wait.wait_for(10s));
+  EXPECT_EQ(nullptr, wait.get());
+}
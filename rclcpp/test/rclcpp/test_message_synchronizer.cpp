@@ -0,0 +1,201 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/experimental/message_synchronizer.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+#include "rclcpp/msg/header.hpp"
+#include "rclcpp/msg/message_with_header.hpp"
+
+using rclcpp::experimental::MessageSynchronizer;
+using rclcpp::experimental::SyncPolicy;
+using rclcpp::experimental::SynchronizerOptions;
+using rclcpp::msg::Header;
+using rclcpp::msg::MessageWithHeader;
+
+namespace rclcpp
+{
+namespace experimental
+{
+// The stamp of a header message is its only field
+template<>
+struct MessageStamp<Header>
+{
+  static int64_t
+  get(const Header & message)
+  {
+    return static_cast<int64_t>(message.stamp.sec) * 1000000000LL + message.stamp.nanosec;
+  }
+};
+}  // namespace experimental
+}  // namespace rclcpp
+
+namespace
+{
+std::shared_ptr<const MessageWithHeader>
+make_message(int32_t sec, uint32_t nanosec = 0)
+{
+  auto message = std::make_shared<MessageWithHeader>();
+  message->header.stamp.sec = sec;
+  message->header.stamp.nanosec = nanosec;
+  return message;
+}
+
+std::shared_ptr<const Header>
+make_header(int32_t sec, uint32_t nanosec = 0)
+{
+  auto message = std::make_shared<Header>();
+  message->stamp.sec = sec;
+  message->stamp.nanosec = nanosec;
+  return message;
+}
+}  // namespace
+
+using Synchronizer = MessageSynchronizer<MessageWithHeader, Header>;
+using MatchedStamps = std::vector<std::pair<int32_t, int32_t>>;
+
+TEST(TestMessageSynchronizer, invalid_options) {
+  auto callback = [](auto &&...) {};
+  SynchronizerOptions options;
+  options.queue_size = 0;
+  EXPECT_THROW(Synchronizer(options, callback), std::invalid_argument);
+  options.queue_size = 1;
+  options.max_interval = std::chrono::nanoseconds(-1);
+  EXPECT_THROW(Synchronizer(options, callback), std::invalid_argument);
+  EXPECT_THROW(Synchronizer(SynchronizerOptions(), nullptr), std::invalid_argument);
+
+  Synchronizer synchronizer(SynchronizerOptions(), callback);
+  EXPECT_THROW(synchronizer.add_message<0>(nullptr), std::invalid_argument);
+}
+
+TEST(TestMessageSynchronizer, exact_time) {
+  MatchedStamps matched;
+  Synchronizer synchronizer(
+    SynchronizerOptions(),
+    [&matched](
+      const std::shared_ptr<const MessageWithHeader> & first,
+      const std::shared_ptr<const Header> & second) {
+      matched.emplace_back(first->header.stamp.sec, second->stamp.sec);
+    });
+
+  synchronizer.add_message<0>(make_message(1));
+  synchronizer.add_message<0>(make_message(2));
+  synchronizer.add_message<1>(make_header(2));
+  EXPECT_EQ(MatchedStamps({{2, 2}}), matched);
+  // The older message can't be matched anymore
+  EXPECT_EQ(1u, synchronizer.get_dropped_count());
+
+  synchronizer.add_message<1>(make_header(1));
+  synchronizer.add_message<1>(make_header(3, 1));
+  synchronizer.add_message<0>(make_message(3));
+  EXPECT_EQ(1u, matched.size());
+  synchronizer.add_message<0>(make_message(3, 1));
+  EXPECT_EQ(MatchedStamps({{2, 2}, {3, 3}}), matched);
+  EXPECT_EQ(2u, synchronizer.get_matched_count());
+  EXPECT_EQ(3u, synchronizer.get_dropped_count());
+}
+
+TEST(TestMessageSynchronizer, approximate_time) {
+  MatchedStamps matched;
+  SynchronizerOptions options;
+  options.policy = SyncPolicy::ApproximateTime;
+  options.max_interval = std::chrono::milliseconds(100);
+  Synchronizer synchronizer(
+    options,
+    [&matched](
+      const std::shared_ptr<const MessageWithHeader> & first,
+      const std::shared_ptr<const Header> & second) {
+      matched.emplace_back(first->header.stamp.sec, second->stamp.sec);
+    });
+
+  constexpr uint32_t kMillisecond = 1000000;
+  synchronizer.add_message<0>(make_message(1));
+  synchronizer.add_message<0>(make_message(2));
+  // Too far from the first message, which is dropped, and matched with the second one
+  synchronizer.add_message<1>(make_header(2, 50 * kMillisecond));
+  EXPECT_EQ(MatchedStamps({{2, 2}}), matched);
+  EXPECT_EQ(1u, synchronizer.get_dropped_count());
+
+  // The latest message not newer than the pivot is matched
+  synchronizer.add_message<1>(make_header(3));
+  synchronizer.add_message<1>(make_header(3, 10 * kMillisecond));
+  synchronizer.add_message<0>(make_message(3, 20 * kMillisecond));
+  EXPECT_EQ(MatchedStamps({{2, 2}, {3, 3}}), matched);
+  EXPECT_EQ(2u, synchronizer.get_dropped_count());
+}
+
+TEST(TestMessageSynchronizer, bounded_queues) {
+  size_t matched = 0;
+  SynchronizerOptions options;
+  options.queue_size = 2;
+  Synchronizer synchronizer(options, [&matched](auto &&...) {matched++;});
+  for (int32_t sec = 1; sec <= 5; ++sec) {
+    synchronizer.add_message<0>(make_message(sec));
+  }
+  EXPECT_EQ(3u, synchronizer.get_dropped_count());
+  synchronizer.add_message<1>(make_header(1));
+  EXPECT_EQ(0u, matched);
+  synchronizer.add_message<1>(make_header(5));
+  EXPECT_EQ(1u, matched);
+}
+
+TEST(TestMessageSynchronizer, subscribe) {
+  rclcpp::init(0, nullptr);
+  auto node = std::make_shared<rclcpp::Node>(
+    "test_message_synchronizer", rclcpp::NodeOptions().use_intra_process_comms(true));
+
+  std::vector<const void *> received;
+  auto synchronizer = std::make_shared<Synchronizer>(
+    SynchronizerOptions(),
+    [&received](
+      const std::shared_ptr<const MessageWithHeader> & first,
+      const std::shared_ptr<const Header> & second) {
+      received.push_back(first.get());
+      received.push_back(second.get());
+    });
+  rclcpp::SubscriptionOptions options;
+  options.callback_group =
+    node->create_callback_group(rclcpp::CallbackGroupType::MutuallyExclusive, false);
+  synchronizer->subscribe<0>(*node, "~/test_synchronized_first", 10, options);
+  synchronizer->subscribe<1>(*node, "~/test_synchronized_second", 10, options);
+
+  auto first_pub = node->create_publisher<MessageWithHeader>("~/test_synchronized_first", 10);
+  auto second_pub = node->create_publisher<Header>("~/test_synchronized_second", 10);
+  auto first = std::make_unique<MessageWithHeader>();
+  first->header.stamp.sec = 1;
+  auto second = std::make_unique<Header>();
+  second->stamp.sec = 1;
+  // The intra-process messages are given to the callback without being copied
+  const std::vector<const void *> published = {first.get(), second.get()};
+  first_pub->publish(std::move(first));
+  second_pub->publish(std::move(second));
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_callback_group(options.callback_group, node->get_node_base_interface());
+  executor.spin_some();
+  EXPECT_EQ(published, received);
+  EXPECT_EQ(1u, synchronizer->get_matched_count());
+
+  synchronizer.reset();
+  rclcpp::shutdown();
+}
@@ -0,0 +1,158 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rclcpp/multi_node_parameters_client.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+using namespace std::chrono_literals;
+using rclcpp::MultiNodeParametersClient;
+using rclcpp::RemoteParametersStatus;
+
+class TestMultiNodeParametersClient : public ::testing::Test
+{
+protected:
+  static void SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  static void TearDownTestCase()
+  {
+    rclcpp::shutdown();
+  }
+
+  void SetUp()
+  {
+    node = std::make_shared<rclcpp::Node>("test_multi_node_parameters_client", "/ns");
+    executor.add_node(node);
+    for (size_t i = 0; i < 3; ++i) {
+      auto remote_node = std::make_shared<rclcpp::Node>("remote" + std::to_string(i), "/ns");
+      remote_node->declare_parameter("index", static_cast<int64_t>(i));
+      executor.add_node(remote_node);
+      remote_nodes.push_back(remote_node);
+      remote_node_names.push_back(remote_node->get_fully_qualified_name());
+    }
+  }
+
+  template<typename FutureT>
+  bool
+  spin_until_complete(const FutureT & future)
+  {
+    return executor.spin_until_future_complete(future, 10s) == rclcpp::FutureReturnCode::SUCCESS;
+  }
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  rclcpp::Node::SharedPtr node;
+  std::vector<rclcpp::Node::SharedPtr> remote_nodes;
+  std::vector<std::string> remote_node_names;
+};
+
+TEST_F(TestMultiNodeParametersClient, construction) {
+  rclcpp::MultiNodeParametersClientOptions options;
+  options.max_requests_in_flight = 0;
+  EXPECT_THROW(MultiNodeParametersClient(node, remote_node_names, options), std::invalid_argument);
+  options.max_requests_in_flight = 1;
+  options.timeout = 0s;
+  EXPECT_THROW(MultiNodeParametersClient(node, remote_node_names, options), std::invalid_argument);
+  EXPECT_THROW(MultiNodeParametersClient(node, {""}), std::invalid_argument);
+
+  MultiNodeParametersClient client(node, {"/ns/remote1", "/ns/remote0", "/ns/remote1"});
+  EXPECT_EQ(
+    (std::vector<std::string>{"/ns/remote0", "/ns/remote1"}), client.get_remote_node_names());
+  EXPECT_EQ(0u, client.get_requests_in_flight());
+}
+
+TEST_F(TestMultiNodeParametersClient, get_and_set_parameters) {
+  rclcpp::MultiNodeParametersClientOptions options;
+  options.max_requests_in_flight = 2;
+  MultiNodeParametersClient client(node, remote_node_names, options);
+  ASSERT_TRUE(client.wait_for_services(10s));
+
+  // The requests sent one after another are pipelined
+  std::vector<MultiNodeParametersClient::SharedFuture<std::vector<rclcpp::Parameter>>> futures;
+  size_t callbacks = 0;
+  for (size_t i = 0; i < 5; ++i) {
+    futures.push_back(
+      client.get_parameters(
+        {"index"},
+        [&callbacks](MultiNodeParametersClient::SharedFuture<std::vector<rclcpp::Parameter>>) {
+          ++callbacks;
+        }));
+  }
+  EXPECT_EQ(6u, client.get_requests_in_flight());
+  for (const auto & future : futures) {
+    ASSERT_TRUE(spin_until_complete(future));
+    const auto results = future.get();
+    ASSERT_EQ(3u, results.size());
+    for (size_t i = 0; i < remote_node_names.size(); ++i) {
+      const auto & result = results.at(remote_node_names[i]);
+      ASSERT_EQ(RemoteParametersStatus::Success, result.status);
+      ASSERT_EQ(1u, result.result.size());
+      EXPECT_EQ(static_cast<int64_t>(i), result.result[0].as_int());
+    }
+  }
+  EXPECT_EQ(5u, callbacks);
+  EXPECT_EQ(0u, client.get_requests_in_flight());
+
+  // Set different parameters on a part of the nodes
+  auto set_future = client.set_parameters(
+    std::map<std::string, std::vector<rclcpp::Parameter>>{
+    {remote_node_names[0], {rclcpp::Parameter("index", 10)}},
+    {remote_node_names[2], {rclcpp::Parameter("index", 12)}},
+  });
+  ASSERT_TRUE(spin_until_complete(set_future));
+  const auto set_results = set_future.get();
+  ASSERT_EQ(2u, set_results.size());
+  ASSERT_EQ(RemoteParametersStatus::Success, set_results.at(remote_node_names[2]).status);
+  EXPECT_TRUE(set_results.at(remote_node_names[2]).result.at(0).successful);
+  EXPECT_EQ(10, remote_nodes[0]->get_parameter("index").as_int());
+  EXPECT_EQ(1, remote_nodes[1]->get_parameter("index").as_int());
+  EXPECT_EQ(12, remote_nodes[2]->get_parameter("index").as_int());
+
+  auto list_future = client.list_parameters({}, 0);
+  ASSERT_TRUE(spin_until_complete(list_future));
+  for (const auto & [name, result] : list_future.get()) {
+    ASSERT_EQ(RemoteParametersStatus::Success, result.status) << name;
+    EXPECT_EQ(2u, result.result.names.size()) << name;
+  }
+
+  EXPECT_THROW(
+    client.set_parameters(
+      std::map<std::string, std::vector<rclcpp::Parameter>>{{"/ns/unknown", {}}}),
+    std::invalid_argument);
+}
+
+TEST_F(TestMultiNodeParametersClient, timeout) {
+  rclcpp::MultiNodeParametersClientOptions options;
+  options.timeout = 100ms;
+  MultiNodeParametersClient client(node, {remote_node_names[0], "/ns/missing"}, options);
+
+  auto future = client.describe_parameters({"index"});
+  ASSERT_TRUE(spin_until_complete(future));
+  const auto results = future.get();
+  ASSERT_EQ(2u, results.size());
+  ASSERT_EQ(RemoteParametersStatus::Success, results.at(remote_node_names[0]).status);
+  EXPECT_EQ(1u, results.at(remote_node_names[0]).result.size());
+  EXPECT_EQ(RemoteParametersStatus::Timeout, results.at("/ns/missing").status);
+  EXPECT_EQ(0u, client.get_requests_in_flight());
+}
@@ -16,13 +16,18 @@
 
 #include <chrono>
 #include <functional>
+#include <future>
 #include <limits>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <unordered_set>
 #include <vector>
 
+#include "rcl_interfaces/msg/log.hpp"
+#include "rcl_interfaces/msg/parameter_event.hpp"
+
 #include "rclcpp/exceptions.hpp"
 #include "rclcpp/node.hpp"
 #include "rclcpp/rclcpp.hpp"
@@ -190,6 +195,64 @@ TEST_F(TestNode, pub_and_sub_lifecycles) {
   pub->publish(Empty());
 }
 
+TEST_F(TestNode, create_entities_async) {
+  using test_msgs::msg::Empty;
+  auto node = std::make_shared<rclcpp::Node>("my_node", "/ns");
+
+  std::promise<bool> created_promise;
+  auto created = created_promise.get_future();
+  auto publisher_future = node->create_publisher_async<Empty>(
+    "topic", 10, rclcpp::PublisherOptions(),
+    [&created_promise](std::shared_future<rclcpp::Publisher<Empty>::SharedPtr> future) {
+      created_promise.set_value(future.get() != nullptr);
+    });
+  size_t received = 0;
+  auto subscription_future = node->create_subscription_async<Empty>(
+    "topic", 10, [&received](Empty::ConstSharedPtr) {
+      ++received;
+    });
+  auto service_future = node->create_service_async<test_msgs::srv::Empty>(
+    "service",
+    [](
+      const test_msgs::srv::Empty::Request::SharedPtr,
+      test_msgs::srv::Empty::Response::SharedPtr) {});
+  auto client_future = node->create_client_async<test_msgs::srv::Empty>("service");
+
+  ASSERT_EQ(std::future_status::ready, created.wait_for(std::chrono::seconds(10)));
+  EXPECT_TRUE(created.get());
+  ASSERT_EQ(std::future_status::ready, client_future.wait_for(std::chrono::seconds(10)));
+  auto publisher = publisher_future.get();
+  auto subscription = subscription_future.get();
+  ASSERT_NE(nullptr, service_future.get());
+  auto client = client_future.get();
+  ASSERT_NE(nullptr, client);
+  EXPECT_STREQ("/ns/topic", subscription->get_topic_name());
+  EXPECT_TRUE(client->wait_for_service(std::chrono::seconds(10)));
+
+  // The subscription was added to the callback group of the node
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (publisher->get_subscription_count() == 0 &&
+    std::chrono::steady_clock::now() < deadline)
+  {
+    executor.spin_some(std::chrono::milliseconds(10));
+  }
+  publisher->publish(Empty());
+  while (received == 0 && std::chrono::steady_clock::now() < deadline) {
+    executor.spin_some(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(1u, received);
+
+  // The errors of the creation are given by the future
+  auto invalid_future = node->create_publisher_async<Empty>("invalid topic?", 10);
+  EXPECT_THROW(invalid_future.get(), rclcpp::exceptions::InvalidTopicNameError);
+
+  // The node must be owned by a shared pointer
+  rclcpp::Node stack_node("stack_node", "/ns");
+  EXPECT_THROW(stack_node.create_publisher_async<Empty>("topic", 10), std::bad_weak_ptr);
+}
+
 TEST_F(TestNode, get_name_and_namespace) {
   {
     auto node = std::make_shared<rclcpp::Node>("my_node", "/ns");
@@ -3469,3 +3532,48 @@ TEST_F(TestNode, get_parameter_with_node_allow_undeclared) {
     EXPECT_EQ(rclcpp::ParameterValue{}, param.get_parameter_value());
   }
 }
+
+TEST_F(TestNode, shared_publishers) {
+  auto listener = std::make_shared<rclcpp::Node>("shared_publishers_listener", "ns");
+  std::set<std::string> parameter_event_nodes;
+  auto parameter_events_subscription =
+    listener->create_subscription<rcl_interfaces::msg::ParameterEvent>(
+    "/parameter_events", rclcpp::ParameterEventsQoS(),
+    [&parameter_event_nodes](const rcl_interfaces::msg::ParameterEvent & event) {
+      parameter_event_nodes.insert(event.node);
+    });
+  std::set<std::string> log_names;
+  auto rosout_subscription = listener->create_subscription<rcl_interfaces::msg::Log>(
+    "/rosout", rclcpp::RosoutQoS(),
+    [&log_names](const rcl_interfaces::msg::Log & log) {
+      if (log.msg == "shared rosout") {
+        log_names.insert(log.name);
+      }
+    });
+
+  rclcpp::NodeOptions options;
+  options.use_shared_publishers(true);
+  auto first_node = std::make_shared<rclcpp::Node>("first_shared_node", "ns", options);
+  auto second_node = std::make_shared<rclcpp::Node>("second_shared_node", "ns", options);
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(listener);
+  auto start = std::chrono::steady_clock::now();
+  for (
+    int i = 0;
+    (parameter_event_nodes.size() < 2u || log_names.size() < 2u) &&
+    std::chrono::steady_clock::now() - start < std::chrono::seconds(10);
+    ++i)
+  {
+    first_node->declare_parameter("shared_" + std::to_string(i), i);
+    second_node->declare_parameter("shared_" + std::to_string(i), i);
+    RCLCPP_INFO(first_node->get_logger(), "shared rosout");
+    RCLCPP_INFO(second_node->get_logger(), "shared rosout");
+    executor.spin_some(std::chrono::milliseconds(100));
+  }
+  // The messages of both nodes are published with the names of the nodes
+  EXPECT_EQ(1u, parameter_event_nodes.count("/ns/first_shared_node"));
+  EXPECT_EQ(1u, parameter_event_nodes.count("/ns/second_shared_node"));
+  EXPECT_EQ(1u, log_names.count("ns.first_shared_node"));
+  EXPECT_EQ(1u, log_names.count("ns.second_shared_node"));
+}
@@ -262,12 +262,48 @@ TEST(TestNodeOptions, bool_setters_and_getters) {
   options.start_parameter_event_publisher(true);
   EXPECT_TRUE(options.start_parameter_event_publisher());
 
+  options.start_lifecycle_services(false);
+  EXPECT_FALSE(options.start_lifecycle_services());
+  options.start_lifecycle_services(true);
+  EXPECT_TRUE(options.start_lifecycle_services());
+
   options.automatically_declare_parameters_from_overrides(false);
   EXPECT_FALSE(options.automatically_declare_parameters_from_overrides());
   options.automatically_declare_parameters_from_overrides(true);
   EXPECT_TRUE(options.automatically_declare_parameters_from_overrides());
 }
 
+TEST(TestNodeOptions, lightweight) {
+  rclcpp::NodeOptions options;
+  EXPECT_FALSE(options.lightweight());
+  options.lightweight(true);
+  EXPECT_TRUE(options.lightweight());
+  EXPECT_FALSE(options.start_parameter_services());
+  EXPECT_FALSE(options.start_parameter_event_publisher());
+  EXPECT_FALSE(options.enable_rosout());
+  EXPECT_FALSE(options.get_rcl_node_options()->enable_rosout);
+
+  // The options can be enabled again
+  options.enable_rosout(true);
+  EXPECT_TRUE(options.get_rcl_node_options()->enable_rosout);
+  EXPECT_TRUE(rclcpp::NodeOptions(options).lightweight());
+}
+
+TEST(TestNodeOptions, use_shared_publishers) {
+  rclcpp::NodeOptions options;
+  EXPECT_FALSE(options.use_shared_publishers());
+  EXPECT_TRUE(options.get_rcl_node_options()->enable_rosout);
+  options.use_shared_publishers(true);
+  EXPECT_TRUE(options.use_shared_publishers());
+  EXPECT_TRUE(options.enable_rosout());
+  // The log messages are published by the shared publisher, not by rcl
+  EXPECT_FALSE(options.get_rcl_node_options()->enable_rosout);
+  EXPECT_TRUE(rclcpp::NodeOptions(options).use_shared_publishers());
+
+  options.use_shared_publishers(false);
+  EXPECT_TRUE(options.get_rcl_node_options()->enable_rosout);
+}
+
 TEST(TestNodeOptions, parameter_event_qos) {
   rclcpp::NodeOptions options;
   rclcpp::QoS qos1(1);
@@ -0,0 +1,69 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <vector>
+
+#include "rclcpp/numa_topology.hpp"
+
+using rclcpp::NumaTopology;
+
+TEST(TestNumaTopology, parse_cpu_list) {
+  EXPECT_EQ(
+    (std::vector<size_t>{0, 1, 2, 3, 8, 10, 11}), NumaTopology::parse_cpu_list("0-3,8,10-11\n"));
+  EXPECT_TRUE(NumaTopology::parse_cpu_list("").empty());
+  EXPECT_THROW(NumaTopology::parse_cpu_list("3-1"), std::invalid_argument);
+  EXPECT_THROW(NumaTopology::parse_cpu_list("0,a"), std::invalid_argument);
+}
+
+TEST(TestNumaTopology, nodes_and_cpus) {
+  // The node 1 is made of memory only
+  NumaTopology topology({{0, 1}, {}, {2, 3}});
+  EXPECT_EQ(3u, topology.get_number_of_nodes());
+  EXPECT_EQ((std::vector<size_t>{2, 3}), topology.get_node_cpus(2));
+  EXPECT_THROW(topology.get_node_cpus(3), std::out_of_range);
+  EXPECT_EQ(0u, topology.get_node_of_cpu(1));
+  EXPECT_EQ(2u, topology.get_node_of_cpu(3));
+  EXPECT_EQ(NumaTopology::unknown, topology.get_node_of_cpu(4));
+
+  EXPECT_THROW(NumaTopology(std::vector<std::vector<size_t>>{}), std::invalid_argument);
+  EXPECT_THROW(NumaTopology(std::vector<std::vector<size_t>>{{}, {}}), std::invalid_argument);
+}
+
+TEST(TestNumaTopology, worker_placement) {
+  NumaTopology topology({{0, 1}, {}, {2, 3}});
+  EXPECT_EQ((std::vector<size_t>{0, 0, 2, 2}), topology.get_worker_nodes(4));
+  EXPECT_EQ((std::vector<size_t>{0, 0, 2}), topology.get_worker_nodes(3));
+  EXPECT_EQ((std::vector<size_t>{0}), topology.get_worker_nodes(1));
+
+  auto attributes = topology.make_worker_thread_attributes(2);
+  ASSERT_EQ(2u, attributes.size());
+  EXPECT_EQ((std::vector<size_t>{0, 1}), attributes[0].cpu_set);
+  EXPECT_EQ((std::vector<size_t>{2, 3}), attributes[1].cpu_set);
+}
+
+TEST(TestNumaTopology, host_topology) {
+  const NumaTopology & topology = NumaTopology::get_host_topology();
+  ASSERT_GE(topology.get_number_of_nodes(), 1u);
+#if defined(__linux__)
+  EXPECT_NE(NumaTopology::unknown, topology.get_current_node());
+#endif
+  std::vector<int> memory(1024, 1);
+  const size_t node = NumaTopology::get_node_of_address(memory.data());
+  if (node != NumaTopology::unknown) {
+    EXPECT_LT(node, topology.get_number_of_nodes());
+  }
+}
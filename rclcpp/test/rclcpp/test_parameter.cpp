@@ -927,6 +927,60 @@ TEST_F(TestParameter, string_array_variant) {
   EXPECT_EQ(string_array_variant, from_msg);
 }
 
+TEST_F(TestParameter, shared_value_storage) {
+  const std::vector<double> TEST_VALUE(4096, 1.5);
+  rclcpp::ParameterValue value(TEST_VALUE);
+  rclcpp::ParameterValue copy = value;
+  // The copies share the array, which isn't copied
+  EXPECT_EQ(
+    &value.get<std::vector<double>>(),
+    &copy.get<std::vector<double>>());
+  EXPECT_EQ(value, copy);
+
+  rclcpp::Parameter parameter("double_array_param", value);
+  rclcpp::Parameter parameter_copy = parameter;
+  EXPECT_EQ(
+    &value.get<std::vector<double>>(),
+    &parameter_copy.get_parameter_value().get<std::vector<double>>());
+  EXPECT_EQ(&value.get<std::vector<double>>(), &parameter_copy.as_double_array());
+
+  // Replacing a value doesn't change its former copies
+  copy = rclcpp::ParameterValue(std::vector<double>{2.0});
+  EXPECT_EQ(TEST_VALUE, value.get<std::vector<double>>());
+  EXPECT_EQ(std::vector<double>{2.0}, copy.get<std::vector<double>>());
+  EXPECT_NE(value, copy);
+
+  // The values equal without sharing their storage
+  EXPECT_EQ(value, rclcpp::ParameterValue(TEST_VALUE));
+
+  // A value moved in isn't copied
+  std::vector<std::string> strings{"R", "O", "S2"};
+  const std::string * data = strings.data();
+  rclcpp::ParameterValue moved(std::move(strings));
+  EXPECT_EQ(data, moved.get<std::vector<std::string>>().data());
+
+  rcl_interfaces::msg::ParameterValue message = value.to_value_msg();
+  const double * message_data = message.double_array_value.data();
+  rclcpp::ParameterValue from_message(std::move(message));
+  EXPECT_EQ(message_data, from_message.get<std::vector<double>>().data());
+  EXPECT_EQ(value, from_message);
+
+  rcl_interfaces::msg::ParameterValue unknown_type;
+  unknown_type.type = 42;
+  EXPECT_THROW(rclcpp::ParameterValue{std::move(unknown_type)}, std::runtime_error);
+
+  // A moved from value is not set, and can still be read and compared
+  rclcpp::ParameterValue moved_to(std::move(from_message));
+  EXPECT_EQ(rclcpp::PARAMETER_NOT_SET, from_message.get_type());
+  EXPECT_EQ(rclcpp::ParameterValue(), from_message);
+  EXPECT_EQ(value, moved_to);
+  rclcpp::ParameterValue string_value("string");
+  moved_to = std::move(string_value);
+  EXPECT_EQ(rclcpp::PARAMETER_NOT_SET, string_value.get_type());
+  EXPECT_EQ(rclcpp::PARAMETER_NOT_SET, string_value.to_value_msg().type);
+  EXPECT_EQ("string", moved_to.get<std::string>());
+}
+
 TEST_F(TestParameter, parameter_vector_stringification) {
   const std::vector<rclcpp::Parameter> parameters = {
     rclcpp::Parameter(),
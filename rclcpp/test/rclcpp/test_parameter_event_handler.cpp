@@ -16,6 +16,7 @@
 #include <memory>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "rclcpp/rclcpp.hpp"
@@ -23,10 +24,21 @@
 class TestParameterEventHandler : public rclcpp::ParameterEventHandler
 {
 public:
-  explicit TestParameterEventHandler(rclcpp::Node::SharedPtr node)
-  : ParameterEventHandler(node)
+  explicit TestParameterEventHandler(
+    rclcpp::Node::SharedPtr node,
+    bool use_content_filter = false)
+  : ParameterEventHandler(
+      node,
+      rclcpp::QoS(rclcpp::QoSInitialization::from_rmw(rmw_qos_profile_parameter_events)),
+      use_content_filter)
   {}
 
+  static rclcpp::ContentFilterOptions
+  content_filter(const std::vector<std::string> & node_names)
+  {
+    return get_content_filter(node_names);
+  }
+
   void test_event(rcl_interfaces::msg::ParameterEvent::ConstSharedPtr event)
   {
     callbacks_->event_callback(*event);
@@ -438,3 +450,67 @@ TEST_F(TestNode, LastInFirstCallForParameterEventCallbacks)
   param_handler->remove_parameter_event_callback(h2);
   EXPECT_EQ(param_handler->num_event_callbacks(), 0UL);
 }
+
+TEST_F(TestNode, ParameterCallbacksOfOtherNodes)
+{
+  size_t other_nodes_calls = 0;
+  std::vector<rclcpp::ParameterCallbackHandle::SharedPtr> handles;
+  for (size_t i = 0; i < 100; ++i) {
+    handles.push_back(
+      param_handler->add_parameter_callback(
+        "my_int", [&other_nodes_calls](const rclcpp::Parameter &) {other_nodes_calls++;},
+        "/other_node_" + std::to_string(i)));
+  }
+  std::vector<std::string> received;
+  auto h1 = param_handler->add_parameter_callback(
+    "my_int", [&received](const rclcpp::Parameter & p) {received.push_back(p.get_name());},
+    remote_node_name);
+  auto h2 = param_handler->add_parameter_callback(
+    "my_string", [&received](const rclcpp::Parameter & p) {received.push_back(p.get_name());},
+    remote_node_name);
+
+  param_handler->test_event(diff_node_int);
+  param_handler->test_event(remote_node_string);
+  param_handler->test_event(same_node_int);
+  EXPECT_EQ(0u, other_nodes_calls);
+  EXPECT_EQ((std::vector<std::string>{"my_int", "my_string"}), received);
+
+  // A new parameter hides a changed one with the same name
+  received.clear();
+  auto event = std::make_shared<rcl_interfaces::msg::ParameterEvent>(*diff_node_int);
+  event->new_parameters = event->changed_parameters;
+  param_handler->test_event(event);
+  EXPECT_EQ(1u, received.size());
+
+  param_handler->remove_parameter_callback(h1);
+  param_handler->remove_parameter_callback(h2);
+  handles.clear();
+  EXPECT_EQ(100u, param_handler->num_parameter_callbacks());
+}
+
+TEST_F(TestNode, ContentFilter)
+{
+  auto filter = TestParameterEventHandler::content_filter({});
+  EXPECT_EQ("node <> %0", filter.filter_expression);
+  EXPECT_EQ(std::vector<std::string>{"''"}, filter.expression_parameters);
+
+  filter = TestParameterEventHandler::content_filter({"/a", "/b"});
+  EXPECT_EQ("node = %0 OR node = %1", filter.filter_expression);
+  EXPECT_EQ((std::vector<std::string>{"'/a'", "'/b'"}), filter.expression_parameters);
+
+  // Too many node names for the expression parameters, all the events are received
+  filter = TestParameterEventHandler::content_filter(std::vector<std::string>(101, "/a"));
+  EXPECT_EQ("node <> %0", filter.filter_expression);
+
+  // The callbacks are called with or without content filtering by the middleware
+  auto filtered_handler = std::make_shared<TestParameterEventHandler>(node, true);
+  bool received = false;
+  auto h1 = filtered_handler->add_parameter_callback(
+    "my_int", [&received](const rclcpp::Parameter &) {received = true;});
+  auto h2 = filtered_handler->add_parameter_event_callback(
+    [](const rcl_interfaces::msg::ParameterEvent &) {});
+  filtered_handler->remove_parameter_event_callback(h2);
+  filtered_handler->test_event(same_node_int);
+  EXPECT_TRUE(received);
+  filtered_handler->remove_parameter_callback(h1);
+}
@@ -0,0 +1,147 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/parameter_handle.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+using rclcpp::ParameterHandle;
+using rclcpp::ParameterValue;
+using rclcpp::ParameterValueCell;
+
+TEST(TestParameterHandle, get_value) {
+  auto cell = std::make_shared<ParameterValueCell>("gain", ParameterValue(1.5));
+  ParameterHandle<double> double_handle(cell);
+  ParameterHandle<float> float_handle(cell);
+  EXPECT_EQ("gain", double_handle.get_name());
+  EXPECT_DOUBLE_EQ(1.5, double_handle.get());
+  EXPECT_FLOAT_EQ(1.5f, float_handle.get());
+  EXPECT_THROW(
+    ParameterHandle<int64_t>(cell).get(),
+    rclcpp::exceptions::InvalidParameterTypeException);
+
+  const uint64_t version = double_handle.get_version();
+  cell->store(ParameterValue(2.5));
+  EXPECT_EQ(version + 1, double_handle.get_version());
+  EXPECT_DOUBLE_EQ(2.5, double_handle.get());
+
+  cell->store(ParameterValue(true));
+  EXPECT_TRUE(ParameterHandle<bool>(cell).get());
+  cell->store(ParameterValue(int64_t{-3}));
+  EXPECT_EQ(-3, ParameterHandle<int>(cell).get());
+  cell->store(ParameterValue(std::vector<std::string>{"a", "b"}));
+  EXPECT_EQ(
+    (std::vector<std::string>{"a", "b"}),
+    ParameterHandle<std::vector<std::string>>(cell).get());
+
+  cell->store(ParameterValue());
+  EXPECT_THROW(double_handle.get(), rclcpp::exceptions::ParameterNotDeclaredException);
+
+  EXPECT_FALSE(ParameterHandle<double>());
+  EXPECT_TRUE(double_handle);
+  EXPECT_THROW(ParameterHandle<double>(nullptr), std::invalid_argument);
+}
+
+TEST(TestParameterHandle, store_while_read) {
+  auto cell = std::make_shared<ParameterValueCell>("counter", ParameterValue(int64_t{0}));
+  ParameterHandle<int64_t> handle(cell);
+
+  // The values are read whole and in order
+  std::atomic<bool> done{false};
+  std::atomic<size_t> unordered_reads{0};
+  std::thread reader(
+    [&]() {
+      int64_t last_value = 0;
+      while (!done) {
+        const int64_t value = handle.get();
+        if (value < last_value) {
+          ++unordered_reads;
+        }
+        last_value = value;
+      }
+    });
+  for (int64_t value = 1; value <= 10000; ++value) {
+    cell->store(ParameterValue(value));
+  }
+  done = true;
+  reader.join();
+  EXPECT_EQ(0u, unordered_reads);
+  EXPECT_EQ(10000, handle.get());
+}
+
+class TestParameterHandleNode : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    rclcpp::init(0, nullptr);
+    node = std::make_shared<rclcpp::Node>("test_parameter_handle_node");
+  }
+
+  void TearDown() override
+  {
+    node.reset();
+    rclcpp::shutdown();
+  }
+
+  rclcpp::Node::SharedPtr node;
+};
+
+TEST_F(TestParameterHandleNode, declare_parameter_handle) {
+  auto gain = node->declare_parameter_handle("controller.gain", 0.5);
+  EXPECT_DOUBLE_EQ(0.5, gain.get());
+
+  const uint64_t version = gain.get_version();
+  ASSERT_TRUE(node->set_parameter(rclcpp::Parameter("controller.gain", 2.0)).successful);
+  EXPECT_DOUBLE_EQ(2.0, gain.get());
+  EXPECT_EQ(version + 1, gain.get_version());
+
+  // Setting the same value doesn't change the version
+  ASSERT_TRUE(node->set_parameter(rclcpp::Parameter("controller.gain", 2.0)).successful);
+  EXPECT_EQ(version + 1, gain.get_version());
+
+  // The handles of a parameter share the same value
+  auto same_gain = node->get_parameter_handle<double>("controller.gain");
+  EXPECT_DOUBLE_EQ(2.0, same_gain.get());
+  EXPECT_EQ(gain.get_version(), same_gain.get_version());
+
+  EXPECT_THROW(
+    node->get_parameter_handle<std::string>("controller.gain"),
+    rclcpp::exceptions::InvalidParameterTypeException);
+  EXPECT_THROW(
+    node->get_parameter_handle<double>("undeclared"),
+    rclcpp::exceptions::ParameterNotDeclaredException);
+}
+
+TEST_F(TestParameterHandleNode, undeclare_parameter) {
+  rcl_interfaces::msg::ParameterDescriptor descriptor;
+  descriptor.dynamic_typing = true;
+  auto name = node->declare_parameter_handle<std::string>("name", "first", descriptor);
+  EXPECT_EQ("first", name.get());
+
+  node->undeclare_parameter("name");
+  EXPECT_THROW(name.get(), rclcpp::exceptions::ParameterNotDeclaredException);
+
+  // The handle reads the value of the parameter declared again
+  node->declare_parameter("name", rclcpp::ParameterValue("second"), descriptor);
+  EXPECT_EQ("second", name.get());
+}
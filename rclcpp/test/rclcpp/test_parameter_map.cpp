@@ -18,11 +18,14 @@
 #include <rcutils/strdup.h>
 
 #include <cstdio>
+#include <filesystem>
+#include <fstream>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "rclcpp/parameter_map.hpp"
+#include "rcpputils/scope_exit.hpp"
 
 rcl_params_t *
 make_params(std::vector<std::string> node_names)
@@ -483,3 +486,79 @@ TEST(Test_parameter_map_from, multi_nodes_diff_param_name_by_node_fqn)
   delete[] c_hello_world;
   rcl_yaml_node_struct_fini(c_params);
 }
+
+TEST(Test_parameter_file_cache, parse_once_per_file_version)
+{
+  const std::filesystem::path yaml_path =
+    std::filesystem::temp_directory_path() / "test_parameter_file_cache.yaml";
+  {
+    std::ofstream yaml_file(yaml_path);
+    yaml_file <<
+      "/**:\n"
+      "  ros__parameters:\n"
+      "    a_value: 1\n"
+      "/ns/node:\n"
+      "  ros__parameters:\n"
+      "    b_value: 2\n";
+  }
+  RCPPUTILS_SCOPE_EXIT(std::filesystem::remove(yaml_path); );
+
+  rclcpp::ParameterFileCache cache;
+  std::vector<rclcpp::Parameter> params = cache.get_parameters(yaml_path.string(), "/ns/node");
+  ASSERT_EQ(2u, params.size());
+  EXPECT_EQ("a_value", params[0].get_name());
+  EXPECT_EQ("b_value", params[1].get_name());
+  EXPECT_EQ(2, params[1].get_value<int64_t>());
+  params = cache.get_parameters(yaml_path.string(), "/other_node");
+  ASSERT_EQ(1u, params.size());
+  EXPECT_EQ("a_value", params[0].get_name());
+  EXPECT_EQ(1u, cache.get_file_count());
+
+  rclcpp::ParameterMap map = cache.get_parameter_map(yaml_path.string());
+  EXPECT_EQ(2u, map.size());
+  EXPECT_EQ(1u, map.at("/ns/node").size());
+  EXPECT_EQ(1u, cache.get_parameter_map(yaml_path.string(), "/ns/other_node").size());
+
+  // A modified file is parsed again
+  {
+    std::ofstream yaml_file(yaml_path);
+    yaml_file <<
+      "/ns/node:\n"
+      "  ros__parameters:\n"
+      "    b_value: 20\n"
+      "    c_value: 30\n";
+  }
+  params = cache.get_parameters(yaml_path.string(), "/ns/node");
+  ASSERT_EQ(2u, params.size());
+  EXPECT_EQ(20, params[0].get_value<int64_t>());
+  EXPECT_EQ("c_value", params[1].get_name());
+  EXPECT_TRUE(cache.get_parameters(yaml_path.string(), "/other_node").empty());
+  EXPECT_EQ(1u, cache.get_file_count());
+
+  cache.clear();
+  EXPECT_EQ(0u, cache.get_file_count());
+  EXPECT_THROW(
+    cache.get_parameters((yaml_path.parent_path() / "missing.yaml").string(), "/ns/node"),
+    rclcpp::exceptions::RCLError);
+  EXPECT_EQ(0u, cache.get_file_count());
+}
+
+TEST(Test_parameter_file_cache, same_as_parameter_map_from)
+{
+  const std::string yaml_path =
+    (std::filesystem::path(TEST_RESOURCES_DIRECTORY) / "test_node_parameters" /
+    "complicated_wildcards.yaml").string();
+
+  rcl_params_t * c_params = rcl_yaml_node_struct_init(rcl_get_default_allocator());
+  RCPPUTILS_SCOPE_EXIT(rcl_yaml_node_struct_fini(c_params); );
+  ASSERT_TRUE(rcl_parse_yaml_file(yaml_path.c_str(), c_params));
+
+  rclcpp::ParameterFileCache cache;
+  for (const char * node_fqn :
+    {"/foo/a/bar/node2", "/a/foo/b/bar/node2", "/foo/bar/node2", "/node2"})
+  {
+    rclcpp::ParameterMap expected = rclcpp::parameter_map_from(c_params, node_fqn);
+    EXPECT_EQ(expected, cache.get_parameter_map(yaml_path, node_fqn)) << node_fqn;
+  }
+  EXPECT_EQ(rclcpp::parameter_map_from(c_params), cache.get_parameter_map(yaml_path));
+}
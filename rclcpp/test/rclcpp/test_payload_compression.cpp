@@ -0,0 +1,235 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "rclcpp/payload_compression.hpp"
+#include "rclcpp/serialized_message.hpp"
+
+namespace
+{
+
+rclcpp::SerializedMessage
+make_serialized_message(const std::vector<uint8_t> & data)
+{
+  rclcpp::SerializedMessage message(data.size());
+  auto & rcl_message = message.get_rcl_serialized_message();
+  if (!data.empty()) {
+    std::memcpy(rcl_message.buffer, data.data(), data.size());
+  }
+  rcl_message.buffer_length = data.size();
+  return message;
+}
+
+// Returns the data of a serialized message, as a CDR encapsulation header followed by values
+std::vector<uint8_t>
+make_compressible_data(size_t size)
+{
+  std::vector<uint8_t> data(size);
+  for (size_t i = 4; i < size; ++i) {
+    data[i] = static_cast<uint8_t>((i / 8) % 16);
+  }
+  if (size > 1) {
+    data[1] = 1;
+  }
+  return data;
+}
+
+}  // namespace
+
+TEST(TestPayloadCompression, lz4_round_trip) {
+  rclcpp::LZ4PayloadCodec codec;
+  std::mt19937 generator(42);
+  for (size_t size : {0u, 1u, 12u, 13u, 100u, 4096u, 70000u}) {
+    for (int kind = 0; kind < 3; ++kind) {
+      std::vector<uint8_t> input(size);
+      for (size_t i = 0; i < size; ++i) {
+        switch (kind) {
+          case 0:
+            input[i] = static_cast<uint8_t>(generator());
+            break;
+          case 1:
+            input[i] = static_cast<uint8_t>(generator() % 3);
+            break;
+          default:
+            input[i] = static_cast<uint8_t>(i / 300);
+            break;
+        }
+      }
+      for (int level : {1, 9}) {
+        std::vector<uint8_t> compressed(codec.get_max_compressed_size(size));
+        const size_t compressed_size =
+          codec.compress(input.data(), size, compressed.data(), compressed.size(), level);
+        ASSERT_LE(compressed_size, compressed.size());
+        std::vector<uint8_t> output(size);
+        codec.decompress(compressed.data(), compressed_size, output.data(), size);
+        EXPECT_EQ(input, output) << "size " << size << ", kind " << kind << ", level " << level;
+      }
+    }
+  }
+}
+
+TEST(TestPayloadCompression, lz4_corrupted_data) {
+  rclcpp::LZ4PayloadCodec codec;
+  auto input = make_compressible_data(1000);
+  std::vector<uint8_t> compressed(codec.get_max_compressed_size(input.size()));
+  const size_t compressed_size =
+    codec.compress(input.data(), input.size(), compressed.data(), compressed.size(), 1);
+  std::vector<uint8_t> output(input.size());
+
+  EXPECT_THROW(
+    codec.decompress(compressed.data(), compressed_size / 2, output.data(), output.size()),
+    std::runtime_error);
+  EXPECT_THROW(
+    codec.decompress(compressed.data(), compressed_size, output.data(), output.size() - 1),
+    std::runtime_error);
+  EXPECT_THROW(
+    codec.compress(input.data(), input.size(), compressed.data(), input.size() / 2, 1),
+    std::invalid_argument);
+
+  // Flipping any bit either fails or produces other data, without reading nor writing out of
+  // the buffers
+  for (size_t i = 0; i < compressed_size; ++i) {
+    auto corrupted = compressed;
+    corrupted[i] ^= 0x10;
+    try {
+      codec.decompress(corrupted.data(), compressed_size, output.data(), output.size());
+    } catch (const std::runtime_error &) {
+    }
+  }
+}
+
+TEST(TestPayloadCompression, compressor_and_decompressor) {
+  rclcpp::PayloadCompressionOptions options;
+  options.encoding = "lz4";
+  rclcpp::PayloadCompressor compressor(options);
+  EXPECT_EQ("lz4", compressor.get_codec()->get_encoding());
+  rclcpp::PayloadDecompressor decompressor;
+
+  const auto data = make_compressible_data(4096);
+  auto serialized_message = make_serialized_message(data);
+  EXPECT_FALSE(
+    rclcpp::PayloadDecompressor::is_compressed(serialized_message.get_rcl_serialized_message()));
+
+  auto compressed = compressor.compress(serialized_message.get_rcl_serialized_message());
+  ASSERT_NE(nullptr, compressed);
+  EXPECT_LT(compressed->size(), data.size() / 4);
+  const auto & rcl_compressed = compressed->get_rcl_serialized_message();
+  EXPECT_TRUE(rclcpp::PayloadDecompressor::is_compressed(rcl_compressed));
+
+  auto decompressed = decompressor.decompress(rcl_compressed);
+  ASSERT_EQ(data.size(), decompressed->size());
+  EXPECT_EQ(
+    0, std::memcmp(data.data(), decompressed->get_rcl_serialized_message().buffer, data.size()));
+
+  // The buffers are reused
+  auto * raw_compressed = compressed.get();
+  compressor.release(compressed);
+  EXPECT_EQ(nullptr, compressed);
+  compressed = compressor.compress(serialized_message.get_rcl_serialized_message());
+  EXPECT_EQ(raw_compressed, compressed.get());
+
+  auto truncated = *compressed;
+  truncated.get_rcl_serialized_message().buffer_length = 8;
+  EXPECT_THROW(
+    decompressor.decompress(truncated.get_rcl_serialized_message()), std::runtime_error);
+  auto unknown_encoding = *compressed;
+  unknown_encoding.get_rcl_serialized_message().buffer[5] = 'x';
+  EXPECT_THROW(
+    decompressor.decompress(unknown_encoding.get_rcl_serialized_message()), std::runtime_error);
+}
+
+TEST(TestPayloadCompression, uncompressed_messages) {
+  rclcpp::PayloadCompressionOptions options;
+  options.encoding = "lz4";
+  options.min_size = 64;
+  rclcpp::PayloadCompressor compressor(options);
+
+  // Too small
+  auto small_message = make_serialized_message(make_compressible_data(32));
+  EXPECT_EQ(nullptr, compressor.compress(small_message.get_rcl_serialized_message()));
+
+  // Incompressible
+  std::vector<uint8_t> random_data(1024);
+  std::mt19937 generator(7);
+  for (auto & byte : random_data) {
+    byte = static_cast<uint8_t>(generator());
+  }
+  auto random_message = make_serialized_message(random_data);
+  EXPECT_EQ(nullptr, compressor.compress(random_message.get_rcl_serialized_message()));
+}
+
+class TestPayloadCodec : public rclcpp::PayloadCodec
+{
+public:
+  std::string get_encoding() const override {return "test";}
+  int get_default_level() const override {return 3;}
+  size_t get_max_compressed_size(size_t size) const override {return size;}
+
+  size_t compress(
+    const uint8_t * input, size_t size, uint8_t * output, size_t, int level) const override
+  {
+    last_level = level;
+    // Keeps the first half, the data of the test has two equal halves
+    std::memcpy(output, input, size / 2);
+    return size / 2;
+  }
+
+  void decompress(
+    const uint8_t * input, size_t size, uint8_t * output, size_t output_size) const override
+  {
+    if (output_size != 2 * size) {
+      throw std::runtime_error("unexpected size");
+    }
+    std::memcpy(output, input, size);
+    std::memcpy(output + size, input, size);
+  }
+
+  mutable int last_level = 0;
+};
+
+TEST(TestPayloadCompression, registered_codec) {
+  EXPECT_EQ(nullptr, rclcpp::get_payload_codec("test"));
+  rclcpp::PayloadCompressionOptions options;
+  options.encoding = "test";
+  EXPECT_THROW(rclcpp::PayloadCompressor{options}, std::invalid_argument);
+  EXPECT_THROW(rclcpp::register_payload_codec(nullptr), std::invalid_argument);
+
+  auto codec = std::make_shared<TestPayloadCodec>();
+  rclcpp::register_payload_codec(codec);
+  EXPECT_EQ(codec, rclcpp::get_payload_codec("test"));
+
+  rclcpp::PayloadCompressor compressor(options);
+  rclcpp::PayloadDecompressor decompressor;
+  // Both halves are equal, so the codec can compress it
+  std::vector<uint8_t> data(256, 0);
+  data[1] = 1;
+  data[129] = 1;
+  auto serialized_message = make_serialized_message(data);
+  auto compressed = compressor.compress(serialized_message.get_rcl_serialized_message());
+  ASSERT_NE(nullptr, compressed);
+  EXPECT_EQ(3, codec->last_level);
+  auto decompressed = decompressor.decompress(compressed->get_rcl_serialized_message());
+  ASSERT_EQ(data.size(), decompressed->size());
+  EXPECT_EQ(
+    0, std::memcmp(data.data(), decompressed->get_rcl_serialized_message().buffer, data.size()));
+}
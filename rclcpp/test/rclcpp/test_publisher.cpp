@@ -17,6 +17,7 @@
 #include <chrono>
 #include <memory>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -196,11 +197,7 @@ static std::vector<TestParameters> invalid_qos_profiles()
 {
   std::vector<TestParameters> parameters;
 
-  parameters.reserve(2);
-  parameters.push_back(
-    TestParameters(
-      rclcpp::QoS(rclcpp::KeepLast(10)).transient_local(),
-      "transient_local_qos"));
+  parameters.reserve(1);
   parameters.push_back(
     TestParameters(
       rclcpp::QoS(rclcpp::KeepAll()),
@@ -409,9 +406,7 @@ TEST_F(TestPublisher, intra_process_publish_failures) {
   std::allocator<void> allocator;
   {
     rclcpp::LoanedMessage<test_msgs::msg::Empty> loaned_msg(*publisher, allocator);
-    RCLCPP_EXPECT_THROW_EQ(
-      publisher->publish(std::move(loaned_msg)),
-      std::runtime_error("storing loaned messages in intra process is not supported yet"));
+    EXPECT_NO_THROW(publisher->publish(std::move(loaned_msg)));
   }
 
   {
@@ -476,6 +471,231 @@ TEST_F(TestPublisher, inter_process_publish_failures) {
   EXPECT_NO_THROW(publisher->publish(std::move(loaned_msg)));
 }
 
+TEST_F(TestPublisher, intra_process_publish_loaned_message) {
+  initialize();
+  rclcpp::PublisherOptionsWithAllocator<std::allocator<void>> options;
+  options.use_intra_process_comm = rclcpp::IntraProcessSetting::Enable;
+  auto publisher = node->create_publisher<test_msgs::msg::Strings>("topic", 10, options);
+  std::string received;
+  rclcpp::SubscriptionOptions subscription_options;
+  subscription_options.use_intra_process_comm = rclcpp::IntraProcessSetting::Enable;
+  auto subscription = node->create_subscription<test_msgs::msg::Strings>(
+    "topic", 10,
+    [&received](test_msgs::msg::Strings::ConstSharedPtr msg) {
+      received = msg->string_value;
+    },
+    subscription_options);
+
+  auto loaned_msg = publisher->borrow_loaned_message();
+  loaned_msg.get().string_value = "loaned";
+  ASSERT_NO_THROW(publisher->publish(std::move(loaned_msg)));
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  executor.spin_some();
+  EXPECT_EQ("loaned", received);
+}
+
+TEST_F(TestPublisher, intra_process_publish_shared_loaned_message) {
+  initialize();
+  rclcpp::PublisherOptionsWithAllocator<std::allocator<void>> options;
+  options.use_intra_process_comm = rclcpp::IntraProcessSetting::Enable;
+  options.share_loaned_messages_intra_process = true;
+  auto publisher = node->create_publisher<test_msgs::msg::Strings>("topic", 10, options);
+  rclcpp::SubscriptionOptions subscription_options;
+  subscription_options.use_intra_process_comm = rclcpp::IntraProcessSetting::Enable;
+  test_msgs::msg::Strings::ConstSharedPtr shared_received;
+  auto shared_subscription = node->create_subscription<test_msgs::msg::Strings>(
+    "topic", 10,
+    [&shared_received](test_msgs::msg::Strings::ConstSharedPtr msg) {
+      shared_received = msg;
+    },
+    subscription_options);
+  std::unique_ptr<test_msgs::msg::Strings> owned_received;
+  auto owning_subscription = node->create_subscription<test_msgs::msg::Strings>(
+    "topic", 10,
+    [&owned_received](std::unique_ptr<test_msgs::msg::Strings> msg) {
+      owned_received = std::move(msg);
+    },
+    subscription_options);
+
+  auto loaned_msg = publisher->borrow_loaned_message();
+  loaned_msg.get().string_value = "loaned";
+  const test_msgs::msg::Strings * loaned_address = &loaned_msg.get();
+  ASSERT_NO_THROW(publisher->publish(std::move(loaned_msg)));
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  executor.spin_some();
+  // The subscription taking shared messages reads the published message itself
+  ASSERT_NE(nullptr, shared_received);
+  EXPECT_EQ(loaned_address, shared_received.get());
+  ASSERT_NE(nullptr, owned_received);
+  EXPECT_NE(loaned_address, owned_received.get());
+  EXPECT_EQ("loaned", owned_received->string_value);
+}
+
+TEST_F(TestPublisher, intra_process_publish_batch) {
+  initialize();
+  rclcpp::PublisherOptionsWithAllocator<std::allocator<void>> options;
+  options.use_intra_process_comm = rclcpp::IntraProcessSetting::Enable;
+  auto publisher = node->create_publisher<test_msgs::msg::Strings>("topic", 10, options);
+  rclcpp::SubscriptionOptions subscription_options;
+  subscription_options.use_intra_process_comm = rclcpp::IntraProcessSetting::Enable;
+  std::vector<std::string> received;
+  auto subscription = node->create_subscription<test_msgs::msg::Strings>(
+    "topic", 10,
+    [&received](test_msgs::msg::Strings::ConstSharedPtr msg) {
+      received.push_back(msg->string_value);
+    },
+    subscription_options);
+
+  std::vector<std::unique_ptr<test_msgs::msg::Strings>> unique_msgs;
+  for (const char * value : {"first", "second"}) {
+    unique_msgs.push_back(std::make_unique<test_msgs::msg::Strings>());
+    unique_msgs.back()->string_value = value;
+  }
+  ASSERT_NO_THROW(publisher->publish_batch(std::move(unique_msgs)));
+  EXPECT_TRUE(unique_msgs.empty());
+
+  std::vector<test_msgs::msg::Strings> msgs(1);
+  msgs[0].string_value = "third";
+  ASSERT_NO_THROW(publisher->publish_batch(msgs.begin(), msgs.end()));
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  executor.spin_some();
+  EXPECT_EQ((std::vector<std::string>{"first", "second", "third"}), received);
+
+  // Nothing is published if one of the messages is a null pointer
+  unique_msgs.push_back(std::make_unique<test_msgs::msg::Strings>());
+  unique_msgs.emplace_back();
+  EXPECT_THROW(publisher->publish_batch(std::move(unique_msgs)), std::runtime_error);
+  executor.spin_some();
+  EXPECT_EQ(3u, received.size());
+}
+
+TEST_F(TestPublisher, async_publishing) {
+  initialize();
+  rclcpp::PublisherOptionsWithAllocator<std::allocator<void>> options;
+  options.use_intra_process_comm = rclcpp::IntraProcessSetting::Disable;
+  options.async_publishing.depth = 2;
+  options.async_publishing.overflow_policy = rclcpp::AsyncPublishingOverflowPolicy::Block;
+  auto publisher = node->create_publisher<test_msgs::msg::Strings>("topic", 10, options);
+
+  test_msgs::msg::Strings msg;
+  for (size_t i = 0; i < 5; ++i) {
+    msg.string_value = std::to_string(i);
+    ASSERT_NO_THROW(publisher->publish(msg));
+  }
+  ASSERT_NO_THROW(publisher->publish(std::make_unique<test_msgs::msg::Strings>()));
+  EXPECT_TRUE(publisher->wait_for_async_publishing(std::chrono::seconds(10)));
+
+  auto statistics = publisher->get_async_publishing_statistics();
+  EXPECT_EQ(2u, statistics.depth);
+  EXPECT_EQ(0u, statistics.size);
+  EXPECT_LE(statistics.high_water_mark, 2u);
+  EXPECT_EQ(6u, statistics.enqueued_count);
+  EXPECT_EQ(6u, statistics.published_count);
+  EXPECT_EQ(0u, statistics.dropped_count);
+  EXPECT_EQ(0u, statistics.failed_count);
+
+  {
+    // The errors of the middleware are counted by the sender thread instead of thrown
+    auto mock = mocking_utils::patch_and_return("lib:rclcpp", rcl_publish, RCL_RET_ERROR);
+    EXPECT_NO_THROW(publisher->publish(msg));
+    EXPECT_TRUE(publisher->wait_for_async_publishing(std::chrono::seconds(10)));
+  }
+  statistics = publisher->get_async_publishing_statistics();
+  EXPECT_EQ(6u, statistics.published_count);
+  EXPECT_EQ(1u, statistics.failed_count);
+
+  // The messages still queued are published on destruction
+  publisher->publish(msg);
+  EXPECT_NO_THROW(publisher.reset());
+
+  // Without asynchronous publishing the statistics are empty
+  auto sync_publisher = node->create_publisher<test_msgs::msg::Strings>("topic", 10);
+  EXPECT_EQ(0u, sync_publisher->get_async_publishing_statistics().depth);
+  EXPECT_TRUE(sync_publisher->wait_for_async_publishing(std::chrono::seconds(0)));
+}
+
+TEST_F(TestPublisher, rate_limit) {
+  initialize();
+  rclcpp::PublisherOptionsWithAllocator<std::allocator<void>> options;
+  options.rate_limit.policy = rclcpp::RateLimitPolicy::KeepEveryNth;
+  options.rate_limit.keep_every_nth = 3;
+  auto publisher = node->create_publisher<test_msgs::msg::Empty>("topic", 10, options);
+  ASSERT_NE(nullptr, publisher->get_rate_limiter());
+
+  test_msgs::msg::Empty msg;
+  for (size_t i = 0; i < 4; ++i) {
+    ASSERT_NO_THROW(publisher->publish(msg));
+  }
+  ASSERT_NO_THROW(publisher->publish(std::make_unique<test_msgs::msg::Empty>()));
+  ASSERT_NO_THROW(publisher->publish(std::make_unique<test_msgs::msg::Empty>()));
+  EXPECT_EQ(2u, publisher->get_rate_limiter()->get_kept_count());
+  EXPECT_EQ(4u, publisher->get_rate_limiter()->get_dropped_count());
+
+  auto unlimited_publisher = node->create_publisher<test_msgs::msg::Empty>("topic", 10);
+  EXPECT_EQ(nullptr, unlimited_publisher->get_rate_limiter());
+
+  // Only the subscriptions can skip to the newest message
+  options.rate_limit.policy = rclcpp::RateLimitPolicy::LatestPerInterval;
+  options.rate_limit.max_frequency = 10.0;
+  EXPECT_THROW(
+    node->create_publisher<test_msgs::msg::Empty>("topic", 10, options),
+    std::invalid_argument);
+}
+
+TEST_F(TestPublisher, skip_publish_without_subscriptions) {
+  initialize();
+  rclcpp::PublisherOptionsWithAllocator<std::allocator<void>> options;
+  options.skip_publish_without_subscriptions = true;
+  auto publisher = node->create_publisher<test_msgs::msg::Empty>("topic", 10, options);
+  ASSERT_TRUE(publisher->skips_publish_without_subscriptions());
+  EXPECT_FALSE(publisher->has_inter_process_subscriptions());
+  EXPECT_FALSE(publisher->has_intra_process_subscriptions());
+
+  test_msgs::msg::Empty msg;
+  ASSERT_NO_THROW(publisher->publish(msg));
+  ASSERT_NO_THROW(publisher->publish(std::make_unique<test_msgs::msg::Empty>()));
+  EXPECT_EQ(2u, publisher->get_skipped_publish_count());
+
+  size_t received = 0;
+  auto subscription = node->create_subscription<test_msgs::msg::Empty>(
+    "topic", 10,
+    [&received](test_msgs::msg::Empty::ConstSharedPtr) {
+      ++received;
+    });
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (!publisher->has_inter_process_subscriptions() &&
+    std::chrono::steady_clock::now() < deadline)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  ASSERT_TRUE(publisher->has_inter_process_subscriptions());
+  ASSERT_NO_THROW(publisher->publish(msg));
+  EXPECT_EQ(2u, publisher->get_skipped_publish_count());
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  while (received == 0 && std::chrono::steady_clock::now() < deadline) {
+    executor.spin_some(std::chrono::milliseconds(100));
+  }
+  EXPECT_EQ(1u, received);
+
+  // The history of a transient local publisher is kept for the late joining subscriptions
+  auto transient_local_publisher = node->create_publisher<test_msgs::msg::Empty>(
+    "other_topic", rclcpp::QoS(10).transient_local(), options);
+  EXPECT_FALSE(transient_local_publisher->skips_publish_without_subscriptions());
+  ASSERT_NO_THROW(transient_local_publisher->publish(msg));
+  EXPECT_EQ(0u, transient_local_publisher->get_skipped_publish_count());
+
+  auto default_publisher = node->create_publisher<test_msgs::msg::Empty>("other_topic", 10);
+  EXPECT_FALSE(default_publisher->skips_publish_without_subscriptions());
+}
+
 template<typename MessageT, typename AllocatorT = std::allocator<void>>
 class TestPublisherProtectedMethods : public rclcpp::Publisher<MessageT, AllocatorT>
 {
@@ -33,6 +33,15 @@ using namespace std::chrono_literals;
 static const int g_max_loops = 200;
 static const std::chrono::milliseconds g_sleep_per_loop(10);
 
+/// Custom type counting its conversions to the ROS message type.
+struct CountedString
+{
+  std::string data;
+  static size_t conversions;
+};
+
+size_t CountedString::conversions = 0;
+
 
 class TestPublisher : public ::testing::Test
 {
@@ -105,6 +114,31 @@ struct TypeAdapter<int, rclcpp::msg::String>
   }
 };
 
+template<>
+struct TypeAdapter<CountedString, rclcpp::msg::String>
+{
+  using is_specialized = std::true_type;
+  using custom_type = CountedString;
+  using ros_message_type = rclcpp::msg::String;
+
+  static void
+  convert_to_ros_message(
+    const custom_type & source,
+    ros_message_type & destination)
+  {
+    CountedString::conversions++;
+    destination.data = source.data;
+  }
+
+  static void
+  convert_to_custom(
+    const ros_message_type & source,
+    custom_type & destination)
+  {
+    destination.data = source.data;
+  }
+};
+
 }  // namespace rclcpp
 
 /*
@@ -307,3 +341,67 @@ TEST_F(TestPublisher, check_type_adapted_message_is_sent_and_received) {
     assert_message_was_received();
   }
 }
+
+/*
+ * Testing that a type adapted message is converted once for all the subscriptions of the ROS type.
+ */
+TEST_F(TestPublisher, type_adapted_message_is_converted_once) {
+  using CountedStringTypeAdapter = rclcpp::TypeAdapter<CountedString, rclcpp::msg::String>;
+  const std::string message_data = "Message Data";
+  const std::string topic_name = "converted_once_topic";
+
+  auto node = rclcpp::Node::make_shared(
+    "test_converted_once",
+    rclcpp::NodeOptions().use_intra_process_comms(true));
+  auto pub = node->create_publisher<CountedStringTypeAdapter>(topic_name, 10);
+
+  size_t received = 0;
+  auto shared_callback = [&](rclcpp::msg::String::ConstSharedPtr msg) {
+      EXPECT_EQ(message_data, msg->data);
+      received++;
+    };
+  auto unique_callback = [&](rclcpp::msg::String::UniquePtr msg) {
+      EXPECT_EQ(message_data, msg->data);
+      received++;
+    };
+  auto shared_sub_1 = node->create_subscription<rclcpp::msg::String>(
+    topic_name, 10, shared_callback);
+  auto shared_sub_2 = node->create_subscription<rclcpp::msg::String>(
+    topic_name, 10, shared_callback);
+  auto unique_sub_1 = node->create_subscription<rclcpp::msg::String>(
+    topic_name, 10, unique_callback);
+  auto unique_sub_2 = node->create_subscription<rclcpp::msg::String>(
+    topic_name, 10, unique_callback);
+
+  auto spin_until_received = [&](size_t expected) {
+      rclcpp::executors::SingleThreadedExecutor executor;
+      executor.add_node(node);
+      for (int i = 0; received < expected && i < g_max_loops; ++i) {
+        executor.spin_once(g_sleep_per_loop);
+      }
+    };
+
+  { // intra-process subscriptions only
+    CountedString::conversions = 0;
+    pub->publish(std::make_unique<CountedString>(CountedString{message_data}));
+    spin_until_received(4);
+    EXPECT_EQ(4u, received);
+    EXPECT_EQ(1u, CountedString::conversions);
+  }
+  { // the conversion for the intra-process subscriptions is shared with the middleware
+    auto other_node = rclcpp::Node::make_shared("test_converted_once_other");
+    auto other_sub = other_node->create_subscription<rclcpp::msg::String>(
+      topic_name, 10, [](rclcpp::msg::String::ConstSharedPtr) {});
+    for (int i = 0; pub->get_subscription_count() < 5u && i < g_max_loops; ++i) {
+      std::this_thread::sleep_for(g_sleep_per_loop);
+    }
+    ASSERT_EQ(5u, pub->get_subscription_count());
+
+    received = 0;
+    CountedString::conversions = 0;
+    pub->publish(std::make_unique<CountedString>(CountedString{message_data}));
+    spin_until_received(4);
+    EXPECT_EQ(4u, received);
+    EXPECT_EQ(1u, CountedString::conversions);
+  }
+}
@@ -311,6 +311,72 @@ TEST_F(TestQosEvent, add_to_wait_set) {
   }
 }
 
+/*
+   Testing that a single waitable dispatches all the events of an entity.
+ */
+TEST_F(TestQosEvent, composite_event_handler) {
+  auto publisher = node->create_publisher<test_msgs::msg::Empty>(topic_name, 10);
+  auto rcl_handle = publisher->get_publisher_handle();
+
+  size_t deadline_count = 0;
+  size_t liveliness_count = 0;
+  auto deadline_callback = [&deadline_count](rclcpp::QOSDeadlineOfferedInfo &) {
+      deadline_count++;
+    };
+  auto liveliness_callback = [&liveliness_count](rclcpp::QOSLivelinessLostInfo &) {
+      liveliness_count++;
+    };
+  rclcpp::CompositeQOSEventHandler composite;
+  composite.add_handler(
+    std::make_shared<rclcpp::QOSEventHandler<decltype(deadline_callback), decltype(rcl_handle)>>(
+      deadline_callback, rcl_publisher_event_init, rcl_handle,
+      RCL_PUBLISHER_OFFERED_DEADLINE_MISSED));
+  composite.add_handler(
+    std::make_shared<rclcpp::QOSEventHandler<
+      decltype(liveliness_callback), decltype(rcl_handle)>>(
+      liveliness_callback, rcl_publisher_event_init, rcl_handle,
+      RCL_PUBLISHER_LIVELINESS_LOST));
+  ASSERT_EQ(2u, composite.get_handlers().size());
+  EXPECT_EQ(2u, composite.get_number_of_ready_events());
+
+  {
+    rcl_wait_set_t wait_set = rcl_get_zero_initialized_wait_set();
+    auto mock = mocking_utils::patch_and_return("lib:rclcpp", rcl_wait_set_add_event, RCL_RET_OK);
+    EXPECT_NO_THROW(composite.add_to_wait_set(&wait_set));
+  }
+  {
+    rcl_wait_set_t wait_set = rcl_get_zero_initialized_wait_set();
+    auto mock = mocking_utils::patch_and_return(
+      "lib:rclcpp", rcl_wait_set_add_event, RCL_RET_ERROR);
+    EXPECT_THROW(composite.add_to_wait_set(&wait_set), rclcpp::exceptions::RCLError);
+  }
+
+  // Nothing is taken before the wait set reported an event
+  std::shared_ptr<void> data = composite.take_data();
+  EXPECT_NO_THROW(composite.execute(data));
+  EXPECT_EQ(0u, deadline_count);
+  EXPECT_EQ(0u, liveliness_count);
+
+  // The events are identified by the index of their handler
+  data = composite.take_data_by_entity_id(1);
+  EXPECT_NO_THROW(composite.execute(data));
+  EXPECT_EQ(0u, deadline_count);
+  EXPECT_EQ(1u, liveliness_count);
+  EXPECT_THROW(composite.take_data_by_entity_id(2), std::out_of_range);
+
+  std::shared_ptr<void> empty_data;
+  EXPECT_THROW(composite.execute(empty_data), std::runtime_error);
+
+  // The entities only register the composite waitable, with all their handlers
+  rclcpp::PublisherOptions options;
+  options.event_callbacks.deadline_callback = deadline_callback;
+  options.event_callbacks.liveliness_callback = liveliness_callback;
+  publisher = node->create_publisher<test_msgs::msg::Empty>(topic_name, 10, options);
+  auto publisher_events = publisher->get_composite_event_handler();
+  ASSERT_NE(nullptr, publisher_events);
+  EXPECT_EQ(publisher->get_event_handlers().size(), publisher_events->get_handlers().size());
+}
+
 TEST_F(TestQosEvent, test_on_new_event_callback)
 {
   auto offered_deadline = rclcpp::Duration(std::chrono::milliseconds(1));
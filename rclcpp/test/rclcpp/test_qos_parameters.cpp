@@ -109,6 +109,50 @@ TEST(TestQosParameters, declare_with_callback) {
   rclcpp::shutdown();
 }
 
+TEST(TestQosParameters, declare_at_once) {
+  rclcpp::init(0, nullptr);
+  auto node = std::make_shared<rclcpp::Node>(
+    "my_node", "/ns", rclcpp::NodeOptions().parameter_overrides(
+  {
+    rclcpp::Parameter("qos_overrides./my/topic.publisher.depth", 20),
+  }));
+  size_t callback_calls = 0;
+  size_t declared_parameters = 0;
+  auto handle = node->add_on_set_parameters_callback(
+    [&callback_calls, &declared_parameters](const std::vector<rclcpp::Parameter> & parameters) {
+      ++callback_calls;
+      declared_parameters += parameters.size();
+      rcl_interfaces::msg::SetParametersResult result;
+      result.successful = true;
+      return result;
+    });
+
+  rclcpp::QoS qos = rclcpp::detail::declare_qos_parameters(
+    rclcpp::QosOverridingOptions::with_default_policies(),
+    node,
+    "/my/topic",
+    rclcpp::QoS{rclcpp::KeepLast(10)},
+    rclcpp::detail::PublisherQosParametersTraits{});
+  EXPECT_EQ(20u, qos.get_rmw_qos_profile().depth);
+  // The parameters of the policies are validated together
+  EXPECT_EQ(1u, callback_calls);
+  EXPECT_EQ(3u, declared_parameters);
+  EXPECT_TRUE(
+    node->describe_parameter("qos_overrides./my/topic.publisher.depth").read_only);
+
+  // Declaring them again reads the declared values
+  qos = rclcpp::detail::declare_qos_parameters(
+    rclcpp::QosOverridingOptions::with_default_policies(),
+    node,
+    "/my/topic",
+    rclcpp::QoS{rclcpp::KeepLast(10)},
+    rclcpp::detail::PublisherQosParametersTraits{});
+  EXPECT_EQ(20u, qos.get_rmw_qos_profile().depth);
+  EXPECT_EQ(1u, callback_calls);
+
+  rclcpp::shutdown();
+}
+
 constexpr int64_t kDuration{1000000};
 
 TEST(TestQosParameters, declare_qos_subscription_parameters) {
@@ -14,6 +14,7 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <string>
 
 #include "rclcpp/rate.hpp"
@@ -119,3 +120,41 @@ TEST(TestRate, from_double) {
     EXPECT_EQ(std::chrono::milliseconds(250), rate.period());
   }
 }
+
+TEST(TestRate, busy_wait_threshold) {
+  auto period = std::chrono::milliseconds(20);
+  auto epsilon = std::chrono::milliseconds(1);
+
+  rclcpp::WallRate r(period);
+  EXPECT_EQ(std::chrono::nanoseconds(0), r.get_busy_wait_threshold());
+  r.set_busy_wait_threshold(std::chrono::milliseconds(2));
+  EXPECT_EQ(std::chrono::milliseconds(2), r.get_busy_wait_threshold());
+
+  // The deadlines don't drift from the period
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 1; i <= 5; ++i) {
+    ASSERT_TRUE(r.sleep());
+    auto delta = std::chrono::steady_clock::now() - start;
+    EXPECT_LT(i * period, delta + epsilon);
+    EXPECT_GT(i * period + epsilon, delta);
+  }
+  auto statistics = r.get_overrun_statistics();
+  EXPECT_EQ(5u, statistics.cycles);
+  EXPECT_EQ(0u, statistics.overruns);
+  EXPECT_GT(epsilon, statistics.max_wakeup_latency);
+
+  // Missed periods are skipped, keeping the phase of the deadlines
+  rclcpp::sleep_for(period * 2 + period / 2);
+  ASSERT_FALSE(r.sleep());
+  ASSERT_TRUE(r.sleep());
+  auto delta = (std::chrono::steady_clock::now() - start) % period;
+  EXPECT_GT(epsilon, std::min<std::chrono::nanoseconds>(delta, period - delta));
+  statistics = r.get_overrun_statistics();
+  EXPECT_EQ(7u, statistics.cycles);
+  EXPECT_EQ(1u, statistics.overruns);
+  EXPECT_EQ(1u, statistics.missed_periods);
+  EXPECT_LT(period, statistics.max_overrun);
+
+  r.reset_overrun_statistics();
+  EXPECT_EQ(0u, r.get_overrun_statistics().cycles);
+}
@@ -0,0 +1,119 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/rate_limit.hpp"
+
+using rclcpp::RateLimiter;
+using rclcpp::RateLimitOptions;
+using rclcpp::RateLimitPolicy;
+using namespace std::chrono_literals;
+
+TEST(TestRateLimit, invalid_options) {
+  RateLimitOptions options;
+  EXPECT_THROW(RateLimiter{options}, std::invalid_argument);
+
+  options.policy = RateLimitPolicy::MaxFrequency;
+  EXPECT_THROW(RateLimiter{options}, std::invalid_argument);
+  options.max_frequency = -1.0;
+  EXPECT_THROW(RateLimiter{options}, std::invalid_argument);
+  options.policy = RateLimitPolicy::LatestPerInterval;
+  EXPECT_THROW(RateLimiter{options}, std::invalid_argument);
+
+  options.policy = RateLimitPolicy::KeepEveryNth;
+  options.keep_every_nth = 0;
+  EXPECT_THROW(RateLimiter{options}, std::invalid_argument);
+  options.keep_every_nth = 1;
+  EXPECT_NO_THROW(RateLimiter{options});
+}
+
+TEST(TestRateLimit, keep_every_nth) {
+  RateLimitOptions options;
+  options.policy = RateLimitPolicy::KeepEveryNth;
+  options.keep_every_nth = 3;
+  RateLimiter rate_limiter(options);
+
+  std::vector<bool> kept;
+  for (size_t i = 0; i < 7; ++i) {
+    kept.push_back(rate_limiter.try_keep());
+  }
+  EXPECT_EQ(std::vector<bool>({true, false, false, true, false, false, true}), kept);
+  EXPECT_EQ(3u, rate_limiter.get_kept_count());
+  EXPECT_EQ(4u, rate_limiter.get_dropped_count());
+
+  // The decisions made in two steps count the same messages
+  EXPECT_FALSE(rate_limiter.is_due());
+  rate_limiter.on_dropped();
+  EXPECT_FALSE(rate_limiter.is_due());
+  rate_limiter.on_dropped();
+  EXPECT_TRUE(rate_limiter.is_due());
+  rate_limiter.on_kept();
+  EXPECT_EQ(4u, rate_limiter.get_kept_count());
+  EXPECT_EQ(6u, rate_limiter.get_dropped_count());
+}
+
+TEST(TestRateLimit, max_frequency) {
+  RateLimitOptions options;
+  options.policy = RateLimitPolicy::MaxFrequency;
+  options.max_frequency = 10.0;
+  RateLimiter rate_limiter(options);
+
+  const auto start = RateLimiter::Clock::now();
+  EXPECT_TRUE(rate_limiter.try_keep(start));
+  EXPECT_FALSE(rate_limiter.try_keep(start + 50ms));
+  EXPECT_FALSE(rate_limiter.try_keep(start + 99ms));
+  EXPECT_TRUE(rate_limiter.try_keep(start + 100ms));
+  // The interval starts from the message kept, not from the previous interval
+  EXPECT_TRUE(rate_limiter.try_keep(start + 250ms));
+  EXPECT_FALSE(rate_limiter.try_keep(start + 300ms));
+  EXPECT_EQ(3u, rate_limiter.get_kept_count());
+  EXPECT_EQ(3u, rate_limiter.get_dropped_count());
+
+  EXPECT_FALSE(rate_limiter.is_due(start + 349ms));
+  EXPECT_TRUE(rate_limiter.is_due(start + 350ms));
+  rate_limiter.on_kept(start + 400ms);
+  EXPECT_FALSE(rate_limiter.is_due(start + 450ms));
+  EXPECT_EQ(4u, rate_limiter.get_kept_count());
+}
+
+TEST(TestRateLimit, concurrent_keep) {
+  RateLimitOptions options;
+  options.policy = RateLimitPolicy::MaxFrequency;
+  options.max_frequency = 1.0;
+  auto rate_limiter = std::make_shared<RateLimiter>(options);
+
+  // Only one of the messages due at the same time is kept
+  const auto now = RateLimiter::Clock::now();
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < 4; ++i) {
+    threads.emplace_back(
+      [rate_limiter, now]() {
+        for (size_t j = 0; j < 1000; ++j) {
+          rate_limiter->try_keep(now);
+        }
+      });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(1u, rate_limiter->get_kept_count());
+  EXPECT_EQ(3999u, rate_limiter->get_dropped_count());
+}
@@ -0,0 +1,179 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rclcpp/experimental/recording_sink.hpp"
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp/serialization.hpp"
+
+#include "test_msgs/msg/basic_types.hpp"
+
+using namespace std::chrono_literals;
+using rclcpp::experimental::RecordingSegmentReader;
+using rclcpp::experimental::RecordingSink;
+using rclcpp::experimental::RecordingSinkOptions;
+
+class TestRecordingSink : public ::testing::Test
+{
+public:
+  void SetUp()
+  {
+    directory = (std::filesystem::temp_directory_path() /
+      ("test_recording_sink_" + std::string(
+        ::testing::UnitTest::GetInstance()->current_test_info()->name()))).string();
+    std::filesystem::remove_all(directory);
+    options.directory = directory;
+  }
+
+  void TearDown()
+  {
+    std::filesystem::remove_all(directory);
+  }
+
+  std::string directory;
+  RecordingSinkOptions options;
+};
+
+TEST_F(TestRecordingSink, invalid_arguments) {
+  EXPECT_THROW(RecordingSink{RecordingSinkOptions()}, std::invalid_argument);
+  options.segment_size = 8;
+  EXPECT_THROW(RecordingSink{options}, std::invalid_argument);
+  options.segment_size = 4096;
+  options.max_records_per_segment = 0;
+  EXPECT_THROW(RecordingSink{options}, std::invalid_argument);
+  EXPECT_THROW(RecordingSegmentReader(directory + "/segment_0.rec"), std::system_error);
+
+  options.max_records_per_segment = 1;
+  RecordingSink sink(options);
+  EXPECT_THROW(sink.write(0, rclcpp::SerializedMessageView(), 0, 0), std::invalid_argument);
+}
+
+TEST_F(TestRecordingSink, write_and_read_segments) {
+  options.segment_size = 4096;
+  options.max_records_per_segment = 8;
+  auto sink = std::make_shared<RecordingSink>(options);
+  const uint32_t topic_a = sink->add_topic("/a", "test_msgs/msg/Empty");
+  const uint32_t topic_b = sink->add_topic("/b", "test_msgs/msg/Strings");
+
+  std::vector<uint8_t> data(13, 7);
+  for (uint8_t i = 0; i < 20; ++i) {
+    data[0] = i;
+    EXPECT_TRUE(
+      sink->write(
+        i % 2 ? topic_b : topic_a, rclcpp::SerializedMessageView(data.data(), data.size()),
+        i, i + 1));
+  }
+  // Larger than a segment
+  std::vector<uint8_t> large_data(options.segment_size, 1);
+  EXPECT_FALSE(
+    sink->write(
+      topic_a, rclcpp::SerializedMessageView(large_data.data(), large_data.size()), 0, 0));
+  sink->close();
+
+  auto statistics = sink->get_statistics();
+  EXPECT_EQ(20u, statistics.record_count);
+  EXPECT_EQ(20u * data.size(), statistics.byte_count);
+  EXPECT_EQ(1u, statistics.dropped_count);
+  // The index of a segment holds 8 records
+  EXPECT_EQ(3u, statistics.segment_count);
+
+  auto paths = sink->get_segment_paths();
+  ASSERT_EQ(3u, paths.size());
+  int64_t count = 0;
+  for (const auto & path : paths) {
+    RecordingSegmentReader reader(path);
+    ASSERT_EQ(2u, reader.get_topics().size());
+    EXPECT_EQ("/b", reader.get_topics()[1].name);
+    EXPECT_EQ("test_msgs/msg/Strings", reader.get_topics()[1].type);
+    for (size_t i = 0; i < reader.size(); ++i, ++count) {
+      auto entry = reader.at(i);
+      EXPECT_EQ(count % 2 ? topic_b : topic_a, entry.topic_id);
+      EXPECT_EQ(count, entry.source_timestamp);
+      EXPECT_EQ(count + 1, entry.received_timestamp);
+      ASSERT_EQ(data.size(), entry.message.size());
+      EXPECT_EQ(count, entry.message.data()[0]);
+      EXPECT_EQ(7, entry.message.data()[data.size() - 1]);
+    }
+    EXPECT_THROW(reader.at(reader.size()), std::out_of_range);
+  }
+  EXPECT_EQ(20, count);
+}
+
+TEST_F(TestRecordingSink, max_segments) {
+  options.segment_size = 1024;
+  options.max_segments = 2;
+  auto sink = std::make_shared<RecordingSink>(options);
+  const uint32_t topic = sink->add_topic("/a", "test_msgs/msg/Empty");
+  std::vector<uint8_t> data(100, 0);
+  for (size_t i = 0; i < 100; ++i) {
+    sink->write(topic, rclcpp::SerializedMessageView(data.data(), data.size()), 0, 0);
+  }
+  sink.reset();
+
+  // The last two segments and their index
+  size_t file_count = 0;
+  for (const auto & file : std::filesystem::directory_iterator(directory)) {
+    (void)file;
+    file_count++;
+  }
+  EXPECT_EQ(4u, file_count);
+}
+
+TEST_F(TestRecordingSink, record_subscription) {
+  rclcpp::init(0, nullptr);
+  {
+    auto node = std::make_shared<rclcpp::Node>("test_recording_sink");
+    auto sink = std::make_shared<RecordingSink>(options);
+    auto subscription = sink->subscribe(
+      *node, "recorded", "test_msgs/msg/BasicTypes", rclcpp::QoS(10));
+    auto publisher = node->create_publisher<test_msgs::msg::BasicTypes>("recorded", 10);
+    rclcpp::executors::SingleThreadedExecutor executor;
+    executor.add_node(node);
+
+    test_msgs::msg::BasicTypes message;
+    message.int32_value = 42;
+    const auto end = std::chrono::steady_clock::now() + 10s;
+    while (sink->get_statistics().record_count == 0 && std::chrono::steady_clock::now() < end) {
+      publisher->publish(message);
+      executor.spin_some(10ms);
+    }
+    sink->close();
+    ASSERT_GT(sink->get_statistics().record_count, 0u);
+
+    RecordingSegmentReader reader(sink->get_segment_paths().front());
+    ASSERT_EQ(1u, reader.get_topics().size());
+    EXPECT_EQ("/recorded", reader.get_topics()[0].name);
+    ASSERT_GT(reader.size(), 0u);
+    auto entry = reader.at(0);
+
+    rclcpp::SerializedMessage serialized_message(entry.message.size());
+    auto & rcl_serialized_message = serialized_message.get_rcl_serialized_message();
+    std::memcpy(rcl_serialized_message.buffer, entry.message.data(), entry.message.size());
+    rcl_serialized_message.buffer_length = entry.message.size();
+    test_msgs::msg::BasicTypes recorded_message;
+    rclcpp::Serialization<test_msgs::msg::BasicTypes>().deserialize_message(
+      &serialized_message, &recorded_message);
+    EXPECT_EQ(42, recorded_message.int32_value);
+  }
+  rclcpp::shutdown();
+}
@@ -79,3 +79,39 @@ TEST(TestRingBufferImplementation, basic_usage) {
   EXPECT_EQ(false, rb.has_data());
   EXPECT_EQ(false, rb.is_full());
 }
+
+/*
+   Metrics
+   - count the enqueued, dequeued and overwritten elements
+   - track the current and the maximum number of stored elements
+ */
+TEST(TestRingBufferImplementation, metrics) {
+  rclcpp::experimental::buffers::RingBufferImplementation<char> rb(2);
+
+  auto metrics = rb.get_metrics();
+  EXPECT_EQ(2u, metrics.capacity);
+  EXPECT_EQ(0u, metrics.depth);
+  EXPECT_EQ(0u, metrics.high_water_mark);
+
+  rb.enqueue('a');
+  rb.enqueue('b');
+  rb.enqueue('c');
+
+  metrics = rb.get_metrics();
+  EXPECT_EQ(2u, metrics.depth);
+  EXPECT_EQ(2u, metrics.high_water_mark);
+  EXPECT_EQ(3u, metrics.enqueued_count);
+  EXPECT_EQ(0u, metrics.dequeued_count);
+  EXPECT_EQ(1u, metrics.dropped_count);
+
+  rb.dequeue();
+  rb.dequeue();
+  rb.dequeue();
+
+  metrics = rb.get_metrics();
+  EXPECT_EQ(0u, metrics.depth);
+  EXPECT_EQ(2u, metrics.high_water_mark);
+  EXPECT_EQ(3u, metrics.enqueued_count);
+  EXPECT_EQ(2u, metrics.dequeued_count);
+  EXPECT_EQ(1u, metrics.dropped_count);
+}
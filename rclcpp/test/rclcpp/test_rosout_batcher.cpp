@@ -0,0 +1,183 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "rcl_interfaces/msg/log.hpp"
+#include "rclcpp/detail/rosout_batcher.hpp"
+
+using rclcpp::detail::RosoutBatcher;
+using rcl_interfaces::msg::Log;
+
+namespace
+{
+
+Log
+make_log(const std::string & name, const std::string & msg, uint8_t level = Log::INFO)
+{
+  Log log;
+  log.name = name;
+  log.msg = msg;
+  log.level = level;
+  return log;
+}
+
+rclcpp::RosoutBatchingOptions
+make_options(
+  std::chrono::milliseconds window, size_t max_batch_size, size_t max_messages_per_second = 0)
+{
+  rclcpp::RosoutBatchingOptions options;
+  options.window = window;
+  options.max_batch_size = max_batch_size;
+  options.max_messages_per_second = max_messages_per_second;
+  return options;
+}
+
+}  // namespace
+
+class TestRosoutBatcher : public ::testing::Test
+{
+protected:
+  RosoutBatcher::PublishFunction
+  get_publish_function()
+  {
+    return [this](const Log & log) {
+        std::lock_guard<std::mutex> lock(mutex);
+        published.push_back(log);
+      };
+  }
+
+  std::vector<Log>
+  take_published()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<Log> logs;
+    logs.swap(published);
+    return logs;
+  }
+
+  /// Wait until count messages were published, or a timeout.
+  void
+  wait_for_published(size_t count)
+  {
+    auto start = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - start < std::chrono::seconds(10)) {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (published.size() >= count) {
+          return;
+        }
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+
+  std::mutex mutex;
+  std::vector<Log> published;
+};
+
+TEST_F(TestRosoutBatcher, invalid_arguments) {
+  EXPECT_FALSE(RosoutBatcher::is_enabled(rclcpp::RosoutBatchingOptions()));
+  EXPECT_THROW(
+    RosoutBatcher(rclcpp::RosoutBatchingOptions(), get_publish_function()),
+    std::invalid_argument);
+  EXPECT_THROW(
+    RosoutBatcher(make_options(std::chrono::milliseconds(10), 4), nullptr),
+    std::invalid_argument);
+}
+
+TEST_F(TestRosoutBatcher, batch_size) {
+  RosoutBatcher batcher(make_options(std::chrono::hours(1), 3), get_publish_function());
+  for (int i = 0; i < 4; ++i) {
+    batcher.add(make_log("node", "message " + std::to_string(i)));
+  }
+  wait_for_published(1u);
+  auto logs = take_published();
+  ASSERT_EQ(1u, logs.size());
+  EXPECT_EQ("node", logs[0].name);
+  EXPECT_EQ("message 0\nmessage 1\nmessage 2", logs[0].msg);
+
+  // The pending batch is published on close, the next messages right away
+  batcher.close();
+  batcher.add(make_log("node", "after close"));
+  logs = take_published();
+  ASSERT_EQ(2u, logs.size());
+  EXPECT_EQ("message 3", logs[0].msg);
+  EXPECT_EQ("after close", logs[1].msg);
+}
+
+TEST_F(TestRosoutBatcher, window) {
+  RosoutBatcher batcher(make_options(std::chrono::milliseconds(20), 100), get_publish_function());
+  batcher.add(make_log("first", "a"));
+  batcher.add(make_log("second", "b"));
+  batcher.add(make_log("first", "c"));
+  // A change of severity closes the batch
+  batcher.add(make_log("first", "d", Log::WARN));
+  wait_for_published(3u);
+  auto logs = take_published();
+  ASSERT_EQ(3u, logs.size());
+  std::vector<std::string> first_messages;
+  for (const auto & log : logs) {
+    if (log.name == "first") {
+      first_messages.push_back(log.msg);
+    } else {
+      EXPECT_EQ("b", log.msg);
+    }
+  }
+  ASSERT_EQ(2u, first_messages.size());
+  EXPECT_EQ("a\nc", first_messages[0]);
+  EXPECT_EQ("d", first_messages[1]);
+}
+
+TEST_F(TestRosoutBatcher, rate_limit) {
+  RosoutBatcher batcher(make_options(std::chrono::milliseconds(0), 1, 2), get_publish_function());
+  for (int i = 0; i < 5; ++i) {
+    batcher.add(make_log("node", std::to_string(i)));
+  }
+  batcher.add(make_log("other", "other"));
+  EXPECT_EQ(3u, batcher.get_suppressed_count());
+  // Without batching, the messages allowed are published by the caller
+  auto logs = take_published();
+  ASSERT_EQ(3u, logs.size());
+  EXPECT_EQ("0", logs[0].msg);
+  EXPECT_EQ("1", logs[1].msg);
+  EXPECT_EQ("other", logs[2].msg);
+
+  // The summary is published once the second elapsed
+  wait_for_published(1u);
+  logs = take_published();
+  ASSERT_EQ(1u, logs.size());
+  EXPECT_EQ("node", logs[0].name);
+  EXPECT_EQ(Log::WARN, logs[0].level);
+  EXPECT_EQ(0u, logs[0].msg.find("3 log messages were suppressed"));
+}
+
+TEST_F(TestRosoutBatcher, rate_limit_summary_on_close) {
+  RosoutBatcher batcher(make_options(std::chrono::hours(1), 10, 1), get_publish_function());
+  batcher.add(make_log("node", "kept"));
+  batcher.add(make_log("node", "suppressed"));
+  batcher.close();
+  auto logs = take_published();
+  ASSERT_EQ(2u, logs.size());
+  EXPECT_EQ("kept", logs[0].msg);
+  EXPECT_EQ(0u, logs[1].msg.find("1 log messages were suppressed"));
+}
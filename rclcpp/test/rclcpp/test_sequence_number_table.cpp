@@ -0,0 +1,141 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "rclcpp/detail/sequence_number_table.hpp"
+
+using rclcpp::detail::SequenceNumberTable;
+
+TEST(TestSequenceNumberTable, emplace_find_take) {
+  SequenceNumberTable<std::string> table(4, 8);
+  EXPECT_EQ(4u, table.capacity());
+  EXPECT_TRUE(table.emplace(1, "one"));
+  EXPECT_TRUE(table.emplace(2, "two"));
+  EXPECT_FALSE(table.emplace(2, "again"));
+  EXPECT_EQ(2u, table.size());
+  ASSERT_NE(nullptr, table.find(2));
+  EXPECT_EQ("two", *table.find(2));
+  EXPECT_EQ(nullptr, table.find(3));
+
+  auto value = table.take(1);
+  ASSERT_TRUE(value.has_value());
+  EXPECT_EQ("one", *value);
+  EXPECT_FALSE(table.take(1).has_value());
+  EXPECT_TRUE(table.erase(2));
+  EXPECT_FALSE(table.erase(2));
+  EXPECT_EQ(0u, table.size());
+
+  // Short-lived values reuse the ring without growing it
+  for (int64_t i = 3; i < 1000; ++i) {
+    EXPECT_TRUE(table.emplace(i, "value"));
+    EXPECT_TRUE(table.erase(i));
+  }
+  EXPECT_EQ(4u, table.capacity());
+}
+
+TEST(TestSequenceNumberTable, grow_and_overflow) {
+  SequenceNumberTable<int64_t> table(2, 4);
+  // The oldest value is never taken, the ring grows then moves it to the overflow map
+  EXPECT_TRUE(table.emplace(0, 0));
+  for (int64_t i = 1; i < 10; ++i) {
+    EXPECT_TRUE(table.emplace(i, i));
+    if (i > 1) {
+      EXPECT_TRUE(table.erase(i - 1));
+    }
+  }
+  EXPECT_EQ(4u, table.capacity());
+  EXPECT_EQ(1u, table.overflow_size());
+  EXPECT_EQ(2u, table.size());
+  ASSERT_NE(nullptr, table.find(0));
+  EXPECT_EQ(0, *table.find(0));
+  EXPECT_FALSE(table.emplace(0, 0));
+
+  // Values older than the ring and far ahead of it
+  EXPECT_TRUE(table.emplace(-5, -5));
+  EXPECT_TRUE(table.emplace(1000000, 1000000));
+  EXPECT_EQ(4u, table.size());
+  EXPECT_EQ(9, *table.take(9));
+  EXPECT_EQ(1000000, *table.take(1000000));
+  EXPECT_EQ(-5, *table.take(-5));
+  EXPECT_EQ(0, *table.take(0));
+  EXPECT_EQ(0u, table.size());
+
+  table.emplace(1, 1);
+  table.emplace(3, 3);
+  table.clear();
+  EXPECT_EQ(0u, table.size());
+  EXPECT_EQ(nullptr, table.find(3));
+}
+
+TEST(TestSequenceNumberTable, erase_oldest_while) {
+  SequenceNumberTable<int64_t> table(4, 4);
+  for (int64_t i = 0; i < 10; ++i) {
+    table.emplace(i, i);
+  }
+  table.erase(7);
+  std::vector<int64_t> erased;
+  EXPECT_EQ(
+    5u, table.erase_oldest_while(
+      [&erased](int64_t sequence_number, int64_t) {
+        if (sequence_number >= 5) {
+          return false;
+        }
+        erased.push_back(sequence_number);
+        return true;
+      }));
+  EXPECT_EQ((std::vector<int64_t>{0, 1, 2, 3, 4}), erased);
+  EXPECT_EQ(4u, table.size());
+  EXPECT_EQ(4u, table.erase_oldest_while([](int64_t, int64_t) {return true;}));
+  EXPECT_EQ(0u, table.size());
+}
+
+TEST(TestSequenceNumberTable, matches_map) {
+  SequenceNumberTable<int64_t> table(4, 16);
+  std::map<int64_t, int64_t> expected;
+  std::mt19937 generator(42);
+  int64_t next = 1;
+  for (size_t i = 0; i < 20000; ++i) {
+    const auto action = generator() % 8;
+    if (action < 4) {
+      const int64_t sequence_number = (action == 0 && next > 100) ? next - 100 : next++;
+      EXPECT_EQ(
+        expected.emplace(sequence_number, sequence_number).second,
+        table.emplace(sequence_number, sequence_number));
+    } else if (action < 7 && !expected.empty()) {
+      // Mostly the newest values, leaving some values behind
+      auto it = std::prev(expected.end(), 1 + generator() % std::min<size_t>(expected.size(), 3));
+      EXPECT_EQ(it->second, *table.take(it->first));
+      expected.erase(it);
+    } else {
+      const int64_t limit = next - 50;
+      table.erase_oldest_while(
+        [limit](int64_t sequence_number, int64_t) {return sequence_number < limit;});
+      expected.erase(expected.begin(), expected.lower_bound(limit));
+    }
+    ASSERT_EQ(expected.size(), table.size());
+  }
+  for (const auto & entry : expected) {
+    ASSERT_NE(nullptr, table.find(entry.first));
+    EXPECT_EQ(entry.second, *table.find(entry.first));
+  }
+}
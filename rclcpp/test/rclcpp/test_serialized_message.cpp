@@ -18,9 +18,11 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "rclcpp/serialization.hpp"
 #include "rclcpp/serialized_message.hpp"
+#include "rclcpp/serialized_message_view.hpp"
 #include "rclcpp/rclcpp.hpp"
 
 #include "rcpputils/asserts.hpp"
@@ -154,6 +156,31 @@ TEST(TestSerializedMessage, reserve) {
     rclcpp::exceptions::RCLBadAlloc);
 }
 
+TEST(TestSerializedMessage, view) {
+  const std::string content = "Hello World";
+  rclcpp::SerializedMessage serialized_msg(content.size());
+  auto & rcl_serialized_msg = serialized_msg.get_rcl_serialized_message();
+  std::memcpy(rcl_serialized_msg.buffer, content.c_str(), content.size());
+  rcl_serialized_msg.buffer_length = content.size();
+
+  rclcpp::SerializedMessageView view(serialized_msg);
+  EXPECT_EQ(rcl_serialized_msg.buffer, view.data());
+  EXPECT_EQ(content.size(), view.size());
+  EXPECT_FALSE(view.empty());
+  EXPECT_EQ('W', view[6]);
+  EXPECT_EQ(content, std::string(view.begin(), view.end()));
+  EXPECT_TRUE(rclcpp::SerializedMessageView().empty());
+
+  // The rcl message refers to the viewed data, a copy of it owns its own buffer
+  auto rcl_view = view.get_rcl_serialized_message();
+  EXPECT_EQ(rcl_serialized_msg.buffer, rcl_view.buffer);
+  EXPECT_EQ(content.size(), rcl_view.buffer_length);
+  rclcpp::SerializedMessage copy(rcl_view);
+  EXPECT_NE(rcl_serialized_msg.buffer, copy.get_rcl_serialized_message().buffer);
+  EXPECT_EQ(content.size(), copy.size());
+  EXPECT_EQ(0, std::memcmp(content.c_str(), copy.get_rcl_serialized_message().buffer, copy.size()));
+}
+
 TEST(TestSerializedMessage, serialization) {
   using MessageT = test_msgs::msg::BasicTypes;
 
@@ -173,6 +200,81 @@ TEST(TestSerializedMessage, serialization) {
   }
 }
 
+TEST(TestSerializedMessage, batch_serialization) {
+  using MessageT = test_msgs::msg::BasicTypes;
+
+  rclcpp::Serialization<MessageT> serializer;
+
+  std::vector<MessageT> ros_msgs;
+  for (const auto & ros_msg : get_messages_basic_types()) {
+    ros_msgs.push_back(*ros_msg);
+  }
+
+  std::vector<rclcpp::SerializedMessage> serialized_msgs;
+  serializer.serialize_messages(ros_msgs, serialized_msgs);
+  ASSERT_EQ(ros_msgs.size(), serialized_msgs.size());
+  std::vector<size_t> capacities;
+  for (size_t i = 0; i < ros_msgs.size(); ++i) {
+    MessageT deserialized_ros_msg;
+    serializer.deserialize_message(&serialized_msgs[i], &deserialized_ros_msg);
+    EXPECT_EQ(ros_msgs[i], deserialized_ros_msg);
+    capacities.push_back(serialized_msgs[i].capacity());
+  }
+
+  // Serializing again reuses the buffers
+  serializer.serialize_messages(ros_msgs, serialized_msgs);
+  for (size_t i = 0; i < ros_msgs.size(); ++i) {
+    EXPECT_EQ(capacities[i], serialized_msgs[i].capacity());
+  }
+}
+
+TEST(TestSerializedMessage, framed_serialization) {
+  using MessageT = test_msgs::msg::BasicTypes;
+
+  rclcpp::Serialization<MessageT> serializer;
+
+  std::vector<MessageT> ros_msgs;
+  for (const auto & ros_msg : get_messages_basic_types()) {
+    ros_msgs.push_back(*ros_msg);
+  }
+
+  rclcpp::SerializedMessage serialized_buffer;
+  serializer.serialize_messages_framed(ros_msgs, serialized_buffer);
+  EXPECT_EQ(0u, serialized_buffer.size() % 8u);
+  EXPECT_EQ(
+    ros_msgs.size(),
+    rclcpp::SerializationBase::get_framed_message_count(&serialized_buffer));
+
+  std::vector<MessageT> deserialized_ros_msgs;
+  serializer.deserialize_messages_framed(serialized_buffer, deserialized_ros_msgs);
+  EXPECT_EQ(ros_msgs, deserialized_ros_msgs);
+
+  // The buffer is overwritten and keeps its capacity
+  const size_t capacity = serialized_buffer.capacity();
+  serializer.serialize_messages_framed(ros_msgs, serialized_buffer);
+  EXPECT_EQ(capacity, serialized_buffer.capacity());
+  serializer.serialize_messages_framed(std::vector<MessageT>(), serialized_buffer);
+  EXPECT_EQ(0u, rclcpp::SerializationBase::get_framed_message_count(&serialized_buffer));
+
+  // Truncated frames are rejected
+  serializer.serialize_messages_framed(ros_msgs, serialized_buffer);
+  serialized_buffer.get_rcl_serialized_message().buffer_length -= 8u;
+  EXPECT_THROW(
+    rclcpp::SerializationBase::get_framed_message_count(&serialized_buffer),
+    std::invalid_argument);
+  EXPECT_THROW(
+    serializer.deserialize_messages_framed(serialized_buffer, deserialized_ros_msgs),
+    std::invalid_argument);
+
+  // The number of messages must match the number of frames
+  serializer.serialize_messages_framed(ros_msgs, serialized_buffer);
+  MessageT ros_msg;
+  void * ros_msg_ptr = &ros_msg;
+  EXPECT_THROW(
+    serializer.deserialize_messages_framed(&serialized_buffer, &ros_msg_ptr, 1u),
+    std::invalid_argument);
+}
+
 TEST(TestSerializedMessage, assignment_operators) {
   const std::string content = "Hello World";
   const auto content_size = content.size() + 1;  // accounting for null terminator
@@ -0,0 +1,71 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <memory>
+
+#include "rclcpp/serialized_message_pool.hpp"
+
+TEST(TestSerializedMessagePool, reuse_keeps_capacity) {
+  rclcpp::SerializedMessagePool pool;
+
+  auto message = pool.acquire();
+  ASSERT_NE(nullptr, message);
+  EXPECT_EQ(1u, pool.get_allocation_count());
+  message->reserve(1024);
+  message->get_rcl_serialized_message().buffer_length = 100;
+  auto * raw_message = message.get();
+  pool.release(message);
+  EXPECT_EQ(nullptr, message);
+  EXPECT_EQ(1u, pool.get_free_count());
+
+  message = pool.acquire(16);
+  EXPECT_EQ(raw_message, message.get());
+  EXPECT_EQ(0u, message->size());
+  EXPECT_EQ(1024u, message->capacity());
+  EXPECT_EQ(1u, pool.get_allocation_count());
+
+  // A bigger capacity grows the reused buffer
+  pool.release(message);
+  message = pool.acquire(2048);
+  EXPECT_EQ(2048u, message->capacity());
+  pool.release(message);
+}
+
+TEST(TestSerializedMessagePool, kept_messages_are_not_reused) {
+  rclcpp::SerializedMessagePool pool;
+
+  auto message = pool.acquire();
+  auto kept = message;
+  pool.release(message);
+  EXPECT_EQ(0u, pool.get_free_count());
+  EXPECT_EQ(nullptr, message);
+  EXPECT_EQ(1, kept.use_count());
+}
+
+TEST(TestSerializedMessagePool, depth) {
+  rclcpp::SerializedMessagePool pool(1);
+
+  auto first = pool.acquire();
+  auto second = pool.acquire();
+  pool.release(first);
+  pool.release(second);
+  EXPECT_EQ(1u, pool.get_free_count());
+
+  rclcpp::SerializedMessagePool disabled_pool(0);
+  auto message = disabled_pool.acquire();
+  disabled_pool.release(message);
+  EXPECT_EQ(0u, disabled_pool.get_free_count());
+}
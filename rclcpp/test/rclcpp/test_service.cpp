@@ -14,9 +14,14 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <chrono>
+#include <future>
 #include <string>
 #include <memory>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include "rclcpp/exceptions.hpp"
 #include "rclcpp/rclcpp.hpp"
@@ -25,6 +30,7 @@
 #include "../utils/rclcpp_gtest_macros.hpp"
 
 #include "rcl_interfaces/srv/list_parameters.hpp"
+#include "test_msgs/srv/basic_types.hpp"
 #include "test_msgs/srv/empty.hpp"
 #include "test_msgs/srv/empty.h"
 
@@ -239,6 +245,204 @@ TEST_F(TestService, send_response) {
   }
 }
 
+/*
+   Testing responses deferred through a DeferredResponse.
+ */
+TEST_F(TestService, deferred_response) {
+  using DeferredResponse = rclcpp::DeferredResponse<test_msgs::srv::Empty>;
+  std::vector<DeferredResponse> deferred_responses;
+  auto server = node->create_service<test_msgs::srv::Empty>(
+    "service",
+    [&deferred_responses](
+      const test_msgs::srv::Empty::Request::SharedPtr, DeferredResponse deferred_response) {
+      EXPECT_TRUE(deferred_response.is_pending());
+      deferred_responses.push_back(std::move(deferred_response));
+    });
+  auto client = node->create_client<test_msgs::srv::Empty>("service");
+  ASSERT_TRUE(client->wait_for_service(5s));
+  auto future1 = client->async_send_request(std::make_shared<test_msgs::srv::Empty::Request>());
+  auto future2 = client->async_send_request(std::make_shared<test_msgs::srv::Empty::Request>());
+
+  auto start = std::chrono::steady_clock::now();
+  while (deferred_responses.size() < 2u && std::chrono::steady_clock::now() - start < 5s) {
+    rclcpp::spin_some(node);
+  }
+  ASSERT_EQ(2u, deferred_responses.size());
+  EXPECT_EQ(2u, server->get_number_of_deferred_responses());
+
+  // The responses can be sent from any thread
+  std::thread sender([&deferred_responses]() {
+      test_msgs::srv::Empty::Response response;
+      EXPECT_TRUE(deferred_responses[0].send(response));
+      EXPECT_FALSE(deferred_responses[0].is_pending());
+      EXPECT_THROW(deferred_responses[0].send(response), std::runtime_error);
+    });
+  sender.join();
+  EXPECT_EQ(1u, server->get_number_of_deferred_responses());
+  EXPECT_EQ(
+    rclcpp::FutureReturnCode::SUCCESS, rclcpp::spin_until_future_complete(node, future1, 5s));
+
+  // Abandoned responses are released
+  deferred_responses.clear();
+  EXPECT_EQ(0u, server->get_number_of_deferred_responses());
+  EXPECT_EQ(1u, client->prune_pending_requests());
+}
+
+TEST_F(TestService, max_deferred_responses) {
+  using DeferredResponse = rclcpp::DeferredResponse<test_msgs::srv::Empty>;
+  std::vector<DeferredResponse> deferred_responses;
+  auto server = node->create_service<test_msgs::srv::Empty>(
+    "service",
+    [&deferred_responses](
+      const test_msgs::srv::Empty::Request::SharedPtr, DeferredResponse deferred_response) {
+      deferred_responses.push_back(std::move(deferred_response));
+    });
+  size_t overflow_count = 0;
+  server->set_max_deferred_responses(
+    1u,
+    [&overflow_count](
+      const test_msgs::srv::Empty::Request::SharedPtr,
+      test_msgs::srv::Empty::Response::SharedPtr) {overflow_count++;});
+  EXPECT_EQ(1u, server->get_max_deferred_responses());
+
+  auto client = node->create_client<test_msgs::srv::Empty>("service");
+  ASSERT_TRUE(client->wait_for_service(5s));
+  using SharedFuture = rclcpp::Client<test_msgs::srv::Empty>::SharedFuture;
+  size_t response_count = 0;
+  for (size_t i = 0; i < 3u; ++i) {
+    client->async_send_request(
+      std::make_shared<test_msgs::srv::Empty::Request>(),
+      [&response_count](SharedFuture) {response_count++;});
+  }
+
+  // The requests exceeding the limit are answered right away by the overflow callback
+  auto start = std::chrono::steady_clock::now();
+  while (response_count < 2u && std::chrono::steady_clock::now() - start < 5s) {
+    rclcpp::spin_some(node);
+  }
+  EXPECT_EQ(1u, deferred_responses.size());
+  EXPECT_EQ(2u, overflow_count);
+  EXPECT_EQ(2u, response_count);
+  EXPECT_EQ(1u, server->get_number_of_deferred_responses());
+
+  test_msgs::srv::Empty::Response response;
+  EXPECT_TRUE(deferred_responses[0].send(response));
+  EXPECT_EQ(0u, server->get_number_of_deferred_responses());
+  start = std::chrono::steady_clock::now();
+  while (response_count < 3u && std::chrono::steady_clock::now() - start < 5s) {
+    rclcpp::spin_some(node);
+  }
+  EXPECT_EQ(3u, response_count);
+}
+
+TEST_F(TestService, concurrency) {
+  using BasicTypes = test_msgs::srv::BasicTypes;
+  std::atomic_int running(0);
+  std::atomic_int max_running(0);
+  auto server = node->create_service<BasicTypes>(
+    "service",
+    [&running, &max_running](
+      const BasicTypes::Request::SharedPtr request, BasicTypes::Response::SharedPtr response) {
+      const int current = ++running;
+      int previous = max_running.load();
+      while (previous < current && !max_running.compare_exchange_weak(previous, current)) {
+      }
+      // The first requests take longer, their responses are still sent first
+      std::this_thread::sleep_for(std::chrono::milliseconds(40 - 10 * request->int32_value));
+      response->int32_value = request->int32_value;
+      --running;
+    });
+  rclcpp::ServiceConcurrencyOptions options;
+  options.max_concurrent_requests = 2;
+  options.ordered_responses = true;
+  options.thread_pool = std::make_shared<rclcpp::DeserializationThreadPool>(4);
+  server->set_concurrency(options);
+
+  auto client = node->create_client<BasicTypes>("service");
+  ASSERT_TRUE(client->wait_for_service(5s));
+  std::vector<int32_t> responses;
+  for (int32_t i = 0; i < 4; ++i) {
+    auto request = std::make_shared<BasicTypes::Request>();
+    request->int32_value = i;
+    client->async_send_request(
+      request,
+      [&responses](rclcpp::Client<BasicTypes>::SharedFuture future) {
+        responses.push_back(future.get()->int32_value);
+      });
+  }
+  auto start = std::chrono::steady_clock::now();
+  while (responses.size() < 4u && std::chrono::steady_clock::now() - start < 5s) {
+    rclcpp::spin_some(node);
+  }
+  EXPECT_EQ((std::vector<int32_t>{0, 1, 2, 3}), responses);
+  EXPECT_LE(max_running.load(), 2);
+
+  auto statistics = server->get_request_statistics();
+  EXPECT_EQ(4u, statistics.handled_requests);
+  EXPECT_EQ(0u, statistics.running_requests);
+  EXPECT_EQ(0u, statistics.queue_depth);
+  EXPECT_GT(statistics.max_service_time, std::chrono::nanoseconds(0));
+  server->reset_request_statistics();
+  EXPECT_EQ(0u, server->get_request_statistics().handled_requests);
+
+  options.max_concurrent_requests = 0;
+  EXPECT_THROW(server->set_concurrency(options), std::invalid_argument);
+}
+
+TEST_F(TestService, concurrency_overload) {
+  using BasicTypes = test_msgs::srv::BasicTypes;
+  std::promise<void> release;
+  auto released = release.get_future().share();
+  auto server = node->create_service<BasicTypes>(
+    "service",
+    [released](
+      const BasicTypes::Request::SharedPtr request, BasicTypes::Response::SharedPtr response) {
+      released.wait();
+      response->int32_value = request->int32_value;
+    });
+  rclcpp::ServiceConcurrencyOptions options;
+  options.max_queue_depth = 1;
+  options.thread_pool = std::make_shared<rclcpp::DeserializationThreadPool>(1);
+  server->set_concurrency(options);
+  server->set_overload_callback(
+    [](const BasicTypes::Request::SharedPtr, BasicTypes::Response::SharedPtr response) {
+      response->int32_value = -1;
+    });
+
+  auto client = node->create_client<BasicTypes>("service");
+  ASSERT_TRUE(client->wait_for_service(5s));
+  std::vector<int32_t> responses;
+  auto send_request = [&client, &responses](int32_t value) {
+      auto request = std::make_shared<BasicTypes::Request>();
+      request->int32_value = value;
+      client->async_send_request(
+        request,
+        [&responses](rclcpp::Client<BasicTypes>::SharedFuture future) {
+          responses.push_back(future.get()->int32_value);
+        });
+    };
+  auto spin_until_responses = [this, &responses](size_t count) {
+      auto start = std::chrono::steady_clock::now();
+      while (responses.size() < count && std::chrono::steady_clock::now() - start < 5s) {
+        rclcpp::spin_some(node);
+      }
+    };
+  // The first request runs and the second one waits, the third one is rejected right away
+  send_request(1);
+  send_request(2);
+  send_request(3);
+  spin_until_responses(1);
+  EXPECT_EQ((std::vector<int32_t>{-1}), responses);
+  release.set_value();
+  spin_until_responses(3);
+  EXPECT_EQ((std::vector<int32_t>{-1, 1, 2}), responses);
+
+  auto statistics = server->get_request_statistics();
+  EXPECT_EQ(2u, statistics.handled_requests);
+  EXPECT_EQ(1u, statistics.rejected_requests);
+  EXPECT_EQ(0u, statistics.expired_requests);
+}
+
 /*
    Testing on_new_request callbacks.
  */
@@ -0,0 +1,74 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/detail/snapshot_ptr.hpp"
+
+using rclcpp::detail::SnapshotPtr;
+
+TEST(TestSnapshotPtr, load_store) {
+  SnapshotPtr<int> empty;
+  EXPECT_EQ(nullptr, empty.load());
+
+  SnapshotPtr<int> snapshot(std::make_shared<const int>(1));
+  const auto first = snapshot.load();
+  ASSERT_NE(nullptr, first);
+  EXPECT_EQ(1, *first);
+
+  snapshot.store(std::make_shared<const int>(2));
+  EXPECT_EQ(2, *snapshot.load());
+  // The snapshot loaded before the store is still valid
+  EXPECT_EQ(1, *first);
+  EXPECT_EQ(1, first.use_count());
+}
+
+TEST(TestSnapshotPtr, concurrent_loads) {
+  // Each snapshot holds its version twice, so a torn or freed one would be seen
+  struct Version
+  {
+    int first;
+    int second;
+  };
+  constexpr int kStores = 2000;
+  SnapshotPtr<Version> snapshot(std::make_shared<const Version>(Version{0, 0}));
+  std::atomic_bool done{false};
+  std::vector<std::thread> readers;
+  for (size_t i = 0; i < 3; ++i) {
+    readers.emplace_back(
+      [&snapshot, &done]() {
+        int last = 0;
+        while (!done.load()) {
+          const auto version = snapshot.load();
+          ASSERT_EQ(version->first, version->second);
+          // The versions are stored in order, a reader never goes back
+          ASSERT_LE(last, version->first);
+          last = version->first;
+        }
+      });
+  }
+  for (int i = 1; i <= kStores; ++i) {
+    snapshot.store(std::make_shared<const Version>(Version{i, i}));
+  }
+  done.store(true);
+  for (auto & reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(kStores, snapshot.load()->first);
+}
@@ -16,6 +16,7 @@
 
 #include <chrono>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <string>
 #include <thread>
@@ -27,6 +28,7 @@
 #include "../mocking_utils/patch.hpp"
 #include "../utils/rclcpp_gtest_macros.hpp"
 
+#include "test_msgs/msg/basic_types.hpp"
 #include "test_msgs/msg/empty.hpp"
 
 using namespace std::chrono_literals;
@@ -324,6 +326,171 @@ TEST_F(TestSubscription, take) {
   // TODO(wjwwood): figure out a good way to test the intra-process exclusion behavior.
 }
 
+/*
+   Testing the executor taking several messages each time the subscription is ready.
+ */
+TEST_F(TestSubscription, execute_subscription_max_messages_per_take) {
+  initialize();
+  using test_msgs::msg::Empty;
+  size_t received = 0;
+  auto callback = [&received](Empty::ConstSharedPtr) {received++;};
+  rclcpp::SubscriptionOptions so;
+  so.use_intra_process_comm = rclcpp::IntraProcessSetting::Disable;
+  auto default_sub = node->create_subscription<Empty>("~/test_batched_take", 10, callback, so);
+  EXPECT_EQ(0u, default_sub->get_max_messages_per_take());
+
+  so.max_messages_per_take = 2;
+  auto sub = node->create_subscription<Empty>("~/test_batched_take", 10, callback, so);
+  EXPECT_EQ(2u, sub->get_max_messages_per_take());
+  rclcpp::PublisherOptions po;
+  po.use_intra_process_comm = rclcpp::IntraProcessSetting::Disable;
+  auto pub = node->create_publisher<Empty>("~/test_batched_take", 10, po);
+  for (int i = 0; i < 3; ++i) {
+    pub->publish(Empty());
+  }
+
+  size_t taken = 0;
+  auto start = std::chrono::steady_clock::now();
+  while (taken < 3 && std::chrono::steady_clock::now() - start < 10s) {
+    std::this_thread::sleep_for(100ms);
+    size_t taken_now = rclcpp::Executor::execute_subscription(sub, 1);
+    EXPECT_LE(taken_now, 2u);
+    taken += taken_now;
+  }
+  EXPECT_EQ(3u, taken);
+  EXPECT_EQ(3u, received);
+  EXPECT_EQ(0u, rclcpp::Executor::execute_subscription(sub, 1));
+
+  // The subscription without its own maximum uses the one of the executor
+  received = 0;
+  taken = 0;
+  start = std::chrono::steady_clock::now();
+  while (taken < 3 && std::chrono::steady_clock::now() - start < 10s) {
+    std::this_thread::sleep_for(100ms);
+    taken += rclcpp::Executor::execute_subscription(
+      default_sub, std::numeric_limits<size_t>::max());
+  }
+  EXPECT_EQ(3u, taken);
+  EXPECT_EQ(3u, received);
+
+  // A single message is taken for one event, whatever the maximum of the subscription
+  for (int i = 0; i < 2; ++i) {
+    pub->publish(Empty());
+  }
+  received = 0;
+  start = std::chrono::steady_clock::now();
+  while (received < 2 && std::chrono::steady_clock::now() - start < 10s) {
+    std::this_thread::sleep_for(100ms);
+    const size_t received_before = received;
+    rclcpp::Executor::execute_subscription(sub);
+    EXPECT_LE(received, received_before + 1);
+  }
+  EXPECT_EQ(2u, received);
+}
+
+TEST_F(TestSubscription, deserialization_thread_pool) {
+  initialize();
+  using test_msgs::msg::BasicTypes;
+  std::vector<int32_t> received;
+  std::thread::id callback_thread_id;
+  auto callback = [&received, &callback_thread_id](BasicTypes::ConstSharedPtr msg) {
+      received.push_back(msg->int32_value);
+      callback_thread_id = std::this_thread::get_id();
+    };
+  rclcpp::SubscriptionOptions so;
+  so.use_intra_process_comm = rclcpp::IntraProcessSetting::Disable;
+  so.deserialization_thread_pool = std::make_shared<rclcpp::DeserializationThreadPool>(2);
+  EXPECT_EQ(2u, so.deserialization_thread_pool->get_number_of_threads());
+  auto sub = node->create_subscription<BasicTypes>("~/test_deserialization", 10, callback, so);
+  // The messages are taken serialized and deserialized on the thread pool
+  EXPECT_TRUE(sub->is_serialized());
+  ASSERT_NE(nullptr, sub->get_deserialization_waitable());
+
+  rclcpp::PublisherOptions po;
+  po.use_intra_process_comm = rclcpp::IntraProcessSetting::Disable;
+  auto pub = node->create_publisher<BasicTypes>("~/test_deserialization", 10, po);
+  BasicTypes msg;
+  for (int32_t i = 0; i < 5; ++i) {
+    msg.int32_value = i;
+    pub->publish(msg);
+  }
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  auto start = std::chrono::steady_clock::now();
+  while (received.size() < 5u && std::chrono::steady_clock::now() - start < 10s) {
+    executor.spin_some(100ms);
+  }
+  // The callbacks are executed by the executor, in order
+  EXPECT_EQ(std::vector<int32_t>({0, 1, 2, 3, 4}), received);
+  EXPECT_EQ(std::this_thread::get_id(), callback_thread_id);
+
+  // The small messages are deserialized by the executor
+  so.deserialization_thread_pool_min_size = std::numeric_limits<size_t>::max();
+  received.clear();
+  auto small_sub = node->create_subscription<BasicTypes>(
+    "~/test_deserialization_small", 10, callback, so);
+  auto small_pub = node->create_publisher<BasicTypes>("~/test_deserialization_small", 10, po);
+  small_pub->publish(msg);
+  start = std::chrono::steady_clock::now();
+  while (received.empty() && std::chrono::steady_clock::now() - start < 10s) {
+    std::this_thread::sleep_for(100ms);
+    rclcpp::Executor::execute_subscription(small_sub, 1);
+  }
+  EXPECT_EQ(std::vector<int32_t>({4}), received);
+
+  // The pool doesn't apply to the callbacks of serialized messages
+  auto serialized_sub = node->create_subscription<BasicTypes>(
+    "~/test_deserialization", 10, [](std::shared_ptr<const rclcpp::SerializedMessage>) {}, so);
+  EXPECT_EQ(nullptr, serialized_sub->get_deserialization_waitable());
+}
+
+TEST_F(TestSubscription, prefetch_depth) {
+  initialize();
+  using test_msgs::msg::BasicTypes;
+  std::vector<int32_t> received;
+  std::thread::id callback_thread_id;
+  auto callback = [&received, &callback_thread_id](BasicTypes::ConstSharedPtr msg) {
+      received.push_back(msg->int32_value);
+      callback_thread_id = std::this_thread::get_id();
+    };
+  rclcpp::SubscriptionOptions so;
+  so.use_intra_process_comm = rclcpp::IntraProcessSetting::Disable;
+  auto default_sub = node->create_subscription<BasicTypes>(
+    "~/test_prefetch_default", 10, callback, so);
+  EXPECT_EQ(0u, default_sub->get_prefetch_depth());
+  EXPECT_FALSE(default_sub->take_and_prefetch());
+
+  // Without a thread pool, the worker pool of the context prefetches the messages
+  so.prefetch_depth = 3;
+  auto sub = node->create_subscription<BasicTypes>("~/test_prefetch", 10, callback, so);
+  EXPECT_EQ(3u, sub->get_prefetch_depth());
+  EXPECT_TRUE(sub->is_serialized());
+  ASSERT_NE(nullptr, sub->get_deserialization_waitable());
+
+  rclcpp::PublisherOptions po;
+  po.use_intra_process_comm = rclcpp::IntraProcessSetting::Disable;
+  auto pub = node->create_publisher<BasicTypes>("~/test_prefetch", 10, po);
+  BasicTypes msg;
+  for (int32_t i = 0; i < 8; ++i) {
+    msg.int32_value = i;
+    pub->publish(msg);
+  }
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  auto start = std::chrono::steady_clock::now();
+  while (received.size() < 8u && std::chrono::steady_clock::now() - start < 10s) {
+    executor.spin_some(100ms);
+  }
+  // The messages taken by the executor and by the pool are handled in order, by the executor
+  EXPECT_EQ(std::vector<int32_t>({0, 1, 2, 3, 4, 5, 6, 7}), received);
+  EXPECT_EQ(std::this_thread::get_id(), callback_thread_id);
+  EXPECT_EQ(0u, std::static_pointer_cast<
+      rclcpp::experimental::SubscriptionDeserializationWaitable>(
+      sub->get_deserialization_waitable())->get_number_of_pending_messages());
+}
+
 /*
    Testing take_serialized.
  */
@@ -440,6 +607,18 @@ TEST_F(TestSubscription, handle_loaned_message) {
   EXPECT_NO_THROW(sub->handle_loaned_message(&msg, message_info));
 }
 
+TEST_F(TestSubscription, loaned_message_callback) {
+  initialize();
+  auto callback = [](rclcpp::SubscriptionLoanedMessage<test_msgs::msg::Empty>) {};
+  auto sub = node->create_subscription<test_msgs::msg::Empty>("topic", 10, callback);
+  // The loans are returned by the handles given to the callback
+  EXPECT_TRUE(sub->keeps_loaned_messages());
+
+  auto other_callback = [](std::shared_ptr<const test_msgs::msg::Empty>) {};
+  auto other_sub = node->create_subscription<test_msgs::msg::Empty>("topic", 10, other_callback);
+  EXPECT_FALSE(other_sub->keeps_loaned_messages());
+}
+
 /*
    Testing on_new_message callbacks.
  */
@@ -580,6 +759,508 @@ TEST_F(TestSubscription, on_new_intra_process_message_callback) {
   EXPECT_THROW(sub->set_on_new_intra_process_message_callback(invalid_cb), std::invalid_argument);
 }
 
+/*
+   Testing the intra-process buffer metrics.
+ */
+TEST_F(TestSubscription, rate_limit) {
+  initialize();
+  using test_msgs::msg::BasicTypes;
+  std::vector<int32_t> received;
+  auto callback = [&received](BasicTypes::ConstSharedPtr msg) {
+      received.push_back(msg->int32_value);
+    };
+  rclcpp::SubscriptionOptions so;
+  so.use_intra_process_comm = rclcpp::IntraProcessSetting::Disable;
+  so.rate_limit.policy = rclcpp::RateLimitPolicy::LatestPerInterval;
+  so.rate_limit.max_frequency = 0.01;
+  so.max_messages_per_take = 100;
+  auto sub = node->create_subscription<BasicTypes>("~/test_rate_limit", 10, callback, so);
+  ASSERT_NE(nullptr, sub->get_rate_limiter());
+  rclcpp::PublisherOptions po;
+  po.use_intra_process_comm = rclcpp::IntraProcessSetting::Disable;
+  auto pub = node->create_publisher<BasicTypes>("~/test_rate_limit", 10, po);
+  BasicTypes msg;
+  for (int32_t i = 0; i < 3; ++i) {
+    msg.int32_value = i;
+    pub->publish(msg);
+  }
+
+  // The messages queued by the middleware are skipped up to the newest one
+  auto start = std::chrono::steady_clock::now();
+  while (sub->get_rate_limiter()->get_dropped_count() < 2u &&
+    std::chrono::steady_clock::now() - start < 10s)
+  {
+    std::this_thread::sleep_for(100ms);
+    rclcpp::Executor::execute_subscription(sub, 1);
+  }
+  EXPECT_EQ(std::vector<int32_t>({2}), received);
+  EXPECT_EQ(1u, sub->get_rate_limiter()->get_kept_count());
+  EXPECT_EQ(2u, sub->get_rate_limiter()->get_dropped_count());
+
+  // The messages received within the interval are all dropped
+  pub->publish(msg);
+  start = std::chrono::steady_clock::now();
+  while (sub->get_rate_limiter()->get_dropped_count() < 3u &&
+    std::chrono::steady_clock::now() - start < 10s)
+  {
+    std::this_thread::sleep_for(100ms);
+    EXPECT_EQ(0u, rclcpp::Executor::execute_subscription(sub, 1));
+  }
+  EXPECT_EQ(1u, received.size());
+  EXPECT_EQ(3u, sub->get_rate_limiter()->get_dropped_count());
+
+  // The intra-process messages are dropped before being queued
+  received.clear();
+  so.use_intra_process_comm = rclcpp::IntraProcessSetting::Enable;
+  so.rate_limit.policy = rclcpp::RateLimitPolicy::KeepEveryNth;
+  so.rate_limit.keep_every_nth = 2;
+  auto intra_process_sub = node->create_subscription<BasicTypes>(
+    "~/test_intra_process_rate_limit", 10, callback, so);
+  po.use_intra_process_comm = rclcpp::IntraProcessSetting::Enable;
+  auto intra_process_pub = node->create_publisher<BasicTypes>(
+    "~/test_intra_process_rate_limit", 10, po);
+  for (int32_t i = 0; i < 4; ++i) {
+    msg.int32_value = i;
+    intra_process_pub->publish(msg);
+  }
+  auto metrics = intra_process_sub->get_intra_process_buffer_metrics();
+  ASSERT_TRUE(metrics.has_value());
+  EXPECT_EQ(2u, metrics->enqueued_count);
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  executor.spin_some();
+  EXPECT_EQ(std::vector<int32_t>({0, 2}), received);
+  EXPECT_EQ(2u, intra_process_sub->get_rate_limiter()->get_kept_count());
+  EXPECT_EQ(2u, intra_process_sub->get_rate_limiter()->get_dropped_count());
+
+  so.rate_limit.keep_every_nth = 0;
+  EXPECT_THROW(
+    node->create_subscription<BasicTypes>("~/test_rate_limit", 10, callback, so),
+    std::invalid_argument);
+}
+
+TEST_F(TestSubscription, pause_and_resume) {
+  initialize();
+  using test_msgs::msg::BasicTypes;
+  std::vector<int32_t> received;
+  auto callback = [&received](BasicTypes::ConstSharedPtr msg) {
+      received.push_back(msg->int32_value);
+    };
+  rclcpp::SubscriptionOptions so;
+  so.use_intra_process_comm = rclcpp::IntraProcessSetting::Disable;
+  so.max_messages_per_take = 100;
+  auto sub = node->create_subscription<BasicTypes>("~/test_pause", 10, callback, so);
+  rclcpp::PublisherOptions po;
+  po.use_intra_process_comm = rclcpp::IntraProcessSetting::Disable;
+  auto pub = node->create_publisher<BasicTypes>("~/test_pause", 10, po);
+  EXPECT_FALSE(sub->is_paused());
+
+  // The messages received while paused are dropped without calling the callback
+  sub->pause();
+  EXPECT_TRUE(sub->is_paused());
+  BasicTypes msg;
+  for (int32_t i = 0; i < 3; ++i) {
+    msg.int32_value = i;
+    pub->publish(msg);
+  }
+  auto start = std::chrono::steady_clock::now();
+  while (sub->get_paused_dropped_count() < 3u && std::chrono::steady_clock::now() - start < 10s) {
+    std::this_thread::sleep_for(100ms);
+    EXPECT_EQ(0u, rclcpp::Executor::execute_subscription(sub, 1));
+  }
+  EXPECT_EQ(3u, sub->get_paused_dropped_count());
+  EXPECT_TRUE(received.empty());
+
+  // Still matched, the messages are delivered as soon as it's resumed
+  sub->resume();
+  EXPECT_EQ(1u, pub->get_subscription_count());
+  msg.int32_value = 3;
+  pub->publish(msg);
+  start = std::chrono::steady_clock::now();
+  while (received.empty() && std::chrono::steady_clock::now() - start < 10s) {
+    std::this_thread::sleep_for(100ms);
+    rclcpp::Executor::execute_subscription(sub, 1);
+  }
+  EXPECT_EQ(std::vector<int32_t>({3}), received);
+
+  // The intra-process messages aren't queued while paused
+  received.clear();
+  so.use_intra_process_comm = rclcpp::IntraProcessSetting::Enable;
+  auto intra_process_sub = node->create_subscription<BasicTypes>(
+    "~/test_intra_process_pause", 10, callback, so);
+  po.use_intra_process_comm = rclcpp::IntraProcessSetting::Enable;
+  auto intra_process_pub = node->create_publisher<BasicTypes>(
+    "~/test_intra_process_pause", 10, po);
+  msg.int32_value = 0;
+  intra_process_pub->publish(msg);
+  intra_process_sub->pause();
+  msg.int32_value = 1;
+  intra_process_pub->publish(msg);
+  auto metrics = intra_process_sub->get_intra_process_buffer_metrics();
+  ASSERT_TRUE(metrics.has_value());
+  EXPECT_EQ(1u, metrics->enqueued_count);
+
+  // The message queued before the pause is dropped by the executor
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  executor.spin_some();
+  EXPECT_TRUE(received.empty());
+  EXPECT_EQ(2u, intra_process_sub->get_paused_dropped_count());
+
+  intra_process_sub->resume();
+  msg.int32_value = 2;
+  intra_process_pub->publish(msg);
+  executor.spin_some();
+  EXPECT_EQ(std::vector<int32_t>({2}), received);
+}
+
+TEST_F(TestSubscription, max_message_age) {
+  initialize();
+  using test_msgs::msg::BasicTypes;
+  std::vector<int32_t> received;
+  auto callback = [&received](BasicTypes::ConstSharedPtr msg) {
+      received.push_back(msg->int32_value);
+    };
+  rclcpp::SubscriptionOptions so;
+  so.use_intra_process_comm = rclcpp::IntraProcessSetting::Disable;
+  so.max_message_age = 200ms;
+  so.max_messages_per_take = 100;
+  auto sub = node->create_subscription<BasicTypes>("~/test_max_message_age", 10, callback, so);
+  EXPECT_EQ(200ms, sub->get_max_message_age());
+  rclcpp::PublisherOptions po;
+  po.use_intra_process_comm = rclcpp::IntraProcessSetting::Disable;
+  auto pub = node->create_publisher<BasicTypes>("~/test_max_message_age", 10, po);
+  BasicTypes msg;
+  for (int32_t i = 0; i < 3; ++i) {
+    msg.int32_value = i;
+    pub->publish(msg);
+  }
+
+  // The messages left in the queue for too long are dropped, if the middleware stamps them
+  std::this_thread::sleep_for(500ms);
+  msg.int32_value = 3;
+  pub->publish(msg);
+  auto start = std::chrono::steady_clock::now();
+  while ((received.empty() || received.back() != 3) &&
+    std::chrono::steady_clock::now() - start < 10s)
+  {
+    rclcpp::Executor::execute_subscription(sub, 1);
+    std::this_thread::sleep_for(10ms);
+  }
+  const uint64_t expired_count = sub->get_expired_message_count();
+  EXPECT_TRUE(expired_count == 0u || expired_count == 3u);
+  EXPECT_EQ(4u - expired_count, received.size());
+  ASSERT_FALSE(received.empty());
+  EXPECT_EQ(3, received.back());
+
+  // The intra-process messages are dropped when taken
+  received.clear();
+  so.use_intra_process_comm = rclcpp::IntraProcessSetting::Enable;
+  auto intra_process_sub = node->create_subscription<BasicTypes>(
+    "~/test_intra_process_max_message_age", 10, callback, so);
+  po.use_intra_process_comm = rclcpp::IntraProcessSetting::Enable;
+  auto intra_process_pub = node->create_publisher<BasicTypes>(
+    "~/test_intra_process_max_message_age", 10, po);
+  for (int32_t i = 0; i < 2; ++i) {
+    msg.int32_value = i;
+    intra_process_pub->publish(msg);
+  }
+  std::this_thread::sleep_for(300ms);
+  msg.int32_value = 2;
+  intra_process_pub->publish(msg);
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  executor.spin_some();
+  EXPECT_EQ(std::vector<int32_t>({2}), received);
+  EXPECT_EQ(2u, intra_process_sub->get_expired_message_count());
+
+  so.max_message_age = -1ms;
+  EXPECT_THROW(
+    node->create_subscription<BasicTypes>("~/test_max_message_age", 10, callback, so),
+    std::invalid_argument);
+}
+
+TEST_F(TestSubscription, take_without_message_info) {
+  initialize();
+  using test_msgs::msg::BasicTypes;
+  std::vector<int32_t> received;
+  rclcpp::SubscriptionOptions so;
+  so.use_intra_process_comm = rclcpp::IntraProcessSetting::Disable;
+  auto sub = node->create_subscription<BasicTypes>(
+    "~/test_take_without_message_info", 10,
+    [&received](const BasicTypes & msg) {received.push_back(msg.int32_value);}, so);
+  EXPECT_FALSE(sub->needs_message_info());
+  auto sub_with_info = node->create_subscription<BasicTypes>(
+    "~/test_take_without_message_info", 10,
+    [](const BasicTypes &, const rclcpp::MessageInfo &) {}, so);
+  EXPECT_TRUE(sub_with_info->needs_message_info());
+  // The message info tells which messages were also delivered intra-process
+  so.use_intra_process_comm = rclcpp::IntraProcessSetting::Enable;
+  auto intra_process_sub = node->create_subscription<BasicTypes>(
+    "~/test_take_without_message_info", 10, [](const BasicTypes &) {}, so);
+  EXPECT_TRUE(intra_process_sub->needs_message_info());
+
+  rclcpp::PublisherOptions po;
+  po.use_intra_process_comm = rclcpp::IntraProcessSetting::Disable;
+  auto pub = node->create_publisher<BasicTypes>("~/test_take_without_message_info", 10, po);
+  BasicTypes msg;
+  msg.int32_value = 42;
+  pub->publish(msg);
+  auto start = std::chrono::steady_clock::now();
+  while (received.empty() && std::chrono::steady_clock::now() - start < 10s) {
+    std::this_thread::sleep_for(100ms);
+    rclcpp::Executor::execute_subscription(sub, 1);
+  }
+  EXPECT_EQ(std::vector<int32_t>({42}), received);
+}
+
+TEST_F(TestSubscription, latest_value_only) {
+  initialize();
+  using test_msgs::msg::BasicTypes;
+  std::vector<int32_t> received;
+  auto callback = [&received](BasicTypes::ConstSharedPtr msg) {
+      received.push_back(msg->int32_value);
+    };
+  rclcpp::SubscriptionOptions so;
+  so.use_intra_process_comm = rclcpp::IntraProcessSetting::Disable;
+  so.latest_value_only = true;
+  so.max_messages_per_take = 100;
+  auto sub = node->create_subscription<BasicTypes>("~/test_latest_value_only", 10, callback, so);
+  EXPECT_EQ(nullptr, sub->get_latest_message());
+  EXPECT_EQ(1u, sub->get_actual_qos().depth());
+  rclcpp::PublisherOptions po;
+  po.use_intra_process_comm = rclcpp::IntraProcessSetting::Disable;
+  auto pub = node->create_publisher<BasicTypes>("~/test_latest_value_only", 10, po);
+  BasicTypes msg;
+  for (int32_t i = 0; i < 3; ++i) {
+    msg.int32_value = i;
+    pub->publish(msg);
+  }
+
+  // Only the newest message is kept by the middleware
+  auto start = std::chrono::steady_clock::now();
+  while (received.empty() && std::chrono::steady_clock::now() - start < 10s) {
+    std::this_thread::sleep_for(100ms);
+    rclcpp::Executor::execute_subscription(sub, 1);
+  }
+  EXPECT_EQ(std::vector<int32_t>({2}), received);
+  ASSERT_NE(nullptr, sub->get_latest_message());
+  EXPECT_EQ(2, sub->get_latest_message()->int32_value);
+
+  // The intra-process messages replace each other, the callback is called once
+  received.clear();
+  so.use_intra_process_comm = rclcpp::IntraProcessSetting::Enable;
+  auto intra_process_sub = node->create_subscription<BasicTypes>(
+    "~/test_intra_process_latest_value_only", 10, callback, so);
+  po.use_intra_process_comm = rclcpp::IntraProcessSetting::Enable;
+  auto intra_process_pub = node->create_publisher<BasicTypes>(
+    "~/test_intra_process_latest_value_only", 10, po);
+  for (int32_t i = 0; i < 4; ++i) {
+    msg.int32_value = i;
+    intra_process_pub->publish(msg);
+  }
+  auto metrics = intra_process_sub->get_intra_process_buffer_metrics();
+  ASSERT_TRUE(metrics.has_value());
+  EXPECT_EQ(1u, metrics->capacity);
+  EXPECT_EQ(1u, metrics->depth);
+  EXPECT_EQ(3u, metrics->dropped_count);
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  executor.spin_some();
+  EXPECT_EQ(std::vector<int32_t>({3}), received);
+  ASSERT_NE(nullptr, intra_process_sub->get_latest_message());
+  EXPECT_EQ(3, intra_process_sub->get_latest_message()->int32_value);
+
+  // Without the option, no message is kept
+  so.latest_value_only = false;
+  auto queued_sub = node->create_subscription<BasicTypes>(
+    "~/test_intra_process_latest_value_only", 10, callback, so);
+  intra_process_pub->publish(msg);
+  executor.spin_some();
+  EXPECT_EQ(nullptr, queued_sub->get_latest_message());
+}
+
+TEST_F(TestSubscription, intra_process_buffer_metrics) {
+  initialize(rclcpp::NodeOptions().use_intra_process_comms(true));
+  using test_msgs::msg::Empty;
+
+  auto callback = [](std::shared_ptr<const Empty>) {};
+  auto sub = node->create_subscription<Empty>("~/test_buffer_metrics", 2, callback);
+  auto pub = node->create_publisher<Empty>("~/test_buffer_metrics", 2);
+
+  Empty msg;
+  pub->publish(msg);
+  pub->publish(msg);
+  pub->publish(msg);
+
+  auto metrics = sub->get_intra_process_buffer_metrics();
+  ASSERT_TRUE(metrics.has_value());
+  EXPECT_EQ(2u, metrics->capacity);
+  EXPECT_EQ(2u, metrics->depth);
+  EXPECT_EQ(2u, metrics->high_water_mark);
+  EXPECT_EQ(3u, metrics->enqueued_count);
+  EXPECT_EQ(0u, metrics->dequeued_count);
+  EXPECT_EQ(1u, metrics->dropped_count);
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  executor.spin_some();
+
+  metrics = sub->get_intra_process_buffer_metrics();
+  ASSERT_TRUE(metrics.has_value());
+  EXPECT_EQ(0u, metrics->depth);
+  EXPECT_EQ(2u, metrics->dequeued_count);
+
+  rclcpp::SubscriptionOptions options;
+  options.use_intra_process_comm = rclcpp::IntraProcessSetting::Disable;
+  auto inter_process_sub = node->create_subscription<Empty>(
+    "~/test_buffer_metrics", 2, callback, options);
+  EXPECT_FALSE(inter_process_sub->get_intra_process_buffer_metrics().has_value());
+}
+
+/*
+   Testing intra-process batch callbacks.
+ */
+TEST_F(TestSubscription, intra_process_batch_callback) {
+  initialize(rclcpp::NodeOptions().use_intra_process_comms(true));
+  using test_msgs::msg::Empty;
+
+  std::vector<size_t> batch_sizes;
+  auto batch_callback =
+    [&batch_sizes](const std::vector<std::shared_ptr<const Empty>> & messages) {
+      batch_sizes.push_back(messages.size());
+    };
+  auto sub = node->create_subscription<Empty>("~/test_batch", 10, batch_callback);
+  auto pub = node->create_publisher<Empty>("~/test_batch", 10);
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+
+  Empty msg;
+  pub->publish(msg);
+  pub->publish(msg);
+  pub->publish(msg);
+  executor.spin_some();
+  ASSERT_EQ(batch_sizes.size(), 1u);
+  EXPECT_EQ(batch_sizes[0], 3u);
+
+  // The buffer was drained, the next batch only has the new message
+  pub->publish(msg);
+  executor.spin_some();
+  ASSERT_EQ(batch_sizes.size(), 2u);
+  EXPECT_EQ(batch_sizes[1], 1u);
+}
+
+TEST_F(TestSubscription, intra_process_direct_dispatch) {
+  initialize(rclcpp::NodeOptions().use_intra_process_comms(true));
+  using test_msgs::msg::Empty;
+
+  auto callback_group = node->create_callback_group(rclcpp::CallbackGroupType::Reentrant);
+  rclcpp::SubscriptionOptions options;
+  options.callback_group = callback_group;
+  options.intra_process_direct_dispatch = true;
+  options.intra_process_direct_dispatch_max_depth = 3;
+
+  rclcpp::Publisher<Empty>::SharedPtr pub;
+  size_t received = 0;
+  std::thread::id callback_thread_id;
+  auto callback = [&](Empty::ConstSharedPtr msg) {
+      callback_thread_id = std::this_thread::get_id();
+      // Publishing from the callback nests direct dispatches, up to the maximum depth
+      if (++received < 10) {
+        pub->publish(*msg);
+      }
+    };
+  auto sub = node->create_subscription<Empty>("~/test_direct_dispatch", 10, callback, options);
+  pub = node->create_publisher<Empty>("~/test_direct_dispatch", 10);
+  EXPECT_TRUE(sub->get_intra_process_waitable() != nullptr);
+
+  // Executed by the publishing thread, without spinning
+  pub->publish(Empty());
+  EXPECT_EQ(3u, received);
+  EXPECT_EQ(std::this_thread::get_id(), callback_thread_id);
+
+  // The message published deeper than the maximum depth was queued for the executor
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  for (int i = 0; i < 10 && received < 10u; ++i) {
+    executor.spin_some();
+  }
+  EXPECT_EQ(10u, received);
+}
+
+TEST_F(TestSubscription, intra_process_lineage) {
+  initialize(rclcpp::NodeOptions().use_intra_process_comms(true));
+  using test_msgs::msg::Empty;
+
+  rclcpp::PublisherOptions publisher_options;
+  publisher_options.propagate_lineage = true;
+  rclcpp::SubscriptionOptions subscription_options;
+  subscription_options.track_lineage = true;
+
+  // A chain of two hops, the first one republishing the messages it receives
+  auto relay_pub = node->create_publisher<Empty>("~/test_lineage_relayed", 10, publisher_options);
+  rclcpp::MessageLineage first_hop_lineage;
+  auto first_hop_sub = node->create_subscription<Empty>(
+    "~/test_lineage", 10,
+    [&](Empty::ConstSharedPtr msg, const rclcpp::MessageInfo & message_info) {
+      first_hop_lineage = message_info.get_lineage();
+      EXPECT_EQ(first_hop_lineage.flow_id, rclcpp::get_current_message_lineage().flow_id);
+      relay_pub->publish(*msg);
+    },
+    subscription_options);
+  rclcpp::MessageLineage second_hop_lineage;
+  auto second_hop_sub = node->create_subscription<Empty>(
+    "~/test_lineage_relayed", 10,
+    [&](Empty::ConstSharedPtr, const rclcpp::MessageInfo & message_info) {
+      second_hop_lineage = message_info.get_lineage();
+    },
+    subscription_options);
+  auto pub = node->create_publisher<Empty>("~/test_lineage", 10, publisher_options);
+
+  pub->publish(Empty());
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  for (int i = 0; i < 10 && !second_hop_lineage.is_valid(); ++i) {
+    executor.spin_some();
+  }
+  ASSERT_TRUE(first_hop_lineage.is_valid());
+  EXPECT_EQ(first_hop_lineage.flow_id, second_hop_lineage.flow_id);
+  EXPECT_EQ(first_hop_lineage.origin_timestamp, second_hop_lineage.origin_timestamp);
+  EXPECT_FALSE(rclcpp::get_current_message_lineage().is_valid());
+
+  ASSERT_NE(nullptr, first_hop_sub->get_lineage_tracker());
+  ASSERT_NE(nullptr, second_hop_sub->get_lineage_tracker());
+  EXPECT_EQ(1u, first_hop_sub->get_lineage_tracker()->take_latency_snapshot().get_count());
+  EXPECT_EQ(1u, second_hop_sub->get_lineage_tracker()->take_latency_snapshot().get_count());
+
+  // The messages of a publisher without the option have no flow
+  bool received = false;
+  rclcpp::MessageLineage untracked_lineage = rclcpp::start_message_flow();
+  auto untracked_sub = node->create_subscription<Empty>(
+    "~/test_lineage_untracked", 10,
+    [&](Empty::ConstSharedPtr, const rclcpp::MessageInfo & message_info) {
+      untracked_lineage = message_info.get_lineage();
+      received = true;
+    },
+    subscription_options);
+  auto untracked_pub = node->create_publisher<Empty>("~/test_lineage_untracked", 10);
+  untracked_pub->publish(Empty());
+  for (int i = 0; i < 10 && !received; ++i) {
+    executor.spin_some();
+  }
+  EXPECT_TRUE(received);
+  EXPECT_FALSE(untracked_lineage.is_valid());
+  EXPECT_EQ(1u, untracked_sub->get_lineage_tracker()->get_untracked_count());
+
+  // Without the option, the subscription has no tracker
+  auto default_sub = node->create_subscription<Empty>(
+    "~/test_lineage", 10, [](Empty::ConstSharedPtr) {});
+  EXPECT_EQ(nullptr, default_sub->get_lineage_tracker());
+}
+
 /*
    Testing subscription with intraprocess enabled and invalid QoS
  */
@@ -629,11 +1310,7 @@ static std::vector<TestParameters> invalid_qos_profiles()
 {
   std::vector<TestParameters> parameters;
 
-  parameters.reserve(3);
-  parameters.push_back(
-    TestParameters(
-      rclcpp::QoS(rclcpp::KeepLast(10)).transient_local(),
-      "transient_local_qos"));
+  parameters.reserve(1);
   parameters.push_back(
     TestParameters(
       rclcpp::QoS(rclcpp::KeepAll()),
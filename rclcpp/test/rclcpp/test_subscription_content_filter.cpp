@@ -128,6 +128,9 @@ TEST_F(CLASSNAME(TestContentFilterSubscription, RMW_IMPLEMENTATION), is_cft_enab
 }
 
 TEST_F(CLASSNAME(TestContentFilterSubscription, RMW_IMPLEMENTATION), get_content_filter_error) {
+  // The filter is only got from rcl when the middleware filters the messages
+  auto cft_enabled_mock = mocking_utils::patch_and_return(
+    "lib:rclcpp", rcl_subscription_is_cft_enabled, true);
   auto mock = mocking_utils::patch_and_return(
     "lib:rclcpp", rcl_subscription_get_content_filter, RCL_RET_ERROR);
 
@@ -151,27 +154,29 @@ TEST_F(CLASSNAME(TestContentFilterSubscription, RMW_IMPLEMENTATION), set_content
 TEST_F(CLASSNAME(TestContentFilterSubscription, RMW_IMPLEMENTATION), get_content_filter) {
   rclcpp::ContentFilterOptions options;
 
-  if (sub->is_cft_enabled()) {
-    EXPECT_NO_THROW(
-      options = sub->get_content_filter());
+  // Without a middleware support, the filter is evaluated by rclcpp
+  EXPECT_TRUE(sub->is_content_filter_enabled());
+  EXPECT_NO_THROW(
+    options = sub->get_content_filter());
 
-    EXPECT_EQ(options.filter_expression, filter_expression_init);
-    EXPECT_EQ(options.expression_parameters, expression_parameters_1);
-  } else {
-    EXPECT_THROW(
-      options = sub->get_content_filter(),
-      rclcpp::exceptions::RCLError);
-  }
+  EXPECT_EQ(options.filter_expression, filter_expression_init);
+  EXPECT_EQ(options.expression_parameters, expression_parameters_1);
 }
 
 TEST_F(CLASSNAME(TestContentFilterSubscription, RMW_IMPLEMENTATION), set_content_filter) {
-  if (sub->is_cft_enabled()) {
-    EXPECT_NO_THROW(
-      sub->set_content_filter(filter_expression_init, expression_parameters_2));
-  } else {
+  EXPECT_NO_THROW(
+    sub->set_content_filter(filter_expression_init, expression_parameters_2));
+  EXPECT_EQ(expression_parameters_2, sub->get_content_filter().expression_parameters);
+
+  if (!sub->is_cft_enabled()) {
+    // rclcpp compiles the expression
     EXPECT_THROW(
-      sub->set_content_filter(filter_expression_init, expression_parameters_2),
-      rclcpp::exceptions::RCLError);
+      sub->set_content_filter("int32_value = 'x'"),
+      std::invalid_argument);
+
+    EXPECT_NO_THROW(sub->set_content_filter(""));
+    EXPECT_FALSE(sub->is_content_filter_enabled());
+    EXPECT_TRUE(sub->get_content_filter().filter_expression.empty());
   }
 }
 
@@ -200,12 +205,14 @@ TEST_F(CLASSNAME(TestContentFilterSubscription, RMW_IMPLEMENTATION), content_fil
     EXPECT_TRUE(receive);
     EXPECT_EQ(original_message, output_message);
 
+    EXPECT_NO_THROW(
+      sub->set_content_filter(filter_expression_init, expression_parameters_2));
     if (sub->is_cft_enabled()) {
-      EXPECT_NO_THROW(
-        sub->set_content_filter(filter_expression_init, expression_parameters_2));
       // waiting to allow for filter propagation
       std::this_thread::sleep_for(std::chrono::seconds(10));
+    }
 
+    {
       test_msgs::msg::BasicTypes original_message;
       original_message.int32_value = 3;
       pub->publish(original_message);
@@ -237,21 +244,19 @@ TEST_F(CLASSNAME(TestContentFilterSubscription, RMW_IMPLEMENTATION), content_fil
     original_message.int32_value = 4;
     pub->publish(original_message);
 
+    // Filtered by the middleware or by rclcpp
     test_msgs::msg::BasicTypes output_message;
     bool receive = wait_for_message(output_message, sub, context, 10s);
-    if (sub->is_cft_enabled()) {
-      EXPECT_FALSE(receive);
-    } else {
-      EXPECT_TRUE(receive);
-      EXPECT_EQ(original_message, output_message);
-    }
+    EXPECT_FALSE(receive);
 
+    EXPECT_NO_THROW(
+      sub->set_content_filter(filter_expression_init, expression_parameters_2));
     if (sub->is_cft_enabled()) {
-      EXPECT_NO_THROW(
-        sub->set_content_filter(filter_expression_init, expression_parameters_2));
       // waiting to allow for filter propagation
       std::this_thread::sleep_for(std::chrono::seconds(10));
+    }
 
+    {
       test_msgs::msg::BasicTypes original_message;
       original_message.int32_value = 4;
       pub->publish(original_message);
@@ -284,21 +289,19 @@ TEST_F(CLASSNAME(TestContentFilterSubscription, RMW_IMPLEMENTATION), content_fil
     original_message.int32_value = 4;
     pub->publish(original_message);
 
+    // Filtered by the middleware or by rclcpp
     test_msgs::msg::BasicTypes output_message;
     bool receive = wait_for_message(output_message, sub, context, 10s);
-    if (sub->is_cft_enabled()) {
-      EXPECT_FALSE(receive);
-    } else {
-      EXPECT_TRUE(receive);
-      EXPECT_EQ(original_message, output_message);
-    }
+    EXPECT_FALSE(receive);
 
+    EXPECT_NO_THROW(
+      sub->set_content_filter(""));
     if (sub->is_cft_enabled()) {
-      EXPECT_NO_THROW(
-        sub->set_content_filter(""));
       // waiting to allow for filter propagation
       std::this_thread::sleep_for(std::chrono::seconds(10));
+    }
 
+    {
       test_msgs::msg::BasicTypes original_message;
       original_message.int32_value = 4;
       pub->publish(original_message);
@@ -310,3 +313,33 @@ TEST_F(CLASSNAME(TestContentFilterSubscription, RMW_IMPLEMENTATION), content_fil
     }
   }
 }
+
+TEST_F(CLASSNAME(TestContentFilterSubscription, RMW_IMPLEMENTATION), content_filter_intra_process) {
+  using namespace std::chrono_literals;
+  auto options = rclcpp::SubscriptionOptions();
+  options.use_intra_process_comm = rclcpp::IntraProcessSetting::Enable;
+  options.content_filter_options.filter_expression = filter_expression_init;
+  options.content_filter_options.expression_parameters = expression_parameters_1;
+
+  std::vector<int32_t> received;
+  auto intra_process_sub = node->create_subscription<test_msgs::msg::BasicTypes>(
+    "content_filter_intra_process_topic", rclcpp::QoS(10),
+    [&received](const test_msgs::msg::BasicTypes & message) {
+      received.push_back(message.int32_value);
+    },
+    options);
+  rclcpp::PublisherOptions pub_options;
+  pub_options.use_intra_process_comm = rclcpp::IntraProcessSetting::Enable;
+  auto pub = node->create_publisher<test_msgs::msg::BasicTypes>(
+    "content_filter_intra_process_topic", rclcpp::QoS(10), pub_options);
+
+  // The intra-process messages are always filtered by rclcpp
+  for (int32_t value : {3, 4, 3}) {
+    test_msgs::msg::BasicTypes message;
+    message.int32_value = value;
+    pub->publish(message);
+  }
+  ASSERT_TRUE(wait_for([&received]() {return received.size() >= 2u;}, 10s));
+  rclcpp::spin_some(node);
+  EXPECT_EQ(std::vector<int32_t>({3, 3}), received);
+}
@@ -77,6 +77,57 @@ struct TypeAdapter<std::string, rclcpp::msg::String>
 
 }  // namespace rclcpp
 
+/// A view of the data of a shared rclcpp::msg::String.
+struct StringView
+{
+  std::shared_ptr<const rclcpp::msg::String> message;
+  const char * data = nullptr;
+};
+
+namespace rclcpp
+{
+
+template<>
+struct TypeAdapter<StringView, rclcpp::msg::String>
+{
+  using is_specialized = std::true_type;
+  using custom_type = StringView;
+  using ros_message_type = rclcpp::msg::String;
+
+  static void
+  convert_to_ros_message(
+    const custom_type & source,
+    ros_message_type & destination)
+  {
+    destination.data = source.data;
+  }
+
+  static void
+  convert_to_custom(
+    const ros_message_type & source,
+    custom_type & destination)
+  {
+    convert_to_custom(std::make_shared<const ros_message_type>(source), destination);
+  }
+
+  static void
+  convert_to_custom(
+    const std::shared_ptr<const ros_message_type> & source,
+    custom_type & destination)
+  {
+    destination.message = source;
+    destination.data = source->data.c_str();
+  }
+
+  static std::shared_ptr<const ros_message_type>
+  get_viewed_ros_message(const custom_type & source)
+  {
+    return source.message;
+  }
+};
+
+}  // namespace rclcpp
+
 void wait_for_message_to_be_received(
   bool & is_received,
   const std::shared_ptr<rclcpp::Node> & node)
@@ -561,3 +612,71 @@ TEST_F(
     }
   }
 }
+
+/*
+ * Testing that a view type adapter refers to the data of the messages instead of copying it.
+ */
+TEST_F(TestSubscription, view_type_adapter_intra_process) {
+  using StringViewTypeAdapter = rclcpp::TypeAdapter<StringView, rclcpp::msg::String>;
+  static_assert(
+    rclcpp::detail::is_view_type_adapter<StringViewTypeAdapter>::value,
+    "StringView is expected to be a view of the ROS message");
+  static_assert(
+    !rclcpp::detail::is_view_type_adapter<
+      rclcpp::TypeAdapter<std::string, rclcpp::msg::String>>::value,
+    "std::string is expected to be a copy of the ROS message");
+  const std::string topic_name = "topic_name";
+
+  auto node = rclcpp::Node::make_shared(
+    "test_intra_process",
+    rclcpp::NodeOptions().use_intra_process_comms(true));
+
+  { // ROS message published to a subscription of the view
+    auto pub = node->create_publisher<rclcpp::msg::String>(topic_name, 1);
+    const char * received_data = nullptr;
+    auto callback =
+      [&received_data](const StringView & msg) -> void {
+        received_data = msg.data;
+      };
+    auto sub = node->create_subscription<StringViewTypeAdapter>(topic_name, 1, callback);
+    ASSERT_TRUE(wait_for_match(sub, pub));
+
+    auto msg = std::make_unique<rclcpp::msg::String>();
+    msg->data = "Message Data";
+    const char * published_data = msg->data.c_str();
+    pub->publish(std::move(msg));
+    bool is_received = false;
+    rclcpp::executors::SingleThreadedExecutor executor;
+    executor.add_node(node);
+    for (int i = 0; !is_received && i < g_max_loops; ++i) {
+      executor.spin_once(g_sleep_per_loop);
+      is_received = received_data != nullptr;
+    }
+    ASSERT_TRUE(is_received);
+    EXPECT_EQ(published_data, received_data);
+  }
+
+  { // View published to a subscription of the ROS message
+    auto pub = node->create_publisher<StringViewTypeAdapter>(topic_name, 1);
+    std::shared_ptr<const rclcpp::msg::String> received_message;
+    auto callback =
+      [&received_message](std::shared_ptr<const rclcpp::msg::String> msg) -> void {
+        received_message = msg;
+      };
+    auto sub = node->create_subscription<rclcpp::msg::String>(topic_name, 1, callback);
+    ASSERT_TRUE(wait_for_match(sub, pub));
+
+    auto ros_message = std::make_shared<rclcpp::msg::String>();
+    ros_message->data = "Message Data";
+    auto msg = std::make_unique<StringView>();
+    StringViewTypeAdapter::convert_to_custom(ros_message, *msg);
+    pub->publish(std::move(msg));
+    rclcpp::executors::SingleThreadedExecutor executor;
+    executor.add_node(node);
+    for (int i = 0; !received_message && i < g_max_loops; ++i) {
+      executor.spin_once(g_sleep_per_loop);
+    }
+    ASSERT_NE(nullptr, received_message);
+    EXPECT_EQ(ros_message.get(), received_message.get());
+  }
+}
@@ -0,0 +1,100 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include "rclcpp/thread.hpp"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+TEST(TestThread, default_constructed) {
+  rclcpp::Thread thread;
+  EXPECT_FALSE(thread.joinable());
+  EXPECT_THROW(thread.join(), std::system_error);
+}
+
+TEST(TestThread, run_and_join) {
+  std::atomic_bool executed {false};
+  rclcpp::Thread thread(rclcpp::ThreadAttributes(), [&executed]() {executed = true;});
+  EXPECT_TRUE(thread.joinable());
+  thread.join();
+  EXPECT_FALSE(thread.joinable());
+  EXPECT_TRUE(executed);
+}
+
+TEST(TestThread, move) {
+  std::atomic_int count {0};
+  rclcpp::Thread thread(rclcpp::ThreadAttributes(), [&count]() {count++;});
+  rclcpp::Thread other(std::move(thread));
+  EXPECT_FALSE(thread.joinable());
+  ASSERT_TRUE(other.joinable());
+  thread = std::move(other);
+  EXPECT_FALSE(other.joinable());
+  ASSERT_TRUE(thread.joinable());
+  thread.join();
+  EXPECT_EQ(1, count);
+}
+
+TEST(TestThread, invalid_priority) {
+  rclcpp::ThreadAttributes attributes;
+  attributes.scheduling_policy = rclcpp::ThreadSchedulingPolicy::Fifo;
+  attributes.priority = 1000;
+  EXPECT_THROW(rclcpp::Thread(attributes, []() {}), std::invalid_argument);
+}
+
+#if defined(__linux__)
+TEST(TestThread, attributes) {
+  rclcpp::ThreadAttributes attributes;
+  attributes.cpu_set = {0};
+  attributes.stack_size = 1024 * 1024;
+  attributes.name = "rclcpp_test_thread_with_long_name";
+
+  std::atomic_int cpu {-1};
+  std::string name;
+  size_t stack_size = 0;
+  rclcpp::Thread thread(
+    attributes, [&]() {
+      cpu = sched_getcpu();
+      char buffer[16] = {};
+      pthread_getname_np(pthread_self(), buffer, sizeof(buffer));
+      name = buffer;
+      pthread_attr_t attr;
+      if (pthread_getattr_np(pthread_self(), &attr) == 0) {
+        pthread_attr_getstacksize(&attr, &stack_size);
+        pthread_attr_destroy(&attr);
+      }
+    });
+  thread.join();
+
+  EXPECT_EQ(0, cpu);
+  // Linux truncates thread names to 15 characters
+  EXPECT_EQ("rclcpp_test_thr", name);
+  EXPECT_GE(stack_size, attributes.stack_size);
+}
+
+TEST(TestThread, invalid_cpu) {
+  rclcpp::ThreadAttributes attributes;
+  attributes.cpu_set = {CPU_SETSIZE};
+  EXPECT_THROW(rclcpp::Thread(attributes, []() {}), std::invalid_argument);
+}
+#endif
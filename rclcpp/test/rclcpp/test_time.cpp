@@ -95,6 +95,28 @@ TEST_F(TestTime, time_sources) {
   EXPECT_NE(0u, steady_now.nanosec);
 }
 
+TEST_F(TestTime, now_nanoseconds) {
+  // The time read directly is the time of the rcl clock
+  for (auto clock_type : {RCL_SYSTEM_TIME, RCL_STEADY_TIME, RCL_ROS_TIME}) {
+    rclcpp::Clock clock(clock_type);
+    rcl_time_point_value_t rcl_before = 0;
+    ASSERT_EQ(RCL_RET_OK, rcl_clock_get_now(clock.get_clock_handle(), &rcl_before));
+    const rcl_time_point_value_t nanoseconds = clock.now_nanoseconds();
+    const rclcpp::Time now = clock.now();
+    rcl_time_point_value_t rcl_after = 0;
+    ASSERT_EQ(RCL_RET_OK, rcl_clock_get_now(clock.get_clock_handle(), &rcl_after));
+    EXPECT_LE(rcl_before, nanoseconds);
+    EXPECT_LE(nanoseconds, now.nanoseconds());
+    EXPECT_LE(now.nanoseconds(), rcl_after);
+    EXPECT_EQ(clock_type, now.get_clock_type());
+  }
+
+  rclcpp::Clock ros_clock(RCL_ROS_TIME);
+  ASSERT_EQ(RCL_RET_OK, rcl_enable_ros_time_override(ros_clock.get_clock_handle()));
+  ASSERT_EQ(RCL_RET_OK, rcl_set_ros_time_override(ros_clock.get_clock_handle(), 42));
+  EXPECT_EQ(42, ros_clock.now_nanoseconds());
+}
+
 static const int64_t HALF_SEC_IN_NS = RCUTILS_MS_TO_NS(500);
 static const int64_t ONE_SEC_IN_NS = RCUTILS_MS_TO_NS(1000);
 static const int64_t ONE_AND_HALF_SEC_IN_NS = 3 * HALF_SEC_IN_NS;
@@ -15,10 +15,13 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <limits>
 #include <memory>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "rcl/error_handling.h"
 #include "rcl/time.h"
@@ -325,6 +328,48 @@ TEST_F(TestTimeSource, clock) {
   EXPECT_GT(t_high.nanoseconds(), t_out.nanoseconds());
 }
 
+TEST_F(TestTimeSource, shared_ros_time) {
+  rclcpp::TimeSource ts(node);
+  auto ros_clock = std::make_shared<rclcpp::Clock>(RCL_ROS_TIME);
+  auto timer_clock = std::make_shared<rclcpp::Clock>(RCL_ROS_TIME);
+  ts.attachClock(ros_clock);
+  ts.attachClock(timer_clock);
+  EXPECT_FALSE(ros_clock->is_using_shared_ros_time());
+
+  set_use_sim_time_parameter(node, rclcpp::ParameterValue(true), ros_clock);
+  EXPECT_TRUE(ros_clock->is_using_shared_ros_time());
+  EXPECT_TRUE(timer_clock->is_using_shared_ros_time());
+
+  // Using the rcl clock stops reading the shared time, the rcl clock is set to the last time
+  trigger_clock_changes(node, ros_clock);
+  rcl_clock_t * clock_handle = timer_clock->get_clock_handle();
+  EXPECT_FALSE(timer_clock->is_using_shared_ros_time());
+  EXPECT_TRUE(ros_clock->is_using_shared_ros_time());
+  rcl_time_point_value_t nanoseconds = 0;
+  ASSERT_EQ(RCL_RET_OK, rcl_clock_get_now(clock_handle, &nanoseconds));
+  EXPECT_EQ(ros_clock->now().nanoseconds(), nanoseconds);
+  EXPECT_EQ(ros_clock->now(), timer_clock->now());
+
+  // Both clocks keep being updated
+  auto clock_pub = node->create_publisher<rosgraph_msgs::msg::Clock>("clock", 10);
+  rosgraph_msgs::msg::Clock msg;
+  msg.clock.sec = 42;
+  clock_pub->publish(msg);
+  spin_until_time(ros_clock, node, 42s, true);
+  spin_until_time(timer_clock, node, 42s, true);
+  EXPECT_EQ(rclcpp::Time(42, 0, RCL_ROS_TIME), ros_clock->now());
+  EXPECT_EQ(rclcpp::Time(42, 0, RCL_ROS_TIME), timer_clock->now());
+
+  // A detached clock keeps the last time
+  ts.detachClock(ros_clock);
+  EXPECT_FALSE(ros_clock->is_using_shared_ros_time());
+  EXPECT_TRUE(ros_clock->ros_time_is_active());
+  EXPECT_EQ(rclcpp::Time(42, 0, RCL_ROS_TIME), ros_clock->now());
+
+  set_use_sim_time_parameter(node, rclcpp::ParameterValue(false), timer_clock);
+  EXPECT_FALSE(timer_clock->ros_time_is_active());
+}
+
 class CallbackObject
 {
 public:
@@ -532,6 +577,29 @@ TEST_F(TestTimeSource, parameter_activation) {
   EXPECT_TRUE(ros_clock->ros_time_is_active());
 }
 
+TEST_F(TestTimeSource, lightweight_node_parameter_activation) {
+  auto lightweight_node = std::make_shared<rclcpp::Node>(
+    "lightweight_node", rclcpp::NodeOptions().lightweight(true));
+  auto ros_clock = lightweight_node->get_clock();
+  EXPECT_FALSE(ros_clock->ros_time_is_active());
+
+  // The parameter is followed without a subscription to the parameter events
+  auto subscriptions = lightweight_node->get_subscriber_names_and_types_by_node(
+    "lightweight_node", "/");
+  EXPECT_EQ(0u, subscriptions.count("/parameter_events"));
+
+  ASSERT_TRUE(lightweight_node->set_parameter({"use_sim_time", true}).successful);
+  EXPECT_TRUE(ros_clock->ros_time_is_active());
+  ASSERT_TRUE(lightweight_node->set_parameter({"use_sim_time", false}).successful);
+  EXPECT_FALSE(ros_clock->ros_time_is_active());
+
+  rclcpp::TimeSource ts;
+  EXPECT_TRUE(ts.get_use_parameter_events());
+  ts.set_use_parameter_events(false);
+  ts.detachNode();
+  EXPECT_FALSE(ts.get_use_parameter_events());
+}
+
 TEST_F(TestTimeSource, no_pre_jump_callback) {
   CallbackObject cbo;
   rcl_jump_threshold_t jump_threshold;
@@ -822,3 +890,45 @@ TEST_F(TestTimeSource, clock_sleep_until_with_ros_time_basic) {
   auto until = now + rclcpp::Duration(0, 500);
   EXPECT_TRUE(clock->sleep_until(until));
 }
+
+TEST_F(TestTimeSource, clock_sleep_until_with_shared_ros_time) {
+  SimClockPublisherNode pub_node;
+  pub_node.SpinNode();
+
+  node->set_parameter({"use_sim_time", true});
+  auto clock = std::make_shared<rclcpp::Clock>(RCL_ROS_TIME);
+  rclcpp::TimeSource time_source(node);
+  time_source.attachClock(clock);
+  ASSERT_TRUE(clock->is_using_shared_ros_time());
+  ASSERT_TRUE(clock->wait_until_started());
+
+  // Each sleeping thread is only woken once its own deadline is reached
+  const auto start = clock->now();
+  std::atomic<size_t> woken{0};
+  std::vector<std::thread> sleepers;
+  for (int64_t i = 0; i < 8; ++i) {
+    sleepers.emplace_back(
+      [&clock, &woken, until = start + rclcpp::Duration(0, 1000000 * (i + 1))]() {
+        if (clock->sleep_until(until) && clock->now() >= until) {
+          ++woken;
+        }
+      });
+  }
+  for (auto & sleeper : sleepers) {
+    sleeper.join();
+  }
+  EXPECT_EQ(8u, woken.load());
+  EXPECT_TRUE(clock->is_using_shared_ros_time());
+
+  // Disabling ROS time wakes the sleeping threads, the time source changed
+  std::atomic<bool> slept{true};
+  std::thread sleeper(
+    [&clock, &slept, until = start + rclcpp::Duration(3600, 0)]() {
+      slept = clock->sleep_until(until);
+    });
+  std::this_thread::sleep_for(10ms);
+  node->set_parameter({"use_sim_time", false});
+  sleeper.join();
+  EXPECT_FALSE(slept.load());
+  EXPECT_FALSE(clock->ros_time_is_active());
+}
@@ -0,0 +1,124 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "rclcpp/executors/single_threaded_executor.hpp"
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp/timer_coalescer.hpp"
+
+using namespace std::chrono_literals;
+
+class TestTimerCoalescer : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    rclcpp::init(0, nullptr);
+    node = std::make_shared<rclcpp::Node>("test_timer_coalescer_node");
+    coalescer = node->get_node_timers_interface()->get_timer_coalescer();
+  }
+
+  void TearDown() override
+  {
+    coalescer.reset();
+    node.reset();
+    rclcpp::shutdown();
+  }
+
+  rclcpp::CoalescedTimer::SharedPtr
+  create_timer(std::chrono::nanoseconds period, std::function<void()> callback)
+  {
+    return rclcpp::create_coalesced_wall_timer(
+      period, 1ms, callback, nullptr,
+      node->get_node_base_interface().get(), node->get_node_timers_interface().get());
+  }
+
+  rclcpp::Node::SharedPtr node;
+  rclcpp::TimerCoalescer::SharedPtr coalescer;
+};
+
+TEST_F(TestTimerCoalescer, invalid_arguments) {
+  EXPECT_THROW(coalescer->add_timer(nullptr, 10ms, 1ms, []() {}), std::invalid_argument);
+  EXPECT_THROW(
+    coalescer->add_timer(coalescer->get_steady_clock(), 10ms, 1ms, nullptr),
+    std::invalid_argument);
+  EXPECT_THROW(
+    coalescer->add_timer(coalescer->get_steady_clock(), 10ms, -1ms, []() {}),
+    std::invalid_argument);
+  EXPECT_THROW(create_timer(-10ms, []() {}), std::invalid_argument);
+  EXPECT_EQ(0u, coalescer->get_number_of_shared_timers());
+}
+
+TEST_F(TestTimerCoalescer, shared_timers) {
+  std::vector<size_t> counts(4, 0);
+  auto timer1 = create_timer(10ms, [&counts]() {counts[0]++;});
+  auto timer2 = create_timer(10ms, [&counts]() {counts[1]++;});
+  // Within the tolerance, uses the period of the shared timer
+  auto timer3 = create_timer(10ms + 500us, [&counts]() {counts[2]++;});
+  EXPECT_EQ(10ms, timer3->get_period());
+  EXPECT_EQ(1u, coalescer->get_number_of_shared_timers());
+  EXPECT_EQ(3u, coalescer->get_number_of_coalesced_timers());
+
+  // Beyond the tolerance, or in another callback group or clock
+  auto timer4 = create_timer(20ms, [&counts]() {counts[3]++;});
+  auto group = node->create_callback_group(rclcpp::CallbackGroupType::MutuallyExclusive);
+  auto timer5 = rclcpp::create_coalesced_wall_timer(
+    10ms, 1ms, []() {}, group,
+    node->get_node_base_interface().get(), node->get_node_timers_interface().get());
+  auto timer6 = coalescer->add_timer(node->get_clock(), 10ms, 1ms, []() {});
+  EXPECT_EQ(4u, coalescer->get_number_of_shared_timers());
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  const auto end = std::chrono::steady_clock::now() + 10s;
+  while (counts[3] < 2 && std::chrono::steady_clock::now() < end) {
+    executor.spin_once(10ms);
+  }
+  EXPECT_GE(counts[3], 2u);
+  EXPECT_GE(counts[0], 2u);
+  // The callbacks of a shared timer are called in turn
+  EXPECT_EQ(counts[0], counts[1]);
+  EXPECT_EQ(counts[0], counts[2]);
+}
+
+TEST_F(TestTimerCoalescer, cancel) {
+  size_t count = 0;
+  rclcpp::CoalescedTimer::SharedPtr timer1;
+  rclcpp::CoalescedTimer::SharedPtr timer2;
+  rclcpp::executors::SingleThreadedExecutor executor;
+  // Canceling a timer from the callback of an earlier one of the same shared timer
+  timer1 = create_timer(
+    10ms, [&]() {
+      count++;
+      timer2->cancel();
+      executor.cancel();
+    });
+  timer2 = create_timer(10ms, [&count]() {count++;});
+  executor.add_node(node);
+  executor.spin();
+  EXPECT_EQ(1u, count);
+  EXPECT_TRUE(timer2->is_canceled());
+  EXPECT_EQ(1u, coalescer->get_number_of_coalesced_timers());
+
+  // The shared timer is removed with its last coalesced timer
+  timer1.reset();
+  EXPECT_EQ(0u, coalescer->get_number_of_shared_timers());
+  EXPECT_EQ(0u, coalescer->get_number_of_coalesced_timers());
+}
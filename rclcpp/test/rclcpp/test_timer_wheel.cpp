@@ -0,0 +1,154 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "rclcpp/timer_wheel.hpp"
+
+using namespace std::chrono_literals;
+using rclcpp::TimerWheel;
+
+class TestTimerWheel : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    // In the future, so that the actual time is never ahead of the advanced time
+    start_ = std::chrono::steady_clock::now() + 24h;
+    wheel_ = std::make_shared<TimerWheel>(1ms, start_);
+    now_ = start_;
+  }
+
+  /// Advance the wheel by the given duration, one tick at a time.
+  size_t advance_by(std::chrono::nanoseconds duration)
+  {
+    size_t called = 0;
+    const auto end = now_ + duration;
+    while (now_ < end) {
+      now_ += 1ms;
+      called += wheel_->advance(now_);
+    }
+    return called;
+  }
+
+  std::chrono::steady_clock::time_point start_;
+  std::chrono::steady_clock::time_point now_;
+  TimerWheel::SharedPtr wheel_;
+};
+
+TEST_F(TestTimerWheel, invalid_arguments) {
+  EXPECT_THROW(TimerWheel(0ms), std::invalid_argument);
+  EXPECT_THROW(wheel_->add_timer(-1ms, []() {}), std::invalid_argument);
+  EXPECT_THROW(wheel_->add_timer(1ms, nullptr), std::invalid_argument);
+}
+
+TEST_F(TestTimerWheel, periodic_timers) {
+  std::vector<size_t> counts(3, 0);
+  wheel_->add_timer(10ms, [&counts]() {counts[0]++;});
+  wheel_->add_timer(300ms, [&counts]() {counts[1]++;});
+  // Beyond the range of the first two levels
+  wheel_->add_timer(70s, [&counts]() {counts[2]++;});
+  EXPECT_EQ(3u, wheel_->size());
+
+  advance_by(1s);
+  EXPECT_EQ(100u, counts[0]);
+  EXPECT_EQ(3u, counts[1]);
+  EXPECT_EQ(0u, counts[2]);
+
+  // The remaining time is advanced at once: each timer is called once per advance
+  now_ += 69s;
+  wheel_->advance(now_);
+  EXPECT_EQ(101u, counts[0]);
+  EXPECT_EQ(4u, counts[1]);
+  EXPECT_EQ(1u, counts[2]);
+}
+
+TEST_F(TestTimerWheel, cancel_and_reset) {
+  size_t count = 0;
+  auto timer_id = wheel_->add_timer(10ms, [&count]() {count++;});
+  advance_by(25ms);
+  EXPECT_EQ(2u, count);
+
+  // A watchdog fed more often than its period never expires
+  for (size_t i = 0; i < 10; ++i) {
+    EXPECT_TRUE(wheel_->reset(timer_id));
+    advance_by(5ms);
+  }
+  EXPECT_EQ(2u, count);
+
+  EXPECT_TRUE(wheel_->cancel(timer_id));
+  EXPECT_FALSE(wheel_->cancel(timer_id));
+  EXPECT_FALSE(wheel_->reset(timer_id));
+  EXPECT_EQ(0u, wheel_->size());
+  advance_by(50ms);
+  EXPECT_EQ(2u, count);
+
+  // The identifiers of canceled timers are not reused
+  auto other_id = wheel_->add_timer(10ms, []() {});
+  EXPECT_NE(timer_id, other_id);
+  EXPECT_FALSE(wheel_->cancel(timer_id));
+}
+
+TEST_F(TestTimerWheel, cancel_from_callback) {
+  // The timers expire at the same time, the first one called cancels the other one
+  size_t count = 0;
+  TimerWheel::TimerId first_id = 0;
+  TimerWheel::TimerId second_id = 0;
+  first_id = wheel_->add_timer(
+    10ms, [this, &second_id, &count]() {
+      count++;
+      wheel_->cancel(second_id);
+    });
+  second_id = wheel_->add_timer(
+    10ms, [this, &first_id, &count]() {
+      count++;
+      wheel_->cancel(first_id);
+    });
+  advance_by(10ms);
+  EXPECT_EQ(1u, count);
+  EXPECT_EQ(1u, wheel_->size());
+
+  // Timers can be added from callbacks
+  wheel_->add_timer(10ms, [this]() {wheel_->add_timer(10ms, []() {});});
+  advance_by(10ms);
+  EXPECT_EQ(3u, wheel_->size());
+}
+
+TEST_F(TestTimerWheel, many_timers) {
+  size_t count = 0;
+  std::vector<TimerWheel::TimerId> timer_ids;
+  for (size_t i = 0; i < 5000; ++i) {
+    timer_ids.push_back(
+      wheel_->add_timer(std::chrono::milliseconds(100 + i % 100), [&count]() {count++;}));
+  }
+  advance_by(199ms);
+  EXPECT_EQ(5000u, count);
+  for (size_t i = 0; i < timer_ids.size(); i += 2) {
+    EXPECT_TRUE(wheel_->cancel(timer_ids[i]));
+  }
+  EXPECT_EQ(2500u, wheel_->size());
+  size_t expected_count = 0;
+  for (size_t i = 1; i < timer_ids.size(); i += 2) {
+    const size_t period = 100 + i % 100;
+    expected_count += 399 / period - 199 / period;
+  }
+  count = 0;
+  advance_by(200ms);
+  EXPECT_EQ(expected_count, count);
+}
@@ -0,0 +1,276 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+#include "rclcpp/contexts/default_context.hpp"
+#include "rclcpp/experimental/timers_manager.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+using namespace std::chrono_literals;
+
+using rclcpp::experimental::TimersManager;
+
+using CallbackT = std::function<void ()>;
+using TimerT = rclcpp::WallTimer<CallbackT>;
+
+class TestTimersManager : public ::testing::Test
+{
+public:
+  void SetUp()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  void TearDown()
+  {
+    rclcpp::shutdown();
+  }
+};
+
+static void execute_all_ready_timers(std::shared_ptr<TimersManager> timers_manager)
+{
+  bool head_was_ready = false;
+  do {
+    head_was_ready = timers_manager->execute_head_timer();
+  } while (head_was_ready);
+}
+
+TEST_F(TestTimersManager, empty_manager)
+{
+  auto timers_manager = std::make_shared<TimersManager>(
+    rclcpp::contexts::get_global_default_context());
+
+  EXPECT_EQ(TimersManager::MAX_TIME, timers_manager->get_head_timeout());
+  EXPECT_FALSE(timers_manager->execute_head_timer());
+  EXPECT_EQ(0u, timers_manager->execute_ready_timers());
+  EXPECT_EQ(0u, timers_manager->get_number_ready_timers());
+  EXPECT_NO_THROW(timers_manager->clear());
+  EXPECT_NO_THROW(timers_manager->start());
+  EXPECT_NO_THROW(timers_manager->stop());
+}
+
+TEST_F(TestTimersManager, add_run_remove_timer)
+{
+  size_t t_runs = 0;
+  auto t = TimerT::make_shared(
+    1ms,
+    [&t_runs]() {
+      t_runs++;
+    },
+    rclcpp::contexts::get_global_default_context());
+  std::weak_ptr<TimerT> t_weak = t;
+
+  // Add the timer to the timers manager
+  auto timers_manager = std::make_shared<TimersManager>(
+    rclcpp::contexts::get_global_default_context());
+  timers_manager->add_timer(t);
+
+  // Sleep for more 3 times the timer period
+  std::this_thread::sleep_for(3ms);
+
+  // The timer is executed only once, even if we slept 3 times the period
+  execute_all_ready_timers(timers_manager);
+  EXPECT_EQ(1u, t_runs);
+
+  // Remove the timer from the manager
+  timers_manager->remove_timer(t);
+
+  t.reset();
+  // The timer is now not valid anymore
+  EXPECT_FALSE(t_weak.lock() != nullptr);
+}
+
+TEST_F(TestTimersManager, add_timer_twice)
+{
+  auto timers_manager = std::make_shared<TimersManager>(
+    rclcpp::contexts::get_global_default_context());
+
+  auto t = TimerT::make_shared(
+    1ms,
+    []() {},
+    rclcpp::contexts::get_global_default_context());
+
+  timers_manager->add_timer(t);
+  EXPECT_NO_THROW(timers_manager->add_timer(t));
+
+  std::this_thread::sleep_for(2ms);
+  EXPECT_EQ(1u, timers_manager->get_number_ready_timers());
+}
+
+TEST_F(TestTimersManager, add_nullptr)
+{
+  auto timers_manager = std::make_shared<TimersManager>(
+    rclcpp::contexts::get_global_default_context());
+
+  EXPECT_THROW(timers_manager->add_timer(nullptr), std::exception);
+}
+
+TEST_F(TestTimersManager, head_timer_ordering)
+{
+  auto timers_manager = std::make_shared<TimersManager>(
+    rclcpp::contexts::get_global_default_context());
+
+  size_t t1_runs = 0;
+  auto t1 = TimerT::make_shared(
+    1ms, [&t1_runs]() {t1_runs++;}, rclcpp::contexts::get_global_default_context());
+  size_t t2_runs = 0;
+  auto t2 = TimerT::make_shared(
+    1s, [&t2_runs]() {t2_runs++;}, rclcpp::contexts::get_global_default_context());
+
+  timers_manager->add_timer(t2);
+  timers_manager->add_timer(t1);
+
+  // The head timeout is the one of the fastest timer
+  EXPECT_GE(1ms, timers_manager->get_head_timeout());
+
+  std::this_thread::sleep_for(2ms);
+  EXPECT_EQ(1u, timers_manager->execute_ready_timers());
+  EXPECT_EQ(1u, t1_runs);
+  EXPECT_EQ(0u, t2_runs);
+}
+
+TEST_F(TestTimersManager, canceled_timers_are_not_head)
+{
+  auto timers_manager = std::make_shared<TimersManager>(
+    rclcpp::contexts::get_global_default_context());
+
+  auto t = TimerT::make_shared(
+    1ms, []() {}, rclcpp::contexts::get_global_default_context());
+  timers_manager->add_timer(t);
+  t->cancel();
+
+  EXPECT_EQ(TimersManager::MAX_TIME, timers_manager->get_head_timeout());
+  std::this_thread::sleep_for(2ms);
+  EXPECT_FALSE(timers_manager->execute_head_timer());
+}
+
+TEST_F(TestTimersManager, timers_thread)
+{
+  auto timers_manager = std::make_shared<TimersManager>(
+    rclcpp::contexts::get_global_default_context());
+
+  std::atomic<size_t> t1_runs {0};
+  auto t1 = TimerT::make_shared(
+    1ms, [&t1_runs]() {t1_runs++;}, rclcpp::contexts::get_global_default_context());
+  std::atomic<size_t> t2_runs {0};
+  auto t2 = TimerT::make_shared(
+    1ms, [&t2_runs]() {t2_runs++;}, rclcpp::contexts::get_global_default_context());
+
+  timers_manager->add_timer(t1);
+  timers_manager->add_timer(t2);
+
+  // Run timers thread for a while
+  timers_manager->start();
+  std::this_thread::sleep_for(50ms);
+  timers_manager->stop();
+
+  EXPECT_LT(1u, t1_runs.load());
+  EXPECT_LT(1u, t2_runs.load());
+}
+
+TEST_F(TestTimersManager, check_one_timer_cancel_doesnt_affect_other_timers)
+{
+  auto timers_manager = std::make_shared<TimersManager>(
+    rclcpp::contexts::get_global_default_context());
+
+  std::atomic<size_t> t1_runs {0};
+  std::shared_ptr<TimerT> t1;
+  // After a while cancel t1. Don't remove it though.
+  // Simulates typical usage in a Node where a timer is cancelled but not removed,
+  // since typical users aren't going to mess around with the timer manager.
+  t1 = TimerT::make_shared(
+    1ms,
+    [&t1_runs, &t1]() {
+      t1_runs++;
+      if (t1_runs == 5) {
+        t1->cancel();
+      }
+    },
+    rclcpp::contexts::get_global_default_context());
+
+  std::atomic<size_t> t2_runs {0};
+  auto t2 = TimerT::make_shared(
+    1ms, [&t2_runs]() {t2_runs++;}, rclcpp::contexts::get_global_default_context());
+
+  timers_manager->add_timer(t1);
+  timers_manager->add_timer(t2);
+
+  // Start timers thread
+  timers_manager->start();
+
+  // Wait for t1 to be canceled
+  auto start = std::chrono::steady_clock::now();
+  while (!t1->is_canceled() && (std::chrono::steady_clock::now() - start < 1s)) {
+    std::this_thread::sleep_for(2ms);
+  }
+  ASSERT_TRUE(t1->is_canceled());
+
+  size_t t2_runs_at_cancel = t2_runs;
+  std::this_thread::sleep_for(20ms);
+  timers_manager->stop();
+
+  EXPECT_EQ(5u, t1_runs.load());
+  EXPECT_LT(t2_runs_at_cancel, t2_runs.load());
+}
+
+TEST_F(TestTimersManager, on_ready_callback)
+{
+  std::atomic<size_t> ready_count {0};
+  const rclcpp::TimerBase * ready_timer = nullptr;
+  auto timers_manager = std::make_shared<TimersManager>(
+    rclcpp::contexts::get_global_default_context(),
+    [&ready_count, &ready_timer](const rclcpp::TimerBase * timer_id) {
+      ready_timer = timer_id;
+      ready_count++;
+    });
+
+  size_t t_runs = 0;
+  auto t = TimerT::make_shared(
+    1ms, [&t_runs]() {t_runs++;}, rclcpp::contexts::get_global_default_context());
+  timers_manager->add_timer(t);
+
+  timers_manager->start();
+  auto start = std::chrono::steady_clock::now();
+  while (ready_count == 0u && (std::chrono::steady_clock::now() - start < 1s)) {
+    std::this_thread::sleep_for(1ms);
+  }
+  timers_manager->stop();
+
+  // The callback notifies the timer instead of executing it
+  ASSERT_LT(0u, ready_count.load());
+  EXPECT_EQ(t.get(), ready_timer);
+  EXPECT_EQ(0u, t_runs);
+
+  timers_manager->execute_ready_timer(ready_timer);
+  EXPECT_EQ(1u, t_runs);
+}
+
+TEST_F(TestTimersManager, start_twice)
+{
+  auto timers_manager = std::make_shared<TimersManager>(
+    rclcpp::contexts::get_global_default_context());
+
+  timers_manager->start();
+  EXPECT_THROW(timers_manager->start(), std::exception);
+  EXPECT_THROW(timers_manager->execute_head_timer(), std::exception);
+  timers_manager->stop();
+  EXPECT_NO_THROW(timers_manager->stop());
+}
@@ -14,6 +14,7 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <vector>
@@ -142,6 +143,30 @@ TEST(TestUtilities, test_pre_shutdown_callback_add_remove) {
   EXPECT_TRUE(is_called2);
 }
 
+TEST(TestUtilities, test_context_worker_pool) {
+  auto context = std::make_shared<rclcpp::contexts::DefaultContext>();
+  EXPECT_EQ(nullptr, context->get_worker_pool());
+
+  rclcpp::InitOptions init_options;
+  init_options.worker_pool.number_of_threads = 2;
+  context->init(0, nullptr, init_options);
+  auto worker_pool = context->get_worker_pool();
+  ASSERT_NE(nullptr, worker_pool);
+  EXPECT_EQ(2u, worker_pool->get_number_of_threads());
+  // The pool is shared by all the users of the context
+  EXPECT_EQ(worker_pool, context->get_worker_pool());
+
+  std::atomic<size_t> count{0};
+  for (size_t i = 0; i < 100; ++i) {
+    worker_pool->post([&count]() {count++;});
+  }
+  worker_pool.reset();
+  // The queued jobs are run before the pool is released by the shutdown
+  rclcpp::shutdown(context);
+  EXPECT_EQ(100u, count.load());
+  EXPECT_EQ(nullptr, context->get_worker_pool());
+}
+
 TEST(TestUtilities, test_context_basic_access) {
   auto context1 = std::make_shared<rclcpp::contexts::DefaultContext>();
   EXPECT_NE(nullptr, context1->get_init_options().get_rcl_init_options());
@@ -359,3 +359,59 @@ TEST_F(TestWaitSet, get_result_from_wait_result_not_ready_error) {
     const_result.get_wait_set(),
     std::runtime_error("cannot access wait set when the result was not ready"));
 }
+
+/*
+ * Iterate over the ready entities only.
+ */
+TEST_F(TestWaitSet, get_ready_entities_from_wait_result) {
+  auto node = std::make_shared<rclcpp::Node>("get_ready_entities_from_wait_result");
+  auto publisher = node->create_publisher<test_msgs::msg::BasicTypes>("~/test", 1);
+  auto subscription = node->create_subscription<test_msgs::msg::BasicTypes>(
+    "~/test", 1, [](std::shared_ptr<const test_msgs::msg::BasicTypes>) {});
+  auto other_subscription = node->create_subscription<test_msgs::msg::BasicTypes>(
+    "~/other", 1, [](std::shared_ptr<const test_msgs::msg::BasicTypes>) {});
+  auto guard_condition = std::make_shared<rclcpp::GuardCondition>();
+  auto other_guard_condition = std::make_shared<rclcpp::GuardCondition>();
+
+  // The thread-safe wait set has an extra guard condition, which is never reported as ready
+  rclcpp::ThreadSafeWaitSet wait_set;
+  wait_set.add_subscription(other_subscription);
+  wait_set.add_subscription(subscription);
+  wait_set.add_guard_condition(other_guard_condition);
+  wait_set.add_guard_condition(guard_condition);
+  guard_condition->trigger();
+  publisher->publish(test_msgs::msg::BasicTypes());
+
+  size_t number_of_ready_subscriptions = 0;
+  while (number_of_ready_subscriptions == 0) {
+    auto result = wait_set.wait(std::chrono::seconds(1));
+    ASSERT_EQ(rclcpp::WaitResultKind::Ready, result.kind());
+    const rclcpp::ReadyEntities & ready_entities = result.get_ready_entities();
+    EXPECT_EQ(&ready_entities, &result.get_ready_entities());
+    number_of_ready_subscriptions = ready_entities.subscriptions.size();
+    if (number_of_ready_subscriptions > 0) {
+      ASSERT_EQ(1u, ready_entities.subscriptions.size());
+      EXPECT_EQ(subscription, ready_entities.subscriptions[0]);
+    }
+    for (const auto & ready_guard_condition : ready_entities.guard_conditions) {
+      EXPECT_EQ(guard_condition, ready_guard_condition);
+    }
+    EXPECT_TRUE(ready_entities.timers.empty());
+    EXPECT_TRUE(ready_entities.waitables.empty());
+  }
+
+  {
+    // The message which wasn't taken is still ready
+    auto result = wait_set.wait(std::chrono::milliseconds(10));
+    ASSERT_EQ(rclcpp::WaitResultKind::Ready, result.kind());
+    EXPECT_EQ(1u, result.get_ready_entities().subscriptions.size());
+    EXPECT_TRUE(result.get_ready_entities().guard_conditions.empty());
+  }
+  test_msgs::msg::BasicTypes message;
+  rclcpp::MessageInfo message_info;
+  EXPECT_TRUE(subscription->take(message, message_info));
+
+  auto timeout_result = wait_set.wait(std::chrono::milliseconds(10));
+  ASSERT_EQ(rclcpp::WaitResultKind::Timeout, timeout_result.kind());
+  EXPECT_TRUE(timeout_result.get_ready_entities().empty());
+}
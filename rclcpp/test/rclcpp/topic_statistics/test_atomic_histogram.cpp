@@ -0,0 +1,114 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/topic_statistics/atomic_histogram.hpp"
+
+using rclcpp::topic_statistics::AtomicHistogram;
+
+TEST(TestAtomicHistogram, empty) {
+  AtomicHistogram histogram;
+  EXPECT_EQ(
+    (AtomicHistogram::kDefaultMaxValueBits - AtomicHistogram::kDefaultSubBucketBits + 1u) * 32u,
+    histogram.get_bucket_count());
+  const auto snapshot = histogram.take_snapshot();
+  EXPECT_EQ(0u, snapshot.get_count());
+  EXPECT_EQ(0u, snapshot.get_value_at_percentile(99.0));
+}
+
+TEST(TestAtomicHistogram, percentiles_and_reset) {
+  AtomicHistogram histogram;
+  for (uint64_t value = 1; value <= 100; ++value) {
+    histogram.add_sample(value);
+  }
+  // Reading the window doesn't reset it
+  EXPECT_EQ(100u, histogram.get_snapshot().get_count());
+  EXPECT_EQ(50u, histogram.get_snapshot().get_value_at_percentile(50.0));
+  auto snapshot = histogram.take_snapshot();
+  EXPECT_EQ(100u, snapshot.get_count());
+  // The values below 64 are recorded exactly, the next ones in buckets of 2
+  EXPECT_EQ(1u, snapshot.get_value_at_percentile(1.0));
+  EXPECT_EQ(25u, snapshot.get_value_at_percentile(25.0));
+  EXPECT_EQ(50u, snapshot.get_value_at_percentile(50.0));
+  EXPECT_EQ(99u, snapshot.get_value_at_percentile(99.0));
+  EXPECT_EQ(101u, snapshot.get_value_at_percentile(100.0));
+
+  EXPECT_THROW(snapshot.get_value_at_percentile(0.0), std::invalid_argument);
+  EXPECT_THROW(snapshot.get_value_at_percentile(100.1), std::invalid_argument);
+
+  // A new window starts
+  EXPECT_EQ(0u, histogram.take_snapshot().get_count());
+  histogram.add_sample(7);
+  snapshot = histogram.take_snapshot();
+  EXPECT_EQ(1u, snapshot.get_count());
+  EXPECT_EQ(7u, snapshot.get_value_at_percentile(50.0));
+}
+
+TEST(TestAtomicHistogram, relative_error) {
+  AtomicHistogram histogram;
+  std::mt19937_64 generator(42);
+  std::uniform_int_distribution<uint64_t> distribution(1, 1000000000);
+  for (int i = 0; i < 1000; ++i) {
+    const uint64_t value = distribution(generator);
+    histogram.add_sample(value);
+    auto snapshot = histogram.take_snapshot();
+    const uint64_t recorded = snapshot.get_value_at_percentile(100.0);
+    EXPECT_GE(recorded, value);
+    EXPECT_LE(static_cast<double>(recorded - value), static_cast<double>(value) / 32.0);
+  }
+}
+
+TEST(TestAtomicHistogram, saturation) {
+  AtomicHistogram histogram(2, 8);
+  EXPECT_EQ(28u, histogram.get_bucket_count());
+  histogram.add_sample(0);
+  histogram.add_sample(UINT64_MAX);
+  auto snapshot = histogram.take_snapshot();
+  EXPECT_EQ(0u, snapshot.get_value_at_percentile(50.0));
+  EXPECT_EQ(255u, snapshot.get_value_at_percentile(100.0));
+
+  AtomicHistogram full_range(AtomicHistogram::kDefaultSubBucketBits, 64);
+  full_range.add_sample(UINT64_MAX);
+  EXPECT_EQ(UINT64_MAX, full_range.take_snapshot().get_value_at_percentile(100.0));
+
+  EXPECT_THROW(AtomicHistogram(0, 8), std::invalid_argument);
+  EXPECT_THROW(AtomicHistogram(17, 32), std::invalid_argument);
+  EXPECT_THROW(AtomicHistogram(8, 8), std::invalid_argument);
+  EXPECT_THROW(AtomicHistogram(8, 65), std::invalid_argument);
+}
+
+TEST(TestAtomicHistogram, concurrent_samples) {
+  AtomicHistogram histogram;
+  std::vector<std::thread> threads;
+  for (uint64_t i = 0; i < 4; ++i) {
+    threads.emplace_back(
+      [&histogram, i]() {
+        for (uint64_t value = 0; value < 10000; ++value) {
+          histogram.add_sample(value * (i + 1));
+        }
+      });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(40000u, histogram.take_snapshot().get_count());
+}
@@ -0,0 +1,83 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/topic_statistics/atomic_statistics_accumulator.hpp"
+
+using rclcpp::topic_statistics::AtomicStatisticsAccumulator;
+
+TEST(TestAtomicStatisticsAccumulator, empty) {
+  AtomicStatisticsAccumulator accumulator;
+  const auto data = accumulator.get_statistics();
+  EXPECT_EQ(0u, data.sample_count);
+  EXPECT_TRUE(std::isnan(data.average));
+  EXPECT_TRUE(std::isnan(data.min));
+  EXPECT_TRUE(std::isnan(data.max));
+  EXPECT_TRUE(std::isnan(data.standard_deviation));
+}
+
+TEST(TestAtomicStatisticsAccumulator, statistics_and_reset) {
+  AtomicStatisticsAccumulator accumulator;
+  for (double sample : {2.0, 4.0, 4.0, 4.0, 5.0, 5.0, 7.0, 9.0}) {
+    accumulator.add_sample(sample);
+  }
+  auto data = accumulator.get_statistics();
+  EXPECT_EQ(8u, data.sample_count);
+  EXPECT_DOUBLE_EQ(5.0, data.average);
+  EXPECT_DOUBLE_EQ(2.0, data.min);
+  EXPECT_DOUBLE_EQ(9.0, data.max);
+  EXPECT_DOUBLE_EQ(2.0, data.standard_deviation);
+
+  data = accumulator.take_statistics();
+  EXPECT_EQ(8u, data.sample_count);
+  EXPECT_DOUBLE_EQ(5.0, data.average);
+
+  // A new window starts
+  EXPECT_EQ(0u, accumulator.get_statistics().sample_count);
+  accumulator.add_sample(-1.0);
+  data = accumulator.take_statistics();
+  EXPECT_EQ(1u, data.sample_count);
+  EXPECT_DOUBLE_EQ(-1.0, data.min);
+  EXPECT_DOUBLE_EQ(-1.0, data.max);
+  EXPECT_DOUBLE_EQ(0.0, data.standard_deviation);
+}
+
+TEST(TestAtomicStatisticsAccumulator, concurrent_samples) {
+  AtomicStatisticsAccumulator accumulator;
+  constexpr size_t kThreads = 4;
+  constexpr size_t kSamplesPerThread = 10000;
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < kThreads; ++i) {
+    threads.emplace_back(
+      [&accumulator, i]() {
+        for (size_t j = 0; j < kSamplesPerThread; ++j) {
+          accumulator.add_sample(static_cast<double>(i + 1));
+        }
+      });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  const auto data = accumulator.take_statistics();
+  EXPECT_EQ(kThreads * kSamplesPerThread, data.sample_count);
+  EXPECT_DOUBLE_EQ(2.5, data.average);
+  EXPECT_DOUBLE_EQ(1.0, data.min);
+  EXPECT_DOUBLE_EQ(4.0, data.max);
+}
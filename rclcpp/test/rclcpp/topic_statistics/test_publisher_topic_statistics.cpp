@@ -0,0 +1,274 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "libstatistics_collector/moving_average_statistics/types.hpp"
+
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp/topic_statistics/publisher_topic_statistics.hpp"
+
+#include "statistics_msgs/msg/metrics_message.hpp"
+#include "statistics_msgs/msg/statistic_data_type.hpp"
+
+#include "test_msgs/msg/empty.hpp"
+
+#include "test_topic_stats_utils.hpp"
+
+namespace
+{
+constexpr const char kTestPubStatsTopic[]{"/test_pub_stats_topic"};
+constexpr const char kTestTopicStatisticsTopic[]{"/test_pub_topic_statistics_topic"};
+constexpr const uint64_t kNoSamples{0};
+constexpr const std::chrono::seconds kTestTimeout{10};
+constexpr const uint64_t kNumPublishedMessages{5};
+constexpr const uint64_t kNumMetricsPerWindow{5};
+}  // namespace
+
+using libstatistics_collector::moving_average_statistics::StatisticData;
+using rclcpp::topic_statistics::PublisherTopicStatistics;
+using statistics_msgs::msg::MetricsMessage;
+using statistics_msgs::msg::StatisticDataType;
+using test_msgs::msg::Empty;
+
+/**
+ * Wrapper class to test and expose parts of the PublisherTopicStatistics class.
+ */
+class TestPublisherTopicStatistics : public PublisherTopicStatistics
+{
+public:
+  using PublisherTopicStatistics::PublisherTopicStatistics;
+
+  /// Exposed for testing
+  std::vector<StatisticData> get_current_collector_data() const
+  {
+    return PublisherTopicStatistics::get_current_collector_data();
+  }
+
+  /// Exposed for testing
+  std::pair<uint64_t, uint64_t> get_current_published_message_counts() const
+  {
+    return PublisherTopicStatistics::get_current_published_message_counts();
+  }
+};
+
+/**
+ * Test fixture to bring up and teardown rclcpp
+ */
+class TestPublisherTopicStatisticsFixture : public ::testing::Test
+{
+protected:
+  void SetUp()
+  {
+    rclcpp::init(0 /* argc */, nullptr /* argv */);
+    node_ = std::make_shared<rclcpp::Node>("test_pub_stats_node");
+  }
+
+  void TearDown()
+  {
+    node_.reset();
+    rclcpp::shutdown();
+  }
+
+  rclcpp::Node::SharedPtr node_;
+};
+
+/**
+ * Return the value of a statistic of a statistics message, NaN if missing.
+ */
+double get_statistic(const MetricsMessage & message, uint8_t type)
+{
+  for (const auto & stats_point : message.statistics) {
+    if (stats_point.data_type == type) {
+      return stats_point.data;
+    }
+  }
+  return std::nan("");
+}
+
+TEST_F(TestPublisherTopicStatisticsFixture, test_invalid_publish_period)
+{
+  auto options = rclcpp::PublisherOptions();
+  options.topic_stats_options.state = rclcpp::TopicStatisticsState::Enable;
+  options.topic_stats_options.publish_period = std::chrono::milliseconds(0);
+
+  ASSERT_THROW(
+    node_->create_publisher<Empty>("should_throw_invalid_arg", 10, options),
+    std::invalid_argument);
+}
+
+TEST_F(TestPublisherTopicStatisticsFixture, test_disabled_by_default)
+{
+  auto publisher = node_->create_publisher<Empty>(kTestPubStatsTopic, 10);
+  EXPECT_EQ(nullptr, publisher->get_topic_statistics());
+
+  auto options = rclcpp::PublisherOptions();
+  options.topic_stats_options.state = rclcpp::TopicStatisticsState::Enable;
+  publisher = node_->create_publisher<Empty>(kTestPubStatsTopic, 10, options);
+  EXPECT_NE(nullptr, publisher->get_topic_statistics());
+}
+
+TEST_F(TestPublisherTopicStatisticsFixture, test_manual_construction)
+{
+  EXPECT_THROW(TestPublisherTopicStatistics(node_->get_name(), nullptr), std::invalid_argument);
+
+  auto topic_stats = std::make_unique<TestPublisherTopicStatistics>(
+    node_->get_name(),
+    node_->create_publisher<MetricsMessage>(kTestTopicStatisticsTopic, 10));
+
+  // Expect no data has been collected / no samples received
+  for (const auto & data : topic_stats->get_current_collector_data()) {
+    EXPECT_TRUE(std::isnan(data.average));
+    EXPECT_EQ(kNoSamples, data.sample_count);
+  }
+
+  {
+    PublisherTopicStatistics::Scope scope(topic_stats.get());
+    // The nested publish calls aren't measured
+    PublisherTopicStatistics::Scope nested_scope(topic_stats.get());
+    topic_stats->on_serialized_publish(100);
+    topic_stats->on_inter_process_publish();
+  }
+  {
+    PublisherTopicStatistics::Scope scope(topic_stats.get());
+    topic_stats->on_serialized_publish(300);
+    topic_stats->on_intra_process_publish();
+    topic_stats->on_inter_process_publish();
+  }
+  {
+    // Nothing to measure
+    PublisherTopicStatistics::Scope scope(nullptr);
+  }
+
+  const auto data = topic_stats->get_current_collector_data();
+  ASSERT_EQ(3u, data.size());
+  // The period is measured from the second call
+  EXPECT_EQ(1u, data[0].sample_count);
+  EXPECT_LE(0.0, data[0].min);
+  EXPECT_EQ(2u, data[1].sample_count);
+  EXPECT_LE(0.0, data[1].min);
+  EXPECT_EQ(2u, data[2].sample_count);
+  EXPECT_DOUBLE_EQ(200.0, data[2].average);
+  EXPECT_DOUBLE_EQ(100.0, data[2].min);
+  EXPECT_DOUBLE_EQ(300.0, data[2].max);
+  EXPECT_EQ(
+    (std::pair<uint64_t, uint64_t>(1, 2)),
+    topic_stats->get_current_published_message_counts());
+
+  // Publishing the statistics starts a new window
+  topic_stats->publish_message_and_reset_measurements();
+  for (const auto & window_data : topic_stats->get_current_collector_data()) {
+    EXPECT_EQ(kNoSamples, window_data.sample_count);
+  }
+  EXPECT_EQ(
+    (std::pair<uint64_t, uint64_t>(0, 0)),
+    topic_stats->get_current_published_message_counts());
+}
+
+TEST_F(TestPublisherTopicStatisticsFixture, test_receive_stats_intra_process)
+{
+  auto statistics_listener = std::make_shared<rclcpp::topic_statistics::MetricsMessageSubscriber>(
+    "test_receive_publisher_stats_listener",
+    kTestTopicStatisticsTopic,
+    kNumMetricsPerWindow);
+
+  auto options = rclcpp::PublisherOptions();
+  options.use_intra_process_comm = rclcpp::IntraProcessSetting::Enable;
+  options.topic_stats_options.state = rclcpp::TopicStatisticsState::Enable;
+  options.topic_stats_options.publish_topic = kTestTopicStatisticsTopic;
+  options.topic_stats_options.publish_period = std::chrono::milliseconds(500);
+  auto publisher = node_->create_publisher<Empty>(kTestPubStatsTopic, 10, options);
+
+  auto subscription_options = rclcpp::SubscriptionOptions();
+  subscription_options.use_intra_process_comm = rclcpp::IntraProcessSetting::Enable;
+  auto subscription = node_->create_subscription<Empty>(
+    kTestPubStatsTopic, 10, [](Empty::UniquePtr) {}, subscription_options);
+
+  for (uint64_t i = 0; i < kNumPublishedMessages; ++i) {
+    publisher->publish(Empty());
+  }
+
+  rclcpp::executors::SingleThreadedExecutor ex;
+  ex.add_node(node_);
+  ex.add_node(statistics_listener);
+  ex.spin_until_future_complete(statistics_listener->GetFuture(), kTestTimeout);
+
+  std::map<std::string, MetricsMessage> first_messages;
+  for (const auto & msg : statistics_listener->GetReceivedMessages()) {
+    EXPECT_EQ(node_->get_name(), msg.measurement_source_name);
+    first_messages.emplace(msg.metrics_source, msg);
+  }
+  ASSERT_EQ(kNumMetricsPerWindow, first_messages.size());
+
+  const auto & period = first_messages.at(rclcpp::topic_statistics::kPublishPeriodName);
+  EXPECT_EQ("ms", period.unit);
+  EXPECT_DOUBLE_EQ(
+    static_cast<double>(kNumPublishedMessages - 1),
+    get_statistic(period, StatisticDataType::STATISTICS_DATA_TYPE_SAMPLE_COUNT));
+  const auto & duration = first_messages.at(rclcpp::topic_statistics::kPublishDurationName);
+  EXPECT_DOUBLE_EQ(
+    static_cast<double>(kNumPublishedMessages),
+    get_statistic(duration, StatisticDataType::STATISTICS_DATA_TYPE_SAMPLE_COUNT));
+  // Typed messages aren't serialized by rclcpp
+  const auto & size = first_messages.at(rclcpp::topic_statistics::kSerializedMessageSizeName);
+  EXPECT_DOUBLE_EQ(
+    0.0, get_statistic(size, StatisticDataType::STATISTICS_DATA_TYPE_SAMPLE_COUNT));
+
+  const auto & intra_process =
+    first_messages.at(rclcpp::topic_statistics::kIntraProcessPublishedMessagesName);
+  EXPECT_DOUBLE_EQ(
+    static_cast<double>(kNumPublishedMessages),
+    get_statistic(intra_process, StatisticDataType::STATISTICS_DATA_TYPE_AVERAGE));
+  const auto & inter_process =
+    first_messages.at(rclcpp::topic_statistics::kInterProcessPublishedMessagesName);
+  EXPECT_DOUBLE_EQ(
+    0.0, get_statistic(inter_process, StatisticDataType::STATISTICS_DATA_TYPE_AVERAGE));
+}
+
+TEST_F(TestPublisherTopicStatisticsFixture, test_generic_publisher_serialized_size)
+{
+  auto options = rclcpp::PublisherOptions();
+  options.use_intra_process_comm = rclcpp::IntraProcessSetting::Disable;
+  auto publisher = node_->create_generic_publisher(
+    kTestPubStatsTopic, "test_msgs/msg/Empty", rclcpp::QoS(10), options);
+  auto topic_stats = std::make_shared<TestPublisherTopicStatistics>(
+    node_->get_name(),
+    node_->create_publisher<MetricsMessage>(kTestTopicStatisticsTopic, 10));
+  publisher->set_topic_statistics(topic_stats);
+
+  rclcpp::Serialization<Empty> serialization;
+  rclcpp::SerializedMessage serialized_message;
+  Empty message;
+  serialization.serialize_message(&message, &serialized_message);
+  publisher->publish(serialized_message);
+  publisher->publish(serialized_message);
+
+  const auto data = topic_stats->get_current_collector_data();
+  EXPECT_EQ(2u, data[1].sample_count);
+  EXPECT_EQ(2u, data[2].sample_count);
+  EXPECT_DOUBLE_EQ(static_cast<double>(serialized_message.size()), data[2].average);
+  EXPECT_EQ(
+    (std::pair<uint64_t, uint64_t>(0, 2)),
+    topic_stats->get_current_published_message_counts());
+}
@@ -16,12 +16,17 @@
 
 #include <atomic>
 #include <chrono>
+#include <cmath>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <optional>
 #include <random>
 #include <set>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include "libstatistics_collector/moving_average_statistics/types.hpp"
@@ -85,8 +90,12 @@ class TestSubscriptionTopicStatistics : public SubscriptionTopicStatistics<Callb
 public:
   TestSubscriptionTopicStatistics(
     const std::string & node_name,
-    rclcpp::Publisher<statistics_msgs::msg::MetricsMessage>::SharedPtr publisher)
-  : SubscriptionTopicStatistics<CallbackMessageT>(node_name, publisher)
+    rclcpp::Publisher<statistics_msgs::msg::MetricsMessage>::SharedPtr publisher,
+    const std::vector<double> & percentiles = {},
+    uint64_t sample_every_n_messages = 1,
+    uint64_t max_samples_per_period = 0)
+  : SubscriptionTopicStatistics<CallbackMessageT>(
+      node_name, publisher, percentiles, sample_every_n_messages, max_samples_per_period)
   {
   }
 
@@ -586,3 +595,282 @@ TEST_F(TestSubscriptionTopicStatisticsFixture, test_receive_stats_include_window
     }
   }
 }
+
+/**
+ * Give intra-process buffer metrics to a manually constructed instance, and verify that a
+ * message is published per metric, with the counts of each window.
+ */
+TEST_F(TestSubscriptionTopicStatisticsFixture, test_intra_process_buffer_metrics)
+{
+  auto empty_subscriber = std::make_shared<EmptySubscriber>(
+    kTestSubNodeName,
+    kTestSubStatsEmptyTopic);
+  auto topic_stats_publisher =
+    empty_subscriber->create_publisher<MetricsMessage>(kTestTopicStatisticsTopic, 20);
+  auto sub_topic_stats = std::make_unique<TestSubscriptionTopicStatistics<Empty>>(
+    empty_subscriber->get_name(),
+    topic_stats_publisher);
+
+  // The two collectors and the five buffer metrics, over two windows
+  constexpr uint64_t kNumExpectedMessagesPerWindow{7};
+  auto statistics_listener = std::make_shared<rclcpp::topic_statistics::MetricsMessageSubscriber>(
+    "test_intra_process_buffer_metrics_listener",
+    kTestTopicStatisticsTopic,
+    kNumExpectedMessagesPerWindow * 2);
+
+  // Wait for the listener to be matched, not to lose the first messages
+  const auto start = std::chrono::steady_clock::now();
+  while (
+    topic_stats_publisher->get_subscription_count() == 0 &&
+    std::chrono::steady_clock::now() - start < kTestTimeout)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  ASSERT_EQ(1u, topic_stats_publisher->get_subscription_count());
+
+  rclcpp::experimental::buffers::BufferMetrics metrics;
+  metrics.capacity = 10;
+  metrics.depth = 3;
+  metrics.high_water_mark = 5;
+  metrics.enqueued_count = 10;
+  metrics.dequeued_count = 6;
+  metrics.dropped_count = 1;
+  sub_topic_stats->set_intra_process_buffer_metrics_source(
+    [&metrics]() -> std::optional<rclcpp::experimental::buffers::BufferMetrics> {
+      return metrics;
+    });
+
+  sub_topic_stats->publish_message_and_reset_measurements();
+  metrics.depth = 10;
+  metrics.high_water_mark = 10;
+  metrics.enqueued_count = 20;
+  metrics.dropped_count = 4;
+  sub_topic_stats->publish_message_and_reset_measurements();
+
+  rclcpp::executors::SingleThreadedExecutor ex;
+  ex.add_node(statistics_listener);
+  ex.spin_until_future_complete(statistics_listener->GetFuture(), kTestTimeout);
+
+  const auto received_messages = statistics_listener->GetReceivedMessages();
+  ASSERT_EQ(kNumExpectedMessagesPerWindow * 2, received_messages.size());
+
+  auto get_average = [](const MetricsMessage & msg) {
+      for (const auto & stats_point : msg.statistics) {
+        if (stats_point.data_type == StatisticDataType::STATISTICS_DATA_TYPE_AVERAGE) {
+          return stats_point.data;
+        }
+      }
+      return std::nan("");
+    };
+
+  std::vector<std::vector<double>> window_values(2);
+  for (size_t i = 0; i < received_messages.size(); ++i) {
+    const auto & msg = received_messages[i];
+    if (
+      msg.metrics_source == kMessageAgeSourceLabel ||
+      msg.metrics_source == kMessagePeriodSourceLabel)
+    {
+      continue;
+    }
+    EXPECT_EQ("messages", msg.unit);
+    window_values[i / kNumExpectedMessagesPerWindow].push_back(get_average(msg));
+  }
+  // Depth, high-water mark, then the enqueued, dequeued and dropped counts of the window
+  EXPECT_EQ(std::vector<double>({3.0, 5.0, 10.0, 6.0, 1.0}), window_values[0]);
+  EXPECT_EQ(std::vector<double>({10.0, 10.0, 10.0, 0.0, 3.0}), window_values[1]);
+
+  // Nothing is published for the buffer without metrics
+  sub_topic_stats->set_intra_process_buffer_metrics_source(
+    []() -> std::optional<rclcpp::experimental::buffers::BufferMetrics> {
+      return std::nullopt;
+    });
+  EXPECT_NO_THROW(sub_topic_stats->publish_message_and_reset_measurements());
+}
+
+/**
+ * Give messages with known ages and periods to a manually constructed instance publishing
+ * percentiles, and verify that a message is published per percentile.
+ */
+TEST_F(TestSubscriptionTopicStatisticsFixture, test_percentiles)
+{
+  auto empty_subscriber = std::make_shared<EmptySubscriber>(
+    kTestSubNodeName,
+    kTestSubStatsEmptyTopic);
+  auto topic_stats_publisher =
+    empty_subscriber->create_publisher<MetricsMessage>(kTestTopicStatisticsTopic, 20);
+
+  EXPECT_THROW(
+    TestSubscriptionTopicStatistics<MessageWithHeader>(
+      empty_subscriber->get_name(), topic_stats_publisher, {0.0}),
+    std::invalid_argument);
+  EXPECT_THROW(
+    TestSubscriptionTopicStatistics<MessageWithHeader>(
+      empty_subscriber->get_name(), topic_stats_publisher, {50.0, 101.0}),
+    std::invalid_argument);
+
+  auto sub_topic_stats = std::make_unique<TestSubscriptionTopicStatistics<MessageWithHeader>>(
+    empty_subscriber->get_name(),
+    topic_stats_publisher,
+    std::vector<double>{50.0, 99.9});
+
+  // The two collectors and two percentiles of each
+  constexpr uint64_t kNumExpectedMessagesPerWindow{6};
+  auto statistics_listener = std::make_shared<rclcpp::topic_statistics::MetricsMessageSubscriber>(
+    "test_percentiles_listener",
+    kTestTopicStatisticsTopic,
+    kNumExpectedMessagesPerWindow);
+
+  // Wait for the listener to be matched, not to lose the messages
+  const auto start = std::chrono::steady_clock::now();
+  while (
+    topic_stats_publisher->get_subscription_count() == 0 &&
+    std::chrono::steady_clock::now() - start < kTestTimeout)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  ASSERT_EQ(1u, topic_stats_publisher->get_subscription_count());
+
+  // Messages received every millisecond, aged from 1 to 100 milliseconds
+  const rclcpp::Time start_time(1000, 0);
+  for (int64_t i = 1; i <= 100; ++i) {
+    const rclcpp::Time now = start_time + rclcpp::Duration::from_nanoseconds(RCL_MS_TO_NS(i));
+    MessageWithHeader msg;
+    msg.header.stamp = now - rclcpp::Duration::from_nanoseconds(RCL_MS_TO_NS(i));
+    sub_topic_stats->handle_message(msg, now);
+  }
+  sub_topic_stats->publish_message_and_reset_measurements();
+
+  rclcpp::executors::SingleThreadedExecutor ex;
+  ex.add_node(statistics_listener);
+  ex.spin_until_future_complete(statistics_listener->GetFuture(), kTestTimeout);
+
+  std::map<std::string, MetricsMessage> received_messages;
+  for (const auto & msg : statistics_listener->GetReceivedMessages()) {
+    received_messages.emplace(msg.metrics_source, msg);
+  }
+  ASSERT_EQ(kNumExpectedMessagesPerWindow, received_messages.size());
+
+  auto get_statistic = [](const MetricsMessage & msg, uint8_t type) {
+      for (const auto & stats_point : msg.statistics) {
+        if (stats_point.data_type == type) {
+          return stats_point.data;
+        }
+      }
+      return std::nan("");
+    };
+
+  // The values are recorded with a relative error of 1/32
+  const std::pair<const char *, double> expected_percentiles[] = {
+    {"message_age_p50", 50.0},
+    {"message_age_p99.9", 100.0},
+    {"message_period_p50", 1.0},
+    {"message_period_p99.9", 1.0},
+  };
+  for (const auto & expected : expected_percentiles) {
+    ASSERT_EQ(1u, received_messages.count(expected.first)) << expected.first;
+    const auto & msg = received_messages.at(expected.first);
+    EXPECT_EQ("ms", msg.unit);
+    const double value = get_statistic(msg, StatisticDataType::STATISTICS_DATA_TYPE_AVERAGE);
+    EXPECT_LE(expected.second, value) << expected.first;
+    EXPECT_GE(expected.second * (1.0 + 1.0 / 32.0), value) << expected.first;
+  }
+  EXPECT_DOUBLE_EQ(
+    100.0,
+    get_statistic(
+      received_messages.at("message_age_p50"),
+      StatisticDataType::STATISTICS_DATA_TYPE_SAMPLE_COUNT));
+  EXPECT_DOUBLE_EQ(
+    99.0,
+    get_statistic(
+      received_messages.at("message_period_p50"),
+      StatisticDataType::STATISTICS_DATA_TYPE_SAMPLE_COUNT));
+}
+
+/**
+ * Measure a sample of the messages with a manually constructed instance, and verify that the
+ * period is scaled and the sampling interval adapted to the rate of the messages.
+ */
+TEST_F(TestSubscriptionTopicStatisticsFixture, test_sampling)
+{
+  auto empty_subscriber = std::make_shared<EmptySubscriber>(
+    kTestSubNodeName,
+    kTestSubStatsEmptyTopic);
+  auto topic_stats_publisher =
+    empty_subscriber->create_publisher<MetricsMessage>(kTestTopicStatisticsTopic, 20);
+
+  EXPECT_THROW(
+    TestSubscriptionTopicStatistics<Empty>(
+      empty_subscriber->get_name(), topic_stats_publisher, {}, 0),
+    std::invalid_argument);
+
+  // One message out of 4, and at most 10 per window
+  auto sub_topic_stats = std::make_unique<TestSubscriptionTopicStatistics<Empty>>(
+    empty_subscriber->get_name(),
+    topic_stats_publisher,
+    std::vector<double>{},
+    4,
+    10);
+
+  // The two collectors and the number of messages received, over two windows
+  constexpr uint64_t kNumExpectedMessagesPerWindow{3};
+  auto statistics_listener = std::make_shared<rclcpp::topic_statistics::MetricsMessageSubscriber>(
+    "test_sampling_listener",
+    kTestTopicStatisticsTopic,
+    kNumExpectedMessagesPerWindow * 2);
+
+  // Wait for the listener to be matched, not to lose the messages
+  const auto start = std::chrono::steady_clock::now();
+  while (
+    topic_stats_publisher->get_subscription_count() == 0 &&
+    std::chrono::steady_clock::now() - start < kTestTimeout)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  ASSERT_EQ(1u, topic_stats_publisher->get_subscription_count());
+
+  // Messages received every millisecond
+  rclcpp::Time now(1000, 0);
+  auto receive_messages = [&now, &sub_topic_stats](uint64_t count) {
+      uint64_t measured_count = 0;
+      for (uint64_t i = 0; i < count; ++i) {
+        now += rclcpp::Duration::from_nanoseconds(RCL_MS_TO_NS(1));
+        if (sub_topic_stats->should_measure_message()) {
+          ++measured_count;
+          sub_topic_stats->handle_message(Empty(), now);
+        }
+      }
+      return measured_count;
+    };
+
+  EXPECT_EQ(25u, receive_messages(100));
+  auto period = sub_topic_stats->get_current_collector_data()[1];
+  EXPECT_EQ(24u, period.sample_count);
+  EXPECT_DOUBLE_EQ(1.0, period.average);
+  sub_topic_stats->publish_message_and_reset_measurements();
+
+  // 100 messages were received in the previous window, one out of 10 is measured
+  EXPECT_EQ(10u, receive_messages(100));
+  period = sub_topic_stats->get_current_collector_data()[1];
+  EXPECT_EQ(9u, period.sample_count);
+  EXPECT_DOUBLE_EQ(1.0, period.average);
+  sub_topic_stats->publish_message_and_reset_measurements();
+
+  rclcpp::executors::SingleThreadedExecutor ex;
+  ex.add_node(statistics_listener);
+  ex.spin_until_future_complete(statistics_listener->GetFuture(), kTestTimeout);
+
+  uint64_t received_messages_count = 0;
+  for (const auto & msg : statistics_listener->GetReceivedMessages()) {
+    if (msg.metrics_source != "received_messages") {
+      continue;
+    }
+    ++received_messages_count;
+    EXPECT_EQ("messages", msg.unit);
+    for (const auto & stats_point : msg.statistics) {
+      if (stats_point.data_type == StatisticDataType::STATISTICS_DATA_TYPE_AVERAGE) {
+        EXPECT_DOUBLE_EQ(100.0, stats_point.data);
+      }
+    }
+  }
+  EXPECT_EQ(2u, received_messages_count);
+}
@@ -0,0 +1,161 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp/timer_statistics.hpp"
+#include "rclcpp/topic_statistics/timer_statistics_publisher.hpp"
+
+#include "statistics_msgs/msg/metrics_message.hpp"
+
+using namespace std::chrono_literals;
+using statistics_msgs::msg::MetricsMessage;
+
+class TestTimerStatistics : public ::testing::Test
+{
+public:
+  void SetUp()
+  {
+    rclcpp::init(0, nullptr);
+    node = std::make_shared<rclcpp::Node>("test_timer_statistics_node");
+  }
+
+  void TearDown()
+  {
+    node.reset();
+    rclcpp::shutdown();
+  }
+
+  rclcpp::Node::SharedPtr node;
+};
+
+TEST_F(TestTimerStatistics, disabled_by_default) {
+  auto timer = node->create_wall_timer(1ms, []() {});
+  EXPECT_EQ(nullptr, timer->get_statistics());
+  auto statistics = timer->enable_statistics();
+  ASSERT_NE(nullptr, statistics);
+  EXPECT_EQ(statistics, timer->enable_statistics());
+  EXPECT_EQ(statistics, timer->get_statistics());
+  EXPECT_EQ(0u, statistics->get_snapshot().call_count);
+}
+
+TEST_F(TestTimerStatistics, lateness_execution_time_and_missed_periods) {
+  size_t calls = 0;
+  auto timer = node->create_wall_timer(
+    10ms, [&calls]() {
+      // The first call is at least 3 periods late, the others run for 1ms
+      std::this_thread::sleep_for(1ms);
+      ++calls;
+    });
+  auto statistics = timer->enable_statistics();
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  std::this_thread::sleep_for(45ms);
+  const auto end = std::chrono::steady_clock::now() + 10s;
+  while (calls < 3 && std::chrono::steady_clock::now() < end) {
+    executor.spin_once(10ms);
+  }
+  ASSERT_GE(calls, 3u);
+
+  auto snapshot = statistics->get_snapshot();
+  EXPECT_EQ(calls, snapshot.call_count);
+  EXPECT_EQ(calls, snapshot.lateness.sample_count);
+  EXPECT_EQ(calls, snapshot.lateness_histogram.get_count());
+  EXPECT_GE(snapshot.missed_periods, 3u);
+  EXPECT_GE(snapshot.lateness.max, 30.0);
+  EXPECT_GE(snapshot.execution_time.min, 1.0);
+  EXPECT_GE(snapshot.lateness_histogram.get_value_at_percentile(100.0), 30000000u);
+
+  // Taking the snapshot starts a new window
+  snapshot = statistics->take_snapshot();
+  EXPECT_EQ(calls, snapshot.call_count);
+  snapshot = statistics->take_snapshot();
+  EXPECT_EQ(0u, snapshot.call_count);
+  EXPECT_EQ(0u, snapshot.missed_periods);
+  EXPECT_EQ(0u, snapshot.lateness_histogram.get_count());
+}
+
+TEST_F(TestTimerStatistics, callback_not_called_by_an_executor) {
+  auto timer = node->create_wall_timer(1s, []() {});
+  auto statistics = timer->enable_statistics();
+  timer->execute_callback();
+  auto snapshot = statistics->get_snapshot();
+  EXPECT_EQ(1u, snapshot.call_count);
+  EXPECT_EQ(0u, snapshot.lateness.sample_count);
+  EXPECT_EQ(0u, snapshot.missed_periods);
+}
+
+TEST_F(TestTimerStatistics, generate_messages) {
+  auto timer = node->create_wall_timer(1s, []() {});
+  auto statistics = timer->enable_statistics();
+  auto msgs = rclcpp::topic_statistics::TimerStatisticsPublisher::generate_messages(
+    "/node/timer", statistics->get_snapshot(), rclcpp::Time(0), rclcpp::Time(1));
+  // No lateness percentile without samples
+  ASSERT_EQ(3u, msgs.size());
+  EXPECT_EQ("/node/timer", msgs[0].measurement_source_name);
+  EXPECT_EQ(rclcpp::topic_statistics::kTimerLatenessName, msgs[0].metrics_source);
+  EXPECT_EQ(rclcpp::topic_statistics::kTimerExecutionTimeName, msgs[1].metrics_source);
+  EXPECT_EQ(rclcpp::topic_statistics::kTimerMissedPeriodsName, msgs[2].metrics_source);
+  EXPECT_EQ(rclcpp::topic_statistics::kTimerMissedPeriodsUnitName, msgs[2].unit);
+}
+
+TEST_F(TestTimerStatistics, publisher) {
+  auto timer = node->create_wall_timer(5ms, []() {});
+  rclcpp::topic_statistics::TimerStatisticsPublisherOptions options;
+  options.publish_topic = "/timer_statistics";
+  options.publish_period = 100ms;
+  EXPECT_THROW(
+    rclcpp::topic_statistics::create_timer_statistics_publisher(
+      *node, nullptr, "control_loop", options),
+    std::invalid_argument);
+  auto invalid_options = options;
+  invalid_options.publish_period = 0ms;
+  EXPECT_THROW(
+    rclcpp::topic_statistics::create_timer_statistics_publisher(
+      *node, timer, "control_loop", invalid_options),
+    std::invalid_argument);
+
+  auto statistics_publisher = rclcpp::topic_statistics::create_timer_statistics_publisher(
+    *node, timer, "control_loop", options);
+  ASSERT_NE(nullptr, timer->get_statistics());
+
+  std::vector<MetricsMessage> received;
+  auto subscription = node->create_subscription<MetricsMessage>(
+    "/timer_statistics", 10,
+    [&received](const MetricsMessage & msg) {
+      received.push_back(msg);
+    });
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  const auto end = std::chrono::steady_clock::now() + 10s;
+  bool has_percentile = false;
+  while (!has_percentile && std::chrono::steady_clock::now() < end) {
+    executor.spin_once(10ms);
+    for (const auto & msg : received) {
+      EXPECT_EQ("/test_timer_statistics_node/control_loop", msg.measurement_source_name);
+      has_percentile = has_percentile ||
+        msg.metrics_source == rclcpp::topic_statistics::kTimerLatenessP99Name;
+    }
+  }
+  EXPECT_TRUE(has_percentile);
+}
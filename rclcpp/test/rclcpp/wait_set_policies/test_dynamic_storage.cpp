@@ -300,3 +300,56 @@ TEST_F(TestDynamicStorage, wait_waitable) {
     EXPECT_EQ(rclcpp::WaitResultKind::Empty, wait_result.kind());
   }
 }
+
+TEST_F(TestDynamicStorage, wait_repeatedly) {
+  rclcpp::WaitSet wait_set;
+  auto publisher = node->create_publisher<test_msgs::msg::Empty>("topic", 10);
+  auto subscription = node->create_subscription<test_msgs::msg::Empty>(
+    "topic", 10, [](test_msgs::msg::Empty::ConstSharedPtr) {});
+  wait_set.add_subscription(subscription);
+  auto guard_condition = std::make_shared<rclcpp::GuardCondition>();
+  wait_set.add_guard_condition(guard_condition);
+
+  // The handles of the first wait are reused by the following waits
+  for (size_t i = 0; i < 3; ++i) {
+    guard_condition->trigger();
+    auto wait_result = wait_set.wait(std::chrono::seconds(-1));
+    ASSERT_EQ(rclcpp::WaitResultKind::Ready, wait_result.kind());
+    const rcl_wait_set_t & rcl_wait_set = wait_set.get_rcl_wait_set();
+    ASSERT_EQ(1u, rcl_wait_set.size_of_subscriptions);
+    EXPECT_EQ(nullptr, rcl_wait_set.subscriptions[0]);
+    EXPECT_EQ(&guard_condition->get_rcl_guard_condition(), rcl_wait_set.guard_conditions[0]);
+  }
+
+  publisher->publish(test_msgs::msg::Empty());
+  {
+    auto wait_result = wait_set.wait(std::chrono::seconds(-1));
+    ASSERT_EQ(rclcpp::WaitResultKind::Ready, wait_result.kind());
+    EXPECT_EQ(
+      subscription->get_subscription_handle().get(),
+      wait_set.get_rcl_wait_set().subscriptions[0]);
+  }
+  test_msgs::msg::Empty message;
+  rclcpp::MessageInfo message_info;
+  EXPECT_TRUE(subscription->take(message, message_info));
+
+  // Modifying the wait set collects the handles again
+  auto other_publisher = node->create_publisher<test_msgs::msg::Empty>("other_topic", 10);
+  auto other_subscription = node->create_subscription<test_msgs::msg::Empty>(
+    "other_topic", 10, [](test_msgs::msg::Empty::ConstSharedPtr) {});
+  wait_set.remove_subscription(subscription);
+  wait_set.add_subscription(other_subscription);
+  other_publisher->publish(test_msgs::msg::Empty());
+  {
+    auto wait_result = wait_set.wait(std::chrono::seconds(-1));
+    ASSERT_EQ(rclcpp::WaitResultKind::Ready, wait_result.kind());
+    EXPECT_EQ(
+      other_subscription->get_subscription_handle().get(),
+      wait_set.get_rcl_wait_set().subscriptions[0]);
+  }
+
+  // A deleted entity isn't added from the previous handles
+  guard_condition.reset();
+  EXPECT_EQ(rclcpp::WaitResultKind::Ready, wait_set.wait(std::chrono::seconds(-1)).kind());
+  EXPECT_EQ(nullptr, wait_set.get_rcl_wait_set().guard_conditions[0]);
+}
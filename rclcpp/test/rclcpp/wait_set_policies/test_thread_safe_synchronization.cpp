@@ -15,6 +15,7 @@
 #include <gtest/gtest.h>
 
 #include <memory>
+#include <thread>
 #include <vector>
 
 #include "rclcpp/rclcpp.hpp"
@@ -304,3 +305,32 @@ TEST_F(TestThreadSafeStorage, wait_waitable) {
     EXPECT_EQ(rclcpp::WaitResultKind::Timeout, wait_result.kind());
   }
 }
+
+TEST_F(TestThreadSafeStorage, add_remove_while_waiting) {
+  rclcpp::ThreadSafeWaitSet wait_set;
+  auto guard_condition = std::make_shared<rclcpp::GuardCondition>();
+  wait_set.add_guard_condition(guard_condition);
+
+  std::vector<rclcpp::GuardCondition::SharedPtr> added_guard_conditions;
+  for (size_t i = 0; i < 10; ++i) {
+    added_guard_conditions.push_back(std::make_shared<rclcpp::GuardCondition>());
+  }
+  std::thread modifying_thread([&]() {
+      // The removals don't interrupt the wait, the additions are waited on in one rebuild
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      for (const auto & added_guard_condition : added_guard_conditions) {
+        wait_set.add_guard_condition(added_guard_condition);
+      }
+      for (size_t i = 0; i + 1 < added_guard_conditions.size(); ++i) {
+        wait_set.remove_guard_condition(added_guard_conditions[i]);
+      }
+      added_guard_conditions.back()->trigger();
+    });
+
+  auto wait_result = wait_set.wait(std::chrono::seconds(10));
+  modifying_thread.join();
+  ASSERT_EQ(rclcpp::WaitResultKind::Ready, wait_result.kind());
+  const auto & ready_guard_conditions = wait_result.get_ready_entities().guard_conditions;
+  ASSERT_EQ(1u, ready_guard_conditions.size());
+  EXPECT_EQ(added_guard_conditions.back(), ready_guard_conditions[0]);
+}
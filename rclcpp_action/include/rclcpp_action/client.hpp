@@ -19,7 +19,6 @@
 #include <chrono>
 #include <functional>
 #include <future>
-#include <map>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -28,6 +27,7 @@
 
 #include "rcl/event_callback.h"
 
+#include "rclcpp/context.hpp"
 #include "rclcpp/exceptions.hpp"
 #include "rclcpp/macros.hpp"
 #include "rclcpp/node_interfaces/node_base_interface.hpp"
@@ -42,6 +42,7 @@
 
 #include "rclcpp_action/client_goal_handle.hpp"
 #include "rclcpp_action/exceptions.hpp"
+#include "rclcpp_action/intra_process.hpp"
 #include "rclcpp_action/types.hpp"
 #include "rclcpp_action/visibility_control.hpp"
 
@@ -180,6 +181,12 @@ public:
   // End Waitables API
   // -----------------
 
+  /// Return the waitable receiving the intra-process messages, if intra-process is setup.
+  /// \internal
+  RCLCPP_ACTION_PUBLIC
+  rclcpp::Waitable::SharedPtr
+  get_intra_process_waitable() const;
+
 protected:
   RCLCPP_ACTION_PUBLIC
   ClientBase(
@@ -198,6 +205,9 @@ protected:
   // -----------------------------------------------------
   // API for communication between ClientBase and Client<>
   using ResponseCallback = std::function<void (std::shared_ptr<void> response)>;
+  /// Function called with the response to a goal request, and whether it was sent by pointer.
+  using GoalResponseCallback =
+    std::function<void (std::shared_ptr<void> response, bool is_intra_process)>;
 
   /// \internal
   RCLCPP_ACTION_PUBLIC
@@ -215,7 +225,7 @@ protected:
   void
   send_goal_request(
     std::shared_ptr<void> request,
-    ResponseCallback callback);
+    GoalResponseCallback callback);
 
   /// \internal
   RCLCPP_ACTION_PUBLIC
@@ -288,9 +298,27 @@ protected:
   create_status_message() const = 0;
 
   /// \internal
+  /**
+   * \param[in] message the goal statuses.
+   * \param[in] is_intra_process true if the message was given by pointer by an action server in
+   *   the same context, only the statuses of the goals sent to it by pointer are used.
+   */
   virtual
   void
-  handle_status_message(std::shared_ptr<void> message) = 0;
+  handle_status_message(std::shared_ptr<void> message, bool is_intra_process) = 0;
+
+  /// Send the requests by pointer to the action server in the same context, if any.
+  /// \internal
+  /**
+   * \sa Client::setup_intra_process()
+   *
+   * \param[in] context the context of the node of the client.
+   * \param[in] weak_this the client itself, the messages are dropped once it's destroyed.
+   * \throws std::runtime_error if intra-process communication is already setup.
+   */
+  RCLCPP_ACTION_PUBLIC
+  void
+  setup_intra_process(rclcpp::Context::SharedPtr context, std::weak_ptr<ClientBase> weak_this);
 
   // End API for communication between ClientBase and Client<>
   // ---------------------------------------------------------
@@ -312,6 +340,14 @@ protected:
 private:
   std::unique_ptr<ClientBaseImpl> pimpl_;
 
+  /// Handle a message given by pointer by an action server in the same context
+  RCLCPP_ACTION_PUBLIC
+  void
+  handle_intra_process_message(
+    ClientIntraProcess::MessageType message_type,
+    int64_t request_id,
+    std::shared_ptr<void> message);
+
   /// Set a std::function callback to be called when the specified entity is ready
   RCLCPP_ACTION_PUBLIC
   void
@@ -333,7 +369,7 @@ private:
  *  - calling user callbacks.
  */
 template<typename ActionT>
-class Client : public ClientBase
+class Client : public ClientBase, public std::enable_shared_from_this<Client<ActionT>>
 {
 public:
   RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(Client<ActionT>)
@@ -430,7 +466,8 @@ public:
     goal_request->goal = goal;
     this->send_goal_request(
       std::static_pointer_cast<void>(goal_request),
-      [this, goal_request, options, promise](std::shared_ptr<void> response) mutable
+      [this, goal_request, options, promise](
+        std::shared_ptr<void> response, bool is_intra_process) mutable
       {
         using GoalResponse = typename ActionT::Impl::SendGoalService::Response;
         auto goal_response = std::static_pointer_cast<GoalResponse>(response);
@@ -449,7 +486,8 @@ public:
           new GoalHandle(goal_info, options.feedback_callback, options.result_callback));
         {
           std::lock_guard<std::mutex> guard(goal_handles_mutex_);
-          goal_handles_[goal_handle->get_goal_id()] = goal_handle;
+          goal_handles_[goal_handle->get_goal_id()] =
+            {goal_handle, goal_handle->get_status(), is_intra_process};
         }
         promise->set_value(goal_handle);
         if (options.goal_response_callback) {
@@ -464,19 +502,23 @@ public:
     // TODO(jacobperron): Encapsulate into it's own function and
     //                    consider exposing an option to disable this cleanup
     // To prevent the list from growing out of control, forget about any goals
-    // with no more user references
+    // with no more user references.
+    // Doing it once the list doubled in size keeps the cost per goal constant.
     {
       std::lock_guard<std::mutex> guard(goal_handles_mutex_);
-      auto goal_handle_it = goal_handles_.begin();
-      while (goal_handle_it != goal_handles_.end()) {
-        if (!goal_handle_it->second.lock()) {
-          RCLCPP_DEBUG(
-            this->get_logger(),
-            "Dropping weak reference to goal handle during send_goal()");
-          goal_handle_it = goal_handles_.erase(goal_handle_it);
-        } else {
-          ++goal_handle_it;
+      if (goal_handles_.size() >= 2 * goal_handles_pruned_size_) {
+        auto goal_handle_it = goal_handles_.begin();
+        while (goal_handle_it != goal_handles_.end()) {
+          if (!goal_handle_it->second.goal_handle.lock()) {
+            RCLCPP_DEBUG(
+              this->get_logger(),
+              "Dropping weak reference to goal handle during send_goal()");
+            goal_handle_it = goal_handles_.erase(goal_handle_it);
+          } else {
+            ++goal_handle_it;
+          }
         }
+        goal_handles_pruned_size_ = goal_handles_.size();
       }
     }
 
@@ -587,13 +629,32 @@ public:
     return async_cancel(cancel_request, cancel_callback);
   }
 
+  /// Send the requests by pointer to the action server in the same context, if any.
+  /**
+   * Called by rclcpp_action::create_client() when the node uses intra-process communication.
+   * The action server is looked up before each request, and the request goes through the
+   * middleware when there is no action server with this name and type in the same context.
+   * The responses, the feedback and the goal statuses of the goals sent by pointer are given
+   * by pointer too.
+   * The server gets the request objects themselves, so they must not be modified after being
+   * sent.
+   *
+   * \param[in] context the context of the node of the client.
+   * \throws std::runtime_error if intra-process communication is already setup.
+   */
+  void
+  setup_intra_process(rclcpp::Context::SharedPtr context)
+  {
+    ClientBase::setup_intra_process(context, this->shared_from_this());
+  }
+
   virtual
   ~Client()
   {
     std::lock_guard<std::mutex> guard(goal_handles_mutex_);
     auto it = goal_handles_.begin();
     while (it != goal_handles_.end()) {
-      typename GoalHandle::SharedPtr goal_handle = it->second.lock();
+      typename GoalHandle::SharedPtr goal_handle = it->second.goal_handle.lock();
       if (goal_handle) {
         goal_handle->invalidate(exceptions::UnawareGoalHandleError());
       }
@@ -642,19 +703,20 @@ private:
     typename FeedbackMessage::SharedPtr feedback_message =
       std::static_pointer_cast<FeedbackMessage>(message);
     const GoalUUID & goal_id = feedback_message->goal_id.uuid;
-    if (goal_handles_.count(goal_id) == 0) {
+    auto entry = goal_handles_.find(goal_id);
+    if (entry == goal_handles_.end()) {
       RCLCPP_DEBUG(
         this->get_logger(),
         "Received feedback for unknown goal. Ignoring...");
       return;
     }
-    typename GoalHandle::SharedPtr goal_handle = goal_handles_[goal_id].lock();
+    typename GoalHandle::SharedPtr goal_handle = entry->second.goal_handle.lock();
     // Forget about the goal if there are no more user references
     if (!goal_handle) {
       RCLCPP_DEBUG(
         this->get_logger(),
         "Dropping weak reference to goal handle during feedback callback");
-      goal_handles_.erase(goal_id);
+      goal_handles_.erase(entry);
       return;
     }
     auto feedback = std::make_shared<Feedback>();
@@ -672,28 +734,38 @@ private:
 
   /// \internal
   void
-  handle_status_message(std::shared_ptr<void> message) override
+  handle_status_message(std::shared_ptr<void> message, bool is_intra_process) override
   {
     std::lock_guard<std::mutex> guard(goal_handles_mutex_);
     using GoalStatusMessage = typename ActionT::Impl::GoalStatusMessage;
     auto status_message = std::static_pointer_cast<GoalStatusMessage>(message);
     for (const GoalStatus & status : status_message->status_list) {
       const GoalUUID & goal_id = status.goal_info.goal_id.uuid;
-      if (goal_handles_.count(goal_id) == 0) {
+      auto entry = goal_handles_.find(goal_id);
+      if (entry == goal_handles_.end()) {
         RCLCPP_DEBUG(
           this->get_logger(),
           "Received status for unknown goal. Ignoring...");
         continue;
       }
-      typename GoalHandle::SharedPtr goal_handle = goal_handles_[goal_id].lock();
+      // The goals sent by pointer get their statuses by pointer too, and the other ones through
+      // the middleware.
+      // The status message lists all the goals of the server, only the changes are applied
+      if (entry->second.is_intra_process != is_intra_process ||
+        entry->second.status == status.status)
+      {
+        continue;
+      }
+      typename GoalHandle::SharedPtr goal_handle = entry->second.goal_handle.lock();
       // Forget about the goal if there are no more user references
       if (!goal_handle) {
         RCLCPP_DEBUG(
           this->get_logger(),
           "Dropping weak reference to goal handle during status callback");
-        goal_handles_.erase(goal_id);
+        goal_handles_.erase(entry);
         continue;
       }
+      entry->second.status = status.status;
       goal_handle->set_status(status.status);
     }
   }
@@ -754,7 +826,17 @@ private:
     return future;
   }
 
-  std::map<GoalUUID, typename GoalHandle::WeakPtr> goal_handles_;
+  // The goal handles with the last status received for them
+  struct GoalHandleEntry
+  {
+    typename GoalHandle::WeakPtr goal_handle;
+    int8_t status;
+    // Whether the goal was sent by pointer to an action server in the same context
+    bool is_intra_process;
+  };
+  std::unordered_map<GoalUUID, GoalHandleEntry> goal_handles_;
+  // Number of goal handles after the last removal of the ones without user references
+  size_t goal_handles_pruned_size_{0};
   std::mutex goal_handles_mutex_;
 };
 }  // namespace rclcpp_action
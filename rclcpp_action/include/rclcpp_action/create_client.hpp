@@ -38,6 +38,9 @@ namespace rclcpp_action
  * \param[in] group The action client will be added to this callback group.
  *   If `nullptr`, then the action client is added to the default callback group.
  * \param[in] options Options to pass to the underlying `rcl_action_client_t`.
+ *
+ * When the node uses intra-process communication, the requests are sent by pointer to an
+ * action server of the same context, see Client::setup_intra_process().
  */
 template<typename ActionT>
 typename Client<ActionT>::SharedPtr
@@ -64,15 +67,22 @@ create_client(
       if (shared_node) {
         // API expects a shared pointer, give it one with a deleter that does nothing.
         std::shared_ptr<Client<ActionT>> fake_shared_ptr(ptr, [](Client<ActionT> *) {});
+        auto intra_process_waitable = ptr->get_intra_process_waitable();
 
         if (group_is_null) {
           // Was added to default group
           shared_node->remove_waitable(fake_shared_ptr, nullptr);
+          if (intra_process_waitable) {
+            shared_node->remove_waitable(intra_process_waitable, nullptr);
+          }
         } else {
           // Was added to a specific group
           auto shared_group = weak_group.lock();
           if (shared_group) {
             shared_node->remove_waitable(fake_shared_ptr, shared_group);
+            if (intra_process_waitable) {
+              shared_node->remove_waitable(intra_process_waitable, shared_group);
+            }
           }
         }
       }
@@ -88,6 +98,10 @@ create_client(
       options),
     deleter);
 
+  if (node_base_interface->get_use_intra_process_default()) {
+    action_client->setup_intra_process(node_base_interface->get_context());
+    node_waitables_interface->add_waitable(action_client->get_intra_process_waitable(), group);
+  }
   node_waitables_interface->add_waitable(action_client, group);
   return action_client;
 }
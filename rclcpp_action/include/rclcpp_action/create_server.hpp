@@ -52,6 +52,9 @@ namespace rclcpp_action
  * \param[in] options Options to pass to the underlying `rcl_action_server_t`.
  * \param[in] group The action server will be added to this callback group.
  *   If `nullptr`, then the action server is added to the default callback group.
+ *
+ * When the node uses intra-process communication, the requests of the clients of the same
+ * context are received by pointer, see Server::setup_intra_process().
  */
 template<typename ActionT>
 typename Server<ActionT>::SharedPtr
@@ -81,15 +84,22 @@ create_server(
       if (shared_node) {
         // API expects a shared pointer, give it one with a deleter that does nothing.
         std::shared_ptr<Server<ActionT>> fake_shared_ptr(ptr, [](Server<ActionT> *) {});
+        auto intra_process_waitable = ptr->get_intra_process_waitable();
 
         if (group_is_null) {
           // Was added to default group
           shared_node->remove_waitable(fake_shared_ptr, nullptr);
+          if (intra_process_waitable) {
+            shared_node->remove_waitable(intra_process_waitable, nullptr);
+          }
         } else {
           // Was added to a specific group
           auto shared_group = weak_group.lock();
           if (shared_group) {
             shared_node->remove_waitable(fake_shared_ptr, shared_group);
+            if (intra_process_waitable) {
+              shared_node->remove_waitable(intra_process_waitable, shared_group);
+            }
           }
         }
       }
@@ -106,6 +116,10 @@ create_server(
       handle_cancel,
       handle_accepted), deleter);
 
+  if (node_base_interface->get_use_intra_process_default()) {
+    action_server->setup_intra_process(node_base_interface->get_context());
+    node_waitables_interface->add_waitable(action_server->get_intra_process_waitable(), group);
+  }
   node_waitables_interface->add_waitable(action_server, group);
   return action_server;
 }
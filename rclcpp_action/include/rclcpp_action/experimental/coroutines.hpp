@@ -0,0 +1,235 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP_ACTION__EXPERIMENTAL__COROUTINES_HPP_
+#define RCLCPP_ACTION__EXPERIMENTAL__COROUTINES_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <memory>
+#include <utility>
+
+#include "rclcpp/experimental/coroutines.hpp"
+#include "rclcpp/node_interfaces/get_node_base_interface.hpp"
+#include "rclcpp/node_interfaces/get_node_timers_interface.hpp"
+
+#include "rclcpp_action/client.hpp"
+#include "rclcpp_action/client_goal_handle.hpp"
+
+namespace rclcpp_action
+{
+namespace experimental
+{
+
+// The goal response and result callbacks of an action client are called while it holds some
+// of its locks, so the coroutines can't be resumed from there: they are resumed from a
+// zero-period one-shot timer of the node instead.
+
+/// Awaitable sending a goal and producing its goal handle, see async_send_goal().
+template<typename ActionT>
+class SendGoalAwaitable
+{
+public:
+  using ClientT = Client<ActionT>;
+  using GoalHandleSharedPtr = typename ClientGoalHandle<ActionT>::SharedPtr;
+
+  SendGoalAwaitable(
+    typename ClientT::SharedPtr client,
+    typename ClientT::Goal goal,
+    typename ClientT::SendGoalOptions options,
+    rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_base,
+    rclcpp::node_interfaces::NodeTimersInterface::SharedPtr node_timers,
+    rclcpp::CallbackGroup::SharedPtr group)
+  : client_(std::move(client)),
+    goal_(std::move(goal)),
+    options_(std::move(options)),
+    node_base_(std::move(node_base)),
+    node_timers_(std::move(node_timers)),
+    group_(std::move(group))
+  {}
+
+  bool
+  await_ready() const noexcept
+  {
+    return false;
+  }
+
+  void
+  await_suspend(std::coroutine_handle<> handle)
+  {
+    auto options = options_;
+    auto goal_response_callback = std::move(options.goal_response_callback);
+    options.goal_response_callback =
+      [this, handle, goal_response_callback](GoalHandleSharedPtr goal_handle) {
+        if (goal_response_callback) {
+          goal_response_callback(goal_handle);
+        }
+        goal_handle_ = std::move(goal_handle);
+        // Nothing of this object is used once the timer is created
+        rclcpp::experimental::detail::resume_from_timer(
+          handle, std::chrono::nanoseconds::zero(), node_base_.get(), node_timers_.get(), group_);
+      };
+    auto client = client_;
+    client->async_send_goal(goal_, options);
+  }
+
+  GoalHandleSharedPtr
+  await_resume() noexcept
+  {
+    return std::move(goal_handle_);
+  }
+
+private:
+  typename ClientT::SharedPtr client_;
+  typename ClientT::Goal goal_;
+  typename ClientT::SendGoalOptions options_;
+  rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_base_;
+  rclcpp::node_interfaces::NodeTimersInterface::SharedPtr node_timers_;
+  rclcpp::CallbackGroup::SharedPtr group_;
+  GoalHandleSharedPtr goal_handle_;
+};
+
+/// Send a goal from a coroutine, and resume it when the goal is accepted or rejected.
+/**
+ * The coroutine is resumed by the executor of the given node, without holding any thread
+ * while waiting for the goal response.
+ *
+ * \param[in] node node used to resume the coroutine.
+ * \param[in] client action client used to send the goal.
+ * \param[in] goal goal to be sent.
+ * \param[in] options options of the goal, the goal response callback is still called.
+ * \param[in] group callback group used to resume the coroutine, or nullptr for the default one.
+ * \return the awaitable to `co_await`, producing the goal handle, or nullptr if the goal was
+ *   rejected.
+ */
+template<typename NodeT, typename ActionT>
+SendGoalAwaitable<ActionT>
+async_send_goal(
+  NodeT && node,
+  const std::shared_ptr<Client<ActionT>> & client,
+  typename Client<ActionT>::Goal goal,
+  typename Client<ActionT>::SendGoalOptions options = typename Client<ActionT>::SendGoalOptions(),
+  rclcpp::CallbackGroup::SharedPtr group = nullptr)
+{
+  return SendGoalAwaitable<ActionT>(
+    client, std::move(goal), std::move(options),
+    rclcpp::node_interfaces::get_node_base_interface(node),
+    rclcpp::node_interfaces::get_node_timers_interface(node),
+    std::move(group));
+}
+
+/// Awaitable producing the result of a goal, see async_get_result().
+template<typename ActionT>
+class GetResultAwaitable
+{
+public:
+  using ClientT = Client<ActionT>;
+  using GoalHandleSharedPtr = typename ClientGoalHandle<ActionT>::SharedPtr;
+  using WrappedResult = typename ClientGoalHandle<ActionT>::WrappedResult;
+
+  GetResultAwaitable(
+    typename ClientT::SharedPtr client,
+    GoalHandleSharedPtr goal_handle,
+    rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_base,
+    rclcpp::node_interfaces::NodeTimersInterface::SharedPtr node_timers,
+    rclcpp::CallbackGroup::SharedPtr group)
+  : client_(std::move(client)),
+    goal_handle_(std::move(goal_handle)),
+    node_base_(std::move(node_base)),
+    node_timers_(std::move(node_timers)),
+    group_(std::move(group))
+  {}
+
+  bool
+  await_ready() const noexcept
+  {
+    return false;
+  }
+
+  bool
+  await_suspend(std::coroutine_handle<> handle)
+  {
+    // Either the result callback or this function produces the result, whichever comes first
+    auto claimed = std::make_shared<std::atomic_bool>(false);
+    auto client = client_;
+    auto future = client->async_get_result(
+      goal_handle_,
+      [this, handle, claimed](const WrappedResult & result) {
+        if (claimed->exchange(true)) {
+          return;
+        }
+        result_ = result;
+        // Nothing of this object is used once the timer is created
+        rclcpp::experimental::detail::resume_from_timer(
+          handle, std::chrono::nanoseconds::zero(), node_base_.get(), node_timers_.get(), group_);
+      });
+    // The result may have been received before the callback was set
+    if (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready ||
+      claimed->exchange(true))
+    {
+      return true;
+    }
+    result_ = future.get();
+    return false;
+  }
+
+  WrappedResult
+  await_resume()
+  {
+    return std::move(result_);
+  }
+
+private:
+  typename ClientT::SharedPtr client_;
+  GoalHandleSharedPtr goal_handle_;
+  rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_base_;
+  rclcpp::node_interfaces::NodeTimersInterface::SharedPtr node_timers_;
+  rclcpp::CallbackGroup::SharedPtr group_;
+  WrappedResult result_;
+};
+
+/// Wait from a coroutine for the result of a goal.
+/**
+ * The coroutine is resumed by the executor of the given node, without holding any thread
+ * while the goal is executed.
+ * This replaces the result callback of the goal handle.
+ *
+ * \param[in] node node used to resume the coroutine.
+ * \param[in] client action client the goal was sent with.
+ * \param[in] goal_handle handle of the accepted goal.
+ * \param[in] group callback group used to resume the coroutine, or nullptr for the default one.
+ * \return the awaitable to `co_await`, producing the wrapped result of the goal.
+ * \throws exceptions::UnknownGoalHandleError from the `co_await` expression, as
+ *   Client::async_get_result().
+ */
+template<typename NodeT, typename ActionT>
+GetResultAwaitable<ActionT>
+async_get_result(
+  NodeT && node,
+  const std::shared_ptr<Client<ActionT>> & client,
+  typename ClientGoalHandle<ActionT>::SharedPtr goal_handle,
+  rclcpp::CallbackGroup::SharedPtr group = nullptr)
+{
+  return GetResultAwaitable<ActionT>(
+    client, std::move(goal_handle),
+    rclcpp::node_interfaces::get_node_base_interface(node),
+    rclcpp::node_interfaces::get_node_timers_interface(node),
+    std::move(group));
+}
+
+}  // namespace experimental
+}  // namespace rclcpp_action
+
+#endif  // RCLCPP_ACTION__EXPERIMENTAL__COROUTINES_HPP_
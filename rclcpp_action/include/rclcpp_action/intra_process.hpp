@@ -0,0 +1,257 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP_ACTION__INTRA_PROCESS_HPP_
+#define RCLCPP_ACTION__INTRA_PROCESS_HPP_
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "rcl/wait.h"
+#include "rmw/types.h"
+#include "rosidl_runtime_c/action_type_support_struct.h"
+
+#include "rclcpp/context.hpp"
+#include "rclcpp/experimental/intra_process_service_waitable.hpp"
+#include "rclcpp/macros.hpp"
+
+#include "rclcpp_action/visibility_control.hpp"
+
+namespace rclcpp_action
+{
+
+/// Return the name under which an action server registers its intra-process part.
+/**
+ * \param[in] action_name the fully qualified name of the action.
+ * \return the name used with the rclcpp::experimental::IntraProcessServiceManager.
+ */
+RCLCPP_ACTION_PUBLIC
+std::string
+get_intra_process_action_name(const std::string & action_name);
+
+/// Intra-process part of an action client, receiving the messages of a server in the same context.
+/**
+ * The responses, the feedback and the goal statuses are given by pointer by the
+ * ServerIntraProcess of the server, then handed to the client when the executor executes this
+ * waitable.
+ */
+class ClientIntraProcess : public rclcpp::experimental::IntraProcessServiceWaitable
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(ClientIntraProcess)
+
+  enum class MessageType
+  {
+    GoalResponse,
+    CancelResponse,
+    ResultResponse,
+    Feedback,
+    Status,
+  };
+
+  /// Function called with the type of a message, the sequence number of its request and itself.
+  /** The sequence number is only meaningful for the responses. */
+  using MessageCallback = std::function<void (MessageType, int64_t, std::shared_ptr<void>)>;
+
+  /// Create the intra-process part of an action client.
+  /**
+   * \param[in] callback function handing a message to the client.
+   * \param[in] context the context of the client.
+   * \param[in] action_name the fully qualified name of the action.
+   * \param[in] client_id the id identifying the client in the request headers, see
+   *   rclcpp::experimental::IntraProcessServiceManager::reserve_client_id().
+   * \throws std::invalid_argument if the callback is empty.
+   */
+  RCLCPP_ACTION_PUBLIC
+  ClientIntraProcess(
+    MessageCallback callback,
+    rclcpp::Context::SharedPtr context,
+    const std::string & action_name,
+    uint64_t client_id);
+
+  RCLCPP_ACTION_PUBLIC
+  virtual ~ClientIntraProcess() = default;
+
+  /// Return the id identifying this client in the request headers.
+  RCLCPP_ACTION_PUBLIC
+  uint64_t
+  get_client_id() const;
+
+  RCLCPP_ACTION_PUBLIC
+  bool
+  is_ready(rcl_wait_set_t * wait_set) override;
+
+  RCLCPP_ACTION_PUBLIC
+  std::shared_ptr<void>
+  take_data() override;
+
+  RCLCPP_ACTION_PUBLIC
+  void
+  execute(std::shared_ptr<void> & data) override;
+
+  /// Queue a message for the client, can be called from any thread.
+  /**
+   * \param[in] message_type the type of the message.
+   * \param[in] sequence_number the sequence number of the request, for a response.
+   * \param[in] message the message, given as is to the client.
+   */
+  RCLCPP_ACTION_PUBLIC
+  void
+  provide_message(
+    MessageType message_type,
+    int64_t sequence_number,
+    std::shared_ptr<void> message);
+
+private:
+  RCLCPP_DISABLE_COPY(ClientIntraProcess)
+
+  using QueuedMessage = std::tuple<MessageType, int64_t, std::shared_ptr<void>>;
+
+  MessageCallback callback_;
+  const uint64_t client_id_;
+
+  std::mutex messages_mutex_;
+  std::deque<QueuedMessage> messages_;
+};
+
+/// Intra-process part of an action server, receiving the requests of clients in the same context.
+/**
+ * The requests are given by pointer by the clients, then handed to the server when the
+ * executor executes this waitable.
+ * As with rclcpp::experimental::ServiceIntraProcess, the header of an intra-process request has
+ * the sequence number chosen by the client and a writer guid made of the client id, so the
+ * server tells the intra-process requests apart from the ones received from the middleware.
+ *
+ * The clients which sent a request are registered, to give them the goal statuses.
+ */
+class ServerIntraProcess : public rclcpp::experimental::IntraProcessServiceWaitable
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(ServerIntraProcess)
+
+  enum class RequestType
+  {
+    Goal,
+    Cancel,
+    Result,
+  };
+
+  /// Function called with the type of a request, its header and the request.
+  using RequestCallback =
+    std::function<void (RequestType, const rmw_request_id_t &, std::shared_ptr<void>)>;
+
+  /// Create the intra-process part of an action server.
+  /**
+   * \param[in] callback function handing a request to the server.
+   * \param[in] context the context of the server.
+   * \param[in] action_name the fully qualified name of the action.
+   * \param[in] type_support the type support of the action, the clients of other action types
+   *   don't use this server.
+   * \throws std::invalid_argument if the callback is empty.
+   */
+  RCLCPP_ACTION_PUBLIC
+  ServerIntraProcess(
+    RequestCallback callback,
+    rclcpp::Context::SharedPtr context,
+    const std::string & action_name,
+    const rosidl_action_type_support_t * type_support);
+
+  RCLCPP_ACTION_PUBLIC
+  virtual ~ServerIntraProcess() = default;
+
+  /// Return the type support of the action.
+  RCLCPP_ACTION_PUBLIC
+  const rosidl_action_type_support_t *
+  get_type_support() const;
+
+  RCLCPP_ACTION_PUBLIC
+  bool
+  is_ready(rcl_wait_set_t * wait_set) override;
+
+  RCLCPP_ACTION_PUBLIC
+  std::shared_ptr<void>
+  take_data() override;
+
+  RCLCPP_ACTION_PUBLIC
+  void
+  execute(std::shared_ptr<void> & data) override;
+
+  /// Queue the request of a client in the same context, can be called from any thread.
+  /**
+   * \param[in] client the intra-process part of the client, which gets the response.
+   * \param[in] request_type the type of the request.
+   * \param[in] sequence_number the sequence number of the request, unique for the client and
+   *   the type of request.
+   * \param[in] request the request, given as is to the server.
+   */
+  RCLCPP_ACTION_PUBLIC
+  void
+  send_request(
+    const ClientIntraProcess::SharedPtr & client,
+    RequestType request_type,
+    int64_t sequence_number,
+    std::shared_ptr<void> request);
+
+  /// Take the client waiting for the response to a request, if it's an intra-process one.
+  /**
+   * \param[in] request_type the type of the request.
+   * \param[in] request_header the header of the request.
+   * \return the client waiting for the response, which may not exist anymore, or std::nullopt
+   *   if the request was received from the middleware or was already answered.
+   */
+  RCLCPP_ACTION_PUBLIC
+  std::optional<ClientIntraProcess::WeakPtr>
+  take_pending_client(RequestType request_type, const rmw_request_id_t & request_header);
+
+  /// Return the client which sent a request, if it's an intra-process one and still exists.
+  /**
+   * \param[in] request_header the header of the request.
+   * \return the client, or nullptr.
+   */
+  RCLCPP_ACTION_PUBLIC
+  ClientIntraProcess::SharedPtr
+  get_client(const rmw_request_id_t & request_header);
+
+  /// Return the registered clients which still exist.
+  RCLCPP_ACTION_PUBLIC
+  std::vector<ClientIntraProcess::SharedPtr>
+  get_clients();
+
+private:
+  RCLCPP_DISABLE_COPY(ServerIntraProcess)
+
+  using QueuedRequest = std::tuple<RequestType, rmw_request_id_t, std::shared_ptr<void>>;
+  using RequestKey = std::tuple<RequestType, uint64_t, int64_t>;
+
+  RequestCallback callback_;
+  const rosidl_action_type_support_t * type_support_;
+
+  std::mutex mutex_;
+  std::deque<QueuedRequest> requests_;
+  std::map<RequestKey, ClientIntraProcess::WeakPtr> pending_clients_;
+  std::map<uint64_t, ClientIntraProcess::WeakPtr> clients_;
+};
+
+}  // namespace rclcpp_action
+
+#endif  // RCLCPP_ACTION__INTRA_PROCESS_HPP_
@@ -15,20 +15,26 @@
 #ifndef RCLCPP_ACTION__SERVER_HPP_
 #define RCLCPP_ACTION__SERVER_HPP_
 
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
+#include "action_msgs/srv/cancel_goal.hpp"
 #include "rcl/event_callback.h"
 #include "rcl_action/action_server.h"
 #include "rosidl_runtime_c/action_type_support_struct.h"
 #include "rosidl_typesupport_cpp/action_type_support.hpp"
+#include "rclcpp/context.hpp"
 #include "rclcpp/node_interfaces/node_base_interface.hpp"
 #include "rclcpp/node_interfaces/node_clock_interface.hpp"
 #include "rclcpp/node_interfaces/node_logging_interface.hpp"
+#include "rclcpp/serialization.hpp"
+#include "rclcpp/serialized_message.hpp"
 #include "rclcpp/waitable.hpp"
 
 #include "rclcpp_action/visibility_control.hpp"
@@ -177,6 +183,93 @@ public:
   // End Waitables API
   // -----------------
 
+  /// Set the minimum period between two status messages.
+  /**
+   * The goal state changes within the period after a status message are published together in
+   * a single status message at the end of the period.
+   * By default the period is zero and a status message is published on every state change.
+   *
+   * This function is thread-safe.
+   *
+   * \param[in] period the minimum period between two status messages.
+   */
+  RCLCPP_ACTION_PUBLIC
+  void
+  set_status_publish_period(std::chrono::nanoseconds period);
+
+  /// Set the maximum number of goals in a terminal state included in the status messages.
+  /**
+   * Only the goals which most recently reached a terminal state are included, the results of
+   * the others can still be requested until they expire.
+   * By default it is zero and all the goals are included until they expire.
+   *
+   * This function is thread-safe.
+   *
+   * \param[in] max_terminal_goal_statuses the maximum number of terminal goals, 0 for all.
+   */
+  RCLCPP_ACTION_PUBLIC
+  void
+  set_max_terminal_goal_statuses(size_t max_terminal_goal_statuses);
+
+  /// Set the minimum period between two feedback messages of a goal.
+  /**
+   * Only the latest feedback published by a goal within the period after its last feedback
+   * message is kept, and it is published at the end of the period.
+   * Feedback not published yet when the goal reaches a terminal state is published before the
+   * result.
+   * By default the period is zero and all the feedback is published right away.
+   *
+   * This function is thread-safe.
+   *
+   * \param[in] period the minimum period between two feedback messages of a goal.
+   */
+  RCLCPP_ACTION_PUBLIC
+  void
+  set_feedback_publish_period(std::chrono::nanoseconds period);
+
+  /// Statistics of the results retained for the goals in a terminal state.
+  struct ResultRetentionStatistics
+  {
+    /// Number of retained results.
+    size_t retained_results;
+    /// Total serialized size of the retained results measured while a byte limit was set.
+    size_t retained_bytes;
+    /// Number of results evicted to stay within the limits.
+    size_t evicted_results;
+  };
+
+  /// Limit the results retained for the goals in a terminal state.
+  /**
+   * The results are retained until the goal expires, after the result timeout of the server.
+   * Beyond these limits the least recently sent or requested results are evicted early,
+   * except the most recent one.
+   * The result requests for a goal whose result was evicted are answered with the status
+   * `STATUS_UNKNOWN`, as for an expired goal.
+   *
+   * The results are serialized to measure their size only while a byte limit is set.
+   * By default there is no limit.
+   *
+   * This function is thread-safe.
+   *
+   * \param[in] max_results maximum number of retained results, 0 for no limit.
+   * \param[in] max_bytes maximum total serialized size of the retained results, 0 for no limit.
+   */
+  RCLCPP_ACTION_PUBLIC
+  void
+  set_result_retention_limits(size_t max_results, size_t max_bytes = 0);
+
+  /// Return the statistics of the retained results.
+  /** This function is thread-safe. */
+  RCLCPP_ACTION_PUBLIC
+  ResultRetentionStatistics
+  get_result_retention_statistics() const;
+
+  /// Return the waitable receiving the intra-process requests, if intra-process is setup.
+  /// \internal
+  RCLCPP_ACTION_PUBLIC
+  rclcpp::Waitable::SharedPtr
+  get_intra_process_waitable() const;
+
 protected:
   RCLCPP_ACTION_PUBLIC
   ServerBase(
@@ -251,11 +344,26 @@ protected:
   std::shared_ptr<void>
   create_result_response(decltype(action_msgs::msg::GoalStatus::status) status) = 0;
 
+  /// Return the serialized size of a goal result message.
+  /// \internal
+  RCLCPP_ACTION_PUBLIC
+  virtual
+  size_t
+  get_result_response_size(const std::shared_ptr<void> & result_response) const = 0;
+
   /// \internal
   RCLCPP_ACTION_PUBLIC
   void
   publish_status();
 
+  /// Record the new state of a goal and publish the goal statuses.
+  /// \internal
+  RCLCPP_ACTION_PUBLIC
+  void
+  update_goal_status(
+    const GoalUUID & uuid,
+    decltype(action_msgs::msg::GoalStatus::status) status);
+
   /// \internal
   RCLCPP_ACTION_PUBLIC
   void
@@ -269,7 +377,20 @@ protected:
   /// \internal
   RCLCPP_ACTION_PUBLIC
   void
-  publish_feedback(std::shared_ptr<void> feedback_msg);
+  publish_feedback(const GoalUUID & uuid, std::shared_ptr<void> feedback_msg);
+
+  /// Receive by pointer the requests of the clients in the same context.
+  /// \internal
+  /**
+   * \sa Server::setup_intra_process()
+   *
+   * \param[in] context the context of the node of the server.
+   * \param[in] weak_this the server itself, the requests are dropped once it's destroyed.
+   * \throws std::runtime_error if intra-process communication is already setup.
+   */
+  RCLCPP_ACTION_PUBLIC
+  void
+  setup_intra_process(rclcpp::Context::SharedPtr context, std::weak_ptr<ServerBase> weak_this);
 
   // End API for communication between ServerBase and Server<>
   // ---------------------------------------------------------
@@ -299,6 +420,32 @@ private:
   void
   execute_check_expired_goals();
 
+  /// Handle a goal request received from the middleware or from a client in the same context
+  /// \internal
+  RCLCPP_ACTION_PUBLIC
+  void
+  handle_goal_request(rmw_request_id_t & request_header, std::shared_ptr<void> message);
+
+  /// Handle a cancel request received from the middleware or from a client in the same context
+  /// \internal
+  RCLCPP_ACTION_PUBLIC
+  void
+  handle_cancel_request(
+    rmw_request_id_t & request_header,
+    std::shared_ptr<action_msgs::srv::CancelGoal::Request> request);
+
+  /// Handle a result request received from the middleware or from a client in the same context
+  /// \internal
+  RCLCPP_ACTION_PUBLIC
+  void
+  handle_result_request(rmw_request_id_t & request_header, std::shared_ptr<void> result_request);
+
+  /// Replace the evicted results of goals by an unknown goal response
+  /// \internal
+  RCLCPP_ACTION_PUBLIC
+  void
+  evict_results(const std::vector<GoalUUID> & evicted);
+
   /// Private implementation
   /// \internal
   std::unique_ptr<ServerBaseImpl> pimpl_;
@@ -402,6 +549,24 @@ public:
 
   virtual ~Server() = default;
 
+  /// Receive by pointer the requests of the clients in the same context.
+  /**
+   * Called by rclcpp_action::create_server() when the node uses intra-process communication.
+   * The clients of the same context using intra-process communication then give their
+   * requests by pointer, and get the responses, their feedback and the goal statuses without
+   * going through the middleware.
+   * The requests of the other clients are received from the middleware as usual, and the goal
+   * statuses are still published for them.
+   *
+   * \param[in] context the context of the node of the server.
+   * \throws std::runtime_error if intra-process communication is already setup.
+   */
+  void
+  setup_intra_process(rclcpp::Context::SharedPtr context)
+  {
+    ServerBase::setup_intra_process(context, this->shared_from_this());
+  }
+
 protected:
   // -----------------------------------------------------
   // API for communication between ServerBase and Server<>
@@ -470,7 +635,9 @@ protected:
         // Send result message to anyone that asked
         shared_this->publish_result(goal_uuid, result_message);
         // Publish a status message any time a goal handle changes state
-        shared_this->publish_status();
+        auto result_response = std::static_pointer_cast<
+          typename ActionT::Impl::GetResultService::Response>(result_message);
+        shared_this->update_goal_status(goal_uuid, result_response->status);
         // notify base so it can recalculate the expired goal timer
         shared_this->notify_goal_terminal_state();
         // Delete data now (ServerBase and rcl_action_server_t keep data until goal handle expires)
@@ -485,9 +652,9 @@ protected:
         if (!shared_this) {
           return;
         }
-        (void)goal_uuid;
         // Publish a status message any time a goal handle changes state
-        shared_this->publish_status();
+        shared_this->update_goal_status(
+          goal_uuid, action_msgs::msg::GoalStatus::STATUS_EXECUTING);
       };
 
     std::function<void(std::shared_ptr<typename ActionT::Impl::FeedbackMessage>)> publish_feedback =
@@ -497,7 +664,8 @@ protected:
         if (!shared_this) {
           return;
         }
-        shared_this->publish_feedback(std::static_pointer_cast<void>(feedback_msg));
+        shared_this->publish_feedback(
+          feedback_msg->goal_id.uuid, std::static_pointer_cast<void>(feedback_msg));
       };
 
     auto request = std::static_pointer_cast<
@@ -552,6 +720,17 @@ protected:
     return std::static_pointer_cast<void>(result);
   }
 
+  /// \internal
+  size_t
+  get_result_response_size(const std::shared_ptr<void> & result_response) const override
+  {
+    using GoalResultResponse = typename ActionT::Impl::GetResultService::Response;
+    rclcpp::Serialization<GoalResultResponse> serialization;
+    rclcpp::SerializedMessage serialized_result;
+    serialization.serialize_message(result_response.get(), &serialized_result);
+    return serialized_result.size();
+  }
+
   // End API for communication between ServerBase and Server<>
   // ---------------------------------------------------------
 
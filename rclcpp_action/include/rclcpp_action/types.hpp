@@ -16,7 +16,8 @@
 #define RCLCPP_ACTION__TYPES_HPP_
 
 #include <array>
-#include <climits>
+#include <cstdint>
+#include <cstring>
 #include <functional>
 #include <string>
 
@@ -69,16 +70,24 @@ struct hash<rclcpp_action::GoalUUID>
 {
   size_t operator()(const rclcpp_action::GoalUUID & uuid) const noexcept
   {
-    // TODO(sloretz) Use someone else's hash function and cite it
-    size_t result = 0;
-    for (size_t i = 0; i < uuid.size(); ++i) {
-      for (size_t b = 0; b < sizeof(size_t); ++b) {
-        size_t part = uuid[i];
-        part <<= CHAR_BIT * b;
-        result ^= part;
-      }
-    }
-    return result;
+    // Mix the two 64 bit halves of the id with the finalizer of MurmurHash3, so that every bit
+    // of the id affects every bit of the hash.
+    // See https://github.com/aappleby/smhasher/blob/master/src/MurmurHash3.cpp
+    auto mix = [](uint64_t k)
+      {
+        k ^= k >> 33;
+        k *= 0xff51afd7ed558ccdULL;
+        k ^= k >> 33;
+        k *= 0xc4ceb9fe1a85ec53ULL;
+        k ^= k >> 33;
+        return k;
+      };
+    uint64_t low;
+    uint64_t high;
+    static_assert(sizeof(low) + sizeof(high) == UUID_SIZE, "unexpected goal id size");
+    std::memcpy(&low, uuid.data(), sizeof(low));
+    std::memcpy(&high, uuid.data() + sizeof(low), sizeof(high));
+    return static_cast<size_t>(mix(low ^ mix(high)));
   }
 };
 }  // namespace std
@@ -13,8 +13,9 @@
 // limitations under the License.
 
 #include <algorithm>
-#include <map>
+#include <functional>
 #include <memory>
+#include <optional>
 #include <random>
 #include <string>
 #include <tuple>
@@ -22,11 +23,15 @@
 
 #include "rcl_action/action_client.h"
 #include "rcl_action/wait.h"
+#include "rclcpp/detail/sequence_number_table.hpp"
+#include "rclcpp/expand_topic_or_service_name.hpp"
+#include "rclcpp/experimental/intra_process_service_manager.hpp"
 #include "rclcpp/node_interfaces/node_base_interface.hpp"
 #include "rclcpp/node_interfaces/node_logging_interface.hpp"
 
 #include "rclcpp_action/client.hpp"
 #include "rclcpp_action/exceptions.hpp"
+#include "rclcpp_action/intra_process.hpp"
 
 namespace rclcpp_action
 {
@@ -44,6 +49,7 @@ public:
   : node_graph_(node_graph),
     node_handle(node_base->get_shared_rcl_node_handle()),
     logger(node_logging->get_logger().get_child("rclcpp_action")),
+    action_type_support(type_support),
     random_bytes_generator(std::random_device{}())
   {
     std::weak_ptr<rcl_node_t> weak_node_handle(node_handle);
@@ -86,6 +92,12 @@ public:
       rclcpp::exceptions::throw_from_rcl_error(
         ret, "could not retrieve rcl action client details");
     }
+
+    goal_service_name = rclcpp::expand_topic_or_service_name(
+      action_name,
+      rcl_node_get_name(node_handle.get()),
+      rcl_node_get_namespace(node_handle.get()),
+      true) + "/_action/send_goal";
   }
 
   size_t num_subscriptions{0u};
@@ -106,18 +118,106 @@ public:
   std::shared_ptr<rcl_node_t> node_handle{nullptr};
   std::shared_ptr<rcl_action_client_t> client_handle{nullptr};
   rclcpp::Logger logger;
+  // Groups the clients of the action waiting in wait_for_action_server()
+  std::string goal_service_name;
 
   using ResponseCallback = std::function<void (std::shared_ptr<void> response)>;
-
-  std::map<int64_t, ResponseCallback> pending_goal_responses;
+  using GoalResponseCallback =
+    std::function<void (std::shared_ptr<void> response, bool is_intra_process)>;
+
+  // Indexed by sequence number, so looking up a response costs constant time.
+  // The intra-process requests have negative ids and are indexed by the opposite of their id.
+  rclcpp::detail::SequenceNumberTable<GoalResponseCallback> pending_goal_responses;
+  rclcpp::detail::SequenceNumberTable<GoalResponseCallback> pending_intra_process_goal_responses;
+  int64_t next_intra_process_goal_request_id{-1};
   std::mutex goal_requests_mutex;
 
-  std::map<int64_t, ResponseCallback> pending_result_responses;
+  rclcpp::detail::SequenceNumberTable<ResponseCallback> pending_result_responses;
+  rclcpp::detail::SequenceNumberTable<ResponseCallback> pending_intra_process_result_responses;
+  int64_t next_intra_process_result_request_id{-1};
   std::mutex result_requests_mutex;
 
-  std::map<int64_t, ResponseCallback> pending_cancel_responses;
+  rclcpp::detail::SequenceNumberTable<ResponseCallback> pending_cancel_responses;
+  rclcpp::detail::SequenceNumberTable<ResponseCallback> pending_intra_process_cancel_responses;
+  int64_t next_intra_process_cancel_request_id{-1};
   std::mutex cancel_requests_mutex;
 
+  const rosidl_action_type_support_t * action_type_support;
+
+  // Set before the client is added to an executor, when its node uses intra-process
+  // communication
+  ClientIntraProcess::SharedPtr intra_process;
+  std::weak_ptr<rclcpp::experimental::IntraProcessServiceManager> weak_ipsm;
+  std::mutex intra_process_server_mutex;
+  std::weak_ptr<ServerIntraProcess> intra_process_server;
+  uint64_t intra_process_server_generation{0};
+
+  // Return the intra-process action server with the name and type of this client, if any.
+  // It's only looked up again when services were added to or removed from the context.
+  ServerIntraProcess::SharedPtr
+  get_intra_process_server()
+  {
+    if (!intra_process) {
+      return nullptr;
+    }
+    auto ipsm = weak_ipsm.lock();
+    if (!ipsm) {
+      return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(intra_process_server_mutex);
+    const uint64_t generation = ipsm->get_generation();
+    if (generation != intra_process_server_generation) {
+      auto server = std::dynamic_pointer_cast<ServerIntraProcess>(
+        ipsm->get_service(intra_process->get_service_name()));
+      // A server of another action type doesn't get the requests
+      if (server && server->get_type_support() != action_type_support) {
+        server.reset();
+      }
+      intra_process_server = server;
+      intra_process_server_generation = generation;
+    }
+    return intra_process_server.lock();
+  }
+
+  // Send a request by pointer to an action server in the same context, if there is one
+  template<typename CallbackT>
+  bool
+  send_intra_process_request(
+    ServerIntraProcess::RequestType request_type,
+    std::mutex & requests_mutex,
+    rclcpp::detail::SequenceNumberTable<CallbackT> & pending_responses,
+    int64_t & next_request_id,
+    const std::shared_ptr<void> & request,
+    const CallbackT & callback)
+  {
+    auto server = get_intra_process_server();
+    if (!server) {
+      return false;
+    }
+    int64_t request_id;
+    {
+      std::lock_guard<std::mutex> guard(requests_mutex);
+      request_id = next_request_id--;
+      const bool inserted = pending_responses.emplace(-request_id, callback);
+      assert(inserted);
+      (void)inserted;
+    }
+    // Registered first, as the response can be given from another thread right away
+    server->send_request(intra_process, request_type, request_id, request);
+    return true;
+  }
+
+  template<typename CallbackT>
+  static std::optional<CallbackT>
+  take_intra_process_response(
+    std::mutex & requests_mutex,
+    rclcpp::detail::SequenceNumberTable<CallbackT> & pending_responses,
+    int64_t request_id)
+  {
+    std::lock_guard<std::mutex> guard(requests_mutex);
+    return pending_responses.take(-request_id);
+  }
+
   std::independent_bits_engine<
     std::default_random_engine, 8, unsigned int> random_bytes_generator;
 };
@@ -172,7 +272,6 @@ ClientBase::wait_for_action_server_nanoseconds(std::chrono::nanoseconds timeout)
   if (this->action_server_is_ready()) {
     return true;
   }
-  auto event = node_ptr->get_graph_event();
   if (timeout == std::chrono::nanoseconds(0)) {
     // check was non-blocking, return immediately
     return false;
@@ -188,6 +287,10 @@ ClientBase::wait_for_action_server_nanoseconds(std::chrono::nanoseconds timeout)
     // Setting time_to_wait to 0 will allow one non-blocking wait because of the do-while.
     time_to_wait = std::chrono::nanoseconds(0);
   }
+  // The waiters of the same service share the readiness checks done after the graph changes
+  const std::function<bool()> is_ready = [this]() {
+      return this->action_server_is_ready();
+    };
   do {
     if (!rclcpp::ok(this->pimpl_->context_)) {
       return false;
@@ -199,12 +302,13 @@ ClientBase::wait_for_action_server_nanoseconds(std::chrono::nanoseconds timeout)
     // If no other graph events occur, the wait set will not be triggered again until the timeout
     // has been reached, despite the service being available, so we artificially limit the wait
     // time to limit the delay.
-    node_ptr->wait_for_graph_change(
-      event, std::min(time_to_wait, std::chrono::nanoseconds(RCL_MS_TO_NS(100))));
-    // Because of the aforementioned race condition, we check if the service is ready even if the
-    // graph event wasn't triggered.
-    event->check_and_clear();
-    if (this->action_server_is_ready()) {
+    // Because of the aforementioned race condition, the service is checked again on each call
+    // even if no graph change occurred.
+    if (
+      node_ptr->wait_for_service_ready(
+        pimpl_->goal_service_name, is_ready,
+        std::min(time_to_wait, std::chrono::nanoseconds(RCL_MS_TO_NS(100)))))
+    {
       return true;
     }
     // server is not ready, loop if there is time left
@@ -289,19 +393,29 @@ ClientBase::handle_goal_response(
   const rmw_request_id_t & response_header,
   std::shared_ptr<void> response)
 {
-  std::lock_guard<std::mutex> guard(pimpl_->goal_requests_mutex);
-  const int64_t & sequence_number = response_header.sequence_number;
-  if (pimpl_->pending_goal_responses.count(sequence_number) == 0) {
+  std::optional<GoalResponseCallback> callback;
+  {
+    std::lock_guard<std::mutex> guard(pimpl_->goal_requests_mutex);
+    callback = pimpl_->pending_goal_responses.take(response_header.sequence_number);
+  }
+  if (!callback) {
     RCLCPP_ERROR(pimpl_->logger, "unknown goal response, ignoring...");
     return;
   }
-  pimpl_->pending_goal_responses[sequence_number](response);
-  pimpl_->pending_goal_responses.erase(sequence_number);
+  (*callback)(response, false);
 }
 
 void
-ClientBase::send_goal_request(std::shared_ptr<void> request, ResponseCallback callback)
+ClientBase::send_goal_request(std::shared_ptr<void> request, GoalResponseCallback callback)
 {
+  if (
+    pimpl_->send_intra_process_request(
+      ServerIntraProcess::RequestType::Goal, pimpl_->goal_requests_mutex,
+      pimpl_->pending_intra_process_goal_responses,
+      pimpl_->next_intra_process_goal_request_id, request, callback))
+  {
+    return;
+  }
   std::unique_lock<std::mutex> guard(pimpl_->goal_requests_mutex);
   int64_t sequence_number;
   rcl_ret_t ret = rcl_action_send_goal_request(
@@ -309,8 +423,9 @@ ClientBase::send_goal_request(std::shared_ptr<void> request, ResponseCallback ca
   if (RCL_RET_OK != ret) {
     rclcpp::exceptions::throw_from_rcl_error(ret, "failed to send goal request");
   }
-  assert(pimpl_->pending_goal_responses.count(sequence_number) == 0);
-  pimpl_->pending_goal_responses[sequence_number] = callback;
+  const bool inserted = pimpl_->pending_goal_responses.emplace(sequence_number, callback);
+  assert(inserted);
+  (void)inserted;
 }
 
 void
@@ -318,19 +433,29 @@ ClientBase::handle_result_response(
   const rmw_request_id_t & response_header,
   std::shared_ptr<void> response)
 {
-  std::lock_guard<std::mutex> guard(pimpl_->result_requests_mutex);
-  const int64_t & sequence_number = response_header.sequence_number;
-  if (pimpl_->pending_result_responses.count(sequence_number) == 0) {
+  std::optional<ResponseCallback> callback;
+  {
+    std::lock_guard<std::mutex> guard(pimpl_->result_requests_mutex);
+    callback = pimpl_->pending_result_responses.take(response_header.sequence_number);
+  }
+  if (!callback) {
     RCLCPP_ERROR(pimpl_->logger, "unknown result response, ignoring...");
     return;
   }
-  pimpl_->pending_result_responses[sequence_number](response);
-  pimpl_->pending_result_responses.erase(sequence_number);
+  (*callback)(response);
 }
 
 void
 ClientBase::send_result_request(std::shared_ptr<void> request, ResponseCallback callback)
 {
+  if (
+    pimpl_->send_intra_process_request(
+      ServerIntraProcess::RequestType::Result, pimpl_->result_requests_mutex,
+      pimpl_->pending_intra_process_result_responses,
+      pimpl_->next_intra_process_result_request_id, request, callback))
+  {
+    return;
+  }
   std::lock_guard<std::mutex> guard(pimpl_->result_requests_mutex);
   int64_t sequence_number;
   rcl_ret_t ret = rcl_action_send_result_request(
@@ -338,8 +463,9 @@ ClientBase::send_result_request(std::shared_ptr<void> request, ResponseCallback
   if (RCL_RET_OK != ret) {
     rclcpp::exceptions::throw_from_rcl_error(ret, "failed to send result request");
   }
-  assert(pimpl_->pending_result_responses.count(sequence_number) == 0);
-  pimpl_->pending_result_responses[sequence_number] = callback;
+  const bool inserted = pimpl_->pending_result_responses.emplace(sequence_number, callback);
+  assert(inserted);
+  (void)inserted;
 }
 
 void
@@ -347,19 +473,29 @@ ClientBase::handle_cancel_response(
   const rmw_request_id_t & response_header,
   std::shared_ptr<void> response)
 {
-  std::lock_guard<std::mutex> guard(pimpl_->cancel_requests_mutex);
-  const int64_t & sequence_number = response_header.sequence_number;
-  if (pimpl_->pending_cancel_responses.count(sequence_number) == 0) {
+  std::optional<ResponseCallback> callback;
+  {
+    std::lock_guard<std::mutex> guard(pimpl_->cancel_requests_mutex);
+    callback = pimpl_->pending_cancel_responses.take(response_header.sequence_number);
+  }
+  if (!callback) {
     RCLCPP_ERROR(pimpl_->logger, "unknown cancel response, ignoring...");
     return;
   }
-  pimpl_->pending_cancel_responses[sequence_number](response);
-  pimpl_->pending_cancel_responses.erase(sequence_number);
+  (*callback)(response);
 }
 
 void
 ClientBase::send_cancel_request(std::shared_ptr<void> request, ResponseCallback callback)
 {
+  if (
+    pimpl_->send_intra_process_request(
+      ServerIntraProcess::RequestType::Cancel, pimpl_->cancel_requests_mutex,
+      pimpl_->pending_intra_process_cancel_responses,
+      pimpl_->next_intra_process_cancel_request_id, request, callback))
+  {
+    return;
+  }
   std::lock_guard<std::mutex> guard(pimpl_->cancel_requests_mutex);
   int64_t sequence_number;
   rcl_ret_t ret = rcl_action_send_cancel_request(
@@ -367,8 +503,88 @@ ClientBase::send_cancel_request(std::shared_ptr<void> request, ResponseCallback
   if (RCL_RET_OK != ret) {
     rclcpp::exceptions::throw_from_rcl_error(ret, "failed to send cancel request");
   }
-  assert(pimpl_->pending_cancel_responses.count(sequence_number) == 0);
-  pimpl_->pending_cancel_responses[sequence_number] = callback;
+  const bool inserted = pimpl_->pending_cancel_responses.emplace(sequence_number, callback);
+  assert(inserted);
+  (void)inserted;
+}
+
+void
+ClientBase::setup_intra_process(
+  rclcpp::Context::SharedPtr context,
+  std::weak_ptr<ClientBase> weak_this)
+{
+  if (pimpl_->intra_process) {
+    throw std::runtime_error(
+            "intra-process communication is already setup for this action client");
+  }
+  using rclcpp::experimental::IntraProcessServiceManager;
+  auto ipsm = context->get_sub_context<IntraProcessServiceManager>();
+  pimpl_->intra_process = std::make_shared<ClientIntraProcess>(
+    [weak_this](
+      ClientIntraProcess::MessageType message_type,
+      int64_t request_id,
+      std::shared_ptr<void> message)
+    {
+      auto client = weak_this.lock();
+      if (client) {
+        client->handle_intra_process_message(message_type, request_id, std::move(message));
+      }
+    },
+    context,
+    rcl_action_client_get_action_name(pimpl_->client_handle.get()),
+    ipsm->reserve_client_id());
+  pimpl_->weak_ipsm = ipsm;
+}
+
+rclcpp::Waitable::SharedPtr
+ClientBase::get_intra_process_waitable() const
+{
+  return pimpl_->intra_process;
+}
+
+void
+ClientBase::handle_intra_process_message(
+  ClientIntraProcess::MessageType message_type,
+  int64_t request_id,
+  std::shared_ptr<void> message)
+{
+  switch (message_type) {
+    case ClientIntraProcess::MessageType::GoalResponse:
+      {
+        auto callback = ClientBaseImpl::take_intra_process_response(
+          pimpl_->goal_requests_mutex, pimpl_->pending_intra_process_goal_responses, request_id);
+        if (callback) {
+          (*callback)(message, true);
+        }
+        break;
+      }
+    case ClientIntraProcess::MessageType::CancelResponse:
+      {
+        auto callback = ClientBaseImpl::take_intra_process_response(
+          pimpl_->cancel_requests_mutex, pimpl_->pending_intra_process_cancel_responses,
+          request_id);
+        if (callback) {
+          (*callback)(message);
+        }
+        break;
+      }
+    case ClientIntraProcess::MessageType::ResultResponse:
+      {
+        auto callback = ClientBaseImpl::take_intra_process_response(
+          pimpl_->result_requests_mutex, pimpl_->pending_intra_process_result_responses,
+          request_id);
+        if (callback) {
+          (*callback)(message);
+        }
+        break;
+      }
+    case ClientIntraProcess::MessageType::Feedback:
+      handle_feedback_message(message);
+      break;
+    case ClientIntraProcess::MessageType::Status:
+      handle_status_message(message, true);
+      break;
+  }
 }
 
 GoalUUID
@@ -636,7 +852,7 @@ ClientBase::execute(std::shared_ptr<void> & data)
     pimpl_->is_status_ready = false;
     if (RCL_RET_OK == ret) {
       auto status_message = std::get<1>(*shared_ptr);
-      this->handle_status_message(status_message);
+      this->handle_status_message(status_message, false);
     } else if (RCL_RET_ACTION_CLIENT_TAKE_FAILED != ret) {
       rclcpp::exceptions::throw_from_rcl_error(ret, "error taking status");
     }
@@ -0,0 +1,253 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "rclcpp_action/intra_process.hpp"
+
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using rclcpp_action::ClientIntraProcess;
+using rclcpp_action::ServerIntraProcess;
+
+namespace
+{
+
+// Tells the headers of the intra-process requests apart from the ones of the middleware
+constexpr char kActionRequestMarker[] = {'r', 'c', 'l', 'a', 'c', 't', 'i', 'p'};
+static_assert(
+  sizeof(rmw_request_id_t::writer_guid) >= sizeof(uint64_t) + sizeof(kActionRequestMarker),
+  "the writer guid can't hold the client id and the marker");
+
+bool
+get_intra_process_client_id(const rmw_request_id_t & request_header, uint64_t * client_id)
+{
+  if (
+    std::memcmp(
+      request_header.writer_guid + sizeof(uint64_t), kActionRequestMarker,
+      sizeof(kActionRequestMarker)) != 0)
+  {
+    return false;
+  }
+  std::memcpy(client_id, request_header.writer_guid, sizeof(*client_id));
+  return true;
+}
+
+}  // namespace
+
+std::string
+rclcpp_action::get_intra_process_action_name(const std::string & action_name)
+{
+  // The namespace of the action services, which no other service is expected to be named after
+  return action_name + "/_action";
+}
+
+ClientIntraProcess::ClientIntraProcess(
+  MessageCallback callback,
+  rclcpp::Context::SharedPtr context,
+  const std::string & action_name,
+  uint64_t client_id)
+: IntraProcessServiceWaitable(
+    context, get_intra_process_action_name(action_name), EntityType::Client),
+  callback_(std::move(callback)),
+  client_id_(client_id)
+{
+  if (!callback_) {
+    throw std::invalid_argument("intra-process action client callback cannot be empty");
+  }
+}
+
+uint64_t
+ClientIntraProcess::get_client_id() const
+{
+  return client_id_;
+}
+
+bool
+ClientIntraProcess::is_ready(rcl_wait_set_t * wait_set)
+{
+  (void) wait_set;
+  std::lock_guard<std::mutex> lock(messages_mutex_);
+  return !messages_.empty();
+}
+
+std::shared_ptr<void>
+ClientIntraProcess::take_data()
+{
+  std::lock_guard<std::mutex> lock(messages_mutex_);
+  if (messages_.empty()) {
+    return nullptr;
+  }
+  auto message = std::make_shared<QueuedMessage>(std::move(messages_.front()));
+  messages_.pop_front();
+  return message;
+}
+
+void
+ClientIntraProcess::execute(std::shared_ptr<void> & data)
+{
+  if (!data) {
+    return;
+  }
+  auto message = std::static_pointer_cast<QueuedMessage>(data);
+  callback_(std::get<0>(*message), std::get<1>(*message), std::move(std::get<2>(*message)));
+}
+
+void
+ClientIntraProcess::provide_message(
+  MessageType message_type,
+  int64_t sequence_number,
+  std::shared_ptr<void> message)
+{
+  {
+    std::lock_guard<std::mutex> lock(messages_mutex_);
+    messages_.emplace_back(message_type, sequence_number, std::move(message));
+  }
+  notify_ready();
+}
+
+ServerIntraProcess::ServerIntraProcess(
+  RequestCallback callback,
+  rclcpp::Context::SharedPtr context,
+  const std::string & action_name,
+  const rosidl_action_type_support_t * type_support)
+: IntraProcessServiceWaitable(
+    context, get_intra_process_action_name(action_name), EntityType::Service),
+  callback_(std::move(callback)),
+  type_support_(type_support)
+{
+  if (!callback_) {
+    throw std::invalid_argument("intra-process action server callback cannot be empty");
+  }
+}
+
+const rosidl_action_type_support_t *
+ServerIntraProcess::get_type_support() const
+{
+  return type_support_;
+}
+
+bool
+ServerIntraProcess::is_ready(rcl_wait_set_t * wait_set)
+{
+  (void) wait_set;
+  std::lock_guard<std::mutex> lock(mutex_);
+  return !requests_.empty();
+}
+
+std::shared_ptr<void>
+ServerIntraProcess::take_data()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (requests_.empty()) {
+    return nullptr;
+  }
+  auto request = std::make_shared<QueuedRequest>(std::move(requests_.front()));
+  requests_.pop_front();
+  return request;
+}
+
+void
+ServerIntraProcess::execute(std::shared_ptr<void> & data)
+{
+  if (!data) {
+    return;
+  }
+  auto request = std::static_pointer_cast<QueuedRequest>(data);
+  callback_(std::get<0>(*request), std::get<1>(*request), std::move(std::get<2>(*request)));
+}
+
+void
+ServerIntraProcess::send_request(
+  const ClientIntraProcess::SharedPtr & client,
+  RequestType request_type,
+  int64_t sequence_number,
+  std::shared_ptr<void> request)
+{
+  rmw_request_id_t request_header;
+  std::memset(request_header.writer_guid, 0, sizeof(request_header.writer_guid));
+  const uint64_t client_id = client->get_client_id();
+  std::memcpy(request_header.writer_guid, &client_id, sizeof(client_id));
+  std::memcpy(
+    request_header.writer_guid + sizeof(client_id), kActionRequestMarker,
+    sizeof(kActionRequestMarker));
+  request_header.sequence_number = sequence_number;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    clients_[client_id] = client;
+    pending_clients_.emplace(RequestKey(request_type, client_id, sequence_number), client);
+    requests_.emplace_back(request_type, request_header, std::move(request));
+  }
+  notify_ready();
+}
+
+std::optional<ClientIntraProcess::WeakPtr>
+ServerIntraProcess::take_pending_client(
+  RequestType request_type,
+  const rmw_request_id_t & request_header)
+{
+  // Only the intra-process requests have the marker, the others don't need the lock
+  uint64_t client_id;
+  if (!get_intra_process_client_id(request_header, &client_id)) {
+    return std::nullopt;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = pending_clients_.find(
+    RequestKey(request_type, client_id, request_header.sequence_number));
+  if (it == pending_clients_.end()) {
+    return std::nullopt;
+  }
+  auto client = std::move(it->second);
+  pending_clients_.erase(it);
+  return client;
+}
+
+ClientIntraProcess::SharedPtr
+ServerIntraProcess::get_client(const rmw_request_id_t & request_header)
+{
+  uint64_t client_id;
+  if (!get_intra_process_client_id(request_header, &client_id)) {
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = clients_.find(client_id);
+  if (it == clients_.end()) {
+    return nullptr;
+  }
+  return it->second.lock();
+}
+
+std::vector<ClientIntraProcess::SharedPtr>
+ServerIntraProcess::get_clients()
+{
+  std::vector<ClientIntraProcess::SharedPtr> clients;
+  std::lock_guard<std::mutex> lock(mutex_);
+  clients.reserve(clients_.size());
+  for (auto it = clients_.begin(); it != clients_.end(); ) {
+    auto client = it->second.lock();
+    if (client) {
+      clients.push_back(std::move(client));
+      ++it;
+    } else {
+      // The clients destroyed since the last call are forgotten
+      it = clients_.erase(it);
+    }
+  }
+  return clients;
+}
@@ -12,9 +12,16 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <list>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <unordered_map>
 #include <utility>
@@ -28,10 +35,14 @@
 #include "action_msgs/msg/goal_status_array.hpp"
 #include "action_msgs/srv/cancel_goal.hpp"
 #include "rclcpp/exceptions.hpp"
+#include "rclcpp/experimental/intra_process_service_manager.hpp"
+#include "rclcpp_action/intra_process.hpp"
 #include "rclcpp_action/server.hpp"
 
 using rclcpp_action::ServerBase;
 using rclcpp_action::GoalUUID;
+using rclcpp_action::ClientIntraProcess;
+using rclcpp_action::ServerIntraProcess;
 
 namespace rclcpp_action
 {
@@ -46,8 +57,11 @@ public:
   {
   }
 
-  // Lock for action_server_
-  std::recursive_mutex action_server_reentrant_mutex_;
+  // Lock for the goals and the wait set indices of action_server_, which aren't thread-safe.
+  // Only rcl_action calls are made with it, so no other lock is ever taken while holding it.
+  // Its entities are thread-safe, so taking requests, sending responses and publishing don't
+  // need it.
+  std::mutex action_server_mutex_;
 
   rclcpp::Clock::SharedPtr clock_;
 
@@ -60,20 +74,503 @@ public:
   size_t num_services_ = 0;
   size_t num_guard_conditions_ = 0;
 
+  const rosidl_action_type_support_t * type_support_ = nullptr;
+
+  // Set before the server is added to an executor, when its node uses intra-process
+  // communication
+  ServerIntraProcess::SharedPtr intra_process_;
+  std::weak_ptr<rclcpp::experimental::IntraProcessServiceManager> weak_ipsm_;
+  uint64_t intra_process_service_id_ = 0;
+
   std::atomic<bool> goal_request_ready_{false};
   std::atomic<bool> cancel_request_ready_{false};
   std::atomic<bool> result_request_ready_{false};
   std::atomic<bool> goal_expired_{false};
 
-  // Lock for unordered_maps
-  std::recursive_mutex unordered_map_mutex_;
+  // Lock for the goal statuses, the pending feedback and the state of the publish thread
+  std::mutex publish_state_mutex_;
+  // Serializes the status messages, so an older status is never published after a newer one
+  std::mutex status_publish_mutex_;
+
+  // Statuses of the goals, updated on each state change instead of being rebuilt for each
+  // status message.
+  // A goal moves from the active list, in the order of acceptance, to the terminal list, in the
+  // order of completion, when it reaches a terminal state.
+  std::list<action_msgs::msg::GoalStatus> active_goal_statuses_;
+  std::list<action_msgs::msg::GoalStatus> terminal_goal_statuses_;
+  struct GoalStatusEntry
+  {
+    std::list<action_msgs::msg::GoalStatus>::iterator status;
+    bool is_terminal;
+  };
+  std::unordered_map<GoalUUID, GoalStatusEntry> goal_statuses_;
+  // The oldest terminal goals are left out of the status messages beyond this count, 0 for all
+  size_t max_terminal_goal_statuses_ = 0;
+
+  // State changes within the period after a status message are published together at its end
+  std::chrono::nanoseconds status_publish_period_{0};
+  std::chrono::steady_clock::time_point last_status_publish_;
+  bool is_status_publish_pending_ = false;
+
+  // The feedback of a goal is published at most once per period, the latest message published
+  // at the end of the period replaces the ones received within it
+  std::atomic<std::chrono::nanoseconds> feedback_publish_period_{std::chrono::nanoseconds(0)};
+  struct FeedbackState
+  {
+    std::chrono::steady_clock::time_point last_publish;
+    std::shared_ptr<void> pending_feedback;
+  };
+  std::unordered_map<GoalUUID, FeedbackState> feedback_states_;
+
+  // Publishes the status messages and the feedback deferred to the end of their period
+  bool is_publish_thread_stopped_ = false;
+  std::condition_variable publish_condition_;
+  std::thread publish_thread_;
+
+  static bool
+  is_terminal_status(decltype(action_msgs::msg::GoalStatus::status) status)
+  {
+    return action_msgs::msg::GoalStatus::STATUS_SUCCEEDED == status ||
+           action_msgs::msg::GoalStatus::STATUS_CANCELED == status ||
+           action_msgs::msg::GoalStatus::STATUS_ABORTED == status;
+  }
+
+  void
+  add_goal_status(
+    const rcl_action_goal_info_t & goal_info,
+    decltype(action_msgs::msg::GoalStatus::status) status)
+  {
+    action_msgs::msg::GoalStatus status_msg;
+    status_msg.status = status;
+    convert(goal_info, &status_msg.goal_info.goal_id.uuid);
+    status_msg.goal_info.stamp.sec = goal_info.stamp.sec;
+    status_msg.goal_info.stamp.nanosec = goal_info.stamp.nanosec;
+
+    std::lock_guard<std::mutex> lock(publish_state_mutex_);
+    auto iter = active_goal_statuses_.insert(active_goal_statuses_.end(), status_msg);
+    goal_statuses_[status_msg.goal_info.goal_id.uuid] = {iter, false};
+  }
+
+  void
+  update_goal_status(
+    const GoalUUID & uuid,
+    decltype(action_msgs::msg::GoalStatus::status) status)
+  {
+    std::lock_guard<std::mutex> lock(publish_state_mutex_);
+    auto entry = goal_statuses_.find(uuid);
+    // A terminal state is final, even if a cancel request was processed concurrently
+    if (entry == goal_statuses_.end() || entry->second.is_terminal) {
+      return;
+    }
+    entry->second.status->status = status;
+    if (!is_terminal_status(status)) {
+      return;
+    }
+    // Splicing keeps the iterator valid
+    terminal_goal_statuses_.splice(
+      terminal_goal_statuses_.end(), active_goal_statuses_, entry->second.status);
+    entry->second.is_terminal = true;
+    trim_terminal_goal_statuses();
+  }
+
+  void
+  remove_goal_status(const GoalUUID & uuid)
+  {
+    std::lock_guard<std::mutex> lock(publish_state_mutex_);
+    auto entry = goal_statuses_.find(uuid);
+    if (entry == goal_statuses_.end()) {
+      return;
+    }
+    if (entry->second.is_terminal) {
+      terminal_goal_statuses_.erase(entry->second.status);
+    } else {
+      active_goal_statuses_.erase(entry->second.status);
+    }
+    goal_statuses_.erase(entry);
+  }
+
+  // Requires publish_state_mutex_
+  void
+  trim_terminal_goal_statuses()
+  {
+    if (0u == max_terminal_goal_statuses_) {
+      return;
+    }
+    while (terminal_goal_statuses_.size() > max_terminal_goal_statuses_) {
+      goal_statuses_.erase(terminal_goal_statuses_.front().goal_info.goal_id.uuid);
+      terminal_goal_statuses_.pop_front();
+    }
+  }
+
+  // Return true if the status has to be published now, otherwise it's published by the status
+  // thread at the end of the period
+  bool
+  request_status_publish()
+  {
+    std::lock_guard<std::mutex> lock(publish_state_mutex_);
+    if (status_publish_period_.count() <= 0) {
+      return true;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    if (now >= last_status_publish_ + status_publish_period_ && !is_status_publish_pending_) {
+      last_status_publish_ = now;
+      return true;
+    }
+    is_status_publish_pending_ = true;
+    notify_publish_thread();
+    return false;
+  }
+
+  // Return true if the feedback has to be published now, otherwise it's kept until the end of
+  // the period
+  bool
+  request_feedback_publish(const GoalUUID & uuid, std::shared_ptr<void> feedback_msg)
+  {
+    const auto period = feedback_publish_period_.load();
+    if (period.count() <= 0) {
+      return true;
+    }
+    std::lock_guard<std::mutex> lock(publish_state_mutex_);
+    auto & state = feedback_states_[uuid];
+    const auto now = std::chrono::steady_clock::now();
+    if (now >= state.last_publish + period && !state.pending_feedback) {
+      state.last_publish = now;
+      return true;
+    }
+    state.pending_feedback = std::move(feedback_msg);
+    notify_publish_thread();
+    return false;
+  }
+
+  // Return the feedback of a goal not published yet, and forget the goal
+  std::shared_ptr<void>
+  take_pending_feedback(const GoalUUID & uuid)
+  {
+    std::lock_guard<std::mutex> lock(publish_state_mutex_);
+    auto iter = feedback_states_.find(uuid);
+    if (iter == feedback_states_.end()) {
+      return nullptr;
+    }
+    auto pending_feedback = std::move(iter->second.pending_feedback);
+    feedback_states_.erase(iter);
+    return pending_feedback;
+  }
+
+  void
+  publish_feedback(const GoalUUID & uuid, const std::shared_ptr<void> & feedback_msg)
+  {
+    // Only the client of a goal uses its feedback, an intra-process one gets it by pointer
+    if (intra_process_) {
+      ClientIntraProcess::SharedPtr client;
+      {
+        auto & shard = get_goal_shard(uuid);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto iter = shard.intra_process_clients.find(uuid);
+        if (iter != shard.intra_process_clients.end()) {
+          client = iter->second.lock();
+          if (!client) {
+            return;
+          }
+        }
+      }
+      if (client) {
+        client->provide_message(
+          ClientIntraProcess::MessageType::Feedback, 0, feedback_msg);
+        return;
+      }
+    }
+    rcl_ret_t ret = rcl_action_publish_feedback(action_server_.get(), feedback_msg.get());
+    if (RCL_RET_OK != ret) {
+      rclcpp::exceptions::throw_from_rcl_error(ret, "Failed to publish feedback");
+    }
+  }
+
+  void
+  publish_goal_statuses()
+  {
+    std::lock_guard<std::mutex> publish_lock(status_publish_mutex_);
+
+    auto status_msg = std::make_shared<action_msgs::msg::GoalStatusArray>();
+    {
+      std::lock_guard<std::mutex> lock(publish_state_mutex_);
+      is_status_publish_pending_ = false;
+      status_msg->status_list.reserve(goal_statuses_.size());
+      status_msg->status_list.insert(
+        status_msg->status_list.end(),
+        terminal_goal_statuses_.begin(), terminal_goal_statuses_.end());
+      status_msg->status_list.insert(
+        status_msg->status_list.end(),
+        active_goal_statuses_.begin(), active_goal_statuses_.end());
+    }
+
+    // The intra-process clients get the message by pointer, the others through the middleware
+    if (intra_process_) {
+      for (const auto & client : intra_process_->get_clients()) {
+        client->provide_message(ClientIntraProcess::MessageType::Status, 0, status_msg);
+      }
+    }
+
+    // Publish the message through the status publisher
+    rcl_ret_t ret = rcl_action_publish_status(action_server_.get(), status_msg.get());
+
+    if (RCL_RET_OK != ret) {
+      rclcpp::exceptions::throw_from_rcl_error(ret);
+    }
+  }
+
+  // Requires publish_state_mutex_
+  void
+  notify_publish_thread()
+  {
+    if (!publish_thread_.joinable()) {
+      publish_thread_ = std::thread(&ServerBaseImpl::run_publish_thread, this);
+    }
+    publish_condition_.notify_one();
+  }
+
+  void
+  run_publish_thread()
+  {
+    std::unique_lock<std::mutex> lock(publish_state_mutex_);
+    while (!is_publish_thread_stopped_) {
+      const auto now = std::chrono::steady_clock::now();
+      auto next_deadline = std::chrono::steady_clock::time_point::max();
+
+      bool is_status_due = false;
+      if (is_status_publish_pending_) {
+        const auto deadline = last_status_publish_ + status_publish_period_;
+        if (now >= deadline) {
+          is_status_due = true;
+          last_status_publish_ = now;
+        } else {
+          next_deadline = std::min(next_deadline, deadline);
+        }
+      }
+
+      std::vector<std::pair<GoalUUID, std::shared_ptr<void>>> due_feedback;
+      const auto feedback_period = feedback_publish_period_.load();
+      for (auto & goal_state : feedback_states_) {
+        FeedbackState & state = goal_state.second;
+        if (!state.pending_feedback) {
+          continue;
+        }
+        const auto deadline = state.last_publish + feedback_period;
+        if (now >= deadline) {
+          due_feedback.emplace_back(goal_state.first, std::move(state.pending_feedback));
+          state.pending_feedback.reset();
+          state.last_publish = now;
+        } else {
+          next_deadline = std::min(next_deadline, deadline);
+        }
+      }
+
+      if (!is_status_due && due_feedback.empty()) {
+        if (next_deadline == std::chrono::steady_clock::time_point::max()) {
+          publish_condition_.wait(lock);
+        } else {
+          publish_condition_.wait_until(lock, next_deadline);
+        }
+        continue;
+      }
+
+      lock.unlock();
+      for (const auto & feedback : due_feedback) {
+        try {
+          publish_feedback(feedback.first, feedback.second);
+        } catch (const std::exception & ex) {
+          RCLCPP_ERROR(logger_, "%s", ex.what());
+        }
+      }
+      if (is_status_due) {
+        try {
+          publish_goal_statuses();
+        } catch (const std::exception & ex) {
+          RCLCPP_ERROR(logger_, "Failed to publish the goal statuses: %s", ex.what());
+        }
+      }
+      lock.lock();
+    }
+  }
+
+  void
+  stop_publish_thread()
+  {
+    {
+      std::lock_guard<std::mutex> lock(publish_state_mutex_);
+      is_publish_thread_stopped_ = true;
+    }
+    publish_condition_.notify_one();
+    if (publish_thread_.joinable()) {
+      publish_thread_.join();
+    }
+  }
 
-  // Results to be kept until the goal expires after reaching a terminal state
-  std::unordered_map<GoalUUID, std::shared_ptr<void>> goal_results_;
-  // Requests for results are kept until a result becomes available
-  std::unordered_map<GoalUUID, std::vector<rmw_request_id_t>> result_requests_;
-  // rcl goal handles are kept so api to send result doesn't try to access freed memory
-  std::unordered_map<GoalUUID, std::shared_ptr<rcl_action_goal_handle_t>> goal_handles_;
+  // Result bookkeeping of the goals whose id hashes to the shard, so that goals ending in
+  // different threads rarely contend.
+  // A shard lock is never held while taking another lock.
+  struct GoalShard
+  {
+    std::mutex mutex;
+    // Results to be kept until the goal expires after reaching a terminal state
+    std::unordered_map<GoalUUID, std::shared_ptr<void>> goal_results;
+    // Requests for results are kept until a result becomes available
+    std::unordered_map<GoalUUID, std::vector<rmw_request_id_t>> result_requests;
+    // rcl goal handles are kept so api to send result doesn't try to access freed memory
+    std::unordered_map<GoalUUID, std::shared_ptr<rcl_action_goal_handle_t>> goal_handles;
+    // Clients in the same context of the goals they sent, which get the feedback by pointer
+    std::unordered_map<GoalUUID, ClientIntraProcess::WeakPtr> intra_process_clients;
+  };
+  std::array<GoalShard, 16> goal_shards_;
+
+  GoalShard &
+  get_goal_shard(const GoalUUID & uuid)
+  {
+    return goal_shards_[std::hash<GoalUUID>()(uuid) % goal_shards_.size()];
+  }
+
+  // Lock for the retention bookkeeping of the results, never held while taking another lock
+  std::mutex result_retention_mutex_;
+  // Goals with a retained result, least recently used first, evicted first beyond the limits
+  std::list<GoalUUID> result_lru_;
+  struct RetainedResult
+  {
+    std::list<GoalUUID>::iterator lru;
+    size_t size;
+  };
+  std::unordered_map<GoalUUID, RetainedResult> retained_results_;
+  size_t retained_result_bytes_ = 0;
+  size_t evicted_results_ = 0;
+  size_t max_retained_results_ = 0;
+  // Results are only measured while their total size is limited
+  std::atomic<size_t> max_retained_result_bytes_{0};
+
+  // Return the goals whose result has to be evicted
+  std::vector<GoalUUID>
+  retain_result(const GoalUUID & uuid, size_t size)
+  {
+    std::lock_guard<std::mutex> lock(result_retention_mutex_);
+    auto iter = retained_results_.find(uuid);
+    if (iter != retained_results_.end()) {
+      retained_result_bytes_ -= iter->second.size;
+      result_lru_.erase(iter->second.lru);
+      retained_results_.erase(iter);
+    }
+    retained_results_[uuid] = {result_lru_.insert(result_lru_.end(), uuid), size};
+    retained_result_bytes_ += size;
+    return take_results_beyond_limits();
+  }
+
+  // Requires result_retention_mutex_
+  std::vector<GoalUUID>
+  take_results_beyond_limits()
+  {
+    std::vector<GoalUUID> evicted;
+    const size_t max_bytes = max_retained_result_bytes_.load();
+    // The most recent result is kept, so that it can be requested at least once
+    while (result_lru_.size() > 1u &&
+      ((max_retained_results_ > 0u && retained_results_.size() > max_retained_results_) ||
+      (max_bytes > 0u && retained_result_bytes_ > max_bytes)))
+    {
+      const GoalUUID uuid = result_lru_.front();
+      result_lru_.pop_front();
+      auto iter = retained_results_.find(uuid);
+      retained_result_bytes_ -= iter->second.size;
+      retained_results_.erase(iter);
+      evicted.push_back(uuid);
+      ++evicted_results_;
+    }
+    return evicted;
+  }
+
+  void
+  replace_evicted_results(
+    const std::vector<GoalUUID> & evicted,
+    const std::shared_ptr<void> & evicted_result)
+  {
+    for (const GoalUUID & uuid : evicted) {
+      auto & shard = get_goal_shard(uuid);
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      auto iter = shard.goal_results.find(uuid);
+      if (iter != shard.goal_results.end()) {
+        iter->second = evicted_result;
+      }
+    }
+  }
+
+  void
+  touch_result(const GoalUUID & uuid)
+  {
+    std::lock_guard<std::mutex> lock(result_retention_mutex_);
+    auto iter = retained_results_.find(uuid);
+    if (iter != retained_results_.end()) {
+      result_lru_.splice(result_lru_.end(), result_lru_, iter->second.lru);
+    }
+  }
+
+  void
+  forget_result(const GoalUUID & uuid)
+  {
+    std::lock_guard<std::mutex> lock(result_retention_mutex_);
+    auto iter = retained_results_.find(uuid);
+    if (iter != retained_results_.end()) {
+      retained_result_bytes_ -= iter->second.size;
+      result_lru_.erase(iter->second.lru);
+      retained_results_.erase(iter);
+    }
+  }
+
+  // Send a response by pointer to an intra-process client, or else through the middleware
+  void
+  send_response(
+    ServerIntraProcess::RequestType request_type,
+    rmw_request_id_t & request_header,
+    const std::shared_ptr<void> & response)
+  {
+    if (intra_process_) {
+      auto pending_client = intra_process_->take_pending_client(request_type, request_header);
+      if (pending_client) {
+        // The response is dropped if the client was destroyed, as with the middleware
+        auto client = pending_client->lock();
+        if (client) {
+          client->provide_message(
+            get_response_type(request_type), request_header.sequence_number, response);
+        }
+        return;
+      }
+    }
+    rcl_ret_t ret = RCL_RET_ERROR;
+    switch (request_type) {
+      case ServerIntraProcess::RequestType::Goal:
+        ret = rcl_action_send_goal_response(
+          action_server_.get(), &request_header, response.get());
+        break;
+      case ServerIntraProcess::RequestType::Cancel:
+        ret = rcl_action_send_cancel_response(
+          action_server_.get(), &request_header, response.get());
+        break;
+      case ServerIntraProcess::RequestType::Result:
+        ret = rcl_action_send_result_response(
+          action_server_.get(), &request_header, response.get());
+        break;
+    }
+    if (RCL_RET_OK != ret) {
+      rclcpp::exceptions::throw_from_rcl_error(ret);
+    }
+  }
+
+  static ClientIntraProcess::MessageType
+  get_response_type(ServerIntraProcess::RequestType request_type)
+  {
+    switch (request_type) {
+      case ServerIntraProcess::RequestType::Goal:
+        return ClientIntraProcess::MessageType::GoalResponse;
+      case ServerIntraProcess::RequestType::Cancel:
+        return ClientIntraProcess::MessageType::CancelResponse;
+      case ServerIntraProcess::RequestType::Result:
+        break;
+    }
+    return ClientIntraProcess::MessageType::ResultResponse;
+  }
 
   rclcpp::Logger logger_;
 };
@@ -104,6 +601,7 @@ ServerBase::ServerBase(
       }
     };
 
+  pimpl_->type_support_ = type_support;
   pimpl_->action_server_.reset(new rcl_action_server_t, deleter);
   *(pimpl_->action_server_) = rcl_action_get_zero_initialized_server();
 
@@ -132,6 +630,59 @@ ServerBase::ServerBase(
 
 ServerBase::~ServerBase()
 {
+  auto ipsm = pimpl_->weak_ipsm_.lock();
+  if (ipsm && pimpl_->intra_process_) {
+    ipsm->remove_service(pimpl_->intra_process_service_id_);
+  }
+  pimpl_->stop_publish_thread();
+}
+
+void
+ServerBase::setup_intra_process(
+  rclcpp::Context::SharedPtr context,
+  std::weak_ptr<ServerBase> weak_this)
+{
+  if (pimpl_->intra_process_) {
+    throw std::runtime_error(
+            "intra-process communication is already setup for this action server");
+  }
+  using rclcpp::experimental::IntraProcessServiceManager;
+  auto ipsm = context->get_sub_context<IntraProcessServiceManager>();
+  pimpl_->intra_process_ = std::make_shared<ServerIntraProcess>(
+    [weak_this](
+      ServerIntraProcess::RequestType request_type,
+      const rmw_request_id_t & request_header,
+      std::shared_ptr<void> request)
+    {
+      auto server = weak_this.lock();
+      if (!server) {
+        return;
+      }
+      rmw_request_id_t header = request_header;
+      switch (request_type) {
+        case ServerIntraProcess::RequestType::Goal:
+          server->handle_goal_request(header, std::move(request));
+          break;
+        case ServerIntraProcess::RequestType::Cancel:
+          server->handle_cancel_request(
+            header, std::static_pointer_cast<action_msgs::srv::CancelGoal::Request>(request));
+          break;
+        case ServerIntraProcess::RequestType::Result:
+          server->handle_result_request(header, std::move(request));
+          break;
+      }
+    },
+    context,
+    rcl_action_server_get_action_name(pimpl_->action_server_.get()),
+    pimpl_->type_support_);
+  pimpl_->intra_process_service_id_ = ipsm->add_service(pimpl_->intra_process_);
+  pimpl_->weak_ipsm_ = ipsm;
+}
+
+rclcpp::Waitable::SharedPtr
+ServerBase::get_intra_process_waitable() const
+{
+  return pimpl_->intra_process_;
 }
 
 size_t
@@ -167,7 +718,7 @@ ServerBase::get_number_of_ready_guard_conditions()
 void
 ServerBase::add_to_wait_set(rcl_wait_set_t * wait_set)
 {
-  std::lock_guard<std::recursive_mutex> lock(pimpl_->action_server_reentrant_mutex_);
+  std::lock_guard<std::mutex> lock(pimpl_->action_server_mutex_);
   rcl_ret_t ret = rcl_action_wait_set_add_action_server(
     wait_set, pimpl_->action_server_.get(), NULL);
   if (RCL_RET_OK != ret) {
@@ -184,7 +735,7 @@ ServerBase::is_ready(rcl_wait_set_t * wait_set)
   bool goal_expired;
   rcl_ret_t ret;
   {
-    std::lock_guard<std::recursive_mutex> lock(pimpl_->action_server_reentrant_mutex_);
+    std::lock_guard<std::mutex> lock(pimpl_->action_server_mutex_);
     ret = rcl_action_server_wait_set_get_entities_ready(
       wait_set,
       pimpl_->action_server_.get(),
@@ -217,8 +768,6 @@ ServerBase::take_data()
     rcl_action_goal_info_t goal_info = rcl_action_get_zero_initialized_goal_info();
     rmw_request_id_t request_header;
 
-    std::lock_guard<std::recursive_mutex> lock(pimpl_->action_server_reentrant_mutex_);
-
     std::shared_ptr<void> message = create_goal_request();
     ret = rcl_action_take_goal_request(
       pimpl_->action_server_.get(),
@@ -238,7 +787,6 @@ ServerBase::take_data()
     // Initialize cancel request
     auto request = std::make_shared<action_msgs::srv::CancelGoal::Request>();
 
-    std::lock_guard<std::recursive_mutex> lock(pimpl_->action_server_reentrant_mutex_);
     ret = rcl_action_take_cancel_request(
       pimpl_->action_server_.get(),
       &request_header,
@@ -253,7 +801,6 @@ ServerBase::take_data()
     // Get the result request message
     rmw_request_id_t request_header;
     std::shared_ptr<void> result_request = create_result_request();
-    std::lock_guard<std::recursive_mutex> lock(pimpl_->action_server_reentrant_mutex_);
     ret = rcl_action_take_result_request(
       pimpl_->action_server_.get(), &request_header, result_request.get());
 
@@ -320,7 +867,6 @@ ServerBase::execute_goal_request_received(std::shared_ptr<void> & data)
   } else if (RCL_RET_OK != ret) {
     rclcpp::exceptions::throw_from_rcl_error(ret);
   }
-  rcl_action_goal_info_t goal_info = std::get<1>(*shared_ptr);
   rmw_request_id_t request_header = std::get<2>(*shared_ptr);
   std::shared_ptr<void> message = std::get<3>(*shared_ptr);
 
@@ -329,23 +875,30 @@ ServerBase::execute_goal_request_received(std::shared_ptr<void> & data)
     return;
   }
 
+  handle_goal_request(request_header, message);
+  data.reset();
+}
+
+void
+ServerBase::handle_goal_request(
+  rmw_request_id_t & request_header,
+  std::shared_ptr<void> message)
+{
+  rcl_action_goal_info_t goal_info = rcl_action_get_zero_initialized_goal_info();
   GoalUUID uuid = get_goal_id_from_goal_request(message.get());
   convert(uuid, &goal_info);
 
   // Call user's callback, getting the user's response and a ros message to send back
   auto response_pair = call_handle_goal_callback(uuid, message);
 
-  {
-    std::lock_guard<std::recursive_mutex> lock(pimpl_->action_server_reentrant_mutex_);
-    ret = rcl_action_send_goal_response(
-      pimpl_->action_server_.get(),
-      &request_header,
-      response_pair.second.get());
+  // A client in the same context gets the feedback of its goal by pointer
+  ClientIntraProcess::SharedPtr intra_process_client;
+  if (pimpl_->intra_process_) {
+    intra_process_client = pimpl_->intra_process_->get_client(request_header);
   }
 
-  if (RCL_RET_OK != ret) {
-    rclcpp::exceptions::throw_from_rcl_error(ret);
-  }
+  pimpl_->send_response(
+    ServerIntraProcess::RequestType::Goal, request_header, response_pair.second);
 
   const auto status = response_pair.first;
 
@@ -367,7 +920,7 @@ ServerBase::execute_goal_request_received(std::shared_ptr<void> & data)
       };
     rcl_action_goal_handle_t * rcl_handle;
     {
-      std::lock_guard<std::recursive_mutex> lock(pimpl_->action_server_reentrant_mutex_);
+      std::lock_guard<std::mutex> lock(pimpl_->action_server_mutex_);
       rcl_handle = rcl_action_accept_new_goal(pimpl_->action_server_.get(), &goal_info);
     }
     if (!rcl_handle) {
@@ -379,9 +932,21 @@ ServerBase::execute_goal_request_received(std::shared_ptr<void> & data)
     *handle = *rcl_handle;
 
     {
-      std::lock_guard<std::recursive_mutex> lock(pimpl_->unordered_map_mutex_);
-      pimpl_->goal_handles_[uuid] = handle;
+      auto & shard = pimpl_->get_goal_shard(uuid);
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      shard.goal_handles[uuid] = handle;
+      if (intra_process_client) {
+        shard.intra_process_clients[uuid] = intra_process_client;
+      }
+    }
+
+    // Get the goal info with the time stamp set by rcl_action
+    rcl_action_goal_info_t accepted_goal_info = rcl_action_get_zero_initialized_goal_info();
+    rcl_ret_t ret = rcl_action_goal_handle_get_info(handle.get(), &accepted_goal_info);
+    if (RCL_RET_OK != ret) {
+      rclcpp::exceptions::throw_from_rcl_error(ret);
     }
+    pimpl_->add_goal_status(accepted_goal_info, action_msgs::msg::GoalStatus::STATUS_ACCEPTED);
 
     if (GoalResponse::ACCEPT_AND_EXECUTE == status) {
       // Change status to executing
@@ -389,6 +954,7 @@ ServerBase::execute_goal_request_received(std::shared_ptr<void> & data)
       if (RCL_RET_OK != ret) {
         rclcpp::exceptions::throw_from_rcl_error(ret);
       }
+      pimpl_->update_goal_status(uuid, action_msgs::msg::GoalStatus::STATUS_EXECUTING);
     }
     // publish status since a goal's state has changed (was accepted or has begun execution)
     publish_status();
@@ -396,7 +962,6 @@ ServerBase::execute_goal_request_received(std::shared_ptr<void> & data)
     // Tell user to start executing action
     call_goal_accepted_callback(handle, uuid, message);
   }
-  data.reset();
 }
 
 void
@@ -418,6 +983,15 @@ ServerBase::execute_cancel_request_received(std::shared_ptr<void> & data)
   auto request_header = std::get<2>(*shared_ptr);
   pimpl_->cancel_request_ready_ = false;
 
+  handle_cancel_request(request_header, request);
+  data.reset();
+}
+
+void
+ServerBase::handle_cancel_request(
+  rmw_request_id_t & request_header,
+  std::shared_ptr<action_msgs::srv::CancelGoal::Request> request)
+{
   // Convert c++ message to C message
   rcl_action_cancel_request_t cancel_request = rcl_action_get_zero_initialized_cancel_request();
   convert(request->goal_info.goal_id.uuid, &cancel_request.goal_info);
@@ -427,8 +1001,9 @@ ServerBase::execute_cancel_request_received(std::shared_ptr<void> & data)
   // Get a list of goal info that should be attempted to be cancelled
   rcl_action_cancel_response_t cancel_response = rcl_action_get_zero_initialized_cancel_response();
 
+  rcl_ret_t ret;
   {
-    std::lock_guard<std::recursive_mutex> lock(pimpl_->action_server_reentrant_mutex_);
+    std::lock_guard<std::mutex> lock(pimpl_->action_server_mutex_);
     ret = rcl_action_process_cancel_request(
       pimpl_->action_server_.get(),
       &cancel_request,
@@ -463,6 +1038,7 @@ ServerBase::execute_cancel_request_received(std::shared_ptr<void> & data)
       cpp_info.stamp.sec = goal_info.stamp.sec;
       cpp_info.stamp.nanosec = goal_info.stamp.nanosec;
       response->goals_canceling.push_back(cpp_info);
+      pimpl_->update_goal_status(uuid, action_msgs::msg::GoalStatus::STATUS_CANCELING);
     }
   }
 
@@ -477,16 +1053,7 @@ ServerBase::execute_cancel_request_received(std::shared_ptr<void> & data)
     publish_status();
   }
 
-  {
-    std::lock_guard<std::recursive_mutex> lock(pimpl_->action_server_reentrant_mutex_);
-    ret = rcl_action_send_cancel_response(
-      pimpl_->action_server_.get(), &request_header, response.get());
-  }
-
-  if (RCL_RET_OK != ret) {
-    rclcpp::exceptions::throw_from_rcl_error(ret);
-  }
-  data.reset();
+  pimpl_->send_response(ServerIntraProcess::RequestType::Cancel, request_header, response);
 }
 
 void
@@ -507,6 +1074,15 @@ ServerBase::execute_result_request_received(std::shared_ptr<void> & data)
   auto request_header = std::get<2>(*shared_ptr);
 
   pimpl_->result_request_ready_ = false;
+  handle_result_request(request_header, result_request);
+  data.reset();
+}
+
+void
+ServerBase::handle_result_request(
+  rmw_request_id_t & request_header,
+  std::shared_ptr<void> result_request)
+{
   std::shared_ptr<void> result_response;
 
   // check if the goal exists
@@ -515,7 +1091,7 @@ ServerBase::execute_result_request_received(std::shared_ptr<void> & data)
   convert(uuid, &goal_info);
   bool goal_exists;
   {
-    std::lock_guard<std::recursive_mutex> lock(pimpl_->action_server_reentrant_mutex_);
+    std::lock_guard<std::mutex> lock(pimpl_->action_server_mutex_);
     goal_exists = rcl_action_server_goal_exists(pimpl_->action_server_.get(), &goal_info);
   }
   if (!goal_exists) {
@@ -523,26 +1099,23 @@ ServerBase::execute_result_request_received(std::shared_ptr<void> & data)
     result_response = create_result_response(action_msgs::msg::GoalStatus::STATUS_UNKNOWN);
   } else {
     // Goal exists, check if a result is already available
-    std::lock_guard<std::recursive_mutex> lock(pimpl_->unordered_map_mutex_);
-    auto iter = pimpl_->goal_results_.find(uuid);
-    if (iter != pimpl_->goal_results_.end()) {
+    auto & shard = pimpl_->get_goal_shard(uuid);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto iter = shard.goal_results.find(uuid);
+    if (iter != shard.goal_results.end()) {
       result_response = iter->second;
     } else {
       // Store the request so it can be responded to later
-      pimpl_->result_requests_[uuid].push_back(request_header);
+      shard.result_requests[uuid].push_back(request_header);
     }
   }
 
   if (result_response) {
+    pimpl_->touch_result(uuid);
     // Send the result now
-    std::lock_guard<std::recursive_mutex> lock(pimpl_->action_server_reentrant_mutex_);
-    rcl_ret_t rcl_ret = rcl_action_send_result_response(
-      pimpl_->action_server_.get(), &request_header, result_response.get());
-    if (RCL_RET_OK != rcl_ret) {
-      rclcpp::exceptions::throw_from_rcl_error(rcl_ret);
-    }
+    pimpl_->send_response(
+      ServerIntraProcess::RequestType::Result, request_header, result_response);
   }
-  data.reset();
 }
 
 void
@@ -556,7 +1129,7 @@ ServerBase::execute_check_expired_goals()
   while (num_expired > 0u) {
     rcl_ret_t ret;
     {
-      std::lock_guard<std::recursive_mutex> lock(pimpl_->action_server_reentrant_mutex_);
+      std::lock_guard<std::mutex> lock(pimpl_->action_server_mutex_);
       ret = rcl_action_expire_goals(pimpl_->action_server_.get(), expired_goals, 1, &num_expired);
     }
     if (RCL_RET_OK != ret) {
@@ -566,10 +1139,28 @@ ServerBase::execute_check_expired_goals()
       GoalUUID uuid;
       convert(expired_goals[0], &uuid);
       RCLCPP_DEBUG(pimpl_->logger_, "Expired goal %s", to_string(uuid).c_str());
-      std::lock_guard<std::recursive_mutex> lock(pimpl_->unordered_map_mutex_);
-      pimpl_->goal_results_.erase(uuid);
-      pimpl_->result_requests_.erase(uuid);
-      pimpl_->goal_handles_.erase(uuid);
+      std::vector<rmw_request_id_t> result_requests;
+      {
+        auto & shard = pimpl_->get_goal_shard(uuid);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.goal_results.erase(uuid);
+        auto iter = shard.result_requests.find(uuid);
+        if (iter != shard.result_requests.end()) {
+          result_requests = std::move(iter->second);
+          shard.result_requests.erase(iter);
+        }
+        shard.goal_handles.erase(uuid);
+        shard.intra_process_clients.erase(uuid);
+      }
+      // The intra-process clients of the requests left unanswered are forgotten
+      if (pimpl_->intra_process_) {
+        for (const auto & request_header : result_requests) {
+          pimpl_->intra_process_->take_pending_client(
+            ServerIntraProcess::RequestType::Result, request_header);
+        }
+      }
+      pimpl_->remove_goal_status(uuid);
+      pimpl_->forget_result(uuid);
     }
   }
 }
@@ -577,71 +1168,54 @@ ServerBase::execute_check_expired_goals()
 void
 ServerBase::publish_status()
 {
-  rcl_ret_t ret;
-
-  // We need to hold the lock across this entire method because
-  // rcl_action_server_get_goal_handles() returns an internal pointer to the
-  // goal data.
-  std::lock_guard<std::recursive_mutex> lock(pimpl_->action_server_reentrant_mutex_);
-
-  // Get all goal handles known to C action server
-  rcl_action_goal_handle_t ** goal_handles = NULL;
-  size_t num_goals = 0;
-  ret = rcl_action_server_get_goal_handles(
-    pimpl_->action_server_.get(), &goal_handles, &num_goals);
-
-  if (RCL_RET_OK != ret) {
-    rclcpp::exceptions::throw_from_rcl_error(ret);
+  if (pimpl_->request_status_publish()) {
+    pimpl_->publish_goal_statuses();
   }
+}
 
-  auto status_msg = std::make_shared<action_msgs::msg::GoalStatusArray>();
-  status_msg->status_list.reserve(num_goals);
-  // Populate a c++ status message with the goals and their statuses
-  rcl_action_goal_status_array_t c_status_array =
-    rcl_action_get_zero_initialized_goal_status_array();
-  ret = rcl_action_get_goal_status_array(pimpl_->action_server_.get(), &c_status_array);
-  if (RCL_RET_OK != ret) {
-    rclcpp::exceptions::throw_from_rcl_error(ret);
-  }
+void
+ServerBase::update_goal_status(
+  const GoalUUID & uuid,
+  decltype(action_msgs::msg::GoalStatus::status) status)
+{
+  pimpl_->update_goal_status(uuid, status);
+  publish_status();
+}
 
-  RCPPUTILS_SCOPE_EXIT(
+void
+ServerBase::set_status_publish_period(std::chrono::nanoseconds period)
+{
   {
-    ret = rcl_action_goal_status_array_fini(&c_status_array);
-    if (RCL_RET_OK != ret) {
-      RCLCPP_ERROR(pimpl_->logger_, "Failed to fini status array message");
-    }
-  });
-
-  for (size_t i = 0; i < c_status_array.msg.status_list.size; ++i) {
-    auto & c_status_msg = c_status_array.msg.status_list.data[i];
-
-    action_msgs::msg::GoalStatus msg;
-    msg.status = c_status_msg.status;
-    // Convert C goal info to C++ goal info
-    convert(c_status_msg.goal_info, &msg.goal_info.goal_id.uuid);
-    msg.goal_info.stamp.sec = c_status_msg.goal_info.stamp.sec;
-    msg.goal_info.stamp.nanosec = c_status_msg.goal_info.stamp.nanosec;
-
-    status_msg->status_list.push_back(msg);
+    std::lock_guard<std::mutex> lock(pimpl_->publish_state_mutex_);
+    pimpl_->status_publish_period_ = period;
   }
+  // A pending status message is published at the end of the new period
+  pimpl_->publish_condition_.notify_one();
+}
 
-  // Publish the message through the status publisher
-  ret = rcl_action_publish_status(pimpl_->action_server_.get(), status_msg.get());
-
-  if (RCL_RET_OK != ret) {
-    rclcpp::exceptions::throw_from_rcl_error(ret);
-  }
+void
+ServerBase::set_max_terminal_goal_statuses(size_t max_terminal_goal_statuses)
+{
+  std::lock_guard<std::mutex> lock(pimpl_->publish_state_mutex_);
+  pimpl_->max_terminal_goal_statuses_ = max_terminal_goal_statuses;
+  pimpl_->trim_terminal_goal_statuses();
 }
 
 void
 ServerBase::publish_result(const GoalUUID & uuid, std::shared_ptr<void> result_msg)
 {
+  // The latest feedback of the goal is published before its result
+  std::shared_ptr<void> pending_feedback = pimpl_->take_pending_feedback(uuid);
+  if (pending_feedback) {
+    pimpl_->publish_feedback(uuid, pending_feedback);
+  }
+
   // Check that the goal exists
   rcl_action_goal_info_t goal_info;
   convert(uuid, &goal_info);
   bool goal_exists;
   {
-    std::lock_guard<std::recursive_mutex> lock(pimpl_->action_server_reentrant_mutex_);
+    std::lock_guard<std::mutex> lock(pimpl_->action_server_mutex_);
     goal_exists = rcl_action_server_goal_exists(pimpl_->action_server_.get(), &goal_info);
   }
 
@@ -649,40 +1223,70 @@ ServerBase::publish_result(const GoalUUID & uuid, std::shared_ptr<void> result_m
     throw std::runtime_error("Asked to publish result for goal that does not exist");
   }
 
+  // The requests received before the result are answered, the later ones find the result
+  std::vector<rmw_request_id_t> result_requests;
   {
-    /**
-    * NOTE: There is a potential deadlock issue if both unordered_map_mutex_ and
-    * action_server_reentrant_mutex_ locked in other block scopes. Unless using
-    * std::scoped_lock, locking order must be consistent with the current.
-    *
-    * Current locking order:
-    *
-    *   1. unordered_map_mutex_
-    *   2. action_server_reentrant_mutex_
-    *
-    */
-    std::lock_guard<std::recursive_mutex> unordered_map_lock(pimpl_->unordered_map_mutex_);
-    pimpl_->goal_results_[uuid] = result_msg;
-
-    // if there are clients who already asked for the result, send it to them
-    auto iter = pimpl_->result_requests_.find(uuid);
-    if (iter != pimpl_->result_requests_.end()) {
-      std::lock_guard<std::recursive_mutex> lock(pimpl_->action_server_reentrant_mutex_);
-      for (auto & request_header : iter->second) {
-        rcl_ret_t ret = rcl_action_send_result_response(
-          pimpl_->action_server_.get(), &request_header, result_msg.get());
-        if (RCL_RET_OK != ret) {
-          rclcpp::exceptions::throw_from_rcl_error(ret);
-        }
-      }
+    auto & shard = pimpl_->get_goal_shard(uuid);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.goal_results[uuid] = result_msg;
+    auto iter = shard.result_requests.find(uuid);
+    if (iter != shard.result_requests.end()) {
+      result_requests = std::move(iter->second);
+      shard.result_requests.erase(iter);
     }
   }
+
+  size_t result_size = 0;
+  if (pimpl_->max_retained_result_bytes_.load() > 0u) {
+    result_size = get_result_response_size(result_msg);
+  }
+  evict_results(pimpl_->retain_result(uuid, result_size));
+
+  // if there are clients who already asked for the result, send it to them
+  for (auto & request_header : result_requests) {
+    pimpl_->send_response(ServerIntraProcess::RequestType::Result, request_header, result_msg);
+  }
+}
+
+void
+ServerBase::evict_results(const std::vector<GoalUUID> & evicted)
+{
+  if (evicted.empty()) {
+    return;
+  }
+  // The requests for an evicted result are answered as for an unknown goal
+  pimpl_->replace_evicted_results(
+    evicted, create_result_response(action_msgs::msg::GoalStatus::STATUS_UNKNOWN));
+}
+
+void
+ServerBase::set_result_retention_limits(size_t max_results, size_t max_bytes)
+{
+  std::vector<GoalUUID> evicted;
+  {
+    std::lock_guard<std::mutex> lock(pimpl_->result_retention_mutex_);
+    pimpl_->max_retained_results_ = max_results;
+    pimpl_->max_retained_result_bytes_.store(max_bytes);
+    evicted = pimpl_->take_results_beyond_limits();
+  }
+  evict_results(evicted);
+}
+
+ServerBase::ResultRetentionStatistics
+ServerBase::get_result_retention_statistics() const
+{
+  std::lock_guard<std::mutex> lock(pimpl_->result_retention_mutex_);
+  ResultRetentionStatistics statistics;
+  statistics.retained_results = pimpl_->retained_results_.size();
+  statistics.retained_bytes = pimpl_->retained_result_bytes_;
+  statistics.evicted_results = pimpl_->evicted_results_;
+  return statistics;
 }
 
 void
 ServerBase::notify_goal_terminal_state()
 {
-  std::lock_guard<std::recursive_mutex> lock(pimpl_->action_server_reentrant_mutex_);
+  std::lock_guard<std::mutex> lock(pimpl_->action_server_mutex_);
   rcl_ret_t ret = rcl_action_notify_goal_done(pimpl_->action_server_.get());
   if (RCL_RET_OK != ret) {
     rclcpp::exceptions::throw_from_rcl_error(ret);
@@ -690,13 +1294,23 @@ ServerBase::notify_goal_terminal_state()
 }
 
 void
-ServerBase::publish_feedback(std::shared_ptr<void> feedback_msg)
+ServerBase::publish_feedback(const GoalUUID & uuid, std::shared_ptr<void> feedback_msg)
 {
-  std::lock_guard<std::recursive_mutex> lock(pimpl_->action_server_reentrant_mutex_);
-  rcl_ret_t ret = rcl_action_publish_feedback(pimpl_->action_server_.get(), feedback_msg.get());
-  if (RCL_RET_OK != ret) {
-    rclcpp::exceptions::throw_from_rcl_error(ret, "Failed to publish feedback");
+  if (pimpl_->request_feedback_publish(uuid, feedback_msg)) {
+    // Published concurrently by the goals, without a lock
+    pimpl_->publish_feedback(uuid, feedback_msg);
+  }
+}
+
+void
+ServerBase::set_feedback_publish_period(std::chrono::nanoseconds period)
+{
+  {
+    std::lock_guard<std::mutex> lock(pimpl_->publish_state_mutex_);
+    pimpl_->feedback_publish_period_.store(period);
   }
+  // The pending feedback is published at the end of the new period
+  pimpl_->publish_condition_.notify_one();
 }
 
 void
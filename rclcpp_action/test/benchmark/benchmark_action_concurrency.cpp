@@ -0,0 +1,353 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "performance_test_fixture/performance_test_fixture.hpp"
+#include "rclcpp_action/rclcpp_action.hpp"
+#include "rclcpp/rclcpp.hpp"
+#include "test_msgs/action/fibonacci.hpp"
+
+using performance_test_fixture::PerformanceTest;
+
+using Fibonacci = test_msgs::action::Fibonacci;
+using ClientGoalHandle = rclcpp_action::ClientGoalHandle<Fibonacci>;
+using ServerGoalHandle = rclcpp_action::ServerGoalHandle<Fibonacci>;
+using GoalUUID = rclcpp_action::GoalUUID;
+
+namespace
+{
+
+constexpr char fibonacci_action_name[] = "fibonacci";
+constexpr int result_order = 10;
+// Depth of the queues of the services and the topics of the action
+constexpr size_t max_goal_count = 10000;
+
+/// Register the benchmark for 1, 100 and 10000 concurrent goals.
+void
+goal_counts(benchmark::internal::Benchmark * benchmark)
+{
+  for (int64_t count : {1, 100, 10000}) {
+    benchmark->Arg(count);
+  }
+}
+
+}  // namespace
+
+/// Fixture with an action server and a client sharing a node and handling many goals at once.
+/**
+ * The number of concurrent goals is the first argument of the benchmark.
+ * The queues of the services and the topics of the action are deep enough for all the goals,
+ * so that no request, response or feedback message is dropped.
+ * The server defers the execution of the accepted goals, and it retains the results of the
+ * goals of the latest iteration only.
+ */
+class ActionConcurrencyPerformanceTest : public PerformanceTest
+{
+public:
+  void SetUp(benchmark::State & state)
+  {
+    goal_count = static_cast<size_t>(state.range(0));
+    rclcpp::init(0, nullptr);
+    node = std::make_shared<rclcpp::Node>("node", "ns");
+
+    rcl_action_server_options_t server_options = rcl_action_server_get_default_options();
+    set_depth(server_options.goal_service_qos);
+    set_depth(server_options.cancel_service_qos);
+    set_depth(server_options.result_service_qos);
+    set_depth(server_options.feedback_topic_qos);
+    action_server = rclcpp_action::create_server<Fibonacci>(
+      node, fibonacci_action_name,
+      [](const GoalUUID &, std::shared_ptr<const Fibonacci::Goal>) {
+        return rclcpp_action::GoalResponse::ACCEPT_AND_DEFER;
+      },
+      [](std::shared_ptr<ServerGoalHandle>) {
+        return rclcpp_action::CancelResponse::ACCEPT;
+      },
+      [this](std::shared_ptr<ServerGoalHandle> goal_handle) {
+        server_goal_handles.push_back(goal_handle);
+      },
+      server_options);
+    action_server->set_result_retention_limits(goal_count);
+
+    rcl_action_client_options_t client_options = rcl_action_client_get_default_options();
+    set_depth(client_options.goal_service_qos);
+    set_depth(client_options.cancel_service_qos);
+    set_depth(client_options.result_service_qos);
+    set_depth(client_options.feedback_topic_qos);
+    action_client = rclcpp_action::create_client<Fibonacci>(
+      node, fibonacci_action_name, nullptr, client_options);
+
+    executor = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+    executor->add_node(node);
+
+    result = std::make_shared<Fibonacci::Result>();
+    for (int i = 0; i < result_order; ++i) {
+      // Not the fibonacci sequence, but that's not important to this benchmark
+      result->sequence.push_back(i);
+    }
+
+    if (!action_client->wait_for_action_server(std::chrono::seconds(1))) {
+      state.SkipWithError("Waiting for server timed out");
+    }
+    PerformanceTest::SetUp(state);
+  }
+
+  void TearDown(benchmark::State & state)
+  {
+    PerformanceTest::TearDown(state);
+    // Ensure proper sequencing of destruction
+    client_goal_handles.clear();
+    server_goal_handles.clear();
+    executor.reset();
+    action_client.reset();
+    action_server.reset();
+    node.reset();
+    rclcpp::shutdown();
+  }
+
+  /// Spin the executor until the predicate holds, returning false on timeout.
+  bool SpinUntil(const std::function<bool()> & predicate)
+  {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while (!predicate()) {
+      if (std::chrono::steady_clock::now() > deadline) {
+        return false;
+      }
+      executor->spin_some();
+    }
+    return true;
+  }
+
+  /// Send the goals and spin until the server accepted all of them.
+  bool SendGoals(size_t count)
+  {
+    rclcpp_action::Client<Fibonacci>::SendGoalOptions options;
+    options.feedback_callback =
+      [this](ClientGoalHandle::SharedPtr, std::shared_ptr<const Fibonacci::Feedback>) {
+        ++feedback_count;
+      };
+    options.result_callback = [this](const ClientGoalHandle::WrappedResult &) {
+        ++result_count;
+      };
+
+    Fibonacci::Goal goal;
+    goal.order = result_order;
+    std::vector<std::shared_future<ClientGoalHandle::SharedPtr>> futures;
+    futures.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+      futures.push_back(action_client->async_send_goal(goal, options));
+    }
+    for (auto & future : futures) {
+      if (executor->spin_until_future_complete(future, std::chrono::seconds(30)) !=
+        rclcpp::FutureReturnCode::SUCCESS || !future.get())
+      {
+        return false;
+      }
+      client_goal_handles.push_back(future.get());
+    }
+    return SpinUntil([this]() {return server_goal_handles.size() == client_goal_handles.size();});
+  }
+
+  /// Succeed the goals of the server and spin until the client received all the results.
+  bool SucceedGoals()
+  {
+    const size_t expected_result_count = result_count + server_goal_handles.size();
+    for (auto & goal_handle : server_goal_handles) {
+      goal_handle->execute();
+      goal_handle->succeed(result);
+    }
+    server_goal_handles.clear();
+    const bool received = SpinUntil(
+      [this, expected_result_count]() {return result_count == expected_result_count;});
+    client_goal_handles.clear();
+    return received;
+  }
+
+protected:
+  static void set_depth(rmw_qos_profile_t & qos)
+  {
+    qos.history = RMW_QOS_POLICY_HISTORY_KEEP_LAST;
+    qos.depth = max_goal_count;
+  }
+
+  size_t goal_count;
+  std::shared_ptr<rclcpp::Node> node;
+  std::shared_ptr<rclcpp_action::Server<Fibonacci>> action_server;
+  std::shared_ptr<rclcpp_action::Client<Fibonacci>> action_client;
+  std::shared_ptr<rclcpp::executors::SingleThreadedExecutor> executor;
+  std::shared_ptr<Fibonacci::Result> result;
+  std::vector<std::shared_ptr<ServerGoalHandle>> server_goal_handles;
+  std::vector<ClientGoalHandle::SharedPtr> client_goal_handles;
+  size_t feedback_count = 0;
+  size_t result_count = 0;
+};
+
+BENCHMARK_DEFINE_F(ActionConcurrencyPerformanceTest, accept_goals)(benchmark::State & state)
+{
+  reset_heap_counters();
+  for (auto _ : state) {
+    (void)_;
+    if (!SendGoals(goal_count)) {
+      state.SkipWithError("Valid goals were not accepted");
+      return;
+    }
+
+    state.PauseTiming();
+    if (!SucceedGoals()) {
+      state.SkipWithError("Results were not received");
+      return;
+    }
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * goal_count));
+}
+BENCHMARK_REGISTER_F(ActionConcurrencyPerformanceTest, accept_goals)->Apply(goal_counts);
+
+BENCHMARK_DEFINE_F(ActionConcurrencyPerformanceTest, feedback_fan_out)(benchmark::State & state)
+{
+  if (!SendGoals(goal_count)) {
+    state.SkipWithError("Valid goals were not accepted");
+    return;
+  }
+  for (auto & goal_handle : server_goal_handles) {
+    goal_handle->execute();
+  }
+  auto feedback = std::make_shared<Fibonacci::Feedback>();
+  feedback->sequence = result->sequence;
+
+  reset_heap_counters();
+  for (auto _ : state) {
+    (void)_;
+    // Each goal publishes a feedback message, all of which the client dispatches
+    const size_t expected_feedback_count = feedback_count + goal_count;
+    for (auto & goal_handle : server_goal_handles) {
+      goal_handle->publish_feedback(feedback);
+    }
+    if (!SpinUntil([&]() {return feedback_count == expected_feedback_count;})) {
+      state.SkipWithError("Feedback was not received");
+      return;
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * goal_count));
+
+  if (!SucceedGoals()) {
+    state.SkipWithError("Results were not received");
+  }
+}
+BENCHMARK_REGISTER_F(ActionConcurrencyPerformanceTest, feedback_fan_out)->Apply(goal_counts);
+
+BENCHMARK_DEFINE_F(ActionConcurrencyPerformanceTest, status_publish)(benchmark::State & state)
+{
+  // The other goals stay active, so that each status message lists all of them
+  if (goal_count > 1 && !SendGoals(goal_count - 1)) {
+    state.SkipWithError("Valid goals were not accepted");
+    return;
+  }
+  auto active_goal_handles = std::move(server_goal_handles);
+  server_goal_handles.clear();
+  auto active_client_goal_handles = std::move(client_goal_handles);
+  client_goal_handles.clear();
+
+  reset_heap_counters();
+  for (auto _ : state) {
+    (void)_;
+    state.PauseTiming();
+    if (!SendGoals(1)) {
+      state.SkipWithError("Valid goal was not accepted");
+      return;
+    }
+    state.ResumeTiming();
+
+    // The state change of the goal publishes the status message
+    server_goal_handles.front()->execute();
+
+    state.PauseTiming();
+    if (!SucceedGoals()) {
+      state.SkipWithError("Result was not received");
+      return;
+    }
+    state.ResumeTiming();
+  }
+
+  server_goal_handles = std::move(active_goal_handles);
+  client_goal_handles = std::move(active_client_goal_handles);
+  if (!SucceedGoals()) {
+    state.SkipWithError("Results were not received");
+  }
+}
+BENCHMARK_REGISTER_F(ActionConcurrencyPerformanceTest, status_publish)->Apply(goal_counts);
+
+BENCHMARK_DEFINE_F(ActionConcurrencyPerformanceTest, result_latency)(benchmark::State & state)
+{
+  reset_heap_counters();
+  for (auto _ : state) {
+    (void)_;
+    state.PauseTiming();
+    // The client requests the results with the goal responses, spinning lets the server take
+    // some of them before the goals succeed
+    if (!SendGoals(goal_count)) {
+      state.SkipWithError("Valid goals were not accepted");
+      return;
+    }
+    executor->spin_some();
+    state.ResumeTiming();
+
+    if (!SucceedGoals()) {
+      state.SkipWithError("Results were not received");
+      return;
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * goal_count));
+}
+BENCHMARK_REGISTER_F(ActionConcurrencyPerformanceTest, result_latency)->Apply(goal_counts);
+
+BENCHMARK_DEFINE_F(ActionConcurrencyPerformanceTest, retained_goal_memory)(
+  benchmark::State & state)
+{
+  // The byte limit only enables the measurement of the serialized size of the results
+  action_server->set_result_retention_limits(goal_count, std::numeric_limits<size_t>::max());
+
+  reset_heap_counters();
+  for (auto _ : state) {
+    (void)_;
+    state.PauseTiming();
+    if (!SendGoals(goal_count)) {
+      state.SkipWithError("Valid goals were not accepted");
+      return;
+    }
+    state.ResumeTiming();
+
+    // Timing the goals reaching a terminal state, whose results are retained
+    if (!SucceedGoals()) {
+      state.SkipWithError("Results were not received");
+      return;
+    }
+  }
+
+  const auto statistics = action_server->get_result_retention_statistics();
+  if (statistics.retained_results > 0) {
+    state.counters["retained_results"] = static_cast<double>(statistics.retained_results);
+    state.counters["retained_bytes_per_goal"] =
+      static_cast<double>(statistics.retained_bytes) /
+      static_cast<double>(statistics.retained_results);
+  }
+}
+BENCHMARK_REGISTER_F(ActionConcurrencyPerformanceTest, retained_goal_memory)->Apply(goal_counts);
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <memory>
+#include <thread>
 #include <vector>
 
 #include "gtest/gtest.h"
@@ -25,6 +26,7 @@
 
 #include "rcl_action/action_server.h"
 #include "rcl_action/wait.h"
+#include "rclcpp_action/create_client.hpp"
 #include "rclcpp_action/create_server.hpp"
 #include "rclcpp_action/server.hpp"
 #include "mocking_utils/patch.hpp"
@@ -767,6 +769,144 @@ TEST_F(TestServer, publish_status_aborted)
   EXPECT_EQ(uuid, msg->status_list.at(0).goal_info.goal_id.uuid);
 }
 
+TEST_F(TestServer, publish_status_max_terminal_goals)
+{
+  auto node = std::make_shared<rclcpp::Node>(
+    "status_max_terminal", "/rclcpp_action/status_max_terminal");
+
+  auto handle_goal = [](
+    const GoalUUID &, std::shared_ptr<const Fibonacci::Goal>)
+    {
+      return rclcpp_action::GoalResponse::ACCEPT_AND_EXECUTE;
+    };
+
+  using GoalHandle = rclcpp_action::ServerGoalHandle<Fibonacci>;
+
+  auto handle_cancel = [](std::shared_ptr<GoalHandle>)
+    {
+      return rclcpp_action::CancelResponse::REJECT;
+    };
+
+  std::vector<std::shared_ptr<GoalHandle>> received_handles;
+  auto handle_accepted = [&received_handles](std::shared_ptr<GoalHandle> handle)
+    {
+      received_handles.push_back(handle);
+    };
+
+  auto as = rclcpp_action::create_server<Fibonacci>(
+    node, "fibonacci",
+    handle_goal,
+    handle_cancel,
+    handle_accepted);
+  as->set_max_terminal_goal_statuses(2);
+
+  // Subscribe to status messages
+  std::vector<action_msgs::msg::GoalStatusArray::ConstSharedPtr> received_msgs;
+  auto subscriber = node->create_subscription<action_msgs::msg::GoalStatusArray>(
+    "fibonacci/_action/status", 10,
+    [&received_msgs](action_msgs::msg::GoalStatusArray::ConstSharedPtr list)
+    {
+      received_msgs.push_back(list);
+    });
+
+  std::vector<GoalUUID> uuids;
+  for (uint8_t i = 0; i < 4; ++i) {
+    GoalUUID uuid{};
+    uuid[0] = i + 1;
+    send_goal_request(node, uuid);
+    uuids.push_back(uuid);
+  }
+  ASSERT_EQ(4u, received_handles.size());
+  // The last goal keeps executing
+  for (size_t i = 0; i < 3; ++i) {
+    received_handles[i]->succeed(std::make_shared<Fibonacci::Result>());
+  }
+
+  // 10 seconds
+  const size_t max_tries = 10 * 1000 / 100;
+  for (size_t retry = 0; retry < max_tries && received_msgs.size() < 7u; ++retry) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    rclcpp::spin_some(node);
+  }
+
+  ASSERT_LT(0u, received_msgs.size());
+  auto & msg = received_msgs.back();
+  // The oldest terminal goal is left out
+  ASSERT_EQ(3u, msg->status_list.size());
+  EXPECT_EQ(uuids[1], msg->status_list.at(0).goal_info.goal_id.uuid);
+  EXPECT_EQ(action_msgs::msg::GoalStatus::STATUS_SUCCEEDED, msg->status_list.at(0).status);
+  EXPECT_EQ(uuids[2], msg->status_list.at(1).goal_info.goal_id.uuid);
+  EXPECT_EQ(action_msgs::msg::GoalStatus::STATUS_SUCCEEDED, msg->status_list.at(1).status);
+  EXPECT_EQ(uuids[3], msg->status_list.at(2).goal_info.goal_id.uuid);
+  EXPECT_EQ(action_msgs::msg::GoalStatus::STATUS_EXECUTING, msg->status_list.at(2).status);
+}
+
+TEST_F(TestServer, publish_status_coalesced)
+{
+  auto node = std::make_shared<rclcpp::Node>(
+    "status_coalesced", "/rclcpp_action/status_coalesced");
+
+  auto handle_goal = [](
+    const GoalUUID &, std::shared_ptr<const Fibonacci::Goal>)
+    {
+      return rclcpp_action::GoalResponse::ACCEPT_AND_EXECUTE;
+    };
+
+  using GoalHandle = rclcpp_action::ServerGoalHandle<Fibonacci>;
+
+  auto handle_cancel = [](std::shared_ptr<GoalHandle>)
+    {
+      return rclcpp_action::CancelResponse::REJECT;
+    };
+
+  std::vector<std::shared_ptr<GoalHandle>> received_handles;
+  auto handle_accepted = [&received_handles](std::shared_ptr<GoalHandle> handle)
+    {
+      received_handles.push_back(handle);
+    };
+
+  auto as = rclcpp_action::create_server<Fibonacci>(
+    node, "fibonacci",
+    handle_goal,
+    handle_cancel,
+    handle_accepted);
+  as->set_status_publish_period(std::chrono::seconds(1));
+
+  // Subscribe to status messages
+  std::vector<action_msgs::msg::GoalStatusArray::ConstSharedPtr> received_msgs;
+  auto subscriber = node->create_subscription<action_msgs::msg::GoalStatusArray>(
+    "fibonacci/_action/status", 10,
+    [&received_msgs](action_msgs::msg::GoalStatusArray::ConstSharedPtr list)
+    {
+      received_msgs.push_back(list);
+    });
+
+  // The first state change is published right away, the next ones at the end of the period
+  const GoalUUID first_uuid{{1}};
+  const GoalUUID second_uuid{{2}};
+  send_goal_request(node, first_uuid);
+  send_goal_request(node, second_uuid);
+  ASSERT_EQ(2u, received_handles.size());
+  received_handles[0]->succeed(std::make_shared<Fibonacci::Result>());
+  received_handles[1]->abort(std::make_shared<Fibonacci::Result>());
+
+  // 3 seconds
+  const size_t max_tries = 3 * 1000 / 100;
+  for (size_t retry = 0; retry < max_tries; ++retry) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    rclcpp::spin_some(node);
+  }
+
+  ASSERT_EQ(2u, received_msgs.size());
+  ASSERT_EQ(1u, received_msgs.front()->status_list.size());
+  auto & msg = received_msgs.back();
+  ASSERT_EQ(2u, msg->status_list.size());
+  EXPECT_EQ(first_uuid, msg->status_list.at(0).goal_info.goal_id.uuid);
+  EXPECT_EQ(action_msgs::msg::GoalStatus::STATUS_SUCCEEDED, msg->status_list.at(0).status);
+  EXPECT_EQ(second_uuid, msg->status_list.at(1).goal_info.goal_id.uuid);
+  EXPECT_EQ(action_msgs::msg::GoalStatus::STATUS_ABORTED, msg->status_list.at(1).status);
+}
+
 TEST_F(TestServer, publish_feedback)
 {
   auto node = std::make_shared<rclcpp::Node>("pub_feedback", "/rclcpp_action/pub_feedback");
@@ -825,6 +965,136 @@ TEST_F(TestServer, publish_feedback)
   ASSERT_EQ(sent_message->sequence, msg->feedback.sequence);
 }
 
+TEST_F(TestServer, publish_feedback_rate_limited)
+{
+  auto node = std::make_shared<rclcpp::Node>(
+    "pub_feedback_rate_limited", "/rclcpp_action/pub_feedback_rate_limited");
+  const GoalUUID uuid{{1, 20, 30, 4, 5, 6, 70, 8, 9, 1, 11, 120, 13, 14, 15, 161}};
+
+  auto handle_goal = [](
+    const GoalUUID &, std::shared_ptr<const Fibonacci::Goal>)
+    {
+      return rclcpp_action::GoalResponse::ACCEPT_AND_EXECUTE;
+    };
+
+  using GoalHandle = rclcpp_action::ServerGoalHandle<Fibonacci>;
+
+  auto handle_cancel = [](std::shared_ptr<GoalHandle>)
+    {
+      return rclcpp_action::CancelResponse::REJECT;
+    };
+
+  std::shared_ptr<GoalHandle> received_handle;
+  auto handle_accepted = [&received_handle](std::shared_ptr<GoalHandle> handle)
+    {
+      received_handle = handle;
+    };
+
+  auto as = rclcpp_action::create_server<Fibonacci>(
+    node, "fibonacci",
+    handle_goal,
+    handle_cancel,
+    handle_accepted);
+  as->set_feedback_publish_period(std::chrono::seconds(10));
+
+  // Subscribe to feedback messages
+  using FeedbackT = Fibonacci::Impl::FeedbackMessage;
+  std::vector<FeedbackT::ConstSharedPtr> received_msgs;
+  auto subscriber = node->create_subscription<FeedbackT>(
+    "fibonacci/_action/feedback", 10, [&received_msgs](FeedbackT::ConstSharedPtr msg)
+    {
+      received_msgs.push_back(msg);
+    });
+
+  send_goal_request(node, uuid);
+
+  // The first feedback is published right away, the latest one when the goal succeeds
+  auto sent_message = std::make_shared<Fibonacci::Feedback>();
+  for (int32_t i = 0; i < 100; ++i) {
+    sent_message->sequence.push_back(i);
+    received_handle->publish_feedback(sent_message);
+  }
+  received_handle->succeed(std::make_shared<Fibonacci::Result>());
+
+  // 3 seconds
+  const size_t max_tries = 3 * 1000 / 100;
+  for (size_t retry = 0; retry < max_tries; ++retry) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    rclcpp::spin_some(node);
+  }
+
+  ASSERT_EQ(2u, received_msgs.size());
+  EXPECT_EQ(1u, received_msgs.front()->feedback.sequence.size());
+  EXPECT_EQ(sent_message->sequence, received_msgs.back()->feedback.sequence);
+}
+
+TEST_F(TestServer, intra_process_round_trip)
+{
+  auto node = std::make_shared<rclcpp::Node>(
+    "intra_process_round_trip", "/rclcpp_action/intra_process_round_trip",
+    rclcpp::NodeOptions().use_intra_process_comms(true));
+
+  using GoalHandle = rclcpp_action::ServerGoalHandle<Fibonacci>;
+  auto as = rclcpp_action::create_server<Fibonacci>(
+    node, "fibonacci",
+    [](const GoalUUID &, std::shared_ptr<const Fibonacci::Goal>) {
+      return rclcpp_action::GoalResponse::ACCEPT_AND_EXECUTE;
+    },
+    [](std::shared_ptr<GoalHandle>) {
+      return rclcpp_action::CancelResponse::REJECT;
+    },
+    [](std::shared_ptr<GoalHandle> handle) {
+      auto feedback = std::make_shared<Fibonacci::Feedback>();
+      feedback->sequence.resize(static_cast<size_t>(handle->get_goal()->order), 1);
+      handle->publish_feedback(feedback);
+      auto result = std::make_shared<Fibonacci::Result>();
+      result->sequence = feedback->sequence;
+      handle->succeed(result);
+    });
+  ASSERT_NE(nullptr, as->get_intra_process_waitable());
+
+  // The feedback of a goal sent by pointer isn't published through the middleware
+  size_t published_feedback = 0;
+  auto other_node = std::make_shared<rclcpp::Node>(
+    "intra_process_round_trip_other", "/rclcpp_action/intra_process_round_trip");
+  auto subscriber = other_node->create_subscription<Fibonacci::Impl::FeedbackMessage>(
+    "fibonacci/_action/feedback", 10,
+    [&published_feedback](Fibonacci::Impl::FeedbackMessage::ConstSharedPtr) {
+      ++published_feedback;
+    });
+
+  auto ac = rclcpp_action::create_client<Fibonacci>(node, "fibonacci");
+  ASSERT_NE(nullptr, ac->get_intra_process_waitable());
+
+  std::vector<int32_t> received_feedback;
+  auto options = rclcpp_action::Client<Fibonacci>::SendGoalOptions();
+  options.feedback_callback = [&received_feedback](
+    rclcpp_action::ClientGoalHandle<Fibonacci>::SharedPtr,
+    const std::shared_ptr<const Fibonacci::Feedback> feedback) {
+      received_feedback = feedback->sequence;
+    };
+  Fibonacci::Goal goal;
+  goal.order = 3;
+  auto goal_future = ac->async_send_goal(goal, options);
+  ASSERT_EQ(
+    rclcpp::FutureReturnCode::SUCCESS,
+    rclcpp::spin_until_future_complete(node, goal_future, std::chrono::seconds(5)));
+  auto goal_handle = goal_future.get();
+  ASSERT_NE(nullptr, goal_handle);
+
+  auto result_future = ac->async_get_result(goal_handle);
+  ASSERT_EQ(
+    rclcpp::FutureReturnCode::SUCCESS,
+    rclcpp::spin_until_future_complete(node, result_future, std::chrono::seconds(5)));
+  auto wrapped_result = result_future.get();
+  EXPECT_EQ(rclcpp_action::ResultCode::SUCCEEDED, wrapped_result.code);
+  EXPECT_EQ(std::vector<int32_t>({1, 1, 1}), wrapped_result.result->sequence);
+  EXPECT_EQ(std::vector<int32_t>({1, 1, 1}), received_feedback);
+
+  rclcpp::spin_some(other_node);
+  EXPECT_EQ(0u, published_feedback);
+}
+
 TEST_F(TestServer, get_result)
 {
   auto node = std::make_shared<rclcpp::Node>("get_result", "/rclcpp_action/get_result");
@@ -903,6 +1173,185 @@ TEST_F(TestServer, get_result)
   EXPECT_EQ(action_msgs::msg::GoalStatus::STATUS_UNKNOWN, response->status);
 }
 
+TEST_F(TestServer, concurrent_goals)
+{
+  auto node = std::make_shared<rclcpp::Node>(
+    "concurrent_goals", "/rclcpp_action/concurrent_goals");
+
+  auto handle_goal = [](
+    const GoalUUID &, std::shared_ptr<const Fibonacci::Goal>)
+    {
+      return rclcpp_action::GoalResponse::ACCEPT_AND_EXECUTE;
+    };
+
+  using GoalHandle = rclcpp_action::ServerGoalHandle<Fibonacci>;
+
+  auto handle_cancel = [](std::shared_ptr<GoalHandle>)
+    {
+      return rclcpp_action::CancelResponse::REJECT;
+    };
+
+  std::vector<std::shared_ptr<GoalHandle>> received_handles;
+  auto handle_accepted = [&received_handles](std::shared_ptr<GoalHandle> handle)
+    {
+      received_handles.push_back(handle);
+    };
+
+  auto as = rclcpp_action::create_server<Fibonacci>(
+    node, "fibonacci",
+    handle_goal,
+    handle_cancel,
+    handle_accepted);
+  (void)as;
+
+  constexpr uint8_t goal_count = 8;
+  std::vector<GoalUUID> uuids;
+  for (uint8_t i = 0; i < goal_count; ++i) {
+    GoalUUID uuid{};
+    uuid[0] = i + 1;
+    send_goal_request(node, uuid);
+    uuids.push_back(uuid);
+  }
+  ASSERT_EQ(goal_count, received_handles.size());
+
+  auto result_client = node->create_client<Fibonacci::Impl::GetResultService>(
+    "fibonacci/_action/get_result");
+  if (!result_client->wait_for_service(std::chrono::seconds(20))) {
+    throw std::runtime_error("get result service didn't become available");
+  }
+  std::vector<rclcpp::Client<Fibonacci::Impl::GetResultService>::SharedFuture> futures;
+  for (const auto & uuid : uuids) {
+    auto request = std::make_shared<Fibonacci::Impl::GetResultService::Request>();
+    request->goal_id.uuid = uuid;
+    futures.push_back(result_client->async_send_request(request).share());
+  }
+
+  // The goals publish feedback and finish concurrently
+  std::vector<std::thread> threads;
+  for (const auto & handle : received_handles) {
+    threads.emplace_back(
+      [handle]() {
+        auto feedback = std::make_shared<Fibonacci::Feedback>();
+        for (int i = 0; i < 50; ++i) {
+          feedback->sequence.push_back(i);
+          handle->publish_feedback(feedback);
+        }
+        auto result = std::make_shared<Fibonacci::Result>();
+        result->sequence = feedback->sequence;
+        handle->succeed(result);
+      });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+
+  for (auto & future : futures) {
+    ASSERT_EQ(
+      rclcpp::FutureReturnCode::SUCCESS,
+      rclcpp::spin_until_future_complete(node, future));
+    auto response = future.get();
+    EXPECT_EQ(action_msgs::msg::GoalStatus::STATUS_SUCCEEDED, response->status);
+    EXPECT_EQ(50u, response->result.sequence.size());
+  }
+}
+
+TEST_F(TestServer, result_retention_limits)
+{
+  auto node = std::make_shared<rclcpp::Node>(
+    "result_retention", "/rclcpp_action/result_retention");
+
+  auto handle_goal = [](
+    const GoalUUID &, std::shared_ptr<const Fibonacci::Goal>)
+    {
+      return rclcpp_action::GoalResponse::ACCEPT_AND_EXECUTE;
+    };
+
+  using GoalHandle = rclcpp_action::ServerGoalHandle<Fibonacci>;
+
+  auto handle_cancel = [](std::shared_ptr<GoalHandle>)
+    {
+      return rclcpp_action::CancelResponse::REJECT;
+    };
+
+  std::vector<std::shared_ptr<GoalHandle>> received_handles;
+  auto handle_accepted = [&received_handles](std::shared_ptr<GoalHandle> handle)
+    {
+      received_handles.push_back(handle);
+    };
+
+  auto as = rclcpp_action::create_server<Fibonacci>(
+    node, "fibonacci",
+    handle_goal,
+    handle_cancel,
+    handle_accepted);
+  as->set_result_retention_limits(2);
+
+  std::vector<GoalUUID> uuids;
+  for (uint8_t i = 0; i < 3; ++i) {
+    GoalUUID uuid{};
+    uuid[0] = i + 1;
+    send_goal_request(node, uuid);
+    uuids.push_back(uuid);
+  }
+  ASSERT_EQ(3u, received_handles.size());
+  auto result = std::make_shared<Fibonacci::Result>();
+  result->sequence = {5, 8, 13, 21};
+  for (auto & handle : received_handles) {
+    handle->succeed(result);
+  }
+
+  auto statistics = as->get_result_retention_statistics();
+  EXPECT_EQ(2u, statistics.retained_results);
+  EXPECT_EQ(0u, statistics.retained_bytes);
+  EXPECT_EQ(1u, statistics.evicted_results);
+
+  auto result_client = node->create_client<Fibonacci::Impl::GetResultService>(
+    "fibonacci/_action/get_result");
+  if (!result_client->wait_for_service(std::chrono::seconds(20))) {
+    throw std::runtime_error("get result service didn't become available");
+  }
+  auto get_result = [&](const GoalUUID & uuid)
+    {
+      auto request = std::make_shared<Fibonacci::Impl::GetResultService::Request>();
+      request->goal_id.uuid = uuid;
+      auto future = result_client->async_send_request(request);
+      EXPECT_EQ(
+        rclcpp::FutureReturnCode::SUCCESS,
+        rclcpp::spin_until_future_complete(node, future));
+      return future.get();
+    };
+
+  // The least recently used result was evicted
+  EXPECT_EQ(action_msgs::msg::GoalStatus::STATUS_UNKNOWN, get_result(uuids[0])->status);
+  auto response = get_result(uuids[1]);
+  EXPECT_EQ(action_msgs::msg::GoalStatus::STATUS_SUCCEEDED, response->status);
+  EXPECT_EQ(result->sequence, response->result.sequence);
+
+  // The second goal was used more recently than the third one
+  as->set_result_retention_limits(1);
+  EXPECT_EQ(2u, as->get_result_retention_statistics().evicted_results);
+  EXPECT_EQ(action_msgs::msg::GoalStatus::STATUS_SUCCEEDED, get_result(uuids[1])->status);
+  EXPECT_EQ(action_msgs::msg::GoalStatus::STATUS_UNKNOWN, get_result(uuids[2])->status);
+
+  // Only the results stored while a byte limit is set are measured
+  as->set_result_retention_limits(0, 1000000);
+  GoalUUID uuid{};
+  uuid[0] = 4;
+  send_goal_request(node, uuid);
+  received_handles.back()->succeed(result);
+  statistics = as->get_result_retention_statistics();
+  EXPECT_EQ(2u, statistics.retained_results);
+  EXPECT_LT(0u, statistics.retained_bytes);
+  const size_t result_size = statistics.retained_bytes;
+
+  // The newest result is kept even if it alone exceeds the limit
+  as->set_result_retention_limits(0, result_size / 2);
+  statistics = as->get_result_retention_statistics();
+  EXPECT_EQ(1u, statistics.retained_results);
+  EXPECT_EQ(result_size, statistics.retained_bytes);
+  EXPECT_EQ(3u, statistics.evicted_results);
+}
+
 TEST_F(TestServer, get_result_deferred)
 {
   auto node = std::make_shared<rclcpp::Node>("get_result", "/rclcpp_action/get_result");
@@ -1147,18 +1596,10 @@ TEST_F(TestGoalRequestServer, execute_goal_request_received_update_goal_state_er
   EXPECT_THROW(SendClientGoalRequest(), rclcpp::exceptions::RCLError);
 }
 
-TEST_F(TestGoalRequestServer, publish_status_server_get_goal_handles_errors)
-{
-  auto mock = mocking_utils::patch_and_return(
-    "lib:rclcpp_action", rcl_action_server_get_goal_handles, RCL_RET_ERROR);
-
-  EXPECT_THROW(SendClientGoalRequest(), rclcpp::exceptions::RCLError);
-}
-
-TEST_F(TestGoalRequestServer, publish_status_get_goal_status_array_errors)
+TEST_F(TestGoalRequestServer, publish_status_goal_handle_get_info_errors)
 {
   auto mock = mocking_utils::patch_and_return(
-    "lib:rclcpp_action", rcl_action_get_goal_status_array, RCL_RET_ERROR);
+    "lib:rclcpp_action", rcl_action_goal_handle_get_info, RCL_RET_ERROR);
 
   EXPECT_THROW(SendClientGoalRequest(), rclcpp::exceptions::RCLError);
 }
@@ -14,7 +14,9 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <limits>
+#include <unordered_set>
 #include "rclcpp_action/types.hpp"
 
 TEST(TestActionTypes, goal_uuid_to_string) {
@@ -59,3 +61,34 @@ TEST(TestActionTypes, rcl_action_goal_info_to_goal_uuid) {
     EXPECT_EQ(goal_info.goal_id.uuid[i], goal_id[i]);
   }
 }
+
+TEST(TestActionTypes, goal_uuid_hash) {
+  std::hash<rclcpp_action::GoalUUID> hash;
+  // Ids differing in a single bit or in permuted bytes all have different hashes
+  std::unordered_set<size_t> hashes;
+  rclcpp_action::GoalUUID goal_id{};
+  hashes.insert(hash(goal_id));
+  for (uint8_t i = 0; i < UUID_SIZE; ++i) {
+    for (uint8_t bit = 0; bit < 8; ++bit) {
+      rclcpp_action::GoalUUID single_bit_id{};
+      single_bit_id[i] = static_cast<uint8_t>(1u << bit);
+      hashes.insert(hash(single_bit_id));
+    }
+    goal_id[i] = i;
+  }
+  EXPECT_EQ(1u + 8u * UUID_SIZE, hashes.size());
+
+  rclcpp_action::GoalUUID reversed_id;
+  std::reverse_copy(goal_id.begin(), goal_id.end(), reversed_id.begin());
+  EXPECT_NE(hash(goal_id), hash(reversed_id));
+
+  // Sequential ids spread over the buckets of a small table
+  std::unordered_set<size_t> buckets;
+  for (uint16_t i = 0; i < 256; ++i) {
+    rclcpp_action::GoalUUID sequential_id{};
+    sequential_id[14] = static_cast<uint8_t>(i >> 8);
+    sequential_id[15] = static_cast<uint8_t>(i);
+    buckets.insert(hash(sequential_id) % 16);
+  }
+  EXPECT_EQ(16u, buckets.size());
+}
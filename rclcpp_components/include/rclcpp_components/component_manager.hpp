@@ -41,8 +41,11 @@
 #ifndef RCLCPP_COMPONENTS__COMPONENT_MANAGER_HPP__
 #define RCLCPP_COMPONENTS__COMPONENT_MANAGER_HPP__
 
+#include <chrono>
+#include <condition_variable>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -51,9 +54,11 @@
 #include "composition_interfaces/srv/unload_node.hpp"
 #include "composition_interfaces/srv/list_nodes.hpp"
 
+#include "rclcpp/deserialization_thread_pool.hpp"
 #include "rclcpp/executor.hpp"
 #include "rclcpp/node_options.hpp"
 #include "rclcpp/rclcpp.hpp"
+#include "rclcpp/thread.hpp"
 
 #include "rclcpp_components/node_factory.hpp"
 #include "rclcpp_components/visibility_control.hpp"
@@ -75,6 +80,45 @@ public:
 };
 
 /// ComponentManager handles the services to load, unload, and get the list of loaded components.
+/**
+ * The components are loaded one at a time in the thread handling the load node service by
+ * default.
+ * With the read-only parameter `load_thread_num` greater than 1, that number of threads load
+ * the libraries and construct the nodes of the load requests concurrently.
+ * The loaded nodes are still registered in the order of the requests, so they get the same
+ * unique ids as if they had been loaded one after the other, and the responses are sent in
+ * that order.
+ * With the read-only parameter `load_on_worker_pool` set to true, the components are loaded
+ * by the worker pool of the context instead, see rclcpp::Context::get_worker_pool(), so that
+ * the managers of a process don't each start their own load threads.
+ *
+ * The component resources of the packages and the classes of the libraries are cached at first
+ * use.
+ * The libraries of the packages listed by the read-only parameter `preload_packages`, e.g. all
+ * the packages of a launch file, are loaded by the constructor, before the first load request.
+ *
+ * A component is added to the executor of the manager, unless its load request has one of
+ * these extra arguments, in which case it gets its own executor spun by its own thread:
+ * - `executor_type`: "single_threaded", "static_single_threaded", "multi_threaded" or
+ *   "static_multi_threaded", by default multi-threaded if more than one thread is requested.
+ * - `executor_thread_num`: number of threads of a multi-threaded executor, by default one per
+ *   CPU of `executor_cpus`, or the default of the executor.
+ * - `executor_cpus`: CPUs the threads of the executor are pinned to.
+ *
+ * The read-only parameter `use_intra_process_comms` enables the intra-process communication
+ * of all the components, unless the extra argument of the same name of a load request
+ * disables it.
+ * Likewise, the read-only parameter `start_lifecycle_services` set to false keeps the
+ * lifecycle components from creating their lifecycle services and transition_event publisher,
+ * see rclcpp::NodeOptions::start_lifecycle_services().
+ * The read-only parameter `lightweight_components`, or the extra argument `lightweight` of a
+ * load request, creates the components as lightweight nodes, see
+ * rclcpp::NodeOptions::lightweight().
+ *
+ * A load request with the extra argument `reload_unique_id` reloads the component of that
+ * unique id instead of loading a new one, see reload_node().
+ * A reload is answered once done, before the loads still in progress.
+ */
 class ComponentManager : public rclcpp::Node
 {
 public:
@@ -88,6 +132,29 @@ public:
    */
   using ComponentResource = std::pair<std::string, std::string>;
 
+  /// Time spent in the phases of loading the components, added up over all the loads.
+  /**
+   * The phases of the components loaded concurrently overlap, their sum can exceed the elapsed
+   * time.
+   */
+  struct LoadTimings
+  {
+    /// Looking up the component resources in the ament resource index.
+    std::chrono::nanoseconds resource_lookup {0};
+    /// Loading the libraries and listing their classes.
+    std::chrono::nanoseconds library_load {0};
+    /// Instantiating the node factories.
+    std::chrono::nanoseconds factory_creation {0};
+    /// Running the constructors of the nodes.
+    std::chrono::nanoseconds node_construction {0};
+    /// Adding the nodes to the executor model.
+    std::chrono::nanoseconds executor_registration {0};
+    /// Number of libraries loaded, including the preloaded ones.
+    size_t loaded_libraries {0};
+    /// Number of nodes loaded.
+    size_t loaded_nodes {0};
+  };
+
   /// Default constructor
   /**
    * Initializes the component manager. It creates the services: load node, unload node
@@ -111,6 +178,8 @@ public:
 
   /// Return a list of valid loadable components in a given package.
   /**
+   * The resources are read from the resource index once per package, and cached.
+   *
    * \param package_name name of the package
    * \param resource_index name of the executable
    * \throws ComponentManagerException if the resource was not found or a invalid resource entry
@@ -124,6 +193,8 @@ public:
 
   /// Instantiate a component from a dynamic library.
   /**
+   * The library is loaded and its classes are listed at first use only.
+   *
    * \param resource a component resource (class name + library path)
    * \return a NodeFactory interface
    */
@@ -139,6 +210,65 @@ public:
   virtual void
   set_executor(const std::weak_ptr<rclcpp::Executor> executor);
 
+  /// Load several components in one call.
+  /**
+   * The nodes are constructed concurrently by the load threads, see the `load_thread_num`
+   * parameter, and registered in the order of the requests.
+   * The unique ids are therefore the same as if the requests had been sent to the load node
+   * service one after the other, whatever order the constructors finish in.
+   *
+   * This function is thread-safe.
+   *
+   * \param requests information with the nodes to load
+   * \return the responses, in the order of the requests
+   */
+  RCLCPP_COMPONENTS_PUBLIC
+  std::vector<std::shared_ptr<LoadNode::Response>>
+  load_nodes(const std::vector<std::shared_ptr<LoadNode::Request>> & requests);
+
+  /// Load the libraries of the components of a package ahead of the load requests.
+  /**
+   * This function is thread-safe.
+   *
+   * \param package_name name of the package
+   * \param resource_index name of the executable
+   * \throws ComponentManagerException if the resource was not found, was invalid, or if a
+   *   library failed to load
+   */
+  RCLCPP_COMPONENTS_PUBLIC
+  void
+  preload_libraries(
+    const std::string & package_name,
+    const std::string & resource_index = "rclcpp_components");
+
+  /// Return the time spent in the phases of loading the components so far.
+  /** This function is thread-safe. */
+  RCLCPP_COMPONENTS_PUBLIC
+  LoadTimings
+  get_load_timings() const;
+
+  /// Replace a component by a new instance, handing the entities of the old one over to it.
+  /**
+   * The component is destroyed and created again from the request, which can name another
+   * plugin or package, e.g. a new version of the component installed in another library.
+   * The new instance keeps the unique id of the component.
+   * The rcl node, publishers and subscriptions of the old instance are used by the new one
+   * when their names, topics, types and QoS match, see rclcpp::EntityHandoff, so the other
+   * participants don't have to discover them again.
+   * The libraries are never unloaded, reloading a component from the same library runs the
+   * same code.
+   *
+   * If the new instance fails to be created, the component is unloaded.
+   * This function is thread-safe.
+   *
+   * \param unique_id unique id of the component to reload
+   * \param request information with the node to load instead
+   * \return the response, as for a load request
+   */
+  RCLCPP_COMPONENTS_PUBLIC
+  std::shared_ptr<LoadNode::Response>
+  reload_node(uint64_t unique_id, const std::shared_ptr<LoadNode::Request> & request);
+
 protected:
   /// Create node options for loaded component
   /**
@@ -169,6 +299,8 @@ protected:
   /**
    * This function allows to add parameters, remap rules, a specific node, name a namespace
    * and/or additional arguments.
+   * It's only the callback of the service while the components are loaded one at a time, see
+   * the `load_thread_num` parameter.
    *
    * \param request_header unused
    * \param request information with the node to load
@@ -257,15 +389,110 @@ protected:
   }
 
 protected:
+  /// Wait for the components being loaded concurrently, and stop the load threads.
+  /**
+   * The destructor of a derived class overriding add_node_to_executor() needs to call it first.
+   */
+  RCLCPP_COMPONENTS_PUBLIC
+  void
+  stop_load_threads();
+
   std::weak_ptr<rclcpp::Executor> executor_;
 
   uint64_t unique_id_ {1};
+  std::mutex loaders_mutex_;
   std::map<std::string, std::unique_ptr<class_loader::ClassLoader>> loaders_;
+  /// Classes of the node factories of the libraries in loaders_.
+  std::map<std::string, std::vector<std::string>> loader_classes_;
+  /// Protects unique_id_, node_wrappers_ and the nodes of the executor model.
+  std::mutex node_wrappers_mutex_;
   std::map<uint64_t, rclcpp_components::NodeInstanceWrapper> node_wrappers_;
+  /// Extra arguments of the load requests of the nodes in node_wrappers_.
+  /**
+   * They are set before add_node_to_executor() is called, e.g. to place the node.
+   */
+  std::map<uint64_t, std::vector<rclcpp::Parameter>> node_extra_arguments_;
 
   rclcpp::Service<LoadNode>::SharedPtr loadNode_srv_;
   rclcpp::Service<UnloadNode>::SharedPtr unloadNode_srv_;
   rclcpp::Service<ListNodes>::SharedPtr listNodes_srv_;
+
+private:
+  struct PendingLoad;
+
+  /// Executor of a component requested by the extra arguments of its load request.
+  struct ComponentExecutor
+  {
+    std::shared_ptr<rclcpp::Executor> executor;
+    rclcpp::Thread thread;
+  };
+
+  /// Add the node to its own executor if the extra arguments request one.
+  /**
+   * node_wrappers_mutex_ must be locked.
+   * \return false if the node has to be added to the executor of the manager.
+   */
+  bool
+  add_node_to_component_executor(uint64_t node_id);
+
+  /// Load the library if it isn't yet, and return its loader.
+  /** loaders_mutex_ must be locked. */
+  class_loader::ClassLoader *
+  load_library(const std::string & library_path);
+
+  /// Add the time elapsed since start to a phase of the load timings.
+  void
+  add_load_timing(
+    std::chrono::nanoseconds LoadTimings::* phase,
+    std::chrono::steady_clock::time_point start);
+
+  /// Find the factory of the requested component and construct its node.
+  void
+  construct_node(PendingLoad & load);
+
+  /// Give the constructed node its unique id and add it to the executor model.
+  void
+  register_node(PendingLoad & load);
+
+  /// Add the constructed node to node_wrappers_ and to the executor model, and answer its load.
+  /** node_wrappers_mutex_ must be locked. */
+  void
+  add_loaded_node(uint64_t node_id, PendingLoad & load);
+
+  /// Reload the component if the request has the extra argument `reload_unique_id`.
+  /** \return false if the request loads a new component. */
+  bool
+  reload_requested_node(
+    const std::shared_ptr<LoadNode::Request> & request, LoadNode::Response & response);
+
+  /// Load the component in a load thread, registering it after the previous requests.
+  void
+  enqueue_load(std::shared_ptr<PendingLoad> load);
+
+  /// Register the loads constructed so far, in the order of the requests.
+  void
+  finish_load(uint64_t ticket);
+
+  rclcpp::DeserializationThreadPool::SharedPtr load_thread_pool_;
+  std::mutex pending_loads_mutex_;
+  /// Notified when all the pending loads are registered.
+  std::condition_variable pending_loads_condition_;
+  uint64_t next_load_ticket_ {0};
+  std::map<uint64_t, std::shared_ptr<PendingLoad>> pending_loads_;
+
+  mutable std::mutex resources_mutex_;
+  /// Component resources by resource index and package name.
+  mutable std::map<std::pair<std::string, std::string>, std::vector<ComponentResource>>
+  resources_;
+
+  mutable std::mutex load_timings_mutex_;
+  LoadTimings load_timings_;
+
+  bool use_intra_process_comms_ {false};
+  bool start_lifecycle_services_ {true};
+  bool lightweight_components_ {false};
+  /// Executors of the components which requested one, protected by node_wrappers_mutex_.
+  std::map<uint64_t, ComponentExecutor> component_executors_;
 };
 
 }  // namespace rclcpp_components
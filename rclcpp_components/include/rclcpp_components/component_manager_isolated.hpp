@@ -23,32 +23,84 @@
 #include <vector>
 #include <unordered_map>
 
+#include "rclcpp/thread.hpp"
+#include "rclcpp/thread_attributes.hpp"
+
 #include "rclcpp_components/component_manager.hpp"
 
 
 namespace rclcpp_components
 {
 /// ComponentManagerIsolated uses dedicated single-threaded executors for each components.
+/**
+ * By default each component gets its own executor, spun by its own thread.
+ * With the read-only parameter `executor_pool_size` greater than 0, the components are
+ * instead spread over that many executors, each spun by its own thread, so that the number of
+ * threads is bounded.
+ * The read-only parameter `executor_pool_cpus` lists the CPU each of these threads is pinned
+ * to, -1 or a missing entry leaving the thread unpinned.
+ *
+ * A component is added to the executor of the pool with the fewest components, unless the
+ * extra argument `executor_pool_index` of its load request selects the executor.
+ */
 template<typename ExecutorT = rclcpp::executors::SingleThreadedExecutor>
 class ComponentManagerIsolated : public rclcpp_components::ComponentManager
 {
-  using rclcpp_components::ComponentManager::ComponentManager;
-
   struct DedicatedExecutorWrapper
   {
     std::shared_ptr<rclcpp::Executor> executor;
-    std::thread thread;
+    rclcpp::Thread thread;
   };
 
 public:
+  ComponentManagerIsolated(
+    std::weak_ptr<rclcpp::Executor> executor =
+    std::weak_ptr<rclcpp::executors::MultiThreadedExecutor>(),
+    std::string node_name = "ComponentManager",
+    const rclcpp::NodeOptions & node_options = rclcpp::NodeOptions()
+    .start_parameter_services(false)
+    .start_parameter_event_publisher(false))
+  : rclcpp_components::ComponentManager(executor, std::move(node_name), node_options)
+  {
+    rcl_interfaces::msg::ParameterDescriptor size_desc{};
+    size_desc.description = "Number of executors shared by the components, 0 for one each";
+    size_desc.read_only = true;
+    const auto pool_size = this->declare_parameter("executor_pool_size", static_cast<int64_t>(0), size_desc);
+
+    rcl_interfaces::msg::ParameterDescriptor cpus_desc{};
+    cpus_desc.description = "CPU each thread of the shared executors is pinned to, -1 for none";
+    cpus_desc.read_only = true;
+    const auto cpus =
+      this->declare_parameter("executor_pool_cpus", std::vector<int64_t>(), cpus_desc);
+
+    for (int64_t i = 0; i < pool_size; ++i) {
+      rclcpp::ThreadAttributes attributes;
+      attributes.name = "component_exec" + std::to_string(i);
+      const auto index = static_cast<size_t>(i);
+      if (index < cpus.size() && cpus[index] >= 0) {
+        attributes.cpu_set.push_back(static_cast<size_t>(cpus[index]));
+      }
+      pool_thread_attributes_.push_back(std::move(attributes));
+    }
+    pool_executor_wrappers_.resize(pool_thread_attributes_.size());
+    pool_node_counts_.resize(pool_thread_attributes_.size(), 0);
+  }
+
   ~ComponentManagerIsolated()
   {
+    stop_load_threads();
     if (node_wrappers_.size()) {
       for (auto & executor_wrapper : dedicated_executor_wrappers_) {
         cancel_executor(executor_wrapper.second);
       }
-      node_wrappers_.clear();
     }
+    // The executors of the pool keep spinning once started, even without nodes
+    for (auto & executor_wrapper : pool_executor_wrappers_) {
+      if (executor_wrapper.executor) {
+        cancel_executor(executor_wrapper);
+      }
+    }
+    node_wrappers_.clear();
   }
 
 protected:
@@ -59,11 +111,16 @@ protected:
   void
   add_node_to_executor(uint64_t node_id) override
   {
+    if (!pool_executor_wrappers_.empty()) {
+      add_node_to_pool_executor(node_id);
+      return;
+    }
     DedicatedExecutorWrapper executor_wrapper;
     auto exec = std::make_shared<ExecutorT>();
     exec->add_node(node_wrappers_[node_id].get_node_base_interface());
     executor_wrapper.executor = exec;
-    executor_wrapper.thread = std::thread(
+    executor_wrapper.thread = rclcpp::Thread(
+      rclcpp::ThreadAttributes(),
       [exec]() {
         exec->spin();
       });
@@ -76,6 +133,14 @@ protected:
   void
   remove_node_from_executor(uint64_t node_id) override
   {
+    auto pool_index = node_pool_indices_.find(node_id);
+    if (pool_index != node_pool_indices_.end()) {
+      pool_executor_wrappers_[pool_index->second].executor->remove_node(
+        node_wrappers_[node_id].get_node_base_interface());
+      --pool_node_counts_[pool_index->second];
+      node_pool_indices_.erase(pool_index);
+      return;
+    }
     auto executor_wrapper = dedicated_executor_wrappers_.find(node_id);
     if (executor_wrapper != dedicated_executor_wrappers_.end()) {
       cancel_executor(executor_wrapper->second);
@@ -84,6 +149,52 @@ protected:
   }
 
 private:
+  /// Add the node to an executor of the pool, starting the executor at first use.
+  void
+  add_node_to_pool_executor(uint64_t node_id)
+  {
+    const size_t pool_size = pool_executor_wrappers_.size();
+    size_t index = pool_size;
+    for (const auto & extra_argument : node_extra_arguments_[node_id]) {
+      if (extra_argument.get_name() != "executor_pool_index") {
+        continue;
+      }
+      if (
+        extra_argument.get_type() != rclcpp::ParameterType::PARAMETER_INTEGER ||
+        extra_argument.get_value<int64_t>() < 0 ||
+        static_cast<size_t>(extra_argument.get_value<int64_t>()) >= pool_size)
+      {
+        RCLCPP_WARN(
+          get_logger(), "Extra component argument 'executor_pool_index' must be an integer "
+          "between 0 and %zu, the node is added to the least used executor", pool_size - 1);
+      } else {
+        index = static_cast<size_t>(extra_argument.get_value<int64_t>());
+      }
+    }
+    if (index == pool_size) {
+      index = 0;
+      for (size_t i = 1; i < pool_size; ++i) {
+        if (pool_node_counts_[i] < pool_node_counts_[index]) {
+          index = i;
+        }
+      }
+    }
+
+    auto & executor_wrapper = pool_executor_wrappers_[index];
+    if (!executor_wrapper.executor) {
+      auto exec = std::make_shared<ExecutorT>();
+      executor_wrapper.executor = exec;
+      executor_wrapper.thread = rclcpp::Thread(
+        pool_thread_attributes_[index],
+        [exec]() {
+          exec->spin();
+        });
+    }
+    executor_wrapper.executor->add_node(node_wrappers_[node_id].get_node_base_interface());
+    ++pool_node_counts_[index];
+    node_pool_indices_[node_id] = index;
+  }
+
   /// Stops a spinning executor avoiding race conditions.
   /**
    * @param executor_wrapper executor to stop and its associated thread
@@ -109,6 +220,12 @@ private:
   }
 
   std::unordered_map<uint64_t, DedicatedExecutorWrapper> dedicated_executor_wrappers_;
+  /// Attributes of the threads of the executor pool, empty without a pool.
+  std::vector<rclcpp::ThreadAttributes> pool_thread_attributes_;
+  /// Executors of the pool, started at first use.
+  std::vector<DedicatedExecutorWrapper> pool_executor_wrappers_;
+  std::vector<size_t> pool_node_counts_;
+  std::unordered_map<uint64_t, size_t> node_pool_indices_;
 };
 
 }  // namespace rclcpp_components
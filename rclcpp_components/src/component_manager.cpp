@@ -14,14 +14,21 @@
 
 #include "rclcpp_components/component_manager.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <condition_variable>
 #include <functional>
+#include <iterator>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "ament_index_cpp/get_resource.hpp"
 #include "class_loader/class_loader.hpp"
+#include "rclcpp/entity_handoff.hpp"
 #include "rcpputils/filesystem_helper.hpp"
 #include "rcpputils/split.hpp"
 
@@ -30,6 +37,61 @@ using namespace std::placeholders;
 namespace rclcpp_components
 {
 
+namespace
+{
+
+/// Cancel an executor spinning in its own thread, once it's spinning.
+void
+cancel_component_executor(const std::shared_ptr<rclcpp::Executor> & executor)
+{
+  // The thread spinning the executor was just started, cancelling the executor before it is
+  // spinning would have no effect
+  while (!executor->is_spinning()) {
+    // This is an arbitrarily small delay to avoid busy looping
+    rclcpp::sleep_for(std::chrono::milliseconds(1));
+  }
+  executor->cancel();
+}
+
+/// Return the unique id of the component a load request reloads, or 0 if it loads a new one.
+uint64_t
+get_reload_unique_id(const composition_interfaces::srv::LoadNode::Request & request)
+{
+  for (const auto & a : request.extra_arguments) {
+    const rclcpp::Parameter extra_argument = rclcpp::Parameter::from_parameter_msg(a);
+    if (extra_argument.get_name() == "reload_unique_id") {
+      if (
+        extra_argument.get_type() != rclcpp::ParameterType::PARAMETER_INTEGER ||
+        extra_argument.get_value<int64_t>() <= 0)
+      {
+        throw rclcpp_components::ComponentManagerException(
+                "Extra component argument 'reload_unique_id' must be a positive integer");
+      }
+      return static_cast<uint64_t>(extra_argument.get_value<int64_t>());
+    }
+  }
+  return 0;
+}
+
+}  // namespace
+
+/// A load request, from the construction of its node to its response.
+struct ComponentManager::PendingLoad
+{
+  std::shared_ptr<LoadNode::Request> request;
+  std::shared_ptr<LoadNode::Response> response;
+  /// Called once the response is complete, in the order of the requests.
+  std::function<void()> on_answered;
+  rclcpp_components::NodeInstanceWrapper node_instance;
+  /// True once the factory of the component is found, the node then uses a unique id.
+  bool factory_found = false;
+  bool node_constructed = false;
+  /// True once construct_node() returned, the node can be registered.
+  bool ready = false;
+  /// Entities of the previous instance of a reloaded component.
+  std::shared_ptr<rclcpp::EntityHandoff> entity_handoff;
+};
+
 ComponentManager::ComponentManager(
   std::weak_ptr<rclcpp::Executor> executor,
   std::string node_name,
@@ -37,16 +99,6 @@ ComponentManager::ComponentManager(
 : Node(std::move(node_name), node_options),
   executor_(executor)
 {
-  loadNode_srv_ = create_service<LoadNode>(
-    "~/_container/load_node",
-    std::bind(&ComponentManager::on_load_node, this, _1, _2, _3));
-  unloadNode_srv_ = create_service<UnloadNode>(
-    "~/_container/unload_node",
-    std::bind(&ComponentManager::on_unload_node, this, _1, _2, _3));
-  listNodes_srv_ = create_service<ListNodes>(
-    "~/_container/list_nodes",
-    std::bind(&ComponentManager::on_list_nodes, this, _1, _2, _3));
-
   {
     rcl_interfaces::msg::ParameterDescriptor desc{};
     desc.description = "Number of thread";
@@ -58,24 +110,145 @@ ComponentManager::ComponentManager(
     this->declare_parameter(
       "thread_num", static_cast<int64_t>(std::thread::hardware_concurrency()), desc);
   }
+  int64_t load_thread_num = 1;
+  {
+    rcl_interfaces::msg::ParameterDescriptor desc{};
+    desc.description = "Number of threads loading the components concurrently";
+    rcl_interfaces::msg::IntegerRange range{};
+    range.from_value = 1;
+    range.to_value = 256;
+    desc.integer_range.push_back(range);
+    desc.read_only = true;
+    load_thread_num = this->declare_parameter("load_thread_num", load_thread_num, desc);
+  }
+  bool load_on_worker_pool = false;
+  {
+    rcl_interfaces::msg::ParameterDescriptor desc{};
+    desc.description =
+      "Load the components concurrently on the worker pool of the context, "
+      "instead of load threads of the manager";
+    desc.read_only = true;
+    load_on_worker_pool =
+      this->declare_parameter("load_on_worker_pool", load_on_worker_pool, desc);
+  }
+  {
+    rcl_interfaces::msg::ParameterDescriptor desc{};
+    desc.description = "Enable the intra-process communication of all the components";
+    desc.read_only = true;
+    use_intra_process_comms_ =
+      this->declare_parameter("use_intra_process_comms", use_intra_process_comms_, desc);
+  }
+  {
+    rcl_interfaces::msg::ParameterDescriptor desc{};
+    desc.description = "Create the lifecycle services of the lifecycle components";
+    desc.read_only = true;
+    start_lifecycle_services_ =
+      this->declare_parameter("start_lifecycle_services", start_lifecycle_services_, desc);
+  }
+  {
+    rcl_interfaces::msg::ParameterDescriptor desc{};
+    desc.description = "Create the components as lightweight nodes";
+    desc.read_only = true;
+    lightweight_components_ =
+      this->declare_parameter("lightweight_components", lightweight_components_, desc);
+  }
+  {
+    rcl_interfaces::msg::ParameterDescriptor desc{};
+    desc.description = "Packages whose component libraries are loaded at startup";
+    desc.read_only = true;
+    const auto packages =
+      this->declare_parameter("preload_packages", std::vector<std::string>(), desc);
+    const auto start = std::chrono::steady_clock::now();
+    for (const auto & package : packages) {
+      try {
+        preload_libraries(package);
+      } catch (const ComponentManagerException & ex) {
+        RCLCPP_WARN(get_logger(), "Failed to preload package '%s': %s", package.c_str(), ex.what());
+      }
+    }
+    if (!packages.empty()) {
+      RCLCPP_INFO(
+        get_logger(), "Preloaded %zu libraries in %.3f s", get_load_timings().loaded_libraries,
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+  }
+
+  if (load_on_worker_pool) {
+    load_thread_pool_ = get_node_base_interface()->get_context()->get_worker_pool();
+  } else if (load_thread_num > 1) {
+    load_thread_pool_ = std::make_shared<rclcpp::DeserializationThreadPool>(
+      static_cast<size_t>(load_thread_num));
+  }
+  if (load_thread_pool_) {
+    // The requests are enqueued in the order they are received, and answered in that order
+    loadNode_srv_ = create_service<LoadNode>(
+      "~/_container/load_node",
+      [this](
+        const std::shared_ptr<rmw_request_id_t> request_header,
+        const std::shared_ptr<LoadNode::Request> request)
+      {
+        auto load = std::make_shared<PendingLoad>();
+        load->request = request;
+        load->response = std::make_shared<LoadNode::Response>();
+        load->on_answered = [this, request_header, response = load->response]() {
+            loadNode_srv_->send_response(*request_header, *response);
+          };
+        enqueue_load(std::move(load));
+      });
+  } else {
+    loadNode_srv_ = create_service<LoadNode>(
+      "~/_container/load_node",
+      std::bind(&ComponentManager::on_load_node, this, _1, _2, _3));
+  }
+  unloadNode_srv_ = create_service<UnloadNode>(
+    "~/_container/unload_node",
+    std::bind(&ComponentManager::on_unload_node, this, _1, _2, _3));
+  listNodes_srv_ = create_service<ListNodes>(
+    "~/_container/list_nodes",
+    std::bind(&ComponentManager::on_list_nodes, this, _1, _2, _3));
 }
 
 ComponentManager::~ComponentManager()
 {
+  stop_load_threads();
+  std::lock_guard<std::mutex> lock(node_wrappers_mutex_);
+  for (auto & component_executor : component_executors_) {
+    cancel_component_executor(component_executor.second.executor);
+    component_executor.second.thread.join();
+  }
   if (node_wrappers_.size()) {
     RCLCPP_DEBUG(get_logger(), "Removing components from executor");
     if (auto exec = executor_.lock()) {
-      for (auto & wrapper : node_wrappers_) {
-        exec->remove_node(wrapper.second.get_node_base_interface());
+      // Only the last removal wakes the executor up, to rebuild its wait set once
+      auto last_shared = std::find_if(
+        node_wrappers_.rbegin(), node_wrappers_.rend(), [this](const auto & wrapper) {
+          return component_executors_.count(wrapper.first) == 0;
+        });
+      for (auto it = node_wrappers_.rbegin(); it != node_wrappers_.rend(); ++it) {
+        if (component_executors_.count(it->first) == 0) {
+          exec->remove_node(it->second.get_node_base_interface(), it == last_shared);
+        }
       }
     }
   }
+  component_executors_.clear();
+  // Unload the components in the reverse order of their loading, as the later ones may use
+  // the earlier ones, instead of leaving the order to the destruction of the map
+  while (!node_wrappers_.empty()) {
+    node_wrappers_.erase(std::prev(node_wrappers_.end()));
+  }
 }
 
 std::vector<ComponentManager::ComponentResource>
 ComponentManager::get_component_resources(
   const std::string & package_name, const std::string & resource_index) const
 {
+  std::lock_guard<std::mutex> lock(resources_mutex_);
+  auto cached = resources_.find({resource_index, package_name});
+  if (cached != resources_.end()) {
+    return cached->second;
+  }
+
   std::string content;
   std::string base_path;
   if (
@@ -99,6 +272,7 @@ ComponentManager::get_component_resources(
     }
     resources.push_back({parts[0], library_path});
   }
+  resources_.emplace(std::make_pair(resource_index, package_name), resources);
   return resources;
 }
 
@@ -109,30 +283,87 @@ ComponentManager::create_component_factory(const ComponentResource & resource)
   std::string class_name = resource.first;
   std::string fq_class_name = "rclcpp_components::NodeFactoryTemplate<" + class_name + ">";
 
-  class_loader::ClassLoader * loader;
-  if (loaders_.find(library_path) == loaders_.end()) {
-    RCLCPP_INFO(get_logger(), "Load Library: %s", library_path.c_str());
-    try {
-      loaders_[library_path] = std::make_unique<class_loader::ClassLoader>(library_path);
-    } catch (const std::exception & ex) {
-      throw ComponentManagerException("Failed to load library: " + std::string(ex.what()));
-    } catch (...) {
-      throw ComponentManagerException("Failed to load library");
-    }
-  }
-  loader = loaders_[library_path].get();
+  // Loading the libraries isn't concurrent, constructing the nodes is
+  std::lock_guard<std::mutex> lock(loaders_mutex_);
+  auto start = std::chrono::steady_clock::now();
+  class_loader::ClassLoader * loader = load_library(library_path);
+  add_load_timing(&LoadTimings::library_load, start);
 
-  auto classes = loader->getAvailableClasses<rclcpp_components::NodeFactory>();
-  for (const auto & clazz : classes) {
+  for (const auto & clazz : loader_classes_[library_path]) {
     RCLCPP_INFO(get_logger(), "Found class: %s", clazz.c_str());
     if (clazz == class_name || clazz == fq_class_name) {
       RCLCPP_INFO(get_logger(), "Instantiate class: %s", clazz.c_str());
-      return loader->createInstance<rclcpp_components::NodeFactory>(clazz);
+      start = std::chrono::steady_clock::now();
+      auto factory = loader->createInstance<rclcpp_components::NodeFactory>(clazz);
+      add_load_timing(&LoadTimings::factory_creation, start);
+      return factory;
     }
   }
   return {};
 }
 
+class_loader::ClassLoader *
+ComponentManager::load_library(const std::string & library_path)
+{
+  auto loader = loaders_.find(library_path);
+  if (loader != loaders_.end()) {
+    return loader->second.get();
+  }
+
+  RCLCPP_INFO(get_logger(), "Load Library: %s", library_path.c_str());
+  std::unique_ptr<class_loader::ClassLoader> new_loader;
+  try {
+    new_loader = std::make_unique<class_loader::ClassLoader>(library_path);
+  } catch (const std::exception & ex) {
+    throw ComponentManagerException("Failed to load library: " + std::string(ex.what()));
+  } catch (...) {
+    throw ComponentManagerException("Failed to load library");
+  }
+  loader_classes_[library_path] =
+    new_loader->getAvailableClasses<rclcpp_components::NodeFactory>();
+  {
+    std::lock_guard<std::mutex> timings_lock(load_timings_mutex_);
+    ++load_timings_.loaded_libraries;
+  }
+  auto new_loader_ptr = new_loader.get();
+  loaders_[library_path] = std::move(new_loader);
+  return new_loader_ptr;
+}
+
+void
+ComponentManager::preload_libraries(
+  const std::string & package_name, const std::string & resource_index)
+{
+  auto start = std::chrono::steady_clock::now();
+  auto resources = get_component_resources(package_name, resource_index);
+  add_load_timing(&LoadTimings::resource_lookup, start);
+
+  start = std::chrono::steady_clock::now();
+  {
+    std::lock_guard<std::mutex> lock(loaders_mutex_);
+    for (const auto & resource : resources) {
+      load_library(resource.second);
+    }
+  }
+  add_load_timing(&LoadTimings::library_load, start);
+}
+
+ComponentManager::LoadTimings
+ComponentManager::get_load_timings() const
+{
+  std::lock_guard<std::mutex> lock(load_timings_mutex_);
+  return load_timings_;
+}
+
+void
+ComponentManager::add_load_timing(
+  std::chrono::nanoseconds LoadTimings::* phase, std::chrono::steady_clock::time_point start)
+{
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  std::lock_guard<std::mutex> lock(load_timings_mutex_);
+  load_timings_.*phase += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed);
+}
+
 rclcpp::NodeOptions
 ComponentManager::create_node_options(const std::shared_ptr<LoadNode::Request> request)
 {
@@ -162,8 +393,11 @@ ComponentManager::create_node_options(const std::shared_ptr<LoadNode::Request> r
   auto options = rclcpp::NodeOptions()
     .use_global_arguments(false)
     .parameter_overrides(parameters)
-    .arguments(remap_rules);
+    .arguments(remap_rules)
+    .use_intra_process_comms(use_intra_process_comms_)
+    .start_lifecycle_services(start_lifecycle_services_);
 
+  bool lightweight = lightweight_components_;
   for (const auto & a : request->extra_arguments) {
     const rclcpp::Parameter extra_argument = rclcpp::Parameter::from_parameter_msg(a);
     if (extra_argument.get_name() == "use_intra_process_comms") {
@@ -172,6 +406,18 @@ ComponentManager::create_node_options(const std::shared_ptr<LoadNode::Request> r
                 "Extra component argument 'use_intra_process_comms' must be a boolean");
       }
       options.use_intra_process_comms(extra_argument.get_value<bool>());
+    } else if (extra_argument.get_name() == "start_lifecycle_services") {
+      if (extra_argument.get_type() != rclcpp::ParameterType::PARAMETER_BOOL) {
+        throw ComponentManagerException(
+                "Extra component argument 'start_lifecycle_services' must be a boolean");
+      }
+      options.start_lifecycle_services(extra_argument.get_value<bool>());
+    } else if (extra_argument.get_name() == "lightweight") {
+      if (extra_argument.get_type() != rclcpp::ParameterType::PARAMETER_BOOL) {
+        throw ComponentManagerException(
+                "Extra component argument 'lightweight' must be a boolean");
+      }
+      lightweight = extra_argument.get_value<bool>();
     } else if (extra_argument.get_name() == "forward_global_arguments") {
       if (extra_argument.get_type() != rclcpp::ParameterType::PARAMETER_BOOL) {
         throw ComponentManagerException(
@@ -184,8 +430,41 @@ ComponentManager::create_node_options(const std::shared_ptr<LoadNode::Request> r
           "recommended in a component manager. If true, this will cause this node's behavior "
           "to be influenced by global arguments, not only those targeted at this node.");
       }
+    } else if (extra_argument.get_name() == "executor_type") {
+      const auto type = extra_argument.get_type();
+      if (
+        type != rclcpp::ParameterType::PARAMETER_STRING ||
+        (extra_argument.get_value<std::string>() != "single_threaded" &&
+        extra_argument.get_value<std::string>() != "static_single_threaded" &&
+        extra_argument.get_value<std::string>() != "multi_threaded" &&
+        extra_argument.get_value<std::string>() != "static_multi_threaded"))
+      {
+        throw ComponentManagerException(
+                "Extra component argument 'executor_type' must be one of 'single_threaded', "
+                "'static_single_threaded', 'multi_threaded' or 'static_multi_threaded'");
+      }
+    } else if (extra_argument.get_name() == "executor_thread_num") {
+      if (
+        extra_argument.get_type() != rclcpp::ParameterType::PARAMETER_INTEGER ||
+        extra_argument.get_value<int64_t>() < 0)
+      {
+        throw ComponentManagerException(
+                "Extra component argument 'executor_thread_num' must be a positive integer");
+      }
+    } else if (extra_argument.get_name() == "executor_cpus") {
+      if (extra_argument.get_type() != rclcpp::ParameterType::PARAMETER_INTEGER_ARRAY) {
+        throw ComponentManagerException(
+                "Extra component argument 'executor_cpus' must be an integer array");
+      }
+      for (int64_t cpu : extra_argument.get_value<std::vector<int64_t>>()) {
+        if (cpu < 0) {
+          throw ComponentManagerException(
+                  "Extra component argument 'executor_cpus' must only contain CPU indices");
+        }
+      }
     }
   }
+  options.lightweight(lightweight);
 
   return options;
 }
@@ -199,6 +478,9 @@ ComponentManager::set_executor(const std::weak_ptr<rclcpp::Executor> executor)
 void
 ComponentManager::add_node_to_executor(uint64_t node_id)
 {
+  if (add_node_to_component_executor(node_id)) {
+    return;
+  }
   if (auto exec = executor_.lock()) {
     exec->add_node(node_wrappers_[node_id].get_node_base_interface(), true);
   }
@@ -207,11 +489,82 @@ ComponentManager::add_node_to_executor(uint64_t node_id)
 void
 ComponentManager::remove_node_from_executor(uint64_t node_id)
 {
+  auto component_executor = component_executors_.find(node_id);
+  if (component_executor != component_executors_.end()) {
+    cancel_component_executor(component_executor->second.executor);
+    component_executor->second.thread.join();
+    component_executors_.erase(component_executor);
+    return;
+  }
   if (auto exec = executor_.lock()) {
     exec->remove_node(node_wrappers_[node_id].get_node_base_interface());
   }
 }
 
+bool
+ComponentManager::add_node_to_component_executor(uint64_t node_id)
+{
+  std::string executor_type;
+  size_t thread_num = 0;
+  rclcpp::ThreadAttributes thread_attributes;
+  bool requested = false;
+  for (const auto & extra_argument : node_extra_arguments_[node_id]) {
+    // The values were checked by create_node_options()
+    if (extra_argument.get_name() == "executor_type") {
+      executor_type = extra_argument.get_value<std::string>();
+      requested = true;
+    } else if (extra_argument.get_name() == "executor_thread_num") {
+      thread_num = static_cast<size_t>(extra_argument.get_value<int64_t>());
+      requested = true;
+    } else if (extra_argument.get_name() == "executor_cpus") {
+      for (int64_t cpu : extra_argument.get_value<std::vector<int64_t>>()) {
+        thread_attributes.cpu_set.push_back(static_cast<size_t>(cpu));
+      }
+      requested = true;
+    }
+  }
+  if (!requested) {
+    return false;
+  }
+
+  if (thread_num == 0) {
+    thread_num = thread_attributes.cpu_set.size();
+  }
+  if (executor_type.empty()) {
+    executor_type = thread_num > 1 ? "multi_threaded" : "single_threaded";
+  }
+  rclcpp::ExecutorOptions options;
+  if (!thread_attributes.cpu_set.empty()) {
+    // The worker threads all share the CPUs of the component
+    options.thread_attributes.assign(std::max<size_t>(thread_num, 1), thread_attributes);
+  }
+
+  ComponentExecutor component_executor;
+  if (executor_type == "single_threaded") {
+    component_executor.executor =
+      std::make_shared<rclcpp::executors::SingleThreadedExecutor>(options);
+  } else if (executor_type == "static_single_threaded") {
+    component_executor.executor =
+      std::make_shared<rclcpp::executors::StaticSingleThreadedExecutor>(options);
+  } else if (executor_type == "multi_threaded") {
+    component_executor.executor =
+      std::make_shared<rclcpp::executors::MultiThreadedExecutor>(options, thread_num);
+  } else {
+    component_executor.executor =
+      std::make_shared<rclcpp::executors::StaticMultiThreadedExecutor>(options, thread_num);
+  }
+  component_executor.executor->add_node(node_wrappers_[node_id].get_node_base_interface());
+  thread_attributes.name = "component_" + std::to_string(node_id);
+  auto exec = component_executor.executor;
+  component_executor.thread = rclcpp::Thread(
+    thread_attributes,
+    [exec]() {
+      exec->spin();
+    });
+  component_executors_[node_id] = std::move(component_executor);
+  return true;
+}
+
 void
 ComponentManager::on_load_node(
   const std::shared_ptr<rmw_request_id_t> request_header,
@@ -220,8 +573,64 @@ ComponentManager::on_load_node(
 {
   (void) request_header;
 
+  if (reload_requested_node(request, *response)) {
+    return;
+  }
+
+  PendingLoad load;
+  load.request = request;
+  load.response = response;
+  construct_node(load);
+  register_node(load);
+}
+
+std::vector<std::shared_ptr<ComponentManager::LoadNode::Response>>
+ComponentManager::load_nodes(const std::vector<std::shared_ptr<LoadNode::Request>> & requests)
+{
+  std::vector<std::shared_ptr<LoadNode::Response>> responses;
+  responses.reserve(requests.size());
+  std::mutex mutex;
+  std::condition_variable condition;
+  size_t answered = 0;
+  for (const auto & request : requests) {
+    auto load = std::make_shared<PendingLoad>();
+    load->request = request;
+    load->response = std::make_shared<LoadNode::Response>();
+    load->on_answered = [&mutex, &condition, &answered]() {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++answered;
+        condition.notify_all();
+      };
+    responses.push_back(load->response);
+    enqueue_load(std::move(load));
+  }
+
+  std::unique_lock<std::mutex> lock(mutex);
+  condition.wait(lock, [&answered, &requests]() {return answered == requests.size();});
+  return responses;
+}
+
+void
+ComponentManager::stop_load_threads()
+{
+  // The nodes still queued are constructed first, the thread pool may be the worker pool of
+  // the context, which keeps running
+  {
+    std::unique_lock<std::mutex> lock(pending_loads_mutex_);
+    pending_loads_condition_.wait(lock, [this]() {return pending_loads_.empty();});
+  }
+  load_thread_pool_.reset();
+}
+
+void
+ComponentManager::construct_node(PendingLoad & load)
+{
+  const auto & request = load.request;
+  auto & response = load.response;
   try {
+    auto start = std::chrono::steady_clock::now();
     auto resources = get_component_resources(request->package_name);
+    add_load_timing(&LoadTimings::resource_lookup, start);
 
     for (const auto & resource : resources) {
       if (resource.first != request->plugin_name) {
@@ -234,21 +643,13 @@ ComponentManager::on_load_node(
       }
 
       auto options = create_node_options(request);
-      auto node_id = unique_id_++;
-
-      if (0 == node_id) {
-        // This puts a technical limit on the number of times you can add a component.
-        // But even if you could add (and remove) them at 1 kHz (very optimistic rate)
-        // it would still be a very long time before you could exhaust the pool of id's:
-        //   2^64 / 1000 times per sec / 60 sec / 60 min / 24 hours / 365 days = 584,942,417 years
-        // So around 585 million years. Even at 1 GHz, it would take 585 years.
-        // I think it's safe to avoid trying to handle overflow.
-        // If we roll over then it's most likely a bug.
-        throw std::overflow_error("exhausted the unique ids for components in this process");
-      }
+      options.entity_handoff(load.entity_handoff);
+      load.factory_found = true;
 
+      start = std::chrono::steady_clock::now();
       try {
-        node_wrappers_[node_id] = factory->create_node_instance(options);
+        load.node_instance = factory->create_node_instance(options);
+        add_load_timing(&LoadTimings::node_construction, start);
       } catch (const std::exception & ex) {
         // In the case that the component constructor throws an exception,
         // rethrow into the following catch block.
@@ -259,13 +660,7 @@ ComponentManager::on_load_node(
         // rethrow into the following catch block.
         throw ComponentManagerException("Component constructor threw an exception");
       }
-
-      add_node_to_executor(node_id);
-
-      auto node = node_wrappers_[node_id].get_node_base_interface();
-      response->full_node_name = node->get_fully_qualified_name();
-      response->unique_id = node_id;
-      response->success = true;
+      load.node_constructed = true;
       return;
     }
     RCLCPP_ERROR(
@@ -281,6 +676,188 @@ ComponentManager::on_load_node(
   }
 }
 
+void
+ComponentManager::register_node(PendingLoad & load)
+{
+  if (!load.factory_found) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(node_wrappers_mutex_);
+  // A component whose constructor threw still uses a unique id
+  auto node_id = unique_id_++;
+
+  if (0 == node_id) {
+    // This puts a technical limit on the number of times you can add a component.
+    // But even if you could add (and remove) them at 1 kHz (very optimistic rate)
+    // it would still be a very long time before you could exhaust the pool of id's:
+    //   2^64 / 1000 times per sec / 60 sec / 60 min / 24 hours / 365 days = 584,942,417 years
+    // So around 585 million years. Even at 1 GHz, it would take 585 years.
+    // I think it's safe to avoid trying to handle overflow.
+    // If we roll over then it's most likely a bug.
+    throw std::overflow_error("exhausted the unique ids for components in this process");
+  }
+
+  if (!load.node_constructed) {
+    return;
+  }
+  add_loaded_node(node_id, load);
+}
+
+void
+ComponentManager::add_loaded_node(uint64_t node_id, PendingLoad & load)
+{
+  node_wrappers_[node_id] = std::move(load.node_instance);
+  auto & extra_arguments = node_extra_arguments_[node_id];
+  for (const auto & a : load.request->extra_arguments) {
+    extra_arguments.push_back(rclcpp::Parameter::from_parameter_msg(a));
+  }
+  const auto start = std::chrono::steady_clock::now();
+  try {
+    add_node_to_executor(node_id);
+  } catch (const std::exception & ex) {
+    // E.g. the thread of the executor of the component couldn't be pinned to its CPUs
+    node_wrappers_.erase(node_id);
+    node_extra_arguments_.erase(node_id);
+    const std::string error = "Failed to add the component to an executor: " +
+      std::string(ex.what());
+    RCLCPP_ERROR(get_logger(), "%s", error.c_str());
+    load.response->error_message = error;
+    load.response->success = false;
+    return;
+  }
+  add_load_timing(&LoadTimings::executor_registration, start);
+  {
+    std::lock_guard<std::mutex> timings_lock(load_timings_mutex_);
+    ++load_timings_.loaded_nodes;
+  }
+
+  auto node = node_wrappers_[node_id].get_node_base_interface();
+  load.response->full_node_name = node->get_fully_qualified_name();
+  load.response->unique_id = node_id;
+  load.response->success = true;
+}
+
+void
+ComponentManager::enqueue_load(std::shared_ptr<PendingLoad> load)
+{
+  // A reload isn't queued, it replaces a component registered already
+  if (reload_requested_node(load->request, *load->response)) {
+    if (load->on_answered) {
+      load->on_answered();
+    }
+    return;
+  }
+
+  uint64_t ticket;
+  {
+    std::lock_guard<std::mutex> lock(pending_loads_mutex_);
+    ticket = next_load_ticket_++;
+    pending_loads_.emplace(ticket, load);
+  }
+
+  auto job = [this, load, ticket]() {
+      try {
+        construct_node(*load);
+      } catch (const std::exception & ex) {
+        // The load is answered anyway, not to hold back the responses of the next loads
+        RCLCPP_ERROR(get_logger(), "%s", ex.what());
+        load->response->error_message = ex.what();
+        load->response->success = false;
+      }
+      finish_load(ticket);
+    };
+  if (load_thread_pool_) {
+    load_thread_pool_->post(std::move(job));
+  } else {
+    job();
+  }
+}
+
+void
+ComponentManager::finish_load(uint64_t ticket)
+{
+  std::lock_guard<std::mutex> lock(pending_loads_mutex_);
+  pending_loads_[ticket]->ready = true;
+  // The tickets are consecutive, the first pending load is the next one to register
+  while (!pending_loads_.empty() && pending_loads_.begin()->second->ready) {
+    auto load = std::move(pending_loads_.begin()->second);
+    pending_loads_.erase(pending_loads_.begin());
+    try {
+      register_node(*load);
+    } catch (const std::exception & ex) {
+      RCLCPP_ERROR(get_logger(), "%s", ex.what());
+      load->response->error_message = ex.what();
+      load->response->success = false;
+    }
+    if (load->on_answered) {
+      load->on_answered();
+    }
+  }
+  if (pending_loads_.empty()) {
+    pending_loads_condition_.notify_all();
+  }
+}
+
+bool
+ComponentManager::reload_requested_node(
+  const std::shared_ptr<LoadNode::Request> & request, LoadNode::Response & response)
+{
+  try {
+    const uint64_t unique_id = get_reload_unique_id(*request);
+    if (0 == unique_id) {
+      return false;
+    }
+    response = *reload_node(unique_id, request);
+  } catch (const ComponentManagerException & ex) {
+    RCLCPP_ERROR(get_logger(), "%s", ex.what());
+    response.error_message = ex.what();
+    response.success = false;
+  }
+  return true;
+}
+
+std::shared_ptr<ComponentManager::LoadNode::Response>
+ComponentManager::reload_node(
+  uint64_t unique_id, const std::shared_ptr<LoadNode::Request> & request)
+{
+  PendingLoad load;
+  load.request = request;
+  load.response = std::make_shared<LoadNode::Response>();
+
+  std::lock_guard<std::mutex> lock(node_wrappers_mutex_);
+  auto wrapper = node_wrappers_.find(unique_id);
+  if (wrapper == node_wrappers_.end()) {
+    load.response->success = false;
+    load.response->error_message = "No node found with unique_id: " + std::to_string(unique_id);
+    RCLCPP_WARN(get_logger(), "%s", load.response->error_message.c_str());
+    return load.response;
+  }
+
+  // The entities of the old instance are kept from its destruction to the end of the reload
+  load.entity_handoff = std::make_shared<rclcpp::EntityHandoff>(
+    *wrapper->second.get_node_base_interface());
+  remove_node_from_executor(unique_id);
+  node_wrappers_.erase(wrapper);
+  node_extra_arguments_.erase(unique_id);
+
+  construct_node(load);
+  const size_t reused_entities = load.entity_handoff->get_number_of_reused_entities();
+  load.entity_handoff->finish();
+  if (!load.node_constructed) {
+    RCLCPP_ERROR(
+      get_logger(), "Failed to reload the component %" PRIu64 ", it is unloaded", unique_id);
+    return load.response;
+  }
+  add_loaded_node(unique_id, load);
+  if (load.response->success) {
+    RCLCPP_INFO(
+      get_logger(), "Reloaded the component %" PRIu64 ", reusing %zu publishers and "
+      "subscriptions", unique_id, reused_entities);
+  }
+  return load.response;
+}
+
 void
 ComponentManager::on_unload_node(
   const std::shared_ptr<rmw_request_id_t> request_header,
@@ -289,6 +866,7 @@ ComponentManager::on_unload_node(
 {
   (void) request_header;
 
+  std::lock_guard<std::mutex> lock(node_wrappers_mutex_);
   auto wrapper = node_wrappers_.find(request->unique_id);
 
   if (wrapper == node_wrappers_.end()) {
@@ -300,6 +878,7 @@ ComponentManager::on_unload_node(
   } else {
     remove_node_from_executor(request->unique_id);
     node_wrappers_.erase(wrapper);
+    node_extra_arguments_.erase(request->unique_id);
     response->success = true;
   }
 }
@@ -313,6 +892,7 @@ ComponentManager::on_list_nodes(
   (void) request_header;
   (void) request;
 
+  std::lock_guard<std::mutex> lock(node_wrappers_mutex_);
   for (auto & wrapper : node_wrappers_) {
     response->unique_ids.push_back(wrapper.first);
     response->full_node_names.push_back(
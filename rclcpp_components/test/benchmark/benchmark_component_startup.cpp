@@ -0,0 +1,181 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "benchmark/benchmark.h"
+
+#include <rcutils/logging.h>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rclcpp_components/component_manager.hpp"
+
+namespace
+{
+
+/// Register the benchmark for 10, 100 and 500 components.
+void
+component_counts(benchmark::internal::Benchmark * benchmark)
+{
+  for (int64_t count : {10, 100, 500}) {
+    benchmark->Arg(count)->Unit(::benchmark::kMillisecond);
+  }
+}
+
+/// Return the resident set size of the process in bytes, 0 if it isn't known.
+size_t
+get_resident_set_size()
+{
+#ifdef __linux__
+  std::ifstream statm("/proc/self/statm");
+  size_t total_pages = 0;
+  size_t resident_pages = 0;
+  if (statm >> total_pages >> resident_pages) {
+    return resident_pages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  }
+#endif
+  return 0;
+}
+
+double
+to_milliseconds(std::chrono::nanoseconds duration)
+{
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+}  // namespace
+
+/// Fixture loading a number of components, the first argument of the benchmark, in a manager.
+/**
+ * Each iteration loads the components in a new manager, which is destroyed afterwards.
+ * The time spent in each phase of the loads and the growth of the resident set size per
+ * component are reported as counters, averaged over the iterations.
+ * The resident set size only grows with the memory which couldn't be reused from the previous
+ * iterations, so the first iteration accounts for most of it.
+ */
+class ComponentStartupTest : public benchmark::Fixture
+{
+public:
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Woverloaded-virtual"
+#endif
+  void SetUp(benchmark::State & state) override
+  {
+    rcutils_logging_set_default_logger_level(RCUTILS_LOG_SEVERITY_WARN);
+
+    // The components are created in the default context, as by a container
+    rclcpp::init(0, nullptr, rclcpp::InitOptions().auto_initialize_logging(false));
+    executor = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+
+    for (int64_t i = 0; i < state.range(0); ++i) {
+      auto request = std::make_shared<LoadNode::Request>();
+      request->package_name = "benchmark_rclcpp_components";
+      request->plugin_name = "benchmark_rclcpp_components::BenchmarkComponent";
+      request->node_name = "benchmark_component_" + std::to_string(i);
+      requests.push_back(request);
+    }
+  }
+
+  void TearDown(benchmark::State &) override
+  {
+    requests.clear();
+    executor.reset();
+    rclcpp::shutdown();
+  }
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif
+
+protected:
+  using LoadNode = rclcpp_components::ComponentManager::LoadNode;
+
+  /// Load the components in a new manager, adding the timings and memory to the counters.
+  void LoadComponents(benchmark::State & state, const rclcpp::NodeOptions & manager_options)
+  {
+    state.PauseTiming();
+    auto manager = std::make_shared<rclcpp_components::ComponentManager>(
+      executor, "my_manager", manager_options);
+    const size_t resident_set_size = get_resident_set_size();
+    state.ResumeTiming();
+
+    auto responses = manager->load_nodes(requests);
+
+    state.PauseTiming();
+    for (const auto & response : responses) {
+      if (!response->success) {
+        state.SkipWithError(response->error_message.c_str());
+        break;
+      }
+    }
+    const auto timings = manager->get_load_timings();
+    state.counters["resource_lookup_ms"] += to_milliseconds(timings.resource_lookup);
+    state.counters["library_load_ms"] += to_milliseconds(timings.library_load);
+    state.counters["factory_creation_ms"] += to_milliseconds(timings.factory_creation);
+    state.counters["node_construction_ms"] += to_milliseconds(timings.node_construction);
+    state.counters["executor_add_ms"] += to_milliseconds(timings.executor_registration);
+    const size_t grown_resident_set_size = get_resident_set_size();
+    if (grown_resident_set_size > resident_set_size) {
+      state.counters["rss_per_component"] +=
+        static_cast<double>(grown_resident_set_size - resident_set_size) /
+        static_cast<double>(requests.size());
+    }
+    manager.reset();
+    state.ResumeTiming();
+  }
+
+  /// Average the counters added by LoadComponents() over the iterations.
+  void AverageCounters(benchmark::State & state)
+  {
+    for (auto & counter : state.counters) {
+      counter.second.flags = benchmark::Counter::kAvgIterations;
+    }
+  }
+
+  rclcpp::executors::SingleThreadedExecutor::SharedPtr executor;
+  std::vector<std::shared_ptr<LoadNode::Request>> requests;
+};
+
+BENCHMARK_DEFINE_F(ComponentStartupTest, load_components)(benchmark::State & state)
+{
+  for (auto _ : state) {
+    (void)_;
+    LoadComponents(state, rclcpp::NodeOptions());
+  }
+  AverageCounters(state);
+}
+BENCHMARK_REGISTER_F(ComponentStartupTest, load_components)->Apply(component_counts);
+
+BENCHMARK_DEFINE_F(ComponentStartupTest, load_components_concurrently)(benchmark::State & state)
+{
+  const auto options = rclcpp::NodeOptions().parameter_overrides(
+    {{"load_thread_num", 4},
+      {"preload_packages", std::vector<std::string>{"benchmark_rclcpp_components"}}});
+  for (auto _ : state) {
+    (void)_;
+    LoadComponents(state, options);
+  }
+  AverageCounters(state);
+}
+BENCHMARK_REGISTER_F(ComponentStartupTest, load_components_concurrently)->Apply(
+  component_counts);
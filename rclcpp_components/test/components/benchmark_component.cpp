@@ -0,0 +1,70 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "composition_interfaces/srv/list_nodes.hpp"
+#include "rclcpp/rclcpp.hpp"
+#include "std_msgs/msg/string.hpp"
+
+namespace benchmark_rclcpp_components
+{
+
+/// Component with the entities of a typical node of a pipeline.
+/**
+ * The components share the names of their topics, so that each publisher is matched with the
+ * subscriptions of all the components.
+ */
+class BenchmarkComponent : public rclcpp::Node
+{
+public:
+  explicit BenchmarkComponent(rclcpp::NodeOptions options)
+  : rclcpp::Node("benchmark_component", options)
+  {
+    constexpr size_t topic_count = 5;
+    constexpr size_t parameter_count = 10;
+    for (size_t i = 0; i < topic_count; ++i) {
+      publishers_.push_back(
+        create_publisher<std_msgs::msg::String>("output_" + std::to_string(i), 10));
+      subscriptions_.push_back(
+        create_subscription<std_msgs::msg::String>(
+          "output_" + std::to_string(i), 10, [](std_msgs::msg::String::ConstSharedPtr) {}));
+    }
+    for (size_t i = 0; i < parameter_count; ++i) {
+      declare_parameter("parameter_" + std::to_string(i), static_cast<int64_t>(i));
+    }
+    service_ = create_service<composition_interfaces::srv::ListNodes>(
+      "~/list",
+      [](
+        const std::shared_ptr<composition_interfaces::srv::ListNodes::Request>,
+        std::shared_ptr<composition_interfaces::srv::ListNodes::Response>) {});
+    timer_ = create_wall_timer(std::chrono::seconds(1), []() {});
+  }
+
+private:
+  std::vector<rclcpp::Publisher<std_msgs::msg::String>::SharedPtr> publishers_;
+  std::vector<rclcpp::Subscription<std_msgs::msg::String>::SharedPtr> subscriptions_;
+  rclcpp::Service<composition_interfaces::srv::ListNodes>::SharedPtr service_;
+  rclcpp::TimerBase::SharedPtr timer_;
+};
+
+}  // namespace benchmark_rclcpp_components
+
+#include "rclcpp_components/register_node_macro.hpp"
+
+RCLCPP_COMPONENTS_REGISTER_NODE(benchmark_rclcpp_components::BenchmarkComponent)
@@ -15,6 +15,8 @@
 #include <gtest/gtest.h>
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "rclcpp_components/component_manager.hpp"
 
@@ -95,3 +97,200 @@ TEST_F(TestComponentManager, create_component_factory_invalid)
     auto resources = manager->get_component_resources("invalid_rclcpp_components"),
     rclcpp_components::ComponentManagerException);
 }
+
+TEST_F(TestComponentManager, load_nodes)
+{
+  using LoadNode = rclcpp_components::ComponentManager::LoadNode;
+  auto exec = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+  auto manager = std::make_shared<rclcpp_components::ComponentManager>(
+    exec, "ComponentManager",
+    rclcpp::NodeOptions().parameter_overrides({{"load_thread_num", 4}}));
+
+  std::vector<std::shared_ptr<LoadNode::Request>> requests;
+  for (const char * plugin_name : {"TestComponentFoo", "TestComponent", "TestComponentBar"}) {
+    auto request = std::make_shared<LoadNode::Request>();
+    request->package_name = "rclcpp_components";
+    request->plugin_name = std::string("test_rclcpp_components::") + plugin_name;
+    requests.push_back(request);
+  }
+  requests.push_back(std::make_shared<LoadNode::Request>(*requests[0]));
+  requests.back()->node_name = "test_component_baz";
+
+  // The unique ids follow the order of the requests, not the order the nodes were constructed
+  auto responses = manager->load_nodes(requests);
+  ASSERT_EQ(4u, responses.size());
+  EXPECT_TRUE(responses[0]->success);
+  EXPECT_EQ("/test_component_foo", responses[0]->full_node_name);
+  EXPECT_EQ(1u, responses[0]->unique_id);
+  EXPECT_FALSE(responses[1]->success);
+  EXPECT_EQ(0u, responses[1]->unique_id);
+  EXPECT_TRUE(responses[2]->success);
+  EXPECT_EQ("/test_component_bar", responses[2]->full_node_name);
+  EXPECT_EQ(2u, responses[2]->unique_id);
+  EXPECT_TRUE(responses[3]->success);
+  EXPECT_EQ("/test_component_baz", responses[3]->full_node_name);
+  EXPECT_EQ(3u, responses[3]->unique_id);
+}
+
+TEST_F(TestComponentManager, load_nodes_on_worker_pool)
+{
+  using LoadNode = rclcpp_components::ComponentManager::LoadNode;
+  auto exec = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+  auto manager = std::make_shared<rclcpp_components::ComponentManager>(
+    exec, "ComponentManager",
+    rclcpp::NodeOptions().parameter_overrides({{"load_on_worker_pool", true}}));
+
+  std::vector<std::shared_ptr<LoadNode::Request>> requests;
+  for (const char * plugin_name : {"TestComponentFoo", "TestComponentBar"}) {
+    auto request = std::make_shared<LoadNode::Request>();
+    request->package_name = "rclcpp_components";
+    request->plugin_name = std::string("test_rclcpp_components::") + plugin_name;
+    requests.push_back(request);
+  }
+
+  auto responses = manager->load_nodes(requests);
+  ASSERT_EQ(2u, responses.size());
+  EXPECT_TRUE(responses[0]->success);
+  EXPECT_EQ(1u, responses[0]->unique_id);
+  EXPECT_TRUE(responses[1]->success);
+  EXPECT_EQ(2u, responses[1]->unique_id);
+
+  // The manager doesn't own the pool, which keeps running after it is destroyed
+  auto context = manager->get_node_base_interface()->get_context();
+  auto worker_pool = context->get_worker_pool();
+  manager.reset();
+  EXPECT_EQ(worker_pool, context->get_worker_pool());
+}
+
+TEST_F(TestComponentManager, preload_libraries)
+{
+  auto exec = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+  auto manager = std::make_shared<rclcpp_components::ComponentManager>(
+    exec, "ComponentManager",
+    rclcpp::NodeOptions().parameter_overrides(
+      {{"preload_packages", std::vector<std::string>{"rclcpp_components", "invalid_package"}}}));
+
+  // The three components of the package share a library
+  auto timings = manager->get_load_timings();
+  EXPECT_EQ(1u, timings.loaded_libraries);
+  EXPECT_EQ(0u, timings.loaded_nodes);
+  EXPECT_GT(timings.library_load.count(), 0);
+
+  // The cached resources and classes are reused
+  auto resources = manager->get_component_resources("rclcpp_components");
+  ASSERT_EQ(3u, resources.size());
+  EXPECT_NE(nullptr, manager->create_component_factory(resources[1]));
+
+  using LoadNode = rclcpp_components::ComponentManager::LoadNode;
+  auto request = std::make_shared<LoadNode::Request>();
+  request->package_name = "rclcpp_components";
+  request->plugin_name = "test_rclcpp_components::TestComponentFoo";
+  auto responses = manager->load_nodes({request});
+  ASSERT_EQ(1u, responses.size());
+  EXPECT_TRUE(responses[0]->success);
+
+  timings = manager->get_load_timings();
+  EXPECT_EQ(1u, timings.loaded_libraries);
+  EXPECT_EQ(1u, timings.loaded_nodes);
+  EXPECT_GT(timings.node_construction.count(), 0);
+}
+
+class ComponentManagerWithNodes : public rclcpp_components::ComponentManager
+{
+public:
+  using rclcpp_components::ComponentManager::ComponentManager;
+
+  rclcpp::node_interfaces::NodeBaseInterface::SharedPtr
+  get_node(uint64_t node_id)
+  {
+    return node_wrappers_.at(node_id).get_node_base_interface();
+  }
+};
+
+TEST_F(TestComponentManager, component_executors)
+{
+  using LoadNode = rclcpp_components::ComponentManager::LoadNode;
+  auto exec = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+  auto manager = std::make_shared<ComponentManagerWithNodes>(
+    exec, "ComponentManager",
+    rclcpp::NodeOptions().parameter_overrides({{"use_intra_process_comms", true}}));
+
+  auto request = std::make_shared<LoadNode::Request>();
+  request->package_name = "rclcpp_components";
+  request->plugin_name = "test_rclcpp_components::TestComponentFoo";
+  request->extra_arguments.push_back(
+    rclcpp::Parameter("executor_type", "multi_threaded").to_parameter_msg());
+  request->extra_arguments.push_back(
+    rclcpp::Parameter("executor_thread_num", 2).to_parameter_msg());
+
+  auto invalid_request = std::make_shared<LoadNode::Request>(*request);
+  invalid_request->plugin_name = "test_rclcpp_components::TestComponentBar";
+  invalid_request->extra_arguments[0] =
+    rclcpp::Parameter("executor_type", "events").to_parameter_msg();
+
+  auto default_request = std::make_shared<LoadNode::Request>();
+  default_request->package_name = "rclcpp_components";
+  default_request->plugin_name = "test_rclcpp_components::TestComponentBar";
+  default_request->extra_arguments.push_back(
+    rclcpp::Parameter("use_intra_process_comms", false).to_parameter_msg());
+
+  auto responses = manager->load_nodes({request, invalid_request, default_request});
+  ASSERT_EQ(3u, responses.size());
+  ASSERT_TRUE(responses[0]->success);
+  EXPECT_FALSE(responses[1]->success);
+  ASSERT_TRUE(responses[2]->success);
+
+  // The container-wide default applies unless the load request overrides it
+  EXPECT_TRUE(manager->get_node(responses[0]->unique_id)->get_use_intra_process_default());
+  EXPECT_FALSE(manager->get_node(responses[2]->unique_id)->get_use_intra_process_default());
+
+  // The component spun by its own executor is not in the executor of the manager
+  EXPECT_THROW(
+    exec->remove_node(manager->get_node(responses[0]->unique_id)), std::runtime_error);
+  EXPECT_NO_THROW(exec->remove_node(manager->get_node(responses[2]->unique_id)));
+  exec->add_node(manager->get_node(responses[2]->unique_id));
+}
+
+TEST_F(TestComponentManager, reload_node)
+{
+  using LoadNode = rclcpp_components::ComponentManager::LoadNode;
+  auto exec = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+  auto manager = std::make_shared<ComponentManagerWithNodes>(exec, "ComponentManager");
+
+  auto request = std::make_shared<LoadNode::Request>();
+  request->package_name = "rclcpp_components";
+  request->plugin_name = "test_rclcpp_components::TestComponentFoo";
+  auto responses = manager->load_nodes({request});
+  ASSERT_EQ(1u, responses.size());
+  ASSERT_TRUE(responses[0]->success);
+  const uint64_t unique_id = responses[0]->unique_id;
+  const rcl_node_t * rcl_node = manager->get_node(unique_id)->get_rcl_node_handle();
+
+  // The new instance keeps the unique id and uses the rcl node of the old one
+  auto response = manager->reload_node(unique_id, request);
+  ASSERT_TRUE(response->success);
+  EXPECT_EQ(unique_id, response->unique_id);
+  EXPECT_EQ("/test_component_foo", response->full_node_name);
+  EXPECT_EQ(rcl_node, manager->get_node(unique_id)->get_rcl_node_handle());
+
+  // A load request can reload a component, but not an unknown one
+  auto reload_request = std::make_shared<LoadNode::Request>(*request);
+  reload_request->extra_arguments.push_back(
+    rclcpp::Parameter("reload_unique_id", static_cast<int64_t>(unique_id)).to_parameter_msg());
+  auto unknown_request = std::make_shared<LoadNode::Request>(*request);
+  unknown_request->extra_arguments.push_back(
+    rclcpp::Parameter("reload_unique_id", static_cast<int64_t>(unique_id + 1)).to_parameter_msg());
+  responses = manager->load_nodes({reload_request, unknown_request});
+  ASSERT_EQ(2u, responses.size());
+  EXPECT_TRUE(responses[0]->success);
+  EXPECT_EQ(unique_id, responses[0]->unique_id);
+  EXPECT_FALSE(responses[1]->success);
+  EXPECT_EQ(rcl_node, manager->get_node(unique_id)->get_rcl_node_handle());
+
+  // A failed reload unloads the component
+  auto invalid_request = std::make_shared<LoadNode::Request>(*request);
+  invalid_request->plugin_name = "test_rclcpp_components::TestComponent";
+  response = manager->reload_node(unique_id, invalid_request);
+  EXPECT_FALSE(response->success);
+  EXPECT_THROW(manager->get_node(unique_id), std::out_of_range);
+}
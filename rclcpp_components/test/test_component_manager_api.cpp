@@ -37,17 +37,24 @@ protected:
 
 // TODO(hidmic): split up tests once Node bring up/tear down races
 //               are solved https://github.com/ros2/rclcpp/issues/863
-void test_components_api(bool use_dedicated_executor)
+void test_components_api(
+  bool use_dedicated_executor, int64_t load_thread_num = 1, int64_t executor_pool_size = 0)
 {
   auto exec = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
   auto node = rclcpp::Node::make_shared("test_component_manager");
+  const auto options = rclcpp::NodeOptions()
+    .start_parameter_services(false)
+    .start_parameter_event_publisher(false)
+    .parameter_overrides(
+    {{"load_thread_num", load_thread_num}, {"executor_pool_size", executor_pool_size}});
   std::shared_ptr<rclcpp_components::ComponentManager> manager;
   if (use_dedicated_executor) {
     using ComponentManagerIsolated =
       rclcpp_components::ComponentManagerIsolated<rclcpp::executors::SingleThreadedExecutor>;
-    manager = std::make_shared<ComponentManagerIsolated>(exec);
+    manager = std::make_shared<ComponentManagerIsolated>(exec, "ComponentManager", options);
   } else {
-    manager = std::make_shared<rclcpp_components::ComponentManager>(exec);
+    manager = std::make_shared<rclcpp_components::ComponentManager>(
+      exec, "ComponentManager", options);
   }
 
   exec->add_node(manager);
@@ -219,6 +226,28 @@ void test_components_api(bool use_dedicated_executor)
     EXPECT_EQ(result->unique_id, 0u);
   }
 
+  {
+    // start_lifecycle_services is not a bool type parameter
+    auto request = std::make_shared<composition_interfaces::srv::LoadNode::Request>();
+    request->package_name = "rclcpp_components";
+    request->plugin_name = "test_rclcpp_components::TestComponentFoo";
+    request->node_name = "test_component_lifecycle_services_str";
+
+    rclcpp::Parameter start_lifecycle_services("start_lifecycle_services",
+      rclcpp::ParameterValue("hello"));
+    request->extra_arguments.push_back(start_lifecycle_services.to_parameter_msg());
+
+    auto future = composition_client->async_send_request(request);
+    auto ret = exec->spin_until_future_complete(future, 5s);  // Wait for the result.
+    auto result = future.get();
+    EXPECT_EQ(ret, rclcpp::FutureReturnCode::SUCCESS);
+    EXPECT_EQ(result->success, false);
+    EXPECT_EQ(
+      result->error_message,
+      "Extra component argument 'start_lifecycle_services' must be a boolean");
+    EXPECT_EQ(result->unique_id, 0u);
+  }
+
   {
     // forward_global_arguments
     auto request = std::make_shared<composition_interfaces::srv::LoadNode::Request>();
@@ -387,4 +416,16 @@ TEST_F(TestComponentManager, components_api)
     SCOPED_TRACE("ComponentManagerIsolated");
     test_components_api(true);
   }
+  {
+    SCOPED_TRACE("ComponentManager with load threads");
+    test_components_api(false, 2);
+  }
+  {
+    SCOPED_TRACE("ComponentManagerIsolated with load threads");
+    test_components_api(true, 2);
+  }
+  {
+    SCOPED_TRACE("ComponentManagerIsolated with an executor pool");
+    test_components_api(true, 1, 2);
+  }
 }
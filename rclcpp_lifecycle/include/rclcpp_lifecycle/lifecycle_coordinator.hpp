@@ -0,0 +1,186 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP_LIFECYCLE__LIFECYCLE_COORDINATOR_HPP_
+#define RCLCPP_LIFECYCLE__LIFECYCLE_COORDINATOR_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "lifecycle_msgs/srv/change_state.hpp"
+
+#include "rclcpp/callback_group.hpp"
+#include "rclcpp/deserialization_thread_pool.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/node_interfaces/node_base_interface.hpp"
+#include "rclcpp/node_interfaces/node_services_interface.hpp"
+#include "rclcpp/service.hpp"
+
+#include "rclcpp_lifecycle/lifecycle_node.hpp"
+#include "rclcpp_lifecycle/visibility_control.h"
+
+namespace rclcpp_lifecycle
+{
+
+/// Apply lifecycle transitions to a set of lifecycle nodes of the same process.
+/**
+ * Each node may depend on other nodes of the coordinator.
+ * The transitions bringing the nodes up, configure and activate, are applied to the
+ * dependencies of a node before the node itself, the other transitions in the reverse order.
+ * Nodes not waiting on each other are transitioned in parallel by the worker threads of the
+ * coordinator, and a node isn't transitioned when the transition of a node it waits on failed.
+ *
+ * The coordinator can offer a lifecycle_msgs/srv/ChangeState service applying the requested
+ * transition to all its nodes, so that a whole container is brought up with a single request
+ * instead of one request per node and transition.
+ * The nodes then don't need lifecycle services of their own, see
+ * rclcpp::NodeOptions::start_lifecycle_services().
+ */
+class LifecycleCoordinator
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(LifecycleCoordinator)
+
+  using ChangeStateSrv = lifecycle_msgs::srv::ChangeState;
+
+  /// Result of a transition for one node.
+  struct NodeTransitionResult
+  {
+    /// Fully qualified name of the node.
+    std::string node_name;
+    /// Whether the transition was applied and its callback succeeded.
+    bool success = false;
+    /// Whether the node was left as is because the transition failed for a node it waits on.
+    bool skipped = false;
+    /// Id of the state of the node after the transition.
+    uint8_t state_id = 0;
+  };
+
+  /// Result of a transition for all the nodes of the coordinator.
+  struct TransitionResult
+  {
+    /// Whether the transition succeeded for all the nodes.
+    bool success = true;
+    /// Results of the nodes, in the order they were added.
+    std::vector<NodeTransitionResult> nodes;
+  };
+
+  /// Create a coordinator.
+  /**
+   * \param[in] number_of_threads number of threads transitioning the nodes in parallel,
+   *   0 to use the number of cores.
+   */
+  RCLCPP_LIFECYCLE_PUBLIC
+  explicit LifecycleCoordinator(size_t number_of_threads = 0);
+
+  RCLCPP_LIFECYCLE_PUBLIC
+  virtual ~LifecycleCoordinator();
+
+  /// Add a node to the coordinator.
+  /**
+   * \param[in] node the node to transition.
+   * \param[in] dependencies fully qualified names of the nodes this node depends on, they must
+   *   have been added before.
+   * \throws std::invalid_argument if the node is null, was added already, or a dependency is
+   *   unknown.
+   */
+  RCLCPP_LIFECYCLE_PUBLIC
+  void
+  add_node(
+    LifecycleNode::SharedPtr node,
+    const std::vector<std::string> & dependencies = {});
+
+  /// Remove a node from the coordinator.
+  /**
+   * \param[in] node_name fully qualified name of the node.
+   * \return false if the node isn't part of the coordinator.
+   * \throws std::invalid_argument if other nodes of the coordinator depend on the node.
+   */
+  RCLCPP_LIFECYCLE_PUBLIC
+  bool
+  remove_node(const std::string & node_name);
+
+  /// Return the number of nodes of the coordinator.
+  RCLCPP_LIFECYCLE_PUBLIC
+  size_t
+  get_number_of_nodes() const;
+
+  /// Apply a transition to all the nodes and wait for it to complete.
+  /**
+   * \param[in] transition_id id of the transition, see lifecycle_msgs/msg/Transition.
+   */
+  RCLCPP_LIFECYCLE_PUBLIC
+  TransitionResult
+  change_state(uint8_t transition_id);
+
+  /// Apply a transition to all the nodes and wait for it to complete.
+  /**
+   * The transition is looked up in the current state of each node, so that for example
+   * "shutdown" is applied to nodes in different primary states.
+   *
+   * \param[in] transition_label label of the transition.
+   */
+  RCLCPP_LIFECYCLE_PUBLIC
+  TransitionResult
+  change_state(const std::string & transition_label);
+
+  /// Offer a service applying the requested transition to all the nodes.
+  /**
+   * The label of the request takes precedence over its id, like for the change_state service
+   * of a lifecycle node.
+   * The response succeeds when the transition succeeded for all the nodes.
+   * The service waits for the transitions in the callback, the transition callbacks of the
+   * nodes must not wait on the executor spinning the service.
+   * The coordinator must outlive the service.
+   *
+   * \param[in] node_base base interface of the node offering the service.
+   * \param[in] node_services services interface of the node offering the service.
+   * \param[in] service_name name of the service.
+   * \param[in] group callback group of the service, null for the default one.
+   * \return the service.
+   */
+  RCLCPP_LIFECYCLE_PUBLIC
+  rclcpp::Service<ChangeStateSrv>::SharedPtr
+  create_change_state_service(
+    rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_base,
+    rclcpp::node_interfaces::NodeServicesInterface::SharedPtr node_services,
+    const std::string & service_name = "~/coordinator/change_state",
+    rclcpp::CallbackGroup::SharedPtr group = nullptr);
+
+private:
+  struct ManagedNode
+  {
+    LifecycleNode::SharedPtr node;
+    std::string name;
+    std::vector<std::string> dependencies;
+    /// One more than the highest level of the dependencies.
+    size_t level;
+  };
+
+  TransitionResult
+  apply_transition(uint8_t transition_id, const std::string & transition_label, bool up);
+
+  mutable std::mutex nodes_mutex_;
+  std::vector<ManagedNode> nodes_;
+  /// Serializes the transitions.
+  std::mutex transition_mutex_;
+  rclcpp::DeserializationThreadPool thread_pool_;
+};
+
+}  // namespace rclcpp_lifecycle
+
+#endif  // RCLCPP_LIFECYCLE__LIFECYCLE_COORDINATOR_HPP_
@@ -27,6 +27,9 @@
  *   - rclcpp_lifecycle/publisher.hpp
  * - Lifecycle node: An optional interface class for life cycle node implementations.
  *   - rclcpp_lifecycle/lifecycle_node.hpp
+ * - Lifecycle coordinator: Applies a transition to many lifecycle nodes of a process in the order
+ *   of their dependencies.
+ *   - rclcpp_lifecycle/lifecycle_coordinator.hpp
  *
  * Some useful internal abstractions and utilities:
  * - Macros for controlling symbol visibility on the library
@@ -38,6 +41,7 @@
 
 #include <chrono>
 #include <functional>
+#include <future>
 #include <map>
 #include <memory>
 #include <string>
@@ -87,6 +91,9 @@
 
 #include "rclcpp_lifecycle/node_interfaces/lifecycle_node_interface.hpp"
 #include "rclcpp_lifecycle/lifecycle_publisher.hpp"
+#include "rclcpp_lifecycle/lifecycle_subscription.hpp"
+#include "rclcpp_lifecycle/lifecycle_timer.hpp"
+#include "rclcpp_lifecycle/managed_entity.hpp"
 #include "rclcpp_lifecycle/state.hpp"
 #include "rclcpp_lifecycle/transition.hpp"
 #include "rclcpp_lifecycle/visibility_control.h"
@@ -132,6 +139,7 @@ public:
    * \param[in] node_name Name of the node.
    * \param[in] options Additional options to control creation of the node.
    * \param[in] enable_communication_interface Deciding whether the communication interface of the underlying rcl_lifecycle_node shall be enabled.
+   *   It is disabled as well if rclcpp::NodeOptions::start_lifecycle_services() is false.
    */
   RCLCPP_LIFECYCLE_PUBLIC
   explicit LifecycleNode(
@@ -145,6 +153,7 @@ public:
    * \param[in] namespace_ Namespace of the node.
    * \param[in] options Additional options to control creation of the node.
    * \param[in] enable_communication_interface Deciding whether the communication interface of the underlying rcl_lifecycle_node shall be enabled.
+   *   It is disabled as well if rclcpp::NodeOptions::start_lifecycle_services() is false.
    */
   RCLCPP_LIFECYCLE_PUBLIC
   LifecycleNode(
@@ -219,11 +228,15 @@ public:
 
   /// Create and return a Subscription.
   /**
+   * If SubscriptionT is a rclcpp_lifecycle::ManagedEntityInterface, e.g. a
+   * rclcpp_lifecycle::LifecycleSubscription, it is activated and deactivated with the node.
+   *
    * \param[in] topic_name The topic to subscribe on.
    * \param[in] callback The user-defined callback function.
    * \param[in] qos The quality of service for this subscription.
    * \param[in] options The subscription options for this subscription.
-   * \param[in] msg_mem_strat The message memory strategy to use for allocating messages.
+   * \param[in] msg_mem_strat The message memory strategy to use for allocating messages,
+   *   nullptr for the default one using the allocator of the options.
    * \return Shared pointer to the created subscription.
    */
   template<
@@ -239,11 +252,32 @@ public:
     CallbackT && callback,
     const SubscriptionOptionsWithAllocator<AllocatorT> & options =
     create_default_subscription_options<AllocatorT>(),
-    typename MessageMemoryStrategyT::SharedPtr msg_mem_strat = (
-      MessageMemoryStrategyT::create_default()
-    )
+    typename MessageMemoryStrategyT::SharedPtr msg_mem_strat = nullptr
   );
 
+  /// Create and return a Subscription which only delivers the messages while the node is active.
+  /**
+   * The subscription is paused while the node isn't active, see
+   * rclcpp_lifecycle::LifecycleSubscription, so that the callback doesn't have to check the
+   * state of the node.
+   * It is active from the start when created while the node is active.
+   *
+   * \sa create_subscription
+   */
+  template<
+    typename MessageT,
+    typename CallbackT,
+    typename AllocatorT = std::allocator<void>>
+  std::shared_ptr<rclcpp_lifecycle::LifecycleSubscription<MessageT, AllocatorT>>
+  create_lifecycle_subscription(
+    const std::string & topic_name,
+    const rclcpp::QoS & qos,
+    CallbackT && callback,
+    const SubscriptionOptionsWithAllocator<AllocatorT> & options =
+    create_default_subscription_options<AllocatorT>(),
+    typename rclcpp_lifecycle::LifecycleSubscription<MessageT, AllocatorT>::
+    MessageMemoryStrategyType::SharedPtr msg_mem_strat = nullptr);
+
   /// Create a timer that uses the wall clock to drive the callback.
   /**
    * \param[in] period Time interval between triggers of the callback.
@@ -270,6 +304,35 @@ public:
     CallbackT callback,
     rclcpp::CallbackGroup::SharedPtr group = nullptr);
 
+  /// Create a timer that uses the wall clock and only runs while the node is active.
+  /**
+   * The timer is canceled while the node isn't active and reset when it is activated, see
+   * rclcpp_lifecycle::LifecycleTimer.
+   * It runs from the start when created while the node is active.
+   *
+   * \param[in] period Time interval between triggers of the callback.
+   * \param[in] callback User-defined callback function.
+   * \param[in] group Callback group to execute this timer's callback in.
+   * \throws std::invalid_argument if the period is negative or too large
+   */
+  template<typename DurationRepT = int64_t, typename DurationT = std::milli, typename CallbackT>
+  typename rclcpp_lifecycle::LifecycleTimer<CallbackT>::SharedPtr
+  create_lifecycle_wall_timer(
+    std::chrono::duration<DurationRepT, DurationT> period,
+    CallbackT callback,
+    rclcpp::CallbackGroup::SharedPtr group = nullptr);
+
+  /// Create a timer that uses the node clock and only runs while the node is active.
+  /**
+   * \sa create_lifecycle_wall_timer
+   */
+  template<typename DurationRepT = int64_t, typename DurationT = std::milli, typename CallbackT>
+  typename rclcpp_lifecycle::LifecycleTimer<CallbackT>::SharedPtr
+  create_lifecycle_timer(
+    std::chrono::duration<DurationRepT, DurationT> period,
+    CallbackT callback,
+    rclcpp::CallbackGroup::SharedPtr group = nullptr);
+
   /// Create and return a Client.
   /**
    * \sa rclcpp::Node::create_client
@@ -352,6 +415,21 @@ public:
     )
   );
 
+  /// Create and return a GenericSubscription borrowing views of the serialized messages.
+  /**
+   * \sa rclcpp::Node::create_generic_subscription
+   */
+  template<typename AllocatorT = std::allocator<void>>
+  std::shared_ptr<rclcpp::GenericSubscription> create_generic_subscription(
+    const std::string & topic_name,
+    const std::string & topic_type,
+    const rclcpp::QoS & qos,
+    rclcpp::GenericSubscription::ViewCallback callback,
+    const rclcpp::SubscriptionOptionsWithAllocator<AllocatorT> & options = (
+      rclcpp::SubscriptionOptionsWithAllocator<AllocatorT>()
+    )
+  );
+
   /// Declare and initialize a parameter, return the effective value.
   /**
    * \sa rclcpp::Node::declare_parameter
@@ -901,6 +979,34 @@ public:
   trigger_transition(
     uint8_t transition_id, LifecycleNodeInterface::CallbackReturn & cb_return_code);
 
+  /// Run the transition callbacks on a worker thread of the node.
+  /**
+   * In this mode the change_state service and trigger_transition_async() move the node to the
+   * intermediate state of the transition, e.g. configuring, and return.
+   * The transition callbacks, and the managed entities they activate or deactivate, then run
+   * on the worker thread, which completes the transition and answers the service request.
+   * Long callbacks, e.g. loading a map, don't hold the executor thread meanwhile, and the
+   * transitions requested until the transition completes fail.
+   *
+   * trigger_transition() and the shortcuts like configure() keep running the callbacks on the
+   * calling thread.
+   * The transitions must have completed before the node is destroyed.
+   */
+  RCLCPP_LIFECYCLE_PUBLIC
+  void
+  enable_async_transitions();
+
+  /// Trigger the specified transition and run its callbacks on the worker thread of the node.
+  /*
+   * \sa enable_async_transitions()
+   * \return a future completed with the transition callback return code once the node reached
+   *   the next primary state, or with ERROR if the transition couldn't start.
+   * \throws std::runtime_error if the asynchronous transitions aren't enabled.
+   */
+  RCLCPP_LIFECYCLE_PUBLIC
+  std::shared_future<LifecycleNodeInterface::CallbackReturn>
+  trigger_transition_async(uint8_t transition_id);
+
   /// Trigger the configure transition
   /*
    * \param[out] cb_return_code transition callback return code.
@@ -1064,6 +1170,21 @@ protected:
   void
   add_timer_handle(std::shared_ptr<rclcpp::TimerBase> timer);
 
+  /// Add the managed entity, activated if the node is active and deactivated otherwise.
+  RCLCPP_LIFECYCLE_PUBLIC
+  void
+  add_managed_entity_in_current_state(
+    std::shared_ptr<rclcpp_lifecycle::ManagedEntityInterface> managed_entity);
+
+  /// Create a LifecycleTimer with the given clock, added to the node and managed by it.
+  template<typename DurationRepT, typename DurationT, typename CallbackT>
+  typename rclcpp_lifecycle::LifecycleTimer<CallbackT>::SharedPtr
+  create_lifecycle_timer_with_clock(
+    rclcpp::Clock::SharedPtr clock,
+    std::chrono::duration<DurationRepT, DurationT> period,
+    CallbackT callback,
+    rclcpp::CallbackGroup::SharedPtr group);
+
 private:
   RCLCPP_DISABLE_COPY(LifecycleNode)
 
@@ -21,6 +21,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -33,6 +34,8 @@
 #include "rclcpp/create_publisher.hpp"
 #include "rclcpp/create_service.hpp"
 #include "rclcpp/create_subscription.hpp"
+#include "rclcpp/create_timer.hpp"
+#include "rclcpp/detail/get_declared_parameter_values.hpp"
 #include "rclcpp/parameter.hpp"
 #include "rclcpp/publisher_options.hpp"
 #include "rclcpp/qos.hpp"
@@ -43,6 +46,9 @@
 
 #include "rclcpp_lifecycle/lifecycle_node.hpp"
 #include "rclcpp_lifecycle/lifecycle_publisher.hpp"
+#include "rclcpp_lifecycle/lifecycle_subscription.hpp"
+#include "rclcpp_lifecycle/lifecycle_timer.hpp"
+#include "rclcpp_lifecycle/managed_entity.hpp"
 #include "rclcpp_lifecycle/visibility_control.h"
 
 namespace rclcpp_lifecycle
@@ -65,7 +71,6 @@ LifecycleNode::create_publisher(
   return pub;
 }
 
-// TODO(karsten1987): Create LifecycleSubscriber
 template<
   typename MessageT,
   typename CallbackT,
@@ -80,13 +85,38 @@ LifecycleNode::create_subscription(
   const rclcpp::SubscriptionOptionsWithAllocator<AllocatorT> & options,
   typename MessageMemoryStrategyT::SharedPtr msg_mem_strat)
 {
-  return rclcpp::create_subscription<MessageT>(
+  auto sub = rclcpp::create_subscription<
+    MessageT, CallbackT, AllocatorT, SubscriptionT, MessageMemoryStrategyT>(
     *this,
     topic_name,
     qos,
     std::forward<CallbackT>(callback),
     options,
     msg_mem_strat);
+  if constexpr (std::is_base_of_v<rclcpp_lifecycle::ManagedEntityInterface, SubscriptionT>) {
+    this->add_managed_entity_in_current_state(sub);
+  }
+  return sub;
+}
+
+template<typename MessageT, typename CallbackT, typename AllocatorT>
+std::shared_ptr<rclcpp_lifecycle::LifecycleSubscription<MessageT, AllocatorT>>
+LifecycleNode::create_lifecycle_subscription(
+  const std::string & topic_name,
+  const rclcpp::QoS & qos,
+  CallbackT && callback,
+  const rclcpp::SubscriptionOptionsWithAllocator<AllocatorT> & options,
+  typename rclcpp_lifecycle::LifecycleSubscription<MessageT, AllocatorT>::
+  MessageMemoryStrategyType::SharedPtr msg_mem_strat)
+{
+  return this->create_subscription<
+    MessageT, CallbackT, AllocatorT,
+    rclcpp_lifecycle::LifecycleSubscription<MessageT, AllocatorT>>(
+    topic_name,
+    qos,
+    std::forward<CallbackT>(callback),
+    options,
+    msg_mem_strat);
 }
 
 template<typename DurationRepT, typename DurationT, typename CallbackT>
@@ -120,6 +150,46 @@ LifecycleNode::create_timer(
     this->node_timers_.get());
 }
 
+template<typename DurationRepT, typename DurationT, typename CallbackT>
+typename rclcpp_lifecycle::LifecycleTimer<CallbackT>::SharedPtr
+LifecycleNode::create_lifecycle_wall_timer(
+  std::chrono::duration<DurationRepT, DurationT> period,
+  CallbackT callback,
+  rclcpp::CallbackGroup::SharedPtr group)
+{
+  return this->create_lifecycle_timer_with_clock(
+    std::make_shared<rclcpp::Clock>(RCL_STEADY_TIME), period, std::move(callback), group);
+}
+
+template<typename DurationRepT, typename DurationT, typename CallbackT>
+typename rclcpp_lifecycle::LifecycleTimer<CallbackT>::SharedPtr
+LifecycleNode::create_lifecycle_timer(
+  std::chrono::duration<DurationRepT, DurationT> period,
+  CallbackT callback,
+  rclcpp::CallbackGroup::SharedPtr group)
+{
+  return this->create_lifecycle_timer_with_clock(
+    this->get_clock(), period, std::move(callback), group);
+}
+
+template<typename DurationRepT, typename DurationT, typename CallbackT>
+typename rclcpp_lifecycle::LifecycleTimer<CallbackT>::SharedPtr
+LifecycleNode::create_lifecycle_timer_with_clock(
+  rclcpp::Clock::SharedPtr clock,
+  std::chrono::duration<DurationRepT, DurationT> period,
+  CallbackT callback,
+  rclcpp::CallbackGroup::SharedPtr group)
+{
+  auto timer = rclcpp_lifecycle::LifecycleTimer<CallbackT>::make_shared(
+    std::move(clock),
+    rclcpp::detail::safe_cast_to_period_in_ns(period),
+    std::move(callback),
+    this->node_base_->get_context());
+  this->node_timers_->add_timer(timer, group);
+  this->add_managed_entity_in_current_state(timer);
+  return timer;
+}
+
 template<typename ServiceT>
 typename rclcpp::Client<ServiceT>::SharedPtr
 LifecycleNode::create_client(
@@ -210,6 +280,27 @@ LifecycleNode::create_generic_subscription(
   );
 }
 
+template<typename AllocatorT>
+std::shared_ptr<rclcpp::GenericSubscription>
+LifecycleNode::create_generic_subscription(
+  const std::string & topic_name,
+  const std::string & topic_type,
+  const rclcpp::QoS & qos,
+  rclcpp::GenericSubscription::ViewCallback callback,
+  const rclcpp::SubscriptionOptionsWithAllocator<AllocatorT> & options)
+{
+  return rclcpp::create_generic_subscription(
+    node_topics_,
+    // TODO(karsten1987): LifecycleNode is currently not supporting subnamespaces
+    // see https://github.com/ros2/rclcpp/issues/1614
+    topic_name,
+    topic_type,
+    qos,
+    std::move(callback),
+    options
+  );
+}
+
 template<typename ParameterT>
 auto
 LifecycleNode::declare_parameter(
@@ -250,15 +341,16 @@ LifecycleNode::declare_parameters(
   const std::string & namespace_,
   const std::map<std::string, ParameterT> & parameters)
 {
-  std::vector<ParameterT> result;
   std::string normalized_namespace = namespace_.empty() ? "" : (namespace_ + ".");
-  std::transform(
-    parameters.begin(), parameters.end(), std::back_inserter(result),
-    [this, &normalized_namespace](auto element) {
-      return this->declare_parameter(normalized_namespace + element.first, element.second);
-    }
-  );
-  return result;
+  std::vector<rclcpp::node_interfaces::ParameterDeclaration> declarations(parameters.size());
+  auto declaration = declarations.begin();
+  for (const auto & element : parameters) {
+    declaration->name = normalized_namespace + element.first;
+    declaration->default_value = rclcpp::ParameterValue(element.second);
+    ++declaration;
+  }
+  return rclcpp::detail::get_declared_parameter_values<ParameterT>(
+    declarations, node_parameters_->declare_parameters(declarations));
 }
 
 template<typename ParameterT>
@@ -270,20 +362,17 @@ LifecycleNode::declare_parameters(
     std::pair<ParameterT, rcl_interfaces::msg::ParameterDescriptor>
   > & parameters)
 {
-  std::vector<ParameterT> result;
   std::string normalized_namespace = namespace_.empty() ? "" : (namespace_ + ".");
-  std::transform(
-    parameters.begin(), parameters.end(), std::back_inserter(result),
-    [this, &normalized_namespace](auto element) {
-      return static_cast<ParameterT>(
-        this->declare_parameter(
-          normalized_namespace + element.first,
-          element.second.first,
-          element.second.second)
-      );
-    }
-  );
-  return result;
+  std::vector<rclcpp::node_interfaces::ParameterDeclaration> declarations(parameters.size());
+  auto declaration = declarations.begin();
+  for (const auto & element : parameters) {
+    declaration->name = normalized_namespace + element.first;
+    declaration->default_value = rclcpp::ParameterValue(element.second.first);
+    declaration->descriptor = element.second.second;
+    ++declaration;
+  }
+  return rclcpp::detail::get_declared_parameter_values<ParameterT>(
+    declarations, node_parameters_->declare_parameters(declarations));
 }
 
 template<typename ParameterT>
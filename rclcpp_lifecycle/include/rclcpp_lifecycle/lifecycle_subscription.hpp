@@ -0,0 +1,104 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP_LIFECYCLE__LIFECYCLE_SUBSCRIPTION_HPP_
+#define RCLCPP_LIFECYCLE__LIFECYCLE_SUBSCRIPTION_HPP_
+
+#include <memory>
+#include <string>
+
+#include "rclcpp/any_subscription_callback.hpp"
+#include "rclcpp/node_interfaces/node_base_interface.hpp"
+#include "rclcpp/qos.hpp"
+#include "rclcpp/subscription.hpp"
+#include "rclcpp/subscription_options.hpp"
+#include "rclcpp/topic_statistics/subscription_topic_statistics.hpp"
+
+#include "rclcpp_lifecycle/managed_entity.hpp"
+
+namespace rclcpp_lifecycle
+{
+
+/// Child class of rclcpp::Subscription which only delivers the messages while activated.
+/**
+ * While deactivated the subscription is paused, see rclcpp::SubscriptionBase::pause(): it
+ * stays matched with the publishers, but the executors drop the messages received without
+ * deserializing them nor calling the callback, and the intra-process messages aren't queued.
+ *
+ * It is created with rclcpp_lifecycle::LifecycleNode::create_lifecycle_subscription(), which
+ * activates it with the node.
+ */
+template<
+  typename MessageT,
+  typename AllocatorT = std::allocator<void>,
+  typename SubscribedT = typename rclcpp::TypeAdapter<MessageT>::custom_type,
+  typename ROSMessageT = typename rclcpp::TypeAdapter<MessageT>::ros_message_type,
+  typename MessageMemoryStrategyT = rclcpp::message_memory_strategy::MessageMemoryStrategy<
+    ROSMessageT,
+    AllocatorT
+  >>
+class LifecycleSubscription : public SimpleManagedEntity,
+  public rclcpp::Subscription<MessageT, AllocatorT, SubscribedT, ROSMessageT,
+    MessageMemoryStrategyT>
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(LifecycleSubscription)
+
+  using SubscriptionT = rclcpp::Subscription<MessageT, AllocatorT, SubscribedT, ROSMessageT,
+      MessageMemoryStrategyT>;
+
+  LifecycleSubscription(
+    rclcpp::node_interfaces::NodeBaseInterface * node_base,
+    const rosidl_message_type_support_t & type_support_handle,
+    const std::string & topic_name,
+    const rclcpp::QoS & qos,
+    rclcpp::AnySubscriptionCallback<MessageT, AllocatorT> callback,
+    const rclcpp::SubscriptionOptionsWithAllocator<AllocatorT> & options,
+    typename MessageMemoryStrategyT::SharedPtr message_memory_strategy,
+    std::shared_ptr<rclcpp::topic_statistics::SubscriptionTopicStatistics<ROSMessageT>>
+    subscription_topic_statistics = nullptr)
+  : SubscriptionT(
+      node_base,
+      type_support_handle,
+      topic_name,
+      qos,
+      callback,
+      options,
+      message_memory_strategy,
+      subscription_topic_statistics)
+  {
+  }
+
+  ~LifecycleSubscription() override = default;
+
+  /// Deliver the messages received from now on.
+  void
+  on_activate() override
+  {
+    SimpleManagedEntity::on_activate();
+    this->resume();
+  }
+
+  /// Drop the messages received from now on.
+  void
+  on_deactivate() override
+  {
+    SimpleManagedEntity::on_deactivate();
+    this->pause();
+  }
+};
+
+}  // namespace rclcpp_lifecycle
+
+#endif  // RCLCPP_LIFECYCLE__LIFECYCLE_SUBSCRIPTION_HPP_
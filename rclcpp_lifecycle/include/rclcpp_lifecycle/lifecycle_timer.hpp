@@ -0,0 +1,81 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP_LIFECYCLE__LIFECYCLE_TIMER_HPP_
+#define RCLCPP_LIFECYCLE__LIFECYCLE_TIMER_HPP_
+
+#include <chrono>
+#include <utility>
+
+#include "rclcpp/clock.hpp"
+#include "rclcpp/context.hpp"
+#include "rclcpp/timer.hpp"
+
+#include "rclcpp_lifecycle/managed_entity.hpp"
+
+namespace rclcpp_lifecycle
+{
+
+/// Child class of rclcpp::GenericTimer which only runs while activated.
+/**
+ * While deactivated the timer is canceled, so that it doesn't wake the executors up, and it
+ * is reset when activated: the first callback is called a period after the activation.
+ *
+ * It is created with rclcpp_lifecycle::LifecycleNode::create_lifecycle_timer() or
+ * rclcpp_lifecycle::LifecycleNode::create_lifecycle_wall_timer(), which activate it with the
+ * node.
+ */
+template<typename FunctorT>
+class LifecycleTimer : public SimpleManagedEntity, public rclcpp::GenericTimer<FunctorT>
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(LifecycleTimer)
+
+  /// Constructor.
+  /**
+   * \param[in] clock The clock providing the current time.
+   * \param[in] period The interval at which the timer fires.
+   * \param[in] callback User-specified callback function.
+   * \param[in] context custom context to be used.
+   */
+  LifecycleTimer(
+    rclcpp::Clock::SharedPtr clock, std::chrono::nanoseconds period, FunctorT && callback,
+    rclcpp::Context::SharedPtr context)
+  : rclcpp::GenericTimer<FunctorT>(
+      std::move(clock), period, std::forward<FunctorT>(callback), std::move(context))
+  {
+  }
+
+  ~LifecycleTimer() override = default;
+
+  /// Restart the timer, its next callback is called a period from now.
+  void
+  on_activate() override
+  {
+    SimpleManagedEntity::on_activate();
+    this->reset();
+  }
+
+  /// Cancel the timer.
+  void
+  on_deactivate() override
+  {
+    SimpleManagedEntity::on_deactivate();
+    this->cancel();
+  }
+};
+
+}  // namespace rclcpp_lifecycle
+
+#endif  // RCLCPP_LIFECYCLE__LIFECYCLE_TIMER_HPP_
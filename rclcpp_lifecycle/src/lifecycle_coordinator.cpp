@@ -0,0 +1,239 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp_lifecycle/lifecycle_coordinator.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "lifecycle_msgs/msg/transition.hpp"
+
+#include "rclcpp/create_service.hpp"
+#include "rclcpp/logging.hpp"
+#include "rclcpp/qos.hpp"
+
+namespace rclcpp_lifecycle
+{
+
+using CallbackReturn = node_interfaces::LifecycleNodeInterface::CallbackReturn;
+
+LifecycleCoordinator::LifecycleCoordinator(size_t number_of_threads)
+: thread_pool_(number_of_threads)
+{}
+
+LifecycleCoordinator::~LifecycleCoordinator()
+{}
+
+void
+LifecycleCoordinator::add_node(
+  LifecycleNode::SharedPtr node,
+  const std::vector<std::string> & dependencies)
+{
+  if (!node) {
+    throw std::invalid_argument("node argument must not be null");
+  }
+  ManagedNode managed_node{node, node->get_fully_qualified_name(), dependencies, 1};
+
+  std::lock_guard<std::mutex> lock(nodes_mutex_);
+  auto find_node = [this](const std::string & name) {
+      return std::find_if(
+        nodes_.begin(), nodes_.end(),
+        [&name](const ManagedNode & entry) {return entry.name == name;});
+    };
+  if (find_node(managed_node.name) != nodes_.end()) {
+    throw std::invalid_argument("node '" + managed_node.name + "' was added already");
+  }
+  // Requiring the dependencies to be added first rules out cycles
+  for (const auto & dependency : dependencies) {
+    auto it = find_node(dependency);
+    if (it == nodes_.end()) {
+      throw std::invalid_argument(
+              "dependency '" + dependency + "' of node '" + managed_node.name + "' is unknown");
+    }
+    managed_node.level = std::max(managed_node.level, it->level + 1);
+  }
+  nodes_.push_back(std::move(managed_node));
+}
+
+bool
+LifecycleCoordinator::remove_node(const std::string & node_name)
+{
+  std::lock_guard<std::mutex> lock(nodes_mutex_);
+  auto it = std::find_if(
+    nodes_.begin(), nodes_.end(),
+    [&node_name](const ManagedNode & managed_node) {return managed_node.name == node_name;});
+  if (it == nodes_.end()) {
+    return false;
+  }
+  for (const auto & managed_node : nodes_) {
+    const auto & dependencies = managed_node.dependencies;
+    if (std::find(dependencies.begin(), dependencies.end(), node_name) != dependencies.end()) {
+      throw std::invalid_argument(
+              "node '" + managed_node.name + "' depends on node '" + node_name + "'");
+    }
+  }
+  nodes_.erase(it);
+  return true;
+}
+
+size_t
+LifecycleCoordinator::get_number_of_nodes() const
+{
+  std::lock_guard<std::mutex> lock(nodes_mutex_);
+  return nodes_.size();
+}
+
+LifecycleCoordinator::TransitionResult
+LifecycleCoordinator::change_state(uint8_t transition_id)
+{
+  const bool up =
+    transition_id == lifecycle_msgs::msg::Transition::TRANSITION_CONFIGURE ||
+    transition_id == lifecycle_msgs::msg::Transition::TRANSITION_ACTIVATE;
+  return apply_transition(transition_id, "", up);
+}
+
+LifecycleCoordinator::TransitionResult
+LifecycleCoordinator::change_state(const std::string & transition_label)
+{
+  const bool up = transition_label == "configure" || transition_label == "activate";
+  return apply_transition(0, transition_label, up);
+}
+
+LifecycleCoordinator::TransitionResult
+LifecycleCoordinator::apply_transition(
+  uint8_t transition_id, const std::string & transition_label, bool up)
+{
+  std::lock_guard<std::mutex> transition_lock(transition_mutex_);
+  std::vector<ManagedNode> nodes;
+  {
+    std::lock_guard<std::mutex> lock(nodes_mutex_);
+    nodes = nodes_;
+  }
+
+  TransitionResult result;
+  result.nodes.resize(nodes.size());
+  std::unordered_map<std::string, size_t> indices;
+  size_t max_level = 0;
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    indices[nodes[i].name] = i;
+    result.nodes[i].node_name = nodes[i].name;
+    max_level = std::max(max_level, nodes[i].level);
+  }
+  // Going down, a node waits on the nodes depending on it
+  std::vector<std::vector<size_t>> waits_on(nodes.size());
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    for (const auto & dependency : nodes[i].dependencies) {
+      const size_t j = indices.at(dependency);
+      if (up) {
+        waits_on[i].push_back(j);
+      } else {
+        waits_on[j].push_back(i);
+      }
+    }
+  }
+
+  for (size_t step = 0; step < max_level; ++step) {
+    const size_t level = up ? step + 1 : max_level - step;
+    std::vector<std::future<void>> transitions;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+      if (nodes[i].level != level) {
+        continue;
+      }
+      NodeTransitionResult & node_result = result.nodes[i];
+      const bool waits_on_failure = std::any_of(
+        waits_on[i].begin(), waits_on[i].end(),
+        [&result](size_t j) {return !result.nodes[j].success;});
+      if (waits_on_failure) {
+        node_result.skipped = true;
+        node_result.state_id = nodes[i].node->get_current_state().id();
+        continue;
+      }
+      auto done = std::make_shared<std::promise<void>>();
+      transitions.push_back(done->get_future());
+      thread_pool_.post(
+        [node = nodes[i].node, &node_result, transition_id, &transition_label, done]() {
+          auto cb_return_code = CallbackReturn::ERROR;
+          try {
+            uint8_t id = transition_id;
+            if (!transition_label.empty()) {
+              // Look the transition up in the current state, like the change_state service does
+              id = 0;
+              for (const auto & transition : node->get_available_transitions()) {
+                if (transition.label() == transition_label) {
+                  id = transition.id();
+                  break;
+                }
+              }
+            }
+            if (id != 0 || transition_label.empty()) {
+              node_result.state_id = node->trigger_transition(id, cb_return_code).id();
+            } else {
+              node_result.state_id = node->get_current_state().id();
+            }
+          } catch (const std::exception & exception) {
+            cb_return_code = CallbackReturn::ERROR;
+            RCLCPP_ERROR(
+              rclcpp::get_logger("rclcpp_lifecycle"),
+              "Transition of node '%s' threw: %s", node_result.node_name.c_str(), exception.what());
+          }
+          node_result.success = cb_return_code == CallbackReturn::SUCCESS;
+          done->set_value();
+        });
+    }
+    for (auto & transition : transitions) {
+      transition.wait();
+    }
+  }
+
+  for (const auto & node_result : result.nodes) {
+    if (!node_result.success) {
+      result.success = false;
+      RCLCPP_WARN(
+        rclcpp::get_logger("rclcpp_lifecycle"), "Transition of node '%s' %s",
+        node_result.node_name.c_str(), node_result.skipped ? "skipped" : "failed");
+    }
+  }
+  return result;
+}
+
+rclcpp::Service<LifecycleCoordinator::ChangeStateSrv>::SharedPtr
+LifecycleCoordinator::create_change_state_service(
+  rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_base,
+  rclcpp::node_interfaces::NodeServicesInterface::SharedPtr node_services,
+  const std::string & service_name,
+  rclcpp::CallbackGroup::SharedPtr group)
+{
+  return rclcpp::create_service<ChangeStateSrv>(
+    node_base, node_services, service_name,
+    [this](
+      const std::shared_ptr<ChangeStateSrv::Request> request,
+      std::shared_ptr<ChangeStateSrv::Response> response)
+    {
+      if (!request->transition.label.empty()) {
+        response->success = change_state(request->transition.label).success;
+      } else {
+        response->success = change_state(request->transition.id).success;
+      }
+    },
+    rclcpp::ServicesQoS(), group);
+}
+
+}  // namespace rclcpp_lifecycle
@@ -16,6 +16,7 @@
 
 #include <chrono>
 #include <functional>
+#include <future>
 #include <map>
 #include <memory>
 #include <stdexcept>
@@ -74,9 +75,13 @@ LifecycleNode::LifecycleNode(
       options.context(),
       *(options.get_rcl_node_options()),
       options.use_intra_process_comms(),
-      options.enable_topic_statistics())),
-  node_graph_(new rclcpp::node_interfaces::NodeGraph(node_base_.get())),
-  node_logging_(new rclcpp::node_interfaces::NodeLogging(node_base_.get())),
+      options.enable_topic_statistics(),
+      nullptr,
+      options.entity_handoff())),
+  node_graph_(new rclcpp::node_interfaces::NodeGraph(
+      node_base_.get(), options.use_graph_cache())),
+  node_logging_(new rclcpp::node_interfaces::NodeLogging(
+      node_base_.get(), options.use_shared_publishers() && options.enable_rosout())),
   node_timers_(new rclcpp::node_interfaces::NodeTimers(node_base_.get())),
   node_topics_(new rclcpp::node_interfaces::NodeTopics(node_base_.get(), node_timers_.get())),
   node_services_(new rclcpp::node_interfaces::NodeServices(node_base_.get())),
@@ -100,7 +105,9 @@ LifecycleNode::LifecycleNode(
       options.parameter_event_qos(),
       options.parameter_event_publisher_options(),
       options.allow_undeclared_parameters(),
-      options.automatically_declare_parameters_from_overrides()
+      options.automatically_declare_parameters_from_overrides(),
+      options.use_shared_publishers(),
+      options.parameter_state()
     )),
   node_time_source_(new rclcpp::node_interfaces::NodeTimeSource(
       node_base_,
@@ -111,13 +118,15 @@ LifecycleNode::LifecycleNode(
       node_clock_,
       node_parameters_,
       options.clock_qos(),
-      options.use_clock_thread()
+      options.use_clock_thread(),
+      options.clock_thread_attributes(),
+      !options.lightweight()
     )),
   node_waitables_(new rclcpp::node_interfaces::NodeWaitables(node_base_.get())),
   node_options_(options),
   impl_(new LifecycleNodeInterfaceImpl(node_base_, node_services_))
 {
-  impl_->init(enable_communication_interface);
+  impl_->init(enable_communication_interface && options.start_lifecycle_services());
 
   register_on_configure(
     std::bind(
@@ -585,6 +594,18 @@ LifecycleNode::trigger_transition(
   return impl_->trigger_transition(transition_id, cb_return_code);
 }
 
+void
+LifecycleNode::enable_async_transitions()
+{
+  impl_->enable_async_transitions();
+}
+
+std::shared_future<node_interfaces::LifecycleNodeInterface::CallbackReturn>
+LifecycleNode::trigger_transition_async(uint8_t transition_id)
+{
+  return impl_->trigger_transition_async(transition_id);
+}
+
 const State &
 LifecycleNode::configure()
 {
@@ -676,6 +697,19 @@ LifecycleNode::add_managed_entity(
   impl_->add_managed_entity(managed_entity);
 }
 
+void
+LifecycleNode::add_managed_entity_in_current_state(
+  std::shared_ptr<rclcpp_lifecycle::ManagedEntityInterface> managed_entity)
+{
+  impl_->add_managed_entity(managed_entity);
+  // Synchronized after being added, so that a concurrent transition isn't missed
+  if (get_current_state().id() == lifecycle_msgs::msg::State::PRIMARY_STATE_ACTIVE) {
+    managed_entity->on_activate();
+  } else {
+    managed_entity->on_deactivate();
+  }
+}
+
 void
 LifecycleNode::add_timer_handle(std::shared_ptr<rclcpp::TimerBase> timer)
 {
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <functional>
+#include <future>
 #include <memory>
 #include <mutex>
 #include <stdexcept>
@@ -58,6 +59,8 @@ LifecycleNode::LifecycleNodeInterfaceImpl::LifecycleNodeInterfaceImpl(
 
 LifecycleNode::LifecycleNodeInterfaceImpl::~LifecycleNodeInterfaceImpl()
 {
+  // Complete the asynchronous transitions while the state machine still exists
+  transition_worker_.reset();
   rcl_node_t * node_handle = node_base_interface_->get_rcl_node_handle();
   rcl_ret_t ret;
   {
@@ -109,9 +112,13 @@ LifecycleNode::LifecycleNodeInterfaceImpl::init(bool enable_communication_interf
 
   if (enable_communication_interface) {
     { // change_state
-      auto cb = std::bind(
-        &LifecycleNode::LifecycleNodeInterfaceImpl::on_change_state, this,
-        std::placeholders::_1, std::placeholders::_2, std::placeholders::_3);
+      // The response is deferred, to be sent by the worker of the asynchronous transitions
+      auto cb = [this](
+        const std::shared_ptr<ChangeStateSrv::Request> req,
+        rclcpp::DeferredResponse<ChangeStateSrv> deferred_response)
+        {
+          on_change_state(req, std::move(deferred_response));
+        };
       rclcpp::AnyServiceCallback<ChangeStateSrv> any_cb;
       any_cb.set(std::move(cb));
 
@@ -203,12 +210,12 @@ LifecycleNode::LifecycleNodeInterfaceImpl::register_callback(
 
 void
 LifecycleNode::LifecycleNodeInterfaceImpl::on_change_state(
-  const std::shared_ptr<rmw_request_id_t> header,
   const std::shared_ptr<ChangeStateSrv::Request> req,
-  std::shared_ptr<ChangeStateSrv::Response> resp)
+  rclcpp::DeferredResponse<ChangeStateSrv> deferred_response)
 {
-  (void)header;
+  ChangeStateSrv::Response resp;
   std::uint8_t transition_id;
+  bool async;
   {
     std::lock_guard<std::recursive_mutex> lock(state_machine_mutex_);
     if (rcl_lifecycle_state_machine_is_initialized(&state_machine_) != RCL_RET_OK) {
@@ -228,21 +235,39 @@ LifecycleNode::LifecycleNodeInterfaceImpl::on_change_state(
       auto rcl_transition = rcl_lifecycle_get_transition_by_label(
         state_machine_.current_state, req->transition.label.c_str());
       if (rcl_transition == nullptr) {
-        resp->success = false;
+        resp.success = false;
+        deferred_response.send(resp);
         return;
       }
       transition_id = static_cast<std::uint8_t>(rcl_transition->id);
     }
+    async = transition_worker_ != nullptr;
+  }
+
+  if (async) {
+    auto pending_response =
+      std::make_shared<rclcpp::DeferredResponse<ChangeStateSrv>>(std::move(deferred_response));
+    change_state_async(
+      transition_id,
+      [pending_response](node_interfaces::LifecycleNodeInterface::CallbackReturn cb_return_code)
+      {
+        ChangeStateSrv::Response resp;
+        resp.success =
+          (cb_return_code == node_interfaces::LifecycleNodeInterface::CallbackReturn::SUCCESS);
+        pending_response->send(resp);
+      });
+    return;
   }
 
-  node_interfaces::LifecycleNodeInterface::CallbackReturn cb_return_code;
+  auto cb_return_code = node_interfaces::LifecycleNodeInterface::CallbackReturn::ERROR;
   auto ret = change_state(transition_id, cb_return_code);
   (void) ret;
   // TODO(karsten1987): Lifecycle msgs have to be extended to keep both returns
   // 1. return is the actual transition
   // 2. return is whether an error occurred or not
-  resp->success =
+  resp.success =
     (cb_return_code == node_interfaces::LifecycleNodeInterface::CallbackReturn::SUCCESS);
+  deferred_response.send(resp);
 }
 
 void
@@ -391,10 +416,20 @@ LifecycleNode::LifecycleNodeInterfaceImpl::change_state(
   std::uint8_t transition_id,
   node_interfaces::LifecycleNodeInterface::CallbackReturn & cb_return_code)
 {
-  constexpr bool publish_update = true;
   State initial_state;
   unsigned int current_state_id;
+  rcl_ret_t ret = start_transition(transition_id, initial_state, current_state_id);
+  if (ret != RCL_RET_OK) {
+    return ret;
+  }
+  return finish_transition(transition_id, initial_state, current_state_id, cb_return_code);
+}
 
+rcl_ret_t
+LifecycleNode::LifecycleNodeInterfaceImpl::start_transition(
+  std::uint8_t transition_id, State & initial_state, unsigned int & current_state_id)
+{
+  constexpr bool publish_update = true;
   {
     std::lock_guard<std::recursive_mutex> lock(state_machine_mutex_);
     if (rcl_lifecycle_state_machine_is_initialized(&state_machine_) != RCL_RET_OK) {
@@ -422,7 +457,17 @@ LifecycleNode::LifecycleNodeInterfaceImpl::change_state(
 
   // Update the internal current_state_
   current_state_ = State(state_machine_.current_state);
+  return RCL_RET_OK;
+}
 
+rcl_ret_t
+LifecycleNode::LifecycleNodeInterfaceImpl::finish_transition(
+  std::uint8_t transition_id,
+  const State & initial_state,
+  unsigned int current_state_id,
+  node_interfaces::LifecycleNodeInterface::CallbackReturn & cb_return_code)
+{
+  constexpr bool publish_update = true;
   auto get_label_for_return_code =
     [](node_interfaces::LifecycleNodeInterface::CallbackReturn cb_return_code) -> const char *{
       auto cb_id = static_cast<uint8_t>(cb_return_code);
@@ -482,6 +527,31 @@ LifecycleNode::LifecycleNodeInterfaceImpl::change_state(
   return RCL_RET_OK;
 }
 
+void
+LifecycleNode::LifecycleNodeInterfaceImpl::change_state_async(
+  std::uint8_t transition_id,
+  std::function<void(node_interfaces::LifecycleNodeInterface::CallbackReturn)> on_done)
+{
+  rclcpp::DeserializationThreadPool * transition_worker;
+  {
+    std::lock_guard<std::recursive_mutex> lock(state_machine_mutex_);
+    transition_worker = transition_worker_.get();
+  }
+  State initial_state;
+  unsigned int current_state_id;
+  if (start_transition(transition_id, initial_state, current_state_id) != RCL_RET_OK) {
+    on_done(node_interfaces::LifecycleNodeInterface::CallbackReturn::ERROR);
+    return;
+  }
+  // The node stays in the intermediate state until the worker finishes the transition
+  transition_worker->post(
+    [this, transition_id, initial_state, current_state_id, on_done]() {
+      auto cb_return_code = node_interfaces::LifecycleNodeInterface::CallbackReturn::ERROR;
+      finish_transition(transition_id, initial_state, current_state_id, cb_return_code);
+      on_done(cb_return_code);
+    });
+}
+
 node_interfaces::LifecycleNodeInterface::CallbackReturn
 LifecycleNode::LifecycleNodeInterfaceImpl::execute_callback(
   unsigned int cb_id, const State & previous_state) const
@@ -545,6 +615,35 @@ LifecycleNode::LifecycleNodeInterfaceImpl::trigger_transition(
   return get_current_state();
 }
 
+void
+LifecycleNode::LifecycleNodeInterfaceImpl::enable_async_transitions()
+{
+  std::lock_guard<std::recursive_mutex> lock(state_machine_mutex_);
+  if (!transition_worker_) {
+    transition_worker_ = std::make_unique<rclcpp::DeserializationThreadPool>(1);
+  }
+}
+
+std::shared_future<node_interfaces::LifecycleNodeInterface::CallbackReturn>
+LifecycleNode::LifecycleNodeInterfaceImpl::trigger_transition_async(uint8_t transition_id)
+{
+  {
+    std::lock_guard<std::recursive_mutex> lock(state_machine_mutex_);
+    if (!transition_worker_) {
+      throw std::runtime_error("Asynchronous transitions aren't enabled");
+    }
+  }
+  auto promise =
+    std::make_shared<std::promise<node_interfaces::LifecycleNodeInterface::CallbackReturn>>();
+  auto future = promise->get_future().share();
+  change_state_async(
+    transition_id,
+    [promise](node_interfaces::LifecycleNodeInterface::CallbackReturn cb_return_code) {
+      promise->set_value(cb_return_code);
+    });
+  return future;
+}
+
 void
 LifecycleNode::LifecycleNodeInterfaceImpl::add_managed_entity(
   std::weak_ptr<rclcpp_lifecycle::ManagedEntityInterface> managed_entity)
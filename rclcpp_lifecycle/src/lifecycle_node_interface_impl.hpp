@@ -18,6 +18,7 @@
 #include "rclcpp_lifecycle/lifecycle_node.hpp"
 
 #include <functional>
+#include <future>
 #include <map>
 #include <memory>
 #include <vector>
@@ -30,9 +31,11 @@
 
 #include "rcl_lifecycle/rcl_lifecycle.h"
 
+#include "rclcpp/deserialization_thread_pool.hpp"
 #include "rclcpp/macros.hpp"
 #include "rclcpp/node_interfaces/node_base_interface.hpp"
 #include "rclcpp/node_interfaces/node_services_interface.hpp"
+#include "rclcpp/service.hpp"
 
 #include "rclcpp_lifecycle/node_interfaces/lifecycle_node_interface.hpp"
 
@@ -90,6 +93,12 @@ public:
     const char * transition_label,
     node_interfaces::LifecycleNodeInterface::CallbackReturn & cb_return_code);
 
+  void
+  enable_async_transitions();
+
+  std::shared_future<node_interfaces::LifecycleNodeInterface::CallbackReturn>
+  trigger_transition_async(uint8_t transition_id);
+
   void
   on_activate() const;
 
@@ -107,9 +116,8 @@ private:
 
   void
   on_change_state(
-    const std::shared_ptr<rmw_request_id_t> header,
     const std::shared_ptr<ChangeStateSrv::Request> req,
-    std::shared_ptr<ChangeStateSrv::Response> resp);
+    rclcpp::DeferredResponse<ChangeStateSrv> deferred_response);
 
   void
   on_get_state(
@@ -140,6 +148,29 @@ private:
     std::uint8_t transition_id,
     node_interfaces::LifecycleNodeInterface::CallbackReturn & cb_return_code);
 
+  /// Move the state machine to the intermediate state of the transition.
+  rcl_ret_t
+  start_transition(
+    std::uint8_t transition_id, State & initial_state, unsigned int & current_state_id);
+
+  /// Run the callbacks of a started transition and move to the next primary state.
+  rcl_ret_t
+  finish_transition(
+    std::uint8_t transition_id,
+    const State & initial_state,
+    unsigned int current_state_id,
+    node_interfaces::LifecycleNodeInterface::CallbackReturn & cb_return_code);
+
+  /// Start a transition and queue the rest of it to the transition worker.
+  /**
+   * on_done is called with the callback return code, by the worker or by the calling thread
+   * if the transition couldn't start.
+   */
+  void
+  change_state_async(
+    std::uint8_t transition_id,
+    std::function<void(node_interfaces::LifecycleNodeInterface::CallbackReturn)> on_done);
+
   node_interfaces::LifecycleNodeInterface::CallbackReturn
   execute_callback(unsigned int cb_id, const State & previous_state) const;
 
@@ -172,6 +203,9 @@ private:
   // to controllable things
   std::vector<std::weak_ptr<rclcpp_lifecycle::ManagedEntityInterface>> weak_managed_entities_;
   std::vector<std::weak_ptr<rclcpp::TimerBase>> weak_timers_;
+
+  /// Runs the asynchronous transitions, if enabled.
+  std::unique_ptr<rclcpp::DeserializationThreadPool> transition_worker_;
 };
 
 }  // namespace rclcpp_lifecycle
@@ -0,0 +1,243 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "lifecycle_msgs/msg/state.hpp"
+#include "lifecycle_msgs/msg/transition.hpp"
+#include "lifecycle_msgs/srv/change_state.hpp"
+
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp_lifecycle/lifecycle_coordinator.hpp"
+#include "rclcpp_lifecycle/lifecycle_node.hpp"
+
+using lifecycle_msgs::msg::State;
+using lifecycle_msgs::msg::Transition;
+using rclcpp_lifecycle::LifecycleCoordinator;
+using CallbackReturn = rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn;
+
+class TestLifecycleCoordinator : public ::testing::Test
+{
+protected:
+  static void SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  static void TearDownTestCase()
+  {
+    rclcpp::shutdown();
+  }
+};
+
+struct TransitionLog
+{
+  void add(const std::string & entry)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.push_back(entry);
+  }
+
+  size_t index_of(const std::string & entry)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    return static_cast<size_t>(
+      std::find(entries.begin(), entries.end(), entry) - entries.begin());
+  }
+
+  std::mutex mutex;
+  std::vector<std::string> entries;
+};
+
+class LoggingLifecycleNode : public rclcpp_lifecycle::LifecycleNode
+{
+public:
+  LoggingLifecycleNode(
+    const std::string & node_name, std::shared_ptr<TransitionLog> log, bool fail_configure = false)
+  : rclcpp_lifecycle::LifecycleNode(node_name), log_(log), fail_configure_(fail_configure)
+  {}
+
+protected:
+  CallbackReturn
+  on_configure(const rclcpp_lifecycle::State &) override
+  {
+    log_->add("configure " + std::string(get_name()));
+    return fail_configure_ ? CallbackReturn::FAILURE : CallbackReturn::SUCCESS;
+  }
+
+  CallbackReturn
+  on_activate(const rclcpp_lifecycle::State &) override
+  {
+    log_->add("activate " + std::string(get_name()));
+    return CallbackReturn::SUCCESS;
+  }
+
+  CallbackReturn
+  on_deactivate(const rclcpp_lifecycle::State &) override
+  {
+    log_->add("deactivate " + std::string(get_name()));
+    return CallbackReturn::SUCCESS;
+  }
+
+  CallbackReturn
+  on_shutdown(const rclcpp_lifecycle::State &) override
+  {
+    log_->add("shutdown " + std::string(get_name()));
+    return CallbackReturn::SUCCESS;
+  }
+
+private:
+  std::shared_ptr<TransitionLog> log_;
+  bool fail_configure_;
+};
+
+TEST_F(TestLifecycleCoordinator, add_and_remove_nodes) {
+  auto log = std::make_shared<TransitionLog>();
+  auto driver = std::make_shared<LoggingLifecycleNode>("driver", log);
+  auto planner = std::make_shared<LoggingLifecycleNode>("planner", log);
+  LifecycleCoordinator coordinator(2);
+
+  EXPECT_THROW(coordinator.add_node(nullptr), std::invalid_argument);
+  EXPECT_THROW(coordinator.add_node(planner, {"/driver"}), std::invalid_argument);
+  coordinator.add_node(driver);
+  EXPECT_THROW(coordinator.add_node(driver), std::invalid_argument);
+  coordinator.add_node(planner, {"/driver"});
+  EXPECT_EQ(2u, coordinator.get_number_of_nodes());
+
+  EXPECT_THROW(coordinator.remove_node("/driver"), std::invalid_argument);
+  EXPECT_FALSE(coordinator.remove_node("/unknown"));
+  EXPECT_TRUE(coordinator.remove_node("/planner"));
+  EXPECT_TRUE(coordinator.remove_node("/driver"));
+  EXPECT_EQ(0u, coordinator.get_number_of_nodes());
+}
+
+TEST_F(TestLifecycleCoordinator, dependency_order) {
+  auto log = std::make_shared<TransitionLog>();
+  LifecycleCoordinator coordinator(4);
+  coordinator.add_node(std::make_shared<LoggingLifecycleNode>("driver_left", log));
+  coordinator.add_node(std::make_shared<LoggingLifecycleNode>("driver_right", log));
+  coordinator.add_node(
+    std::make_shared<LoggingLifecycleNode>("localization", log),
+    {"/driver_left", "/driver_right"});
+  coordinator.add_node(std::make_shared<LoggingLifecycleNode>("planner", log), {"/localization"});
+
+  auto result = coordinator.change_state(Transition::TRANSITION_CONFIGURE);
+  EXPECT_TRUE(result.success);
+  ASSERT_EQ(4u, result.nodes.size());
+  EXPECT_EQ("/driver_left", result.nodes[0].node_name);
+  for (const auto & node_result : result.nodes) {
+    EXPECT_TRUE(node_result.success);
+    EXPECT_FALSE(node_result.skipped);
+    EXPECT_EQ(State::PRIMARY_STATE_INACTIVE, node_result.state_id);
+  }
+  EXPECT_LT(log->index_of("configure driver_left"), log->index_of("configure localization"));
+  EXPECT_LT(log->index_of("configure driver_right"), log->index_of("configure localization"));
+  EXPECT_LT(log->index_of("configure localization"), log->index_of("configure planner"));
+
+  result = coordinator.change_state(Transition::TRANSITION_ACTIVATE);
+  EXPECT_TRUE(result.success);
+  result = coordinator.change_state(Transition::TRANSITION_DEACTIVATE);
+  EXPECT_TRUE(result.success);
+  // Going down, the nodes are transitioned before their dependencies
+  EXPECT_LT(log->index_of("deactivate planner"), log->index_of("deactivate localization"));
+  EXPECT_LT(log->index_of("deactivate localization"), log->index_of("deactivate driver_left"));
+
+  // The shutdown label is looked up in the current state of each node
+  result = coordinator.change_state("shutdown");
+  EXPECT_TRUE(result.success);
+  for (const auto & node_result : result.nodes) {
+    EXPECT_EQ(State::PRIMARY_STATE_FINALIZED, node_result.state_id);
+  }
+  EXPECT_LT(log->index_of("shutdown planner"), log->index_of("shutdown driver_right"));
+}
+
+TEST_F(TestLifecycleCoordinator, failed_dependency) {
+  auto log = std::make_shared<TransitionLog>();
+  LifecycleCoordinator coordinator(2);
+  coordinator.add_node(std::make_shared<LoggingLifecycleNode>("camera", log, true));
+  coordinator.add_node(std::make_shared<LoggingLifecycleNode>("lidar", log));
+  coordinator.add_node(std::make_shared<LoggingLifecycleNode>("detector", log), {"/camera"});
+
+  auto result = coordinator.change_state(Transition::TRANSITION_CONFIGURE);
+  EXPECT_FALSE(result.success);
+  ASSERT_EQ(3u, result.nodes.size());
+  EXPECT_FALSE(result.nodes[0].success);
+  EXPECT_FALSE(result.nodes[0].skipped);
+  EXPECT_EQ(State::PRIMARY_STATE_UNCONFIGURED, result.nodes[0].state_id);
+  EXPECT_TRUE(result.nodes[1].success);
+  EXPECT_EQ(State::PRIMARY_STATE_INACTIVE, result.nodes[1].state_id);
+  EXPECT_FALSE(result.nodes[2].success);
+  EXPECT_TRUE(result.nodes[2].skipped);
+  EXPECT_EQ(State::PRIMARY_STATE_UNCONFIGURED, result.nodes[2].state_id);
+  EXPECT_EQ(log->entries.size(), log->index_of("configure detector"));
+
+  // The transition isn't available in the current state of the lidar
+  result = coordinator.change_state(Transition::TRANSITION_CONFIGURE);
+  EXPECT_FALSE(result.success);
+  EXPECT_FALSE(result.nodes[1].success);
+  EXPECT_EQ(State::PRIMARY_STATE_INACTIVE, result.nodes[1].state_id);
+}
+
+TEST_F(TestLifecycleCoordinator, change_state_service) {
+  auto log = std::make_shared<TransitionLog>();
+  LifecycleCoordinator coordinator(2);
+  auto first = std::make_shared<LoggingLifecycleNode>("first", log);
+  auto second = std::make_shared<LoggingLifecycleNode>("second", log);
+  coordinator.add_node(first);
+  coordinator.add_node(second, {"/first"});
+
+  auto container = std::make_shared<rclcpp::Node>("container");
+  auto service = coordinator.create_change_state_service(
+    container->get_node_base_interface(), container->get_node_services_interface());
+  ASSERT_NE(nullptr, service);
+  EXPECT_STREQ("/container/coordinator/change_state", service->get_service_name());
+
+  auto client = container->create_client<lifecycle_msgs::srv::ChangeState>(
+    "/container/coordinator/change_state");
+  ASSERT_TRUE(client->wait_for_service(std::chrono::seconds(5)));
+  auto request = std::make_shared<lifecycle_msgs::srv::ChangeState::Request>();
+  request->transition.id = Transition::TRANSITION_CONFIGURE;
+  auto future = client->async_send_request(request);
+  ASSERT_EQ(
+    rclcpp::FutureReturnCode::SUCCESS,
+    rclcpp::spin_until_future_complete(container, future, std::chrono::seconds(5)));
+  EXPECT_TRUE(future.get()->success);
+  EXPECT_EQ(State::PRIMARY_STATE_INACTIVE, first->get_current_state().id());
+  EXPECT_EQ(State::PRIMARY_STATE_INACTIVE, second->get_current_state().id());
+
+  request->transition.id = 0;
+  request->transition.label = "activate";
+  future = client->async_send_request(request);
+  ASSERT_EQ(
+    rclcpp::FutureReturnCode::SUCCESS,
+    rclcpp::spin_until_future_complete(container, future, std::chrono::seconds(5)));
+  EXPECT_TRUE(future.get()->success);
+  EXPECT_EQ(State::PRIMARY_STATE_ACTIVE, second->get_current_state().id());
+
+  // Cleanup isn't available in the active state
+  request->transition.label = "cleanup";
+  future = client->async_send_request(request);
+  ASSERT_EQ(
+    rclcpp::FutureReturnCode::SUCCESS,
+    rclcpp::spin_until_future_complete(container, future, std::chrono::seconds(5)));
+  EXPECT_FALSE(future.get()->success);
+}
@@ -14,6 +14,7 @@
 
 
 #include <gtest/gtest.h>
+#include <future>
 #include <map>
 #include <memory>
 #include <set>
@@ -23,6 +24,7 @@
 
 #include "lifecycle_msgs/msg/state.hpp"
 #include "lifecycle_msgs/msg/transition.hpp"
+#include "lifecycle_msgs/srv/change_state.hpp"
 
 #include "rcl_lifecycle/rcl_lifecycle.h"
 
@@ -715,6 +717,100 @@ TEST_F(TestDefaultStateMachine, test_graph_services_by_node) {
     "lifecycle_msgs/srv/GetAvailableTransitions");
 }
 
+TEST_F(TestDefaultStateMachine, test_without_lifecycle_services) {
+  auto test_node = std::make_shared<rclcpp_lifecycle::LifecycleNode>(
+    "testnode", rclcpp::NodeOptions().start_lifecycle_services(false));
+
+  auto service_names_and_types_by_node =
+    test_node->get_service_names_and_types_by_node("testnode", "");
+  EXPECT_EQ(0u, service_names_and_types_by_node.count("/testnode/change_state"));
+  EXPECT_EQ(0u, service_names_and_types_by_node.count("/testnode/get_state"));
+  EXPECT_EQ(0u, test_node->count_publishers("/testnode/transition_event"));
+
+  // The transitions are still triggered in the process
+  EXPECT_EQ(State::PRIMARY_STATE_INACTIVE, test_node->configure().id());
+  EXPECT_EQ(State::PRIMARY_STATE_ACTIVE, test_node->activate().id());
+}
+
+class BlockingConfigureNode : public rclcpp_lifecycle::LifecycleNode
+{
+public:
+  explicit BlockingConfigureNode(const std::string & node_name)
+  : rclcpp_lifecycle::LifecycleNode(node_name), released_(release_.get_future().share())
+  {}
+
+  void release()
+  {
+    release_.set_value();
+  }
+
+protected:
+  rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn
+  on_configure(const rclcpp_lifecycle::State &) override
+  {
+    released_.wait();
+    return rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn::SUCCESS;
+  }
+
+private:
+  std::promise<void> release_;
+  std::shared_future<void> released_;
+};
+
+TEST_F(TestDefaultStateMachine, async_transitions) {
+  using CallbackReturn = rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn;
+  auto test_node = std::make_shared<BlockingConfigureNode>("testnode");
+  EXPECT_THROW(
+    test_node->trigger_transition_async(Transition::TRANSITION_CONFIGURE), std::runtime_error);
+
+  test_node->enable_async_transitions();
+  auto configured = test_node->trigger_transition_async(Transition::TRANSITION_CONFIGURE);
+  EXPECT_EQ(State::TRANSITION_STATE_CONFIGURING, test_node->get_current_state().id());
+  EXPECT_EQ(
+    std::future_status::timeout, configured.wait_for(std::chrono::milliseconds(10)));
+
+  // No other transition starts until the callbacks complete
+  auto activated = test_node->trigger_transition_async(Transition::TRANSITION_ACTIVATE);
+  EXPECT_EQ(std::future_status::ready, activated.wait_for(std::chrono::seconds(0)));
+  EXPECT_EQ(CallbackReturn::ERROR, activated.get());
+
+  test_node->release();
+  EXPECT_EQ(CallbackReturn::SUCCESS, configured.get());
+  EXPECT_EQ(State::PRIMARY_STATE_INACTIVE, test_node->get_current_state().id());
+  activated = test_node->trigger_transition_async(Transition::TRANSITION_ACTIVATE);
+  EXPECT_EQ(CallbackReturn::SUCCESS, activated.get());
+  EXPECT_EQ(State::PRIMARY_STATE_ACTIVE, test_node->get_current_state().id());
+}
+
+TEST_F(TestDefaultStateMachine, async_change_state_service) {
+  auto test_node = std::make_shared<BlockingConfigureNode>("testnode");
+  test_node->enable_async_transitions();
+  auto client_node = std::make_shared<rclcpp::Node>("client_node");
+  auto client = client_node->create_client<lifecycle_msgs::srv::ChangeState>(
+    "/testnode/change_state");
+  ASSERT_TRUE(client->wait_for_service(std::chrono::seconds(5)));
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(test_node->get_node_base_interface());
+  executor.add_node(client_node);
+  auto request = std::make_shared<lifecycle_msgs::srv::ChangeState::Request>();
+  request->transition.id = Transition::TRANSITION_CONFIGURE;
+  auto future = client->async_send_request(request);
+
+  // The executor keeps spinning while the node is configuring
+  EXPECT_EQ(
+    rclcpp::FutureReturnCode::TIMEOUT,
+    executor.spin_until_future_complete(future, std::chrono::milliseconds(200)));
+  EXPECT_EQ(State::TRANSITION_STATE_CONFIGURING, test_node->get_current_state().id());
+
+  test_node->release();
+  ASSERT_EQ(
+    rclcpp::FutureReturnCode::SUCCESS,
+    executor.spin_until_future_complete(future, std::chrono::seconds(5)));
+  EXPECT_TRUE(future.get()->success);
+  EXPECT_EQ(State::PRIMARY_STATE_INACTIVE, test_node->get_current_state().id());
+}
+
 TEST_F(TestDefaultStateMachine, test_callback_groups) {
   auto test_node = std::make_shared<EmptyLifecycleNode>("testnode");
   size_t num_groups = 0;
@@ -0,0 +1,163 @@
+// Copyright 2022 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "lifecycle_msgs/msg/state.hpp"
+#include "lifecycle_msgs/msg/transition.hpp"
+
+#include "rclcpp/rclcpp.hpp"
+#include "test_msgs/msg/empty.hpp"
+
+#include "rclcpp_lifecycle/lifecycle_node.hpp"
+#include "rclcpp_lifecycle/lifecycle_subscription.hpp"
+#include "rclcpp_lifecycle/lifecycle_timer.hpp"
+
+using lifecycle_msgs::msg::State;
+using lifecycle_msgs::msg::Transition;
+
+class TestLifecycleSubscription : public ::testing::Test
+{
+public:
+  void SetUp()
+  {
+    rclcpp::init(0, nullptr);
+    node_ = std::make_shared<rclcpp_lifecycle::LifecycleNode>("node");
+  }
+
+  void TearDown()
+  {
+    node_.reset();
+    rclcpp::shutdown();
+  }
+
+protected:
+  void transition(uint8_t transition_id)
+  {
+    auto ret = rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn::ERROR;
+    node_->trigger_transition(rclcpp_lifecycle::Transition(transition_id), ret);
+    ASSERT_EQ(
+      rclcpp_lifecycle::node_interfaces::LifecycleNodeInterface::CallbackReturn::SUCCESS, ret);
+  }
+
+  std::shared_ptr<rclcpp_lifecycle::LifecycleNode> node_;
+};
+
+TEST_F(TestLifecycleSubscription, managed_by_node) {
+  auto subscription = node_->create_lifecycle_subscription<test_msgs::msg::Empty>(
+    "topic", 10, [](test_msgs::msg::Empty::ConstSharedPtr) {});
+  auto wall_timer = node_->create_lifecycle_wall_timer(std::chrono::seconds(1), []() {});
+  auto timer = node_->create_lifecycle_timer(std::chrono::seconds(1), []() {});
+  EXPECT_FALSE(subscription->is_activated());
+  EXPECT_TRUE(subscription->is_paused());
+  EXPECT_TRUE(wall_timer->is_canceled());
+  EXPECT_TRUE(timer->is_canceled());
+
+  transition(Transition::TRANSITION_CONFIGURE);
+  EXPECT_TRUE(subscription->is_paused());
+  EXPECT_TRUE(wall_timer->is_canceled());
+
+  transition(Transition::TRANSITION_ACTIVATE);
+  EXPECT_TRUE(subscription->is_activated());
+  EXPECT_FALSE(subscription->is_paused());
+  EXPECT_FALSE(wall_timer->is_canceled());
+  EXPECT_FALSE(timer->is_canceled());
+
+  // Created while active, they start active
+  auto active_subscription = node_->create_lifecycle_subscription<test_msgs::msg::Empty>(
+    "topic", 10, [](test_msgs::msg::Empty::ConstSharedPtr) {});
+  auto active_timer = node_->create_lifecycle_wall_timer(std::chrono::seconds(1), []() {});
+  EXPECT_FALSE(active_subscription->is_paused());
+  EXPECT_FALSE(active_timer->is_canceled());
+
+  transition(Transition::TRANSITION_DEACTIVATE);
+  EXPECT_TRUE(subscription->is_paused());
+  EXPECT_TRUE(active_subscription->is_paused());
+  EXPECT_TRUE(wall_timer->is_canceled());
+  EXPECT_TRUE(timer->is_canceled());
+  EXPECT_TRUE(active_timer->is_canceled());
+
+  // The plain subscriptions aren't managed
+  auto subscription_options = rclcpp::SubscriptionOptions();
+  auto plain_subscription = node_->create_subscription<test_msgs::msg::Empty>(
+    "topic", 10, [](test_msgs::msg::Empty::ConstSharedPtr) {}, subscription_options);
+  EXPECT_FALSE(plain_subscription->is_paused());
+}
+
+TEST_F(TestLifecycleSubscription, messages_delivered_while_active) {
+  size_t received = 0;
+  auto subscription = node_->create_lifecycle_subscription<test_msgs::msg::Empty>(
+    "topic", 10, [&received](test_msgs::msg::Empty::ConstSharedPtr) {
+      ++received;
+    });
+  auto publisher_node = std::make_shared<rclcpp::Node>("publisher_node");
+  auto publisher = publisher_node->create_publisher<test_msgs::msg::Empty>("topic", 10);
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node_->get_node_base_interface());
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (publisher->get_subscription_count() == 0 &&
+    std::chrono::steady_clock::now() < deadline)
+  {
+    executor.spin_some(std::chrono::milliseconds(10));
+  }
+  ASSERT_EQ(1u, publisher->get_subscription_count());
+
+  // Dropped while inactive
+  publisher->publish(test_msgs::msg::Empty());
+  while (subscription->get_paused_dropped_count() == 0 &&
+    std::chrono::steady_clock::now() < deadline)
+  {
+    executor.spin_some(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(1u, subscription->get_paused_dropped_count());
+  EXPECT_EQ(0u, received);
+
+  transition(Transition::TRANSITION_CONFIGURE);
+  transition(Transition::TRANSITION_ACTIVATE);
+  publisher->publish(test_msgs::msg::Empty());
+  while (received == 0 && std::chrono::steady_clock::now() < deadline) {
+    executor.spin_some(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(1u, received);
+}
+
+TEST_F(TestLifecycleSubscription, timer_runs_while_active) {
+  size_t calls = 0;
+  auto timer = node_->create_lifecycle_wall_timer(
+    std::chrono::milliseconds(1), [&calls]() {
+      ++calls;
+    });
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node_->get_node_base_interface());
+  executor.spin_some(std::chrono::milliseconds(20));
+  EXPECT_EQ(0u, calls);
+
+  transition(Transition::TRANSITION_CONFIGURE);
+  transition(Transition::TRANSITION_ACTIVATE);
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (calls == 0 && std::chrono::steady_clock::now() < deadline) {
+    executor.spin_some(std::chrono::milliseconds(10));
+  }
+  EXPECT_LT(0u, calls);
+
+  transition(Transition::TRANSITION_DEACTIVATE);
+  const size_t calls_when_deactivated = calls;
+  executor.spin_some(std::chrono::milliseconds(20));
+  EXPECT_EQ(calls_when_deactivated, calls);
+}